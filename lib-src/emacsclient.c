@@ -141,6 +141,10 @@ #define DEFAULT_TIMEOUT (30)
 #ifdef SOCKETS_IN_FILE_SYSTEM
 /* If non-NULL, the filename of the UNIX socket.  */
 static char const *socket_name;
+
+/* True means run the remaining arguments in a copy of the Emacs that
+   serves `server-batch-start'.  --batch.  */
+static bool batch;
 #endif
 
 /* If non-NULL, the filename of the authentication file.  */
@@ -180,6 +184,7 @@ #define DEFAULT_TIMEOUT (30)
   { "frame-parameters", required_argument, NULL, 'F' },
 #ifdef SOCKETS_IN_FILE_SYSTEM
   { "socket-name",	required_argument, NULL, 's' },
+  { "batch",	no_argument,	   NULL, 'b' },
 #endif
   { "server-file",	required_argument, NULL, 'f' },
   { "display",	required_argument, NULL, 'd' },
@@ -190,7 +195,7 @@ #define DEFAULT_TIMEOUT (30)
 };
 
 /* Short options, in the same order as the corresponding long options.
-   There is no '-p' short option.  */
+   There are no '-p' and '-b' short options.  */
 static char const shortopts[] =
   "nqueHVtca:F:w:"
 #ifdef SOCKETS_IN_FILE_SYSTEM
@@ -520,6 +525,10 @@ decode_options (int argc, char **argv)
 	case 's':
 	  socket_name = optarg;
 	  break;
+
+	case 'b':
+	  batch = true;
+	  break;
 #endif
 
 	case 'f':
@@ -604,6 +613,12 @@ decode_options (int argc, char **argv)
 	  exit (EXIT_FAILURE);
 	  break;
 	}
+
+#ifdef SOCKETS_IN_FILE_SYSTEM
+      /* The arguments after --batch are for Emacs.  */
+      if (batch)
+	return;
+#endif
     }
 
   /* If the -c option is used (without -t) and no --display argument
@@ -711,7 +726,10 @@ print_help_and_exit (void)
 --parent-id=ID          Open in parent window ID, via XEmbed\n"
 #ifdef SOCKETS_IN_FILE_SYSTEM
 "-s SOCKET, --socket-name=SOCKET\n\
-			Set filename of the UNIX socket for communication\n"
+			Set filename of the UNIX socket for communication\n\
+--batch ARG...		Run 'emacs --batch ARG...' in a copy of the Emacs\n\
+			that runs 'server-batch-start'; this must be the\n\
+			last emacsclient option\n"
 #endif
 "-f SERVER, --server-file=SERVER\n\
 			Set filename of the TCP authentication file\n\
@@ -1650,6 +1668,126 @@ set_local_socket (char const *server_name)
 
   return INVALID_SOCKET;
 }
+
+/* The process that serves a --batch request, once known, and a
+   signal received before it was known.  */
+static pid_t volatile batch_pid;
+static sig_atomic_t volatile batch_signal;
+
+/* Forward the signal SIG to the process that serves the request.  */
+static void
+handle_batch_signal (int sig)
+{
+  if (batch_pid)
+    kill (batch_pid, sig);
+  else
+    batch_signal = sig;
+  reinstall_handler_if_needed (sig, handle_batch_signal);
+}
+
+/* Run the ARGC arguments ARGV in a copy of the Emacs that runs
+   `server-batch-start', as though they were the arguments of
+   "emacs --batch".  The copy uses our standard input, output and
+   error, working directory and environment.  Return its exit status.  */
+static int
+batch_request (int argc, char *const *argv)
+{
+  HSOCKET s = set_local_socket (socket_name ? socket_name : "batch");
+  if (s == INVALID_SOCKET)
+    fail ();
+
+  char *cwd = get_current_dir_name ();
+  if (!cwd)
+    {
+      message (true, "%s: %s\n", progname,
+	       "Cannot get current working directory");
+      fail ();
+    }
+
+  /* The request is a sequence of null-terminated strings, each tagged
+     by its first byte: 'D' for the working directory, 'E' for an
+     environment variable and 'A' for an argument.  */
+  size_t size = strlen (cwd) + 2;
+  for (char *const *e = environ; *e; e++)
+    size += strlen (*e) + 2;
+  for (int i = 0; i < argc; i++)
+    size += strlen (argv[i]) + 2;
+  char *request = xmalloc (size);
+  char *p = request;
+  p += sprintf (p, "D%s", cwd) + 1;
+  for (char *const *e = environ; *e; e++)
+    p += sprintf (p, "E%s", *e) + 1;
+  for (int i = 0; i < argc; i++)
+    p += sprintf (p, "A%s", argv[i]) + 1;
+  free (cwd);
+
+  /* Pass our standard file descriptors along with the request.  */
+  int fds[3] = { STDIN_FILENO, STDOUT_FILENO, STDERR_FILENO };
+  union
+  {
+    struct cmsghdr align;
+    char buf[CMSG_SPACE (sizeof fds)];
+  } control;
+  memset (&control, 0, sizeof control);
+  struct iovec iov = { .iov_base = request, .iov_len = size };
+  struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1,
+			.msg_control = control.buf,
+			.msg_controllen = sizeof control.buf };
+  struct cmsghdr *cmsg = CMSG_FIRSTHDR (&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN (sizeof fds);
+  memcpy (CMSG_DATA (cmsg), fds, sizeof fds);
+  ssize_t sent = sendmsg (s, &msg, 0);
+  for (size_t off = sent; 0 <= sent && off < size; off += sent)
+    sent = send (s, request + off, size - off, 0);
+  if (sent < 0 || shutdown (s, SHUT_WR) != 0)
+    {
+      message (true, "%s: can't send request: %s\n",
+	       progname, strerror (errno));
+      exit (EXIT_FAILURE);
+    }
+  free (request);
+
+  install_handler (SIGINT, handle_batch_signal, NULL);
+  install_handler (SIGTERM, handle_batch_signal, NULL);
+  install_handler (SIGHUP, handle_batch_signal, NULL);
+  install_handler (SIGQUIT, handle_batch_signal, NULL);
+
+  /* Read the replies "-emacs-pid PID" and "-exit STATUS".  */
+  char reply[128];
+  size_t len = 0;
+  while (true)
+    {
+      ssize_t n = recv (s, reply + len, sizeof reply - 1 - len, 0);
+      if (n < 0 && errno == EINTR)
+	continue;
+      if (n <= 0)
+	break;
+      len += n;
+      reply[len] = '\0';
+      char *nl;
+      while ((nl = strchr (reply, '\n')))
+	{
+	  intmax_t value;
+	  if (sscanf (reply, "-emacs-pid %"SCNdMAX, &value) == 1)
+	    {
+	      batch_pid = value;
+	      if (batch_signal)
+		kill (batch_pid, batch_signal);
+	    }
+	  else if (sscanf (reply, "-exit %"SCNdMAX, &value) == 1)
+	    return value;
+	  len -= nl + 1 - reply;
+	  memmove (reply, nl + 1, len + 1);
+	}
+      if (len == sizeof reply - 1)
+	break;
+    }
+
+  message (true, "%s: Emacs exited without reporting a status\n", progname);
+  return EXIT_FAILURE;
+}
 #endif /* SOCKETS_IN_FILE_SYSTEM */
 
 static HSOCKET
@@ -1990,6 +2128,11 @@ main (int argc, char **argv)
   /* Process options.  */
   decode_options (argc, argv);
 
+#ifdef SOCKETS_IN_FILE_SYSTEM
+  if (batch)
+    exit (batch_request (argc - optind, argv + optind));
+#endif
+
   if (! (optind < argc || eval || create_frame))
     {
       message (true, ("%s: file name or argument required\n"
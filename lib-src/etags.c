@@ -125,6 +125,17 @@ Copyright (C) 1984, 1987-1989, 1993-1995, 1998-2025 Free Software
 #include <assert.h>
 #include <getopt.h>
 #include <regex.h>
+#include <sys/stat.h>
+#include <stat-time.h>
+#include <timespec.h>
+
+/* Whether -j can parse files in parallel worker processes.  */
+#if !MSDOS && !defined DOS_NT
+# define PARALLEL_ETAGS true
+# include <sys/wait.h>
+#else
+# define PARALLEL_ETAGS false
+#endif
 
 /* Define MERCURY_HEURISTICS_RATIO as it was necessary to disambiguate
    Mercury from Objective C, which have same file extensions .m
@@ -275,6 +286,7 @@ #define xrnew(op, n, m) ((op) = xnrealloc (op, n, (m) * sizeof *(op)))
   char *prop;			/* file properties to write in tagfile */
   bool usecharno;		/* etags tags shall contain char number */
   bool written;			/* entry written in the tags file */
+  ptrdiff_t job_index;		/* with -j, the index of the file argument */
 } fdesc;
 
 typedef struct node_st
@@ -386,9 +398,18 @@ #define xrnew(op, n, m) ((op) = xnrealloc (op, n, (m) * sizeof *(op)))
 static _Noreturn void pfatal (const char *);
 static void add_node (node *, node **);
 
+static void process_arguments (argument *, linebuffer *, int);
 static void process_file_name (char *, language *);
 static void process_file (FILE *, char *, language *);
+static void read_old_tags (void);
+static bool reuse_old_section (FILE *, fdesc *);
+#if PARALLEL_ETAGS
+static void run_jobs (argument *, linebuffer *);
+static void worker_process_file_name (ptrdiff_t, char *, language *);
+static bool tagged_by_other_job (char *);
+#endif
 static void find_entries (FILE *);
+static void reset_input (FILE *);
 static void free_tree (node *);
 static void free_fdesc (fdesc *);
 static void pfnote (char *, bool, char *, ptrdiff_t, intmax_t, intmax_t);
@@ -432,6 +453,8 @@ #define xrnew(op, n, m) ((op) = xnrealloc (op, n, (m) * sizeof *(op)))
 
 static fdesc *fdhead;		/* head of file description list */
 static fdesc *curfdp;		/* current file description */
+static ptrdiff_t worker_file_index; /* with -j, the index of the current
+				       file argument */
 static char *infilename;	/* current input file name */
 static intmax_t lineno;		/* line number of current line */
 static intmax_t charno;		/* current character number */
@@ -474,6 +497,8 @@ #define xrnew(op, n, m) ((op) = xnrealloc (op, n, (m) * sizeof *(op)))
 static int fallback_lang;	/* --(no-)fallback-lang: Fortran/C fallbacks */
 static int empty_files;		/* --(no-)empty-file-entries */
 static bool parsing_stdin;	/* --parse-stdin used */
+static int incremental;		/* --incremental: reuse unchanged sections */
+static int jobs = 1;		/* -j: number of parallel worker processes */
 
 /* For long options that have no equivalent short option, use a
    non-character as a pseudo short option, starting with CHAR_MAX + 1.  */
@@ -529,6 +554,8 @@ #define xrnew(op, n, m) ((op) = xnrealloc (op, n, (m) * sizeof *(op)))
   { "fallback-lang",      no_argument,       &fallback_lang,     1     },
   { "no-empty-file-entries", no_argument,    &empty_files,       0     },
   { "empty-file-entries", no_argument,       &empty_files,       1     },
+  { "incremental",        no_argument,       &incremental,       1     },
+  { "jobs",               required_argument, NULL,               'j'   },
 
   { NULL }
 };
@@ -1016,6 +1043,15 @@ print_help (argument *argbuffer)
         a tag, one should also consult the tags file FILE after\n\
         checking the current file.");
 
+  if (!ctags)
+    {
+      puts ("--incremental\n\
+        Copy the entries of the files that did not change since the tags\n\
+        file was last written from that file instead of parsing them again.");
+      puts ("-j N, --jobs=N\n\
+        Parse the files in N parallel processes.");
+    }
+
   puts ("-l LANG, --language=LANG\n\
         Force the following files to be considered as written in the\n\
 	named language up to the next --language=LANG option.");
@@ -1185,7 +1221,7 @@ main (int argc, char **argv)
 
   /* When the optstring begins with a '-' getopt_long does not rearrange the
      non-options arguments to be at the end, but leaves them alone. */
-  static char const optstring[] = "-aBc:CdDf:hHi:Il:o:Qr:RStTuvVwx";
+  static char const optstring[] = "-aBc:CdDf:hHi:Ij:l:o:Qr:RStTuvVwx";
 
   while ((opt = getopt_long (argc, argv, optstring, longopts, NULL)) != EOF)
     switch (opt)
@@ -1284,6 +1320,15 @@ main (int argc, char **argv)
 	/* Etags options */
       case 'D': constantypedefs = false;			break;
       case 'i': included_files[nincluded_files++] = optarg;	break;
+      case 'j':
+	{
+	  char *end;
+	  long n = strtol (optarg, &end, 10);
+	  if (*end || n < 1 || INT_MAX < n)
+	    fatal ("invalid number of jobs: %s", optarg);
+	  jobs = n;
+	}
+	break;
 
 	/* Ctags options. */
       case 'B': searchar = '?';					break;
@@ -1354,7 +1399,12 @@ main (int argc, char **argv)
 	  set_binary_mode (STDOUT_FILENO, O_BINARY);
 	}
       else
-	tagf = fopen (tagfile, append_to_tagfile ? "ab" : "wb");
+	{
+	  /* Remember the old sections before truncating the file.  */
+	  if (incremental && !append_to_tagfile)
+	    read_old_tags ();
+	  tagf = fopen (tagfile, append_to_tagfile ? "ab" : "wb");
+	}
       if (tagf == NULL)
 	pfatal (tagfile);
     }
@@ -1362,42 +1412,12 @@ main (int argc, char **argv)
   /*
    * Loop through files finding functions.
    */
-  for (i = 0; i < current_arg; i++)
-    {
-      static language *lang;	/* non-NULL if language is forced */
-      char *this_file;
-
-      switch (argbuffer[i].arg_type)
-	{
-	case at_language:
-	  lang = argbuffer[i].lang;
-	  break;
-	case at_regexp:
-	  analyze_regex (argbuffer[i].what);
-	  break;
-	case at_filename:
-	      this_file = argbuffer[i].what;
-	      /* Input file named "-" means read file names from stdin
-		 (one per line) and use them. */
-	      if (streq (this_file, "-"))
-		{
-		  if (parsing_stdin)
-		    fatal ("cannot parse standard input "
-			   "AND read file names from it");
-		  while (readline_internal (&filename_lb, stdin, "-", false) > 0)
-		    process_file_name (filename_lb.buffer, lang);
-		}
-	      else
-		process_file_name (this_file, lang);
-	  break;
-        case at_stdin:
-          this_file = argbuffer[i].what;
-          process_file (stdin, this_file, lang);
-          break;
-	default:
-	  error ("internal error: arg_type");
-	}
-    }
+#if PARALLEL_ETAGS
+  if (!ctags && 1 < jobs && !parsing_stdin)
+    run_jobs (argbuffer, &filename_lb);
+  else
+#endif
+    process_arguments (argbuffer, &filename_lb, -1);
 
   free_regexps ();
   free (lb.buffer);
@@ -1663,6 +1683,58 @@ get_language_from_filename (char *file, bool case_sensitive)
 }
 
 
+/* Process the arguments in ARGBUFFER, up to the one of type at_end.
+   If WORKER is nonnegative, process only the file names that are
+   assigned to the parallel worker WORKER, see run_jobs.  FILENAME_LB
+   is used to read file names from stdin.  */
+static void
+process_arguments (argument *argbuffer, linebuffer *filename_lb, int worker)
+{
+  language *lang = NULL;	/* non-NULL if language is forced */
+  ptrdiff_t file_index = 0;
+
+  for (; argbuffer->arg_type != at_end; argbuffer++)
+    {
+      char *this_file;
+
+      switch (argbuffer->arg_type)
+	{
+	case at_language:
+	  lang = argbuffer->lang;
+	  break;
+	case at_regexp:
+	  analyze_regex (argbuffer->what);
+	  break;
+	case at_filename:
+	      this_file = argbuffer->what;
+	      /* Input file named "-" means read file names from stdin
+		 (one per line) and use them. */
+	      if (worker < 0 && streq (this_file, "-"))
+		{
+		  if (parsing_stdin)
+		    fatal ("cannot parse standard input "
+			   "AND read file names from it");
+		  while (readline_internal (filename_lb, stdin, "-", false) > 0)
+		    process_file_name (filename_lb->buffer, lang);
+		}
+	      else if (worker < 0)
+		process_file_name (this_file, lang);
+#if PARALLEL_ETAGS
+	      else if (file_index % jobs == worker)
+		worker_process_file_name (file_index, this_file, lang);
+#endif
+	      file_index++;
+	  break;
+        case at_stdin:
+          this_file = argbuffer->what;
+          process_file (stdin, this_file, lang);
+          break;
+	default:
+	  error ("internal error: arg_type");
+	}
+    }
+}
+
 /*
  * This routine is called on each file argument.
  */
@@ -1848,10 +1920,14 @@ process_file (FILE *fh, char *fn, language *lang)
   fdp->usecharno = true;	/* use char position when making tags */
   fdp->prop = NULL;
   fdp->written = false;		/* not written on tags file yet */
+  fdp->job_index = worker_file_index;
 
   fdhead = fdp;
   curfdp = fdhead;		/* the current file description */
 
+  if (fh != stdin && reuse_old_section (fh, fdp))
+    return;
+
   find_entries (fh);
 
   /* If not Ctags, and if this is not metasource and if it contained no #line
@@ -1889,6 +1965,522 @@ process_file (FILE *fh, char *fn, language *lang)
     }
 }
 
+/* A section of the old tags file, see read_old_tags.  */
+typedef struct
+{
+  char *name;			/* the file name of the section */
+  char *text;			/* the section, starting with its form feed */
+  ptrdiff_t size;		/* the size of TEXT, or -1 if the name is
+				   not unique */
+} old_section;
+
+static old_section *old_sections;
+static ptrdiff_t *old_section_table; /* open hash table of indices into
+					OLD_SECTIONS, -1 for empty slots */
+static size_t old_section_mask;	/* the size of OLD_SECTION_TABLE - 1 */
+static struct timespec old_tags_mtime; /* when the old tags were written */
+
+static size_t
+hash_file_name (char const *name)
+{
+  size_t h = 0;
+  for (; *name; name++)
+    h = h * 31 + (unsigned char) *name;
+  return h;
+}
+
+/* Return the slot of OLD_SECTION_TABLE that holds NAME, or the empty
+   slot where it belongs.  */
+static ptrdiff_t *
+old_section_slot (char const *name)
+{
+  for (size_t i = hash_file_name (name) & old_section_mask; ;
+       i = (i + 1) & old_section_mask)
+    {
+      ptrdiff_t j = old_section_table[i];
+      if (j < 0 || streq (old_sections[j].name, name))
+	return &old_section_table[i];
+    }
+}
+
+/* For --incremental, read the tags file that is about to be
+   overwritten and index its sections by file name, so that
+   reuse_old_section can copy the sections of unchanged files.  */
+static void
+read_old_tags (void)
+{
+  FILE *f = fopen (tagfile, "r" FOPEN_BINARY);
+  struct stat st;
+  if (!f)
+    return;
+  if (fstat (fileno (f), &st) != 0 || !S_ISREG (st.st_mode)
+      || PTRDIFF_MAX <= st.st_size)
+    {
+      fclose (f);
+      return;
+    }
+
+  char *buf = xmalloc (st.st_size + 1);
+  ptrdiff_t nread = fread (buf, 1, st.st_size, f);
+  fclose (f);
+  char *end = buf + nread;
+  ptrdiff_t nsections = 0, nalloc = 0;
+
+  for (char *p = buf; p < end; )
+    {
+      /* Each section starts with a form feed line followed by a
+	 "NAME,SIZE" header line.  */
+      if (! (p[0] == '\f' && p + 1 < end && p[1] == '\n'))
+	break;
+      char *header = p + 2;
+      char *eol = memchr (header, '\n', end - header);
+      if (!eol)
+	break;
+      char *comma = eol;
+      while (header < comma && *comma != ',')
+	comma--;
+      if (comma == header)
+	break;
+
+      /* Find the start of the next section.  */
+      char *next = eol + 1;
+      while (next < end && ! (next[0] == '\f' && next + 1 < end
+			      && next[1] == '\n'))
+	{
+	  char *nl = memchr (next, '\n', end - next);
+	  next = nl ? nl + 1 : end;
+	}
+
+      /* Only sections with tags are worth reusing; the entry of a file
+	 without tags is cheap to recreate.  */
+      if (eol + 1 < next && !strneq (comma + 1, "include\n", 8))
+	{
+	  if (nsections == nalloc)
+	    xrnew (old_sections, nalloc = 2 * nalloc + 16, 1);
+	  old_sections[nsections].name = savenstr (header, comma - header);
+	  old_sections[nsections].text = p;
+	  old_sections[nsections].size = next - p;
+	  nsections++;
+	}
+      p = next;
+    }
+
+  if (nsections == 0)
+    {
+      free (buf);
+      return;
+    }
+
+  size_t table_size = 2;
+  while (table_size < 2 * nsections)
+    table_size *= 2;
+  old_section_mask = table_size - 1;
+  old_section_table = xnmalloc (table_size, sizeof *old_section_table);
+  for (size_t i = 0; i < table_size; i++)
+    old_section_table[i] = -1;
+  for (ptrdiff_t j = 0; j < nsections; j++)
+    {
+      ptrdiff_t *slot = old_section_slot (old_sections[j].name);
+      if (*slot < 0)
+	*slot = j;
+      else
+	old_sections[*slot].size = -1;
+    }
+  old_tags_mtime = get_stat_mtime (&st);
+}
+
+/* Return true if the input file FH has #line directives, which may
+   attribute some of its tags to the sections of other files.  */
+static bool
+has_line_directives (FILE *fh)
+{
+  static char const directive[] = "#line ";
+  int matched = 0;		/* the length of the directive matched at
+				   the start of this line, or -1 */
+  int c;
+
+  while ((c = getc (fh)) != EOF)
+    if (0 <= matched && c == directive[matched])
+      {
+	if (++matched == sizeof directive - 1)
+	  break;
+      }
+    else
+      matched = c == '\n' ? 0 : -1;
+  reset_input (fh);
+  return c != EOF;
+}
+
+/* If the input file FH, described by FDP, has not been modified since
+   the old tags file was written, copy its section from there and
+   return true.  */
+static bool
+reuse_old_section (FILE *fh, fdesc *fdp)
+{
+  struct stat st;
+  if (!old_section_table
+      || fstat (fileno (fh), &st) != 0 || !S_ISREG (st.st_mode)
+      || 0 <= timespec_cmp (get_stat_mtime (&st), old_tags_mtime))
+    return false;
+
+  /* Metasource files are related to the files generated from them,
+     see find_entries.  */
+  language *lang = (fdp->lang ? fdp->lang
+		    : get_language_from_filename (fdp->infname, true));
+  if (lang && lang->metasource)
+    return false;
+
+  ptrdiff_t j = *old_section_slot (fdp->taggedfname);
+  if (j < 0 || old_sections[j].size < 0
+      || (!no_line_directive && has_line_directives (fh)))
+    return false;
+
+  fwrite (old_sections[j].text, 1, old_sections[j].size, tagf);
+  fdp->written = true;
+  return true;
+}
+
+#if PARALLEL_ETAGS
+
+/* With -j, each worker process writes the tags of the files assigned
+   to it to a temporary data file, and records in a temporary chunk
+   file where the output for each of these files is.  The parent then
+   copies these chunks to the tags file in the order in which they
+   would have been written sequentially.  */
+typedef struct
+{
+  ptrdiff_t file_index;		/* the index of the file */
+  off_t start;			/* where the chunk starts in the data file */
+  off_t size;			/* its size */
+  char kind;			/* 'S' for the tags written while parsing,
+				   'T' for the tags written at the end,
+				   'E' for the entry of a file without tags */
+} tag_chunk;
+
+static FILE *chunkf;		/* the chunk file of a worker */
+
+/* A file name argument of run_jobs.  */
+typedef struct
+{
+  char *name;			/* the uncompressed name */
+  ptrdiff_t position;		/* the index of the argument or file */
+} file_arg;
+
+static file_arg *job_files;	/* the absolute names of all the files,
+				   sorted */
+static ptrdiff_t njob_files;	/* the length of JOB_FILES */
+
+static int
+compare_file_arg_names (void const *a, void const *b)
+{
+  file_arg const *fa = a, *fb = b;
+  return strcmp (fa->name, fb->name);
+}
+
+static int
+compare_file_args (void const *a, void const *b)
+{
+  file_arg const *fa = a, *fb = b;
+  int cmp = strcmp (fa->name, fb->name);
+  return (cmp ? cmp
+	  : (fa->position > fb->position) - (fa->position < fb->position));
+}
+
+/* Return the index of the file argument whose absolute name is
+   ABSNAME if another worker tags it, -1 otherwise.  */
+static ptrdiff_t
+other_job_file_index (char *absname, ptrdiff_t file_index)
+{
+  file_arg key = { absname };
+  file_arg *f = (njob_files == 0 ? NULL
+		 : bsearch (&key, job_files, njob_files, sizeof *job_files,
+			    compare_file_arg_names));
+  return f && f->position % jobs != file_index % jobs ? f->position : -1;
+}
+
+/* Return true if the tags that a #line directive attributes to the
+   file ABSNAME should be discarded because another worker already
+   tagged that file, as the sequential code does.  */
+static bool
+tagged_by_other_job (char *absname)
+{
+  ptrdiff_t i = other_job_file_index (absname, worker_file_index);
+  return 0 <= i && i < worker_file_index;
+}
+
+/* Return true if FDP, created by a #line directive, is for a
+   metasource file that another worker tags after the file containing
+   the directive.  find_entries would have deleted it sequentially.  */
+static bool
+superseded_by_other_job (fdesc *fdp)
+{
+  char *absname = absolute_filename (fdp->taggedfname, tagfiledir);
+  ptrdiff_t i = (streq (absname, fdp->infabsname) ? -1
+		 : other_job_file_index (absname, fdp->job_index));
+  language *lang = (fdp->job_index < i
+		    ? get_language_from_filename (absname, true) : NULL);
+  free (absname);
+  return lang && lang->metasource;
+}
+
+/* Record that the data written to TAGF since START is a chunk of kind
+   KIND for the file with index FILE_INDEX.  */
+static void
+record_chunk (ptrdiff_t file_index, char kind, off_t start)
+{
+  tag_chunk chunk = { file_index, start, ftello (tagf) - start, kind };
+  if (chunk.size != 0 && fwrite (&chunk, sizeof chunk, 1, chunkf) != 1)
+    pfatal ("chunk file");
+}
+
+/* Process FILE, the file with index FILE_INDEX, in a worker.  */
+static void
+worker_process_file_name (ptrdiff_t file_index, char *file, language *lang)
+{
+  off_t start = ftello (tagf);
+  worker_file_index = file_index;
+  process_file_name (file, lang);
+  record_chunk (file_index, 'S', start);
+}
+
+/* In a worker, write the tags that were not written yet and the
+   entries of the files without tags, like main does sequentially,
+   and record them as chunks.  */
+static void
+worker_finish (void)
+{
+  if (!no_line_directive)
+    {
+      fdesc **fdpp = &fdhead;
+      while (*fdpp != NULL)
+	if (superseded_by_other_job (*fdpp))
+	  {
+	    fdesc *badfdp = *fdpp;
+	    invalidate_nodes (badfdp, &nodehead);
+	    *fdpp = badfdp->next;
+	    free_fdesc (badfdp);
+	  }
+	else
+	  fdpp = &(*fdpp)->next;
+    }
+
+  node *np = nodehead;
+  while (np)
+    {
+      /* Each sublist holds the tags of one file, see add_node.  */
+      node *next = np->left;
+      off_t start = ftello (tagf);
+      np->left = NULL;
+      put_entries (np);
+      record_chunk (np->fdp->job_index, 'T', start);
+      np = next;
+    }
+  if (empty_files)
+    for (fdesc *fdp = fdhead; fdp != NULL; fdp = fdp->next)
+      if (!fdp->written)
+	{
+	  off_t start = ftello (tagf);
+	  fprintf (tagf, "\f\n%s,0\n", fdp->taggedfname);
+	  record_chunk (fdp->job_index, 'E', start);
+	}
+  if (fflush (tagf) != 0 || fflush (chunkf) != 0)
+    pfatal ("tmpfile");
+}
+
+/* Read all the chunks recorded in F into a new array, and store its
+   length in *NCHUNKS.  */
+static tag_chunk *
+read_chunks (FILE *f, ptrdiff_t *nchunks)
+{
+  off_t size = ftello (f);
+  tag_chunk *chunks = xmalloc (size + 1);
+  *nchunks = size / sizeof *chunks;
+  rewind (f);
+  if (fread (chunks, sizeof *chunks, *nchunks, f) != *nchunks)
+    pfatal ("chunk file");
+  return chunks;
+}
+
+/* Copy CHUNK from the data file DATA to the tags file.  */
+static void
+copy_chunk (FILE *data, tag_chunk const *chunk)
+{
+  char buf[BUFSIZ];
+  if (fseeko (data, chunk->start, SEEK_SET) != 0)
+    pfatal ("data file");
+  for (off_t left = chunk->size; 0 < left; )
+    {
+      size_t n = fread (buf, 1, left < sizeof buf ? left : sizeof buf, data);
+      if (n == 0)
+	pfatal ("data file");
+      fwrite (buf, 1, n, tagf);
+      left -= n;
+    }
+}
+
+
+/* Parse the file names in ARGBUFFER in JOBS worker processes, and
+   merge their output into the tags file.  FILENAME_LB is used to read
+   file names from stdin.  */
+static void
+run_jobs (argument *argbuffer, linebuffer *filename_lb)
+{
+  /* Replace "-" by the file names read from stdin, and drop the names
+     that process_file_name would skip as duplicates, so that each
+     worker sees only its share of the files.  */
+  ptrdiff_t nargs = 0, nalloc = 0, nfiles = 0;
+  argument *args = NULL;
+  for (argument *arg = argbuffer; ; arg++)
+    {
+      bool from_stdin = (arg->arg_type == at_filename
+			 && streq (arg->what, "-"));
+      do
+	{
+	  if (nargs == nalloc)
+	    xrnew (args, nalloc = 2 * nalloc + 16, 1);
+	  args[nargs] = *arg;
+	  if (from_stdin)
+	    {
+	      if (readline_internal (filename_lb, stdin, "-", false) <= 0)
+		break;
+	      args[nargs].what = savestr (filename_lb->buffer);
+	    }
+	  if (args[nargs].arg_type == at_filename)
+	    {
+	      canonicalize_filename (args[nargs].what);
+	      nfiles++;
+	    }
+	  nargs++;
+	}
+      while (from_stdin);
+      if (arg->arg_type == at_end)
+	break;
+    }
+
+  file_arg *files = xnmalloc (nfiles, sizeof *files);
+  ptrdiff_t n = 0;
+  for (ptrdiff_t i = 0; i < nargs; i++)
+    if (args[i].arg_type == at_filename)
+      {
+	char *ext;
+	files[n].name = args[i].what;
+	if (get_compressor_from_suffix (files[n].name, &ext))
+	  files[n].name = savenstr (files[n].name, ext - files[n].name);
+	files[n++].position = i;
+      }
+  qsort (files, n, sizeof *files, compare_file_args);
+  for (ptrdiff_t i = n - 1; 0 <= i; i--)
+    {
+      char **what = &args[files[i].position].what;
+      bool duplicate = 0 < i && streq (files[i].name, files[i - 1].name);
+      if (files[i].name != *what)
+	free (files[i].name);
+      if (duplicate)
+	*what = NULL;
+    }
+  ptrdiff_t kept = 0;
+  nfiles = 0;
+  for (ptrdiff_t i = 0; i < nargs; i++)
+    if (! (args[i].arg_type == at_filename && !args[i].what))
+      {
+	if (args[i].arg_type == at_filename)
+	  {
+	    char *ext, *name = args[i].what;
+	    if (get_compressor_from_suffix (name, &ext))
+	      name = savenstr (name, ext - name);
+	    files[nfiles].name = absolute_filename (name, cwd);
+	    files[nfiles].position = nfiles;
+	    nfiles++;
+	    if (name != args[i].what)
+	      free (name);
+	  }
+	args[kept++] = args[i];
+      }
+  qsort (files, nfiles, sizeof *files, compare_file_args);
+  job_files = files;
+  njob_files = nfiles;
+
+  FILE **data = xnmalloc (jobs, 2 * sizeof *data);
+  FILE **chunks = data + jobs;
+  pid_t *pids = xnmalloc (jobs, sizeof *pids);
+  fflush (NULL);
+  for (int w = 0; w < jobs; w++)
+    {
+      data[w] = tmpfile ();
+      chunks[w] = tmpfile ();
+      if (!data[w] || !chunks[w])
+	pfatal ("tmpfile");
+      pids[w] = fork ();
+      if (pids[w] < 0)
+	pfatal ("fork");
+      if (pids[w] == 0)
+	{
+	  tagf = data[w];
+	  chunkf = chunks[w];
+	  process_arguments (args, filename_lb, w);
+
+	  worker_finish ();
+	  exit (EXIT_SUCCESS);
+	}
+    }
+
+  bool failed = false;
+  for (int w = 0; w < jobs; w++)
+    {
+      int status;
+      while (waitpid (pids[w], &status, 0) < 0)
+	if (errno != EINTR)
+	  pfatal ("waitpid");
+      failed |= !WIFEXITED (status) || WEXITSTATUS (status) != EXIT_SUCCESS;
+    }
+  if (failed)
+    fatal ("a worker process failed");
+
+  /* Copy the chunks in the order in which the sequential code would
+     have written them: first the sections written while parsing each
+     file, then the tags that were kept until the end, and finally the
+     entries of the files without tags, in reverse order.  Within each
+     worker, the chunks of each kind are already in that order.  */
+  tag_chunk **worker_chunks = xnmalloc (jobs, sizeof *worker_chunks);
+  ptrdiff_t *nchunks = xnmalloc (jobs, 2 * sizeof *nchunks);
+  ptrdiff_t *next = nchunks + jobs;
+  for (int w = 0; w < jobs; w++)
+    {
+      worker_chunks[w] = read_chunks (chunks[w], &nchunks[w]);
+      next[w] = 0;
+    }
+  for (char const *kind = "STE"; *kind; kind++)
+    for (ptrdiff_t k = 0; k < nfiles; k++)
+      {
+	ptrdiff_t i = *kind == 'E' ? nfiles - 1 - k : k;
+	int w = i % jobs;
+	for (; next[w] < nchunks[w]; next[w]++)
+	  {
+	    tag_chunk *c = &worker_chunks[w][next[w]];
+	    if (c->kind != *kind || c->file_index != i)
+	      break;
+	    copy_chunk (data[w], c);
+	  }
+      }
+
+  for (int w = 0; w < jobs; w++)
+    {
+      fclose (data[w]);
+      fclose (chunks[w]);
+      free (worker_chunks[w]);
+    }
+  for (ptrdiff_t i = 0; i < nfiles; i++)
+    free (files[i].name);
+  free (files);
+  free (worker_chunks);
+  free (nchunks);
+  free (data);
+  free (pids);
+  free (args);
+}
+
+#endif /* PARALLEL_ETAGS */
+
 static void
 reset_input (FILE *inf)
 {
@@ -7651,6 +8243,15 @@ readline (linebuffer *lbp, FILE *stream)
 			      free (taggedfname);
 			      break;
 			    }
+#if PARALLEL_ETAGS
+		      /* Likewise if another worker tags it.  */
+		      if (fdp == NULL && tagged_by_other_job (taggedabsname))
+			{
+			  discard_until_line_directive = true;
+			  free (taggedfname);
+			  fdp = curfdp;	/* do not create a description */
+			}
+#endif
 		      /* Else create a new file description and use that from
 			 now on, until the next #line directive. */
 		      if (fdp == NULL) /* not found */
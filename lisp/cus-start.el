@@ -89,6 +89,12 @@ minibuffer-prompt-properties--setter
 	     (gc-cons-threshold alloc integer)
 	     (gc-cons-percentage alloc float)
 	     (garbage-collection-messages alloc boolean)
+	     (gc-idle-delay alloc
+			    (choice (const :tag "Never" nil)
+				    (number :tag "Seconds"))
+			    "31.1")
+	     (gc-idle-factor alloc integer "31.1")
+	     (gc-parallel-sweep alloc boolean "31.1")
 	     ;; buffer.c
 	     (cursor-type display ,cursor-type-types)
 	     (mode-line-format mode-line sexp) ;Hard to do right.
@@ -269,6 +275,10 @@ minibuffer-prompt-properties--setter
 	     ;; fileio.c
 	     (delete-by-moving-to-trash auto-save boolean "23.1")
 	     (auto-save-visited-file-name auto-save boolean)
+	     (file-attribute-cache-ttl files
+				       (choice (const :tag "Off" nil)
+					       (number :tag "Seconds"))
+				       "31.1")
 	     ;; filelock.c
 	     (create-lockfiles files boolean "24.3")
 	     (temporary-file-directory
@@ -408,6 +418,7 @@ minibuffer-prompt-properties--setter
 	     ;;    			(const :tag " current dir" nil)
 	     ;;    			(directory :format "%v"))))
 	     (load-prefer-newer lisp boolean "24.4")
+	     (load-path-cache lisp boolean "31.1")
              (record-all-keys keyboard boolean)
 	     ;; minibuf.c
 	     (minibuffer-follows-selected-frame
@@ -609,6 +620,11 @@ minibuffer-prompt-properties--setter
                function))
 	     ;; undo.c
 	     (undo-limit undo integer "27.1")
+	     (undo-compressed-limit undo
+				    (choice (const :tag "Off" nil)
+					    (const :tag "No limit" t)
+					    integer)
+				    "31.1")
 	     (undo-strong-limit undo integer "27.1")
 	     (undo-outer-limit undo
 			       (choice integer
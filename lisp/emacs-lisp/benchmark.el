@@ -172,6 +172,58 @@ benchmark-progn
        ;; Return the value of the body.
        ,value)))
 
+;;;###autoload
+(defun benchmark-redisplay (file &optional frames)
+  "Measure redisplay while scrolling through FILE.
+Visit FILE in the selected window, then scroll forward by one
+screen at a time and force a redisplay after each scroll, for at
+most FRAMES redisplays (default 500) or until the end of the buffer.
+Interactively, FRAMES is the prefix argument.
+
+Display a summary of the distribution of the time taken by each
+redisplay, and return it as a plist with the keys `:frames',
+`:total', `:min', `:median', `:p90', `:p99' and `:max'.  Times are
+in seconds.
+
+In batch mode, this redisplays the initial frame, whose glyphs are
+only produced in memory, so it needs no display."
+  (interactive "fBenchmark redisplay of file: \nP")
+  (let ((frames (if frames (prefix-numeric-value frames) 500))
+        (redisplay-skip-initial-frame
+         (and (not noninteractive) redisplay-skip-initial-frame))
+        (times nil))
+    (save-window-excursion
+      (switch-to-buffer (find-file-noselect file))
+      (goto-char (point-min))
+      (set-window-start nil (point-min))
+      (redisplay t)
+      (garbage-collect)
+      (catch 'done
+        (dotimes (_ frames)
+          (condition-case nil
+              (scroll-up)
+            (end-of-buffer (throw 'done nil)))
+          (push (benchmark-elapse (redisplay t)) times))))
+    (unless times
+      (user-error "Nothing to redisplay in %s" file))
+    (let* ((sorted (vconcat (sort times #'<)))
+           (n (length sorted))
+           (quantile (lambda (q)
+                       (aref sorted (min (1- n) (floor (* q n))))))
+           (result (list :frames n
+                         :total (apply #'+ times)
+                         :min (aref sorted 0)
+                         :median (funcall quantile 0.5)
+                         :p90 (funcall quantile 0.9)
+                         :p99 (funcall quantile 0.99)
+                         :max (aref sorted (1- n)))))
+      (message "%d redisplays in %fs: min %fs, median %fs, \
+90%% %fs, 99%% %fs, max %fs"
+               n (plist-get result :total) (plist-get result :min)
+               (plist-get result :median) (plist-get result :p90)
+               (plist-get result :p99) (plist-get result :max))
+      result)))
+
 (provide 'benchmark)
 
 ;;; benchmark.el ends here
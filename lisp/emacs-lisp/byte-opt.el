@@ -1832,8 +1832,8 @@ byte-optimize-set
          previous-single-char-property-change previous-single-property-change
          text-properties-at text-property-any text-property-not-all
          ;; thread.c
-         all-threads condition-mutex condition-name mutex-name thread-live-p
-         thread-name
+         all-threads channel-name condition-mutex condition-name mutex-name
+         thread-live-p thread-name
          ;; timefns.c
          current-cpu-time
          current-time-string current-time-zone decode-time encode-time
@@ -1907,6 +1907,8 @@ byte-optimize-set
          imagep
          ;; indent.c
          current-column current-indentation
+         ;; json.c
+         json-parser-p
          ;; keyboard.c
          current-idle-time current-input-mode recent-keys recursion-depth
          this-command-keys this-command-keys-vector this-single-command-keys
@@ -1918,12 +1920,14 @@ byte-optimize-set
          minibuffer-prompt minibuffer-prompt-end
          ;; process.c
          process-list processp signal-names waiting-for-user-input-p
+         ;; region-cache.c
+         region-cache-p
          ;; sqlite.c
          sqlite-available-p sqlitep
          ;; syntax.c
          standard-syntax-table syntax-table syntax-table-p
          ;; thread.c
-         current-thread
+         channelp current-thread
          ;; timefns.c
          current-time
          ;; window.c
@@ -2033,10 +2037,21 @@ disassemble-offset
 	 (+ (aref bytes bytedecomp-ptr)
 	    (progn (setq bytedecomp-ptr (1+ bytedecomp-ptr))
 		   (ash (aref bytes bytedecomp-ptr) 8))))
-	((and (>= bytedecomp-op byte-listN)
-	      (<= bytedecomp-op byte-discardN))
+	((or (and (>= bytedecomp-op byte-listN)
+	          (<= bytedecomp-op byte-discardN))
+             (eq bytedecomp-op byte-varref-car))
 	 (setq bytedecomp-ptr (1+ bytedecomp-ptr)) ;Offset in next byte.
-	 (aref bytes bytedecomp-ptr))))
+	 (aref bytes bytedecomp-ptr))
+        ((eq bytedecomp-op byte-dup-goto-if-nil)
+	 ;; Offset in next 2 bytes.
+	 (setq bytedecomp-ptr (1+ bytedecomp-ptr))
+	 (+ (aref bytes bytedecomp-ptr)
+	    (progn (setq bytedecomp-ptr (1+ bytedecomp-ptr))
+		   (ash (aref bytes bytedecomp-ptr) 8))))
+        ((eq bytedecomp-op byte-stack-ref-call)
+	 ;; Stack offset and number of arguments in next 2 bytes.
+	 (setq bytedecomp-ptr (+ bytedecomp-ptr 2))
+	 (cons (aref bytes (1- bytedecomp-ptr)) (aref bytes bytedecomp-ptr)))))
 
 (defvar byte-compile-tag-number)
 
@@ -2063,7 +2078,7 @@ byte-decompile-bytecode
 (defun byte-decompile-bytecode-1 (bytes constvec &optional make-spliceable)
   (let ((length (length bytes))
         (bytedecomp-ptr 0) optr tags bytedecomp-op offset
-	lap tmp last-constant)
+	lap tmp last-constant second)
     (while (not (= bytedecomp-ptr length))
       (or make-spliceable
 	  (push bytedecomp-ptr lap))
@@ -2074,6 +2089,21 @@ byte-decompile-bytecode-1
       (let ((opcode (aref byte-code-vector bytedecomp-op)))
 	(cl-assert opcode)
 	(setq bytedecomp-op opcode))
+      ;; Split a superinstruction into its two instructions.  The
+      ;; second one gets no pc, as nothing can jump to it.
+      (setq second nil)
+      (pcase bytedecomp-op
+        ('byte-varref-car
+         (setq bytedecomp-op 'byte-varref
+               second '(byte-car . 0)))
+        ('byte-dup-goto-if-nil
+         (setq bytedecomp-op 'byte-goto-if-nil)
+         (push (cons optr (cons 'byte-dup 0)) lap)
+         (setq optr nil))
+        ('byte-stack-ref-call
+         (setq bytedecomp-op 'byte-stack-ref
+               second (cons 'byte-call (cdr offset))
+               offset (car offset))))
       (cond ((memq bytedecomp-op byte-goto-ops)
 	     ;; It's a pc.
 	     (setq offset
@@ -2134,6 +2164,8 @@ byte-decompile-bytecode-1
       ;; lap = ( [ (pc . (op . arg)) ]* )
       (push (cons optr (cons bytedecomp-op (or offset 0)))
             lap)
+      (when second
+        (push (cons nil second) lap))
       (setq bytedecomp-ptr (1+ bytedecomp-ptr)))
     (let ((rest lap))
       (while rest
@@ -923,7 +923,19 @@ 183
  "to take a hash table and a value from the stack, and jump to
 the address the value maps to, if any.")
 
-;; unused: 184-191
+;; The following are superinstructions, which `byte-compile-lapcode'
+;; emits for common sequences of two instructions.  They never appear
+;; in lapcode, and `byte-decompile-bytecode' turns them back into the
+;; two instructions.
+(byte-defop 184  1 byte-varref-car "for `varref', then `car'")
+(byte-defop 185  0 byte-dup-goto-if-nil "for `dup', then `goto-if-nil'")
+(byte-defop 186 nil byte-stack-ref-call "for `stack-ref', then `call'")
+
+(defconst byte-fused-ops '(byte-varref-car byte-dup-goto-if-nil
+                           byte-stack-ref-call)
+  "List of superinstructions, which combine two byte-codes.")
+
+;; unused: 187-191
 
 (byte-defop 192  1 byte-constant	"for reference to a constant")
 ;; Codes 193-255 are consumed by `byte-constant', which uses the 6
@@ -993,6 +1005,43 @@ byte-compile-push-bytecode-const2
   `(byte-compile-push-bytecodes ,opcode (logand ,const2 255) (ash ,const2 -8)
 				,bytes ,pc))
 
+(defvar byte-compile-fuse-instructions t
+  "If non-nil, emit superinstructions for common pairs of byte-codes.
+The superinstructions are listed in `byte-fused-ops'.  Emacs versions
+before 31.1 can't run byte code that uses them.")
+
+(defun byte-compile--fuse-lapcode (lap)
+  "Return a copy of LAP that uses superinstructions where possible.
+Two instructions are only combined if no tag is between them, so that
+nothing can jump to the second one."
+  (let ((result nil))
+    (while lap
+      (let* ((entry (car lap))
+             (next (cadr lap))
+             (op (car entry))
+             (op2 (car next))
+             (fused
+              (pcase op
+                ('byte-varref
+                 (and (eq op2 'byte-car)
+                      (< (cddr entry) 256)
+                      (cons 'byte-varref-car (cdr entry))))
+                ('byte-dup
+                 (and (eq op2 'byte-goto-if-nil)
+                      (cons 'byte-dup-goto-if-nil (cdr next))))
+                ('byte-stack-ref
+                 (and (eq op2 'byte-call)
+                      (< 0 (cdr entry) 256)
+                      (< (cdr next) 256)
+                      (cons 'byte-stack-ref-call
+                            (cons (cdr entry) (cdr next))))))))
+        (if fused
+            (setq result (cons fused result)
+                  lap (cddr lap))
+          (setq result (cons entry result)
+                lap (cdr lap)))))
+    (nreverse result)))
+
 (defun byte-compile-lapcode (lap)
   "Turn lapcode LAP into bytecode.  The lapcode is destroyed."
   ;; Lapcode modifications: changes the ID of a tag to be the tag's PC.
@@ -1001,7 +1050,9 @@ byte-compile-lapcode
 	opcode			; numeric value of OP
 	(bytes '())		; Put the output bytes here
 	(patchlist nil))        ; List of gotos to patch
-    (dolist (lap-entry lap)
+    (dolist (lap-entry (if byte-compile-fuse-instructions
+                           (byte-compile--fuse-lapcode lap)
+                         lap))
       (setq op (car lap-entry)
 	    off (cdr lap-entry))
       (cond
@@ -1017,10 +1068,15 @@ byte-compile-lapcode
                   ;; with a modified argument.
                   byte-discardN
                 (symbol-value op)))
-        (cond ((memq op byte-goto-ops)
+        (cond ((or (memq op byte-goto-ops)
+                   (eq op 'byte-dup-goto-if-nil))
                ;; goto
                (byte-compile-push-bytecodes opcode nil (cdr off) bytes pc)
                (push bytes patchlist))
+              ((eq op 'byte-stack-ref-call)
+               ;; Stack offset and number of arguments in two bytes.
+               (byte-compile-push-bytecodes opcode (car off) (cdr off)
+                                            bytes pc))
               ((or (and (consp off)
                         ;; Variable or constant reference
                         (progn
@@ -1040,8 +1096,9 @@ byte-compile-lapcode
                ;; offset is too large for the normal version.
                (byte-compile-push-bytecode-const2 byte-stack-set2 off
                                                   bytes pc))
-              ((and (>= opcode byte-listN)
-                    (< opcode byte-discardN))
+              ((or (and (>= opcode byte-listN)
+                        (< opcode byte-discardN))
+                   (eq op 'byte-varref-car))
                ;; These insns all put their operand into one extra byte.
                (byte-compile-push-bytecodes opcode off bytes pc))
               ((= opcode byte-discardN)
@@ -1768,6 +1825,16 @@ byte-compile--wide-docstring-p
           (setq start (1+ eol)))))
     too-wide))
 
+(defcustom byte-compile-binary-forms nil
+  "If non-nil, write top-level forms to compiled files in binary form.
+The `#%' syntax that this produces reads faster than the textual
+syntax, but can't be read by Emacs versions before 31.1.  Forms that
+can't be written in binary form, such as strings with text
+properties, are written textually as usual."
+  :type 'boolean
+  :safe #'booleanp
+  :version "31.1")
+
 (defcustom byte-compile-docstring-max-column 80
   "Recommended maximum width of doc string lines.
 The byte-compiler will emit a warning for documentation strings
@@ -2548,7 +2615,11 @@ byte-compile-output-file-form
     (when byte-compile--\#$
       (puthash byte-compile--\#$ "#$" print-number-table))
     (princ "\n" byte-compile--outbuffer)
-    (prin1 form byte-compile--outbuffer)
+    (let ((binary (and byte-compile-binary-forms
+                       (print--binary form byte-compile--\#$))))
+      (if binary
+          (princ binary byte-compile--outbuffer)
+        (prin1 form byte-compile--outbuffer)))
     nil))
 
 (defvar byte-compile--for-effect)
@@ -6031,7 +6102,8 @@ bytecomp--check-keyword-args
           form args
           '(:name
             :buffer :command :coding :noquery :stop :connection-type
-            :filter :sentinel :stderr :file-handler)
+            :filter :filter-batch-ms :filter-batch-bytes :framing
+            :sentinel :stderr :file-handler)
           '(:name :command))))
 
 (put 'make-pipe-process 'compiler-macro
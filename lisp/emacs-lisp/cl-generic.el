@@ -677,11 +677,18 @@ cl--generic-compiler
     ;; see `cl--generic-prefill-dispatchers'.
     #'byte-compile))
 
-(defun cl--generic-get-dispatcher (dispatch)
+(defun cl--generic-get-dispatcher (dispatch &optional nargs)
+  "Return the dispatcher function for DISPATCH.
+If NARGS is non-nil, the dispatcher is for generic functions whose
+methods all take exactly NARGS arguments.  Such a dispatcher takes
+its arguments directly, instead of collecting them into a list to
+`apply' the method to them."
   (with-memoization
       ;; We need `copy-sequence` here because this `dispatch' object might be
       ;; modified by side-effect in `cl-generic-define-method' (bug#46722).
-      (gethash (copy-sequence dispatch) cl--generic-dispatchers)
+      (gethash (if nargs (cons nargs (copy-sequence dispatch))
+                 (copy-sequence dispatch))
+               cl--generic-dispatchers)
 
     (when (and purify-flag ;FIXME: Is this a reliable test of the final dump?
                (eq cl--generic-compiler #'byte-compile))
@@ -726,6 +733,7 @@ cl--generic-get-dispatcher
                        (butlast tagcodes)
                      tagcodes)))
            (fixedargs '(arg))
+           (restargs nil)
            (dispatch-idx dispatch-arg)
            (bindings nil))
       (when (eq '&context (car-safe dispatch-arg))
@@ -734,6 +742,9 @@ cl--generic-get-dispatcher
         (setq dispatch-idx 0))
       (dotimes (i dispatch-idx)
         (push (make-symbol (format "arg%d" (- dispatch-idx i 1))) fixedargs))
+      (when nargs
+        (dotimes (i (- nargs (length fixedargs)))
+          (push (make-symbol (format "arg%d" (- nargs i 1))) restargs)))
       ;; FIXME: For generic functions with a single method (or with 2 methods,
       ;; one of which always matches), using a tagcode + hash-table is
       ;; overkill: better just use a `cl-typep' test.
@@ -741,15 +752,33 @@ cl--generic-get-dispatcher
        cl--generic-compiler
        `(lambda (generic dispatches-left methods)
           (let ((method-cache (make-hash-table :test #'eql)))
-            (lambda (,@fixedargs &rest args)
+            (lambda (,@fixedargs ,@(if nargs restargs '(&rest args)))
               (let ,bindings
-                (apply (with-memoization
-                           (gethash ,tag-exp method-cache)
-                         (cl--generic-cache-miss
-                          generic ',dispatch-arg dispatches-left methods
-                          ,(if (cdr typescodes)
-                               `(append ,@typescodes) (car typescodes))))
-                       ,@fixedargs args)))))))))
+                (,(if nargs 'funcall 'apply)
+                 (with-memoization
+                     (gethash ,tag-exp method-cache)
+                   (cl--generic-cache-miss
+                    generic ',dispatch-arg dispatches-left methods
+                    ,(if (cdr typescodes)
+                         `(append ,@typescodes) (car typescodes))))
+                 ,@fixedargs ,@(if nargs restargs '(args)))))))))))
+
+(defun cl--generic-methods-nargs (methods)
+  "Return the number of arguments that all METHODS take, if fixed.
+Return nil if some method takes optional or rest arguments, or if
+the methods take different numbers of arguments."
+  (let ((nargs nil))
+    (catch 'varies
+      (dolist (method methods nargs)
+        (let ((arity (and (memq (cl--generic-method-call-con method) '(nil t))
+                          (func-arity (cl--generic-method-function method)))))
+          (unless (and arity (eql (car arity) (cdr arity)))
+            (throw 'varies nil))
+          (let ((n (if (cl--generic-method-call-con method)
+                       (1- (car arity)) (car arity))))
+            (unless (eql n (or nargs n))
+              (throw 'varies nil))
+            (setq nargs n)))))))
 
 (defun cl--generic-make-function (generic)
   (cl--generic-make-next-function generic
@@ -770,7 +799,21 @@ cl--generic-make-next-function
                   ;; further arguments.
                   methods))
         (cl--generic-build-combined-method generic methods)
-      (let ((dispatcher (cl--generic-get-dispatcher dispatch)))
+      (let* ((nargs (cl--generic-methods-nargs methods))
+             (dispatcher
+              (cl--generic-get-dispatcher
+               dispatch
+               (and nargs
+                    (> nargs (if (integerp (car dispatch)) (car dispatch) -1))
+                    ;; Don't load the byte-compiler to build the
+                    ;; dispatcher for NARGS, unless the dispatcher
+                    ;; for any number of arguments needs it too.
+                    (or (not (eq cl--generic-compiler #'byte-compile))
+                        (featurep 'bytecomp)
+                        (gethash (cons nargs dispatch) cl--generic-dispatchers)
+                        (not (or purify-flag
+                                 (gethash dispatch cl--generic-dispatchers))))
+                    nargs))))
         (funcall dispatcher generic dispatches methods)))))
 
 (defvar cl--generic-combined-method-memoization
@@ -986,7 +1029,7 @@ cl--generic-prefill-dispatchers
     (setq arg-or-context `(&context . ,arg-or-context)))
   (unless (fboundp 'cl--generic-get-dispatcher)
     (require 'cl-generic))
-  (let ((fun
+  (let ((funs
          ;; Let-bind cl--generic-dispatchers so we *re*compute the function
          ;; from scratch, since the one in the cache may be non-compiled!
          (let ((cl--generic-dispatchers (make-hash-table))
@@ -995,11 +1038,22 @@ cl--generic-prefill-dispatchers
                ;; `cl-generic' is still interpreted.
                (cl--generic-compiler
                 (if (featurep 'bytecomp) #'byte-compile cl--generic-compiler)))
-           (cl--generic-get-dispatcher
-            `(,arg-or-context
-              ,@(apply #'append
-                       (mapcar #'cl-generic-generalizers specializers))
-              ,cl--generic-t-generalizer)))))
+           ;; Also prefill the dispatchers for generic functions of
+           ;; up to 3 arguments.
+           (mapcar
+            (lambda (nargs)
+              (cons nargs
+                    (cl--generic-get-dispatcher
+                     `(,arg-or-context
+                       ,@(apply #'append
+                                (mapcar #'cl-generic-generalizers
+                                        specializers))
+                       ,cl--generic-t-generalizer)
+                     nargs)))
+            (cons nil (number-sequence (if (integerp arg-or-context)
+                                           (1+ arg-or-context)
+                                         0)
+                                       3))))))
     ;; Recompute dispatch at run-time, since the generalizers may be slightly
     ;; different (e.g. byte-compiled rather than interpreted).
     ;; FIXME: There is a risk that the run-time generalizer is not equivalent
@@ -1010,8 +1064,12 @@ cl--generic-prefill-dispatchers
               ,@(apply #'append
                        (mapcar #'cl-generic-generalizers ',specializers))
               ,cl--generic-t-generalizer)))
-       ;; (message "Prefilling for %S with \n%S" dispatch ',fun)
-       (puthash dispatch ',fun cl--generic-dispatchers)))))
+       ;; (message "Prefilling for %S with \n%S" dispatch ',funs)
+       ,@(mapcar (lambda (fun)
+                   `(puthash ,(if (car fun) `(cons ,(car fun) dispatch)
+                                'dispatch)
+                             ',(cdr fun) cl--generic-dispatchers))
+                 funs)))))
 
 (cl-defmethod cl-generic-combine-methods (generic methods)
   "Standard support for :after, :before, :around, and `:extra NAME' qualifiers."
@@ -362,6 +362,7 @@ font-spec
 (cl--define-built-in-type condvar atom)
 (cl--define-built-in-type mutex atom)
 (cl--define-built-in-type thread atom)
+(cl--define-built-in-type channel atom)
 (cl--define-built-in-type terminal atom)
 (cl--define-built-in-type hash-table atom)
 (cl--define-built-in-type frame atom)
@@ -49,7 +49,8 @@ native-comp-jit-compilation-deny-list
 (defcustom native-comp-async-jobs-number 0
   "Default number of subprocesses used for async native compilation.
 Value of zero means to use half the number of the CPU's execution units,
-or one if there's just one execution unit."
+or one if there's just one execution unit.  When Emacs runs under GNU
+make, zero instead means the job limit given to make with \"-jN\"."
   :type 'natnum
   :risky t
   :version "28.1")
@@ -136,8 +137,43 @@ native-comp-enable-subr-trampolines
 
 (declare-function comp--install-trampoline "comp.c")
 (declare-function comp-el-to-eln-filename "comp.c")
+(declare-function comp-el-to-eln-shared-filename "comp.c")
 (declare-function native-elisp-load "comp.c")
 
+(defun comp--shared-eln-file (source-file)
+  "Return the file in the shared native-compilation cache for SOURCE-FILE.
+Return nil if there is no such file.  See
+`native-comp-shared-eln-directory'."
+  (when-let* ((file (ignore-errors
+                      (comp-el-to-eln-shared-filename source-file))))
+    (and (file-exists-p file) file)))
+
+(defun comp--share-eln-file (source-file eln-file)
+  "Store ELN-FILE, compiled from SOURCE-FILE, in the shared cache.
+Do nothing unless `native-comp-shared-eln-directory' is writable.
+Write a temporary file in the cache and rename it, so that other
+users of the cache never see a partially written file."
+  (when-let* ((shared (ignore-errors
+                        (comp-el-to-eln-shared-filename source-file)))
+              (dir (file-name-directory shared)))
+    (unless (file-exists-p shared)
+      (ignore-errors (make-directory dir t))
+      (when (file-writable-p dir)
+        (let (temp)
+          (condition-case err
+              (progn
+                (setq temp (make-temp-file (expand-file-name ".tmp-" dir)
+                                           nil ".eln"))
+                (copy-file eln-file temp t)
+                (set-file-modes temp #o644)
+                (rename-file temp shared t))
+            (file-error
+             (when temp
+               (ignore-errors (delete-file temp)))
+             (display-warning 'native-compiler
+                              (format "Cannot store %s: %s" shared
+                                      (error-message-string err))))))))))
+
 (defun native--compile-async-skip-p (file load selector)
   "Return non-nil if FILE's compilation should be skipped.
 
@@ -158,8 +194,39 @@ native--compile-async-skip-p
                       (string-match-p re file))
                     native-comp-jit-compilation-deny-list))))
 
+(defcustom native-comp-async-worker-files 10
+  "Maximum number of files each async native compilation process compiles.
+Async native compilation runs in separate Emacs processes.  Each
+such process compiles files from the queue one after the other, and
+exits after compiling this many files or when no more files are
+waiting to be compiled.  Reusing a process saves starting Emacs and
+loading the compiler for every file, but lets the side effects of
+compiling one file (such as features it loaded) be seen while the
+next file is compiled.  A value of 1 compiles each file in a fresh
+Emacs process."
+  :type 'natnum
+  :version "31.1")
+
 (defvar comp-files-queue ()
-  "List of Emacs Lisp files to be compiled.")
+  "List of Emacs Lisp files to be compiled.
+Each element has the form (FILE . LOAD), where LOAD is as described
+in `native--compile-async'.  Files to be loaded come first.")
+
+(defun comp--queue-file (file load)
+  "Add FILE to `comp-files-queue', to be loaded as requested by LOAD.
+Files that are to be loaded into the current session are queued
+ahead of those that are not, so that they get compiled first."
+  (let ((entry (cons file load)))
+    (if (null load)
+        (setf comp-files-queue (nconc comp-files-queue (list entry)))
+      (let ((tail comp-files-queue)
+            prev)
+        (while (and tail (cdar tail))
+          (setq prev tail
+                tail (cdr tail)))
+        (if prev
+            (setcdr prev (cons entry tail))
+          (push entry comp-files-queue))))))
 
 (defun comp--async-runnings ()
   "Return the number of async compilations currently running.
@@ -174,11 +241,23 @@ comp--async-runnings
    do (remhash file-name comp-async-compilations))
   (hash-table-count comp-async-compilations))
 
+(defun comp--make-jobs-limit ()
+  "Return the job limit of the GNU make Emacs is running under, or nil.
+The limit is taken from the \"-jN\" flag GNU make passes to its
+recipes in the environment variable MAKEFLAGS."
+  (when-let* ((flags (getenv "MAKEFLAGS"))
+              ((string-match (rx (or bos " ")
+                                 (or "-j" "--jobs=") (group (+ digit))
+                                 (or eos " "))
+                             flags)))
+    (max 1 (string-to-number (match-string 1 flags)))))
+
 (defvar comp-num-cpus nil)
 (defun comp--effective-async-max-jobs ()
   "Compute the effective number of async jobs."
   (if (zerop native-comp-async-jobs-number)
-      (or comp-num-cpus
+      (or (comp--make-jobs-limit)
+          comp-num-cpus
           (setf comp-num-cpus
 		(max 1 (/ (num-processors) 2))))
     native-comp-async-jobs-number))
@@ -186,34 +265,208 @@ comp--effective-async-max-jobs
 (defvar-local comp-last-scanned-async-output nil)
 ;; From warnings.el
 (defvar warning-suppress-types)
-(defun comp--accept-and-process-async-output (process)
-  "Accept PROCESS output and check for diagnostic messages."
-  (if native-comp-async-report-warnings-errors
-      (let ((warning-suppress-types
-             (if (eq native-comp-async-report-warnings-errors 'silent)
-                 (cons '(native-compiler) warning-suppress-types)
-               warning-suppress-types))
-            (regexp (if (eq native-comp-async-warnings-errors-kind 'all)
-                        "^.*?\\(?:Error\\|Warning\\): .*$"
-                      (rx bol
-                          (*? nonl)
-                          (or
-                           (seq "Error: " (*? nonl))
-                           (seq "Warning: the function ‘" (1+ (not "’"))
-                                "’ is not known to be defined."))
-                          eol))))
-        (with-current-buffer (process-buffer process)
-          (save-excursion
-            (accept-process-output process)
-            (goto-char (or comp-last-scanned-async-output (point-min)))
-            (while (re-search-forward regexp nil t)
-              (display-warning 'native-compiler (match-string 0)))
-            (setq comp-last-scanned-async-output (point-max)))))
-    (accept-process-output process)))
+(defun comp--process-async-output (buffer)
+  "Check the output of async compilations in BUFFER for diagnostic messages."
+  (when native-comp-async-report-warnings-errors
+    (let ((warning-suppress-types
+           (if (eq native-comp-async-report-warnings-errors 'silent)
+               (cons '(native-compiler) warning-suppress-types)
+             warning-suppress-types))
+          (regexp (if (eq native-comp-async-warnings-errors-kind 'all)
+                      "^.*?\\(?:Error\\|Warning\\): .*$"
+                    (rx bol
+                        (*? nonl)
+                        (or
+                         (seq "Error: " (*? nonl))
+                         (seq "Warning: the function ‘" (1+ (not "’"))
+                              "’ is not known to be defined."))
+                        eol))))
+      (with-current-buffer buffer
+        (save-excursion
+          (goto-char (or comp-last-scanned-async-output (point-min)))
+          (while (re-search-forward regexp nil t)
+            (display-warning 'native-compiler (match-string 0)))
+          (setq comp-last-scanned-async-output (point-max)))))))
 
 (defconst comp-valid-source-re (rx ".el" (? ".gz") eos)
   "Regexp to match filename of valid input source files.")
 
+(defvar comp--async-workers ()
+  "List of the live async native compilation processes.")
+
+(defconst comp--async-done-tag "comp-async-done: "
+  "Prefix of the line an async compilation process emits after each file.")
+
+(defun comp--async-buffer ()
+  "Return the buffer logging the output of async compilations."
+  (with-current-buffer (get-buffer-create comp-async-buffer-name)
+    (unless (derived-mode-p 'compilation-mode)
+      (emacs-lisp-compilation-mode))
+    (current-buffer)))
+
+(defun comp--async-worker-idle-p (process)
+  "Return non-nil if the async compilation PROCESS can take a new file."
+  (and (process-live-p process)
+       (null (process-get process 'comp-job))
+       (< (process-get process 'comp-files-done)
+          (max 1 native-comp-async-worker-files))))
+
+(defun comp--async-job-done (process file ok)
+  "Handle the end of the compilation of FILE by async PROCESS.
+OK is non-nil if FILE was compiled successfully."
+  (let ((load (cdr (process-get process 'comp-job))))
+    (process-put process 'comp-job nil)
+    (remhash file comp-async-compilations)
+    (run-hook-with-args 'native-comp-async-cu-done-functions file)
+    (when (buffer-live-p (process-buffer process))
+      (comp--process-async-output (process-buffer process)))
+    (let ((eln-file (comp-el-to-eln-filename file)))
+      (when (and ok (file-exists-p eln-file))
+        (comp--share-eln-file file eln-file)
+        (when load
+          (native-elisp-load eln-file (eq load 'late)))))
+    (comp--run-async-workers)
+    ;; Let PROCESS exit if it was not given another file.
+    (when (and (process-live-p process)
+               (null (process-get process 'comp-job)))
+      (process-put process 'comp-files-done most-positive-fixnum)
+      (process-send-eof process))))
+
+(defun comp--async-worker-filter (process output)
+  "Log OUTPUT of async compilation PROCESS and notice finished files."
+  (with-current-buffer (comp--async-buffer)
+    (save-excursion
+      (let ((inhibit-read-only t))
+        (goto-char (point-max))
+        (insert output))))
+  (let ((lines (split-string (concat (process-get process 'comp-pending-output)
+                                     output)
+                             "\n")))
+    ;; Keep the last, incomplete line for the next call.
+    (process-put process 'comp-pending-output (car (last lines)))
+    (dolist (line (butlast lines))
+      (when (string-prefix-p comp--async-done-tag line)
+        (let ((result (car (read-from-string
+                           line (length comp--async-done-tag)))))
+          (comp--async-job-done process (car result) (cdr result)))))))
+
+(defun comp--async-worker-sentinel (process _event)
+  "Clean up after async compilation PROCESS exited."
+  (unless (process-live-p process)
+    (setq comp--async-workers (delq process comp--async-workers))
+    (ignore-errors (delete-file (process-get process 'comp-temp-file)))
+    (if-let* ((job (process-get process 'comp-job)))
+        ;; PROCESS died while compiling a file.
+        (comp--async-job-done process (car job) nil)
+      (when comp-files-queue
+        (comp--run-async-workers)))))
+
+(defun comp--async-start-worker ()
+  "Start a new async compilation process and return it.
+The process reads the files to compile from its standard input,
+one printed (FILE . LOAD) cons per line, and reports the end of the
+compilation of each file with a line starting with
+`comp--async-done-tag'."
+  (let* ((expr `((require 'comp)
+                 (setq comp-async-compilation t
+                       warning-fill-column most-positive-fixnum)
+                 ,(let ((set (list 'setq)))
+                    (dolist (var '(comp-file-preloaded-p
+                                   native-compile-target-directory
+                                   native-comp-speed
+                                   native-comp-profile
+                                   native-comp-profile-threshold
+                                   native-comp-profile-speeds
+                                   native-comp-debug
+                                   native-comp-verbose
+                                   comp-libgccjit-reproducer
+                                   native-comp-eln-load-path
+                                   native-comp-compiler-options
+                                   native-comp-driver-options
+                                   load-path
+                                   backtrace-line-length
+                                   byte-compile-warnings
+                                   comp-sanitizer-emit
+                                   ;; package-load-list
+                                   ;; package-user-dir
+                                   ;; package-directory-list
+                                   ))
+                      (when (boundp var)
+                        (push var set)
+                        (push `',(symbol-value var) set)))
+                    (nreverse set))
+                 ;; FIXME: Activating all packages would align the
+                 ;; functionality offered with what is usually done
+                 ;; for ELPA packages (and thus fix some compilation
+                 ;; issues with some ELPA packages), but it's too
+                 ;; blunt an instrument (e.g. we don't even know if
+                 ;; we're compiling such an ELPA package at
+                 ;; this point).
+                 ;;(package-activate-all)
+                 ,native-comp-async-env-modifier-form
+                 (let (job)
+                   (while (setq job (ignore-error end-of-file
+                                      (car (read-from-string
+                                            (read-from-minibuffer "")))))
+                     (let ((ok nil))
+                       (message "Compiling %s..." (car job))
+                       (condition-case err
+                           (progn
+                             (comp--native-compile (car job) (and (cdr job) t))
+                             (setq ok t))
+                         (error
+                          (message "Error: %s" (error-message-string err))))
+                       (message "%s%S" ,comp--async-done-tag
+                                (cons (car job) ok)))))))
+         (temp-file (make-temp-file "emacs-async-comp-" nil ".el"))
+         (expr-strings (let ((print-length nil)
+                             (print-level nil))
+                         (mapcar #'prin1-to-string expr)))
+         (_ (progn
+              (with-temp-file temp-file
+                (mapc #'insert expr-strings))
+              (comp-log "\n")
+              (mapc #'comp-log expr-strings)))
+         (default-directory invocation-directory)
+         (process (make-process
+                   :name "Native compilation"
+                   :buffer (comp--async-buffer)
+                   :connection-type 'pipe
+                   :command (list
+                             (expand-file-name invocation-name
+                                               invocation-directory)
+                             "-no-comp-spawn" "-Q" "--batch"
+                             "--eval"
+                             ;; Suppress Abort dialogs on MS-Windows
+                             "(setq w32-disable-abort-dialog t)"
+                             "-l" temp-file)
+                   :filter #'comp--async-worker-filter
+                   :sentinel #'comp--async-worker-sentinel
+                   :noquery (not native-comp-async-query-on-exit))))
+    (process-put process 'comp-temp-file temp-file)
+    (process-put process 'comp-files-done 0)
+    (push process comp--async-workers)
+    process))
+
+(defun comp--async-dispatch (source-file load)
+  "Have an async compilation process compile SOURCE-FILE.
+LOAD is as described in `native--compile-async'."
+  (let ((process (or (seq-find #'comp--async-worker-idle-p
+                               comp--async-workers)
+                     (comp--async-start-worker)))
+        (print-length nil)
+        (print-level nil)
+        (print-escape-newlines t)
+        (print-escape-multibyte t)
+        (print-escape-nonascii t))
+    (process-put process 'comp-job (cons source-file load))
+    (process-put process 'comp-files-done
+                 (1+ (process-get process 'comp-files-done)))
+    (puthash source-file process comp-async-compilations)
+    (process-send-string process
+                         (concat (prin1-to-string (cons source-file load))
+                                 "\n"))))
+
 (defun comp--run-async-workers ()
   "Start compiling files from `comp-files-queue' asynchronously.
 When compilation is finished, run `native-comp-async-all-done-hook' and
@@ -228,107 +481,28 @@ comp--run-async-workers
          do (cl-assert (string-match-p comp-valid-source-re source-file) nil
                        "`comp-files-queue' should be \".el\" files: %s"
                        source-file)
-         when (or native-comp-always-compile
-                  load ; Always compile when the compilation is
-                       ; commanded for late load.
-                  ;; Skip compilation if `comp-el-to-eln-filename' fails
-                  ;; to find a writable directory.
-                  (with-demoted-errors "Async compilation :%S"
-                    (file-newer-than-file-p
-                     source-file (comp-el-to-eln-filename source-file))))
-         do (let* ((expr `((require 'comp)
-                           (setq comp-async-compilation t
-                                 warning-fill-column most-positive-fixnum)
-                           ,(let ((set (list 'setq)))
-                              (dolist (var '(comp-file-preloaded-p
-                                             native-compile-target-directory
-                                             native-comp-speed
-                                             native-comp-debug
-                                             native-comp-verbose
-                                             comp-libgccjit-reproducer
-                                             native-comp-eln-load-path
-                                             native-comp-compiler-options
-                                             native-comp-driver-options
-                                             load-path
-                                             backtrace-line-length
-                                             byte-compile-warnings
-                                             comp-sanitizer-emit
-                                             ;; package-load-list
-                                             ;; package-user-dir
-                                             ;; package-directory-list
-                                             ))
-                                (when (boundp var)
-                                  (push var set)
-                                  (push `',(symbol-value var) set)))
-                              (nreverse set))
-                           ;; FIXME: Activating all packages would align the
-                           ;; functionality offered with what is usually done
-                           ;; for ELPA packages (and thus fix some compilation
-                           ;; issues with some ELPA packages), but it's too
-                           ;; blunt an instrument (e.g. we don't even know if
-                           ;; we're compiling such an ELPA package at
-                           ;; this point).
-                           ;;(package-activate-all)
-                           ,native-comp-async-env-modifier-form
-                           (message "Compiling %s..." ,source-file)
-                           (comp--native-compile ,source-file ,(and load t))))
-                   (source-file1 source-file) ;; Make the closure works :/
-                   (temp-file (make-temp-file
-                               (concat "emacs-async-comp-"
-                                       (file-name-base source-file) "-")
-                               nil ".el"))
-                   (expr-strings (let ((print-length nil)
-                                       (print-level nil))
-                                   (mapcar #'prin1-to-string expr)))
-                   (_ (progn
-                        (with-temp-file temp-file
-                          (mapc #'insert expr-strings))
-                        (comp-log "\n")
-                        (mapc #'comp-log expr-strings)))
-                   (load1 load)
-                   (default-directory invocation-directory)
-                   (process (make-process
-                             :name (concat "Compiling: " source-file)
-                             :buffer (with-current-buffer
-                                         (get-buffer-create
-                                          comp-async-buffer-name)
-                                       (unless (derived-mode-p 'compilation-mode)
-                                         (emacs-lisp-compilation-mode))
-			               (current-buffer))
-                             :command (list
-                                       (expand-file-name invocation-name
-                                                         invocation-directory)
-                                       "-no-comp-spawn" "-Q" "--batch"
-                                       "--eval"
-                                       ;; Suppress Abort dialogs on MS-Windows
-                                       "(setq w32-disable-abort-dialog t)"
-                                       "-l" temp-file)
-                             :sentinel
-                             (lambda (process _event)
-                               (run-hook-with-args
-                                'native-comp-async-cu-done-functions
-                                source-file)
-                               (comp--accept-and-process-async-output process)
-                               (ignore-errors (delete-file temp-file))
-                               (let ((eln-file (comp-el-to-eln-filename
-                                                source-file1)))
-                                 (when (and load1
-                                            (zerop (process-exit-status
-                                                    process))
-                                            (file-exists-p eln-file))
-                                   (native-elisp-load eln-file
-                                                      (eq load1 'late))))
-                               (comp--run-async-workers))
-                             :noquery (not native-comp-async-query-on-exit))))
-              (puthash source-file process comp-async-compilations))
+         for shared = (and (not native-comp-always-compile)
+                           (comp--shared-eln-file source-file))
+         ;; Another user has compiled the same source already.
+         when (and shared load)
+         do (native-elisp-load shared (eq load 'late))
+         when (and (not shared)
+                   (or native-comp-always-compile
+                       load ; Always compile when the compilation is
+                            ; commanded for late load.
+                       ;; Skip compilation if `comp-el-to-eln-filename'
+                       ;; fails to find a writable directory.
+                       (with-demoted-errors "Async compilation :%S"
+                         (file-newer-than-file-p
+                          source-file
+                          (comp-el-to-eln-filename source-file)))))
+         do (comp--async-dispatch source-file load)
          when (>= (comp--async-runnings) (comp--effective-async-max-jobs))
          do (cl-return)))
     ;; No files left to compile and all processes finished.
     (run-hooks 'native-comp-async-all-done-hook)
-    (with-current-buffer (get-buffer-create comp-async-buffer-name)
+    (with-current-buffer (comp--async-buffer)
       (save-excursion
-        (unless (derived-mode-p 'compilation-mode)
-          (emacs-lisp-compilation-mode))
         (let ((inhibit-read-only t))
           (goto-char (point-max))
           (insert "Compilation finished.\n"))))
@@ -390,7 +564,8 @@ native--compile-async
 a function -- A function selecting files with matching names.
 
 The variable `native-comp-async-jobs-number' specifies the number
-of (commands) to run simultaneously.
+of (commands) to run simultaneously.  Files to be loaded are
+compiled before the others.
 
 LOAD can also be the symbol `late'.  This is used internally if
 the byte code has already been loaded when this function is
@@ -425,13 +600,8 @@ native--compile-async
           ;; compilation, so update `comp-files-queue' to reflect that.
           (unless (or (null load)
                       (eq load (cdr entry)))
-            (setf comp-files-queue
-                  (cl-loop for i in comp-files-queue
-                           with old = (car entry)
-                           if (string= (car i) old)
-                             collect (cons file load)
-                           else
-                             collect i)))
+            (setf comp-files-queue (delq entry comp-files-queue))
+            (comp--queue-file file load))
 
         (unless (native--compile-async-skip-p file load selector)
           (let* ((out-filename (comp-el-to-eln-filename file))
@@ -439,9 +609,9 @@ native--compile-async
             (unless (file-exists-p out-dir)
               (make-directory out-dir t))
             (if (file-writable-p out-filename)
-                (setf comp-files-queue
-                      (append comp-files-queue `((,file . ,load)))
-                      added-something t)
+                (progn
+                  (comp--queue-file file load)
+                  (setf added-something t))
               (display-warning 'native-compiler
                                (format "Cannot write %s; skipping."
                                        out-filename)))))))
@@ -69,6 +69,40 @@ native-comp-speed
   :safe #'integerp
   :version "28.1")
 
+(defcustom native-comp-profile nil
+  "Profile guiding the choice of the optimization level of each function.
+The value can be a file name of a profile saved with
+`profiler-report-write-profile', a profile as returned by
+`profiler-cpu-profile', or a hash table of call counts as returned
+by `byte-code-profile-calls'.  Named functions found hot in the
+profile, according to `native-comp-profile-threshold', are compiled
+at the optimization level given by the car of
+`native-comp-profile-speeds', and the other named functions at the
+level given by its cdr.  A `speed' declaration of a function takes
+precedence over the profile.  Nil means not to use a profile."
+  :type '(choice (const :tag "No profile" nil)
+                 (file :tag "Profile file"))
+  :version "31.1")
+
+(defcustom native-comp-profile-threshold 0.01
+  "Share of the samples of `native-comp-profile' that makes a function hot.
+A function is hot if it appears in at least this fraction of the
+samples of the profile, or accounts for at least this fraction of
+its calls."
+  :type 'number
+  :version "31.1")
+
+(defcustom native-comp-profile-speeds '(nil . 1)
+  "Optimization levels of hot and cold functions in `native-comp-profile'.
+The value is a cons (HOT . COLD) of optimization levels, as in
+`native-comp-speed'.  If either of them is nil, the corresponding
+functions are compiled at the optimization level of the file.
+The default compiles cold functions with light optimizations only,
+which saves compilation time where it does not matter."
+  :type '(cons (choice (const :tag "Default" nil) integer)
+               (choice (const :tag "Default" nil) integer))
+  :version "31.1")
+
 (defcustom native-comp-debug 0
   "Debug level for native compilation, a number between 0 and 3.
 This is intended for debugging the compiler itself.
@@ -359,6 +393,43 @@ comp-vec-prepend
 (define-hash-table-test 'comp-imm-equal-test #'equal-including-properties
   #'sxhash-equal-including-properties)
 
+(declare-function profiler-read-profile "profiler" (filename))
+
+(defun comp--profile-hot-functions (&optional profile)
+  "Return a hash table of the hot functions of PROFILE.
+PROFILE defaults to `native-comp-profile', see there for its possible
+values.  Return nil if there is no profile."
+  (when-let* ((profile (or profile native-comp-profile))
+              (log (cond
+                    ((hash-table-p profile) profile)
+                    ((stringp profile)
+                     (require 'profiler)
+                     (aref (profiler-read-profile profile) 3))
+                    ((and (vectorp profile)
+                          (eq (aref profile 0) 'profiler-profile))
+                     (aref profile 3))
+                    (t (error "Invalid `native-comp-profile': %S"
+                              profile)))))
+    (let ((counts (make-hash-table :test #'eq))
+          (hot (make-hash-table :test #'eq))
+          (total 0))
+      ;; A profiler log maps backtraces to sample counts, a call count
+      ;; table maps functions to call counts.  Count each function once
+      ;; per backtrace it appears in.
+      (maphash (lambda (key count)
+                 (cl-incf total count)
+                 (dolist (f (if (vectorp key)
+                                (delete-dups (append key nil))
+                              (list key)))
+                   (when (and f (symbolp f))
+                     (cl-incf (gethash f counts 0) count))))
+               log)
+      (maphash (lambda (f count)
+                 (when (>= count (* total native-comp-profile-threshold))
+                   (puthash f t hot)))
+               counts)
+      hot)))
+
 (cl-defstruct comp-data-container
   "Data relocation container structure."
   (l () :type list
@@ -399,7 +470,9 @@ comp-data-container
   (d-ephemeral (make-comp-data-container) :type comp-data-container
                :documentation "Relocated data not necessary after load.")
   (with-late-load nil :type boolean
-                  :documentation "When non-nil support late load."))
+                  :documentation "When non-nil support late load.")
+  (profile-hot (comp--profile-hot-functions) :type (or null hash-table)
+               :documentation "Hot functions of `native-comp-profile'."))
 
 (cl-defstruct comp-args-base
   (min nil :type integer
@@ -698,9 +771,18 @@ comp--spill-decl-spec
   (plist-get (cdr (assq function-name byte-to-native-plist-environment))
              spec))
 
+(defun comp--profile-speed (function-name)
+  "Return the speed `native-comp-profile' gives to FUNCTION-NAME, or nil."
+  (when-let* (((and function-name (symbolp function-name)))
+              (hot (comp-ctxt-profile-hot comp-ctxt)))
+    (if (gethash function-name hot)
+        (car native-comp-profile-speeds)
+      (cdr native-comp-profile-speeds))))
+
 (defun comp--spill-speed (function-name)
   "Return the speed for FUNCTION-NAME."
   (or (comp--spill-decl-spec function-name 'speed)
+      (comp--profile-speed function-name)
       (comp-ctxt-speed comp-ctxt)))
 
 (defun comp--spill-safety (function-name)
@@ -40,12 +40,24 @@
 
 (oclosure-define (advice
                   (:predicate advice--p)
-                  (:copier advice--cons (cdr))
                   (:copier advice--copy (car cdr how props)))
   car cdr how props)
 
 (eval-when-compile
-  (defmacro advice--make-how-alist (&rest args)
+  (defconst advice--how-bodies
+    '((:around (apply car cdr r))
+      (:before (apply car r) (apply cdr r))
+      (:after (prog1 (apply cdr r) (apply car r)))
+      (:override (apply car r))
+      (:after-until (or (apply cdr r) (apply car r)))
+      (:after-while (and (apply cdr r) (apply car r)))
+      (:before-until (or (apply car r) (apply cdr r)))
+      (:before-while (and (apply car r) (apply cdr r)))
+      (:filter-args (apply cdr (funcall car r)))
+      (:filter-return (funcall car (apply cdr r))))
+    "The code of each kind of advice, which calls its arguments R.")
+
+  (defmacro advice--make-how-alist ()
     `(list
       ,@(mapcar
          (lambda (arg)
@@ -60,26 +72,56 @@
                        (format "%S" `(lambda (&rest r) ,@body))
                        t t)
                       t t))))
-         args))))
+         advice--how-bodies)))
+
+  (defun advice--fixed-nargs-code (form args)
+    "Return FORM with its calls that apply functions to R using ARGS.
+Throw `advice--rest' if FORM uses R otherwise."
+    (cond
+     ((eq form 'r) (throw 'advice--rest nil))
+     ((atom form) form)
+     ((and (eq (car form) 'apply) (eq (car (last form)) 'r))
+      `(funcall ,@(butlast (cdr form)) ,@args))
+     (t (mapcar (lambda (f) (advice--fixed-nargs-code f args)) form))))
+
+  (defmacro advice--make-fixed-nargs-alist (max)
+    `(list
+      ,@(delq nil
+              (mapcar
+               (lambda (arg)
+                 (pcase-let ((`(,how . ,body) arg))
+                   (catch 'advice--rest
+                     `(cons ,how
+                            (vector
+                             ,@(mapcar
+                                (lambda (n)
+                                  (let ((args (mapcar (lambda (i)
+                                                        (intern
+                                                         (format "arg%d" i)))
+                                                      (number-sequence 1 n))))
+                                    `(oclosure-lambda (advice (how ,how)) ,args
+                                       ,@(advice--fixed-nargs-code
+                                          body args))))
+                                (number-sequence 0 max)))))))
+               advice--how-bodies)))))
 
 ;;;; Lightweight advice/hook
 (defvar advice--how-alist
-  (advice--make-how-alist
-   (:around (apply car cdr r))
-   (:before (apply car r) (apply cdr r))
-   (:after (prog1 (apply cdr r) (apply car r)))
-   (:override (apply car r))
-   (:after-until (or (apply cdr r) (apply car r)))
-   (:after-while (and (apply cdr r) (apply car r)))
-   (:before-until (or (apply car r) (apply cdr r)))
-   (:before-while (and (apply car r) (apply cdr r)))
-   (:filter-args (apply cdr (funcall car r)))
-   (:filter-return (funcall car (apply cdr r))))
+  (advice--make-how-alist)
   "List of descriptions of how to add a function.
 Each element has the form (HOW OCL DOC) where HOW is a keyword,
 OCL is a \"prototype\" function of type `advice', and
 DOC is a string where \"FUNCTION\" and \"OLDFUN\" are expected.")
 
+(defvar advice--fixed-nargs-alist
+  (advice--make-fixed-nargs-alist 4)
+  "Prototypes of advice for functions that take a fixed number of arguments.
+Each element has the form (HOW . PROTOS) where HOW is a keyword and
+PROTOS is a vector whose Nth element is the prototype of the advice
+for functions that take exactly N arguments.  Unlike those of
+`advice--how-alist', these prototypes do not collect their arguments
+into a list.")
+
 (defun advice--cd*r (f)
   (while (advice--p f)
     (setq f (advice--cdr f)))
@@ -253,10 +295,47 @@ advice--make
         ;; `function' should go deeper.
         (let ((rest (advice--make how function (advice--cdr main) props)))
           (advice--cons main rest))
-      (let ((proto (assq how advice--how-alist)))
-        (unless proto (error "Unknown add-function location `%S'" how))
-        (advice--copy (cadr proto)
-                      function main how props)))))
+      (advice--copy (advice--prototype how function main)
+                    function main how props))))
+
+(defun advice--fixed-nargs (how function main)
+  "Return the number of arguments that the advice of FUNCTION to MAIN takes.
+Return nil unless MAIN is a function value that takes a fixed number
+of arguments, and FUNCTION can be called with the arguments that HOW
+passes to it."
+  (let ((arity (and (functionp main)
+                    (not (symbolp main))
+                    (not (autoloadp main))
+                    (func-arity main))))
+    (when (and arity (eql (car arity) (cdr arity)))
+      (let* ((nargs (car arity))
+             (fnargs (if (eq how :around) (1+ nargs) nargs))
+             (farity (and (functionp function)
+                          (not (autoloadp (indirect-function function)))
+                          (func-arity function))))
+        (and farity
+             (<= (car farity) fnargs)
+             (or (eql (cdr farity) fnargs)
+                 ;; An :override advice which takes more arguments
+                 ;; may be called with them.
+                 (and (eq (cdr farity) 'many) (not (eq how :override))))
+             nargs)))))
+
+(defun advice--prototype (how function main)
+  "Return the prototype of the advice that adds FUNCTION to MAIN at HOW."
+  (let ((nargs (advice--fixed-nargs how function main))
+        (protos (cdr (assq how advice--fixed-nargs-alist))))
+    (if (and nargs protos (< nargs (length protos)))
+        (aref protos nargs)
+      (or (cadr (assq how advice--how-alist))
+          (error "Unknown add-function location `%S'" how)))))
+
+(defun advice--cons (advice rest)
+  "Return a copy of ADVICE whose next function is REST."
+  (let ((how (advice--how advice))
+        (function (advice--car advice)))
+    (advice--copy (advice--prototype how function rest)
+                  function rest how (advice--props advice))))
 
 (defun advice--member-p (function use-name definition)
   (let ((found nil))
@@ -179,9 +179,8 @@ timer--activate
       (error "Timer already activated"))
      (t
       ;; Skip all timers to trigger before the new one.
-      (while (and timers (timer--time-less-p (car timers) timer))
-	(setq last timers
-	      timers (cdr timers)))
+      (setq last (internal--timer-insert-position timer timers))
+      (if last (setq timers (cdr last)))
       (if reuse-cell
 	  (progn
 	    (setcar reuse-cell timer)
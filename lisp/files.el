@@ -1036,13 +1036,45 @@ directory-files-recursively
 
 PREDICATE can be either nil (which means that all subdirectories
 of DIR are descended into), t (which means that subdirectories that
-can't be read are ignored), or a function (which is called with
+can't be read are ignored), a function (which is called with
 the name of each subdirectory, and should return non-nil if the
-subdirectory is to be descended into).
+subdirectory is to be descended into), or a list of regexps (which
+means that subdirectories whose names match any of them are not
+descended into, and subdirectories that can't be read are ignored).
 
 If FOLLOW-SYMLINKS is non-nil, symbolic links that point to
 directories are followed.  Note that this can lead to infinite
 recursion."
+  (let ((prune (and (consp predicate) (not (functionp predicate))
+                    predicate)))
+    (cond
+     ;; Local directories are listed much faster in C, unless
+     ;; PREDICATE is a Lisp function.
+     ((and (or prune (memq predicate '(nil t)))
+           (not (find-file-name-handler (expand-file-name dir)
+                                        'file-name-all-completions)))
+      (internal-directory-files-recursively
+       dir regexp include-directories (and predicate t) follow-symlinks
+       prune))
+     (prune
+      (directory-files-recursively
+       dir regexp include-directories
+       (lambda (subdir)
+         (let ((name (file-name-nondirectory subdir))
+               (descend (file-readable-p subdir)))
+           (dolist (re prune)
+             (when (string-match-p re name)
+               (setq descend nil)))
+           descend))
+       follow-symlinks))
+     (t
+      (files--directory-files-recursively
+       dir regexp include-directories predicate follow-symlinks)))))
+
+(defun files--directory-files-recursively (dir regexp include-directories
+                                               predicate follow-symlinks)
+  "Subroutine of `directory-files-recursively' for remote directories.
+It is also used for local directories when PREDICATE is a function."
   (let* ((result nil)
 	 (files nil)
          (dir (directory-file-name dir))
@@ -1066,10 +1098,10 @@ directory-files-recursively
                 (let ((sub-files
                        (if (eq predicate t)
                            (ignore-error file-error
-                             (directory-files-recursively
+                             (files--directory-files-recursively
 			      full-file regexp include-directories
                               predicate follow-symlinks))
-                         (directory-files-recursively
+                         (files--directory-files-recursively
 			  full-file regexp include-directories
                           predicate follow-symlinks))))
 		  (setq result (nconc result sub-files))))
@@ -2810,6 +2842,89 @@ insert-file-contents-literally
         (inhibit-file-name-operation 'insert-file-contents))
     (insert-file-contents filename visit beg end replace)))
 
+(defun insert-file-contents-async (filename &optional callback chunk-size)
+  "Insert the contents of file FILENAME after point, a chunk at a time.
+Unlike `insert-file-contents', this returns right away, and inserts
+the file from a timer, CHUNK-SIZE bytes at a time (4 MiB by default).
+The buffer can be displayed and scrolled while the rest of the file
+is still being read.  After the whole file has been inserted, call
+CALLBACK, if non-nil, in the buffer with the number of inserted
+characters as its argument.
+
+The text is decoded like `insert-file-contents' does, except that the
+coding system is determined from the first chunk only.  Chunks end
+after a newline where possible, so that characters are not split
+between two chunks.  If the coding system is not ASCII compatible, as
+for UTF-16, the whole file is inserted at once instead.
+
+This doesn't visit the file, and doesn't run the hooks that
+`insert-file-contents' runs.  The insertion doesn't record undo
+information, and ignores the buffer being read-only.  It stops if the
+buffer is killed.
+
+Return the timer that does the insertion.  Use `cancel-timer' on it to
+stop inserting the file."
+  (setq filename (expand-file-name filename))
+  (unless chunk-size
+    (setq chunk-size (* 4 1024 1024)))
+  (let* ((size (file-attribute-size (file-attributes filename)))
+         (marker (point-marker))
+         (coding (or coding-system-for-read
+                     (car-safe (find-operation-coding-system
+                                'insert-file-contents filename))
+                     'undecided))
+         (offset 0)
+         (inserted 0)
+         (timer (timer-create)))
+    (unless size
+      (signal 'file-missing (list "Opening input file"
+                                  "No such file or directory" filename)))
+    (set-marker-insertion-type marker t)
+    (timer-set-function
+     timer
+     (lambda ()
+       (when (buffer-live-p (marker-buffer marker))
+         (let ((text
+                (with-temp-buffer
+                  (set-buffer-multibyte nil)
+                  (insert-file-contents-literally
+                   filename nil offset (min size (+ offset chunk-size)))
+                  (when (= offset 0)
+                    (when (eq (coding-system-type coding) 'undecided)
+                      (setq coding (detect-coding-region
+                                    (point-min) (point-max) t)))
+                    ;; Splitting the text at newlines could split
+                    ;; characters, so read the rest in one go.
+                    (unless (coding-system-get coding :ascii-compatible-p)
+                      (goto-char (point-max))
+                      (insert-file-contents-literally
+                       filename nil (buffer-size) size)))
+                  (goto-char (point-max))
+                  (when (and (< (+ offset (buffer-size)) size)
+                             (search-backward "\n" nil t))
+                    (delete-region (1+ (point)) (point-max)))
+                  (setq offset (+ offset (buffer-size)))
+                  (decode-coding-string (buffer-string) coding t))))
+           (with-current-buffer (marker-buffer marker)
+             (let ((inhibit-read-only t)
+                   (buffer-undo-list t))
+               (save-excursion
+                 (goto-char marker)
+                 (insert text))))
+           (setq inserted (+ inserted (length text)))
+           (if (< offset size)
+               (progn
+                 (timer-set-time timer nil)
+                 (timer-activate timer))
+             (let ((buffer (marker-buffer marker)))
+               (set-marker marker nil)
+               (when callback
+                 (with-current-buffer buffer
+                   (funcall callback inserted)))))))))
+    (timer-set-time timer nil)
+    (timer-activate timer)
+    timer))
+
 (defun insert-file-1 (filename insert-func)
   (if (file-directory-p filename)
       (signal 'file-error (list "Opening input file" "Is a directory"
@@ -1117,6 +1117,103 @@ make-frame
     (run-hook-with-args 'after-make-frame-functions frame)
     frame))
 
+(defcustom child-frame-pool-size 8
+  "Maximum number of child frames kept for reuse by `make-child-frame'.
+When `release-child-frame' would keep more frames than this, it
+deletes the least recently released one."
+  :type 'natnum
+  :group 'frames
+  :version "31.1")
+
+(defvar child-frame--pool nil
+  "Child frames released by `release-child-frame', most recent first.
+Each element has the form (FRAME . PARAMETERS), where PARAMETERS are
+the parameters FRAME was made with by `make-child-frame', without
+those in `child-frame--pool-ignored-parameters'.")
+
+(defconst child-frame--pool-ignored-parameters
+  '(parent-frame left top width height user-position user-size visibility)
+  "Frame parameters in which a reused child frame may differ.
+`make-child-frame' sets them on the frame it reuses.")
+
+(defun child-frame--pool-key (parameters)
+  "Return PARAMETERS without those a reused child frame may differ in."
+  (seq-remove (lambda (parameter)
+                (memq (car-safe parameter)
+                      child-frame--pool-ignored-parameters))
+              parameters))
+
+(defun make-child-frame (parent &optional parameters)
+  "Return a child frame of PARENT with frame parameters PARAMETERS.
+Reuse a frame released by `release-child-frame' if there is one that
+is on the same terminal as PARENT and was made with the same
+PARAMETERS, except for position, size and visibility.  Otherwise,
+make a new frame with `make-frame'.
+
+Making a frame realizes its faces and, on graphical terminals,
+creates a window-system window and loads its fonts.  A reused frame
+keeps all of these, so reusing frames makes popups that show up and
+go away often, such as completion popups, much faster.
+
+A reused frame is made a child frame of PARENT, gets the position,
+size and visibility that PARAMETERS specify, and is made visible
+unless PARAMETERS specify otherwise.  Its root window keeps the
+buffer it showed before.  The hooks `before-make-frame-hook' and
+`after-make-frame-functions' are not run for a reused frame."
+  (setq parent (window-normalize-frame parent))
+  (setq child-frame--pool
+        (seq-filter (lambda (entry) (frame-live-p (car entry)))
+                    child-frame--pool))
+  (let* ((key (child-frame--pool-key parameters))
+         (entry (seq-find (lambda (entry)
+                            (and (not (eq (car entry) parent))
+                                 (not (frame-ancestor-p (car entry) parent))
+                                 (eq (frame-terminal (car entry))
+                                     (frame-terminal parent))
+                                 (equal (cdr entry) key)))
+                          child-frame--pool)))
+    (if (not entry)
+        (let ((frame (make-frame
+                      (cons (cons 'parent-frame parent)
+                            (assq-delete-all 'parent-frame
+                                             (copy-sequence parameters))))))
+          ;; Record the key in a list, so that it is non-nil.
+          (set-frame-parameter frame 'child-frame--pool-key (list key))
+          frame)
+      (let ((frame (car entry))
+            (changed (list (cons 'parent-frame parent))))
+        (setq child-frame--pool (delq entry child-frame--pool))
+        (dolist (parameter parameters)
+          (when (and (memq (car-safe parameter)
+                           child-frame--pool-ignored-parameters)
+                     (not (memq (car parameter) '(parent-frame visibility)))
+                     (not (equal (frame-parameter frame (car parameter))
+                                 (cdr parameter))))
+            (push parameter changed)))
+        (modify-frame-parameters frame changed)
+        (if (cdr (or (assq 'visibility parameters) '(visibility . t)))
+            (make-frame-visible frame)
+          (make-frame-invisible frame t))
+        frame))))
+
+(defun release-child-frame (frame)
+  "Make child frame FRAME invisible and let `make-child-frame' reuse it.
+FRAME should have been returned by `make-child-frame', and the caller
+should not use it after calling this function.  If FRAME was not made
+by `make-child-frame' or is no longer a child frame, delete it."
+  (when (and (frame-live-p frame)
+             (not (assq frame child-frame--pool)))
+    (let ((key (frame-parameter frame 'child-frame--pool-key)))
+      (if (not (and key (frame-parent frame) (> child-frame-pool-size 0)))
+          (delete-frame frame)
+        (make-frame-invisible frame t)
+        (push (cons frame (car key)) child-frame--pool)
+        (let ((tail (nthcdr (1- child-frame-pool-size) child-frame--pool)))
+          (when (cdr tail)
+            (dolist (entry (cdr tail))
+              (delete-frame (car entry)))
+            (setcdr tail nil)))))))
+
 (defun filtered-frame-list (predicate)
   "Return a list of all live frames which satisfy PREDICATE."
   (let* ((frames (frame-list))
@@ -3316,7 +3413,8 @@ set-frame-property--interactive
         display-fill-column-indicator-character
         bidi-paragraph-direction
         bidi-display-reordering
-        bidi-inhibit-bpa))
+        bidi-inhibit-bpa
+        face-range-sets))
 
 (defun frame-hide-title-bar-when-maximized (frame)
   "Hide the title bar if FRAME is maximized.
@@ -100,6 +100,18 @@ jka-compr-shell
 (defvar jka-compr-use-shell
   (not (memq system-type '(ms-dos windows-nt))))
 
+(defcustom jka-compr-prefer-uncompress-function t
+  "Non-nil means uncompress files inside Emacs when possible.
+Some entries of `jka-compr-compression-info-list' name a function that
+uncompresses data in a buffer, such as `zlib-decompress-region' for
+gzip files.  If this is non-nil, visiting such files uses that
+function instead of running the uncompression program, which is
+faster.  If nil, the function is used only when the program is not
+available."
+  :type 'boolean
+  :version "31.1"
+  :group 'jka-compr)
+
 (defvar-local jka-compr-really-do-compress nil
   "Non-nil in a buffer whose visited file was uncompressed on visiting it.
 This means compress the data on writing the file, even if the
@@ -369,6 +381,25 @@ jka-compr-write-region
 					lockname mustbenew)))))
 
 
+(defun jka-compr--use-uncompress-function-p (program function)
+  "Return non-nil if FUNCTION should uncompress instead of PROGRAM."
+  (and function
+       (fboundp function)
+       (or jka-compr-prefer-uncompress-function
+           (not (executable-find program))
+           ;; Android ships a bespoke version of gzip that is
+           ;; absolutely useless for Emacs's purposes, not supporting
+           ;; decompression or reading input from elsewhere than stdin.
+           ;;
+           ;; This is only true of early releases of the OS, but,
+           ;; since zlib is always available on Android, simply
+           ;; unconditionally prefer the built-in decompression
+           ;; function.
+           (eq system-type 'android))
+       ;; zlib might be a DLL that could not be loaded.
+       (or (not (eq function 'zlib-decompress-region))
+           (zlib-available-p))))
+
 (defun jka-compr-insert-file-contents (file &optional visit beg end replace)
   (barf-if-buffer-read-only)
 
@@ -407,86 +438,85 @@ jka-compr-insert-file-contents
                uncompress-message
 	       jka-compr-verbose
                (message "%s %s..." uncompress-message base-name))
-              (if (and (or (not (executable-find uncompress-program))
-                           ;; Android ships a bespoke version of gzip
-                           ;; that is absolutely useless for Emacs's
-                           ;; purposes, not supporting decompression or
-                           ;; reading input from elsewhere than stdin.
-                           ;;
-                           ;; This is only true of early releases of the
-                           ;; OS, but, since zlib is always available on
-                           ;; Android, simply unconditionally prefer the
-                           ;; built-in decompression function.
-                           (eq system-type 'android))
-                       uncompress-function
-                       (fboundp uncompress-function))
-                  ;; If we don't have the uncompression program, then use the
-                  ;; internal uncompression function (if we have one).
-                  (let ((buf (current-buffer)))
-                    (with-temp-buffer
-                      (set-buffer-multibyte nil)
-                      (insert-file-contents-literally file)
-                      (funcall uncompress-function (point-min) (point-max))
-                      (when end
-                        (delete-region end (point-max)))
-                      (when beg
-                        (delete-region (point-min) beg))
-                      (setq size (buffer-size))
-                      (insert-into-buffer buf))
-                    (goto-char (point-min)))
-                ;; Use the external uncompression program.
-                (condition-case error-code
-
-                    (let ((coding-system-for-read 'no-conversion))
-                      (if replace
-                          (goto-char (point-min)))
-                      (setq start (point))
-                      (if (or beg end)
-                          (jka-compr-partial-uncompress
-                           uncompress-program
-                           (concat uncompress-message " " base-name)
-                           uncompress-args
-                           local-file
-                           (or beg 0)
-                           (if (and beg end)
-                               (- end beg)
-                             end))
-                        ;; If visiting, bind off buffer-file-name so that
-                        ;; file-locking will not ask whether we should
-                        ;; really edit the buffer.
-                        (let ((buffer-file-name
-                               (if visit nil buffer-file-name)))
-                          (jka-compr-call-process uncompress-program
-                                                  (concat uncompress-message
-                                                          " " base-name)
-                                                  local-file
-                                                  t
-                                                  nil
-                                                  uncompress-args)))
-                      (setq size (- (point) start))
-                      (if replace
-                          (delete-region (point) (point-max)))
-                      (goto-char start))
-                  (error
-                   ;; If the file we wanted to uncompress does not exist,
-                   ;; handle that according to VISIT as `insert-file-contents'
-                   ;; would, maybe signaling the same error it normally would.
-                   (if (and (eq (car error-code) 'file-missing)
-                            (eq (nth 3 error-code) local-file))
-                       (if visit
-                           (setq notfound error-code)
-                         (signal 'file-missing
-                                 (cons "Opening input file"
-                                       (nthcdr 2 error-code))))
-                     ;; If the uncompression program can't be found,
-                     ;; signal that as a non-file error
-                     ;; so that find-file-noselect-1 won't handle it.
-                     (if (and (memq 'file-error (get (car error-code)
-                                                     'error-conditions))
-                              (equal (cadr error-code) "Searching for program"))
-                         (error "Uncompression program `%s' not found"
-                                (nth 3 error-code)))
-                     (signal (car error-code) (cdr error-code)))))))
+              (condition-case error-code
+
+                  (let ((coding-system-for-read 'no-conversion))
+                    (if replace
+                        (goto-char (point-min)))
+                    (setq start (point))
+                    (cond
+                     ((jka-compr--use-uncompress-function-p
+                       uncompress-program uncompress-function)
+                      ;; Use the internal uncompression function.
+                      (let ((buf (current-buffer)))
+                        (with-temp-buffer
+                          (set-buffer-multibyte nil)
+                          (insert-file-contents-literally local-file)
+                          (unless (funcall uncompress-function
+                                           (point-min) (point-max))
+                            (signal 'compression-error
+                                    (list "Uncompressing" base-name)))
+                          ;; BEG and END are byte offsets.
+                          (when end
+                            (delete-region (min (1+ end) (point-max))
+                                           (point-max)))
+                          (when beg
+                            (delete-region (point-min)
+                                           (min (1+ beg) (point-max))))
+                          (let ((temp (current-buffer)))
+                            (with-current-buffer buf
+                              ;; As below, prevent file locking.
+                              (let ((buffer-file-name
+                                     (if visit nil buffer-file-name)))
+                                (insert-buffer-substring temp)))))))
+                     ;; Use the external uncompression program.
+                     ((or beg end)
+                      (jka-compr-partial-uncompress
+                       uncompress-program
+                       (concat uncompress-message " " base-name)
+                       uncompress-args
+                       local-file
+                       (or beg 0)
+                       (if (and beg end)
+                           (- end beg)
+                         end)))
+                     (t
+                      ;; If visiting, bind off buffer-file-name so that
+                      ;; file-locking will not ask whether we should
+                      ;; really edit the buffer.
+                      (let ((buffer-file-name
+                             (if visit nil buffer-file-name)))
+                        (jka-compr-call-process uncompress-program
+                                                (concat uncompress-message
+                                                        " " base-name)
+                                                local-file
+                                                t
+                                                nil
+                                                uncompress-args))))
+                    (setq size (- (point) start))
+                    (if replace
+                        (delete-region (point) (point-max)))
+                    (goto-char start))
+                (error
+                 ;; If the file we wanted to uncompress does not exist,
+                 ;; handle that according to VISIT as `insert-file-contents'
+                 ;; would, maybe signaling the same error it normally would.
+                 (if (and (eq (car error-code) 'file-missing)
+                          (equal (nth 3 error-code) local-file))
+                     (if visit
+                         (setq notfound error-code)
+                       (signal 'file-missing
+                               (cons "Opening input file"
+                                     (nthcdr 2 error-code))))
+                   ;; If the uncompression program can't be found,
+                   ;; signal that as a non-file error
+                   ;; so that find-file-noselect-1 won't handle it.
+                   (if (and (memq 'file-error (get (car error-code)
+                                                   'error-conditions))
+                            (equal (cadr error-code) "Searching for program"))
+                       (error "Uncompression program `%s' not found"
+                              (nth 3 error-code)))
+                   (signal (car error-code) (cdr error-code))))))
 
           (and
            local-copy
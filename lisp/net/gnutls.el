@@ -139,6 +139,17 @@ gnutls-min-prime-bits
                  (integer :tag "Number of bits" 2048))
   :version "27.1")
 
+(defcustom gnutls-resume-sessions t
+  "If non-nil, resume earlier TLS sessions when possible.
+When Emacs connects again to a host it talked to before, it can then
+resume the earlier session instead of doing a full handshake, which
+saves time and computation.  The certificates of the host are
+verified in either case.  Sessions are remembered only in memory, and
+only for connections whose certificates were verified without
+problems."
+  :type 'boolean
+  :version "31.1")
+
 (defcustom gnutls-crlfiles
   '(
     "/etc/grid-security/certificates/*.crl.pem"
@@ -371,6 +382,7 @@ gnutls-boot-parameters
                 :verify-error ,verify-error
                 :pass ,pass
                 :flags ,flags
+                :resume-session ,gnutls-resume-sessions
                 :callbacks nil)))
 
 (defun gnutls--get-files (files)
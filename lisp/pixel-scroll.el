@@ -214,6 +214,16 @@ pixel-scroll-precision-interpolate-mice
   :type 'boolean
   :version "29.1")
 
+(defcustom pixel-scroll-precision-coalesce-events t
+  "Whether to scroll once for all wheel events that are already queued.
+If non-nil, `pixel-scroll-precision' adds up the pixel deltas of the
+wheel events that arrived while Emacs was busy scrolling and
+redisplaying, and scrolls by their sum.  This avoids laying out and
+redisplaying the window for every event of a fast touchpad or
+high-resolution mouse wheel."
+  :type 'boolean
+  :version "31.1")
+
 (defun pixel-scroll-in-rush-p ()
   "Return non-nil if next scroll should be non-smooth.
 When scrolling request is delivered soon after the previous one,
@@ -675,6 +685,27 @@ pixel-scroll-precision-scroll-up
 ;; FIXME: This doesn't _always_ work when there's an image above the
 ;; current line that is taller than the window, and scrolling can
 ;; sometimes be jumpy in that case.
+(defun pixel-scroll--coalesce-delta (event delta)
+  "Return DELTA plus the pixel deltas of the wheel events queued after EVENT.
+Read the queued wheel events that have pixel deltas and are for the
+same window and with the same modifiers as EVENT, and put back the
+first event that is not."
+  (let ((window (mwheel-event-window event))
+        (modifiers (event-modifiers event))
+        next)
+    (while (and (not executing-kbd-macro)
+                (input-pending-p)
+                (setq next (read-event nil nil 0))
+                (memq (event-basic-type next) '(wheel-up wheel-down))
+                (equal (event-modifiers next) modifiers)
+                (eq (mwheel-event-window next) window)
+                (nth 4 next))
+      (setq delta (+ delta (round (cdr (nth 4 next))))
+            next nil))
+    (when next
+      (push next unread-command-events))
+    delta))
+
 (defun pixel-scroll-precision (event)
   "Scroll the display vertically by pixels according to EVENT.
 Move the display up or down by the pixel deltas in EVENT to
@@ -687,6 +718,8 @@ pixel-scroll-precision
       (setq window (frame-selected-window window)))
     (if (and (nth 4 event))
         (let ((delta (round (cdr (nth 4 event)))))
+          (when pixel-scroll-precision-coalesce-events
+            (setq delta (pixel-scroll--coalesce-delta event delta)))
           (unless (zerop delta)
             (if (> (abs delta) (window-text-height window t))
                 (mwheel-scroll event nil)
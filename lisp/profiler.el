@@ -191,6 +191,39 @@ profiler-read-profile
     (goto-char (point-min))
     (read (current-buffer))))
 
+(defun profiler-collapsed-stack-frame (entry)
+  "Return the name of backtrace ENTRY for a collapsed stack."
+  (let ((name (cond
+               ((eq entry t) "Others")
+               ((stringp entry) entry)
+               (t (help-fns-function-name entry)))))
+    ;; `;' separates frames and whitespace separates the count.
+    (replace-regexp-in-string "[;\n]" "_" (substring-no-properties name))))
+
+(defun profiler-write-collapsed-stacks (profile filename &optional confirm)
+  "Write PROFILE into file FILENAME as collapsed stacks.
+Each line of the file describes one backtrace, outermost frame first,
+with the frames separated by semicolons, followed by a space and the
+sample count (or the number of bytes for a memory profile).  This is
+the input format of flame graph tools, and can be converted to other
+formats, such as pprof, by external tools."
+  (let (lines)
+    (maphash
+     (lambda (backtrace count)
+       (let (frames)
+         (dotimes (i (length backtrace))
+           (let ((entry (aref backtrace i)))
+             (when entry
+               (push (profiler-collapsed-stack-frame entry) frames))))
+         (when (and frames (/= count 0))
+           (push (format "%s %d" (mapconcat #'identity frames ";") count)
+                 lines))))
+     (profiler-profile-log profile))
+    (with-temp-buffer
+      (dolist (line (sort lines #'string<))
+        (insert line "\n"))
+      (write-file filename confirm))))
+
 (defun profiler-running-p (&optional mode)
   "Return non-nil if the profiler is running.
 Optional argument MODE means only check for the specified mode (cpu or mem)."
@@ -217,6 +250,16 @@ profiler-memory-profile
    :timestamp (current-time)
    :log profiler-memory-log))
 
+(defun profiler-heap-profile ()
+  "Return a memory profile of the objects that are still alive.
+The profile attributes the live objects allocated since
+`profiler-heap-start' to their type and to the call-stack of their
+allocation.  See `profiler-heap-snapshot'."
+  (profiler-make-profile
+   :type 'memory
+   :timestamp (current-time)
+   :log (profiler-heap-snapshot)))
+
 
 ;;; Calltrees
 
@@ -576,6 +619,9 @@ profiler-report-mode-map
      :help "Compare current profile with another"]
     ["Write Profile..." profiler-report-write-profile :active t
      :help "Write current profile to a file"]
+    ["Write Collapsed Stacks..." profiler-report-write-collapsed-stacks
+     :active t
+     :help "Write current profile to a file as collapsed stacks"]
     "--"
     ["Start Profiler" profiler-start :active (not (profiler-running-p))
      :help "Start profiling"]
@@ -800,15 +846,28 @@ profiler-report-write-profile
                           filename
                           confirm))
 
+(defun profiler-report-write-collapsed-stacks (filename &optional confirm)
+  "Write the current profile into file FILENAME as collapsed stacks.
+See `profiler-write-collapsed-stacks' for the format."
+  (interactive
+   (list (read-file-name "Write collapsed stacks: " default-directory)
+	 (not current-prefix-arg)))
+  (profiler-write-collapsed-stacks profiler-report-profile
+                                   filename
+                                   confirm))
+
 
 ;;; Profiler commands
 
 ;;;###autoload
 (defun profiler-start (mode)
   "Start/restart profilers.
-MODE can be one of `cpu', `mem', or `cpu+mem'.
+MODE can be one of `cpu', `wall', `mem', or `cpu+mem'.
 If MODE is `cpu' or `cpu+mem', start the time-based profiler,
    whereby CPU is sampled periodically using the SIGPROF signal.
+If MODE is `wall', start the time-based profiler, but sample
+   periodically in elapsed time, so that time spent waiting for
+   input, subprocesses or file I/O is sampled too.
 If MODE is `mem' or `cpu+mem', start profiler that samples CPU
    whenever memory-allocation functions are called -- this is useful
    if SIGPROF is not supported, or is unreliable, or is not sampling
@@ -816,12 +875,15 @@ profiler-start
   (interactive
    (list (if (not (fboundp 'profiler-cpu-start)) 'mem
            (intern (completing-read (format-prompt "Mode" "cpu")
-                                    '("cpu" "mem" "cpu+mem")
+                                    '("cpu" "wall" "mem" "cpu+mem")
                                     nil t nil nil "cpu")))))
   (cl-ecase mode
     (cpu
      (profiler-cpu-start profiler-sampling-interval)
      (message "CPU profiler started"))
+    (wall
+     (profiler-cpu-start profiler-sampling-interval t)
+     (message "Wall-clock profiler started"))
     (mem
      (profiler-memory-start)
      (message "Memory profiler started"))
@@ -356,6 +356,34 @@ project-files
        (list (project-root project)))))
 
 (defun project--files-in-directory (dir ignores &optional files)
+  (if (and (not files)
+           (fboundp 'directory-files-tree)
+           (not (file-remote-p dir))
+           (not (file-name-quoted-p dir)))
+      ;; List local directories without starting `find'.  Cache the
+      ;; result, so that repeated completion on the files is quick.
+      (let ((dir (file-name-as-directory (expand-file-name dir))))
+        (mapcar (if project-files-relative-names
+                    #'identity
+                  (lambda (file) (concat dir file)))
+                (directory-files-tree
+                 dir (project--ignores-to-gitignore ignores) nil t)))
+    (project--find-files-in-directory dir ignores files)))
+
+(defun project--ignores-to-gitignore (ignores)
+  "Convert IGNORES to patterns for `directory-files-tree'.
+IGNORES is a list of glob patterns as returned by `project-ignores'."
+  (mapcar (lambda (ignore)
+            (cond
+             ;; Rooted entry.
+             ((string-prefix-p "./" ignore) (substring ignore 1))
+             ;; Like `find', match entries with slashes at any depth.
+             ((not (string-match-p "/." ignore)) ignore)
+             ((string-prefix-p "*" ignore) (concat "*" ignore))
+             (t (concat "**/" ignore))))
+          ignores))
+
+(defun project--find-files-in-directory (dir ignores &optional files)
   (require 'find-dired)
   (require 'xref)
   (let* ((dir (file-name-as-directory dir))
@@ -193,6 +193,32 @@ server-done-hook
   "Hook run when done editing a buffer for the Emacs server."
   :type 'hook)
 
+(defcustom server-frame-pool-size 0
+  "Number of hidden frames to keep ready for new graphical client frames.
+Creating a graphical frame from scratch, as for \"emacsclient -c\", can
+take a noticeable time.  If this is a positive number, then after
+creating a graphical client frame on a display, the server creates
+that many invisible frames on the same display when Emacs is idle, and
+shows one of them instead of creating a new frame the next time a
+client asks for a frame there.  Client frames that ask for a parent
+window are always created from scratch.
+
+Note that the hidden frames keep the connection to their display open."
+  :type 'natnum
+  :version "31.1")
+
+(defcustom server-batch-name "batch"
+  "The name of the socket that `server-batch-start' serves.
+If this is a file name with no leading directories, the socket is
+created under `server-socket-dir'.  \"emacsclient --batch\" connects
+to this name unless given another one with \"-s\"."
+  :type 'string
+  :version "31.1")
+
+(defvar server--frame-pool nil
+  "Invisible frames kept ready for new client frames.
+See `server-frame-pool-size'.")
+
 (defvar server-process nil
   "The current server process.")
 
@@ -653,6 +679,8 @@ server-stop
             server-process nil
             server-mode nil
             global-minor-modes (delq 'server-mode global-minor-modes))
+      (unless noframe
+        (server--frame-pool-clear))
       (server-apply-stop-automatically))
     (unwind-protect
         ;; Delete the socket files made by previous server
@@ -707,7 +735,7 @@ server-start
 	    ;; doing emacsclient --eval "(kill-emacs)" in daemon mode.
 	    (cond
 	     ((and (daemonp)
-		   (null (cdr (frame-list)))
+		   (null (cdr (server--frame-list)))
 		   (eq (selected-frame) terminal-frame))
 	      leave-dead)
 	     (inhibit-prompt t)
@@ -850,6 +878,46 @@ server-running-p
 	t)
     (file-error nil)))
 
+;;;###autoload
+(defun server-batch-start (&optional name)
+  "Serve \"emacsclient --batch\" requests with copies of this Emacs.
+Start a fork server on the local socket NAME, which defaults to
+`server-batch-name'.  Each request runs in a fresh copy of this Emacs,
+forked from it at the time of the request, that uses the standard
+input, output and error, the working directory, the environment and
+the command-line arguments of the client.  This saves the time to
+start Emacs and load its init files for each batch job.
+
+Call this function as the last command-line action of a batch Emacs
+that has loaded everything the requests need, for instance
+
+  emacs --batch -l ~/.emacs.d/batch-init.el -f server-batch-start &
+
+and then run each batch job with
+
+  emacsclient --batch -l job.el -f job-main
+
+The copy processes the arguments of the client as though they
+followed \"-f server-batch-start\" on the command line of this
+Emacs, and \"emacsclient\" exits with the exit status of the copy.
+This function returns only in the copies."
+  (let ((dir server-socket-dir)
+        args env)
+    (unless dir
+      (error "Local sockets are not supported"))
+    (setq name (or name server-batch-name))
+    (unless (file-name-absolute-p name)
+      (server-ensure-safe-dir dir))
+    (dolist (item (internal--fork-server (expand-file-name name dir)))
+      (let ((string (decode-coding-string (substring item 1)
+                                          locale-coding-system t)))
+        (pcase (aref item 0)
+          (?D (setq default-directory (file-name-as-directory string)))
+          (?E (push string env))
+          (?A (push string args)))))
+    (setq process-environment (nreverse env))
+    (setq command-line-args-left (nreverse args))))
+
 ;; This keymap is empty, but allows users to define keybindings to use
 ;; when `server-mode' is active.
 (defvar-keymap server-mode-map)
@@ -968,7 +1036,10 @@ server-create-window-system-frame
                 `((display . ,display)
                   ,@(if parent-id
                         `((parent-id . ,(string-to-number parent-id))))
-                  ,@parameters))
+                  ,@parameters)
+                (and (> server-frame-pool-size 0)
+                     (not parent-id)
+                     display))
              (error
               (server-log "Window system unsupported" proc)
               (server-send-string proc "-window-system-unsupported \n")
@@ -979,6 +1050,49 @@ server-create-window-system-frame
            (server-send-string proc "-window-system-unsupported \n")
            nil))))
 
+(defun server--frame-pool-take (display parameters)
+  "Return a frame from the pool on DISPLAY, with PARAMETERS applied.
+Return nil if the pool has no frame on DISPLAY."
+  (setq server--frame-pool (seq-filter #'frame-live-p server--frame-pool))
+  (when-let* ((frame (seq-find (lambda (frame)
+                                 (equal (frame-parameter frame 'display)
+                                        display))
+                               server--frame-pool)))
+    (setq server--frame-pool (delq frame server--frame-pool))
+    (modify-frame-parameters frame parameters)
+    (make-frame-visible frame)
+    frame))
+
+(defun server--frame-pool-fill (display)
+  "Create hidden frames on DISPLAY until the pool for it is full."
+  (setq server--frame-pool (seq-filter #'frame-live-p server--frame-pool))
+  (condition-case err
+      (while (and server-process
+                  (< (seq-count (lambda (frame)
+                                  (equal (frame-parameter frame 'display)
+                                         display))
+                                server--frame-pool)
+                     server-frame-pool-size))
+        (let ((frame (make-frame `((display . ,display)
+                                   (visibility . nil)))))
+          (push frame server--frame-pool)
+          (server-log (format "%s created for the frame pool" frame))))
+    (error (server-log (format "Could not fill the frame pool: %S" err)))))
+
+(defun server--frame-pool-clear ()
+  "Delete the hidden frames kept ready for new client frames."
+  (dolist (frame server--frame-pool)
+    (when (frame-live-p frame)
+      (delete-frame frame t)))
+  (setq server--frame-pool nil))
+
+(defun server--frame-list ()
+  "Return the list of frames, except those in the frame pool."
+  (if server--frame-pool
+      (seq-remove (lambda (frame) (memq frame server--frame-pool))
+                  (frame-list))
+    (frame-list)))
+
 (defun server-create-dumb-terminal-frame (nowait proc &optional parameters)
   ;; If the destination is a dumb terminal, we can't really run Emacs
   ;; in its tty.  So instead, we use whichever terminal is currently
@@ -991,26 +1105,35 @@ server-create-dumb-terminal-frame
     (process-put proc 'no-delete-terminal t)
     frame))
 
-(defun server--create-frame (nowait proc parameters)
+(defun server--create-frame (nowait proc parameters &optional pool-display)
+  "Create a client frame for PROC with frame PARAMETERS.
+If POOL-DISPLAY is non-nil, it is the display of the new frame, and
+the frame can come from the pool of hidden frames for that display,
+see `server-frame-pool-size'."
   (add-to-list 'frame-inherited-parameters 'client)
   ;; When `nowait' is set, flag frame as client-created, but use
   ;; a dummy client.  This will prevent the frame from being deleted
   ;; when emacsclient quits while also preventing
   ;; `server-save-buffers-kill-terminal' from unexpectedly killing
   ;; emacs on that frame.
-  (let ((frame (make-frame `((client . ,(if nowait 'nowait proc))
-                             ;; This is a leftover from an earlier
-                             ;; attempt at making it possible for process
-                             ;; run in the server process to use the
-                             ;; environment of the client process.
-                             ;; It has no effect now and to make it work
-                             ;; we'd need to decide how to make
-                             ;; process-environment interact with client
-                             ;; envvars, and then to change the
-                             ;; C functions `child_setup' and
-                             ;; `getenv_internal' accordingly.
-                             (environment . ,(process-get proc 'env))
-                             ,@parameters))))
+  (let* ((parameters `((client . ,(if nowait 'nowait proc))
+                       ;; This is a leftover from an earlier
+                       ;; attempt at making it possible for process
+                       ;; run in the server process to use the
+                       ;; environment of the client process.
+                       ;; It has no effect now and to make it work
+                       ;; we'd need to decide how to make
+                       ;; process-environment interact with client
+                       ;; envvars, and then to change the
+                       ;; C functions `child_setup' and
+                       ;; `getenv_internal' accordingly.
+                       (environment . ,(process-get proc 'env))
+                       ,@parameters))
+         (frame (or (and pool-display
+                         (server--frame-pool-take pool-display parameters))
+                    (make-frame parameters))))
+    (when pool-display
+      (run-with-idle-timer 0.5 nil #'server--frame-pool-fill pool-display))
     (server-log (format "%s created" frame) proc)
     (select-frame frame)
     (process-put proc 'frame frame)
@@ -1414,7 +1537,7 @@ server--process-filter-1
 			     ;; We can't use the Emacs daemon's
 			     ;; terminal frame.
 			     (not (and (daemonp)
-				       (null (cdr (frame-list)))
+				       (null (cdr (server--frame-list)))
 				       (eq (selected-frame)
 					   terminal-frame)))))
 		    (setq tty-name nil tty-type nil)
@@ -1438,7 +1561,7 @@ server--process-filter-1
                    ;; back to trying to create a new one.
 		   ((and use-current-frame
 			 (daemonp)
-			 (null (cdr (frame-list)))
+			 (null (cdr (server--frame-list)))
 			 (eq (selected-frame) terminal-frame)
 			 display)
 		    (setq tty-name nil tty-type nil)
@@ -1891,7 +2014,7 @@ server-save-buffers-kill-terminal
         (proc (frame-parameter nil 'client)))
     (cond ((eq proc 'nowait)
 	   ;; Nowait frames have no client buffer list.
-	   (if (length> (frame-list) (if stop-automatically 2 1))
+	   (if (length> (server--frame-list) (if stop-automatically 2 1))
                ;; If there are any other frames, only delete this one.
                ;; When `server-stop-automatically' is set, don't count
                ;; the daemon frame.
@@ -1928,13 +2051,13 @@ server-save-buffers-kill-terminal
 
 (defun server-stop-automatically--handle-delete-frame (_frame)
   "Handle deletion of FRAME when `server-stop-automatically' is `delete-frame'."
-  (when (null (cddr (frame-list)))
+  (when (null (cddr (server--frame-list)))
     (let ((server-stop-automatically nil))
       (save-buffers-kill-emacs))))
 
 (defun server-stop-automatically--maybe-kill-emacs ()
   "Handle closing of Emacs daemon when `server-stop-automatically' is `empty'."
-  (unless (cdr (frame-list))
+  (unless (cdr (server--frame-list))
     (when (and
 	   (not (memq t (mapcar (lambda (b)
 				  (and (buffer-file-name b)
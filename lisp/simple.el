@@ -3726,6 +3726,10 @@ primitive-undo
              (set-marker marker
                          (- marker offset)
                          (marker-buffer marker))))
+          ;; (undo-compressed . DATA) holds the older records in
+          ;; compressed form; see `undo-compressed-limit'.
+          (`(undo-compressed . ,data)
+           (setq list (nconc (undo--decompress-history data) list)))
           (_ (error "Unrecognized entry in undo list %S" next))))
       (setq arg (1- arg)))
     ;; Make sure an apply entry produces at least one undo entry,
@@ -3835,6 +3839,9 @@ undo-make-selective-list
       (when undo-no-redo
         (while (consp (gethash ulist undo-equiv-table))
           (setq ulist (gethash ulist undo-equiv-table))))
+      (while (eq (car-safe (car ulist)) 'undo-compressed)
+        (setq ulist (nconc (undo--decompress-history (cdar ulist))
+                           (cdr ulist))))
       (setq undo-elt (car ulist))
       (cond
        ((null undo-elt)
@@ -100,17 +100,17 @@ sort-subr
 	  (if messages (message "Sorting records..."))
 	  (setq sort-lists
 		(sort sort-lists
-		      (cond (predicate
-			     `(lambda (a b) (,predicate (car a) (car b))))
-			    ((numberp (car (car sort-lists)))
-			     'car-less-than-car)
-			    ((consp (car (car sort-lists)))
-			     (lambda (a b)
-			       (> 0 (compare-buffer-substrings
-				     nil (car (car a)) (cdr (car a))
-				     nil (car (car b)) (cdr (car b))))))
-			    (t
-			     (lambda (a b) (string< (car a) (car b)))))))
+		      :key #'car
+		      :lessp (cond (predicate)
+				   ((numberp (car (car sort-lists)))
+				    #'<)
+				   ((consp (car (car sort-lists)))
+				    (lambda (a b)
+				      (> 0 (compare-buffer-substrings
+					    nil (car a) (cdr a)
+					    nil (car b) (cdr b)))))
+				   (t #'string<))
+		      :in-place t))
 	  (if reverse (setq sort-lists (nreverse sort-lists)))
 	  (if messages (message "Reordering buffer..."))
           (with-buffer-unmodified-if-unchanged
@@ -1228,6 +1228,7 @@ command-line
                          ("--user") ("--iconic") ("--icon-type") ("--quick")
 			 ("--no-blinking-cursor") ("--basic-display")
                          ("--dump-file") ("--temacs") ("--seccomp")
+                         ("--startup-profile")
                          ("--init-directory" "--no-comp-spawn")))
              (argi (pop args))
              (orig-argi argi)
@@ -1300,7 +1301,8 @@ command-line
 	  (push '(visibility . icon) initial-frame-alist))
 	 ((member argi '("-nbc" "-no-blinking-cursor"))
 	  (setq no-blinking-cursor t))
-         ((member argi '("-dump-file" "-temacs" "-seccomp"))
+         ((member argi '("-dump-file" "-temacs" "-seccomp"
+                         "-startup-profile"))
           ;; Handled in C
           (or argval (pop args))
           (setq argval nil))
@@ -2551,7 +2553,7 @@ command-line-1
                ;; and long versions of what's on command-switch-alist.
                (longopts
                 (append '("--funcall" "--load" "--insert" "--kill"
-                          "--dump-file" "--seccomp"
+                          "--dump-file" "--seccomp" "--startup-profile"
                           "--directory" "--eval" "--execute" "--no-splash"
                           "--find-file" "--visit" "--file" "--no-desktop")
                         (mapcar (lambda (elt) (concat "-" (car elt)))
@@ -2717,7 +2719,8 @@ command-line-1
                      (insert-file-contents (command-line-normalize-file-name tem)))
 
                     ((or (equal argi "-dump-file")
-                         (equal argi "-seccomp"))
+                         (equal argi "-seccomp")
+                         (equal argi "-startup-profile"))
                      ;; This was processed in C.
                      (or argval (pop command-line-args-left)))
 
@@ -35,7 +35,8 @@ xterm--extra-capabilities-type
   '(set (const :tag "modifyOtherKeys support" modifyOtherKeys)
         (const :tag "report background" reportBackground)
         (const :tag "get X selection" getSelection)
-        (const :tag "set X selection" setSelection)))
+        (const :tag "set X selection" setSelection)
+        (const :tag "synchronized output" synchronizedOutput)))
 
 (defcustom xterm-extra-capabilities 'check
   "Whether Xterm supports some additional, more modern, features.
@@ -47,8 +48,9 @@ xterm-extra-capabilities
   modifyOtherKeys  -- if supported, more key bindings work (e.g., \"\\C-,\")
   reportBackground -- if supported, Xterm reports its background color
   getSelection     -- if supported, Xterm yanks text from the X selection
-  setSelection     -- if supported, Xterm saves killed text to the X selection"
-  :version "24.1"
+  setSelection     -- if supported, Xterm saves killed text to the X selection
+  synchronizedOutput -- if supported, Xterm displays each redisplay at once"
+  :version "31.1"
   :type `(choice (const :tag "Check" check)
                  ,xterm--extra-capabilities-type))
 
@@ -814,7 +816,8 @@ xterm--version-handler
           ;; disabled, C-y will incur a timeout, so we only use it if the user
           ;; explicitly requests it.
           ;;(xterm--init-activate-get-selection)
-          (xterm--init-activate-set-selection))))))
+          (xterm--init-activate-set-selection))))
+    (xterm--query-synchronized-output)))
 
 (defvar xterm-query-timeout 2
   "Seconds to wait for an answer from the terminal.
@@ -918,6 +921,21 @@ xterm--query-name-and-version
                          (throw 'result str))))))
       nil)))
 
+(defun xterm--synchronized-output-handler ()
+  ;; The reply should be: \e [ ? 2026 ; NUMBER $ y
+  ;; where NUMBER is 1 or 2 if the mode is known and can be changed.
+  (let ((str (xterm--read-string ?y)))
+    (when (string-match "\\`[12]\\$\\'" str)
+      (xterm--init-synchronized-output))))
+
+(defun xterm--query-synchronized-output ()
+  "Ask whether the terminal supports synchronized output (mode 2026)."
+  ;; Terminals that don't know the DECRQM request ignore it, so use a
+  ;; short timeout as in `xterm--query-name-and-version'.
+  (let ((xterm-query-timeout 0.1))
+    (xterm--query "\e[?2026$p"
+                  '(("\e[?2026;" . xterm--synchronized-output-handler)))))
+
 (defun xterm--push-map (map basemap)
   ;; Use inheritance to let the main keymaps override those defaults.
   ;; This way we don't override terminfo-derived settings or settings
@@ -961,7 +979,9 @@ xterm--init
     (when (memq 'getSelection xterm-extra-capabilities)
       (xterm--init-activate-get-selection))
     (when (memq 'setSelection xterm-extra-capabilities)
-      (xterm--init-activate-set-selection)))
+      (xterm--init-activate-set-selection))
+    (when (memq 'synchronizedOutput xterm-extra-capabilities)
+      (xterm--init-synchronized-output)))
 
   (when xterm-set-window-title
     (xterm--init-frame-title))
@@ -1018,6 +1038,10 @@ xterm--init-activate-set-selection
   "Terminal initialization for `gui-set-selection'."
   (set-terminal-parameter nil 'xterm--set-selection t))
 
+(defun xterm--init-synchronized-output ()
+  "Terminal initialization for synchronized output."
+  (set-terminal-parameter nil 'tty-synchronized-output t))
+
 (defun xterm--init-frame-title ()
   "Terminal initialization for XTerm frame titles."
   (xterm-set-window-title)
@@ -50,6 +50,93 @@ thread-handle-event
             (err (cddr event)))
         (message "Error %s: %S" thread err))))
 
+;;; Thread pools
+
+(declare-function make-thread "thread.c")
+(declare-function thread-join "thread.c")
+(declare-function make-channel "thread.c")
+(declare-function channel-send "thread.c")
+(declare-function channel-receive "thread.c")
+(declare-function channel-close "thread.c")
+
+(cl-defstruct (thread-pool (:constructor thread-pool--make)
+                           (:copier nil)
+                           (:predicate thread-pool-p))
+  "A fixed set of threads that call the functions submitted to it."
+  (name nil :read-only t :documentation "The name of the pool, or nil.")
+  (jobs nil :read-only t
+        :documentation "The channel of jobs waiting for a thread.")
+  (threads nil :read-only t :documentation "The threads of the pool."))
+
+(defun thread-pool--work (jobs)
+  "Call the functions received from the channel JOBS until it is closed.
+Each job is a list (FUNCTION ARGS RESULT), and the outcome of
+applying FUNCTION to ARGS is sent to the channel RESULT."
+  (condition-case nil
+      (while t
+        (pcase-let ((`(,function ,args ,result) (channel-receive jobs)))
+          (channel-send result
+                        (condition-case err
+                            (cons t (apply function args))
+                          (error (cons nil err))))))
+    (channel-closed nil)))
+
+;;;###autoload
+(defun make-thread-pool (size &optional name)
+  "Make a pool of SIZE threads, and return it.
+The threads call the functions that `thread-pool-submit' gives the
+pool, one at a time each, until the pool is shut down with
+`thread-pool-shutdown'.  NAME, if non-nil, is a string that names
+the pool and its threads.
+
+Like all Lisp threads, the threads of a pool run one at a time, so a
+pool is useful for functions that spend much of their time waiting,
+for instance for processes or network connections."
+  (unless (natnump size)
+    (signal 'wrong-type-argument (list 'natnump size)))
+  (let ((jobs (make-channel (max size 1) name))
+        (threads nil))
+    (dotimes (i size)
+      (push (make-thread (lambda () (thread-pool--work jobs))
+                         (format "%s-%d" (or name "thread-pool") i))
+            threads))
+    (thread-pool--make :name name :jobs jobs :threads (nreverse threads))))
+
+(defun thread-pool-submit (pool function &rest args)
+  "Ask a thread of POOL to apply FUNCTION to ARGS.
+Return a channel that receives the outcome; pass it to
+`thread-pool-result' to wait for the value that FUNCTION returns.
+If all threads of POOL are busy and enough functions already wait
+for one, wait until some thread is free."
+  (let ((result (make-channel 1)))
+    (channel-send (thread-pool-jobs pool) (list function args result))
+    result))
+
+(defun thread-pool-result (result)
+  "Wait for a function submitted to a thread pool, and return its value.
+RESULT is the channel that `thread-pool-submit' returned.  If the
+function signaled an error, signal it again.  Call this at most once
+for each RESULT."
+  (pcase-let ((`(,ok . ,value) (channel-receive result)))
+    (if ok value (signal (car value) (cdr value)))))
+
+(defun thread-pool-map (pool function sequence)
+  "Apply FUNCTION to each element of SEQUENCE using the threads of POOL.
+Return the list of the results, in the order of SEQUENCE.  If
+FUNCTION signals an error for one of the elements, signal it again
+once the calls for all the elements before it returned."
+  (mapcar #'thread-pool-result
+          (mapcar (lambda (elt) (thread-pool-submit pool function elt))
+                  sequence)))
+
+(defun thread-pool-shutdown (pool &optional wait)
+  "Shut down POOL.
+The threads of POOL exit once they have called the functions already
+submitted to it.  If WAIT is non-nil, wait for them to exit."
+  (channel-close (thread-pool-jobs pool))
+  (when wait
+    (mapc #'thread-join (thread-pool-threads pool))))
+
 ;;; The thread list buffer and list-threads command
 
 (defcustom thread-list-refresh-seconds 0.5
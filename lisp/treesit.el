@@ -112,6 +112,7 @@ treesit-declare-unavailable-functions
      (declare-function treesit-query-expand "treesit.c")
      (declare-function treesit-query-compile "treesit.c")
      (declare-function treesit-query-capture "treesit.c")
+     (declare-function treesit-query-capture-batch "treesit.c")
 
      (declare-function treesit-search-subtree "treesit.c")
      (declare-function treesit-search-forward "treesit.c")
@@ -1864,18 +1865,47 @@ treesit--font-lock-fast-mode
 ;; the node, because it could (and often do) fontify the relatives of
 ;; the captured node, not just the node itself.  If we took out those
 ;; nodes author of those functions would be very confused.
-(defun treesit-font-lock-fontify-region (start end &optional loudly)
-  "Fontify the region between START and END.
-If LOUDLY is non-nil, display some debugging information."
-  (when (or loudly treesit--font-lock-verbose)
-    (message "Fontifying region: %s-%s" start end))
-  (treesit-update-ranges start end)
-  (font-lock-unfontify-region start end)
+;; 4. When `treesit-font-lock-prefontify-windows' is non-nil, the
+;; text that jit-lock would fontify while redisplaying the windows is
+;; fontified before redisplay starts, by
+;; `treesit--font-lock-prefontify-windows'.  That function finds the
+;; queries to run for all this text at once, and runs them with
+;; `treesit-query-capture-batch', which can run them on several
+;; threads.  The captures are then applied one region after another,
+;; by calling `jit-lock-fontify-now' as jit-lock would, and
+;; `treesit-font-lock-fontify-region' finds them in
+;; `treesit--font-lock-prefetched' instead of running the queries.
+
+(defcustom treesit-font-lock-prefontify-windows nil
+  "Non-nil means fontify the text of all visible windows before redisplay.
+When this is nil, jit-lock fontifies the text of each window as
+redisplay reaches it, running the tree-sitter queries of one region
+after another.  When this is non-nil, the text that jit-lock would
+fontify in all the visible windows is fontified just before
+redisplay, and the queries for all of it are run together, on
+several threads if there are several processors."
+  :type 'boolean
+  :version "31.1")
+
+(defvar-local treesit--font-lock-prefetched nil
+  "Captures found in advance for `treesit-font-lock-fontify-region'.
+Each element has the form (TICK START END . CAPTURES): CAPTURES is a
+list of (OVERRIDE . CAPTURES-OF-QUERY), the result of each query that
+fontifies the region between START and END, in the order they are to
+be applied, and TICK is the `buffer-chars-modified-tick' they are
+valid for.  `treesit--font-lock-prefontify-windows' sets this.")
+
+(defun treesit--font-lock-query-specs (start end)
+  "Return the queries to run to fontify the region between START and END.
+Each element has the form (NODE QUERY OVERRIDE): QUERY is to be run
+on NODE, and OVERRIDE says how to apply the faces it captures.  The
+elements are in the order their faces are to be applied."
   (let* ((local-parsers (treesit-local-parsers-on start end))
          (global-parsers (treesit-parser-list))
          (root-nodes
           (mapcar #'treesit-parser-root-node
-                  (append local-parsers global-parsers))))
+                  (append local-parsers global-parsers)))
+         (specs nil))
     ;; Can't we combine all the queries in each setting into one big
     ;; query? That should make font-lock faster? I tried, it shaved off
     ;; 1ms in xdisp.c, and 0.3ms in a small C file (for typing a single
@@ -1914,8 +1944,53 @@ treesit-font-lock-fontify-region
 
           ;; Query each node.
           (dolist (sub-node nodes)
-            (treesit--font-lock-fontify-region-1
-             sub-node query start end override loudly))))))
+            (push (list sub-node query override) specs)))))
+    (nreverse specs)))
+
+(defun treesit--font-lock-query-range (start end)
+  "Return the range to query to fontify the region between START and END.
+The value is a cons (BEG . END)."
+  (cons (max (- start (car treesit--font-lock-query-expand-range))
+             (point-min))
+        (min (+ end (cdr treesit--font-lock-query-expand-range))
+             (point-max))))
+
+(defun treesit--font-lock-take-prefetched (start end)
+  "Return the captures found in advance for fontifying START to END.
+The value is the CAPTURES of an element of
+`treesit--font-lock-prefetched', or nil if there is none that is
+still valid."
+  (let ((entry (seq-find (lambda (entry)
+                           (and (eql (nth 1 entry) start)
+                                (eql (nth 2 entry) end)))
+                         treesit--font-lock-prefetched)))
+    (when entry
+      (setq treesit--font-lock-prefetched
+            (delq entry treesit--font-lock-prefetched))
+      (and (eql (car entry) (buffer-chars-modified-tick))
+           ;; Changing the ranges of a parser makes its nodes outdated.
+           (seq-every-p (lambda (elt)
+                          (or (null (cdr elt))
+                              (not (treesit-node-check (cdadr elt)
+                                                       'outdated))))
+                        (nthcdr 3 entry))
+           (nthcdr 3 entry)))))
+
+(defun treesit-font-lock-fontify-region (start end &optional loudly)
+  "Fontify the region between START and END.
+If LOUDLY is non-nil, display some debugging information."
+  (when (or loudly treesit--font-lock-verbose)
+    (message "Fontifying region: %s-%s" start end))
+  (treesit-update-ranges start end)
+  (font-lock-unfontify-region start end)
+  (let ((prefetched (treesit--font-lock-take-prefetched start end)))
+    (if prefetched
+        (dolist (elt prefetched)
+          (treesit--font-lock-apply-captures
+           (cdr elt) start end (car elt) loudly))
+      (dolist (spec (treesit--font-lock-query-specs start end))
+        (treesit--font-lock-fontify-region-1
+         (nth 0 spec) (nth 1 spec) start end (nth 2 spec) loudly))))
   `(jit-lock-bounds ,start . ,end))
 
 (defun treesit--font-lock-fontify-region-1 (node query start end override loudly)
@@ -1923,43 +1998,150 @@ treesit--font-lock-fontify-region-1
 
 If OVERRIDE is non-nil, override existing faces, if LOUDLY is
 non-nil, print debugging information."
-  (let* ((delta-start (car treesit--font-lock-query-expand-range))
-         (delta-end (cdr treesit--font-lock-query-expand-range))
+  (let* ((range (treesit--font-lock-query-range start end))
          (captures (treesit-query-capture
-                    node query
-                    (max (- start delta-start) (point-min))
-                    (min (+ end delta-end) (point-max)))))
-
-    ;; For each captured node, fontify that node.
-    (with-silent-modifications
-      (dolist (capture captures)
-        (let* ((face (car capture))
-               (node (cdr capture))
-               (node-start (treesit-node-start node))
-               (node-end (treesit-node-end node)))
-
-          ;; If node is not in the region, take them out.  See
-          ;; comment #3 above for more detail.
-          (if (and (facep face)
-                   (or (>= start node-end) (>= node-start end)))
-              (when (or loudly treesit--font-lock-verbose)
-                (message "Captured node %s(%s-%s) but it is outside of fontifing region" node node-start node-end))
-
-            (cond
-             ((facep face)
-              (treesit-fontify-with-override
-               (max node-start start) (min node-end end)
-               face override))
-             ((functionp face)
-              (funcall face node override start end)))
-
-            ;; Don't raise an error if FACE is neither a face nor
-            ;; a function.  This is to allow intermediate capture
-            ;; names used for #match and #eq.
+                    node query (car range) (cdr range))))
+    (treesit--font-lock-apply-captures captures start end override loudly)))
+
+(defun treesit--font-lock-apply-captures (captures start end override loudly)
+  "Fontify the region between START and END according to CAPTURES.
+CAPTURES is a result of `treesit-query-capture'.  If OVERRIDE is
+non-nil, override existing faces, if LOUDLY is non-nil, print
+debugging information."
+  ;; For each captured node, fontify that node.
+  (with-silent-modifications
+    (dolist (capture captures)
+      (let* ((face (car capture))
+             (node (cdr capture))
+             (node-start (treesit-node-start node))
+             (node-end (treesit-node-end node)))
+
+        ;; If node is not in the region, take them out.  See
+        ;; comment #3 above for more detail.
+        (if (and (facep face)
+                 (or (>= start node-end) (>= node-start end)))
             (when (or loudly treesit--font-lock-verbose)
-              (message "Fontifying text from %d to %d, Face: %s, Node: %s"
-                       (max node-start start) (min node-end end)
-                       face (treesit-node-type node)))))))))
+              (message "Captured node %s(%s-%s) but it is outside of fontifing region" node node-start node-end))
+
+          (cond
+           ((facep face)
+            (treesit-fontify-with-override
+             (max node-start start) (min node-end end)
+             face override))
+           ((functionp face)
+            (funcall face node override start end)))
+
+          ;; Don't raise an error if FACE is neither a face nor
+          ;; a function.  This is to allow intermediate capture
+          ;; names used for #match and #eq.
+          (when (or loudly treesit--font-lock-verbose)
+            (message "Fontifying text from %d to %d, Face: %s, Node: %s"
+                     (max node-start start) (min node-end end)
+                     face (treesit-node-type node))))))))
+
+(defun treesit--font-lock-extend-region (start end)
+  "Return the region `font-lock-fontify-region' fontifies for START to END.
+The value is a cons (BEG . END), the region extended by
+`font-lock-extend-region-functions' as `font-lock-default-fontify-region'
+does it."
+  (with-syntax-table (or font-lock-syntax-table (syntax-table))
+    (let ((funs font-lock-extend-region-functions)
+          (font-lock-beg start)
+          (font-lock-end (min end (point-max))))
+      (save-excursion
+        (save-match-data
+          (while funs
+            (setq funs (if (or (not (funcall (car funs)))
+                               (eq funs font-lock-extend-region-functions))
+                           (cdr funs)
+                         font-lock-extend-region-functions)))))
+      (cons font-lock-beg font-lock-end))))
+
+(defun treesit--font-lock-prefontify-p ()
+  "Return non-nil if the current buffer's windows can be fontified early."
+  (and treesit-font-lock-prefontify-windows
+       jit-lock-mode
+       (null jit-lock-defer-timer)
+       (eq font-lock-fontify-region-function
+           #'font-lock-default-fontify-region)
+       (eq font-lock-fontify-syntactically-function
+           #'treesit-font-lock-fontify-region)
+       (not font-lock-keywords-only)
+       ;; Fast mode depends on the region queried.
+       (null treesit--font-lock-fast-mode)))
+
+(defun treesit--font-lock-prefontify-windows (&rest _)
+  "Fontify the text in visible windows that jit-lock hasn't fontified.
+Do that for all the windows whose buffers use tree-sitter for
+font-lock, running all the queries for them with
+`treesit-query-capture-batch'.  This is a member of
+`pre-redisplay-functions' when `treesit-font-lock-prefontify-windows'
+is non-nil."
+  (when treesit-font-lock-prefontify-windows
+    ;; Each chunk is a list (BUFFER START END REGION OVERRIDES), where
+    ;; START and END are what jit-lock would fontify, REGION is the
+    ;; region `treesit-font-lock-fontify-region' is then called for, and
+    ;; OVERRIDES has an element for each query that fontifies REGION.
+    (let ((chunks nil)
+          (jobs nil))
+      ;; Find the text that jit-lock would fontify in each window, and
+      ;; the queries that fontify it.
+      (dolist (window (window-list-1 nil 'nomini 'visible))
+        (with-current-buffer (window-buffer window)
+          (when (treesit--font-lock-prefontify-p)
+            (treesit--pre-redisplay)
+            (let* ((pos (window-start window))
+                   (limit (save-excursion
+                            (goto-char pos)
+                            (forward-line (window-body-height window))
+                            (point))))
+              (while (setq pos (text-property-any pos limit 'fontified nil))
+                (let ((next (or (text-property-any pos limit 'fontified t)
+                                limit)))
+                  (unless (seq-find (lambda (chunk)
+                                      (and (eq (nth 0 chunk) (current-buffer))
+                                           (eql (nth 1 chunk) pos)
+                                           (eql (nth 2 chunk) next)))
+                                    chunks)
+                    (let* ((region (treesit--font-lock-extend-region pos next))
+                           (range (progn
+                                    (treesit-update-ranges (car region)
+                                                           (cdr region))
+                                    (treesit--font-lock-query-range
+                                     (car region) (cdr region))))
+                           (overrides nil))
+                      (dolist (spec (treesit--font-lock-query-specs
+                                     (car region) (cdr region)))
+                        (push (list (nth 0 spec) (nth 1 spec)
+                                    (car range) (cdr range))
+                              jobs)
+                        (push (nth 2 spec) overrides))
+                      (push (list (current-buffer) pos next region
+                                  (nreverse overrides))
+                            chunks)))
+                  (setq pos next)))))))
+      (when chunks
+        (setq chunks (nreverse chunks))
+        ;; Run the queries, and record the results for
+        ;; `treesit-font-lock-fontify-region'.
+        (let ((results (treesit-query-capture-batch (nreverse jobs))))
+          (pcase-dolist (`(,buffer ,_ ,_ ,region ,overrides) chunks)
+            (let ((captures (mapcar (lambda (override)
+                                      (cons override (pop results)))
+                                    overrides)))
+              (with-current-buffer buffer
+                (push (cl-list* (buffer-chars-modified-tick)
+                                (car region) (cdr region) captures)
+                      treesit--font-lock-prefetched)))))
+        ;; Fontify the text as jit-lock would, then forget what wasn't
+        ;; used.
+        (unwind-protect
+            (pcase-dolist (`(,buffer ,start ,end . ,_) chunks)
+              (with-current-buffer buffer
+                (jit-lock-fontify-now start end)))
+          (dolist (chunk chunks)
+            (with-current-buffer (car chunk)
+              (setq treesit--font-lock-prefetched nil))))))))
 
 (defvar-local treesit--syntax-propertize-start nil
   "If non-nil, next `syntax-propertize' should start at this position.
@@ -4248,6 +4430,8 @@ treesit-major-mode-setup
                     . treesit-font-lock-fontify-region)))
     (treesit-font-lock-recompute-features)
     (add-hook 'pre-redisplay-functions #'treesit--pre-redisplay 0 t)
+    (add-hook 'pre-redisplay-functions
+              #'treesit--font-lock-prefontify-windows 10 t)
     (when treesit-primary-parser
       (treesit-parser-add-notifier
        treesit-primary-parser #'treesit--font-lock-mark-ranges-to-fontify))
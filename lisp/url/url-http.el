@@ -78,6 +78,26 @@ url-http-open-connections
 If Emacs is compiled with thread support, the key is a list `(host port
 thread)'.  Otherwise, it is a cons cell `(host . port)'.")
 
+(defvar url-http--busy-connections (make-hash-table :test 'equal)
+  "A hash table of the connections that are in use.
+The keys are as in `url-http-open-connections'.")
+
+(defvar url-http--pending-requests (make-hash-table :test 'equal)
+  "A hash table of the retrievals that wait for a connection.
+The keys are as in `url-http-open-connections', and the values are
+lists of functions that start the retrievals, first one first.")
+
+(defvar url-http--idle-timer nil
+  "Timer that closes connections idle for `url-http-idle-connection-timeout'.")
+
+(defconst url-http--request-variables
+  '(url-request-method url-request-extra-headers url-request-data
+    url-request-noninteractive url-using-proxy url-mime-accept-string
+    url-current-lastloc url-http-attempt-keepalives)
+  "Variables that `url-http' uses to make a request.
+A retrieval that waits for a connection uses the values that these
+variables had when it was requested.")
+
 (defvar url-http-version "1.1"
   "What version of HTTP we advertise, as a string.
 Valid values are 1.1 and 1.0.
@@ -158,31 +178,148 @@ url-http-debug
 (declare-function current-thread "thread.c" ())
 (declare-function thread-live-p "thread.c" (thread))
 
+(defun url-http--connection-key (host port)
+  "Return the key of connections to HOST and PORT in the current thread."
+  (if main-thread
+      (list host port (current-thread))
+    (cons host port)))
+
 (defun url-http-mark-connection-as-busy (host port proc)
-  (let ((key (if main-thread
-                 (list host port (current-thread))
-               (cons host port))))
+  (let ((key (url-http--connection-key host port)))
     (url-http-debug "Marking connection as busy: %s:%d %S" host port proc)
     (set-process-query-on-exit-flag proc t)
     (puthash key
              (delq proc (gethash key url-http-open-connections))
 	     url-http-open-connections)
+    (puthash key
+             (cons proc (delq proc (gethash key url-http--busy-connections)))
+             url-http--busy-connections)
     proc))
 
 (defun url-http-mark-connection-as-free (host port proc)
-  (let ((key (if main-thread
-                 (list host port (current-thread))
-               (cons host port))))
+  (let ((key (url-http--connection-key host port)))
     (url-http-debug "Marking connection as free: %s:%d %S" host port proc)
+    (puthash key
+             (delq proc (gethash key url-http--busy-connections))
+             url-http--busy-connections)
     (when (memq (process-status proc) '(open run connect))
       (set-process-buffer proc nil)
       (set-process-sentinel proc 'url-http-idle-sentinel)
       (set-process-query-on-exit-flag proc nil)
+      (process-put proc 'url-http-idle-since (float-time))
       (puthash key
-	       (cons proc (gethash key url-http-open-connections))
-	       url-http-open-connections))
+	       (cons proc (delq proc (gethash key url-http-open-connections)))
+	       url-http-open-connections)
+      (url-http--schedule-idle-timer))
+    (url-http--start-pending-request key)
     nil))
 
+(defun url-http--connection-expired-p (proc)
+  "Return non-nil if the idle connection PROC should be closed."
+  (and url-http-idle-connection-timeout
+       (> (- (float-time) (or (process-get proc 'url-http-idle-since) 0))
+          url-http-idle-connection-timeout)))
+
+(defun url-http--schedule-idle-timer ()
+  "Arrange for idle connections to be closed after they expire."
+  (when (and url-http-idle-connection-timeout
+             (not (memq url-http--idle-timer timer-list)))
+    (setq url-http--idle-timer
+          (run-with-timer url-http-idle-connection-timeout nil
+                          #'url-http--close-expired-connections))))
+
+(defun url-http--close-expired-connections ()
+  "Close the idle connections that have been idle for too long."
+  (let ((expired nil)
+        (idle nil))
+    (maphash (lambda (_key conns)
+               (dolist (proc conns)
+                 (if (url-http--connection-expired-p proc)
+                     (push proc expired)
+                   (setq idle t))))
+             url-http-open-connections)
+    (dolist (proc expired)
+      (url-http-debug "Closing idle connection %S" proc)
+      (url-http-idle-sentinel proc nil)
+      (delete-process proc))
+    (when idle
+      (url-http--schedule-idle-timer))))
+
+(defun url-http--busy-connection-count (key)
+  "Return the number of busy connections with KEY."
+  (let ((count 0))
+    (dolist (proc (gethash key url-http--busy-connections))
+      (when (process-live-p proc)
+        (setq count (1+ count))))
+    count))
+
+(defun url-http--must-wait-p (key)
+  "Return non-nil if a retrieval must wait for a connection with KEY.
+That is the case if `url-http-max-connections-per-host' connections
+with KEY are busy and none is free."
+  (and url-http-max-connections-per-host
+       ;; Requests are started from timers, which run in the main
+       ;; thread, so only the main thread waits.
+       (or (not main-thread) (eq (current-thread) main-thread))
+       (>= (url-http--busy-connection-count key)
+           url-http-max-connections-per-host)
+       (not (cl-some #'process-live-p
+                      (gethash key url-http-open-connections)))))
+
+(defun url-http--start-pending-request (key)
+  "Start the first retrieval that waits for a connection with KEY, if any.
+This happens from a timer, so that the connection that has just been
+freed can be reused."
+  (when (gethash key url-http--pending-requests)
+    (run-at-time 0 nil
+                 (lambda ()
+                   (let ((pending (gethash key url-http--pending-requests)))
+                     (when (and pending (not (url-http--must-wait-p key)))
+                       (if (cdr pending)
+                           (puthash key (cdr pending)
+                                    url-http--pending-requests)
+                         (remhash key url-http--pending-requests))
+                       (funcall (car pending))))))))
+
+(defun url-http--queue-request (url callback cbargs retry-buffer gateway-method)
+  "Arrange for `url-http' to retrieve URL when a connection is free.
+Return the retrieval buffer.  The other arguments are as in `url-http'."
+  (let ((buffer (or retry-buffer
+                    (generate-new-buffer
+                     (format " *http %s:%d*" (url-host url) (url-port url)))))
+        (key (url-http--connection-key (url-host url) (url-port url)))
+        (values (mapcar #'symbol-value url-http--request-variables)))
+    (url-http-debug "Waiting for a free connection: %s:%d"
+                    (url-host url) (url-port url))
+    (puthash key
+             (nconc
+              (gethash key url-http--pending-requests)
+              (list
+               (lambda ()
+                 (when (buffer-live-p buffer)
+                   (cl-progv url-http--request-variables values
+                     (condition-case err
+                         (progn
+                           (url-http--start url callback cbargs buffer
+                                            gateway-method)
+                           ;; The buffer is not one of a failed
+                           ;; attempt, so allow `url-http' to retry.
+                           (with-current-buffer buffer
+                             (setq url-http-no-retry retry-buffer)))
+                       (error
+                        (when (buffer-live-p buffer)
+                          (with-current-buffer buffer
+                            (apply callback
+                                   (cons (plist-put
+                                          (car cbargs) :error
+                                          (list 'error 'connection-failed
+                                                (error-message-string err)
+                                                :host (url-host url)
+                                                :service (url-port url)))
+                                         (cdr cbargs))))))))))))
+             url-http--pending-requests)
+    buffer))
+
 (defun url-http-find-free-connection (host port &optional gateway-method)
   (when main-thread
     (maphash
@@ -190,11 +327,8 @@ url-http-find-free-connection
        (unless (thread-live-p (caddr key))
          (remhash key url-http-open-connections)))
      url-http-open-connections))
-  (let ((conns (gethash
-                (if main-thread
-                    (list host port (current-thread))
-                  (cons host port))
-                url-http-open-connections))
+  (let ((conns (gethash (url-http--connection-key host port)
+                        url-http-open-connections))
 	(connection nil))
     (while (and conns (not connection))
       (if (not (memq (process-status (car conns)) '(run open connect)))
@@ -202,9 +336,15 @@ url-http-find-free-connection
 	    (url-http-debug "Cleaning up dead process: %s:%d %S"
 			    host port (car conns))
 	    (url-http-idle-sentinel (car conns) nil))
-	(setq connection (car conns))
-	(url-http-debug
-         "Found existing connection: %s:%d %S" host port connection))
+        (if (url-http--connection-expired-p (car conns))
+            (progn
+              (url-http-debug "Closing expired connection: %s:%d %S"
+                              host port (car conns))
+              (url-http-idle-sentinel (car conns) nil)
+              (delete-process (car conns)))
+	  (setq connection (car conns))
+	  (url-http-debug
+           "Found existing connection: %s:%d %S" host port connection)))
       (pop conns))
     (if connection
 	(url-http-debug "Reusing existing connection: %s:%d" host port)
@@ -1023,7 +1163,12 @@ url-http-idle-sentinel
   (maphash (lambda (key val)
 		(if (memq proc val)
 		    (puthash key (delq proc val) url-http-open-connections)))
-	      url-http-open-connections))
+	      url-http-open-connections)
+  (maphash (lambda (key val)
+             (when (memq proc val)
+               (puthash key (delq proc val) url-http--busy-connections)
+               (url-http--start-pending-request key)))
+           url-http--busy-connections))
 
 (defun url-http-end-of-document-sentinel (proc why)
   ;; Sentinel used to handle (i) terminated old HTTP/0.9 connections,
@@ -1338,6 +1483,14 @@ url-http
 
 The return value of this function is the retrieval buffer."
   (cl-check-type url url "Need a pre-parsed URL.")
+  (if (url-http--must-wait-p
+       (url-http--connection-key (url-host url) (url-port url)))
+      (url-http--queue-request url callback cbargs retry-buffer gateway-method)
+    (url-http--start url callback cbargs retry-buffer gateway-method)))
+
+(defun url-http--start (url callback cbargs &optional retry-buffer gateway-method)
+  "Retrieve URL via HTTP asynchronously, without waiting for a connection.
+The arguments and the return value are as in `url-http'."
   (let* (;; (host (url-host (or url-using-proxy url)))
 	 ;; (port (url-port (or url-using-proxy url)))
 	 (nsm-noninteractive (not (url-interactive-p)))
@@ -1353,10 +1506,13 @@ url-http
                       (format " *http %s:%d*" (url-host url) (url-port url)))))
          (referer (url-http--encode-string (url-http--get-referer url))))
     (if (not connection)
-	;; Failed to open the connection for some reason
+	;; Failed to open the connection for some reason.  A retry
+	;; buffer belongs to the caller, which reports the failure in
+	;; it.
 	(progn
-	  (kill-buffer buffer)
-	  (setq buffer nil)
+	  (unless retry-buffer
+	    (kill-buffer buffer)
+	    (setq buffer nil))
           (error "Could not create connection to %s:%d" (url-host url)
                  (url-port url)))
       (with-current-buffer buffer
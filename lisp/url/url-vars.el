@@ -313,6 +313,26 @@ url-show-status
   :type 'boolean
   :group 'url)
 
+(defcustom url-http-max-connections-per-host 6
+  "Maximum number of connections that HTTP retrievals open to one host.
+When this many connections to a host are busy, further retrievals
+from it wait until one of them is free, and then reuse it.  nil
+means there is no limit."
+  :type '(choice (const :tag "No limit" nil) natnum)
+  :version "31.1"
+  :group 'url)
+
+(defcustom url-http-idle-connection-timeout 60
+  "Seconds after which an idle HTTP connection is closed.
+HTTP connections are kept open after a retrieval, so that later
+retrievals from the same host can reuse them.  Servers close such
+connections after a while, and a retrieval that tries to reuse a
+connection that the server has just closed must be retried.  nil
+means keep idle connections until the server closes them."
+  :type '(choice (const :tag "Never" nil) number)
+  :version "31.1"
+  :group 'url)
+
 (defvar url-using-proxy nil
   "Either nil or the fully qualified proxy URL in use, e.g.
 https://www.example.com/")
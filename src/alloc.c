@@ -42,6 +42,7 @@ Copyright (C) 1985-2025 Free Software Foundation, Inc.
 #include "frame.h"
 #include "blockinput.h"
 #include "pdumper.h"
+#include "probes.h"
 #include "termhooks.h"		/* For struct terminal.  */
 #include "itree.h"
 #ifdef HAVE_WINDOW_SYSTEM
@@ -72,6 +73,10 @@ Copyright (C) 1985-2025 Free Software Foundation, Inc.
 # include <malloc.h>
 #endif
 
+#ifdef HAVE_MADVISE
+# include <sys/mman.h>
+#endif
+
 #if (defined ENABLE_CHECKING \
      && defined HAVE_VALGRIND_VALGRIND_H && !defined USE_VALGRIND)
 # define USE_VALGRIND 1
@@ -318,6 +323,27 @@ #define HI_THRESHOLD (EMACS_INT_MAX / 2)
   byte_ct total_hash_table_bytes;
 } gcstat;
 
+/* Phases of garbage collection whose duration is recorded in
+   `post-gc-statistics'.  */
+
+enum gc_phase
+  {
+    GC_PHASE_MARK,
+    GC_PHASE_WEAK_TABLES,
+    GC_PHASE_SWEEP_STRINGS,
+    GC_PHASE_COMPACT_STRINGS,
+    GC_PHASE_SWEEP_CONSES,
+    GC_PHASE_SWEEP_FLOATS,
+    GC_PHASE_SWEEP_INTERVALS,
+    GC_PHASE_SWEEP_SYMBOLS,
+    GC_PHASE_SWEEP_BUFFERS,
+    GC_PHASE_SWEEP_VECTORS,
+    GC_N_PHASES
+  };
+
+/* Time spent in each phase by the most recent garbage collection.  */
+static struct timespec gc_phase_time[GC_N_PHASES];
+
 /* Total size of ancillary arrays of all allocated hash-table and obarray
    objects, both dead and alive.  This number is always kept up-to-date.  */
 static ptrdiff_t hash_table_allocated_bytes = 0;
@@ -482,6 +508,26 @@ deadp (Lisp_Object x)
 
 static void *min_heap_address, *max_heap_address;
 
+/* Conservative stack marking looks up every word of the stacks with
+   mem_find, and most of them are not pointers into Lisp memory at
+   all.  To reject these quickly, mem_page_blocks counts, for each
+   page of memory, the blocks in the tree that overlap it.  Pages are
+   hashed into the table by their number modulo its size, so a zero
+   count proves that no block contains an address, and a nonzero count
+   means that the tree must be searched.  */
+
+enum { MEM_PAGE_SHIFT = 12, MEM_PAGE_TABLE_SIZE = 1 << 16 };
+
+static unsigned int mem_page_blocks[MEM_PAGE_TABLE_SIZE];
+
+/* Return the index in mem_page_blocks of the page containing P.  */
+
+static int
+mem_page_index (void const *p)
+{
+  return ((uintptr_t) p >> MEM_PAGE_SHIFT) & (MEM_PAGE_TABLE_SIZE - 1);
+}
+
 /* Sentinel node of the tree.  */
 
 static struct mem_node mem_z;
@@ -528,6 +574,100 @@ tally_consing (ptrdiff_t nbytes)
   consing_until_gc -= nbytes;
 }
 
+/* Heap profiler.  While it runs, one allocation is sampled every
+   heap_sample_interval bytes or so: the new object is recorded along
+   with the backtrace at the time of its allocation.  The objects are
+   held weakly, so the samples still present after a GC tell which
+   call sites allocated the memory that is still alive.  */
+
+/* True if the heap profiler is running.  */
+static bool heap_profiler_running;
+
+/* Number of bytes allocated between two samples, and until the next.  */
+static intmax_t heap_sample_interval;
+static intmax_t heap_bytes_until_sample;
+
+struct heap_sample
+{
+  /* The sampled object.  */
+  Lisp_Object object;
+
+  /* Number of bytes allocated since the previous sample, which this
+     sample stands for.  */
+  intmax_t weight;
+};
+
+/* The samples, and the backtraces where they were allocated, of
+   heap_sample_depth elements each.  */
+static struct heap_sample *heap_samples;
+static Lisp_Object *heap_sample_traces;
+static ptrdiff_t heap_samples_used, heap_samples_size;
+static int heap_sample_depth;
+
+/* Record that OBJ, of NBYTES bytes, was just allocated.  */
+
+static void
+heap_probe_1 (Lisp_Object obj, ptrdiff_t nbytes)
+{
+  heap_bytes_until_sample -= nbytes;
+  if (heap_bytes_until_sample > 0 || gc_in_progress)
+    return;
+
+  if (heap_samples_used == heap_samples_size)
+    {
+      heap_samples = xpalloc (heap_samples, &heap_samples_size, 1, -1,
+			      sizeof *heap_samples);
+      heap_sample_traces = xnrealloc (heap_sample_traces,
+				      heap_samples_size,
+				      heap_sample_depth
+				      * sizeof *heap_sample_traces);
+    }
+  ptrdiff_t i = heap_samples_used++;
+  heap_samples[i].object = obj;
+  heap_samples[i].weight = heap_sample_interval - heap_bytes_until_sample;
+  get_backtrace (heap_sample_traces + i * heap_sample_depth,
+		 heap_sample_depth);
+  heap_bytes_until_sample = heap_sample_interval;
+}
+
+static void
+heap_probe (Lisp_Object obj, ptrdiff_t nbytes)
+{
+  if (heap_profiler_running)
+    heap_probe_1 (obj, nbytes);
+}
+
+/* Mark the backtraces of the heap samples.  */
+
+static void
+mark_heap_samples (void)
+{
+  mark_objects (heap_sample_traces, heap_samples_used * heap_sample_depth);
+}
+
+/* Forget the samples whose object is not going to survive this GC.
+   Their backtraces are kept alive until the next GC; that is harmless
+   and avoids marking anything once the weak tables have been swept.  */
+
+static void
+prune_heap_samples (void)
+{
+  ptrdiff_t n = 0;
+  for (ptrdiff_t i = 0; i < heap_samples_used; i++)
+    if (survives_gc_p (heap_samples[i].object))
+      {
+	if (n != i)
+	  {
+	    heap_samples[n] = heap_samples[i];
+	    memcpy (heap_sample_traces + n * heap_sample_depth,
+		    heap_sample_traces + i * heap_sample_depth,
+		    heap_sample_depth * sizeof *heap_sample_traces);
+	  }
+	n++;
+      }
+  heap_samples_used = n;
+}
+
 #ifdef DOUG_LEA_MALLOC
 static bool
 pointers_fit_in_lispobj_p (void)
@@ -1350,6 +1490,7 @@ make_interval (void)
 
   tally_consing (sizeof (struct interval));
   intervals_consed++;
+  interval_tree_tick++;
   RESET_INTERVAL (val);
   val->gcmarkbit = 0;
   return val;
@@ -1477,6 +1618,9 @@ #define SDATA_DATA(S)	((struct sdata *) (S))->data
      of the sblock if there isn't any space left in this block.  */
   sdata *next_free;
 
+  /* True if compact_small_strings is compacting this block.  */
+  bool compacting;
+
   /* String data.  */
   sdata data[FLEXIBLE_ARRAY_MEMBER];
 };
@@ -1890,6 +2034,7 @@ allocate_string_data (struct Lisp_String *s,
 #endif
 
   tally_consing (needed);
+  heap_probe (make_lisp_ptr (s, Lisp_String), sizeof *s + needed);
 }
 
 /* Reallocate multibyte STRING data when a single character is replaced.
@@ -2045,7 +2190,10 @@ sweep_strings (void)
 
   string_blocks = live_blocks;
   free_large_strings ();
+  struct timespec compact_start = current_timespec ();
   compact_small_strings ();
+  gc_phase_time[GC_PHASE_COMPACT_STRINGS]
+    = timespec_sub (current_timespec (), compact_start);
 
   check_string_free_list ();
 }
@@ -2076,15 +2224,65 @@ free_large_strings (void)
 }
 
 
+/* Return the address just past the sdata FROM, which is in a block
+   of small strings.  */
+
+static sdata *
+sdata_next (sdata *from)
+{
+  struct Lisp_String *s = from->string;
+
+#ifdef GC_CHECK_STRING_BYTES
+  /* Check that the string size recorded in the string is the
+     same as the one recorded in the sdata structure.  */
+  if (s && string_bytes (s) != SDATA_NBYTES (from))
+    emacs_abort ();
+#endif /* GC_CHECK_STRING_BYTES */
+
+  ptrdiff_t nbytes = s ? STRING_BYTES (s) : SDATA_NBYTES (from);
+  eassert (nbytes <= LARGE_STRING_BYTES);
+  return (sdata *) ((char *) from + sdata_size (nbytes) + GC_STRING_EXTRA);
+}
+
+/* Return true if so much of sblock B is taken by the data of dead
+   strings that it is worth compacting.  Blocks that are only slightly
+   fragmented are left alone, so that their live strings need not be
+   copied at every garbage collection; the space of their dead strings
+   is reclaimed once enough of it accumulates.  */
+
+static bool
+sblock_fragmented_p (struct sblock *b)
+{
+  ptrdiff_t dead = 0;
+  for (sdata *from = b->data; from < b->next_free; )
+    {
+      sdata *from_end = sdata_next (from);
+      if (!from->string)
+	dead += (char *) from_end - (char *) from;
+      from = from_end;
+    }
+  return SBLOCK_SIZE / 8 < dead;
+}
+
 /* Compact data of small strings.  Free sblocks that don't contain
    data of live strings after compaction.  */
 
 static void
 compact_small_strings (void)
 {
+  /* Decide which blocks to compact.  The youngest block is always
+     compacted, so that there is a block to allocate from.  */
+  struct sblock *b;
+  for (b = oldest_sblock; b; b = b->next)
+    b->compacting = !b->next || sblock_fragmented_p (b);
+
   /* TB is the sblock we copy to, TO is the sdata within TB we copy
-     to, and TB_END is the end of TB.  */
+     to, and TB_END is the end of TB.  Only blocks being compacted
+     are copied to or from; since they are visited in the same order,
+     TO never overtakes the data being copied.  */
   struct sblock *tb = oldest_sblock;
+  while (tb && !tb->compacting)
+    tb = tb->next;
   if (tb)
     {
       sdata *tb_end = (sdata *) ((char *) tb + SBLOCK_SIZE);
@@ -2093,9 +2291,11 @@ compact_small_strings (void)
       /* Step through the blocks from the oldest to the youngest.  We
 	 expect that old blocks will stabilize over time, so that less
 	 copying will happen this way.  */
-      struct sblock *b = tb;
-      do
+      for (b = tb; b; b = b->next)
 	{
+	  if (!b->compacting)
+	    continue;
+
 	  sdata *end = b->next_free;
 	  eassert ((char *) end <= (char *) b + SBLOCK_SIZE);
 
@@ -2103,22 +2303,10 @@ compact_small_strings (void)
 	    {
 	      /* Compute the next FROM here because copying below may
 		 overwrite data we need to compute it.  */
-	      ptrdiff_t nbytes;
 	      struct Lisp_String *s = from->string;
-
-#ifdef GC_CHECK_STRING_BYTES
-	      /* Check that the string size recorded in the string is the
-		 same as the one recorded in the sdata structure.  */
-	      if (s && string_bytes (s) != SDATA_NBYTES (from))
-		emacs_abort ();
-#endif /* GC_CHECK_STRING_BYTES */
-
-	      nbytes = s ? STRING_BYTES (s) : SDATA_NBYTES (from);
-	      eassert (nbytes <= LARGE_STRING_BYTES);
-
+	      ptrdiff_t nbytes = s ? STRING_BYTES (s) : SDATA_NBYTES (from);
 	      ptrdiff_t size = sdata_size (nbytes);
-	      sdata *from_end = (sdata *) ((char *) from
-					   + size + GC_STRING_EXTRA);
+	      sdata *from_end = sdata_next (from);
 
 #ifdef GC_CHECK_STRING_OVERRUN
 	      if (memcmp (string_overrun_cookie,
@@ -2130,13 +2318,16 @@ compact_small_strings (void)
 	      /* Non-NULL S means it's alive.  Copy its data.  */
 	      if (s)
 		{
-		  /* If TB is full, proceed with the next sblock.  */
+		  /* If TB is full, proceed with the next sblock being
+		     compacted.  */
 		  sdata *to_end = (sdata *) ((char *) to
 					     + size + GC_STRING_EXTRA);
 		  if (to_end > tb_end)
 		    {
 		      tb->next_free = to;
-		      tb = tb->next;
+		      do
+			tb = tb->next;
+		      while (!tb->compacting);
 		      tb_end = (sdata *) ((char *) tb + SBLOCK_SIZE);
 		      to = tb->data;
 		      to_end = (sdata *) ((char *) to + size + GC_STRING_EXTRA);
@@ -2156,24 +2347,28 @@ compact_small_strings (void)
 		}
 	      from = from_end;
 	    }
-	  b = b->next;
-	}
-      while (b);
-
-      /* The rest of the sblocks following TB don't contain live data, so
-	 we can free them.  */
-      for (b = tb->next; b; )
-	{
-	  struct sblock *next = b->next;
-	  lisp_free (b);
-	  b = next;
 	}
 
       tb->next_free = to;
-      tb->next = NULL;
+
+      /* The compacted sblocks following TB don't contain live data, so
+	 we can free them.  Blocks that were left alone stay.  */
+      struct sblock **prev = &tb->next;
+      while ((b = *prev))
+	if (b->compacting)
+	  {
+	    *prev = b->next;
+	    lisp_free (b);
+	  }
+	else
+	  prev = &b->next;
     }
 
-  current_sblock = tb;
+  /* Allocation continues in the youngest block.  */
+  for (current_sblock = oldest_sblock;
+       current_sblock && current_sblock->next;
+       current_sblock = current_sblock->next)
+    continue;
 }
 
 void
@@ -2541,10 +2736,6 @@ #define SETMARKBIT(block,n)				\
   ((block)->gcmarkbits[(n) / BITS_PER_BITS_WORD]	\
    |= (bits_word) 1 << ((n) % BITS_PER_BITS_WORD))
 
-#define UNSETMARKBIT(block,n)				\
-  ((block)->gcmarkbits[(n) / BITS_PER_BITS_WORD]	\
-   &= ~((bits_word) 1 << ((n) % BITS_PER_BITS_WORD)))
-
 #define FLOAT_BLOCK(fptr) \
   (eassert (!pdumper_object_p (fptr)),                                  \
    ((struct float_block *) (((uintptr_t) (fptr)) & ~(BLOCK_ALIGN - 1))))
@@ -2566,9 +2757,6 @@ #define XFLOAT_MARKED_P(fptr) \
 #define XFLOAT_MARK(fptr) \
   SETMARKBIT (FLOAT_BLOCK (fptr), FLOAT_INDEX (fptr))
 
-#define XFLOAT_UNMARK(fptr) \
-  UNSETMARKBIT (FLOAT_BLOCK (fptr), FLOAT_INDEX (fptr))
-
 #if GC_ASAN_POISON_OBJECTS
 # define ASAN_POISON_FLOAT_BLOCK(fblk)         \
   __asan_poison_memory_region ((fblk)->floats, \
@@ -2637,6 +2825,7 @@ make_float (double float_value)
   eassert (!XFLOAT_MARKED_P (XFLOAT (val)));
   tally_consing (sizeof (struct Lisp_Float));
   floats_consed++;
+  heap_probe (val, sizeof (struct Lisp_Float));
   return val;
 }
 
@@ -2678,9 +2867,6 @@ #define XCONS_MARKED_P(fptr) \
 #define XMARK_CONS(fptr) \
   SETMARKBIT (CONS_BLOCK (fptr), CONS_INDEX (fptr))
 
-#define XUNMARK_CONS(fptr) \
-  UNSETMARKBIT (CONS_BLOCK (fptr), CONS_INDEX (fptr))
-
 /* Minimum number of bytes of consing since GC before next GC,
    when memory is full.  */
 
@@ -2724,18 +2910,19 @@ free_cons (struct Lisp_Cons *ptr)
   ASAN_POISON_CONS (ptr);
 }
 
-DEFUN ("cons", Fcons, Scons, 2, 2, 0,
-       doc: /* Create a new cons, give it CAR and CDR as components, and return it.  */)
-  (Lisp_Object car, Lisp_Object cdr)
-{
-  register Lisp_Object val;
+/* Return a new cons cell, with uninitialized contents.  The caller
+   must have blocked input with MALLOC_BLOCK_INPUT, and is responsible
+   for updating consing_until_gc and cons_cells_consed.  */
 
-  MALLOC_BLOCK_INPUT;
+static struct Lisp_Cons *
+allocate_cons_cell (void)
+{
+  struct Lisp_Cons *c;
 
   if (cons_free_list)
     {
       ASAN_UNPOISON_CONS (cons_free_list);
-      XSETCONS (val, cons_free_list);
+      c = cons_free_list;
       cons_free_list = cons_free_list->u.s.u.chain;
     }
   else
@@ -2751,10 +2938,21 @@ DEFUN ("cons", Fcons, Scons, 2, 2, 0,
 	  cons_block_index = 0;
 	}
       ASAN_UNPOISON_CONS (&cons_block->conses[cons_block_index]);
-      XSETCONS (val, &cons_block->conses[cons_block_index]);
+      c = &cons_block->conses[cons_block_index];
       cons_block_index++;
     }
 
+  return c;
+}
+
+DEFUN ("cons", Fcons, Scons, 2, 2, 0,
+       doc: /* Create a new cons, give it CAR and CDR as components, and return it.  */)
+  (Lisp_Object car, Lisp_Object cdr)
+{
+  register Lisp_Object val;
+
+  MALLOC_BLOCK_INPUT;
+  XSETCONS (val, allocate_cons_cell ());
   MALLOC_UNBLOCK_INPUT;
 
   XSETCAR (val, car);
@@ -2762,6 +2960,7 @@ DEFUN ("cons", Fcons, Scons, 2, 2, 0,
   eassert (!XCONS_MARKED_P (XCONS (val)));
   consing_until_gc -= sizeof (struct Lisp_Cons);
   cons_cells_consed++;
+  heap_probe (val, sizeof (struct Lisp_Cons));
   return val;
 }
 
@@ -2834,14 +3033,33 @@ DEFUN ("list", Flist, Slist, 0, MANY, 0,
 usage: (list &rest OBJECTS)  */)
   (ptrdiff_t nargs, Lisp_Object *args)
 {
-  register Lisp_Object val;
-  val = Qnil;
+  return list_from_array (nargs, args, Qnil);
+}
+
+/* Return the list (ARGS[0] ... ARGS[NARGS - 1] . TAIL).  This is
+   equivalent to calling Fcons NARGS times, but faster, since the
+   conses are allocated in one go and the allocation counters are
+   updated only once.  Use it in C code that collects the elements of
+   a large list before building it.  */
+
+Lisp_Object
+list_from_array (ptrdiff_t nargs, Lisp_Object const *args, Lisp_Object tail)
+{
+  Lisp_Object val = tail;
 
-  while (nargs > 0)
+  MALLOC_BLOCK_INPUT;
+  for (ptrdiff_t i = nargs - 1; 0 <= i; i--)
     {
-      nargs--;
-      val = Fcons (args[nargs], val);
+      struct Lisp_Cons *c = allocate_cons_cell ();
+      c->u.s.car = args[i];
+      c->u.s.u.cdr = val;
+      eassert (!XCONS_MARKED_P (c));
+      XSETCONS (val, c);
     }
+  MALLOC_UNBLOCK_INPUT;
+
+  consing_until_gc -= nargs * sizeof (struct Lisp_Cons);
+  cons_cells_consed += nargs;
   return val;
 }
 
@@ -3323,16 +3541,20 @@ cleanup_vector (struct Lisp_Vector *vector)
 	    eassert (h->index_bits > 0);
 	    xfree (h->index);
 	    xfree (h->key_and_value);
-	    xfree (h->next);
-	    xfree (h->hash);
+	    xfree (h->hash_and_next);
 	    ptrdiff_t bytes = (h->table_size * (2 * sizeof *h->key_and_value
-						+ sizeof *h->hash
-						+ sizeof *h->next)
+						+ sizeof *h->hash_and_next)
 			       + hash_table_index_size (h) * sizeof *h->index);
 	    hash_table_allocated_bytes -= bytes;
 	  }
       }
       break;
+    case PVEC_JSON_PARSER:
+      xfree (PSEUDOVEC_STRUCT (vector, Lisp_JSON_Parser)->input);
+      break;
+    case PVEC_REGION_CACHE:
+      free_lisp_region_cache (PSEUDOVEC_STRUCT (vector, Lisp_Region_Cache));
+      break;
     case PVEC_OBARRAY:
       {
 	struct Lisp_Obarray *o = PSEUDOVEC_STRUCT (vector, Lisp_Obarray);
@@ -3358,6 +3580,7 @@ cleanup_vector (struct Lisp_Vector *vector)
     case PVEC_XWIDGET_VIEW:
     case PVEC_TS_NODE:
     case PVEC_SQLITE:
+    case PVEC_CHANNEL:
     case PVEC_CLOSURE:
     case PVEC_CHAR_TABLE:
     case PVEC_SUB_CHAR_TABLE:
@@ -3520,6 +3743,9 @@ allocate_vectorlike (ptrdiff_t len, bool clearit)
 
   MALLOC_UNBLOCK_INPUT;
 
+  /* The caller initializes the header before the next GC.  */
+  heap_probe (make_lisp_ptr (p, Lisp_Vectorlike), nbytes);
+
   return p;
 }
 
@@ -3847,6 +4073,7 @@ DEFUN ("make-symbol", Fmake_symbol, Smake_symbol, 1, 1, 0,
   init_symbol (val, name);
   tally_consing (sizeof (struct Lisp_Symbol));
   symbols_consed++;
+  heap_probe (val, sizeof (struct Lisp_Symbol));
   return val;
 }
 
@@ -3927,8 +4154,7 @@ build_marker (struct buffer *buf, ptrdiff_t charpos, ptrdiff_t bytepos)
   m->bytepos = bytepos;
   m->insertion_type = 0;
   m->need_adjustment = 0;
-  m->next = BUF_MARKERS (buf);
-  BUF_MARKERS (buf) = m;
+  chain_marker (m, buf);
   return make_lisp_ptr (m, Lisp_Vectorlike);
 }
 
@@ -4358,7 +4584,8 @@ mem_find (void *start)
 {
   struct mem_node *p;
 
-  if (start < min_heap_address || start > max_heap_address)
+  if (start < min_heap_address || start > max_heap_address
+      || !mem_page_blocks[mem_page_index (start)])
     return MEM_NIL;
 
   /* Make the search always successful to speed up the loop below.  */
@@ -4372,6 +4599,75 @@ mem_find (void *start)
 }
 
 
+/* Add INCR to the block counts of the pages that the block of memory
+   from START to END overlaps.  */
+
+static void
+mem_count_pages (void *start, void *end, int incr)
+{
+  uintptr_t first = (uintptr_t) start >> MEM_PAGE_SHIFT;
+  uintptr_t last = ((uintptr_t) end - 1) >> MEM_PAGE_SHIFT;
+
+  /* Consecutive pages use consecutive entries of the table, so any
+     MEM_PAGE_TABLE_SIZE of them use all of its entries.  */
+  uintptr_t npages = min (last - first + 1, MEM_PAGE_TABLE_SIZE);
+  for (uintptr_t i = 0; i < npages; i++)
+    mem_page_blocks[(first + i) & (MEM_PAGE_TABLE_SIZE - 1)] += incr;
+}
+
+
+#if defined HAVE_MADVISE && defined MADV_HUGEPAGE
+
+/* The size of a transparent huge page.  */
+enum { HUGE_PAGE_SIZE = 2 * 1024 * 1024 };
+
+/* If `gc-huge-pages' is non-nil, advise the system to back the new
+   block of Lisp memory from START to END with huge pages.  A block
+   that spans huge pages of its own, such as a large vector, is a
+   mapping of its own, so advise only the huge pages within it.  A
+   smaller block is part of malloc's heap, so advise the huge page
+   around it, unless the previous call already did, and also the next
+   one, so that the advice precedes the first use of its memory when
+   malloc carves the following blocks from it.  */
+
+static void
+mem_advise_huge_pages (void *start, void *end)
+{
+  static uintptr_t last_advised;
+
+  if (!gc_huge_pages)
+    return;
+
+  uintptr_t lo = (uintptr_t) start, hi = (uintptr_t) end;
+  if (hi - lo >= HUGE_PAGE_SIZE)
+    {
+      lo = ROUNDUP (lo, HUGE_PAGE_SIZE);
+      hi &= -HUGE_PAGE_SIZE;
+    }
+  else
+    {
+      lo &= -HUGE_PAGE_SIZE;
+      hi = ROUNDUP (hi, HUGE_PAGE_SIZE) + HUGE_PAGE_SIZE;
+      if (lo == last_advised && hi - lo == 2 * HUGE_PAGE_SIZE)
+	return;
+      last_advised = hi - 2 * HUGE_PAGE_SIZE;
+    }
+
+  /* This fails harmlessly for ranges that are not entirely mapped,
+     and on systems without transparent huge pages.  */
+  if (lo < hi)
+    madvise ((void *) lo, hi - lo, MADV_HUGEPAGE);
+}
+
+#else
+
+static void
+mem_advise_huge_pages (void *start, void *end)
+{
+}
+
+#endif
+
 /* Insert a new node into the tree for a block of memory with start
    address START, end address END, and type TYPE.  Value is a
    pointer to the node that was inserted.  */
@@ -4385,6 +4681,8 @@ mem_insert (void *start, void *end, enum mem_type type)
     min_heap_address = start;
   if (max_heap_address == NULL || end > max_heap_address)
     max_heap_address = end;
+  mem_count_pages (start, end, 1);
+  mem_advise_huge_pages (start, end);
 
   /* See where in the tree a node for START belongs.  In this
      particular application, it shouldn't happen that a node is already
@@ -4588,6 +4886,8 @@ mem_delete (struct mem_node *z)
   if (!z || z == MEM_NIL)
     return;
 
+  mem_count_pages (z->start, z->end, -1);
+
   if (z->left == MEM_NIL || z->right == MEM_NIL)
     y = z;
   else
@@ -4991,6 +5291,19 @@ live_small_vector_p (struct mem_node *m, void *p)
   return live_small_vector_holding (m, p) == p;
 }
 
+/* Return true if P might point to Lisp data, because it points into
+   the dump or into a page that overlaps blocks of Lisp memory.  This
+   is much cheaper than mark_maybe_pointer, and false for most words
+   on the stack.  */
+
+static bool
+maybe_lisp_pointer_p (void *p)
+{
+  return (pdumper_object_p (p)
+	  || (min_heap_address <= p && p <= max_heap_address
+	      && mem_page_blocks[mem_page_index (p)]));
+}
+
 /* If P points to Lisp data, mark that as live if it isn't already
    marked.  */
 
@@ -5173,9 +5486,12 @@ mark_memory (void const *start, void const *end)
 
 #if !USE_LSB_TAG && !defined WIDE_EMACS_INT
       ip = (intptr_t) p;
-      mark_maybe_pointer ((void *) (ip & VALMASK), false);
+      void *q = (void *) (ip & VALMASK);
+      if (maybe_lisp_pointer_p (q))
+	mark_maybe_pointer (q, false);
 #else /* USE_LSB_TAG || WIDE_EMACS_INT */
-      mark_maybe_pointer (p, false);
+      if (maybe_lisp_pointer_p (p))
+	mark_maybe_pointer (p, false);
 #endif /* USE_LSB_TAG || WIDE_EMACS_INT */
 
       /* Unmask any struct Lisp_Symbol pointer that make_lisp_symbol
@@ -5184,7 +5500,8 @@ mark_memory (void const *start, void const *end)
 	 a Lisp_Object might be split into registers saved into
 	 non-adjacent words and P might be the low-order word's value.  */
       ckd_add (&ip, (intptr_t) p, (intptr_t) lispsym);
-      mark_maybe_pointer ((void *) ip, true);
+      if (maybe_lisp_pointer_p ((void *) ip))
+	mark_maybe_pointer ((void *) ip, true);
     }
 }
 
@@ -5809,11 +6126,39 @@ mark_object_root_visitor (Lisp_Object const *root_ptr,
    NULL on entry to garbage_collect and after it returns.  */
 static struct Lisp_Hash_Table *weak_hash_tables;
 
+/* What the most recent garbage collection did with a weak hash table.
+   The table itself is not kept, as it may be freed by the next one.  */
+struct weak_table_sweep
+{
+  /* The table, valid only while it is being processed.  */
+  struct Lisp_Hash_Table *table;
+
+  /* Weakness and number of entries of the table before the sweep.  */
+  hash_table_weakness_t weakness;
+  ptrdiff_t entries;
+
+  /* Number of entries examined, counting each pass over the table.  */
+  ptrdiff_t scanned;
+
+  /* Start in weak_table_pending of the indices of the entries that
+     could not be kept yet, and their number.  When marking is done,
+     these are the entries removed from the table.  */
+  ptrdiff_t start, pending;
+};
+
+/* The weak hash tables processed by the most recent collection.  */
+static struct weak_table_sweep *weak_table_sweeps;
+static ptrdiff_t weak_table_sweeps_size, n_weak_table_sweeps;
+
+/* Indices of pending entries of all tables in weak_table_sweeps.  */
+static hash_idx_t *weak_table_pending;
+static ptrdiff_t weak_table_pending_size;
+
 NO_INLINE /* For better stack traces */
 static void
 mark_and_sweep_weak_table_contents (void)
 {
-  struct Lisp_Hash_Table *h;
+  ptrdiff_t pending_used = 0;
   bool marked;
 
   /* Mark all keys and values that are in use.  Keep on marking until
@@ -5821,25 +6166,86 @@ mark_and_sweep_weak_table_contents (void)
      value-weak table A containing an entry X -> Y, where Y is used in a
      key-weak table B, Z -> Y.  If B comes after A in the list of weak
      tables, X -> Y might be removed from A, although when looking at B
-     one finds that it shouldn't.  */
+     one finds that it shouldn't.
+
+     Each table is examined in full only once, when it is found.  Later
+     passes look only at its entries that could not be kept so far, and
+     skip the table entirely once all its entries are kept.  */
+  n_weak_table_sweeps = 0;
   do
     {
       marked = false;
-      for (h = weak_hash_tables; h; h = h->next_weak)
-        marked |= sweep_weak_table (h, false);
+
+      for (ptrdiff_t t = 0; t < n_weak_table_sweeps; t++)
+	{
+	  struct weak_table_sweep *s = &weak_table_sweeps[t];
+	  if (s->pending > 0)
+	    {
+	      s->scanned += s->pending;
+	      s->pending = mark_weak_table (s->table,
+					    weak_table_pending + s->start,
+					    s->pending, &marked);
+	    }
+	}
+
+      /* Examine the tables found since the previous pass, including
+	 those found by marking the contents of other tables.  */
+      while (weak_hash_tables)
+	{
+	  struct Lisp_Hash_Table *h = weak_hash_tables;
+	  weak_hash_tables = h->next_weak;
+	  h->next_weak = NULL;
+
+	  if (n_weak_table_sweeps == weak_table_sweeps_size)
+	    weak_table_sweeps = xpalloc (weak_table_sweeps,
+					 &weak_table_sweeps_size, 1, -1,
+					 sizeof *weak_table_sweeps);
+	  if (weak_table_pending_size - pending_used < h->count)
+	    weak_table_pending
+	      = xpalloc (weak_table_pending, &weak_table_pending_size,
+			 h->count - (weak_table_pending_size - pending_used),
+			 -1, sizeof *weak_table_pending);
+
+	  struct weak_table_sweep *s
+	    = &weak_table_sweeps[n_weak_table_sweeps++];
+	  s->table = h;
+	  s->weakness = h->weakness;
+	  s->entries = h->count;
+	  s->scanned = h->count;
+	  s->start = pending_used;
+	  s->pending = mark_weak_table (h, weak_table_pending + s->start,
+					-1, &marked);
+	  pending_used += s->pending;
+	}
     }
   while (marked);
 
   /* Remove hash table entries that aren't used.  */
-  while (weak_hash_tables)
+  for (ptrdiff_t t = 0; t < n_weak_table_sweeps; t++)
     {
-      h = weak_hash_tables;
-      weak_hash_tables = h->next_weak;
-      h->next_weak = NULL;
-      sweep_weak_table (h, true);
+      struct weak_table_sweep *s = &weak_table_sweeps[t];
+      sweep_weak_table (s->table, weak_table_pending + s->start,
+			s->pending);
+      s->table = NULL;
     }
 }
 
+/* Return the `weak-tables' element of `post-gc-statistics'.  */
+static Lisp_Object
+weak_table_statistics (void)
+{
+  Lisp_Object tables = Qnil;
+  for (ptrdiff_t t = n_weak_table_sweeps - 1; t >= 0; t--)
+    {
+      struct weak_table_sweep *s = &weak_table_sweeps[t];
+      tables = Fcons (list4 (hash_table_weakness_symbol (s->weakness),
+			     make_int (s->entries), make_int (s->scanned),
+			     make_int (s->pending)),
+		      tables);
+    }
+  return Fcons (Qweak_tables, tables);
+}
+
 /* Return the number of bytes to cons between GCs, given THRESHOLD and
    PERCENTAGE.  When calculating a threshold based on PERCENTAGE,
    assume SINCE_GC bytes have been allocated since the most recent GC.
@@ -5918,6 +6324,134 @@ maybe_garbage_collect (void)
 
 static inline bool mark_stack_empty_p (void);
 
+/* Values of the allocation counters and of gcstat after the previous
+   collection, which let gc_statistics compute how much was freed.  */
+static intmax_t last_conses, last_floats, last_symbols, last_strings;
+static intmax_t last_string_chars, last_vector_cells, last_intervals;
+static struct gcstat last_gcstat;
+
+static void
+record_consing_counters (void)
+{
+  last_conses = cons_cells_consed;
+  last_floats = floats_consed;
+  last_symbols = symbols_consed;
+  last_strings = strings_consed;
+  last_string_chars = string_chars_consed;
+  last_vector_cells = vector_cells_consed;
+  last_intervals = intervals_consed;
+}
+
+#ifdef HAVE_MALLOC_TRIM
+
+/* Return the size of the resident set of Emacs in bytes, or -1 if it
+   is unknown.  */
+static intmax_t
+resident_set_size (void)
+{
+#ifdef GNU_LINUX
+  char buf[128];
+  int fd = emacs_open_noquit ("/proc/self/statm", O_RDONLY, 0);
+  if (fd < 0)
+    return -1;
+  ptrdiff_t nread = emacs_read (fd, buf, sizeof buf - 1);
+  emacs_close (fd);
+  if (nread <= 0)
+    return -1;
+  buf[nread] = '\0';
+  intmax_t size, resident;
+  if (sscanf (buf, "%jd %jd", &size, &resident) != 2)
+    return -1;
+  return resident * getpagesize ();
+#else
+  return -1;
+#endif
+}
+
+#endif
+
+/* Ask the C library to return free heap memory to the system, if the
+   garbage collection that has just finished reduced the bytes used by
+   Lisp objects from BEFORE to AFTER by more than `gc-trim-fraction'
+   of BEFORE.  Return the number of bytes released, as far as the size
+   of the resident set tells.  */
+static intmax_t
+gc_trim_heap (byte_ct before, byte_ct after)
+{
+#ifdef HAVE_MALLOC_TRIM
+  if (NUMBERP (Vgc_trim_fraction) && after < before
+      && before - after > XFLOATINT (Vgc_trim_fraction) * before)
+    {
+      intmax_t rss_before = resident_set_size ();
+      /* Leave room at the top of the heap for the allocations that
+	 lead to the next collection.  */
+      malloc_trim (gc_threshold);
+      intmax_t rss_after = resident_set_size ();
+      if (0 <= rss_after && rss_after < rss_before)
+	return rss_before - rss_after;
+    }
+#endif
+  return 0;
+}
+
+/* Return the value of `post-gc-statistics' for a garbage collection
+   that took ELAPSED, released RELEASED bytes to the system, and has
+   just finished.  */
+static Lisp_Object
+gc_statistics (struct timespec elapsed, intmax_t released)
+{
+#define PHASE(name, phase) \
+  Fcons (name, make_float (timespectod (gc_phase_time[phase])))
+
+  Lisp_Object phases
+    = list (PHASE (Qmark, GC_PHASE_MARK),
+	    PHASE (Qweak_tables, GC_PHASE_WEAK_TABLES),
+	    PHASE (Qsweep_strings, GC_PHASE_SWEEP_STRINGS),
+	    PHASE (Qcompact_strings, GC_PHASE_COMPACT_STRINGS),
+	    PHASE (Qsweep_conses, GC_PHASE_SWEEP_CONSES),
+	    PHASE (Qsweep_floats, GC_PHASE_SWEEP_FLOATS),
+	    PHASE (Qsweep_intervals, GC_PHASE_SWEEP_INTERVALS),
+	    PHASE (Qsweep_symbols, GC_PHASE_SWEEP_SYMBOLS),
+	    PHASE (Qsweep_buffers, GC_PHASE_SWEEP_BUFFERS),
+	    PHASE (Qsweep_vectors, GC_PHASE_SWEEP_VECTORS));
+#undef PHASE
+
+  /* The number of objects of a type freed is the number of objects
+     alive after the previous collection, plus the number allocated
+     since, minus the number alive now.  */
+#define FREED(type, last_consed, consed, size)				\
+  Fcons (Q##type,							\
+	 make_int (max (0, ((intmax_t) last_gcstat.total_##type		\
+			    + (consed - last_consed)			\
+			    - (intmax_t) gcstat.total_##type))		\
+		   * (size)))
+
+  Lisp_Object freed
+    = list (FREED (conses, last_conses, cons_cells_consed,
+		   sizeof (struct Lisp_Cons)),
+	    FREED (floats, last_floats, floats_consed,
+		   sizeof (struct Lisp_Float)),
+	    FREED (symbols, last_symbols, symbols_consed,
+		   sizeof (struct Lisp_Symbol)),
+	    FREED (strings, last_strings, strings_consed,
+		   sizeof (struct Lisp_String)),
+	    FREED (string_bytes, last_string_chars, string_chars_consed, 1),
+	    FREED (vector_slots, last_vector_cells, vector_cells_consed,
+		   word_size),
+	    FREED (intervals, last_intervals, intervals_consed,
+		   sizeof (struct interval)));
+#undef FREED
+
+  record_consing_counters ();
+  last_gcstat = gcstat;
+
+  return list5 (Fcons (Qelapsed, make_float (timespectod (elapsed))),
+		Fcons (Qphases, phases),
+		Fcons (Qfreed, freed),
+		weak_table_statistics (),
+		Fcons (Qreleased, make_int (released)));
+}
+
 /* Subroutine of Fgarbage_collect that does most of the work.  */
 void
 garbage_collect (void)
@@ -5935,6 +6469,8 @@ garbage_collect (void)
 
   eassert(mark_stack_empty_p ());
 
+  EMACS_PROBE1 (gc_start, gcs_done);
+
   /* Record this function, so it appears on the profiler's backtraces.  */
   record_in_backtrace (QAutomatic_GC, 0, 0);
 
@@ -5949,6 +6485,11 @@ garbage_collect (void)
 
   start = current_timespec ();
 
+  /* The bytes used by Lisp objects now: those that survived the last
+     collection, and those allocated since.  */
+  byte_ct heap_before = (total_bytes_of_live_objects ()
+			 + max (0, gc_threshold - consing_until_gc));
+
   /* In case user calls debug_print during GC,
      don't let that cause a recursive GC.  */
   consing_until_gc = HI_THRESHOLD;
@@ -5998,9 +6539,12 @@ garbage_collect (void)
   block_input ();
 
   shrink_regexp_cache ();
+  clear_bignum_cache ();
 
   gc_in_progress = 1;
 
+  struct timespec phase_start = current_timespec ();
+
   /* Mark all the special slots that serve as the roots of accessibility.  */
 
   struct gc_root_visitor visitor = { .visit = mark_object_root_visitor };
@@ -6012,7 +6556,9 @@ garbage_collect (void)
   mark_threads ();
   mark_charset ();
   mark_composite ();
+  mark_regexp_cache ();
   mark_profiler ();
+  mark_heap_samples ();
 #ifdef HAVE_PGTK
   mark_pgtkterm ();
 #endif
@@ -6072,9 +6618,17 @@ garbage_collect (void)
   queue_doomed_finalizers (&doomed_finalizers, &finalizers);
   mark_finalizer_list (&doomed_finalizers);
 
+  struct timespec now = current_timespec ();
+  gc_phase_time[GC_PHASE_MARK] = timespec_sub (now, phase_start);
+  phase_start = now;
+
   /* Must happen after all other marking and before gc_sweep.  */
   mark_and_sweep_weak_table_contents ();
   eassert (weak_hash_tables == NULL);
+  prune_heap_samples ();
+
+  gc_phase_time[GC_PHASE_WEAK_TABLES]
+    = timespec_sub (current_timespec (), phase_start);
 
   eassert (mark_stack_empty_p ());
 
@@ -6109,16 +6663,24 @@ garbage_collect (void)
   image_prune_animation_caches (false);
 #endif
 
+  intmax_t released = gc_trim_heap (heap_before,
+				    total_bytes_of_live_objects ());
+
   /* Accumulate statistics.  */
+  struct timespec this_gc = timespec_sub (current_timespec (), start);
   if (FLOATP (Vgc_elapsed))
     {
       static struct timespec gc_elapsed;
-      gc_elapsed = timespec_add (gc_elapsed,
-				 timespec_sub (current_timespec (), start));
+      gc_elapsed = timespec_add (gc_elapsed, this_gc);
       Vgc_elapsed = make_float (timespectod (gc_elapsed));
     }
 
   gcs_done++;
+  EMACS_PROBE2 (gc_done, gcs_done,
+		this_gc.tv_sec * (intmax_t) 1000000000 + this_gc.tv_nsec);
+
+  if (NILP (Vmemory_full))
+    Vpost_gc_statistics = gc_statistics (this_gc, released);
 
   /* Collect profiling data.  */
   if (tot_before != (byte_ct) -1)
@@ -6214,16 +6776,27 @@ DEFUN ("garbage-collect-maybe", Fgarbage_collect_maybe,
   (Lisp_Object factor)
 {
   CHECK_FIXNAT (factor);
-  EMACS_INT fact = XFIXNAT (factor);
+  return maybe_garbage_collect_eagerly (XFIXNAT (factor)) ? Qt : Qnil;
+}
 
+/* Return true if more than 1/FACTOR of the allocations needed to
+   trigger an automatic garbage collection have taken place.  */
+bool
+gc_eagerly_due_p (EMACS_INT factor)
+{
   EMACS_INT since_gc = gc_threshold - consing_until_gc;
-  if (fact >= 1 && since_gc > gc_threshold / fact)
-    {
-      garbage_collect ();
-      return Qt;
-    }
-  else
-    return Qnil;
+  return factor >= 1 && since_gc > gc_threshold / factor;
+}
+
+/* Collect garbage if gc_eagerly_due_p says so.  Return true if a
+   collection took place.  */
+bool
+maybe_garbage_collect_eagerly (EMACS_INT factor)
+{
+  if (!gc_eagerly_due_p (factor) || garbage_collection_inhibited)
+    return false;
+  garbage_collect ();
+  return true;
 }
 
 /* Mark Lisp objects in glyph matrix MATRIX.  Currently the
@@ -6373,6 +6946,9 @@ mark_buffer (struct buffer *buffer)
   if (!itree_empty_p (buffer->overlays))
     mark_overlays (buffer->overlays->root);
 
+  if (buffer->line_height_cache)
+    mark_line_height_cache (buffer->line_height_cache);
+
   /* If this is an indirect buffer, mark its base buffer.  */
   if (buffer->base_buffer &&
       !vectorlike_marked_p (&buffer->base_buffer->header))
@@ -6944,6 +7520,13 @@ survives_gc_p (Lisp_Object obj)
 
 
 
+/* Cons and float blocks found to be entirely free by sweep_conses
+   and sweep_floats.  They are not freed right away, since that
+   modifies the mem_tree and the ablock free list, which is not safe
+   if the main thread is sweeping other types at the same time.  */
+static struct cons_block *swept_cons_blocks;
+static struct float_block *swept_float_blocks;
+
 NO_INLINE /* For better stack traces */
 static void
 sweep_conses (void)
@@ -6972,7 +7555,10 @@ sweep_conses (void)
           else
             {
               /* Some cons cells for this int are not marked.
-                 Find which ones, and free them.  */
+                 Find which ones, and free them.  Test the bits in a
+                 local copy of the word, which is much cheaper than
+                 XCONS_MARKED_P, and clear the word afterwards.  */
+              bits_word bits = cblk->gcmarkbits[i];
               int start, pos, stop;
 
               start = i * BITS_PER_BITS_WORD;
@@ -6984,21 +7570,19 @@ sweep_conses (void)
               for (pos = start; pos < stop; pos++)
                 {
 		  struct Lisp_Cons *acons = &cblk->conses[pos];
-		  if (!XCONS_MARKED_P (acons))
+		  if (! (bits & ((bits_word) 1 << (pos - start))))
                     {
-		      ASAN_UNPOISON_CONS (&cblk->conses[pos]);
+		      ASAN_UNPOISON_CONS (acons);
                       this_free++;
-                      cblk->conses[pos].u.s.u.chain = cons_free_list;
-                      cons_free_list = &cblk->conses[pos];
-                      cons_free_list->u.s.car = dead_object ();
-		      ASAN_POISON_CONS (&cblk->conses[pos]);
+                      acons->u.s.u.chain = cons_free_list;
+                      cons_free_list = acons;
+                      acons->u.s.car = dead_object ();
+		      ASAN_POISON_CONS (acons);
 		    }
                   else
-                    {
-                      num_used++;
-		      XUNMARK_CONS (acons);
-                    }
+                    num_used++;
                 }
+              cblk->gcmarkbits[i] = 0;
             }
         }
 
@@ -7012,7 +7596,10 @@ sweep_conses (void)
           /* Unhook from the free list.  */
 	  ASAN_UNPOISON_CONS (&cblk->conses[0]);
           cons_free_list = cblk->conses[0].u.s.u.chain;
-          lisp_align_free (cblk);
+          /* Let free_swept_blocks release the block, since this may
+             run in the sweeper thread.  */
+          cblk->next = swept_cons_blocks;
+          swept_cons_blocks = cblk;
         }
       else
         {
@@ -7037,22 +7624,38 @@ sweep_floats (void)
   for (struct float_block *fblk; (fblk = *fprev); )
     {
       int this_free = 0;
+      int ilim = (lim + BITS_PER_BITS_WORD - 1) / BITS_PER_BITS_WORD;
       ASAN_UNPOISON_FLOAT_BLOCK (fblk);
-      for (int i = 0; i < lim; i++)
+
+      /* Scan the mark bits an int at a time, like sweep_conses.  */
+      for (int i = 0; i < ilim; i++)
 	{
-	  struct Lisp_Float *afloat = &fblk->floats[i];
-	  if (!XFLOAT_MARKED_P (afloat))
+	  bits_word bits = fblk->gcmarkbits[i];
+	  int start = i * BITS_PER_BITS_WORD;
+	  int stop = start + min (lim - start, BITS_PER_BITS_WORD);
+
+	  if (bits == BITS_WORD_MAX)
 	    {
-	      this_free++;
-	      fblk->floats[i].u.chain = float_free_list;
-	      ASAN_POISON_FLOAT (&fblk->floats[i]);
-	      float_free_list = &fblk->floats[i];
+	      /* Fast path - all floats for this int are marked.  */
+	      fblk->gcmarkbits[i] = 0;
+	      num_used += BITS_PER_BITS_WORD;
+	      continue;
 	    }
-	  else
+
+	  for (int pos = start; pos < stop; pos++)
 	    {
-	      num_used++;
-	      XFLOAT_UNMARK (afloat);
+	      struct Lisp_Float *afloat = &fblk->floats[pos];
+	      if (! (bits & ((bits_word) 1 << (pos - start))))
+		{
+		  this_free++;
+		  afloat->u.chain = float_free_list;
+		  ASAN_POISON_FLOAT (afloat);
+		  float_free_list = afloat;
+		}
+	      else
+		num_used++;
 	    }
+	  fblk->gcmarkbits[i] = 0;
 	}
       lim = FLOAT_BLOCK_SIZE;
       /* If this block contains only free floats and we have already
@@ -7064,7 +7667,8 @@ sweep_floats (void)
           /* Unhook from the free list.  */
 	  ASAN_UNPOISON_FLOAT (&fblk->floats[0]);
 	  float_free_list = fblk->floats[0].u.chain;
-          lisp_align_free (fblk);
+          fblk->next = swept_float_blocks;
+          swept_float_blocks = fblk;
         }
       else
         {
@@ -7085,6 +7689,7 @@ sweep_intervals (void)
   object_ct num_free = 0, num_used = 0;
 
   interval_free_list = 0;
+  interval_tree_tick++;
 
   for (struct interval_block *iblk; (iblk = *iprev); )
     {
@@ -7201,20 +7806,22 @@ sweep_symbols (void)
 }
 
 /* Remove BUFFER's markers that are due to be swept.  This is needed since
-   we treat BUF_MARKERS and markers's `next' field as weak pointers.  */
+   we treat BUF_MARKERS and markers's `next' and `prev' fields as weak
+   pointers.  */
 static void
 unchain_dead_markers (struct buffer *buffer)
 {
-  struct Lisp_Marker *this, **prev = &BUF_MARKERS (buffer);
+  struct Lisp_Marker *this, *next;
 
-  while ((this = *prev))
-    if (vectorlike_marked_p (&this->header))
-      prev = &this->next;
-    else
-      {
-        this->buffer = NULL;
-        *prev = this->next;
-      }
+  for (this = BUF_MARKERS (buffer); this; this = next)
+    {
+      next = this->next;
+      if (!vectorlike_marked_p (&this->header))
+	{
+	  this->buffer = NULL;
+	  unlink_marker (this, buffer);
+	}
+    }
 }
 
 NO_INLINE /* For better stack traces */
@@ -7234,22 +7841,223 @@ sweep_buffers (void)
     }
 }
 
+/* Call SWEEP, recording the time it takes as that of PHASE.  */
+static void
+timed_sweep (void (*sweep) (void), enum gc_phase phase)
+{
+  struct timespec start = current_timespec ();
+  sweep ();
+  gc_phase_time[phase] = timespec_sub (current_timespec (), start);
+}
+
+/* Free the blocks that sweep_conses and sweep_floats put aside.  */
+static void
+free_swept_blocks (void)
+{
+  while (swept_cons_blocks)
+    {
+      struct cons_block *cblk = swept_cons_blocks;
+      swept_cons_blocks = cblk->next;
+      lisp_align_free (cblk);
+    }
+  while (swept_float_blocks)
+    {
+      struct float_block *fblk = swept_float_blocks;
+      swept_float_blocks = fblk->next;
+      lisp_align_free (fblk);
+    }
+}
+
+/* Parallel sweeping.  Conses and floats live in blocks of their own
+   and their sweep touches nothing else, so when `gc-parallel-sweep' is
+   non-nil a helper thread sweeps them while the main thread sweeps the
+   other types.  The helper is started on first use and then waits on
+   sweep_cond for further requests.  */
+
+enum sweep_state { SWEEP_IDLE, SWEEP_REQUESTED, SWEEP_DONE };
+
+static sys_mutex_t sweep_mutex;
+static sys_cond_t sweep_cond;
+static enum sweep_state sweep_state;
+static bool sweep_thread_running;
+
+static void *
+sweep_thread (void *arg)
+{
+#ifdef HAVE_PTHREAD
+  /* Leave signal handling to the main thread.  */
+  sigset_t blocked;
+  sigfillset (&blocked);
+  pthread_sigmask (SIG_BLOCK, &blocked, NULL);
+#endif
+  sys_thread_set_name ("GC sweeper");
+
+  sys_mutex_lock (&sweep_mutex);
+  for (;;)
+    {
+      while (sweep_state != SWEEP_REQUESTED)
+	sys_cond_wait (&sweep_cond, &sweep_mutex);
+      sys_mutex_unlock (&sweep_mutex);
+
+      timed_sweep (sweep_conses, GC_PHASE_SWEEP_CONSES);
+      timed_sweep (sweep_floats, GC_PHASE_SWEEP_FLOATS);
+
+      sys_mutex_lock (&sweep_mutex);
+      sweep_state = SWEEP_DONE;
+      sys_cond_broadcast (&sweep_cond);
+    }
+  return NULL;
+}
+
+/* Ask the sweeper thread to sweep conses and floats, starting it if
+   necessary.  Return false if that is not possible, in which case the
+   caller should sweep them itself.  */
+static bool
+start_parallel_sweep (void)
+{
+  if (!gc_parallel_sweep)
+    return false;
+  if (!sweep_thread_running)
+    {
+      static bool sweep_thread_failed;
+      sys_thread_t thr;
+      if (sweep_thread_failed)
+	return false;
+      sys_mutex_init (&sweep_mutex);
+      sys_cond_init (&sweep_cond);
+      if (!sys_thread_create (&thr, sweep_thread, NULL))
+	{
+	  sweep_thread_failed = true;
+	  return false;
+	}
+      sweep_thread_running = true;
+    }
+  sys_mutex_lock (&sweep_mutex);
+  sweep_state = SWEEP_REQUESTED;
+  sys_cond_broadcast (&sweep_cond);
+  sys_mutex_unlock (&sweep_mutex);
+  return true;
+}
+
+/* Wait for the sweep started by start_parallel_sweep to finish.  */
+static void
+finish_parallel_sweep (void)
+{
+  sys_mutex_lock (&sweep_mutex);
+  while (sweep_state != SWEEP_DONE)
+    sys_cond_wait (&sweep_cond, &sweep_mutex);
+  sweep_state = SWEEP_IDLE;
+  sys_mutex_unlock (&sweep_mutex);
+}
+
 /* Sweep: find all structures not marked, and free them.  */
 static void
 gc_sweep (void)
 {
-  sweep_strings ();
+  bool parallel = start_parallel_sweep ();
+  timed_sweep (sweep_strings, GC_PHASE_SWEEP_STRINGS);
   check_string_bytes (!noninteractive);
-  sweep_conses ();
-  sweep_floats ();
-  sweep_intervals ();
-  sweep_symbols ();
-  sweep_buffers ();
-  sweep_vectors ();
+  if (!parallel)
+    {
+      timed_sweep (sweep_conses, GC_PHASE_SWEEP_CONSES);
+      timed_sweep (sweep_floats, GC_PHASE_SWEEP_FLOATS);
+    }
+  timed_sweep (sweep_intervals, GC_PHASE_SWEEP_INTERVALS);
+  timed_sweep (sweep_symbols, GC_PHASE_SWEEP_SYMBOLS);
+  timed_sweep (sweep_buffers, GC_PHASE_SWEEP_BUFFERS);
+  timed_sweep (sweep_vectors, GC_PHASE_SWEEP_VECTORS);
+  if (parallel)
+    finish_parallel_sweep ();
+  free_swept_blocks ();
   pdumper_clear_marks ();
   check_string_bytes (!noninteractive);
 }
 
+DEFUN ("profiler-heap-start", Fprofiler_heap_start, Sprofiler_heap_start,
+       0, 1, 0,
+       doc: /* Start the heap profiler.
+The heap profiler records the call-stack of one allocation for every
+INTERVAL bytes allocated, 524288 by default, and keeps track of whether
+the allocated object is still alive.  Use `profiler-heap-snapshot' to
+see where the live objects were allocated.
+See also `profiler-max-stack-depth'.  */)
+  (Lisp_Object interval)
+{
+  if (heap_profiler_running)
+    error ("Heap profiler is already running");
+  if (NILP (interval))
+    heap_sample_interval = 512 * 1024;
+  else
+    {
+      CHECK_FIXNAT (interval);
+      heap_sample_interval = max (1, XFIXNAT (interval));
+    }
+  heap_bytes_until_sample = heap_sample_interval;
+  heap_sample_depth = clip_to_bounds (0, profiler_max_stack_depth, INT_MAX);
+  heap_samples_used = 0;
+  heap_profiler_running = true;
+  return Qt;
+}
+
+DEFUN ("profiler-heap-stop", Fprofiler_heap_stop, Sprofiler_heap_stop,
+       0, 0, 0,
+       doc: /* Stop the heap profiler and discard its samples.
+Return non-nil if the profiler was running.  */)
+  (void)
+{
+  if (!heap_profiler_running)
+    return Qnil;
+  heap_profiler_running = false;
+  xfree (heap_samples);
+  xfree (heap_sample_traces);
+  heap_samples = NULL;
+  heap_sample_traces = NULL;
+  heap_samples_used = heap_samples_size = 0;
+  return Qt;
+}
+
+DEFUN ("profiler-heap-running-p", Fprofiler_heap_running_p,
+       Sprofiler_heap_running_p, 0, 0, 0,
+       doc: /* Return non-nil if the heap profiler is running.  */)
+  (void)
+{
+  return heap_profiler_running ? Qt : Qnil;
+}
+
+DEFUN ("profiler-heap-snapshot", Fprofiler_heap_snapshot,
+       Sprofiler_heap_snapshot, 0, 0, 0,
+       doc: /* Collect garbage and return where the live objects were allocated.
+The value is a hash table in the format of `profiler-memory-log': the
+keys are backtraces, whose first element is the type of the allocated
+objects, as returned by `cl-type-of', followed by the call-stack of
+their allocation.  The values estimate how many bytes of those objects
+are still alive.  The snapshot only covers the objects allocated since
+`profiler-heap-start' was called.  Subtracting one snapshot from a
+later one shows which call sites retained memory in the meantime.  */)
+  (void)
+{
+  if (!heap_profiler_running)
+    error ("Heap profiler is not running");
+  garbage_collect ();
+
+  /* Don't sample the objects making up the snapshot.  */
+  heap_profiler_running = false;
+  Lisp_Object h = make_hash_table (&hashtest_equal, DEFAULT_HASH_SIZE,
+				   Weak_None);
+  for (ptrdiff_t i = 0; i < heap_samples_used; i++)
+    {
+      Lisp_Object key = make_nil_vector (heap_sample_depth + 1);
+      ASET (key, 0, Fcl_type_of (heap_samples[i].object));
+      memcpy (XVECTOR (key)->contents + 1,
+	      heap_sample_traces + i * heap_sample_depth,
+	      heap_sample_depth * sizeof *heap_sample_traces);
+      Lisp_Object old = Fgethash (key, h, make_fixnum (0));
+      Fputhash (key, CALLN (Fplus, old, make_int (heap_samples[i].weight)), h);
+    }
+  heap_profiler_running = true;
+  return h;
+}
+
 DEFUN ("memory-info", Fmemory_info, Smemory_info, 0, 0, 0,
        doc: /* Return a list of (TOTAL-RAM FREE-RAM TOTAL-SWAP FREE-SWAP).
 All values are in Kbytes.  If there is no swap space,
@@ -7525,6 +8333,8 @@ init_alloc (void)
 {
   Vgc_elapsed = make_float (0.0);
   gcs_done = 0;
+  gcs_idle_done = 0;
+  record_consing_counters ();
 }
 
 void
@@ -7638,6 +8448,109 @@ syms_of_alloc (void)
   DEFVAR_INT ("gcs-done", gcs_done,
               doc: /* Accumulated number of garbage collections done.  */);
 
+  DEFVAR_LISP ("post-gc-statistics", Vpost_gc_statistics,
+	       doc: /* Statistics about the most recent garbage collection.
+This is an alist with the following elements:
+
+  (elapsed . SECONDS) -- the time taken by the collection.
+  (phases (PHASE . SECONDS)...) -- the time taken by each phase.
+  (freed (TYPE . BYTES)...) -- the number of bytes freed for each type.
+  (weak-tables (WEAKNESS ENTRIES SCANNED REMOVED)...) -- the work done
+    on each weak hash table.
+  (released . BYTES) -- the memory returned to the system after the
+    collection, see `gc-trim-fraction'.
+
+PHASE is one of `mark' (marking all reachable objects, starting from
+the roots), `weak-tables' (marking and sweeping weak hash tables),
+`sweep-strings', `compact-strings' (included in `sweep-strings'),
+`sweep-conses', `sweep-floats', `sweep-intervals', `sweep-symbols',
+`sweep-buffers' and `sweep-vectors'.  TYPE names a type of object as
+in the value of `garbage-collect'.  For each weak hash table that is
+reachable, WEAKNESS is its weakness as returned by `hash-table-weakness',
+ENTRIES the number of entries it had before the collection, SCANNED the
+number of times an entry was examined, and REMOVED the number of
+entries removed.
+
+The value is updated at the end of each garbage collection, before
+`post-gc-hook' runs, so a function on that hook can record it.  */);
+  Vpost_gc_statistics = Qnil;
+  DEFSYM (Qelapsed, "elapsed");
+  DEFSYM (Qphases, "phases");
+  DEFSYM (Qfreed, "freed");
+  DEFSYM (Qmark, "mark");
+  DEFSYM (Qweak_tables, "weak-tables");
+  DEFSYM (Qsweep_strings, "sweep-strings");
+  DEFSYM (Qcompact_strings, "compact-strings");
+  DEFSYM (Qsweep_conses, "sweep-conses");
+  DEFSYM (Qsweep_floats, "sweep-floats");
+  DEFSYM (Qsweep_intervals, "sweep-intervals");
+  DEFSYM (Qsweep_symbols, "sweep-symbols");
+  DEFSYM (Qsweep_buffers, "sweep-buffers");
+  DEFSYM (Qsweep_vectors, "sweep-vectors");
+  DEFSYM (Qreleased, "released");
+
+  DEFVAR_BOOL ("gc-huge-pages", gc_huge_pages,
+	       doc: /* Non-nil means back the Lisp heap with huge pages.
+If this is non-nil, Emacs advises the system to use transparent huge
+pages for the memory it allocates for Lisp objects from then on.  With
+a heap of many megabytes, this makes garbage collection faster,
+because marking touches the whole heap and huge pages need far fewer
+entries in the processor's translation lookaside buffer, but it can
+make Emacs use more memory.  Set this early, for instance in your
+early init file, so that it affects most of the heap.
+
+This has no effect on systems without transparent huge pages, and on
+GNU/Linux systems where they are used for all memory or not at all;
+see the file /sys/kernel/mm/transparent_hugepage/enabled.  */);
+  gc_huge_pages = false;
+
+  DEFVAR_LISP ("gc-trim-fraction", Vgc_trim_fraction,
+	       doc: /* Fraction of Lisp data freed that returns memory to the system.
+If this is a number between 0 and 1, and a garbage collection frees
+more than this fraction of the memory used by Lisp objects, Emacs
+asks the C library to return the free memory of its heap to the
+operating system afterward, as `malloc-trim' does.  This keeps the
+memory used by Emacs from staying at its peak after a transient
+workload, such as parsing a large JSON text, at the cost of a longer
+collection when it happens.  The element `released' of
+`post-gc-statistics' says how many bytes were returned.
+
+If nil, memory is not returned to the system after garbage
+collection.  This variable has no effect if the C library cannot
+return memory.  */);
+  Vgc_trim_fraction = Qnil;
+
+  DEFVAR_BOOL ("gc-parallel-sweep", gc_parallel_sweep,
+	       doc: /* Non-nil means sweep part of the heap in a separate thread.
+When this is non-nil, garbage collection frees unused cons cells and
+floats in a helper thread while the main thread frees the other types
+of objects, which shortens the collection on machines with more than
+one processor.  This has no effect if Emacs was built without support
+for threads.  */);
+  gc_parallel_sweep = false;
+
+  DEFVAR_LISP ("gc-idle-delay", Vgc_idle_delay,
+	       doc: /* Seconds of idleness after which garbage is collected early.
+If this is a number, and Emacs has been waiting for input for that
+many seconds, it collects garbage if more than 1/Nth of the
+allocations needed to trigger an automatic collection have taken
+place, where N is the value of `gc-idle-factor'.  This moves the pause
+caused by garbage collection to a moment when the user is not typing,
+instead of whenever `gc-cons-threshold' happens to be reached.
+
+If nil, garbage is never collected early because of idleness.  */);
+  Vgc_idle_delay = Qnil;
+
+  DEFVAR_INT ("gc-idle-factor", gc_idle_factor,
+	      doc: /* Divisor of the allocation threshold used by idle collections.
+See `gc-idle-delay' for the meaning of this variable.  It should be
+greater than 1 to have any effect.  */);
+  gc_idle_factor = 2;
+
+  DEFVAR_INT ("gcs-idle-done", gcs_idle_done,
+	      doc: /* Number of garbage collections done because of idleness.
+These are also counted in `gcs-done'.  See `gc-idle-delay'.  */);
+
   DEFVAR_INT ("integer-width", integer_width,
 	      doc: /* Maximum number N of bits in safely-calculated integers.
 Integers with absolute values less than 2**N do not signal a range error.
@@ -7661,6 +8574,10 @@ syms_of_alloc (void)
   defsubr (&Sgarbage_collect);
   defsubr (&Sgarbage_collect_maybe);
   defsubr (&Smemory_info);
+  defsubr (&Sprofiler_heap_start);
+  defsubr (&Sprofiler_heap_stop);
+  defsubr (&Sprofiler_heap_running_p);
+  defsubr (&Sprofiler_heap_snapshot);
   defsubr (&Smemory_use_counts);
 #if defined GNU_LINUX && defined __GLIBC__ && \
   (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 10)
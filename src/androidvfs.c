@@ -1021,6 +1021,251 @@ android_extract_long (const char *pointer)
   return number;
 }
 
+/* Startup loads much of the Lisp tree from the assets directory, and
+   scanning the directory tree for each file name visits every sibling
+   of each directory on its way.  So the directory tree is indexed by
+   file name once it is loaded, in a hash table with open addressing.
+   If that fails, the directory tree is scanned instead.  */
+
+struct android_asset_index_entry
+{
+  /* Hash code of the file name, or 0 if this entry is unused.  */
+  unsigned int hash;
+
+  /* Offset of the file name in asset_index_names.  */
+  size_t name;
+
+  /* What `android_scan_directory_tree' returns for this file.  */
+  const char *entry;
+
+  /* The offset to the end of this file or directory in the
+     directory tree.  */
+  size_t limit;
+};
+
+/* The index of the directory tree, or NULL.  Its size is a power of
+   two.  */
+static struct android_asset_index_entry *asset_index;
+static size_t asset_index_size;
+
+/* The file names in asset_index, relative to the assets directory
+   and without leading or trailing slashes.  */
+static char *asset_index_names;
+
+/* Return the hash code of the LENGTH bytes of the file name NAME.  */
+
+static unsigned int
+android_hash_asset_name (const char *name, size_t length)
+{
+  unsigned int hash;
+  size_t i;
+
+  hash = 5381;
+  for (i = 0; i < length; ++i)
+    hash = hash * 33 + (unsigned char) name[i];
+
+  /* Zero marks unused entries.  */
+  return hash ? hash : 1;
+}
+
+/* Return the index entry for the file name NAME, LENGTH bytes long,
+   or an unused entry where it should be entered.  */
+
+static struct android_asset_index_entry *
+android_find_asset_entry (const char *name, size_t length)
+{
+  unsigned int hash;
+  size_t i;
+  struct android_asset_index_entry *entry;
+
+  hash = android_hash_asset_name (name, length);
+
+  for (i = hash & (asset_index_size - 1);;
+       i = (i + 1) & (asset_index_size - 1))
+    {
+      entry = &asset_index[i];
+
+      if (!entry->hash
+	  || (entry->hash == hash
+	      && !memcmp (asset_index_names + entry->name, name, length)
+	      && !asset_index_names[entry->name + length]))
+	return entry;
+    }
+}
+
+/* Walk the directory tree entries between START and LIMIT, whose
+   file names are relative to the directory named by the first
+   PREFIX_LENGTH bytes of PREFIX, a buffer of PATH_MAX bytes.
+
+   If asset_index_names is NULL, count the entries in *COUNT and the
+   bytes of their names in *NAMES_SIZE.  Otherwise, enter them into
+   asset_index, and their names at *NAMES_SIZE bytes into
+   asset_index_names.
+
+   Return false if the directory tree is malformed or too deep.  */
+
+static bool
+android_index_directory_tree (const char *start, const char *limit,
+			      char *prefix, size_t prefix_length,
+			      size_t *count, size_t *names_size)
+{
+  const char *max, *end;
+  size_t length, name_length;
+  bool directory_p;
+  struct android_asset_index_entry *entry;
+
+  while (start < limit)
+    {
+      max = memchr (start, 0, limit - start);
+
+      if (!max || max == start
+	  || max + (OLD_ANDROID_ASSETS ? 9 : 5) > limit)
+	return false;
+
+      directory_p = *(max - 1) == '/';
+      name_length = max - start - directory_p;
+      length = prefix_length + (prefix_length != 0) + name_length;
+
+      if (length >= PATH_MAX)
+	return false;
+
+      if (prefix_length)
+	prefix[prefix_length] = '/';
+      memcpy (prefix + length - name_length, start, name_length);
+
+      end = (directory_tree
+	     + android_extract_long (max + (OLD_ANDROID_ASSETS ? 5 : 1)));
+
+      if (end < max + (OLD_ANDROID_ASSETS ? 9 : 5)
+	  || end > directory_tree + directory_tree_size)
+	return false;
+
+      if (!asset_index_names)
+	++*count;
+      else
+	{
+	  entry = android_find_asset_entry (prefix, length);
+	  entry->hash = android_hash_asset_name (prefix, length);
+	  entry->name = *names_size;
+	  entry->entry = max + (OLD_ANDROID_ASSETS ? 9 : 5);
+	  entry->limit = end - directory_tree;
+	  memcpy (asset_index_names + *names_size, prefix, length);
+	  asset_index_names[*names_size + length] = '\0';
+	}
+
+      *names_size += length + 1;
+
+      if (directory_p
+	  && !android_index_directory_tree (max + (OLD_ANDROID_ASSETS
+						   ? 9 : 5),
+					    end, prefix, length,
+					    count, names_size))
+	return false;
+
+      start = end;
+    }
+
+  return true;
+}
+
+/* Build the index of the directory tree.  Leave asset_index NULL if
+   that fails.  */
+
+static void
+android_index_assets (void)
+{
+  char prefix[PATH_MAX];
+  size_t count, names_size;
+  const char *start;
+
+  start = directory_tree + (OLD_ANDROID_ASSETS ? 9 : 5);
+  count = names_size = 0;
+
+  if (!android_index_directory_tree (start,
+				     directory_tree + directory_tree_size,
+				     prefix, 0, &count, &names_size))
+    goto fail;
+
+  /* Keep the table at most half full.  */
+  for (asset_index_size = 16; asset_index_size < count * 2;)
+    asset_index_size *= 2;
+
+  asset_index = calloc (asset_index_size, sizeof *asset_index);
+  asset_index_names = malloc (max (names_size, 1));
+
+  if (!asset_index || !asset_index_names)
+    goto fail;
+
+  names_size = 0;
+  if (!android_index_directory_tree (start,
+				     directory_tree + directory_tree_size,
+				     prefix, 0, &count, &names_size))
+    goto fail;
+
+  return;
+
+ fail:
+  __android_log_print (ANDROID_LOG_WARN, __func__,
+		       "could not index directory tree");
+  free (asset_index);
+  free (asset_index_names);
+  asset_index = NULL;
+  asset_index_names = NULL;
+}
+
+/* Look up FILE in the index of the directory tree, like
+   `android_scan_directory_tree'.  */
+
+static const char *
+android_lookup_asset_index (const char *file, size_t *limit_return)
+{
+  char name[PATH_MAX];
+  size_t length;
+  const char *p;
+  struct android_asset_index_entry *entry;
+
+  /* Collapse consecutive slashes and remove leading and trailing
+     ones, as splitting FILE into tokens does.  */
+
+  length = 0;
+  for (p = file; *p; ++p)
+    {
+      if (*p == '/' && (!length || name[length - 1] == '/'))
+	continue;
+
+      if (length == sizeof name - 1)
+	return NULL;
+
+      name[length++] = *p;
+    }
+
+  if (length && name[length - 1] == '/')
+    length--;
+
+  if (!length)
+    {
+      if (limit_return)
+	*limit_return = directory_tree_size;
+
+      return directory_tree + (OLD_ANDROID_ASSETS ? 9 : 5);
+    }
+
+  entry = android_find_asset_entry (name, length);
+
+  if (!entry->hash)
+    return NULL;
+
+  /* If FILE ends with a slash, it must be a directory.  */
+  if (file[strlen (file) - 1] == '/'
+      && *(entry->entry - (OLD_ANDROID_ASSETS ? 10 : 6)) != '/')
+    return NULL;
+
+  if (limit_return)
+    *limit_return = entry->limit;
+
+  return entry->entry;
+}
+
 /* Scan to the file FILE in the asset directory tree.  Return a
    pointer to the end of that file (immediately before any children)
    in the directory tree, or NULL if that file does not exist.
@@ -1040,6 +1285,9 @@ android_scan_directory_tree (const char *file, size_t *limit_return)
   size_t token_length, ntokens, i, len;
   char *tokens[20];
 
+  if (asset_index)
+    return android_lookup_asset_index (file, limit_return);
+
   USE_SAFE_ALLOCA;
 
   /* Skip past the 5 or 9 byte header.  */
@@ -1277,6 +1525,8 @@ android_init_assets (JNIEnv *env, jobject manager)
     }
 #endif /* OLD_ANDROID_ASSETS */
 
+  android_index_assets ();
+
   /* Hold a VM reference to the asset manager to prevent the native
      object from being deleted.  */
   (*env)->NewGlobalRef (env, manager);
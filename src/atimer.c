@@ -64,6 +64,10 @@ #define raise(s) w32_raise(s)
 # ifdef HAVE_TIMERFD
 /* File descriptor for timer, or -1 if it could not be created.  */
 static int timerfd;
+
+/* How many nanoseconds after the timer descriptor the POSIX timer
+   is set to fire, in case Emacs is too busy to read the descriptor.  */
+enum { ATIMER_SIGNAL_DELAY = 10000000 };
 # else
 enum { timerfd = -1 };
 # endif
@@ -308,6 +312,25 @@ set_alarm (void)
 	  struct itimerspec ispec;
 	  ispec.it_value = atimers->expiration;
 	  ispec.it_interval.tv_sec = ispec.it_interval.tv_nsec = 0;
+
+# if defined HAVE_TIMERFD && !defined CYGWIN
+	  /* Prefer the timer descriptor, which wakes up
+	     wait_reading_process_output without interrupting it with a
+	     signal.  The descriptor is not read while Emacs is busy,
+	     though, so still arm the POSIX timer as a backstop, a little
+	     later; if the descriptor is read in time, running the
+	     atimers rearms it before the signal is sent.  */
+	  if (0 <= timerfd
+	      && timerfd_settime (timerfd, TFD_TIMER_ABSTIME, &ispec, 0) == 0)
+	    {
+	      add_timer_wait_descriptor (timerfd);
+	      exit = true;
+	      ispec.it_value
+		= timespec_add (ispec.it_value,
+				make_timespec (0, ATIMER_SIGNAL_DELAY));
+	    }
+# endif
+
 	  if (alarm_timer_ok
 	      && timer_settime (alarm_timer, TIMER_ABSTIME, &ispec, 0) == 0)
 	    exit = true;
@@ -320,15 +343,15 @@ set_alarm (void)
 # ifdef CYGWIN
 	  if (exit)
 	    return;
-# endif
 
-# ifdef HAVE_TIMERFD
+#  ifdef HAVE_TIMERFD
 	  if (0 <= timerfd
 	      && timerfd_settime (timerfd, TFD_TIMER_ABSTIME, &ispec, 0) == 0)
 	    {
 	      add_timer_wait_descriptor (timerfd);
 	      exit = true;
 	    }
+#  endif
 # endif
 
 	  if (exit)
@@ -603,9 +626,9 @@ init_atimer (void)
 # endif
   /* We're starting the alarms even if we have timerfd, because
      timerfd events do not fire while Emacs Lisp is busy and doesn't
-     call thread_select.  This might or might not mean that the
-     timerfd code doesn't really give us anything and should be
-     removed, see discussion in bug#19776.  */
+     call thread_select, see discussion in bug#19776.  set_alarm arms
+     them a little later than the timerfd, so that they are only
+     delivered when the timerfd is not read in time.  */
   struct sigevent sigev;
   sigev.sigev_notify = SIGEV_SIGNAL;
   sigev.sigev_signo = SIGALRM;
@@ -1558,9 +1558,10 @@ #define MAX_PARAGRAPH_SEARCH 7500
 /* Find the beginning of this paragraph by looking back in the buffer.
    Value is the byte position of the paragraph's beginning, or
    BEGV_BYTE if paragraph_start_re is still not found after looking
-   back MAX_PARAGRAPH_SEARCH lines in the buffer.  */
+   back MAX_PARAGRAPH_SEARCH lines in the buffer.  In the latter case,
+   set *GAVE_UP to true, if GAVE_UP is non-NULL.  */
 static ptrdiff_t
-bidi_find_paragraph_start (ptrdiff_t pos, ptrdiff_t pos_byte)
+bidi_find_paragraph_start (ptrdiff_t pos, ptrdiff_t pos_byte, bool *gave_up)
 {
   Lisp_Object re =
     STRINGP (BVAR (current_buffer, bidi_paragraph_start_re))
@@ -1598,7 +1599,11 @@ bidi_find_paragraph_start (ptrdiff_t pos, ptrdiff_t pos_byte)
     }
   unbind_to (count, Qnil);
   if (n >= MAX_PARAGRAPH_SEARCH)
-    pos = BEGV, pos_byte = BEGV_BYTE;
+    {
+      pos = BEGV, pos_byte = BEGV_BYTE;
+      if (gave_up)
+	*gave_up = true;
+    }
   if (bpc)
     know_region_cache (cache_buffer, bpc, pos, oldpos);
   /* Positions returned by the region cache are not limited to
@@ -1607,6 +1612,287 @@ bidi_find_paragraph_start (ptrdiff_t pos, ptrdiff_t pos_byte)
   return pos_byte;
 }
 
+/* Cache of paragraph beginnings and of the first strong character in
+   each paragraph, for bidi_paragraph_init.
+
+   The display engine reseats its iterators many times per redisplay
+   cycle, and every time it needs to find the base direction of the
+   paragraph it lands in, which means searching back for the start of
+   the paragraph, then forward for its first strong directional
+   character.  In long paragraphs both searches are costly, yet their
+   results are the same until the buffer changes.  Each entry below
+   says that the paragraph containing positions START to KNOWN_END of
+   BUFFER begins at START, and that its first strong character is of
+   type TYPE, as shown in window W.  An entry is only valid while the
+   text, overlays, accessible portion and paragraph regexps of the
+   buffer are those it was made with; any edit invalidates it.  */
+
+struct bidi_paragraph_entry
+{
+  struct buffer *buffer;
+  struct window *w;
+  bool frame_window_p;
+  modiff_count modiff, overlay_modiff;
+  ptrdiff_t begv, zv;
+  Lisp_Object start_re, separate_re;
+  ptrdiff_t start, start_byte, known_end;
+  bidi_type_t type;
+};
+
+#define BIDI_PARAGRAPH_CACHE_SIZE 8
+
+static struct bidi_paragraph_entry
+  bidi_paragraph_entries[BIDI_PARAGRAPH_CACHE_SIZE];
+
+/* The entry to replace next.  */
+static int bidi_paragraph_next_entry;
+
+/* Return true if ENTRY was made for the current state of the current
+   buffer as displayed by BIDI_IT.  */
+
+static bool
+bidi_paragraph_entry_valid_p (struct bidi_paragraph_entry *entry,
+			      struct bidi_it *bidi_it)
+{
+  return (entry->buffer == current_buffer
+	  && entry->w == bidi_it->w
+	  && entry->frame_window_p == bidi_it->frame_window_p
+	  && entry->modiff == MODIFF
+	  && entry->overlay_modiff == OVERLAY_MODIFF
+	  && entry->begv == BEGV && entry->zv == ZV
+	  && EQ (entry->start_re,
+		 BVAR (current_buffer, bidi_paragraph_start_re))
+	  && EQ (entry->separate_re,
+		 BVAR (current_buffer, bidi_paragraph_separate_re)));
+}
+
+/* Return the cache entry for the paragraph containing POS, or NULL if
+   there is none.  */
+
+static struct bidi_paragraph_entry *
+bidi_lookup_paragraph (struct bidi_it *bidi_it, ptrdiff_t pos)
+{
+  for (int i = 0; i < BIDI_PARAGRAPH_CACHE_SIZE; i++)
+    {
+      struct bidi_paragraph_entry *entry = &bidi_paragraph_entries[i];
+
+      if (entry->buffer
+	  && entry->start <= pos && pos <= entry->known_end
+	  && bidi_paragraph_entry_valid_p (entry, bidi_it))
+	return entry;
+    }
+  return NULL;
+}
+
+/* Record that the paragraph containing POS starts at START and
+   START_BYTE, and that its first strong character is of TYPE.  */
+
+static void
+bidi_record_paragraph (struct bidi_it *bidi_it, ptrdiff_t pos,
+		       ptrdiff_t start, ptrdiff_t start_byte,
+		       bidi_type_t type)
+{
+  struct bidi_paragraph_entry *entry = NULL;
+
+  /* Extend the entry of this paragraph, if there is one.  */
+  for (int i = 0; i < BIDI_PARAGRAPH_CACHE_SIZE; i++)
+    if (bidi_paragraph_entries[i].buffer
+	&& bidi_paragraph_entries[i].start == start
+	&& bidi_paragraph_entry_valid_p (&bidi_paragraph_entries[i],
+					 bidi_it))
+      {
+	entry = &bidi_paragraph_entries[i];
+	break;
+      }
+
+  if (!entry)
+    {
+      entry = &bidi_paragraph_entries[bidi_paragraph_next_entry];
+      bidi_paragraph_next_entry
+	= (bidi_paragraph_next_entry + 1) % BIDI_PARAGRAPH_CACHE_SIZE;
+      entry->buffer = current_buffer;
+      entry->w = bidi_it->w;
+      entry->frame_window_p = bidi_it->frame_window_p;
+      entry->modiff = MODIFF;
+      entry->overlay_modiff = OVERLAY_MODIFF;
+      entry->begv = BEGV;
+      entry->zv = ZV;
+      entry->start_re = BVAR (current_buffer, bidi_paragraph_start_re);
+      entry->separate_re = BVAR (current_buffer, bidi_paragraph_separate_re);
+      entry->start = start;
+      entry->start_byte = start_byte;
+      entry->known_end = pos;
+      entry->type = type;
+    }
+  else if (entry->known_end < pos)
+    entry->known_end = pos;
+}
+
+/* Checkpoints of the bidi iterator in long lines.
+
+   To produce the display element at a position in the middle of a
+   line, get_visually_first_element in xdisp.c primes the bidi
+   iterator by moving it from the start of the line, or from the
+   start of the restriction it uses in buffers with long lines, up to
+   that position.  In long lines that is thousands of characters each
+   time an iterator is reseated.  So the iterator states met while
+   priming are recorded every BIDI_CHECKPOINT_INTERVAL characters, and
+   later priming from the same start resumes at the last of them
+   before the target position.
+
+   A state can only be recorded where it is completely described by
+   struct bidi_it: in a left-to-right paragraph, at its base embedding
+   level, while scanning forward and with an empty cache of iterator
+   states.  Everything before such a position has then been delivered
+   already, and everything after it is delivered later.  Like the
+   paragraph cache, the checkpoints are only valid while the text,
+   overlays and accessible portion of the buffer are those they were
+   recorded with.  */
+
+#define BIDI_CHECKPOINT_INTERVAL 256
+#define BIDI_CHECKPOINT_CACHE_SIZE 128
+
+/* The part of struct bidi_it that bidi_copy_it copies when there is
+   nothing on the directional status stack.  */
+enum
+  {
+    bidi_checkpoint_state_size
+      = offsetof (struct bidi_it, level_stack) + sizeof (struct bidi_stack)
+  };
+
+struct bidi_checkpoint
+{
+  /* Where priming started, and where the state below was recorded.  */
+  ptrdiff_t start, charpos;
+  char *state;
+};
+
+static struct
+{
+  struct buffer *buffer;
+  struct window *w;
+  bool frame_window_p, inhibit_bpa;
+  modiff_count modiff, overlay_modiff;
+  ptrdiff_t begv, zv;
+} bidi_checkpoint_key;
+
+static struct bidi_checkpoint bidi_checkpoints[BIDI_CHECKPOINT_CACHE_SIZE];
+
+/* The number of valid checkpoints, and the one to replace next.  */
+static int bidi_checkpoints_used, bidi_checkpoint_next;
+
+/* Return true if the recorded checkpoints can be used for the current
+   buffer as displayed by BIDI_IT.  If not and RESET, forget them and
+   make them usable for recording checkpoints.  */
+
+static bool
+bidi_checkpoints_valid_p (struct bidi_it *bidi_it, bool reset)
+{
+  if (bidi_checkpoint_key.buffer == current_buffer
+      && bidi_checkpoint_key.w == bidi_it->w
+      && bidi_checkpoint_key.frame_window_p == bidi_it->frame_window_p
+      && bidi_checkpoint_key.inhibit_bpa == bidi_inhibit_bpa
+      && bidi_checkpoint_key.modiff == MODIFF
+      && bidi_checkpoint_key.overlay_modiff == OVERLAY_MODIFF
+      && bidi_checkpoint_key.begv == BEGV
+      && bidi_checkpoint_key.zv == ZV)
+    return true;
+  if (reset)
+    {
+      bidi_checkpoint_key.buffer = current_buffer;
+      bidi_checkpoint_key.w = bidi_it->w;
+      bidi_checkpoint_key.frame_window_p = bidi_it->frame_window_p;
+      bidi_checkpoint_key.inhibit_bpa = bidi_inhibit_bpa;
+      bidi_checkpoint_key.modiff = MODIFF;
+      bidi_checkpoint_key.overlay_modiff = OVERLAY_MODIFF;
+      bidi_checkpoint_key.begv = BEGV;
+      bidi_checkpoint_key.zv = ZV;
+      bidi_checkpoints_used = bidi_checkpoint_next = 0;
+    }
+  return false;
+}
+
+/* BIDI_IT has just been initialized by bidi_paragraph_init at START,
+   for moving it forward to POS in the same line.  If a checkpoint was
+   recorded between START and POS while moving from START before, put
+   BIDI_IT in the state of the last such checkpoint.  Return the
+   position from which to record checkpoints while moving on.  */
+
+ptrdiff_t
+bidi_resume_from_checkpoint (struct bidi_it *bidi_it, ptrdiff_t start,
+			     ptrdiff_t pos)
+{
+  struct bidi_checkpoint *best = NULL;
+
+  if (bidi_checkpoints_valid_p (bidi_it, false))
+    for (int i = 0; i < bidi_checkpoints_used; i++)
+      {
+	struct bidi_checkpoint *cp = &bidi_checkpoints[i];
+	if (cp->start == start && cp->charpos <= pos
+	    && (!best || best->charpos < cp->charpos))
+	  best = cp;
+      }
+  if (!best)
+    return start + BIDI_CHECKPOINT_INTERVAL;
+
+  /* The checkpoint was recorded after bidi_paragraph_init at START,
+     so the level stack and the fields beyond it are as they are
+     now.  */
+  memcpy (bidi_it, best->state, bidi_checkpoint_state_size);
+  bidi_it->first_elt = false;
+  return best->charpos + BIDI_CHECKPOINT_INTERVAL;
+}
+
+/* Record the state of BIDI_IT, which was moved from START, as a
+   checkpoint if possible.  Return the position from which to try to
+   record the next checkpoint.  */
+
+ptrdiff_t
+bidi_record_checkpoint (struct bidi_it *bidi_it, ptrdiff_t start)
+{
+  if (!(bidi_it->scan_dir == 1
+	&& bidi_it->stack_idx == 0
+	&& bidi_it->level_stack[0].level == 0
+	&& bidi_it->resolved_level == 0
+	&& bidi_cache_idx == bidi_cache_start
+	&& !bidi_it->first_elt
+	&& !bidi_it->new_paragraph
+	&& !bidi_it->string.s
+	&& NILP (bidi_it->string.lstring)))
+    return bidi_it->charpos + 1;
+
+  bidi_checkpoints_valid_p (bidi_it, true);
+  for (int i = 0; i < bidi_checkpoints_used; i++)
+    if (bidi_checkpoints[i].start == start
+	&& bidi_checkpoints[i].charpos == bidi_it->charpos)
+      return bidi_it->charpos + BIDI_CHECKPOINT_INTERVAL;
+
+  struct bidi_checkpoint *cp = &bidi_checkpoints[bidi_checkpoint_next];
+  bidi_checkpoint_next
+    = (bidi_checkpoint_next + 1) % BIDI_CHECKPOINT_CACHE_SIZE;
+  if (bidi_checkpoints_used < BIDI_CHECKPOINT_CACHE_SIZE)
+    bidi_checkpoints_used++;
+  if (!cp->state)
+    cp->state = xmalloc (bidi_checkpoint_state_size);
+  cp->start = start;
+  cp->charpos = bidi_it->charpos;
+  memcpy (cp->state, bidi_it, bidi_checkpoint_state_size);
+  return bidi_it->charpos + BIDI_CHECKPOINT_INTERVAL;
+}
+
+/* Forget the cached paragraphs and iterator checkpoints of buffer B,
+   which is being killed.  */
+
+void
+bidi_forget_buffer_paragraphs (struct buffer *b)
+{
+  for (int i = 0; i < BIDI_PARAGRAPH_CACHE_SIZE; i++)
+    if (bidi_paragraph_entries[i].buffer == b)
+      bidi_paragraph_entries[i].buffer = NULL;
+  if (bidi_checkpoint_key.buffer == b)
+    bidi_checkpoint_key.buffer = NULL;
+}
+
 /* This tracks how far we needed to search for first strong character.  */
 static ptrdiff_t nsearch_for_strong;
 
@@ -1711,6 +1997,7 @@ bidi_paragraph_init (bidi_dir_t dir, struct bidi_it *bidi_it, bool no_default_p)
   ptrdiff_t begbyte = string_p ? 0 : BEGV_BYTE;
   ptrdiff_t end = string_p ? bidi_it->string.schars : ZV;
   ptrdiff_t pos = bidi_it->charpos;
+  bool cached = false;
 
   nsearch_for_strong = 0;
 
@@ -1734,10 +2021,12 @@ bidi_paragraph_init (bidi_dir_t dir, struct bidi_it *bidi_it, bool no_default_p)
   else if (dir == NEUTRAL_DIR)	/* P2 */
     {
       ptrdiff_t ch_len, nchars;
-      ptrdiff_t disp_pos = -1;
+      ptrdiff_t disp_pos = -1, searchpos;
       int disp_prop = 0;
       bidi_type_t type;
       const unsigned char *s;
+      struct bidi_paragraph_entry *entry = NULL;
+      bool gave_up = false, record_p;
 
       if (!bidi_initialized)
 	bidi_initialize ();
@@ -1773,8 +2062,12 @@ bidi_paragraph_init (bidi_dir_t dir, struct bidi_it *bidi_it, bool no_default_p)
 	     string.  It is treated as a single paragraph.  */
 	  pstartbyte = 0;
 	}
+      else if ((entry = bidi_lookup_paragraph (bidi_it, pos)))
+	pstartbyte = entry->start_byte;
       else
-	pstartbyte = bidi_find_paragraph_start (pos, bytepos);
+	pstartbyte = bidi_find_paragraph_start (pos, bytepos, &gave_up);
+      searchpos = pos;
+      record_p = !string_p && !entry && !gave_up;
       bidi_it->separator_limit = -1;
       bidi_it->new_paragraph = 0;
 
@@ -1784,10 +2077,25 @@ bidi_paragraph_init (bidi_dir_t dir, struct bidi_it *bidi_it, bool no_default_p)
 	bytepos = pstartbyte;
 	if (!string_p)
 	  pos = BYTE_TO_CHAR (bytepos);
-	type = find_first_strong_char (pos, bytepos, end, &disp_pos, &disp_prop,
-				       &bidi_it->string, bidi_it->w,
-				       string_p, bidi_it->frame_window_p,
-				       &ch_len, &nchars, false);
+	if (entry)
+	  {
+	    type = entry->type;
+	    entry = NULL;
+	    cached = true;
+	  }
+	else
+	  {
+	    type = find_first_strong_char (pos, bytepos, end, &disp_pos,
+					   &disp_prop, &bidi_it->string,
+					   bidi_it->w, string_p,
+					   bidi_it->frame_window_p,
+					   &ch_len, &nchars, false);
+	    /* Only the paragraph containing SEARCHPOS, which we look
+	       at first, can be recorded.  */
+	    if (record_p)
+	      bidi_record_paragraph (bidi_it, searchpos, pos, bytepos, type);
+	    record_p = false;
+	  }
 	if (type == STRONG_R || type == STRONG_AL) /* P3 */
 	  bidi_it->paragraph_dir = R2L;
 	else if (type == STRONG_L)
@@ -1810,7 +2118,7 @@ bidi_paragraph_init (bidi_dir_t dir, struct bidi_it *bidi_it, bool no_default_p)
 		       string?  See also a FIXME inside
 		       bidi_find_paragraph_start.  */
 		    dec_both (&p, &pbyte);
-		    prevpbyte = bidi_find_paragraph_start (p, pbyte);
+		    prevpbyte = bidi_find_paragraph_start (p, pbyte, NULL);
 		  }
 		pstartbyte = prevpbyte;
 	      }
@@ -1838,7 +2146,7 @@ bidi_paragraph_init (bidi_dir_t dir, struct bidi_it *bidi_it, bool no_default_p)
      roughly equivalent to the display engine iterating over a single
      buffer position.  */
   ptrdiff_t nexamined = bidi_it->charpos - pos + nsearch_for_strong;
-  if (max_redisplay_ticks > 0 && nexamined > 0)
+  if (max_redisplay_ticks > 0 && nexamined > 0 && !cached)
     update_redisplay_ticks (nexamined / 50, bidi_it->w);
 }
 
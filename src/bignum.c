@@ -86,6 +86,22 @@ double_to_integer (double d)
   return make_integer_mpz ();
 }
 
+/* Recently made bignums of at most BIGNUM_CACHE_BITS bits, indexed by
+   a hash of their values.  Code that keeps computing the same few
+   bignums, such as timestamps with the same seconds count, can then
+   share them instead of allocating each anew; this is valid because
+   bignums are immutable and 'eq' need not distinguish equal ones.
+   Garbage collection clears the cache, so it keeps nothing alive.  */
+enum { BIGNUM_CACHE_BITS = 128, BIGNUM_CACHE_SIZE_BITS = 6 };
+static Lisp_Object bignum_cache[1 << BIGNUM_CACHE_SIZE_BITS];
+
+void
+clear_bignum_cache (void)
+{
+  for (int i = 0; i < ARRAYELTS (bignum_cache); i++)
+    bignum_cache[i] = Qnil;
+}
+
 /* Return a Lisp integer equal to mpz[0], which has BITS bits and which
    must not be in fixnum range.  Set mpz[0] to a junk value.  */
 static Lisp_Object
@@ -99,11 +115,26 @@ make_bignum_bits (size_t bits)
   if (integer_width < bits && 2 * max (INTMAX_WIDTH, UINTMAX_WIDTH) < bits)
     overflow_error ();
 
+  Lisp_Object *slot = NULL;
+  if (bits <= BIGNUM_CACHE_BITS)
+    {
+      EMACS_UINT hash = mpz_sgn (mpz[0]) < 0;
+      for (size_t i = 0; i < mpz_size (mpz[0]); i++)
+	hash = sxhash_combine (hash, mpz_getlimbn (mpz[0], i));
+      slot = &bignum_cache[knuth_hash (reduce_emacs_uint_to_hash_hash (hash),
+				       BIGNUM_CACHE_SIZE_BITS)];
+      if (BIGNUMP (*slot) && mpz_cmp (*xbignum_val (*slot), mpz[0]) == 0)
+	return *slot;
+    }
+
   struct Lisp_Bignum *b = ALLOCATE_PLAIN_PSEUDOVECTOR (struct Lisp_Bignum,
 						       PVEC_BIGNUM);
   mpz_init (b->value);
   mpz_swap (b->value, mpz[0]);
-  return make_lisp_ptr (b, Lisp_Vectorlike);
+  Lisp_Object result = make_lisp_ptr (b, Lisp_Vectorlike);
+  if (slot)
+    *slot = result;
+  return result;
 }
 
 /* Return a Lisp integer equal to mpz[0], which must not be in fixnum range.
@@ -299,6 +330,59 @@ mpz_to_uintmax (mpz_t const z, uintmax_t *pi)
   return true;
 }
 
+/* If the Lisp bignum N fits in intwide_t, store its value into *PI and
+   return true.  Return false otherwise.  */
+bool
+bignum_to_intwide (Lisp_Object n, intwide_t *pi)
+{
+  mpz_t const *z = xbignum_val (n);
+  ptrdiff_t bits = mpz_sizeinbase (*z, 2);
+  if (INTWIDE_WIDTH <= bits)
+    return false;
+
+  uintwide_t v = 0;
+  int i = 0, shift = 0;
+
+  do
+    {
+      uintwide_t limb = mpz_getlimbn (*z, i++);
+      v += limb << shift;
+      shift += GMP_NUMB_BITS;
+    }
+  while (shift < bits);
+
+  *pi = mpz_sgn (*z) < 0 ? - (intwide_t) v : v;
+  return true;
+}
+
+/* Set RESULT to V.  */
+void
+mpz_set_intwide (mpz_t result, intwide_t v)
+{
+  int maxlimbs = (INTWIDE_WIDTH + GMP_NUMB_BITS - 1) / GMP_NUMB_BITS;
+  mp_limb_t *limb = mpz_limbs_write (result, maxlimbs);
+  int n = 0;
+  uintwide_t u = v < 0 ? - (uintwide_t) v : v;
+
+  do
+    {
+      limb[n++] = u;
+      u = GMP_NUMB_BITS < INTWIDE_WIDTH ? u >> GMP_NUMB_BITS : 0;
+    }
+  while (u != 0);
+
+  mpz_limbs_finish (result, v < 0 ? -n : n);
+}
+
+/* Return a Lisp integer equal to N, which must not be in fixnum range.
+   This lets arithmetic on small bignums avoid GMP until the end.  */
+Lisp_Object
+make_bigwide (intwide_t n)
+{
+  mpz_set_intwide (mpz[0], n);
+  return make_bignum ();
+}
+
 /* Return the value of the bignum X if it fits, 0 otherwise.
    A bignum cannot be zero, so 0 indicates failure reliably.  */
 intmax_t
@@ -36,6 +36,19 @@ #define BIGNUM_H
 enum { GMP_NUMB_BITS = TYPE_WIDTH (mp_limb_t) };
 #endif
 
+/* A signed integer type twice as wide as intmax_t if the compiler
+   has one, intmax_t otherwise, and its unsigned counterpart.
+   Arithmetic on small bignums can use it instead of GMP.  */
+#if defined __SIZEOF_INT128__ && INTMAX_WIDTH == 64
+__extension__ typedef __int128 intwide_t;
+__extension__ typedef unsigned __int128 uintwide_t;
+# define INTWIDE_WIDTH 128
+#else
+typedef intmax_t intwide_t;
+typedef uintmax_t uintwide_t;
+# define INTWIDE_WIDTH INTMAX_WIDTH
+#endif
+
 struct Lisp_Bignum
 {
   union vectorlike_header header;
@@ -50,6 +63,9 @@ #define BIGNUM_H
 extern bool mpz_to_uintmax (mpz_t const, uintmax_t *) ARG_NONNULL ((1, 2));
 extern void mpz_set_intmax_slow (mpz_t, intmax_t) ARG_NONNULL ((1));
 extern void mpz_set_uintmax_slow (mpz_t, uintmax_t) ARG_NONNULL ((1));
+extern void mpz_set_intwide (mpz_t, intwide_t) ARG_NONNULL ((1));
+extern bool bignum_to_intwide (Lisp_Object, intwide_t *) ARG_NONNULL ((2));
+extern Lisp_Object make_bigwide (intwide_t);
 extern void emacs_mpz_mul (mpz_t, mpz_t const, mpz_t const)
   ARG_NONNULL ((1, 2, 3));
 extern void emacs_mpz_mul_2exp (mpz_t, mpz_t const, EMACS_INT)
@@ -103,6 +119,27 @@ xbignum_val (Lisp_Object i)
   return bignum_val (XBIGNUM (i));
 }
 
+/* If the Lisp integer NUM fits in intwide_t, store its value into *N
+   and return true.  Otherwise return false.  */
+INLINE bool
+integer_to_intwide (Lisp_Object num, intwide_t *n)
+{
+  if (FIXNUMP (num))
+    {
+      *n = XFIXNUM (num);
+      return true;
+    }
+  return bignum_to_intwide (num, n);
+}
+
+/* Return a Lisp integer equal to N.  */
+INLINE Lisp_Object
+make_intwide (intwide_t n)
+{
+  intmax_t i;
+  return !ckd_add (&i, n, 0) ? make_int (i) : make_bigwide (n);
+}
+
 /* Return a pointer to an mpz_t that is equal to the Lisp integer I.
    If I is a bignum this returns a pointer to I's representation;
    otherwise this sets *TMP to I's value and returns TMP.  */
@@ -118,6 +118,11 @@ #define OVERLAY_COUNT_MAX						\
    due to user rplac'ing this alist or its elements.  */
 Lisp_Object Vbuffer_alist;
 
+/* Hash table of the live buffers by their names, which `get-buffer'
+   uses instead of searching Vbuffer_alist.  It has the same names and
+   buffers as Vbuffer_alist.  */
+static Lisp_Object Vbuffer_name_table;
+
 static Lisp_Object QSFundamental;	/* A string "Fundamental".  */
 
 static void alloc_buffer_text (struct buffer *, ptrdiff_t);
@@ -456,22 +461,6 @@ DEFUN ("buffer-list", Fbuffer_list, Sbuffer_list, 0, 1, 0,
     return general;
 }
 
-/* Like Fassoc, but use Fstring_equal to compare
-   (which ignores text properties), and don't ever quit.  */
-
-static Lisp_Object
-assoc_ignore_text_properties (Lisp_Object key, Lisp_Object list)
-{
-  Lisp_Object tail;
-  for (tail = list; CONSP (tail); tail = XCDR (tail))
-    {
-      Lisp_Object elt = XCAR (tail);
-      if (!NILP (Fstring_equal (Fcar (elt), key)))
-	return elt;
-    }
-  return Qnil;
-}
-
 DEFUN ("get-buffer", Fget_buffer, Sget_buffer, 1, 1, 0,
        doc: /* Return the buffer named BUFFER-OR-NAME.
 BUFFER-OR-NAME must be either a string or a buffer.  If BUFFER-OR-NAME
@@ -483,7 +472,7 @@ DEFUN ("get-buffer", Fget_buffer, Sget_buffer, 1, 1, 0,
     return buffer_or_name;
   CHECK_STRING (buffer_or_name);
 
-  return Fcdr (assoc_ignore_text_properties (buffer_or_name, Vbuffer_alist));
+  return Fgethash (buffer_or_name, Vbuffer_name_table, Qnil);
 }
 
 DEFUN ("get-file-buffer", Fget_file_buffer, Sget_file_buffer, 1, 1, 0,
@@ -634,10 +623,14 @@ DEFUN ("get-buffer-create", Fget_buffer_create, Sget_buffer_create, 1, 2, 0,
   *(BUF_GPT_ADDR (b)) = *(BUF_Z_ADDR (b)) = 0; /* Put an anchor '\0'.  */
   b->text->inhibit_shrinking = false;
   b->text->redisplay = false;
+  b->text->bytechar_index = NULL;
+  b->text->line_index = NULL;
 
   b->newline_cache = 0;
   b->width_run_cache = 0;
   b->bidi_paragraph_cache = 0;
+  b->composition_cache = 0;
+  b->line_height_cache = NULL;
   bset_width_table (b, Qnil);
   b->prevent_redisplay_optimizations_p = 1;
 
@@ -664,6 +657,7 @@ DEFUN ("get-buffer-create", Fget_buffer_create, Sget_buffer_create, 1, 2, 0,
   /* Put this in the alist of all live buffers.  */
   XSETBUFFER (buffer, b);
   Vbuffer_alist = nconc2 (Vbuffer_alist, list1 (Fcons (name, buffer)));
+  Fputhash (name, buffer, Vbuffer_name_table);
 
   run_buffer_list_update_hook (b);
 
@@ -865,6 +859,8 @@ DEFUN ("make-indirect-buffer", Fmake_indirect_buffer, Smake_indirect_buffer,
   b->newline_cache = 0;
   b->width_run_cache = 0;
   b->bidi_paragraph_cache = 0;
+  b->composition_cache = 0;
+  b->line_height_cache = NULL;
   bset_width_table (b, Qnil);
 
   name = Fcopy_sequence (name);
@@ -881,6 +877,7 @@ DEFUN ("make-indirect-buffer", Fmake_indirect_buffer, Smake_indirect_buffer,
   /* Put this in the alist of all live buffers.  */
   XSETBUFFER (buf, b);
   Vbuffer_alist = nconc2 (Vbuffer_alist, list1 (Fcons (name, buf)));
+  Fputhash (name, buf, Vbuffer_name_table);
 
   bset_mark (b, Fmake_marker ());
 
@@ -1701,6 +1698,8 @@ DEFUN ("rename-buffer", Frename_buffer, Srename_buffer, 1, 2,
 
   XSETBUFFER (buf, current_buffer);
   Fsetcar (Frassq (buf, Vbuffer_alist), newname);
+  Fremhash (oldname, Vbuffer_name_table);
+  Fputhash (newname, buf, Vbuffer_name_table);
   if (NILP (BVAR (current_buffer, filename))
       && !NILP (BVAR (current_buffer, auto_save_file_name)))
     call0 (Qrename_auto_save_file);
@@ -2065,6 +2064,7 @@ DEFUN ("kill-buffer", Fkill_buffer, Skill_buffer, 0, 1, "bKill buffer: ",
   bset_undo_list (b, Qnil);
   /* Remove the buffer from the list of all buffers.  */
   Vbuffer_alist = Fdelq (Frassq (buffer, Vbuffer_alist), Vbuffer_alist);
+  Fremhash (BVAR (b, name), Vbuffer_name_table);
   /* If replace_buffer_in_windows didn't do its job fix that now.  */
   replace_buffer_in_windows_safely (buffer);
   Vinhibit_quit = tem;
@@ -2075,16 +2075,15 @@ DEFUN ("kill-buffer", Fkill_buffer, Skill_buffer, 0, 1, "bKill buffer: ",
       /* Unchain all markers that belong to this indirect buffer.
 	 Don't unchain the markers that belong to the base buffer
 	 or its other indirect buffers.  */
-      struct Lisp_Marker **mp = &BUF_MARKERS (b);
-      while ((m = *mp))
+      struct Lisp_Marker *next;
+      for (m = BUF_MARKERS (b); m; m = next)
 	{
+	  next = m->next;
 	  if (m->buffer == b)
 	    {
 	      m->buffer = NULL;
-	      *mp = m->next;
+	      unlink_marker (m, b);
 	    }
-	  else
-	    mp = &m->next;
 	}
       /* Intervals should be owned by the base buffer (Bug#16502).  */
       i = buffer_intervals (b);
@@ -2103,7 +2102,7 @@ DEFUN ("kill-buffer", Fkill_buffer, Skill_buffer, 0, 1, "bKill buffer: ",
 	{
 	  struct Lisp_Marker *next = m->next;
 	  m->buffer = 0;
-	  m->next = NULL;
+	  m->next = m->prev = NULL;
 	  m = next;
 	}
       BUF_MARKERS (b) = NULL;
@@ -2156,6 +2155,13 @@ DEFUN ("kill-buffer", Fkill_buffer, Skill_buffer, 0, 1, "bKill buffer: ",
       free_region_cache (b->bidi_paragraph_cache);
       b->bidi_paragraph_cache = 0;
     }
+  if (b->composition_cache)
+    {
+      free_region_cache (b->composition_cache);
+      b->composition_cache = 0;
+    }
+  bidi_forget_buffer_paragraphs (b);
+  free_line_height_cache (b);
   bset_width_table (b, Qnil);
   unblock_input ();
 
@@ -2347,22 +2353,26 @@ set_buffer_internal_1 (register struct buffer *b)
 
   /* Look down buffer's list of local Lisp variables
      to find and update any that forward into C variables.  */
-
-  do
+  for (tail = BVAR (b, local_var_alist); CONSP (tail); tail = XCDR (tail))
     {
-      for (tail = BVAR (b, local_var_alist); CONSP (tail); tail = XCDR (tail))
-	{
-	  Lisp_Object var = XCAR (XCAR (tail));
-	  struct Lisp_Symbol *sym = XSYMBOL (var);
-	  if (sym->u.s.redirect == SYMBOL_LOCALIZED /* Just to be sure.  */
-	      && SYMBOL_BLV (sym)->fwd.fwdptr)
-	    /* Just reference the variable
-	       to cause it to become set for this buffer.  */
-	    Fsymbol_value (var);
-	}
+      struct Lisp_Symbol *sym = XSYMBOL (XCAR (XCAR (tail)));
+      if (sym->u.s.redirect == SYMBOL_LOCALIZED /* Just to be sure.  */
+	  && SYMBOL_BLV (sym)->fwd.fwdptr)
+	swap_in_symval_binding (sym, XCAR (tail));
     }
-  /* Do the same with any others that were local to the previous buffer */
-  while (b != old_buf && (b = old_buf, b));
+
+  /* Do the same with any others that were local to the previous
+     buffer.  The loop above set up all those that are local to B, so
+     the rest have no binding in B.  */
+  if (old_buf && old_buf != b)
+    for (tail = BVAR (old_buf, local_var_alist); CONSP (tail);
+	 tail = XCDR (tail))
+      {
+	struct Lisp_Symbol *sym = XSYMBOL (XCAR (XCAR (tail)));
+	if (sym->u.s.redirect == SYMBOL_LOCALIZED /* Just to be sure.  */
+	    && SYMBOL_BLV (sym)->fwd.fwdptr)
+	  swap_in_symval_binding (sym, Qnil);
+      }
 }
 
 /* Switch to buffer B temporarily for redisplay purposes.
@@ -2599,6 +2609,13 @@ #define swapfield_(field, type) \
   swapfield (newline_cache, struct region_cache *);
   swapfield (width_run_cache, struct region_cache *);
   swapfield (bidi_paragraph_cache, struct region_cache *);
+  swapfield (composition_cache, struct region_cache *);
+  swapfield (composition_cache_generation, EMACS_UINT);
+  swapfield (line_height_cache, struct line_height_cache *);
+  invalidate_syntax_checkpoints (current_buffer, BEG);
+  invalidate_syntax_checkpoints (other_buffer, BEG);
+  reset_lisp_region_caches (current_buffer);
+  reset_lisp_region_caches (other_buffer);
   current_buffer->prevent_redisplay_optimizations_p = 1;
   other_buffer->prevent_redisplay_optimizations_p = 1;
   swapfield (long_line_optimizations_p, bool_bf);
@@ -2727,6 +2744,8 @@ DEFUN ("set-buffer-multibyte", Fset_buffer_multibyte, Sset_buffer_multibyte,
 
   /* If the cached position is for this buffer, clear it out.  */
   clear_charpos_cache (current_buffer);
+  invalidate_bytechar_index (current_buffer, BEG_BYTE, PTRDIFF_MAX);
+  free_line_index (current_buffer);
 
   if (NILP (flag))
     begv = BEGV_BYTE, zv = ZV_BYTE;
@@ -3630,6 +3649,85 @@ DEFUN ("make-overlay", Fmake_overlay, Smake_overlay, 2, 5, 0,
   return ov;
 }
 
+DEFUN ("make-overlays", Fmake_overlays, Smake_overlays, 1, 4, 0,
+       doc: /* Create overlays with the ranges in RANGES in BUFFER.
+RANGES is a list or vector of conses (BEG . END), where BEG and END
+may be integers or markers.  Return a vector of the new overlays, in the
+order of RANGES.
+If omitted, BUFFER defaults to the current buffer.  FRONT-ADVANCE and
+REAR-ADVANCE apply to all the overlays, and mean the same as for
+`make-overlay'.
+
+This is equivalent to calling `make-overlay' for each range, but is
+much faster when creating many overlays at once.  */)
+  (Lisp_Object ranges, Lisp_Object buffer,
+   Lisp_Object front_advance, Lisp_Object rear_advance)
+{
+  struct buffer *b;
+
+  if (NILP (buffer))
+    XSETBUFFER (buffer, current_buffer);
+  else
+    CHECK_BUFFER (buffer);
+
+  b = XBUFFER (buffer);
+  if (! BUFFER_LIVE_P (b))
+    error ("Attempt to create overlay in a dead buffer");
+
+  if (!VECTORP (ranges))
+    ranges = Fvconcat (1, &ranges);
+
+  /* Check all the ranges before creating any overlay.  */
+  ptrdiff_t n = ASIZE (ranges);
+  for (ptrdiff_t i = 0; i < n; i++)
+    {
+      Lisp_Object range = AREF (ranges, i);
+      CHECK_CONS (range);
+      Lisp_Object beg = XCAR (range), end = XCDR (range);
+      if (MARKERP (beg) && !BASE_EQ (Fmarker_buffer (beg), buffer))
+	signal_error ("Marker points into wrong buffer", beg);
+      if (MARKERP (end) && !BASE_EQ (Fmarker_buffer (end), buffer))
+	signal_error ("Marker points into wrong buffer", end);
+      CHECK_FIXNUM_COERCE_MARKER (beg);
+      CHECK_FIXNUM_COERCE_MARKER (end);
+    }
+
+  Lisp_Object overlays = make_nil_vector (n);
+  struct itree_node **nodes;
+  USE_SAFE_ALLOCA;
+  SAFE_NALLOCA (nodes, 1, n);
+
+  for (ptrdiff_t i = 0; i < n; i++)
+    {
+      Lisp_Object range = AREF (ranges, i);
+      ptrdiff_t beg = fix_position (XCAR (range));
+      ptrdiff_t end = fix_position (XCDR (range));
+
+      if (beg > end)
+	{
+	  ptrdiff_t temp = beg;
+	  beg = end;
+	  end = temp;
+	}
+
+      Lisp_Object ov = build_overlay (! NILP (front_advance),
+				      ! NILP (rear_advance), Qnil);
+      struct itree_node *node = XOVERLAY (ov)->interval;
+      node->begin = clip_to_bounds (BUF_BEG (b), beg, BUF_Z (b));
+      node->end = clip_to_bounds (node->begin, end, BUF_Z (b));
+      XOVERLAY (ov)->buffer = b;
+      nodes[i] = node;
+      ASET (overlays, i, ov);
+    }
+
+  if (! b->overlays)
+    b->overlays = itree_create ();
+  itree_insert_nodes (b->overlays, nodes, n);
+
+  SAFE_FREE ();
+  return overlays;
+}
+
 /* Mark a section of BUF as needing redisplay because of overlays changes.  */
 
 static void
@@ -3777,6 +3875,86 @@ DEFUN ("delete-overlay", Fdelete_overlay, Sdelete_overlay, 1, 1, 0,
   return unbind_to (count, Qnil);
 }
 
+struct overlay_to_delete
+{
+  struct buffer *buffer;
+  struct itree_node *node;
+};
+
+static int
+compare_overlays_to_delete (const void *a, const void *b)
+{
+  uintptr_t buffer_a = (uintptr_t) ((struct overlay_to_delete const *) a)->buffer;
+  uintptr_t buffer_b = (uintptr_t) ((struct overlay_to_delete const *) b)->buffer;
+
+  return (buffer_a > buffer_b) - (buffer_a < buffer_b);
+}
+
+DEFUN ("delete-overlays", Fdelete_overlays, Sdelete_overlays, 1, 1, 0,
+       doc: /* Delete the overlays in OVERLAYS from their buffers.
+OVERLAYS is a list or vector of overlays.  This is equivalent to calling
+`delete-overlay' for each of them, but is much faster when deleting
+many overlays at once.  */)
+  (Lisp_Object overlays)
+{
+  specpdl_ref count = SPECPDL_INDEX ();
+
+  if (!VECTORP (overlays))
+    overlays = Fvconcat (1, &overlays);
+
+  ptrdiff_t n = ASIZE (overlays);
+  for (ptrdiff_t i = 0; i < n; i++)
+    CHECK_OVERLAY (AREF (overlays, i));
+
+  specbind (Qinhibit_quit, Qt);
+
+  struct overlay_to_delete *entries;
+  USE_SAFE_ALLOCA;
+  SAFE_NALLOCA (entries, 1, n);
+
+  /* Detach the overlays from their buffers, and collect their nodes.
+     Since a detached overlay has no buffer, an overlay that appears
+     more than once in OVERLAYS is collected only once.  */
+  ptrdiff_t k = 0;
+  for (ptrdiff_t i = 0; i < n; i++)
+    {
+      Lisp_Object overlay = AREF (overlays, i);
+      struct Lisp_Overlay *ov = XOVERLAY (overlay);
+      struct buffer *b = ov->buffer;
+
+      if (! b)
+	continue;
+      modify_overlay (b, overlay_start (ov), overlay_end (ov));
+      /* See Fdelete_overlay.  */
+      if (!windows_or_buffers_changed
+	  && (!NILP (Foverlay_get (overlay, Qbefore_string))
+	      || !NILP (Foverlay_get (overlay, Qafter_string))))
+	b->prevent_redisplay_optimizations_p = 1;
+      entries[k].buffer = b;
+      entries[k].node = ov->interval;
+      k++;
+      ov->buffer = NULL;
+    }
+
+  /* Remove the nodes from the overlay tree of each buffer at once.  */
+  if (k > 1)
+    qsort (entries, k, sizeof *entries, compare_overlays_to_delete);
+  struct itree_node **nodes;
+  SAFE_NALLOCA (nodes, 1, k);
+  for (ptrdiff_t i = 0; i < k; )
+    {
+      struct buffer *b = entries[i].buffer;
+      ptrdiff_t m = 0;
+
+      for (; i < k && entries[i].buffer == b; i++)
+	nodes[m++] = entries[i].node;
+      itree_remove_nodes (b->overlays, nodes, m);
+    }
+
+  SAFE_FREE ();
+  return unbind_to (count, Qnil);
+}
+
 DEFUN ("delete-all-overlays", Fdelete_all_overlays, Sdelete_all_overlays, 0, 1, 0,
        doc: /* Delete all overlays of BUFFER.
 BUFFER omitted or nil means delete all overlays of the current
@@ -4638,6 +4816,8 @@ free_buffer_text (struct buffer *b)
     }
 
   BUF_BEG_ADDR (b) = NULL;
+  free_bytechar_index (b);
+  free_line_index (b);
   unblock_input ();
 }
 
@@ -4862,6 +5042,8 @@ init_buffer_once (void)
   { static_assert (sizeof (EMACS_INT) == word_size); }
 
   Vbuffer_alist = Qnil;
+  Vbuffer_name_table = make_hash_table (&hashtest_equal, DEFAULT_HASH_SIZE,
+					Weak_None);
   current_buffer = 0;
   pdumper_remember_lv_ptr_raw (&current_buffer, Lisp_Vectorlike);
 
@@ -4881,6 +5063,7 @@ init_buffer_once (void)
   Vprin1_to_string_buffer =
     Fget_buffer_create (build_string (" prin1"), Qt);
   Vbuffer_alist = Qnil;
+  Fclrhash (Vbuffer_name_table);
 
   Fset_buffer (Fget_buffer_create (build_string ("*scratch*"), Qnil));
 
@@ -5030,6 +5213,7 @@ syms_of_buffer (void)
 
   staticpro (&QSFundamental);
   staticpro (&Vbuffer_alist);
+  staticpro (&Vbuffer_name_table);
 
   DEFSYM (Qchoice, "choice");
   DEFSYM (Qleft, "left");
@@ -5741,6 +5925,11 @@ from (abs POSITION).  If POSITION is positive, point was at the front
 results of these scans are cached.  This doesn't help too much if
 paragraphs are of the reasonable (few thousands of characters) size.
 
+Automatic composition of characters, see `auto-composition-mode', also
+scans the buffer for characters that could be composed.  If
+`cache-long-scans' is non-nil, stretches of text that have no such
+characters are remembered.
+
 The caches require no explicit maintenance; their accuracy is
 maintained internally by the Emacs primitives.  Enabling or disabling
 the cache should not affect the behavior of any of the motion
@@ -6048,7 +6237,9 @@ Functions (implicitly) running this hook are `get-buffer-create',
 
   defsubr (&Soverlayp);
   defsubr (&Smake_overlay);
+  defsubr (&Smake_overlays);
   defsubr (&Sdelete_overlay);
+  defsubr (&Sdelete_overlays);
   defsubr (&Sdelete_all_overlays);
   defsubr (&Smove_overlay);
   defsubr (&Soverlay_start);
@@ -275,11 +275,20 @@ #define FETCH_BYTE(n) (*BYTE_POS_ADDR (n))
        This is actually a single marker ---
        successive elements in its marker `chain'
        are the other markers referring to this buffer.
-       This is a singly linked unordered list, which means that it's
-       very cheap to add a marker to the list and it's also very cheap
-       to move a marker within a buffer.  */
+       This is a doubly linked unordered list, which means that it's
+       very cheap to add a marker to the list or remove it from the
+       list, and it's also very cheap to move a marker within a
+       buffer.  */
     struct Lisp_Marker *markers;
 
+    /* Checkpoints of known character and byte positions in large
+       multibyte buffers, or NULL.  See marker.c.  */
+    struct bytechar_index *bytechar_index;
+
+    /* Checkpoints of the number of lines before places in large
+       buffers, or NULL.  See search.c.  */
+    struct line_index *line_index;
+
     /* Usually false.  Temporarily true in decode_coding_gap to
        prevent Fgarbage_collect from shrinking the gap and losing
        not-yet-decoded bytes.  */
@@ -674,10 +683,23 @@ #define BVAR(buf, field) ((buf)->field ## _)
      such regions very quickly, using algebra instead of inspecting
      each character.   See also width_table, below.
 
-     The latter cache is used to speedup bidi_find_paragraph_start.  */
+     The latter cache is used to speedup bidi_find_paragraph_start.
+
+     The composition cache records which stretches of the buffer are
+     known to contain no characters with entries in
+     composition-function-table, so that composite.c can skip them
+     when looking for automatic compositions.  The information is
+     valid for the contents of that table as of
+     composition_cache_generation; see composition_cache_on_off.  */
   struct region_cache *newline_cache;
   struct region_cache *width_run_cache;
   struct region_cache *bidi_paragraph_cache;
+  struct region_cache *composition_cache;
+  EMACS_UINT composition_cache_generation;
+
+  /* The heights of the lines of this buffer, as laid out by the
+     display engine.  See the comments in xdisp.c.  */
+  struct line_height_cache *line_height_cache;
 
   /* Non-zero means disable redisplay optimizations when rebuilding the glyph
      matrices (but not when redrawing).  */
@@ -1078,6 +1100,33 @@ PTR_BYTE_POS (unsigned char const *ptr)
   return byte - (byte <= GPT_BYTE - BEG_BYTE ? 0 : GAP_SIZE) + BEG_BYTE;
 }
 
+/* Add marker M to the front of the marker chain of buffer B.  */
+
+INLINE void
+chain_marker (struct Lisp_Marker *m, struct buffer *b)
+{
+  m->prev = NULL;
+  m->next = BUF_MARKERS (b);
+  if (m->next)
+    m->next->prev = m;
+  BUF_MARKERS (b) = m;
+}
+
+/* Remove marker M from the marker chain of buffer B, which must
+   contain it.  This does not change M's buffer.  */
+
+INLINE void
+unlink_marker (struct Lisp_Marker *m, struct buffer *b)
+{
+  if (m->prev)
+    m->prev->next = m->next;
+  else
+    BUF_MARKERS (b) = m->next;
+  if (m->next)
+    m->next->prev = m->prev;
+  m->next = m->prev = NULL;
+}
+
 /* Number of Lisp_Objects at the beginning of struct buffer.
    If you add, remove, or reorder Lisp_Objects within buffer
    structure, make sure that this is still correct.  */
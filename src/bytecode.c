@@ -262,6 +262,11 @@ DEFINE (Bstack_set2, 0263)						\
 DEFINE (BdiscardN,   0266)						\
 									\
 DEFINE (Bswitch, 0267)                                                  \
+									\
+/* Superinstructions, which combine two instructions.  */		\
+DEFINE (Bvarref_car, 0270)						\
+DEFINE (Bdup_gotoifnil, 0271)						\
+DEFINE (Bstack_ref_call, 0272)						\
                                                                         \
 DEFINE (Bconstant, 0300)
 
@@ -445,6 +450,95 @@ DEFUN ("internal-stack-stats", Finternal_stack_stats, Sinternal_stack_stats,
   return Qnil;
 }
 
+/* Profiling of byte-code execution.  While byte_code_profiling is
+   true, byte_code_op_counts counts the instructions executed for each
+   opcode, and byte_code_call_counts maps each function that byte code
+   calls to the number of calls.  The threaded interpreter counts
+   instructions by dispatching through a separate table, so that it
+   costs nothing when profiling is off.  */
+
+static bool byte_code_profiling;
+static EMACS_UINT byte_code_op_counts[256];
+static Lisp_Object byte_code_call_counts;
+
+static void
+byte_code_count_call (Lisp_Object fun)
+{
+  struct Lisp_Hash_Table *h = XHASH_TABLE (byte_code_call_counts);
+  hash_hash_t hash;
+  ptrdiff_t i = hash_lookup_get_hash (h, fun, &hash);
+  if (i < 0)
+    hash_put (h, fun, make_fixnum (1), hash);
+  else if (XFIXNUM (HASH_VALUE (h, i)) < MOST_POSITIVE_FIXNUM)
+    set_hash_value_slot (h, i, make_fixnum (XFIXNUM (HASH_VALUE (h, i)) + 1));
+}
+
+DEFUN ("byte-code-profile-start", Fbyte_code_profile_start,
+       Sbyte_code_profile_start, 0, 0, 0,
+       doc: /* Start counting byte-code instructions and calls.
+This discards the counts of any previous profile.  The counts are
+kept until the next call of this function, and can be retrieved with
+`byte-code-profile-opcodes' and `byte-code-profile-calls'.  Byte-code
+functions that are already running count their instructions only
+after they next call another byte-code function.  */)
+  (void)
+{
+  memset (byte_code_op_counts, 0, sizeof byte_code_op_counts);
+  byte_code_call_counts = make_hash_table (&hashtest_eq, DEFAULT_HASH_SIZE,
+					   Weak_None);
+  byte_code_profiling = true;
+  return Qt;
+}
+
+DEFUN ("byte-code-profile-stop", Fbyte_code_profile_stop,
+       Sbyte_code_profile_stop, 0, 0, 0,
+       doc: /* Stop counting byte-code instructions and calls.
+Return non-nil if the counting was running.  */)
+  (void)
+{
+  bool was_running = byte_code_profiling;
+  byte_code_profiling = false;
+  return was_running ? Qt : Qnil;
+}
+
+DEFUN ("byte-code-profile-running-p", Fbyte_code_profile_running_p,
+       Sbyte_code_profile_running_p, 0, 0, 0,
+       doc: /* Return non-nil if byte-code instructions are being counted.  */)
+  (void)
+{
+  return byte_code_profiling ? Qt : Qnil;
+}
+
+DEFUN ("byte-code-profile-opcodes", Fbyte_code_profile_opcodes,
+       Sbyte_code_profile_opcodes, 0, 0, 0,
+       doc: /* Return the instruction counts of the byte-code profile.
+The value is a hash table that maps each opcode that was executed, as
+an integer, to the number of times it was executed.  An opcode that
+encodes an operand, such as one of the forms of `varref', is counted
+separately from the other forms; `byte-code-vector' gives the name of
+each opcode.  */)
+  (void)
+{
+  Lisp_Object h = make_hash_table (&hashtest_eql, DEFAULT_HASH_SIZE,
+				   Weak_None);
+  for (int op = 0; op < ARRAYELTS (byte_code_op_counts); op++)
+    if (byte_code_op_counts[op])
+      Fputhash (make_fixnum (op), make_uint (byte_code_op_counts[op]), h);
+  return h;
+}
+
+DEFUN ("byte-code-profile-calls", Fbyte_code_profile_calls,
+       Sbyte_code_profile_calls, 0, 0, 0,
+       doc: /* Return the call counts of the byte-code profile.
+The value is a hash table that maps each function that byte code
+called, usually a symbol, to the number of calls.  */)
+  (void)
+{
+  return (HASH_TABLE_P (byte_code_call_counts)
+	  ? Fcopy_hash_table (byte_code_call_counts)
+	  : make_hash_table (&hashtest_eq, DEFAULT_HASH_SIZE, Weak_None));
+}
+
 /* Whether a stack pointer is valid in the current frame.  */
 static bool
 valid_sp (struct bc_thread_state *bc, Lisp_Object *sp)
@@ -453,6 +547,60 @@ valid_sp (struct bc_thread_state *bc, Lisp_Object *sp)
   return sp < (Lisp_Object *)fp && sp + 1 >= fp->saved_fp->next_stack;
 }
 
+/* Return the value of the variable SYM, which is not a plain variable
+   with a value.  Handle buffer-local variables whose current binding
+   is loaded for the current buffer, and built-in variables, without
+   calling Fsymbol_value.  */
+
+static Lisp_Object
+varref_slow (Lisp_Object sym)
+{
+  struct Lisp_Symbol *s = XBARE_SYMBOL (sym);
+  Lisp_Object val = Qunbound;
+  switch (s->u.s.redirect)
+    {
+    case SYMBOL_LOCALIZED:
+      {
+	struct Lisp_Buffer_Local_Value *blv = SYMBOL_BLV (s);
+	if (!blv->fwd.fwdptr && BUFFERP (blv->where)
+	    && XBUFFER (blv->where) == current_buffer)
+	  val = XCDR (blv->valcell);
+      }
+      break;
+
+    case SYMBOL_FORWARDED:
+      val = do_symval_forwarding (SYMBOL_FWD (s));
+      break;
+
+    default:
+      break;
+    }
+  return BASE_EQ (val, Qunbound) ? Fsymbol_value (sym) : val;
+}
+
+/* Set the buffer-local variable SYM to VAL if its binding for the
+   current buffer is loaded, and return true if so.  Return false if
+   set_internal must do the job.  */
+
+static bool
+varset_fast (Lisp_Object sym, Lisp_Object val)
+{
+  struct Lisp_Symbol *s = XBARE_SYMBOL (sym);
+  if (BASE_EQ (val, Qunbound)
+      || s->u.s.redirect != SYMBOL_LOCALIZED
+      || s->u.s.trapped_write)
+    return false;
+  struct Lisp_Buffer_Local_Value *blv = SYMBOL_BLV (s);
+  /* When the default binding is loaded, setting the variable may
+     need to make a local binding.  */
+  if (blv->fwd.fwdptr || !BUFFERP (blv->where)
+      || XBUFFER (blv->where) != current_buffer
+      || BASE_EQ (blv->valcell, blv->defcell))
+    return false;
+  XSETCDR (blv->valcell, val);
+  return true;
+}
+
 /* Execute the byte-code in FUN.  ARGS_TEMPLATE is the function arity
    encoded as an integer (the one in FUN is ignored), and ARGS, of
    size NARGS, should be a vector of the actual arguments.  The
@@ -530,6 +678,13 @@ exec_byte_code (Lisp_Object fun, ptrdiff_t args_template,
     for (ptrdiff_t i = nargs - rest; i < nonrest; i++)
       PUSH (Qnil);
 
+  /* The handlers pushed by this invocation share HANDLER_JMP, which
+     is set up when the first of them is pushed.  This is safe because
+     the landing code below reloads all of its state from the handler
+     and the current frame.  */
+  sys_jmp_buf handler_jmp;
+  bool volatile handler_jmp_set = false;
+
   unsigned char volatile saved_quitcounter;
 #if GCC_LINT && __GNUC__ && !__clang__
   Lisp_Object *volatile saved_vectorp;
@@ -551,6 +706,10 @@ exec_byte_code (Lisp_Object fun, ptrdiff_t args_template,
 #elif !defined BYTE_CODE_THREADED
       op = FETCH;
 #endif
+#ifndef BYTE_CODE_THREADED
+      if (byte_code_profiling)
+	byte_code_op_counts[op]++;
+#endif
 
       /* The interpreter can be compiled one of two ways: as an
 	 ordinary switch-based interpreter, or as a threaded
@@ -565,7 +724,7 @@ #define CASE(OP) insn_ ## OP
       /* NEXT is invoked at the end of an instruction to go to the
 	 next instruction.  It is either a computed goto, or a
 	 plain break.  */
-#define NEXT goto *(targets[op = FETCH])
+#define NEXT goto *(dispatch[op = FETCH])
       /* FIRST is like NEXT, but is only used at the start of the
 	 interpreter body.  In the switch-based interpreter it is the
 	 switch, so the threaded definition must include a semicolon.  */
@@ -600,6 +759,16 @@ #define DEFINE(name, value) [name] = &&insn_ ## name,
 #undef DEFINE
 	};
 
+      /* The dispatch table used while profiling, which counts each
+	 instruction before going to its code.  */
+      static const void *const counting_targets[256] =
+	{
+	  [0 ... 255] = &&insn_count
+	};
+
+      const void *const *dispatch
+	= byte_code_profiling ? counting_targets : targets;
+
 #endif
 
 
@@ -628,7 +797,7 @@ #define DEFINE(name, value) [name] = &&insn_ ## name,
 	    if (XBARE_SYMBOL (v1)->u.s.redirect != SYMBOL_PLAINVAL
 		|| (v2 = XBARE_SYMBOL (v1)->u.s.val.value,
 		    BASE_EQ (v2, Qunbound)))
-	      v2 = Fsymbol_value (v1);
+	      v2 = varref_slow (v1);
 	    PUSH (v2);
 	    NEXT;
 	  }
@@ -642,6 +811,32 @@ #define DEFINE(name, value) [name] = &&insn_ ## name,
 	    NEXT;
 	  }
 
+	/* Bvarref6 of the variable in the following byte, then Bcar.  */
+	CASE (Bvarref_car):
+	  {
+	    Lisp_Object v1 = vectorp[FETCH], v2;
+	    if (XBARE_SYMBOL (v1)->u.s.redirect != SYMBOL_PLAINVAL
+		|| (v2 = XBARE_SYMBOL (v1)->u.s.val.value,
+		    BASE_EQ (v2, Qunbound)))
+	      v2 = varref_slow (v1);
+	    PUSH (v2);
+	    if (CONSP (TOP))
+	      TOP = XCAR (TOP);
+	    else if (!NILP (TOP))
+	      {
+		record_in_backtrace (Qcar, &TOP, 1);
+		wrong_type_argument (Qlistp, TOP);
+	      }
+	    NEXT;
+	  }
+
+	/* Bdup, then Bgotoifnil.  */
+	CASE (Bdup_gotoifnil):
+	  op = FETCH2;
+	  if (NILP (TOP))
+	    goto op_branch;
+	  NEXT;
+
 	CASE (Bcar):
 	  if (CONSP (TOP))
 	    TOP = XCAR (TOP);
@@ -703,7 +898,7 @@ #define DEFINE(name, value) [name] = &&insn_ ## name,
 		&& XBARE_SYMBOL (sym)->u.s.redirect == SYMBOL_PLAINVAL
 		&& !XBARE_SYMBOL (sym)->u.s.trapped_write)
 	      SET_SYMBOL_VAL (XBARE_SYMBOL (sym), val);
-	    else
+	    else if (!varset_fast (sym, val))
               set_internal (sym, val, Qnil, SET_INTERNAL_SET);
 	  }
 	  NEXT;
@@ -745,6 +940,16 @@ #define DEFINE(name, value) [name] = &&insn_ ## name,
 	  op = FETCH2;
 	  goto docall;
 
+	/* Bstack_ref6 with the offset in the following byte, then
+	   Bcall6 with the number of arguments in the byte after it.  */
+	CASE (Bstack_ref_call):
+	  {
+	    Lisp_Object v1 = top[- FETCH];
+	    PUSH (v1);
+	    op = FETCH;
+	    goto docall;
+	  }
+
 	CASE (Bcall):
 	CASE (Bcall1):
 	CASE (Bcall2):
@@ -768,6 +973,8 @@ #define DEFINE(name, value) [name] = &&insn_ ## name,
 		  }
 	      }
 #endif
+	    if (byte_code_profiling)
+	      byte_code_count_call (TOP);
 	    maybe_quit ();
 
 	    if (++lisp_eval_depth > max_lisp_eval_depth)
@@ -791,7 +998,13 @@ #define DEFINE(name, value) [name] = &&insn_ ## name,
 	    Lisp_Object original_fun = call_fun;
 	    /* Calls to symbols-with-pos don't need to be on the fast path.  */
 	    if (BARE_SYMBOL_P (call_fun))
-	      call_fun = XBARE_SYMBOL (call_fun)->u.s.function;
+	      {
+		call_fun = XBARE_SYMBOL (call_fun)->u.s.function;
+		/* Follow aliases made by `defalias', so that calls
+		   through them take the fast paths below too.  */
+		if (BARE_SYMBOL_P (call_fun) && !NILP (call_fun))
+		  call_fun = indirect_function (call_fun);
+	      }
 	    if (CLOSUREP (call_fun))
 	      {
 		Lisp_Object template = AREF (call_fun, CLOSURE_ARGLIST);
@@ -964,37 +1177,42 @@ #define DEFINE(name, value) [name] = &&insn_ ## name,
 	    struct handler *c = push_handler (POP, type);
 	    c->bytecode_dest = FETCH2;
 	    c->bytecode_top = top;
+	    c->bytecode_jmp = &handler_jmp;
 
-	    if (sys_setjmp (c->jmp))
+	    if (!handler_jmp_set)
 	      {
-		quitcounter = saved_quitcounter;
-		struct handler *c = handlerlist;
-		handlerlist = c->next;
-		top = c->bytecode_top;
-		op = c->bytecode_dest;
-		bc = &current_thread->bc;
-		struct bc_frame *fp = bc->fp;
-
-		Lisp_Object fun = fp->fun;
-		Lisp_Object bytestr = AREF (fun, CLOSURE_CODE);
-		Lisp_Object vector = AREF (fun, CLOSURE_CONSTANTS);
+		handler_jmp_set = true;
+		if (sys_setjmp (handler_jmp))
+		  {
+		    quitcounter = saved_quitcounter;
+		    struct handler *c = handlerlist;
+		    handlerlist = c->next;
+		    top = c->bytecode_top;
+		    op = c->bytecode_dest;
+		    bc = &current_thread->bc;
+		    struct bc_frame *fp = bc->fp;
+
+		    Lisp_Object fun = fp->fun;
+		    Lisp_Object bytestr = AREF (fun, CLOSURE_CODE);
+		    Lisp_Object vector = AREF (fun, CLOSURE_CONSTANTS);
 #if GCC_LINT && __GNUC__ && !__clang__
-		/* These useless assignments pacify GCC 14.2.1 x86-64
-		   <https://gcc.gnu.org/bugzilla/show_bug.cgi?id=21161>.  */
-		bytestr_data = saved_bytestr_data;
-		vectorp = saved_vectorp;
+		    /* These useless assignments pacify GCC 14.2.1 x86-64
+		       <https://gcc.gnu.org/bugzilla/show_bug.cgi?id=21161>.  */
+		    bytestr_data = saved_bytestr_data;
+		    vectorp = saved_vectorp;
 #endif
-		bytestr_data = SDATA (bytestr);
-		vectorp = XVECTOR (vector)->contents;
-		if (BYTE_CODE_SAFE)
-		  {
-		    /* Only required for checking, not for execution.  */
-		    const_length = ASIZE (vector);
-		    bytestr_length = SCHARS (bytestr);
+		    bytestr_data = SDATA (bytestr);
+		    vectorp = XVECTOR (vector)->contents;
+		    if (BYTE_CODE_SAFE)
+		      {
+			/* Only required for checking, not for execution.  */
+			const_length = ASIZE (vector);
+			bytestr_length = SCHARS (bytestr);
+		      }
+		    pc = bytestr_data;
+		    PUSH (c->val);
+		    goto op_branch;
 		  }
-		pc = bytestr_data;
-		PUSH (c->val);
-		goto op_branch;
 	      }
 
 	    saved_quitcounter = quitcounter;
@@ -1773,6 +1991,14 @@ #define DEFINE(name, value) [name] = &&insn_ ## name,
           }
           NEXT;
 
+#ifdef BYTE_CODE_THREADED
+	insn_count:
+	  /* Don't count after profiling stops in this frame.  */
+	  if (byte_code_profiling)
+	    byte_code_op_counts[op]++;
+	  goto *(targets[op]);
+#endif
+
 	CASE_DEFAULT
 	CASE (Bconstant):
 	  if (BYTE_CODE_SAFE
@@ -1812,6 +2038,14 @@ syms_of_bytecode (void)
 
   defsubr (&Sbyte_code);
   defsubr (&Sinternal_stack_stats);
+  defsubr (&Sbyte_code_profile_start);
+  defsubr (&Sbyte_code_profile_stop);
+  defsubr (&Sbyte_code_profile_running_p);
+  defsubr (&Sbyte_code_profile_opcodes);
+  defsubr (&Sbyte_code_profile_calls);
+
+  staticpro (&byte_code_call_counts);
+  byte_code_call_counts = Qnil;
 
 #ifdef BYTE_CODE_METER
 
@@ -785,8 +785,11 @@ call_process (ptrdiff_t nargs, Lisp_Object *args, int filefd,
 	  nread = carryover;
 	  while (nread < bufsize - 1024)
 	    {
+	      int wait0 = profiler_wait;
+	      profiler_wait = PROFILER_WAIT_PROCESS;
 	      int this_read = emacs_read_quit (fd0, buf + nread,
 					       bufsize - nread);
+	      profiler_wait = wait0;
 
 	      if (this_read < 0)
 		goto give_up;
@@ -841,6 +844,17 @@ call_process (ptrdiff_t nargs, Lisp_Object *args, int filefd,
               insert_1_both (buf, nread, nread, 0, 0, 0);
               signal_after_change (PT - nread, 0, nread);
             }
+	  else if (decode_coding_ascii_verbatim_p (&process_coding,
+						   (unsigned char *) buf,
+						   nread))
+	    {
+	      /* Decoding would not change this chunk, so copy it into
+		 the gap directly instead of running it through the
+		 decoder.  */
+	      insert_1_both (buf, nread, nread, 0, 0, 0);
+	      signal_after_change (PT - nread, 0, nread);
+	      carryover = 0;
+	    }
 	  else
 	    {			/* We have to decode the input.  */
 	      Lisp_Object curbuf;
@@ -921,7 +935,10 @@ call_process (ptrdiff_t nargs, Lisp_Object *args, int filefd,
   bool wait_ok = true;
 #ifndef MSDOS
   /* Wait for it to terminate, unless it already has.  */
+  int wait0 = profiler_wait;
+  profiler_wait = PROFILER_WAIT_PROCESS;
   wait_ok = wait_for_termination (pid, &status, fd0 < 0);
+  profiler_wait = wait0;
 #endif
 
   /* Don't kill any children that the subprocess may have left behind
@@ -61,8 +61,52 @@ Copyright (C) 1985, 1994, 1997-1999, 2001-2025 Free Software Foundation,
 
   /* What the last operation was.  */
   bool downcase_last;
+
+  /* Whether runs of ASCII characters can be cased with
+     case_ascii_run.  */
+  bool ascii_fast;
 };
 
+/* For upcasing and downcasing, the case tables and special casing
+   table last checked by ascii_casing_is_standard, the char_table_modiff
+   as of the check, and its result.  */
+static struct
+{
+  Lisp_Object down, up, special;
+  EMACS_UINT modiff;
+  bool standard;
+} ascii_casing_checked[CASE_CAPITALIZE];
+
+/* Return true if, for upcasing if FLAG is CASE_UP and downcasing if it
+   is CASE_DOWN, the current buffer's case table maps the ASCII letters
+   to each other as usual and the other ASCII characters to themselves,
+   and the special casing table SPECIAL has no entries for ASCII
+   characters.  */
+static bool
+ascii_casing_is_standard (enum case_action flag, Lisp_Object special)
+{
+  Lisp_Object down = BVAR (current_buffer, downcase_table);
+  Lisp_Object up = BVAR (current_buffer, upcase_table);
+  if (EQ (down, ascii_casing_checked[flag].down)
+      && EQ (up, ascii_casing_checked[flag].up)
+      && EQ (special, ascii_casing_checked[flag].special)
+      && ascii_casing_checked[flag].modiff == char_table_modiff)
+    return ascii_casing_checked[flag].standard;
+
+  bool standard = true;
+  for (int c = 0; c < 0x80 && standard; c++)
+    standard = (downcase (c) == ('A' <= c && c <= 'Z' ? c + ('a' - 'A') : c)
+		&& upcase (c) == ('a' <= c && c <= 'z' ? c - ('a' - 'A') : c)
+		&& (NILP (special)
+		    || !STRINGP (CHAR_TABLE_REF (special, c))));
+  ascii_casing_checked[flag].down = down;
+  ascii_casing_checked[flag].up = up;
+  ascii_casing_checked[flag].special = special;
+  ascii_casing_checked[flag].modiff = char_table_modiff;
+  ascii_casing_checked[flag].standard = standard;
+  return standard;
+}
+
 /* Initialize CTX structure for casing characters.  */
 static void
 prepare_casing_context (struct casing_context *ctx,
@@ -90,6 +134,13 @@ prepare_casing_context (struct casing_context *ctx,
 
   if (inbuffer && flag >= CASE_CAPITALIZE)
     SETUP_BUFFER_SYNTAX_TABLE ();	/* For syntax_prefix_flag_p.  */
+
+  /* Capitalizing depends on word boundaries, so it always goes
+     character by character.  */
+  ctx->ascii_fast
+    = (flag < CASE_CAPITALIZE
+       && ascii_casing_is_standard (flag,
+				    ctx->specialcase_char_tables[flag]));
 }
 
 static bool
@@ -186,6 +237,94 @@ case_character_impl (struct casing_str_buf *buf,
   return cased != ch;
 }
 
+/* Return the number of ASCII bytes at the start of the LEN bytes at P.  */
+static ptrdiff_t
+ascii_run_length (unsigned char const *p, ptrdiff_t len)
+{
+  ptrdiff_t i = 0;
+  while (i < len && ASCII_CHAR_P (p[i]))
+    i++;
+  return i;
+}
+
+/* Based on CTX, whose ascii_fast must be true, case the LEN ASCII
+   bytes at SRC and store them at DST, which may be equal to SRC.
+   Update CTX as if the bytes had gone through case_character.  Return
+   whether any byte changed.
+
+   The loop has no branches, so that compilers can vectorize it.  */
+static bool
+case_ascii_run (struct casing_context *ctx, unsigned char *dst,
+		unsigned char const *src, ptrdiff_t len)
+{
+  if (!len)
+    return false;
+
+  bool down = ctx->flag == CASE_DOWN;
+  ctx->downcase_last = down;
+
+  /* Only the last characters of the run can affect whether the next
+     character is within a word.  */
+  for (ptrdiff_t i = len - 1; 0 <= i; i--)
+    {
+      int c = src[i];
+      if (!case_ch_is_word (SYNTAX (c)))
+	{
+	  ctx->inword = false;
+	  break;
+	}
+      if (!ctx->inbuffer || !syntax_prefix_flag_p (c))
+	{
+	  ctx->inword = true;
+	  break;
+	}
+    }
+
+  unsigned char first = down ? 'A' : 'a';
+  unsigned char changed = 0;
+  for (ptrdiff_t i = 0; i < len; i++)
+    {
+      unsigned char c = src[i];
+      unsigned char flip = (unsigned char) (c - first) <= 'z' - 'a' ? 0x20 : 0;
+      dst[i] = c ^ flip;
+      changed |= flip;
+    }
+  return changed != 0;
+}
+
+/* Based on CTX, whose ascii_fast must be true, case the run of ASCII
+   characters in the current buffer that starts at byte position
+   POS_BYTE and is at most NCHARS characters long.  The run stops at
+   the gap.  DELTA is the difference between the character and byte
+   positions of the run.  If any character changed, update *FIRST and
+   *LAST, the character positions of the first change and the end of
+   the last change.  Return the length of the run.  */
+static ptrdiff_t
+case_ascii_region_run (struct casing_context *ctx, ptrdiff_t pos_byte,
+		       ptrdiff_t nchars, ptrdiff_t delta,
+		       ptrdiff_t *first, ptrdiff_t *last)
+{
+  ptrdiff_t limit = (pos_byte < GPT_BYTE ? GPT_BYTE : Z_BYTE) - pos_byte;
+  unsigned char *p = BYTE_POS_ADDR (pos_byte);
+  ptrdiff_t run = ascii_run_length (p, min (nchars, limit));
+  unsigned char lo = ctx->flag == CASE_DOWN ? 'A' : 'a';
+
+  ptrdiff_t i = 0, j = run;
+  while (i < run && (unsigned char) (p[i] - lo) > 'z' - 'a')
+    i++;
+  if (i < run)
+    {
+      while ((unsigned char) (p[j - 1] - lo) > 'z' - 'a')
+	j--;
+      if (*first < 0)
+	*first = pos_byte + delta + i;
+      *last = pos_byte + delta + j;
+    }
+
+  case_ascii_run (ctx, p, p, run);
+  return run;
+}
+
 /* In Greek, lower case sigma has two forms: one when used in the middle and one
    when used at the end of a word.  Below is to help handle those cases when
    casing.
@@ -300,6 +439,17 @@ do_casify_multibyte_string (struct casing_context *ctx, Lisp_Object obj)
 
   for (n = 0; size; --size)
     {
+      if (ctx->ascii_fast)
+	{
+	  ptrdiff_t run = ascii_run_length (src, size);
+	  case_ascii_run (ctx, o, src, run);
+	  src += run;
+	  o += run;
+	  n += run;
+	  size -= run;
+	  if (!size)
+	    break;
+	}
       if (dst_end - o < sizeof (struct casing_str_buf))
 	string_overflow ();
       int ch = string_char_advance (&src);
@@ -333,6 +483,15 @@ do_casify_unibyte_string (struct casing_context *ctx, Lisp_Object obj)
   obj = Fcopy_sequence (obj);
   for (i = 0; i < size; i++)
     {
+      if (ctx->ascii_fast)
+	{
+	  unsigned char *p = SDATA (obj) + i;
+	  ptrdiff_t run = ascii_run_length (p, size - i);
+	  case_ascii_run (ctx, p, p, run);
+	  i += run;
+	  if (i == size)
+	    break;
+	}
       ch = make_char_multibyte (SREF (obj, i));
       cased = case_single_character (ctx, ch);
       if (ch == cased)
@@ -448,6 +607,14 @@ do_casify_unibyte_region (struct casing_context *ctx,
 
   for (ptrdiff_t pos = *startp; pos < end; ++pos)
     {
+      if (ctx->ascii_fast)
+	{
+	  ptrdiff_t run = case_ascii_region_run (ctx, pos, end - pos, 0,
+						 &first, &last);
+	  pos += run;
+	  if (pos == end)
+	    break;
+	}
       int ch = make_char_multibyte (FETCH_BYTE (pos));
       int cased = case_single_character (ctx, ch);
       if (cased == ch)
@@ -481,6 +648,17 @@ do_casify_multibyte_region (struct casing_context *ctx,
 
   for (; size; --size)
     {
+      if (ctx->ascii_fast)
+	{
+	  ptrdiff_t run = case_ascii_region_run (ctx, pos_byte, size,
+						 pos - pos_byte,
+						 &first, &last);
+	  pos += run;
+	  pos_byte += run;
+	  size -= run;
+	  if (!size)
+	    break;
+	}
       int len, ch = string_char_and_length (BYTE_POS_ADDR (pos_byte), &len);
       struct casing_str_buf buf;
       if (!case_character (&buf, ctx, ch,
@@ -546,7 +724,7 @@ casify_region (enum case_action flag, Lisp_Object b, Lisp_Object e)
 #endif
 
   ptrdiff_t orig_end = end;
-  record_delete (start, make_buffer_string (start, end, true), false);
+  record_delete (start, make_buffer_string (start, end, true));
   if (NILP (BVAR (current_buffer, enable_multibyte_characters)))
     {
       record_insert (start, end - start);
@@ -711,6 +889,13 @@ syms_of_casefiddle (void)
   DEFSYM (Qspecial_lowercase, "special-lowercase");
   DEFSYM (Qspecial_titlecase, "special-titlecase");
 
+  for (int i = 0; i < ARRAYELTS (ascii_casing_checked); i++)
+    {
+      staticpro (&ascii_casing_checked[i].down);
+      staticpro (&ascii_casing_checked[i].up);
+      staticpro (&ascii_casing_checked[i].special);
+    }
+
   DEFVAR_LISP ("region-extract-function", Vregion_extract_function,
 	       doc: /* Function to get the region's content.
 Called with one argument METHOD which can be:
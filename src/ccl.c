@@ -841,6 +841,16 @@ #define CCL_ENCODE_CHAR(c, charset_list, id, encoded)		\
    If SOURCE or DESTINATION is NULL, only operations on registers are
    permitted.  */
 
+/* If CCL_THREADED is defined, ccl_driver is indirect threaded like
+   the byte-code interpreter: each command ends by fetching the next
+   one and jumping directly to its code with GCC's computed goto
+   extension, which is much easier on branch prediction than going
+   back to a single switch.  This is incompatible with CCL_DEBUG,
+   which records each command in the backtrace at the loop head.  */
+#if defined __GNUC__ && !defined __STRICT_ANSI__ && !defined CCL_DEBUG
+#define CCL_THREADED
+#endif
+
 #ifdef CCL_DEBUG
 #define CCL_DEBUG_BACKTRACE_LEN 256
 int ccl_backtrace_table[CCL_DEBUG_BACKTRACE_LEN];
@@ -899,6 +909,68 @@ ccl_driver (struct ccl_program *ccl, int *source, int *destination, int src_size
   ccl_backtrace_idx = 0;
 #endif
 
+#ifdef CCL_THREADED
+  /* CCL_CASE introduces the code of a command.  It is a case label,
+     and in the threaded driver also a label for the dispatch table.  */
+#define CCL_CASE(cmd) case cmd: insn_ ## cmd
+  /* CCL_NEXT ends the code of a command.  In the threaded driver it
+     checks for quit like the loop head does, and fetches and decodes
+     the next command without going back to the loop head.  */
+#define CCL_NEXT						\
+  do {								\
+    if (!NILP (Vquit_flag) && NILP (Vinhibit_quit))		\
+      goto ccl_repeat;						\
+    this_ic = ic;						\
+    GET_CCL_CODE (code, ccl_prog, ic++);			\
+    field1 = code >> 8;						\
+    field2 = (code & 0xFF) >> 5;				\
+    goto *ccl_dispatch[code & 0x1F];				\
+  } while (0)
+
+  /* The 5-bit command field indexes this table, which is completely
+     filled since every value is a valid command.  */
+  static const void *const ccl_dispatch[32] =
+    {
+#define CCL_INSN(cmd) [cmd] = &&insn_ ## cmd
+      CCL_INSN (CCL_SetRegister),
+      CCL_INSN (CCL_SetShortConst),
+      CCL_INSN (CCL_SetConst),
+      CCL_INSN (CCL_SetArray),
+      CCL_INSN (CCL_Jump),
+      CCL_INSN (CCL_JumpCond),
+      CCL_INSN (CCL_WriteRegisterJump),
+      CCL_INSN (CCL_WriteRegisterReadJump),
+      CCL_INSN (CCL_WriteConstJump),
+      CCL_INSN (CCL_WriteConstReadJump),
+      CCL_INSN (CCL_WriteStringJump),
+      CCL_INSN (CCL_WriteArrayReadJump),
+      CCL_INSN (CCL_ReadJump),
+      CCL_INSN (CCL_Branch),
+      CCL_INSN (CCL_ReadRegister),
+      CCL_INSN (CCL_WriteExprConst),
+      CCL_INSN (CCL_ReadBranch),
+      CCL_INSN (CCL_WriteRegister),
+      CCL_INSN (CCL_WriteExprRegister),
+      CCL_INSN (CCL_Call),
+      CCL_INSN (CCL_WriteConstString),
+      CCL_INSN (CCL_WriteArray),
+      CCL_INSN (CCL_End),
+      CCL_INSN (CCL_ExprSelfConst),
+      CCL_INSN (CCL_ExprSelfReg),
+      CCL_INSN (CCL_SetExprConst),
+      CCL_INSN (CCL_SetExprReg),
+      CCL_INSN (CCL_JumpCondExprConst),
+      CCL_INSN (CCL_JumpCondExprReg),
+      CCL_INSN (CCL_ReadJumpCondExprConst),
+      CCL_INSN (CCL_ReadJumpCondExprReg),
+      CCL_INSN (CCL_Extension),
+#undef CCL_INSN
+    };
+#else
+#define CCL_CASE(cmd) case cmd
+#define CCL_NEXT break
+#endif
+
   for (;;)
     {
     ccl_repeat:
@@ -933,70 +1005,70 @@ #define EXCMD (field1 >> 6)
 
       switch (code & 0x1F)
 	{
-	case CCL_SetRegister:	/* 00000000000000000RRRrrrXXXXX */
+	CCL_CASE (CCL_SetRegister):	/* 00000000000000000RRRrrrXXXXX */
 	  reg[rrr] = reg[RRR];
-	  break;
+	  CCL_NEXT;
 
-	case CCL_SetShortConst:	/* CCCCCCCCCCCCCCCCCCCCrrrXXXXX */
+	CCL_CASE (CCL_SetShortConst):	/* CCCCCCCCCCCCCCCCCCCCrrrXXXXX */
 	  reg[rrr] = field1;
-	  break;
+	  CCL_NEXT;
 
-	case CCL_SetConst:	/* 00000000000000000000rrrXXXXX */
+	CCL_CASE (CCL_SetConst):	/* 00000000000000000000rrrXXXXX */
 	  reg[rrr] = XFIXNUM (ccl_prog[ic++]);
-	  break;
+	  CCL_NEXT;
 
-	case CCL_SetArray:	/* CCCCCCCCCCCCCCCCCCCCRRRrrrXXXXX */
+	CCL_CASE (CCL_SetArray):	/* CCCCCCCCCCCCCCCCCCCCRRRrrrXXXXX */
 	  i = reg[RRR];
 	  j = field1 >> 3;
 	  if (0 <= i && i < j)
 	    reg[rrr] = XFIXNUM (ccl_prog[ic + i]);
 	  ic += j;
-	  break;
+	  CCL_NEXT;
 
-	case CCL_Jump:		/* A--D--D--R--E--S--S-000XXXXX */
+	CCL_CASE (CCL_Jump):		/* A--D--D--R--E--S--S-000XXXXX */
 	  ic += ADDR;
-	  break;
+	  CCL_NEXT;
 
-	case CCL_JumpCond:	/* A--D--D--R--E--S--S-rrrXXXXX */
+	CCL_CASE (CCL_JumpCond):	/* A--D--D--R--E--S--S-rrrXXXXX */
 	  if (!reg[rrr])
 	    ic += ADDR;
-	  break;
+	  CCL_NEXT;
 
-	case CCL_WriteRegisterJump: /* A--D--D--R--E--S--S-rrrXXXXX */
+	CCL_CASE (CCL_WriteRegisterJump): /* A--D--D--R--E--S--S-rrrXXXXX */
 	  i = reg[rrr];
 	  CCL_WRITE_CHAR (i);
 	  ic += ADDR;
-	  break;
+	  CCL_NEXT;
 
-	case CCL_WriteRegisterReadJump: /* A--D--D--R--E--S--S-rrrXXXXX */
+	CCL_CASE (CCL_WriteRegisterReadJump): /* A--D--D--R--E--S--S-rrrXXXXX */
 	  i = reg[rrr];
 	  CCL_WRITE_CHAR (i);
 	  ic++;
 	  CCL_READ_CHAR (reg[rrr]);
 	  ic += ADDR - 1;
-	  break;
+	  CCL_NEXT;
 
-	case CCL_WriteConstJump: /* A--D--D--R--E--S--S-000XXXXX */
+	CCL_CASE (CCL_WriteConstJump): /* A--D--D--R--E--S--S-000XXXXX */
 	  i = XFIXNUM (ccl_prog[ic]);
 	  CCL_WRITE_CHAR (i);
 	  ic += ADDR;
-	  break;
+	  CCL_NEXT;
 
-	case CCL_WriteConstReadJump: /* A--D--D--R--E--S--S-rrrXXXXX */
+	CCL_CASE (CCL_WriteConstReadJump): /* A--D--D--R--E--S--S-rrrXXXXX */
 	  i = XFIXNUM (ccl_prog[ic]);
 	  CCL_WRITE_CHAR (i);
 	  ic++;
 	  CCL_READ_CHAR (reg[rrr]);
 	  ic += ADDR - 1;
-	  break;
+	  CCL_NEXT;
 
-	case CCL_WriteStringJump: /* A--D--D--R--E--S--S-000XXXXX */
+	CCL_CASE (CCL_WriteStringJump): /* A--D--D--R--E--S--S-000XXXXX */
 	  j = XFIXNUM (ccl_prog[ic++]);
 	  CCL_WRITE_STRING (j);
 	  ic += ADDR - 1;
-	  break;
+	  CCL_NEXT;
 
-	case CCL_WriteArrayReadJump: /* A--D--D--R--E--S--S-rrrXXXXX */
+	CCL_CASE (CCL_WriteArrayReadJump): /* A--D--D--R--E--S--S-rrrXXXXX */
 	  i = reg[rrr];
 	  j = XFIXNUM (ccl_prog[ic]);
 	  if (0 <= i && i < j)
@@ -1007,25 +1079,25 @@ #define EXCMD (field1 >> 6)
 	  ic += j + 2;
 	  CCL_READ_CHAR (reg[rrr]);
 	  ic += ADDR - (j + 2);
-	  break;
+	  CCL_NEXT;
 
-	case CCL_ReadJump:	/* A--D--D--R--E--S--S-rrrYYYYY */
+	CCL_CASE (CCL_ReadJump):	/* A--D--D--R--E--S--S-rrrYYYYY */
 	  CCL_READ_CHAR (reg[rrr]);
 	  ic += ADDR;
-	  break;
+	  CCL_NEXT;
 
-	case CCL_ReadBranch:	/* CCCCCCCCCCCCCCCCCCCCrrrXXXXX */
+	CCL_CASE (CCL_ReadBranch):	/* CCCCCCCCCCCCCCCCCCCCrrrXXXXX */
 	  CCL_READ_CHAR (reg[rrr]);
 	  FALLTHROUGH;
-	case CCL_Branch:	/* CCCCCCCCCCCCCCCCCCCCrrrXXXXX */
+	CCL_CASE (CCL_Branch):	/* CCCCCCCCCCCCCCCCCCCCrrrXXXXX */
 	{
 	  int ioff = 0 <= reg[rrr] && reg[rrr] < field1 ? reg[rrr] : field1;
 	  int incr = XFIXNUM (ccl_prog[ic + ioff]);
 	  ic += incr;
 	}
-	  break;
+	  CCL_NEXT;
 
-	case CCL_ReadRegister:	/* CCCCCCCCCCCCCCCCCCCCrrXXXXX */
+	CCL_CASE (CCL_ReadRegister):	/* CCCCCCCCCCCCCCCCCCCCrrXXXXX */
 	  while (1)
 	    {
 	      CCL_READ_CHAR (reg[rrr]);
@@ -1034,9 +1106,9 @@ #define EXCMD (field1 >> 6)
 	      field1 = code >> 8;
 	      field2 = (code & 0xFF) >> 5;
 	    }
-	  break;
+	  CCL_NEXT;
 
-	case CCL_WriteExprConst:  /* 1:00000OPERATION000RRR000XXXXX */
+	CCL_CASE (CCL_WriteExprConst):  /* 1:00000OPERATION000RRR000XXXXX */
 	  rrr = 7;
 	  i = reg[RRR];
 	  j = XFIXNUM (ccl_prog[ic]);
@@ -1044,7 +1116,7 @@ #define EXCMD (field1 >> 6)
 	  jump_address = ic + 1;
 	  goto ccl_set_expr;
 
-	case CCL_WriteRegister:	/* CCCCCCCCCCCCCCCCCCCrrrXXXXX */
+	CCL_CASE (CCL_WriteRegister):	/* CCCCCCCCCCCCCCCCCCCrrrXXXXX */
 	  while (1)
 	    {
 	      i = reg[rrr];
@@ -1054,9 +1126,9 @@ #define EXCMD (field1 >> 6)
 	      field1 = code >> 8;
 	      field2 = (code & 0xFF) >> 5;
 	    }
-	  break;
+	  CCL_NEXT;
 
-	case CCL_WriteExprRegister: /* 1:00000OPERATIONRrrRRR000XXXXX */
+	CCL_CASE (CCL_WriteExprRegister): /* 1:00000OPERATIONRrrRRR000XXXXX */
 	  rrr = 7;
 	  i = reg[RRR];
 	  j = reg[Rrr];
@@ -1064,7 +1136,7 @@ #define EXCMD (field1 >> 6)
 	  jump_address = ic;
 	  goto ccl_set_expr;
 
-	case CCL_Call:		/* 1:CCCCCCCCCCCCCCCCCCCCFFFXXXXX */
+	CCL_CASE (CCL_Call):		/* 1:CCCCCCCCCCCCCCCCCCCCFFFXXXXX */
 	  {
 	    Lisp_Object slot;
 	    int prog_id;
@@ -1099,9 +1171,9 @@ #define EXCMD (field1 >> 6)
 	    ic = CCL_HEADER_MAIN;
 	    eof_ic = XFIXNAT (ccl_prog[CCL_HEADER_EOF]);
 	  }
-	  break;
+	  CCL_NEXT;
 
-	case CCL_WriteConstString: /* CCCCCCCCCCCCCCCCCCCCrrrXXXXX */
+	CCL_CASE (CCL_WriteConstString): /* CCCCCCCCCCCCCCCCCCCCrrrXXXXX */
 	  if (!rrr)
 	    CCL_WRITE_CHAR (field1);
 	  else
@@ -1109,9 +1181,9 @@ #define EXCMD (field1 >> 6)
 	      CCL_WRITE_STRING (field1);
 	      ic += (field1 + 2) / 3;
 	    }
-	  break;
+	  CCL_NEXT;
 
-	case CCL_WriteArray:	/* CCCCCCCCCCCCCCCCCCCCrrrXXXXX */
+	CCL_CASE (CCL_WriteArray):	/* CCCCCCCCCCCCCCCCCCCCrrrXXXXX */
 	  i = reg[rrr];
 	  if (0 <= i && i < field1)
 	    {
@@ -1119,9 +1191,9 @@ #define EXCMD (field1 >> 6)
 	      CCL_WRITE_CHAR (j);
 	    }
 	  ic += field1;
-	  break;
+	  CCL_NEXT;
 
-	case CCL_End:		/* 0000000000000000000000XXXXX */
+	CCL_CASE (CCL_End):		/* 0000000000000000000000XXXXX */
 	  if (stack_idx > 0)
 	    {
 	      stack_idx--;
@@ -1130,7 +1202,7 @@ #define EXCMD (field1 >> 6)
 	      eof_ic = ccl_prog_stack_struct[stack_idx].eof_ic;
 	      if (eof_hit)
 		ic = eof_ic;
-	      break;
+	      CCL_NEXT;
 	    }
 	  if (src)
 	    src = src_end;
@@ -1139,12 +1211,12 @@ #define EXCMD (field1 >> 6)
 	  ic--;
 	  CCL_SUCCESS;
 
-	case CCL_ExprSelfConst: /* 00000OPERATION000000rrrXXXXX */
+	CCL_CASE (CCL_ExprSelfConst): /* 00000OPERATION000000rrrXXXXX */
 	  i = XFIXNUM (ccl_prog[ic++]);
 	  op = field1 >> 6;
 	  goto ccl_expr_self;
 
-	case CCL_ExprSelfReg:	/* 00000OPERATION000RRRrrrXXXXX */
+	CCL_CASE (CCL_ExprSelfReg):	/* 00000OPERATION000RRRrrrXXXXX */
 	  i = reg[RRR];
 	  op = field1 >> 6;
 
@@ -1205,26 +1277,26 @@ #define EXCMD (field1 >> 6)
 	    case CCL_NE: reg[rrr] = reg[rrr] != i; break;
 	    default: CCL_INVALID_CMD;
 	    }
-	  break;
+	  CCL_NEXT;
 
-	case CCL_SetExprConst:	/* 00000OPERATION000RRRrrrXXXXX */
+	CCL_CASE (CCL_SetExprConst):	/* 00000OPERATION000RRRrrrXXXXX */
 	  i = reg[RRR];
 	  j = XFIXNUM (ccl_prog[ic++]);
 	  op = field1 >> 6;
 	  jump_address = ic;
 	  goto ccl_set_expr;
 
-	case CCL_SetExprReg:	/* 00000OPERATIONRrrRRRrrrXXXXX */
+	CCL_CASE (CCL_SetExprReg):	/* 00000OPERATIONRrrRRRrrrXXXXX */
 	  i = reg[RRR];
 	  j = reg[Rrr];
 	  op = field1 >> 6;
 	  jump_address = ic;
 	  goto ccl_set_expr;
 
-	case CCL_ReadJumpCondExprConst: /* A--D--D--R--E--S--S-rrrXXXXX */
+	CCL_CASE (CCL_ReadJumpCondExprConst): /* A--D--D--R--E--S--S-rrrXXXXX */
 	  CCL_READ_CHAR (reg[rrr]);
 	  FALLTHROUGH;
-	case CCL_JumpCondExprConst: /* A--D--D--R--E--S--S-rrrXXXXX */
+	CCL_CASE (CCL_JumpCondExprConst): /* A--D--D--R--E--S--S-rrrXXXXX */
 	  i = reg[rrr];
 	  jump_address = ic + ADDR;
 	  op = XFIXNUM (ccl_prog[ic++]);
@@ -1232,10 +1304,10 @@ #define EXCMD (field1 >> 6)
 	  rrr = 7;
 	  goto ccl_set_expr;
 
-	case CCL_ReadJumpCondExprReg: /* A--D--D--R--E--S--S-rrrXXXXX */
+	CCL_CASE (CCL_ReadJumpCondExprReg): /* A--D--D--R--E--S--S-rrrXXXXX */
 	  CCL_READ_CHAR (reg[rrr]);
 	  FALLTHROUGH;
-	case CCL_JumpCondExprReg:
+	CCL_CASE (CCL_JumpCondExprReg):
 	  i = reg[rrr];
 	  jump_address = ic + ADDR;
 	  op = XFIXNUM (ccl_prog[ic++]);
@@ -1325,9 +1397,9 @@ #define EXCMD (field1 >> 6)
 	    }
 	  else if (!reg[rrr])
 	    ic = jump_address;
-	  break;
+	  CCL_NEXT;
 
-	case CCL_Extension:
+	CCL_CASE (CCL_Extension):
 	  switch (EXCMD)
 	    {
 	    case CCL_ReadMultibyteChar2:
@@ -1777,7 +1849,7 @@ #define EXCMD (field1 >> 6)
 	    default:
 	      CCL_INVALID_CMD;
 	    }
-	  break;
+	  CCL_NEXT;
 
 	default:
 	  CCL_INVALID_CMD;
@@ -493,6 +493,29 @@ DEFUN ("string-width", Fstring_width, Sstring_width, 1, 3, 0,
   return val;
 }
 
+/* Return the number of bytes at the start of the NBYTES bytes at PTR
+   that are ASCII.  This looks at 32 bytes at a time, so it is much
+   faster than looking at each byte when the text is mostly ASCII.  */
+
+ptrdiff_t
+ascii_prefix_length (const unsigned char *ptr, ptrdiff_t nbytes)
+{
+  const unsigned char *p = ptr, *endp = ptr + nbytes;
+  uint_least64_t const high_bits = 0x8080808080808080;
+
+  while (endp - p >= 32)
+    {
+      uint_least64_t w[4];
+      memcpy (w, p, sizeof w);
+      if ((w[0] | w[1] | w[2] | w[3]) & high_bits)
+	break;
+      p += sizeof w;
+    }
+  while (p < endp && ASCII_CHAR_P (*p))
+    p++;
+  return p - ptr;
+}
+
 /* Return the number of characters in the NBYTES bytes at PTR.
    This works by looking at the contents and checking for multibyte
    sequences while assuming that there's no invalid sequence.
@@ -523,6 +546,14 @@ multibyte_chars_in_text (const unsigned char *ptr, ptrdiff_t nbytes)
 
   while (ptr < endp)
     {
+      if (ASCII_CHAR_P (*ptr))
+	{
+	  ptrdiff_t run = ascii_prefix_length (ptr, endp - ptr);
+	  ptr += run;
+	  chars += run;
+	  continue;
+	}
+
       int len = multibyte_length (ptr, endp, true, true);
 
       if (len == 0)
@@ -552,6 +583,12 @@ parse_str_as_multibyte (const unsigned char *str, ptrdiff_t len,
       const unsigned char *adjusted_endp = endp - (MAX_MULTIBYTE_LENGTH - 1);
       while (str < adjusted_endp)
 	{
+	  if (ASCII_CHAR_P (*str))
+	    {
+	      ptrdiff_t run = ascii_prefix_length (str, adjusted_endp - str);
+	      str += run, bytes += run, chars += run;
+	      continue;
+	    }
 	  int n = multibyte_length (str, NULL, false, false);
 	  if (0 < n)
 	    str += n, bytes += n;
@@ -596,6 +633,12 @@ str_as_multibyte (unsigned char *str, ptrdiff_t len, ptrdiff_t nbytes,
       unsigned char *adjusted_endp = endp - (MAX_MULTIBYTE_LENGTH - 1);
       while (p < adjusted_endp)
 	{
+	  if (ASCII_CHAR_P (*p))
+	    {
+	      ptrdiff_t run = ascii_prefix_length (p, adjusted_endp - p);
+	      p += run, chars += run;
+	      continue;
+	    }
 	  int n = multibyte_length (p, NULL, false, false);
 	  if (n <= 0)
 	    break;
@@ -625,6 +668,13 @@ str_as_multibyte (unsigned char *str, ptrdiff_t len, ptrdiff_t nbytes,
       unsigned char *adjusted_endp = endp - (MAX_MULTIBYTE_LENGTH - 1);
       while (p < adjusted_endp)
 	{
+	  if (ASCII_CHAR_P (*p))
+	    {
+	      ptrdiff_t run = ascii_prefix_length (p, adjusted_endp - p);
+	      memmove (to, p, run);
+	      to += run, p += run, chars += run;
+	      continue;
+	    }
 	  int n = multibyte_length (p, NULL, false, false);
 	  if (0 < n)
 	    {
@@ -637,8 +687,8 @@ str_as_multibyte (unsigned char *str, ptrdiff_t len, ptrdiff_t nbytes,
 	      c = BYTE8_TO_CHAR (c);
 	      to += CHAR_STRING (c, to);
 	    }
+	  chars++;
 	}
-      chars++;
     }
   while (p < endp)
     {
@@ -692,7 +742,12 @@ str_to_multibyte (unsigned char *dst, const unsigned char *src,
     {
       unsigned char c = src[i];
       if (c <= 0x7f)
-	*d++ = c;
+	{
+	  ptrdiff_t run = ascii_prefix_length (src + i, nchars - i);
+	  memcpy (d, src + i, run);
+	  d += run;
+	  i += run - 1;
+	}
       else
 	{
 	  *d++ = 0xc0 + ((c >> 6) & 1);
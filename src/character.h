@@ -563,6 +563,7 @@ char_surrogate_p (int c)
 extern EMACS_INT char_resolve_modifier_mask (EMACS_INT) ATTRIBUTE_CONST;
 
 extern int translate_char (Lisp_Object, int c);
+extern ptrdiff_t ascii_prefix_length (const unsigned char *, ptrdiff_t);
 extern ptrdiff_t count_size_as_multibyte (const unsigned char *, ptrdiff_t);
 extern ptrdiff_t str_as_multibyte (unsigned char *, ptrdiff_t, ptrdiff_t,
 				   ptrdiff_t *);
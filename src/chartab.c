@@ -61,6 +61,7 @@ #define CHARTAB_IDX(c, depth, min_char)		\
 typedef Lisp_Object (*uniprop_encoder_t) (Lisp_Object, Lisp_Object);
 
 static Lisp_Object uniprop_table_uncompress (Lisp_Object, int);
+static Lisp_Object char_table_ref_1 (Lisp_Object, int);
 static uniprop_decoder_t uniprop_get_decoder (Lisp_Object);
 static Lisp_Object
 sub_char_table_ref_and_range (Lisp_Object, int, int *, int *,
@@ -83,6 +84,43 @@ #define UNIPROP_COMPRESSED_FORM_P(OBJ)	\
   (STRINGP (OBJ) && SCHARS (OBJ) > 0	\
    && ((SREF (OBJ, 0) == 1 || (SREF (OBJ, 0) == 2))))
 
+EMACS_UINT char_table_modiff;
+
+/* Flattened copies of the values of the characters in the BMP (the
+   first CHARTAB_FLAT_CHARS characters) in char-tables that are read
+   often, so that looking one up costs a single memory access instead
+   of descending the sub-char-tables and following the parent chain.
+
+   A table is flattened once CHARTAB_FLAT_THRESHOLD lookups of non-ASCII
+   characters in it have missed the flat copies; the candidates for
+   flattening are counted in a small direct-mapped array.  A flattened
+   table and all its parents must not change as long as its copy
+   exists; note_char_table_change discards the copies of tables that
+   inherit from a table that changes.  The copies don't need to be
+   marked by GC, since each value is also in the table or one of its
+   parents, which are protected by char_table_flat[I].table.  */
+
+enum { CHARTAB_FLAT_CHARS = 1 << 16,
+       CHARTAB_FLAT_TABLES = 4,
+       CHARTAB_FLAT_CANDIDATES = 16,
+       CHARTAB_FLAT_THRESHOLD = 1 << 12 };
+
+static struct
+{
+  Lisp_Object table;
+  Lisp_Object *values;
+} char_table_flat[CHARTAB_FLAT_TABLES];
+
+static struct
+{
+  struct Lisp_Char_Table *table;
+  int lookups;
+} char_table_flat_candidates[CHARTAB_FLAT_CANDIDATES];
+
+/* The number of flattened tables, and the slot to use next.  */
+int char_table_flat_used;
+static int char_table_flat_next;
+
 static void
 CHECK_CHAR_TABLE (Lisp_Object x)
 {
@@ -97,6 +135,7 @@ set_char_table_ascii (Lisp_Object table, Lisp_Object val)
 static void
 set_char_table_parent (Lisp_Object table, Lisp_Object val)
 {
+  note_char_table_change (table);
   XCHAR_TABLE (table)->parent = val;
 }
 
@@ -221,8 +260,91 @@ sub_char_table_ref (Lisp_Object table, int c, bool is_uniprop)
   return val;
 }
 
+/* Discard the flattened copy in slot I of char_table_flat.  */
+
+static void
+char_table_flat_discard (int i)
+{
+  xfree (char_table_flat[i].values);
+  char_table_flat[i].values = NULL;
+  char_table_flat[i].table = Qnil;
+  char_table_flat_used--;
+}
+
+/* Discard the flattened copies of TABLE and of the tables inheriting
+   from it, because lookups in TABLE might give different results
+   now.  */
+
+void
+char_table_flat_invalidate (Lisp_Object table)
+{
+  for (int i = 0; i < CHARTAB_FLAT_TABLES; i++)
+    if (char_table_flat[i].values)
+      for (Lisp_Object t = char_table_flat[i].table; CHAR_TABLE_P (t);
+	   t = XCHAR_TABLE (t)->parent)
+	if (EQ (t, table))
+	  {
+	    char_table_flat_discard (i);
+	    break;
+	  }
+}
+
+/* Make a flattened copy of TABLE, unless it or its parents are
+   uniprop tables, whose values are decoded lazily.  */
+
+static void
+char_table_flatten (Lisp_Object table)
+{
+  for (Lisp_Object t = table; CHAR_TABLE_P (t); t = XCHAR_TABLE (t)->parent)
+    if (UNIPROP_TABLE_P (t))
+      return;
+
+  int i = char_table_flat_next;
+  char_table_flat_next = (i + 1) % CHARTAB_FLAT_TABLES;
+  if (char_table_flat[i].values)
+    char_table_flat_discard (i);
+  Lisp_Object *values = xmalloc (CHARTAB_FLAT_CHARS * sizeof *values);
+  for (int c = 0; c < CHARTAB_FLAT_CHARS; c++)
+    values[c] = char_table_ref_1 (table, c);
+  char_table_flat[i].table = table;
+  char_table_flat[i].values = values;
+  char_table_flat_used++;
+}
+
+/* Return the value for character C in char-table TABLE.  */
+
 Lisp_Object
 char_table_ref (Lisp_Object table, int c)
+{
+  if (c < CHARTAB_FLAT_CHARS && !ASCII_CHAR_P (c))
+    {
+      if (char_table_flat_used)
+	for (int i = 0; i < CHARTAB_FLAT_TABLES; i++)
+	  if (EQ (char_table_flat[i].table, table)
+	      && char_table_flat[i].values)
+	    return char_table_flat[i].values[c];
+
+      struct Lisp_Char_Table *tbl = XCHAR_TABLE (table);
+      int i = ((uintptr_t) tbl >> 3) % CHARTAB_FLAT_CANDIDATES;
+      if (char_table_flat_candidates[i].table != tbl)
+	{
+	  char_table_flat_candidates[i].table = tbl;
+	  char_table_flat_candidates[i].lookups = 0;
+	}
+      else if (++char_table_flat_candidates[i].lookups
+	       == CHARTAB_FLAT_THRESHOLD)
+	{
+	  char_table_flat_candidates[i].table = NULL;
+	  char_table_flatten (table);
+	}
+    }
+  return char_table_ref_1 (table, c);
+}
+
+/* Like char_table_ref, but don't use or make flattened copies.  */
+
+static Lisp_Object
+char_table_ref_1 (Lisp_Object table, int c)
 {
   struct Lisp_Char_Table *tbl = XCHAR_TABLE (table);
   Lisp_Object val;
@@ -243,7 +365,7 @@ char_table_ref (Lisp_Object table, int c)
     {
       val = tbl->defalt;
       if (NILP (val) && CHAR_TABLE_P (tbl->parent))
-	val = char_table_ref (tbl->parent, c);
+	val = char_table_ref_1 (tbl->parent, c);
     }
   return val;
 }
@@ -400,6 +522,8 @@ char_table_set (Lisp_Object table, int c, Lisp_Object val)
 {
   struct Lisp_Char_Table *tbl = XCHAR_TABLE (table);
 
+  note_char_table_change (table);
+
   if (ASCII_CHAR_P (c)
       && SUB_CHAR_TABLE_P (tbl->ascii))
     set_sub_char_table_contents (tbl->ascii, c, val);
@@ -463,6 +587,8 @@ char_table_set_range (Lisp_Object table, int from, int to, Lisp_Object val)
 {
   struct Lisp_Char_Table *tbl = XCHAR_TABLE (table);
 
+  note_char_table_change (table);
+
   if (from == to)
     char_table_set (table, from, val);
   else
@@ -1351,6 +1477,9 @@ syms_of_chartab (void)
   /* Purpose of uniprop tables. */
   DEFSYM (Qchar_code_property_table, "char-code-property-table");
 
+  for (int i = 0; i < CHARTAB_FLAT_TABLES; i++)
+    staticpro (&char_table_flat[i].table);
+
   defsubr (&Smake_char_table);
   defsubr (&Schar_table_parent);
   defsubr (&Schar_table_subtype);
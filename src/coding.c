@@ -285,6 +285,9 @@ encode_coding_XXX (struct coding_system *coding)
 
 #include <config.h>
 
+#include <nproc.h>
+#include <signal.h>
+
 #ifdef HAVE_WCHAR_H
 #include <wchar.h>
 #endif /* HAVE_WCHAR_H */
@@ -1125,6 +1128,48 @@ #define UTF_8_BOM_1 0xEF
 #define UTF_8_BOM_2 0xBB
 #define UTF_8_BOM_3 0xBF
 
+/* Return the number of bytes at the start of the N bytes at P that
+   are ASCII other than CR, looking at 32 bytes at a time.  If
+   EOL_SEEN is non-null, add EOL_SEEN_LF to *EOL_SEEN if those bytes
+   contain an LF.  */
+
+static ptrdiff_t
+ascii_run_length (const unsigned char *p, ptrdiff_t n, int *eol_seen)
+{
+  const unsigned char *q = p, *end = p + n;
+  uint_least64_t const ones = 0x0101010101010101;
+  uint_least64_t const high_bits = ones << 7;
+  uint_least64_t lf = 0;
+
+  /* A word W has a byte equal to B if and only if W ^ (ONES * B) has
+     a zero byte, and a word V has a zero byte if and only if
+     (V - ONES) & ~V & HIGH_BITS is nonzero.  */
+#define HAS_BYTE(w, b) \
+  ((((w) ^ (ones * (b))) - ones) & ~((w) ^ (ones * (b))) & high_bits)
+
+  while (end - q >= 32)
+    {
+      uint_least64_t w[4], stop = 0, block_lf = 0;
+      memcpy (w, q, sizeof w);
+      for (int i = 0; i < 4; i++)
+	{
+	  stop |= (w[i] & high_bits) | HAS_BYTE (w[i], '\r');
+	  block_lf |= HAS_BYTE (w[i], '\n');
+	}
+      if (stop)
+	break;
+      lf |= block_lf;
+      q += sizeof w;
+    }
+#undef HAS_BYTE
+
+  for (; q < end && UTF_8_1_OCTET_P (*q) && *q != '\r'; q++)
+    lf |= *q == '\n';
+  if (eol_seen && lf)
+    *eol_seen |= EOL_SEEN_LF;
+  return q - p;
+}
+
 /* Unlike the other detect_coding_XXX, this function counts the number
    of characters and checks the EOL format.  */
 
@@ -1157,7 +1202,10 @@ detect_coding_utf_8 (struct coding_system *coding,
   while (1)
     {
       int c, c1, c2, c3, c4;
+      ptrdiff_t run = ascii_prefix_length (src, src_end - src);
 
+      src += run;
+      nchars += run;
       src_base = src;
       ONE_MORE_BYTE (c);
       if (c < 0 || UTF_8_1_OCTET_P (c))
@@ -1298,40 +1346,18 @@ decode_coding_utf_8 (struct coding_system *coding)
 	  break;
 	}
 
-      /* In the simple case, rapidly handle ordinary characters */
-      if (multibytep && ! eol_dos
-	  && charbuf < charbuf_end - 6 && src < src_end - 6)
+      /* In the simple case, rapidly handle ordinary characters.  */
+      if (byte_after_cr < 0)
 	{
-	  while (charbuf < charbuf_end - 6 && src < src_end - 6)
-	    {
-	      c1 = *src;
-	      if (c1 & 0x80)
-		break;
-	      src++;
-	      consumed_chars++;
-	      *charbuf++ = c1;
-
-	      c1 = *src;
-	      if (c1 & 0x80)
-		break;
-	      src++;
-	      consumed_chars++;
-	      *charbuf++ = c1;
-
-	      c1 = *src;
-	      if (c1 & 0x80)
-		break;
-	      src++;
-	      consumed_chars++;
-	      *charbuf++ = c1;
-
-	      c1 = *src;
-	      if (c1 & 0x80)
-		break;
-	      src++;
-	      consumed_chars++;
-	      *charbuf++ = c1;
-	    }
+	  ptrdiff_t run = min (charbuf_end - charbuf, src_end - src);
+	  run = (eol_dos
+		 ? ascii_run_length (src, run, NULL)
+		 : ascii_prefix_length (src, run));
+	  for (ptrdiff_t i = 0; i < run; i++)
+	    charbuf[i] = src[i];
+	  charbuf += run;
+	  src += run;
+	  consumed_chars += run;
 	  /* If we handled at least one character, restart the main loop.  */
 	  if (src != src_base)
 	    continue;
@@ -6180,10 +6206,12 @@ check_ascii (struct coding_system *coding)
       || SYMBOLP (eol_type))
     {
       /* We don't have to check EOL format.  */
-      while (src < end && !( *src & 0x80))
+      while (src < end)
 	{
-	  if (*src++ == '\n')
-	    eol_seen |= EOL_SEEN_LF;
+	  src += ascii_run_length (src, end - src, &eol_seen);
+	  if (src == end || (*src & 0x80))
+	    break;
+	  src++;		/* Skip a CR.  */
 	}
     }
   else
@@ -6191,23 +6219,18 @@ check_ascii (struct coding_system *coding)
       end--;		    /* We look ahead one byte for "CR LF".  */
       while (src < end)
 	{
-	  int c = *src;
-
-	  if (c & 0x80)
+	  src += ascii_run_length (src, end - src, &eol_seen);
+	  if (src == end || (*src & 0x80))
 	    break;
+	  /* Here *SRC is a CR.  */
 	  src++;
-	  if (c == '\r')
+	  if (*src == '\n')
 	    {
-	      if (*src == '\n')
-		{
-		  eol_seen |= EOL_SEEN_CRLF;
-		  src++;
-		}
-	      else
-		eol_seen |= EOL_SEEN_CR;
+	      eol_seen |= EOL_SEEN_CRLF;
+	      src++;
 	    }
-	  else if (c == '\n')
-	    eol_seen |= EOL_SEEN_LF;
+	  else
+	    eol_seen |= EOL_SEEN_CR;
 	}
       if (src == end)
 	{
@@ -6230,63 +6253,51 @@ check_ascii (struct coding_system *coding)
 }
 
 
-/* Return the number of characters at the source if all the bytes are
-   valid UTF-8 (of Unicode range).  Otherwise, return -1.  By side
-   effects, update coding->eol_seen.  The value of coding->eol_seen is
-   "logical or" of EOL_SEEN_LF, EOL_SEEN_CR, and EOL_SEEN_CRLF, but
-   the value is reliable only when all the source bytes are valid
-   UTF-8.  */
+/* Return the number of characters from SRC to END if all those bytes
+   are valid UTF-8 (of Unicode range).  Otherwise, return -1.  Add the
+   EOL_SEEN_* values of the end-of-line sequences in the text to
+   *EOL_SEEN.  */
 
 static ptrdiff_t
-check_utf_8 (struct coding_system *coding)
+utf_8_text_chars (const unsigned char *src, const unsigned char *end,
+		  int *eol_seen)
 {
-  const unsigned char *src, *end;
-  int eol_seen;
-  ptrdiff_t nchars = coding->head_ascii;
+  ptrdiff_t nchars = 0;
 
-  if (coding->head_ascii < 0)
-    check_ascii (coding);
-  else
-    coding_set_source (coding);
-  src = coding->source + coding->head_ascii;
-  /* We look ahead one byte for CR LF.  */
-  end = coding->source + coding->src_bytes - 1;
-  eol_seen = coding->eol_seen;
   while (src < end)
     {
       int c = *src;
 
-      if (UTF_8_1_OCTET_P (*src))
+      if (UTF_8_1_OCTET_P (c) && c != '\r')
+	{
+	  ptrdiff_t run = ascii_run_length (src, end - src, eol_seen);
+	  src += run;
+	  nchars += run;
+	  continue;
+	}
+      if (c == '\r')
 	{
 	  src++;
-	  if (c < 0x20)
+	  if (src < end && *src == '\n')
 	    {
-	      if (c == '\r')
-		{
-		  if (*src == '\n')
-		    {
-		      eol_seen |= EOL_SEEN_CRLF;
-		      src++;
-		      nchars++;
-		    }
-		  else
-		    eol_seen |= EOL_SEEN_CR;
-		}
-	      else if (c == '\n')
-		eol_seen |= EOL_SEEN_LF;
+	      *eol_seen |= EOL_SEEN_CRLF;
+	      src++;
+	      nchars++;
 	    }
+	  else
+	    *eol_seen |= EOL_SEEN_CR;
 	}
       else if (UTF_8_2_OCTET_LEADING_P (c))
 	{
 	  if (c < 0xC2		/* overlong sequence */
-	      || src + 1 >= end
+	      || end - src < 2
 	      || ! UTF_8_EXTRA_OCTET_P (src[1]))
 	    return -1;
 	  src += 2;
 	}
       else if (UTF_8_3_OCTET_LEADING_P (c))
 	{
-	  if (src + 2 >= end
+	  if (end - src < 3
 	      || ! (UTF_8_EXTRA_OCTET_P (src[1])
 		    && UTF_8_EXTRA_OCTET_P (src[2])))
 	    return -1;
@@ -6299,7 +6310,7 @@ check_utf_8 (struct coding_system *coding)
 	}
       else if (UTF_8_4_OCTET_LEADING_P (c))
 	{
-	  if (src + 3 >= end
+	  if (end - src < 4
 	      || ! (UTF_8_EXTRA_OCTET_P (src[1])
 		    && UTF_8_EXTRA_OCTET_P (src[2])
 		    && UTF_8_EXTRA_OCTET_P (src[3])))
@@ -6315,17 +6326,202 @@ check_utf_8 (struct coding_system *coding)
 	return -1;
       nchars++;
     }
+  return nchars;
+}
+
+/* Return the number of characters at the source if all the bytes are
+   valid UTF-8 (of Unicode range).  Otherwise, return -1.  By side
+   effects, update coding->eol_seen.  The value of coding->eol_seen is
+   "logical or" of EOL_SEEN_LF, EOL_SEEN_CR, and EOL_SEEN_CRLF, but
+   the value is reliable only when all the source bytes are valid
+   UTF-8.  */
+
+static ptrdiff_t
+check_utf_8 (struct coding_system *coding)
+{
+  int eol_seen;
+  ptrdiff_t nchars;
+
+  if (coding->head_ascii < 0)
+    check_ascii (coding);
+  else
+    coding_set_source (coding);
+  eol_seen = coding->eol_seen;
+  nchars = utf_8_text_chars (coding->source + coding->head_ascii,
+			     coding->source + coding->src_bytes, &eol_seen);
+  if (nchars < 0)
+    return -1;
+  coding->eol_seen = eol_seen;
+  return coding->head_ascii + nchars;
+}
+
+/* Checking large texts with several threads.  */
+
+/* A part of a text to check with utf_8_text_chars, and the results:
+   the number of characters in it or -1, the number of ASCII bytes at
+   its start, and the EOL_SEEN_* values of its end-of-line
+   sequences.  */
+struct utf_8_chunk
+{
+  const unsigned char *start, *end;
+  ptrdiff_t nchars, head_ascii;
+  int eol_seen;
+};
+
+/* The maximum number of threads that check a text, and the minimum
+   number of bytes each of them checks.  */
+enum { MAX_CHECK_THREADS = 16, MIN_CHECK_CHUNK = 1024 * 1024 };
+
+/* The chunks being checked, the index of the next one that no thread
+   has taken yet, and the number of chunks that have been checked.
+   These are protected by CHECK_MUTEX, and CHECK_COND is signaled when
+   there are new chunks to check and when the last one is done.  */
+static struct utf_8_chunk *check_chunks;
+static int check_chunk_count, check_chunk_next, check_chunks_done;
+static sys_mutex_t check_mutex;
+static sys_cond_t check_cond;
+
+/* The number of threads started to check chunks.  */
+static int check_threads;
+
+static void
+check_utf_8_chunk (struct utf_8_chunk *chunk)
+{
+  chunk->eol_seen = EOL_SEEN_NONE;
+  chunk->head_ascii = ascii_prefix_length (chunk->start,
+					   chunk->end - chunk->start);
+  chunk->nchars = utf_8_text_chars (chunk->start, chunk->end,
+				    &chunk->eol_seen);
+}
+
+/* Check the chunks that no other thread has taken.  CHECK_MUTEX must
+   be locked on entry, and is locked on return.  */
+
+static void
+check_remaining_chunks (void)
+{
+  while (check_chunk_next < check_chunk_count)
+    {
+      struct utf_8_chunk *chunk = &check_chunks[check_chunk_next++];
+      sys_mutex_unlock (&check_mutex);
+      check_utf_8_chunk (chunk);
+      sys_mutex_lock (&check_mutex);
+      if (++check_chunks_done == check_chunk_count)
+	sys_cond_broadcast (&check_cond);
+    }
+}
 
-  if (src == end)
+static void *
+check_thread (void *arg)
+{
+#ifdef HAVE_PTHREAD
+  /* Leave signal handling to the main thread.  */
+  sigset_t blocked;
+  sigfillset (&blocked);
+  pthread_sigmask (SIG_BLOCK, &blocked, NULL);
+#endif
+  sys_thread_set_name ("UTF-8 checker");
+
+  sys_mutex_lock (&check_mutex);
+  for (;;)
+    {
+      while (check_chunk_next >= check_chunk_count)
+	sys_cond_wait (&check_cond, &check_mutex);
+      check_remaining_chunks ();
+    }
+  return NULL;
+}
+
+/* If the source text of CODING is large enough according to
+   'coding-parallel-decoding-threshold', check with several threads
+   whether it is valid UTF-8.  If it is, set coding->head_ascii and
+   coding->eol_seen as check_ascii and check_utf_8 would, and return
+   the number of characters.  Otherwise, return -1 and leave CODING
+   alone.  */
+
+static ptrdiff_t
+check_utf_8_in_parallel (struct coding_system *coding)
+{
+  ptrdiff_t bytes = coding->src_bytes;
+
+  if (! FIXNATP (Vcoding_parallel_decoding_threshold)
+      || bytes < XFIXNAT (Vcoding_parallel_decoding_threshold))
+    return -1;
+  int nchunks = min (num_processors (NPROC_CURRENT_OVERRIDABLE),
+		     min (MAX_CHECK_THREADS, bytes / MIN_CHECK_CHUNK));
+  if (nchunks < 2)
+    return -1;
+
+  /* Start the threads that are missing.  The calling thread checks a
+     chunk too, and takes over those of threads that couldn't be
+     started.  */
+  static bool check_initialized, check_thread_failed;
+  if (! check_initialized)
+    {
+      sys_mutex_init (&check_mutex);
+      sys_cond_init (&check_cond);
+      check_initialized = true;
+    }
+  while (check_threads < nchunks - 1 && ! check_thread_failed)
+    {
+      sys_thread_t thr;
+      if (sys_thread_create (&thr, check_thread, NULL))
+	check_threads++;
+      else
+	check_thread_failed = true;
+    }
+
+  /* Split the text at the starts of characters, and not between a CR
+     and an LF.  */
+  struct utf_8_chunk chunks[MAX_CHECK_THREADS];
+  coding_set_source (coding);
+  const unsigned char *source = coding->source, *end = source + bytes;
+  const unsigned char *p = source;
+  for (int i = 0; i < nchunks; i++)
+    {
+      const unsigned char *q = end;
+      if (i < nchunks - 1)
+	{
+	  q = source + bytes / nchunks * (i + 1);
+	  for (int j = 1; j < MAX_MULTIBYTE_LENGTH && UTF_8_EXTRA_OCTET_P (*q);
+	       j++)
+	    q++;
+	  if (q[-1] == '\r' && *q == '\n')
+	    q++;
+	}
+      chunks[i].start = p;
+      chunks[i].end = q;
+      p = q;
+    }
+
+  sys_mutex_lock (&check_mutex);
+  check_chunks = chunks;
+  check_chunk_count = nchunks;
+  check_chunk_next = check_chunks_done = 0;
+  sys_cond_broadcast (&check_cond);
+  check_remaining_chunks ();
+  while (check_chunks_done < nchunks)
+    sys_cond_wait (&check_cond, &check_mutex);
+  check_chunks = NULL;
+  check_chunk_count = check_chunk_next = 0;
+  sys_mutex_unlock (&check_mutex);
+
+  ptrdiff_t nchars = 0, head_ascii = 0;
+  int eol_seen = coding->eol_seen;
+  bool in_head = true;
+  for (int i = 0; i < nchunks; i++)
     {
-      if (! UTF_8_1_OCTET_P (*src))
+      if (chunks[i].nchars < 0)
 	return -1;
-      nchars++;
-      if (*src == '\r')
-	eol_seen |= EOL_SEEN_CR;
-      else if (*src  == '\n')
-	eol_seen |= EOL_SEEN_LF;
+      nchars += chunks[i].nchars;
+      eol_seen |= chunks[i].eol_seen;
+      if (in_head)
+	{
+	  head_ascii += chunks[i].head_ascii;
+	  in_head = chunks[i].head_ascii == chunks[i].end - chunks[i].start;
+	}
     }
+  coding->head_ascii = head_ascii;
   coding->eol_seen = eol_seen;
   return nchars;
 }
@@ -7038,6 +7234,23 @@ produce_chars (struct coding_system *coding, Lisp_Object translation_table,
 	  int c = *buf;
 	  ptrdiff_t i;
 
+	  /* Copy a run of untranslated ASCII characters in one go,
+	     leaving as much room at DST_END as the code below.  */
+	  if (ASCII_CHAR_P (c) && NILP (translation_table))
+	    {
+	      ptrdiff_t n = min (buf_end - buf,
+				 dst_end - dst - (MAX_MULTIBYTE_LENGTH - 1));
+	      for (i = 0; i < n && ASCII_CHAR_P (buf[i]); i++)
+		dst[i] = buf[i];
+	      if (i > 0)
+		{
+		  dst += i;
+		  buf += i;
+		  produced_chars += i;
+		  continue;
+		}
+	    }
+
 	  if (c >= 0)
 	    {
 	      ptrdiff_t from_nchars = 1, to_nchars = 1;
@@ -7946,17 +8159,23 @@ decode_coding_gap (struct coding_system *coding, ptrdiff_t bytes)
       && NILP (CODING_ATTR_POST_READ (attrs))
       && NILP (get_translation_table (attrs, 0, NULL)))
     {
-      ptrdiff_t chars = coding->head_ascii;
+      ptrdiff_t chars = coding->head_ascii, utf_8_chars = -1;
       if (chars < 0)
-	chars = check_ascii (coding);
+	{
+	  utf_8_chars = check_utf_8_in_parallel (coding);
+	  chars = utf_8_chars < 0 ? check_ascii (coding) : coding->head_ascii;
+	}
       if (chars != bytes)
 	{
 	  /* There exists a non-ASCII byte.  */
 	  if (EQ (CODING_ATTR_TYPE (attrs), Qutf_8)
-	      && coding->detected_utf8_bytes == coding->src_bytes)
+	      && (coding->detected_utf8_bytes == coding->src_bytes
+		  || utf_8_chars >= 0))
 	    {
 	      if (coding->detected_utf8_chars >= 0)
 		chars = coding->detected_utf8_chars;
+	      else if (utf_8_chars >= 0)
+		chars = utf_8_chars;
 	      else
 		chars = check_utf_8 (coding);
 	      if (CODING_UTF_8_BOM (coding) != utf_without_bom
@@ -8044,6 +8263,46 @@ decode_coding_gap (struct coding_system *coding, ptrdiff_t bytes)
   unbind_to (count, Qnil);
 }
 
+/* Return true if decoding the BYTES bytes at SRC by CODING would
+   produce exactly the same bytes, so that the caller can insert them
+   as they are.  This is true when the text is pure ASCII without CR
+   characters, and CODING is an ASCII compatible coding system with a
+   known EOL type that doesn't post-process or translate what it
+   decodes.  Unlike decode_coding_gap, this never changes the state
+   of CODING, so it is safe to use for a chunk of a stream that is
+   decoded in several pieces.  */
+
+bool
+decode_coding_ascii_verbatim_p (struct coding_system *coding,
+				const unsigned char *src, ptrdiff_t bytes)
+{
+  if (disable_ascii_optimization
+      || coding->mode & CODING_MODE_SELECTIVE_DISPLAY)
+    return false;
+
+  /* Detection by an undecided coding system whose EOL type is known
+     finds nothing in ASCII text without NUL or ESC characters, and
+     leaves the coding system undecided, so it decodes such text
+     verbatim too.  This is the common case of reading the output of
+     a program with the default process coding system.  */
+  Lisp_Object attrs = CODING_ID_ATTRS (coding->id);
+  bool undecided = EQ (CODING_ATTR_TYPE (attrs), Qundecided);
+  if ((CODING_REQUIRE_DETECTION (coding) && !undecided)
+      || NILP (CODING_ATTR_ASCII_COMPAT (attrs))
+      || !NILP (CODING_ATTR_POST_READ (attrs))
+      || !NILP (get_translation_table (attrs, 0, NULL))
+      || !SYMBOLP (CODING_ID_EOL_TYPE (coding->id))
+      || (EQ (CODING_ATTR_TYPE (attrs), Qutf_8)
+	  && CODING_UTF_8_BOM (coding) != utf_without_bom))
+    return false;
+
+  for (ptrdiff_t i = 0; i < bytes; i++)
+    if (!ASCII_CHAR_P (src[i]) || src[i] == '\r'
+	|| (undecided && (src[i] == '\0' || src[i] == ISO_CODE_ESC)))
+      return false;
+  return true;
+}
+
 
 /* Decode the text in the range FROM/FROM_BYTE and TO/TO_BYTE in
    SRC_OBJECT into DST_OBJECT by coding context CODING.
@@ -12232,6 +12491,17 @@ system (e.g. `iso-2022-7bit').
 decode text as usual.  */);
   inhibit_null_byte_detection = 0;
 
+  DEFVAR_LISP ("coding-parallel-decoding-threshold",
+	       Vcoding_parallel_decoding_threshold,
+	       doc: /* Size from which text is checked with several threads when decoding.
+Before decoding text inserted from a file, Emacs checks whether the
+text is ASCII, or valid UTF-8 if the coding system is a UTF-8 one, in
+which case no conversion is needed.  If this variable is a number and
+the text has at least that many bytes, the check is split among
+several threads, up to one per processor.  If it is nil, the default,
+the check is done by a single thread.  */);
+  Vcoding_parallel_decoding_threshold = Qnil;
+
   DEFVAR_BOOL ("disable-ascii-optimization", disable_ascii_optimization,
 	       doc: /* If non-nil, Emacs does not optimize code decoder for ASCII files.
 Internal use only.  Remove after the experimental optimizer becomes stable.  */);
@@ -705,6 +705,8 @@ #define UTF_16_LOW_SURROGATE_P(val) \
 extern Lisp_Object make_string_from_utf8 (const char *, ptrdiff_t);
 
 extern void decode_coding_gap (struct coding_system *, ptrdiff_t);
+extern bool decode_coding_ascii_verbatim_p (struct coding_system *,
+					    const unsigned char *, ptrdiff_t);
 extern void decode_coding_object (struct coding_system *,
                                   Lisp_Object, ptrdiff_t, ptrdiff_t,
                                   ptrdiff_t, ptrdiff_t, Lisp_Object);
@@ -40,6 +40,12 @@
 #include "sysstdio.h"
 #include "zlib.h"
 
+#ifdef __GLIBC__
+# include <dlfcn.h>
+# include <link.h>
+# include <unistd.h>
+#endif
+
 
 /********************************/
 /* Dynamic loading of libgccjit */
@@ -725,8 +731,11 @@ comp_hash_string (Lisp_Object string)
   return Fsubstring (digest, Qnil, make_fixnum (HASH_LENGTH));
 }
 
+/* Return the first LENGTH hex digits of the hash of the contents of
+   the source file FILENAME.  */
+
 static Lisp_Object
-comp_hash_source_file (Lisp_Object filename)
+comp_hash_source_file (Lisp_Object filename, int length)
 {
   /* Can't use Finsert_file_contents + Fbuffer_hash as this is called
      by Fcomp_el_to_eln_filename too early during bootstrap.  */
@@ -759,7 +768,7 @@ comp_hash_source_file (Lisp_Object filename)
 
   hexbuf_digest (SSDATA (digest), SSDATA (digest), MD5_DIGEST_SIZE);
 
-  return Fsubstring (digest, Qnil, make_fixnum (HASH_LENGTH));
+  return Fsubstring (digest, Qnil, make_fixnum (length));
 }
 
 DEFUN ("comp--subr-signature", Fcomp__subr_signature,
@@ -4306,7 +4315,7 @@ DEFUN ("comp-el-to-eln-rel-filename", Fcomp_el_to_eln_rel_filename,
   filename = Fw32_long_file_name (filename);
 #endif
 
-  Lisp_Object content_hash = comp_hash_source_file (filename);
+  Lisp_Object content_hash = comp_hash_source_file (filename, HASH_LENGTH);
 
   if (suffix_p (filename, ".gz"))
     filename = Fsubstring (filename, Qnil, make_fixnum (-3));
@@ -4366,6 +4375,44 @@ DEFUN ("comp-el-to-eln-rel-filename", Fcomp_el_to_eln_rel_filename,
   return concat3 (filename, hash, build_string (NATIVE_ELISP_SUFFIX));
 }
 
+DEFUN ("comp-el-to-eln-shared-filename", Fcomp_el_to_eln_shared_filename,
+       Scomp_el_to_eln_shared_filename, 1, 1, 0,
+       doc: /* Return the .eln file name for FILENAME in the shared cache.
+The value is in the subdirectory `comp-native-version-dir' of
+`native-comp-shared-eln-directory', and its name consists of the base
+name of FILENAME followed by the hash of its contents and .eln.  It
+does not depend on the leading directories of FILENAME, so it is the
+same for every copy of that source file.  Value is nil if
+`native-comp-shared-eln-directory' is nil.  */)
+  (Lisp_Object filename)
+{
+  CHECK_STRING (filename);
+  if (NILP (Vnative_comp_shared_eln_directory))
+    return Qnil;
+
+  filename = Fexpand_file_name (filename, Qnil);
+  if (NILP (Ffile_exists_p (filename)))
+    xsignal1 (Qfile_missing, filename);
+
+  /* Unlike the names of the per-user cache, this name has nothing but
+     the contents to tell apart files with the same base name, so use
+     the whole hash.  */
+  Lisp_Object content_hash
+    = comp_hash_source_file (filename, MD5_DIGEST_SIZE * 2);
+  if (suffix_p (filename, ".gz"))
+    filename = Fsubstring (filename, Qnil, make_fixnum (-3));
+  Lisp_Object base
+    = Ffile_name_nondirectory (Fsubstring (filename, Qnil, make_fixnum (-3)));
+  Lisp_Object dir
+    = Fexpand_file_name (Vcomp_native_version_dir,
+			 Fexpand_file_name (Vnative_comp_shared_eln_directory,
+					    Vinvocation_directory));
+  return Fexpand_file_name (CALLN (Fconcat, base, build_string ("-"),
+				   content_hash,
+				   build_string (NATIVE_ELISP_SUFFIX)),
+			    dir);
+}
+
 DEFUN ("comp-el-to-eln-filename", Fcomp_el_to_eln_filename,
        Scomp_el_to_eln_filename, 1, 2, 0,
        doc: /* Return the absolute .eln file name for source FILENAME.
@@ -4464,6 +4511,7 @@ DEFUN ("comp--install-trampoline", Fcomp__install_trampoline,
       Lisp_Object subr = XCAR (subr_l);
       if (EQ (subr, orig_subr))
 	{
+	  maybe_resolve_native_subr (XSUBR (trampoline));
 	  freloc.link_table[i] = XSUBR (trampoline)->function.a0;
 	  Fputhash (subr_name, trampoline, Vcomp_installed_trampolines_h);
 	  return Qt;
@@ -5355,6 +5403,42 @@ native_function_doc (Lisp_Object function)
   return make_fixnum (doc);
 }
 
+/* The perf map of this process, or NULL if not open yet.  */
+static FILE *perf_map;
+
+/* If 'native-comp-perf-map' is non-nil, tell perf that the code of the
+   native function named NAME starts at FUNC.  perf reads
+   /tmp/perf-PID.map to name the code it cannot find in the symbol
+   table of a mapped file, for instance because the .eln file was
+   deleted or replaced after being loaded.  */
+
+static void
+perf_map_record (void *func, const char *name)
+{
+#ifdef __GLIBC__
+  if (!native_comp_perf_map)
+    return;
+
+  /* The dynamic symbol table has the size of the function.  */
+  Dl_info info;
+  const ElfW (Sym) *sym = NULL;
+  if (!dladdr1 (func, &info, (void **) &sym, RTLD_DL_SYMENT) || !sym)
+    return;
+
+  if (!perf_map)
+    {
+      char file[sizeof "/tmp/perf-.map" + INT_STRLEN_BOUND (intmax_t)];
+      sprintf (file, "/tmp/perf-%"PRIdMAX".map", (intmax_t) getpid ());
+      perf_map = emacs_fopen (file, "a");
+      if (!perf_map)
+	return;
+    }
+  fprintf (perf_map, "%"PRIxPTR" %"PRIxMAX" %s\n", (uintptr_t) func,
+	   (uintmax_t) sym->st_size, name);
+  fflush (perf_map);
+#endif
+}
+
 static Lisp_Object
 make_subr (Lisp_Object symbol_name, Lisp_Object minarg, Lisp_Object maxarg,
 	   Lisp_Object c_name, Lisp_Object type, Lisp_Object doc_idx,
@@ -5365,8 +5449,13 @@ make_subr (Lisp_Object symbol_name, Lisp_Object minarg, Lisp_Object maxarg,
   if (!handle)
     xsignal0 (Qwrong_register_subr_call);
 
-  void *func = dynlib_sym (handle, SSDATA (c_name));
-  eassert (func);
+  /* When resolving lazily, leave the code to 'resolve_native_subr'.  */
+  void *func = NULL;
+  if (!native_comp_lazy_subrs)
+    {
+      func = dynlib_sym (handle, SSDATA (c_name));
+      eassert (func);
+    }
   union Aligned_Lisp_Subr *x =
     (union Aligned_Lisp_Subr *) allocate_pseudovector (
 				  VECSIZE (union Aligned_Lisp_Subr),
@@ -5400,12 +5489,31 @@ make_subr (Lisp_Object symbol_name, Lisp_Object minarg, Lisp_Object maxarg,
   x->s.native_c_name = xstrdup (SSDATA (c_name));
   x->s.type = type;
 #endif
+  if (func)
+    perf_map_record (func, x->s.symbol_name);
   Lisp_Object tem;
   XSETSUBR (tem, &x->s);
 
   return tem;
 }
 
+/* Look up the code of the native-compiled SUBR, which was deferred
+   until its first call.  */
+
+void
+resolve_native_subr (struct Lisp_Subr *subr)
+{
+  struct Lisp_Native_Comp_Unit *cu = XNATIVE_COMP_UNIT (subr->native_comp_u);
+  void *func = (cu->handle
+		? dynlib_sym (cu->handle, subr->native_c_name)
+		: NULL);
+  if (!func)
+    xsignal2 (Qnative_lisp_file_inconsistent, cu->file,
+	      build_string (subr->native_c_name));
+  subr->function.a0 = func;
+  perf_map_record (func, subr->symbol_name);
+}
+
 DEFUN ("comp--register-lambda", Fcomp__register_lambda, Scomp__register_lambda,
        7, 7, 0,
        doc: /* Register anonymous lambda.
@@ -5559,6 +5667,24 @@ syms_of_comp (void)
 natively compiled one.  */);
   native_comp_jit_compilation = true;
 
+  DEFVAR_BOOL ("native-comp-lazy-subrs", native_comp_lazy_subrs,
+    doc: /* If non-nil, look up the code of native functions on first call.
+Loading a .eln file then only registers its functions, leaving finding
+their code in the shared library until they are called, so that
+functions that are never called cost less.  If nil, the code of all
+the functions is looked up when the file is loaded.  The functions of
+the .eln files preloaded into the Emacs dump are always looked up on
+first call.  */);
+  native_comp_lazy_subrs = true;
+
+  DEFVAR_BOOL ("native-comp-perf-map", native_comp_perf_map,
+    doc: /* If non-nil, describe native code for the perf profiler.
+The start, size and Lisp name of each natively compiled function are
+then appended to the file /tmp/perf-PID.map when its code is looked up,
+so that "perf report" names the functions even if their .eln file
+has been deleted or replaced.  Only supported on GNU/Linux.  */);
+  native_comp_perf_map = false;
+
   DEFSYM (Qnative_comp_speed, "native-comp-speed");
   DEFSYM (Qnative_comp_debug, "native-comp-debug");
   DEFSYM (Qnative_comp_driver_options, "native-comp-driver-options");
@@ -5679,6 +5805,7 @@ syms_of_comp (void)
   defsubr (&Scomp__subr_signature);
   defsubr (&Scomp_el_to_eln_rel_filename);
   defsubr (&Scomp_el_to_eln_filename);
+  defsubr (&Scomp_el_to_eln_shared_filename);
   defsubr (&Scomp_native_driver_options_effective_p);
   defsubr (&Scomp_native_compiler_options_effective_p);
   defsubr (&Scomp__install_trampoline);
@@ -5742,6 +5869,25 @@ syms_of_comp (void)
      dump reload.  */
   Vnative_comp_eln_load_path = Fcons (build_string ("../native-lisp/"), Qnil);
 
+  DEFVAR_LISP ("native-comp-shared-eln-directory",
+	       Vnative_comp_shared_eln_directory,
+    doc: /* Directory of a native-compilation cache shared by all users, or nil.
+If non-nil, the *.eln files in the `comp-native-version-dir'
+subdirectory of this directory are looked for after those in
+`native-comp-eln-load-path' when loading a Lisp file, and
+asynchronous native compilation is skipped for source files that have
+an *.eln file there.  The name of each file there depends only on the
+base name and the contents of its source file (see
+`comp-el-to-eln-shared-filename'), so that every user who loads the
+same version of a package from any directory finds the same file.
+The directory need not be writable; if it is, every asynchronous
+native compilation stores its result there too.  Files are stored by
+renaming a temporary file in the same directory, so that concurrent
+users never see partially written files.
+If the name is not absolute, it is assumed to be relative to
+`invocation-directory'.  */);
+  Vnative_comp_shared_eln_directory = Qnil;
+
   DEFVAR_LISP ("native-comp-enable-subr-trampolines",
 	       Vnative_comp_enable_subr_trampolines,
     doc: /* If non-nil, enable generation of trampolines for calling primitives.
@@ -35,6 +35,8 @@
 #include "frame.h"
 #include "dispextern.h"
 #include "termhooks.h"
+#include "window.h"
+#include "region-cache.h"
 
 
 /* Emacs uses special text property `composition' to support character
@@ -640,10 +642,215 @@ compose_text (ptrdiff_t start, ptrdiff_t end, Lisp_Object components,
 
 static Lisp_Object gstring_hash_table;
 
+/* Bookkeeping for the entries of gstring_hash_table, indexed by the
+   id of an lgstring.  TICK records when the lgstring was last used,
+   and BYTES is the memory it takes.  */
+
+struct gstring_cache_entry
+{
+  EMACS_INT tick;
+  ptrdiff_t bytes;
+};
+
+static struct gstring_cache_entry *gstring_cache_entries;
+static ptrdiff_t gstring_cache_entries_size;
+
+/* The current tick of the cache; incremented by every lookup.  */
+static EMACS_INT gstring_cache_tick;
+
+/* Total memory taken by the lgstrings in gstring_hash_table.  */
+static EMACS_INT gstring_cache_bytes;
+
+/* True if gstring_cache_bytes exceeded `composition-cache-max-bytes'.
+   The glyph matrices and the iterators of the display code refer to
+   cached lgstrings by their id, so the eviction waits until the next
+   redisplay cycle starts, when no iterator is active.  */
+static bool gstring_cache_evict_pending;
+
+/* Usage counters reported by `composition-cache-statistics'.  */
+static EMACS_INT gstring_cache_hits;
+static EMACS_INT gstring_cache_misses;
+static EMACS_INT gstring_cache_evictions;
+
+/* Return the number of bytes taken by the vector V, or 0 if V is not a
+   vector.  */
+static ptrdiff_t
+gstring_vector_bytes (Lisp_Object v)
+{
+  return VECTORP (v) ? header_size + ASIZE (v) * word_size : 0;
+}
+
+/* Return the number of bytes taken by the cached lgstring GSTRING.  */
+static ptrdiff_t
+gstring_cache_bytes_of (Lisp_Object gstring)
+{
+  ptrdiff_t bytes = (gstring_vector_bytes (gstring)
+		     + gstring_vector_bytes (LGSTRING_HEADER (gstring)));
+
+  for (ptrdiff_t i = 0; i < LGSTRING_GLYPH_LEN (gstring); i++)
+    {
+      Lisp_Object g = LGSTRING_GLYPH (gstring, i);
+      if (NILP (g))
+	break;
+      bytes += (gstring_vector_bytes (g)
+		+ gstring_vector_bytes (LGLYPH_ADJUSTMENT (g)));
+    }
+  return bytes;
+}
+
+/* Record that the lgstring whose id is ID was used.  */
+static void
+gstring_cache_touch (ptrdiff_t id)
+{
+  if (0 <= id && id < gstring_cache_entries_size)
+    gstring_cache_entries[id].tick = gstring_cache_tick;
+}
+
 Lisp_Object
 composition_gstring_lookup_cache (Lisp_Object header)
 {
-  return Fgethash (header, gstring_hash_table, Qnil);
+  struct Lisp_Hash_Table *h = XHASH_TABLE (gstring_hash_table);
+  ptrdiff_t id = hash_lookup (h, header);
+
+  gstring_cache_tick++;
+  if (id < 0)
+    {
+      gstring_cache_misses++;
+      return Qnil;
+    }
+  gstring_cache_hits++;
+  gstring_cache_touch (id);
+  return HASH_VALUE (h, id);
+}
+
+/* Forget the lgstring whose id is ID, which was stored under KEY.  */
+static void
+gstring_cache_remove (struct Lisp_Hash_Table *h, Lisp_Object key,
+		      ptrdiff_t id)
+{
+  if (0 <= id && id < gstring_cache_entries_size)
+    {
+      gstring_cache_bytes -= gstring_cache_entries[id].bytes;
+      gstring_cache_entries[id].bytes = 0;
+    }
+  hash_remove_from_table (h, key);
+}
+
+/* Record TICK as the last use of the automatic compositions
+   displayed in the glyph matrix MATRIX.  */
+static void
+gstring_cache_pin_matrix (struct glyph_matrix *matrix, EMACS_INT tick)
+{
+  if (!matrix || !matrix->rows)
+    return;
+  for (int i = 0; i < matrix->nrows; i++)
+    {
+      struct glyph_row *row = matrix->rows + i;
+
+      if (!row->enabled_p)
+	continue;
+      for (int area = LEFT_MARGIN_AREA; area < LAST_AREA; area++)
+	for (struct glyph *glyph = row->glyphs[area];
+	     glyph < row->glyphs[area] + row->used[area]; glyph++)
+	  if (glyph->type == COMPOSITE_GLYPH && glyph->u.cmp.automatic
+	      && 0 <= glyph->u.cmp.id
+	      && glyph->u.cmp.id < gstring_cache_entries_size)
+	    gstring_cache_entries[glyph->u.cmp.id].tick = tick;
+    }
+}
+
+/* Likewise, but for every window in the window tree rooted at W.  */
+static void
+gstring_cache_pin_windows (Lisp_Object window, EMACS_INT tick)
+{
+  while (WINDOWP (window))
+    {
+      struct window *w = XWINDOW (window);
+
+      if (WINDOWP (w->contents))
+	gstring_cache_pin_windows (w->contents, tick);
+      else
+	{
+	  gstring_cache_pin_matrix (w->current_matrix, tick);
+	  gstring_cache_pin_matrix (w->desired_matrix, tick);
+	}
+      window = w->next;
+    }
+}
+
+/* Compare the ids of two cached lgstrings by their last use.  */
+static int
+compare_gstring_cache_ids (const void *a, const void *b)
+{
+  EMACS_INT ta = gstring_cache_entries[*(const ptrdiff_t *) a].tick;
+  EMACS_INT tb = gstring_cache_entries[*(const ptrdiff_t *) b].tick;
+  return (ta > tb) - (ta < tb);
+}
+
+/* Discard the least recently used lgstrings from the cache, until it
+   takes no more than three quarters of `composition-cache-max-bytes'.
+   The lgstrings displayed on some frame are never discarded, since
+   glyph matrices refer to them by their id.  This must not be called
+   while some iterator is active, as it might hold ids that are not
+   recorded in any glyph matrix.  */
+static void
+gstring_cache_evict (void)
+{
+  struct Lisp_Hash_Table *h = XHASH_TABLE (gstring_hash_table);
+  EMACS_INT pinned = ++gstring_cache_tick;
+  Lisp_Object tail, frame;
+
+  gstring_cache_evict_pending = false;
+
+  FOR_EACH_FRAME (tail, frame)
+    {
+      struct frame *f = XFRAME (frame);
+
+      gstring_cache_pin_matrix (f->current_matrix, pinned);
+      gstring_cache_pin_matrix (f->desired_matrix, pinned);
+      gstring_cache_pin_windows (f->root_window, pinned);
+      if (WINDOWP (f->minibuffer_window)
+	  && XWINDOW (f->minibuffer_window)->frame == frame)
+	gstring_cache_pin_windows (f->minibuffer_window, pinned);
+#if defined (HAVE_WINDOW_SYSTEM)
+      gstring_cache_pin_windows (f->tab_bar_window, pinned);
+#endif
+#if defined (HAVE_WINDOW_SYSTEM) && ! defined (HAVE_EXT_TOOL_BAR)
+      gstring_cache_pin_windows (f->tool_bar_window, pinned);
+#endif
+    }
+
+  /* Sort the ids of the lgstrings that can go from the least recently
+     used to the most recently used.  */
+  ptrdiff_t n = 0;
+  USE_SAFE_ALLOCA;
+  ptrdiff_t *ids;
+  SAFE_NALLOCA (ids, 1, h->count);
+  DOHASH_SAFE (h, i)
+    if (i < gstring_cache_entries_size
+	&& gstring_cache_entries[i].tick != pinned)
+      ids[n++] = i;
+  qsort (ids, n, sizeof *ids, compare_gstring_cache_ids);
+
+  EMACS_INT target = composition_cache_max_bytes / 4 * 3;
+  for (ptrdiff_t i = 0; i < n && gstring_cache_bytes > target; i++)
+    {
+      gstring_cache_remove (h, HASH_KEY (h, ids[i]), ids[i]);
+      gstring_cache_evictions++;
+    }
+  SAFE_FREE ();
+}
+
+/* Discard least recently used lgstrings if the cache took more memory
+   than `composition-cache-max-bytes' allows.  Redisplay calls this
+   before it starts laying out any window.  */
+void
+composition_gstring_cache_maybe_evict (void)
+{
+  if (gstring_cache_evict_pending
+      && 0 < composition_cache_max_bytes
+      && composition_cache_max_bytes < gstring_cache_bytes)
+    gstring_cache_evict ();
 }
 
 Lisp_Object
@@ -666,6 +873,18 @@ composition_gstring_put_cache (Lisp_Object gstring, ptrdiff_t len)
     LGSTRING_SET_GLYPH (copy, i, Fcopy_sequence (LGSTRING_GLYPH (gstring, i)));
   ptrdiff_t id = hash_put (h, LGSTRING_HEADER (copy), copy, hash);
   LGSTRING_SET_ID (copy, make_fixnum (id));
+
+  if (gstring_cache_entries_size <= id)
+    gstring_cache_entries
+      = xpalloc (gstring_cache_entries, &gstring_cache_entries_size,
+		 id - gstring_cache_entries_size + 1, -1,
+		 sizeof *gstring_cache_entries);
+  gstring_cache_entries[id].tick = gstring_cache_tick;
+  gstring_cache_entries[id].bytes = gstring_cache_bytes_of (copy);
+  gstring_cache_bytes += gstring_cache_entries[id].bytes;
+  if (0 < composition_cache_max_bytes
+      && composition_cache_max_bytes < gstring_cache_bytes)
+    gstring_cache_evict_pending = true;
   return copy;
 }
 
@@ -673,6 +892,7 @@ composition_gstring_put_cache (Lisp_Object gstring, ptrdiff_t len)
 composition_gstring_from_id (ptrdiff_t id)
 {
   struct Lisp_Hash_Table *h = XHASH_TABLE (gstring_hash_table);
+  gstring_cache_touch (id);
   /* FIXME: The stability of this value depends on the hash table internals!  */
   return HASH_VALUE (h, id);
 }
@@ -686,7 +906,7 @@ composition_gstring_cache_clear_font (Lisp_Object font_object)
 
   DOHASH (h, k, gstring)
     if (EQ (LGSTRING_FONT (gstring), font_object))
-      hash_remove_from_table (h, k);
+      gstring_cache_remove (h, k, XFIXNUM (LGSTRING_ID (gstring)));
 }
 
 DEFUN ("clear-composition-cache", Fclear_composition_cache,
@@ -697,12 +917,38 @@ DEFUN ("clear-composition-cache", Fclear_composition_cache,
 {
   gstring_hash_table = CALLN (Fmake_hash_table, QCtest, Qequal,
 			      QCsize, make_fixnum (311));
+  gstring_cache_bytes = 0;
+  gstring_cache_evict_pending = false;
+#ifdef HAVE_HARFBUZZ
+  hbfont_shape_cache_clear_font (Qnil);
+#endif
   /* Fixme: We call Fclear_face_cache to force complete re-building of
      display glyphs.  But, it may be better to call this function from
      Fclear_face_cache instead.  */
   return Fclear_face_cache (Qt);
 }
 
+DEFUN ("composition-cache-statistics", Fcomposition_cache_statistics,
+       Scomposition_cache_statistics, 0, 0, 0,
+       doc: /* Return statistics about the cache of automatic compositions.
+The value is an alist with the following elements:
+
+  (entries . N)    N is the number of glyph-strings in the cache;
+  (bytes . N)      N is the approximate memory they take, in bytes;
+  (hits . N)       N is the number of lookups that found a glyph-string;
+  (misses . N)     N is the number of lookups that found none;
+  (evictions . N)  N is the number of glyph-strings discarded to keep
+                   the cache within `composition-cache-max-bytes'.  */)
+  (void)
+{
+  return list5 (Fcons (Qentries,
+		       make_fixnum (XHASH_TABLE (gstring_hash_table)->count)),
+		Fcons (Qbytes, make_int (gstring_cache_bytes)),
+		Fcons (Qhits, make_int (gstring_cache_hits)),
+		Fcons (Qmisses, make_int (gstring_cache_misses)),
+		Fcons (Qevictions, make_int (gstring_cache_evictions)));
+}
+
 bool
 composition_gstring_p (Lisp_Object gstring)
 {
@@ -1021,6 +1267,73 @@ inhibit_auto_composition (void)
   return false;
 }
 
+/* The composition-function-table whose contents, as of char_table_modiff
+   composition_cache_modiff, the composition caches of buffers
+   describe, and the generation of that information.  A buffer whose
+   composition_cache_generation differs from composition_cache_generation
+   forgets what its composition cache knows.  */
+static Lisp_Object composition_cache_table;
+static EMACS_UINT composition_cache_modiff;
+static EMACS_UINT composition_cache_generation;
+
+/* If the user has requested the long scans caching, make sure the
+   composition cache of the current buffer is on, and return it, after
+   setting *CACHE_BUFFER to the buffer that owns it.  Otherwise, make
+   sure it's off, and return NULL.  See newline_cache_on_off in
+   search.c.  */
+static struct region_cache *
+composition_cache_on_off (struct buffer **cache_buffer)
+{
+  struct buffer *base_buf = current_buffer;
+  bool indirect_p = false;
+
+  if (base_buf->base_buffer)
+    {
+      base_buf = base_buf->base_buffer;
+      indirect_p = true;
+    }
+  *cache_buffer = base_buf;
+
+  if (NILP (BVAR (current_buffer, cache_long_scans)))
+    {
+      if (!indirect_p
+	  || NILP (BVAR (base_buf, cache_long_scans)))
+	{
+	  if (base_buf->composition_cache)
+	    {
+	      free_region_cache (base_buf->composition_cache);
+	      base_buf->composition_cache = 0;
+	    }
+	}
+      return NULL;
+    }
+
+  if (!indirect_p
+      || !NILP (BVAR (base_buf, cache_long_scans)))
+    {
+      if (!base_buf->composition_cache)
+	base_buf->composition_cache = new_region_cache ();
+    }
+  if (!base_buf->composition_cache)
+    return NULL;
+
+  /* composition-function-table can be buffer-local, and it can be
+     modified in place.  */
+  if (! (EQ (Vcomposition_function_table, composition_cache_table)
+	 && composition_cache_modiff == char_table_modiff))
+    {
+      composition_cache_table = Vcomposition_function_table;
+      composition_cache_modiff = char_table_modiff;
+      composition_cache_generation++;
+    }
+  if (base_buf->composition_cache_generation != composition_cache_generation)
+    {
+      invalidate_region_cache (base_buf, base_buf->composition_cache, 0, 0);
+      base_buf->composition_cache_generation = composition_cache_generation;
+    }
+  return base_buf->composition_cache;
+}
+
 /* Update cmp_it->stop_pos to the next position after CHARPOS (and
    BYTEPOS) where character composition may happen.  If BYTEPOS is
    negative, compute it.  ENDPOS is a limit of searching.  If it is
@@ -1103,18 +1416,54 @@ composition_compute_stop_pos (struct composition_it *cmp_it, ptrdiff_t charpos,
   start = charpos;
   if (charpos < endpos)
     {
-      /* Forward search.  */
+      /* Forward search.  In a buffer, skip the text that the
+	 composition cache knows has no characters with composition
+	 rules, and tell the cache about such text found on the way.
+	 KNOWN_FROM is the start of the run of such characters that
+	 ends at CHARPOS.  */
+      struct buffer *cache_buffer;
+      struct region_cache *cache
+	= NILP (string) ? composition_cache_on_off (&cache_buffer) : NULL;
+      bool check_cache = cache != NULL;
+      ptrdiff_t known_from = charpos;
+
       while (charpos < endpos)
 	{
+	  if (check_cache)
+	    {
+	      ptrdiff_t next, counted;
+
+	      check_cache = false;
+	      if (region_cache_forward (cache_buffer, cache, charpos, &next))
+		{
+		  /* Like the loop below, stop after a newline.  */
+		  charpos = find_newline (charpos, bytepos, min (next, endpos),
+					  -1, 1, &counted, &bytepos, false);
+		  if (counted)
+		    {
+		      cmp_it->ch = -2;
+		      break;
+		    }
+		  continue;
+		}
+	    }
 	  c = (STRINGP (string)
 	       ? fetch_string_char_advance (string, &charpos, &bytepos)
 	       : fetch_char_advance (&charpos, &bytepos));
+	  val = CHAR_TABLE_REF (Vcomposition_function_table, c);
+	  if (cache && ! NILP (val))
+	    {
+	      if (known_from < charpos - 1)
+		know_region_cache (cache_buffer, cache,
+				   known_from, charpos - 1);
+	      known_from = charpos;
+	      check_cache = true;
+	    }
 	  if (c == '\n')
 	    {
 	      cmp_it->ch = -2;
 	      break;
 	    }
-	  val = CHAR_TABLE_REF (Vcomposition_function_table, c);
 	  if (! NILP (val))
 	    {
 	      for (EMACS_INT ridx = 0; CONSP (val); val = XCDR (val), ridx++)
@@ -1133,6 +1482,8 @@ composition_compute_stop_pos (struct composition_it *cmp_it, ptrdiff_t charpos,
 		}
 	    }
 	}
+      if (cache && known_from < charpos)
+	know_region_cache (cache_buffer, cache, known_from, charpos);
       if (charpos == endpos
 	  && !(STRINGP (string) && endpos == SCHARS (string)))
 	{
@@ -1692,6 +2043,23 @@ find_automatic_composition (ptrdiff_t pos, ptrdiff_t limit, ptrdiff_t backlim,
   else
     fore_check_limit = min (tail, limit + MAX_AUTO_COMPOSITION_LOOKBACK);
 
+  /* Only the composition rules of the characters between HEAD and
+     FORE_CHECK_LIMIT are tried below.  Don't bother if the composition
+     cache knows that none of these characters has any.  */
+  if (NILP (string))
+    {
+      struct buffer *cache_buffer;
+      struct region_cache *cache = composition_cache_on_off (&cache_buffer);
+      ptrdiff_t next;
+
+      if (cache && region_cache_forward (cache_buffer, cache, head, &next)
+	  && fore_check_limit <= next)
+	{
+	  *gstring = Qnil;
+	  return 0;
+	}
+    }
+
   /* Provided that we have these possible compositions now:
 
 	   POS:	1 2 3 4 5 6 7 8 9
@@ -2201,6 +2569,8 @@ syms_of_composite (void)
     ASET (gstring_work_headers, i, make_nil_vector (i + 2));
   staticpro (&gstring_work);
   gstring_work = make_nil_vector (10);
+  staticpro (&composition_cache_table);
+  composition_cache_table = Qnil;
 
   /* Text property `composition' should be nonsticky by default.  */
   Vtext_property_default_nonsticky
@@ -2222,6 +2592,22 @@ syms_of_composite (void)
 
   DEFSYM (Qauto_composed, "auto-composed");
 
+  DEFSYM (Qentries, "entries");
+  DEFSYM (Qbytes, "bytes");
+  DEFSYM (Qhits, "hits");
+  DEFSYM (Qmisses, "misses");
+  DEFSYM (Qevictions, "evictions");
+
+  DEFVAR_INT ("composition-cache-max-bytes", composition_cache_max_bytes,
+	      doc: /* Approximate limit on the memory taken by cached compositions.
+The display engine caches the glyph-strings it produces for automatic
+compositions, see `composition-get-gstring'.  When they take more than
+this many bytes, the least recently used glyph-strings that are not
+displayed on any frame are discarded, until the cache takes no more than
+three quarters of this limit.  Zero or a negative value means no
+limit.  */);
+  composition_cache_max_bytes = 16 * 1024 * 1024;
+
   DEFVAR_LISP ("auto-composition-mode", Vauto_composition_mode,
 	       doc: /* Non-nil if Auto-Composition mode is enabled.
 Use the command `auto-composition-mode' to change this variable.
@@ -2304,5 +2690,6 @@ syms_of_composite (void)
   defsubr (&Sfind_composition_internal);
   defsubr (&Scomposition_get_gstring);
   defsubr (&Sclear_composition_cache);
+  defsubr (&Scomposition_cache_statistics);
   defsubr (&Scomposition_sort_rules);
 }
@@ -357,6 +357,7 @@ #define LGLYPH_WADJUST(g) (VECTORP (LGLYPH_ADJUSTMENT (g)) \
 extern Lisp_Object composition_gstring_lookup_cache (Lisp_Object);
 
 extern void composition_gstring_cache_clear_font (Lisp_Object);
+extern void composition_gstring_cache_maybe_evict (void);
 
 INLINE_HEADER_END
 
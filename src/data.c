@@ -256,6 +256,7 @@ DEFUN ("cl-type-of", Fcl_type_of, Scl_type_of, 1, 1, 0,
         case PVEC_THREAD: return Qthread;
         case PVEC_MUTEX: return Qmutex;
         case PVEC_CONDVAR: return Qcondition_variable;
+        case PVEC_CHANNEL: return Qchannel;
         case PVEC_TERMINAL: return Qterminal;
         case PVEC_RECORD:
           {
@@ -282,6 +283,10 @@ DEFUN ("cl-type-of", Fcl_type_of, Scl_type_of, 1, 1, 0,
 	  return Qtreesit_compiled_query;
         case PVEC_SQLITE:
           return Qsqlite;
+        case PVEC_JSON_PARSER:
+          return Qjson_parser;
+        case PVEC_REGION_CACHE:
+          return Qregion_cache;
         case PVEC_SUB_CHAR_TABLE:
           return Qsub_char_table;
         /* "Impossible" cases.  */
@@ -1396,7 +1401,7 @@ wrong_range (Lisp_Object min, Lisp_Object max, Lisp_Object wrong)
    BUF non-zero means set the value in buffer BUF instead of the
    current buffer.  This only plays a role for per-buffer variables.  */
 
-static void
+void
 store_symval_forwarding (lispfwd valcontents, Lisp_Object newval,
 			 struct buffer *buf)
 {
@@ -1519,6 +1524,30 @@ swap_in_global_binding (struct Lisp_Symbol *symbol)
   set_blv_found (blv, false);
 }
 
+/* Load into the buffer-local symbol SYMBOL, whose value cell points
+   to BLV, its binding CELL in the current buffer, or its default
+   binding if CELL is nil.  */
+
+static void
+load_symval_binding (struct Lisp_Symbol *symbol,
+		     struct Lisp_Buffer_Local_Value *blv, Lisp_Object cell)
+{
+  eassert (blv == SYMBOL_BLV (symbol));
+
+  /* Unload the previously loaded binding.  */
+  if (blv->fwd.fwdptr)
+    set_blv_value (blv, do_symval_forwarding (blv->fwd));
+  /* Choose the new binding.  */
+  set_blv_where (blv, Fcurrent_buffer ());
+  if (!(blv->found = !NILP (cell)))
+    cell = blv->defcell;
+
+  /* Load the new binding.  */
+  set_blv_valcell (blv, cell);
+  if (blv->fwd.fwdptr)
+    store_symval_forwarding (blv->fwd, blv_value (blv), NULL);
+}
+
 /* Set up the buffer-local symbol SYMBOL for validity in the current buffer.
    VALCONTENTS is the contents of its value cell,
    which points to a struct Lisp_Buffer_Local_Value.
@@ -1538,28 +1567,29 @@ swap_in_symval_forwarding (struct Lisp_Symbol *symbol, struct Lisp_Buffer_Local_
   if (NILP (tem1)
       || current_buffer != XBUFFER (tem1))
     {
+      Lisp_Object var;
+      XSETSYMBOL (var, symbol);
+      load_symval_binding (symbol, blv,
+			   assq_no_quit (var,
+					 BVAR (current_buffer,
+					       local_var_alist)));
+    }
+}
 
-      /* Unload the previously loaded binding.  */
-      tem1 = blv->valcell;
-      if (blv->fwd.fwdptr)
-	set_blv_value (blv, do_symval_forwarding (blv->fwd));
-      /* Choose the new binding.  */
-      {
-	Lisp_Object var;
-	XSETSYMBOL (var, symbol);
-	tem1 = assq_no_quit (var, BVAR (current_buffer, local_var_alist));
-	set_blv_where (blv, Fcurrent_buffer ());
-      }
-      if (!(blv->found = !NILP (tem1)))
-	tem1 = blv->defcell;
+/* Like swap_in_symval_forwarding, but the caller knows that the
+   binding of SYMBOL in the current buffer is CELL, an element of the
+   buffer's local_var_alist, or that SYMBOL has no binding there if
+   CELL is nil.  This saves searching local_var_alist.  */
 
-      /* Load the new binding.  */
-      set_blv_valcell (blv, tem1);
-      if (blv->fwd.fwdptr)
-	store_symval_forwarding (blv->fwd, blv_value (blv), NULL);
-    }
+void
+swap_in_symval_binding (struct Lisp_Symbol *symbol, Lisp_Object cell)
+{
+  struct Lisp_Buffer_Local_Value *blv = SYMBOL_BLV (symbol);
+
+  if (NILP (blv->where) || current_buffer != XBUFFER (blv->where))
+    load_symval_binding (symbol, blv, cell);
 }
-
+
 /* Find the value of a symbol, returning Qunbound if it's not bound.
    This is helpful for code which just wants to get a variable's value
    if it has one, without signaling an error.
@@ -3167,7 +3197,7 @@ float_arith_driver (enum arithop code, ptrdiff_t nargs, Lisp_Object *args,
 
 static Lisp_Object
 bignum_arith_driver (enum arithop code, ptrdiff_t nargs, Lisp_Object *args,
-		     ptrdiff_t argnum, intmax_t iaccum, Lisp_Object val)
+		     ptrdiff_t argnum, intwide_t iaccum, Lisp_Object val)
 {
   mpz_t const *accum;
   if (argnum == 0)
@@ -3175,7 +3205,7 @@ bignum_arith_driver (enum arithop code, ptrdiff_t nargs, Lisp_Object *args,
       accum = bignum_integer (&mpz[0], val);
       goto next_arg;
     }
-  mpz_set_intmax (mpz[0], iaccum);
+  mpz_set_intwide (mpz[0], iaccum);
   accum = &mpz[0];
 
   while (true)
@@ -3211,6 +3241,66 @@ bignum_arith_driver (enum arithop code, ptrdiff_t nargs, Lisp_Object *args,
     }
 }
 
+/* Like bignum_arith_driver, except use intwide_t arithmetic for as
+   long as the arguments and results fit, so that operations on small
+   bignums need not go through GMP.  */
+
+static Lisp_Object
+intwide_arith_driver (enum arithop code, ptrdiff_t nargs, Lisp_Object *args,
+		      ptrdiff_t argnum, intwide_t accum, Lisp_Object val)
+{
+  while (true)
+    {
+      /* Set NEXT to the next value if it fits, else exit the loop.  */
+      intwide_t next;
+      if (! (INTEGERP (val) && integer_to_intwide (val, &next)))
+	break;
+
+      if (argnum == 0)
+	accum = next;
+      else
+	{
+	  /* Set ACCUM to the next operation's result if it fits,
+	     else exit the loop.  */
+	  bool overflow;
+	  intwide_t a;
+	  switch (code)
+	    {
+	    case Aadd : overflow = ckd_add (&a, accum, next); break;
+	    case Amult: overflow = ckd_mul (&a, accum, next); break;
+	    case Asub : overflow = ckd_sub (&a, accum, next); break;
+	    case Adiv:
+	      if (next == 0)
+		xsignal0 (Qarith_error);
+	      if (next == -1)
+		overflow = ckd_sub (&a, 0, accum);
+	      else
+		{
+		  a = accum / next;
+		  overflow = false;
+		}
+	      break;
+	    case Alogand: a = accum & next; overflow = false; break;
+	    case Alogior: a = accum | next; overflow = false; break;
+	    case Alogxor: a = accum ^ next; overflow = false; break;
+	    default: eassume (false);
+	    }
+	  if (overflow)
+	    break;
+	  accum = a;
+	}
+
+      argnum++;
+      if (argnum == nargs)
+	return make_intwide (accum);
+      val = check_number_coerce_marker (args[argnum]);
+    }
+
+  return (FLOATP (val)
+	  ? float_arith_driver (code, nargs, args, argnum, accum, val)
+	  : bignum_arith_driver (code, nargs, args, argnum, accum, val));
+}
+
 /* Return the result of applying the arithmetic operation CODE to the
    NARGS arguments starting at ARGS, with the first argument being the
    number VAL.  2 <= NARGS.  Check that the remaining arguments are
@@ -3269,7 +3359,7 @@ arith_driver (enum arithop code, ptrdiff_t nargs, Lisp_Object *args,
 
   return (FLOATP (val)
 	  ? float_arith_driver (code, nargs, args, argnum, accum, val)
-	  : bignum_arith_driver (code, nargs, args, argnum, accum, val));
+	  : intwide_arith_driver (code, nargs, args, argnum, accum, val));
 }
 
 
@@ -4188,6 +4278,7 @@ #define PUT_ERROR(sym, tail, msg)			\
   DEFSYM (Qthread, "thread");
   DEFSYM (Qmutex, "mutex");
   DEFSYM (Qcondition_variable, "condition-variable");
+  DEFSYM (Qchannel, "channel");
   DEFSYM (Qfont_spec, "font-spec");
   DEFSYM (Qfont_entity, "font-entity");
   DEFSYM (Qfont_object, "font-object");
@@ -1617,6 +1617,33 @@ DEFUN ("dbus-message-internal", Fdbus_message_internal, Sdbus_message_internal,
   return result;
 }
 
+/* Return the handler of the first registration in the list VALUE of
+   `dbus-registered-objects-table' entries that matches the sender
+   UNAME and the object PATH of a message, or nil.  */
+static Lisp_Object
+xd_find_handler (Lisp_Object value, const char *uname, const char *path)
+{
+  for (; !NILP (value); value = CDR_SAFE (value))
+    {
+      Lisp_Object key = CAR_SAFE (value);
+      Lisp_Object key_uname = CAR_SAFE (key);
+      /* key has the structure (UNAME SERVICE PATH HANDLER).  */
+      if (uname && !NILP (key_uname)
+	  && strcmp (uname, SSDATA (key_uname)) != 0)
+	continue;
+      Lisp_Object key_service_etc = CDR_SAFE (key);
+      Lisp_Object key_path_etc = CDR_SAFE (key_service_etc);
+      Lisp_Object key_path = CAR_SAFE (key_path_etc);
+      if (path && !NILP (key_path)
+	  && strcmp (path, SSDATA (key_path)) != 0)
+	continue;
+      Lisp_Object handler = CAR_SAFE (CDR_SAFE (key_path_etc));
+      if (!NILP (handler))
+	return handler;
+    }
+  return Qnil;
+}
+
 /* Read one queued incoming message of the D-Bus BUS.
    BUS is either a Lisp symbol, :system, :session, :system-private or
    :session-private, or a string denoting the bus address.  */
@@ -1624,6 +1651,7 @@ DEFUN ("dbus-message-internal", Fdbus_message_internal, Sdbus_message_internal,
 xd_read_message_1 (DBusConnection *connection, Lisp_Object bus)
 {
   Lisp_Object args, key, value;
+  Lisp_Object interface_string, member_string;
   struct input_event event;
   DBusMessage *dmessage;
   DBusMessageIter iter;
@@ -1676,6 +1704,10 @@ xd_read_message_1 (DBusConnection *connection, Lisp_Object bus)
 		    mtype == DBUS_MESSAGE_TYPE_ERROR ? error_name : member,
 		    XD_OBJECT_TO_STRING (args));
 
+  /* These are used both for looking up handlers and in the events.  */
+  interface_string = interface == NULL ? Qnil : build_string (interface);
+  member_string = member == NULL ? Qnil : build_string (member);
+
   if (mtype == DBUS_MESSAGE_TYPE_INVALID)
     goto cleanup;
 
@@ -1708,56 +1740,33 @@ xd_read_message_1 (DBusConnection *connection, Lisp_Object bus)
       if ((interface == NULL) || (member == NULL))
 	goto monitor;
 
-      /* Search for a registered function of the message.  */
-      key = list4 (mtype == DBUS_MESSAGE_TYPE_METHOD_CALL ? QCmethod : QCsignal,
-		   bus, build_string (interface), build_string (member));
-      value = Fgethash (key, Vdbus_registered_objects_table, Qnil);
-
-      /* A signal could be registered with a nil interface or member.  */
-      if (mtype == DBUS_MESSAGE_TYPE_SIGNAL)
+      /* Search for a registered function of the message.  A signal
+	 could also be registered with a nil interface or member.
+	 Search the registrations in place, rather than appending the
+	 lists for each message.  */
+      Lisp_Object keytype
+	= mtype == DBUS_MESSAGE_TYPE_METHOD_CALL ? QCmethod : QCsignal;
+      Lisp_Object interfaces[] = { interface_string, Qnil,
+				   interface_string, Qnil };
+      Lisp_Object members[] = { member_string, member_string,
+				Qnil, Qnil };
+      int nkeys = mtype == DBUS_MESSAGE_TYPE_SIGNAL ? 4 : 1;
+      Lisp_Object handler = Qnil;
+      for (int i = 0; i < nkeys && NILP (handler); i++)
 	{
-	  key = list4 (QCsignal, bus, Qnil, build_string (member));
-	  value = CALLN (Fappend, value,
-			 Fgethash (key, Vdbus_registered_objects_table, Qnil));
-
-	  key = list4 (QCsignal, bus, build_string (interface), Qnil);
-	  value = CALLN (Fappend, value,
-			 Fgethash (key, Vdbus_registered_objects_table, Qnil));
-
-	  key = list4 (QCsignal, bus, Qnil, Qnil);
-	  value = CALLN (Fappend, value,
-			 Fgethash (key, Vdbus_registered_objects_table, Qnil));
+	  key = list4 (keytype, bus, interfaces[i], members[i]);
+	  value = Fgethash (key, Vdbus_registered_objects_table, Qnil);
+	  handler = xd_find_handler (value, uname, path);
 	}
 
-      /* Loop over the registered functions.  Construct an event.  */
-      for (; !NILP (value); value = CDR_SAFE (value))
-	{
-	  key = CAR_SAFE (value);
-	  Lisp_Object key_uname = CAR_SAFE (key);
-	  /* key has the structure (UNAME SERVICE PATH HANDLER).  */
-	  if (uname && !NILP (key_uname)
-	      && strcmp (uname, SSDATA (key_uname)) != 0)
-	    continue;
-	  Lisp_Object key_service_etc = CDR_SAFE (key);
-	  Lisp_Object key_path_etc = CDR_SAFE (key_service_etc);
-	  Lisp_Object key_path = CAR_SAFE (key_path_etc);
-	  if (path && !NILP (key_path)
-	      && strcmp (path, SSDATA (key_path)) != 0)
-	    continue;
-	  Lisp_Object handler = CAR_SAFE (CDR_SAFE (key_path_etc));
-	  if (NILP (handler))
-	    continue;
-
-	  /* Construct an event and exit the loop.  */
-	  EVENT_INIT (event);
-	  event.kind = DBUS_EVENT;
-	  event.frame_or_window = Qnil;
-	  event.arg = Fcons (handler, args);
-	  break;
-	}
-
-      if (NILP (value))
+      if (NILP (handler))
 	goto monitor;
+
+      /* Construct an event.  */
+      EVENT_INIT (event);
+      event.kind = DBUS_EVENT;
+      event.frame_or_window = Qnil;
+      event.arg = Fcons (handler, args);
     }
 
   /* Add type, serial, uname, destination, path, interface and member
@@ -1765,10 +1774,9 @@ xd_read_message_1 (DBusConnection *connection, Lisp_Object bus)
   event.arg
     = Fcons (mtype == DBUS_MESSAGE_TYPE_ERROR
 	     ? error_name == NULL ? Qnil : build_string (error_name)
-	     : member == NULL ? Qnil : build_string (member),
+	     : member_string,
 	     event.arg);
-  event.arg = Fcons ((interface == NULL ? Qnil : build_string (interface)),
-		     event.arg);
+  event.arg = Fcons (interface_string, event.arg);
   event.arg = Fcons ((path == NULL ? Qnil : build_string (path)),
 		     event.arg);
   event.arg = Fcons ((destination == NULL ? Qnil : build_string (destination)),
@@ -1809,10 +1817,9 @@ xd_read_message_1 (DBusConnection *connection, Lisp_Object bus)
   event.arg
     = Fcons (mtype == DBUS_MESSAGE_TYPE_ERROR
 	     ? error_name == NULL ? Qnil : build_string (error_name)
-	     : member == NULL ? Qnil : build_string (member),
+	     : member_string,
 	     event.arg);
-  event.arg = Fcons ((interface == NULL ? Qnil : build_string (interface)),
-		     event.arg);
+  event.arg = Fcons (interface_string, event.arg);
   event.arg = Fcons ((path == NULL ? Qnil : build_string (path)),
 		     event.arg);
   event.arg = Fcons ((destination == NULL ? Qnil : build_string (destination)),
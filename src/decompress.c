@@ -37,6 +37,14 @@ DEF_DLL_FN (int, inflateInit2_,
 	     int stream_size));
 DEF_DLL_FN (int, inflate, (z_streamp strm, int flush));
 DEF_DLL_FN (int, inflateEnd, (z_streamp strm));
+DEF_DLL_FN (int, inflateReset, (z_streamp strm));
+DEF_DLL_FN (uLong, compressBound, (uLong sourceLen));
+DEF_DLL_FN (int, compress2,
+	    (Bytef *dest, uLongf *destLen, const Bytef *source,
+	     uLong sourceLen, int level));
+DEF_DLL_FN (int, uncompress,
+	    (Bytef *dest, uLongf *destLen, const Bytef *source,
+	     uLong sourceLen));
 
 static bool zlib_initialized;
 
@@ -51,16 +59,28 @@ init_zlib_functions (void)
   LOAD_DLL_FN (library, inflateInit2_);
   LOAD_DLL_FN (library, inflate);
   LOAD_DLL_FN (library, inflateEnd);
+  LOAD_DLL_FN (library, inflateReset);
+  LOAD_DLL_FN (library, compressBound);
+  LOAD_DLL_FN (library, compress2);
+  LOAD_DLL_FN (library, uncompress);
   return true;
 }
 
 # undef inflate
 # undef inflateEnd
+# undef inflateReset
 # undef inflateInit2_
+# undef compressBound
+# undef compress2
+# undef uncompress
 
 # define inflate fn_inflate
 # define inflateEnd fn_inflateEnd
+# define inflateReset fn_inflateReset
 # define inflateInit2_ fn_inflateInit2_
+# define compressBound fn_compressBound
+# define compress2 fn_compress2
+# define uncompress fn_uncompress
 
 #endif	/* WINDOWSNT */
 
@@ -199,6 +219,54 @@ unwind_decompress (void *ddata)
   SET_PT (min (data->old_point, ZV));
 }
 
+/* Compress the SIZE bytes at DATA.  Return the result as a unibyte
+   string, or nil if zlib is not available or did not make the data
+   smaller.  */
+
+Lisp_Object
+zlib_compress_bytes (const void *data, ptrdiff_t size)
+{
+#ifdef WINDOWSNT
+  if (!zlib_initialized)
+    zlib_initialized = init_zlib_functions ();
+  if (!zlib_initialized)
+    return Qnil;
+#endif
+
+  if (ULONG_MAX < size)
+    return Qnil;
+  uLongf nbytes = compressBound (size);
+  USE_SAFE_ALLOCA;
+  Bytef *buf = SAFE_ALLOCA (nbytes);
+  Lisp_Object result = Qnil;
+  if (compress2 (buf, &nbytes, data, size, Z_DEFAULT_COMPRESSION) == Z_OK
+      && nbytes < size)
+    result = make_unibyte_string ((char *) buf, nbytes);
+  SAFE_FREE ();
+  return result;
+}
+
+/* Uncompress the SIZE bytes at DATA, compressed by
+   zlib_compress_bytes, into the NBYTES bytes at BUF.  Return true if
+   that succeeded and filled BUF exactly.  */
+
+bool
+zlib_uncompress_bytes (const void *data, ptrdiff_t size,
+		       void *buf, ptrdiff_t nbytes)
+{
+#ifdef WINDOWSNT
+  if (!zlib_initialized)
+    zlib_initialized = init_zlib_functions ();
+  if (!zlib_initialized)
+    return false;
+#endif
+
+  if (ULONG_MAX < size || ULONG_MAX < nbytes)
+    return false;
+  uLongf len = nbytes;
+  return (uncompress (buf, &len, data, size) == Z_OK && len == nbytes);
+}
+
 DEFUN ("zlib-available-p", Fzlib_available_p, Szlib_available_p, 0, 0, 0,
        doc: /* Return t if zlib decompression is available in this instance of Emacs.  */)
      (void)
@@ -224,7 +292,9 @@ DEFUN ("zlib-decompress-region", Fzlib_decompress_region,
        Szlib_decompress_region,
        2, 3, 0,
        doc: /* Decompress a gzip- or zlib-compressed region.
-Replace the text in the region by the decompressed data.
+Replace the text in the region by the decompressed data.  If the
+region holds several gzip members one after another, as produced by
+concatenating gzip files, decompress them all.
 
 If optional parameter ALLOW-PARTIAL is nil or omitted, then on
 failure, return nil and leave the data in place.  Otherwise, return
@@ -311,6 +381,16 @@ DEFUN ("zlib-decompress-region", Fzlib_decompress_region,
       insert_from_gap (decompressed, decompressed, 0, false);
       unwind_data.nbytes += decompressed;
       maybe_quit ();
+
+      /* Like gzip, decompress the members of a file made by
+	 concatenating gzip files one after another.  Ignore anything
+	 else after the end of the compressed data, as before.  */
+      if (inflate_status == Z_STREAM_END
+	  && iend - pos_byte >= 2
+	  && FETCH_BYTE (pos_byte) == 0x1f
+	  && FETCH_BYTE (pos_byte + 1) == 0x8b
+	  && inflateReset (&stream) == Z_OK)
+	inflate_status = Z_OK;
     }
   while (inflate_status == Z_OK);
 
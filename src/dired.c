@@ -444,6 +444,713 @@ DEFUN ("directory-files-and-attributes", Fdirectory_files_and_attributes,
 				   true, id_format, count);
 }
 
+/* State shared by the calls of directory_files_recursively_1.  */
+
+struct recursive_listing
+{
+  /* The arguments of internal-directory-files-recursively.  */
+  Lisp_Object regexp, prune;
+  bool include_directories, ignore_unreadable, follow_symlinks;
+
+  /* The case table for matching REGEXP and PRUNE.  */
+  Lisp_Object case_table;
+
+  /* The matching file names found so far, in reverse order.  */
+  Lisp_Object result;
+};
+
+/* Return true if NAME matches a regexp in the list REGEXPS, using
+   CASE_TABLE.  */
+
+static bool
+match_any_regexp (Lisp_Object regexps, Lisp_Object name,
+		  Lisp_Object case_table)
+{
+  for (Lisp_Object tail = regexps; CONSP (tail); tail = XCDR (tail))
+    if (fast_string_match_internal (XCAR (tail), name, case_table) >= 0)
+      return true;
+  return false;
+}
+
+/* Add the matching files under the directory DIR, whose name encoded
+   for the file system is ENCODED_DIR, to L->result.  If the directory
+   can't be read, signal an error, unless L->ignore_unreadable and
+   not TOPLEVEL, in which case ignore it.  */
+
+static void
+directory_files_recursively_1 (struct recursive_listing *l,
+			       Lisp_Object dir, Lisp_Object encoded_dir,
+			       bool toplevel)
+{
+  int fd;
+  emacs_dir *d;
+
+  if (toplevel || !l->ignore_unreadable)
+    d = open_directory (dir, encoded_dir, &fd);
+  else
+    {
+      /* open_directory signals errors, which we want to ignore here;
+	 but catching them would be much slower.  */
+#if defined DOS_NT || (defined HAVE_ANDROID && !defined ANDROID_STUBIFY)
+      if (sys_faccessat (AT_FDCWD, SSDATA (encoded_dir), R_OK, AT_EACCESS)
+	  != 0)
+	return;
+      d = open_directory (dir, encoded_dir, &fd);
+#else
+      fd = emacs_open (SSDATA (encoded_dir), O_RDONLY | O_DIRECTORY, 0);
+      if (fd < 0)
+	return;
+      d = fdopendir (fd);
+      if (!d)
+	{
+	  emacs_close (fd);
+	  return;
+	}
+#endif
+    }
+
+  specpdl_ref count = SPECPDL_INDEX ();
+  record_unwind_protect_ptr (directory_files_internal_unwind, d);
+
+  /* Read all the entries first, so that only one directory is open
+     at a time.  Each element of ENTRIES is (NAME) for a file, and
+     (NAME ENCODED-NAME . SYMLINKP) for a directory, whose NAME ends in
+     a slash.  Only symbolic links, and entries of unknown type, need
+     to be stat'ed to know whether they are directories.  */
+  enum { ENTRY_DIR = 1, ENTRY_SYMLINK = 2 };
+  Lisp_Object slash = build_string ("/");
+  Lisp_Object entries = Qnil;
+  for (struct dirent *dp; (dp = read_dirent (d, dir)); )
+    {
+      ptrdiff_t len = dirent_namelen (dp);
+      if (dp->d_name[0] == '.'
+	  && (len == 1 || (len == 2 && dp->d_name[1] == '.')))
+	continue;
+
+      int flags = 0;
+      int type = dirent_type (dp);
+      struct stat st;
+      if (type == DT_DIR)
+	flags = ENTRY_DIR;
+      else if (type == DT_LNK || type == DT_UNKNOWN)
+	{
+	  if (type == DT_LNK
+	      || (fstatat (fd, dp->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0
+		  && S_ISLNK (st.st_mode)))
+	    flags |= ENTRY_SYMLINK;
+	  if (fstatat (fd, dp->d_name, &st, 0) == 0 && S_ISDIR (st.st_mode))
+	    flags |= ENTRY_DIR;
+	}
+
+      Lisp_Object encoded_name = make_unibyte_string (dp->d_name, len);
+      /* This can GC.  */
+      Lisp_Object name = DECODE_FILE (encoded_name);
+      Lisp_Object entry;
+      if (flags & ENTRY_DIR)
+	entry = Fcons (concat2 (name, slash),
+		       Fcons (encoded_name,
+			      flags & ENTRY_SYMLINK ? Qt : Qnil));
+      else
+	entry = list1 (name);
+      entries = Fcons (entry, entries);
+      maybe_quit ();
+    }
+  emacs_closedir (d);
+  specpdl_ptr = specpdl_ref_to_ptr (count);
+
+  /* Sort the entries like file-name-all-completions, whose directory
+     names end in a slash.  */
+  entries = CALLN (Fsort, entries, QCkey, Qcar, QClessp, Qstring_lessp,
+		   QCin_place, Qt);
+
+  Lisp_Object encoded_slash = build_unibyte_string ("/");
+  Lisp_Object files = Qnil;
+  for (Lisp_Object tail = entries; CONSP (tail); tail = XCDR (tail))
+    {
+      Lisp_Object name = XCAR (XCAR (tail));
+      Lisp_Object dirinfo = XCDR (XCAR (tail));
+
+      if (NILP (dirinfo))
+	{
+	  if (fast_string_match_internal (l->regexp, name, l->case_table) >= 0)
+	    files = Fcons (concat3 (dir, slash, name), files);
+	  continue;
+	}
+
+      Lisp_Object leaf = Fsubstring (name, make_fixnum (0), make_fixnum (-1));
+      Lisp_Object full = concat3 (dir, slash, leaf);
+      if ((NILP (XCDR (dirinfo)) || l->follow_symlinks)
+	  && !match_any_regexp (l->prune, leaf, l->case_table))
+	directory_files_recursively_1 (l, full,
+				       concat3 (encoded_dir, encoded_slash,
+						XCAR (dirinfo)),
+				       false);
+      if (l->include_directories
+	  && fast_string_match_internal (l->regexp, leaf, l->case_table) >= 0)
+	l->result = Fcons (full, l->result);
+    }
+
+  /* The files of a directory come after those in its subdirectories.  */
+  l->result = nconc2 (files, l->result);
+}
+
+DEFUN ("internal-directory-files-recursively",
+       Finternal_directory_files_recursively,
+       Sinternal_directory_files_recursively, 6, 6, 0,
+       doc: /* Internal use only.
+Return the files under the local directory DIR whose names match REGEXP,
+like `directory-files-recursively' with the same arguments.  Signal an
+error if a subdirectory can't be read, unless IGNORE-UNREADABLE is
+non-nil.  Don't descend into subdirectories whose names match a regexp
+in the list PRUNE.  */)
+  (Lisp_Object dir, Lisp_Object regexp, Lisp_Object include_directories,
+   Lisp_Object ignore_unreadable, Lisp_Object follow_symlinks,
+   Lisp_Object prune)
+{
+  CHECK_STRING (regexp);
+  CHECK_LIST (prune);
+  for (Lisp_Object tail = prune; CONSP (tail); tail = XCDR (tail))
+    CHECK_STRING (XCAR (tail));
+
+  struct recursive_listing l = {
+    .regexp = regexp,
+    .prune = prune,
+    .include_directories = !NILP (include_directories),
+    .ignore_unreadable = !NILP (ignore_unreadable),
+    .follow_symlinks = !NILP (follow_symlinks),
+    .case_table = (!NILP (Vcase_fold_search)
+		   ? BVAR (current_buffer, case_canon_table) : Qnil),
+    .result = Qnil,
+  };
+  dir = Fdirectory_file_name (dir);
+  Lisp_Object encoded_dir = ENCODE_FILE (Fexpand_file_name (dir, Qnil));
+  re_match_object = Qt;
+  directory_files_recursively_1 (&l, dir, encoded_dir, true);
+  return Fnreverse (l.result);
+}
+
+/* Listing trees of files, for projects.  */
+
+/* The flags of an ignore pattern.  */
+enum
+  {
+    /* The pattern starts with "!", and includes files again.  */
+    IGNORE_NEGATE = 1,
+    /* The pattern ends in a slash, and only matches directories.  */
+    IGNORE_DIRONLY = 2,
+    /* The pattern contains a slash, and is matched against names
+       relative to the directory of its ignore file.  */
+    IGNORE_ANCHORED = 4,
+  };
+
+/* Return true if the glob pattern P of PLEN bytes matches the name S
+   of SLEN bytes, with the conventions of .gitignore files: "*" and
+   "?" don't match a slash, but "**" does, and "**" followed by a slash
+   also matches the empty string.  */
+
+static bool
+gitignore_match (unsigned char const *p, ptrdiff_t plen,
+		 unsigned char const *s, ptrdiff_t slen)
+{
+  while (0 < plen)
+    switch (*p)
+      {
+      case '*':
+	if (1 < plen && p[1] == '*')
+	  {
+	    p += 2, plen -= 2;
+	    if (0 < plen && *p == '/'
+		&& gitignore_match (p + 1, plen - 1, s, slen))
+	      return true;
+	    for (ptrdiff_t i = 0; i <= slen; i++)
+	      if (gitignore_match (p, plen, s + i, slen - i))
+		return true;
+	    return false;
+	  }
+	p++, plen--;
+	for (ptrdiff_t i = 0; ; i++)
+	  {
+	    if (gitignore_match (p, plen, s + i, slen - i))
+	      return true;
+	    if (i == slen || s[i] == '/')
+	      return false;
+	  }
+
+      case '?':
+	if (slen == 0 || *s == '/')
+	  return false;
+	p++, plen--, s++, slen--;
+	break;
+
+      case '[':
+	{
+	  ptrdiff_t i = 1;
+	  bool negate = i < plen && (p[i] == '!' || p[i] == '^');
+	  i += negate;
+	  bool matched = false;
+	  /* A "]" right after the "[" stands for itself.  */
+	  for (ptrdiff_t first = i; i < plen && (p[i] != ']' || i == first);
+	       i++)
+	    if (i + 2 < plen && p[i + 1] == '-' && p[i + 2] != ']')
+	      {
+		matched |= 0 < slen && p[i] <= *s && *s <= p[i + 2];
+		i += 2;
+	      }
+	    else
+	      matched |= 0 < slen && p[i] == *s;
+	  if (i == plen)
+	    /* No closing "]": match the "[" literally.  */
+	    goto literal;
+	  if (slen == 0 || *s == '/' || matched == negate)
+	    return false;
+	  p += i + 1, plen -= i + 1, s++, slen--;
+	}
+	break;
+
+      case '\\':
+	if (1 < plen)
+	  p++, plen--;
+	FALLTHROUGH;
+      default:
+      literal:
+	if (slen == 0 || *s != *p)
+	  return false;
+	p++, plen--, s++, slen--;
+	break;
+      }
+
+  return slen == 0;
+}
+
+/* Parse the NBYTES of TEXT, which are in the format of a .gitignore
+   file, and return a pattern set for them, or nil if there are no
+   patterns.  A pattern set is (PREFIX . PATTERNS), where PREFIX is
+   the number of bytes of the names relative to the walk's root that
+   precede the names relative to the directory of the ignore file,
+   and PATTERNS is a list of (FLAGS . PATTERN), with the last pattern
+   in TEXT first, since the last matching pattern wins.  */
+
+static Lisp_Object
+parse_gitignore (char const *text, ptrdiff_t nbytes, ptrdiff_t prefix)
+{
+  Lisp_Object patterns = Qnil;
+  char const *end = text + nbytes;
+
+  for (char const *line = text, *eol; line < end; line = eol + 1)
+    {
+      eol = memchr (line, '\n', end - line);
+      if (!eol)
+	eol = end;
+      char const *p = line, *q = eol;
+      if (p < q && q[-1] == '\r')
+	q--;
+      /* Trailing spaces are ignored, unless quoted with a backslash.  */
+      while (p < q && q[-1] == ' ' && ! (p < q - 1 && q[-2] == '\\'))
+	q--;
+      if (p == q || *p == '#')
+	continue;
+
+      int flags = 0;
+      if (*p == '!')
+	{
+	  flags |= IGNORE_NEGATE;
+	  p++;
+	}
+      if (p < q && q[-1] == '/')
+	{
+	  flags |= IGNORE_DIRONLY;
+	  q--;
+	}
+      if (memchr (p, '/', q - p))
+	{
+	  flags |= IGNORE_ANCHORED;
+	  if (p < q && *p == '/')
+	    p++;
+	}
+      if (p == q)
+	continue;
+      patterns = Fcons (Fcons (make_fixnum (flags),
+			       make_unibyte_string (p, q - p)),
+			patterns);
+    }
+
+  return NILP (patterns) ? Qnil : Fcons (make_fixnum (prefix), patterns);
+}
+
+/* State of a walk of a tree of files by directory-files-tree.  */
+
+struct tree_walk
+{
+  /* The name of the directory being walked, encoded for the file
+     system, and null-terminated.  Its first ROOTLEN bytes are the
+     name of the root of the tree; if the directory is not the root,
+     they are followed by a slash and the name of the directory
+     relative to the root.  BUF is allocated with BUFSIZE bytes.  */
+  char *buf;
+  ptrdiff_t bufsize, rootlen;
+
+  /* Whether to obey .gitignore files.  */
+  bool gitignore;
+
+  /* Whether to record STAMPS for the cache.  */
+  bool cache;
+
+  /* The names of the files found so far, relative to the root.  */
+  Lisp_Object files;
+
+  /* For the cache, a list of the encoded names of the directories
+     walked and ignore files read, each followed by the seconds and
+     nanoseconds of its modification time.  */
+  Lisp_Object stamps;
+};
+
+static void
+free_tree_walk (void *arg)
+{
+  struct tree_walk *w = arg;
+  xfree (w->buf);
+}
+
+/* Make sure that W->buf has room for NBYTES bytes.  */
+
+static void
+tree_walk_reserve (struct tree_walk *w, ptrdiff_t nbytes)
+{
+  if (w->bufsize < nbytes)
+    w->buf = xpalloc (w->buf, &w->bufsize, nbytes - w->bufsize, -1, 1);
+}
+
+/* Record in W->stamps the modification time in ST of the file whose
+   encoded name is the first NBYTES of W->buf.  */
+
+static void
+tree_walk_stamp (struct tree_walk *w, ptrdiff_t nbytes, struct stat *st)
+{
+  struct timespec mtime = get_stat_mtime (st);
+  w->stamps = Fcons (make_fixnum (mtime.tv_nsec),
+		     Fcons (INT_TO_INTEGER (mtime.tv_sec),
+			    Fcons (make_unibyte_string (w->buf, nbytes),
+				   w->stamps)));
+}
+
+/* Read the ignore file whose name follows the first DIREND bytes of
+   W->buf, and push its patterns, with PREFIX, onto the list SETS.
+   Return the new list.  */
+
+static Lisp_Object
+tree_walk_read_ignores (struct tree_walk *w, ptrdiff_t dirend,
+			char const *name, ptrdiff_t prefix, Lisp_Object sets)
+{
+  ptrdiff_t namelen = strlen (name);
+  tree_walk_reserve (w, dirend + 1 + namelen + 1);
+  w->buf[dirend] = '/';
+  strcpy (w->buf + dirend + 1, name);
+
+  int fd = emacs_open (w->buf, O_RDONLY, 0);
+  w->buf[dirend] = '\0';
+  if (fd < 0)
+    return sets;
+  struct stat st;
+  Lisp_Object text = Qnil;
+  if (fstat (fd, &st) == 0 && S_ISREG (st.st_mode)
+      && st.st_size <= STRING_BYTES_BOUND)
+    {
+      text = make_uninit_string (st.st_size);
+      ptrdiff_t nread = emacs_read (fd, SSDATA (text), st.st_size);
+      if (nread < 0)
+	text = Qnil;
+      else
+	{
+	  text = Fsubstring (text, make_fixnum (0), make_fixnum (nread));
+	  if (w->cache)
+	    {
+	      w->buf[dirend] = '/';
+	      tree_walk_stamp (w, dirend + 1 + namelen, &st);
+	      w->buf[dirend] = '\0';
+	    }
+	}
+    }
+  emacs_close (fd);
+
+  if (NILP (text))
+    return sets;
+  Lisp_Object set = parse_gitignore (SSDATA (text), SBYTES (text), prefix);
+  return NILP (set) ? sets : Fcons (set, sets);
+}
+
+/* Return true if the name REL of RELLEN bytes, relative to the root of
+   the walk, is ignored by the pattern sets SETS.  DIRP says whether it
+   names a directory.  */
+
+static bool
+tree_walk_ignored_p (Lisp_Object sets, char const *rel, ptrdiff_t rellen,
+		     bool dirp)
+{
+  char const *slash = memrchr (rel, '/', rellen);
+  char const *base = slash ? slash + 1 : rel;
+  ptrdiff_t baselen = rel + rellen - base;
+
+  for (; CONSP (sets); sets = XCDR (sets))
+    {
+      ptrdiff_t prefix = XFIXNUM (XCAR (XCAR (sets)));
+      for (Lisp_Object tail = XCDR (XCAR (sets)); CONSP (tail);
+	   tail = XCDR (tail))
+	{
+	  int flags = XFIXNUM (XCAR (XCAR (tail)));
+	  Lisp_Object pattern = XCDR (XCAR (tail));
+	  if ((flags & IGNORE_DIRONLY) && !dirp)
+	    continue;
+	  bool match
+	    = ((flags & IGNORE_ANCHORED)
+	       ? gitignore_match (SDATA (pattern), SBYTES (pattern),
+				  (unsigned char const *) rel + prefix,
+				  rellen - prefix)
+	       : gitignore_match (SDATA (pattern), SBYTES (pattern),
+				  (unsigned char const *) base, baselen));
+	  if (match)
+	    return ! (flags & IGNORE_NEGATE);
+	}
+    }
+
+  return false;
+}
+
+/* Add the regular files in the directory whose name relative to the
+   root of the walk W has RELLEN bytes to W->files, obeying the pattern
+   sets SETS, and recurse into its subdirectories.  */
+
+static void
+tree_walk_directory (struct tree_walk *w, ptrdiff_t rellen, Lisp_Object sets)
+{
+  ptrdiff_t dirend = rellen ? w->rootlen + 1 + rellen : w->rootlen;
+  if (rellen)
+    w->buf[w->rootlen] = '/';
+  w->buf[dirend] = '\0';
+
+  int fd = emacs_open (w->buf, O_RDONLY | O_DIRECTORY, 0);
+  if (fd < 0)
+    {
+      if (rellen == 0)
+	report_file_error ("Opening directory",
+			   DECODE_FILE (make_unibyte_string (w->buf, dirend)));
+      /* Ignore unreadable subdirectories, like Git does.  */
+      return;
+    }
+  emacs_dir *d = fdopendir (fd);
+  if (!d)
+    {
+      emacs_close (fd);
+      return;
+    }
+  specpdl_ref count = SPECPDL_INDEX ();
+  record_unwind_protect_ptr (directory_files_internal_unwind, d);
+
+  struct stat st;
+  if (w->cache && fstat (fd, &st) == 0)
+    tree_walk_stamp (w, dirend, &st);
+
+  if (w->gitignore)
+    sets = tree_walk_read_ignores (w, dirend, ".gitignore",
+				   rellen ? rellen + 1 : 0, sets);
+
+  Lisp_Object subdirs = Qnil;
+  Lisp_Object dirname = Qnil;
+  for (struct dirent *dp; ; )
+    {
+      errno = 0;
+      dp = emacs_readdir (d);
+      if (!dp)
+	{
+	  if (errno == EAGAIN || errno == EINTR)
+	    {
+	      maybe_quit ();
+	      continue;
+	    }
+	  break;
+	}
+
+      ptrdiff_t len = dirent_namelen (dp);
+      if (dp->d_name[0] == '.'
+	  && (len == 1 || (len == 2 && dp->d_name[1] == '.')))
+	continue;
+
+      int type = dirent_type (dp);
+      if (type == DT_UNKNOWN)
+	{
+	  if (fstatat (fd, dp->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+	    continue;
+	  type = (S_ISDIR (st.st_mode) ? DT_DIR
+		  : S_ISREG (st.st_mode) ? DT_REG : DT_UNKNOWN);
+	}
+      bool dirp = type == DT_DIR;
+      if (! (dirp || type == DT_REG)
+	  || (dirp && w->gitignore && len == 4
+	      && memcmp (dp->d_name, ".git", 4) == 0))
+	continue;
+
+      ptrdiff_t sublen = (rellen ? rellen + 1 : 0) + len;
+      tree_walk_reserve (w, w->rootlen + 1 + sublen + 1);
+      char *rel = w->buf + w->rootlen + 1;
+      if (rellen)
+	rel[rellen] = '/';
+      memcpy (rel + sublen - len, dp->d_name, len);
+      if (tree_walk_ignored_p (sets, rel, sublen, dirp))
+	continue;
+
+      if (dirp)
+	subdirs = Fcons (make_unibyte_string (dp->d_name, len), subdirs);
+      else
+	{
+	  /* This can GC.  */
+	  Lisp_Object name = DECODE_FILE (make_unibyte_string (rel, sublen));
+	  w->files = Fcons (name, w->files);
+	}
+      maybe_quit ();
+    }
+  if (errno != 0)
+    {
+      dirname = DECODE_FILE (make_unibyte_string (w->buf, dirend));
+      report_file_error ("Reading directory", dirname);
+    }
+  emacs_closedir (d);
+  specpdl_ptr = specpdl_ref_to_ptr (count);
+
+  for (; CONSP (subdirs); subdirs = XCDR (subdirs))
+    {
+      Lisp_Object name = XCAR (subdirs);
+      ptrdiff_t sublen = (rellen ? rellen + 1 : 0) + SBYTES (name);
+      tree_walk_reserve (w, w->rootlen + 1 + sublen + 1);
+      char *rel = w->buf + w->rootlen + 1;
+      if (rellen)
+	rel[rellen] = '/';
+      memcpy (rel + sublen - SBYTES (name), SDATA (name), SBYTES (name));
+      tree_walk_directory (w, sublen, sets);
+    }
+}
+
+/* The cache of directory-files-tree.  A hash table whose keys are the
+   lists of its arguments, and whose values are (FILES . STAMPS), where
+   STAMPS is a vector of the encoded names of the directories and
+   ignore files that were read, each followed by the seconds and
+   nanoseconds of its modification time.  */
+static Lisp_Object directory_files_tree_cache;
+
+/* Return true if none of the files in the vector STAMPS has changed
+   its modification time.  */
+
+static bool
+tree_stamps_valid_p (Lisp_Object stamps)
+{
+  for (ptrdiff_t i = 0; i + 2 < ASIZE (stamps); i += 3)
+    {
+      struct stat st;
+      if (emacs_fstatat (AT_FDCWD, SSDATA (AREF (stamps, i)), &st, 0) != 0)
+	return false;
+      struct timespec mtime = get_stat_mtime (&st);
+      if (! (EQ (INT_TO_INTEGER (mtime.tv_sec), AREF (stamps, i + 1))
+	     && EQ (make_fixnum (mtime.tv_nsec), AREF (stamps, i + 2))))
+	return false;
+    }
+  return true;
+}
+
+DEFUN ("directory-files-tree", Fdirectory_files_tree, Sdirectory_files_tree,
+       1, 4, 0,
+       doc: /* Return a vector of the regular files under DIRECTORY.
+The file names are relative to DIRECTORY, and sorted with `string<'.
+Subdirectories are searched recursively, except for unreadable ones and
+symbolic links to directories.
+
+IGNORES is a list of patterns in the syntax of .gitignore files.  Files
+and subdirectories that match any of them are left out.  A pattern that
+contains a slash, other than at its end, is matched against file names
+relative to DIRECTORY, and other patterns against the last component of
+file names.  A pattern that ends in a slash only matches directories,
+and a pattern that starts with "!" includes matching files again.  In
+patterns, "*" and "?" don't match a slash, but "**" does.
+
+If GITIGNORE is non-nil, also obey the .gitignore files in DIRECTORY
+and its subdirectories, and DIRECTORY/.git/info/exclude, and leave out
+.git directories, as Git does.  Patterns in these files take precedence
+over IGNORES.
+
+If CACHE is non-nil, remember the result, and return it again from
+later calls with the same arguments if none of the directories searched
+and ignore files read has changed its modification time since.  This
+is much faster than searching the tree again.  */)
+  (Lisp_Object directory, Lisp_Object ignores, Lisp_Object gitignore,
+   Lisp_Object cache)
+{
+  directory = Fexpand_file_name (directory, Qnil);
+
+  /* If the file name has special constructs in it,
+     call the corresponding file name handler.  */
+  Lisp_Object handler = Ffind_file_name_handler (directory,
+						 Qdirectory_files_tree);
+  if (!NILP (handler))
+    return calln (handler, Qdirectory_files_tree, directory, ignores,
+		  gitignore, cache);
+
+  CHECK_LIST (ignores);
+  Lisp_Object key = Qnil;
+  if (!NILP (cache))
+    {
+      key = list3 (directory, Fcopy_sequence (ignores),
+		   NILP (gitignore) ? Qnil : Qt);
+      if (NILP (directory_files_tree_cache))
+	directory_files_tree_cache
+	  = make_hash_table (&hashtest_equal, DEFAULT_HASH_SIZE, Weak_None);
+      Lisp_Object cached = Fgethash (key, directory_files_tree_cache, Qnil);
+      if (CONSP (cached) && tree_stamps_valid_p (XCDR (cached)))
+	return Fcopy_sequence (XCAR (cached));
+    }
+
+  struct tree_walk w = {
+    .gitignore = !NILP (gitignore),
+    .cache = !NILP (cache),
+    .files = Qnil,
+    .stamps = Qnil,
+  };
+  Lisp_Object encoded_root = ENCODE_FILE (Fdirectory_file_name (directory));
+  w.rootlen = SBYTES (encoded_root);
+  specpdl_ref count = SPECPDL_INDEX ();
+  record_unwind_protect_ptr (free_tree_walk, &w);
+  tree_walk_reserve (&w, w.rootlen + 1);
+  memcpy (w.buf, SSDATA (encoded_root), w.rootlen);
+
+  /* The pattern sets, innermost first.  IGNORES take precedence over
+     nothing, and .git/info/exclude only over IGNORES.  */
+  Lisp_Object sets = Qnil;
+  if (!NILP (ignores))
+    {
+      Lisp_Object text = Qnil;
+      for (Lisp_Object tail = ignores; CONSP (tail); tail = XCDR (tail))
+	{
+	  CHECK_STRING (XCAR (tail));
+	  text = concat3 (text, ENCODE_FILE (XCAR (tail)),
+			  build_unibyte_string ("\n"));
+	}
+      Lisp_Object set = parse_gitignore (SSDATA (text), SBYTES (text), 0);
+      if (!NILP (set))
+	sets = list1 (set);
+    }
+  if (w.gitignore)
+    sets = tree_walk_read_ignores (&w, w.rootlen, ".git/info/exclude", 0,
+				   sets);
+
+  tree_walk_directory (&w, 0, sets);
+  Lisp_Object files = Fvconcat (1, &w.files);
+  files = CALLN (Fsort, files, QClessp, Qstring_lessp, QCin_place, Qt);
+
+  if (!NILP (cache))
+    Fputhash (key, Fcons (files, Fvconcat (1, (Lisp_Object []) {
+			    Fnreverse (w.stamps) })),
+	      directory_files_tree_cache);
+
+  unbind_to (count, Qnil);
+  return NILP (cache) ? files : Fcopy_sequence (files);
+}
+
 
 static Lisp_Object file_name_completion (Lisp_Object, Lisp_Object, bool,
 					 Lisp_Object);
@@ -1018,9 +1725,19 @@ DEFUN ("file-attributes", Ffile_attributes, Sfile_attributes, 1, 2, 0,
 	return calln (handler, Qfile_attributes, filename, id_format);
     }
 
+  enum file_attribute_cache_slot slot
+    = (NILP (id_format) || EQ (id_format, Qinteger)
+       ? FILE_ATTRIBUTE_CACHE_ATTRIBUTES
+       : FILE_ATTRIBUTE_CACHE_ATTRIBUTES_STRING);
+  Lisp_Object attributes;
+  if (file_attribute_cache_lookup (filename, slot, &attributes))
+    return Fcopy_sequence (attributes);
+
   encoded = ENCODE_FILE (filename);
-  return file_attributes (AT_FDCWD, SSDATA (encoded), Qnil, filename,
-			  id_format);
+  attributes = file_attributes (AT_FDCWD, SSDATA (encoded), Qnil, filename,
+				id_format);
+  file_attribute_cache_store (filename, slot, attributes);
+  return attributes;
 }
 
 static Lisp_Object
@@ -1196,6 +1913,11 @@ syms_of_dired (void)
 
   defsubr (&Sdirectory_files);
   defsubr (&Sdirectory_files_and_attributes);
+  defsubr (&Sinternal_directory_files_recursively);
+  defsubr (&Sdirectory_files_tree);
+  DEFSYM (Qdirectory_files_tree, "directory-files-tree");
+  staticpro (&directory_files_tree_cache);
+  directory_files_tree_cache = Qnil;
   defsubr (&Sfile_name_completion);
   defsubr (&Sfile_name_all_completions);
   defsubr (&Sfile_attributes);
@@ -3257,6 +3257,11 @@ reset_mouse_highlight (Mouse_HLInfo *hlinfo)
   /* Width and height of the image.  */
   int width, height;
 
+  /* If the decoder shrank the image because it is displayed smaller,
+     the width and height of the image in its file, which are what
+     properties like `:scale' refer to.  Otherwise zero.  */
+  int native_width, native_height;
+
   /* The scale factor applied to the image.  */
   double scale;
 
@@ -3301,6 +3306,10 @@ #define CENTERED_IMAGE_ASCENT -1
   /* True means that loading the image failed.  Don't try again.  */
   bool load_failed_p;
 
+  /* True means that redisplay deferred decoding the image, and shows
+     a rectangle of the placeholder size for it meanwhile.  */
+  bool decode_deferred_p;
+
   /* A place for image types to store additional data.  It is marked
      during GC.  */
   Lisp_Object lisp_data;
@@ -3503,6 +3512,10 @@ #define DEFAULT_TOOL_BAR_IMAGE_HEIGHT 24
 extern void bidi_init_it (ptrdiff_t, ptrdiff_t, bool, struct bidi_it *);
 extern void bidi_move_to_visually_next (struct bidi_it *);
 extern void bidi_paragraph_init (bidi_dir_t, struct bidi_it *, bool);
+extern void bidi_forget_buffer_paragraphs (struct buffer *);
+extern ptrdiff_t bidi_resume_from_checkpoint (struct bidi_it *, ptrdiff_t,
+					     ptrdiff_t);
+extern ptrdiff_t bidi_record_checkpoint (struct bidi_it *, ptrdiff_t);
 extern int  bidi_mirror_char (int);
 extern void bidi_push_it (struct bidi_it *);
 extern void bidi_pop_it (struct bidi_it *);
@@ -3556,6 +3569,10 @@ #define DEFAULT_TOOL_BAR_IMAGE_HEIGHT 24
 			      ptrdiff_t to_charpos, int to_x,
 			      enum move_operation_enum op);
 int partial_line_height (struct it *it_origin);
+void invalidate_line_height_caches (void);
+void free_line_height_cache (struct buffer *);
+struct line_height_cache;
+void mark_line_height_cache (struct line_height_cache *);
 bool in_display_vector_p (struct it *);
 int frame_mode_line_height (struct frame *);
 extern bool redisplaying_p;
@@ -3701,6 +3718,8 @@ #define TRY_WINDOW_IGNORE_FONTS_CHANGE	(1 << 1)
 bool valid_image_p (Lisp_Object);
 void prepare_image_for_display (struct frame *, struct image *);
 ptrdiff_t lookup_image (struct frame *, Lisp_Object, int);
+void image_start_redisplay_cycle (void);
+bool image_caches_over_budget_p (void);
 Lisp_Object image_spec_value (Lisp_Object, Lisp_Object, bool *);
 
 #if defined HAVE_X_WINDOWS || defined USE_CAIRO || defined HAVE_NS \
@@ -3765,6 +3784,7 @@ #define RGB_PIXEL_COLOR COLORREF
 void init_frame_faces (struct frame *);
 void free_frame_faces (struct frame *);
 void recompute_basic_faces (struct frame *);
+ptrdiff_t next_face_range_change (struct window *, ptrdiff_t);
 int face_at_buffer_position (struct window *, ptrdiff_t, ptrdiff_t *,
                              ptrdiff_t, bool, int, enum lface_attribute_index);
 int face_for_overlay_string (struct window *, ptrdiff_t, ptrdiff_t *, ptrdiff_t,
@@ -3859,6 +3879,7 @@ #define IMAGE_BACKGROUND_TRANSPARENT(img, f, mask)			      \
 void clear_glyph_matrix_rows (struct glyph_matrix *, int, int);
 void clear_glyph_row (struct glyph_row *);
 void prepare_desired_row (struct window *, struct glyph_row *, bool);
+void copy_glyph_row (struct glyph_row *, struct glyph_row *);
 void update_single_window (struct window *);
 #ifdef HAVE_WINDOW_SYSTEM
 extern void gui_update_window_begin (struct window *);
@@ -1057,6 +1057,26 @@ assign_row (struct glyph_row *to, struct glyph_row *from)
 }
 
 
+/* Copy glyph row FROM to glyph row TO, glyphs included.  Unlike
+   assign_row, this leaves the glyph memory of FROM alone, so FROM can
+   stay where it is.  TO must have room for the glyphs of FROM in each
+   area.  */
+
+void
+copy_glyph_row (struct glyph_row *to, struct glyph_row *from)
+{
+  for (int area = LEFT_MARGIN_AREA; area < LAST_AREA; ++area)
+    {
+      eassert (to->glyphs[area] + from->used[area] <= to->glyphs[LAST_AREA]);
+      memcpy (to->glyphs[area], from->glyphs[area],
+	      from->used[area] * sizeof (struct glyph));
+      to->used[area] = from->used[area];
+    }
+  to->hash = from->hash;
+  copy_row_except_pointers (to, from);
+}
+
+
 /* Test whether the glyph memory of the glyph row WINDOW_ROW, which is
    a row in a window matrix, is a slice of the glyph memory of the
    glyph row FRAME_ROW which is a row in a frame glyph matrix.  Value
@@ -3875,6 +3895,7 @@ update_initial_frame (struct frame *f)
 static void
 flush_terminal (struct frame *f)
 {
+  tty_finish_update (FRAME_TTY (f));
   if (FRAME_TTY (f)->termscript)
     fflush (FRAME_TTY (f)->termscript);
   fflush (FRAME_TTY (f)->output);
@@ -5179,6 +5200,23 @@ set_window_update_flags (struct window *w, bool on_p)
 static struct row_entry **old_lines, **new_lines;
 static ptrdiff_t old_lines_size, new_lines_size;
 
+/* Vectors saying which rows of the current and desired matrix are
+   already part of a run, and so can't be part of another.  They have
+   the sizes of old_lines and new_lines.  */
+
+static bool *old_lines_used, *new_lines_used;
+
+/* The table of lengths of common subsequences used by
+   scrolling_window_lcs, and its size.  */
+
+static int *lcs_table;
+static ptrdiff_t lcs_table_size;
+
+/* Don't look for a longest common subsequence of more than this many
+   pairs of rows; use only the unique rows as anchors in that case.  */
+
+enum { SCROLLING_LCS_MAX_CELLS = 1 << 17 };
+
 /* A pool to allocate run structures from, and its size.  */
 
 static struct run *run_pool;
@@ -5215,6 +5253,132 @@ add_row_entry (struct glyph_row *row)
   return entry;
 }
 
+/* Insert RUN into the first NRUNS elements of runs, which are ordered
+   by decreasing height.  */
+
+static void
+insert_run (struct run *run, int nruns)
+{
+  int p, q;
+
+  for (p = 0; p < nruns && runs[p]->height > run->height; ++p)
+    ;
+  for (q = nruns; q > p; --q)
+    runs[q] = runs[q - 1];
+  runs[p] = run;
+}
+
+/* Add to runs the runs of rows that have the same order in rows
+   FIRST_OLD to LAST_OLD - 1 of the current matrix of W and rows
+   FIRST_NEW to LAST_NEW - 1 of its desired matrix, along a longest
+   common subsequence of them.  Unlike unique anchor rows, this finds
+   every region that scrolled, by whatever amount, even if all of its
+   rows also appear elsewhere.  NRUNS is the number of runs recorded
+   so far, and *RUN_IDX the index of the next free element of
+   run_pool.  Value is the new number of runs, or -1 if the matrices
+   are too large to compare this way.  */
+
+static int
+scrolling_window_lcs (struct window *w, int first_old, int last_old,
+		      int first_new, int last_new, int nruns,
+		      int *run_idx)
+{
+  struct glyph_matrix *desired_matrix = w->desired_matrix;
+  struct glyph_matrix *current_matrix = w->current_matrix;
+  ptrdiff_t nold = last_old - first_old, nnew = last_new - first_new;
+  ptrdiff_t width = nnew + 1;
+  ptrdiff_t p, q;
+  struct run *run = NULL;
+
+  if ((nold + 1) * width > SCROLLING_LCS_MAX_CELLS)
+    return -1;
+
+  if ((nold + 1) * width > lcs_table_size)
+    lcs_table = xpalloc (lcs_table, &lcs_table_size,
+			 (nold + 1) * width - lcs_table_size,
+			 -1, sizeof *lcs_table);
+
+#define LCS(P, Q) lcs_table[(P) * width + (Q)]
+
+  for (q = 0; q <= nnew; ++q)
+    LCS (nold, q) = 0;
+  for (p = nold - 1; p >= 0; --p)
+    {
+      struct row_entry *entry = old_lines[first_old + p];
+
+      LCS (p, nnew) = 0;
+      for (q = nnew - 1; q >= 0; --q)
+	LCS (p, q) = (entry && entry == new_lines[first_new + q]
+		      ? LCS (p + 1, q + 1) + 1
+		      : max (LCS (p + 1, q), LCS (p, q + 1)));
+    }
+
+  /* Walk along the subsequence, and make a run of each stretch of
+     rows that are consecutive in both matrices.  */
+  for (p = q = 0; p <= nold && q <= nnew; )
+    {
+      int i = first_old + p, j = first_new + q;
+      bool match_p = (p < nold && q < nnew && old_lines[i]
+		      && old_lines[i] == new_lines[j]);
+
+      if (run && !(match_p
+		   && run->current_vpos + run->nrows == i
+		   && run->desired_vpos + run->nrows == j))
+	{
+	  /* The run ends here.  Copying a single row that isn't
+	     unique, like an empty line, isn't worth the trouble.  */
+	  struct row_entry *entry = old_lines[run->current_vpos];
+
+	  if (run->current_y == run->desired_y
+	      || run->nrows > 1
+	      || (entry->old_uses == 1 && entry->new_uses == 1))
+	    {
+	      for (int k = 0; k < run->nrows; ++k)
+		{
+		  old_lines_used[run->current_vpos + k] = true;
+		  new_lines_used[run->desired_vpos + k] = true;
+		}
+	      insert_run (run, nruns++);
+	    }
+	  else
+	    --*run_idx;
+	  run = NULL;
+	}
+
+      if (match_p)
+	{
+	  int h = MATRIX_ROW (current_matrix, i)->height;
+
+	  if (run)
+	    {
+	      ++run->nrows;
+	      run->height += h;
+	    }
+	  else
+	    {
+	      run = run_pool + (*run_idx)++;
+	      run->current_vpos = i;
+	      run->current_y = MATRIX_ROW (current_matrix, i)->y;
+	      run->desired_vpos = j;
+	      run->desired_y = MATRIX_ROW (desired_matrix, j)->y;
+	      run->nrows = 1;
+	      run->height = h;
+	    }
+	  ++p, ++q;
+	}
+      else if (p == nold || q == nnew)
+	break;
+      else if (LCS (p + 1, q) >= LCS (p, q + 1))
+	++p;
+      else
+	++q;
+    }
+
+#undef LCS
+
+  return nruns;
+}
+
 /* Try to reuse part of the current display of W by scrolling lines.
    HEADER_LINE_P means W has a header line.
 
@@ -5229,10 +5393,14 @@ add_row_entry (struct glyph_row *row)
    2. Enter rows in the current and desired matrix into a symbol
    table, counting how often they appear in both matrices.
 
-   3. Rows that appear exactly once in both matrices serve as anchors,
-   i.e. we assume that such lines are likely to have been moved.
+   3. Find the runs of rows along a longest common subsequence of
+   both matrices; see scrolling_window_lcs.
+
+   4. Rows that appear exactly once in both matrices and aren't part
+   of a run yet serve as anchors, i.e. we assume that such lines are
+   likely to have been moved, possibly past other rows.
 
-   4. Starting from anchor lines, extend regions to be scrolled both
+   5. Starting from anchor lines, extend regions to be scrolled both
    forward and backward.
 
    Value is
@@ -5385,14 +5553,22 @@ scrolling_window (struct window *w, int tab_line_p)
   /* Reallocate vectors, tables etc. if necessary.  */
 
   if (current_matrix->nrows > old_lines_size)
-    old_lines = xpalloc (old_lines, &old_lines_size,
-			 current_matrix->nrows - old_lines_size,
-			 INT_MAX, sizeof *old_lines);
+    {
+      old_lines = xpalloc (old_lines, &old_lines_size,
+			   current_matrix->nrows - old_lines_size,
+			   INT_MAX, sizeof *old_lines);
+      old_lines_used = xnrealloc (old_lines_used, old_lines_size,
+				  sizeof *old_lines_used);
+    }
 
   if (desired_matrix->nrows > new_lines_size)
-    new_lines = xpalloc (new_lines, &new_lines_size,
-			 desired_matrix->nrows - new_lines_size,
-			 INT_MAX, sizeof *new_lines);
+    {
+      new_lines = xpalloc (new_lines, &new_lines_size,
+			   desired_matrix->nrows - new_lines_size,
+			   INT_MAX, sizeof *new_lines);
+      new_lines_used = xnrealloc (new_lines_used, new_lines_size,
+				  sizeof *new_lines_used);
+    }
 
   n = desired_matrix->nrows;
   n += current_matrix->nrows;
@@ -5432,6 +5608,7 @@ scrolling_window (struct window *w, int tab_line_p)
 	}
       else
 	old_lines[i] = NULL;
+      old_lines_used[i] = false;
     }
 
   for (i = first_new; i < last_new; ++i)
@@ -5441,14 +5618,23 @@ scrolling_window (struct window *w, int tab_line_p)
       ++entry->new_uses;
       entry->new_line_number = i;
       new_lines[i] = entry;
+      new_lines_used[i] = false;
     }
 
+  /* Identify the regions that scrolled.  */
+  nruns = scrolling_window_lcs (w, first_old, last_old, first_new, last_new,
+				nruns, &run_idx);
+  if (nruns < 0)
+    nruns = 0;
+
   /* Identify moves based on lines that are unique and equal
      in both matrices.  */
   for (i = first_old; i < last_old;)
     if (old_lines[i]
 	&& old_lines[i]->old_uses == 1
-        && old_lines[i]->new_uses == 1)
+        && old_lines[i]->new_uses == 1
+	&& !old_lines_used[i]
+	&& !new_lines_used[old_lines[i]->new_line_number])
       {
 	int p, q;
 	int new_line = old_lines[i]->new_line_number;
@@ -5467,7 +5653,8 @@ scrolling_window (struct window *w, int tab_line_p)
 	q = new_line - 1;
 	while (p > first_old
 	       && q > first_new
-	       && old_lines[p] == new_lines[q])
+	       && old_lines[p] == new_lines[q]
+	       && !old_lines_used[p] && !new_lines_used[q])
 	  {
 	    int h = MATRIX_ROW (current_matrix, p)->height;
 	    --run->current_vpos;
@@ -5484,7 +5671,8 @@ scrolling_window (struct window *w, int tab_line_p)
 	q = new_line + 1;
 	while (p < last_old
 	       && q < last_new
-	       && old_lines[p] == new_lines[q])
+	       && old_lines[p] == new_lines[q]
+	       && !old_lines_used[p] && !new_lines_used[q])
 	  {
 	    int h = MATRIX_ROW (current_matrix, p)->height;
 	    ++run->nrows;
@@ -5497,12 +5685,12 @@ scrolling_window (struct window *w, int tab_line_p)
 	   be copied because they are already in place.  This is done
 	   because we can avoid calling update_window_line in this
 	   case.  */
-	for (p = 0; p < nruns && runs[p]->height > run->height; ++p)
-	  ;
-	for (q = nruns; q > p; --q)
-	  runs[q] = runs[q - 1];
-	runs[p] = run;
-	++nruns;
+	for (p = 0; p < run->nrows; ++p)
+	  {
+	    old_lines_used[run->current_vpos + p] = true;
+	    new_lines_used[run->desired_vpos + p] = true;
+	  }
+	insert_run (run, nruns++);
 
 	i += run->nrows;
       }
@@ -7537,6 +7725,13 @@ syms_of_display (void)
 Possible values are t (below the tool bar), nil (above the tool bar).
 This option affects only builds where the tool bar is not external.  */);
 
+  DEFVAR_INT ("redisplay-glyphs-written", redisplay_glyphs_written,
+	      doc: /* Number of glyphs written to the display by redisplay so far.
+This counts the glyphs that frame updates wrote or inserted, on any
+kind of terminal.  To find out how much an update redrew, compare the
+values before and after that update.  */);
+  redisplay_glyphs_written = 0;
+
   pdumper_do_now_and_after_load (syms_of_display_for_pdumper);
 
   Fprovide (intern_c_string ("tty-child-frames"), Qnil);
@@ -74,6 +74,23 @@ #define USE_ANDROID_ASSETS
 static char *get_doc_string_buffer;
 static ptrdiff_t get_doc_string_buffer_size;
 
+/* The contents of the DOC file, read in full the first time a doc
+   string is looked up there, and the name they were read from, or
+   NULL if they are not valid.  */
+static char *doc_file_contents;
+static ptrdiff_t doc_file_size;
+static char *doc_file_contents_name;
+
+/* Recently fetched doc strings of byte-compiled files, most recently
+   used first, as an alist of (FILEPOS . STRING).  FILEPOS is the
+   object that get_doc_string was given and is compared with `eq', so
+   that reloading a file does not find the doc strings of its old
+   version.  */
+static Lisp_Object doc_string_cache;
+
+/* The maximum length of doc_string_cache.  */
+enum { DOC_STRING_CACHE_SIZE = 64 };
+
 static char const sibling_etc[] = "../etc/";
 
 #ifdef USE_ANDROID_ASSETS
@@ -92,6 +109,37 @@ close_file_unwind_android_fd (void *ptr)
 
 #endif /* USE_ANDROID_ASSETS */
 
+/* Read the whole DOC file from FD, which was opened as NAME from
+   FILE, into doc_file_contents.  */
+
+static void
+read_doc_file_contents (doc_fd fd, char const *name, Lisp_Object file)
+{
+  /* Invalidate the old contents first, in case the user quits.  */
+  xfree (doc_file_contents_name);
+  doc_file_contents_name = NULL;
+  doc_file_size = 0;
+
+  ptrdiff_t alloc = 0;
+  xfree (doc_file_contents);
+  doc_file_contents = NULL;
+  while (true)
+    {
+      if (alloc - doc_file_size < 16 * 1024)
+	doc_file_contents = xpalloc (doc_file_contents, &alloc, 16 * 1024,
+				     -1, 1);
+      ptrdiff_t nread = doc_read_quit (fd, doc_file_contents + doc_file_size,
+				       min (alloc - doc_file_size,
+					    1024 * 1024));
+      if (nread < 0)
+	report_file_error ("Read error on documentation file", file);
+      if (!nread)
+	break;
+      doc_file_size += nread;
+    }
+  doc_file_contents_name = xstrdup (name);
+}
+
 /* Extract a doc string from a file.  FILEPOS says where to get it.
    If it is an integer, use that position in the standard DOC file.
    If it is (FILE . INTEGER), use FILE as the file name
@@ -127,6 +175,18 @@ get_doc_string (Lisp_Object filepos, bool unibyte)
   else
     return Qnil;
 
+  if (CONSP (filepos) && !unibyte)
+    {
+      Lisp_Object cached = Fassq (filepos, doc_string_cache);
+      if (!NILP (cached))
+	{
+	  if (!EQ (cached, XCAR (doc_string_cache)))
+	    doc_string_cache = Fcons (cached,
+				      Fdelq (cached, doc_string_cache));
+	  return XCDR (cached);
+	}
+    }
+
   /* We used to emit negative positions for 'user variables' (whose doc
      strings started with an asterisk); take the absolute value for
      compatibility with bytecode from Emacs <29.  */
@@ -151,6 +211,12 @@ get_doc_string (Lisp_Object filepos, bool unibyte)
   name = SAFE_ALLOCA (docdir_sizemax + SBYTES (file));
   lispstpcpy (lispstpcpy (name, docdir), file);
 
+  /* Keep the DOC file in memory, as most doc strings are there.  */
+  bool in_memory = FIXNUMP (filepos) && !will_dump_p ();
+  if (in_memory && doc_file_contents_name
+      && strcmp (name, doc_file_contents_name) == 0)
+    goto read_from_memory;
+
   doc_fd fd = doc_open (name, O_RDONLY, 0);
   if (!doc_fd_p (fd))
     {
@@ -179,10 +245,37 @@ get_doc_string (Lisp_Object filepos, bool unibyte)
   record_unwind_protect_ptr (close_file_unwind_android_fd, &fd);
 #endif /* !USE_ANDROID_ASSETS */
 
-  /* Seek only to beginning of disk block.  */
+  if (in_memory)
+    read_doc_file_contents (fd, name, file);
+
+ read_from_memory:;
   /* Make sure we read at least 1024 bytes before `position'
      so we can check the leading text for consistency.  */
   int offset = min (position, max (1024, position % (8 * 1024)));
+  if (in_memory)
+    {
+      if (doc_file_size < position)
+	error ("Position %"pI"d out of range in doc string file \"%s\"",
+	       position, name);
+      char *start = doc_file_contents + position - offset;
+      char *end = memchr (doc_file_contents + position, '\037',
+			  doc_file_size - position);
+      ptrdiff_t len = (end ? end : doc_file_contents + doc_file_size) - start;
+      /* Grow the buffer at least as much as the loop below does,
+	 which needs room for OFFSET bytes at the first read.  */
+      if (get_doc_string_buffer_size <= len)
+	get_doc_string_buffer
+	  = xpalloc (get_doc_string_buffer, &get_doc_string_buffer_size,
+		     max (16 * 1024, len + 1 - get_doc_string_buffer_size),
+		     -1, 1);
+      memcpy (get_doc_string_buffer, start, len);
+      p = get_doc_string_buffer + len;
+      *p = 0;
+      SAFE_FREE_UNBIND_TO (count, Qnil);
+      goto check;
+    }
+
+  /* Seek only to beginning of disk block.  */
   if (TYPE_MAXIMUM (off_t) < position
       || doc_lseek (fd, position - offset, 0) < 0)
     error ("Position %"pI"d out of range in doc string file \"%s\"",
@@ -233,6 +326,7 @@ get_doc_string (Lisp_Object filepos, bool unibyte)
     }
   SAFE_FREE_UNBIND_TO (count, Qnil);
 
+ check:
   /* Sanity checking.  */
   if (CONSP (filepos))
     {
@@ -294,17 +388,24 @@ get_doc_string (Lisp_Object filepos, bool unibyte)
   if (unibyte)
     return make_unibyte_string (get_doc_string_buffer + offset,
 				to - (get_doc_string_buffer + offset));
-  else
+
+  /* The data determines whether the string is multibyte.  */
+  ptrdiff_t nchars
+    = multibyte_chars_in_text (((unsigned char *) get_doc_string_buffer
+				+ offset),
+			       to - (get_doc_string_buffer + offset));
+  Lisp_Object doc
+    = make_string_from_bytes (get_doc_string_buffer + offset, nchars,
+			      to - (get_doc_string_buffer + offset));
+  if (CONSP (filepos))
     {
-      /* The data determines whether the string is multibyte.  */
-      ptrdiff_t nchars
-	= multibyte_chars_in_text (((unsigned char *) get_doc_string_buffer
-				    + offset),
-				   to - (get_doc_string_buffer + offset));
-      return make_string_from_bytes (get_doc_string_buffer + offset,
-				     nchars,
-				     to - (get_doc_string_buffer + offset));
+      doc_string_cache = Fcons (Fcons (filepos, doc), doc_string_cache);
+      Lisp_Object last = Fnthcdr (make_fixnum (DOC_STRING_CACHE_SIZE - 1),
+				  doc_string_cache);
+      if (CONSP (last))
+	XSETCDR (last, Qnil);
     }
+  return doc;
 }
 
 static void
@@ -551,6 +652,10 @@ DEFUN ("Snarf-documentation", Fsnarf_documentation, Ssnarf_documentation,
 	Vbuild_files = Fcons (build_string (buildobj[i]), Vbuild_files);
     }
 
+  /* The DOC file will be read anew by get_doc_string.  */
+  xfree (doc_file_contents_name);
+  doc_file_contents_name = NULL;
+
   doc_fd fd = doc_open (name, O_RDONLY, 0);
   if (!doc_fd_p (fd))
     {
@@ -688,6 +793,9 @@ syms_of_doc (void)
   DEFSYM (Qstraight, "straight");
   DEFSYM (Qcurve, "curve");
 
+  staticpro (&doc_string_cache);
+  doc_string_cache = Qnil;
+
   DEFVAR_LISP ("internal-doc-file-name", Vdoc_file_name,
 	       doc: /* Name of file containing documentation strings of built-in symbols.  */);
   Vdoc_file_name = Qnil;
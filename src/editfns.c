@@ -1879,7 +1879,9 @@ DEFUN ("compare-buffer-substrings", Fcompare_buffer_substrings, Scompare_buffer_
 #define USE_HEURISTIC
 
 #define XVECREF_YVECREF_EQUAL(ctx, xoff, yoff)  \
-  buffer_chars_equal (ctx, xoff, yoff)
+  ((ctx)->lines_a					\
+   ? buffer_lines_equal (ctx, xoff, yoff)		\
+   : buffer_chars_equal (ctx, xoff, yoff))
 
 #define OFFSET ptrdiff_t
 
@@ -1897,6 +1899,14 @@ #define EXTRA_CONTEXT_FIELDS                    \
      or inserted.  */                           \
   unsigned char *deletions;                     \
   unsigned char *insertions;			\
+  /* When comparing lines rather than characters, the	\
+     equivalence classes of the lines of each buffer.  */	\
+  ptrdiff_t *lines_a;				\
+  ptrdiff_t *lines_b;				\
+  /* If non-null, the characters of the differing lines	\
+     of each multibyte buffer, decoded.  */		\
+  int *chars_a;					\
+  int *chars_b;					\
   struct timespec time_limit;			\
   sys_jmp_buf jmp;				\
   unsigned short quitcounter;
@@ -1909,8 +1919,27 @@ #define EARLY_ABORT(ctx) compareseq_early_abort (ctx)
 static void set_bit (unsigned char *, OFFSET);
 static bool bit_is_set (const unsigned char *, OFFSET);
 static bool buffer_chars_equal (struct context *, OFFSET, OFFSET);
+static bool buffer_lines_equal (struct context *, OFFSET, OFFSET);
 static bool compareseq_early_abort (struct context *);
 
+/* A line of one of the buffers compared by replace-buffer-contents.  */
+struct buffer_line
+{
+  /* Byte position and length of the line, including its newline.  */
+  ptrdiff_t bytepos, nbytes;
+  EMACS_UINT hash;
+};
+
+static ptrdiff_t buffer_count_lines (struct buffer *, ptrdiff_t, ptrdiff_t);
+static ptrdiff_t buffer_split_lines (struct buffer *, ptrdiff_t, ptrdiff_t,
+				     bool, struct buffer_line *, ptrdiff_t *);
+static void buffer_line_classes (struct buffer *, struct buffer *,
+				 struct buffer_line *, ptrdiff_t, ptrdiff_t,
+				 ptrdiff_t *);
+static bool compareseq_by_lines (struct context *, struct buffer_line *,
+				 ptrdiff_t, ptrdiff_t, const ptrdiff_t *,
+				 const ptrdiff_t *, unsigned char *);
+
 #include "minmax.h"
 #include "diffseq.h"
 
@@ -2040,13 +2069,54 @@ DEFUN ("replace-buffer-contents", Freplace_buffer_contents,
     .time_limit = time_limit,
   };
 
+  /* Unless one of the buffers is plain ASCII or unibyte and the other
+     isn't, their lines are equal if and only if their bytes are.  In
+     that case, compare lines first, and then only the characters of
+     the lines that differ.  This is much faster when there are many
+     differences spread over many lines, as when source code is
+     reformatted.  */
+  ptrdiff_t nlines_a = 0, nlines_b = 0;
+  struct buffer_line *lines = NULL;
+  ptrdiff_t *line_starts = NULL;
+  unsigned char *line_changes = NULL;
+  if (ctx.a_unibyte == ctx.b_unibyte)
+    {
+      ptrdiff_t begv_byte_b = BUF_BEGV_BYTE (b), zv_byte_b = BUF_ZV_BYTE (b);
+      nlines_a = buffer_count_lines (a, BEGV_BYTE, ZV_BYTE);
+      nlines_b = buffer_count_lines (b, begv_byte_b, zv_byte_b);
+      SAFE_NALLOCA (lines, 1, nlines_a + nlines_b);
+      SAFE_NALLOCA (line_starts, 1, nlines_a + nlines_b + 2);
+      buffer_split_lines (a, BEGV_BYTE, ZV_BYTE, ctx.a_unibyte,
+			  lines, line_starts);
+      buffer_split_lines (b, begv_byte_b, zv_byte_b, ctx.b_unibyte,
+			  lines + nlines_a, line_starts + nlines_a + 1);
+      SAFE_NALLOCA (ctx.lines_a, 1, nlines_a + nlines_b);
+      ctx.lines_b = ctx.lines_a + nlines_a;
+      buffer_line_classes (a, b, lines, nlines_a, nlines_b, ctx.lines_a);
+      ptrdiff_t line_bytes = (nlines_a / CHAR_BIT + 1
+			      + nlines_b / CHAR_BIT + 1);
+      line_changes = memset (SAFE_ALLOCA (line_bytes), 0, line_bytes);
+      /* Converting character positions to byte positions would take
+	 most of the time in multibyte buffers, so decode the
+	 characters to compare in advance.  */
+      if (!ctx.a_unibyte)
+	{
+	  SAFE_NALLOCA (ctx.chars_a, 1, size_a + size_b);
+	  ctx.chars_b = ctx.chars_a + size_a;
+	}
+    }
+
   /* compareseq requires indices to be zero-based.  We add BEGV back
      later.  */
   bool early_abort;
-  if (! sys_setjmp (ctx.jmp))
-    early_abort = compareseq (0, size_a, 0, size_b, false, &ctx);
-  else
+  if (sys_setjmp (ctx.jmp))
     early_abort = true;
+  else if (line_changes)
+    early_abort = compareseq_by_lines (&ctx, lines, nlines_a, nlines_b,
+				       line_starts, line_starts + nlines_a + 1,
+				       line_changes);
+  else
+    early_abort = compareseq (0, size_a, 0, size_b, false, &ctx);
 
   if (early_abort)
     {
@@ -2166,6 +2236,9 @@ buffer_chars_equal (struct context *ctx,
 	sys_longjmp (ctx->jmp, 1);
     }
 
+  if (ctx->chars_a)
+    return ctx->chars_a[pos_a] == ctx->chars_b[pos_b];
+
   pos_a += ctx->beg_a;
   pos_b += ctx->beg_b;
 
@@ -2191,6 +2264,210 @@ buffer_chars_equal (struct context *ctx,
     == BUF_FETCH_MULTIBYTE_CHAR (ctx->buffer_b, bpos_b);
 }
 
+/* Return true if line LINE_A of buffer CTX->buffer_a and line LINE_B of
+   buffer CTX->buffer_b are equal.  */
+
+static bool
+buffer_lines_equal (struct context *ctx,
+		    ptrdiff_t line_a, ptrdiff_t line_b)
+{
+  if (!++ctx->quitcounter)
+    {
+      maybe_quit ();
+      if (compareseq_early_abort (ctx))
+	sys_longjmp (ctx->jmp, 1);
+    }
+
+  return ctx->lines_a[line_a] == ctx->lines_b[line_b];
+}
+
+/* Return the number of lines in the text of BUF between BEG_BYTE and
+   END_BYTE.  The last line need not end in a newline.  */
+
+static ptrdiff_t
+buffer_count_lines (struct buffer *buf, ptrdiff_t beg_byte, ptrdiff_t end_byte)
+{
+  ptrdiff_t nlines = 0;
+  for (ptrdiff_t pos = beg_byte; pos < end_byte; pos++)
+    nlines += BUF_FETCH_BYTE (buf, pos) == '\n';
+  return (nlines
+	  + (beg_byte < end_byte && BUF_FETCH_BYTE (buf, end_byte - 1) != '\n'));
+}
+
+/* Record in LINES the position, length and hash code of each line in
+   the text of BUF between BEG_BYTE and END_BYTE, and in STARTS the
+   number of characters before each line, plus the total number of
+   characters.  UNIBYTE means BUF has as many characters as bytes.
+   Return the number of lines.  */
+
+static ptrdiff_t
+buffer_split_lines (struct buffer *buf, ptrdiff_t beg_byte,
+		    ptrdiff_t end_byte, bool unibyte,
+		    struct buffer_line *lines, ptrdiff_t *starts)
+{
+  ptrdiff_t nlines = 0, nchars = 0, line_byte = beg_byte;
+  EMACS_UINT hash = 0;
+  starts[0] = 0;
+  for (ptrdiff_t pos = beg_byte; pos < end_byte; pos++)
+    {
+      unsigned char c = BUF_FETCH_BYTE (buf, pos);
+      hash = sxhash_combine (hash, c);
+      nchars += unibyte || CHAR_HEAD_P (c);
+      if (c == '\n' || pos + 1 == end_byte)
+	{
+	  lines[nlines].bytepos = line_byte;
+	  lines[nlines].nbytes = pos + 1 - line_byte;
+	  lines[nlines].hash = hash;
+	  starts[++nlines] = nchars;
+	  line_byte = pos + 1;
+	  hash = 0;
+	}
+    }
+  return nlines;
+}
+
+/* Return true if the lines L1 of buffer B1 and L2 of buffer B2 have
+   the same bytes.  */
+
+static bool
+buffer_line_bytes_equal (struct buffer *b1, struct buffer_line *l1,
+			 struct buffer *b2, struct buffer_line *l2)
+{
+  if (l1->hash != l2->hash || l1->nbytes != l2->nbytes)
+    return false;
+  for (ptrdiff_t i = 0; i < l1->nbytes; i++)
+    if (BUF_FETCH_BYTE (b1, l1->bytepos + i)
+	!= BUF_FETCH_BYTE (b2, l2->bytepos + i))
+      return false;
+  return true;
+}
+
+/* Store in CLASSES an equivalence class for each of the NLINES_A lines
+   of buffer A and the NLINES_B lines of buffer B that follow them in
+   LINES, such that two lines have the same class if and only if they
+   are equal.  The class of a line is the index of the first line equal
+   to it.  */
+
+static void
+buffer_line_classes (struct buffer *a, struct buffer *b,
+		     struct buffer_line *lines, ptrdiff_t nlines_a,
+		     ptrdiff_t nlines_b, ptrdiff_t *classes)
+{
+  ptrdiff_t nlines = nlines_a + nlines_b;
+  ptrdiff_t size = 1;
+  while (size < 2 * nlines)
+    size *= 2;
+  USE_SAFE_ALLOCA;
+  /* An open-addressed hash table mapping lines to their classes.  Each
+     slot is either -1 or the index of the first line of a class.  */
+  ptrdiff_t *table;
+  SAFE_NALLOCA (table, 1, size);
+  for (ptrdiff_t i = 0; i < size; i++)
+    table[i] = -1;
+  for (ptrdiff_t i = 0; i < nlines; i++)
+    {
+      struct buffer *buf = i < nlines_a ? a : b;
+      ptrdiff_t slot = lines[i].hash & (size - 1);
+      for (;; slot = (slot + 1) & (size - 1))
+	{
+	  ptrdiff_t j = table[slot];
+	  if (j < 0)
+	    {
+	      table[slot] = classes[i] = i;
+	      break;
+	    }
+	  if (buffer_line_bytes_equal (buf, &lines[i],
+				       j < nlines_a ? a : b, &lines[j]))
+	    {
+	      classes[i] = j;
+	      break;
+	    }
+	}
+    }
+  SAFE_FREE ();
+}
+
+/* Store in CHARS the characters of BUF in the lines LINES[BEG] to
+   LINES[END - 1], which start at the characters STARTS.  */
+
+static void
+buffer_decode_lines (struct buffer *buf, int *chars,
+		     struct buffer_line *lines, const ptrdiff_t *starts,
+		     ptrdiff_t beg, ptrdiff_t end)
+{
+  for (ptrdiff_t line = beg; line < end; line++)
+    {
+      ptrdiff_t bytepos = lines[line].bytepos;
+      for (ptrdiff_t i = starts[line]; i < starts[line + 1]; i++)
+	{
+	  int len;
+	  chars[i] = string_char_and_length (BUF_BYTE_ADDRESS (buf, bytepos),
+					     &len);
+	  bytepos += len;
+	}
+    }
+}
+
+/* Compare the lines of the buffers of CTX, whose classes are in
+   CTX->lines_a and CTX->lines_b, and then the characters of each run
+   of lines that differ.  LINES holds the NLINES_A lines of the first
+   buffer followed by the NLINES_B lines of the second, which start at
+   the characters STARTS_A and STARTS_B.  LINE_CHANGES is a zeroed bit
+   vector for the line comparison.  Return true if the comparison was
+   aborted.  */
+
+static bool
+compareseq_by_lines (struct context *ctx, struct buffer_line *lines,
+		     ptrdiff_t nlines_a, ptrdiff_t nlines_b,
+		     const ptrdiff_t *starts_a, const ptrdiff_t *starts_b,
+		     unsigned char *line_changes)
+{
+  unsigned char *deletions = ctx->deletions;
+  unsigned char *insertions = ctx->insertions;
+  unsigned char *line_deletions = line_changes;
+  unsigned char *line_insertions = line_changes + nlines_a / CHAR_BIT + 1;
+
+  /* There are no more lines than characters, so the diagonal vectors
+     allocated for the characters are large enough.  */
+  ctx->deletions = line_deletions;
+  ctx->insertions = line_insertions;
+  if (compareseq (0, nlines_a, 0, nlines_b, false, ctx))
+    return true;
+  ctx->deletions = deletions;
+  ctx->insertions = insertions;
+  ctx->lines_a = ctx->lines_b = NULL;
+
+  ptrdiff_t i = 0, j = 0;
+  while (i < nlines_a || j < nlines_b)
+    {
+      if ((i < nlines_a && bit_is_set (line_deletions, i))
+	  || (j < nlines_b && bit_is_set (line_insertions, j)))
+	{
+	  ptrdiff_t i0 = i, j0 = j;
+	  while (i < nlines_a && bit_is_set (line_deletions, i))
+	    i++;
+	  while (j < nlines_b && bit_is_set (line_insertions, j))
+	    j++;
+	  ptrdiff_t beg_a = starts_a[i0], beg_b = starts_b[j0];
+	  if (ctx->chars_a && i0 < i && j0 < j)
+	    {
+	      buffer_decode_lines (ctx->buffer_a, ctx->chars_a, lines,
+				   starts_a, i0, i);
+	      buffer_decode_lines (ctx->buffer_b, ctx->chars_b,
+				   lines + nlines_a, starts_b, j0, j);
+	    }
+	  if (compareseq (beg_a, starts_a[i], beg_b, starts_b[j], false, ctx))
+	    return true;
+	}
+      else
+	{
+	  i++;
+	  j++;
+	}
+    }
+  return false;
+}
+
 static bool
 compareseq_early_abort (struct context *ctx)
 {
@@ -2442,7 +2719,9 @@ DEFUN ("translate-region-internal", Ftranslate_region_internal,
   ptrdiff_t pos = XFIXNUM (start);
   ptrdiff_t pos_byte = CHAR_TO_BYTE (pos);
   ptrdiff_t end_pos = XFIXNUM (end);
-  modify_text (pos, end_pos);
+  /* Report the translation to the modification hooks as one change,
+     instead of one for each character.  */
+  specpdl_ref count = begin_combined_change (pos, end_pos);
 
   ptrdiff_t characters_changed = 0;
 
@@ -2465,7 +2744,7 @@ DEFUN ("translate-region-internal", Ftranslate_region_internal,
 
 	  if (STRINGP (table))
 	    {
-	      /* Reload as signal_after_change in last iteration may GC.  */
+	      /* Reload as replace_range in last iteration may GC.  */
 	      unsigned char *tt = SDATA (table);
 
 	      if (string_multibyte)
@@ -2525,7 +2804,6 @@ DEFUN ("translate-region-internal", Ftranslate_region_internal,
 		  record_change (pos, 1);
 		  while (str_len-- > 0)
 		    *p++ = *str++;
-		  signal_after_change (pos, 1, 1);
 		  update_compositions (pos, pos + 1, CHECK_BORDER);
 
 #ifdef HAVE_TREE_SITTER
@@ -2573,6 +2851,9 @@ DEFUN ("translate-region-internal", Ftranslate_region_internal,
       pos++;
     }
 
+  finish_combined_change (count, XFIXNUM (start),
+			  XFIXNUM (end) - XFIXNUM (start),
+			  end_pos - XFIXNUM (start));
   return make_fixnum (characters_changed);
 }
 
@@ -3237,6 +3518,134 @@ str2num (char *str, char **str_end)
   return n;
 }
 
+/* Append to the result of format_simple the NBYTES bytes at SRC, which
+   are NCHARS characters and are multibyte if SRC_MULTIBYTE.  *NBYTES
+   and *NCHARS are the size of the result so far, which is multibyte
+   if MULTIBYTE, and DST, if non-null, is where it is stored.  Return
+   false if the text cannot be appended without the conversions that
+   styled_format does.  */
+
+static bool
+format_simple_append (const unsigned char *src, ptrdiff_t nbytes,
+		      ptrdiff_t nchars, bool src_multibyte, bool multibyte,
+		      unsigned char *dst, ptrdiff_t *result_bytes,
+		      ptrdiff_t *result_chars)
+{
+  ptrdiff_t bytes = nbytes;
+  if (multibyte && src_multibyte)
+    {
+      /* Don't risk combining bytes with preceding text.  */
+      if (nbytes && !CHAR_HEAD_P (*src))
+	return false;
+    }
+  else if (multibyte)
+    bytes = count_size_as_multibyte (src, nbytes);
+  else if (src_multibyte && nchars != nbytes)
+    return false;
+  if (ckd_add (result_bytes, *result_bytes, bytes)
+      || STRING_BYTES_BOUND < *result_bytes)
+    return false;
+  if (dst)
+    copy_text (src, dst + *result_bytes - bytes, nbytes, src_multibyte,
+	       multibyte);
+  *result_chars += nchars;
+  return true;
+}
+
+/* Format the NARGS arguments ARGS like 'format', or like
+   'format-message' if MESSAGE, provided that the format string has
+   only %% and %s and %d specs without field numbers, flags, width or
+   precision, whose arguments are fixnums, strings or symbols, and that
+   no text properties or quotes must be handled.  The result is
+   multibyte if *MULTIBYTE; if ADJUST, *MULTIBYTE is set to true if a
+   symbol with a multibyte name is formatted.
+
+   Return the number of bytes in the result and store the number of
+   its characters in *NCHARS, and the result itself in DST if that is
+   non-null.  Return -1 if the format is not so simple, so that
+   styled_format must be used.  This does not allocate, and is much
+   faster than styled_format for typical short format strings.  */
+
+static ptrdiff_t
+format_simple (ptrdiff_t nargs, Lisp_Object *args, bool message,
+	       bool *multibyte, bool adjust, unsigned char *dst,
+	       ptrdiff_t *nchars)
+{
+  Lisp_Object format = args[0];
+  if (!STRINGP (format) || string_intervals (format))
+    return -1;
+  bool format_multibyte = STRING_MULTIBYTE (format);
+
+ retry:;
+  ptrdiff_t result_bytes = 0, result_chars = 0, n = 0;
+  const unsigned char *chunk = SDATA (format);
+  const unsigned char *end = chunk + SBYTES (format);
+  while (true)
+    {
+      const unsigned char *f = chunk;
+      ptrdiff_t chunk_chars = 0;
+      for (; f < end && *f != '%'; f++)
+	{
+	  if (message && (*f == '`' || *f == '\''))
+	    return -1;
+	  chunk_chars += !format_multibyte || CHAR_HEAD_P (*f);
+	}
+      if (!format_simple_append (chunk, f - chunk, chunk_chars,
+				 format_multibyte, *multibyte, dst,
+				 &result_bytes, &result_chars))
+	return -1;
+      if (f == end)
+	break;
+      if (f + 1 == end)
+	return -1;
+
+      char conversion = f[1];
+      chunk = f + 2;
+      if (conversion == '%')
+	{
+	  if (!format_simple_append (f, 1, 1, false, *multibyte, dst,
+				     &result_bytes, &result_chars))
+	    return -1;
+	  continue;
+	}
+      if (! ((conversion == 's' || conversion == 'd') && ++n < nargs))
+	return -1;
+
+      Lisp_Object arg = args[n];
+      if (FIXNUMP (arg))
+	{
+	  char buf[INT_BUFSIZE_BOUND (EMACS_INT)];
+	  char *bufend = buf + sizeof buf;
+	  char *p = fixnum_to_string (XFIXNUM (arg), buf, bufend);
+	  if (!format_simple_append ((unsigned char *) p, bufend - p, bufend - p,
+				     false, *multibyte, dst,
+				     &result_bytes, &result_chars))
+	    return -1;
+	  continue;
+	}
+      if (conversion != 's')
+	return -1;
+      if (SYMBOLP (arg))
+	{
+	  arg = SYMBOL_NAME (arg);
+	  if (STRING_MULTIBYTE (arg) && !*multibyte && adjust)
+	    {
+	      /* styled_format would make the result multibyte.  */
+	      *multibyte = true;
+	      goto retry;
+	    }
+	}
+      if (! (STRINGP (arg) && !string_intervals (arg)
+	     && format_simple_append (SDATA (arg), SBYTES (arg), SCHARS (arg),
+				      STRING_MULTIBYTE (arg), *multibyte,
+				      dst, &result_bytes, &result_chars)))
+	return -1;
+    }
+
+  *nchars = result_chars;
+  return result_bytes;
+}
+
 DEFUN ("format", Fformat, Sformat, 1, MANY, 0,
        doc: /* Format a string out of a format-string and arguments.
 The first argument is a format control string.
@@ -3329,6 +3738,37 @@ DEFUN ("format-message", Fformat_message, Sformat_message, 1, MANY, 0,
   return styled_format (nargs, args, true);
 }
 
+DEFUN ("insert-format", Finsert_format, Sinsert_format, 1, MANY, 0,
+       doc: /* Insert the result of formatting OBJECTS with STRING at point.
+This is like `(insert (format STRING OBJECTS...))', but for simple
+format strings it inserts the text directly, without making a string.
+Point and markers are relocated like by `insert'.
+
+usage: (insert-format STRING &rest OBJECTS)  */)
+  (ptrdiff_t nargs, Lisp_Object *args)
+{
+  bool multibyte = !NILP (BVAR (current_buffer, enable_multibyte_characters));
+  ptrdiff_t nchars;
+  ptrdiff_t nbytes = format_simple (nargs, args, false, &multibyte, false,
+				    NULL, &nchars);
+  if (nbytes < 0)
+    {
+      Lisp_Object string = styled_format (nargs, args, false);
+      return Finsert (1, &string);
+    }
+  if (nbytes == 0)
+    return Qnil;
+
+  USE_SAFE_ALLOCA;
+  unsigned char *text = SAFE_ALLOCA (nbytes);
+  format_simple (nargs, args, false, &multibyte, false, text, &nchars);
+  insert_1_both ((char *) text, nchars, nbytes, false, true, false);
+  signal_after_change (PT - nchars, 0, nchars);
+  update_compositions (PT - nchars, PT, CHECK_BORDER);
+  SAFE_FREE ();
+  return Qnil;
+}
+
 /* Implement ‘format-message’ if MESSAGE is true, ‘format’ otherwise.  */
 
 static Lisp_Object
@@ -3352,6 +3792,38 @@ styled_format (ptrdiff_t nargs, Lisp_Object *args, bool message)
   };
   static_assert (USEFUL_PRECISION_MAX > 0);
 
+  /* True if the output should be a multibyte string,
+     which is true if any of the inputs is one.  */
+  bool multibyte = STRINGP (args[0]) && STRING_MULTIBYTE (args[0]);
+  for (ptrdiff_t i = 1; !multibyte && i < nargs; i++)
+    if (STRINGP (args[i]) && STRING_MULTIBYTE (args[i]))
+      multibyte = true;
+
+  /* Most format strings are simple enough to be formatted directly
+     into the result.  */
+  ptrdiff_t simple_chars;
+  ptrdiff_t simple_bytes = format_simple (nargs, args, message, &multibyte,
+					  true, NULL, &simple_chars);
+  if (0 <= simple_bytes)
+    {
+      Lisp_Object format = args[0];
+      if (SBYTES (format) == 2 && SREF (format, 0) == '%'
+	  && SREF (format, 1) == 's'
+	  && !FIXNUMP (args[1]))
+	return SYMBOLP (args[1]) ? SYMBOL_NAME (args[1]) : args[1];
+      if (simple_bytes == SBYTES (format)
+	  && !memchr (SDATA (format), '%', SBYTES (format)))
+	return format;
+      Lisp_Object val
+	= (multibyte
+	   ? make_uninit_multibyte_string (simple_chars, simple_bytes)
+	   : make_uninit_string (simple_bytes));
+      ptrdiff_t bytes = format_simple (nargs, args, message, &multibyte,
+				       false, SDATA (val), &simple_chars);
+      eassert (bytes == simple_bytes);
+      return val;
+    }
+
   ptrdiff_t n;		/* The number of the next arg to substitute.  */
   char initial_buffer[1000 + SPRINTF_BUFSIZE];
   char *buf = initial_buffer;
@@ -3417,13 +3889,6 @@ styled_format (ptrdiff_t nargs, Lisp_Object *args, bool message)
      or because a grave accent or apostrophe is requoted,
      and in that case, we won't know it here.  */
 
-  /* True if the output should be a multibyte string,
-     which is true if any of the inputs is one.  */
-  bool multibyte = multibyte_format;
-  for (ptrdiff_t i = 1; !multibyte && i < nargs; i++)
-    if (STRINGP (args[i]) && STRING_MULTIBYTE (args[i]))
-      multibyte = true;
-
   Lisp_Object quoting_style = message ? Ftext_quoting_style () : Qnil;
 
   ptrdiff_t ispec;
@@ -4388,6 +4853,9 @@ transpose_markers (ptrdiff_t start1, ptrdiff_t end1,
 	}
       marker->charpos = mpos;
     }
+
+  invalidate_bytechar_index (current_buffer, start1_byte, end2_byte);
+  invalidate_line_index (current_buffer, start1_byte, end2_byte);
 }
 
 DEFUN ("transpose-regions", Ftranspose_regions, Stranspose_regions, 4, 5,
@@ -4784,6 +5252,7 @@ syms_of_editfns (void)
   defsubr (&Scurrent_message);
   defsubr (&Sformat);
   defsubr (&Sformat_message);
+  defsubr (&Sinsert_format);
 
   defsubr (&Sinsert_buffer_substring);
   defsubr (&Scompare_buffer_substrings);
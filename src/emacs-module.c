@@ -77,6 +77,9 @@ Copyright (C) 2015-2025 Free Software Foundation, Inc.
 
 #include "emacs-module.h"
 
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -85,6 +88,7 @@ Copyright (C) 2015-2025 Free Software Foundation, Inc.
 
 #include "lisp.h"
 #include "bignum.h"
+#include "buffer.h"
 #include "dynlib.h"
 #include "coding.h"
 #include "keyboard.h"
@@ -1188,6 +1192,216 @@ module_open_channel (emacs_env *env, emacs_value pipe_process)
   return rc;
 }
 
+static bool
+module_buffer_text (emacs_env *env, emacs_value buffer,
+		    intmax_t start, intmax_t end,
+		    const char **text1, ptrdiff_t *size1,
+		    const char **text2, ptrdiff_t *size2)
+{
+  MODULE_FUNCTION_BEGIN (false);
+  Lisp_Object lbuffer = value_to_lisp (buffer);
+  CHECK_BUFFER (lbuffer);
+  struct buffer *b = XBUFFER (lbuffer);
+  if (!BUFFER_LIVE_P (b))
+    error ("Selecting deleted buffer");
+  if (! (BUF_BEGV (b) <= start && start <= end && end <= BUF_ZV (b)))
+    args_out_of_range_3 (lbuffer, INT_TO_INTEGER (start),
+			 INT_TO_INTEGER (end));
+
+  /* The text is in at most two pieces, on either side of the gap.  */
+  ptrdiff_t start_byte = buf_charpos_to_bytepos (b, start);
+  ptrdiff_t end_byte = buf_charpos_to_bytepos (b, end);
+  ptrdiff_t gap_byte = clip_to_bounds (start_byte, BUF_GPT_BYTE (b),
+				       end_byte);
+  *text1 = (const char *) BUF_BYTE_ADDRESS (b, start_byte);
+  *size1 = gap_byte - start_byte;
+  *text2 = (const char *) BUF_BYTE_ADDRESS (b, gap_byte);
+  *size2 = end_byte - gap_byte;
+
+  MODULE_INTERNAL_CLEANUP ();
+  return true;
+}
+
+static bool
+module_insert_text (emacs_env *env, ptrdiff_t count,
+		    const char *const *texts, const ptrdiff_t *sizes)
+{
+  MODULE_FUNCTION_BEGIN (false);
+  if (count < 0)
+    args_out_of_range (INT_TO_INTEGER (count), make_fixnum (0));
+
+  /* Decode the pieces all at once, so that the text is inserted, and
+     the change hooks are run, only once.  */
+  ptrdiff_t nbytes = 0;
+  for (ptrdiff_t i = 0; i < count; i++)
+    if (sizes[i] < 0 || ckd_add (&nbytes, nbytes, sizes[i])
+	|| STRING_BYTES_BOUND < nbytes)
+      overflow_error ();
+  if (nbytes > 0)
+    {
+      Lisp_Object text;
+      if (count == 1)
+	text = module_decode_utf_8 (texts[0], nbytes);
+      else
+	{
+	  Lisp_Object bytes = make_uninit_string (nbytes);
+	  char *p = SSDATA (bytes);
+	  for (ptrdiff_t i = 0; i < count; p += sizes[i++])
+	    memcpy (p, texts[i], sizes[i]);
+	  text = decode_string_utf_8 (bytes, NULL, 0, Qnil, false, Qnil, Qnil);
+	  CHECK_TYPE (!NILP (text), Qutf_8_string_p, bytes);
+	}
+      insert_from_string (text, 0, 0, SCHARS (text), SBYTES (text), false);
+    }
+
+  MODULE_INTERNAL_CLEANUP ();
+  return true;
+}
+
+/* The bulk constructors below build a whole vector or list with a
+   single call, and so with a single value in the value frame,
+   instead of one call and one value per element.  */
+
+static emacs_value
+module_make_integer_vector (emacs_env *env, ptrdiff_t count,
+			    const intmax_t *values)
+{
+  emacs_value value;
+
+  MODULE_FUNCTION_BEGIN (NULL);
+  if (count < 0)
+    args_out_of_range (INT_TO_INTEGER (count), make_fixnum (0));
+  Lisp_Object vec = make_nil_vector (count);
+  for (ptrdiff_t i = 0; i < count; i++)
+    ASET (vec, i, make_int (values[i]));
+  value = lisp_to_value (env, vec);
+  MODULE_INTERNAL_CLEANUP ();
+
+  return value;
+}
+
+static emacs_value
+module_make_float_vector (emacs_env *env, ptrdiff_t count,
+			  const double *values)
+{
+  emacs_value value;
+
+  MODULE_FUNCTION_BEGIN (NULL);
+  if (count < 0)
+    args_out_of_range (INT_TO_INTEGER (count), make_fixnum (0));
+  Lisp_Object vec = make_nil_vector (count);
+  for (ptrdiff_t i = 0; i < count; i++)
+    ASET (vec, i, make_float (values[i]));
+  value = lisp_to_value (env, vec);
+  MODULE_INTERNAL_CLEANUP ();
+
+  return value;
+}
+
+static emacs_value
+module_make_string_list (emacs_env *env, const char *data,
+			 ptrdiff_t count, const ptrdiff_t *sizes)
+{
+  emacs_value value;
+
+  MODULE_FUNCTION_BEGIN (NULL);
+  if (count < 0)
+    args_out_of_range (INT_TO_INTEGER (count), make_fixnum (0));
+  ptrdiff_t nbytes = 0;
+  for (ptrdiff_t i = 0; i < count; i++)
+    if (! (0 <= sizes[i] && sizes[i] <= STRING_BYTES_BOUND)
+	|| ckd_add (&nbytes, nbytes, sizes[i]))
+      overflow_error ();
+  /* Cons the list up from its end, so that it needn't be reversed.  */
+  Lisp_Object list = Qnil;
+  for (ptrdiff_t i = count - 1; 0 <= i; i--)
+    {
+      nbytes -= sizes[i];
+      Lisp_Object str = (sizes[i] == 0 ? empty_multibyte_string
+			 : module_decode_utf_8 (data + nbytes, sizes[i]));
+      list = Fcons (str, list);
+    }
+  value = lisp_to_value (env, list);
+  MODULE_INTERNAL_CLEANUP ();
+
+  return value;
+}
+
+/* Callbacks posted by threads of modules.  A thread posts a callback
+   with a single write of a struct module_posted_callback to the write
+   end of module_post_pipe.  Such a write is atomic, since it is
+   smaller than PIPE_BUF, so posting needs no lock and doesn't touch
+   any Lisp data.  The main thread reads the callbacks from the read
+   end in module_read_posted_callbacks, and turns each one into a
+   module-event special event, which module-handle-event runs.  */
+
+struct module_posted_callback
+{
+  void (*callback) (emacs_env *, void *);
+  void *data;
+};
+
+static int module_post_pipe[2] = { -1, -1 };
+
+static bool
+module_post_callback (emacs_env *env,
+		      void (*callback) (emacs_env *, void *), void *data)
+{
+  /* This runs in an arbitrary thread, so it mustn't use ENV, signal
+     errors, or call anything that might.  */
+  struct module_posted_callback posted = { callback, data };
+  static_assert (sizeof posted <= PIPE_BUF);
+  ssize_t nbytes;
+  do
+    nbytes = write (module_post_pipe[1], &posted, sizeof posted);
+  while (nbytes < 0 && errno == EINTR);
+  return nbytes == sizeof posted;
+}
+
+static void
+module_free_posted_callback (void *posted)
+{
+  xfree (posted);
+}
+
+/* Called from wait_reading_process_output when FD, the read end of
+   module_post_pipe, is readable.  */
+
+static void
+module_read_posted_callbacks (int fd, void *data)
+{
+  struct module_posted_callback posted[64];
+  ptrdiff_t nbytes;
+
+  /* Since each callback was written atomically, the pipe only ever
+     contains whole callbacks.  */
+  while (0 < (nbytes = emacs_read (fd, posted, sizeof posted)))
+    for (ptrdiff_t i = 0; i < nbytes / (ptrdiff_t) sizeof *posted; i++)
+      {
+	struct module_posted_callback *p = xmalloc (sizeof *p);
+	*p = posted[i];
+	struct input_event event;
+	EVENT_INIT (event);
+	event.kind = MODULE_EVENT;
+	event.frame_or_window = Qnil;
+	/* A user pointer can't be forged by Lisp code, and frees the
+	   callback if the event is discarded.  */
+	event.arg = list1 (make_user_ptr (module_free_posted_callback, p));
+	kbd_buffer_store_event (&event);
+      }
+}
+
+/* Create module_post_pipe, unless that has already been done.  */
+
+static void
+module_init_post_pipe (void)
+{
+  if (0 <= module_post_pipe[0] || emacs_pipe (module_post_pipe) != 0)
+    return;
+  fcntl (module_post_pipe[0], F_SETFL, O_NONBLOCK);
+  add_read_fd (module_post_pipe[0], module_read_posted_callbacks, NULL);
+}
+
 
 /* Subroutines.  */
 
@@ -1230,6 +1444,8 @@ DEFUN ("module-load", Fmodule_load, Smodule_load, 1, 1, 0,
   if (!module_init)
     xsignal1 (Qmissing_module_init_function, file);
 
+  module_init_post_pipe ();
+
   struct emacs_runtime rt_pub;
   struct emacs_runtime_private rt_priv;
   emacs_env env_pub;
@@ -1270,6 +1486,43 @@ DEFUN ("module-load", Fmodule_load, Smodule_load, 1, 1, 0,
   return unbind_to (count, Qt);
 }
 
+DEFUN ("module-handle-event", Fmodule_handle_event, Smodule_handle_event,
+       1, 1, "e",
+       doc: /* Run the callback that a module thread posted with EVENT.
+EVENT is a special event of the form (module-event PTR); see the
+`post_callback' function of the module API.  */)
+  (Lisp_Object event)
+{
+  Lisp_Object ptr = CONSP (event) ? Fcar_safe (XCDR (event)) : Qnil;
+  if (! (CONSP (event) && EQ (XCAR (event), Qmodule_event)
+	 && USER_PTRP (ptr)
+	 && XUSER_PTR (ptr)->finalizer == module_free_posted_callback))
+    signal_error ("Invalid module event", event);
+
+  /* Run each callback only once, even if EVENT is handled again.  */
+  struct module_posted_callback *p = XUSER_PTR (ptr)->p;
+  if (!p)
+    return Qnil;
+  struct module_posted_callback posted = *p;
+  XUSER_PTR (ptr)->p = NULL;
+  xfree (p);
+
+  emacs_env pub;
+  struct emacs_env_private priv;
+  emacs_env *env = initialize_environment (&pub, &priv);
+  specpdl_ref count = SPECPDL_INDEX ();
+  record_unwind_protect_module (SPECPDL_MODULE_ENVIRONMENT, env);
+
+  posted.callback (env, posted.data);
+
+  /* Process the quit flag first, so that quitting doesn't get
+     overridden by other non-local exits.  */
+  maybe_quit ();
+
+  module_signal_or_throw (&priv);
+  return unbind_to (count, Qnil);
+}
+
 Lisp_Object
 funcall_module (Lisp_Object function, ptrdiff_t nargs, Lisp_Object *arglist)
 {
@@ -1613,6 +1866,12 @@ initialize_environment (emacs_env *env, struct emacs_env_private *priv)
   env->set_function_finalizer = module_set_function_finalizer;
   env->open_channel = module_open_channel;
   env->make_interactive = module_make_interactive;
+  env->buffer_text = module_buffer_text;
+  env->insert_text = module_insert_text;
+  env->make_integer_vector = module_make_integer_vector;
+  env->make_float_vector = module_make_float_vector;
+  env->make_string_list = module_make_string_list;
+  env->post_callback = module_post_callback;
   return env;
 }
 
@@ -1775,4 +2034,5 @@ syms_of_module (void)
   DEFSYM (Qunicode_string_p, "unicode-string-p");
 
   defsubr (&Smodule_load);
+  defsubr (&Smodule_handle_event);
 }
@@ -71,6 +71,17 @@ #define MAIN_PROGRAM
 # include <sys/socket.h>
 #endif
 
+#if defined HAVE_SYS_UN_H && !defined WINDOWSNT
+# include <sys/socket.h>
+# include <sys/un.h>
+# if !defined AF_LOCAL && defined AF_UNIX
+#  define AF_LOCAL AF_UNIX
+# endif
+# if defined AF_LOCAL && defined SCM_RIGHTS
+#  define HAVE_FORK_SERVER
+# endif
+#endif
+
 #if defined HAVE_LINUX_SECCOMP_H && defined HAVE_LINUX_FILTER_H \
   && HAVE_DECL_SECCOMP_SET_MODE_FILTER                          \
   && HAVE_DECL_SECCOMP_FILTER_FLAG_TSYNC
@@ -112,6 +123,7 @@ #define MAIN_PROGRAM
 #include "regex-emacs.h"
 #include "syntax.h"
 #include "sysselect.h"
+#include "syswait.h"
 #include "systime.h"
 
 #include "getpagesize.h"
@@ -238,6 +250,12 @@ #define MAIN_PROGRAM
 HANDLE w32_daemon_event;
 #endif
 
+#ifdef HAVE_FORK_SERVER
+/* In a child forked by `internal--fork-server', the connection to the
+   client whose request the child serves; otherwise -1.  */
+static int fork_server_fd = -1;
+#endif
+
 /* Save argv and argc.  */
 char **initial_argv;
 int initial_argc;
@@ -289,6 +307,9 @@ #define MAIN_PROGRAM
 "
 #endif
     "\
+--startup-profile=FILE      write a trace of startup phases to FILE\n\
+"
+    "\
 --no-build-details          do not add build details such as time stamps\n\
 --no-desktop                do not load a saved desktop\n\
 --no-init-file, -q          load neither ~/.emacs nor default.el\n\
@@ -1252,6 +1273,177 @@ maybe_load_seccomp (int argc, char **argv)
 
 #endif  /* SECCOMP_USABLE */
 
+/* Startup profiling, enabled by --startup-profile=FILE.  Emacs
+   records when each startup phase and each `load' begins and ends,
+   and writes the events to FILE in the JSON trace event format, which
+   chrome://tracing and Perfetto can display.  */
+
+struct startup_profile_event
+{
+  /* What kind of event this is, e.g. "init" or "load".  */
+  const char *category;
+  char *name;
+  struct timespec start;
+  /* When the event ended, or an invalid timespec if it has not ended
+     yet.  */
+  struct timespec end;
+};
+
+/* The file to write the profile to, or NULL if not profiling.  */
+static char *startup_profile_file;
+static struct startup_profile_event *startup_profile_events;
+static ptrdiff_t startup_profile_nevents, startup_profile_nalloc;
+
+/* The time at which Emacs started, and at which the current startup
+   phase began.  */
+static struct timespec startup_profile_origin, startup_profile_phase_start;
+
+static struct timespec
+startup_profile_now (void)
+{
+#ifdef CLOCK_MONOTONIC
+  struct timespec now;
+  if (clock_gettime (CLOCK_MONOTONIC, &now) == 0)
+    return now;
+#endif
+  return current_timespec ();
+}
+
+/* Look for --startup-profile in ARGV.  This runs before the dump is
+   loaded, so it must not allocate memory.  */
+static void
+startup_profile_init (int argc, char **argv)
+{
+  int skip_args = 0;
+  char *file = NULL;
+  while (skip_args < argc - 1)
+    {
+      if (argmatch (argv, argc, "-startup-profile", "--startup-profile",
+		    10, &file, &skip_args)
+	  || argmatch (argv, argc, "--", NULL, 2, NULL, &skip_args))
+	break;
+      ++skip_args;
+    }
+  if (file == NULL)
+    return;
+  startup_profile_file = file;
+  startup_profile_origin = startup_profile_phase_start
+    = startup_profile_now ();
+}
+
+/* If profiling startup, record the start of an event of kind CATEGORY
+   named NAME, and return a handle to pass to startup_profile_end.
+   Otherwise, return -1.  */
+intmax_t
+startup_profile_begin (const char *category, const char *name)
+{
+  if (!startup_profile_file)
+    return -1;
+  if (startup_profile_nevents == startup_profile_nalloc)
+    startup_profile_events
+      = xpalloc (startup_profile_events, &startup_profile_nalloc, 1, -1,
+		 sizeof *startup_profile_events);
+  struct startup_profile_event *event
+    = &startup_profile_events[startup_profile_nevents];
+  event->category = category;
+  event->name = xstrdup (name);
+  event->start = startup_profile_now ();
+  event->end = invalid_timespec ();
+  return startup_profile_nevents++;
+}
+
+/* Record the end of the event EVENT returned by startup_profile_begin.
+   This can be used as an unwind function.  */
+void
+startup_profile_end (intmax_t event)
+{
+  if (0 <= event && event < startup_profile_nevents)
+    startup_profile_events[event].end = startup_profile_now ();
+}
+
+/* Record that the startup phase NAME, which began where the previous
+   phase ended, has just ended.  */
+static void
+startup_profile_phase (const char *name)
+{
+  intmax_t event = startup_profile_begin ("init", name);
+  if (0 <= event)
+    {
+      startup_profile_events[event].start = startup_profile_phase_start;
+      startup_profile_end (event);
+      startup_profile_phase_start = startup_profile_events[event].end;
+    }
+}
+
+/* Print the time interval T in microseconds to STREAM.  */
+static void
+startup_profile_print_time (FILE *stream, struct timespec t)
+{
+  fprintf (stream, "%jd.%03d", (intmax_t) t.tv_sec * 1000000
+	   + t.tv_nsec / 1000, (int) (t.tv_nsec % 1000));
+}
+
+static void
+startup_profile_print_string (FILE *stream, const char *string)
+{
+  putc ('"', stream);
+  for (unsigned char const *p = (unsigned char const *) string; *p; p++)
+    if (*p == '"' || *p == '\\')
+      fprintf (stream, "\\%c", *p);
+    else if (*p < ' ')
+      fprintf (stream, "\\u%04x", *p);
+    else
+      putc (*p, stream);
+  putc ('"', stream);
+}
+
+/* If profiling startup, write the profile and stop profiling.  Events
+   that have not ended yet are treated as ending now.  */
+void
+startup_profile_finish (void)
+{
+  if (!startup_profile_file)
+    return;
+
+  struct timespec now = startup_profile_now ();
+  FILE *stream = emacs_fopen (startup_profile_file, "w");
+  if (!stream)
+    fprintf (stderr, "emacs: cannot write startup profile %s: %s\n",
+	     startup_profile_file, emacs_strerror (errno));
+  else
+    {
+      intmax_t pid = getpid ();
+      fputs ("{\"traceEvents\":[", stream);
+      for (ptrdiff_t i = 0; i < startup_profile_nevents; i++)
+	{
+	  struct startup_profile_event *event = &startup_profile_events[i];
+	  struct timespec end = timespec_valid_p (event->end) ? event->end : now;
+	  fputs (i ? ",\n{\"name\":" : "\n{\"name\":", stream);
+	  startup_profile_print_string (stream, event->name);
+	  fprintf (stream, ",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":",
+		   event->category);
+	  startup_profile_print_time (stream,
+				      timespec_sub (event->start,
+						    startup_profile_origin));
+	  fputs (",\"dur\":", stream);
+	  startup_profile_print_time (stream,
+				      timespec_sub (end, event->start));
+	  fprintf (stream, ",\"pid\":%jd,\"tid\":%jd}", pid, pid);
+	}
+      fputs ("\n],\"displayTimeUnit\":\"ms\"}\n", stream);
+      if (fclose (stream) != 0)
+	fprintf (stderr, "emacs: cannot write startup profile %s: %s\n",
+		 startup_profile_file, emacs_strerror (errno));
+    }
+
+  for (ptrdiff_t i = 0; i < startup_profile_nevents; i++)
+    xfree (startup_profile_events[i].name);
+  xfree (startup_profile_events);
+  startup_profile_events = NULL;
+  startup_profile_nevents = startup_profile_nalloc = 0;
+  startup_profile_file = NULL;
+}
+
 #if !defined HAVE_ANDROID || defined ANDROID_STUBIFY
 int
 main (int argc, char **argv)
@@ -1278,6 +1470,8 @@ android_emacs_init (int argc, char **argv, char *dump_file)
   maybe_load_seccomp (argc, argv);
 #endif
 
+  startup_profile_init (argc, argv);
+
   bool no_loadup = false;
   char *junk = 0;
   char *dname_arg = 0;
@@ -1370,6 +1564,7 @@ android_emacs_init (int argc, char **argv, char *dump_file)
   if (attempt_load_pdump)
     {
       initial_emacs_executable = load_pdump (argc, argv, dump_file);
+      startup_profile_phase ("pdumper_load");
 #ifdef WINDOWSNT
   /* Reinitialize the codepage for file names, needed to decode
      non-ASCII file names during startup.  This is needed because
@@ -1879,6 +2074,7 @@ android_emacs_init (int argc, char **argv, char *dump_file)
     malloc_enable_thread ();
 #endif
 
+  startup_profile_phase ("command_line");
   init_signals ();
 
   noninteractive1 = noninteractive;
@@ -1950,6 +2146,7 @@ android_emacs_init (int argc, char **argv, char *dump_file)
   running_asynch_code = 0;
   init_random ();
   init_xfaces ();
+  startup_profile_phase ("init_alloc");
 
   if (!initialized)
     syms_of_comp ();
@@ -2149,6 +2346,7 @@ android_emacs_init (int argc, char **argv, char *dump_file)
   init_callproc ();	/* Must follow init_cmdargs but not init_sys_modes.  */
   init_fileio ();
   init_lread ();
+  startup_profile_phase ("init_lread");
 
   /* If "-version" was specified, produce version information and
      exit.  We do it here because the code below needs to call Lisp
@@ -2415,6 +2613,7 @@ android_emacs_init (int argc, char **argv, char *dump_file)
       syms_of_profiler ();
       syms_of_pdumper ();
       syms_of_json ();
+      syms_of_region_cache ();
 
       keys_of_keyboard ();
 
@@ -2440,6 +2639,7 @@ android_emacs_init (int argc, char **argv, char *dump_file)
       globals_of_w32select ();
 #endif
     }
+  startup_profile_phase ("syms_of");
 
 #ifdef HAVE_HAIKU
   init_haiku_select ();
@@ -2490,6 +2690,7 @@ android_emacs_init (int argc, char **argv, char *dump_file)
   init_sfntfont ();
   init_sfntfont_android ();
 #endif
+  startup_profile_phase ("init_display");
 
   if (!initialized)
     {
@@ -2557,6 +2758,7 @@ android_emacs_init (int argc, char **argv, char *dump_file)
 
   /* Enter editor command loop.  This never returns.  */
   set_initial_minibuffer_mode ();
+  startup_profile_phase ("init_misc");
   Frecursive_edit ();
   eassume (false);
 }
@@ -2658,6 +2860,7 @@ android_emacs_init (int argc, char **argv, char *dump_file)
 #if SECCOMP_USABLE
   { "-seccomp", "--seccomp", 1, 1 },
 #endif
+  { "-startup-profile", "--startup-profile", 1, 1 },
 #ifdef HAVE_NS
   { "-NSAutoLaunch", 0, 5, 1 },
   { "-NXAutoLaunch", 0, 5, 1 },
@@ -2927,6 +3130,7 @@ DEFUN ("kill-emacs", Fkill_emacs, Skill_emacs, 0, 2, "P",
   x_clipboard_manager_save_all ();
 #endif
 
+  startup_profile_finish ();
   shut_down_emacs (0, (STRINGP (arg) && !feof (stdin)) ? arg : Qnil);
 
   /* If we have an auto-save list file,
@@ -2987,6 +3191,20 @@ DEFUN ("kill-emacs", Fkill_emacs, Skill_emacs, 0, 2, "P",
 		 : XFIXNUM (arg) & INT_MAX);
   else
     exit_code = EXIT_SUCCESS;
+
+#ifdef HAVE_FORK_SERVER
+  /* Tell the client of a forked server child how the request ended,
+     once everything that the request wrote has reached the client.  */
+  if (0 <= fork_server_fd)
+    {
+      char buf[sizeof "-exit \n" + INT_STRLEN_BOUND (int)];
+      fflush (stdout);
+      fflush (stderr);
+      emacs_write (fork_server_fd, buf,
+		   sprintf (buf, "-exit %d\n", exit_code));
+    }
+#endif
+
   exit (exit_code);
 }
 
@@ -3376,6 +3594,151 @@ DEFUN ("daemon-initialized", Fdaemon_initialized, Sdaemon_initialized, 0, 0, 0,
   return Qt;
 }
 
+#ifdef HAVE_FORK_SERVER
+/* Serve the request of the client connected to FD, in a grandchild of
+   the fork server.  Receive the client's standard input, output and
+   error, and return the strings that it sent.  Exit on failure, which
+   the client notices as a connection closed without an exit status.  */
+static Lisp_Object
+fork_server_child (int fd)
+{
+  ptrdiff_t alloc = 4096, size = 0;
+  char *buf = xmalloc (alloc);
+  union
+  {
+    struct cmsghdr align;
+    char buf[CMSG_SPACE (3 * sizeof (int))];
+  } control;
+  struct iovec iov = { .iov_base = buf, .iov_len = alloc };
+  struct msghdr msg = { .msg_iov = &iov, .msg_iovlen = 1,
+			.msg_control = control.buf,
+			.msg_controllen = sizeof control.buf };
+  ptrdiff_t n;
+  do
+    n = recvmsg (fd, &msg, 0);
+  while (n < 0 && errno == EINTR);
+
+  struct cmsghdr *cmsg = n < 0 ? NULL : CMSG_FIRSTHDR (&msg);
+  if (! (cmsg && cmsg->cmsg_level == SOL_SOCKET
+	 && cmsg->cmsg_type == SCM_RIGHTS
+	 && cmsg->cmsg_len == CMSG_LEN (3 * sizeof (int))))
+    _exit (EXIT_FAILURE);
+  int fds[3];
+  memcpy (fds, CMSG_DATA (cmsg), sizeof fds);
+  for (int i = 0; i < 3; i++)
+    if (dup2 (fds[i], i) < 0)
+      _exit (EXIT_FAILURE);
+  for (int i = 0; i < 3; i++)
+    if (STDERR_FILENO < fds[i])
+      emacs_close (fds[i]);
+  clearerr (stdin);
+
+  /* The client shuts down its side of the connection after sending
+     the request.  */
+  for (size = n; 0 < n; size += n)
+    {
+      if (size == alloc)
+	buf = xpalloc (buf, &alloc, 1, -1, 1);
+      n = emacs_read (fd, buf + size, alloc - size);
+      if (n < 0)
+	_exit (EXIT_FAILURE);
+    }
+
+  /* Let the client forward its signals to this process.  */
+  char pidbuf[sizeof "-emacs-pid \n" + INT_STRLEN_BOUND (pid_t)];
+  int pidlen = sprintf (pidbuf, "-emacs-pid %"PRIdMAX"\n",
+			(intmax_t) getpid ());
+  if (emacs_write (fd, pidbuf, pidlen) != pidlen)
+    _exit (EXIT_FAILURE);
+  fork_server_fd = fd;
+  init_random ();
+
+  Lisp_Object result = Qnil;
+  for (char *p = buf, *lim = buf + size; p < lim; )
+    {
+      char *end = memchr (p, '\0', lim - p);
+      if (!end)
+	end = lim;
+      result = Fcons (make_unibyte_string (p, end - p), result);
+      p = end + 1;
+    }
+  xfree (buf);
+  return Fnreverse (result);
+}
+#endif
+
+DEFUN ("internal--fork-server", Finternal__fork_server,
+       Sinternal__fork_server, 1, 1, 0,
+       doc: /* Serve the requests of clients of the local socket FILE.
+Create FILE, replacing any file of that name, and accept connections
+on it forever.  For each connection, fork a copy of this Emacs that
+takes over the standard input, output and error passed by the client,
+and return in that copy the list of null-separated unibyte strings that
+the client sent.  When the copy exits, the client receives its exit
+status.
+
+This function never returns in the Emacs that calls it.  It is meant
+for `server-batch-start', which see.  */)
+  (Lisp_Object file)
+{
+#ifdef HAVE_FORK_SERVER
+  CHECK_STRING (file);
+  Lisp_Object encoded = ENCODE_FILE (Fexpand_file_name (file, Qnil));
+  struct sockaddr_un addr;
+  memset (&addr, 0, sizeof addr);
+  addr.sun_family = AF_LOCAL;
+  if (sizeof addr.sun_path <= SBYTES (encoded))
+    error ("Socket name too long: %s", SDATA (file));
+  memcpy (addr.sun_path, SSDATA (encoded), SBYTES (encoded));
+
+  int server = socket (AF_LOCAL, SOCK_STREAM, 0);
+  if (server < 0)
+    report_file_error ("Creating fork server socket", file);
+  fcntl (server, F_SETFD, FD_CLOEXEC);
+  unlink (addr.sun_path);
+  if (bind (server, (struct sockaddr *) &addr, sizeof addr) < 0
+      || listen (server, 16) < 0)
+    {
+      int err = errno;
+      emacs_close (server);
+      report_file_errno ("Starting fork server", file, err);
+    }
+
+  while (true)
+    {
+      int fd = accept (server, NULL, NULL);
+      if (fd < 0)
+	{
+	  if (errno == EINTR || errno == ECONNABORTED)
+	    {
+	      maybe_quit ();
+	      continue;
+	    }
+	  report_file_error ("Accepting fork server connection", file);
+	}
+      fcntl (fd, F_SETFD, FD_CLOEXEC);
+
+      fflush (NULL);
+      pid_t pid = fork ();
+      if (pid == 0)
+	{
+	  /* Fork again, so that the server reaps the intermediate
+	     child at once and never waits for the request.  */
+	  pid = fork ();
+	  if (pid != 0)
+	    _exit (pid < 0 ? EXIT_FAILURE : EXIT_SUCCESS);
+	  emacs_close (server);
+	  return fork_server_child (fd);
+	}
+      emacs_close (fd);
+      if (0 < pid)
+	wait_for_termination (pid, NULL, false);
+    }
+#else
+  error ("Fork servers are not supported on this system");
+#endif
+}
+
 void
 syms_of_emacs (void)
 {
@@ -3395,6 +3758,7 @@ syms_of_emacs (void)
   defsubr (&Sinvocation_directory);
   defsubr (&Sdaemonp);
   defsubr (&Sdaemon_initialized);
+  defsubr (&Sinternal__fork_server);
 
   DEFVAR_LISP ("command-line-args", Vcommand_line_args,
 	       doc: /* Args passed by shell to Emacs, as a list of strings.
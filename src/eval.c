@@ -1342,6 +1342,7 @@ unwind_to_catch (struct handler *catch, enum nonlocal_exit type,
   /* Restore certain special C variables.  */
   set_poll_suppress_count (catch->poll_suppress_count);
   unblock_input_to (catch->interrupt_input_blocked);
+  profiler_wait = catch->f_profiler_wait;
 
 #ifdef HAVE_X_WINDOWS
   /* Restore the X error handler stack.  This is important because
@@ -1366,7 +1367,7 @@ unwind_to_catch (struct handler *catch, enum nonlocal_exit type,
   lisp_eval_depth = catch->f_lisp_eval_depth;
   set_act_rec (current_thread, catch->act_rec);
 
-  sys_longjmp (catch->jmp, 1);
+  sys_longjmp (catch->bytecode_jmp ? *catch->bytecode_jmp : catch->jmp, 1);
 }
 
 DEFUN ("throw", Fthrow, Sthrow, 2, 2, 0,
@@ -1761,12 +1762,14 @@ push_handler_nosignal (Lisp_Object tag_ch_val, enum handlertype handlertype)
   c->type = handlertype;
   c->tag_or_ch = tag_ch_val;
   c->val = Qnil;
+  c->bytecode_jmp = NULL;
   c->next = handlerlist;
   c->f_lisp_eval_depth = lisp_eval_depth;
   c->pdlcount = SPECPDL_INDEX ();
   c->act_rec = get_act_rec (current_thread);
   c->poll_suppress_count = poll_suppress_count;
   c->interrupt_input_blocked = interrupt_input_blocked;
+  c->f_profiler_wait = profiler_wait;
 #ifdef HAVE_X_WINDOWS
   c->x_error_handler_depth = x_error_message_count;
 #endif
@@ -2532,6 +2535,7 @@ eval_sub (Lisp_Object form)
     {
       Lisp_Object args_left = original_args;
       ptrdiff_t numargs = list_length (args_left);
+      maybe_resolve_native_subr (XSUBR (fun));
 
       if (numargs < XSUBR (fun)->min_args
 	  || (XSUBR (fun)->max_args >= 0
@@ -3130,6 +3134,7 @@ safe_eval (Lisp_Object sexp)
 funcall_subr (struct Lisp_Subr *subr, ptrdiff_t numargs, Lisp_Object *args)
 {
   eassume (numargs >= 0);
+  maybe_resolve_native_subr (subr);
   if (numargs >= subr->min_args)
     {
       /* Conforming call to finite-arity subr.  */
@@ -3334,6 +3339,7 @@ funcall_lambda (Lisp_Object fun, ptrdiff_t nargs, Lisp_Object *arg_vector)
       eassert (NATIVE_COMP_FUNCTION_DYNP (fun));
       /* No need to use funcall_subr as we have zero arguments by
 	 construction.  */
+      maybe_resolve_native_subr (XSUBR (fun));
       val = XSUBR (fun)->function.a0 ();
     }
   else
@@ -3511,6 +3517,22 @@ do_specbind (struct Lisp_Symbol *sym, union specbinding *bind,
     }
 }
 
+/* Counts of the dynamic bindings made by `specbind', by the path they
+   took, and of the entries popped by `unbind_to', for
+   `specpdl-statistics'.  */
+
+enum specbind_path
+  {
+    SPECBIND_PLAIN,
+    SPECBIND_FORWARDED,
+    SPECBIND_PER_BUFFER,
+    SPECBIND_OTHER,
+    SPECBIND_PATHS
+  };
+
+static EMACS_UINT specbind_counts[SPECBIND_PATHS];
+static EMACS_UINT specpdl_unbind_count;
+
 /* `specpdl_ptr' describes which variable is
    let-bound, so it can be properly undone when we unbind_to.
    It can be either a plain SPECPDL_LET or a SPECPDL_LET_LOCAL/DEFAULT.
@@ -3541,9 +3563,74 @@ specbind (Lisp_Object symbol, Lisp_Object value)
       specpdl_ptr->let.symbol = symbol;
       specpdl_ptr->let.old_value = SYMBOL_VAL (sym);
       specpdl_ptr->let.where.kbd = NULL;
+      if (!sym->u.s.trapped_write)
+	{
+	  specbind_counts[SPECBIND_PLAIN]++;
+	  grow_specpdl ();
+	  SET_SYMBOL_VAL (sym, value);
+	  return;
+	}
       break;
-    case SYMBOL_LOCALIZED:
     case SYMBOL_FORWARDED:
+      /* Variables like `inhibit-read-only' that live in a C variable,
+	 and variables like `case-fold-search' that have a buffer-local
+	 value in the current buffer, need not go through
+	 `set_internal' either.  */
+      if (!sym->u.s.trapped_write)
+	{
+	  lispfwd fwd = SYMBOL_FWD (sym);
+	  if (BUFFER_OBJFWDP (fwd))
+	    {
+	      int offset = XBUFFER_OBJFWD (fwd)->offset;
+	      int idx = PER_BUFFER_IDX (offset);
+	      if (idx == -1 || PER_BUFFER_VALUE_P (current_buffer, idx))
+		{
+		  specpdl_ptr->let.kind = SPECPDL_LET_LOCAL;
+		  specpdl_ptr->let.symbol = symbol;
+		  specpdl_ptr->let.old_value
+		    = per_buffer_value (current_buffer, offset);
+		  specpdl_ptr->let.where.buf = Fcurrent_buffer ();
+		  specbind_counts[SPECBIND_PER_BUFFER]++;
+		  grow_specpdl ();
+		  store_symval_forwarding (fwd, value, current_buffer);
+		  return;
+		}
+	    }
+	  else if (!KBOARD_OBJFWDP (fwd))
+	    {
+	      specpdl_ptr->let.kind = SPECPDL_LET;
+	      specpdl_ptr->let.symbol = symbol;
+	      specpdl_ptr->let.old_value = do_symval_forwarding (fwd);
+	      specpdl_ptr->let.where.kbd = NULL;
+	      specbind_counts[SPECBIND_FORWARDED]++;
+	      grow_specpdl ();
+	      store_symval_forwarding (fwd, value, NULL);
+	      return;
+	    }
+	}
+      FALLTHROUGH;
+    case SYMBOL_LOCALIZED:
+      if (sym->u.s.redirect == SYMBOL_LOCALIZED && !sym->u.s.trapped_write)
+	{
+	  /* Likewise if the binding of the current buffer is loaded.  */
+	  struct Lisp_Buffer_Local_Value *blv = SYMBOL_BLV (sym);
+	  if (BASE_EQ (blv->where, Fcurrent_buffer ())
+	      && !BASE_EQ (blv->valcell, blv->defcell))
+	    {
+	      specpdl_ptr->let.kind = SPECPDL_LET_LOCAL;
+	      specpdl_ptr->let.symbol = symbol;
+	      specpdl_ptr->let.old_value = (blv->fwd.fwdptr
+					    ? do_symval_forwarding (blv->fwd)
+					    : XCDR (blv->valcell));
+	      specpdl_ptr->let.where.buf = blv->where;
+	      specbind_counts[SPECBIND_PER_BUFFER]++;
+	      grow_specpdl ();
+	      XSETCDR (blv->valcell, value);
+	      if (blv->fwd.fwdptr)
+		store_symval_forwarding (blv->fwd, value, current_buffer);
+	      return;
+	    }
+	}
       {
 	Lisp_Object ovalue = find_symbol_value (symbol);
 	specpdl_ptr->let.kind = SPECPDL_LET_LOCAL;
@@ -3581,6 +3668,7 @@ specbind (Lisp_Object symbol, Lisp_Object value)
       }
     default: emacs_abort ();
     }
+  specbind_counts[SPECBIND_OTHER]++;
   grow_specpdl ();
   do_specbind (sym, specpdl_ptr - 1, value, SET_INTERNAL_BIND);
 }
@@ -3729,6 +3817,19 @@ do_one_unbind (union specbinding *this_binding, bool unwinding,
                             Qnil, bindflag);
 	    break;
 	  }
+	/* Likewise if it is forwarded to an untrapped C variable.  */
+	if (SYMBOLP (sym)
+	    && XSYMBOL (sym)->u.s.redirect == SYMBOL_FORWARDED
+	    && !XSYMBOL (sym)->u.s.trapped_write)
+	  {
+	    lispfwd fwd = SYMBOL_FWD (XSYMBOL (sym));
+	    if (!BUFFER_OBJFWDP (fwd) && !KBOARD_OBJFWDP (fwd))
+	      {
+		store_symval_forwarding (fwd, specpdl_old_value (this_binding),
+					 NULL);
+		break;
+	      }
+	  }
       }
       /* Come here only if make_local_foo was used for the first time
 	 on this var within this let or the symbol is not a plainval.  */
@@ -3748,7 +3849,30 @@ do_one_unbind (union specbinding *this_binding, bool unwinding,
 
 	/* If this was a local binding, reset the value in the appropriate
 	   buffer, but only if that buffer's binding still exists.  */
-	if (!NILP (Flocal_variable_p (symbol, where)))
+	struct Lisp_Symbol *sym = XSYMBOL (symbol);
+	if (sym->u.s.redirect == SYMBOL_FORWARDED
+	    && !sym->u.s.trapped_write
+	    && BUFFER_OBJFWDP (SYMBOL_FWD (sym)))
+	  {
+	    /* The fast path of `local-variable-p' and `set_internal'.  */
+	    lispfwd fwd = SYMBOL_FWD (sym);
+	    int idx = PER_BUFFER_IDX (XBUFFER_OBJFWD (fwd)->offset);
+	    if (idx == -1 || PER_BUFFER_VALUE_P (XBUFFER (where), idx))
+	      store_symval_forwarding (fwd, old_value, XBUFFER (where));
+	  }
+	else if (sym->u.s.redirect == SYMBOL_LOCALIZED
+		 && !sym->u.s.trapped_write
+		 && BASE_EQ (SYMBOL_BLV (sym)->where, where)
+		 && !BASE_EQ (SYMBOL_BLV (sym)->valcell,
+			      SYMBOL_BLV (sym)->defcell))
+	  {
+	    /* WHERE's binding is still loaded.  */
+	    struct Lisp_Buffer_Local_Value *blv = SYMBOL_BLV (sym);
+	    XSETCDR (blv->valcell, old_value);
+	    if (blv->fwd.fwdptr)
+	      store_symval_forwarding (blv->fwd, old_value, XBUFFER (where));
+	  }
+	else if (!NILP (Flocal_variable_p (symbol, where)))
           set_internal (symbol, old_value, where, bindflag);
       }
       break;
@@ -3825,6 +3949,7 @@ unbind_to (specpdl_ref count, Lisp_Object value)
       union specbinding this_binding;
       this_binding = *--specpdl_ptr;
 
+      specpdl_unbind_count++;
       do_one_unbind (&this_binding, true, SET_INTERNAL_UNBIND);
     }
 
@@ -3834,6 +3959,43 @@ unbind_to (specpdl_ref count, Lisp_Object value)
   return value;
 }
 
+DEFUN ("specpdl-statistics", Fspecpdl_statistics, Sspecpdl_statistics,
+       0, 1, 0,
+       doc: /* Return statistics about dynamic binding in this session.
+The value is an alist with these elements:
+
+  (plain . N)       N bindings of variables with an ordinary value.
+  (forwarded . N)   N bindings of built-in variables stored in C variables.
+  (per-buffer . N)  N bindings of the value of a variable local to the
+                    current buffer.
+  (other . N)       N bindings of other variables, such as those with
+                    watchers, or buffer-local variables bound in a
+                    buffer where they have no local value.
+  (unbind . N)      N entries of the binding stack popped, including
+                    `unwind-protect' forms and other clean-ups.
+  (size . N)        N entries allocated to the binding stack of the
+                    current thread.
+
+If RESET is non-nil, reset the counts to zero after returning them.  */)
+  (Lisp_Object reset)
+{
+  Lisp_Object val
+    = list (Fcons (Qplain, make_uint (specbind_counts[SPECBIND_PLAIN])),
+	    Fcons (Qforwarded,
+		   make_uint (specbind_counts[SPECBIND_FORWARDED])),
+	    Fcons (Qper_buffer,
+		   make_uint (specbind_counts[SPECBIND_PER_BUFFER])),
+	    Fcons (Qother, make_uint (specbind_counts[SPECBIND_OTHER])),
+	    Fcons (Qunbind, make_uint (specpdl_unbind_count)),
+	    Fcons (Qsize, make_fixnum (specpdl_end - specpdl)));
+  if (!NILP (reset))
+    {
+      memset (specbind_counts, 0, sizeof specbind_counts);
+      specpdl_unbind_count = 0;
+    }
+  return val;
+}
+
 DEFUN ("special-variable-p", Fspecial_variable_p, Sspecial_variable_p, 1, 1, 0,
        doc: /* Return non-nil if SYMBOL's global binding has been declared special.
 A special variable is one that will be bound dynamically, even in a
@@ -4543,6 +4705,13 @@ syms_of_eval (void)
   defsubr (&Sbacktrace_eval);
   defsubr (&Sbacktrace__locals);
   defsubr (&Sspecial_variable_p);
+  defsubr (&Sspecpdl_statistics);
+  DEFSYM (Qplain, "plain");
+  DEFSYM (Qforwarded, "forwarded");
+  DEFSYM (Qper_buffer, "per-buffer");
+  DEFSYM (Qother, "other");
+  DEFSYM (Qunbind, "unbind");
+  DEFSYM (Qsize, "size");
   DEFSYM (Qfunctionp, "functionp");
   defsubr (&Sfunctionp);
 }
@@ -55,6 +55,7 @@ Copyright (C) 1985-1988, 1993-2025 Free Software Foundation, Inc.
 #include "blockinput.h"
 #include "region-cache.h"
 #include "frame.h"
+#include "probes.h"
 
 #ifdef HAVE_ANDROID
 #include "android.h"
@@ -124,7 +125,7 @@ #define DRIVE_LETTER(x) c_tolower (x)
 
 #define emacs_fd_open		emacs_open
 #define emacs_fd_close		emacs_close
-#define emacs_fd_read		emacs_read_quit
+#define emacs_fd_read_1		emacs_read_quit
 #define emacs_fd_lseek		lseek
 #define emacs_fd_fstat		sys_fstat
 #define emacs_fd_valid_p(fd)	((fd) >= 0)
@@ -141,7 +142,7 @@ #define emacs_fd_to_int(fds)	(fds)
 
 #define emacs_fd_open		android_open_asset
 #define emacs_fd_close		android_close_asset
-#define emacs_fd_read		android_asset_read_quit
+#define emacs_fd_read_1		android_asset_read_quit
 #define emacs_fd_lseek		android_asset_lseek
 #define emacs_fd_fstat		android_asset_fstat
 #define emacs_fd_valid_p(fd)	((fd).asset != ((void *) -1))
@@ -149,6 +150,31 @@ #define emacs_fd_to_int(fds)	((fds).asset ? -1 : (fds).fd)
 
 #endif /* !defined HAVE_ANDROID || defined ANDROID_STUBIFY */
 
+/* Read up to NBYTE bytes from FD into BUF, attributing the time to
+   file I/O in wall-clock profiles.  */
+
+static ptrdiff_t
+emacs_fd_read (emacs_fd fd, void *buf, ptrdiff_t nbyte)
+{
+  int wait = profiler_wait;
+  profiler_wait = PROFILER_WAIT_FILE;
+  ptrdiff_t nread = emacs_fd_read_1 (fd, buf, nbyte);
+  profiler_wait = wait;
+  return nread;
+}
+
+/* Likewise for writing NBYTE bytes from BUF to FD.  */
+
+static ptrdiff_t
+file_write_quit (int fd, void const *buf, ptrdiff_t nbyte)
+{
+  int wait = profiler_wait;
+  profiler_wait = PROFILER_WAIT_FILE;
+  ptrdiff_t nwritten = emacs_write_quit (fd, buf, nbyte);
+  profiler_wait = wait;
+  return nwritten;
+}
+
 /* True during writing of auto-save files.  */
 static bool auto_saving;
 
@@ -2437,7 +2463,7 @@ DEFUN ("copy-file", Fcopy_file, Scopy_file, 2, 6,
 	    {
 	      if (copied < 0)
 		report_file_error ("Read error", file);
-	      if (emacs_write_quit (ofd, buf, copied) != copied)
+	      if (file_write_quit (ofd, buf, copied) != copied)
 		report_file_error ("Write error", newname);
 	    }
 	}
@@ -2557,6 +2583,7 @@ DEFUN ("copy-file", Fcopy_file, Scopy_file, 2, 6,
   /* Discard the unwind protects.  */
   specpdl_ptr = specpdl_ref_to_ptr (count);
 
+  file_attribute_cache_flush ();
   return Qnil;
 }
 
@@ -2577,6 +2604,7 @@ DEFUN ("make-directory-internal", Fmake_directory_internal,
 
   if (emacs_mkdir (dir, 0777 & ~auto_saving_dir_umask) != 0)
     report_file_error ("Creating directory", directory);
+  file_attribute_cache_flush ();
 
   return Qnil;
 }
@@ -2596,6 +2624,7 @@ DEFUN ("delete-directory-internal", Fdelete_directory_internal,
 
   if (emacs_rmdir (dir) != 0)
     report_file_error ("Removing directory", directory);
+  file_attribute_cache_flush ();
 
   return Qnil;
 }
@@ -2615,6 +2644,7 @@ DEFUN ("delete-file-internal", Fdelete_file_internal, Sdelete_file_internal, 1,
   if (emacs_unlink (SSDATA (encoded_file)) != 0
       && errno != ENOENT)
     report_file_error ("Removing old name", filename);
+  file_attribute_cache_flush ();
   return Qnil;
 }
 
@@ -2781,7 +2811,10 @@ DEFUN ("rename-file", Frename_file, Srename_file, 2, 3,
 				    AT_FDCWD,
 				    SSDATA (encoded_newname))
 	  == 0)
-	return Qnil;
+	{
+	  file_attribute_cache_flush ();
+	  return Qnil;
+	}
 
       rename_errno = errno;
       switch (rename_errno)
@@ -2803,7 +2836,10 @@ DEFUN ("rename-file", Frename_file, Srename_file, 2, 3,
     {
       if (emacs_rename (SSDATA (encoded_file),
 			SSDATA (encoded_newname)) == 0)
-	return Qnil;
+	{
+	  file_attribute_cache_flush ();
+	  return Qnil;
+	}
       rename_errno = errno;
       /* Don't prompt again.  */
       ok_if_already_exists = Qt;
@@ -2889,7 +2925,10 @@ DEFUN ("add-name-to-file", Fadd_name_to_file, Sadd_name_to_file, 2, 3,
 		      " within special directory");
 
   if (link (SSDATA (encoded_file), SSDATA (encoded_newname)) == 0)
-    return Qnil;
+    {
+      file_attribute_cache_flush ();
+      return Qnil;
+    }
 
   if (errno == EEXIST)
     {
@@ -2898,6 +2937,7 @@ DEFUN ("add-name-to-file", Fadd_name_to_file, Sadd_name_to_file, 2, 3,
 	barf_or_query_if_file_exists (newname, true, "make it a new name",
 				      FIXNUMP (ok_if_already_exists), false);
       emacs_unlink (SSDATA (newname));
+      file_attribute_cache_flush ();
       if (link (SSDATA (encoded_file), SSDATA (encoded_newname)) == 0)
 	return Qnil;
     }
@@ -2943,7 +2983,10 @@ DEFUN ("make-symbolic-link", Fmake_symbolic_link, Smake_symbolic_link, 2, 3,
 
   if (emacs_symlink (SSDATA (encoded_target),
 		     SSDATA (encoded_linkname)) == 0)
-    return Qnil;
+    {
+      file_attribute_cache_flush ();
+      return Qnil;
+    }
 
   if (errno == ENOSYS)
     xsignal1 (Qfile_error,
@@ -2956,6 +2999,7 @@ DEFUN ("make-symbolic-link", Fmake_symbolic_link, Smake_symbolic_link, 2, 3,
 	barf_or_query_if_file_exists (linkname, true, "make it a link",
 				      FIXNUMP (ok_if_already_exists), false);
       emacs_unlink (SSDATA (encoded_linkname));
+      file_attribute_cache_flush ();
       if (emacs_symlink (SSDATA (encoded_target),
 			 SSDATA (encoded_linkname)) == 0)
 	return Qnil;
@@ -2986,11 +3030,111 @@ file_name_absolute_p (char const *filename)
 		  || user_homedir (&filename[1]))));
 }
 
+/* The file attribute cache.  When `file-attribute-cache-ttl' is a
+   positive number, the results of `file-attributes', `file-exists-p',
+   `file-readable-p' and `file-executable-p' for local files are
+   remembered for that many seconds, so that code asking about the same
+   file over and over does not go to the file system each time, which
+   is slow on network file systems.  The table maps expanded file names
+   to vectors indexed by enum file_attribute_cache_slot, whose elements
+   are nil or (VALUE . EXPIRY), EXPIRY being a float time.  Emacs
+   flushes the whole cache whenever it changes a file itself, and when
+   a file notification arrives.  */
+static Lisp_Object file_attribute_cache;
+
+/* Start over when the cache grows this large, so that entries for
+   files nobody asks about any more do not accumulate.  */
+enum { FILE_ATTRIBUTE_CACHE_MAX = 4096 };
+
+static double
+file_attribute_cache_ttl (void)
+{
+  return (FIXNUMP (Vfile_attribute_cache_ttl)
+	  ? XFIXNUM (Vfile_attribute_cache_ttl)
+	  : FLOATP (Vfile_attribute_cache_ttl)
+	  ? XFLOAT_DATA (Vfile_attribute_cache_ttl)
+	  : 0);
+}
+
+/* If the cache has an unexpired entry for SLOT of the expanded file
+   name FILE, store it in *VALUE and return true.  */
+
+bool
+file_attribute_cache_lookup (Lisp_Object file,
+			     enum file_attribute_cache_slot slot,
+			     Lisp_Object *value)
+{
+  if (! (HASH_TABLE_P (file_attribute_cache)
+	 && file_attribute_cache_ttl () > 0))
+    return false;
+  Lisp_Object entry = Fgethash (file, file_attribute_cache, Qnil);
+  if (!VECTORP (entry))
+    return false;
+  Lisp_Object cached = AREF (entry, slot);
+  if (! (CONSP (cached)
+	 && timespectod (current_timespec ()) < XFLOAT_DATA (XCDR (cached))))
+    return false;
+  *value = XCAR (cached);
+  file_attribute_cache_hits++;
+  return true;
+}
+
+/* Remember VALUE for SLOT of the expanded file name FILE, if the cache
+   is enabled.  A list VALUE is copied, so that the caller may return
+   it to Lisp code that modifies it.  */
+
+void
+file_attribute_cache_store (Lisp_Object file,
+			    enum file_attribute_cache_slot slot,
+			    Lisp_Object value)
+{
+  double ttl = file_attribute_cache_ttl ();
+  if (! (ttl > 0))
+    return;
+  if (! (HASH_TABLE_P (file_attribute_cache)
+	 && (XHASH_TABLE (file_attribute_cache)->count
+	     < FILE_ATTRIBUTE_CACHE_MAX)))
+    file_attribute_cache
+      = make_hash_table (&hashtest_equal, DEFAULT_HASH_SIZE, Weak_None);
+  Lisp_Object entry = Fgethash (file, file_attribute_cache, Qnil);
+  if (!VECTORP (entry))
+    {
+      entry = make_nil_vector (FILE_ATTRIBUTE_CACHE_SLOTS);
+      Fputhash (Fcopy_sequence (file), entry, file_attribute_cache);
+    }
+  if (CONSP (value))
+    value = Fcopy_sequence (value);
+  ASET (entry, slot,
+	Fcons (value, make_float (timespectod (current_timespec ()) + ttl)));
+}
+
+/* Forget everything in the file attribute cache.  */
+
+void
+file_attribute_cache_flush (void)
+{
+  file_attribute_cache = Qnil;
+}
+
+DEFUN ("clear-file-attribute-cache", Fclear_file_attribute_cache,
+       Sclear_file_attribute_cache, 0, 0, 0,
+       doc: /* Forget the file attributes remembered so far.
+Call this after changing files behind Emacs's back, if you want
+`file-attributes' and similar functions to see the changes before
+`file-attribute-cache-ttl' seconds have passed.  */)
+  (void)
+{
+  file_attribute_cache_flush ();
+  return Qnil;
+}
+
 /* Return t if FILE exists and is accessible via OPERATION and AMODE,
-   nil (setting errno) if not.  */
+   nil (setting errno) if not.  SLOT is where the file attribute cache
+   keeps the result.  */
 
 static Lisp_Object
-check_file_access (Lisp_Object file, Lisp_Object operation, int amode)
+check_file_access (Lisp_Object file, Lisp_Object operation, int amode,
+		   enum file_attribute_cache_slot slot)
 {
   file = Fexpand_file_name (file, Qnil);
   Lisp_Object handler = Ffind_file_name_handler (file, operation);
@@ -3004,8 +3148,20 @@ check_file_access (Lisp_Object file, Lisp_Object operation, int amode)
       return ok;
     }
 
+  /* The cache holds t, or the errno value for nil.  */
+  Lisp_Object cached;
+  if (file_attribute_cache_lookup (file, slot, &cached))
+    {
+      if (EQ (cached, Qt))
+	return Qt;
+      errno = XFIXNUM (cached);
+      return Qnil;
+    }
+
   char *encoded_file = SSDATA (ENCODE_FILE (file));
-  return file_access_p (encoded_file, amode) ? Qt : Qnil;
+  bool ok = file_access_p (encoded_file, amode);
+  file_attribute_cache_store (file, slot, ok ? Qt : make_fixnum (errno));
+  return ok ? Qt : Qnil;
 }
 
 DEFUN ("file-exists-p", Ffile_exists_p, Sfile_exists_p, 1, 1, 0,
@@ -3017,7 +3173,8 @@ DEFUN ("file-exists-p", Ffile_exists_p, Sfile_exists_p, 1, 1, 0,
 Use `file-symlink-p' to test for such links.  */)
   (Lisp_Object filename)
 {
-  return check_file_access (filename, Qfile_exists_p, F_OK);
+  return check_file_access (filename, Qfile_exists_p, F_OK,
+			    FILE_ATTRIBUTE_CACHE_EXISTS);
 }
 
 DEFUN ("file-executable-p", Ffile_executable_p, Sfile_executable_p, 1, 1, 0,
@@ -3027,7 +3184,8 @@ DEFUN ("file-executable-p", Ffile_executable_p, Sfile_executable_p, 1, 1, 0,
 purpose, though.)  */)
   (Lisp_Object filename)
 {
-  return check_file_access (filename, Qfile_executable_p, X_OK);
+  return check_file_access (filename, Qfile_executable_p, X_OK,
+			    FILE_ATTRIBUTE_CACHE_EXECUTABLE);
 }
 
 DEFUN ("file-readable-p", Ffile_readable_p, Sfile_readable_p, 1, 1, 0,
@@ -3035,7 +3193,8 @@ DEFUN ("file-readable-p", Ffile_readable_p, Sfile_readable_p, 1, 1, 0,
 See also `file-exists-p' and `file-attributes'.  */)
   (Lisp_Object filename)
 {
-  return check_file_access (filename, Qfile_readable_p, R_OK);
+  return check_file_access (filename, Qfile_readable_p, R_OK,
+			    FILE_ATTRIBUTE_CACHE_READABLE);
 }
 
 DEFUN ("file-writable-p", Ffile_writable_p, Sfile_writable_p, 1, 1, 0,
@@ -3694,6 +3853,7 @@ DEFUN ("set-file-modes", Fset_file_modes, Sset_file_modes, 2, 3,
   mode_t imode = XFIXNUM (mode) & 07777;
   if (emacs_fchmodat (AT_FDCWD, fname, imode, nofollow) != 0)
     report_file_error ("Doing chmod", absname);
+  file_attribute_cache_flush ();
 
   return Qnil;
 }
@@ -3777,6 +3937,7 @@ DEFUN ("set-file-times", Fset_file_times, Sset_file_times, 1, 3, 0,
       report_file_error ("Setting file times", absname);
     }
 
+  file_attribute_cache_flush ();
   return Qt;
 }
 
@@ -3841,6 +4002,14 @@ DEFUN ("file-newer-than-file-p", Ffile_newer_than_file_p, Sfile_newer_than_file_
 
 enum { READ_BUF_SIZE = MAX_ALLOCA };
 
+/* The most bytes that insert-file-contents asks for in a single read
+   when it reads a seekable file straight into the gap.  This is much
+   larger than READ_BUF_SIZE, as the size of the file is known and
+   no stack buffer is involved, and it saves most of the system calls
+   needed for a large file.  It is still small enough for C-g to take
+   effect quickly on a slow file system.  */
+enum { READ_GAP_SIZE = 1024 * 1024 };
+
 /* This function is called after Lisp functions to decide a coding
    system are called, or when they cause an error.  Before they are
    called, the current buffer is set unibyte and it contains only a
@@ -3869,7 +4038,7 @@ decide_coding_unwind (Lisp_Object unwind_data)
   /* We're about to "delete" the text by moving it back into the gap.
      So move markers that set-auto-coding might have created to BEG,
      just in case.  */
-  adjust_markers_for_delete (BEG, BEG_BYTE, Z, Z_BYTE);
+  adjust_markers_for_delete (BEG, BEG_BYTE, Z, Z_BYTE, false);
   adjust_overlays_for_delete (BEG, Z - BEG);
   set_buffer_intervals (current_buffer, NULL);
   TEMP_SET_PT_BOTH (BEG, BEG_BYTE);
@@ -4126,6 +4295,7 @@ DEFUN ("insert-file-contents", Finsert_file_contents, Sinsert_file_contents,
 
   CHECK_STRING (filename);
   filename = Fexpand_file_name (filename, Qnil);
+  EMACS_PROBE1 (insert_file_contents_start, SSDATA (filename));
 
   /* The value Qnil means that the coding system is not yet
      decided.  */
@@ -4158,7 +4328,17 @@ DEFUN ("insert-file-contents", Finsert_file_contents, Sinsert_file_contents,
   orig_filename = filename;
   filename = ENCODE_FILE (filename);
 
+#ifdef WINDOWSNT
+  /* MS-Windows has no posix_fadvise, but the file can be opened with
+     FILE_FLAG_SEQUENTIAL_SCAN, which lets the system read ahead as
+     POSIX_FADV_SEQUENTIAL does below.  This matters most for files on
+     network shares.  REPLACE makes us read from both ends of the
+     file, so don't ask for that then.  */
+  fd = emacs_fd_open (SSDATA (filename),
+		      O_RDONLY | (NILP (replace) ? _O_SEQUENTIAL : 0), 0);
+#else
   fd = emacs_fd_open (SSDATA (filename), O_RDONLY, 0);
+#endif
   if (!emacs_fd_valid_p (fd))
     {
       save_errno = errno;
@@ -4797,6 +4977,15 @@ DEFUN ("insert-file-contents", Finsert_file_contents, Sinsert_file_contents,
 	report_file_error ("Setting file position", orig_filename);
     }
 
+#ifdef HAVE_POSIX_FADVISE
+  /* A large file is read from start to end exactly once, so let the
+     kernel read ahead more aggressively.  This is only a hint, so
+     ignore failure.  */
+  if (regular && total > READ_GAP_SIZE && emacs_fd_to_int (fd) >= 0)
+    posix_fadvise (emacs_fd_to_int (fd), beg_offset, total,
+		   POSIX_FADV_SEQUENTIAL);
+#endif
+
   /* Total bytes inserted.  */
   inserted = 0;
 
@@ -4817,7 +5006,8 @@ DEFUN ("insert-file-contents", Finsert_file_contents, Sinsert_file_contents,
 	  }
 
 	/* 'try' is reserved in some compilers (Microsoft C).  */
-	ptrdiff_t trytry = min (gap_size, READ_BUF_SIZE);
+	ptrdiff_t trytry = min (gap_size, (seekable
+					   ? READ_GAP_SIZE : READ_BUF_SIZE));
 	if (seekable || !NILP (end))
 	  trytry = min (trytry, total - inserted);
 
@@ -5211,6 +5401,7 @@ DEFUN ("insert-file-contents", Finsert_file_contents, Sinsert_file_contents,
   if (NILP (val))
     val = list2 (orig_filename, make_fixnum (inserted));
 
+  EMACS_PROBE1 (insert_file_contents_done, inserted);
   return unbind_to (count, val);
 }
 
@@ -5578,6 +5769,9 @@ write_region (Lisp_Object start, Lisp_Object end, Lisp_Object filename,
      files, since they might lose some work anyway.  */
   if (open_and_close_file && !auto_saving && !write_region_inhibit_fsync)
     {
+      int wait = profiler_wait;
+      profiler_wait = PROFILER_WAIT_FILE;
+
       /* Transfer data and metadata to disk, retrying if interrupted.
 	 fsync can report a write failure here, e.g., due to disk full
 	 under NFS.  But ignore EINVAL (and EBADF on Windows), which
@@ -5593,6 +5787,7 @@ write_region (Lisp_Object start, Lisp_Object end, Lisp_Object filename,
 	      ok = 0, save_errno = errno;
 	    break;
 	  }
+      profiler_wait = wait;
     }
 
   modtime = invalid_timespec ();
@@ -5696,6 +5891,7 @@ write_region (Lisp_Object start, Lisp_Object end, Lisp_Object filename,
     }
 
   unbind_to (count, Qnil);
+  file_attribute_cache_flush ();
 
   if (file_locked)
     Funlock_file (lockname);
@@ -5980,7 +6176,7 @@ e_write (int desc, Lisp_Object string, ptrdiff_t start, ptrdiff_t end,
 		       : (STRINGP (coding->dst_object)
 			  ? SSDATA (coding->dst_object)
 			  : (char *) BYTE_POS_ADDR (coding->dst_pos_byte)));
-	  coding->produced -= emacs_write_quit (desc, buf, coding->produced);
+	  coding->produced -= file_write_quit (desc, buf, coding->produced);
 
 	  if (coding->raw_destination)
 	    {
@@ -6857,6 +7053,31 @@ do (file-exists-p FILENAME) and FILENAME is handled by HANDLER, then
   delete_by_moving_to_trash = 0;
   DEFSYM (Qdelete_by_moving_to_trash, "delete-by-moving-to-trash");
 
+  DEFVAR_LISP ("file-attribute-cache-ttl", Vfile_attribute_cache_ttl,
+	       doc: /* Seconds for which to remember the attributes of local files.
+If this is a positive number, `file-attributes', `file-exists-p',
+`file-readable-p' and `file-executable-p' remember their results for
+local files for that many seconds, and return them again without
+asking the file system.  This can speed up code that asks about the
+same files repeatedly, such as mode line and version control code, on
+slow network file systems.
+
+Emacs forgets the remembered results whenever it creates, deletes,
+renames or changes a file itself, and whenever a file notification
+arrives (see `file-notify-add-watch').  Changes made by other programs
+are only seen once the remembered results expire, or after calling
+`clear-file-attribute-cache'.  A value of nil, the default, disables
+the cache.  */);
+  Vfile_attribute_cache_ttl = Qnil;
+
+  DEFVAR_INT ("file-attribute-cache-hits", file_attribute_cache_hits,
+	      doc: /* Number of file system queries avoided by the file attribute cache.
+See `file-attribute-cache-ttl'.  */);
+  file_attribute_cache_hits = 0;
+
+  staticpro (&file_attribute_cache);
+  file_attribute_cache = Qnil;
+
   /* Lisp function for interactive file delete with trashing */
   DEFSYM (Qdelete_file, "delete-file");
 
@@ -6894,6 +7115,7 @@ do (file-exists-p FILENAME) and FILENAME is handled by HANDLER, then
   defsubr (&Sadd_name_to_file);
   defsubr (&Smake_symbolic_link);
   defsubr (&Sfile_name_absolute_p);
+  defsubr (&Sclear_file_attribute_cache);
   defsubr (&Sfile_exists_p);
   defsubr (&Sfile_executable_p);
   defsubr (&Sfile_readable_p);
@@ -44,6 +44,7 @@ Copyright (C) 1985-1987, 1993-1994, 1996, 1998-2025 Free Software
 #include "lisp.h"
 #include "buffer.h"
 #include "coding.h"
+#include "systime.h"
 #ifdef WINDOWSNT
 #include <share.h>
 #include <sys/socket.h>	/* for fcntl */
@@ -119,10 +120,19 @@ get_boot_sec (void)
   if (will_dump_p ())
     return 0;
 
-  struct timespec boot_time;
-  boot_time.tv_sec = 0;
-  get_boot_time (&boot_time);
-  return boot_time.tv_sec;
+  /* The boot time does not change while Emacs runs, and finding it
+     can mean reading a file, so do that only once.  */
+  static time_t boot_sec;
+  static bool boot_sec_known;
+  if (!boot_sec_known)
+    {
+      struct timespec boot_time;
+      boot_time.tv_sec = 0;
+      get_boot_time (&boot_time);
+      boot_sec = boot_time.tv_sec;
+      boot_sec_known = true;
+    }
+  return boot_sec;
 }
 
 /* An arbitrary limit on lock contents length.  8 K should be plenty
@@ -531,6 +541,62 @@ lock_if_free (lock_info_type *clasher, Lisp_Object lfname)
   return err;
 }
 
+/* Directories where creating a lock file recently failed in a way
+   that is likely to persist, for instance because the directory is
+   read-only, as an alist of (DIRECTORY . RETRY-TIME).  DIRECTORY is
+   an encoded string and RETRY-TIME a float time.  Until RETRY-TIME,
+   Emacs neither locks nor unlocks files in DIRECTORY, because each
+   failed attempt can take a long time on a network file system, and
+   locking is attempted on the first modification of every buffer.  */
+static Lisp_Object unlockable_directories;
+
+/* How many seconds to wait before trying again to create lock files
+   in a directory listed in unlockable_directories.  */
+enum { LOCK_DIRECTORY_RETRY_INTERVAL = 60 };
+
+/* Return the directory part of the encoded lock file name LFNAME.  */
+
+static Lisp_Object
+lock_file_directory (Lisp_Object lfname)
+{
+  char *name = SSDATA (lfname);
+  char *last_slash = strrchr (name, '/');
+  return make_unibyte_string (name, last_slash ? last_slash - name : 0);
+}
+
+/* Return true if Emacs recently failed to create a lock file in the
+   directory of LFNAME, and should not try again yet.  */
+
+static bool
+lock_directory_unwritable_p (Lisp_Object lfname)
+{
+  if (NILP (unlockable_directories))
+    return false;
+  Lisp_Object entry = Fassoc (lock_file_directory (lfname),
+			      unlockable_directories, Qnil);
+  if (NILP (entry))
+    return false;
+  if (timespectod (current_timespec ()) < XFLOAT_DATA (XCDR (entry)))
+    return true;
+  unlockable_directories = Fdelq (entry, unlockable_directories);
+  return false;
+}
+
+/* Note that creating the lock file LFNAME failed with error ERR.  */
+
+static void
+note_lock_failure (Lisp_Object lfname, int err)
+{
+  if (err == EACCES || err == EROFS || err == ENOENT || err == ENOTDIR)
+    {
+      double retry = (timespectod (current_timespec ())
+		      + LOCK_DIRECTORY_RETRY_INTERVAL);
+      unlockable_directories
+	= Fcons (Fcons (lock_file_directory (lfname), make_float (retry)),
+		 unlockable_directories);
+    }
+}
+
 /* Return the encoded name of the lock file for FN, or nil if none.  */
 
 static Lisp_Object
@@ -607,12 +673,15 @@ lock_file (Lisp_Object fn)
       && !(!NILP (lfname) && current_lock_owner (NULL, lfname) == I_OWN_IT))
     calln (intern ("userlock--ask-user-about-supersession-threat"), fn);
 
-  /* Don't do locking if the user has opted out.  */
-  if (!NILP (lfname))
+  /* Don't do locking if the user has opted out, or if it failed
+     recently.  */
+  if (!NILP (lfname) && !lock_directory_unwritable_p (lfname))
     {
       /* Try to lock the lock.  FIXME: This ignores errors when
-	 lock_if_free returns an errno value.  */
-      if (lock_if_free (&lock_info, lfname) == ANOTHER_OWNS_IT)
+	 lock_if_free returns an errno value, except to avoid trying
+	 again soon.  */
+      int err = lock_if_free (&lock_info, lfname);
+      if (err == ANOTHER_OWNS_IT)
 	{
 	  /* Someone else has the lock.  Consider breaking it.  */
 	  Lisp_Object attack;
@@ -629,6 +698,8 @@ lock_file (Lisp_Object fn)
 	  if (!NILP (attack))
 	    lock_file_1 (lfname, 1);
 	}
+      else if (err != 0)
+	note_lock_failure (lfname, err);
     }
   return Qnil;
 }
@@ -637,7 +708,7 @@ lock_file (Lisp_Object fn)
 unlock_file (Lisp_Object fn)
 {
   Lisp_Object lfname = make_lock_file_name (fn);
-  if (NILP (lfname))
+  if (NILP (lfname) || lock_directory_unwritable_p (lfname))
     return Qnil;
 
   int err = current_lock_owner (0, lfname);
@@ -822,6 +893,11 @@ syms_of_filelock (void)
 Info node `(emacs)Interlocking'.  */);
   create_lockfiles = true;
 
+#ifndef MSDOS
+  staticpro (&unlockable_directories);
+  unlockable_directories = Qnil;
+#endif
+
   DEFSYM (Qlock_file, "lock-file");
   DEFSYM (Qunlock_file, "unlock-file");
   DEFSYM (Qfile_locked_p, "file-locked-p");
@@ -26,6 +26,7 @@ Copyright (C) 1985-2025 Free Software Foundation, Inc.
 #include <intprops.h>
 #include <vla.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <math.h>
 
 #include "lisp.h"
@@ -269,22 +270,109 @@ DEFUN ("string-bytes", Fstring_bytes, Sstring_bytes, 1, 1, 0,
   return make_fixnum (SBYTES (string));
 }
 
-DEFUN ("string-distance", Fstring_distance, Sstring_distance, 2, 3, 0,
-       doc: /* Return Levenshtein distance between STRING1 and STRING2.
-The distance is the number of deletions, insertions, and substitutions
-required to transform STRING1 into STRING2.
-If BYTECOMPARE is nil or omitted, compute distance in terms of characters.
-If BYTECOMPARE is non-nil, compute distance in terms of bytes.
-Letter-case is significant, but text properties are ignored. */)
-  (Lisp_Object string1, Lisp_Object string2, Lisp_Object bytecompare)
+/* The longest string, in characters or bytes, that
+   levenshtein_bitparallel handles as its pattern.  */
+enum { LEVENSHTEIN_PATTERN_MAX = 64 };
 
+/* A pattern string for levenshtein_bitparallel.  For each character C
+   of the pattern, the bit I of its mask is set if C is the Ith
+   character of the pattern.  Characters below 256 have their masks in
+   LOW; the others are in an open-addressed table.  */
+struct levenshtein_pattern
 {
-  CHECK_STRING (string1);
-  CHECK_STRING (string2);
+  ptrdiff_t length;
+  uint_least64_t low[256];
+  int high_char[2 * LEVENSHTEIN_PATTERN_MAX];
+  uint_least64_t high_mask[2 * LEVENSHTEIN_PATTERN_MAX];
+};
+
+/* Return the slot for character C >= 256 in P's table.  */
+static int
+levenshtein_pattern_slot (struct levenshtein_pattern const *p, int c)
+{
+  int i = (c * 0x9E3779B1u) >> 25;
+  while (p->high_char[i] != c && p->high_char[i] >= 0)
+    i = (i + 1) % (2 * LEVENSHTEIN_PATTERN_MAX);
+  return i;
+}
+
+static uint_least64_t
+levenshtein_pattern_mask (struct levenshtein_pattern const *p, int c)
+{
+  return (c < 256 ? p->low[c]
+	  : p->high_mask[levenshtein_pattern_slot (p, c)]);
+}
+
+/* Set up P for STRING, which has no more than LEVENSHTEIN_PATTERN_MAX
+   characters, or bytes if BYTES.  */
+static void
+levenshtein_pattern_init (struct levenshtein_pattern *p, Lisp_Object string,
+			  bool bytes)
+{
+  memset (p->low, 0, sizeof p->low);
+  memset (p->high_char, -1, sizeof p->high_char);
+  memset (p->high_mask, 0, sizeof p->high_mask);
+  p->length = bytes ? SBYTES (string) : SCHARS (string);
+  eassert (p->length <= LEVENSHTEIN_PATTERN_MAX);
+  ptrdiff_t ichar = 0, ibyte = 0;
+  for (ptrdiff_t i = 0; i < p->length; i++)
+    {
+      int c = (bytes ? SREF (string, i)
+	       : fetch_string_char_advance (string, &ichar, &ibyte));
+      uint_least64_t bit = (uint_least64_t) 1 << i;
+      if (c < 256)
+	p->low[c] |= bit;
+      else
+	{
+	  int slot = levenshtein_pattern_slot (p, c);
+	  p->high_char[slot] = c;
+	  p->high_mask[slot] |= bit;
+	}
+    }
+}
 
-  bool use_byte_compare =
-    !NILP (bytecompare)
-    || (!STRING_MULTIBYTE (string1) && !STRING_MULTIBYTE (string2));
+/* Return the Levenshtein distance between pattern P and the
+   characters, or bytes if BYTES, of TEXT.  This is the bit-vector
+   algorithm of Myers, as formulated by Hyyrö, which computes a whole
+   column of the distance matrix in a few word operations.  */
+static ptrdiff_t
+levenshtein_bitparallel (struct levenshtein_pattern const *p,
+			 Lisp_Object text, bool bytes)
+{
+  ptrdiff_t len = bytes ? SBYTES (text) : SCHARS (text);
+  if (p->length == 0)
+    return len;
+
+  uint_least64_t last = (uint_least64_t) 1 << (p->length - 1);
+  uint_least64_t pv = -1, mv = 0;
+  ptrdiff_t score = p->length;
+  ptrdiff_t ichar = 0, ibyte = 0;
+  for (ptrdiff_t i = 0; i < len; i++)
+    {
+      int c = (bytes ? SREF (text, i)
+	       : fetch_string_char_advance (text, &ichar, &ibyte));
+      uint_least64_t eq = levenshtein_pattern_mask (p, c);
+      uint_least64_t xv = eq | mv;
+      uint_least64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+      uint_least64_t ph = mv | ~(xh | pv);
+      uint_least64_t mh = pv & xh;
+      score += (ph & last) != 0;
+      score -= (mh & last) != 0;
+      ph = ph << 1 | 1;
+      mh <<= 1;
+      pv = mh | ~(xv | ph);
+      mv = ph & xv;
+    }
+  return score;
+}
+
+/* Return the Levenshtein distance between STRING1 and STRING2,
+   comparing bytes if USE_BYTE_COMPARE, with the classic dynamic
+   programming algorithm.  */
+static ptrdiff_t
+levenshtein_dp (Lisp_Object string1, Lisp_Object string2,
+		bool use_byte_compare)
+{
   ptrdiff_t len1 = use_byte_compare ? SBYTES (string1) : SCHARS (string1);
   ptrdiff_t len2 = use_byte_compare ? SBYTES (string2) : SCHARS (string2);
   ptrdiff_t x, y, lastdiag, olddiag;
@@ -332,8 +420,107 @@ DEFUN ("string-distance", Fstring_distance, Sstring_distance, 2, 3, 0,
         }
     }
 
+  ptrdiff_t distance = column[len1];
   SAFE_FREE ();
-  return make_fixnum (column[len1]);
+  return distance;
+}
+
+/* Return the Levenshtein distance between STRING1 and STRING2, as
+   described for `string-distance'.  */
+static ptrdiff_t
+string_distance (Lisp_Object string1, Lisp_Object string2,
+		 bool bytecompare)
+{
+  bool use_byte_compare
+    = bytecompare || (!STRING_MULTIBYTE (string1)
+		      && !STRING_MULTIBYTE (string2));
+  bool bytes1 = use_byte_compare || !STRING_MULTIBYTE (string1);
+  bool bytes2 = use_byte_compare || !STRING_MULTIBYTE (string2);
+  ptrdiff_t len1 = bytes1 ? SBYTES (string1) : SCHARS (string1);
+  ptrdiff_t len2 = bytes2 ? SBYTES (string2) : SCHARS (string2);
+
+  if (min (len1, len2) > LEVENSHTEIN_PATTERN_MAX)
+    return levenshtein_dp (string1, string2, use_byte_compare);
+
+  /* The distance is symmetric, so use the shorter string as the
+     pattern.  */
+  struct levenshtein_pattern p;
+  if (len1 <= len2)
+    {
+      levenshtein_pattern_init (&p, string1, bytes1);
+      return levenshtein_bitparallel (&p, string2, bytes2);
+    }
+  else
+    {
+      levenshtein_pattern_init (&p, string2, bytes2);
+      return levenshtein_bitparallel (&p, string1, bytes1);
+    }
+}
+
+DEFUN ("string-distance", Fstring_distance, Sstring_distance, 2, 3, 0,
+       doc: /* Return Levenshtein distance between STRING1 and STRING2.
+The distance is the number of deletions, insertions, and substitutions
+required to transform STRING1 into STRING2.
+If BYTECOMPARE is nil or omitted, compute distance in terms of characters.
+If BYTECOMPARE is non-nil, compute distance in terms of bytes.
+Letter-case is significant, but text properties are ignored. */)
+  (Lisp_Object string1, Lisp_Object string2, Lisp_Object bytecompare)
+
+{
+  CHECK_STRING (string1);
+  CHECK_STRING (string2);
+  return make_fixnum (string_distance (string1, string2,
+				       !NILP (bytecompare)));
+}
+
+DEFUN ("string-distance-many", Fstring_distance_many, Sstring_distance_many,
+       2, 3, 0,
+       doc: /* Return Levenshtein distances between STRING and CANDIDATES.
+CANDIDATES is a list or vector of strings.  The value is a vector
+whose Nth element is the `string-distance' between STRING and the Nth
+element of CANDIDATES.
+BYTECOMPARE has the same meaning as for `string-distance'.  */)
+  (Lisp_Object string, Lisp_Object candidates, Lisp_Object bytecompare)
+{
+  CHECK_STRING (string);
+  bool use_byte_compare = !NILP (bytecompare);
+  if (!VECTORP (candidates))
+    CHECK_LIST (candidates);
+  Lisp_Object result = make_nil_vector (XFIXNAT (Flength (candidates)));
+
+  /* Set up STRING as the pattern only once, if it is short enough.
+     When STRING is unibyte, its characters are its bytes, whatever
+     the candidate.  */
+  bool bytes = use_byte_compare || !STRING_MULTIBYTE (string);
+  struct levenshtein_pattern p;
+  bool use_pattern = ((bytes ? SBYTES (string) : SCHARS (string))
+		      <= LEVENSHTEIN_PATTERN_MAX);
+  if (use_pattern)
+    levenshtein_pattern_init (&p, string, bytes);
+
+  ptrdiff_t n = ASIZE (result);
+  Lisp_Object tail = candidates;
+  for (ptrdiff_t i = 0; i < n; i++)
+    {
+      Lisp_Object candidate;
+      if (VECTORP (candidates))
+	candidate = AREF (candidates, i);
+      else
+	{
+	  candidate = XCAR (tail);
+	  tail = XCDR (tail);
+	}
+      CHECK_STRING (candidate);
+      ptrdiff_t distance
+	= (use_pattern
+	   ? levenshtein_bitparallel (&p, candidate,
+				      (use_byte_compare
+				       || !STRING_MULTIBYTE (candidate)))
+	   : string_distance (string, candidate, use_byte_compare));
+      ASET (result, i, make_fixnum (distance));
+      rarely_quit (i);
+    }
+  return result;
 }
 
 DEFUN ("string-equal", Fstring_equal, Sstring_equal, 2, 2, 0,
@@ -467,7 +654,7 @@ load_unaligned_size_t (const void *p)
 }
 
 /* Return -1/0/1 to indicate the relation </=/> between string1 and string2.  */
-static int
+int
 string_cmp (Lisp_Object string1, Lisp_Object string2)
 {
   ptrdiff_t n = min (SCHARS (string1), SCHARS (string2));
@@ -1185,14 +1372,92 @@ concat_to_vector (ptrdiff_t nargs, Lisp_Object *args)
   return result;
 }
 
-static Lisp_Object string_char_byte_cache_string;
-static ptrdiff_t string_char_byte_cache_charpos;
-static ptrdiff_t string_char_byte_cache_bytepos;
+/* A cache of recent character and byte positions in multibyte
+   strings, so that walking through a string, or through several
+   strings in turn, does not scan each from the start every time.
+
+   Each entry records the last position looked up in its string.  For
+   a long string, it also records the byte position of every
+   STRING_CHECKPOINT_INTERVAL-th character, so that positions far from
+   the last one are found without scanning more than an interval.  The
+   most recently used entry comes first.  */
+
+enum { STRING_CHAR_BYTE_CACHE_SIZE = 4 };
+enum { STRING_CHECKPOINT_INTERVAL = 128 };
+
+/* Strings with fewer characters than this get no checkpoints.  */
+enum { STRING_CHECKPOINT_MIN = 8 * STRING_CHECKPOINT_INTERVAL };
+
+struct string_char_byte_cache
+{
+  Lisp_Object string;
+  ptrdiff_t charpos, bytepos;
+
+  /* If not null, CHECKPOINTS[I] is the byte position of character
+     I * STRING_CHECKPOINT_INTERVAL.  */
+  ptrdiff_t *checkpoints;
+};
+
+static struct string_char_byte_cache
+  string_char_byte_cache[STRING_CHAR_BYTE_CACHE_SIZE];
 
 void
 clear_string_char_byte_cache (void)
 {
-  string_char_byte_cache_string = Qnil;
+  for (int i = 0; i < STRING_CHAR_BYTE_CACHE_SIZE; i++)
+    {
+      struct string_char_byte_cache *c = &string_char_byte_cache[i];
+      c->string = Qnil;
+      xfree (c->checkpoints);
+      c->checkpoints = NULL;
+    }
+}
+
+/* Return the cache entry for the multibyte STRING, moving it to the
+   front of the cache, or making a new one from the least recently used
+   entry.  */
+
+static struct string_char_byte_cache *
+string_char_byte_cache_entry (Lisp_Object string)
+{
+  struct string_char_byte_cache *cache = string_char_byte_cache;
+  if (!BASE_EQ (cache[0].string, string))
+    {
+      int i;
+      for (i = 1; i < STRING_CHAR_BYTE_CACHE_SIZE - 1; i++)
+	if (BASE_EQ (cache[i].string, string))
+	  break;
+      struct string_char_byte_cache found = cache[i];
+      memmove (&cache[1], &cache[0], i * sizeof *cache);
+      cache[0] = found;
+
+      if (!BASE_EQ (found.string, string))
+	{
+	  /* Reuse the least recently used entry.  */
+	  xfree (found.checkpoints);
+	  cache[0].string = string;
+	  cache[0].charpos = cache[0].bytepos = 0;
+	  cache[0].checkpoints = NULL;
+	}
+    }
+
+  ptrdiff_t nchars = SCHARS (string);
+  if (!cache[0].checkpoints && nchars >= STRING_CHECKPOINT_MIN)
+    {
+      ptrdiff_t n = nchars / STRING_CHECKPOINT_INTERVAL + 1;
+      ptrdiff_t *checkpoints = xnmalloc (n, sizeof *checkpoints);
+      unsigned char const *data = SDATA (string);
+      ptrdiff_t bytepos = 0;
+      for (ptrdiff_t j = 0; j < n; j++)
+	{
+	  checkpoints[j] = bytepos;
+	  if (j < n - 1)
+	    for (int k = 0; k < STRING_CHECKPOINT_INTERVAL; k++)
+	      bytepos += BYTES_BY_CHAR_HEAD (data[bytepos]);
+	}
+      cache[0].checkpoints = checkpoints;
+    }
+  return &cache[0];
 }
 
 /* Return the byte index corresponding to CHAR_INDEX in STRING.  */
@@ -1210,17 +1475,30 @@ string_char_to_byte (Lisp_Object string, ptrdiff_t char_index)
   if (best_above == best_above_byte)
     return char_index;
 
-  if (BASE_EQ (string, string_char_byte_cache_string))
+  struct string_char_byte_cache *cache
+    = string_char_byte_cache_entry (string);
+  if (cache->checkpoints)
     {
-      if (string_char_byte_cache_charpos < char_index)
+      ptrdiff_t k = char_index / STRING_CHECKPOINT_INTERVAL;
+      best_below = k * STRING_CHECKPOINT_INTERVAL;
+      best_below_byte = cache->checkpoints[k];
+      if (best_below + STRING_CHECKPOINT_INTERVAL <= best_above)
 	{
-	  best_below = string_char_byte_cache_charpos;
-	  best_below_byte = string_char_byte_cache_bytepos;
+	  best_above = best_below + STRING_CHECKPOINT_INTERVAL;
+	  best_above_byte = cache->checkpoints[k + 1];
+	}
+    }
+  if (best_below <= cache->charpos && cache->charpos <= best_above)
+    {
+      if (cache->charpos < char_index)
+	{
+	  best_below = cache->charpos;
+	  best_below_byte = cache->bytepos;
 	}
       else
 	{
-	  best_above = string_char_byte_cache_charpos;
-	  best_above_byte = string_char_byte_cache_bytepos;
+	  best_above = cache->charpos;
+	  best_above_byte = cache->bytepos;
 	}
     }
 
@@ -1248,13 +1526,12 @@ string_char_to_byte (Lisp_Object string, ptrdiff_t char_index)
       i_byte = p - SDATA (string);
     }
 
-  string_char_byte_cache_bytepos = i_byte;
-  string_char_byte_cache_charpos = char_index;
-  string_char_byte_cache_string = string;
+  cache->bytepos = i_byte;
+  cache->charpos = char_index;
 
   return i_byte;
 }
-
+
 /* Return the character index corresponding to BYTE_INDEX in STRING.  */
 
 ptrdiff_t
@@ -1270,17 +1547,39 @@ string_byte_to_char (Lisp_Object string, ptrdiff_t byte_index)
   if (best_above == best_above_byte)
     return byte_index;
 
-  if (BASE_EQ (string, string_char_byte_cache_string))
+  struct string_char_byte_cache *cache
+    = string_char_byte_cache_entry (string);
+  if (cache->checkpoints)
+    {
+      /* Find the last checkpoint at or before BYTE_INDEX.  */
+      ptrdiff_t lo = 0, hi = best_above / STRING_CHECKPOINT_INTERVAL;
+      while (lo < hi)
+	{
+	  ptrdiff_t mid = lo + (hi - lo + 1) / 2;
+	  if (cache->checkpoints[mid] <= byte_index)
+	    lo = mid;
+	  else
+	    hi = mid - 1;
+	}
+      best_below = lo * STRING_CHECKPOINT_INTERVAL;
+      best_below_byte = cache->checkpoints[lo];
+      if (best_below + STRING_CHECKPOINT_INTERVAL <= best_above)
+	{
+	  best_above = best_below + STRING_CHECKPOINT_INTERVAL;
+	  best_above_byte = cache->checkpoints[lo + 1];
+	}
+    }
+  if (best_below_byte <= cache->bytepos && cache->bytepos <= best_above_byte)
     {
-      if (string_char_byte_cache_bytepos < byte_index)
+      if (cache->bytepos < byte_index)
 	{
-	  best_below = string_char_byte_cache_charpos;
-	  best_below_byte = string_char_byte_cache_bytepos;
+	  best_below = cache->charpos;
+	  best_below_byte = cache->bytepos;
 	}
       else
 	{
-	  best_above = string_char_byte_cache_charpos;
-	  best_above_byte = string_char_byte_cache_bytepos;
+	  best_above = cache->charpos;
+	  best_above_byte = cache->bytepos;
 	}
     }
 
@@ -1312,9 +1611,8 @@ string_byte_to_char (Lisp_Object string, ptrdiff_t byte_index)
       i_byte = p - SDATA (string);
     }
 
-  string_char_byte_cache_bytepos = i_byte;
-  string_char_byte_cache_charpos = i;
-  string_char_byte_cache_string = string;
+  cache->bytepos = i_byte;
+  cache->charpos = i;
 
   return i;
 }
@@ -3296,6 +3594,7 @@ DEFUN ("fillarray", Ffillarray, Sfillarray, 2, 2, 0,
 		error ("Attempt to change byte length of a string");
 	      for (idx = 0; idx < size_byte; idx++)
 		*p++ = str[idx % len];
+	      clear_string_char_byte_cache ();
 	    }
 	}
     }
@@ -3321,6 +3620,7 @@ DEFUN ("clear-string", Fclear_string, Sclear_string, 1, 1, 0,
       memset (SDATA (string), 0, len);
       STRING_SET_CHARS (string, len);
       STRING_SET_UNIBYTE (string);
+      clear_string_char_byte_cache ();
     }
   return Qnil;
 }
@@ -4012,8 +4312,6 @@ #define MIME_LINE_LENGTH 76
 
 static ptrdiff_t base64_encode_1 (const char *, char *, ptrdiff_t, bool, bool,
 				  bool, bool);
-static ptrdiff_t base64_decode_1 (const char *, char *, ptrdiff_t, bool,
-				  bool, bool, ptrdiff_t *);
 
 static Lisp_Object base64_encode_region_1 (Lisp_Object, Lisp_Object, bool,
 					   bool, bool);
@@ -4056,17 +4354,15 @@ DEFUN ("base64url-encode-region", Fbase64url_encode_region, Sbase64url_encode_re
 base64_encode_region_1 (Lisp_Object beg, Lisp_Object end, bool line_break,
 			bool pad, bool base64url)
 {
-  char *encoded;
   ptrdiff_t allength, length;
   ptrdiff_t ibeg, iend, encoded_length;
   ptrdiff_t old_pos = PT;
-  USE_SAFE_ALLOCA;
 
   validate_region (&beg, &end);
+  prepare_to_modify_buffer (XFIXNAT (beg), XFIXNAT (beg), NULL);
 
   ibeg = CHAR_TO_BYTE (XFIXNAT (beg));
   iend = CHAR_TO_BYTE (XFIXNAT (end));
-  move_gap_both (XFIXNAT (beg), ibeg);
 
   /* We need to allocate enough room for encoding the text.
      We need 33 1/3% more space, plus a newline every 76
@@ -4075,9 +4371,13 @@ base64_encode_region_1 (Lisp_Object beg, Lisp_Object end, bool line_break,
   allength = length + length/3 + 1;
   allength += allength / MIME_LINE_LENGTH + 1 + 6;
 
-  encoded = SAFE_ALLOCA (allength);
+  /* Encode the region, which starts right after the gap, into the
+     gap, so that the encoded text need not be copied again.  */
+  move_gap_both (XFIXNAT (beg), ibeg);
+  if (GAP_SIZE < allength)
+    make_gap (allength - GAP_SIZE);
   encoded_length = base64_encode_1 ((char *) BYTE_POS_ADDR (ibeg),
-				    encoded, length, line_break,
+				    (char *) GPT_ADDR, length, line_break,
 				    pad, base64url,
 				    !NILP (BVAR (current_buffer, enable_multibyte_characters)));
   if (encoded_length > allength)
@@ -4086,15 +4386,15 @@ base64_encode_region_1 (Lisp_Object beg, Lisp_Object end, bool line_break,
   if (encoded_length < 0)
     {
       /* The encoding wasn't possible. */
-      SAFE_FREE ();
       error ("Multibyte character in data for base64 encoding");
     }
 
   /* Now we have encoded the region, so we insert the new contents
      and delete the old.  (Insert first in order to preserve markers.)  */
-  SET_PT_BOTH (XFIXNAT (beg), ibeg);
-  insert (encoded, encoded_length);
-  SAFE_FREE ();
+  insert_from_gap (encoded_length, encoded_length, false, false);
+  signal_after_change (XFIXNAT (beg), 0, encoded_length);
+  update_compositions (XFIXNAT (beg), XFIXNAT (beg) + encoded_length,
+		       CHECK_BORDER);
   del_range_byte (ibeg + encoded_length, iend + encoded_length);
 
   /* If point was outside of the region, restore it exactly; else just
@@ -4187,6 +4487,34 @@ base64_encode_1 (const char *from, char *to, ptrdiff_t length,
 
   while (i < length)
     {
+      /* Encode whole triplets of single-byte characters without
+	 looking at each byte separately.  */
+      unsigned char const *p;
+      while (length - i >= 3
+	     && (p = (unsigned char const *) from + i,
+		 !multibyte || (p[0] | p[1] | p[2]) < 0x80))
+	{
+	  if (line_break)
+	    {
+	      if (counter < MIME_LINE_LENGTH / 4)
+		counter++;
+	      else
+		{
+		  *e++ = '\n';
+		  counter = 1;
+		}
+	    }
+	  value = p[0] << 16 | p[1] << 8 | p[2];
+	  e[0] = b64_value_to_char[value >> 18];
+	  e[1] = b64_value_to_char[0x3f & value >> 12];
+	  e[2] = b64_value_to_char[0x3f & value >> 6];
+	  e[3] = b64_value_to_char[0x3f & value];
+	  e += 4;
+	  i += 3;
+	}
+      if (i == length)
+	break;
+
       if (multibyte)
 	{
 	  c = string_char_and_length ((unsigned char *) from + i, &bytes);
@@ -4294,12 +4622,10 @@ DEFUN ("base64-decode-region", Fbase64_decode_region, Sbase64_decode_region,
       Lisp_Object ignore_invalid)
 {
   ptrdiff_t ibeg, iend, length, allength;
-  char *decoded;
   ptrdiff_t old_pos = PT;
   ptrdiff_t decoded_length;
   ptrdiff_t inserted_chars;
   bool multibyte = !NILP (BVAR (current_buffer, enable_multibyte_characters));
-  USE_SAFE_ALLOCA;
 
   validate_region (&beg, &end);
 
@@ -4308,17 +4634,23 @@ DEFUN ("base64-decode-region", Fbase64_decode_region, Sbase64_decode_region,
 
   length = iend - ibeg;
 
-  /* We need to allocate enough room for decoding the text.  If we are
-     working on a multibyte buffer, each decoded code may occupy at
-     most two bytes.  */
-  allength = multibyte ? length * 2 : length;
-  decoded = SAFE_ALLOCA (allength);
+  /* We need enough room for decoding the text: 3 bytes for every 4
+     characters, rounded up.  If we are working on a multibyte buffer,
+     each decoded byte may occupy two bytes.  */
+  allength = (length / 4 + 1) * 3;
+  if (multibyte)
+    allength *= 2;
 
+  /* Decode the region, which starts right after the gap, into the
+     gap, so that the decoded text need not be copied again.  If the
+     data is invalid, only the gap has been written to.  */
   move_gap_both (XFIXNAT (beg), ibeg);
+  if (GAP_SIZE < allength)
+    make_gap (allength - GAP_SIZE);
   decoded_length = base64_decode_1 ((char *) BYTE_POS_ADDR (ibeg),
-				    decoded, length, !NILP (base64url),
-				    multibyte, !NILP (ignore_invalid),
-				    &inserted_chars);
+				    (char *) GPT_ADDR, length,
+				    !NILP (base64url), multibyte,
+				    !NILP (ignore_invalid), &inserted_chars);
   if (decoded_length > allength)
     emacs_abort ();
 
@@ -4330,14 +4662,12 @@ DEFUN ("base64-decode-region", Fbase64_decode_region, Sbase64_decode_region,
 
   /* Now we have decoded the region, so we insert the new contents
      and delete the old.  (Insert first in order to preserve markers.)  */
-  TEMP_SET_PT_BOTH (XFIXNAT (beg), ibeg);
-  insert_1_both (decoded, inserted_chars, decoded_length, 0, 1, 0);
+  insert_from_gap (inserted_chars, decoded_length, false, false);
   signal_after_change (XFIXNAT (beg), 0, inserted_chars);
-  SAFE_FREE ();
 
   /* Delete the original text.  */
-  del_range_both (PT, PT_BYTE, XFIXNAT (end) + inserted_chars,
-		  iend + decoded_length, 1);
+  del_range_both (XFIXNAT (beg) + inserted_chars, ibeg + decoded_length,
+		  XFIXNAT (end) + inserted_chars, iend + decoded_length, 1);
 
   /* If point was outside of the region, restore it exactly; else just
      move to the beginning of the region.  */
@@ -4394,7 +4724,7 @@ DEFUN ("base64-decode-string", Fbase64_decode_string, Sbase64_decode_string,
    form.  If IGNORE_INVALID, ignore invalid base64 characters.
    Store the number of produced characters in *NCHARS_RETURN.  */
 
-static ptrdiff_t
+ptrdiff_t
 base64_decode_1 (const char *from, char *to, ptrdiff_t length,
 		 bool base64url, bool multibyte, bool ignore_invalid,
 		 ptrdiff_t *nchars_return)
@@ -4411,6 +4741,29 @@ base64_decode_1 (const char *from, char *to, ptrdiff_t length,
       unsigned char c;
       int v1;
 
+      /* Decode whole quadruplets without whitespace or padding, which
+	 is most of the data, without looking at each byte separately.  */
+      while (flim - f >= 4)
+	{
+	  unsigned char const *p = (unsigned char const *) f;
+	  int v0 = b64_char_to_value[p[0]], va = b64_char_to_value[p[1]];
+	  int vb = b64_char_to_value[p[2]], vc = b64_char_to_value[p[3]];
+	  if (v0 <= 0 || va <= 0 || vb <= 0 || vc <= 0)
+	    break;
+	  unsigned int value = ((v0 - 1) << 18 | (va - 1) << 12
+				| (vb - 1) << 6 | (vc - 1));
+	  for (int shift = 16; shift >= 0; shift -= 8)
+	    {
+	      c = value >> shift & 0xff;
+	      if (c & multibyte_bit)
+		e += BYTE8_STRING (c, (unsigned char *) e);
+	      else
+		*e++ = c;
+	    }
+	  nchars += 3;
+	  f += 4;
+	}
+
       /* Process first byte of a quadruplet. */
 
       do
@@ -4563,13 +4916,13 @@ CHECK_HASH_TABLE (Lisp_Object x)
 set_hash_next_slot (struct Lisp_Hash_Table *h, ptrdiff_t idx, ptrdiff_t val)
 {
   eassert (idx >= 0 && idx < h->table_size);
-  h->next[idx] = val;
+  h->hash_and_next[idx].next = val;
 }
 static void
 set_hash_hash_slot (struct Lisp_Hash_Table *h, ptrdiff_t idx, hash_hash_t val)
 {
   eassert (idx >= 0 && idx < h->table_size);
-  h->hash[idx] = val;
+  h->hash_and_next[idx].hash = val;
 }
 static void
 set_hash_index_slot (struct Lisp_Hash_Table *h, ptrdiff_t idx, ptrdiff_t val)
@@ -4642,7 +4995,7 @@ larger_vector (Lisp_Object vec, ptrdiff_t incr_min, ptrdiff_t nitems_max)
 HASH_NEXT (struct Lisp_Hash_Table *h, ptrdiff_t idx)
 {
   eassert (idx >= 0 && idx < h->table_size);
-  return h->next[idx];
+  return h->hash_and_next[idx].next;
 }
 
 /* Return the index of the element in hash table H that is the start
@@ -4822,8 +5175,7 @@ make_hash_table (const struct hash_table_test *test, EMACS_INT size,
   if (size == 0)
     {
       h->key_and_value = NULL;
-      h->hash = NULL;
-      h->next = NULL;
+      h->hash_and_next = NULL;
       h->index_bits = 0;
       h->index = (hash_idx_t *)empty_hash_index_vector;
       h->next_free = -1;
@@ -4835,12 +5187,11 @@ make_hash_table (const struct hash_table_test *test, EMACS_INT size,
       for (ptrdiff_t i = 0; i < 2 * size; i++)
 	h->key_and_value[i] = HASH_UNUSED_ENTRY_KEY;
 
-      h->hash = hash_table_alloc_bytes (size * sizeof *h->hash);
-
-      h->next = hash_table_alloc_bytes (size * sizeof *h->next);
+      h->hash_and_next = hash_table_alloc_bytes (size
+						 * sizeof *h->hash_and_next);
       for (ptrdiff_t i = 0; i < size - 1; i++)
-	h->next[i] = i + 1;
-      h->next[size - 1] = -1;
+	h->hash_and_next[i].next = i + 1;
+      h->hash_and_next[size - 1].next = -1;
 
       int index_bits = compute_hash_index_bits (size);
       h->index_bits = index_bits;
@@ -4876,13 +5227,9 @@ copy_hash_table (struct Lisp_Hash_Table *h1)
       h2->key_and_value = hash_table_alloc_bytes (kv_bytes);
       memcpy (h2->key_and_value, h1->key_and_value, kv_bytes);
 
-      ptrdiff_t hash_bytes = h1->table_size * sizeof *h1->hash;
-      h2->hash = hash_table_alloc_bytes (hash_bytes);
-      memcpy (h2->hash, h1->hash, hash_bytes);
-
-      ptrdiff_t next_bytes = h1->table_size * sizeof *h1->next;
-      h2->next = hash_table_alloc_bytes (next_bytes);
-      memcpy (h2->next, h1->next, next_bytes);
+      ptrdiff_t link_bytes = h1->table_size * sizeof *h1->hash_and_next;
+      h2->hash_and_next = hash_table_alloc_bytes (link_bytes);
+      memcpy (h2->hash_and_next, h1->hash_and_next, link_bytes);
 
       ptrdiff_t index_bytes = hash_table_index_size (h1) * sizeof *h1->index;
       h2->index = hash_table_alloc_bytes (index_bytes);
@@ -4917,10 +5264,13 @@ maybe_resize_hash_table (struct Lisp_Hash_Table *h)
 
       /* Allocate all the new vectors before updating *H, to
 	 avoid problems if memory is exhausted.  */
-      hash_idx_t *next = hash_table_alloc_bytes (new_size * sizeof *next);
+      struct hash_table_link *hash_and_next
+	= hash_table_alloc_bytes (new_size * sizeof *hash_and_next);
+      memcpy (hash_and_next, h->hash_and_next,
+	      old_size * sizeof *hash_and_next);
       for (ptrdiff_t i = old_size; i < new_size - 1; i++)
-	next[i] = i + 1;
-      next[new_size - 1] = -1;
+	hash_and_next[i].next = i + 1;
+      hash_and_next[new_size - 1].next = -1;
 
       Lisp_Object *key_and_value
 	= hash_table_alloc_bytes (2 * new_size * sizeof *key_and_value);
@@ -4929,9 +5279,6 @@ maybe_resize_hash_table (struct Lisp_Hash_Table *h)
       for (ptrdiff_t i = 2 * old_size; i < 2 * new_size; i++)
         key_and_value[i] = HASH_UNUSED_ENTRY_KEY;
 
-      hash_hash_t *hash = hash_table_alloc_bytes (new_size * sizeof *hash);
-      memcpy (hash, h->hash, old_size * sizeof *hash);
-
       ptrdiff_t old_index_size = hash_table_index_size (h);
       ptrdiff_t index_bits = compute_hash_index_bits (new_size);
       ptrdiff_t index_size = (ptrdiff_t)1 << index_bits;
@@ -4951,11 +5298,9 @@ maybe_resize_hash_table (struct Lisp_Hash_Table *h)
 			     2 * old_size * sizeof *h->key_and_value);
       h->key_and_value = key_and_value;
 
-      hash_table_free_bytes (h->hash, old_size * sizeof *h->hash);
-      h->hash = hash;
-
-      hash_table_free_bytes (h->next, old_size * sizeof *h->next);
-      h->next = next;
+      hash_table_free_bytes (h->hash_and_next,
+			     old_size * sizeof *h->hash_and_next);
+      h->hash_and_next = hash_and_next;
 
       h->key_and_value = key_and_value;
 
@@ -4998,8 +5343,7 @@ hash_table_thaw (Lisp_Object hash_table)
   if (size == 0)
     {
       h->key_and_value = NULL;
-      h->hash = NULL;
-      h->next = NULL;
+      h->hash_and_next = NULL;
       h->index_bits = 0;
       h->index = (hash_idx_t *)empty_hash_index_vector;
     }
@@ -5008,9 +5352,8 @@ hash_table_thaw (Lisp_Object hash_table)
       ptrdiff_t index_bits = compute_hash_index_bits (size);
       h->index_bits = index_bits;
 
-      h->hash = hash_table_alloc_bytes (size * sizeof *h->hash);
-
-      h->next = hash_table_alloc_bytes (size * sizeof *h->next);
+      h->hash_and_next = hash_table_alloc_bytes (size
+						 * sizeof *h->hash_and_next);
 
       ptrdiff_t index_size = hash_table_index_size (h);
       h->index = hash_table_alloc_bytes (index_size * sizeof *h->index);
@@ -5031,7 +5374,10 @@ hash_table_thaw (Lisp_Object hash_table)
 }
 
 /* Look up KEY with hash HASH in table H.
-   Return entry index or -1 if none.  */
+   Return entry index or -1 if none.  Keys that are the same under the
+   test of H have the same hash code, so compare the hash codes first:
+   they are next to the chain links, and entries whose codes differ
+   need not have their keys loaded at all.  */
 static ptrdiff_t
 hash_lookup_with_hash (struct Lisp_Hash_Table *h,
 		       Lisp_Object key, hash_hash_t hash)
@@ -5039,10 +5385,10 @@ hash_lookup_with_hash (struct Lisp_Hash_Table *h,
   ptrdiff_t start_of_bucket = hash_index_index (h, hash);
   for (ptrdiff_t i = HASH_INDEX (h, start_of_bucket);
        0 <= i; i = HASH_NEXT (h, i))
-    if (EQ (key, HASH_KEY (h, i))
-	|| (h->test->cmpfn
-	    && hash == HASH_HASH (h, i)
-	    && !NILP (h->test->cmpfn (key, HASH_KEY (h, i), h))))
+    if (hash == HASH_HASH (h, i)
+	&& (EQ (key, HASH_KEY (h, i))
+	    || (h->test->cmpfn
+		&& !NILP (h->test->cmpfn (key, HASH_KEY (h, i), h)))))
       return i;
 
   return -1;
@@ -5117,10 +5463,10 @@ hash_remove_from_table (struct Lisp_Hash_Table *h, Lisp_Object key)
        0 <= i;
        i = HASH_NEXT (h, i))
     {
-      if (EQ (key, HASH_KEY (h, i))
-	  || (h->test->cmpfn
-	      && hashval == HASH_HASH (h, i)
-	      && !NILP (h->test->cmpfn (key, HASH_KEY (h, i), h))))
+      if (hashval == HASH_HASH (h, i)
+	  && (EQ (key, HASH_KEY (h, i))
+	      || (h->test->cmpfn
+		  && !NILP (h->test->cmpfn (key, HASH_KEY (h, i), h)))))
 	{
 	  /* Take entry out of collision chain.  */
 	  if (prev < 0)
@@ -5191,83 +5537,97 @@ keep_entry_p (hash_table_weakness_t weakness,
   emacs_abort();
 }
 
-/* Sweep weak hash table H.  REMOVE_ENTRIES_P means remove
-   entries from the table that don't survive the current GC.
-   !REMOVE_ENTRIES_P means mark entries that are in use.  Value is
-   true if anything was marked.  */
+/* Mark the keys and values of those entries of weak hash table H that
+   must survive the current GC.  PENDING holds the indices of the
+   entries to examine, NPENDING of them; if NPENDING is negative,
+   examine every entry of H instead, and PENDING must have room for
+   the indices of all of them.  Store into PENDING the indices of the
+   entries that cannot be kept yet, because neither key nor value is
+   known to survive, and return their number.  Set *MARKED to true if
+   anything was marked.
 
-bool
-sweep_weak_table (struct Lisp_Hash_Table *h, bool remove_entries_p)
+   An entry that is kept once stays kept for the rest of the GC, so the
+   entries left in PENDING are the only ones that later calls need to
+   look at, and the only ones to remove when marking is done.  */
+
+ptrdiff_t
+mark_weak_table (struct Lisp_Hash_Table *h, hash_idx_t *pending,
+		 ptrdiff_t npending, bool *marked)
 {
-  ptrdiff_t n = hash_table_index_size (h);
-  bool marked = false;
+  bool all = npending < 0;
+  ptrdiff_t n = all ? HASH_TABLE_SIZE (h) : npending;
+  ptrdiff_t nleft = 0;
 
-  for (ptrdiff_t bucket = 0; bucket < n; ++bucket)
+  for (ptrdiff_t j = 0; j < n; j++)
     {
-      /* Follow collision chain, removing entries that don't survive
-         this garbage collection.  */
-      ptrdiff_t prev = -1;
-      ptrdiff_t next;
-      for (ptrdiff_t i = HASH_INDEX (h, bucket); 0 <= i; i = next)
-        {
-	  bool key_known_to_survive_p = survives_gc_p (HASH_KEY (h, i));
-	  bool value_known_to_survive_p = survives_gc_p (HASH_VALUE (h, i));
-	  bool remove_p = !keep_entry_p (h->weakness,
-					 key_known_to_survive_p,
-					 value_known_to_survive_p);
+      ptrdiff_t i = all ? j : pending[j];
+      Lisp_Object key = HASH_KEY (h, i);
+      if (hash_unused_entry_key_p (key))
+	continue;
+      Lisp_Object value = HASH_VALUE (h, i);
+      bool key_known_to_survive_p = survives_gc_p (key);
+      bool value_known_to_survive_p = survives_gc_p (value);
 
-	  next = HASH_NEXT (h, i);
+      if (!keep_entry_p (h->weakness,
+			 key_known_to_survive_p, value_known_to_survive_p))
+	pending[nleft++] = i;
+      else
+	{
+	  /* Make sure key and value survive.  */
+	  if (!key_known_to_survive_p)
+	    {
+	      mark_object (key);
+	      *marked = true;
+	    }
 
-	  if (remove_entries_p)
+	  if (!value_known_to_survive_p)
 	    {
-              eassert (!remove_p
-                       == (key_known_to_survive_p && value_known_to_survive_p));
-	      if (remove_p)
-		{
-		  /* Take out of collision chain.  */
-		  if (prev < 0)
-		    set_hash_index_slot (h, bucket, next);
-		  else
-		    set_hash_next_slot (h, prev, next);
+	      mark_object (value);
+	      *marked = true;
+	    }
+	}
+    }
 
-		  /* Add to free list.  */
-		  set_hash_next_slot (h, i, h->next_free);
-		  h->next_free = i;
+  return nleft;
+}
 
-		  /* Clear key and value.  */
-		  set_hash_key_slot (h, i, HASH_UNUSED_ENTRY_KEY);
-		  set_hash_value_slot (h, i, Qnil);
+/* Remove from weak hash table H the NPENDING entries whose indices are
+   in PENDING, which mark_weak_table found could not be kept.  */
 
-                  eassert (h->count != 0);
-                  h->count--;
-                }
-	      else
-		{
-		  prev = i;
-		}
-	    }
-	  else
-	    {
-	      if (!remove_p)
-		{
-		  /* Make sure key and value survive.  */
-		  if (!key_known_to_survive_p)
-		    {
-		      mark_object (HASH_KEY (h, i));
-                      marked = true;
-		    }
+void
+sweep_weak_table (struct Lisp_Hash_Table *h, hash_idx_t const *pending,
+		  ptrdiff_t npending)
+{
+  for (ptrdiff_t j = 0; j < npending; j++)
+    {
+      ptrdiff_t i = pending[j];
+      eassert (!(survives_gc_p (HASH_KEY (h, i))
+		 && survives_gc_p (HASH_VALUE (h, i))));
 
-		  if (!value_known_to_survive_p)
-		    {
-		      mark_object (HASH_VALUE (h, i));
-                      marked = true;
-		    }
-		}
-	    }
+      /* Take out of collision chain.  */
+      ptrdiff_t bucket = hash_index_index (h, HASH_HASH (h, i));
+      ptrdiff_t prev = -1;
+      for (ptrdiff_t k = HASH_INDEX (h, bucket); k != i; k = HASH_NEXT (h, k))
+	{
+	  eassert (0 <= k);
+	  prev = k;
 	}
-    }
+      if (prev < 0)
+	set_hash_index_slot (h, bucket, HASH_NEXT (h, i));
+      else
+	set_hash_next_slot (h, prev, HASH_NEXT (h, i));
 
-  return marked;
+      /* Add to free list.  */
+      set_hash_next_slot (h, i, h->next_free);
+      h->next_free = i;
+
+      /* Clear key and value.  */
+      set_hash_key_slot (h, i, HASH_UNUSED_ENTRY_KEY);
+      set_hash_value_slot (h, i, Qnil);
+
+      eassert (h->count != 0);
+      h->count--;
+    }
 }
 
 
@@ -6225,6 +6585,26 @@ extract_data_from_object (Lisp_Object spec,
 
 /* ALGORITHM is a symbol: md5, sha1, sha224 and so on. */
 
+/* Inputs of secure_hash at least this many bytes long are hashed
+   without holding the global lock, if other Lisp threads could use
+   it.  */
+enum { SECURE_HASH_UNLOCKED_MIN = 64 * 1024 };
+
+struct secure_hash_args
+{
+  void *(*hash_func) (const char *, size_t, void *);
+  char *input;
+  ptrdiff_t len;
+  char digest[SHA512_DIGEST_SIZE];
+};
+
+static void
+secure_hash_unlocked (void *arg)
+{
+  struct secure_hash_args *args = arg;
+  args->hash_func (args->input, args->len, args->digest);
+}
+
 static Lisp_Object
 secure_hash (Lisp_Object algorithm, Lisp_Object object, Lisp_Object start,
 	     Lisp_Object end, Lisp_Object coding_system, Lisp_Object noerror,
@@ -6281,9 +6661,25 @@ secure_hash (Lisp_Object algorithm, Lisp_Object object, Lisp_Object start,
      hexified value */
   digest = make_uninit_string (digest_size * 2);
 
-  hash_func (input + start_byte,
-	     end_byte - start_byte,
-	     SSDATA (digest));
+  ptrdiff_t len = end_byte - start_byte;
+  if (len >= SECURE_HASH_UNLOCKED_MIN && other_threads_p ())
+    {
+      /* Let other threads run while this one hashes.  They could
+	 change the data, and garbage collection could move it, so
+	 hash a copy.  */
+      struct secure_hash_args args;
+      args.hash_func = hash_func;
+      args.input = xmalloc (len);
+      args.len = len;
+      memcpy (args.input, input + start_byte, len);
+      specpdl_ref count = SPECPDL_INDEX ();
+      record_unwind_protect_ptr (xfree, args.input);
+      thread_call_unlocked (secure_hash_unlocked, &args);
+      memcpy (SSDATA (digest), args.digest, digest_size);
+      unbind_to (count, Qnil);
+    }
+  else
+    hash_func (input + start_byte, len, SSDATA (digest));
 
   if (NILP (binary))
     return make_digest_string (digest, digest_size);
@@ -6405,6 +6801,272 @@ DEFUN ("buffer-hash", Fbuffer_hash, Sbuffer_hash, 0, 1, 0,
   return make_digest_string (digest, SHA1_DIGEST_SIZE);
 }
 
+/* Streaming secure hashes.  A context is a record
+   [secure-hash-context ALGORITHM STATE], where STATE is a unibyte
+   string holding a union secure_hash_ctx.  The state is copied in and
+   out of the string, since string data may move and need not be
+   suitably aligned.  */
+
+enum
+  {
+    SECURE_HASH_CONTEXT_ALGORITHM = 1,
+    SECURE_HASH_CONTEXT_STATE,
+    SECURE_HASH_CONTEXT_SIZE
+  };
+
+union secure_hash_ctx
+{
+  struct md5_ctx md5;
+  struct sha1_ctx sha1;
+  struct sha256_ctx sha256;
+  struct sha512_ctx sha512;
+};
+
+/* Initialize CTX for hashing with ALGORITHM.  */
+static void
+secure_hash_init (Lisp_Object algorithm, union secure_hash_ctx *ctx)
+{
+  if (EQ (algorithm, Qmd5))
+    md5_init_ctx (&ctx->md5);
+  else if (EQ (algorithm, Qsha1))
+    sha1_init_ctx (&ctx->sha1);
+  else if (EQ (algorithm, Qsha224))
+    sha224_init_ctx (&ctx->sha256);
+  else if (EQ (algorithm, Qsha256))
+    sha256_init_ctx (&ctx->sha256);
+  else if (EQ (algorithm, Qsha384))
+    sha384_init_ctx (&ctx->sha512);
+  else if (EQ (algorithm, Qsha512))
+    sha512_init_ctx (&ctx->sha512);
+  else
+    error ("Invalid algorithm arg: %s", SDATA (Fsymbol_name (algorithm)));
+}
+
+/* Add the LEN bytes at P to CTX, which hashes with ALGORITHM.  */
+static void
+secure_hash_process (Lisp_Object algorithm, union secure_hash_ctx *ctx,
+		     void const *p, ptrdiff_t len)
+{
+  if (EQ (algorithm, Qmd5))
+    md5_process_bytes (p, len, &ctx->md5);
+  else if (EQ (algorithm, Qsha1))
+    sha1_process_bytes (p, len, &ctx->sha1);
+  else if (EQ (algorithm, Qsha224) || EQ (algorithm, Qsha256))
+    sha256_process_bytes (p, len, &ctx->sha256);
+  else
+    sha512_process_bytes (p, len, &ctx->sha512);
+}
+
+/* Store into DIGEST the digest of the data added to CTX, which hashes
+   with ALGORITHM, and return its size.  */
+static int
+secure_hash_finish (Lisp_Object algorithm, union secure_hash_ctx *ctx,
+		    char *digest)
+{
+  if (EQ (algorithm, Qmd5))
+    {
+      md5_finish_ctx (&ctx->md5, digest);
+      return MD5_DIGEST_SIZE;
+    }
+  else if (EQ (algorithm, Qsha1))
+    {
+      sha1_finish_ctx (&ctx->sha1, digest);
+      return SHA1_DIGEST_SIZE;
+    }
+  else if (EQ (algorithm, Qsha224))
+    {
+      sha224_finish_ctx (&ctx->sha256, digest);
+      return SHA224_DIGEST_SIZE;
+    }
+  else if (EQ (algorithm, Qsha256))
+    {
+      sha256_finish_ctx (&ctx->sha256, digest);
+      return SHA256_DIGEST_SIZE;
+    }
+  else if (EQ (algorithm, Qsha384))
+    {
+      sha384_finish_ctx (&ctx->sha512, digest);
+      return SHA384_DIGEST_SIZE;
+    }
+  else
+    {
+      sha512_finish_ctx (&ctx->sha512, digest);
+      return SHA512_DIGEST_SIZE;
+    }
+}
+
+/* Check that CONTEXT is a secure hash context, and copy its state
+   into *CTX.  Return its algorithm.  */
+static Lisp_Object
+get_secure_hash_context (Lisp_Object context, union secure_hash_ctx *ctx)
+{
+  if (! (RECORDP (context)
+	 && PVSIZE (context) == SECURE_HASH_CONTEXT_SIZE
+	 && EQ (AREF (context, 0), Qsecure_hash_context)))
+    wrong_type_argument (Qsecure_hash_context, context);
+  Lisp_Object algorithm = AREF (context, SECURE_HASH_CONTEXT_ALGORITHM);
+  Lisp_Object state = AREF (context, SECURE_HASH_CONTEXT_STATE);
+  if (! ((EQ (algorithm, Qmd5) || EQ (algorithm, Qsha1)
+	  || EQ (algorithm, Qsha224) || EQ (algorithm, Qsha256)
+	  || EQ (algorithm, Qsha384) || EQ (algorithm, Qsha512))
+	 && STRINGP (state) && !STRING_MULTIBYTE (state)
+	 && SBYTES (state) == sizeof *ctx))
+    wrong_type_argument (Qsecure_hash_context, context);
+  memcpy (ctx, SDATA (state), sizeof *ctx);
+  return algorithm;
+}
+
+/* Store the state *CTX back into CONTEXT.  */
+static void
+set_secure_hash_context (Lisp_Object context, union secure_hash_ctx const *ctx)
+{
+  Lisp_Object state = AREF (context, SECURE_HASH_CONTEXT_STATE);
+  memcpy (SDATA (state), ctx, sizeof *ctx);
+}
+
+DEFUN ("secure-hash-make", Fsecure_hash_make, Ssecure_hash_make, 1, 1, 0,
+       doc: /* Return a new context for computing a hash with ALGORITHM.
+ALGORITHM is one of the symbols returned by `secure-hash-algorithms'.
+Add data to the context with `secure-hash-update' and
+`secure-hash-update-file', and get the hash with `secure-hash-final'.  */)
+  (Lisp_Object algorithm)
+{
+  CHECK_SYMBOL (algorithm);
+  union secure_hash_ctx ctx;
+  secure_hash_init (algorithm, &ctx);
+  Lisp_Object state = make_uninit_string (sizeof ctx);
+  memcpy (SDATA (state), &ctx, sizeof ctx);
+  Lisp_Object context = Fmake_record (Qsecure_hash_context,
+				      make_fixnum (SECURE_HASH_CONTEXT_SIZE - 1),
+				      Qnil);
+  ASET (context, SECURE_HASH_CONTEXT_ALGORITHM, algorithm);
+  ASET (context, SECURE_HASH_CONTEXT_STATE, state);
+  return context;
+}
+
+DEFUN ("secure-hash-update", Fsecure_hash_update, Ssecure_hash_update,
+       2, 4, 0,
+       doc: /* Add the text of OBJECT, a buffer or string, to hash CONTEXT.
+CONTEXT is a value returned by `secure-hash-make'.  The two optional
+arguments START and END are positions specifying which part of OBJECT
+to add.  If nil or omitted, add the whole accessible portion of a
+buffer or the whole string.
+
+Unlike `secure-hash', this does not encode the text, and hashes its
+internal representation instead.  That is the same as its encoding in
+`utf-8' for text without raw bytes, and as the text itself for unibyte
+buffers and strings.  The text of a buffer is not copied, so this is
+suitable for hashing large buffers.  Return CONTEXT.  */)
+  (Lisp_Object context, Lisp_Object object, Lisp_Object start,
+   Lisp_Object end)
+{
+  union secure_hash_ctx ctx;
+  Lisp_Object algorithm = get_secure_hash_context (context, &ctx);
+
+  if (STRINGP (object))
+    {
+      ptrdiff_t from, to;
+      validate_subarray (object, start, end, SCHARS (object), &from, &to);
+      ptrdiff_t from_byte = string_char_to_byte (object, from);
+      ptrdiff_t to_byte = string_char_to_byte (object, to);
+      secure_hash_process (algorithm, &ctx, SDATA (object) + from_byte,
+			   to_byte - from_byte);
+    }
+  else
+    {
+      CHECK_BUFFER (object);
+      struct buffer *b = XBUFFER (object);
+      if (!BUFFER_LIVE_P (b))
+	error ("Selecting deleted buffer");
+      specpdl_ref count = SPECPDL_INDEX ();
+      record_unwind_current_buffer ();
+      set_buffer_internal (b);
+      if (NILP (start))
+	start = make_fixnum (BEGV);
+      if (NILP (end))
+	end = make_fixnum (ZV);
+      validate_region (&start, &end);
+      ptrdiff_t from_byte = CHAR_TO_BYTE (XFIXNUM (start));
+      ptrdiff_t to_byte = CHAR_TO_BYTE (XFIXNUM (end));
+
+      /* Hash the text before the gap, then the text after it.  */
+      if (from_byte < GPT_BYTE)
+	{
+	  ptrdiff_t before_gap = min (to_byte, GPT_BYTE);
+	  secure_hash_process (algorithm, &ctx, BYTE_POS_ADDR (from_byte),
+			       before_gap - from_byte);
+	  from_byte = before_gap;
+	}
+      if (from_byte < to_byte)
+	secure_hash_process (algorithm, &ctx, BYTE_POS_ADDR (from_byte),
+			     to_byte - from_byte);
+      unbind_to (count, Qnil);
+    }
+
+  set_secure_hash_context (context, &ctx);
+  return context;
+}
+
+DEFUN ("secure-hash-update-file", Fsecure_hash_update_file,
+       Ssecure_hash_update_file, 2, 2, 0,
+       doc: /* Add the contents of FILE to hash CONTEXT.
+CONTEXT is a value returned by `secure-hash-make'.  The file is read
+in pieces and not decoded, so this is suitable for hashing large files.
+Return CONTEXT.  */)
+  (Lisp_Object context, Lisp_Object file)
+{
+  union secure_hash_ctx ctx;
+  Lisp_Object algorithm = get_secure_hash_context (context, &ctx);
+
+  CHECK_STRING (file);
+  file = Fexpand_file_name (file, Qnil);
+  Lisp_Object handler = Ffind_file_name_handler (file,
+						 Qsecure_hash_update_file);
+  if (!NILP (handler))
+    return calln (handler, Qsecure_hash_update_file, context, file);
+
+  Lisp_Object encoded = ENCODE_FILE (file);
+  int fd = emacs_open (SSDATA (encoded), O_RDONLY, 0);
+  if (fd < 0)
+    report_file_error ("Opening input file", file);
+  specpdl_ref count = SPECPDL_INDEX ();
+  record_unwind_protect_int (close_file_unwind, fd);
+
+  /* Update a local copy of the state, so that CONTEXT is unchanged if
+     reading fails or is interrupted.  */
+  char buf[16 * 1024];
+  ptrdiff_t nread;
+  while (0 < (nread = emacs_read_quit (fd, buf, sizeof buf)))
+    secure_hash_process (algorithm, &ctx, buf, nread);
+  if (nread < 0)
+    report_file_error ("Read error", file);
+
+  unbind_to (count, Qnil);
+  set_secure_hash_context (context, &ctx);
+  return context;
+}
+
+DEFUN ("secure-hash-final", Fsecure_hash_final, Ssecure_hash_final,
+       1, 2, 0,
+       doc: /* Return the hash of the data added to CONTEXT.
+CONTEXT is a value returned by `secure-hash-make'.  The value is in
+the same form as that of `secure-hash'; in particular, if BINARY is
+non-nil, return a unibyte string holding the hash in binary form.
+CONTEXT is not changed, so more data can be added to it afterward.  */)
+  (Lisp_Object context, Lisp_Object binary)
+{
+  union secure_hash_ctx ctx;
+  Lisp_Object algorithm = get_secure_hash_context (context, &ctx);
+  char buf[SHA512_DIGEST_SIZE];
+  int digest_size = secure_hash_finish (algorithm, &ctx, buf);
+  if (!NILP (binary))
+    return make_unibyte_string (buf, digest_size);
+
+  Lisp_Object digest = make_uninit_string (digest_size * 2);
+  memcpy (SDATA (digest), buf, digest_size);
+  return make_digest_string (digest, digest_size);
+}
+
 DEFUN ("buffer-line-statistics", Fbuffer_line_statistics,
        Sbuffer_line_statistics, 0, 1, 0,
        doc: /* Return data about lines in BUFFER.
@@ -6708,6 +7370,8 @@ syms_of_fns (void)
   DEFSYM (Qsha256, "sha256");
   DEFSYM (Qsha384, "sha384");
   DEFSYM (Qsha512, "sha512");
+  DEFSYM (Qsecure_hash_context, "secure-hash-context");
+  DEFSYM (Qsecure_hash_update_file, "secure-hash-update-file");
 
   /* Miscellaneous stuff.  */
 
@@ -6725,8 +7389,11 @@ syms_of_fns (void)
   Voverriding_plist_environment = Qnil;
   DEFSYM (Qoverriding_plist_environment, "overriding-plist-environment");
 
-  staticpro (&string_char_byte_cache_string);
-  string_char_byte_cache_string = Qnil;
+  for (int i = 0; i < STRING_CHAR_BYTE_CACHE_SIZE; i++)
+    {
+      staticpro (&string_char_byte_cache[i].string);
+      string_char_byte_cache[i].string = Qnil;
+    }
 
   require_nesting_list = Qnil;
   staticpro (&require_nesting_list);
@@ -6794,6 +7461,7 @@ syms_of_fns (void)
   defsubr (&Sproper_list_p);
   defsubr (&Sstring_bytes);
   defsubr (&Sstring_distance);
+  defsubr (&Sstring_distance_many);
   defsubr (&Sstring_equal);
   defsubr (&Scompare_strings);
   defsubr (&Sstring_lessp);
@@ -6861,6 +7529,10 @@ syms_of_fns (void)
   defsubr (&Ssecure_hash_algorithms);
   defsubr (&Ssecure_hash);
   defsubr (&Sbuffer_hash);
+  defsubr (&Ssecure_hash_make);
+  defsubr (&Ssecure_hash_update);
+  defsubr (&Ssecure_hash_update_file);
+  defsubr (&Ssecure_hash_final);
   defsubr (&Slocale_info);
   defsubr (&Sbuffer_line_statistics);
 
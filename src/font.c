@@ -2646,6 +2646,9 @@ font_clear_cache (struct frame *f, Lisp_Object cache,
 			     around in lgstring cache that reference
 			     the font.  */
 			  composition_gstring_cache_clear_font (val);
+#ifdef HAVE_HARFBUZZ
+			  hbfont_shape_cache_clear_font (val);
+#endif
 			  driver->close_font (font);
 			}
 		    }
@@ -3024,6 +3027,9 @@ font_close_object (struct frame *f, Lisp_Object font_object)
     /* Already closed.  */
     return;
   FONT_ADD_LOG ("close", font_object, Qnil);
+#ifdef HAVE_HARFBUZZ
+  hbfont_shape_cache_clear_font (font_object);
+#endif
   font->driver->close_font (font);
 #ifdef HAVE_WINDOW_SYSTEM
   eassert (FRAME_DISPLAY_INFO (f)->n_fonts);
@@ -6041,6 +6047,10 @@ syms_of_font (void)
 match.  */);
   query_all_font_backends = false;
 
+#ifdef HAVE_HARFBUZZ
+  syms_of_hbfont ();
+#endif
+
 #ifdef HAVE_WINDOW_SYSTEM
 #ifdef HAVE_FREETYPE
   syms_of_ftfont ();
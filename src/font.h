@@ -917,6 +917,8 @@ valid_font_driver (struct font_driver const *d)
 extern Lisp_Object hbfont_otf_capability (struct font *);
 extern Lisp_Object hbfont_shape (Lisp_Object, Lisp_Object);
 extern Lisp_Object hbfont_combining_capability (struct font *);
+extern void hbfont_shape_cache_clear_font (Lisp_Object);
+extern void syms_of_hbfont (void);
 #endif
 
 #if defined (HAVE_XFT) || defined (HAVE_FREETYPE)
@@ -35,6 +35,9 @@
 #endif
 
 #include <c-strcase.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <stat-time.h>
 
 #include "lisp.h"
 #include "dispextern.h"
@@ -45,6 +48,8 @@
 #include "font.h"
 #include "ftfont.h"
 #include "pdumper.h"
+#include "coding.h"
+#include "systime.h"
 
 static struct font_driver const ftfont_driver;
 #ifdef HAVE_HARFBUZZ
@@ -862,10 +867,255 @@ ftfont_spec_pattern (Lisp_Object spec, char *otlayout,
   return pattern;
 }
 
+
+/* Persistent cache of font matches.
+
+   Asking fontconfig for the fonts matching a spec is slow, and Emacs
+   does it many times when it starts, and whenever it needs a fallback
+   font for a new script.  So the results of ftfont_list and
+   ftfont_match are remembered across sessions in the file named by
+   `font-match-cache-file'.  The cache is a hash table whose keys are
+   printed representations of each query, and whose values are lists
+   of vectors holding the properties of the fonts found.  It is only
+   valid for the fontconfig configuration it was made with, so the
+   file also records the version of fontconfig and the newest
+   modification time of its configuration files and font
+   directories.  */
+
+/* The version of the format of the cache file.  */
+enum { FTFONT_MATCH_CACHE_VERSION = 1 };
+
+/* The cache, or nil before it is loaded, and the stamp of the
+   fontconfig configuration.  */
+static Lisp_Object ftfont_match_cache, ftfont_match_cache_stamp;
+
+/* True if the cache has entries that are not in the file yet, and if
+   a call to `font--save-match-cache' has been arranged.  */
+static bool ftfont_match_cache_dirty, ftfont_match_cache_scheduled;
+
+/* Return the name of the cache file, or nil if there is none.  */
+
+static Lisp_Object
+ftfont_match_cache_file (void)
+{
+  if (!EQ (Vfont_match_cache_file, Qt))
+    return STRINGP (Vfont_match_cache_file) ? Vfont_match_cache_file : Qnil;
+
+  const char *cache_home = getenv ("XDG_CACHE_HOME");
+  if (cache_home && *cache_home)
+    return concat2 (build_string (cache_home),
+		    build_string ("/emacs/font-match-cache"));
+
+  const char *home = getenv ("HOME");
+  if (home && *home)
+    return concat2 (build_string (home),
+		    build_string ("/.cache/emacs/font-match-cache"));
+  return Qnil;
+}
+
+/* Return a stamp identifying the current fontconfig configuration.  */
+
+static Lisp_Object
+ftfont_config_stamp (void)
+{
+  struct timespec newest = make_timespec (0, 0);
+  FcConfig *config = FcConfigGetCurrent ();
+
+  for (int i = 0; i < 2; i++)
+    {
+      FcStrList *list = (i == 0 ? FcConfigGetConfigFiles (config)
+			 : FcConfigGetFontDirs (config));
+      FcChar8 *name;
+      struct stat st;
+
+      if (!list)
+	continue;
+      while ((name = FcStrListNext (list)))
+	if (stat ((char *) name, &st) == 0
+	    && timespec_cmp (get_stat_mtime (&st), newest) > 0)
+	  newest = get_stat_mtime (&st);
+      FcStrListDone (list);
+    }
+
+  return list3 (make_fixnum (FTFONT_MATCH_CACHE_VERSION),
+		make_fixnum (FcGetVersion ()), make_lisp_time (newest));
+}
+
+static Lisp_Object
+ftfont_read_match_cache_1 (Lisp_Object file)
+{
+  Lisp_Object encoded = ENCODE_FILE (file);
+  struct stat st;
+  int fd = emacs_open (SSDATA (encoded), O_RDONLY, 0);
+
+  if (fd < 0)
+    return Qnil;
+  if (fstat (fd, &st) != 0 || st.st_size <= 0
+      || PTRDIFF_MAX < st.st_size)
+    {
+      emacs_close (fd);
+      return Qnil;
+    }
+
+  char *buf = xmalloc (st.st_size);
+  ptrdiff_t nread = emacs_read (fd, buf, st.st_size);
+  emacs_close (fd);
+
+  /* The file is written in Emacs's internal encoding.  */
+  Lisp_Object contents = (nread == st.st_size
+			  ? make_string (buf, nread) : Qnil);
+  xfree (buf);
+
+  return (NILP (contents) ? Qnil
+	  : XCAR (Fread_from_string (contents, Qnil, Qnil)));
+}
+
+static Lisp_Object
+ftfont_match_cache_error (Lisp_Object error)
+{
+  return Qnil;
+}
+
+/* Load the cache from its file, unless that is already done.  Discard
+   what the file contains if it was made for another configuration.  */
+
+static void
+ftfont_load_match_cache (void)
+{
+  Lisp_Object file, data;
+
+  if (!NILP (ftfont_match_cache))
+    return;
+
+  ftfont_match_cache_stamp = ftfont_config_stamp ();
+  file = ftfont_match_cache_file ();
+  data = (NILP (file) ? Qnil
+	  : internal_condition_case_1 (ftfont_read_match_cache_1, file,
+				       Qt, ftfont_match_cache_error));
+
+  if (CONSP (data) && CONSP (XCDR (data))
+      && !NILP (Fequal (XCAR (data), ftfont_match_cache_stamp))
+      && HASH_TABLE_P (XCAR (XCDR (data))))
+    ftfont_match_cache = XCAR (XCDR (data));
+  else
+    ftfont_match_cache = CALLN (Fmake_hash_table, QCtest, Qequal);
+}
+
+/* Return the key of the cache for the query OP of SPEC, or nil if the
+   query can't be cached.  */
+
+static Lisp_Object
+ftfont_match_cache_key (Lisp_Object op, Lisp_Object spec)
+{
+  Lisp_Object key, props = make_nil_vector (FONT_EXTRA_INDEX + 2);
+
+  if (NILP (Vfont_match_cache_file))
+    return Qnil;
+
+  ASET (props, 0, op);
+  for (int i = 0; i <= FONT_EXTRA_INDEX; i++)
+    ASET (props, i + 1, AREF (spec, i));
+  key = Fprin1_to_string (props, Qnil, Qt);
+
+  /* Specs containing unreadable objects can't be written to the
+     file.  */
+  if (strstr (SSDATA (key), "#<"))
+    return Qnil;
+  return key;
+}
+
+/* Return the font entity whose properties PROPS were saved in the
+   cache.  */
+
+static Lisp_Object
+ftfont_match_cache_entity (Lisp_Object props)
+{
+  Lisp_Object entity = font_make_entity ();
+
+  for (int i = 0; i < FONT_EXTRA_INDEX; i++)
+    ASET (entity, i, AREF (props, i));
+  ASET (entity, FONT_EXTRA_INDEX,
+	Fcopy_alist (AREF (props, FONT_EXTRA_INDEX)));
+  return entity;
+}
+
+/* Return the properties of ENTITY to save in the cache.  */
+
+static Lisp_Object
+ftfont_match_cache_props (Lisp_Object entity)
+{
+  Lisp_Object props = make_nil_vector (FONT_EXTRA_INDEX + 1);
+
+  for (int i = 0; i <= FONT_EXTRA_INDEX; i++)
+    ASET (props, i, AREF (entity, i));
+  return props;
+}
+
+/* Record ENTITIES, the list of entities found for KEY, in the cache.
+   This is called from redisplay, which cannot run Lisp, so the file
+   is written later, from an idle timer started through
+   `pending_funcalls'.  */
+
+static void
+ftfont_match_cache_put (Lisp_Object key, Lisp_Object entities)
+{
+  Lisp_Object tail, value = Qnil;
+
+  for (tail = entities; CONSP (tail); tail = XCDR (tail))
+    value = Fcons (ftfont_match_cache_props (XCAR (tail)), value);
+  Fputhash (key, Fnreverse (value), ftfont_match_cache);
+
+  ftfont_match_cache_dirty = true;
+  if (!ftfont_match_cache_scheduled)
+    {
+      ftfont_match_cache_scheduled = true;
+      pending_funcalls = Fcons (list4 (Qrun_with_idle_timer, make_fixnum (5),
+				       Qnil, Qfont__save_match_cache),
+				pending_funcalls);
+    }
+}
+
+static Lisp_Object
+ftfont_save_match_cache_1 (Lisp_Object args)
+{
+  Lisp_Object file = XCAR (args);
+
+  calln (Qmake_directory, Ffile_name_directory (file), Qt);
+  /* A VISIT argument of neither t nor nil nor a string means not to
+     say "Wrote FILE".  */
+  Fwrite_region (XCDR (args), Qnil, file, Qnil, Qlambda, Qnil, Qnil);
+  return Qnil;
+}
+
+DEFUN ("font--save-match-cache", Ffont__save_match_cache,
+       Sfont__save_match_cache, 0, 0, 0,
+       doc: /* Write the cache of font matches to `font-match-cache-file'.
+This function is for internal use only.  */)
+  (void)
+{
+  Lisp_Object file, contents;
+  specpdl_ref count = SPECPDL_INDEX ();
+
+  ftfont_match_cache_scheduled = false;
+  if (!ftfont_match_cache_dirty
+      || NILP (file = ftfont_match_cache_file ()))
+    return Qnil;
+
+  contents = Fprin1_to_string (list2 (ftfont_match_cache_stamp,
+				      ftfont_match_cache),
+			       Qnil, Qt);
+  specbind (Qcoding_system_for_write, Qutf_8_emacs_unix);
+  internal_condition_case_1 (ftfont_save_match_cache_1,
+			     Fcons (file, contents), Qt,
+			     ftfont_match_cache_error);
+  ftfont_match_cache_dirty = false;
+  return unbind_to (count, Qnil);
+}
+
 static Lisp_Object
 ftfont_list (struct frame *f, Lisp_Object spec)
 {
-  Lisp_Object val = Qnil, family, adstyle;
+  Lisp_Object val = Qnil, family, adstyle, key;
   int i;
   FcPattern *pattern;
   FcFontSet *fontset = NULL;
@@ -883,6 +1133,22 @@ ftfont_list (struct frame *f, Lisp_Object spec)
       fc_initialized = 1;
     }
 
+  ftfont_load_match_cache ();
+  key = ftfont_match_cache_key (Qlist, spec);
+  if (! NILP (key))
+    {
+      Lisp_Object cached = Fgethash (key, ftfont_match_cache, Qt);
+
+      if (! EQ (cached, Qt))
+	{
+	  for (; CONSP (cached); cached = XCDR (cached))
+	    val = Fcons (ftfont_match_cache_entity (XCAR (cached)), val);
+	  val = Fnreverse (val);
+	  FONT_ADD_LOG ("ftfont-list", spec, val);
+	  return val;
+	}
+    }
+
   pattern = ftfont_spec_pattern (spec, otlayout, &otspec, &langname);
   if (! pattern)
     return Qnil;
@@ -1074,6 +1340,8 @@ ftfont_list (struct frame *f, Lisp_Object spec)
 	val = Fcons (entity, val);
     }
   val = Fnreverse (val);
+  if (! NILP (key))
+    ftfont_match_cache_put (key, val);
   goto finish;
 
  err:
@@ -1108,6 +1376,7 @@ ftfont_match (struct frame *f, Lisp_Object spec)
   char otlayout[15];		/* For "otlayout:XXXX" */
   struct OpenTypeSpec *otspec = NULL;
   const char *langname = NULL;
+  Lisp_Object key;
 
   if (! fc_initialized)
     {
@@ -1115,6 +1384,21 @@ ftfont_match (struct frame *f, Lisp_Object spec)
       fc_initialized = 1;
     }
 
+  ftfont_load_match_cache ();
+  key = ftfont_match_cache_key (Qmatch, spec);
+  if (! NILP (key))
+    {
+      Lisp_Object cached = Fgethash (key, ftfont_match_cache, Qt);
+
+      if (! EQ (cached, Qt))
+	{
+	  if (CONSP (cached))
+	    entity = ftfont_match_cache_entity (XCAR (cached));
+	  FONT_ADD_LOG ("ftfont-match", spec, entity);
+	  return entity;
+	}
+    }
+
   pattern = ftfont_spec_pattern (spec, otlayout, &otspec, &langname);
   if (! pattern)
     return Qnil;
@@ -1142,6 +1426,8 @@ ftfont_match (struct frame *f, Lisp_Object spec)
 				      AREF (entity, FONT_FAMILY_INDEX))))
 	    entity = Qnil;
 	}
+      if (! NILP (key))
+	ftfont_match_cache_put (key, NILP (entity) ? Qnil : list1 (entity));
     }
   FcPatternDestroy (pattern);
 
@@ -3213,6 +3499,31 @@ syms_of_ftfont (void)
   DEFSYM (QCembolden, ":embolden");
   DEFSYM (QClcdfilter, ":lcdfilter");
 
+  DEFSYM (Qmatch, "match");
+  DEFSYM (Qrun_with_idle_timer, "run-with-idle-timer");
+  DEFSYM (Qfont__save_match_cache, "font--save-match-cache");
+  DEFSYM (Qutf_8_emacs_unix, "utf-8-emacs-unix");
+
+  DEFVAR_LISP ("font-match-cache-file", Vfont_match_cache_file,
+    doc: /* File in which Emacs remembers the fonts matching font specs.
+Finding the fonts that match a font spec takes fontconfig some time,
+which adds up when Emacs starts, or when it looks for a font for a
+script it hasn't displayed yet.  Emacs therefore records the fonts it
+found in this file, and reuses them in later sessions, until the
+fontconfig configuration or the installed fonts change.
+
+The value t means to use the file "emacs/font-match-cache" in the
+directory named by the environment variable XDG_CACHE_HOME, or
+"~/.cache/emacs/font-match-cache" if it is unset.  The value nil
+means not to use such a file, nor to remember font matches.  */);
+  Vfont_match_cache_file = Qt;
+
+  staticpro (&ftfont_match_cache);
+  ftfont_match_cache = Qnil;
+  staticpro (&ftfont_match_cache_stamp);
+  ftfont_match_cache_stamp = Qnil;
+  defsubr (&Sfont__save_match_cache);
+
   staticpro (&freetype_font_cache);
   freetype_font_cache = list1 (Qt);
 
@@ -3231,6 +3542,7 @@ syms_of_ftfont (void)
 syms_of_ftfont_for_pdumper (void)
 {
   PDUMPER_RESET_LV (ft_face_cache, Qnil);
+  PDUMPER_RESET_LV (ftfont_match_cache, Qnil);
   register_font_driver (&ftfont_driver, NULL);
 #ifdef HAVE_HARFBUZZ
   fthbfont_driver = ftfont_driver;
@@ -102,7 +102,9 @@ dir_monitor_callback (GFileMonitor *monitor,
 						  otail))),
 			     XCAR (XCDR (XCDR (XCDR (watch_object)))));
 
-	  /* Store it into the input event queue.  */
+	  /* Store it into the input event queue, and forget the
+	     attributes of files that may have changed.  */
+	  file_attribute_cache_flush ();
 	  kbd_buffer_store_event (&event);
 	  /* XD_DEBUG_MESSAGE ("%s", XD_OBJECT_TO_STRING (event.arg));  */
 	}
@@ -69,6 +69,17 @@
 #  define HAVE_GNUTLS_EXT_GET_NAME
 # endif
 
+# if GNUTLS_VERSION_NUMBER >= 0x030605
+#  define HAVE_GNUTLS_TLS1_3
+# endif
+
+/* Kernel TLS offload is for GNU/Linux and FreeBSD, and GnuTLS turns
+   it on according to its system-wide configuration.  */
+# if GNUTLS_VERSION_NUMBER >= 0x030703 && !defined WINDOWSNT
+#  include <gnutls/socket.h>
+#  define HAVE_GNUTLS_KTLS
+# endif
+
 /* Although AEAD support started in GnuTLS 3.4.0 and works in 3.5.14,
    it was broken through at least GnuTLS 3.4.10; see:
    https://lists.gnu.org/r/emacs-devel/2017-07/msg00992.html
@@ -89,6 +100,14 @@
 
 static bool gnutls_global_initialized;
 
+/* A hash table mapping the keys of recent TLS sessions to the data
+   that resumes them, so that connecting to the same host again can
+   skip most of the handshake.  The data is kept only in memory.  */
+static Lisp_Object gnutls_session_cache;
+
+/* The maximum number of entries in gnutls_session_cache.  */
+enum { GNUTLS_SESSION_CACHE_MAX = 256 };
+
 static void gnutls_log_function (int, const char *);
 static void gnutls_log_function2 (int, const char *, const char *);
 # ifdef HAVE_GNUTLS3
@@ -217,6 +236,14 @@ DEF_DLL_FN (int, gnutls_x509_crt_get_key_id,
 	    (gnutls_x509_crt_t, unsigned int, unsigned char *, size_t *_size));
 DEF_DLL_FN (const char *, gnutls_sec_param_get_name, (gnutls_sec_param_t));
 DEF_DLL_FN (const char *, gnutls_sign_get_name, (gnutls_sign_algorithm_t));
+DEF_DLL_FN (int, gnutls_session_get_data,
+	     (gnutls_session_t, void *, size_t *));
+DEF_DLL_FN (int, gnutls_session_set_data,
+	     (gnutls_session_t, const void *, size_t));
+DEF_DLL_FN (int, gnutls_session_is_resumed, (gnutls_session_t));
+#  ifdef HAVE_GNUTLS_TLS1_3
+DEF_DLL_FN (unsigned, gnutls_session_get_flags, (gnutls_session_t));
+#  endif
 DEF_DLL_FN (int, gnutls_server_name_set,
 	    (gnutls_session_t, gnutls_server_name_type_t,
 	     const void *, size_t));
@@ -378,6 +405,12 @@ init_gnutls_functions (void)
   LOAD_DLL_FN (library, gnutls_x509_crt_get_key_id);
   LOAD_DLL_FN (library, gnutls_sec_param_get_name);
   LOAD_DLL_FN (library, gnutls_sign_get_name);
+  LOAD_DLL_FN (library, gnutls_session_get_data);
+  LOAD_DLL_FN (library, gnutls_session_set_data);
+  LOAD_DLL_FN (library, gnutls_session_is_resumed);
+#   ifdef HAVE_GNUTLS_TLS1_3
+  LOAD_DLL_FN (library, gnutls_session_get_flags);
+#   endif
   LOAD_DLL_FN (library, gnutls_server_name_set);
   LOAD_DLL_FN (library, gnutls_kx_get);
   LOAD_DLL_FN (library, gnutls_kx_get_name);
@@ -507,6 +540,10 @@ init_gnutls_functions (void)
 #  define gnutls_record_send fn_gnutls_record_send
 #  define gnutls_sec_param_get_name fn_gnutls_sec_param_get_name
 #  define gnutls_server_name_set fn_gnutls_server_name_set
+#  define gnutls_session_get_data fn_gnutls_session_get_data
+#  define gnutls_session_get_flags fn_gnutls_session_get_flags
+#  define gnutls_session_is_resumed fn_gnutls_session_is_resumed
+#  define gnutls_session_set_data fn_gnutls_session_set_data
 #  define gnutls_sign_get_name fn_gnutls_sign_get_name
 #  define gnutls_strerror fn_gnutls_strerror
 #  define gnutls_transport_set_errno fn_gnutls_transport_set_errno
@@ -728,10 +765,15 @@ emacs_gnutls_handshake (struct Lisp_Process *proc)
   return gnutls_try_handshake (proc);
 }
 
+/* Return the number of bytes that GnuTLS has read ahead for PROC, or
+   1 if reading from PROC would return what an earlier read from
+   GnuTLS yielded.  */
 ptrdiff_t
-emacs_gnutls_record_check_pending (gnutls_session_t state)
+emacs_gnutls_record_check_pending (struct Lisp_Process *proc)
 {
-  return gnutls_record_check_pending (state);
+  if (proc->gnutls_read_deferred)
+    return 1;
+  return gnutls_record_check_pending (proc->gnutls_state);
 }
 
 # ifdef WINDOWSNT
@@ -788,9 +830,46 @@ emacs_gnutls_read (struct Lisp_Process *proc, char *buf, ptrdiff_t nbyte)
     }
 
   ssize_t rtnval;
-  do
-    rtnval = gnutls_record_recv (state, buf, nbyte);
-  while (rtnval == GNUTLS_E_INTERRUPTED);
+  if (proc->gnutls_read_deferred)
+    {
+      proc->gnutls_read_deferred = false;
+      rtnval = proc->gnutls_deferred_read;
+    }
+  else
+    do
+      rtnval = gnutls_record_recv (state, buf, nbyte);
+    while (rtnval == GNUTLS_E_INTERRUPTED);
+
+# ifndef WINDOWSNT
+  /* gnutls_record_recv returns at most one record, which is at most
+     16 KiB, unless the kernel decrypts the data (kTLS).  Network
+     sockets are non-blocking, so fill the buffer with what has
+     arrived, rather than going through the process loop once for each
+     record.  If that reaches the end of the data or an error, return
+     it from the next call, since the socket need not become readable
+     again.  */
+  if (rtnval > 0)
+    {
+      ptrdiff_t total = rtnval;
+      while (total < nbyte)
+	{
+	  do
+	    rtnval = gnutls_record_recv (state, buf + total, nbyte - total);
+	  while (rtnval == GNUTLS_E_INTERRUPTED);
+	  if (rtnval <= 0)
+	    {
+	      if (rtnval != GNUTLS_E_AGAIN)
+		{
+		  proc->gnutls_deferred_read = rtnval;
+		  proc->gnutls_read_deferred = true;
+		}
+	      break;
+	    }
+	  total += rtnval;
+	}
+      return total;
+    }
+# endif
 
   if (rtnval >= 0)
     return rtnval;
@@ -935,6 +1014,72 @@ gnutls_deinit_certificates (struct Lisp_Process *p)
   p->gnutls_certificates = NULL;
 }
 
+/* Remember the TLS session of P, so that later connections with the
+   same parameters can resume it.  Do this only for sessions whose
+   peer was verified without problems.  */
+static void
+gnutls_save_session (struct Lisp_Process *p)
+{
+  gnutls_session_t state = p->gnutls_state;
+  size_t size = 0;
+
+  if (NILP (p->gnutls_session_key) || !state
+      || p->gnutls_initstage != GNUTLS_STAGE_READY
+      || p->gnutls_peer_verification != 0
+      || p->gnutls_extra_peer_verification != 0)
+    return;
+
+# ifdef HAVE_GNUTLS_TLS1_3
+  /* A TLS 1.3 session can be resumed only with a ticket, which the
+     server sends some time after the handshake.  Without one,
+     gnutls_session_get_data would wait for it.  */
+  if (gnutls_protocol_get_version (state) == GNUTLS_TLS1_3
+      && !(gnutls_session_get_flags (state) & GNUTLS_SFLAGS_SESSION_TICKET))
+    return;
+# endif
+
+  /* This fails but sets SIZE to the size of the data.  */
+  gnutls_session_get_data (state, NULL, &size);
+  if (size == 0 || STRING_BYTES_BOUND < size)
+    return;
+  char *buf = xmalloc (size);
+  int ret = gnutls_session_get_data (state, buf, &size);
+  Lisp_Object data = ret < GNUTLS_E_SUCCESS ? Qnil
+		     : make_unibyte_string (buf, size);
+  xfree (buf);
+  if (NILP (data))
+    return;
+
+  if (GNUTLS_SESSION_CACHE_MAX <= XFIXNUM (Fhash_table_count
+					   (gnutls_session_cache)))
+    Fclrhash (gnutls_session_cache);
+  Fputhash (p->gnutls_session_key, data, gnutls_session_cache);
+  GNUTLS_LOG (2, p->gnutls_log_level, "saved the session for resumption");
+}
+
+/* Prepare the new session STATE of PROC for resuming the last
+   session with the same KEY, if there is one.  */
+static void
+gnutls_resume_session (Lisp_Object proc, gnutls_session_t state,
+		       Lisp_Object key)
+{
+  struct Lisp_Process *p = XPROCESS (proc);
+  Lisp_Object data = Fgethash (key, gnutls_session_cache, Qnil);
+
+  pset_gnutls_session_key (p, key);
+  if (STRINGP (data))
+    {
+      /* Each session can be resumed only once.  */
+      Fremhash (key, gnutls_session_cache);
+      int ret = gnutls_session_set_data (state, SDATA (data), SBYTES (data));
+      if (ret < GNUTLS_E_SUCCESS)
+	GNUTLS_LOG2 (1, p->gnutls_log_level, "cannot resume the session:",
+		     emacs_gnutls_strerror (ret));
+      else
+	GNUTLS_LOG (2, p->gnutls_log_level, "trying to resume the session");
+    }
+}
+
 Lisp_Object
 emacs_gnutls_deinit (Lisp_Object proc)
 {
@@ -963,6 +1108,7 @@ emacs_gnutls_deinit (Lisp_Object proc)
 
   if (XPROCESS (proc)->gnutls_state)
     {
+      gnutls_save_session (XPROCESS (proc));
       gnutls_deinit (XPROCESS (proc)->gnutls_state);
       XPROCESS (proc)->gnutls_state = NULL;
       if (GNUTLS_INITSTAGE (proc) >= GNUTLS_STAGE_INIT)
@@ -1395,7 +1541,12 @@ DEFUN ("gnutls-peer-status", Fgnutls_peer_status, Sgnutls_peer_status, 1, 1, 0,
 first, and intermediary certificates (if any) following it.
 
 In addition, for backwards compatibility, the host certificate is also
-returned as the :certificate entry.  */)
+returned as the :certificate entry.
+
+Where supported, the :kernel-tls entry is a list of the directions,
+`receive' and `send', in which the operating system kernel encrypts or
+decrypts the data of this connection (kTLS).  GnuTLS decides that
+according to its system-wide configuration.  */)
   (Lisp_Object proc)
 {
   Lisp_Object warnings = Qnil, result = Qnil;
@@ -1548,6 +1699,20 @@ DEFUN ("gnutls-peer-status", Fgnutls_peer_status, Sgnutls_peer_status, 1, 1, 0,
       (result, list2 (QCsafe_renegotiation,
 		      gnutls_safe_renegotiation_status (state) ? Qt : Qnil));
 
+  /* Kernel TLS.  */
+# ifdef HAVE_GNUTLS_KTLS
+  {
+    /* This is negative if GnuTLS was built without kTLS support.  */
+    int ktls = gnutls_transport_is_ktls_enabled (state);
+    Lisp_Object directions = Qnil;
+    if (0 < ktls && (ktls & GNUTLS_KTLS_SEND))
+      directions = Fcons (Qsend, directions);
+    if (0 < ktls && (ktls & GNUTLS_KTLS_RECV))
+      directions = Fcons (Qreceive, directions);
+    result = nconc2 (result, list2 (QCkernel_tls, directions));
+  }
+# endif
+
   return result;
 }
 
@@ -1803,6 +1968,10 @@ gnutls_verify_boot (Lisp_Object proc, Lisp_Object proplist)
   /* Set this flag only if the whole initialization succeeded.  */
   p->gnutls_p = true;
 
+  if (gnutls_session_is_resumed (state))
+    GNUTLS_LOG2 (1, max_log_level, "resumed the session with", c_hostname);
+  gnutls_save_session (p);
+
   return gnutls_make_error (ret);
 }
 
@@ -1927,6 +2096,13 @@ DEFUN ("gnutls-boot", Fgnutls_boot, Sgnutls_boot, 3, 3, 0,
 :complete-negotiation, if non-nil, will make negotiation complete
 before returning even on non-blocking sockets.
 
+:resume-session, if non-nil, means to resume the TLS session of an
+earlier connection with the same :hostname, service, TYPE and
+:priority, if one is remembered, which makes the handshake much
+cheaper.  The certificates of the peer are verified in either case.
+It also means to remember the session of this connection for that
+purpose, if its peer was verified without any problems.
+
 :pass, the password of the private key as per GnuTLS'
 gnutls_certificate_set_x509_key_file2.  Specify as nil to have a NULL
 password.
@@ -2063,6 +2239,7 @@ DEFUN ("gnutls-boot", Fgnutls_boot, Sgnutls_boot, 3, 3, 0,
   XPROCESS (proc)->gnutls_x509_cred = NULL;
   XPROCESS (proc)->gnutls_anon_cred = NULL;
   pset_gnutls_cred_type (XPROCESS (proc), type);
+  XPROCESS (proc)->gnutls_read_deferred = false;
   GNUTLS_INITSTAGE (proc) = GNUTLS_STAGE_EMPTY;
 
   GNUTLS_LOG (1, max_log_level, "allocating credentials");
@@ -2268,6 +2445,16 @@ DEFUN ("gnutls-boot", Fgnutls_boot, Sgnutls_boot, 3, 3, 0,
 	return gnutls_make_error (ret);
     }
 
+  if (!NILP (plist_get (proplist, QCresume_session)))
+    {
+      Lisp_Object service = (CONSP (p->childp)
+			     ? plist_get (p->childp, QCservice) : Qnil);
+      gnutls_resume_session (proc, state,
+			     list4 (hostname, service, type, priority_string));
+    }
+  else
+    pset_gnutls_session_key (p, Qnil);
+
   XPROCESS (proc)->gnutls_complete_negotiation_p =
     !NILP (plist_get (proplist, QCcomplete_negotiation));
   GNUTLS_INITSTAGE (proc) = GNUTLS_STAGE_CRED_SET;
@@ -3013,6 +3200,9 @@ syms_of_gnutls (void)
   gnutls_global_initialized = 0;
   PDUMPER_IGNORE (gnutls_global_initialized);
 
+  staticpro (&gnutls_session_cache);
+  gnutls_session_cache = CALLN (Fmake_hash_table, QCtest, Qequal);
+
   DEFSYM (Qgnutls_code, "gnutls-code");
   DEFSYM (Qgnutls_anon, "gnutls-anon");
   DEFSYM (Qgnutls_x509pki, "gnutls-x509pki");
@@ -3026,6 +3216,10 @@ syms_of_gnutls (void)
   DEFSYM (QCmin_prime_bits, ":min-prime-bits");
   DEFSYM (QCloglevel, ":loglevel");
   DEFSYM (QCcomplete_negotiation, ":complete-negotiation");
+  DEFSYM (QCresume_session, ":resume-session");
+  DEFSYM (QCkernel_tls, ":kernel-tls");
+  DEFSYM (Qreceive, "receive");
+  DEFSYM (Qsend, "send");
   DEFSYM (QCpass, ":pass");
   DEFSYM (QCflags, ":flags");
   DEFSYM (QCverify_flags, ":verify-flags");
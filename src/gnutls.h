@@ -84,7 +84,7 @@ emacs_gnutls_write (struct Lisp_Process *proc, const char *buf, ptrdiff_t nbyte)
 extern ptrdiff_t
 emacs_gnutls_read (struct Lisp_Process *proc, char *buf, ptrdiff_t nbyte);
 
-extern ptrdiff_t emacs_gnutls_record_check_pending (gnutls_session_t state);
+extern ptrdiff_t emacs_gnutls_record_check_pending (struct Lisp_Process *proc);
 #ifdef WINDOWSNT
 extern void emacs_gnutls_transport_set_errno (gnutls_session_t state, int err);
 extern int w32_gnutls_rnd (gnutls_rnd_level_t, void *, size_t);
@@ -18,6 +18,7 @@
 
 #include <config.h>
 #include <math.h>
+#include <stdlib.h>		/* for qsort */
 #include <hb.h>
 #include <hb-ot.h>
 
@@ -373,6 +374,120 @@ get_hb_unicode_funcs (void)
   return funcs;
 }
 
+/* Cache of shaped runs.  Shaping the same text with the same font
+   always produces the same glyphs, and redisplay asks for the same
+   runs over and over, so we remember the result of each shaping call.
+
+   The key is a vector [FONT-OBJECT DIRECTION LANGUAGE TEXT], where
+   DIRECTION is the direction passed to HarfBuzz, or nil if HarfBuzz
+   guessed it, LANGUAGE is the language symbol, or nil, and TEXT is a
+   string of the characters that were shaped.  The value is a vector
+   [TICK GLYPH-LEN LGLYPH...], where TICK records when the entry was
+   last used and the LGLYPHs hold the shaped glyphs.  When the cache
+   holds `font-shape-cache-size' entries, the least recently used
+   quarter of them is discarded.  */
+static Lisp_Object hbfont_shape_cache;
+
+/* The current tick of the cache; incremented by every lookup.  */
+static EMACS_INT hbfont_shape_cache_tick;
+
+/* Usage counters reported by `font-shape-cache-statistics'.  */
+static EMACS_INT hbfont_shape_cache_hits;
+static EMACS_INT hbfont_shape_cache_misses;
+static EMACS_INT hbfont_shape_cache_evictions;
+
+static int
+hbfont_compare_ticks (const void *a, const void *b)
+{
+  EMACS_INT ta = *(const EMACS_INT *) a, tb = *(const EMACS_INT *) b;
+  return (ta > tb) - (ta < tb);
+}
+
+/* Discard the least recently used quarter of the shaped-run cache.  */
+static void
+hbfont_shape_cache_evict (void)
+{
+  struct Lisp_Hash_Table *h = XHASH_TABLE (hbfont_shape_cache);
+  ptrdiff_t count = h->count, i = 0;
+  USE_SAFE_ALLOCA;
+  EMACS_INT *ticks;
+
+  SAFE_NALLOCA (ticks, 1, count);
+  DOHASH (h, k, v)
+    ticks[i++] = XFIXNUM (AREF (v, 0));
+  qsort (ticks, count, sizeof *ticks, hbfont_compare_ticks);
+  EMACS_INT oldest = ticks[count / 4];
+  SAFE_FREE ();
+
+  DOHASH (h, k, v)
+    if (XFIXNUM (AREF (v, 0)) <= oldest)
+      {
+	hash_remove_from_table (h, k);
+	hbfont_shape_cache_evictions++;
+      }
+}
+
+/* Remove from the shaped-run cache every entry that references
+   FONT_OBJECT, or every entry if FONT_OBJECT is nil.  */
+void
+hbfont_shape_cache_clear_font (Lisp_Object font_object)
+{
+  if (NILP (hbfont_shape_cache))
+    return;
+  struct Lisp_Hash_Table *h = XHASH_TABLE (hbfont_shape_cache);
+
+  DOHASH (h, k, v)
+    if (NILP (font_object) || EQ (AREF (k, 0), font_object))
+      hash_remove_from_table (h, k);
+}
+
+/* Store in the Ith glyph of LGSTRING the shaped glyph SHAPED.
+   TEXT_LEN is the number of characters that were shaped.  */
+static void
+hbfont_set_glyph (Lisp_Object lgstring, ptrdiff_t i, ptrdiff_t text_len,
+		  Lisp_Object shaped)
+{
+  Lisp_Object lglyph = LGSTRING_GLYPH (lgstring, i);
+  bool new_lglyph = false;
+
+  if (NILP (lglyph))
+    {
+      new_lglyph = true;
+      lglyph = LGLYPH_NEW ();
+      LGSTRING_SET_GLYPH (lgstring, i, lglyph);
+    }
+
+  ptrdiff_t to = LGLYPH_TO (shaped);
+
+  /* All the glyphs in a cluster have the same values of FROM and TO.  */
+  ASET (lglyph, LGLYPH_IX_FROM, AREF (shaped, LGLYPH_IX_FROM));
+  /* This heuristic is for when the Lisp shape-gstring function
+     substitutes known precomposed characters for decomposed
+     sequences.  E.g., hebrew.el does that.  This makes TEXT_LEN
+     be smaller than the original length of the composed character
+     sequence.  In that case, we must not alter the largest TO,
+     because the display engine must know that all the characters
+     in the original sequence were processed by the composition.
+     If we don't do this, some of the composed characters will be
+     displayed again as separate glyphs.  */
+  if (!(!new_lglyph
+	&& to == text_len - 1
+	&& LGLYPH_TO (lglyph) > to))
+    LGLYPH_SET_TO (lglyph, to);
+
+  ASET (lglyph, LGLYPH_IX_CHAR, AREF (shaped, LGLYPH_IX_CHAR));
+  ASET (lglyph, LGLYPH_IX_CODE, AREF (shaped, LGLYPH_IX_CODE));
+  ASET (lglyph, LGLYPH_IX_WIDTH, AREF (shaped, LGLYPH_IX_WIDTH));
+  ASET (lglyph, LGLYPH_IX_LBEARING, AREF (shaped, LGLYPH_IX_LBEARING));
+  ASET (lglyph, LGLYPH_IX_RBEARING, AREF (shaped, LGLYPH_IX_RBEARING));
+  ASET (lglyph, LGLYPH_IX_ASCENT, AREF (shaped, LGLYPH_IX_ASCENT));
+  ASET (lglyph, LGLYPH_IX_DESCENT, AREF (shaped, LGLYPH_IX_DESCENT));
+  /* The adjustment vector is copied, since callers may modify the
+     glyphs of LGSTRING.  */
+  if (!NILP (LGLYPH_ADJUSTMENT (shaped)))
+    LGLYPH_SET_ADJUSTMENT (lglyph, Fcopy_sequence (LGLYPH_ADJUSTMENT (shaped)));
+}
+
 /* HarfBuzz implementation of shape for font backend.
 
    Shape text in LGSTRING.  See the docstring of
@@ -433,17 +548,61 @@ hbfont_shape (Lisp_Object lgstring, Lisp_Object direction)
   if (!text_len)
     return Qnil;
 
+  /* If the caller didn't provide a meaningful DIRECTION, let HarfBuzz
+     guess it.  If they bind bidi-display-reordering to nil, the
+     DIRECTION they provide is meaningless, and we should let HarfBuzz
+     guess the real direction.  */
+  if (NILP (BVAR (current_buffer, bidi_display_reordering)))
+    direction = Qnil;
+
+  /* FIXME: This can only handle the single global language, which
+     normally comes from the locale.  In addition, if
+     current-iso639-language is a list, we arbitrarily use the first
+     one.  We should instead have a notion of the language of the text
+     being shaped.  */
+  Lisp_Object lang = Vcurrent_iso639_language;
+  if (CONSP (Vcurrent_iso639_language))
+    lang = XCAR (Vcurrent_iso639_language);
+  if (!SYMBOLP (lang))
+    lang = Qnil;
+
+  /* Look for the result of shaping the same run earlier.  */
+  Lisp_Object key = Qnil;
+  if (font_shape_cache_size > 0)
+    {
+      USE_SAFE_ALLOCA;
+      unsigned char *text, *p;
+
+      SAFE_NALLOCA (text, MAX_MULTIBYTE_LENGTH, text_len);
+      for (i = 0, p = text; i < text_len; i++)
+	p += CHAR_STRING (chars[i], p);
+      key = CALLN (Fvector, LGSTRING_FONT (lgstring), direction, lang,
+		   make_multibyte_string ((char *) text, text_len, p - text));
+      SAFE_FREE ();
+
+      if (NILP (hbfont_shape_cache))
+	hbfont_shape_cache = CALLN (Fmake_hash_table, QCtest, Qequal);
+      Lisp_Object cached = Fgethash (key, hbfont_shape_cache, Qnil);
+      hbfont_shape_cache_tick++;
+      if (!NILP (cached))
+	{
+	  hbfont_shape_cache_hits++;
+	  ASET (cached, 0, make_fixnum (hbfont_shape_cache_tick));
+	  glyph_len = XFIXNUM (AREF (cached, 1));
+	  if (glyph_len > LGSTRING_GLYPH_LEN (lgstring))
+	    return Qnil;
+	  for (i = 0; i < glyph_len; i++)
+	    hbfont_set_glyph (lgstring, i, text_len, AREF (cached, i + 2));
+	  return make_fixnum (glyph_len);
+	}
+      hbfont_shape_cache_misses++;
+    }
+
   hb_buffer_set_content_type (hb_buffer, HB_BUFFER_CONTENT_TYPE_UNICODE);
   hb_buffer_set_cluster_level (hb_buffer,
 			       HB_BUFFER_CLUSTER_LEVEL_MONOTONE_GRAPHEMES);
 
-  /* If the caller didn't provide a meaningful DIRECTION, let HarfBuzz
-     guess it. */
-  if (!NILP (direction)
-      /* If they bind bidi-display-reordering to nil, the DIRECTION
-	 they provide is meaningless, and we should let HarfBuzz guess
-	 the real direction.  */
-      && !NILP (BVAR (current_buffer, bidi_display_reordering)))
+  if (!NILP (direction))
     {
       hb_direction_t dir = HB_DIRECTION_LTR;
       if (EQ (direction, QL2R))
@@ -459,15 +618,7 @@ hbfont_shape (Lisp_Object lgstring, Lisp_Object direction)
   hb_buffer_set_script (hb_buffer, XXX);
 #endif
 
-  /* FIXME: This can only handle the single global language, which
-     normally comes from the locale.  In addition, if
-     current-iso639-language is a list, we arbitrarily use the first
-     one.  We should instead have a notion of the language of the text
-     being shaped.  */
-  Lisp_Object lang = Vcurrent_iso639_language;
-  if (CONSP (Vcurrent_iso639_language))
-    lang = XCAR (Vcurrent_iso639_language);
-  if (SYMBOLP (lang))
+  if (!NILP (lang))
     {
       Lisp_Object lang_str = SYMBOL_NAME (lang);
       hb_buffer_set_language (hb_buffer,
@@ -512,19 +663,18 @@ hbfont_shape (Lisp_Object lgstring, Lisp_Object direction)
   pos = hb_buffer_get_glyph_positions (hb_buffer, NULL);
   ptrdiff_t from = -1, to UNINIT, cluster_offset UNINIT;
   int incr = buf_reversed ? -1 : 1;
+  Lisp_Object cached = Qnil;
+  if (!NILP (key))
+    {
+      cached = make_nil_vector (glyph_len + 2);
+      ASET (cached, 0, make_fixnum (hbfont_shape_cache_tick));
+      ASET (cached, 1, make_fixnum (glyph_len));
+    }
   for (i = 0; i < glyph_len; i++)
     {
-      Lisp_Object lglyph = LGSTRING_GLYPH (lgstring, i);
+      Lisp_Object lglyph = LGLYPH_NEW ();
       struct font_metrics metrics = {.width = 0};
       int xoff, yoff, wadjust;
-      bool new_lglyph = false;
-
-      if (NILP (lglyph))
-	{
-	  new_lglyph = true;
-	  lglyph = LGLYPH_NEW ();
-	  LGSTRING_SET_GLYPH (lgstring, i, lglyph);
-	}
 
       if (info[i].cluster != from)
 	{
@@ -554,21 +704,8 @@ hbfont_shape (Lisp_Object lgstring, Lisp_Object direction)
 
       eassume (0 <= from);
 
-      /* All the glyphs in a cluster have the same values of FROM and TO.  */
       LGLYPH_SET_FROM (lglyph, from);
-      /* This heuristic is for when the Lisp shape-gstring function
-	 substitutes known precomposed characters for decomposed
-	 sequences.  E.g., hebrew.el does that.  This makes TEXT_LEN
-	 be smaller than the original length of the composed character
-	 sequence.  In that case, we must not alter the largest TO,
-	 because the display engine must know that all the characters
-	 in the original sequence were processed by the composition.
-	 If we don't do this, some of the composed characters will be
-	 displayed again as separate glyphs.  */
-      if (!(!new_lglyph
-	    && to == text_len - 1
-	    && LGLYPH_TO (lglyph) > to))
-	LGLYPH_SET_TO (lglyph, to);
+      LGLYPH_SET_TO (lglyph, to);
 
       /* Not every glyph in a cluster maps directly to a single
 	 character; in general, N characters can yield M glyphs, where
@@ -600,6 +737,16 @@ hbfont_shape (Lisp_Object lgstring, Lisp_Object direction)
 					      make_fixnum (xoff),
 					      make_fixnum (yoff),
 					      make_fixnum (wadjust)));
+      hbfont_set_glyph (lgstring, i, text_len, lglyph);
+      if (!NILP (cached))
+	ASET (cached, i + 2, lglyph);
+    }
+
+  if (!NILP (cached))
+    {
+      if (XHASH_TABLE (hbfont_shape_cache)->count >= font_shape_cache_size)
+	hbfont_shape_cache_evict ();
+      Fputhash (key, cached, hbfont_shape_cache);
     }
 
   return make_fixnum (glyph_len);
@@ -610,3 +757,60 @@ hbfont_combining_capability (struct font *font)
 {
   return Qt;
 }
+
+DEFUN ("font-shape-cache-statistics", Ffont_shape_cache_statistics,
+       Sfont_shape_cache_statistics, 0, 1, 0,
+       doc: /* Return statistics about the cache of text shaped by HarfBuzz.
+The value is an alist with the following elements:
+
+  (entries . N)    N is the number of shaped runs in the cache;
+  (hits . N)       N is the number of times shaping was avoided
+                   because the cache held the result;
+  (misses . N)     N is the number of times the text had to be shaped;
+  (evictions . N)  N is the number of entries discarded to keep the
+                   cache within `font-shape-cache-size' entries.
+
+If RESET is non-nil, empty the cache and reset the counters to zero
+after computing the value.  */)
+  (Lisp_Object reset)
+{
+  Lisp_Object val
+    = list4 (Fcons (Qentries,
+		    make_fixnum (NILP (hbfont_shape_cache)
+				 ? 0
+				 : XHASH_TABLE (hbfont_shape_cache)->count)),
+	     Fcons (Qhits, make_int (hbfont_shape_cache_hits)),
+	     Fcons (Qmisses, make_int (hbfont_shape_cache_misses)),
+	     Fcons (Qevictions, make_int (hbfont_shape_cache_evictions)));
+
+  if (!NILP (reset))
+    {
+      hbfont_shape_cache_clear_font (Qnil);
+      hbfont_shape_cache_hits = 0;
+      hbfont_shape_cache_misses = 0;
+      hbfont_shape_cache_evictions = 0;
+    }
+  return val;
+}
+
+void
+syms_of_hbfont (void)
+{
+  hbfont_shape_cache = Qnil;
+  staticpro (&hbfont_shape_cache);
+
+  DEFSYM (Qentries, "entries");
+  DEFSYM (Qhits, "hits");
+  DEFSYM (Qmisses, "misses");
+  DEFSYM (Qevictions, "evictions");
+
+  DEFVAR_INT ("font-shape-cache-size", font_shape_cache_size,
+	      doc: /* Maximum number of shaped runs remembered by the HarfBuzz shaper.
+Shaping a run of text with the same font, direction and language
+always yields the same glyphs, so the result is kept for reuse.  When
+the cache holds this many runs, the least recently used quarter of
+them is discarded.  Zero or a negative value disables the cache.  */);
+  font_shape_cache_size = 1000;
+
+  defsubr (&Sfont_shape_cache_statistics);
+}
@@ -2324,6 +2324,178 @@ free_image_cache (struct frame *f)
   xfree (c);
 }
 
+#if defined HAVE_X_WINDOWS || defined HAVE_ANDROID
+
+/* Return the number of bytes of a pixmap of WIDTH x HEIGHT pixels and
+   DEPTH bits per pixel.  */
+
+static size_t
+pixmap_size_in_bytes (int width, int height, int depth)
+{
+  int bits_per_pixel = (depth > 16 ? 32 : depth > 8 ? 16
+			: depth > 1 ? 8 : 1);
+  return (((size_t) width * bits_per_pixel + 31) / 32 * 4) * height;
+}
+
+#endif
+
+/* Return the number of bytes image IMG of frame F takes.  */
+
+static size_t
+image_size_in_bytes (struct frame *f, struct image *img)
+{
+  size_t size = 0;
+
+#if defined USE_CAIRO
+  Emacs_Pixmap pm = img->pixmap;
+  if (pm)
+    size += pm->height * pm->bytes_per_line;
+  Emacs_Pixmap msk = img->mask;
+  if (msk)
+    size += msk->height * msk->bytes_per_line;
+
+#elif defined HAVE_X_WINDOWS || defined HAVE_ANDROID
+  /* The server stores pixmaps with the depth of the display, in rows
+     padded to 32 bits, and masks with a depth of 1.  */
+  if (img->pixmap != NO_PIXMAP)
+    size += pixmap_size_in_bytes (img->width, img->height,
+				  FRAME_DISPLAY_INFO (f)->n_planes);
+  if (img->mask != NO_PIXMAP)
+    size += pixmap_size_in_bytes (img->width, img->height, 1);
+
+  if (img->ximg && img->ximg->data)
+    size += img->ximg->bytes_per_line * img->ximg->height;
+  if (img->mask_img && img->mask_img->data)
+    size += img->mask_img->bytes_per_line * img->mask_img->height;
+
+#elif defined HAVE_NS
+  if (img->pixmap)
+    size += ns_image_size_in_bytes (img->pixmap);
+  if (img->mask)
+    size += ns_image_size_in_bytes (img->mask);
+
+#elif defined HAVE_NTGUI
+  if (img->pixmap)
+    size += w32_image_size (img->pixmap);
+  if (img->mask)
+    size += w32_image_size (img->mask);
+
+#elif defined HAVE_HAIKU
+  if (img->pixmap)
+    size += BBitmap_bytes_length (img->pixmap);
+  if (img->mask)
+    size += BBitmap_bytes_length (img->mask);
+#endif
+
+  return size;
+}
+
+static size_t
+image_frame_cache_size (struct frame *f)
+{
+  struct image_cache *c = FRAME_IMAGE_CACHE (f);
+  if (!c)
+    return 0;
+
+  size_t total = 0;
+  for (ptrdiff_t i = 0; i < c->used; ++i)
+    {
+      struct image *img = c->images[i];
+      total += img ? image_size_in_bytes (f, img) : 0;
+    }
+  return total;
+}
+
+/* The start of the latest redisplay cycle.  Images displayed since
+   then are not freed to honor `image-cache-max-size'.  */
+static struct timespec image_cycle_start;
+
+/* True means that an image cache has grown larger than
+   `image-cache-max-size' during redisplay, which should clear the
+   image caches when it is done.  */
+static bool image_cache_over_budget;
+
+/* Return the size in bytes allowed for an image cache, or SIZE_MAX if
+   there is no limit.  */
+
+static size_t
+image_cache_budget (void)
+{
+  return (FIXNATP (Vimage_cache_max_size)
+	  ? XFIXNAT (Vimage_cache_max_size) : SIZE_MAX);
+}
+
+static int
+compare_image_timestamps (void const *a, void const *b)
+{
+  struct image const *img_a = *(struct image *const *) a;
+  struct image const *img_b = *(struct image *const *) b;
+  return timespec_cmp (img_a->timestamp, img_b->timestamp);
+}
+
+/* If the image cache of frame F is larger than `image-cache-max-size',
+   free its least recently displayed images until it fits, sparing
+   those displayed in the latest redisplay cycle.  Value is the number
+   of images freed.  */
+
+static ptrdiff_t
+image_cache_evict_lru (struct frame *f)
+{
+  struct image_cache *c = FRAME_IMAGE_CACHE (f);
+  size_t budget = image_cache_budget ();
+  size_t total;
+  ptrdiff_t i, n = 0, nfreed = 0;
+  USE_SAFE_ALLOCA;
+
+  if (budget == SIZE_MAX || (total = image_frame_cache_size (f)) <= budget)
+    return 0;
+
+  struct image **images;
+  SAFE_NALLOCA (images, 1, c->used);
+  for (i = 0; i < c->used; ++i)
+    if (c->images[i]
+	&& timespec_cmp (c->images[i]->timestamp, image_cycle_start) < 0)
+      images[n++] = c->images[i];
+  qsort (images, n, sizeof *images, compare_image_timestamps);
+
+  for (i = 0; i < n && total > budget; ++i)
+    {
+      total -= image_size_in_bytes (f, images[i]);
+      free_image (f, images[i]);
+      ++nfreed;
+    }
+
+  SAFE_FREE ();
+  return nfreed;
+}
+
+/* Note that IMG has just been decoded on frame F, and shrink its image
+   cache if that made it too large.  Redisplay can't free images yet,
+   because the glyph matrices it is building may refer to them; it
+   clears the caches when it's done instead.  */
+
+static void
+image_cache_check_budget (struct frame *f)
+{
+  if (image_cache_budget () == SIZE_MAX
+      || image_frame_cache_size (f) <= image_cache_budget ())
+    return;
+
+  if (redisplaying_p)
+    image_cache_over_budget = true;
+  else
+    clear_image_cache (f, Qnil);
+}
+
+/* Return true if redisplay should clear the image caches because one
+   of them grew too large.  */
+
+bool
+image_caches_over_budget_p (void)
+{
+  return image_cache_over_budget;
+}
+
 /* Clear image cache of frame F.  FILTER=t means free all images.
    FILTER=nil means clear only images that haven't been
    displayed for some time.
@@ -2391,6 +2563,11 @@ clear_image_cache (struct frame *f, Lisp_Object filter)
 	    }
 	}
 
+      /* Then, if the cache is still too large, free the images that
+	 were displayed least recently.  */
+      if (NILP (filter))
+	nfreed += image_cache_evict_lru (f);
+
       /* We may be clearing the image cache because, for example,
 	 Emacs was iconified for a longer period of time.  In that
 	 case, current matrices may still contain references to
@@ -2424,6 +2601,7 @@ clear_image_caches (Lisp_Object filter)
   FOR_EACH_FRAME (tail, frame)
     if (FRAME_WINDOW_P (XFRAME (frame)))
       clear_image_cache (XFRAME (frame), filter);
+  image_cache_over_budget = false;
 }
 
 DEFUN ("clear-image-cache", Fclear_image_cache, Sclear_image_cache,
@@ -2460,70 +2638,6 @@ DEFUN ("clear-image-cache", Fclear_image_cache, Sclear_image_cache,
   return Qnil;
 }
 
-static size_t
-image_size_in_bytes (struct image *img)
-{
-  size_t size = 0;
-
-#if defined USE_CAIRO
-  Emacs_Pixmap pm = img->pixmap;
-  if (pm)
-    size += pm->height * pm->bytes_per_line;
-  Emacs_Pixmap msk = img->mask;
-  if (msk)
-    size += msk->height * msk->bytes_per_line;
-
-#elif defined HAVE_X_WINDOWS || defined HAVE_ANDROID
-  /* Use a nominal depth of 24 and a bpp of 32 for pixmap and 1 bpp
-     for mask, to avoid having to query the server. */
-  if (img->pixmap != NO_PIXMAP)
-    size += img->width * img->height * 4;
-  if (img->mask != NO_PIXMAP)
-    size += img->width * img->height / 8;
-
-  if (img->ximg && img->ximg->data)
-    size += img->ximg->bytes_per_line * img->ximg->height;
-  if (img->mask_img && img->mask_img->data)
-    size += img->mask_img->bytes_per_line * img->mask_img->height;
-
-#elif defined HAVE_NS
-  if (img->pixmap)
-    size += ns_image_size_in_bytes (img->pixmap);
-  if (img->mask)
-    size += ns_image_size_in_bytes (img->mask);
-
-#elif defined HAVE_NTGUI
-  if (img->pixmap)
-    size += w32_image_size (img->pixmap);
-  if (img->mask)
-    size += w32_image_size (img->mask);
-
-#elif defined HAVE_HAIKU
-  if (img->pixmap)
-    size += BBitmap_bytes_length (img->pixmap);
-  if (img->mask)
-    size += BBitmap_bytes_length (img->mask);
-#endif
-
-  return size;
-}
-
-static size_t
-image_frame_cache_size (struct frame *f)
-{
-  struct image_cache *c = FRAME_IMAGE_CACHE (f);
-  if (!c)
-    return 0;
-
-  size_t total = 0;
-  for (ptrdiff_t i = 0; i < c->used; ++i)
-    {
-      struct image *img = c->images[i];
-      total += img ? image_size_in_bytes (img) : 0;
-    }
-  return total;
-}
-
 DEFUN ("image-flush", Fimage_flush, Simage_flush,
        1, 2, 0,
        doc: /* Flush the image with specification SPEC on frame FRAME.
@@ -2803,6 +2917,34 @@ compute_image_size (struct frame *f, double width, double height,
   *d_height = desired_height;
 }
 
+#if defined HAVE_NATIVE_TRANSFORMS && defined HAVE_JPEG
+
+/* Return the factor, a power of two no larger than MAX_SHRINK, by
+   which a decoder may shrink image IMG of native size WIDTH x HEIGHT
+   without making it smaller than it is to be displayed on F.
+   image_set_transform scales the shrunk image to its final size.  */
+
+static int
+image_decode_shrink_factor (struct frame *f, struct image *img,
+			    int width, int height, int max_shrink)
+{
+  int desired_width, desired_height, factor = 1;
+
+  compute_image_size (f, width, height, img, &desired_width,
+		      &desired_height);
+  if (desired_width <= 0 || desired_height <= 0)
+    return 1;
+
+  while (factor < max_shrink
+	 && width / (factor * 2) >= desired_width
+	 && height / (factor * 2) >= desired_height)
+    factor *= 2;
+
+  return factor;
+}
+
+#endif /* HAVE_NATIVE_TRANSFORMS && HAVE_JPEG */
+
 /* image_set_rotation and image_set_transform use affine
    transformation matrices to perform various transforms on the image.
    The matrix is a 2D array of doubles.  It is laid out like this:
@@ -3065,8 +3207,11 @@ image_set_transform (struct frame *f, struct image *img)
     }
   else
 #endif
-    compute_image_size (f, img->width, img->height, img, &width,
-			&height);
+    compute_image_size (f, (img->native_width
+			    ? img->native_width : img->width),
+			(img->native_height
+			 ? img->native_height : img->height),
+			img, &width, &height);
 
   /* Determine rotation.  */
   double rotation = 0.0;
@@ -3503,6 +3648,153 @@ image_set_transform (struct frame *f, struct image *img)
 
 #endif /* HAVE_IMAGEMAGICK || HAVE_NATIVE_TRANSFORMS */
 
+/* Time spent decoding images in the current redisplay cycle, and
+   whether a call to `image--decode-deferred' has been arranged.  */
+static struct timespec image_decode_time;
+static bool image_decode_scheduled;
+
+/* Called at the start of each redisplay cycle, to give it the full
+   budget of `image-decode-time-limit', and to protect the images it
+   displays from `image-cache-max-size'.  */
+
+void
+image_start_redisplay_cycle (void)
+{
+  image_decode_time = make_timespec (0, 0);
+  image_cycle_start = current_timespec ();
+}
+
+/* Return true if redisplay has spent its budget for decoding images,
+   so that new images should be displayed as placeholders now and
+   decoded later.  */
+
+static bool
+image_decode_deferred_p (void)
+{
+  return (redisplaying_p
+	  && NUMBERP (Vimage_decode_time_limit)
+	  && (timespec_cmp (image_decode_time,
+			    dtotimespec (XFLOATINT (Vimage_decode_time_limit)))
+	      >= 0));
+}
+
+/* Arrange for `image--decode-deferred' to run soon.  This is called
+   from redisplay, which cannot run Lisp, so it goes through
+   `pending_funcalls', which starts a timer; redisplay follows the
+   timer and shows the images it decoded.  */
+
+static void
+schedule_image_decode (void)
+{
+  if (!image_decode_scheduled)
+    {
+      image_decode_scheduled = true;
+      pending_funcalls = Fcons (list4 (Qrun_with_timer, make_fixnum (0),
+				       Qnil, Qimage__decode_deferred),
+				pending_funcalls);
+    }
+}
+
+/* Give IMG, whose decoding failed or was deferred, the size of the
+   rectangle drawn in its place.  */
+
+static void
+image_set_placeholder_size (struct image *img)
+{
+  Lisp_Object value;
+
+  value = image_spec_value (img->spec, QCwidth, NULL);
+  img->width = (FIXNUMP (value)
+		? XFIXNAT (value) : DEFAULT_IMAGE_WIDTH);
+  value = image_spec_value (img->spec, QCheight, NULL);
+  img->height = (FIXNUMP (value)
+		 ? XFIXNAT (value) : DEFAULT_IMAGE_HEIGHT);
+}
+
+/* Decode image IMG of frame F, and handle its type independent
+   attributes.  Must be called with input blocked.  */
+
+static void
+image_decode (struct frame *f, struct image *img)
+{
+  struct timespec start = current_timespec ();
+
+  img->decode_deferred_p = false;
+  img->width = img->height = 0;
+  img->native_width = img->native_height = 0;
+  img->timestamp = start;
+  img->load_failed_p = ! img->type->load_img (f, img);
+
+  /* If we can't load the image, and we don't have a width and
+     height, use some arbitrary width and height so that we can
+     draw a rectangle for it.  */
+  if (img->load_failed_p)
+    image_set_placeholder_size (img);
+  else
+    {
+      /* Handle image type independent image attributes
+	 `:ascent ASCENT', `:margin MARGIN', `:relief RELIEF',
+	 `:background COLOR'.  */
+      Lisp_Object spec = img->spec;
+      Lisp_Object ascent, margin, relief, bg;
+      int relief_bound;
+
+      ascent = image_spec_value (spec, QCascent, NULL);
+      if (FIXNUMP (ascent))
+	img->ascent = XFIXNUM (ascent);
+      else if (EQ (ascent, Qcenter))
+	img->ascent = CENTERED_IMAGE_ASCENT;
+
+      margin = image_spec_value (spec, QCmargin, NULL);
+      if (FIXNUMP (margin))
+	img->vmargin = img->hmargin = XFIXNUM (margin);
+      else if (CONSP (margin))
+	{
+	  img->hmargin = XFIXNUM (XCAR (margin));
+	  img->vmargin = XFIXNUM (XCDR (margin));
+	}
+
+      relief = image_spec_value (spec, QCrelief, NULL);
+      relief_bound = INT_MAX - max (img->hmargin, img->vmargin);
+      if (RANGED_FIXNUMP (- relief_bound, relief, relief_bound))
+	{
+	  img->relief = XFIXNUM (relief);
+	  img->hmargin += eabs (img->relief);
+	  img->vmargin += eabs (img->relief);
+	}
+
+      if (! img->background_valid)
+	{
+	  bg = image_spec_value (img->spec, QCbackground, NULL);
+	  if (!NILP (bg))
+	    {
+	      img->background
+		= image_alloc_image_color (f, img, bg, img->face_background);
+	      img->background_valid = 1;
+	    }
+	}
+
+      /* Do image transformations and compute masks, unless we
+	 don't have the image yet.  */
+      if (!EQ (builtin_lisp_symbol (img->type->type), Qpostscript))
+	postprocess_image (f, img);
+
+      /* postprocess_image above may modify the image or the mask,
+	 relying on the image's real width and height, so
+	 image_set_transform must be called after it.  */
+#ifdef HAVE_NATIVE_TRANSFORMS
+      image_set_transform (f, img);
+#endif
+    }
+
+  if (redisplaying_p)
+    image_decode_time = timespec_add (image_decode_time,
+				      timespec_sub (current_timespec (),
+						    start));
+
+  image_cache_check_budget (f);
+}
+
 /* Return the id of image with Lisp specification SPEC on frame F.
    SPEC must be a valid Lisp image specification (see valid_image_p).  */
 
@@ -3554,87 +3846,114 @@ lookup_image (struct frame *f, Lisp_Object spec, int face_id)
       size_t len = strlen (font_family) + 1;
       img->face_font_family = xmalloc (len);
       memcpy (img->face_font_family, font_family, len);
-      img->load_failed_p = ! img->type->load_img (f, img);
 
-      /* If we can't load the image, and we don't have a width and
-	 height, use some arbitrary width and height so that we can
-	 draw a rectangle for it.  */
-      if (img->load_failed_p)
+      /* If redisplay has already spent its time decoding images, show
+	 a rectangle for this one and decode it later.  */
+      if (image_decode_deferred_p ())
 	{
-	  Lisp_Object value;
-
-	  value = image_spec_value (spec, QCwidth, NULL);
-	  img->width = (FIXNUMP (value)
-			? XFIXNAT (value) : DEFAULT_IMAGE_WIDTH);
-	  value = image_spec_value (spec, QCheight, NULL);
-	  img->height = (FIXNUMP (value)
-			 ? XFIXNAT (value) : DEFAULT_IMAGE_HEIGHT);
+	  img->decode_deferred_p = true;
+	  image_set_placeholder_size (img);
+	  schedule_image_decode ();
 	}
       else
+	image_decode (f, img);
+
+      unblock_input ();
+    }
+  else if (img->decode_deferred_p && !image_decode_deferred_p ())
+    {
+      /* Someone needs the real image now, or redisplay has time to
+	 decode it.  */
+      block_input ();
+      image_decode (f, img);
+      unblock_input ();
+    }
+
+  /* IMG is now being used, so set its timestamp to the current
+     time.  */
+  img->timestamp = current_timespec ();
+
+  /* Value is the image id.  */
+  return img->id;
+}
+
+DEFUN ("image--decode-deferred", Fimage__decode_deferred,
+       Simage__decode_deferred, 0, 0, 0,
+       doc: /* Decode the images whose decoding redisplay deferred.
+Decode them one after the other until input arrives or
+`image-decode-time-limit' has passed, arrange to decode the rest
+later, and redisplay the frames showing the decoded images.
+This function is for internal use only.  */)
+  (void)
+{
+  Lisp_Object tail, frame;
+  struct timespec start = current_timespec ();
+  struct timespec limit = (NUMBERP (Vimage_decode_time_limit)
+			   ? dtotimespec (XFLOATINT (Vimage_decode_time_limit))
+			   : make_timespec (0, 0));
+  bool decoded = false;
+
+  image_decode_scheduled = false;
+
+  FOR_EACH_FRAME (tail, frame)
+    {
+      struct frame *f = XFRAME (frame);
+      struct image_cache *c;
+      bool decoded_here = false;
+
+      if (!FRAME_WINDOW_P (f) || !(c = FRAME_IMAGE_CACHE (f)))
+	continue;
+
+      for (ptrdiff_t i = 0; i < c->used; ++i)
 	{
-	  /* Handle image type independent image attributes
-	     `:ascent ASCENT', `:margin MARGIN', `:relief RELIEF',
-	     `:background COLOR'.  */
-	  Lisp_Object ascent, margin, relief, bg;
-	  int relief_bound;
-
-	  ascent = image_spec_value (spec, QCascent, NULL);
-	  if (FIXNUMP (ascent))
-	    img->ascent = XFIXNUM (ascent);
-	  else if (EQ (ascent, Qcenter))
-	    img->ascent = CENTERED_IMAGE_ASCENT;
-
-	  margin = image_spec_value (spec, QCmargin, NULL);
-	  if (FIXNUMP (margin))
-	    img->vmargin = img->hmargin = XFIXNUM (margin);
-	  else if (CONSP (margin))
-	    {
-	      img->hmargin = XFIXNUM (XCAR (margin));
-	      img->vmargin = XFIXNUM (XCDR (margin));
-	    }
+	  struct image *img = c->images[i];
+
+	  if (!img || !img->decode_deferred_p)
+	    continue;
 
-	  relief = image_spec_value (spec, QCrelief, NULL);
-	  relief_bound = INT_MAX - max (img->hmargin, img->vmargin);
-	  if (RANGED_FIXNUMP (- relief_bound, relief, relief_bound))
+	  /* Decode at least one image per call, so that we make
+	     progress even with a limit of zero.  */
+	  if (decoded
+	      && (detect_input_pending ()
+		  || (timespec_cmp (timespec_sub (current_timespec (), start),
+				    limit)
+		      >= 0)))
 	    {
-	      img->relief = XFIXNUM (relief);
-	      img->hmargin += eabs (img->relief);
-	      img->vmargin += eabs (img->relief);
+	      schedule_image_decode ();
+	      break;
 	    }
 
-	  if (! img->background_valid)
+	  block_input ();
+	  image_decode (f, img);
+	  unblock_input ();
+	  decoded = decoded_here = true;
+	}
+
+      /* The decoded images probably have a size different from the
+	 placeholders in the current matrices of the frames sharing
+	 the cache.  */
+      if (decoded_here)
+	{
+	  Lisp_Object tail2, frame2;
+
+	  FOR_EACH_FRAME (tail2, frame2)
 	    {
-	      bg = image_spec_value (img->spec, QCbackground, NULL);
-	      if (!NILP (bg))
+	      struct frame *fr = XFRAME (frame2);
+	      if (FRAME_IMAGE_CACHE (fr) == c)
 		{
-		  img->background
-		    = image_alloc_image_color (f, img, bg, background);
-		  img->background_valid = 1;
+		  clear_current_matrices (fr);
+		  fset_redisplay (fr);
 		}
 	    }
 
-	  /* Do image transformations and compute masks, unless we
-	     don't have the image yet.  */
-	  if (!EQ (builtin_lisp_symbol (img->type->type), Qpostscript))
-	    postprocess_image (f, img);
-
-          /* postprocess_image above may modify the image or the mask,
-             relying on the image's real width and height, so
-             image_set_transform must be called after it.  */
-#ifdef HAVE_NATIVE_TRANSFORMS
-          image_set_transform (f, img);
-#endif
+	  windows_or_buffers_changed = 19;
 	}
 
-      unblock_input ();
+      if (image_decode_scheduled)
+	break;
     }
 
-  /* IMG is now being used, so set its timestamp to the current
-     time.  */
-  img->timestamp = current_timespec ();
-
-  /* Value is the image id.  */
-  return img->id;
+  return Qnil;
 }
 
 
@@ -3692,10 +4011,11 @@ cache_image (struct frame *f, struct image *img)
   /* A function to call to free the handle.  */
   void (*destructor) (void *);
   int index, width, height, frames;
-  /* This is used to be able to say something about the cache size.
-     We don't actually know how much memory the different libraries
-     actually use here (since these cache structures are opaque), so
-     this is mostly just the size of the original image file.  */
+  /* This is used to be able to say something about the cache size,
+     and to keep it within `image-cache-max-size'.  We don't actually
+     know how much memory the different libraries use here (since
+     these cache structures are opaque), so this is the size of the
+     original image file plus that of the frame being composed.  */
   int byte_size;
   struct timespec update_time;
   struct anim_cache *next;
@@ -3747,6 +4067,41 @@ anim_prune_animation_cache (Lisp_Object clear)
     }
 }
 
+/* Free the least recently used entries of the animation cache, other
+   than KEEP, while the cache is larger than `image-cache-max-size'.  */
+static void
+anim_enforce_cache_budget (struct anim_cache *keep)
+{
+  size_t budget = image_cache_budget ();
+  size_t total = 0;
+
+  for (struct anim_cache *cache = anim_cache; cache; cache = cache->next)
+    total += cache->byte_size;
+
+  while (total > budget)
+    {
+      struct anim_cache **pcache, **oldest = NULL;
+
+      for (pcache = &anim_cache; *pcache; pcache = &(*pcache)->next)
+	if (*pcache != keep
+	    && (!oldest
+		|| timespec_cmp ((*pcache)->update_time,
+				 (*oldest)->update_time) < 0))
+	  oldest = pcache;
+      if (!oldest)
+	break;
+
+      struct anim_cache *cache = *oldest;
+      total -= cache->byte_size;
+      if (cache->handle)
+	cache->destructor (cache);
+      if (cache->temp)
+	xfree (cache->temp);
+      *oldest = cache->next;
+      xfree (cache);
+    }
+}
+
 static struct anim_cache *
 anim_get_animation_cache (Lisp_Object spec)
 {
@@ -3769,6 +4124,7 @@ anim_get_animation_cache (Lisp_Object spec)
     }
 
   cache->update_time = current_timespec ();
+  anim_enforce_cache_budget (cache);
   return cache;
 }
 
@@ -9069,6 +9425,21 @@ jpeg_load_body (struct frame *f, struct image *img,
 
   jpeg_read_header (&mgr->cinfo, 1);
 
+#ifdef HAVE_NATIVE_TRANSFORMS
+  /* If the image is to be displayed smaller, let libjpeg shrink it
+     while decoding, so that the pixels we would scale away are never
+     materialized.  */
+  int shrink = image_decode_shrink_factor (f, img, mgr->cinfo.image_width,
+					   mgr->cinfo.image_height, 8);
+  if (shrink > 1)
+    {
+      mgr->cinfo.scale_num = 1;
+      mgr->cinfo.scale_denom = shrink;
+      img->native_width = mgr->cinfo.image_width;
+      img->native_height = mgr->cinfo.image_height;
+    }
+#endif
+
   /* Start decompression.  */
   jpeg_start_decompress (&mgr->cinfo);
   width = img->width = mgr->cinfo.output_width;
@@ -10049,7 +10420,10 @@ gif_load (struct frame *f, struct image *img)
     {
       pixmap = xmalloc (width * height * sizeof (unsigned long));
       if (cache)
-	cache->temp = pixmap;
+	{
+	  cache->temp = pixmap;
+	  cache->byte_size += width * height * sizeof (unsigned long);
+	}
     }
 
   /* Clear the part of the screen image not covered by the image.
@@ -10583,7 +10957,8 @@ webp_load (struct frame *f, struct image *img)
 	     purge the anim cache.  */
 	  webp_data.size = size;
 
-	  /* This is used just for reporting by `image-cache-size'.  */
+	  /* This is used for reporting by `image-cache-size', and for
+	     `image-cache-max-size'.  */
 	  cache->byte_size = size;
 
 	  /* Get the width/height of the total image.  */
@@ -10593,6 +10968,8 @@ webp_load (struct frame *f, struct image *img)
 						  WEBP_FF_CANVAS_HEIGHT);
 	  cache->frames = frames = WebPDemuxGetI (demux, WEBP_FF_FRAME_COUNT);
 	  cache->destructor = (void (*)(void *)) webp_destroy;
+	  /* The decoder composes frames in an RGBA canvas.  */
+	  cache->byte_size += width * height * 4;
 	  WebPDemuxDelete (demux);
 
 	  WebPAnimDecoderOptions dec_options;
@@ -12956,6 +13333,8 @@ syms_of_image (void)
   DEFSYM (Qextension_data, "extension-data");
   DEFSYM (Qdelay, "delay");
   DEFSYM (Qauto, "auto");
+  DEFSYM (Qrun_with_timer, "run-with-timer");
+  DEFSYM (Qimage__decode_deferred, "image--decode-deferred");
 
   /* Keywords.  */
   DEFSYM (QCascent, ":ascent");
@@ -13132,6 +13511,7 @@ syms_of_image (void)
 #endif
   defsubr (&Sclear_image_cache);
   defsubr (&Simage_flush);
+  defsubr (&Simage__decode_deferred);
   defsubr (&Simage_size);
   defsubr (&Simage_mask_p);
   defsubr (&Simage_metadata);
@@ -13169,6 +13549,34 @@ syms_of_image (void)
 The function `clear-image-cache' disregards this variable.  */);
   Vimage_cache_eviction_delay = make_fixnum (300);
 
+  DEFVAR_LISP ("image-cache-max-size", Vimage_cache_max_size,
+    doc: /* Maximum size in bytes of an image cache, or nil for no limit.
+When the images cached for a display take more memory than this, Emacs
+removes the images that were displayed least recently from the cache,
+until it is small enough again.  Images shown by the latest redisplay
+are never removed, so a cache can still exceed this size if more
+images than fit are visible at once.  The same limit applies, on its
+own, to the cache of animated images.
+
+The function `image-cache-size' returns how much memory the image
+caches currently use.  */);
+  Vimage_cache_max_size = Qnil;
+
+  DEFVAR_LISP ("image-decode-time-limit", Vimage_decode_time_limit,
+    doc: /* Time in seconds redisplay may spend decoding images, or nil.
+If nil, redisplay decodes each new image it displays right away.
+Otherwise, once a redisplay cycle has spent this much time decoding
+images, it displays the remaining new images as rectangles, whose
+size is given by their `:width' and `:height' properties, if any.
+Emacs then decodes these images as soon as it is idle, one after the
+other until input arrives, and redisplays as they become ready.
+
+Setting this to a small number keeps Emacs responsive when showing
+a buffer with many or large images.  A value of 0 defers the decoding
+of every new image.  Functions such as `image-size' always decode the
+image they are given.  */);
+  Vimage_decode_time_limit = Qnil;
+
   DEFVAR_LISP ("image-scaling-factor", Vimage_scaling_factor,
     doc: /* When displaying images, apply this scaling factor before displaying.
 This is not supported for all image types, and is mostly useful
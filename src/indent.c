@@ -50,6 +50,27 @@ #define CR 015
 
 static modiff_count last_known_column_modified;
 
+/* A position in a line whose column is known, so that the column of a
+   later position in the same line can be found by scanning only the
+   text in between.  It is used only in buffers without text
+   properties, overlays or multibyte characters, where columns can be
+   counted byte by byte.  SCANNED says whether COL was computed by
+   scan_for_column, which takes compositions into account, rather than
+   by current_column, which doesn't.  */
+
+static struct
+{
+  struct buffer *buffer;
+  modiff_count modiff;
+  ptrdiff_t line_beg, pos, col;
+  int tab_width;
+  bool ctl_arrow, scanned;
+} column_cache;
+
+/* Number of column computations that did and didn't use column_cache.  */
+
+static intmax_t column_cache_hits, column_cache_misses;
+
 static ptrdiff_t current_column_1 (void);
 static ptrdiff_t position_indentation (ptrdiff_t);
 
@@ -295,6 +316,74 @@ #define MULTIBYTE_BYTES_WIDTH(p, dp, bytes, width)			\
   } while (0)
 
 
+/* Return true if columns in the current buffer can be counted byte by
+   byte, and so recorded in column_cache.  */
+
+static bool
+column_cache_applicable_p (struct Lisp_Char_Table *dp)
+{
+  return (!dp
+	  && !buffer_intervals (current_buffer)
+	  && !buffer_has_overlays ()
+	  && Z == Z_BYTE
+	  && !current_buffer->long_line_optimizations_p
+	  && !EQ (BVAR (current_buffer, selective_display), Qt));
+}
+
+/* Return true if column_cache records a column on the line starting
+   at LINE_BEG, computed by scan_for_column if SCANNED, else by
+   current_column, with the current buffer settings.  */
+
+static bool
+column_cache_valid_p (ptrdiff_t line_beg, bool scanned)
+{
+  bool valid = (column_cache.buffer == current_buffer
+		&& column_cache.modiff == MODIFF
+		&& column_cache.line_beg == line_beg
+		&& column_cache.pos >= line_beg
+		&& column_cache.scanned == scanned
+		&& column_cache.tab_width == SANE_TAB_WIDTH (current_buffer)
+		&& (column_cache.ctl_arrow
+		    == !NILP (BVAR (current_buffer, ctl_arrow))));
+  if (valid)
+    column_cache_hits++;
+  else
+    column_cache_misses++;
+  return valid;
+}
+
+/* Record in column_cache that COL is the column of POS, on the line
+   starting at LINE_BEG.  */
+
+static void
+column_cache_record (ptrdiff_t line_beg, ptrdiff_t pos, ptrdiff_t col,
+		     bool scanned)
+{
+  column_cache.buffer = current_buffer;
+  column_cache.modiff = MODIFF;
+  column_cache.line_beg = line_beg;
+  column_cache.pos = pos;
+  column_cache.col = col;
+  column_cache.scanned = scanned;
+  column_cache.tab_width = SANE_TAB_WIDTH (current_buffer);
+  column_cache.ctl_arrow = !NILP (BVAR (current_buffer, ctl_arrow));
+}
+
+DEFUN ("column-cache-statistics", Fcolumn_cache_statistics,
+       Scolumn_cache_statistics, 0, 0, 0,
+       doc: /* Return data about the cache of columns in lines.
+`current-column' and `move-to-column' remember the column of the last
+position they reached, and in buffers without text properties,
+overlays or multibyte characters start from there when asked about a
+later position in the same line.  The data is returned as a list
+\(HITS MISSES), the number of times so far that they did and didn't
+find a usable column in the cache.  */)
+  (void)
+{
+  return list2 (make_int (column_cache_hits),
+		make_int (column_cache_misses));
+}
+
 DEFUN ("current-column", Fcurrent_column, Scurrent_column, 0, 0, 0,
        doc: /* Return the horizontal position of point.  Beginning of line is column 0.
 This is calculated by adding together the widths of all the displayed
@@ -356,6 +445,25 @@ current_column (void)
       || Z != Z_BYTE)
     return current_column_1 ();
 
+  bool cacheable = column_cache_applicable_p (dp);
+  if (cacheable && column_cache_valid_p (line_beg, false)
+      && column_cache.pos <= PT)
+    {
+      /* Count the columns from the recorded position onward.  */
+      col = column_cache.col;
+      for (ptrdiff_t pos = column_cache.pos; pos < PT; pos++)
+	{
+	  c = FETCH_BYTE (pos);
+	  if (c >= 040 && c < 0177)
+	    col++;
+	  else if (c == '\t')
+	    col = (col / tab_width + 1) * tab_width;
+	  else
+	    col += (ctl_arrow && c < 0200) ? 2 : 4;
+	}
+      goto found;
+    }
+
   /* Scan backwards from point to the previous newline,
      counting width.  Tab characters are the only complicated case.  */
 
@@ -458,6 +566,10 @@ current_column (void)
       col += post_tab;
     }
 
+ found:
+  if (cacheable)
+    column_cache_record (line_beg, PT, col, false);
+
   last_known_column = col;
   last_known_column_point = PT;
   last_known_column_modified = MODIFF;
@@ -564,6 +676,8 @@ scan_for_column (ptrdiff_t *endpos, EMACS_INT *goalcol,
   ptrdiff_t scan, scan_byte, next_boundary, prev_pos, prev_bpos;
 
   scan = find_newline (PT, PT_BYTE, BEGV, BEGV_BYTE, -1, NULL, &scan_byte, 1);
+  ptrdiff_t line_beg = scan;
+  bool cacheable = column_cache_applicable_p (dp);
 
   window = Fget_buffer_window (Fcurrent_buffer (), Qnil);
   w = ! NILP (window) ? XWINDOW (window) : NULL;
@@ -610,6 +724,14 @@ scan_for_column (ptrdiff_t *endpos, EMACS_INT *goalcol,
 	  col = 0;
 	}
     }
+  if (cacheable && column_cache_valid_p (line_beg, true)
+      && column_cache.pos < end && column_cache.col < goal)
+    {
+      /* Resume from a recorded position.  Since COL is less than
+	 GOAL, the loop below sets PREV_COL and friends.  */
+      scan = scan_byte = column_cache.pos;
+      col = column_cache.col;
+    }
   next_boundary = scan;
   prev_pos = scan;
   prev_bpos = scan_byte;
@@ -770,6 +892,10 @@ scan_for_column (ptrdiff_t *endpos, EMACS_INT *goalcol,
     }
  endloop:
 
+  /* Don't record positions inside compositions.  */
+  if (cacheable && cmp_it.id < 0 && scan <= end)
+    column_cache_record (line_beg, scan, col, true);
+
   last_known_column = col;
   last_known_column_point = PT;
   last_known_column_modified = MODIFF;
@@ -2492,6 +2618,7 @@ syms_of_indent (void)
   defsubr (&Scurrent_indentation);
   defsubr (&Sindent_to);
   defsubr (&Scurrent_column);
+  defsubr (&Scolumn_cache_statistics);
   defsubr (&Smove_to_column);
   defsubr (&Sline_number_display_width);
   defsubr (&Svertical_motion);
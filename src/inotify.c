@@ -321,6 +321,39 @@ remove_watch (Lisp_Object descriptor, Lisp_Object id)
       }
 }
 
+/* Events that only say that a file was used or changed.  When one
+   read returns several of them for the same file, only the first is
+   worth delivering, as long as the file was not created, deleted or
+   moved in between.  */
+enum { IN_CHANGE_EVENTS = (IN_ACCESS | IN_ATTRIB | IN_MODIFY | IN_OPEN
+			   | IN_CLOSE_WRITE | IN_CLOSE_NOWRITE) };
+
+/* Return true if the event EV read from the inotify file descriptor
+   repeats an event that was already delivered from the same read.
+   SEEN maps (DESCRIPTOR . NAME) to the change events delivered for
+   that file since it was last created, deleted or moved.  */
+
+static bool
+duplicate_change_event_p (Lisp_Object seen, Lisp_Object descriptor,
+			  struct inotify_event const *ev)
+{
+  Lisp_Object key
+    = Fcons (descriptor,
+	     make_unibyte_string (ev->name,
+				  ev->len ? strnlen (ev->name, ev->len) : 0));
+  uint32_t change = ev->mask & ~IN_ISDIR;
+  if (change & ~IN_CHANGE_EVENTS)
+    {
+      Fremhash (key, seen);
+      return false;
+    }
+  Lisp_Object delivered = Fgethash (key, seen, make_fixnum (0));
+  if ((XFIXNUM (delivered) & change) == change)
+    return true;
+  Fputhash (key, make_fixnum (XFIXNUM (delivered) | change), seen);
+  return false;
+}
+
 /* This callback is called when the FD is available for read.  The inotify
    events are read from FD and converted into input_events.  */
 static void
@@ -336,17 +369,31 @@ inotify_callback (int fd, void *_)
   if (n < 0)
     report_file_notify_error ("Error while reading file system events", Qnil);
 
+  /* Whatever changed, the file attribute cache may be out of date.  */
+  if (n > 0)
+    file_attribute_cache_flush ();
+
   struct input_event event;
   EVENT_INIT (event);
   event.kind = FILE_NOTIFY_EVENT;
 
+  Lisp_Object seen = Qnil;
+
   for (ssize_t i = 0; i < n; )
     {
       struct inotify_event *ev = (struct inotify_event *) &buffer[i];
+
+      /* Coalesce repeated change events only if there is more than
+	 one event, to keep the common case cheap.  */
+      if (i == 0 && sizeof *ev + ev->len < n)
+	seen = CALLN (Fmake_hash_table, QCtest, Qequal);
+
       Lisp_Object descriptor = INT_TO_INTEGER (ev->wd);
       Lisp_Object prevtail = find_descriptor (descriptor);
 
-      if (! NILP (prevtail))
+      if (! NILP (prevtail)
+	  && ! (HASH_TABLE_P (seen)
+		&& duplicate_change_event_p (seen, descriptor, ev)))
         {
 	  Lisp_Object tail = CONSP (prevtail) ? XCDR (prevtail) : watch_list;
 	  for (Lisp_Object watches = XCDR (XCAR (tail)); ! NILP (watches);
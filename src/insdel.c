@@ -142,12 +142,10 @@ gap_left (ptrdiff_t charpos, ptrdiff_t bytepos, bool newgap)
 	  charpos = BYTE_TO_CHAR (bytepos);
 	  break;
 	}
-      /* Move at most 32000 chars before checking again for a quit.  */
-      /* FIXME: This 32KB chunk size dates back to before 1991.
-         Maybe we should bump it to reflect the >1000x increase
-         in memory size and bandwidth since that time.
-         Is it even worthwhile checking `quit` within this loop?
-         Especially since make_gap_smaller/larger binds inhibit-quit anyway!  */
+      /* Move at most 32000 chars before checking again for a quit.
+	 This chunk size dates back to before 1991, but a larger one
+	 doesn't make moving the gap measurably faster: the copying
+	 runs at memory bandwidth either way.  */
       if (i > 32000)
 	i = 32000;
       new_s1 -= i;
@@ -243,11 +241,15 @@ adjust_suspend_auto_hscroll (ptrdiff_t from, ptrdiff_t to)
    The range in charpos is FROM to TO.
 
    This function assumes that the gap is adjacent to
-   or inside of the range being deleted.  */
+   or inside of the range being deleted.
+
+   If RECORD_UNDO, the deletion has just been recorded by
+   record_delete, and this also records the adjustments of the
+   markers in the range that undoing the deletion would not invert.  */
 
 void
 adjust_markers_for_delete (ptrdiff_t from, ptrdiff_t from_byte,
-			   ptrdiff_t to, ptrdiff_t to_byte)
+			   ptrdiff_t to, ptrdiff_t to_byte, bool record_undo)
 {
   struct Lisp_Marker *m;
   ptrdiff_t charpos;
@@ -258,6 +260,20 @@ adjust_markers_for_delete (ptrdiff_t from, ptrdiff_t from_byte,
       charpos = m->charpos;
       eassert (charpos <= Z);
 
+      /* insertion_type nil markers will end up at the beginning of
+	 the re-inserted text after undoing a deletion, and must be
+	 adjusted to move them to the correct place.
+
+	 insertion_type t markers will automatically move forward
+	 upon re-inserting the deleted text, so we have to arrange
+	 for them to move backward to the correct position.  */
+      if (record_undo && from <= charpos && charpos <= to)
+	{
+	  ptrdiff_t adjustment = (m->insertion_type ? to : from) - charpos;
+	  if (adjustment)
+	    record_marker_adjustment (m, adjustment);
+	}
+
       /* If the marker is after the deletion,
 	 relocate by number of chars / bytes deleted.  */
       if (charpos > to)
@@ -272,6 +288,9 @@ adjust_markers_for_delete (ptrdiff_t from, ptrdiff_t from_byte,
 	  m->bytepos = from_byte;
 	}
     }
+  adjust_bytechar_index (current_buffer, from_byte,
+			 to - from, to_byte - from_byte, 0, 0);
+  adjust_line_index (current_buffer, from_byte, to_byte - from_byte, 0);
   adjust_overlays_for_delete (from, to - from);
 }
 
@@ -312,6 +331,8 @@ adjust_markers_for_insert (ptrdiff_t from, ptrdiff_t from_byte,
 	  m->charpos += nchars;
 	}
     }
+  adjust_bytechar_index (current_buffer, from_byte, 0, 0, nchars, nbytes);
+  adjust_line_index (current_buffer, from_byte, 0, nbytes);
   adjust_overlays_for_insert (from, to - from, before_markers);
 }
 
@@ -370,6 +391,9 @@ adjust_markers_for_replace (ptrdiff_t from, ptrdiff_t from_byte,
 
   check_markers ();
 
+  adjust_bytechar_index (current_buffer, from_byte, old_chars, old_bytes,
+			 new_chars, new_bytes);
+  adjust_line_index (current_buffer, from_byte, old_bytes, new_bytes);
   adjust_overlays_for_insert (from + old_chars, new_chars, true);
   if (old_chars)
     adjust_overlays_for_delete (from, old_chars);
@@ -445,6 +469,9 @@ adjust_markers_bytepos (ptrdiff_t from, ptrdiff_t from_byte,
 
   /* Make sure cached charpos/bytepos is invalid.  */
   clear_charpos_cache (current_buffer);
+  invalidate_bytechar_index (current_buffer, from_byte,
+			     to_z ? PTRDIFF_MAX : to_byte);
+  invalidate_line_index (current_buffer, from_byte, PTRDIFF_MAX);
 }
 
 
@@ -1371,7 +1398,7 @@ adjust_after_replace (ptrdiff_t from, ptrdiff_t from_byte,
 			       from + len, from_byte + len_byte, false);
 
   if (nchars_del > 0)
-    record_delete (from, prev_text, false);
+    record_delete (from, prev_text);
   record_insert (from, len);
 
   offset_intervals (current_buffer, from, len - nchars_del);
@@ -1589,7 +1616,7 @@ replace_range (ptrdiff_t from, ptrdiff_t to, Lisp_Object new,
   if (!NILP (deletion))
     {
       record_insert (from + SCHARS (deletion), inschars);
-      record_delete (from, deletion, false);
+      record_delete (from, deletion);
     }
 
   GAP_SIZE -= outgoing_insbytes;
@@ -1965,13 +1992,14 @@ del_range_2 (ptrdiff_t from, ptrdiff_t from_byte,
   else
     deletion = Qnil;
 
-  /* Record marker adjustments, and text deletion into undo
-     history.  */
-  record_delete (from, deletion, true);
+  /* Record text deletion into undo history.  */
+  record_delete (from, deletion);
 
   /* Relocate all markers pointing into the new, larger gap to point
-     at the end of the text before the gap.  */
-  adjust_markers_for_delete (from, from_byte, to, to_byte);
+     at the end of the text before the gap, and record their
+     adjustments into undo history.  */
+  adjust_markers_for_delete (from, from_byte, to, to_byte,
+			     !EQ (BVAR (current_buffer, undo_list), Qt));
 
   modiff_incr (&MODIFF, nchars_del);
   CHARS_MODIFF = MODIFF;
@@ -2097,6 +2125,8 @@ prepare_to_modify_buffer_1 (ptrdiff_t start, ptrdiff_t end,
 	verify_interval_modification (current_buffer, start, end);
     }
 
+  invalidate_syntax_checkpoints (current_buffer, start);
+
   /* For indirect buffers, use the base buffer to check clashes.  */
   if (current_buffer->base_buffer != 0)
     base_buffer = current_buffer->base_buffer;
@@ -2191,6 +2221,15 @@ invalidate_buffer_caches (struct buffer *buf, ptrdiff_t start, ptrdiff_t end)
     invalidate_region_cache (buf,
                              buf->width_run_cache,
                              start - BUF_BEG (buf), BUF_Z (buf) - end);
+  if (buf->composition_cache)
+    invalidate_region_cache (buf,
+                             buf->composition_cache,
+                             start - BUF_BEG (buf), BUF_Z (buf) - end);
+  invalidate_lisp_region_caches (buf, start, end);
+  invalidate_syntax_checkpoints (buf, start);
+  if (buf->text->line_index && start < end)
+    invalidate_line_index (buf, buf_charpos_to_bytepos (buf, start),
+			   buf_charpos_to_bytepos (buf, end));
 }
 
 /* These macros work with an argument named `preserve_ptr'
@@ -2405,6 +2444,34 @@ signal_after_change (ptrdiff_t charpos, ptrdiff_t lendel, ptrdiff_t lenins)
   unbind_to (count, Qnil);
 }
 
+/* Begin a change of the text from START to END of the current buffer
+   that consists of several primitive changes, and that the
+   modification hooks should see as one change.  Like modify_text, run
+   the before-change hooks for the whole text; then inhibit the hooks
+   of the primitive changes.  Return the count to pass to
+   finish_combined_change when the change is done.  */
+
+specpdl_ref
+begin_combined_change (ptrdiff_t start, ptrdiff_t end)
+{
+  modify_text (start, end);
+  specpdl_ref count = SPECPDL_INDEX ();
+  specbind (Qinhibit_modification_hooks, Qt);
+  return count;
+}
+
+/* Finish the change begun by the call to begin_combined_change that
+   returned COUNT, and run the after-change hooks for it, as for
+   signal_after_change with CHARPOS, LENDEL and LENINS.  */
+
+void
+finish_combined_change (specpdl_ref count, ptrdiff_t charpos,
+			ptrdiff_t lendel, ptrdiff_t lenins)
+{
+  unbind_to (count, Qnil);
+  signal_after_change (charpos, lendel, lenins);
+}
+
 static void
 Fcombine_after_change_execute_1 (Lisp_Object val)
 {
@@ -585,6 +585,63 @@ interval_start_pos (INTERVAL source)
   return 0;
 }
 
+/* A finger into the interval tree of a buffer, remembering the
+   interval that find_interval found last.  Loops that look up text
+   properties at successive positions, like those calling
+   `next-single-property-change' or `get-text-property', usually land
+   in that interval or one of its neighbors, which can be reached
+   from it much faster than from the root.
+
+   The finger is valid only while the text of the buffer and the set
+   of intervals are unchanged, since both can change the positions of
+   intervals.  Any modification of the buffer changes its MODIFF; any
+   interval that is created, deleted, resized without modifying the
+   buffer, or freed by GC increments interval_tree_tick.  */
+
+static struct
+{
+  INTERVAL tree, interval;
+  modiff_count modiff;
+  uintmax_t tick;
+} interval_finger;
+
+uintmax_t interval_tree_tick;
+
+/* Return the interval of the buffer B whose interval tree is TREE
+   that contains POSITION, if it can be quickly found from the finger.
+   Otherwise, return NULL.  */
+
+static INTERVAL
+find_interval_from_finger (INTERVAL tree, struct buffer *b,
+			   ptrdiff_t position)
+{
+  INTERVAL i = interval_finger.interval;
+
+  if (interval_finger.tree != tree
+      || interval_finger.tick != interval_tree_tick
+      || interval_finger.modiff != BUF_MODIFF (b))
+    return NULL;
+
+  /* Look at a few intervals after or before the finger.  */
+  for (int n = 0; i && n < 3; n++)
+    {
+      if (position < i->position)
+	i = previous_interval (i);
+      else if (position < i->position + LENGTH (i))
+	return i;
+      else
+	{
+	  INTERVAL next = next_interval (i);
+	  /* At the end of the buffer, use the last interval, like
+	     find_interval does.  */
+	  if (!next && position == i->position + LENGTH (i))
+	    return i;
+	  i = next;
+	}
+    }
+  return NULL;
+}
+
 /* Find the interval containing text position POSITION in the text
    represented by the interval tree TREE.  POSITION is a buffer
    position (starting from 1) or a string index (starting from 0).
@@ -605,17 +662,31 @@ find_interval (register INTERVAL tree, register ptrdiff_t position)
   if (!tree)
     return NULL;
 
+  struct buffer *b = NULL;
   relative_position = position;
   if (INTERVAL_HAS_OBJECT (tree))
     {
       Lisp_Object parent;
       GET_INTERVAL_OBJECT (parent, tree);
       if (BUFFERP (parent))
-	relative_position -= BUF_BEG (XBUFFER (parent));
+	{
+	  b = XBUFFER (parent);
+	  relative_position -= BUF_BEG (b);
+	}
     }
 
   eassert (relative_position <= TOTAL_LENGTH (tree));
 
+  if (b)
+    {
+      INTERVAL i = find_interval_from_finger (tree, b, position);
+      if (i)
+	{
+	  interval_finger.interval = i;
+	  return i;
+	}
+    }
+
   tree = balance_possible_root_interval (tree);
 
   while (1)
@@ -639,6 +710,13 @@ find_interval (register INTERVAL tree, register ptrdiff_t position)
 	    = (position - relative_position /* left edge of *tree.  */
 	       + LEFT_TOTAL_LENGTH (tree)); /* left edge of this interval.  */
 
+	  if (b)
+	    {
+	      interval_finger.tree = buffer_intervals (b);
+	      interval_finger.interval = tree;
+	      interval_finger.modiff = BUF_MODIFF (b);
+	      interval_finger.tick = interval_tree_tick;
+	    }
 	  return tree;
 	}
     }
@@ -1196,6 +1274,7 @@ delete_interval (register INTERVAL i)
   ptrdiff_t amt = LENGTH (i);
 
   eassert (amt <= 0);	/* Only used on zero total-length intervals now.  */
+  interval_tree_tick++;
 
   if (ROOT_INTERVAL_P (i))
     {
@@ -1365,6 +1444,11 @@ offset_intervals (struct buffer *buffer, ptrdiff_t start, ptrdiff_t length)
 				    start, length);
   else
     adjust_intervals_for_deletion (buffer, start, -length);
+
+  /* The intervals after START have moved, and the buffer's MODIFF may
+     have been incremented before, so invalidate the interval finger
+     that may have been set while adjusting them.  */
+  interval_tree_tick++;
 }
 
 /* Merge interval I with its lexicographic successor. The resulting
@@ -2411,6 +2495,7 @@ set_intervals_multibyte (bool multi_flag)
 {
   INTERVAL i = buffer_intervals (current_buffer);
 
+  interval_tree_tick++;
   if (i)
     set_intervals_multibyte_1 (i, multi_flag, BEG, BEG_BYTE, Z, Z_BYTE);
 }
@@ -248,6 +248,8 @@ #define TEXT_PROP_MEANS_INVISIBLE(prop)					\
 
 /* Declared in intervals.c.  */
 
+extern uintmax_t interval_tree_tick;
+
 extern INTERVAL create_root_interval (Lisp_Object);
 extern void copy_properties (INTERVAL, INTERVAL);
 extern bool intervals_equal (INTERVAL, INTERVAL);
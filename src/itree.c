@@ -19,6 +19,7 @@ Copyright (C) 2017-2025 Free Software Foundation, Inc.
 
 #include <config.h>
 #include <math.h>
+#include <stdlib.h>
 
 #include "itree.h"
 
@@ -738,6 +739,176 @@ itree_insert (struct itree_tree *tree, struct itree_node *node,
   itree_insert_node (tree, node);
 }
 
+/* Return the root of a Red-Black tree made of the N nodes in NODES,
+   which are sorted by their begin positions, with PARENT as its
+   parent.  DEPTH is the depth of the root in the whole tree, and
+   nodes at depth RED_DEPTH are colored red.  */
+
+static struct itree_node *
+itree_build_subtree (struct itree_node **nodes, ptrdiff_t n,
+		     struct itree_node *parent, int depth, int red_depth,
+		     uintmax_t otick)
+{
+  if (n == 0)
+    return NULL;
+
+  /* Splitting at the middle keeps all leaves at depth RED_DEPTH or
+     RED_DEPTH - 1, so coloring only the deepest nodes red gives every
+     path from the root the same number of black nodes.  */
+  ptrdiff_t mid = n / 2;
+  struct itree_node *node = nodes[mid];
+
+  node->parent = parent;
+  node->offset = 0;
+  node->otick = otick;
+  node->red = depth == red_depth;
+  node->left = itree_build_subtree (nodes, mid, node, depth + 1,
+				    red_depth, otick);
+  node->right = itree_build_subtree (nodes + mid + 1, n - mid - 1, node,
+				     depth + 1, red_depth, otick);
+  node->limit = itree_newlimit (node);
+  return node;
+}
+
+/* Make the tree TREE hold exactly the N nodes in NODES, which are
+   sorted by their begin positions and have their begin and end
+   fields set.  This takes time proportional to N.  */
+
+static void
+itree_build (struct itree_tree *tree, struct itree_node **nodes,
+	     ptrdiff_t n)
+{
+  int red_depth = 0;
+
+  /* The depth of the deepest nodes is the floor of log2(N).  The root
+     must be black, so a single node gets no red depth.  */
+  for (ptrdiff_t i = n; i > 1; i >>= 1)
+    red_depth++;
+  if (red_depth == 0)
+    red_depth = -1;
+
+  tree->root = itree_build_subtree (nodes, n, NULL, 0, red_depth,
+				    tree->otick);
+  tree->size = n;
+  eassert (check_tree (tree, true));
+}
+
+/* Store the nodes of TREE in NODES, which must have room for all of
+   them, in ascending order of their begin positions, making all of
+   them clean.  */
+
+static void
+itree_collect_nodes (struct itree_tree *tree, struct itree_node **nodes)
+{
+  struct itree_node *node;
+  ptrdiff_t i = 0;
+
+  ITREE_FOREACH (node, tree, PTRDIFF_MIN, PTRDIFF_MAX, ASCENDING)
+    nodes[i++] = node;
+  eassert (i == tree->size);
+}
+
+static int
+compare_itree_nodes (const void *a, const void *b)
+{
+  struct itree_node *const *node_a = a;
+  struct itree_node *const *node_b = b;
+  ptrdiff_t begin_a = (*node_a)->begin;
+  ptrdiff_t begin_b = (*node_b)->begin;
+
+  return (begin_a > begin_b) - (begin_a < begin_b);
+}
+
+/* Insert the N nodes in NODES, whose begin and end fields are set and
+   which are not in any tree, into TREE.  NODES is sorted in place.
+
+   When there are few nodes compared to the size of TREE, they are
+   inserted one by one.  Otherwise, the new nodes are merged with those
+   already in TREE, and the tree is rebuilt, which avoids rebalancing
+   it after each insertion.  */
+
+void
+itree_insert_nodes (struct itree_tree *tree, struct itree_node **nodes,
+		    ptrdiff_t n)
+{
+  if (n < tree->size / 8)
+    {
+      for (ptrdiff_t i = 0; i < n; i++)
+	{
+	  nodes[i]->otick = tree->otick;
+	  itree_insert_node (tree, nodes[i]);
+	}
+      return;
+    }
+
+  qsort (nodes, n, sizeof *nodes, compare_itree_nodes);
+
+  ptrdiff_t size = tree->size;
+  if (size == 0)
+    {
+      itree_build (tree, nodes, n);
+      return;
+    }
+
+  struct itree_node **old = xnmalloc (size, sizeof *old);
+  struct itree_node **all = xnmalloc (size + n, sizeof *all);
+  ptrdiff_t i = 0, j = 0, k = 0;
+
+  itree_collect_nodes (tree, old);
+  while (i < size || j < n)
+    all[k++] = (j == n || (i < size && old[i]->begin <= nodes[j]->begin)
+		? old[i++] : nodes[j++]);
+  itree_build (tree, all, size + n);
+  xfree (all);
+  xfree (old);
+}
+
+/* Remove the N nodes in NODES, which must all be in TREE, from TREE.
+
+   When there are few nodes compared to the size of TREE, they are
+   removed one by one.  Otherwise, the tree is rebuilt from the nodes
+   that remain, which avoids rebalancing it after each removal.  */
+
+void
+itree_remove_nodes (struct itree_tree *tree, struct itree_node **nodes,
+		    ptrdiff_t n)
+{
+  if (n < tree->size / 8)
+    {
+      for (ptrdiff_t i = 0; i < n; i++)
+	itree_remove (tree, nodes[i]);
+      return;
+    }
+
+  ptrdiff_t size = tree->size;
+  struct itree_node **all = xnmalloc (size, sizeof *all);
+  itree_collect_nodes (tree, all);
+
+  /* All nodes in TREE are now clean, so their otick is that of the
+     tree, which is never zero; use a zero otick to mark the nodes
+     being removed.  */
+  for (ptrdiff_t i = 0; i < n; i++)
+    nodes[i]->otick = 0;
+
+  ptrdiff_t k = 0;
+  for (ptrdiff_t i = 0; i < size; i++)
+    {
+      struct itree_node *node = all[i];
+
+      if (node->otick == 0)
+	{
+	  node->otick = tree->otick;
+	  node->red = false;
+	  node->right = node->left = node->parent = NULL;
+	  node->limit = 0;
+	}
+      else
+	all[k++] = node;
+    }
+  itree_build (tree, all, k);
+  xfree (all);
+}
+
 /* Safely modify a node's interval. */
 
 void
@@ -25,9 +25,12 @@ Copyright (C) 2017-2025 Free Software Foundation, Inc.
 #include <stdlib.h>
 #include <math.h>
 
+#include <c-strcase.h>
+
 #include "lisp.h"
 #include "buffer.h"
 #include "coding.h"
+#include "process.h"
 
 enum json_object_type
   {
@@ -101,6 +104,35 @@ json_parse_args (ptrdiff_t nargs, Lisp_Object *args,
     }
 }
 
+/* Copy the NARGS keyword arguments ARGS to CONF_ARGS, except for the
+   :framing keyword, which json_parse_args does not know about, and
+   store their number in *CONF_NARGS.  Return the value of :framing,
+   or nil if it is not given.  */
+static Lisp_Object
+json_take_framing_arg (ptrdiff_t nargs, Lisp_Object *args,
+		       Lisp_Object *conf_args, ptrdiff_t *conf_nargs)
+{
+  if ((nargs % 2) != 0)
+    wrong_type_argument (Qplistp, Flist (nargs, args));
+
+  Lisp_Object framing = Qnil;
+  bool framing_seen = false;
+  *conf_nargs = 0;
+  for (ptrdiff_t i = 0; i < nargs; i += 2)
+    if (EQ (args[i], QCframing))
+      {
+	if (!framing_seen)
+	  framing = args[i + 1];
+	framing_seen = true;
+      }
+    else
+      {
+	conf_args[(*conf_nargs)++] = args[i];
+	conf_args[(*conf_nargs)++] = args[i + 1];
+      }
+  return framing;
+}
+
 /* JSON encoding context.  */
 typedef struct
 {
@@ -318,11 +350,46 @@ string_not_unicode (Lisp_Object obj)
   0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0, /* e0-ff */
 };
 
+/* Return the number of bytes at the start of the NBYTES bytes at PTR
+   that are plain characters in the sense of json_plain_char.  This
+   looks at 16 bytes at a time, so it is much faster than looking at
+   each byte when strings are long.  */
+static ptrdiff_t
+json_plain_prefix_length (const unsigned char *ptr, ptrdiff_t nbytes)
+{
+  const unsigned char *p = ptr, *endp = ptr + nbytes;
+  uint_least64_t const ones = 0x0101010101010101;
+  uint_least64_t const high_bits = 0x8080808080808080;
+
+  while (endp - p >= 16)
+    {
+      uint_least64_t w[2], special = 0;
+      memcpy (w, p, sizeof w);
+      for (int i = 0; i < 2; i++)
+	{
+	  /* A byte is special if it is not ASCII, if it is less than
+	     0x20, or if it is a quote or a backslash, that is, if
+	     XORing it with one of those gives zero.  */
+	  uint_least64_t quote = w[i] ^ (ones * '"');
+	  uint_least64_t backslash = w[i] ^ (ones * '\\');
+	  special |= (w[i] | ((w[i] - ones * 0x20) & ~w[i])
+		      | ((quote - ones) & ~quote)
+		      | ((backslash - ones) & ~backslash));
+	}
+      if (special & high_bits)
+	for (int i = 0; i < 16; i++)
+	  if (!json_plain_char[p[i]])
+	    return p + i - ptr;
+      p += sizeof w;
+    }
+  while (p < endp && json_plain_char[*p])
+    p++;
+  return p - ptr;
+}
+
 static void
 json_out_string (json_out_t *jo, Lisp_Object str, int skip)
 {
-  /* FIXME: this code is slow, make faster! */
-
   static const char hexchar[16] = "0123456789ABCDEF";
   ptrdiff_t len = SBYTES (str);
   json_make_room (jo, len + 2);
@@ -335,8 +402,9 @@ json_out_string (json_out_t *jo, Lisp_Object str, int skip)
       unsigned char c = *p;
       if (json_plain_char[c])
 	{
-	  json_out_byte (jo, c);
-	  p++;
+	  ptrdiff_t n = json_plain_prefix_length (p, end - p);
+	  json_out_str (jo, (const char *) p, n);
+	  p += n;
 	}
       else if (c > 0x7f)
 	{
@@ -667,8 +735,67 @@ DEFUN ("json-insert", Fjson_insert, Sjson_insert, 1, MANY,
 }
 
 
+#ifdef subprocesses
+
+DEFUN ("json-send", Fjson_send, Sjson_send, 2, MANY, NULL,
+       doc: /* Send the JSON representation of OBJECT to PROCESS as input.
+This is like (process-send-string PROCESS (json-serialize OBJECT ...)),
+but faster for large objects, since no Lisp string is made.  The JSON
+text is sent as UTF-8, without using the coding system of PROCESS for
+anything but end-of-line conversion.  PROCESS is as for
+`process-send-string'.
+
+The arguments ARGS are a list of keyword/argument pairs.  They accept
+the keywords of `json-serialize', which see, and also:
+
+:framing FRAMING -- how to delimit the value.
+  If FRAMING is `jsonrpc', precede the value by a Content-Length
+  header, as in the Language Server Protocol.  If it is `ndjson',
+  follow it by a newline.  If it is nil, the default, send only the
+  value.
+usage: (json-send PROCESS OBJECT &rest ARGS)  */)
+  (ptrdiff_t nargs, Lisp_Object *args)
+{
+  specpdl_ref count = SPECPDL_INDEX ();
+  Lisp_Object proc = get_process (args[0]);
+
+  Lisp_Object *conf_args;
+  ptrdiff_t conf_nargs;
+  USE_SAFE_ALLOCA;
+  SAFE_ALLOCA_LISP (conf_args, nargs - 2);
+  Lisp_Object framing
+    = json_take_framing_arg (nargs - 2, args + 2, conf_args, &conf_nargs);
+  if (! (NILP (framing) || EQ (framing, Qjsonrpc) || EQ (framing, Qndjson)))
+    wrong_choice (list3 (Qnil, Qjsonrpc, Qndjson), framing);
+
+  json_out_t jo;
+  json_serialize (&jo, args[1], conf_nargs, conf_args);
+
+  if (EQ (framing, Qjsonrpc))
+    {
+      /* Put the header in front of the value, so that both are sent
+	 at once.  */
+      char header[sizeof "Content-Length: \r\n\r\n"
+		  + INT_STRLEN_BOUND (ptrdiff_t)];
+      int header_bytes = sprintf (header, "Content-Length: %"pD"d\r\n\r\n",
+				  jo.size);
+      json_make_room (&jo, header_bytes);
+      memmove (jo.buf + header_bytes, jo.buf, jo.size);
+      memcpy (jo.buf, header, header_bytes);
+      jo.size += header_bytes;
+    }
+  else if (EQ (framing, Qndjson))
+    json_out_byte (&jo, '\n');
+
+  send_process (proc, jo.buf, jo.size, Qnil);
+  return SAFE_FREE_UNBIND_TO (count, Qnil);
+}
+
+#endif	/* subprocesses */
+
 #define JSON_PARSER_INTERNAL_OBJECT_WORKSPACE_SIZE 64
 #define JSON_PARSER_INTERNAL_BYTE_WORKSPACE_SIZE 512
+#define JSON_PARSER_KEY_CACHE_SIZE 128
 
 struct json_parser
 {
@@ -717,6 +844,11 @@ #define JSON_PARSER_INTERNAL_BYTE_WORKSPACE_SIZE 512
   unsigned char *byte_workspace;
   unsigned char *byte_workspace_end;
   unsigned char *byte_workspace_current;
+
+  /* Object keys made so far, indexed by a hash of their bytes, so
+     that objects with the same keys share them and each key is
+     interned only once per parse.  An unused slot is nil.  */
+  Lisp_Object key_cache[JSON_PARSER_KEY_CACHE_SIZE];
 };
 
 static AVOID
@@ -777,6 +909,9 @@ json_parser_init (struct json_parser *parser,
   parser->byte_workspace = parser->internal_byte_workspace;
   parser->byte_workspace_end = (parser->byte_workspace
 				+ JSON_PARSER_INTERNAL_BYTE_WORKSPACE_SIZE);
+
+  for (int i = 0; i < JSON_PARSER_KEY_CACHE_SIZE; i++)
+    parser->key_cache[i] = Qnil;
 }
 
 static void
@@ -844,21 +979,25 @@ json_byte_workspace_reset (struct json_parser *parser)
   parser->byte_workspace_current = parser->byte_workspace;
 }
 
-/* Puts 'value' into the byte_workspace.  If there is no space
-   available, it allocates space */
+/* Makes sure that the byte_workspace has room for 'size' more
+   bytes */
 NO_INLINE static void
-json_byte_workspace_put_slow_path (struct json_parser *parser,
-				   unsigned char value)
+json_byte_workspace_grow (struct json_parser *parser, size_t size)
 {
   size_t new_workspace_size
     = parser->byte_workspace_end - parser->byte_workspace;
-  if (ckd_mul (&new_workspace_size, new_workspace_size, 2))
-    {
-      json_signal_error (parser, Qjson_out_of_memory);
-    }
-
   size_t offset
     = parser->byte_workspace_current - parser->byte_workspace;
+  size_t needed_workspace_size;
+  if (ckd_add (&needed_workspace_size, offset, size))
+    json_signal_error (parser, Qjson_out_of_memory);
+  while (new_workspace_size < needed_workspace_size)
+    {
+      if (ckd_mul (&new_workspace_size, new_workspace_size, 2))
+	{
+	  json_signal_error (parser, Qjson_out_of_memory);
+	}
+    }
 
   if (parser->byte_workspace == parser->internal_byte_workspace)
     {
@@ -874,6 +1013,15 @@ json_byte_workspace_put_slow_path (struct json_parser *parser,
   parser->byte_workspace_end
     = parser->byte_workspace + new_workspace_size;
   parser->byte_workspace_current = parser->byte_workspace + offset;
+}
+
+/* Puts 'value' into the byte_workspace.  If there is no space
+   available, it allocates space */
+NO_INLINE static void
+json_byte_workspace_put_slow_path (struct json_parser *parser,
+				   unsigned char value)
+{
+  json_byte_workspace_grow (parser, 1);
   *parser->byte_workspace_current++ = value;
 }
 
@@ -891,6 +1039,17 @@ json_byte_workspace_put (struct json_parser *parser,
     }
 }
 
+/* Puts the 'nbytes' bytes at 'bytes' into the byte_workspace */
+static void
+json_byte_workspace_put_bytes (struct json_parser *parser,
+			       const unsigned char *bytes, ptrdiff_t nbytes)
+{
+  if (parser->byte_workspace_end - parser->byte_workspace_current < nbytes)
+    json_byte_workspace_grow (parser, nbytes);
+  memcpy (parser->byte_workspace_current, bytes, nbytes);
+  parser->byte_workspace_current += nbytes;
+}
+
 static bool
 json_input_at_eof (struct json_parser *parser)
 {
@@ -1037,40 +1196,54 @@ utf8_error (struct json_parser *parser)
   json_signal_error (parser, Qjson_utf8_decode_error);
 }
 
-/* Parse a string literal.  Optionally prepend a ':'.
-   Return the string or an interned symbol.  */
+/* Return the object key whose name is STR, which has NCHARS
+   characters and NBYTES bytes: a string if objects are parsed into
+   hash tables, and an interned symbol otherwise.  Reuse the key made
+   for an earlier object if its name is the same.  */
+static Lisp_Object
+json_make_key (struct json_parser *parser, const char *str,
+	       ptrdiff_t nchars, ptrdiff_t nbytes)
+{
+  bool symbol = parser->conf.object_type != json_object_hashtable;
+  Lisp_Object *slot = &parser->key_cache[hash_string (str, nbytes)
+					 % JSON_PARSER_KEY_CACHE_SIZE];
+  if (!NILP (*slot))
+    {
+      Lisp_Object name = symbol ? SYMBOL_NAME (*slot) : *slot;
+      if (SBYTES (name) == nbytes && memcmp (SDATA (name), str, nbytes) == 0)
+	return *slot;
+    }
+  *slot = (symbol
+	   ? intern_c_multibyte (str, nchars, nbytes)
+	   : make_multibyte_string (str, nchars, nbytes));
+  return *slot;
+}
+
+/* Parse a string literal.  If KEY, it is the key of an object member,
+   so prepend a ':' if objects are parsed into plists, and return the
+   key that 'json_make_key' makes of it.  Otherwise return the
+   string.  */
 static Lisp_Object
-json_parse_string (struct json_parser *parser, bool intern, bool leading_colon)
+json_parse_string (struct json_parser *parser, bool key)
 {
   json_byte_workspace_reset (parser);
-  if (leading_colon)
+  if (key && parser->conf.object_type == json_object_plist)
     json_byte_workspace_put (parser, ':');
   ptrdiff_t chars_delta = 0;	/* nbytes - nchars */
   for (;;)
     {
-      /* This if is only here for a possible speedup.  If there are 4
-	 bytes available, and all of them are single_uninteresting,
-	 then we can just copy these 4 bytes to output */
-      if (parser->input_end - parser->input_current >= 4)
+      /* Copy a run of plain characters in one go.  */
+      if (parser->input_current < parser->input_end
+	  && json_plain_char[*parser->input_current])
 	{
-	  int c0 = parser->input_current[0];
-	  int c1 = parser->input_current[1];
-	  int c2 = parser->input_current[2];
-	  int c3 = parser->input_current[3];
-	  bool v0 = json_plain_char[c0];
-	  bool v1 = json_plain_char[c1];
-	  bool v2 = json_plain_char[c2];
-	  bool v3 = json_plain_char[c3];
-	  if (v0 && v1 && v2 && v3)
-	    {
-	      json_byte_workspace_put (parser, c0);
-	      json_byte_workspace_put (parser, c1);
-	      json_byte_workspace_put (parser, c2);
-	      json_byte_workspace_put (parser, c3);
-	      parser->input_current += 4;
-	      parser->current_column += 4;
-	      continue;
-	    }
+	  ptrdiff_t plain
+	    = json_plain_prefix_length (parser->input_current,
+					(parser->input_end
+					 - parser->input_current));
+	  json_byte_workspace_put_bytes (parser, parser->input_current,
+					 plain);
+	  parser->input_current += plain;
+	  parser->current_column += plain;
 	}
 
       int c = json_input_get (parser);
@@ -1087,8 +1260,8 @@ json_parse_string (struct json_parser *parser, bool intern, bool leading_colon)
 	    = parser->byte_workspace_current - parser->byte_workspace;
 	  ptrdiff_t nchars = nbytes - chars_delta;
 	  const char *str = (const char *) parser->byte_workspace;
-	  return (intern
-		  ? intern_c_multibyte (str, nchars, nbytes)
+	  return (key
+		  ? json_make_key (parser, str, nchars, nbytes)
 		  : make_multibyte_string (str, nchars, nbytes));
 	}
 
@@ -1261,7 +1434,7 @@ json_create_float (struct json_parser *parser)
   json_byte_workspace_put (parser, 0);
   errno = 0;
   char *e;
-  double value = strtod ((const char *) parser->byte_workspace, &e);
+  double value = string_to_double ((const char *) parser->byte_workspace, &e);
   bool out_of_range = (errno != 0 && (value == HUGE_VAL || value == -HUGE_VAL));
   if (out_of_range)
     json_signal_error (parser, Qjson_number_out_of_range);
@@ -1405,30 +1578,15 @@ json_parse_array (struct json_parser *parser)
       if (parser->available_depth < 0)
 	json_signal_error (parser, Qjson_object_too_deep);
 
-      Lisp_Object *cdr = &result;
       /* This loop collects the array elements in the object workspace
        */
       for (;;)
 	{
 	  Lisp_Object element = json_parse_value (parser, c);
-	  switch (parser->conf.array_type)
-	    {
-	    case json_array_array:
-	      json_make_object_workspace_for (parser, 1);
-	      parser->object_workspace[parser->object_workspace_current]
-		= element;
-	      parser->object_workspace_current++;
-	      break;
-	    case json_array_list:
-	      {
-		Lisp_Object nc = Fcons (element, Qnil);
-		*cdr = nc;
-		cdr = xcdr_addr (nc);
-		break;
-	      }
-	    default:
-	      emacs_abort ();
-	    }
+	  json_make_object_workspace_for (parser, 1);
+	  parser->object_workspace[parser->object_workspace_current]
+	    = element;
+	  parser->object_workspace_current++;
 
 	  c = json_skip_whitespace (parser);
 	  if (c == ']')
@@ -1460,6 +1618,9 @@ json_parse_array (struct json_parser *parser)
 	break;
       }
     case json_array_list:
+      result = list_from_array (parser->object_workspace_current - first,
+				parser->object_workspace + first, Qnil);
+      parser->object_workspace_current = first;
       break;
     default:
       emacs_abort ();
@@ -1496,8 +1657,6 @@ json_parse_object (struct json_parser *parser)
       if (parser->available_depth < 0)
 	json_signal_error (parser, Qjson_object_too_deep);
 
-      Lisp_Object *cdr = &result;
-
       /* This loop collects the object members (key/value pairs) in
        * the object workspace */
       for (;;)
@@ -1509,7 +1668,7 @@ json_parse_object (struct json_parser *parser)
 	    {
 	    case json_object_hashtable:
 	      {
-		Lisp_Object key = json_parse_string (parser, false, false);
+		Lisp_Object key = json_parse_string (parser, true);
 		Lisp_Object value = json_parse_object_member_value (parser);
 		json_make_object_workspace_for (parser, 2);
 		parser->object_workspace[parser->object_workspace_current] = key;
@@ -1520,24 +1679,23 @@ json_parse_object (struct json_parser *parser)
 	      }
 	    case json_object_alist:
 	      {
-		Lisp_Object key = json_parse_string (parser, true, false);
+		Lisp_Object key = json_parse_string (parser, true);
 		Lisp_Object value = json_parse_object_member_value (parser);
-		Lisp_Object nc = Fcons (Fcons (key, value), Qnil);
-		*cdr = nc;
-		cdr = xcdr_addr (nc);
+		json_make_object_workspace_for (parser, 1);
+		parser->object_workspace[parser->object_workspace_current]
+		  = Fcons (key, value);
+		parser->object_workspace_current++;
 		break;
 	      }
 	    case json_object_plist:
 	      {
-		Lisp_Object key = json_parse_string (parser, true, true);
+		Lisp_Object key = json_parse_string (parser, true);
 		Lisp_Object value = json_parse_object_member_value (parser);
-		Lisp_Object nc = Fcons (key, Qnil);
-		*cdr = nc;
-		cdr = xcdr_addr (nc);
-
-		nc = Fcons (value, Qnil);
-		*cdr = nc;
-		cdr = xcdr_addr (nc);
+		json_make_object_workspace_for (parser, 2);
+		parser->object_workspace[parser->object_workspace_current] = key;
+		parser->object_workspace_current++;
+		parser->object_workspace[parser->object_workspace_current] = value;
+		parser->object_workspace_current++;
 		break;
 	      }
 	    default:
@@ -1582,6 +1740,9 @@ json_parse_object (struct json_parser *parser)
       }
     case json_object_alist:
     case json_object_plist:
+      result = list_from_array (parser->object_workspace_current - first,
+				parser->object_workspace + first, Qnil);
+      parser->object_workspace_current = first;
       break;
     default:
       emacs_abort ();
@@ -1615,7 +1776,7 @@ json_parse_value (struct json_parser *parser, int c)
   else if (c == '[')
     return json_parse_array (parser);
   else if (c == '"')
-    return json_parse_string (parser, false, false);
+    return json_parse_string (parser, false);
   else if ((c >= '0' && c <= '9') || (c == '-'))
     return json_parse_number (parser, c);
   else
@@ -1781,6 +1942,276 @@ DEFUN ("json-parse-buffer", Fjson_parse_buffer, Sjson_parse_buffer,
   return unbind_to (count, result);
 }
 
+/* Incremental parsing.  A json-parser object collects the text it
+   is fed and looks for the end of each top-level value without
+   parsing it; a value that is complete is then parsed like a string
+   passed to json-parse-string.  The state of the search is kept in
+   the object, so each byte is looked at once however the text is
+   split.  */
+
+/* Return true if C is JSON whitespace.  */
+static bool
+json_whitespace_p (unsigned char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/* Find the end of the value that JP's input has after JP->start.
+   Return it, or -1 if the value is not complete yet.  A value that is
+   a number or a literal ends before whitespace or a structural
+   character, so such a value at the end of the input is not complete
+   yet either.  */
+static ptrdiff_t
+json_find_value_end (struct Lisp_JSON_Parser *jp)
+{
+  const unsigned char *input = jp->input;
+  ptrdiff_t i = jp->scanned, n = jp->input_bytes;
+
+  for (; i < n; i++)
+    {
+      unsigned char c = input[i];
+      if (jp->in_string)
+	{
+	  if (jp->in_escape)
+	    jp->in_escape = false;
+	  else if (c == '\\')
+	    jp->in_escape = true;
+	  else if (c == '"')
+	    {
+	      jp->in_string = false;
+	      if (jp->depth == 0)
+		return i + 1;
+	    }
+	}
+      else if (jp->value_start < 0)
+	{
+	  if (json_whitespace_p (c))
+	    continue;
+	  jp->value_start = i;
+	  if (c == '{' || c == '[')
+	    jp->depth = 1;
+	  else if (c == '"')
+	    jp->in_string = true;
+	  else
+	    jp->in_scalar = true;
+	}
+      else if (jp->in_scalar)
+	{
+	  if (json_whitespace_p (c) || c == '{' || c == '}' || c == '['
+	      || c == ']' || c == '"' || c == ',' || c == ':')
+	    return i;
+	}
+      else if (c == '"')
+	jp->in_string = true;
+      else if (c == '{' || c == '[')
+	jp->depth++;
+      else if ((c == '}' || c == ']') && --jp->depth == 0)
+	return i + 1;
+    }
+
+  jp->scanned = n;
+  return -1;
+}
+
+/* Find the end of the value that JP's input has after JP->start,
+   where the value is preceded by headers ending in an empty line, one
+   of which is a Content-Length header giving the length of the value
+   in bytes.  Return the end, or -1 if the value is not complete
+   yet.  */
+static ptrdiff_t
+json_find_framed_value_end (struct Lisp_JSON_Parser *jp)
+{
+  if (jp->value_bytes < 0)
+    {
+      static char const separator[] = "\r\n\r\n";
+      int separator_bytes = sizeof separator - 1;
+      const unsigned char *headers = jp->input + jp->start;
+      const unsigned char *end
+	= memmem (jp->input + jp->scanned, jp->input_bytes - jp->scanned,
+		  separator, separator_bytes);
+      if (!end)
+	{
+	  jp->scanned = max (jp->start,
+			     jp->input_bytes - (separator_bytes - 1));
+	  return -1;
+	}
+
+      /* Look at each header line for the length.  */
+      static char const field[] = "content-length:";
+      ptrdiff_t field_bytes = sizeof field - 1;
+      ptrdiff_t length = -1;
+      for (const unsigned char *line = headers; line < end; )
+	{
+	  const unsigned char *line_end
+	    = memchr (line, '\r', end + 2 - line);
+	  if (line_end - line > field_bytes
+	      && c_strncasecmp ((const char *) line, field, field_bytes) == 0)
+	    {
+	      const unsigned char *p = line + field_bytes;
+	      while (p < line_end && (*p == ' ' || *p == '\t'))
+		p++;
+	      length = p < line_end ? 0 : -1;
+	      for (; p < line_end && length >= 0; p++)
+		if (! ('0' <= *p && *p <= '9')
+		    || ckd_mul (&length, length, 10)
+		    || ckd_add (&length, length, *p - '0'))
+		  length = -1;
+	    }
+	  line = line_end + 2;
+	}
+
+      jp->start = jp->scanned = end + separator_bytes - jp->input;
+      if (length < 0)
+	xsignal1 (Qjson_parse_error,
+		  make_unibyte_string ((const char *) headers,
+				       end - headers));
+      jp->value_start = jp->start;
+      jp->value_bytes = length;
+    }
+
+  return (jp->input_bytes - jp->value_start < jp->value_bytes
+	  ? -1 : jp->value_start + jp->value_bytes);
+}
+
+/* Forget the value that JP's input has after JP->start, which ends at
+   END, and get ready to look for the next one.  */
+static void
+json_skip_value (struct Lisp_JSON_Parser *jp, ptrdiff_t end)
+{
+  jp->start = jp->scanned = end;
+  jp->value_start = jp->value_bytes = -1;
+  jp->depth = 0;
+  jp->in_string = jp->in_escape = jp->in_scalar = false;
+}
+
+DEFUN ("json-make-parser", Fjson_make_parser, Sjson_make_parser,
+       0, MANY, NULL,
+       doc: /* Return a new parser that parses JSON text fed to it in pieces.
+Use `json-parser-feed' to give it text, for instance from a process
+filter, and to get the values it completes.  The parser is fed a
+sequence of JSON values, separated by whitespace if needed.  A number
+or a literal such as `true' at the end of the text fed so far is not
+complete, since more text may continue it.
+
+The arguments ARGS are a list of keyword/argument pairs.  They accept
+the keywords of `json-parse-string', which see, and also:
+
+:framing FRAMING -- how the values are delimited.
+  If FRAMING is nil, the default, values are delimited by their
+  syntax as described above.  If it is `content-length', each value
+  is preceded by headers that end in an empty line, one of which is a
+  Content-Length header giving the length of the value in bytes, as
+  in the base protocol of the Language Server Protocol.
+usage: (json-make-parser &rest ARGS) */)
+  (ptrdiff_t nargs, Lisp_Object *args)
+{
+  Lisp_Object *conf_args;
+  ptrdiff_t conf_nargs;
+  USE_SAFE_ALLOCA;
+  SAFE_ALLOCA_LISP (conf_args, nargs);
+  Lisp_Object framing
+    = json_take_framing_arg (nargs, args, conf_args, &conf_nargs);
+  if (! (NILP (framing) || EQ (framing, Qcontent_length)))
+    wrong_choice (list2 (Qnil, Qcontent_length), framing);
+
+  struct json_configuration conf
+    = { json_object_hashtable, json_array_array, QCnull, QCfalse };
+  json_parse_args (conf_nargs, conf_args, &conf, true);
+  SAFE_FREE ();
+
+  struct Lisp_JSON_Parser *jp
+    = ALLOCATE_PSEUDOVECTOR (struct Lisp_JSON_Parser, values,
+			     PVEC_JSON_PARSER);
+  jp->null_object = conf.null_object;
+  jp->false_object = conf.false_object;
+  jp->values = Qnil;
+  jp->object_type = conf.object_type;
+  jp->array_type = conf.array_type;
+  jp->content_length_framing = !NILP (framing);
+  jp->input_size = jp->input_bytes = 0;
+  jp->input = xpalloc (NULL, &jp->input_size, 1, -1, 1);
+  json_skip_value (jp, 0);
+
+  Lisp_Object parser;
+  XSETPSEUDOVECTOR (parser, jp, PVEC_JSON_PARSER);
+  return parser;
+}
+
+DEFUN ("json-parser-p", Fjson_parser_p, Sjson_parser_p, 1, 1, 0,
+       doc: /* Return t if OBJECT is a parser made by `json-make-parser'.  */)
+  (Lisp_Object object)
+{
+  return JSON_PARSERP (object) ? Qt : Qnil;
+}
+
+DEFUN ("json-parser-feed", Fjson_parser_feed, Sjson_parser_feed, 2, 2, 0,
+       doc: /* Give PARSER the JSON text in STRING, and return the values it completes.
+PARSER is a parser made by `json-make-parser'.  STRING continues the
+text PARSER has been fed so far; it need not start or end at the
+boundary of a value, or even of a character.  Return a list of the
+values that PARSER has parsed completely, in order.  Text after the
+last complete value is kept for the next call.
+
+If one of the values is not valid JSON, signal an error of type
+`json-parse-error' or one of the other JSON errors, and skip the
+value.  In that case, the values parsed before it are returned by the
+next call, which goes on with the text after the invalid value.  */)
+  (Lisp_Object parser, Lisp_Object string)
+{
+  CHECK_JSON_PARSER (parser);
+  CHECK_STRING (string);
+  struct Lisp_JSON_Parser *jp = XJSON_PARSER (parser);
+
+  /* Make room for STRING, dropping the text already parsed.  */
+  ptrdiff_t nbytes = SBYTES (string);
+  if (jp->start > 0)
+    {
+      ptrdiff_t start = jp->start;
+      jp->input_bytes -= start;
+      memmove (jp->input, jp->input + start, jp->input_bytes);
+      jp->start = 0;
+      jp->scanned -= start;
+      if (jp->value_start >= 0)
+	jp->value_start -= start;
+    }
+  if (jp->input_size - jp->input_bytes < nbytes)
+    jp->input = xpalloc (jp->input, &jp->input_size,
+			 nbytes - (jp->input_size - jp->input_bytes), -1, 1);
+  memcpy (jp->input + jp->input_bytes, SDATA (string), nbytes);
+  jp->input_bytes += nbytes;
+
+  struct json_configuration conf
+    = { jp->object_type, jp->array_type,
+	jp->null_object, jp->false_object };
+  for (;;)
+    {
+      ptrdiff_t end = (jp->content_length_framing
+		       ? json_find_framed_value_end (jp)
+		       : json_find_value_end (jp));
+      if (end < 0)
+	break;
+
+      /* Skip the value first, so that it is skipped even if it turns
+	 out to be invalid.  */
+      ptrdiff_t start = jp->start;
+      json_skip_value (jp, end);
+
+      specpdl_ref count = SPECPDL_INDEX ();
+      struct json_parser p;
+      json_parser_init (&p, conf, jp->input + start, jp->input + end,
+			NULL, NULL);
+      record_unwind_protect_ptr (json_parser_done, &p);
+      Lisp_Object value = json_parse (&p);
+      if (json_skip_whitespace_if_possible (&p) >= 0)
+	json_signal_error (&p, Qjson_trailing_content);
+      jp->values = Fcons (unbind_to (count, value), jp->values);
+    }
+
+  Lisp_Object values = Fnreverse (jp->values);
+  jp->values = Qnil;
+  return values;
+}
+
 void
 syms_of_json (void)
 {
@@ -1825,9 +2256,20 @@ syms_of_json (void)
   DEFSYM (Qalist, "alist");
   DEFSYM (Qplist, "plist");
   DEFSYM (Qarray, "array");
+  DEFSYM (QCframing, ":framing");
+  DEFSYM (Qcontent_length, "content-length");
+
+  DEFSYM (Qjson_parser, "json-parser");
+  DEFSYM (Qjson_parser_p, "json-parser-p");
 
   defsubr (&Sjson_serialize);
   defsubr (&Sjson_insert);
+#ifdef subprocesses
+  defsubr (&Sjson_send);
+#endif
   defsubr (&Sjson_parse_string);
   defsubr (&Sjson_parse_buffer);
+  defsubr (&Sjson_make_parser);
+  defsubr (&Sjson_parser_p);
+  defsubr (&Sjson_parser_feed);
 }
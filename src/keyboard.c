@@ -328,6 +328,44 @@ #define GROW_RAW_KEYBUF							\
    Why not just have a flag set and cleared by the enqueuing and
    dequeuing functions?  The code is a bit simpler this way.  */
 
+/* When `track-input-latency' is non-nil, the arrival time of the last
+   input event read before a command finished, the command, and
+   whether it finished.  The latency is recorded when the display is
+   next brought up to date, see note_input_latency_display.  */
+
+static struct timespec input_latency_start;
+static Lisp_Object input_latency_command;
+static bool input_latency_command_done;
+
+/* Hash table mapping commands to the histograms of their latencies,
+   or nil.  Each histogram is a vector [COUNT MAX BUCKET...] whose
+   buckets count the latencies in ranges of microseconds, four per
+   power of two, see input_latency_bucket.  */
+
+static Lisp_Object input_latency_table;
+
+enum { INPUT_LATENCY_BUCKETS = 4 * 40 };
+
+/* Return true if the time from EVENT to the display should be
+   measured.  */
+
+static bool
+input_latency_event_p (struct input_event *event)
+{
+  switch (event->kind)
+    {
+    case ASCII_KEYSTROKE_EVENT:
+    case MULTIBYTE_CHAR_KEYSTROKE_EVENT:
+    case NON_ASCII_KEYSTROKE_EVENT:
+    case MOUSE_CLICK_EVENT:
+    case WHEEL_EVENT:
+    case HORIZ_WHEEL_EVENT:
+      return true;
+    default:
+      return false;
+    }
+}
+
 static void recursive_edit_unwind (Lisp_Object buffer);
 static Lisp_Object command_loop (void);
 
@@ -1137,7 +1175,11 @@ command_loop (void)
   else
     while (1)
       {
+	intmax_t top_level_event = startup_profile_begin ("init", "top-level");
 	internal_catch (Qtop_level, top_level_1, Qnil);
+	startup_profile_end (top_level_event);
+	/* Startup is over once `top-level' has run.  */
+	startup_profile_finish ();
 	internal_catch (Qtop_level, command_loop_2, Qerror);
 	executing_kbd_macro = Qnil;
 
@@ -1578,6 +1620,12 @@ command_loop_1 (void)
 
       kset_last_command (current_kboard, Vthis_command);
       kset_real_last_command (current_kboard, Vreal_this_command);
+      if (!input_latency_command_done
+	  && timespec_sign (input_latency_start) > 0)
+	{
+	  input_latency_command = Vreal_this_command;
+	  input_latency_command_done = true;
+	}
       if (!CONSP (last_command_event))
 	kset_last_repeatable_command (current_kboard, Vreal_this_command);
 
@@ -2936,6 +2984,27 @@ read_char (int commandflag, Lisp_Object map,
       /* If there is still no input available, ask for GC.  */
       if (!detect_input_pending_run_timers (0))
 	maybe_gc ();
+
+      /* Collect garbage early if we stay idle long enough, so that
+	 the next collection does not interrupt typing.  */
+      if (commandflag != 0 && commandflag != -2
+	  && NUMBERP (Vgc_idle_delay)
+	  && gc_eagerly_due_p (gc_idle_factor)
+	  && !detect_input_pending_run_timers (0))
+	{
+	  Lisp_Object tem0;
+	  specpdl_ref count1 = SPECPDL_INDEX ();
+	  save_getcjmp (save_jump);
+	  record_unwind_protect_ptr (restore_getcjmp, save_jump);
+	  restore_getcjmp (local_getcjmp);
+	  tem0 = sit_for (Vgc_idle_delay, 1, 1);
+	  unbind_to (count1, Qnil);
+
+	  if (EQ (tem0, Qt)
+	      && ! CONSP (Vunread_command_events)
+	      && maybe_garbage_collect_eagerly (gc_idle_factor))
+	    gcs_idle_done++;
+	}
     }
 
   /* Notify the caller if an autosave hook, or a timer, sentinel or
@@ -3808,6 +3877,8 @@ kbd_buffer_store_buffered_event (union buffered_input_event *event,
   if (kbd_fetch_ptr != next_slot)
     {
       *kbd_store_ptr = *event;
+      if (track_input_latency && input_latency_event_p (&event->ie))
+	kbd_store_ptr->ie.arrival = current_timespec ();
       kbd_store_ptr = next_slot;
 #ifdef subprocesses
       if (kbd_buffer_nr_stored () > KBD_BUFFER_SIZE / 2
@@ -4007,7 +4078,8 @@ kbd_buffer_get_event (KBOARD **kbp,
     }
 #endif	/* subprocesses */
 
-#if !defined HAVE_DBUS && !defined USE_FILE_NOTIFY && !defined THREADS_ENABLED
+#if (!defined HAVE_DBUS && !defined USE_FILE_NOTIFY && !defined THREADS_ENABLED \
+     && !defined HAVE_MODULES)
   if (noninteractive
       /* In case we are running as a daemon, only do this before
 	 detaching from the terminal.  */
@@ -4018,7 +4090,8 @@ kbd_buffer_get_event (KBOARD **kbp,
       *kbp = current_kboard;
       return obj;
     }
-#endif	/* !defined HAVE_DBUS && !defined USE_FILE_NOTIFY && !defined THREADS_ENABLED  */
+#endif	/* !defined HAVE_DBUS && !defined USE_FILE_NOTIFY && !defined THREADS_ENABLED
+	   && !defined HAVE_MODULES */
 
   *kbp = current_kboard;
 
@@ -4262,6 +4335,9 @@ kbd_buffer_get_event (KBOARD **kbp,
 #ifdef THREADS_ENABLED
       case THREAD_EVENT:
 #endif
+#ifdef HAVE_MODULES
+      case MODULE_EVENT:
+#endif
 #ifdef HAVE_XWIDGETS
       case XWIDGET_EVENT:
       case XWIDGET_DISPLAY_EVENT:
@@ -4416,6 +4492,10 @@ kbd_buffer_get_event (KBOARD **kbp,
 		}
 
 	      obj = make_lispy_event (&event->ie);
+	      if (track_input_latency
+		  && !input_latency_command_done
+		  && timespec_sign (event->ie.arrival) > 0)
+		input_latency_start = event->ie.arrival;
 
 #ifdef HAVE_EXT_MENU_BAR
 	      /* If this was a menu selection, then set the flag to inhibit
@@ -4674,6 +4754,59 @@ decode_timer (Lisp_Object timer)
   return list4_to_timespec (vec[1], vec[2], vec[3], vec[8]);
 }
 
+/* Return the time of the first valid timer in the list TIMERS, an
+   invalid struct timespec if there is none.  */
+static struct timespec
+timer_list_next (Lisp_Object timers)
+{
+  FOR_EACH_TAIL_SAFE (timers)
+    {
+      struct timespec timer_time = decode_timer (XCAR (timers));
+      if (timespec_valid_p (timer_time))
+	return timer_time;
+    }
+  return invalid_timespec ();
+}
+
+/* If no timer is ripe and nothing else needs to be run, return the
+   time to wait until the next timer fires, or an invalid value if no
+   timer is active.  Otherwise return zero.  This looks only at the
+   first valid timer of each list, so it is cheap however many timers
+   are waiting.  */
+static struct timespec
+timer_check_quickly (void)
+{
+  if (CONSP (pending_funcalls))
+    return make_timespec (0, 0);
+
+  struct timespec now = current_timespec ();
+  struct timespec difference = timer_list_next (Vtimer_list);
+  if (timespec_valid_p (difference))
+    {
+      if (timespec_cmp (difference, now) <= 0)
+	return make_timespec (0, 0);
+      difference = timespec_sub (difference, now);
+    }
+
+  if (timespec_valid_p (timer_idleness_start_time))
+    {
+      struct timespec idleness_now
+	= timespec_sub (now, timer_idleness_start_time);
+      struct timespec idle_timer_time = timer_list_next (Vtimer_idle_list);
+      if (timespec_valid_p (idle_timer_time))
+	{
+	  if (timespec_cmp (idle_timer_time, idleness_now) <= 0)
+	    return make_timespec (0, 0);
+	  idle_timer_time = timespec_sub (idle_timer_time, idleness_now);
+	  if (! timespec_valid_p (difference)
+	      || timespec_cmp (idle_timer_time, difference) < 0)
+	    difference = idle_timer_time;
+	}
+    }
+
+  return difference;
+}
+
 
 /* Check whether a timer has fired.  To prevent larger problems we simply
    disregard elements that are not proper timers.  Do not make a circular
@@ -4844,6 +4977,11 @@ timer_check (void)
   struct timespec nexttime;
   Lisp_Object timers, idle_timers;
 
+  /* Usually no timer is ripe, and the lists need not be copied.  */
+  nexttime = timer_check_quickly ();
+  if (! (nexttime.tv_sec == 0 && nexttime.tv_nsec == 0))
+    return nexttime;
+
   Lisp_Object tem = Vinhibit_quit;
   Vinhibit_quit = Qt;
   block_input ();
@@ -4892,6 +5030,40 @@ DEFUN ("current-idle-time", Fcurrent_idle_time, Scurrent_idle_time, 0, 0, 0,
   return Qnil;
 }
 
+DEFUN ("internal--timer-insert-position", Finternal__timer_insert_position,
+       Sinternal__timer_insert_position, 2, 2, 0,
+       doc: /* Return the cell of TIMERS after which to insert TIMER.
+TIMERS is a list of timers sorted by the time they fire.  The value is
+the last cell whose timer fires strictly before TIMER, or nil if TIMER
+should come first.  Elements that are not timers are passed over.  */)
+  (Lisp_Object timer, Lisp_Object timers)
+{
+  if (! (VECTORP (timer) && ASIZE (timer) == 10))
+    wrong_type_argument (Qtimerp, timer);
+  Lisp_Object *vec = XVECTOR (timer)->contents;
+  struct timespec timer_time
+    = list4_to_timespec (vec[1], vec[2], vec[3], vec[8]);
+  if (! timespec_valid_p (timer_time))
+    error ("Invalid or uninitialized timer");
+
+  Lisp_Object last = Qnil;
+  FOR_EACH_TAIL (timers)
+    {
+      Lisp_Object elt = XCAR (timers);
+      if (VECTORP (elt) && ASIZE (elt) == 10)
+	{
+	  vec = XVECTOR (elt)->contents;
+	  struct timespec elt_time
+	    = list4_to_timespec (vec[1], vec[2], vec[3], vec[8]);
+	  if (timespec_valid_p (elt_time)
+	      && timespec_cmp (elt_time, timer_time) >= 0)
+	    break;
+	}
+      last = timers;
+    }
+  return last;
+}
+
 /* Caches for modify_event_symbol.  */
 static Lisp_Object accent_key_syms;
 static Lisp_Object func_key_syms;
@@ -7184,6 +7356,11 @@ make_lispy_event (struct input_event *event)
       return Fcons (Qthread_event, event->arg);
 #endif /* THREADS_ENABLED */
 
+#ifdef HAVE_MODULES
+    case MODULE_EVENT:
+      return Fcons (Qmodule_event, event->arg);
+#endif /* HAVE_MODULES */
+
 #ifdef HAVE_XWIDGETS
     case XWIDGET_EVENT:
       return Fcons (Qxwidget_event, event->arg);
@@ -11854,6 +12031,128 @@ DEFUN ("lossage-size", Flossage_size, Slossage_size, 0, 1,
   return make_fixnum (lossage_limit);
 }
 
+/* Return the histogram bucket of a latency of US microseconds.  */
+
+static int
+input_latency_bucket (intmax_t us)
+{
+  if (us < 4)
+    return max (us, 0);
+  int e = elogb (us);
+  return min (4 * (e - 1) + ((us >> (e - 2)) & 3),
+	      INPUT_LATENCY_BUCKETS - 1);
+}
+
+/* Return the smallest latency in microseconds counted by BUCKET.  */
+
+static intmax_t
+input_latency_bucket_start (int bucket)
+{
+  if (bucket < 4)
+    return bucket;
+  return (intmax_t) (4 + bucket % 4) << (bucket / 4 - 1);
+}
+
+/* Record the latency of the last command, if any, now that the
+   display shows its effects.  Called at the end of redisplay.  */
+
+void
+note_input_latency_display (void)
+{
+  if (!input_latency_command_done)
+    return;
+
+  struct timespec elapsed = timespec_sub (current_timespec (),
+					  input_latency_start);
+  intmax_t us = (elapsed.tv_sec * (intmax_t) 1000000
+		 + elapsed.tv_nsec / 1000);
+  Lisp_Object command = (SYMBOLP (input_latency_command)
+			 ? input_latency_command : Qlambda);
+
+  input_latency_start = make_timespec (0, 0);
+  input_latency_command = Qnil;
+  input_latency_command_done = false;
+  if (!track_input_latency)
+    return;
+
+  if (NILP (input_latency_table))
+    input_latency_table = make_hash_table (&hashtest_eq, DEFAULT_HASH_SIZE,
+					   Weak_None);
+  struct Lisp_Hash_Table *h = XHASH_TABLE (input_latency_table);
+  hash_hash_t hash;
+  ptrdiff_t i = hash_lookup_get_hash (h, command, &hash);
+  Lisp_Object histogram;
+  if (i >= 0)
+    histogram = HASH_VALUE (h, i);
+  else
+    {
+      histogram = make_vector (2 + INPUT_LATENCY_BUCKETS, make_fixnum (0));
+      hash_put (h, command, histogram, hash);
+    }
+
+  ASET (histogram, 0, make_int (XFIXNUM (AREF (histogram, 0)) + 1));
+  if (us > XFIXNUM (AREF (histogram, 1)))
+    ASET (histogram, 1, make_int (us));
+  int bucket = 2 + input_latency_bucket (us);
+  ASET (histogram, bucket, make_int (XFIXNUM (AREF (histogram, bucket)) + 1));
+}
+
+/* Return, in seconds, the latency below which a fraction Q of the
+   latencies in HISTOGRAM lie, estimated from its buckets.  */
+
+static double
+input_latency_quantile (Lisp_Object histogram, double q)
+{
+  EMACS_INT count = XFIXNUM (AREF (histogram, 0));
+  EMACS_INT max_us = XFIXNUM (AREF (histogram, 1));
+  EMACS_INT seen = 0;
+
+  for (int b = 0; b < INPUT_LATENCY_BUCKETS; b++)
+    {
+      seen += XFIXNUM (AREF (histogram, 2 + b));
+      if (seen >= q * count)
+	return min (input_latency_bucket_start (b + 1), max_us) / 1e6;
+    }
+  return max_us / 1e6;
+}
+
+DEFUN ("input-latency-statistics", Finput_latency_statistics,
+       Sinput_latency_statistics, 0, 1, 0,
+       doc: /* Return statistics of the latency from input to display.
+When `track-input-latency' is non-nil, Emacs measures for each command
+the time from the arrival of the last input event read for it until
+redisplay showed the effects of the command.  The value is a list with
+an element (COMMAND COUNT P50 P99 MAX) for each command measured,
+where COUNT is the number of times it was, and P50, P99 and MAX are,
+in seconds, the median latency, the latency that 99 percent of the
+measurements did not exceed, and the largest one.  P50 and P99 are
+estimates with a precision of 25 percent.  Commands that are not
+symbols are recorded under `lambda'.
+
+If CLEAR is non-nil, discard the statistics after returning them.  */)
+  (Lisp_Object clear)
+{
+  Lisp_Object result = Qnil;
+
+  if (!NILP (input_latency_table))
+    {
+      DOHASH (XHASH_TABLE (input_latency_table), command, histogram)
+	{
+	  double p50 = input_latency_quantile (histogram, 0.5);
+	  double p99 = input_latency_quantile (histogram, 0.99);
+	  double longest = XFIXNUM (AREF (histogram, 1)) / 1e6;
+
+	  result = Fcons (list5 (command, AREF (histogram, 0),
+				 make_float (p50), make_float (p99),
+				 make_float (longest)),
+			  result);
+	}
+    }
+  if (!NILP (clear))
+    input_latency_table = Qnil;
+  return Fnreverse (result);
+}
+
 DEFUN ("recent-keys", Frecent_keys, Srecent_keys, 0, 1, 0,
        doc: /* Return vector of last few events, not counting those from keyboard macros.
 If INCLUDE-CMDS is non-nil, include the commands that were run,
@@ -12963,6 +13262,9 @@ init_while_no_input_ignore_events (void)
 #endif
 #ifdef THREADS_ENABLED
   events = Fcons (Qthread_event, events);
+#endif
+#ifdef HAVE_MODULES
+  events = Fcons (Qmodule_event, events);
 #endif
   events = Fcons (Qsleep_event, events);
 
@@ -12987,6 +13289,9 @@ is_ignored_event (union buffered_input_event *event)
 #endif
 #ifdef HAVE_DBUS
     case DBUS_EVENT: ignore_event = Qdbus_event; break;
+#endif
+#ifdef HAVE_MODULES
+    case MODULE_EVENT: ignore_event = Qmodule_event; break;
 #endif
     case SLEEP_EVENT: ignore_event = Qsleep_event; break;
     default: ignore_event = Qnil; break;
@@ -13082,6 +13387,7 @@ syms_of_keyboard (void)
 
 #ifdef THREADS_ENABLED
   DEFSYM (Qthread_event, "thread-event");
+  DEFSYM (Qmodule_event, "module-event");
 #endif
 
 #ifdef HAVE_XWIDGETS
@@ -13300,6 +13606,7 @@ syms_of_keyboard (void)
   staticpro (&menu_bar_touch_id);
 
   defsubr (&Scurrent_idle_time);
+  defsubr (&Sinternal__timer_insert_position);
   defsubr (&Sevent_symbol_parse_modifiers);
   defsubr (&Sevent_convert_list);
   defsubr (&Sinternal_handle_focus_in);
@@ -13310,6 +13617,7 @@ syms_of_keyboard (void)
   defsubr (&Sinput_pending_p);
   defsubr (&Sinsert_special_event);
   defsubr (&Slossage_size);
+  defsubr (&Sinput_latency_statistics);
   defsubr (&Srecent_keys);
   defsubr (&Sthis_command_keys);
   defsubr (&Sthis_command_keys_vector);
@@ -14033,6 +14341,16 @@ syms_of_keyboard (void)
 Internal use only.  */);
   inhibit_record_char = false;
 
+  DEFVAR_BOOL ("track-input-latency", track_input_latency,
+	       doc: /* Non-nil means measure the latency from input to display.
+See `input-latency-statistics'.  */);
+  track_input_latency = false;
+
+  input_latency_table = Qnil;
+  staticpro (&input_latency_table);
+  input_latency_command = Qnil;
+  staticpro (&input_latency_command);
+
   DEFVAR_BOOL ("record-all-keys", record_all_keys,
 	       doc: /* Non-nil means record all keys you type.
 When nil, the default, characters typed as part of passwords are
@@ -14070,6 +14388,7 @@ syms_of_keyboard (void)
   DEFSYM (Qns_unput_working_text, "ns-unput-working-text");
 #endif
   DEFSYM (Qinternal_timer_start_idle, "internal-timer-start-idle");
+  DEFSYM (Qtimerp, "timerp");
   DEFSYM (Qconcat, "concat");
   DEFSYM (Qsuspend_hook, "suspend-hook");
   DEFSYM (Qsuspend_resume_hook, "suspend-resume-hook");
@@ -14168,6 +14487,13 @@ keys_of_keyboard (void)
 			    "thread-handle-event");
 #endif
 
+#ifdef HAVE_MODULES
+  /* Define a special event which is raised for callbacks posted by
+     threads of modules.  */
+  initial_define_lispy_key (Vspecial_event_map, "module-event",
+			    "module-handle-event");
+#endif
+
 #ifdef USE_FILE_NOTIFY
   /* Define a special event which is raised for notification callback
      functions.  */
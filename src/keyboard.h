@@ -523,6 +523,7 @@ kbd_buffer_store_event_hold (struct input_event *event,
 extern int tty_read_avail_input (struct terminal *, struct input_event *);
 extern struct timespec timer_check (void);
 extern void mark_kboards (void);
+extern void note_input_latency_display (void);
 
 #if defined HAVE_NTGUI || defined HAVE_X_WINDOWS || defined HAVE_PGTK
 extern const char *const lispy_function_keys[];
@@ -67,13 +67,28 @@
 /* Char table for the backwards-compatibility part in Flookup_key.  */
 static Lisp_Object unicode_case_table;
 
-/* Hash table used to cache a reverse-map to speed up calls to where-is.  */
+/* List of reverse-maps cached to speed up calls to where-is, most
+   recently used first.  Each element is a vector [KEYMAPS FLAGS TABLE],
+   where TABLE maps each definition in KEYMAPS to the list of key
+   sequences bound to it, and FLAGS tells how they were searched.  */
 static Lisp_Object where_is_cache;
-/* Which keymaps are reverse-stored in the cache.  */
-static Lisp_Object where_is_cache_keymaps;
+enum { WHERE_IS_CACHE_SIZE = 4 };
+
+/* Vector caching recent results of access_keymap.  Element 0 is a
+   generation number, incremented whenever a keymap is modified.  Each
+   entry that follows holds a keymap, an event, a fixnum combining the
+   generation and the flags of the lookup, and the binding found.  */
+static Lisp_Object keymap_lookup_cache;
+enum { KEYMAP_LOOKUP_CACHE_BITS = 9 };
+
+/* True if a menu-item filter was called while looking up a key.  Such
+   a binding depends on more than the keymap, so it is not cached.  */
+static bool keymap_filter_called;
 
 static Lisp_Object store_in_keymap (Lisp_Object, Lisp_Object, Lisp_Object,
 				    bool);
+static Lisp_Object access_keymap_cached (Lisp_Object, Lisp_Object,
+					 bool, bool, bool);
 
 static Lisp_Object define_as_prefix (Lisp_Object, Lisp_Object);
 static void describe_vector (Lisp_Object, Lisp_Object, Lisp_Object,
@@ -268,6 +283,17 @@ keymap_memberp (Lisp_Object map, Lisp_Object maps)
   return (EQ (map, maps));
 }
 
+/* Forget all the bindings in keymap_lookup_cache.  Keymaps modified
+   by other means than store_in_keymap and Fset_keymap_parent are not
+   noticed, just as for where_is_cache.  */
+static void
+flush_keymap_lookup_cache (void)
+{
+  if (VECTORP (keymap_lookup_cache))
+    ASET (keymap_lookup_cache, 0,
+	  make_fixnum (XFIXNUM (AREF (keymap_lookup_cache, 0)) + 1));
+}
+
 /* Set the parent keymap of MAP to PARENT.  */
 
 DEFUN ("set-keymap-parent", Fset_keymap_parent, Sset_keymap_parent, 2, 2, 0,
@@ -276,7 +302,8 @@ DEFUN ("set-keymap-parent", Fset_keymap_parent, Sset_keymap_parent, 2, 2, 0,
   (Lisp_Object keymap, Lisp_Object parent)
 {
   /* Flush any reverse-map cache.  */
-  where_is_cache = Qnil; where_is_cache_keymaps = Qt;
+  where_is_cache = Qnil;
+  flush_keymap_lookup_cache ();
 
   keymap = get_keymap (keymap, 1, 1);
 
@@ -351,8 +378,8 @@ access_keymap_1 (Lisp_Object map, Lisp_Object idx,
 	 infinite recursion.  Protect against that.  */
       if (XFIXNUM (meta_prefix_char) & CHAR_META)
 	meta_prefix_char = make_fixnum (27);
-      event_meta_binding = access_keymap_1 (map, meta_prefix_char, t_ok,
-					    noinherit, autoload);
+      event_meta_binding = access_keymap_cached (map, meta_prefix_char, t_ok,
+						 noinherit, autoload);
       event_meta_map = get_keymap (event_meta_binding, 0, autoload);
       if (CONSP (event_meta_map))
 	{
@@ -414,7 +441,11 @@ access_keymap_1 (Lisp_Object map, Lisp_Object idx,
 	  }
 	else if (CONSP (submap))
 	  {
-	    val = access_keymap_1 (submap, idx, t_ok, noinherit, autoload);
+	    /* Keymaps made by composing others, such as the list of
+	       active keymaps, are usually new each time, but the
+	       keymaps they contain are not.  */
+	    val = access_keymap_cached (submap, idx, t_ok, noinherit,
+					autoload);
 	  }
 	else if (CONSP (binding))
 	  {
@@ -488,11 +519,64 @@ access_keymap_1 (Lisp_Object map, Lisp_Object idx,
   }
 }
 
+/* Like access_keymap_1, but look up and store the binding in
+   keymap_lookup_cache.  */
+
+static Lisp_Object
+access_keymap_cached (Lisp_Object map, Lisp_Object idx,
+		      bool t_ok, bool noinherit, bool autoload)
+{
+  /* Only the head of an event matters, see access_keymap_1.  Meta
+     characters also depend on meta-prefix-char, so they are not
+     cached.  */
+  idx = EVENT_HEAD (idx);
+  if (! (CONSP (map)
+	 && (SYMBOLP (idx)
+	     || (FIXNUMP (idx) && ! (XFIXNUM (idx) & meta_modifier)))))
+    return access_keymap_1 (map, idx, t_ok, noinherit, autoload);
+
+  if (! VECTORP (keymap_lookup_cache))
+    {
+      keymap_lookup_cache
+	= make_nil_vector (1 + 4 * (1 << KEYMAP_LOOKUP_CACHE_BITS));
+      ASET (keymap_lookup_cache, 0, make_fixnum (0));
+    }
+  Lisp_Object generation = AREF (keymap_lookup_cache, 0);
+  Lisp_Object stamp = make_fixnum ((XFIXNUM (generation) << 3)
+				   | (t_ok << 2) | (noinherit << 1)
+				   | autoload);
+  hash_hash_t hash
+    = reduce_emacs_uint_to_hash_hash (sxhash_combine (XHASH (map),
+						      XHASH (idx)));
+  ptrdiff_t i = 1 + 4 * knuth_hash (hash, KEYMAP_LOOKUP_CACHE_BITS);
+  if (EQ (AREF (keymap_lookup_cache, i), map)
+      && EQ (AREF (keymap_lookup_cache, i + 1), idx)
+      && EQ (AREF (keymap_lookup_cache, i + 2), stamp))
+    return AREF (keymap_lookup_cache, i + 3);
+
+  bool filter_called = keymap_filter_called;
+  keymap_filter_called = false;
+  Lisp_Object val = access_keymap_1 (map, idx, t_ok, noinherit, autoload);
+
+  /* Don't cache the binding if a filter was called, or if a keymap was
+     changed while looking it up, for instance by autoloading.  */
+  if (! keymap_filter_called
+      && EQ (AREF (keymap_lookup_cache, 0), generation))
+    {
+      ASET (keymap_lookup_cache, i, map);
+      ASET (keymap_lookup_cache, i + 1, idx);
+      ASET (keymap_lookup_cache, i + 2, stamp);
+      ASET (keymap_lookup_cache, i + 3, val);
+    }
+  keymap_filter_called |= filter_called;
+  return val;
+}
+
 Lisp_Object
 access_keymap (Lisp_Object map, Lisp_Object idx,
 	       bool t_ok, bool noinherit, bool autoload)
 {
-  Lisp_Object val = access_keymap_1 (map, idx, t_ok, noinherit, autoload);
+  Lisp_Object val = access_keymap_cached (map, idx, t_ok, noinherit, autoload);
   return BASE_EQ (val, Qunbound) ? Qnil : val;
 }
 
@@ -708,6 +792,7 @@ get_keyelt (Lisp_Object object, bool autoload)
 		    filter = XCAR (XCDR (tem));
 		    filter = list2 (filter, list2 (Qquote, object));
 		    object = menu_item_eval_property (filter);
+		    keymap_filter_called = true;
 		    break;
 		  }
 	    }
@@ -733,7 +818,7 @@ store_in_keymap (Lisp_Object keymap, register Lisp_Object idx,
 {
   /* Flush any reverse-map cache.  */
   where_is_cache = Qnil;
-  where_is_cache_keymaps = Qt;
+  flush_keymap_lookup_cache ();
 
   if (EQ (idx, Qkeymap))
     error ("`keymap' is reserved for embedded parent maps");
@@ -2491,6 +2576,8 @@ shadow_lookup (Lisp_Object keymap, Lisp_Object key, Lisp_Object accept_default,
   Lisp_Object definition, this, last;
   bool last_is_meta, noindirect;
   Lisp_Object sequences;
+  /* If not nil, the hash table of a reverse-map being filled.  */
+  Lisp_Object cache;
 };
 
 /* This function can't GC, AFAIK.  */
@@ -2506,29 +2593,35 @@ where_is_internal (Lisp_Object definition, Lisp_Object keymaps,
 {
   Lisp_Object maps = Qnil;
   struct where_is_internal_data data;
+  Lisp_Object flags = make_fixnum ((noindirect << 1) | nomenus);
 
-  /* Only important use of caching is for the menubar
-     (i.e. where-is-internal called with (def nil t nil nil)).  */
-  if (nomenus && !noindirect)
+  /* Bindings to a cons are compared with `equal', which the cache
+     can't do, so look for those the slow way.  */
+  data.cache = Qnil;
+  if (!CONSP (definition))
     {
-      /* Check heuristic-consistency of the cache.  */
-      if (NILP (Fequal (keymaps, where_is_cache_keymaps)))
-	where_is_cache = Qnil;
-
-      if (NILP (where_is_cache))
+      Lisp_Object prev = Qnil;
+      for (Lisp_Object tail = where_is_cache; CONSP (tail);
+	   prev = tail, tail = XCDR (tail))
 	{
-	  /* We need to create the cache.  */
-	  where_is_cache = Fmake_hash_table (0, NULL);
-	  where_is_cache_keymaps = Qt;
+	  Lisp_Object entry = XCAR (tail);
+	  if (EQ (AREF (entry, 1), flags)
+	      && !NILP (Fequal (AREF (entry, 0), keymaps)))
+	    {
+	      /* Move the entry to the front of the list.  */
+	      if (!NILP (prev))
+		{
+		  XSETCDR (prev, XCDR (tail));
+		  XSETCDR (tail, where_is_cache);
+		  where_is_cache = tail;
+		}
+	      return Fgethash (definition, AREF (entry, 2), Qnil);
+	    }
 	}
-      else
-	/* We can reuse the cache.  */
-	return Fgethash (definition, where_is_cache, Qnil);
+
+      /* Build a new reverse-map for KEYMAPS.  */
+      data.cache = Fmake_hash_table (0, NULL);
     }
-  else
-    /* Kill the cache so that where_is_internal_1 doesn't think
-       we're filling it up.  */
-    where_is_cache = Qnil;
 
   Lisp_Object found = keymaps;
   while (CONSP (found))
@@ -2578,14 +2671,20 @@ where_is_internal (Lisp_Object definition, Lisp_Object keymaps,
 	map_keymap (map, where_is_internal_1, Qnil, &data, 0);
     }
 
-  if (nomenus && !noindirect)
-    { /* Remember for which keymaps this cache was built.
-	 We do it here (late) because we want to keep where_is_cache_keymaps
-	 set to t while the cache isn't fully filled.  */
-      where_is_cache_keymaps = keymaps;
+  if (!NILP (data.cache))
+    {
+      /* Remember the reverse-map, forgetting the least recently used
+	 one if there are too many.  We do it here (late) so that an
+	 incomplete one is never used.  */
+      where_is_cache = Fcons (CALLN (Fvector, keymaps, flags, data.cache),
+			      where_is_cache);
+      Lisp_Object last = Fnthcdr (make_fixnum (WHERE_IS_CACHE_SIZE - 1),
+				  where_is_cache);
+      if (CONSP (last))
+	XSETCDR (last, Qnil);
       /* During cache-filling, data.sequences is not filled by
 	 where_is_internal_1.  */
-      return Fgethash (definition, where_is_cache, Qnil);
+      return Fgethash (definition, data.cache, Qnil);
     }
   else
     return data.sequences;
@@ -2809,7 +2908,7 @@ where_is_internal_1 (Lisp_Object key, Lisp_Object binding, Lisp_Object args, voi
   /* End this iteration if this element does not match
      the target.  */
 
-  if (!(!NILP (where_is_cache)	/* everything "matches" during cache-fill.  */
+  if (!(!NILP (d->cache)	/* everything "matches" during cache-fill.  */
 	|| EQ (binding, definition)
 	|| (CONSP (definition) && !NILP (Fequal (binding, definition)))))
     /* Doesn't match.  */
@@ -2828,10 +2927,10 @@ where_is_internal_1 (Lisp_Object key, Lisp_Object binding, Lisp_Object args, voi
       sequence = append_key (this, key);
     }
 
-  if (!NILP (where_is_cache))
+  if (!NILP (d->cache))
     {
-      Lisp_Object sequences = Fgethash (binding, where_is_cache, Qnil);
-      Fputhash (binding, Fcons (sequence, sequences), where_is_cache);
+      Lisp_Object sequences = Fgethash (binding, d->cache, Qnil);
+      Fputhash (binding, Fcons (sequence, sequences), d->cache);
     }
   else
     d->sequences = Fcons (sequence, d->sequences);
@@ -3445,10 +3544,10 @@ syms_of_keymap (void)
   command_remapping_vector = make_vector (2, Qremap);
   staticpro (&command_remapping_vector);
 
-  where_is_cache_keymaps = Qt;
   where_is_cache = Qnil;
   staticpro (&where_is_cache);
-  staticpro (&where_is_cache_keymaps);
+  keymap_lookup_cache = Qnil;
+  staticpro (&keymap_lookup_cache);
 
   DEFSYM (Qfont_lock_face, "font-lock-face");
   DEFSYM (Qhelp_key_binding, "help-key-binding");
@@ -91,6 +91,7 @@ kqueue_generate_event (Lisp_Object watch_object, Lisp_Object actions,
 
   /* Store it into the input event queue.  */
   if (! NILP (actions)) {
+    file_attribute_cache_flush ();
     EVENT_INIT (event);
     event.kind = FILE_NOTIFY_EVENT;
     event.frame_or_window = Qnil;
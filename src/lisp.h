@@ -792,6 +792,10 @@ #define XUNTAG(a, type, ctype) \
   SYMBOL_TRAPPED_WRITE     /* trap the write, call watcher functions */
 };
 
+/* The type of a hash value stored in a hash table or in a symbol.
+   It's unsigned and a subtype of EMACS_UINT.  */
+typedef unsigned int hash_hash_t;
+
 struct Lisp_Symbol
 {
   union
@@ -812,6 +816,11 @@ #define XUNTAG(a, type, ctype) \
 	 special (with `defvar' etc), and shouldn't be lexically bound.  */
       bool_bf declared_special : 1;
 
+      /* Hash code of the name, used to find the symbol in its obarray
+	 without looking at the name.  Valid only if the symbol is
+	 interned.  */
+      hash_hash_t name_hash;
+
       /* The symbol's name, as a Lisp string.  */
       Lisp_Object name;
 
@@ -1013,12 +1022,15 @@ DEFINE_GDB_SYMBOL_END (PSEUDOVECTOR_FLAG)
   PVEC_THREAD,
   PVEC_MUTEX,
   PVEC_CONDVAR,
+  PVEC_CHANNEL,
   PVEC_MODULE_FUNCTION,
   PVEC_NATIVE_COMP_UNIT,
   PVEC_TS_PARSER,
   PVEC_TS_NODE,
   PVEC_TS_COMPILED_QUERY,
   PVEC_SQLITE,
+  PVEC_JSON_PARSER,
+  PVEC_REGION_CACHE,
 
   /* These should be last, for internal_equal and sxhash_obj.  */
   PVEC_CLOSURE,
@@ -1398,6 +1410,7 @@ #define XSETSUB_CHAR_TABLE(a, b) XSETPSEUDOVECTOR (a, b, PVEC_SUB_CHAR_TABLE)
 #define XSETTHREAD(a, b) XSETPSEUDOVECTOR (a, b, PVEC_THREAD)
 #define XSETMUTEX(a, b) XSETPSEUDOVECTOR (a, b, PVEC_MUTEX)
 #define XSETCONDVAR(a, b) XSETPSEUDOVECTOR (a, b, PVEC_CONDVAR)
+#define XSETCHANNEL(a, b) XSETPSEUDOVECTOR (a, b, PVEC_CHANNEL)
 #define XSETNATIVE_COMP_UNIT(a, b) XSETPSEUDOVECTOR (a, b, PVEC_NATIVE_COMP_UNIT)
 
 /* Efficiently convert a pointer to a Lisp object and back.  The
@@ -2159,13 +2172,33 @@ CHAR_TABLE_REF (Lisp_Object ct, int idx)
 	  : char_table_ref (ct, idx));
 }
 
+/* Defined in chartab.c.  Incremented whenever a slot that can affect
+   lookups in any char-table changes.  */
+extern EMACS_UINT char_table_modiff;
+extern int char_table_flat_used;
+extern void char_table_flat_invalidate (Lisp_Object);
+
+/* Record that lookups in the char-table TABLE may now give different
+   results.  */
+
+INLINE void
+note_char_table_change (Lisp_Object table)
+{
+  char_table_modiff++;
+  if (char_table_flat_used)
+    char_table_flat_invalidate (table);
+}
+
 /* Equivalent to Faset (CT, IDX, VAL) with optimization for ASCII and
    8-bit European characters.  Does not check validity of CT.  */
 INLINE void
 CHAR_TABLE_SET (Lisp_Object ct, int idx, Lisp_Object val)
 {
   if (ASCII_CHAR_P (idx) && SUB_CHAR_TABLE_P (XCHAR_TABLE (ct)->ascii))
-    set_sub_char_table_contents (XCHAR_TABLE (ct)->ascii, idx, val);
+    {
+      note_char_table_change (ct);
+      set_sub_char_table_contents (XCHAR_TABLE (ct)->ascii, idx, val);
+    }
   else
     char_table_set (ct, idx, val);
 }
@@ -2519,10 +2552,6 @@ #define DOOBARRAY(oa, it)					\
 
 struct Lisp_Hash_Table;
 
-/* The type of a hash value stored in the table.
-   It's unsigned and a subtype of EMACS_UINT.  */
-typedef unsigned int hash_hash_t;
-
 typedef enum hash_table_std_test_t {
   Test_eql,
   Test_eq,
@@ -2563,6 +2592,16 @@ #define DOOBARRAY(oa, it)					\
    (hash) indices.  It's signed and a subtype of ptrdiff_t.  */
 typedef int32_t hash_idx_t;
 
+/* The hash code of a hash table entry, and the index of the entry
+   after it in its collision chain or in the free list.  Keeping both
+   together means that walking a chain and comparing hash codes
+   touches a single cache line per entry.  */
+struct hash_table_link
+{
+  hash_hash_t hash;
+  hash_idx_t next;
+};
+
 struct Lisp_Hash_Table
 {
   union vectorlike_header header;
@@ -2589,8 +2628,9 @@ #define DOOBARRAY(oa, it)					\
                                |
                            next_free
 
-     The table is physically split into three vectors (hash, next,
-     key_and_value) which may or may not be beneficial.  */
+     The table is physically split into two vectors, hash_and_next and
+     key_and_value, so that collision chains can be followed and hash
+     codes compared without loading keys or values.  */
 
   /* Bucket vector.  An entry of -1 indicates no item is present,
      and a nonnegative entry is the index of the first item in
@@ -2601,9 +2641,13 @@ #define DOOBARRAY(oa, it)					\
      Otherwise it is heap-allocated.  */
   hash_idx_t *index;
 
-  /* Vector of hash codes.  Unused entries have undefined values.
+  /* Vector of hash codes and chain links.  The hash code of an
+     unused entry has an undefined value.  If entry I is free,
+     hash_and_next[I].next is the entry number of the next free item.
+     If entry I is non-free, hash_and_next[I].next is the index of the
+     next entry in the collision chain, or -1 if there is no such entry.
      This vector is table_size entries long.  */
-  hash_hash_t *hash;
+  struct hash_table_link *hash_and_next;
 
   /* Vector of keys and values.  The key of item I is found at index
      2 * I, the value is found at index 2 * I + 1.
@@ -2615,13 +2659,6 @@ #define DOOBARRAY(oa, it)					\
   /* The comparison and hash functions.  */
   const struct hash_table_test *test;
 
-  /* Vector used to chain entries.  If entry I is free, next[I] is the
-     entry number of the next free item.  If entry I is non-free,
-     next[I] is the index of the next entry in the collision chain,
-     or -1 if there is no such entry.
-     This vector is table_size entries long.  */
-  hash_idx_t *next;
-
   /* Number of key/value entries in the table.  */
   hash_idx_t count;
 
@@ -2705,7 +2742,7 @@ HASH_VALUE (const struct Lisp_Hash_Table *h, ptrdiff_t idx)
 HASH_HASH (const struct Lisp_Hash_Table *h, ptrdiff_t idx)
 {
   eassert (idx >= 0 && idx < h->table_size);
-  return h->hash[idx];
+  return h->hash_and_next[idx].hash;
 }
 
 /* Value is the size of hash table H.  */
@@ -2840,12 +2877,13 @@ knuth_hash (hash_hash_t hash, unsigned bits)
      does not point anywhere.  */
 
   /* For markers that point somewhere,
-     this is used to chain of all the markers in a given buffer.
+     these are used to chain of all the markers in a given buffer.
      The chain does not preserve markers from garbage collection;
-     instead, markers are removed from the chain when freed by GC.  */
-  /* We could remove it and use an array in buffer_text instead.
+     instead, markers are removed from the chain when freed by GC.
+     PREV is NULL for the first marker of the chain.  */
+  /* We could remove them and use an array in buffer_text instead.
      That would also allow us to preserve it ordered.  */
-  struct Lisp_Marker *next;
+  struct Lisp_Marker *next, *prev;
   /* This is the char position where the marker points.  */
   ptrdiff_t charpos;
   /* This is the byte position.
@@ -2921,11 +2959,75 @@ xmint_pointer (Lisp_Object a)
   void *db;
   void *stmt;
   char *name;
+  /* The statements prepared for a database, see sqlite.c.  */
+  struct sqlite_statement_cache *statements;
+  /* The thread that runs asynchronous queries for a database.  */
+  struct sqlite_worker *worker;
   void (*finalizer) (void *);
   bool eof;
   bool is_statement;
 } GCALIGNED_STRUCT;
 
+/* An incremental JSON parser, which is fed text in pieces and finds
+   where each top-level value ends.  See json.c.  */
+struct Lisp_JSON_Parser
+{
+  union vectorlike_header header;
+
+  /* The objects that represent JSON null and false.  */
+  Lisp_Object null_object;
+  Lisp_Object false_object;
+
+  /* Values that have been parsed but not returned yet, most recent
+     first.  */
+  Lisp_Object values;
+
+  /* The remaining fields are not visible to GC.  */
+
+  /* How JSON objects and arrays are represented.  */
+  int object_type;
+  int array_type;
+
+  /* True if each value is preceded by headers with its length.  */
+  bool content_length_framing;
+
+  /* The text fed so far, of which the first START bytes have been
+     parsed.  */
+  unsigned char *input;
+  ptrdiff_t input_size;
+  ptrdiff_t input_bytes;
+  ptrdiff_t start;
+
+  /* The state of the search for the end of the next value.  SCANNED
+     is how far the input has been looked at, VALUE_START is where the
+     value begins or -1 if it has not begun yet, and VALUE_BYTES is the
+     length of a framed value or -1 if it is not known yet.  */
+  ptrdiff_t scanned;
+  ptrdiff_t value_start;
+  ptrdiff_t value_bytes;
+  ptrdiff_t depth;
+  bool in_string;
+  bool in_escape;
+  bool in_scalar;
+} GCALIGNED_STRUCT;
+
+/* A region cache made by `make-region-cache', which records which
+   stretches of a buffer's text Lisp code knows something about and
+   forgets them when that text changes.  See region-cache.c.  */
+struct Lisp_Region_Cache
+{
+  union vectorlike_header header;
+
+  /* The buffer whose text the cache describes.  */
+  Lisp_Object buffer;
+
+  /* The remaining fields are not visible to GC.  */
+  struct region_cache *cache;
+
+  /* The next live region cache, for invalidating them on edits.  */
+  struct Lisp_Region_Cache *next;
+} GCALIGNED_STRUCT;
+
 struct Lisp_User_Ptr
 {
   union vectorlike_header header;
@@ -3028,6 +3130,44 @@ XSQLITE (Lisp_Object a)
   return XUNTAG (a, Lisp_Vectorlike, struct Lisp_Sqlite);
 }
 
+INLINE bool
+JSON_PARSERP (Lisp_Object x)
+{
+  return PSEUDOVECTORP (x, PVEC_JSON_PARSER);
+}
+
+INLINE void
+CHECK_JSON_PARSER (Lisp_Object x)
+{
+  CHECK_TYPE (JSON_PARSERP (x), Qjson_parser_p, x);
+}
+
+INLINE struct Lisp_JSON_Parser *
+XJSON_PARSER (Lisp_Object a)
+{
+  eassert (JSON_PARSERP (a));
+  return XUNTAG (a, Lisp_Vectorlike, struct Lisp_JSON_Parser);
+}
+
+INLINE bool
+REGION_CACHEP (Lisp_Object x)
+{
+  return PSEUDOVECTORP (x, PVEC_REGION_CACHE);
+}
+
+INLINE void
+CHECK_REGION_CACHE (Lisp_Object x)
+{
+  CHECK_TYPE (REGION_CACHEP (x), Qregion_cache_p, x);
+}
+
+INLINE struct Lisp_Region_Cache *
+XREGION_CACHE (Lisp_Object a)
+{
+  eassert (REGION_CACHEP (a));
+  return XUNTAG (a, Lisp_Vectorlike, struct Lisp_Region_Cache);
+}
+
 INLINE bool
 BIGNUMP (Lisp_Object x)
 {
@@ -3870,6 +4010,11 @@ record_in_backtrace (Lisp_Object function, Lisp_Object *args, ptrdiff_t nargs)
   Lisp_Object *bytecode_top;
   int bytecode_dest;
 
+  /* If non-null, where to longjmp to instead of JMP.  The bytecode
+     interpreter points the handlers it pushes to a single jmp_buf,
+     so that it need not call setjmp for each of them.  */
+  sys_jmp_buf *bytecode_jmp;
+
   /* Most global vars are reset to their value via the specpdl mechanism,
      but a few others are handled by storing their value here.  */
   sys_jmp_buf jmp;
@@ -3878,6 +4023,7 @@ record_in_backtrace (Lisp_Object function, Lisp_Object *args, ptrdiff_t nargs)
   struct bc_frame *act_rec;
   int poll_suppress_count;
   int interrupt_input_blocked;
+  int f_profiler_wait;
 
 #ifdef HAVE_X_WINDOWS
   int x_error_handler_depth;
@@ -4065,6 +4211,7 @@ set_string_intervals (Lisp_Object s, INTERVAL i)
 INLINE void
 set_char_table_defalt (Lisp_Object table, Lisp_Object val)
 {
+  note_char_table_change (table);
   XCHAR_TABLE (table)->defalt = val;
 }
 INLINE void
@@ -4086,12 +4233,14 @@ set_char_table_extras (Lisp_Object table, ptrdiff_t idx, Lisp_Object val)
 set_char_table_contents (Lisp_Object table, ptrdiff_t idx, Lisp_Object val)
 {
   eassert (0 <= idx && idx < (1 << CHARTAB_SIZE_BITS_0));
+  note_char_table_change (table);
   XCHAR_TABLE (table)->contents[idx] = val;
 }
 
 INLINE void
 set_sub_char_table_contents (Lisp_Object table, ptrdiff_t idx, Lisp_Object val)
 {
+  char_table_modiff++;
   XSUB_CHAR_TABLE (table)->contents[idx] = val;
 }
 
@@ -4104,6 +4253,7 @@ set_sub_char_table_contents (Lisp_Object table, ptrdiff_t idx, Lisp_Object val)
 extern Lisp_Object bignum_to_string (Lisp_Object, int);
 extern Lisp_Object make_bignum_str (char const *, int);
 extern Lisp_Object make_neg_biguint (uintmax_t);
+extern void clear_bignum_cache (void);
 extern Lisp_Object double_to_integer (double);
 
 /* Convert the integer NUM to *N.  Return true if successful, false
@@ -4210,6 +4360,7 @@ #define CONS_TO_INTEGER(cons, type, var)				\
 extern AVOID circular_list (Lisp_Object);
 extern KBOARD *kboard_for_bindings (void);
 extern Lisp_Object do_symval_forwarding (lispfwd);
+extern void store_symval_forwarding (lispfwd, Lisp_Object, struct buffer *);
 enum Set_Internal_Bind
   {
     SET_INTERNAL_SET,
@@ -4224,6 +4375,7 @@ #define CONS_TO_INTEGER(cons, type, var)				\
 extern Lisp_Object expt_integer (Lisp_Object, Lisp_Object);
 extern void syms_of_data (void);
 extern void swap_in_global_binding (struct Lisp_Symbol *);
+extern void swap_in_symval_binding (struct Lisp_Symbol *, Lisp_Object);
 
 /* Defined in cmds.c */
 extern void syms_of_cmds (void);
@@ -4250,6 +4402,7 @@ #define CONS_TO_INTEGER(cons, type, var)				\
 struct charset;
 
 /* Defined in syntax.c.  */
+extern void invalidate_syntax_checkpoints (struct buffer *, ptrdiff_t);
 extern void init_syntax_once (void);
 extern void syms_of_syntax (void);
 
@@ -4258,9 +4411,15 @@ #define CONS_TO_INTEGER(cons, type, var)				\
 extern ptrdiff_t list_length (Lisp_Object);
 extern EMACS_INT next_almost_prime (EMACS_INT) ATTRIBUTE_CONST;
 extern Lisp_Object larger_vector (Lisp_Object, ptrdiff_t, ptrdiff_t);
-extern bool sweep_weak_table (struct Lisp_Hash_Table *, bool);
+extern int string_cmp (Lisp_Object, Lisp_Object);
+extern ptrdiff_t mark_weak_table (struct Lisp_Hash_Table *, hash_idx_t *,
+				 ptrdiff_t, bool *);
+extern void sweep_weak_table (struct Lisp_Hash_Table *, hash_idx_t const *,
+			      ptrdiff_t);
 extern void hexbuf_digest (char *, void const *, int);
 extern char *extract_data_from_object (Lisp_Object, ptrdiff_t *, ptrdiff_t *);
+extern ptrdiff_t base64_decode_1 (const char *, char *, ptrdiff_t, bool,
+				  bool, bool, ptrdiff_t *);
 EMACS_UINT hash_string (char const *, ptrdiff_t);
 EMACS_UINT sxhash (Lisp_Object);
 Lisp_Object make_hash_table (const struct hash_table_test *, EMACS_INT,
@@ -4330,6 +4489,10 @@ static_assert (FLT_RADIX == 2 || FLT_RADIX == 16);
 /* Defined in json.c.  */
 extern void syms_of_json (void);
 
+/* Defined in region-cache.c.  */
+extern void free_lisp_region_cache (struct Lisp_Region_Cache *);
+extern void syms_of_region_cache (void);
+
 /* Defined in insdel.c.  */
 extern void move_gap_both (ptrdiff_t, ptrdiff_t);
 extern AVOID buffer_overflow (void);
@@ -4369,10 +4532,13 @@ static_assert (FLT_RADIX == 2 || FLT_RADIX == 16);
 extern void prepare_to_modify_buffer_1 (ptrdiff_t, ptrdiff_t, ptrdiff_t *);
 extern void invalidate_buffer_caches (struct buffer *, ptrdiff_t, ptrdiff_t);
 extern void signal_after_change (ptrdiff_t, ptrdiff_t, ptrdiff_t);
+extern specpdl_ref begin_combined_change (ptrdiff_t, ptrdiff_t);
+extern void finish_combined_change (specpdl_ref, ptrdiff_t, ptrdiff_t,
+				    ptrdiff_t);
 extern void adjust_after_insert (ptrdiff_t, ptrdiff_t, ptrdiff_t,
 				 ptrdiff_t, ptrdiff_t);
 extern void adjust_markers_for_delete (ptrdiff_t, ptrdiff_t,
-				       ptrdiff_t, ptrdiff_t);
+				       ptrdiff_t, ptrdiff_t, bool);
 extern void adjust_markers_for_insert (ptrdiff_t, ptrdiff_t,
 				       ptrdiff_t, ptrdiff_t, bool);
 extern void adjust_markers_bytepos (ptrdiff_t, ptrdiff_t,
@@ -4486,6 +4652,7 @@ flush_stack_call_func (void (*func) (void *arg), void *arg)
 
 extern void garbage_collect (void);
 extern void maybe_garbage_collect (void);
+extern bool gc_eagerly_due_p (EMACS_INT factor);
 extern bool maybe_garbage_collect_eagerly (EMACS_INT factor);
 extern const char *pending_malloc_warning;
 extern Lisp_Object zero_vector;
@@ -4500,6 +4667,8 @@ flush_stack_call_func (void (*func) (void *arg), void *arg)
 extern Lisp_Object list5 (Lisp_Object, Lisp_Object, Lisp_Object, Lisp_Object,
 			  Lisp_Object);
 extern Lisp_Object listn (ptrdiff_t, Lisp_Object, ...);
+extern Lisp_Object list_from_array (ptrdiff_t, Lisp_Object const *,
+				    Lisp_Object);
 #define list(...) \
   listn (ARRAYELTS (((Lisp_Object []) {__VA_ARGS__})), __VA_ARGS__)
 
@@ -4707,6 +4876,70 @@ #define ALLOCATE_ZEROED_PSEUDOVECTOR(type, field, tag)		       \
 extern Lisp_Object get_unicode_property (Lisp_Object, int);
 extern void syms_of_chartab (void);
 
+/* The binary representation of objects, which `print--binary' prints
+   and which the reader reads after "#%" and its length in base 64.
+   `serialize' and `deserialize' use it as is.
+
+   It is a version byte, BINARY_VERSION, then the number of symbols
+   and the symbols, then the number of shared objects, then the object.
+   Numbers are unsigned LEB128 varints.  Each symbol is a byte whose
+   BINARY_UNINTERNED and BINARY_MULTIBYTE bits tell how to make it,
+   then its name: the number of characters of a multibyte name only,
+   the number of bytes, and the bytes.  Each object is one of the tags
+   below, followed by:
+
+   BINARY_SYMBOL: the index of the symbol in the symbol table.
+   BINARY_FIXNUM: the fixnum N as 2N if N >= 0, and -2N-1 otherwise.
+   BINARY_BIGNUM: the number of bytes in its decimal representation,
+     and the representation.
+   BINARY_FLOAT: the 8 bytes of the double, most significant first.
+   BINARY_UNIBYTE_STRING: the number of bytes, and the bytes.
+   BINARY_MULTIBYTE_STRING: the numbers of characters and bytes, and
+     the bytes.
+   BINARY_LIST: the number N > 0 of elements, the N elements, and the
+     last cdr.
+   BINARY_VECTOR, BINARY_RECORD, BINARY_CLOSURE: the number of
+     elements, and the elements.
+   BINARY_BOOL_VECTOR: the number of bits, and the bytes.
+   BINARY_LOAD_FILE_NAME: nothing; this is read as `#$'.
+   BINARY_DEFINITION: the index N of a shared object, and the object.
+   BINARY_REFERENCE: the index N of a shared object that was already
+     read, which stands for that object.
+   BINARY_HASH_TABLE: the name of the test and the weakness, as
+     objects, the number N of entries, and N keys each followed by its
+     value.  */
+enum binary_tag
+  {
+    BINARY_SYMBOL,
+    BINARY_FIXNUM,
+    BINARY_BIGNUM,
+    BINARY_FLOAT,
+    BINARY_UNIBYTE_STRING,
+    BINARY_MULTIBYTE_STRING,
+    BINARY_LIST,
+    BINARY_VECTOR,
+    BINARY_RECORD,
+    BINARY_CLOSURE,
+    BINARY_BOOL_VECTOR,
+    BINARY_LOAD_FILE_NAME,
+    BINARY_DEFINITION,
+    BINARY_REFERENCE,
+    BINARY_HASH_TABLE,
+  };
+enum
+  {
+    BINARY_VERSION = 1,
+    BINARY_UNINTERNED = 1,
+    BINARY_MULTIBYTE = 2,
+    /* The maximum nesting depth of an object, so that neither printing
+       nor reading can overflow the C stack.  */
+    BINARY_MAX_DEPTH = 1000
+  };
+
+/* Defined in floatconv.c.  */
+extern int double_to_string (char *, size_t, double);
+extern double string_to_double (char const *, char **);
+
 /* Defined in print.c.  */
 extern Lisp_Object Vprin1_to_string_buffer;
 extern void debug_print (Lisp_Object) EXTERNALLY_VISIBLE;
@@ -4963,6 +5196,10 @@ XMODULE_FUNCTION (Lisp_Object o)
 extern ptrdiff_t marker_position (Lisp_Object);
 extern ptrdiff_t marker_byte_position (Lisp_Object);
 extern void clear_charpos_cache (struct buffer *);
+extern void adjust_bytechar_index (struct buffer *, ptrdiff_t, ptrdiff_t,
+				   ptrdiff_t, ptrdiff_t, ptrdiff_t);
+extern void invalidate_bytechar_index (struct buffer *, ptrdiff_t, ptrdiff_t);
+extern void free_bytechar_index (struct buffer *);
 extern ptrdiff_t buf_charpos_to_bytepos (struct buffer *, ptrdiff_t);
 extern ptrdiff_t buf_bytepos_to_charpos (struct buffer *, ptrdiff_t);
 extern void detach_marker (Lisp_Object);
@@ -4999,11 +5236,33 @@ XMODULE_FUNCTION (Lisp_Object o)
 extern bool file_directory_p (Lisp_Object);
 extern bool file_accessible_directory_p (Lisp_Object);
 extern Lisp_Object buffer_visited_file_modtime (struct buffer *);
+enum file_attribute_cache_slot
+  {
+    FILE_ATTRIBUTE_CACHE_ATTRIBUTES,
+    FILE_ATTRIBUTE_CACHE_ATTRIBUTES_STRING,
+    FILE_ATTRIBUTE_CACHE_EXISTS,
+    FILE_ATTRIBUTE_CACHE_READABLE,
+    FILE_ATTRIBUTE_CACHE_EXECUTABLE,
+    FILE_ATTRIBUTE_CACHE_SLOTS
+  };
+extern bool file_attribute_cache_lookup (Lisp_Object,
+					 enum file_attribute_cache_slot,
+					 Lisp_Object *);
+extern void file_attribute_cache_store (Lisp_Object,
+					enum file_attribute_cache_slot,
+					Lisp_Object);
+extern void file_attribute_cache_flush (void);
 extern void init_fileio (void);
 extern void syms_of_fileio (void);
 
 /* Defined in search.c.  */
 extern void shrink_regexp_cache (void);
+extern void mark_regexp_cache (void);
+extern ptrdiff_t count_newlines (ptrdiff_t, ptrdiff_t);
+extern void invalidate_line_index (struct buffer *, ptrdiff_t, ptrdiff_t);
+extern void adjust_line_index (struct buffer *, ptrdiff_t, ptrdiff_t,
+			       ptrdiff_t);
+extern void free_line_index (struct buffer *);
 extern void restore_search_regs (void);
 extern void update_search_regs (ptrdiff_t oldstart,
                                 ptrdiff_t oldend, ptrdiff_t newend);
@@ -5153,6 +5412,9 @@ fast_c_string_match_ignore_case (Lisp_Object regexp,
 void synchronize_system_time_locale (void);
 extern char *emacs_strerror (int) ATTRIBUTE_RETURNS_NONNULL;
 extern void shut_down_emacs (int, Lisp_Object);
+extern intmax_t startup_profile_begin (const char *, const char *);
+extern void startup_profile_end (intmax_t);
+extern void startup_profile_finish (void);
 
 /* True means don't do interactive redisplay and don't change tty modes.  */
 extern bool noninteractive;
@@ -5258,7 +5520,8 @@ set_act_rec (struct thread_state *th, struct bc_frame *act_rec)
 /* Defined in undo.c.  */
 extern void truncate_undo_list (struct buffer *);
 extern void record_insert (ptrdiff_t, ptrdiff_t);
-extern void record_delete (ptrdiff_t, Lisp_Object, bool);
+extern void record_delete (ptrdiff_t, Lisp_Object);
+extern void record_marker_adjustment (struct Lisp_Marker *, ptrdiff_t);
 extern void record_first_change (void);
 extern void record_change (ptrdiff_t, ptrdiff_t);
 extern void record_property_change (ptrdiff_t, ptrdiff_t,
@@ -5343,6 +5606,10 @@ maybe_disable_address_randomization (int argc, char **argv)
 extern ptrdiff_t emacs_write (int, void const *, ptrdiff_t);
 extern ptrdiff_t emacs_write_sig (int, void const *, ptrdiff_t);
 extern ptrdiff_t emacs_write_quit (int, void const *, ptrdiff_t);
+#ifdef HAVE_WRITEV
+struct iovec;
+extern ptrdiff_t emacs_writev_sig (int, struct iovec *, int);
+#endif
 extern void emacs_perror (char const *);
 extern int renameat_noreplace (int, char const *, int, char const *);
 extern int str_collate (Lisp_Object, Lisp_Object, Lisp_Object, Lisp_Object);
@@ -5460,6 +5727,8 @@ maybe_disable_address_randomization (int argc, char **argv)
 
 /* Defined in decompress.c.  */
 extern int md5_gz_stream (FILE *, void *);
+extern Lisp_Object zlib_compress_bytes (const void *, ptrdiff_t);
+extern bool zlib_uncompress_bytes (const void *, ptrdiff_t, void *, ptrdiff_t);
 extern void syms_of_decompress (void);
 #endif
 
@@ -5472,6 +5741,16 @@ maybe_disable_address_randomization (int argc, char **argv)
 
 /* Defined in profiler.c.  */
 extern bool profiler_memory_running;
+
+/* What a thread is waiting for, as told by the wall-clock profiler.
+   The current thread's is profiler_wait.  */
+enum profiler_wait_reason
+  {
+    PROFILER_NOT_WAITING,
+    PROFILER_WAIT_INPUT,
+    PROFILER_WAIT_PROCESS,
+    PROFILER_WAIT_FILE
+  };
 extern void malloc_probe (size_t);
 extern void syms_of_profiler (void);
 extern void mark_profiler (void);
@@ -5513,6 +5792,18 @@ SUBR_TYPE (Lisp_Object a)
   return XSUBR (a)->type;
 }
 
+/* Defined in comp.c.  */
+extern void resolve_native_subr (struct Lisp_Subr *);
+
+/* Make sure the code of SUBR is there to be called.  The code of
+   native-compiled subrs is looked up on their first call.  */
+INLINE void
+maybe_resolve_native_subr (struct Lisp_Subr *subr)
+{
+  if (!subr->function.a0)
+    resolve_native_subr (subr);
+}
+
 INLINE struct Lisp_Native_Comp_Unit *
 allocate_native_comp_unit (void)
 {
@@ -5532,6 +5823,11 @@ NATIVE_COMP_FUNCTION_DYNP (Lisp_Object a)
   return false;
 }
 
+INLINE void
+maybe_resolve_native_subr (struct Lisp_Subr *subr)
+{
+}
+
 #endif
 
 /* Defined in lastfile.c.  */
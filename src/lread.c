@@ -44,6 +44,7 @@ #define DEFINE_SYMBOLS
 #include "termhooks.h"
 #include "blockinput.h"
 #include "pdumper.h"
+#include "probes.h"
 #include <c-ctype.h>
 #include <vla.h>
 
@@ -1409,6 +1410,7 @@ DEFUN ("load", Fload, Sload, 1, 5, 0,
 	    suffixes = CALLN (Fappend, suffixes, Vload_file_rep_suffixes);
 	}
 
+      intmax_t search_event = startup_profile_begin ("search", SSDATA (file));
 #if !defined USE_ANDROID_ASSETS
       fd = openp (Vload_path, file, suffixes, &found, Qnil,
 		  load_prefer_newer, no_native, NULL);
@@ -1422,6 +1424,7 @@ DEFUN ("load", Fload, Sload, 1, 5, 0,
       /* fd.asset will be non-NULL if this is actually an asset
 	 file.  */
 #endif
+      startup_profile_end (search_event);
     }
 
   if (lread_fd_cmp (-1))
@@ -1431,6 +1434,8 @@ DEFUN ("load", Fload, Sload, 1, 5, 0,
       return Qnil;
     }
 
+  EMACS_PROBE1 (load_start, SSDATA (found));
+
   /* Tell startup.el whether or not we found the user's init file.  */
   if (EQ (Qt, Vuser_init_file))
     Vuser_init_file = found;
@@ -1518,6 +1523,10 @@ DEFUN ("load", Fload, Sload, 1, 5, 0,
     Vloads_in_progress = Fcons (found, Vloads_in_progress);
   }
 
+  intmax_t load_event = startup_profile_begin ("load", SSDATA (found));
+  if (0 <= load_event)
+    record_unwind_protect_intmax (startup_profile_end, load_event);
+
   /* All loads are by default dynamic, unless the file itself specifies
      otherwise using a file-variable in the first line.  This is bound here
      so that it takes effect whether or not we use
@@ -1615,6 +1624,7 @@ DEFUN ("load", Fload, Sload, 1, 5, 0,
 	  val = calln (Vload_source_file_function, found, hist_file_name,
 		       NILP (noerror) ? Qnil : Qt,
 		       (NILP (nomessage) || force_load_messages) ? Qnil : Qt);
+	  EMACS_PROBE1 (load_done, SSDATA (found));
 	  return unbind_to (count, val);
 	}
     }
@@ -1769,6 +1779,7 @@ DEFUN ("load", Fload, Sload, 1, 5, 0,
 	message_with_string ("Loading %s...done", file, 1);
     }
 
+  EMACS_PROBE1 (load_done, SSDATA (found));
   return Qt;
 }
 
@@ -1913,6 +1924,15 @@ maybe_swap_for_eln (bool no_native, Lisp_Object *filename, int *fd,
 	return;
     }
 
+  /* Look in the shared cache.  The name of the .eln file there pins
+     down the contents of the source, so its time stamp doesn't
+     matter.  */
+  Lisp_Object shared_name = Fcomp_el_to_eln_shared_filename (src_name);
+  if (!NILP (shared_name)
+      && maybe_swap_for_eln1 (src_name, shared_name, filename, fd,
+			      make_timespec (0, 0)))
+    return;
+
   /* Look also in preloaded subfolder of the last entry in
      `comp-eln-load-path'.  */
   dir = Fexpand_file_name (build_string ("preloaded"),
@@ -1923,6 +1943,112 @@ maybe_swap_for_eln (bool no_native, Lisp_Object *filename, int *fd,
 #endif
 }
 
+/* A hash table mapping directory names to vectors [SEC NSEC NAMES
+   FOLD], used by openp when `load-path-cache' is non-nil, or nil.
+   SEC and NSEC are the modification time of the directory when it was
+   listed, and the keys of the hash table NAMES are the names of the
+   files that were in it then.  If FOLD is non-nil, the directory's
+   file names are case-insensitive, and NAMES holds them downcased.  */
+static Lisp_Object load_path_cache_table;
+
+/* Return the entry of load_path_cache_table for the directory DIR,
+   listing DIR again if it was modified since it was last listed.
+   Return t if no file can exist in DIR because it does not exist, and
+   nil if its listing can't be trusted.  */
+
+static Lisp_Object
+load_path_cache_entry (Lisp_Object dir)
+{
+  if (!NILP (Ffind_file_name_handler (dir, Qfile_exists_p)))
+    return Qnil;
+
+  struct stat st;
+  Lisp_Object encoded_dir = ENCODE_FILE (dir);
+  if (emacs_fstatat (AT_FDCWD, SSDATA (encoded_dir), &st, 0) != 0)
+    return errno == ENOENT || errno == ENOTDIR ? Qt : Qnil;
+  if (!S_ISDIR (st.st_mode))
+    return Qt;
+
+  struct timespec mtime = get_stat_mtime (&st);
+  Lisp_Object sec = INT_TO_INTEGER (mtime.tv_sec);
+  Lisp_Object nsec = make_fixnum (mtime.tv_nsec);
+
+  if (NILP (load_path_cache_table))
+    load_path_cache_table = make_hash_table (&hashtest_equal,
+					     DEFAULT_HASH_SIZE, Weak_None);
+  struct Lisp_Hash_Table *h = XHASH_TABLE (load_path_cache_table);
+  hash_hash_t hash;
+  ptrdiff_t i = hash_lookup_get_hash (h, dir, &hash);
+  if (i >= 0)
+    {
+      Lisp_Object entry = HASH_VALUE (h, i);
+      if (!NILP (Feql (AREF (entry, 0), sec)) && EQ (AREF (entry, 1), nsec))
+	return entry;
+    }
+
+  /* A file created in DIR within the same clock tick as its last
+     modification would leave its time stamp unchanged, so don't trust
+     the listing of a directory that was modified very recently.  */
+  if (current_timespec ().tv_sec - mtime.tv_sec < 2
+      || sys_faccessat (AT_FDCWD, SSDATA (encoded_dir), R_OK | X_OK,
+			AT_EACCESS) != 0)
+    return Qnil;
+
+  bool fold = !NILP (Ffile_name_case_insensitive_p (dir));
+  Lisp_Object files = Fdirectory_files (dir, Qnil, Qnil, Qt, Qnil);
+  Lisp_Object names = make_hash_table (&hashtest_equal, list_length (files),
+				       Weak_None);
+  struct Lisp_Hash_Table *nh = XHASH_TABLE (names);
+  for (; CONSP (files); files = XCDR (files))
+    {
+      Lisp_Object name = fold ? Fdowncase (XCAR (files)) : XCAR (files);
+      hash_hash_t name_hash;
+      if (hash_lookup_get_hash (nh, name, &name_hash) < 0)
+	hash_put (nh, name, Qt, name_hash);
+    }
+
+  Lisp_Object entry = CALLN (Fvector, sec, nsec, names, fold ? Qt : Qnil);
+  if (i >= 0)
+    set_hash_value_slot (h, i, entry);
+  else
+    hash_put (h, dir, entry, hash);
+  return entry;
+}
+
+/* Return true if NAME is a file name that openp can look up in the
+   listings of load_path_cache_table: a nonempty ASCII name with no
+   directory part, and that `expand-file-name' leaves alone.  */
+
+static bool
+load_path_cache_name_p (Lisp_Object name)
+{
+  if (SCHARS (name) == 0 || !string_ascii_p (name))
+    return false;
+  for (ptrdiff_t i = 0; i < SBYTES (name); i++)
+    {
+      unsigned char c = SREF (name, i);
+      if (IS_ANY_SEP (c) || c == '~')
+	return false;
+    }
+  return true;
+}
+
+/* Return true if ENTRY, the value of load_path_cache_entry for a
+   directory, shows that no file named NAME followed by SUFFIX is
+   in it.  */
+
+static bool
+load_path_cache_absent_p (Lisp_Object entry, Lisp_Object name,
+			  Lisp_Object suffix)
+{
+  if (!VECTORP (entry) || !string_ascii_p (suffix))
+    return false;
+  Lisp_Object file = concat2 (name, suffix);
+  if (!NILP (AREF (entry, 3)))
+    file = Fdowncase (file);
+  return hash_lookup (XHASH_TABLE (AREF (entry, 2)), file) < 0;
+}
+
 /* Search for a file whose name is STR, looking in directories
    in the Lisp list PATH, and trying suffixes from SUFFIX.
    On success, return a file descriptor (or 1 or -2 as described below).
@@ -1952,6 +2078,9 @@ maybe_swap_for_eln (bool no_native, Lisp_Object *filename, int *fd,
 
    If NO_NATIVE is true do not try to load native code.
 
+   If `load-path-cache' is non-nil, skip the files that the listings
+   cached in load_path_cache_table show not to exist.
+
    If PLATFORM is non-NULL and the file being loaded lies in a special
    directory, such as the Android `/assets' directory, return a handle
    to that directory in *PLATFORM instead of a file descriptor; in
@@ -1998,6 +2127,14 @@ openp (Lisp_Object path, Lisp_Object str, Lisp_Object suffixes,
 
   absolute = complete_filename_p (str);
 
+  /* Whether to look for STR in the cached directory listings.  A
+     predicate other than `file-readable-p' or `access' might accept
+     files that aren't there.  */
+  bool use_cache = (load_path_cache && !absolute
+		    && (NILP (predicate) || EQ (predicate, Qt)
+			|| FIXNATP (predicate))
+		    && load_path_cache_name_p (str));
+
   AUTO_LIST1 (just_use_str, Qnil);
   if (NILP (path))
     path = just_use_str;
@@ -2023,6 +2160,14 @@ openp (Lisp_Object path, Lisp_Object str, Lisp_Object suffixes,
 	  continue;
       }
 
+    Lisp_Object cache_entry = Qnil;
+    if (use_cache && !EQ (path, just_use_str))
+      {
+	cache_entry = load_path_cache_entry (Ffile_name_directory (filename));
+	if (EQ (cache_entry, Qt))
+	  continue;
+      }
+
     /* Calculate maximum length of any filename made from
        this path element/specified file name and any possible suffix.  */
     want_length = max_suffix_len + SBYTES (filename);
@@ -2049,6 +2194,12 @@ openp (Lisp_Object path, Lisp_Object str, Lisp_Object suffixes,
 	ptrdiff_t fnlen, lsuffix = SBYTES (suffix);
 	Lisp_Object handler;
 
+	/* Skip a file that isn't there, unless we need to return the
+	   newest file found for the previous suffixes.  */
+	if (load_path_cache_absent_p (cache_entry, str, suffix)
+	    && ! (0 <= save_fd && ! CONSP (XCDR (tail))))
+	  continue;
+
 	/* Make complete filename by appending SUFFIX.  */
 	memcpy (fn + baselen, SDATA (suffix), lsuffix + 1);
 	fnlen = baselen + lsuffix;
@@ -3437,10 +3588,11 @@ vector_from_rev_list (Lisp_Object elems)
 
 static Lisp_Object get_lazy_string (Lisp_Object val);
 
+/* Turn the vector OBJ, read as the contents of "#[...]", into
+   the closure it stands for.  */
 static Lisp_Object
-bytecode_from_rev_list (Lisp_Object elems, Lisp_Object readcharfun)
+bytecode_from_vector (Lisp_Object obj, Lisp_Object readcharfun)
 {
-  Lisp_Object obj = vector_from_rev_list (elems);
   Lisp_Object *vec = XVECTOR (obj)->contents;
   ptrdiff_t size = ASIZE (obj);
 
@@ -3506,6 +3658,388 @@ bytecode_from_rev_list (Lisp_Object elems, Lisp_Object readcharfun)
   return obj;
 }
 
+static Lisp_Object
+bytecode_from_rev_list (Lisp_Object elems, Lisp_Object readcharfun)
+{
+  return bytecode_from_vector (vector_from_rev_list (elems), readcharfun);
+}
+
+/* Reading objects in binary form, which `print--binary' and
+   `serialize' print.  See enum binary_tag in lisp.h for the format.  */
+
+struct binary_reader
+{
+  /* The binary data that remains to be read.  */
+  const unsigned char *p, *end;
+
+  /* The stream the data comes from, for error messages, or nil for
+     `deserialize'.  */
+  Lisp_Object readcharfun;
+
+  /* The vector of symbols, and the vector of shared objects read so
+     far.  */
+  Lisp_Object symbols;
+  Lisp_Object shared;
+};
+
+static AVOID
+binary_invalid (struct binary_reader *r)
+{
+  if (NILP (r->readcharfun))
+    error ("Invalid serialized data");
+  invalid_syntax ("#%", r->readcharfun);
+}
+
+static EMACS_UINT
+binary_read_uint (struct binary_reader *r)
+{
+  EMACS_UINT n = 0;
+  for (int shift = 0; ; shift += 7)
+    {
+      if (r->p == r->end || shift >= EMACS_UINT_WIDTH)
+	binary_invalid (r);
+      unsigned char c = *r->p++;
+      n |= (EMACS_UINT) (c & 0x7f) << shift;
+      if (! (c & 0x80))
+	return n;
+    }
+}
+
+/* Read the number of bytes or elements of an object.  Since each
+   takes at least a byte, reject a number that exceeds the bytes that
+   remain.  */
+
+static ptrdiff_t
+binary_read_count (struct binary_reader *r)
+{
+  EMACS_UINT n = binary_read_uint (r);
+  if (n > r->end - r->p)
+    binary_invalid (r);
+  return n;
+}
+
+/* Read a name or string of NCHARS characters and NBYTES bytes.  */
+
+static Lisp_Object
+binary_read_string (struct binary_reader *r, ptrdiff_t nchars,
+		    ptrdiff_t nbytes, bool multibyte)
+{
+  if (nbytes > r->end - r->p
+      || (multibyte
+	  && multibyte_chars_in_text (r->p, nbytes) != nchars))
+    binary_invalid (r);
+  Lisp_Object string = make_specified_string ((const char *) r->p, nchars,
+					      nbytes, multibyte);
+  r->p += nbytes;
+  return string;
+}
+
+
+static Lisp_Object
+binary_read_object (struct binary_reader *r, int depth)
+{
+  if (depth > BINARY_MAX_DEPTH || r->p == r->end)
+    binary_invalid (r);
+
+  switch (*r->p++)
+    {
+    case BINARY_SYMBOL:
+      {
+	EMACS_UINT i = binary_read_uint (r);
+	if (i >= ASIZE (r->symbols))
+	  binary_invalid (r);
+	return AREF (r->symbols, i);
+      }
+
+    case BINARY_FIXNUM:
+      {
+	EMACS_UINT n = binary_read_uint (r);
+	return make_int (n & 1 ? - (EMACS_INT) (n >> 1) - 1
+			 : (EMACS_INT) (n >> 1));
+      }
+
+    case BINARY_BIGNUM:
+      {
+	ptrdiff_t nbytes = binary_read_count (r);
+	Lisp_Object digits = binary_read_string (r, nbytes, nbytes, false);
+	ptrdiff_t len;
+	Lisp_Object n = string_to_number (SSDATA (digits), 10, &len);
+	if (!INTEGERP (n) || len != nbytes)
+	  binary_invalid (r);
+	return n;
+      }
+
+    case BINARY_FLOAT:
+      {
+	if (r->end - r->p < 8)
+	  binary_invalid (r);
+	union { double d; uint64_t u; } u = { .u = 0 };
+	for (int i = 0; i < 8; i++)
+	  u.u = (u.u << 8) | *r->p++;
+	return make_float (u.d);
+      }
+
+    case BINARY_UNIBYTE_STRING:
+      {
+	ptrdiff_t nbytes = binary_read_count (r);
+	return binary_read_string (r, nbytes, nbytes, false);
+      }
+
+    case BINARY_MULTIBYTE_STRING:
+      {
+	ptrdiff_t nchars = binary_read_count (r);
+	ptrdiff_t nbytes = binary_read_count (r);
+	return binary_read_string (r, nchars, nbytes, true);
+      }
+
+    case BINARY_LIST:
+      {
+	ptrdiff_t n = binary_read_count (r);
+	if (n == 0)
+	  binary_invalid (r);
+	Lisp_Object head = Fcons (binary_read_object (r, depth + 1), Qnil);
+	Lisp_Object tail = head;
+	for (ptrdiff_t i = 1; i < n; i++)
+	  {
+	    Lisp_Object cell = Fcons (binary_read_object (r, depth + 1), Qnil);
+	    XSETCDR (tail, cell);
+	    tail = cell;
+	  }
+	XSETCDR (tail, binary_read_object (r, depth + 1));
+
+	/* Convert (#$ . FIXNUM) like the textual reader does.  */
+	if (n == 1 && load_force_doc_strings
+	    && BASE_EQ (XCAR (head), Vload_file_name)
+	    && !NILP (XCAR (head))
+	    && FIXNUMP (XCDR (head)))
+	  return get_lazy_string (head);
+	return head;
+      }
+
+    case BINARY_VECTOR:
+    case BINARY_CLOSURE:
+      {
+	bool closure = r->p[-1] == BINARY_CLOSURE;
+	ptrdiff_t n = binary_read_count (r);
+	Lisp_Object v = make_nil_vector (n);
+	for (ptrdiff_t i = 0; i < n; i++)
+	  ASET (v, i, binary_read_object (r, depth + 1));
+	return closure ? bytecode_from_vector (v, r->readcharfun) : v;
+      }
+
+    case BINARY_RECORD:
+      {
+	ptrdiff_t n = binary_read_count (r);
+	if (n == 0)
+	  binary_invalid (r);
+	Lisp_Object type = binary_read_object (r, depth + 1);
+	Lisp_Object record = Fmake_record (type, make_fixnum (n - 1), Qnil);
+	for (ptrdiff_t i = 1; i < n; i++)
+	  ASET (record, i, binary_read_object (r, depth + 1));
+	return record;
+      }
+
+    case BINARY_BOOL_VECTOR:
+      {
+	EMACS_UINT nbits = binary_read_uint (r);
+	if (nbits > (EMACS_UINT) (r->end - r->p) * BOOL_VECTOR_BITS_PER_CHAR)
+	  binary_invalid (r);
+	ptrdiff_t nbytes = bool_vector_bytes (nbits);
+	if (nbytes > r->end - r->p)
+	  binary_invalid (r);
+	Lisp_Object v = make_uninit_bool_vector (nbits);
+	memcpy (bool_vector_uchar_data (v), r->p, nbytes);
+	r->p += nbytes;
+	return v;
+      }
+
+    case BINARY_LOAD_FILE_NAME:
+      return Vload_file_name;
+
+    case BINARY_DEFINITION:
+      {
+	EMACS_UINT i = binary_read_uint (r);
+	if (i >= ASIZE (r->shared))
+	  binary_invalid (r);
+	Lisp_Object obj = binary_read_object (r, depth + 1);
+	ASET (r->shared, i, obj);
+	return obj;
+      }
+
+    case BINARY_REFERENCE:
+      {
+	EMACS_UINT i = binary_read_uint (r);
+	if (i >= ASIZE (r->shared) || NILP (AREF (r->shared, i)))
+	  binary_invalid (r);
+	return AREF (r->shared, i);
+      }
+
+    case BINARY_HASH_TABLE:
+      {
+	Lisp_Object test = binary_read_object (r, depth + 1);
+	Lisp_Object weakness = binary_read_object (r, depth + 1);
+	/* Each entry takes at least two bytes.  */
+	ptrdiff_t n = binary_read_count (r);
+	if (!SYMBOLP (test) || !SYMBOLP (weakness) || n > (r->end - r->p) / 2)
+	  binary_invalid (r);
+	Lisp_Object table = CALLN (Fmake_hash_table, QCtest, test,
+				   QCweakness, weakness,
+				   QCsize, make_fixnum (n));
+	for (ptrdiff_t i = 0; i < n; i++)
+	  {
+	    Lisp_Object key = binary_read_object (r, depth + 1);
+	    Fputhash (key, binary_read_object (r, depth + 1), table);
+	  }
+	return table;
+      }
+
+    default:
+      binary_invalid (r);
+    }
+}
+
+static Lisp_Object read_binary_data (const unsigned char *, ptrdiff_t,
+				     Lisp_Object);
+
+/* Read an object in binary form preceded by "#%": the number N of
+   bytes of its base 64 encoding, a space, and the N bytes.  */
+
+static Lisp_Object
+read_binary_object (Lisp_Object readcharfun)
+{
+  ptrdiff_t len = 0;
+  int c;
+  while ((c = READCHAR) >= '0' && c <= '9')
+    if (ckd_mul (&len, len, 10) || ckd_add (&len, len, c - '0'))
+      invalid_syntax ("#%", readcharfun);
+  if (c != ' ')
+    invalid_syntax ("#%", readcharfun);
+
+  specpdl_ref count = SPECPDL_INDEX ();
+  char *text = xmalloc (len + 1);
+  record_unwind_protect_ptr (xfree, text);
+
+  ptrdiff_t i = 0;
+  if (FROM_FILE_P (readcharfun))
+    {
+      /* Read the bytes directly, as skip_lazy_string does.  */
+      for (; i < len && infile->lookahead > 0; i++)
+	text[i] = infile->buf[--infile->lookahead];
+      block_input ();
+      for (; i < len && (c = file_get_char (infile->stream)) >= 0; i++)
+	text[i] = c;
+      unblock_input ();
+    }
+  else if (BUFFERP (readcharfun) && BUFFER_LIVE_P (XBUFFER (readcharfun)))
+    {
+      /* Copy the bytes from the buffer, and move point past them.
+	 Since they are all ASCII, there are as many characters.  */
+      struct buffer *b = XBUFFER (readcharfun);
+      ptrdiff_t pt_byte = BUF_PT_BYTE (b);
+      if (len <= BUF_ZV_BYTE (b) - pt_byte)
+	for (; i < len && (c = BUF_FETCH_BYTE (b, pt_byte + i)) < 0x80; i++)
+	  text[i] = c;
+      SET_BUF_PT_BOTH (b, BUF_PT (b) + i, pt_byte + i);
+      readchar_offset += i;
+    }
+  else
+    for (; i < len && (c = READCHAR) >= 0 && c < 0x80; i++)
+      text[i] = c;
+  if (i < len)
+    invalid_syntax ("#%", readcharfun);
+
+  unsigned char *data = xmalloc (len + 1);
+  record_unwind_protect_ptr (xfree, data);
+  ptrdiff_t nchars;
+  ptrdiff_t nbytes = base64_decode_1 (text, (char *) data, len, false,
+				      false, false, &nchars);
+  if (nbytes < 0)
+    invalid_syntax ("#%", readcharfun);
+  return unbind_to (count, read_binary_data (data, nbytes, readcharfun));
+}
+
+/* Read an object from the NBYTES bytes of binary data at DATA, which
+   come from READCHARFUN, or from `deserialize' if it is nil.  DATA
+   must not be relocated by GC.  */
+
+static Lisp_Object
+read_binary_data (const unsigned char *data, ptrdiff_t nbytes,
+		  Lisp_Object readcharfun)
+{
+  struct binary_reader r = {
+    .p = data + 1,
+    .end = data + nbytes,
+    .readcharfun = readcharfun,
+  };
+  if (nbytes == 0 || data[0] != BINARY_VERSION)
+    binary_invalid (&r);
+
+  ptrdiff_t nsyms = binary_read_count (&r);
+  r.symbols = make_nil_vector (nsyms);
+  Lisp_Object obarray = check_obarray (Vobarray);
+  for (ptrdiff_t n = 0; n < nsyms; n++)
+    {
+      if (r.p == r.end)
+	binary_invalid (&r);
+      int kind = *r.p++;
+      bool multibyte = kind & BINARY_MULTIBYTE;
+      ptrdiff_t name_chars = multibyte ? binary_read_count (&r) : -1;
+      ptrdiff_t name_bytes = binary_read_count (&r);
+      if (!multibyte)
+	name_chars = name_bytes;
+      Lisp_Object sym;
+      if (kind & BINARY_UNINTERNED)
+	sym = Fmake_symbol (binary_read_string (&r, name_chars, name_bytes,
+						multibyte));
+      else
+	{
+	  /* Don't make a string for the name of a symbol that is
+	     already interned, like the textual reader.  */
+	  if (name_bytes > r.end - r.p
+	      || (multibyte
+		  && multibyte_chars_in_text (r.p, name_bytes) != name_chars))
+	    binary_invalid (&r);
+	  sym = oblookup (obarray, (const char *) r.p, name_chars, name_bytes);
+	  if (BARE_SYMBOL_P (sym))
+	    r.p += name_bytes;
+	  else
+	    sym = intern_driver (binary_read_string (&r, name_chars,
+						     name_bytes, multibyte),
+				 obarray, sym);
+	}
+      ASET (r.symbols, n, sym);
+    }
+
+  r.shared = make_nil_vector (binary_read_count (&r));
+  Lisp_Object obj = binary_read_object (&r, 0);
+  if (r.p != r.end)
+    binary_invalid (&r);
+  return obj;
+}
+
+DEFUN ("deserialize", Fdeserialize, Sdeserialize, 1, 1, 0,
+       doc: /* Return the object that `serialize' represented as STRING.
+STRING must be a string that `serialize' returned, possibly in another
+Emacs session.  It may also be a multibyte string of the same bytes,
+as raw bytes, such as the text that `insert-file-contents-literally'
+inserts in a multibyte buffer.  Symbols in it are interned in
+`obarray'.  */)
+  (Lisp_Object string)
+{
+  CHECK_STRING (string);
+  if (STRING_MULTIBYTE (string))
+    string = Fstring_to_unibyte (string);
+
+  /* Read from a copy, since reading can relocate the string data.  */
+  USE_SAFE_ALLOCA;
+  ptrdiff_t nbytes = SBYTES (string);
+  unsigned char *data = SAFE_ALLOCA (nbytes);
+  memcpy (data, SDATA (string), nbytes);
+  Lisp_Object obj = read_binary_data (data, nbytes, Qnil);
+  SAFE_FREE ();
+  return obj;
+}
+
 static Lisp_Object
 char_table_from_rev_list (Lisp_Object elems, Lisp_Object readcharfun)
 {
@@ -4190,6 +4724,11 @@ read0 (Lisp_Object readcharfun, bool locate_syms)
 	    obj = Vload_file_name;
 	    break;
 
+	  case '%':
+	    /* #%N BASE64 -- an object in binary form */
+	    obj = read_binary_object (readcharfun);
+	    break;
+
 	  case ':':
 	    /* #:X -- uninterned symbol */
 	    c = READCHAR;
@@ -4834,7 +5373,7 @@ string_to_number (char const *string, int base, ptrdiff_t *plen)
       /* Convert to floating point, unless the value is already known
 	 because it is infinite or a NaN.  */
       if (! value)
-	value = atof (string + signedp);
+	value = string_to_double (string + signedp, NULL);
       return make_float (negative ? -value : value);
     }
 
@@ -4876,6 +5415,15 @@ string_to_number (char const *string, int base, ptrdiff_t *plen)
 
 static Lisp_Object make_obarray (unsigned bits);
 
+/* Hash code in obarrays of the string STR of length SIZE_BYTE bytes.
+   It does not depend on the size of the obarray, so interned symbols
+   remember it in their name_hash field.  */
+static hash_hash_t
+obarray_hash (const char *str, ptrdiff_t size_byte)
+{
+  return reduce_emacs_uint_to_hash_hash (hash_string (str, size_byte));
+}
+
 /* Slow path obarray check: return the obarray to use or signal an error.  */
 Lisp_Object
 check_obarray_slow (Lisp_Object obarray)
@@ -4928,6 +5476,7 @@ intern_sym (Lisp_Object sym, Lisp_Object obarray, Lisp_Object index)
 
   struct Lisp_Obarray *o = XOBARRAY (obarray);
   Lisp_Object *ptr = o->buckets + XFIXNUM (index);
+  s->u.s.name_hash = obarray_hash (SSDATA (s->u.s.name), SBYTES (s->u.s.name));
   s->u.s.next = BARE_SYMBOL_P (*ptr) ? XBARE_SYMBOL (*ptr) : NULL;
   *ptr = sym;
   o->count++;
@@ -5161,13 +5710,6 @@ DEFUN ("unintern", Funintern, Sunintern, 2, 2, 0,
 }
 
 
-/* Bucket index of the string STR of length SIZE_BYTE bytes in obarray OA.  */
-static ptrdiff_t
-obarray_index (struct Lisp_Obarray *oa, const char *str, ptrdiff_t size_byte)
-{
-  EMACS_UINT hash = hash_string (str, size_byte);
-  return knuth_hash (reduce_emacs_uint_to_hash_hash (hash), oa->size_bits);
-}
 
 /* Return the symbol in OBARRAY whose names matches the string
    of SIZE characters (SIZE_BYTE bytes) at PTR.
@@ -5180,7 +5722,8 @@ obarray_index (struct Lisp_Obarray *oa, const char *str, ptrdiff_t size_byte)
 oblookup (Lisp_Object obarray, register const char *ptr, ptrdiff_t size, ptrdiff_t size_byte)
 {
   struct Lisp_Obarray *o = XOBARRAY (obarray);
-  ptrdiff_t idx = obarray_index (o, ptr, size_byte);
+  hash_hash_t hash = obarray_hash (ptr, size_byte);
+  ptrdiff_t idx = knuth_hash (hash, o->size_bits);
   Lisp_Object bucket = o->buckets[idx];
 
   oblookup_last_bucket_number = idx;
@@ -5191,7 +5734,8 @@ oblookup (Lisp_Object obarray, register const char *ptr, ptrdiff_t size, ptrdiff
 	{
 	  struct Lisp_Symbol *s = XBARE_SYMBOL (sym);
 	  Lisp_Object name = s->u.s.name;
-	  if (SBYTES (name) == size_byte && SCHARS (name) == size
+	  if (s->u.s.name_hash == hash
+	      && SBYTES (name) == size_byte && SCHARS (name) == size
 	      && memcmp (SDATA (name), ptr, size_byte) == 0)
 	    return sym;
 	  if (s->u.s.next == NULL)
@@ -5308,9 +5852,7 @@ grow_obarray (struct Lisp_Obarray *o)
     o->buckets[i] = make_fixnum (0);
   o->size_bits = new_bits;
 
-  /* Rehash symbols.
-     FIXME: this is expensive since we need to recompute the hash for every
-     symbol name.  Would it be reasonable to store it in the symbol?  */
+  /* Rehash symbols, using the hash codes they remember.  */
   for (ptrdiff_t i = 0; i < old_size; i++)
     {
       Lisp_Object obj = old_buckets[i];
@@ -5319,8 +5861,7 @@ grow_obarray (struct Lisp_Obarray *o)
 	  struct Lisp_Symbol *s = XBARE_SYMBOL (obj);
 	  while (1)
 	    {
-	      Lisp_Object name = s->u.s.name;
-	      ptrdiff_t idx = obarray_index (o, SSDATA (name), SBYTES (name));
+	      ptrdiff_t idx = knuth_hash (s->u.s.name_hash, o->size_bits);
 	      Lisp_Object *loc = o->buckets + idx;
 	      struct Lisp_Symbol *next = s->u.s.next;
 	      s->u.s.next = BARE_SYMBOL_P (*loc) ? XBARE_SYMBOL (*loc) : NULL;
@@ -5701,6 +6242,9 @@ load_path_default (void)
 void
 init_lread (void)
 {
+  /* Don't trust the listings made while dumping.  */
+  load_path_cache_table = Qnil;
+
   /* First, set Vload_path.  */
 
   /* Ignore EMACSLOADPATH when dumping.  */
@@ -5810,6 +6354,7 @@ dir_warning (char const *use, Lisp_Object dirname)
 syms_of_lread (void)
 {
   defsubr (&Sread);
+  defsubr (&Sdeserialize);
   defsubr (&Sread_positioning_symbols);
   defsubr (&Sread_from_string);
   defsubr (&Slread__substitute_object_in_subtree);
@@ -6084,6 +6629,22 @@ syms_of_lread (void)
 that are loaded before your customizations are read!  */);
   load_prefer_newer = 0;
 
+  DEFVAR_BOOL ("load-path-cache", load_path_cache,
+	       doc: /* Non-nil means cache the directory listings that `load' uses.
+When this is non-nil, `load', `locate-file' and other functions that
+search directories such as those in `load-path' for a file remember
+the names of the files in each directory the first time they look at
+it, so that they can skip the file names that aren't there without
+asking the file system for each of them.
+
+A listing is made again when the modification time of its directory
+changes.  It is not used for remote directories, nor for a directory
+that was modified in the last couple of seconds.  On file systems whose
+directory modification times are unreliable, such as some network file
+systems, a file added to a directory might not be found until the
+directory is modified again.  */);
+  load_path_cache = false;
+
   DEFVAR_BOOL ("load-no-native", load_no_native,
                doc: /* Non-nil means not to load native code unless explicitly requested.
 
@@ -6128,6 +6689,9 @@ syms_of_lread (void)
   DEFSYM (Qdir_ok, "dir-ok");
   DEFSYM (Qdo_after_load_evaluation, "do-after-load-evaluation");
 
+  staticpro (&load_path_cache_table);
+  load_path_cache_table = Qnil;
+
   staticpro (&read_objects_map);
   read_objects_map = Qnil;
   staticpro (&read_objects_completed);
@@ -82,6 +82,189 @@ clear_charpos_cache (struct buffer *b)
     cached_buffer = 0;
 }
 
+/* In a large multibyte buffer with few markers, the nearest known
+   position can be megabytes away from the one being converted.  So
+   such buffers get a sparse index of checkpoints, roughly
+   BYTECHAR_INDEX_INTERVAL bytes apart, that are recorded while
+   scanning and kept up to date by insdel.c as the text changes.
+   Once the index covers a part of the buffer, converting a position
+   there scans at most about BYTECHAR_INDEX_INTERVAL bytes.  */
+
+enum { BYTECHAR_INDEX_INTERVAL = 16 * 1024 };
+
+/* Buffers smaller than this many bytes don't use an index.  */
+enum { BYTECHAR_INDEX_THRESHOLD = 4 * BYTECHAR_INDEX_INTERVAL };
+
+struct bytechar_checkpoint
+{
+  ptrdiff_t charpos, bytepos;
+};
+
+struct bytechar_index
+{
+  /* The values of Z and Z_BYTE that the checkpoints are valid for.
+     If they don't match the buffer, the text was changed behind
+     insdel.c's back and the checkpoints are discarded.  */
+  ptrdiff_t z, z_byte;
+
+  /* The checkpoints, in increasing order of position.  */
+  struct bytechar_checkpoint *checkpoints;
+  ptrdiff_t count, size;
+};
+
+/* Number of conversions in indexed buffers that scanned a short
+   stretch of text, and of those that had to scan a long stretch and
+   recorded new checkpoints on the way.  */
+static EMACS_INT bytechar_index_hits, bytechar_index_misses;
+
+/* Return the index of B's text, creating it if needed, or NULL if B
+   is too small to need one.  */
+
+static struct bytechar_index *
+bytechar_index (struct buffer *b)
+{
+  struct bytechar_index *ix = b->text->bytechar_index;
+
+  if (!ix)
+    {
+      if (BUF_Z_BYTE (b) < BYTECHAR_INDEX_THRESHOLD)
+	return NULL;
+      ix = b->text->bytechar_index = xzalloc (sizeof *ix);
+    }
+  if (ix->z != BUF_Z (b) || ix->z_byte != BUF_Z_BYTE (b))
+    {
+      ix->count = 0;
+      ix->z = BUF_Z (b);
+      ix->z_byte = BUF_Z_BYTE (b);
+    }
+  return ix;
+}
+
+/* Return the number of checkpoints in IX that are at or before POS,
+   which is a byte position if BYTE, a character position otherwise.  */
+
+static ptrdiff_t
+bytechar_index_search (struct bytechar_index *ix, ptrdiff_t pos, bool byte)
+{
+  ptrdiff_t lo = 0, hi = ix->count;
+
+  while (lo < hi)
+    {
+      ptrdiff_t mid = lo + (hi - lo) / 2;
+      struct bytechar_checkpoint *cp = &ix->checkpoints[mid];
+
+      if ((byte ? cp->bytepos : cp->charpos) <= pos)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/* Make room in IX for N checkpoints before checkpoint I, and return
+   a pointer to the first of them.  */
+
+static struct bytechar_checkpoint *
+bytechar_index_open (struct bytechar_index *ix, ptrdiff_t i, ptrdiff_t n)
+{
+  if (ix->size - ix->count < n)
+    ix->checkpoints = xpalloc (ix->checkpoints, &ix->size,
+			       n - (ix->size - ix->count), -1,
+			       sizeof *ix->checkpoints);
+  memmove (ix->checkpoints + i + n, ix->checkpoints + i,
+	   (ix->count - i) * sizeof *ix->checkpoints);
+  return ix->checkpoints + i;
+}
+
+/* Of the N checkpoints made room for by bytechar_index_open before
+   checkpoint I, keep the USED ones starting at the START'th, and
+   close up the rest.  */
+
+static void
+bytechar_index_close (struct bytechar_index *ix, ptrdiff_t i, ptrdiff_t n,
+		      ptrdiff_t start, ptrdiff_t used)
+{
+  struct bytechar_checkpoint *cp = ix->checkpoints + i;
+
+  eassert (start + used <= n);
+  memmove (cp, cp + start, used * sizeof *cp);
+  memmove (cp + used, cp + n, (ix->count - i) * sizeof *cp);
+  ix->count += used;
+}
+
+/* Update B's index for the replacement of OLD_CHARS characters
+   (OLD_BYTES bytes) at FROM_BYTE by NEW_CHARS characters (NEW_BYTES
+   bytes).  Checkpoints inside the old text are dropped, and those
+   after it are relocated.  */
+
+void
+adjust_bytechar_index (struct buffer *b, ptrdiff_t from_byte,
+		       ptrdiff_t old_chars, ptrdiff_t old_bytes,
+		       ptrdiff_t new_chars, ptrdiff_t new_bytes)
+{
+  struct bytechar_index *ix = b->text->bytechar_index;
+  ptrdiff_t diff_chars = new_chars - old_chars;
+  ptrdiff_t diff_bytes = new_bytes - old_bytes;
+
+  if (!ix)
+    return;
+
+  ptrdiff_t lo = bytechar_index_search (ix, from_byte, true);
+  ptrdiff_t hi = lo;
+  while (hi < ix->count
+	 && ix->checkpoints[hi].bytepos < from_byte + old_bytes)
+    hi++;
+
+  memmove (ix->checkpoints + lo, ix->checkpoints + hi,
+	   (ix->count - hi) * sizeof *ix->checkpoints);
+  ix->count -= hi - lo;
+  for (ptrdiff_t i = lo; i < ix->count; i++)
+    {
+      ix->checkpoints[i].charpos += diff_chars;
+      ix->checkpoints[i].bytepos += diff_bytes;
+    }
+  ix->z += diff_chars;
+  ix->z_byte += diff_bytes;
+}
+
+/* Drop the checkpoints of B's index that are after FROM_BYTE and
+   not after TO_BYTE.  This is for changes that alter byte positions
+   in ways adjust_bytechar_index cannot describe.  */
+
+void
+invalidate_bytechar_index (struct buffer *b, ptrdiff_t from_byte,
+			   ptrdiff_t to_byte)
+{
+  struct bytechar_index *ix = b->text->bytechar_index;
+
+  if (!ix)
+    return;
+
+  ptrdiff_t lo = bytechar_index_search (ix, from_byte, true);
+  ptrdiff_t hi = bytechar_index_search (ix, to_byte, true);
+
+  memmove (ix->checkpoints + lo, ix->checkpoints + hi,
+	   (ix->count - hi) * sizeof *ix->checkpoints);
+  ix->count -= hi - lo;
+  ix->z = BUF_Z (b);
+  ix->z_byte = BUF_Z_BYTE (b);
+}
+
+/* Free the index of B's text.  */
+
+void
+free_bytechar_index (struct buffer *b)
+{
+  struct bytechar_index *ix = b->text->bytechar_index;
+
+  if (ix)
+    {
+      xfree (ix->checkpoints);
+      xfree (ix);
+      b->text->bytechar_index = NULL;
+    }
+}
+
 /* Converting between character positions and byte positions.  */
 
 /* There are several places in the buffer where we know
@@ -170,6 +353,9 @@ buf_charpos_to_bytepos (struct buffer *b, ptrdiff_t charpos)
   ptrdiff_t best_above, best_above_byte;
   ptrdiff_t best_below, best_below_byte;
   ptrdiff_t distance = BYTECHAR_DISTANCE_INITIAL;
+  struct bytechar_index *ix;
+  struct bytechar_checkpoint *cp = NULL;
+  ptrdiff_t i = 0, n = 0, used = 0, next;
 
   eassert (BUF_BEG (b) <= charpos && charpos <= BUF_Z (b));
 
@@ -202,6 +388,17 @@ buf_charpos_to_bytepos (struct buffer *b, ptrdiff_t charpos)
   if (b == cached_buffer && BUF_MODIFF (b) == cached_modiff)
     CONSIDER (cached_charpos, cached_bytepos);
 
+  ix = bytechar_index (b);
+  if (ix)
+    {
+      i = bytechar_index_search (ix, charpos, false);
+      if (i > 0)
+	CONSIDER (ix->checkpoints[i - 1].charpos,
+		  ix->checkpoints[i - 1].bytepos);
+      if (i < ix->count)
+	CONSIDER (ix->checkpoints[i].charpos, ix->checkpoints[i].bytepos);
+    }
+
   for (tail = BUF_MARKERS (b);
        /* If we are down to a range of DISTANCE chars,
           don't bother checking any other markers;
@@ -219,14 +416,36 @@ buf_charpos_to_bytepos (struct buffer *b, ptrdiff_t charpos)
   eassert (best_below <= charpos && charpos <= best_above);
   if (charpos - best_below < best_above - charpos)
     {
-      bool record = charpos - best_below > 5000;
+      bool record = !ix && charpos - best_below > 5000;
+
+      /* If this is a long scan in an indexed buffer, record
+	 checkpoints along the way for the next time.  */
+      if (ix && charpos - best_below >= BYTECHAR_INDEX_INTERVAL)
+	{
+	  n = (best_above_byte - best_below_byte) / BYTECHAR_INDEX_INTERVAL;
+	  cp = bytechar_index_open (ix, i, n);
+	  bytechar_index_misses++;
+	}
+      else if (ix)
+	bytechar_index_hits++;
+      next = best_below_byte + BYTECHAR_INDEX_INTERVAL;
 
       while (best_below < charpos)
 	{
 	  best_below++;
 	  best_below_byte += buf_next_char_len (b, best_below_byte);
+	  if (cp && best_below_byte >= next)
+	    {
+	      cp[used].charpos = best_below;
+	      cp[used].bytepos = best_below_byte;
+	      used++;
+	      next = best_below_byte + BYTECHAR_INDEX_INTERVAL;
+	    }
 	}
 
+      if (cp)
+	bytechar_index_close (ix, i, n, 0, used);
+
       /* If this position is quite far from the nearest known position,
 	 cache the correspondence by creating a marker here.
 	 It will last until the next GC.  */
@@ -244,14 +463,34 @@ buf_charpos_to_bytepos (struct buffer *b, ptrdiff_t charpos)
     }
   else
     {
-      bool record = best_above - charpos > 5000;
+      bool record = !ix && best_above - charpos > 5000;
+
+      if (ix && best_above - charpos >= BYTECHAR_INDEX_INTERVAL)
+	{
+	  n = (best_above_byte - best_below_byte) / BYTECHAR_INDEX_INTERVAL;
+	  cp = bytechar_index_open (ix, i, n);
+	  bytechar_index_misses++;
+	}
+      else if (ix)
+	bytechar_index_hits++;
+      next = best_above_byte - BYTECHAR_INDEX_INTERVAL;
 
       while (best_above > charpos)
 	{
 	  best_above--;
 	  best_above_byte -= buf_prev_char_len (b, best_above_byte);
+	  if (cp && best_above_byte <= next)
+	    {
+	      used++;
+	      cp[n - used].charpos = best_above;
+	      cp[n - used].bytepos = best_above_byte;
+	      next = best_above_byte - BYTECHAR_INDEX_INTERVAL;
+	    }
 	}
 
+      if (cp)
+	bytechar_index_close (ix, i, n, n - used, used);
+
       /* If this position is quite far from the nearest known position,
 	 cache the correspondence by creating a marker here.
 	 It will last until the next GC.  */
@@ -323,6 +562,9 @@ buf_bytepos_to_charpos (struct buffer *b, ptrdiff_t bytepos)
   ptrdiff_t best_above, best_above_byte;
   ptrdiff_t best_below, best_below_byte;
   ptrdiff_t distance = BYTECHAR_DISTANCE_INITIAL;
+  struct bytechar_index *ix;
+  struct bytechar_checkpoint *cp = NULL;
+  ptrdiff_t i = 0, n = 0, used = 0, next;
 
   eassert (BUF_BEG_BYTE (b) <= bytepos && bytepos <= BUF_Z_BYTE (b));
 
@@ -350,6 +592,17 @@ buf_bytepos_to_charpos (struct buffer *b, ptrdiff_t bytepos)
   if (b == cached_buffer && BUF_MODIFF (b) == cached_modiff)
     CONSIDER (cached_bytepos, cached_charpos);
 
+  ix = bytechar_index (b);
+  if (ix)
+    {
+      i = bytechar_index_search (ix, bytepos, true);
+      if (i > 0)
+	CONSIDER (ix->checkpoints[i - 1].bytepos,
+		  ix->checkpoints[i - 1].charpos);
+      if (i < ix->count)
+	CONSIDER (ix->checkpoints[i].bytepos, ix->checkpoints[i].charpos);
+    }
+
   for (tail = BUF_MARKERS (b);
        /* If we are down to a range of DISTANCE bytes,
           don't bother checking any other markers;
@@ -366,14 +619,36 @@ buf_bytepos_to_charpos (struct buffer *b, ptrdiff_t bytepos)
 
   if (bytepos - best_below_byte < best_above_byte - bytepos)
     {
-      bool record = bytepos - best_below_byte > 5000;
+      bool record = !ix && bytepos - best_below_byte > 5000;
+
+      /* If this is a long scan in an indexed buffer, record
+	 checkpoints along the way for the next time.  */
+      if (ix && bytepos - best_below_byte >= BYTECHAR_INDEX_INTERVAL)
+	{
+	  n = (best_above_byte - best_below_byte) / BYTECHAR_INDEX_INTERVAL;
+	  cp = bytechar_index_open (ix, i, n);
+	  bytechar_index_misses++;
+	}
+      else if (ix)
+	bytechar_index_hits++;
+      next = best_below_byte + BYTECHAR_INDEX_INTERVAL;
 
       while (best_below_byte < bytepos)
 	{
 	  best_below++;
 	  best_below_byte += buf_next_char_len (b, best_below_byte);
+	  if (cp && best_below_byte >= next)
+	    {
+	      cp[used].charpos = best_below;
+	      cp[used].bytepos = best_below_byte;
+	      used++;
+	      next = best_below_byte + BYTECHAR_INDEX_INTERVAL;
+	    }
 	}
 
+      if (cp)
+	bytechar_index_close (ix, i, n, 0, used);
+
       /* If this position is quite far from the nearest known position,
 	 cache the correspondence by creating a marker here.
 	 It will last until the next GC.
@@ -393,14 +668,34 @@ buf_bytepos_to_charpos (struct buffer *b, ptrdiff_t bytepos)
     }
   else
     {
-      bool record = best_above_byte - bytepos > 5000;
+      bool record = !ix && best_above_byte - bytepos > 5000;
+
+      if (ix && best_above_byte - bytepos >= BYTECHAR_INDEX_INTERVAL)
+	{
+	  n = (best_above_byte - best_below_byte) / BYTECHAR_INDEX_INTERVAL;
+	  cp = bytechar_index_open (ix, i, n);
+	  bytechar_index_misses++;
+	}
+      else if (ix)
+	bytechar_index_hits++;
+      next = best_above_byte - BYTECHAR_INDEX_INTERVAL;
 
       while (best_above_byte > bytepos)
 	{
 	  best_above--;
 	  best_above_byte -= buf_prev_char_len (b, best_above_byte);
+	  if (cp && best_above_byte <= next)
+	    {
+	      used++;
+	      cp[n - used].charpos = best_above;
+	      cp[n - used].bytepos = best_above_byte;
+	      next = best_above_byte - BYTECHAR_INDEX_INTERVAL;
+	    }
 	}
 
+      if (cp)
+	bytechar_index_close (ix, i, n, n - used, used);
+
       /* If this position is quite far from the nearest known position,
 	 cache the correspondence by creating a marker here.
 	 It will last until the next GC.
@@ -487,8 +782,7 @@ attach_marker (struct Lisp_Marker *m, struct buffer *b,
     {
       unchain_marker (m);
       m->buffer = b;
-      m->next = BUF_MARKERS (b);
-      BUF_MARKERS (b) = m;
+      chain_marker (m, b);
     }
 }
 
@@ -678,7 +972,8 @@ detach_marker (Lisp_Object marker)
 }
 
 /* Remove MARKER from the chain of whatever buffer it is in.  Set its
-   buffer NULL.  */
+   buffer NULL.  The chain is doubly linked, so this takes constant
+   time.  */
 
 void
 unchain_marker (register struct Lisp_Marker *marker)
@@ -687,34 +982,20 @@ unchain_marker (register struct Lisp_Marker *marker)
 
   if (b)
     {
-      register struct Lisp_Marker *tail, **prev;
-
       /* No dead buffers here.  */
       eassert (BUFFER_LIVE_P (b));
+      /* Error if marker is not in its chain.  */
+      eassert (marker->prev ? marker->prev->next == marker
+	       : BUF_MARKERS (b) == marker);
+
+      /* Crash if a marker in the chain does not say it belongs to
+	 the same buffer, or at least that they have the same base
+	 buffer.  */
+      if (marker->next && b->text != marker->next->buffer->text)
+	emacs_abort ();
 
       marker->buffer = NULL;
-      prev = &BUF_MARKERS (b);
-
-      for (tail = BUF_MARKERS (b); tail; prev = &tail->next, tail = *prev)
-	if (marker == tail)
-	  {
-	    if (*prev == BUF_MARKERS (b))
-	      {
-		/* Deleting first marker from the buffer's chain.  Crash
-		   if new first marker in chain does not say it belongs
-		   to the same buffer, or at least that they have the same
-		   base buffer.  */
-		if (tail->next && b->text != tail->next->buffer->text)
-		  emacs_abort ();
-	      }
-	    *prev = tail->next;
-	    /* We have removed the marker from the chain;
-	       no need to scan the rest of the chain.  */
-	    break;
-	  }
-
-      /* Error if marker was not in it's chain.  */
-      eassert (tail != NULL);
+      unlink_marker (marker, b);
     }
 }
 
@@ -794,6 +1075,29 @@ DEFUN ("set-marker-insertion-type", Fset_marker_insertion_type,
   return type;
 }
 
+DEFUN ("position-index-statistics", Fposition_index_statistics,
+       Sposition_index_statistics, 0, 1, 0,
+       doc: /* Return data about converting positions in large buffers.
+Large multibyte buffers keep an index of checkpoints that record the
+byte position of some characters, so that converting between character
+and byte positions doesn't need to scan much text.  The data is
+returned as a list (HITS MISSES CHECKPOINTS).  HITS is the number of
+such conversions in all buffers so far that only scanned a short
+stretch of text.  MISSES is the number of those that scanned a long
+stretch and added checkpoints on the way.  CHECKPOINTS is the number
+of checkpoints in BUFFER, which defaults to the current buffer.  */)
+  (Lisp_Object buffer)
+{
+  struct buffer *b = decode_buffer (buffer);
+  struct bytechar_index *ix = b->text->bytechar_index;
+  ptrdiff_t count = 0;
+
+  if (ix && ix->z == BUF_Z (b) && ix->z_byte == BUF_Z_BYTE (b))
+    count = ix->count;
+  return list3 (make_int (bytechar_index_hits),
+		make_int (bytechar_index_misses), make_int (count));
+}
+
 #ifdef MARKER_DEBUG
 
 /* For debugging -- count the markers in buffer BUF.  */
@@ -840,4 +1144,5 @@ syms_of_marker (void)
   defsubr (&Scopy_marker);
   defsubr (&Smarker_insertion_type);
   defsubr (&Sset_marker_insertion_type);
+  defsubr (&Sposition_index_statistics);
 }
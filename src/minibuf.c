@@ -20,6 +20,8 @@ Copyright (C) 1985-1986, 1993-2025 Free Software Foundation, Inc.
 
 #include <config.h>
 #include <errno.h>
+#include <math.h>
+#include <stdlib.h>
 
 #include <binary-io.h>
 
@@ -1977,6 +1979,401 @@ DEFUN ("all-completions", Fall_completions, Sall_completions, 2, 3, 0,
   return Fnreverse (allmatches);
 }
 
+/* Completion sessions.
+
+   While the user types a completion one character at a time, each
+   new input extends the previous one, so its completions are among
+   those of the previous input.  A completion session remembers the
+   completions of the last input, so that they can be filtered instead
+   of the whole collection.
+
+   A session is a record of type `completion-session' with the slots
+   below, where STRING, COLLECTION and PREDICATE are the arguments
+   whose completions were last computed, IGNORE-CASE and REGEXPS the
+   values of `completion-ignore-case' and `completion-regexp-list'
+   then, and MATCHES the completions found.  STRING is nil if no
+   completions were computed yet.  */
+
+enum
+  {
+    COMPLETION_SESSION_STRING = 1,
+    COMPLETION_SESSION_COLLECTION,
+    COMPLETION_SESSION_PREDICATE,
+    COMPLETION_SESSION_IGNORE_CASE,
+    COMPLETION_SESSION_REGEXPS,
+    COMPLETION_SESSION_MATCHES,
+    COMPLETION_SESSION_SLOTS = COMPLETION_SESSION_MATCHES
+  };
+
+DEFUN ("make-completion-session", Fmake_completion_session,
+       Smake_completion_session, 0, 0, 0,
+       doc: /* Return a new completion session.
+A completion session remembers the completions that
+`completion-session-all-completions' and
+`completion-session-try-completion' found last, so that when they are
+called again with an input that extends the previous one, they only
+need to look at those completions instead of the whole collection.
+
+The collection must not change while a session is in use; if it does,
+make a new session.  */)
+  (void)
+{
+  return Fmake_record (Qcompletion_session,
+		       make_fixnum (COMPLETION_SESSION_SLOTS), Qnil);
+}
+
+static void
+check_completion_session (Lisp_Object session)
+{
+  CHECK_TYPE (RECORDP (session)
+	      && PVSIZE (session) == COMPLETION_SESSION_SLOTS + 1
+	      && EQ (AREF (session, 0), Qcompletion_session),
+	      Qcompletion_session, session);
+}
+
+/* Return the list of completions of STRING in COLLECTION that satisfy
+   PREDICATE, like `all-completions' does, using and updating SESSION.
+   The caller must not modify the list.  */
+
+static Lisp_Object
+completion_session_matches (Lisp_Object session, Lisp_Object string,
+			    Lisp_Object collection, Lisp_Object predicate)
+{
+  Lisp_Object old = AREF (session, COMPLETION_SESSION_STRING);
+  Lisp_Object ignore_case = completion_ignore_case ? Qt : Qnil;
+  Lisp_Object matches;
+
+  CHECK_STRING (string);
+  if (STRINGP (old)
+      && EQ (collection, AREF (session, COMPLETION_SESSION_COLLECTION))
+      && EQ (predicate, AREF (session, COMPLETION_SESSION_PREDICATE))
+      && EQ (ignore_case, AREF (session, COMPLETION_SESSION_IGNORE_CASE))
+      && EQ (Vcompletion_regexp_list,
+	     AREF (session, COMPLETION_SESSION_REGEXPS))
+      && SCHARS (old) <= SCHARS (string)
+      && EQ (Qt, Fcompare_strings (old, Qnil, Qnil, string, make_fixnum (0),
+				   make_fixnum (SCHARS (old)), ignore_case)))
+    {
+      /* STRING extends the previous input, so its completions are
+	 those of the previous input that it is a prefix of.  They
+	 already passed PREDICATE and `completion-regexp-list'.  */
+      Lisp_Object tail, zero = make_fixnum (0);
+      Lisp_Object len = make_fixnum (SCHARS (string));
+
+      matches = Qnil;
+      for (tail = AREF (session, COMPLETION_SESSION_MATCHES);
+	   CONSP (tail); tail = XCDR (tail))
+	{
+	  Lisp_Object eltstring = XCAR (tail);
+	  if (SCHARS (string) <= SCHARS (eltstring)
+	      && EQ (Qt, Fcompare_strings (eltstring, zero, len,
+					   string, zero, len, ignore_case)))
+	    matches = Fcons (eltstring, matches);
+	}
+      matches = Fnreverse (matches);
+    }
+  else
+    matches = Fall_completions (string, collection, predicate);
+
+  ASET (session, COMPLETION_SESSION_STRING, Fcopy_sequence (string));
+  ASET (session, COMPLETION_SESSION_COLLECTION, collection);
+  ASET (session, COMPLETION_SESSION_PREDICATE, predicate);
+  ASET (session, COMPLETION_SESSION_IGNORE_CASE, ignore_case);
+  ASET (session, COMPLETION_SESSION_REGEXPS, Vcompletion_regexp_list);
+  ASET (session, COMPLETION_SESSION_MATCHES, matches);
+  return matches;
+}
+
+/* Return true if COLLECTION is a function doing completion itself,
+   whose results a completion session cannot reuse.  */
+
+static bool
+completion_function_p (Lisp_Object collection)
+{
+  return !(VECTORP (collection) || HASH_TABLE_P (collection)
+	   || OBARRAYP (collection) || NILP (collection)
+	   || (CONSP (collection) && !FUNCTIONP (collection)));
+}
+
+DEFUN ("completion-session-all-completions",
+       Fcompletion_session_all_completions,
+       Scompletion_session_all_completions, 3, 4, 0,
+       doc: /* Like `all-completions', but using completion session SESSION.
+Return the list of possible completions of STRING in COLLECTION that
+satisfy PREDICATE, exactly as `all-completions' does.  If the previous
+call with SESSION had the same COLLECTION and PREDICATE, and a STRING that
+is a prefix of this one, and `completion-ignore-case' and
+`completion-regexp-list' didn't change in between, only the completions
+found then are examined.  See `make-completion-session'.
+
+When COLLECTION is a function, this is the same as `all-completions'.  */)
+  (Lisp_Object session, Lisp_Object string, Lisp_Object collection,
+   Lisp_Object predicate)
+{
+  check_completion_session (session);
+  if (completion_function_p (collection))
+    return Fall_completions (string, collection, predicate);
+  return Fcopy_sequence (completion_session_matches (session, string,
+						     collection, predicate));
+}
+
+DEFUN ("completion-session-try-completion",
+       Fcompletion_session_try_completion,
+       Scompletion_session_try_completion, 3, 4, 0,
+       doc: /* Like `try-completion', but using completion session SESSION.
+Return the longest common substring of all possible completions of
+STRING in COLLECTION that satisfy PREDICATE, exactly as `try-completion'
+does, but find these completions like
+`completion-session-all-completions' does.
+
+When COLLECTION is a function, this is the same as `try-completion'.  */)
+  (Lisp_Object session, Lisp_Object string, Lisp_Object collection,
+   Lisp_Object predicate)
+{
+  check_completion_session (session);
+  if (completion_function_p (collection))
+    return Ftry_completion (string, collection, predicate);
+
+  Lisp_Object matches = completion_session_matches (session, string,
+						    collection, predicate);
+  /* The completions already match `completion-regexp-list'.  */
+  specpdl_ref count = SPECPDL_INDEX ();
+  specbind (Qcompletion_regexp_list, Qnil);
+  return unbind_to (count, Ftry_completion (string, matches, Qnil));
+}
+
+/* Match the characters of the flex pattern PATTERN, of length NPATTERN,
+   in this order against STRING, each as early as possible, and return
+   true if they all match.  If so, set *SCORE to the score that the
+   `flex' completion style gives to the match, using TIGHTNESS as
+   `flex-score-match-tightness', and if POSITIONS is non-NULL, store in
+   it the positions of the matched characters.  If IGNORE_CASE, the
+   characters of PATTERN must already be downcased.  */
+
+static bool
+flex_match (Lisp_Object string, const int *pattern, ptrdiff_t npattern,
+	    bool ignore_case, double tightness, double *score,
+	    ptrdiff_t *positions)
+{
+  ptrdiff_t len = SCHARS (string);
+  ptrdiff_t charidx = 0, byteidx = 0, last = -1, j = 0;
+  double holes = 0;
+
+  if (len < npattern)
+    return false;
+
+  while (j < npattern && charidx < len)
+    {
+      ptrdiff_t i = charidx;
+      int c = fetch_string_char_advance (string, &charidx, &byteidx);
+
+      if (ignore_case)
+	c = downcase (c);
+      if (c != pattern[j])
+	continue;
+
+      /* Like completion--flex-score-1, charge 1 + (L - 1)^(1/TIGHTNESS)
+	 for each hole of length L between matched characters.  */
+      if (last >= 0 && i - last > 1)
+	holes += 1 + pow (i - last - 2, 1 / tightness);
+      if (positions)
+	positions[j] = i;
+      last = i;
+      j++;
+    }
+
+  if (j < npattern)
+    return false;
+  *score = len ? npattern / (len * (1 + holes)) : 0;
+  return true;
+}
+
+struct flex_candidate
+{
+  double score;
+  ptrdiff_t index;
+};
+
+/* Sort flex candidates by decreasing score, then in collection order.  */
+
+static int
+compare_flex_candidates (const void *a, const void *b)
+{
+  const struct flex_candidate *ca = a, *cb = b;
+
+  if (ca->score != cb->score)
+    return ca->score < cb->score ? 1 : -1;
+  return (ca->index > cb->index) - (ca->index < cb->index);
+}
+
+DEFUN ("completion-flex-matches", Fcompletion_flex_matches,
+       Scompletion_flex_matches, 2, 4, 0,
+       doc: /* Return the completions in COLLECTION that flex-match PATTERN.
+A possible completion flex-matches PATTERN if it contains all the
+characters of PATTERN in the same order, possibly with other characters
+between them, as in the `flex' completion style.
+
+The value is a list of elements (COMPLETION SCORE POSITIONS), sorted by
+decreasing SCORE.  SCORE is a number between 0 and 1 computed like the
+`flex' completion style does, see `flex-score-match-tightness'; only an
+exact match has a score of 1.  POSITIONS is a list of the indices in
+COMPLETION of the characters that match those of PATTERN, each matched
+as early as possible.  Completions with the same score are in the order
+of COLLECTION.
+
+COLLECTION and PREDICATE are as for `all-completions', except that when
+COLLECTION is a function, it is called to return all the possible
+completions, which are then matched against PATTERN.
+The possible completions must also match all the regexps in
+`completion-regexp-list'.  Case is ignored if `completion-ignore-case'
+is non-nil.
+
+If LIMIT is non-nil, it should be a natural number, and only
+the LIMIT completions with the highest scores are returned.
+
+This is much faster than matching each possible completion in Lisp.  */)
+  (Lisp_Object pattern, Lisp_Object collection, Lisp_Object predicate,
+   Lisp_Object limit)
+{
+  CHECK_STRING (pattern);
+  if (!NILP (limit))
+    CHECK_FIXNAT (limit);
+
+  if (VECTORP (collection))
+    collection = check_obarray (collection);
+  if (!(HASH_TABLE_P (collection) || OBARRAYP (collection)
+	|| NILP (collection)
+	|| (CONSP (collection) && !FUNCTIONP (collection))))
+    {
+      collection = calln (collection, empty_unibyte_string, predicate, Qt);
+      predicate = Qnil;
+    }
+  int type = (HASH_TABLE_P (collection) ? 3
+	      : OBARRAYP (collection) ? 2 : 1);
+
+  /* An upper bound on the number of candidates.  */
+  ptrdiff_t nmax = 0;
+  if (type == 1)
+    for (Lisp_Object tail = collection; CONSP (tail); tail = XCDR (tail))
+      nmax++;
+  else if (type == 2)
+    nmax = XOBARRAY (collection)->count;
+  else
+    nmax = XHASH_TABLE (collection)->count;
+
+  bool ignore_case = completion_ignore_case;
+  ptrdiff_t npattern = SCHARS (pattern);
+  double tightness = 3;
+  Lisp_Object val = find_symbol_value (Qflex_score_match_tightness);
+  if (NUMBERP (val) && XFLOATINT (val) > 0)
+    tightness = XFLOATINT (val);
+
+  Lisp_Object *strings;
+  struct flex_candidate *candidates;
+  int *chars;
+  ptrdiff_t *positions;
+  USE_SAFE_ALLOCA;
+  SAFE_ALLOCA_LISP (strings, nmax);
+  SAFE_NALLOCA (candidates, 1, nmax);
+  SAFE_NALLOCA (chars, 1, npattern);
+  SAFE_NALLOCA (positions, 1, npattern);
+
+  for (ptrdiff_t i = 0, charidx = 0, byteidx = 0; i < npattern; i++)
+    {
+      int c = fetch_string_char_advance (pattern, &charidx, &byteidx);
+      chars[i] = ignore_case ? downcase (c) : c;
+    }
+
+  Lisp_Object tail = collection, elt, eltstring;
+  ptrdiff_t idx = 0, n = 0, nseen = 0;
+  obarray_iter_t obit;
+  if (type == 2)
+    obit = make_obarray_iter (XOBARRAY (collection));
+
+  while (nseen < nmax)
+    {
+      /* Get the next element, as in Fall_completions.  */
+      if (type == 1)
+	{
+	  if (!CONSP (tail))
+	    break;
+	  elt = XCAR (tail);
+	  eltstring = CONSP (elt) ? XCAR (elt) : elt;
+	  tail = XCDR (tail);
+	}
+      else if (type == 2)
+	{
+	  if (obarray_iter_at_end (&obit))
+	    break;
+	  elt = eltstring = obarray_iter_symbol (&obit);
+	  obarray_iter_step (&obit);
+	}
+      else
+	{
+	  while (idx < HASH_TABLE_SIZE (XHASH_TABLE (collection))
+		 && hash_unused_entry_key_p (HASH_KEY (XHASH_TABLE (collection),
+						       idx)))
+	    idx++;
+	  if (idx >= HASH_TABLE_SIZE (XHASH_TABLE (collection)))
+	    break;
+	  else
+	    elt = eltstring = HASH_KEY (XHASH_TABLE (collection), idx++);
+	}
+      nseen++;
+      rarely_quit (nseen);
+
+      if (SYMBOLP (eltstring))
+	eltstring = Fsymbol_name (eltstring);
+
+      double score;
+      if (!STRINGP (eltstring)
+	  || !flex_match (eltstring, chars, npattern, ignore_case,
+			  tightness, &score, NULL)
+	  || !match_regexps (eltstring, Vcompletion_regexp_list, ignore_case))
+	continue;
+
+      if (!NILP (predicate))
+	{
+	  Lisp_Object tem;
+	  if (EQ (predicate, Qcommandp))
+	    tem = Fcommandp (elt, Qnil);
+	  else if (type == 3)
+	    tem = calln (predicate, elt,
+			 HASH_VALUE (XHASH_TABLE (collection), idx - 1));
+	  else
+	    tem = calln (predicate, elt);
+	  if (NILP (tem))
+	    continue;
+	}
+
+      strings[n] = eltstring;
+      candidates[n].score = score;
+      candidates[n].index = n;
+      n++;
+    }
+
+  qsort (candidates, n, sizeof *candidates, compare_flex_candidates);
+  if (!NILP (limit) && XFIXNAT (limit) < n)
+    n = XFIXNAT (limit);
+
+  /* Recompute the matched positions of the completions we return.  */
+  Lisp_Object result = Qnil;
+  for (ptrdiff_t i = n - 1; i >= 0; i--)
+    {
+      Lisp_Object string = strings[candidates[i].index];
+      double score;
+      flex_match (string, chars, npattern, ignore_case, tightness,
+		  &score, positions);
+      Lisp_Object posns = Qnil;
+      for (ptrdiff_t j = npattern - 1; j >= 0; j--)
+	posns = Fcons (make_fixnum (positions[j]), posns);
+      result = Fcons (list3 (string, make_float (score), posns), result);
+    }
+
+  SAFE_FREE ();
+  return result;
+}
+
 DEFUN ("completing-read", Fcompleting_read, Scompleting_read, 2, 8, 0,
        doc: /* Read a string in the minibuffer, with completion.
 While in the minibuffer, you can use \\<minibuffer-local-completion-map>\\[minibuffer-complete] and \\[minibuffer-complete-word] to complete your input.
@@ -2544,6 +2941,10 @@ syms_of_minibuf (void)
 
   defsubr (&Stry_completion);
   defsubr (&Sall_completions);
+  defsubr (&Scompletion_flex_matches);
+  defsubr (&Smake_completion_session);
+  defsubr (&Scompletion_session_all_completions);
+  defsubr (&Scompletion_session_try_completion);
   defsubr (&Stest_completion);
   defsubr (&Sassoc_string);
   defsubr (&Scompleting_read);
@@ -2551,4 +2952,7 @@ syms_of_minibuf (void)
   DEFSYM (Qinternal_complete_buffer, "internal-complete-buffer");
   DEFSYM (Qcompleting_read_function, "completing-read-function");
   DEFSYM (Qformat_prompt, "format-prompt");
+  DEFSYM (Qflex_score_match_tightness, "flex-score-match-tightness");
+  DEFSYM (Qcompletion_session, "completion-session");
+  DEFSYM (Qcompletion_regexp_list, "completion-regexp-list");
 }
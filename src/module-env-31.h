@@ -1,3 +1,50 @@
   /* Add module environment functions newly added in Emacs 31 here.
      Before Emacs 31 is released, remove this comment and start
      module-env-32.h on the master branch.  */
+
+  /* Store in *TEXT1 and *SIZE1, and in *TEXT2 and *SIZE2, the two
+     parts of the text of BUFFER between the character positions START
+     and END that come before and after the buffer gap, without copying
+     it.  The text is in the internal representation of Emacs, which
+     is UTF-8 for the text of a multibyte buffer, and must not be
+     modified.  It remains valid only until the next call of an
+     environment function, or until the module function returns.  */
+  bool (*buffer_text) (emacs_env *env, emacs_value buffer,
+                       intmax_t start, intmax_t end,
+                       const char **text1, ptrdiff_t *size1,
+                       const char **text2, ptrdiff_t *size2)
+    EMACS_ATTRIBUTE_NONNULL (1, 5, 6, 7, 8);
+
+  /* Insert the COUNT strings TEXTS, of SIZES bytes, which must be
+     UTF-8 encoded, at point in the current buffer, like one call of
+     'insert' with their concatenation.  */
+  bool (*insert_text) (emacs_env *env, ptrdiff_t count,
+                       const char *const *texts, const ptrdiff_t *sizes)
+    EMACS_ATTRIBUTE_NONNULL (1);
+
+  /* Return a vector of the COUNT integers VALUES.  */
+  emacs_value (*make_integer_vector) (emacs_env *env, ptrdiff_t count,
+                                      const intmax_t *values)
+    EMACS_ATTRIBUTE_NONNULL (1);
+
+  /* Return a vector of the COUNT floating-point numbers VALUES.  */
+  emacs_value (*make_float_vector) (emacs_env *env, ptrdiff_t count,
+                                    const double *values)
+    EMACS_ATTRIBUTE_NONNULL (1);
+
+  /* Return a list of COUNT strings, whose UTF-8 encoded contents
+     follow each other in DATA and are SIZES bytes long.  */
+  emacs_value (*make_string_list) (emacs_env *env, const char *data,
+                                   ptrdiff_t count, const ptrdiff_t *sizes)
+    EMACS_ATTRIBUTE_NONNULL (1);
+
+  /* Arrange for the main thread of Emacs to call CALLBACK with a new
+     environment and DATA from its event loop, as a special event.
+     Unlike all other environment functions, this one can be called
+     from any thread of the module, at any time: save the pointer to
+     it while an environment is available, and pass NULL as ENV.
+     DATA is passed along as is; CALLBACK is responsible for freeing
+     it.  Return true if the callback was posted.  */
+  bool (*post_callback) (emacs_env *env,
+                         void (*callback) (emacs_env *env, void *data),
+                         void *data);
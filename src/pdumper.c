@@ -140,10 +140,13 @@ #define PRIdDUMP_OFF PRIdLEAST32
 
 enum { EMACS_INT_XDIGITS = (EMACS_INT_WIDTH + 3) / 4 };
 
+/* Change this to true to trace the dump queue on stderr.  */
+enum { DUMP_TRACE = false };
+
 static void ATTRIBUTE_FORMAT_PRINTF (1, 2)
 dump_trace (const char *fmt, ...)
 {
-  if (0)
+  if (DUMP_TRACE)
     {
       va_list args;
       va_start (args, fmt);
@@ -1086,8 +1089,10 @@ dump_calc_link_score (dump_off basis,
 {
   float distance = (float)(basis - link_basis);
   eassert (distance >= 0);
-  float link_score = powf (distance, -0.2f);
-  return powf (link_score, (float) link_weight / 1000.0f);
+  /* This is (DISTANCE^-0.2)^(LINK_WEIGHT/1000), computed with a
+     single call to powf since we do this for every link of every
+     object we score.  */
+  return powf (distance, -0.2f * ((float) link_weight / 1000.0f));
 }
 
 /* Compute the score for a queued object.
@@ -1311,23 +1316,26 @@ dump_queue_dequeue (struct dump_queue *dump_queue, dump_off basis)
               best < 0 ? -1.0 : (double) candidates[best].score,
 	      src, EMACS_INT_XDIGITS, uresult);
 
-  {
-    Lisp_Object weights = Fgethash (result, dump_queue->link_weights, Qnil);
-    while (!NILP (weights) && CONSP (weights))
-      {
-        Lisp_Object basis_weight_pair = dump_pop (&weights);
-        dump_off link_basis =
-          dump_off_from_lisp (XCAR (basis_weight_pair));
-        dump_off link_weight =
-          dump_off_from_lisp (XCDR (basis_weight_pair));
-	dump_trace
-	  ("    link_basis=%d distance=%d weight=%d contrib=%f\n",
-	   link_basis,
-	   basis - link_basis,
-	   link_weight,
-	   (double) dump_calc_link_score (basis, link_basis, link_weight));
-      }
-  }
+  /* Computing the trace arguments costs a hash lookup and a score
+     computation per link, so skip it all unless tracing.  */
+  if (DUMP_TRACE)
+    {
+      Lisp_Object weights = Fgethash (result, dump_queue->link_weights, Qnil);
+      while (!NILP (weights) && CONSP (weights))
+	{
+	  Lisp_Object basis_weight_pair = dump_pop (&weights);
+	  dump_off link_basis =
+	    dump_off_from_lisp (XCAR (basis_weight_pair));
+	  dump_off link_weight =
+	    dump_off_from_lisp (XCDR (basis_weight_pair));
+	  dump_trace
+	    ("    link_basis=%d distance=%d weight=%d contrib=%f\n",
+	     link_basis,
+	     basis - link_basis,
+	     link_weight,
+	     (double) dump_calc_link_score (basis, link_basis, link_weight));
+	}
+    }
 
   Fremhash (result, dump_queue->link_weights);
   Fremhash (result, dump_queue->sequence_numbers);
@@ -2111,7 +2119,7 @@ dump_string (struct dump_context *ctx, const struct Lisp_String *string)
 static dump_off
 dump_marker (struct dump_context *ctx, const struct Lisp_Marker *marker)
 {
-#if CHECK_STRUCTS && !defined (HASH_Lisp_Marker_642DBAF866)
+#if CHECK_STRUCTS && !defined (HASH_Lisp_Marker_FBB5402CE5)
 # error "Lisp_Marker changed. See CHECK_STRUCTS comment in config.h."
 #endif
 
@@ -2125,6 +2133,8 @@ dump_marker (struct dump_context *ctx, const struct Lisp_Marker *marker)
 			    Lisp_Vectorlike, WEIGHT_NORMAL);
       dump_field_lv_rawptr (ctx, out, marker, &marker->next,
 			    Lisp_Vectorlike, WEIGHT_STRONG);
+      dump_field_lv_rawptr (ctx, out, marker, &marker->prev,
+			    Lisp_Vectorlike, WEIGHT_NORMAL);
       DUMP_FIELD_COPY (out, marker, charpos);
       DUMP_FIELD_COPY (out, marker, bytepos);
     }
@@ -2471,7 +2481,7 @@ dump_symbol (struct dump_context *ctx,
              Lisp_Object object,
              dump_off offset)
 {
-#if CHECK_STRUCTS && !defined HASH_Lisp_Symbol_E0ADAF2F24
+#if CHECK_STRUCTS && !defined HASH_Lisp_Symbol_39E29A6159
 # error "Lisp_Symbol changed. See CHECK_STRUCTS comment in config.h."
 #endif
 #if CHECK_STRUCTS && !defined (HASH_symbol_redirect_EA72E4BFF5)
@@ -2508,6 +2518,7 @@ dump_symbol (struct dump_context *ctx,
   DUMP_FIELD_COPY (&out, symbol, u.s.trapped_write);
   DUMP_FIELD_COPY (&out, symbol, u.s.interned);
   DUMP_FIELD_COPY (&out, symbol, u.s.declared_special);
+  DUMP_FIELD_COPY (&out, symbol, u.s.name_hash);
   dump_field_lv (ctx, &out, symbol, &symbol->u.s.name, WEIGHT_STRONG);
   switch (symbol->u.s.redirect)
     {
@@ -2704,8 +2715,7 @@ hash_table_std_test (const struct hash_table_test *t)
 hash_table_freeze (struct Lisp_Hash_Table *h)
 {
   h->key_and_value = hash_table_contents (h);
-  h->next = NULL;
-  h->hash = NULL;
+  h->hash_and_next = NULL;
   h->index = NULL;
   h->table_size = 0;
   h->index_bits = 0;
@@ -2739,7 +2749,7 @@ dump_hash_table_contents (struct dump_context *ctx, struct Lisp_Hash_Table *h)
 static dump_off
 dump_hash_table (struct dump_context *ctx, Lisp_Object object)
 {
-#if CHECK_STRUCTS && !defined HASH_Lisp_Hash_Table_2A3C3E2B62
+#if CHECK_STRUCTS && !defined HASH_Lisp_Hash_Table_EB7FB57C26
 # error "Lisp_Hash_Table changed. See CHECK_STRUCTS comment in config.h."
 #endif
   const struct Lisp_Hash_Table *hash_in = XHASH_TABLE (object);
@@ -2924,6 +2934,8 @@ dump_buffer (struct dump_context *ctx, const struct buffer *in_buffer)
   out->newline_cache = NULL;
   out->width_run_cache = NULL;
   out->bidi_paragraph_cache = NULL;
+  out->composition_cache = NULL;
+  out->line_height_cache = NULL;
 
   DUMP_FIELD_COPY (out, buffer, prevent_redisplay_optimizations_p);
   DUMP_FIELD_COPY (out, buffer, clip_changed);
@@ -3071,7 +3083,7 @@ dump_vectorlike (struct dump_context *ctx,
                  Lisp_Object lv,
                  dump_off offset)
 {
-#if CHECK_STRUCTS && !defined HASH_pvec_type_99104541E2
+#if CHECK_STRUCTS && !defined HASH_pvec_type_E154053114
 # error "pvec_type changed. See CHECK_STRUCTS comment in config.h."
 #endif
   const struct Lisp_Vector *v = XVECTOR (lv);
@@ -3141,7 +3153,10 @@ dump_vectorlike (struct dump_context *ctx,
     case PVEC_USER_PTR:
     case PVEC_MUTEX:
     case PVEC_CONDVAR:
+    case PVEC_CHANNEL:
     case PVEC_SQLITE:
+    case PVEC_JSON_PARSER:
+    case PVEC_REGION_CACHE:
     case PVEC_MODULE_FUNCTION:
     case PVEC_SYMBOL_WITH_POS:
     case PVEC_FREE:
@@ -3953,6 +3968,53 @@ dump_merge_emacs_relocs (Lisp_Object lreloc_a, Lisp_Object lreloc_b)
                 dump_off_to_lisp (reloc_a.length));
 }
 
+struct dump_sort_entry
+{
+  dump_off offset;
+  ptrdiff_t index;
+  Lisp_Object cell;
+};
+
+static int
+dump_sort_entry_compare (const void *a, const void *b)
+{
+  const struct dump_sort_entry *ea = a;
+  const struct dump_sort_entry *eb = b;
+  if (ea->offset != eb->offset)
+    return ea->offset < eb->offset ? -1 : 1;
+  /* Keep the sort stable.  */
+  return (ea->index > eb->index) - (ea->index < eb->index);
+}
+
+/* Destructively sort LIST, a list of relocation or fixup descriptors,
+   by the dump offset that is the second element of each descriptor,
+   and return the sorted list.  A dump accumulates hundreds of
+   thousands of these descriptors, so sort them in C by relinking the
+   existing conses: calling a Lisp predicate for every comparison
+   accounted for a good part of the time needed to write a dump.  */
+static Lisp_Object
+dump_sort_by_offset (Lisp_Object list)
+{
+  ptrdiff_t n = list_length (list);
+  if (n < 2)
+    return list;
+  struct dump_sort_entry *entries = xnmalloc (n, sizeof *entries);
+  ptrdiff_t i = 0;
+  for (Lisp_Object tail = list; CONSP (tail); tail = XCDR (tail), i++)
+    {
+      entries[i].offset = dump_off_from_lisp (XCAR (XCDR (XCAR (tail))));
+      entries[i].index = i;
+      entries[i].cell = tail;
+    }
+  qsort (entries, n, sizeof *entries, dump_sort_entry_compare);
+  for (i = 0; i < n - 1; i++)
+    XSETCDR (entries[i].cell, entries[i + 1].cell);
+  XSETCDR (entries[n - 1].cell, Qnil);
+  list = entries[0].cell;
+  xfree (entries);
+  return list;
+}
+
 typedef void (*drain_reloc_handler) (struct dump_context *, Lisp_Object);
 typedef Lisp_Object (*drain_reloc_merger) (Lisp_Object a, Lisp_Object b);
 
@@ -3967,8 +4029,7 @@ drain_reloc_list (struct dump_context *ctx,
   Lisp_Object list_reversed, relocs;
   ctx->flags.pack_objects = true;
   list_reversed = Fnreverse (*reloc_list);
-  relocs = CALLN (Fsort, list_reversed,
-		  Qdump_emacs_portable__sort_predicate);
+  relocs = dump_sort_by_offset (list_reversed);
   *reloc_list = Qnil;
   dump_align_output (ctx, max (alignof (struct dump_reloc),
 			       alignof (struct emacs_reloc)));
@@ -4090,8 +4151,7 @@ dump_do_fixups (struct dump_context *ctx)
 {
   dump_off saved_offset = ctx->offset;
   Lisp_Object fixups_reversed = Fnreverse (ctx->fixups);
-  Lisp_Object fixups = CALLN (Fsort, fixups_reversed,
-			      Qdump_emacs_portable__sort_predicate);
+  Lisp_Object fixups = dump_sort_by_offset (fixups_reversed);
   Lisp_Object prev_fixup = Qnil;
   ctx->fixups = Qnil;
   while (!NILP (fixups))
@@ -4438,18 +4498,6 @@ DEFUN ("dump-emacs-portable",
   return unbind_to (count, Qnil);
 }
 
-DEFUN ("dump-emacs-portable--sort-predicate",
-       Fdump_emacs_portable__sort_predicate,
-       Sdump_emacs_portable__sort_predicate,
-       2, 2, 0,
-       doc: /* Internal relocation sorting function.  */)
-     (Lisp_Object a, Lisp_Object b)
-{
-  dump_off a_offset = dump_off_from_lisp (XCAR (XCDR (a)));
-  dump_off b_offset = dump_off_from_lisp (XCAR (XCDR (b)));
-  return a_offset < b_offset ? Qt : Qnil;
-}
-
 DEFUN ("dump-emacs-portable--sort-predicate-copied",
        Fdump_emacs_portable__sort_predicate_copied,
        Sdump_emacs_portable__sort_predicate_copied,
@@ -4738,7 +4786,7 @@ dump_map_file_w32 (void *base, int fd, off_t offset, size_t size,
 #if VM_SUPPORTED == VM_POSIX
 static void *
 dump_map_file_posix (void *base, int fd, off_t offset, size_t size,
-		     enum dump_memory_protection protection)
+		     enum dump_memory_protection protection, bool populate)
 {
   void *ret;
   int mem_prot;
@@ -4764,6 +4812,10 @@ dump_map_file_posix (void *base, int fd, off_t offset, size_t size,
 
   if (base)
     mem_flags |= MAP_FIXED;
+#ifdef MAP_POPULATE
+  if (populate)
+    mem_flags |= MAP_POPULATE;
+#endif
 
   ret = mmap (base, size, mem_prot, mem_flags, fd, offset);
   if (ret == MAP_FAILED)
@@ -4772,14 +4824,17 @@ dump_map_file_posix (void *base, int fd, off_t offset, size_t size,
 }
 #endif
 
-/* Map a file into memory.  */
+/* Map a file into memory.  If POPULATE, we'll touch every page of the
+   mapping soon, so fault it all in now if the system allows; this is
+   much cheaper than taking one page fault at a time.  */
 static void *
 dump_map_file (void *base, int fd, off_t offset, size_t size,
-	       enum dump_memory_protection protection)
+	       enum dump_memory_protection protection, bool populate)
 {
 #if VM_SUPPORTED == VM_POSIX
-  return dump_map_file_posix (base, fd, offset, size, protection);
+  return dump_map_file_posix (base, fd, offset, size, protection, populate);
 #elif VM_SUPPORTED == VM_MS_WINDOWS
+  (void) populate;
   return dump_map_file_w32 (base, fd, offset, size, protection);
 #else
   errno = ENOSYS;
@@ -4815,6 +4870,7 @@ dump_unmap_file (void *addr, size_t size)
   size_t size;  /* Number of bytes to map.  */
   off_t offset;  /* Offset within fd.  */
   enum dump_memory_protection protection;
+  bool populate;  /* Whether to prefault the whole mapping.  */
 };
 
 struct dump_memory_map
@@ -5025,7 +5081,8 @@ dump_mmap_contiguous_vm (struct dump_memory_map *maps, int nr_maps,
 						    spec.protection);
           else
 	    map->mapping = dump_map_file (mem, spec.fd, spec.offset,
-					  spec.size, spec.protection);
+					  spec.size, spec.protection,
+					  spec.populate);
           mem += spec.size;
 	  if (need_retry && map->mapping == NULL
 	      && (errno == EBUSY
@@ -5523,7 +5580,9 @@ dump_do_dump_relocation (const uintptr_t dump_base,
 	/* When resurrecting from a dump given non all the original
 	   native-compiled subrs may be still around we can't rely on
 	   a 'top_level_run' mechanism, we revive them one-by-one
-	   here.  */
+	   here.  Looking up their code is left to the first call, see
+	   'resolve_native_subr', so that startup does not pay for all
+	   the preloaded functions.  */
 	struct Lisp_Subr *subr = dump_ptr (dump_base, reloc_offset);
 	struct Lisp_Native_Comp_Unit *comp_u =
 	  XNATIVE_COMP_UNIT (subr->native_comp_u);
@@ -5531,11 +5590,7 @@ dump_do_dump_relocation (const uintptr_t dump_base,
 	  error ("NULL handle in compilation unit %s", SSDATA (comp_u->file));
 	const char *c_name = subr->native_c_name;
 	eassert (c_name);
-	void *func = dynlib_sym (comp_u->handle, c_name);
-	if (!func)
-	  error ("can't find function \"%s\" in compilation unit %s", c_name,
-		 SSDATA (comp_u->file));
-	subr->function.a0 = func;
+	subr->function.a0 = NULL;
 	Lisp_Object lambda_data_idx =
 	  Fgethash (build_string (c_name), comp_u->lambda_c_name_idx_h, Qnil);
 	if (!NILP (lambda_data_idx))
@@ -5774,12 +5829,18 @@ pdumper_load (const char *dump_filename, char *argv0)
   eassert (adj_discardable_start % dump_page_size == 0);
   eassert (adj_discardable_start <= header->cold_start);
 
+  /* Relocation touches nearly every page of the hot section, and we
+     copy all of the discardable section into the Emacs image, so
+     fault both in up front.  The cold section stays demand-paged, and
+     its pages remain shared with other Emacs processes using the same
+     dump until something writes to them.  */
   sections[DS_HOT].spec = (struct dump_memory_map_spec)
     {
      .fd = dump_fd,
      .size = adj_discardable_start,
      .offset = 0,
      .protection = DUMP_MEMORY_ACCESS_READWRITE,
+     .populate = true,
     };
 
   sections[DS_DISCARDABLE].spec = (struct dump_memory_map_spec)
@@ -5788,6 +5849,7 @@ pdumper_load (const char *dump_filename, char *argv0)
      .size = header->cold_start - adj_discardable_start,
      .offset = adj_discardable_start,
      .protection = DUMP_MEMORY_ACCESS_READWRITE,
+     .populate = true,
     };
 
   sections[DS_COLD].spec = (struct dump_memory_map_spec)
@@ -5957,10 +6019,7 @@ syms_of_pdumper (void)
   char hexbuf[2 * sizeof fingerprint];
 
   defsubr (&Sdump_emacs_portable);
-  defsubr (&Sdump_emacs_portable__sort_predicate);
   defsubr (&Sdump_emacs_portable__sort_predicate_copied);
-  DEFSYM (Qdump_emacs_portable__sort_predicate,
-          "dump-emacs-portable--sort-predicate");
   DEFSYM (Qdump_emacs_portable__sort_predicate_copied,
           "dump-emacs-portable--sort-predicate-copied");
   DEFSYM (Qdumped_with_pdumper, "dumped-with-pdumper");
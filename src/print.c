@@ -36,7 +36,6 @@ Copyright (C) 1985-2025 Free Software Foundation, Inc.
 
 #include <c-ctype.h>
 #include <float.h>
-#include <ftoastr.h>
 #include <math.h>
 
 #if IEEE_FLOATING_POINT
@@ -231,6 +230,17 @@ print_finish (struct print_context *pc)
   unbind_to (pc->specpdl_count, Qnil);
 }
 
+/* Make room for NBYTES more bytes in print_buffer.  */
+
+static void
+print_buffer_reserve (ptrdiff_t nbytes)
+{
+  ptrdiff_t incr = nbytes - (print_buffer.size - print_buffer.pos_byte);
+  if (incr > 0)
+    print_buffer.buffer = xpalloc (print_buffer.buffer, &print_buffer.size,
+				   incr, -1, 1);
+}
+
 /* Print character CH to the stdio stream STREAM.  */
 
 static void
@@ -305,7 +315,16 @@ printchar_to_stream (unsigned int ch, FILE *stream)
 static void
 printchar (unsigned int ch, Lisp_Object fun)
 {
-  if (!NILP (fun) && !EQ (fun, Qt))
+  /* Most characters printed are ASCII characters going to
+     print_buffer, so take a shortcut for them.  */
+  if (NILP (fun) && ASCII_CHAR_P (ch)
+      && print_buffer.pos_byte < print_buffer.size)
+    {
+      maybe_quit ();
+      print_buffer.buffer[print_buffer.pos_byte++] = ch;
+      print_buffer.pos++;
+    }
+  else if (!NILP (fun) && !EQ (fun, Qt))
     calln (fun, make_fixnum (ch));
   else
     {
@@ -316,11 +335,7 @@ printchar (unsigned int ch, Lisp_Object fun)
 
       if (NILP (fun))
 	{
-	  ptrdiff_t incr = len - (print_buffer.size - print_buffer.pos_byte);
-	  if (incr > 0)
-	    print_buffer.buffer = xpalloc (print_buffer.buffer,
-					   &print_buffer.size,
-					   incr, -1, 1);
+	  print_buffer_reserve (len);
 	  memcpy (print_buffer.buffer + print_buffer.pos_byte, str, len);
 	  print_buffer.pos += 1;
 	  print_buffer.pos_byte += len;
@@ -382,10 +397,7 @@ strout (const char *ptr, ptrdiff_t size, ptrdiff_t size_byte,
 {
   if (NILP (printcharfun))
     {
-      ptrdiff_t incr = size_byte - (print_buffer.size - print_buffer.pos_byte);
-      if (incr > 0)
-	print_buffer.buffer = xpalloc (print_buffer.buffer,
-				       &print_buffer.size, incr, -1, 1);
+      print_buffer_reserve (size_byte);
       memcpy (print_buffer.buffer + print_buffer.pos_byte, ptr, size_byte);
       print_buffer.pos += size;
       print_buffer.pos_byte += size_byte;
@@ -1184,7 +1196,7 @@ float_to_string (char *buf, double data)
     {
       /* Generate the fewest number of digits that represent the
 	 floating point value without losing information.  */
-      len = dtoastr (buf, FLOAT_TO_STRING_BUFSIZE - 2, 0, 0, data);
+      len = double_to_string (buf, FLOAT_TO_STRING_BUFSIZE - 2, data);
       /* The decimal point must be printed, or the byte compiler can
 	 get confused (Bug#8033). */
       width = 1;
@@ -1288,7 +1300,7 @@ print (Lisp_Object obj, Lisp_Object printcharfun, bool escapeflag)
 	  struct Lisp_Hash_Table *h = XHASH_TABLE (Vprint_number_table);
 	  DOHASH (h, k, v)
 	    if (EQ (v, Qt))
-	      Fremhash (k, Vprint_number_table);
+	      hash_remove_from_table (h, k);
 	}
     }
 
@@ -1296,6 +1308,22 @@ print (Lisp_Object obj, Lisp_Object printcharfun, bool escapeflag)
   print_object (obj, printcharfun, escapeflag);
 }
 
+/* Return the print-circle status of OBJ in Vprint_number_table, or
+   nil if it has none.  This is called for every object printed, so
+   it avoids the overhead of Fgethash, and the lookup itself when
+   nothing is shared.  */
+static Lisp_Object
+print_number_get (Lisp_Object obj)
+{
+  if (!HASH_TABLE_P (Vprint_number_table))
+    return Qnil;
+  struct Lisp_Hash_Table *h = XHASH_TABLE (Vprint_number_table);
+  if (h->count == 0)
+    return Qnil;
+  ptrdiff_t i = hash_lookup (h, obj);
+  return i < 0 ? Qnil : HASH_VALUE (h, i);
+}
+
 #define PRINT_CIRCLE_CANDIDATE_P(obj)			   \
   (STRINGP (obj)                                           \
    || CONSP (obj)					   \
@@ -1402,9 +1430,15 @@ print_preprocess (Lisp_Object obj)
       if (PRINT_CIRCLE_CANDIDATE_P (obj))
 	{
 	  if (!HASH_TABLE_P (Vprint_number_table))
-	    Vprint_number_table = CALLN (Fmake_hash_table, QCtest, Qeq);
+	    Vprint_number_table = make_hash_table (&hashtest_eq,
+						   DEFAULT_HASH_SIZE,
+						   Weak_None);
 
-	  Lisp_Object num = Fgethash (obj, Vprint_number_table, Qnil);
+	  /* Look OBJ up only once, and update its entry in place.  */
+	  struct Lisp_Hash_Table *h = XHASH_TABLE (Vprint_number_table);
+	  hash_hash_t hash;
+	  ptrdiff_t i = hash_lookup_get_hash (h, obj, &hash);
+	  Lisp_Object num = i < 0 ? Qnil : HASH_VALUE (h, i);
 	  if (!NILP (num)
 	      /* If Vprint_continuous_numbering is non-nil and OBJ is a gensym,
 		 always print the gensym with a number.  This is a special for
@@ -1417,14 +1451,17 @@ print_preprocess (Lisp_Object obj)
 		{
 		  print_number_index++;
 		  /* Negative number indicates it hasn't been printed yet.  */
-		  Fputhash (obj, make_fixnum (- print_number_index),
-			    Vprint_number_table);
+		  Lisp_Object value = make_fixnum (- print_number_index);
+		  if (i < 0)
+		    hash_put (h, obj, value, hash);
+		  else
+		    set_hash_value_slot (h, i, value);
 		}
 	    }
 	  else
 	    {
 	      /* OBJ is not yet recorded.  Let's add to the table.  */
-	      Fputhash (obj, Qt, Vprint_number_table);
+	      hash_put (h, obj, Qt, hash);
 
 	      switch (XTYPE (obj))
 		{
@@ -1965,6 +2002,19 @@ print_vectorlike_unreadable (Lisp_Object obj, Lisp_Object printcharfun,
       printchar ('>', printcharfun);
       return;
 
+    case PVEC_CHANNEL:
+      print_c_string ("#<channel ", printcharfun);
+      if (STRINGP (XCHANNEL (obj)->name))
+	print_string (XCHANNEL (obj)->name, printcharfun);
+      else
+	{
+	  void *p = XCHANNEL (obj);
+	  int len = sprintf (buf, "%p", p);
+	  strout (buf, len, len, printcharfun);
+	}
+      printchar ('>', printcharfun);
+      return;
+
     case PVEC_MODULE_FUNCTION:
 #ifdef HAVE_MODULES
       {
@@ -2083,6 +2133,30 @@ print_vectorlike_unreadable (Lisp_Object obj, Lisp_Object printcharfun,
       }
       return;
 
+    case PVEC_JSON_PARSER:
+      {
+	struct Lisp_JSON_Parser *jp = XJSON_PARSER (obj);
+	int i = sprintf (buf, "#<json-parser pending=%"pD"d>",
+			 jp->input_bytes - jp->start);
+	strout (buf, i, i, printcharfun);
+	return;
+      }
+
+    case PVEC_REGION_CACHE:
+      {
+	struct buffer *b = XBUFFER (XREGION_CACHE (obj)->buffer);
+	print_c_string ("#<region-cache ", printcharfun);
+	if (BUFFER_LIVE_P (b))
+	  {
+	    print_c_string ("in ", printcharfun);
+	    print_string (BVAR (b, name), printcharfun);
+	  }
+	else
+	  print_c_string ("in killed buffer", printcharfun);
+	printchar ('>', printcharfun);
+	return;
+      }
+
     case PVEC_OBARRAY:
       {
 	struct Lisp_Obarray *o = XOBARRAY (obj);
@@ -2260,7 +2334,7 @@ print_object (Lisp_Object obj, Lisp_Object printcharfun, bool escapeflag)
   else if (PRINT_CIRCLE_CANDIDATE_P (obj))
     {
       /* With the print-circle feature.  */
-      Lisp_Object num = Fgethash (obj, Vprint_number_table, Qnil);
+      Lisp_Object num = print_number_get (obj);
       if (FIXNUMP (num))
 	{
 	  EMACS_INT n = XFIXNUM (num);
@@ -2270,7 +2344,8 @@ print_object (Lisp_Object obj, Lisp_Object printcharfun, bool escapeflag)
 	      int len = sprintf (buf, "#%"pI"d=", -n);
 	      strout (buf, len, len, printcharfun);
 	      /* OBJ is going to be printed.  Remember that fact.  */
-	      Fputhash (obj, make_fixnum (- n), Vprint_number_table);
+	      struct Lisp_Hash_Table *h = XHASH_TABLE (Vprint_number_table);
+	      set_hash_value_slot (h, hash_lookup (h, obj), make_fixnum (- n));
 	    }
 	  else
 	    {
@@ -2675,8 +2750,7 @@ print_object (Lisp_Object obj, Lisp_Object printcharfun, bool escapeflag)
 		if (!NILP (Vprint_circle))
 		  {
 		    /* With the print-circle feature.  */
-		    Lisp_Object num = Fgethash (next, Vprint_number_table,
-						Qnil);
+		    Lisp_Object num = print_number_get (next);
 		    if (!(NILP (num) || EQ (num, Qt)))
 		      {
 			print_c_string (" . ", printcharfun);
@@ -2818,6 +2892,452 @@ print_interval (INTERVAL interval, void *pprintcharfun)
   print_object (interval->plist, printcharfun, 1);
 }
 
+/* Printing objects in binary form.
+
+   print--binary produces the representation that the reader reads
+   back after the "#%" syntax, designed to be read quickly: it starts
+   with a table of the symbols in the object, so that each one needs
+   to be interned only once, and the rest is a tree of tagged objects
+   whose sizes are given in advance, with no escapes to process.  The
+   tags and the layout are described along with enum binary_tag in
+   lisp.h.  */
+
+struct binary_writer
+{
+  /* The binary output, of LEN bytes, in a buffer of SIZE bytes.  */
+  char *buf;
+  ptrdiff_t len, size;
+
+  /* An eq hash table that maps each cons, vector, record, closure or
+     string in the object to t while its components are being scanned,
+     and to the number of times it occurs after that.  */
+  Lisp_Object seen;
+
+  /* An eq hash table that maps symbols to their index in the symbol
+     table, and the list of symbols in reverse order of index.  */
+  Lisp_Object symbols;
+  Lisp_Object symbol_list;
+
+  /* An eq hash table that maps the objects that occur several times to
+     their index.  */
+  Lisp_Object shared;
+
+  /* The object that stands for the value of `load-file-name'.  */
+  Lisp_Object load_file_name;
+};
+
+static void
+binary_writer_free (void *arg)
+{
+  struct binary_writer *w = arg;
+  xfree (w->buf);
+}
+
+static void
+binary_put_bytes (struct binary_writer *w, const char *bytes, ptrdiff_t n)
+{
+  if (w->size - w->len < n)
+    w->buf = xpalloc (w->buf, &w->size, n - (w->size - w->len), -1, 1);
+  memcpy (w->buf + w->len, bytes, n);
+  w->len += n;
+}
+
+static void
+binary_put_byte (struct binary_writer *w, unsigned char c)
+{
+  binary_put_bytes (w, (char *) &c, 1);
+}
+
+static void
+binary_put_uint (struct binary_writer *w, uintmax_t n)
+{
+  unsigned char bytes[(sizeof n * CHAR_BIT + 6) / 7];
+  int i = 0;
+  do
+    {
+      bytes[i] = n & 0x7f;
+      n >>= 7;
+      if (n)
+	bytes[i] |= 0x80;
+      i++;
+    }
+  while (n);
+  binary_put_bytes (w, (char *) bytes, i);
+}
+
+/* Return true if OBJ, one of several occurrences of the same object,
+   should be represented by a reference to the first one.  This
+   matches the objects that `print-circle' numbers.  */
+
+static bool
+binary_shareable_p (Lisp_Object obj)
+{
+  return (CONSP (obj) || VECTORP (obj) || RECORDP (obj) || CLOSUREP (obj)
+	  || HASH_TABLE_P (obj) || (STRINGP (obj) && SCHARS (obj) > 0));
+}
+
+/* Record an occurrence of OBJ, and return true if its components need
+   to be scanned because this is the first one.  Return false and set
+   *CYCLE if OBJ is one of its own components.  */
+
+static bool
+binary_scan_enter (struct binary_writer *w, Lisp_Object obj, bool *cycle)
+{
+  struct Lisp_Hash_Table *h = XHASH_TABLE (w->seen);
+  hash_hash_t hash;
+  ptrdiff_t i = hash_lookup_get_hash (h, obj, &hash);
+  if (i < 0)
+    {
+      hash_put (h, obj, Qt, hash);
+      return true;
+    }
+  Lisp_Object n = HASH_VALUE (h, i);
+  if (EQ (n, Qt))
+    *cycle = true;
+  else
+    set_hash_value_slot (h, i, make_fixnum (XFIXNUM (n) + 1));
+  return false;
+}
+
+static void
+binary_scan_leave (struct binary_writer *w, Lisp_Object obj)
+{
+  Fputhash (obj, make_fixnum (1), w->seen);
+}
+
+/* Scan OBJ, at nesting depth DEPTH, to build the symbol table and
+   find the objects that occur several times.  Return false if OBJ
+   can't be printed in binary form.  */
+
+static bool
+binary_scan (struct binary_writer *w, Lisp_Object obj, int depth)
+{
+  bool cycle = false;
+
+  if (depth > BINARY_MAX_DEPTH)
+    return false;
+  if (EQ (obj, w->load_file_name))
+    return true;
+
+  switch (XTYPE (obj))
+    {
+    case Lisp_Int0:
+    case Lisp_Int1:
+    case Lisp_Float:
+      return true;
+
+    case Lisp_Symbol:
+      if (NILP (Fgethash (obj, w->symbols, Qnil)))
+	{
+	  Fputhash (obj, make_fixnum (list_length (w->symbol_list)),
+		    w->symbols);
+	  w->symbol_list = Fcons (obj, w->symbol_list);
+	}
+      return true;
+
+    case Lisp_String:
+      if (string_intervals (obj))
+	return false;
+      if (SCHARS (obj) > 0)
+	{
+	  binary_scan_enter (w, obj, &cycle);
+	  binary_scan_leave (w, obj);
+	}
+      return true;
+
+    case Lisp_Cons:
+      {
+	/* Scan the conses of a list one after the other, but keep them
+	   all open until the list ends, to detect a cycle through its
+	   cdrs.  */
+	Lisp_Object head = obj;
+	for (; CONSP (obj); obj = XCDR (obj))
+	  {
+	    if (!binary_scan_enter (w, obj, &cycle))
+	      break;
+	    if (!binary_scan (w, XCAR (obj), depth + 1))
+	      return false;
+	  }
+	if (cycle || (!CONSP (obj) && !binary_scan (w, obj, depth + 1)))
+	  return false;
+	for (; !BASE_EQ (head, obj); head = XCDR (head))
+	  binary_scan_leave (w, head);
+	return true;
+      }
+
+    case Lisp_Vectorlike:
+      if (BIGNUMP (obj) || BOOL_VECTOR_P (obj))
+	return true;
+      if (HASH_TABLE_P (obj))
+	{
+	  if (binary_scan_enter (w, obj, &cycle))
+	    {
+	      struct Lisp_Hash_Table *h = XHASH_TABLE (obj);
+	      if (!binary_scan (w, h->test->name, depth + 1)
+		  || !binary_scan (w, hash_table_weakness_symbol (h->weakness),
+				   depth + 1))
+		return false;
+	      DOHASH (h, k, v)
+		if (!binary_scan (w, k, depth + 1)
+		    || !binary_scan (w, v, depth + 1))
+		  return false;
+	      binary_scan_leave (w, obj);
+	    }
+	  return !cycle;
+	}
+      if (!(VECTORP (obj) || RECORDP (obj) || CLOSUREP (obj)))
+	return false;
+      if (binary_scan_enter (w, obj, &cycle))
+	{
+	  ptrdiff_t size = VECTORP (obj) ? ASIZE (obj) : PVSIZE (obj);
+	  for (ptrdiff_t i = 0; i < size; i++)
+	    if (!binary_scan (w, AREF (obj, i), depth + 1))
+	      return false;
+	  binary_scan_leave (w, obj);
+	}
+      return !cycle;
+
+    default:
+      return false;
+    }
+}
+
+/* Print the elements of vector-like OBJ, after its tag.  */
+
+static void binary_print (struct binary_writer *, Lisp_Object);
+
+static void
+binary_print_elements (struct binary_writer *w, enum binary_tag tag,
+		       Lisp_Object obj)
+{
+  ptrdiff_t size = VECTORP (obj) ? ASIZE (obj) : PVSIZE (obj);
+  binary_put_byte (w, tag);
+  binary_put_uint (w, size);
+  for (ptrdiff_t i = 0; i < size; i++)
+    binary_print (w, AREF (obj, i));
+}
+
+static void
+binary_print (struct binary_writer *w, Lisp_Object obj)
+{
+  if (EQ (obj, w->load_file_name))
+    {
+      binary_put_byte (w, BINARY_LOAD_FILE_NAME);
+      return;
+    }
+
+  if (binary_shareable_p (obj)
+      && XFIXNUM (Fgethash (obj, w->seen, make_fixnum (1))) > 1)
+    {
+      Lisp_Object index = Fgethash (obj, w->shared, Qnil);
+      if (!NILP (index))
+	{
+	  binary_put_byte (w, BINARY_REFERENCE);
+	  binary_put_uint (w, XFIXNAT (index));
+	  return;
+	}
+      index = make_fixnum (XHASH_TABLE (w->shared)->count);
+      Fputhash (obj, index, w->shared);
+      binary_put_byte (w, BINARY_DEFINITION);
+      binary_put_uint (w, XFIXNAT (index));
+    }
+
+  switch (XTYPE (obj))
+    {
+    case Lisp_Int0:
+    case Lisp_Int1:
+      {
+	EMACS_INT n = XFIXNUM (obj);
+	binary_put_byte (w, BINARY_FIXNUM);
+	/* Interleave negative and nonnegative numbers, so that numbers
+	   of small magnitude take few bytes.  */
+	binary_put_uint (w, n < 0 ? ((EMACS_UINT) -(n + 1) << 1) | 1
+			 : (EMACS_UINT) n << 1);
+      }
+      break;
+
+    case Lisp_Float:
+      {
+	union { double d; uint64_t u; } u = { .d = XFLOAT_DATA (obj) };
+	binary_put_byte (w, BINARY_FLOAT);
+	for (int i = 7; i >= 0; i--)
+	  binary_put_byte (w, u.u >> (8 * i));
+      }
+      break;
+
+    case Lisp_Symbol:
+      binary_put_byte (w, BINARY_SYMBOL);
+      binary_put_uint (w, XFIXNAT (Fgethash (obj, w->symbols, Qnil)));
+      break;
+
+    case Lisp_String:
+      if (STRING_MULTIBYTE (obj))
+	{
+	  binary_put_byte (w, BINARY_MULTIBYTE_STRING);
+	  binary_put_uint (w, SCHARS (obj));
+	}
+      else
+	binary_put_byte (w, BINARY_UNIBYTE_STRING);
+      binary_put_uint (w, SBYTES (obj));
+      binary_put_bytes (w, SSDATA (obj), SBYTES (obj));
+      break;
+
+    case Lisp_Cons:
+      {
+	/* The list goes on until a cons that occurs elsewhere too,
+	   which is printed as the tail of the list.  */
+	ptrdiff_t n = 1;
+	Lisp_Object tail = XCDR (obj);
+	for (; CONSP (tail); tail = XCDR (tail), n++)
+	  if (XFIXNUM (Fgethash (tail, w->seen, make_fixnum (1))) > 1)
+	    break;
+	binary_put_byte (w, BINARY_LIST);
+	binary_put_uint (w, n);
+	for (; n > 0; n--, obj = XCDR (obj))
+	  binary_print (w, XCAR (obj));
+	binary_print (w, tail);
+      }
+      break;
+
+    default:
+      if (BIGNUMP (obj))
+	{
+	  Lisp_Object digits = bignum_to_string (obj, 10);
+	  binary_put_byte (w, BINARY_BIGNUM);
+	  binary_put_uint (w, SBYTES (digits));
+	  binary_put_bytes (w, SSDATA (digits), SBYTES (digits));
+	}
+      else if (BOOL_VECTOR_P (obj))
+	{
+	  binary_put_byte (w, BINARY_BOOL_VECTOR);
+	  binary_put_uint (w, bool_vector_size (obj));
+	  binary_put_bytes (w, (char *) bool_vector_uchar_data (obj),
+			    bool_vector_bytes (bool_vector_size (obj)));
+	}
+      else if (VECTORP (obj))
+	binary_print_elements (w, BINARY_VECTOR, obj);
+      else if (RECORDP (obj))
+	binary_print_elements (w, BINARY_RECORD, obj);
+      else if (HASH_TABLE_P (obj))
+	{
+	  struct Lisp_Hash_Table *h = XHASH_TABLE (obj);
+	  binary_put_byte (w, BINARY_HASH_TABLE);
+	  binary_print (w, h->test->name);
+	  binary_print (w, hash_table_weakness_symbol (h->weakness));
+	  binary_put_uint (w, h->count);
+	  DOHASH (h, k, v)
+	    {
+	      binary_print (w, k);
+	      binary_print (w, v);
+	    }
+	}
+      else
+	{
+	  eassert (CLOSUREP (obj));
+	  binary_print_elements (w, BINARY_CLOSURE, obj);
+	}
+      break;
+    }
+}
+
+/* Return the binary representation of OBJECT as a unibyte string,
+   without the "#%" syntax around it, or nil if OBJECT can't be
+   represented.  Represent the occurrences of LOAD_FILE_NAME in OBJECT
+   by BINARY_LOAD_FILE_NAME, unless it is Qunbound.  */
+
+static Lisp_Object
+binary_representation (Lisp_Object object, Lisp_Object load_file_name)
+{
+  struct binary_writer w = {
+    .seen = make_hash_table (&hashtest_eq, DEFAULT_HASH_SIZE, Weak_None),
+    .symbols = make_hash_table (&hashtest_eq, DEFAULT_HASH_SIZE, Weak_None),
+    .symbol_list = Qnil,
+    .shared = make_hash_table (&hashtest_eq, DEFAULT_HASH_SIZE, Weak_None),
+    .load_file_name = load_file_name,
+  };
+
+  if (!binary_scan (&w, object, 0))
+    return Qnil;
+
+  specpdl_ref count = SPECPDL_INDEX ();
+  record_unwind_protect_ptr (binary_writer_free, &w);
+
+  binary_put_byte (&w, BINARY_VERSION);
+  Lisp_Object symbols = Fnreverse (w.symbol_list);
+  binary_put_uint (&w, list_length (symbols));
+  for (; CONSP (symbols); symbols = XCDR (symbols))
+    {
+      Lisp_Object sym = XCAR (symbols);
+      Lisp_Object name = SYMBOL_NAME (sym);
+      binary_put_byte (&w, ((SYMBOL_INTERNED_P (sym) ? 0 : BINARY_UNINTERNED)
+			    | (STRING_MULTIBYTE (name) ? BINARY_MULTIBYTE : 0)));
+      if (STRING_MULTIBYTE (name))
+	binary_put_uint (&w, SCHARS (name));
+      binary_put_uint (&w, SBYTES (name));
+      binary_put_bytes (&w, SSDATA (name), SBYTES (name));
+    }
+
+  ptrdiff_t nshared = 0;
+  DOHASH (XHASH_TABLE (w.seen), k, v)
+    if (XFIXNUM (v) > 1)
+      nshared++;
+  binary_put_uint (&w, nshared);
+  binary_print (&w, object);
+
+  return unbind_to (count, make_unibyte_string (w.buf, w.len));
+}
+
+DEFUN ("print--binary", Fprint_binary, Sprint_binary, 1, 2, 0,
+       doc: /* Return the binary printed representation of OBJECT, or nil.
+The value is a string that `read' reads as an object `equal' to
+OBJECT, in which the same components are shared as in OBJECT, like
+with `print-circle'.  It is meant for compiled Lisp files, and can be
+read faster than the output of `prin1'.
+
+If LOAD-FILE-NAME is non-nil, the occurrences of it in OBJECT are read
+as the value of `load-file-name', like `#$'.
+
+Return nil if OBJECT can't be printed this way, because it is
+circular, because it is too deeply nested, or because it contains
+strings with text properties or objects other than numbers, symbols,
+strings, conses, vectors, records, bool-vectors, hash tables and
+closures.  */)
+  (Lisp_Object object, Lisp_Object load_file_name)
+{
+  Lisp_Object data
+    = binary_representation (object, (NILP (load_file_name) ? Qunbound
+				      : load_file_name));
+  if (NILP (data))
+    return Qnil;
+  Lisp_Object encoded = Fbase64_encode_string (data, Qt);
+  AUTO_STRING (prefix, "#%");
+  AUTO_STRING (space, " ");
+  return CALLN (Fconcat, prefix,
+		Fnumber_to_string (make_fixnum (SBYTES (encoded))),
+		space, encoded);
+}
+
+DEFUN ("serialize", Fserialize, Sserialize, 1, 1, 0,
+       doc: /* Return a unibyte string that represents OBJECT in binary form.
+`deserialize' converts the string back to an object `equal' to OBJECT,
+in which the same components are shared as in OBJECT.  This is
+meant for saving large amounts of data, such as caches, to files:
+the string is much smaller than the printed representation of
+OBJECT, and `deserialize' is much faster than `read'.
+
+OBJECT may contain numbers, symbols, strings without text properties,
+conses, vectors, records, bool-vectors, hash tables and byte-code
+functions, nested up to a depth of 1000.  It may not be circular.
+Signal an error if OBJECT can't be serialized.  */)
+  (Lisp_Object object)
+{
+  Lisp_Object data = binary_representation (object, Qunbound);
+  if (NILP (data))
+    signal_error ("Object cannot be serialized", object);
+  return data;
+}
+
+
 /* Initialize debug_print stuff early to have it working from the very
    beginning.  */
 
@@ -2988,6 +3508,8 @@ syms_of_print (void)
   defsubr (&Swrite_char);
   defsubr (&Sredirect_debugging_output);
   defsubr (&Sprint_preprocess);
+  defsubr (&Sprint_binary);
+  defsubr (&Sserialize);
 
   DEFSYM (Qprint_escape_multibyte, "print-escape-multibyte");
   DEFSYM (Qprint_escape_nonascii, "print-escape-nonascii");
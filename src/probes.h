@@ -0,0 +1,41 @@
+/* Static probes for tracing Emacs.
+
+Copyright 2025 Free Software Foundation, Inc.
+
+This file is part of GNU Emacs.
+
+GNU Emacs is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or (at
+your option) any later version.
+
+GNU Emacs is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with GNU Emacs.  If not, see <https://www.gnu.org/licenses/>.  */
+
+#ifndef EMACS_PROBES_H
+#define EMACS_PROBES_H
+
+/* When Emacs is configured --with-sdt, these macros define USDT
+   probes of the "emacs" provider, which SystemTap, DTrace, bpftrace
+   and perf can attach to, e.g. as "usdt:emacs:gc_start" in bpftrace.
+   An unused probe costs a no-op instruction and the computation of
+   its arguments, so these should be cheap.  Without --with-sdt the
+   macros expand to nothing.  */
+
+#ifdef HAVE_SYS_SDT_H
+# include <sys/sdt.h>
+# define EMACS_PROBE(name) DTRACE_PROBE (emacs, name)
+# define EMACS_PROBE1(name, a1) DTRACE_PROBE1 (emacs, name, a1)
+# define EMACS_PROBE2(name, a1, a2) DTRACE_PROBE2 (emacs, name, a1, a2)
+#else
+# define EMACS_PROBE(name) ((void) 0)
+# define EMACS_PROBE1(name, a1) ((void) 0)
+# define EMACS_PROBE2(name, a1, a2) ((void) 0)
+#endif
+
+#endif /* EMACS_PROBES_H */
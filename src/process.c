@@ -92,6 +92,10 @@ #define HAVE_LOCAL_SOCKETS
 #include <pty.h>
 #endif
 
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
+
 #include <c-ctype.h>
 #include <flexmember.h>
 #include <nproc.h>
@@ -115,6 +119,7 @@ #define HAVE_LOCAL_SOCKETS
 #include "sysselect.h"
 #include "syssignal.h"
 #include "syswait.h"
+#include "probes.h"
 #ifdef HAVE_GNUTLS
 #include "gnutls.h"
 #endif
@@ -135,11 +140,124 @@ #define HAVE_LOCAL_SOCKETS
 #endif
 #endif
 
-#if defined HAVE_GETADDRINFO_A || defined HAVE_GNUTLS
+#if defined HAVE_ASYNC_DNS || defined HAVE_GNUTLS
 /* This is 0.1s in nanoseconds. */
 #define ASYNC_RETRY_NSEC 100000000
 #endif
 
+#if defined HAVE_ASYNC_DNS && !defined HAVE_GETADDRINFO_A
+
+/* Emulate the part of getaddrinfo_a that this file uses, by calling
+   getaddrinfo in a detached thread for each request.  A lookup that
+   is in progress cannot be canceled, as with getaddrinfo_a.  */
+
+# include <pthread.h>
+
+# ifndef EAI_INPROGRESS
+#  define EAI_INPROGRESS (-100)
+# endif
+# ifndef EAI_NOTCANCELED
+#  define EAI_NOTCANCELED (-102)
+# endif
+# ifndef EAI_ALLDONE
+#  define EAI_ALLDONE (-103)
+# endif
+# define GAI_NOWAIT 1
+
+struct gaicb
+{
+  char const *ar_name;
+  char const *ar_service;
+  struct addrinfo const *ar_request;
+  struct addrinfo *ar_result;
+
+  /* The value of getaddrinfo, or EAI_INPROGRESS until it returns.
+     This and ar_result are protected by MUTEX.  */
+  int status;
+  pthread_mutex_t mutex;
+  pthread_cond_t done;
+};
+
+static void *
+dns_lookup_thread (void *arg)
+{
+  struct gaicb *req = arg;
+  struct addrinfo *res = NULL;
+  int status = getaddrinfo (req->ar_name, req->ar_service,
+			    req->ar_request, &res);
+  pthread_mutex_lock (&req->mutex);
+  req->ar_result = res;
+  req->status = status;
+  pthread_cond_broadcast (&req->done);
+  pthread_mutex_unlock (&req->mutex);
+  return NULL;
+}
+
+static int
+emacs_getaddrinfo_a (int mode, struct gaicb *list[], int nitems,
+		     struct sigevent *sevp)
+{
+  eassert (mode == GAI_NOWAIT && nitems == 1 && !sevp);
+  struct gaicb *req = list[0];
+  req->status = EAI_INPROGRESS;
+  pthread_mutex_init (&req->mutex, NULL);
+  pthread_cond_init (&req->done, NULL);
+  pthread_attr_t attr;
+  pthread_t thread;
+  bool created = false;
+  if (pthread_attr_init (&attr) == 0)
+    {
+      created = (pthread_attr_setdetachstate (&attr,
+					      PTHREAD_CREATE_DETACHED) == 0
+		 && pthread_create (&thread, &attr, dns_lookup_thread,
+				    req) == 0);
+      pthread_attr_destroy (&attr);
+    }
+  if (!created)
+    {
+      pthread_cond_destroy (&req->done);
+      pthread_mutex_destroy (&req->mutex);
+      return EAI_AGAIN;
+    }
+  return 0;
+}
+
+static int
+emacs_gai_error (struct gaicb *req)
+{
+  pthread_mutex_lock (&req->mutex);
+  int status = req->status;
+  pthread_mutex_unlock (&req->mutex);
+  return status;
+}
+
+static int
+emacs_gai_cancel (struct gaicb *req)
+{
+  return emacs_gai_error (req) == EAI_INPROGRESS ? EAI_NOTCANCELED
+	 : EAI_ALLDONE;
+}
+
+static int
+emacs_gai_suspend (struct gaicb const *const list[], int nitems,
+		   struct timespec const *timeout)
+{
+  eassert (nitems == 1 && !timeout);
+  struct gaicb *req = (struct gaicb *) list[0];
+  pthread_mutex_lock (&req->mutex);
+  while (req->status == EAI_INPROGRESS)
+    pthread_cond_wait (&req->done, &req->mutex);
+  pthread_mutex_unlock (&req->mutex);
+  return 0;
+}
+
+# define getaddrinfo_a emacs_getaddrinfo_a
+# define gai_error emacs_gai_error
+# define gai_cancel emacs_gai_cancel
+# define gai_suspend emacs_gai_suspend
+
+#endif /* HAVE_ASYNC_DNS && !HAVE_GETADDRINFO_A */
+
 #ifdef WINDOWSNT
 extern int sys_select (int, fd_set *, fd_set *, fd_set *,
                        const struct timespec *, const sigset_t *);
@@ -264,7 +382,14 @@ #define READ_OUTPUT_DELAY_MAX_MAX   (READ_OUTPUT_DELAY_INCREMENT * 7)
 
 static bool process_output_skip;
 
+/* Number of processes which might have output held back for their
+   filter by `set-process-filter-batch'.  */
+
+static int process_filter_batch_count;
+
 static void start_process_unwind (Lisp_Object);
+static void flush_process_filter_batch (struct Lisp_Process *);
+static struct timespec flush_expired_filter_batches (struct Lisp_Process *);
 static void create_process (Lisp_Object, char **, Lisp_Object);
 #if defined (USABLE_SIGIO) || defined (USABLE_SIGPOLL)
 static bool keyboard_bit_set (fd_set *);
@@ -379,6 +504,16 @@ pset_filter (struct Lisp_Process *p, Lisp_Object val)
   p->filter = NILP (val) ? Qinternal_default_process_filter : val;
 }
 static void
+pset_filter_batch (struct Lisp_Process *p, Lisp_Object val)
+{
+  p->filter_batch = val;
+}
+static void
+pset_json_parser (struct Lisp_Process *p, Lisp_Object val)
+{
+  p->json_parser = val;
+}
+static void
 pset_log (struct Lisp_Process *p, Lisp_Object val)
 {
   p->log = val;
@@ -495,6 +630,11 @@ add_process_read_fd (int fd)
 
   fd_callback_info[fd].flags &= ~KEYBOARD_FD;
   fd_callback_info[fd].flags |= FOR_READ;
+  /* A thread that was waiting for an earlier user of this descriptor
+     may have left its mark here if the descriptor was above max_desc
+     when it cleared its waiting state.  Nobody can be waiting for a
+     descriptor that was only just opened.  */
+  fd_callback_info[fd].waiting_thread = NULL;
   if (fd > max_desc)
     max_desc = fd;
   eassert (0 <= fd && fd < FD_SETSIZE);
@@ -986,7 +1126,7 @@ update_processes_for_thread_death (Lisp_Object dying_thread)
     }
 }
 
-#ifdef HAVE_GETADDRINFO_A
+#ifdef HAVE_ASYNC_DNS
 static void
 free_dns_request (Lisp_Object proc)
 {
@@ -994,6 +1134,10 @@ free_dns_request (Lisp_Object proc)
 
   if (p->dns_request->ar_result)
     freeaddrinfo (p->dns_request->ar_result);
+#ifndef HAVE_GETADDRINFO_A
+  pthread_cond_destroy (&p->dns_request->done);
+  pthread_mutex_destroy (&p->dns_request->mutex);
+#endif
   xfree (p->dns_request);
   p->dns_request = NULL;
 }
@@ -1022,7 +1166,7 @@ DEFUN ("get-process", Fget_process, Sget_process, 1, 1, 0,
    Buffers denote the first process in the buffer, and nil denotes the
    current buffer.  */
 
-static Lisp_Object
+Lisp_Object
 get_process (register Lisp_Object name)
 {
   register Lisp_Object proc, obj;
@@ -1100,7 +1244,7 @@ DEFUN ("delete-process", Fdelete_process, Sdelete_process, 0, 1,
   process = get_process (process);
   p = XPROCESS (process);
 
-#ifdef HAVE_GETADDRINFO_A
+#ifdef HAVE_ASYNC_DNS
   if (p->dns_request)
     {
       /* Cancel the request.  Unless shutting down, wait until
@@ -1403,6 +1547,18 @@ DEFUN ("set-process-filter", Fset_process_filter, Sset_process_filter,
   return filter;
 }
 
+DEFUN ("process-read-output-max", Fprocess_read_output_max,
+       Sprocess_read_output_max, 1, 1, 0,
+       doc: /* Return the number of bytes Emacs reads at most from PROCESS at once.
+This starts out as the value of `read-process-output-max' when PROCESS
+was created, and changes with the amount of output PROCESS produces if
+`read-process-output-adaptive-max' is non-nil.  */)
+  (Lisp_Object process)
+{
+  CHECK_PROCESS (process);
+  return make_fixnum (XPROCESS (process)->readmax);
+}
+
 DEFUN ("process-filter", Fprocess_filter, Sprocess_filter,
        1, 1, 0,
        doc: /* Return the filter function of PROCESS.
@@ -1413,6 +1569,116 @@ DEFUN ("process-filter", Fprocess_filter, Sprocess_filter,
   return XPROCESS (process)->filter;
 }
 
+/* Set how output of P is batched for its filter to MS milliseconds
+   and BYTES bytes, which must be natural numbers or nil.  */
+
+static void
+set_process_filter_batch (struct Lisp_Process *p, Lisp_Object ms,
+			  Lisp_Object bytes)
+{
+  if (!NILP (ms))
+    CHECK_FIXNAT (ms);
+  if (!NILP (bytes))
+    CHECK_FIXNAT (bytes);
+  p->filter_batch_ms = NILP (ms) ? 0 : clip_to_bounds (0, XFIXNAT (ms),
+							INT_MAX);
+  p->filter_batch_bytes = NILP (bytes) ? 0 : XFIXNAT (bytes);
+}
+
+DEFUN ("set-process-filter-batch", Fset_process_filter_batch,
+       Sset_process_filter_batch, 2, 3, 0,
+       doc: /* Make PROCESS pass its output to the filter in batches.
+Output that arrives is held back for up to MS milliseconds, and then
+everything that arrived in that time is passed to the filter of
+PROCESS in one call.  If BYTES is a positive number, the held back
+output is also passed as soon as there are at least BYTES bytes of it.
+This saves the overhead of calling the filter for every chunk that is
+read from a process that produces a lot of output, at the price of
+delaying the output by up to MS milliseconds.
+
+If MS is nil or 0, pass every chunk to the filter as it is read, and
+pass any output that is still held back right now.
+
+Output that is held back is passed to whatever filter PROCESS has when
+the delay is up.  It is always passed before the sentinel of PROCESS
+is called.  This has no effect when the output of PROCESS is inserted
+into its buffer by the default filter, because that doesn't involve
+calling Lisp.  */)
+  (Lisp_Object process, Lisp_Object ms, Lisp_Object bytes)
+{
+  CHECK_PROCESS (process);
+  struct Lisp_Process *p = XPROCESS (process);
+  set_process_filter_batch (p, ms, bytes);
+  if (p->filter_batch_ms == 0)
+    flush_process_filter_batch (p);
+  return Qnil;
+}
+
+DEFUN ("process-filter-batch", Fprocess_filter_batch, Sprocess_filter_batch,
+       1, 1, 0,
+       doc: /* Return how PROCESS passes its output to the filter in batches.
+The value is nil if each chunk is passed as it is read, or a cons
+\(MS . BYTES) as given to `set-process-filter-batch'.  */)
+  (Lisp_Object process)
+{
+  CHECK_PROCESS (process);
+  struct Lisp_Process *p = XPROCESS (process);
+  if (p->filter_batch_ms == 0)
+    return Qnil;
+  return Fcons (make_fixnum (p->filter_batch_ms),
+		p->filter_batch_bytes ? make_fixnum (p->filter_batch_bytes) : Qnil);
+}
+
+/* Return the JSON parser for the output of a process that FRAMING
+   describes, as given to `set-process-framing'.  */
+
+static Lisp_Object
+process_framing_parser (Lisp_Object framing)
+{
+  if (NILP (framing) || JSON_PARSERP (framing))
+    return framing;
+  if (EQ (framing, Qjsonrpc))
+    return CALLN (Fjson_make_parser, QCframing, Qcontent_length);
+  if (EQ (framing, Qndjson))
+    return Fjson_make_parser (0, NULL);
+  wrong_choice (list3 (Qnil, Qjsonrpc, Qndjson), framing);
+}
+
+DEFUN ("set-process-framing", Fset_process_framing, Sset_process_framing,
+       2, 2, 0,
+       doc: /* Make PROCESS pass the JSON values in its output to the filter.
+FRAMING says how the values are delimited in the output of PROCESS.
+It can be `jsonrpc', where each value is preceded by headers that
+include its Content-Length, as in the Language Server Protocol;
+`ndjson', where the values are separated by newlines or other
+whitespace; or a parser made by `json-make-parser', when the values
+should be parsed with other options than the defaults.
+
+The filter of PROCESS is then called with each value as soon as it has
+been read and parsed, instead of with the text.  The output is parsed
+as UTF-8, without using the coding system of PROCESS, and it is never
+batched as `set-process-filter-batch' would.  If a value is not valid
+JSON, it is skipped, and the error is reported like an error in the
+filter.
+
+If FRAMING is nil, pass the output to the filter as text again.  */)
+  (Lisp_Object process, Lisp_Object framing)
+{
+  CHECK_PROCESS (process);
+  pset_json_parser (XPROCESS (process), process_framing_parser (framing));
+  return Qnil;
+}
+
+DEFUN ("process-framing", Fprocess_framing, Sprocess_framing, 1, 1, 0,
+       doc: /* Return the JSON parser that the output of PROCESS is fed to.
+The value is nil if the filter of PROCESS is passed text.  See
+`set-process-framing'.  */)
+  (Lisp_Object process)
+{
+  CHECK_PROCESS (process);
+  return XPROCESS (process)->json_parser;
+}
+
 DEFUN ("set-process-sentinel", Fset_process_sentinel, Sset_process_sentinel,
        2, 2, 0,
        doc: /* Give PROCESS the sentinel SENTINEL; nil for default.
@@ -1797,6 +2063,17 @@ DEFUN ("make-process", Fmake_process, Smake_process, 0, MANY, 0,
 
 :filter FILTER -- Install FILTER as the process filter.
 
+:filter-batch-ms MS -- Hold back output for up to MS milliseconds and
+pass everything that arrived in that time to FILTER in one call.
+
+:filter-batch-bytes BYTES -- With `:filter-batch-ms', pass the held back
+output to FILTER as soon as there are at least BYTES bytes of it.  See
+`set-process-filter-batch'.
+
+:framing FRAMING -- Pass the JSON values in the output to FILTER
+instead of the text.  FRAMING is `jsonrpc', `ndjson' or a JSON parser.
+See `set-process-framing'.
+
 :sentinel SENTINEL -- Install SENTINEL as the process sentinel.
 
 :stderr STDERR -- STDERR is either a buffer or a pipe process attached
@@ -1888,6 +2165,11 @@ DEFUN ("make-process", Fmake_process, Smake_process, 0, MANY, 0,
   pset_buffer (XPROCESS (proc), buffer);
   pset_sentinel (XPROCESS (proc), plist_get (contact, QCsentinel));
   pset_filter (XPROCESS (proc), plist_get (contact, QCfilter));
+  set_process_filter_batch (XPROCESS (proc),
+			    plist_get (contact, QCfilter_batch_ms),
+			    plist_get (contact, QCfilter_batch_bytes));
+  pset_json_parser (XPROCESS (proc),
+		    process_framing_parser (plist_get (contact, QCframing)));
   pset_command (XPROCESS (proc), Fcopy_sequence (command));
 
   if (!query_on_exit)
@@ -3777,6 +4059,69 @@ connect_network_socket (Lisp_Object proc, Lisp_Object addrinfos,
   unbind_to (count, Qnil);
 }
 
+/* The address cache.  When `network-lookup-cache-ttl' is a positive
+   number, `make-network-process' remembers the addresses that it
+   looks up for that many seconds.  The table maps lists (HOST SERVICE
+   FAMILY SOCKTYPE) to conses (ADDRINFOS . EXPIRY), ADDRINFOS being as
+   returned by conv_addrinfo_to_lisp and EXPIRY a float time.  */
+static Lisp_Object network_lookup_cache;
+
+/* Start over when the cache grows this large.  */
+enum { NETWORK_LOOKUP_CACHE_MAX = 256 };
+
+static double
+network_lookup_cache_ttl (void)
+{
+  return (FIXNUMP (Vnetwork_lookup_cache_ttl)
+	  ? XFIXNUM (Vnetwork_lookup_cache_ttl)
+	  : FLOATP (Vnetwork_lookup_cache_ttl)
+	  ? XFLOAT_DATA (Vnetwork_lookup_cache_ttl)
+	  : 0);
+}
+
+static Lisp_Object
+network_lookup_cache_key (char const *host, char const *service,
+			  int family, int socktype)
+{
+  return list4 (build_string (host), build_string (service),
+		make_fixnum (family), make_fixnum (socktype));
+}
+
+/* Return the unexpired cached addresses for KEY, or nil.  */
+
+static Lisp_Object
+network_lookup_cache_lookup (Lisp_Object key)
+{
+  if (! (HASH_TABLE_P (network_lookup_cache)
+	 && network_lookup_cache_ttl () > 0))
+    return Qnil;
+  Lisp_Object entry = Fgethash (key, network_lookup_cache, Qnil);
+  if (! (CONSP (entry)
+	 && timespectod (current_timespec ()) < XFLOAT_DATA (XCDR (entry))))
+    return Qnil;
+  return Fcopy_sequence (XCAR (entry));
+}
+
+/* Remember the non-empty list of addresses ADDRINFOS for KEY, if the
+   cache is enabled.  */
+
+static void
+network_lookup_cache_store (Lisp_Object key, Lisp_Object addrinfos)
+{
+  double ttl = network_lookup_cache_ttl ();
+  if (! (ttl > 0 && CONSP (addrinfos)))
+    return;
+  if (! (HASH_TABLE_P (network_lookup_cache)
+	 && (XHASH_TABLE (network_lookup_cache)->count
+	     < NETWORK_LOOKUP_CACHE_MAX)))
+    network_lookup_cache
+      = make_hash_table (&hashtest_equal, DEFAULT_HASH_SIZE, Weak_None);
+  Fputhash (key,
+	    Fcons (Fcopy_sequence (addrinfos),
+		   make_float (timespectod (current_timespec ()) + ttl)),
+	    network_lookup_cache);
+}
+
 /* Create a network stream/datagram client/server process.  Treated
    exactly like a normal process when reading and writing.  Primary
    differences are in status display and process deletion.  A network
@@ -3969,7 +4314,7 @@ DEFUN ("make-network-process", Fmake_network_process, Smake_network_process,
   int socktype;
   int family = -1;
   enum { any_protocol = 0 };
-#ifdef HAVE_GETADDRINFO_A
+#ifdef HAVE_ASYNC_DNS
   struct gaicb *dns_request = NULL;
 #endif
   specpdl_ref count = SPECPDL_INDEX ();
@@ -4141,7 +4486,13 @@ DEFUN ("make-network-process", Fmake_network_process, Smake_network_process,
 	  portstringlen = SBYTES (service);
 	}
 
-#ifdef HAVE_GETADDRINFO_A
+      addrinfos = network_lookup_cache_lookup
+	(network_lookup_cache_key (SSDATA (host), portstring,
+				   family, socktype));
+      if (!NILP (addrinfos))
+	goto open_socket;
+
+#ifdef HAVE_ASYNC_DNS
       if (nowait)
 	{
 	  ptrdiff_t hostlen = SBYTES (host);
@@ -4170,7 +4521,7 @@ DEFUN ("make-network-process", Fmake_network_process, Smake_network_process,
 
 	  goto open_socket;
 	}
-#endif /* HAVE_GETADDRINFO_A */
+#endif /* HAVE_ASYNC_DNS */
     }
 
   /* If we have a host, use getaddrinfo to resolve both host and service.
@@ -4199,6 +4550,11 @@ DEFUN ("make-network-process", Fmake_network_process, Smake_network_process,
 
       freeaddrinfo (res);
 
+      network_lookup_cache_store
+	(network_lookup_cache_key (SSDATA (host), portstring,
+				   family, socktype),
+	 addrinfos);
+
       goto open_socket;
     }
 
@@ -4267,7 +4623,7 @@ DEFUN ("make-network-process", Fmake_network_process, Smake_network_process,
   eassert (! p->is_server);
   p->port = port;
   p->socktype = socktype;
-#ifdef HAVE_GETADDRINFO_A
+#ifdef HAVE_ASYNC_DNS
   eassert (! p->dns_request);
 #endif
 #ifdef HAVE_GNUTLS
@@ -4288,7 +4644,7 @@ DEFUN ("make-network-process", Fmake_network_process, Smake_network_process,
     p->is_non_blocking_client = true;
 
   bool postpone_connection = false;
-#ifdef HAVE_GETADDRINFO_A
+#ifdef HAVE_ASYNC_DNS
   /* With async address resolution, the list of addresses is empty, so
      postpone connecting to the server. */
   if (!p->is_server && NILP (addrinfos))
@@ -5138,7 +5494,7 @@ server_accept_connection (Lisp_Object server, int channel)
   exec_sentinel (proc, concat3 (open_from, host_string, nl));
 }
 
-#ifdef HAVE_GETADDRINFO_A
+#ifdef HAVE_ASYNC_DNS
 static Lisp_Object
 check_for_dns (Lisp_Object proc)
 {
@@ -5162,6 +5518,13 @@ check_for_dns (Lisp_Object proc)
 	addrinfos = Fcons (conv_addrinfo_to_lisp (res), addrinfos);
 
       addrinfos = Fnreverse (addrinfos);
+
+      struct addrinfo const *hints = p->dns_request->ar_request;
+      network_lookup_cache_store
+	(network_lookup_cache_key (p->dns_request->ar_name,
+				   p->dns_request->ar_service,
+				   hints->ai_family, hints->ai_socktype),
+	 addrinfos);
     }
   /* The DNS lookup failed. */
   else if (connecting_status (p->status))
@@ -5183,7 +5546,7 @@ check_for_dns (Lisp_Object proc)
   return addrinfos;
 }
 
-#endif /* HAVE_GETADDRINFO_A */
+#endif /* HAVE_ASYNC_DNS */
 
 static void
 wait_for_socket_fds (Lisp_Object process, char const *name)
@@ -5310,7 +5673,7 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
   enum { MINIMUM = -1, TIMEOUT, FOREVER } wait;
   int got_some_output = -1;
   uintmax_t prev_wait_proc_nbytes_read = wait_proc ? wait_proc->nbytes_read : 0;
-#if defined HAVE_GETADDRINFO_A || defined HAVE_GNUTLS
+#if defined HAVE_ASYNC_DNS || defined HAVE_GNUTLS
   bool retry_for_async;
 #endif
   specpdl_ref count = SPECPDL_INDEX ();
@@ -5368,7 +5731,7 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 
       eassert (max_desc < FD_SETSIZE);
 
-#if defined HAVE_GETADDRINFO_A || defined HAVE_GNUTLS
+#if defined HAVE_ASYNC_DNS || defined HAVE_GNUTLS
       {
 	Lisp_Object process_list_head, aproc;
 	struct Lisp_Process *p;
@@ -5380,7 +5743,7 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 
 	    if (! wait_proc || p == wait_proc)
 	      {
-#ifdef HAVE_GETADDRINFO_A
+#ifdef HAVE_ASYNC_DNS
 		/* Check for pending DNS requests. */
 		if (p->dns_request)
 		  {
@@ -5465,6 +5828,19 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 	      && requeued_command_events_pending_p ())
 	    break;
 
+	  /* Pass output whose batching delay is up to the filters, and
+	     wake up in time for the next batch.  */
+	  if (process_filter_batch_count > 0)
+	    {
+	      struct timespec batch_delay
+		= flush_expired_filter_batches (just_wait_proc
+						? wait_proc : NULL);
+	      if (timespec_valid_p (batch_delay)
+		  && (!timespec_valid_p (timer_delay)
+		      || timespec_cmp (batch_delay, timer_delay) < 0))
+		timer_delay = batch_delay;
+	    }
+
           /* This is so a breakpoint can be put here.  */
           if (!timespec_valid_p (timer_delay))
               wait_reading_process_output_1 ();
@@ -5698,7 +6074,7 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 	  if (timeout.tv_sec > 0 || timeout.tv_nsec > 0)
 	    now = invalid_timespec ();
 
-#if defined HAVE_GETADDRINFO_A || defined HAVE_GNUTLS
+#if defined HAVE_ASYNC_DNS || defined HAVE_GNUTLS
 	  if (retry_for_async
 	      && (timeout.tv_sec > 0 || timeout.tv_nsec > ASYNC_RETRY_NSEC))
 	    {
@@ -5713,14 +6089,14 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 	     And if so, we need to skip the select which could block. */
 	  FD_ZERO (&tls_available);
 	  tls_nfds = 0;
-	  for (channel = 0; channel < FD_SETSIZE; ++channel)
+	  for (channel = 0; channel <= max_desc; ++channel)
 	    if (! NILP (chan_process[channel])
 		&& FD_ISSET (channel, &Available))
 	      {
 		struct Lisp_Process *p = XPROCESS (chan_process[channel]);
 		if (p
 		    && p->gnutls_p && p->gnutls_state
-		    && emacs_gnutls_record_check_pending (p->gnutls_state) > 0)
+		    && emacs_gnutls_record_check_pending (p) > 0)
 		  {
 		    tls_nfds++;
 		    eassert (p->infd == channel);
@@ -5745,6 +6121,10 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 	    timeout = short_timeout;
 #endif
 
+	  int wait0 = profiler_wait;
+	  profiler_wait = (read_kbd ? PROFILER_WAIT_INPUT
+			   : PROFILER_WAIT_PROCESS);
+
 	  /* Android requires using a replacement for pselect in
 	     android.c to poll for events.  */
 #if defined HAVE_ANDROID && !defined ANDROID_STUBIFY
@@ -5779,6 +6159,8 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 #endif	/* !HAVE_GLIB */
 #endif /* HAVE_ANDROID && !ANDROID_STUBIFY */
 
+	  profiler_wait = wait0;
+
 #ifdef HAVE_GNUTLS
 	  /* Merge tls_available into Available. */
 	  if (tls_nfds > 0)
@@ -5792,7 +6174,7 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 	      else if (nfds > 0)
 		/* Slow path, merge one by one.  Note: nfds does not need
 		   to be accurate, just positive is enough. */
-		for (channel = 0; channel < FD_SETSIZE; ++channel)
+		for (channel = 0; channel <= max_desc; ++channel)
 		  if (FD_ISSET (channel, &tls_available))
 		    FD_SET (channel, &Available);
 	    }
@@ -6177,13 +6559,43 @@ read_process_output_error_handler (Lisp_Object error_val)
    Yield number of decoded characters read,
    or -1 (setting errno) if there is a read error.
 
-   This function reads at most read_process_output_max bytes.
+   This function reads at most PROC's readmax bytes, which starts out
+   as read_process_output_max.
    If you want to read all available subprocess output,
    you must call it repeatedly until it returns zero.
 
    The characters read are decoded according to PROC's coding-system
    for decoding.  */
 
+/* Adjust how many bytes to read from process P at a time, given that
+   reading from CHANNEL yielded NBYTES of the REQUESTED bytes.  Double
+   the amount when a read fills the buffer, and halve it, down to
+   `read-process-output-max', when reads use less than a quarter.  See
+   `read-process-output-adaptive-max'.  */
+
+static void
+adapt_process_readmax (struct Lisp_Process *p, int channel,
+		       ptrdiff_t nbytes, ptrdiff_t requested)
+{
+  if (!FIXNATP (Vread_process_output_adaptive_max))
+    return;
+  ptrdiff_t base = clip_to_bounds (1, read_process_output_max, INT_MAX);
+  ptrdiff_t limit = clip_to_bounds (base,
+				    XFIXNAT (Vread_process_output_adaptive_max),
+				    INT_MAX);
+  if (nbytes == requested && p->readmax < limit)
+    {
+      p->readmax = p->readmax <= limit / 2 ? 2 * p->readmax : limit;
+#if defined F_SETPIPE_SZ && defined F_GETPIPE_SZ
+      /* A pipe never yields more than its capacity at once.  */
+      if (p->readmax > fcntl (channel, F_GETPIPE_SZ))
+	fcntl (channel, F_SETPIPE_SZ, p->readmax);
+#endif
+    }
+  else if (nbytes < p->readmax / 4 && p->readmax > base)
+    p->readmax = max (p->readmax / 2, base);
+}
+
 static int
 read_process_output (Lisp_Object proc, int channel)
 {
@@ -6256,6 +6668,8 @@ read_process_output (Lisp_Object proc, int channel)
 	      process_output_skip = 1;
 	    }
 	}
+      if (nbytes > 0)
+	adapt_process_readmax (p, channel, nbytes, readmax - buffered);
       nbytes += buffered;
       nbytes += buffered && nbytes <= 0;
     }
@@ -6277,6 +6691,7 @@ read_process_output (Lisp_Object proc, int channel)
 
   /* Ignore carryover, it's been added by a previous iteration already.  */
   p->nbytes_read += nbytes;
+  EMACS_PROBE2 (process_output, p->pid, nbytes);
 
   /* Now set NBYTES how many bytes we must decode.  */
   nbytes += carryover;
@@ -6436,6 +6851,16 @@ read_and_insert_process_output (struct Lisp_Process *p, char *buf,
       insert_1_both (buf, nread, nread, 0, 0, 1);
       signal_after_change (PT - nread, 0, nread);
     }
+  else if (decode_coding_ascii_verbatim_p (process_coding,
+					   (unsigned char *) buf, nread))
+    {
+      /* Decoding would not change this chunk, so copy it into the
+	 gap directly instead of running it through the decoder.  */
+      insert_1_both (buf, nread, nread, 0, 0, 1);
+      process_coding->carryover_bytes = 0;
+      read_process_output_set_last_coding_system (p, process_coding);
+      signal_after_change (PT - nread, 0, nread);
+    }
   else
     {			/* We have to decode the input.  */
       Lisp_Object curbuf;
@@ -6466,6 +6891,151 @@ read_and_insert_process_output (struct Lisp_Process *p, char *buf,
 				    before, before_byte, opoint, opoint_byte);
 }
 
+/* Return all the output of P that is held back for its filter as one
+   string, and forget about it.  */
+
+static Lisp_Object
+take_process_filter_batch (struct Lisp_Process *p)
+{
+  Lisp_Object batch = Fnreverse (p->filter_batch);
+  pset_filter_batch (p, Qnil);
+  p->filter_batch_pending = 0;
+  process_filter_batch_count--;
+
+  if (NILP (XCDR (batch)))
+    return XCAR (batch);
+
+  USE_SAFE_ALLOCA;
+  ptrdiff_t n = list_length (batch);
+  Lisp_Object *strings;
+  SAFE_ALLOCA_LISP (strings, n);
+  for (ptrdiff_t i = 0; i < n; i++, batch = XCDR (batch))
+    strings[i] = XCAR (batch);
+  Lisp_Object text = Fconcat (n, strings);
+  SAFE_FREE ();
+  return text;
+}
+
+/* Add TEXT to the output of P that is held back for its filter.
+   Return the text to pass to the filter now, which is empty if it is
+   all held back.  */
+
+static Lisp_Object
+add_to_process_filter_batch (struct Lisp_Process *p, Lisp_Object text)
+{
+  if (SBYTES (text) == 0)
+    return text;
+
+  if (NILP (p->filter_batch))
+    {
+      p->filter_batch_deadline
+	= timespec_add (current_timespec (),
+			make_timespec (p->filter_batch_ms / 1000,
+				       (p->filter_batch_ms % 1000
+					* (TIMESPEC_HZ / 1000))));
+      process_filter_batch_count++;
+    }
+  pset_filter_batch (p, Fcons (text, p->filter_batch));
+  p->filter_batch_pending += SBYTES (text);
+
+  if (p->filter_batch_bytes > 0
+      && p->filter_batch_pending >= p->filter_batch_bytes)
+    return take_process_filter_batch (p);
+  return empty_unibyte_string;
+}
+
+/* Pass the output of P that is held back for its filter, if any.  */
+
+static void
+flush_process_filter_batch (struct Lisp_Process *p)
+{
+  if (NILP (p->filter_batch))
+    return;
+
+  specpdl_ref count = SPECPDL_INDEX ();
+  Lisp_Object odeactivate = Vdeactivate_mark;
+  record_unwind_current_buffer ();
+  read_and_dispose_of_process_output (p, NULL, 0, NULL);
+  Vdeactivate_mark = odeactivate;
+  unbind_to (count, Qnil);
+}
+
+/* Pass the held back output of each process whose batching delay is
+   up to its filter, or only that of ONLY if it is non-null.  Return
+   the time until the next delay is up, or an invalid timespec if no
+   more output is held back.  */
+
+static struct timespec
+flush_expired_filter_batches (struct Lisp_Process *only)
+{
+  Lisp_Object tail, proc;
+  struct timespec now = current_timespec ();
+  struct timespec next = invalid_timespec ();
+  int pending = 0;
+
+  FOR_EACH_PROCESS (tail, proc)
+    {
+      struct Lisp_Process *p = XPROCESS (proc);
+      if (NILP (p->filter_batch))
+	continue;
+      if ((!only || p == only)
+	  && timespec_cmp (p->filter_batch_deadline, now) <= 0)
+	flush_process_filter_batch (p);
+      else
+	{
+	  pending++;
+	  if (!timespec_valid_p (next)
+	      || timespec_cmp (p->filter_batch_deadline, next) < 0)
+	    next = p->filter_batch_deadline;
+	}
+    }
+
+  /* Processes that were deleted with output held back are no longer
+     in the list, so count again.  */
+  process_filter_batch_count = pending;
+  if (!timespec_valid_p (next))
+    return next;
+  return (timespec_cmp (next, now) <= 0
+	  ? make_timespec (0, 0) : timespec_sub (next, now));
+}
+
+/* Feed NBYTES bytes of output at CHARS, which was read from P, to the
+   JSON parser of P, and pass each value that it completes to the
+   filter of P.  */
+
+static void
+read_process_output_values (struct Lisp_Process *p, char *chars,
+			    ssize_t nbytes)
+{
+  Lisp_Object proc = make_lisp_proc (p);
+  Lisp_Object text = make_unibyte_string (chars, nbytes);
+  Lisp_Object handlers = !NILP (Vdebug_on_error) ? Qnil : Qerror;
+
+  for (;;)
+    {
+      Lisp_Object values
+	= internal_condition_case_2 (Fjson_parser_feed, p->json_parser,
+				     text, handlers,
+				     read_process_output_error_handler);
+      for (Lisp_Object tail = values; CONSP (tail); tail = XCDR (tail))
+	internal_condition_case_1 (read_process_output_call,
+				   list3 (p->filter, proc, XCAR (tail)),
+				   handlers,
+				   read_process_output_error_handler);
+
+      /* After an invalid value is skipped, the parser still has the
+	 values that came before it, and maybe more after it.  */
+      if (! (EQ (values, Qt) && JSON_PARSERP (p->json_parser)))
+	break;
+      text = empty_unibyte_string;
+    }
+}
+
+/* Pass NBYTES bytes of output at CHARS, which was read from P and has
+   to be decoded with CODING, to the filter of P, or insert it into the
+   buffer of P.  If CHARS is null, pass the output that is held back
+   for the filter instead.  */
+
 static void
 read_and_dispose_of_process_output (struct Lisp_Process *p, char *chars,
 				    ssize_t nbytes,
@@ -6505,8 +7075,18 @@ read_and_dispose_of_process_output (struct Lisp_Process *p, char *chars,
      save the match data in a special nonrecursive fashion.  */
   running_asynch_code = 1;
 
-  if (fast_read_process_output
-      && EQ (p->filter, Qinternal_default_process_filter))
+  if (!chars)
+    {
+      text = take_process_filter_batch (p);
+      internal_condition_case_1 (read_process_output_call,
+				 list3 (outstream, make_lisp_proc (p), text),
+				 !NILP (Vdebug_on_error) ? Qnil : Qerror,
+				 read_process_output_error_handler);
+    }
+  else if (!NILP (p->json_parser))
+    read_process_output_values (p, chars, nbytes);
+  else if (fast_read_process_output
+	   && EQ (p->filter, Qinternal_default_process_filter))
     read_and_insert_process_output (p, chars, nbytes, coding);
   else
     {
@@ -6515,6 +7095,9 @@ read_and_dispose_of_process_output (struct Lisp_Process *p, char *chars,
 
       read_process_output_set_last_coding_system (p, coding);
 
+      if (p->filter_batch_ms > 0 || !NILP (p->filter_batch))
+	text = add_to_process_filter_batch (p, text);
+
       if (SBYTES (text) > 0)
 	/* FIXME: It's wrong to wrap or not based on debug-on-error, and
 	   sometimes it's simply wrong to wrap (e.g. when called from
@@ -6649,6 +7232,70 @@ write_queue_pop (struct Lisp_Process *p, Lisp_Object *obj,
   return 1;
 }
 
+#ifdef HAVE_WRITEV
+
+/* The largest number of write_queue entries that send_process passes
+   to a single writev.  */
+enum { WRITE_QUEUE_IOV_MAX = 16 };
+
+/* Write the LEN bytes at BUF, followed by the data of the first
+   entries in the write_queue of P, to OUTFD with as few system calls
+   as possible.  Remove the entries that were written completely from
+   the queue, and advance the first entry that was written in part.
+   Return the number of bytes written from BUF; if this is less than
+   LEN, set errno.  */
+
+static ptrdiff_t
+write_queue_writev (struct Lisp_Process *p, int outfd,
+		    const char *buf, ptrdiff_t len)
+{
+  struct iovec iov[WRITE_QUEUE_IOV_MAX + 1];
+  int iovcnt = 0;
+
+  iov[iovcnt].iov_base = (char *) buf;
+  iov[iovcnt++].iov_len = len;
+  for (Lisp_Object tail = p->write_queue;
+       CONSP (tail) && iovcnt <= WRITE_QUEUE_IOV_MAX;
+       tail = XCDR (tail))
+    {
+      Lisp_Object entry = XCAR (tail);
+      Lisp_Object offset_length = XCDR (entry);
+      ptrdiff_t entry_len = XFIXNUM (XCDR (offset_length));
+      iov[iovcnt].iov_base = (SSDATA (XCAR (entry))
+			      + XFIXNUM (XCAR (offset_length)));
+      iov[iovcnt++].iov_len = entry_len;
+    }
+
+  ptrdiff_t written = emacs_writev_sig (outfd, iov, iovcnt);
+  if (written <= len)
+    return written;
+
+  /* Drop what was written of the queue, saving errno for the caller
+     in case not everything was written.  */
+  int err = errno;
+  for (written -= len; 0 < written; )
+    {
+      Lisp_Object offset_length = XCDR (XCAR (p->write_queue));
+      ptrdiff_t entry_len = XFIXNUM (XCDR (offset_length));
+      if (entry_len <= written)
+	{
+	  pset_write_queue (p, XCDR (p->write_queue));
+	  written -= entry_len;
+	}
+      else
+	{
+	  XSETCAR (offset_length,
+		   make_fixnum (XFIXNUM (XCAR (offset_length)) + written));
+	  XSETCDR (offset_length, make_fixnum (entry_len - written));
+	  written = 0;
+	}
+    }
+  errno = err;
+  return len;
+}
+
+#endif	/* HAVE_WRITEV */
+
 /* Send some data to process PROC.
    BUF is the beginning of the data; LEN is the number of characters.
    OBJECT is the Lisp object that the data comes from.  If OBJECT is
@@ -6659,7 +7306,7 @@ write_queue_pop (struct Lisp_Process *p, Lisp_Object *obj,
 
    This function can evaluate Lisp code and can garbage collect.  */
 
-static void
+void
 send_process (Lisp_Object proc, const char *buf, ptrdiff_t len,
 	      Lisp_Object object)
 {
@@ -6820,6 +7467,12 @@ send_process (Lisp_Object proc, const char *buf, ptrdiff_t len,
 	      if (p->gnutls_p && p->gnutls_state)
 		written = emacs_gnutls_write (p, cur_buf, cur_len);
 	      else
+#endif
+#ifdef HAVE_WRITEV
+	      /* If more data is queued, try to send it along.  */
+	      if (CONSP (p->write_queue))
+		written = write_queue_writev (p, outfd, cur_buf, cur_len);
+	      else
 #endif
 		written = emacs_write_sig (outfd, cur_buf, cur_len);
 	      rv = (written ? 0 : -1);
@@ -7855,6 +8508,10 @@ status_notify (struct Lisp_Process *deleting_process,
 		break;
 	    }
 
+	  /* Don't let the sentinel see the status change before the
+	     filter has seen all the output.  */
+	  flush_process_filter_batch (p);
+
 	  /* Get the text to use for the message.  */
 	  if (p->raw_status_new)
 	    update_status (p);
@@ -8193,7 +8850,11 @@ wait_reading_process_output (intmax_t time_limit, int nsecs, int read_kbd,
 	{
 	  if (read_kbd || !NILP (wait_for_cell))
 	    FD_SET (0, &waitchannels);
+	  int wait0 = profiler_wait;
+	  profiler_wait = (read_kbd ? PROFILER_WAIT_INPUT
+			   : PROFILER_WAIT_PROCESS);
 	  nfds = pselect (1, &waitchannels, NULL, NULL, &timeout, NULL);
+	  profiler_wait = wait0;
 	}
 
       xerrno = errno;
@@ -8796,6 +9457,10 @@ syms_of_process (void)
   DEFSYM (QClog, ":log");
   DEFSYM (QCnoquery, ":noquery");
   DEFSYM (QCstop, ":stop");
+  DEFSYM (QCfilter_batch_ms, ":filter-batch-ms");
+  DEFSYM (QCfilter_batch_bytes, ":filter-batch-bytes");
+  DEFSYM (Qjsonrpc, "jsonrpc");
+  DEFSYM (Qndjson, "ndjson");
   DEFSYM (QCplist, ":plist");
   DEFSYM (QCcommand, ":command");
   DEFSYM (QCconnection_type, ":connection-type");
@@ -8917,6 +9582,22 @@ syms_of_process (void)
 /proc/sys/fs/pipe-max-size.  See pipe(7) manpage for details.  */);
   read_process_output_max = 65536;
 
+  DEFVAR_LISP ("read-process-output-adaptive-max",
+	       Vread_process_output_adaptive_max,
+	       doc: /* Largest chunk of subprocess output to read at once, or nil.
+If this is an integer, Emacs adapts how much it reads from each
+process in a single chunk to the amount of output the process
+produces.  When a read fills the whole chunk, the next read asks for
+twice as much, up to this many bytes; when a read uses less than a
+quarter of the chunk, the chunk is halved again, but never below
+`read-process-output-max'.  For processes that produce bulk output,
+this means fewer and larger chunks are passed to process filters.
+
+If this is nil, Emacs always reads at most `read-process-output-max'
+bytes at a time.  Use `process-read-output-max' to see the current
+chunk size of a process.  */);
+  Vread_process_output_adaptive_max = Qnil;
+
   DEFVAR_BOOL ("fast-read-process-output", fast_read_process_output,
 	       doc: /* Non-nil to optimize the insertion of process output.
 We skip calling `internal-default-process-filter' and don't allocate
@@ -8930,6 +9611,20 @@ syms_of_process (void)
 sentinel or a process filter function has an error.  */);
   process_error_pause_time = 1;
 
+  DEFVAR_LISP ("network-lookup-cache-ttl", Vnetwork_lookup_cache_ttl,
+	       doc: /* Seconds for which to remember the addresses of network hosts.
+If this is a positive number, `make-network-process' remembers the
+addresses that it looks up for a host and service for that many
+seconds, and connects to them again without asking the resolver.
+This avoids the delay of a name lookup when connecting to the same
+host repeatedly.  The system resolver does not report how long the
+addresses are valid, so this should not be longer than the time for
+which the DNS records of the hosts that you connect to stay the same.
+A value of nil or zero disables the cache.  */);
+  Vnetwork_lookup_cache_ttl = make_fixnum (30);
+  staticpro (&network_lookup_cache);
+  network_lookup_cache = Qnil;
+
   DEFSYM (Qinternal_default_interrupt_process,
 	  "internal-default-interrupt-process");
   DEFSYM (Qinterrupt_process_functions, "interrupt-process-functions");
@@ -8955,7 +9650,12 @@ syms_of_process (void)
   defsubr (&Sprocess_buffer);
   defsubr (&Sprocess_mark);
   defsubr (&Sset_process_filter);
+  defsubr (&Sprocess_read_output_max);
   defsubr (&Sprocess_filter);
+  defsubr (&Sset_process_filter_batch);
+  defsubr (&Sprocess_filter_batch);
+  defsubr (&Sset_process_framing);
+  defsubr (&Sprocess_framing);
   defsubr (&Sset_process_sentinel);
   defsubr (&Sprocess_sentinel);
   defsubr (&Sset_process_thread);
@@ -29,6 +29,16 @@ #define EMACS_PROCESS_H
 #include "gnutls.h"
 #endif
 
+/* Network connections can look up addresses asynchronously, with
+   getaddrinfo_a where available and otherwise with a thread for each
+   lookup (see process.c).  */
+#if defined HAVE_GETADDRINFO_A || defined HAVE_PTHREAD
+# define HAVE_ASYNC_DNS
+# ifndef HAVE_GETADDRINFO_A
+#  define gaicb emacs_gaicb
+# endif
+#endif
+
 INLINE_HEADER_BEGIN
 
 /* Bound on number of file descriptors opened on behalf of a process,
@@ -110,11 +120,23 @@ #define EMACS_PROCESS_H
 #ifdef HAVE_GNUTLS
     Lisp_Object gnutls_cred_type;
     Lisp_Object gnutls_boot_parameters;
+
+    /* The key under which the TLS session of this process is cached
+       for resumption, or nil.  */
+    Lisp_Object gnutls_session_key;
 #endif
 
     /* Pipe process attached to the standard error of this process.  */
     Lisp_Object stderrproc;
 
+    /* Output decoded for the filter but held back for batching, as a
+       list of strings with the most recent first.  */
+    Lisp_Object filter_batch;
+
+    /* The JSON parser that the output is fed to, if the filter is
+       passed JSON values instead of text, or nil.  */
+    Lisp_Object json_parser;
+
     /* The thread a process is linked to, or nil for any thread.  */
     Lisp_Object thread;
     /* After this point, there are no Lisp_Objects.  */
@@ -155,6 +177,16 @@ #define EMACS_PROCESS_H
     bool_bf read_output_skip : 1;
     /* Maximum number of bytes to read in a single chunk. */
     ptrdiff_t readmax;
+    /* Milliseconds that output may be held back before it is passed
+       to the filter, or 0 to pass every chunk as it is read.  */
+    int filter_batch_ms;
+    /* Number of held back bytes that are passed to the filter without
+       waiting for the delay to be up, or 0 for no limit.  */
+    ptrdiff_t filter_batch_bytes;
+    /* Number of bytes in filter_batch.  */
+    ptrdiff_t filter_batch_pending;
+    /* When the text in filter_batch must be passed to the filter.  */
+    struct timespec filter_batch_deadline;
     /* True means kill silently if Emacs is exited.
        This is the inverse of the `query-on-exit' flag.  */
     bool_bf kill_without_query : 1;
@@ -184,7 +216,7 @@ #define EMACS_PROCESS_H
     /* The socket type. */
     int socktype;
 
-#ifdef HAVE_GETADDRINFO_A
+#ifdef HAVE_ASYNC_DNS
     /* Whether the socket is waiting for response from an asynchronous
        DNS call. */
     struct gaicb *dns_request;
@@ -201,8 +233,13 @@ #define EMACS_PROCESS_H
     unsigned int gnutls_extra_peer_verification;
     int gnutls_log_level;
     int gnutls_handshakes_tried;
+    /* If gnutls_read_deferred, what GnuTLS yielded after the data
+       that the last read returned: 0 at the end of the data, or an
+       error code.  The next read returns this.  */
+    int gnutls_deferred_read;
     bool_bf gnutls_p : 1;
     bool_bf gnutls_complete_negotiation_p : 1;
+    bool_bf gnutls_read_deferred : 1;
 #endif
   } GCALIGNED_STRUCT;
 
@@ -251,6 +288,12 @@ pset_gnutls_cred_type (struct Lisp_Process *p, Lisp_Object val)
 {
   p->gnutls_cred_type = val;
 }
+
+INLINE void
+pset_gnutls_session_key (struct Lisp_Process *p, Lisp_Object val)
+{
+  p->gnutls_session_key = val;
+}
 #endif
 
 /* True means don't run process sentinels.  This is used
@@ -293,6 +336,8 @@ pset_gnutls_cred_type (struct Lisp_Process *p, Lisp_Object val)
 extern void delete_write_fd (int fd);
 extern void catch_child_signal (void);
 extern void restore_nofile_limit (void);
+extern Lisp_Object get_process (Lisp_Object);
+extern void send_process (Lisp_Object, const char *, ptrdiff_t, Lisp_Object);
 
 #ifdef WINDOWSNT
 extern Lisp_Object network_interface_list (bool full, unsigned short match);
@@ -265,13 +265,21 @@ evict_lower_half (struct profiler_log *plog)
 
 /* Record the current backtrace in LOG.  COUNT is the weight of this
    current backtrace: interrupt counts for CPU, and the allocation
-   size for memory.  */
+   size for memory.  If LEAF is non-nil, record it as the innermost
+   function, below the current backtrace.  */
 
 static void
-record_backtrace (struct profiler_log *plog, EMACS_INT count)
+record_backtrace (struct profiler_log *plog, EMACS_INT count,
+		  Lisp_Object leaf)
 {
   log_t *log = plog->log;
-  get_backtrace (log->trace, log->depth);
+  if (NILP (leaf) || log->depth == 0)
+    get_backtrace (log->trace, log->depth);
+  else
+    {
+      log->trace[0] = leaf;
+      get_backtrace (log->trace + 1, log->depth - 1);
+    }
   EMACS_UINT hash = trace_hash (log->trace, log->depth);
   int hidx = log_hash_index (log, hash);
   int idx = log->index[hidx];
@@ -323,7 +331,7 @@ record_backtrace (struct profiler_log *plog, EMACS_INT count)
 /* Signal handler for sampling profiler.  */
 
 static void
-add_sample (struct profiler_log *plog, EMACS_INT count)
+add_sample (struct profiler_log *plog, EMACS_INT count, Lisp_Object leaf)
 {
   if (EQ (backtrace_top_function (), QAutomatic_GC)) /* bug#60237 */
     /* Special case the time-count inside GC because the hash-table
@@ -334,7 +342,7 @@ add_sample (struct profiler_log *plog, EMACS_INT count)
        effort.  */
     plog->gc_count = saturated_add (plog->gc_count, count);
   else
-    record_backtrace (plog, count);
+    record_backtrace (plog, count, leaf);
 }
 
 #ifdef PROFILER_CPU_SUPPORT
@@ -347,8 +355,15 @@ add_sample (struct profiler_log *plog, EMACS_INT count)
 #ifdef HAVE_ITIMERSPEC
 static timer_t profiler_timer;
 static bool profiler_timer_ok;
+
+/* Likewise for the timer that measures elapsed time.  */
+static timer_t profiler_wall_timer;
+static bool profiler_wall_timer_ok;
 #endif
 
+/* Whether the profiler samples elapsed time rather than CPU time.  */
+static bool profiler_cpu_wall_clock;
+
 /* Status of sampling profiler.  */
 static enum profiler_cpu_running
   { NOT_RUNNING,
@@ -370,14 +385,27 @@ handle_profiler_signal (int signal)
 {
   EMACS_INT count = 1;
 #if defined HAVE_ITIMERSPEC && defined HAVE_TIMER_GETOVERRUN
-  if (profiler_timer_ok)
+  if (profiler_cpu_wall_clock || profiler_timer_ok)
     {
-      int overruns = timer_getoverrun (profiler_timer);
+      int overruns = timer_getoverrun (profiler_cpu_wall_clock
+				       ? profiler_wall_timer
+				       : profiler_timer);
       eassert (overruns >= 0);
       count += overruns;
     }
 #endif
-  add_sample (&cpu, count);
+
+  /* When measuring elapsed time, tell where Emacs was waiting.  */
+  Lisp_Object leaf = Qnil;
+  if (profiler_cpu_wall_clock)
+    switch (profiler_wait)
+      {
+      case PROFILER_NOT_WAITING: break;
+      case PROFILER_WAIT_INPUT: leaf = QWaiting_for_Input; break;
+      case PROFILER_WAIT_PROCESS: leaf = QWaiting_for_Process; break;
+      case PROFILER_WAIT_FILE: leaf = QFile_IO; break;
+      }
+  add_sample (&cpu, count, leaf);
 }
 
 static void
@@ -387,7 +415,7 @@ deliver_profiler_signal (int signal)
 }
 
 static int
-setup_cpu_timer (Lisp_Object sampling_interval)
+setup_cpu_timer (Lisp_Object sampling_interval, bool wall_clock)
 {
   int billion = 1000000000;
 
@@ -407,7 +435,32 @@ setup_cpu_timer (Lisp_Object sampling_interval)
   sigaction (SIGPROF, &action, 0);
 
 #ifdef HAVE_ITIMERSPEC
-  if (! profiler_timer_ok)
+  if (wall_clock)
+    {
+      if (! profiler_wall_timer_ok)
+	{
+	  struct sigevent sigev;
+	  sigev.sigev_value.sival_ptr = &profiler_wall_timer;
+	  sigev.sigev_signo = SIGPROF;
+	  sigev.sigev_notify = SIGEV_SIGNAL;
+	  profiler_wall_timer_ok
+	    = timer_create (
+#ifdef CLOCK_MONOTONIC
+			    CLOCK_MONOTONIC,
+#else
+			    CLOCK_REALTIME,
+#endif
+			    &sigev, &profiler_wall_timer) == 0;
+	}
+      if (profiler_wall_timer_ok)
+	{
+	  struct itimerspec ispec;
+	  ispec.it_value = ispec.it_interval = interval;
+	  if (timer_settime (profiler_wall_timer, 0, &ispec, 0) == 0)
+	    return TIMER_SETTIME_RUNNING;
+	}
+    }
+  else if (! profiler_timer_ok)
     {
       /* System clocks to try, in decreasing order of desirability.  */
       static clockid_t const system_clock[] = {
@@ -435,7 +488,7 @@ setup_cpu_timer (Lisp_Object sampling_interval)
 	  }
     }
 
-  if (profiler_timer_ok)
+  if (! wall_clock && profiler_timer_ok)
     {
       struct itimerspec ispec;
       ispec.it_value = ispec.it_interval = interval;
@@ -444,6 +497,11 @@ setup_cpu_timer (Lisp_Object sampling_interval)
     }
 #endif
 
+  /* setitimer cannot measure elapsed time, since Emacs uses
+     ITIMER_REAL for its own timers.  */
+  if (wall_clock)
+    return NOT_RUNNING;
+
 #ifdef HAVE_SETITIMER
   struct itimerval timer;
   timer.it_value = timer.it_interval = make_timeval (interval);
@@ -455,11 +513,18 @@ setup_cpu_timer (Lisp_Object sampling_interval)
 }
 
 DEFUN ("profiler-cpu-start", Fprofiler_cpu_start, Sprofiler_cpu_start,
-       1, 1, 0,
+       1, 2, 0,
        doc: /* Start or restart the cpu profiler.
 It takes call-stack samples each SAMPLING-INTERVAL nanoseconds, approximately.
+
+If WALL-CLOCK is non-nil, take samples each SAMPLING-INTERVAL
+nanoseconds of elapsed time instead of CPU time, so that time spent
+waiting is sampled too.  Samples taken while Emacs waits for input,
+for subprocesses or for file I/O then have `Waiting for Input',
+`Waiting for Process' or `File I/O' as their innermost function.
+
 See also `profiler-log-size' and `profiler-max-stack-depth'.  */)
-  (Lisp_Object sampling_interval)
+  (Lisp_Object sampling_interval, Lisp_Object wall_clock)
 {
   if (profiler_cpu_running)
     error ("CPU profiler is already running");
@@ -467,7 +532,7 @@ DEFUN ("profiler-cpu-start", Fprofiler_cpu_start, Sprofiler_cpu_start,
   if (cpu.log == NULL)
     cpu = make_profiler_log ();
 
-  int status = setup_cpu_timer (sampling_interval);
+  int status = setup_cpu_timer (sampling_interval, !NILP (wall_clock));
   if (status < 0)
     {
       profiler_cpu_running = NOT_RUNNING;
@@ -476,6 +541,7 @@ DEFUN ("profiler-cpu-start", Fprofiler_cpu_start, Sprofiler_cpu_start,
   else
     {
       profiler_cpu_interval = sampling_interval;
+      profiler_cpu_wall_clock = !NILP (wall_clock);
       profiler_cpu_running = status;
       if (! profiler_cpu_running)
 	error ("Unable to start profiler timer");
@@ -499,7 +565,9 @@ DEFUN ("profiler-cpu-stop", Fprofiler_cpu_stop, Sprofiler_cpu_stop,
     case TIMER_SETTIME_RUNNING:
       {
 	struct itimerspec disable = { 0, };
-	timer_settime (profiler_timer, 0, &disable, 0);
+	timer_settime (profiler_cpu_wall_clock
+		       ? profiler_wall_timer : profiler_timer,
+		       0, &disable, 0);
       }
       break;
 #endif
@@ -546,7 +614,8 @@ DEFUN ("profiler-cpu-log", Fprofiler_cpu_log, Sprofiler_cpu_log,
   Lisp_Object ret = export_log (&cpu);
 
   if (prof_cpu)
-    Fprofiler_cpu_start (profiler_cpu_interval);
+    Fprofiler_cpu_start (profiler_cpu_interval,
+			 profiler_cpu_wall_clock ? Qt : Qnil);
 
   return ret;
 }
@@ -661,7 +730,7 @@ DEFUN ("profiler-memory-log",
 void
 malloc_probe (size_t size)
 {
-  add_sample (&memory, min (size, MOST_POSITIVE_FIXNUM));
+  add_sample (&memory, min (size, MOST_POSITIVE_FIXNUM), Qnil);
 }
 
 DEFUN ("function-equal", Ffunction_equal, Sfunction_equal, 2, 2, 0,
@@ -702,6 +771,9 @@ syms_of_profiler (void)
   profiler_log_size = 10000;
 
   DEFSYM (QDiscarded_Samples, "Discarded Samples");
+  DEFSYM (QWaiting_for_Input, "Waiting for Input");
+  DEFSYM (QWaiting_for_Process, "Waiting for Process");
+  DEFSYM (QFile_IO, "File I/O");
 
   defsubr (&Sfunction_equal);
 
@@ -187,6 +187,14 @@ #define BYTEWIDTH 8 /* In bits.  */
 typedef const unsigned char re_char;
 
 static void re_compile_fastmap (struct re_pattern_buffer *);
+static void extract_literal (struct re_pattern_buffer *);
+static bool nfa_useful_p (struct re_pattern_buffer *);
+static ptrdiff_t nfa_search (struct re_pattern_buffer *bufp,
+			     re_char *string1, ptrdiff_t size1,
+			     re_char *string2, ptrdiff_t size2,
+			     ptrdiff_t startpos, ptrdiff_t range,
+			     struct re_registers *regs, ptrdiff_t stop,
+			     bool anchored_start);
 static ptrdiff_t re_match_2_internal (struct re_pattern_buffer *bufp,
 				     re_char *string1, ptrdiff_t size1,
 				     re_char *string2, ptrdiff_t size2,
@@ -892,6 +900,33 @@ #define INIT_FAILURE_ALLOC 20
    with the process stack limit.  */
 ptrdiff_t emacs_re_max_failures = 40000;
 
+/* Number of steps that matching may still take before it signals
+   'regexp-budget-exceeded', or -1 if there is no limit.  A step is a
+   backtrack or a jump in the pattern or, when running the pattern in
+   lock step, a character of the text.  */
+static intmax_t re_match_steps_left;
+
+/* Start counting steps against 'regexp-match-step-limit'.  */
+static void
+start_match_steps (void)
+{
+  intmax_t limit;
+  re_match_steps_left
+    = (INTEGERP (Vregexp_match_step_limit)
+       && integer_to_intmax (Vregexp_match_step_limit, &limit)
+       && limit >= 0
+       ? limit : -1);
+}
+
+/* Count a step of matching, and check for a quit while at it.  */
+static void
+match_step (void)
+{
+  maybe_quit ();
+  if (re_match_steps_left >= 0 && re_match_steps_left-- == 0)
+    xsignal1 (Qregexp_budget_exceeded, Vregexp_match_step_limit);
+}
+
 union fail_stack_elt
 {
   re_char *pointer;
@@ -2687,6 +2722,8 @@ regex_compile (re_char *pattern, ptrdiff_t size,
 
   /* Success; set the length of the buffer.  */
   bufp->used = b - bufp->buffer;
+  bufp->can_use_nfa = nfa_useful_p (bufp);
+  extract_literal (bufp);
 
 #ifdef REGEX_EMACS_DEBUG
   if (regex_emacs_debug > 0)
@@ -3383,6 +3420,320 @@ re_search (struct re_pattern_buffer *bufp, const char *string, ptrdiff_t size,
 #define POS_ADDR_VSTRING(POS)					\
   (((POS) >= size1 ? string2 - size1 : string1) + (POS))
 
+/* Required literals.
+
+   Most patterns contain a string that every match must contain, such
+   as "(defun " in "^\\s-*(defun ".  're_search_2' can look for that
+   string with 'memchr' and skip over text that does not contain it,
+   instead of trying the matcher at every position there.  */
+
+/* Return the opcode that follows the one at P in the compiled pattern.  */
+static re_char *
+following_op (re_char *p)
+{
+  switch (*p)
+    {
+    case exactn:
+      return p + 2 + p[1];
+
+    case charset: case charset_not:
+      return skip_one_char (p);
+
+    case start_memory: case stop_memory: case duplicate:
+    case syntaxspec: case notsyntaxspec:
+    case categoryspec: case notcategoryspec:
+      return p + 2;
+
+    case jump: case on_failure_jump: case on_failure_keep_string_jump:
+    case on_failure_jump_loop: case on_failure_jump_nastyloop:
+    case on_failure_jump_smart:
+      return p + 3;
+
+    case succeed_n: case jump_n: case set_number_at:
+      return p + 5;
+
+    default:
+      return p + 1;
+    }
+}
+
+/* Return true if every path through the compiled pattern of BUFP, from
+   its start to a successful match, goes through the opcode at AVOID.
+   SEEN and STACK are scratch space for 'bufp->used' elements.
+   Counted repetitions are treated as if they could be skipped or
+   repeated any number of times.  */
+static bool
+required_op_p (struct re_pattern_buffer *bufp, re_char *avoid,
+	       bool *seen, re_char **stack)
+{
+  re_char *pattern = bufp->buffer;
+  re_char *pend = pattern + bufp->used;
+  ptrdiff_t n = 0;
+
+  memset (seen, 0, bufp->used * sizeof *seen);
+  if (pattern == avoid)
+    return true;
+  stack[n++] = pattern;
+  seen[0] = true;
+  while (n > 0)
+    {
+      re_char *p = stack[--n];
+      re_char *next[2];
+      int nnext = 0;
+
+      if (p == pend || *p == succeed)
+	return false;
+      switch (*p)
+	{
+	case jump:
+	  next[nnext++] = extract_address (p + 1);
+	  break;
+	case on_failure_jump: case on_failure_keep_string_jump:
+	case on_failure_jump_loop: case on_failure_jump_nastyloop:
+	case on_failure_jump_smart: case succeed_n: case jump_n:
+	  next[nnext++] = extract_address (p + 1);
+	  next[nnext++] = following_op (p);
+	  break;
+	default:
+	  next[nnext++] = following_op (p);
+	}
+
+      for (int i = 0; i < nnext; i++)
+	if (next[i] != avoid
+	    && (next[i] == pend || !seen[next[i] - pattern]))
+	  {
+	    if (next[i] != pend)
+	      seen[next[i] - pattern] = true;
+	    stack[n++] = next[i];
+	  }
+    }
+  return true;
+}
+
+/* If C, a character of a compiled pattern whose translation table is
+   TRANSLATE, can be matched by looking for at most two bytes in the
+   text, store them in *B1 and *B2 and return true.  */
+static bool
+literal_char_bytes (Lisp_Object translate, int c, unsigned char *b1,
+		    unsigned char *b2)
+{
+  if (!ASCII_CHAR_P (c))
+    return false;
+  *b1 = *b2 = c;
+  if (NILP (translate))
+    return true;
+  if (RE_TRANSLATE (translate, c) != c)
+    return false;
+
+  /* The text characters that match C are those that translate to C,
+     i.e., its case equivalents; see 'set_case_table'.  */
+  if (!CHAR_TABLE_P (translate)
+      || CHAR_TABLE_EXTRA_SLOTS (XCHAR_TABLE (translate)) < 3)
+    return false;
+  Lisp_Object eqv = XCHAR_TABLE (translate)->extras[2];
+  if (!CHAR_TABLE_P (eqv))
+    return false;
+  Lisp_Object other = CHAR_TABLE_REF (eqv, c);
+  if (!FIXNATP (other))
+    return false;
+  if (XFIXNAT (other) == c)
+    return true;
+  if (!ASCII_CHAR_P (XFIXNAT (other)))
+    return false;
+  *b2 = XFIXNAT (other);
+  other = CHAR_TABLE_REF (eqv, *b2);
+  return FIXNATP (other) && XFIXNAT (other) == c;
+}
+
+/* Set the 'literal' fields of BUFP to the longest string that
+   every match of its compiled pattern contains, if any.  */
+static void
+extract_literal (struct re_pattern_buffer *bufp)
+{
+  re_char *pattern = bufp->buffer;
+  re_char *pend = pattern + bufp->used;
+  Lisp_Object translate = bufp->translate;
+  bool multibyte = RE_MULTIBYTE_P (bufp);
+  int candidates = 0;
+
+  bufp->literal_length = 0;
+  bufp->literal_prefix = false;
+  bufp->literal_raw = false;
+
+  /* The opcode that a match must start with, if it has to start with
+     a string.  */
+  re_char *first = pattern;
+  while (first < pend
+	 && (*first == no_op || *first == start_memory
+	     || *first == begline || *first == begbuf
+	     || *first == wordbeg || *first == symbeg
+	     || *first == wordbound))
+    first = following_op (first);
+
+  USE_SAFE_ALLOCA;
+  bool *seen = NULL;
+  re_char **stack = NULL;
+
+  for (re_char *p = pattern; p < pend; p = following_op (p))
+    {
+      if (*p != exactn)
+	continue;
+
+      /* Find the longest run of characters that can be looked for in
+	 the text.  */
+      re_char *s = p + 2, *send = s + p[1];
+      re_char *best = s;
+      int best_length = 0;
+      bool best_raw = false;
+      while (s < send)
+	{
+	  re_char *run = s;
+	  int length = 0;
+	  bool raw = false;
+	  while (s < send)
+	    {
+	      int len;
+	      int c = RE_STRING_CHAR_AND_LENGTH (s, len, multibyte);
+	      unsigned char b1, b2;
+	      if (length + len > RE_LITERAL_MAX)
+		break;
+	      if (literal_char_bytes (translate, c, &b1, &b2))
+		;
+	      else if (NILP (translate))
+		raw = true;
+	      else
+		break;
+	      s += len;
+	      length += len;
+	    }
+	  if (length > best_length)
+	    {
+	      best = run;
+	      best_length = length;
+	      best_raw = raw;
+	    }
+	  if (length == 0)
+	    s += multibyte ? BYTES_BY_CHAR_HEAD (*s) : 1;
+	}
+
+      /* A single byte is hardly better than the fastmap.  */
+      if (best_length < 2 || best_length <= bufp->literal_length)
+	continue;
+      if (! (p == first && best == p + 2))
+	{
+	  /* Don't spend too long on patterns with many strings.  */
+	  if (++candidates > 16)
+	    break;
+	  if (!seen)
+	    {
+	      SAFE_NALLOCA (seen, 1, bufp->used);
+	      SAFE_NALLOCA (stack, 1, bufp->used);
+	    }
+	  if (!required_op_p (bufp, p, seen, stack))
+	    continue;
+	}
+
+      for (int i = 0; i < best_length; i++)
+	if (!literal_char_bytes (translate, best[i], &bufp->literal[i],
+				 &bufp->literal_alt[i]))
+	  bufp->literal[i] = bufp->literal_alt[i] = best[i];
+      bufp->literal_length = best_length;
+      bufp->literal_prefix = p == first && best == p + 2;
+      bufp->literal_raw = best_raw;
+    }
+
+  SAFE_FREE ();
+}
+
+/* Return the start of the first (if FORWARD) or last occurrence of the
+   required literal of BUFP that lies between positions FROM and TO of
+   the virtual concatenation of STRING1 and STRING2, or -1 if there is
+   none.  */
+static ptrdiff_t
+find_literal (struct re_pattern_buffer *bufp,
+	      re_char *string1, ptrdiff_t size1,
+	      re_char *string2, ptrdiff_t size2,
+	      ptrdiff_t from, ptrdiff_t to, bool forward)
+{
+  int length = bufp->literal_length;
+  to = min (to, size1 + size2);
+  unsigned char *lit = bufp->literal, *alt = bufp->literal_alt;
+
+  /* Look for a byte that matches only itself, if any.  */
+  int k = 0;
+  while (k < length - 1 && lit[k] != alt[k])
+    k++;
+
+  /* The position of byte K of the next candidate occurrence is in
+     [LO, HI).  */
+  ptrdiff_t lo = from + k, hi = to - length + k + 1;
+  while (lo < hi)
+    {
+      /* Look in the part of [LO, HI) that is in the same string as
+	 LO (if FORWARD) or HI - 1.  */
+      ptrdiff_t seg_lo = lo, seg_hi = hi;
+      if (lo < size1 && size1 < hi)
+	{
+	  if (forward)
+	    seg_hi = size1;
+	  else
+	    seg_lo = size1;
+	}
+      re_char *base = seg_lo < size1 ? string1 : string2 - size1;
+      re_char *start = base + seg_lo, *end = base + seg_hi, *hit;
+      if (lit[k] == alt[k])
+	hit = (forward ? memchr (start, lit[k], end - start)
+	       : memrchr (start, lit[k], end - start));
+      else
+	{
+	  hit = NULL;
+	  if (forward)
+	    {
+	      for (re_char *q = start; q < end; q++)
+		if (*q == lit[k] || *q == alt[k])
+		  {
+		    hit = q;
+		    break;
+		  }
+	    }
+	  else
+	    {
+	      for (re_char *q = end; q > start; q--)
+		if (q[-1] == lit[k] || q[-1] == alt[k])
+		  {
+		    hit = q - 1;
+		    break;
+		  }
+	    }
+	}
+
+      if (!hit)
+	{
+	  if (forward)
+	    lo = seg_hi;
+	  else
+	    hi = seg_lo;
+	  continue;
+	}
+      ptrdiff_t pos = seg_lo + (hit - start) - k;
+      int i = 0;
+      while (i < length)
+	{
+	  int b = *POS_ADDR_VSTRING (pos + i);
+	  if (b != lit[i] && b != alt[i])
+	    break;
+	  i++;
+	}
+      if (i == length)
+	return pos;
+      if (forward)
+	lo = pos + k + 1;
+      else
+	hi = pos + k;
+    }
+  return -1;
+}
+
 /* Using the compiled pattern in BUFP->buffer, first tries to match the
    virtual concatenation of STRING1 and STRING2, starting first at index
    STARTPOS, then at STARTPOS + 1, and so on.
@@ -3420,11 +3771,17 @@ re_search_2 (struct re_pattern_buffer *bufp, const char *str1, ptrdiff_t size1,
   bool anchored_start;
   /* Nonzero if we are searching multibyte string.  */
   bool multibyte = RE_TARGET_MULTIBYTE_P (bufp);
+  /* Whether to look for the string that every match contains, and
+     where it was last found.  */
+  bool use_literal = false;
+  ptrdiff_t literal_pos = -1;
 
   /* Check for out-of-range STARTPOS.  */
   if (startpos < 0 || startpos > total_size)
     return -1;
 
+  start_match_steps ();
+
   /* Fix up RANGE if it might eventually take us outside
      the virtual concatenation of STRING1 and STRING2.
      Make sure we won't move STARTPOS below 0 or above TOTAL_SIZE.  */
@@ -3459,11 +3816,76 @@ re_search_2 (struct re_pattern_buffer *bufp, const char *str1, ptrdiff_t size1,
   /* See whether the pattern is anchored.  */
   anchored_start = (bufp->buffer[0] == begline);
 
+  /* Look for the string that every match contains, and give up at
+     once if there is none.  Matches starting at STARTPOS or later all
+     end before STOP.  */
+  if (range != 0 && bufp->literal_length > 0
+      && (!bufp->literal_raw || RE_MULTIBYTE_P (bufp) == multibyte))
+    {
+      use_literal = true;
+      if (range > 0)
+	{
+	  literal_pos = find_literal (bufp, string1, size1, string2,
+				      size2, startpos, stop, true);
+	  if (literal_pos < 0
+	      || (bufp->literal_prefix && startpos + range < literal_pos))
+	    return -1;
+	}
+      else
+	{
+	  literal_pos = find_literal (bufp, string1, size1, string2,
+				      size2, startpos + range, stop, false);
+	  if (literal_pos < 0)
+	    return -1;
+	  if (literal_pos < startpos)
+	    {
+	      range += startpos - literal_pos;
+	      startpos = literal_pos;
+	    }
+	}
+    }
+
+  if (range >= 0 && bufp->can_use_nfa)
+    return nfa_search (bufp, string1, size1, string2, size2,
+		       startpos, range, regs, stop, anchored_start);
+
   RE_SETUP_SYNTAX_TABLE_FOR_OBJECT (re_match_object, startpos);
 
   /* Loop through the string, looking for a place to start matching.  */
   for (;;)
     {
+      /* Skip to the next place where the required string starts or,
+	 if it need not start the match, give up once it has been
+	 passed.  */
+      if (use_literal && range > 0 && literal_pos != startpos)
+	{
+	  if (literal_pos < startpos)
+	    literal_pos = find_literal (bufp, string1, size1, string2,
+					size2, startpos, stop, true);
+	  if (literal_pos < 0)
+	    return -1;
+	  if (bufp->literal_prefix)
+	    {
+	      range -= literal_pos - startpos;
+	      if (range < 0)
+		return -1;
+	      startpos = literal_pos;
+	    }
+	}
+      else if (use_literal && range < 0 && bufp->literal_prefix
+	       && literal_pos != startpos)
+	{
+	  literal_pos = find_literal (bufp, string1, size1, string2,
+				      size2, startpos + range,
+				      min (stop,
+					   startpos + bufp->literal_length),
+				      false);
+	  if (literal_pos < 0)
+	    return -1;
+	  range += startpos - literal_pos;
+	  startpos = literal_pos;
+	}
+
       /* If the pattern is anchored,
 	 skip quickly past places we cannot match.
 	 Don't bother to treat startpos == 0 specially
@@ -4052,6 +4474,7 @@ re_match_2 (struct re_pattern_buffer *bufp,
   ptrdiff_t result;
 
   RE_SETUP_SYNTAX_TABLE_FOR_OBJECT (re_match_object, pos);
+  start_match_steps ();
 
   result = re_match_2_internal (bufp, (re_char *) string1, size1,
 				(re_char *) string2, size2,
@@ -4066,6 +4489,38 @@ unwind_re_match (void *ptr)
   b->text->inhibit_shrinking = 0;
 }
 
+/* Make sure REGS has room for NUM_REGS registers, allocating or
+   growing its arrays as BUFP->regs_allocated says.  */
+static void
+allocate_registers (struct re_pattern_buffer *bufp,
+		    struct re_registers *regs, ptrdiff_t num_regs)
+{
+  /* Have the register data arrays been allocated?	*/
+  if (bufp->regs_allocated == REGS_UNALLOCATED)
+    { /* No.  So allocate them with malloc.  */
+      ptrdiff_t n = max (RE_NREGS, num_regs);
+      regs->start = xnmalloc (n, sizeof *regs->start);
+      regs->end = xnmalloc (n, sizeof *regs->end);
+      regs->num_regs = n;
+      bufp->regs_allocated = REGS_REALLOCATE;
+    }
+  else if (bufp->regs_allocated == REGS_REALLOCATE)
+    { /* Yes.  If we need more elements than were already
+	 allocated, reallocate them.  If we need fewer, just
+	 leave it alone.  */
+      ptrdiff_t n = regs->num_regs;
+      if (n < num_regs)
+	{
+	  n = max (n + (n >> 1), num_regs);
+	  regs->start = xnrealloc (regs->start, n, sizeof *regs->start);
+	  regs->end = xnrealloc (regs->end, n, sizeof *regs->end);
+	  regs->num_regs = n;
+	}
+    }
+  else
+    eassert (bufp->regs_allocated == REGS_FIXED);
+}
+
 /* This is a separate function so that we can force an alloca cleanup
    afterwards.  */
 static ptrdiff_t
@@ -4350,31 +4805,7 @@ re_match_2_internal (struct re_pattern_buffer *bufp,
 	  /* If caller wants register contents data back, do it.  */
 	  if (regs)
 	    {
-	      /* Have the register data arrays been allocated?	*/
-	      if (bufp->regs_allocated == REGS_UNALLOCATED)
-		{ /* No.  So allocate them with malloc.  */
-		  ptrdiff_t n = max (RE_NREGS, num_regs);
-		  regs->start = xnmalloc (n, sizeof *regs->start);
-		  regs->end = xnmalloc (n, sizeof *regs->end);
-		  regs->num_regs = n;
-		  bufp->regs_allocated = REGS_REALLOCATE;
-		}
-	      else if (bufp->regs_allocated == REGS_REALLOCATE)
-		{ /* Yes.  If we need more elements than were already
-		     allocated, reallocate them.  If we need fewer, just
-		     leave it alone.  */
-		  ptrdiff_t n = regs->num_regs;
-		  if (n < num_regs)
-		    {
-		      n = max (n + (n >> 1), num_regs);
-		      regs->start
-			= xnrealloc (regs->start, n, sizeof *regs->start);
-		      regs->end = xnrealloc (regs->end, n, sizeof *regs->end);
-		      regs->num_regs = n;
-		    }
-		}
-	      else
-		eassert (bufp->regs_allocated == REGS_FIXED);
+	      allocate_registers (bufp, regs, num_regs);
 
 	      /* Convert the pointer data in 'regstart' and 'regend' to
 		 indices.  Register zero has to be set differently,
@@ -4898,7 +5329,7 @@ re_match_2_internal (struct re_pattern_buffer *bufp,
 	/* Unconditionally jump (without popping any failure points).  */
 	case jump:
 	unconditional_jump:
-	  maybe_quit ();
+	  match_step ();
 	  EXTRACT_NUMBER_AND_INCR (mcnt, p);	/* Get the amount to jump.  */
 	  DEBUG_PRINT ("EXECUTING jump %d ", mcnt);
 	  p += mcnt;				/* Do the jump.  */
@@ -5233,7 +5664,7 @@ re_match_2_internal (struct re_pattern_buffer *bufp,
 
     /* We goto here if a matching operation fails. */
     fail:
-      maybe_quit ();
+      match_step ();
       if (!FAIL_STACK_EMPTY ())
 	{
 	  re_char *str, *pat;
@@ -5325,6 +5756,680 @@ bcmp_translate (re_char *s1, re_char *s2, ptrdiff_t len,
   return p1 != p1_end || p2 != p2_end;
 }
 
+/* Lock-step matching.
+
+   The backtracking matcher above can take time exponential in the
+   length of the text for patterns like "\\(a*\\)*b", because it
+   retries the same pattern position at the same text position once
+   for every way of getting there.  When a pattern's behavior at any
+   point depends only on the pattern position and the text position,
+   it is enough to try each such pair once: the states that the
+   backtracker would visit can be advanced together over the text, one
+   character at a time, with duplicates dropped.  This is Thompson's
+   NFA simulation, with the states kept in the order in which the
+   backtracker would try them, so that the first state to reach
+   'succeed' is the match the backtracker would have returned, with
+   the same registers.
+
+   Back references, counted repetitions (which modify the pattern while
+   matching) and syntax or category tests (which may need to call Lisp
+   to update the syntax table) are left to the backtracker; see
+   'nfa_useful_p'.  */
+
+/* A matcher state.  PC is an offset into the compiled pattern.  If REM
+   is positive, PC is inside the text of an 'exactn' and REM pattern
+   bytes are left to match; otherwise PC is at an opcode that consumes
+   a character, or at 'succeed'.  */
+struct nfa_thread
+{
+  int pc;
+  int rem;
+};
+
+/* A list of states in priority order, with their registers: the
+   registers of the Ith state are CAPS[I * ncap] to
+   CAPS[I * ncap + ncap - 1], holding the start of the match and then
+   the start and end of each group, or -1 if unset.  */
+struct nfa_list
+{
+  ptrdiff_t n;
+  struct nfa_thread *threads;
+  ptrdiff_t *caps;
+};
+
+/* Things to do while computing the states reachable without consuming
+   any text.  They are kept on a stack so that the lower-priority
+   branch of a split is explored only after the higher-priority one,
+   and with the registers as they were at the split.  */
+enum nfa_job_kind
+{
+  NFA_EXPLORE,			/* Follow the pattern from offset ARG.  */
+  NFA_RESTORE,			/* Reset register ARG to VAL.  */
+  NFA_ENTER_LOOP,		/* Mark loop ARG as being retried.  */
+  NFA_LEAVE_LOOP,		/* Unmark loop ARG.  */
+  NFA_DONE			/* Everything after offset ARG is done.  */
+};
+
+struct nfa_job
+{
+  enum nfa_job_kind kind;
+  int arg;
+  ptrdiff_t val;
+};
+
+struct nfa
+{
+  re_char *pattern;
+
+  /* Number of registers per state.  */
+  ptrdiff_t ncap;
+
+  /* MARKS[PC] is GEN if PC has been reached at the current text
+     position.  Reaching it again adds nothing new, unless it is
+     reached from one of its own continuations: BUSY[PC] counts those
+     that are still being explored, and the backtracker would try them
+     again with different registers, before the rest of the earlier
+     visit.  */
+  ptrdiff_t *marks;
+  ptrdiff_t gen;
+  int *busy;
+
+  /* LOOPING[PC] is true while the body of the loop at PC is being
+     explored at the current text position, in which case reaching PC
+     again means that the body matched the empty string.  This mirrors
+     'CHECK_INFINITE_LOOP'.  */
+  bool *looping;
+
+  /* The stack of pending jobs, and its allocated size.  */
+  struct nfa_job *jobs;
+  ptrdiff_t jobs_size;
+
+  /* The registers of the state being followed.  */
+  ptrdiff_t *scratch;
+
+  re_char *string1, *string2;
+  ptrdiff_t size1, size2;
+};
+
+/* Return the opcode after the one at P, or NULL if 'nfa_search' cannot
+   run the opcode at P.  */
+static re_char *
+nfa_next_op (re_char *p)
+{
+  switch (*p)
+    {
+    case no_op: case succeed: case anychar:
+    case begline: case endline: case begbuf: case endbuf:
+      return p + 1;
+
+    case exactn:
+      return p + 2 + p[1];
+
+    case charset: case charset_not:
+      return skip_one_char (p);
+
+    case start_memory: case stop_memory:
+      return p + 2;
+
+    case jump: case on_failure_jump: case on_failure_keep_string_jump:
+    case on_failure_jump_loop: case on_failure_jump_nastyloop:
+    case on_failure_jump_smart:
+      return p + 3;
+
+    default:
+      return NULL;
+    }
+}
+
+/* Return true if the compiled pattern in BUFP should be run by
+   'nfa_search'.  That is only worth it when the pattern has a loop
+   whose body can itself match in several ways, as in "\\(a*\\)*b" or
+   "\\(a\\|ab\\)*c", since that is when backtracking can take time
+   exponential in the length of the text; for other patterns the
+   backtracker is faster.  */
+static bool
+nfa_useful_p (struct re_pattern_buffer *bufp)
+{
+  re_char *p = bufp->buffer;
+  re_char *pend = p + bufp->used;
+  bool nested = false;
+
+  /* Only patterns that stop at the first match; see 'regex_compile'.  */
+  if (p == pend || (re_opcode_t) pend[-1] != succeed)
+    return false;
+
+  /* Keep the per-state registers within reason.  */
+  if ((bufp->used + 1) * (2 * bufp->re_nsub + 1) > 1 << 20)
+    return false;
+
+  for (re_char *next; p < pend; p = next)
+    {
+      next = nfa_next_op (p);
+      if (!next)
+	return false;
+
+      /* A jump back to LOOP closes a loop, whose own split is at LOOP
+	 or just before P.  Look for another split inside it.  */
+      if (next == p + 3 && extract_address (p + 1) < p)
+	{
+	  re_char *loop = extract_address (p + 1);
+	  for (re_char *q = loop; q && q < p; q = nfa_next_op (q))
+	    if (q != loop && q != p - 3
+		&& (*q == on_failure_jump || *q == on_failure_keep_string_jump
+		    || *q == on_failure_jump_loop
+		    || *q == on_failure_jump_nastyloop
+		    || *q == on_failure_jump_smart))
+	      nested = true;
+	}
+    }
+  return nested;
+}
+
+/* Return the address of the byte at POS in the virtual concatenation
+   of the strings of NFA.  */
+static re_char *
+nfa_addr (struct nfa *nfa, ptrdiff_t pos)
+{
+  return (pos < nfa->size1 ? nfa->string1 : nfa->string2 - nfa->size1) + pos;
+}
+
+static void
+nfa_free_jobs (void *ptr)
+{
+  struct nfa *nfa = ptr;
+  xfree (nfa->jobs);
+}
+
+/* Push JOB onto the job stack of NFA, which holds *NJOBS jobs.  */
+static void
+nfa_push (struct nfa *nfa, ptrdiff_t *njobs, struct nfa_job job)
+{
+  if (*njobs == nfa->jobs_size)
+    nfa->jobs = xpalloc (nfa->jobs, &nfa->jobs_size, 1, -1,
+			 sizeof *nfa->jobs);
+  nfa->jobs[(*njobs)++] = job;
+}
+
+/* Append to LIST, in priority order, the states reachable from pattern
+   offset PC at text position POS without consuming any text, starting
+   with the registers in NFA->scratch.  */
+static void
+nfa_add (struct nfa *nfa, struct nfa_list *list, int pc, ptrdiff_t pos)
+{
+  re_char *pattern = nfa->pattern;
+  ptrdiff_t *scratch = nfa->scratch;
+  ptrdiff_t njobs = 0;
+
+  nfa_push (nfa, &njobs, (struct nfa_job) { NFA_EXPLORE, pc });
+  while (njobs > 0)
+    {
+      struct nfa_job job = nfa->jobs[--njobs];
+      switch (job.kind)
+	{
+	case NFA_DONE:
+	  nfa->busy[job.arg]--;
+	  continue;
+	case NFA_RESTORE:
+	  scratch[job.arg] = job.val;
+	  continue;
+	case NFA_ENTER_LOOP:
+	  nfa->looping[job.arg] = true;
+	  continue;
+	case NFA_LEAVE_LOOP:
+	  nfa->looping[job.arg] = false;
+	  continue;
+	case NFA_EXPLORE:
+	  break;
+	}
+
+      pc = job.arg;
+      for (;;)
+	{
+	  re_char *p = pattern + pc;
+
+	  /* A loop that comes back to itself without consuming anything
+	     gives up, as in 're_match_2_internal'.  */
+	  if (nfa->looping[pc])
+	    {
+	      if (*p == on_failure_jump_loop)
+		pc = extract_address (p + 1) - pattern;
+	      else
+		{
+		  eassert (*p == on_failure_jump_nastyloop);
+		  pc += 3;
+		}
+	      continue;
+	    }
+
+	  if (nfa->marks[pc] == nfa->gen && !nfa->busy[pc])
+	    break;
+	  nfa->marks[pc] = nfa->gen;
+	  if (*p != exactn && *p != anychar && *p != charset
+	      && *p != charset_not && *p != succeed)
+	    {
+	      nfa_push (nfa, &njobs, (struct nfa_job) { NFA_DONE, pc });
+	      nfa->busy[pc]++;
+	    }
+
+	  switch (*p)
+	    {
+	    case no_op:
+	      pc++;
+	      continue;
+
+	    case exactn:
+	    case anychar:
+	    case charset:
+	    case charset_not:
+	    case succeed:
+	      {
+		ptrdiff_t i = list->n++;
+		bool lit = *p == exactn;
+		list->threads[i] = (struct nfa_thread) { pc + 2 * lit,
+							 lit ? p[1] : 0 };
+		memcpy (list->caps + i * nfa->ncap, scratch,
+			nfa->ncap * sizeof *scratch);
+	      }
+	      break;
+
+	    case start_memory:
+	    case stop_memory:
+	      {
+		int reg = 2 * p[1] - (*p == start_memory);
+		nfa_push (nfa, &njobs, (struct nfa_job) { NFA_RESTORE, reg,
+							  scratch[reg] });
+		scratch[reg] = pos;
+		pc += 2;
+	      }
+	      continue;
+
+	    case begline:
+	      if (pos == 0 || *nfa_addr (nfa, pos - 1) == '\n')
+		{
+		  pc++;
+		  continue;
+		}
+	      break;
+
+	    case endline:
+	      if (pos == nfa->size1 + nfa->size2 || *nfa_addr (nfa, pos) == '\n')
+		{
+		  pc++;
+		  continue;
+		}
+	      break;
+
+	    case begbuf:
+	      if (pos == 0)
+		{
+		  pc++;
+		  continue;
+		}
+	      break;
+
+	    case endbuf:
+	      if (pos == nfa->size1 + nfa->size2)
+		{
+		  pc++;
+		  continue;
+		}
+	      break;
+
+	    case jump:
+	      {
+		re_char *to = extract_address (p + 1);
+		/* A loop that 'on_failure_jump_smart' turned into an
+		   'on_failure_keep_string_jump' loop jumps back past its
+		   split; each iteration must offer the exit again.  */
+		if (to - pattern >= 3
+		    && to[-3] == on_failure_keep_string_jump
+		    && extract_address (to - 2) == p + 3)
+		  to -= 3;
+		pc = to - pattern;
+	      }
+	      continue;
+
+	    case on_failure_jump:
+	    case on_failure_keep_string_jump:
+	    case on_failure_jump_smart:
+	      nfa_push (nfa, &njobs, (struct nfa_job) {
+		  NFA_EXPLORE, extract_address (p + 1) - pattern });
+	      pc += 3;
+	      continue;
+
+	    case on_failure_jump_loop:
+	      /* Try the body first, then the exit.  */
+	      nfa_push (nfa, &njobs, (struct nfa_job) {
+		  NFA_EXPLORE, extract_address (p + 1) - pattern });
+	      nfa_push (nfa, &njobs, (struct nfa_job) { NFA_LEAVE_LOOP, pc });
+	      nfa->looping[pc] = true;
+	      pc += 3;
+	      continue;
+
+	    case on_failure_jump_nastyloop:
+	      /* Try the exit first, then the body.  */
+	      nfa_push (nfa, &njobs, (struct nfa_job) { NFA_LEAVE_LOOP, pc });
+	      nfa_push (nfa, &njobs, (struct nfa_job) {
+		  NFA_EXPLORE, extract_address (p + 1) - pattern });
+	      nfa_push (nfa, &njobs, (struct nfa_job) { NFA_ENTER_LOOP, pc });
+	      pc += 3;
+	      continue;
+
+	    default:
+	      emacs_abort ();
+	    }
+	  break;
+	}
+    }
+}
+
+/* Return true if a match may start at POS, judging from FASTMAP (if
+   non-null) and ANCHORED_START.  */
+static bool
+nfa_start_p (struct nfa *nfa, struct re_pattern_buffer *bufp,
+	     ptrdiff_t pos, char *fastmap, bool anchored_start)
+{
+  if (anchored_start && pos > 0 && *nfa_addr (nfa, pos - 1) != '\n')
+    return false;
+  if (!fastmap || bufp->can_be_null)
+    return true;
+  if (pos == nfa->size1 + nfa->size2)
+    return false;
+
+  Lisp_Object translate = bufp->translate;
+  re_char *d = nfa_addr (nfa, pos);
+  if (RE_TARGET_MULTIBYTE_P (bufp))
+    return fastmap[CHAR_LEADING_CODE (TRANSLATE (STRING_CHAR (d)))];
+  int buf_ch = *d;
+  if (!NILP (translate))
+    {
+      int ch = RE_CHAR_TO_MULTIBYTE (buf_ch);
+      int translated = RE_TRANSLATE (translate, ch);
+      if (translated != ch && (ch = RE_CHAR_TO_UNIBYTE (translated)) >= 0)
+	buf_ch = ch;
+    }
+  return fastmap[buf_ch];
+}
+
+/* Like 're_search_2' for a forward search (RANGE >= 0), but run the
+   pattern with the lock-step matcher.  BUFP must satisfy
+   'nfa_useful_p', and its fastmap, if any, must be accurate.  */
+static ptrdiff_t
+nfa_search (struct re_pattern_buffer *bufp,
+	    re_char *string1, ptrdiff_t size1,
+	    re_char *string2, ptrdiff_t size2,
+	    ptrdiff_t startpos, ptrdiff_t range,
+	    struct re_registers *regs, ptrdiff_t stop,
+	    bool anchored_start)
+{
+  eassert (0 <= startpos && 0 <= range);
+  eassert (startpos + range <= stop && stop <= size1 + size2);
+
+  Lisp_Object translate = bufp->translate;
+  bool multibyte = RE_MULTIBYTE_P (bufp);
+  bool target_multibyte = RE_TARGET_MULTIBYTE_P (bufp);
+  char *fastmap = bufp->fastmap;
+  ptrdiff_t num_regs = bufp->re_nsub + 1;
+  ptrdiff_t ncap = 2 * num_regs - 1;
+  ptrdiff_t nstates = bufp->used + 1;
+  ptrdiff_t lastpos = startpos + range;
+  ptrdiff_t nchars = 0;
+  ptrdiff_t quit_count = 0;
+
+  struct nfa nfa = {
+    .pattern = bufp->buffer, .ncap = ncap, .gen = 0,
+    .string1 = string1, .string2 = string2, .size1 = size1, .size2 = size2
+  };
+
+  specpdl_ref count = SPECPDL_INDEX ();
+  record_unwind_protect_ptr (nfa_free_jobs, &nfa);
+
+  REGEX_USE_SAFE_ALLOCA;
+  struct nfa_thread *threads;
+  ptrdiff_t *caps;
+  SAFE_NALLOCA (threads, 2, nstates);
+  SAFE_NALLOCA (caps, 2 * ncap + 1, nstates);
+  SAFE_NALLOCA (nfa.marks, 1, nstates);
+  SAFE_NALLOCA (nfa.busy, 1, nstates);
+  SAFE_NALLOCA (nfa.looping, 1, nstates);
+  for (ptrdiff_t i = 0; i < nstates; i++)
+    {
+      nfa.marks[i] = -1;
+      nfa.busy[i] = 0;
+      nfa.looping[i] = false;
+    }
+  struct nfa_list list[2] = {
+    { 0, threads, caps },
+    { 0, threads + nstates, caps + nstates * ncap }
+  };
+  struct nfa_list *clist = &list[0], *nlist = &list[1];
+  nfa.scratch = caps + 2 * nstates * ncap;
+  ptrdiff_t *best = nfa.scratch + ncap;
+  ptrdiff_t match_end = -1;
+
+  ptrdiff_t pos = startpos;
+  for (;;)
+    {
+      /* Start a new attempt at POS, with the lowest priority.  */
+      if (match_end < 0 && pos <= lastpos
+	  && nfa_start_p (&nfa, bufp, pos, fastmap, anchored_start))
+	{
+	  nfa.scratch[0] = pos;
+	  for (ptrdiff_t i = 1; i < ncap; i++)
+	    nfa.scratch[i] = -1;
+	  nfa_add (&nfa, clist, 0, pos);
+	}
+
+      if (clist->n == 0)
+	{
+	  if (match_end >= 0 || pos >= lastpos)
+	    break;
+	  /* Nothing is in progress: skip to the next place where a
+	     match could start.  */
+	  do
+	    pos += target_multibyte ? BYTES_BY_CHAR_HEAD (*nfa_addr (&nfa, pos))
+				    : 1;
+	  while (pos <= lastpos
+		 && !nfa_start_p (&nfa, bufp, pos, fastmap, anchored_start));
+	  if (pos > lastpos)
+	    break;
+	  nfa.gen++;
+	  continue;
+	}
+
+      /* Advance every state over the character at POS, in order.  */
+      match_step ();
+      bool at_stop = pos == stop;
+      int buf_charlen = 1;
+      int buf_ch = 0, tch = 0;
+      re_char *d = NULL;
+      if (!at_stop)
+	{
+	  d = nfa_addr (&nfa, pos);
+	  buf_ch = RE_STRING_CHAR_AND_LENGTH (d, buf_charlen,
+					      target_multibyte);
+	  tch = TRANSLATE (buf_ch);
+	}
+      ptrdiff_t next = pos + buf_charlen;
+      nfa.gen++;
+      nlist->n = 0;
+
+      for (ptrdiff_t i = 0; i < clist->n; i++)
+	{
+	  struct nfa_thread *t = &clist->threads[i];
+	  ptrdiff_t *tcaps = clist->caps + i * ncap;
+	  re_char *p = nfa.pattern + t->pc;
+
+	  if (t->rem == 0 && *p == succeed)
+	    {
+	      /* The states after this one have lower priority than this
+		 match, so drop them.  */
+	      memcpy (best, tcaps, ncap * sizeof *best);
+	      match_end = pos;
+	      break;
+	    }
+	  if (at_stop)
+	    continue;
+	  nchars++;
+
+	  if (t->rem > 0)
+	    {
+	      int pat_charlen, pat_ch;
+	      bool ok;
+	      if (target_multibyte)
+		{
+		  if (multibyte)
+		    pat_ch = string_char_and_length (p, &pat_charlen);
+		  else
+		    {
+		      pat_ch = RE_CHAR_TO_MULTIBYTE (*p);
+		      pat_charlen = 1;
+		    }
+		  ok = tch == pat_ch;
+		}
+	      else
+		{
+		  if (multibyte)
+		    {
+		      pat_ch = string_char_and_length (p, &pat_charlen);
+		      pat_ch = RE_CHAR_TO_UNIBYTE (pat_ch);
+		    }
+		  else
+		    {
+		      pat_ch = *p;
+		      pat_charlen = 1;
+		    }
+		  int c = RE_CHAR_TO_MULTIBYTE (*d);
+		  if (! CHAR_BYTE8_P (c))
+		    {
+		      c = RE_CHAR_TO_UNIBYTE (TRANSLATE (c));
+		      if (c < 0)
+			c = *d;
+		    }
+		  else
+		    c = *d;
+		  ok = c == pat_ch;
+		}
+	      if (!ok)
+		continue;
+
+	      int pc = t->pc + pat_charlen;
+	      int rem = t->rem - pat_charlen;
+	      if (rem > 0)
+		{
+		  if (nfa.marks[pc] != nfa.gen)
+		    {
+		      ptrdiff_t j = nlist->n++;
+		      nfa.marks[pc] = nfa.gen;
+		      nlist->threads[j] = (struct nfa_thread) { pc, rem };
+		      memcpy (nlist->caps + j * ncap, tcaps,
+			      ncap * sizeof *tcaps);
+		    }
+		  continue;
+		}
+	      memcpy (nfa.scratch, tcaps, ncap * sizeof *tcaps);
+	      nfa_add (&nfa, nlist, pc, next);
+	      continue;
+	    }
+
+	  switch (*p)
+	    {
+	    case anychar:
+	      if (tch == '\n')
+		continue;
+	      p++;
+	      break;
+
+	    case charset:
+	    case charset_not:
+	      {
+		bool unibyte_char = false;
+		int c = buf_ch;
+		if (target_multibyte)
+		  {
+		    int c1 = RE_CHAR_TO_UNIBYTE (tch);
+		    c = tch;
+		    if (c1 >= 0)
+		      {
+			unibyte_char = true;
+			c = c1;
+		      }
+		  }
+		else
+		  {
+		    int c1 = RE_CHAR_TO_MULTIBYTE (c);
+		    if (! CHAR_BYTE8_P (c1))
+		      {
+			c1 = RE_CHAR_TO_UNIBYTE (TRANSLATE (c1));
+			if (c1 >= 0)
+			  {
+			    unibyte_char = true;
+			    c = c1;
+			  }
+		      }
+		    else
+		      unibyte_char = true;
+		  }
+		if (!execute_charset (&p, c, buf_ch, unibyte_char, translate))
+		  continue;
+	      }
+	      break;
+
+	    default:
+	      emacs_abort ();
+	    }
+
+	  memcpy (nfa.scratch, tcaps, ncap * sizeof *tcaps);
+	  nfa_add (&nfa, nlist, p - nfa.pattern, next);
+	}
+
+      if (at_stop)
+	break;
+
+      struct nfa_list *tmp = clist;
+      clist = nlist;
+      nlist = tmp;
+      pos = next;
+      rarely_quit (++quit_count);
+    }
+
+  ptrdiff_t retval = -1;
+  if (match_end >= 0)
+    {
+      retval = best[0];
+      if (regs)
+	{
+	  allocate_registers (bufp, regs, num_regs);
+	  if (regs->num_regs > 0)
+	    {
+	      regs->start[0] = best[0];
+	      regs->end[0] = match_end;
+	    }
+	  for (ptrdiff_t reg = 1; reg < num_regs; reg++)
+	    {
+	      if (best[2 * reg] < 0)
+		regs->start[reg] = regs->end[reg] = -1;
+	      else
+		{
+		  eassert (best[2 * reg - 1] >= 0);
+		  regs->start[reg] = best[2 * reg - 1];
+		  regs->end[reg] = best[2 * reg];
+		}
+	    }
+	  for (ptrdiff_t reg = num_regs; reg < regs->num_regs; reg++)
+	    regs->start[reg] = regs->end[reg] = -1;
+	}
+    }
+
+  SAFE_FREE_UNBIND_TO (count, Qnil);
+
+  /* See the comment at the end of 're_match_2_internal'.  */
+  if (max_redisplay_ticks > 0 && nchars > 0)
+    update_redisplay_ticks (nchars / 50 + 1, NULL);
+
+  return retval;
+}
+
 /* Entry points for GNU code.  */
 
 /* re_compile_pattern is the GNU regular expression compiler: it
@@ -55,6 +55,10 @@ #define EMACS_REGEX_H 1
 /* Amount of memory that we can safely stack allocate.  */
 extern ptrdiff_t emacs_re_safe_alloca;
 
+/* Maximum length of the string that 're_search_2' looks for before
+   trying to match a compiled pattern.  */
+enum { RE_LITERAL_MAX = 32 };
+
 /* This data structure represents a compiled pattern.  Before calling
    the pattern compiler, the fields 'buffer', 'allocated', 'fastmap',
    and 'translate' can be set.  After the pattern has been
@@ -118,6 +122,28 @@ #define EMACS_REGEX_H 1
   /* If true, multi-byte form in the target of match should be
      recognized as a multibyte character.  */
   bool_bf target_multibyte : 1;
+
+  /* If true, 're_search_2' may run the pattern with its lock-step
+     matcher instead of backtracking.  */
+  bool_bf can_use_nfa : 1;
+
+  /* If true, every match starts with the string in 'literal'.
+     Otherwise, every match merely contains it.  */
+  bool_bf literal_prefix : 1;
+
+  /* If true, 'literal' contains non-ASCII bytes, so it can be looked
+     for only in a target whose multibyteness is that of the pattern.  */
+  bool_bf literal_raw : 1;
+
+  /* Number of bytes in 'literal', or zero if there is no string that
+     every match must contain.  */
+  unsigned char literal_length;
+
+  /* A string that every match must contain.  Each byte of it matches
+     either itself or the corresponding byte of 'literal_alt', which
+     differs only if the pattern ignores case.  */
+  unsigned char literal[RE_LITERAL_MAX];
+  unsigned char literal_alt[RE_LITERAL_MAX];
 };
 
 /* Declarations for routines.  */
@@ -751,6 +751,189 @@ region_cache_backward (struct buffer *buf, struct region_cache *c,
   }
 }
 
+
+/* Interface: region caches as Lisp objects.  */
+
+/* The region caches made by `make-region-cache' that have not been
+   garbage collected yet, linked through their NEXT fields.  */
+static struct Lisp_Region_Cache *lisp_region_caches;
+
+/* Return the buffer whose text CACHE describes, following indirect
+   buffers to their base buffer.  Signal an error if it is dead.  */
+static struct buffer *
+lisp_region_cache_buffer (Lisp_Object cache)
+{
+  CHECK_REGION_CACHE (cache);
+  struct buffer *b = XBUFFER (XREGION_CACHE (cache)->buffer);
+  if (!BUFFER_LIVE_P (b))
+    error ("Region cache's buffer has been killed");
+  return b->base_buffer ? b->base_buffer : b;
+}
+
+/* Return POS as a position in the text of B, which need not be in its
+   accessible portion.  */
+static ptrdiff_t
+lisp_region_cache_position (struct buffer *b, Lisp_Object pos)
+{
+  EMACS_INT p = fix_position (pos);
+  if (! (BUF_BEG (b) <= p && p <= BUF_Z (b)))
+    args_out_of_range (pos, make_fixnum (BUF_Z (b)));
+  return p;
+}
+
+/* Invalidate the Lisp region caches of BUF, a base buffer, for a
+   change of its text between START and END.  */
+void
+invalidate_lisp_region_caches (struct buffer *buf,
+			       ptrdiff_t start, ptrdiff_t end)
+{
+  for (struct Lisp_Region_Cache *c = lisp_region_caches; c; c = c->next)
+    {
+      struct buffer *b = XBUFFER (c->buffer);
+      if ((b->base_buffer ? b->base_buffer : b) == buf && BUFFER_LIVE_P (b))
+	invalidate_region_cache (buf, c->cache,
+				 start - BUF_BEG (buf), BUF_Z (buf) - end);
+    }
+}
+
+/* Forget everything the Lisp region caches of BUF know, because its
+   text has been replaced by another buffer's.  */
+void
+reset_lisp_region_caches (struct buffer *buf)
+{
+  for (struct Lisp_Region_Cache *c = lisp_region_caches; c; c = c->next)
+    if (XBUFFER (c->buffer) == buf)
+      {
+	free_region_cache (c->cache);
+	c->cache = new_region_cache ();
+      }
+}
+
+/* Free the C data of CACHE, which is being garbage collected.  */
+void
+free_lisp_region_cache (struct Lisp_Region_Cache *cache)
+{
+  struct Lisp_Region_Cache **p = &lisp_region_caches;
+  while (*p != cache)
+    p = &(*p)->next;
+  *p = cache->next;
+  free_region_cache (cache->cache);
+}
+
+DEFUN ("make-region-cache", Fmake_region_cache, Smake_region_cache, 0, 1, 0,
+       doc: /* Return a new region cache for the text of BUFFER.
+BUFFER defaults to the current buffer.  A region cache records which
+stretches of the text Lisp code knows something about, for instance
+that they need no further scanning.  Use `region-cache-know' to record
+a stretch and `region-cache-query' to look one up.  When the text
+changes, the cache forgets what it knew about inserted or replaced
+text, and keeps what it knew about the rest, adjusting it for
+insertions and deletions.  */)
+  (Lisp_Object buffer)
+{
+  Lisp_Object buf = NILP (buffer) ? Fcurrent_buffer () : Fget_buffer (buffer);
+  if (NILP (buf))
+    nsberror (buffer);
+  if (!BUFFER_LIVE_P (XBUFFER (buf)))
+    error ("Selecting deleted buffer");
+
+  struct Lisp_Region_Cache *c
+    = ALLOCATE_PSEUDOVECTOR (struct Lisp_Region_Cache, buffer,
+			     PVEC_REGION_CACHE);
+  c->buffer = buf;
+  c->cache = new_region_cache ();
+  c->next = lisp_region_caches;
+  lisp_region_caches = c;
+
+  Lisp_Object cache;
+  XSETPSEUDOVECTOR (cache, c, PVEC_REGION_CACHE);
+  return cache;
+}
+
+DEFUN ("region-cache-p", Fregion_cache_p, Sregion_cache_p, 1, 1, 0,
+       doc: /* Return t if OBJECT is a region cache made by `make-region-cache'.  */)
+  (Lisp_Object object)
+{
+  return REGION_CACHEP (object) ? Qt : Qnil;
+}
+
+DEFUN ("region-cache-buffer", Fregion_cache_buffer, Sregion_cache_buffer,
+       1, 1, 0,
+       doc: /* Return the buffer whose text CACHE describes.  */)
+  (Lisp_Object cache)
+{
+  CHECK_REGION_CACHE (cache);
+  return XREGION_CACHE (cache)->buffer;
+}
+
+DEFUN ("region-cache-know", Fregion_cache_know, Sregion_cache_know, 3, 3, 0,
+       doc: /* Record in CACHE that the text between START and END is known.
+START and END are positions in the buffer of CACHE, and may be in any
+order; narrowing does not affect them.  */)
+  (Lisp_Object cache, Lisp_Object start, Lisp_Object end)
+{
+  struct buffer *b = lisp_region_cache_buffer (cache);
+  ptrdiff_t s = lisp_region_cache_position (b, start);
+  ptrdiff_t e = lisp_region_cache_position (b, end);
+  if (s > e)
+    {
+      ptrdiff_t tem = s;
+      s = e;
+      e = tem;
+    }
+  if (s < e)
+    know_region_cache (b, XREGION_CACHE (cache)->cache, s, e);
+  return Qnil;
+}
+
+DEFUN ("region-cache-forget", Fregion_cache_forget, Sregion_cache_forget,
+       1, 3, 0,
+       doc: /* Record in CACHE that the text between START and END is not known.
+START and END default to the beginning and end of the buffer of CACHE,
+and may be in any order; narrowing does not affect them.  */)
+  (Lisp_Object cache, Lisp_Object start, Lisp_Object end)
+{
+  struct buffer *b = lisp_region_cache_buffer (cache);
+  ptrdiff_t s = (NILP (start) ? BUF_BEG (b)
+		 : lisp_region_cache_position (b, start));
+  ptrdiff_t e = (NILP (end) ? BUF_Z (b)
+		 : lisp_region_cache_position (b, end));
+  if (s > e)
+    {
+      ptrdiff_t tem = s;
+      s = e;
+      e = tem;
+    }
+  if (s < e)
+    {
+      struct region_cache *c = XREGION_CACHE (cache)->cache;
+      revalidate_region_cache (b, c);
+      set_cache_region (c, s, e, 0);
+    }
+  return Qnil;
+}
+
+DEFUN ("region-cache-query", Fregion_cache_query, Sregion_cache_query,
+       2, 3, 0,
+       doc: /* Return how far the known text after POS extends, according to CACHE.
+If the character after POS is known, return the position where the
+stretch of known text that contains it ends.  Otherwise return nil.
+If BACKWARD is non-nil, look at the character before POS instead, and
+return the position where the stretch of known text that contains it
+begins.  POS is a position in the buffer of CACHE; narrowing does not
+affect it.  */)
+  (Lisp_Object cache, Lisp_Object pos, Lisp_Object backward)
+{
+  struct buffer *b = lisp_region_cache_buffer (cache);
+  ptrdiff_t p = lisp_region_cache_position (b, pos);
+  struct region_cache *c = XREGION_CACHE (cache)->cache;
+  ptrdiff_t next;
+  bool known = (NILP (backward)
+		? region_cache_forward (b, c, p, &next)
+		: region_cache_backward (b, c, p, &next));
+  return known ? make_fixnum (next) : Qnil;
+}
+
 #ifdef ENABLE_CHECKING
 
 /* Debugging: pretty-print a cache to the standard error output.  */
@@ -779,3 +962,18 @@ pp_cache (struct region_cache *c)
 }
 
 #endif /* ENABLE_CHECKING */
+
+
+void
+syms_of_region_cache (void)
+{
+  DEFSYM (Qregion_cache, "region-cache");
+  DEFSYM (Qregion_cache_p, "region-cache-p");
+
+  defsubr (&Smake_region_cache);
+  defsubr (&Sregion_cache_p);
+  defsubr (&Sregion_cache_buffer);
+  defsubr (&Sregion_cache_know);
+  defsubr (&Sregion_cache_forget);
+  defsubr (&Sregion_cache_query);
+}
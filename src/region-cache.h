@@ -109,4 +109,12 @@ #define EMACS_REGION_CACHE_H
 extern int region_cache_backward (struct buffer *buf, struct region_cache *c,
 				  ptrdiff_t pos, ptrdiff_t *next);
 
+/* Invalidate the caches made by `make-region-cache' for BUF, a base
+   buffer, when its text between START and END changes.  */
+extern void invalidate_lisp_region_caches (struct buffer *BUF,
+					   ptrdiff_t START, ptrdiff_t END);
+
+/* Empty the caches made by `make-region-cache' for BUF.  */
+extern void reset_lisp_region_caches (struct buffer *BUF);
+
 #endif /* EMACS_REGION_CACHE_H */
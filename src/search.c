@@ -32,18 +32,22 @@ Copyright (C) 1985-1987, 1993-1994, 1997-1999, 2001-2025 Free Software
 #include "region-cache.h"
 #include "blockinput.h"
 #include "intervals.h"
-#include "pdumper.h"
 #include "composite.h"
+#include "probes.h"
 
 #include "regex-emacs.h"
 
-#define REGEXP_CACHE_SIZE 20
-
 /* If the regexp is non-nil, then the buffer contains the compiled form
    of that regexp, suitable for searching.  */
 struct regexp_cache
 {
-  struct regexp_cache *next;
+  /* The next more recently and less recently used entries.  */
+  struct regexp_cache *prev, *next;
+  /* The next entry in the same bucket of 'searchbuf_table'.  */
+  struct regexp_cache *hash_next;
+  /* Hash of the regexp and the data it was compiled for, if the
+     regexp is non-nil.  */
+  EMACS_UINT hash;
   Lisp_Object regexp, f_whitespace_regexp;
   /* Syntax table for which the regexp applies.  We need this because
      of character classes.  If this is t, then the compiled pattern is valid
@@ -57,11 +61,17 @@ #define REGEXP_CACHE_SIZE 20
   bool busy;
 };
 
-/* The instances of that struct.  */
-static struct regexp_cache searchbufs[REGEXP_CACHE_SIZE];
+/* The most recently and the least recently used entries.  */
+static struct regexp_cache *searchbuf_head, *searchbuf_tail;
+
+/* The number of entries.  This exceeds 'regexp-cache-size' only while
+   all entries are in use by searches in progress.  */
+static ptrdiff_t searchbuf_count;
 
-/* The head of the linked list; points to the most recently used buffer.  */
-static struct regexp_cache *searchbuf_head;
+/* Hash table of the entries with a non-nil regexp, chained through
+   their 'hash_next' members.  Its size is a power of 2.  */
+static struct regexp_cache **searchbuf_table;
+static ptrdiff_t searchbuf_table_size;
 
 static void set_search_regs (ptrdiff_t, ptrdiff_t);
 static void save_search_regs (void);
@@ -151,6 +161,134 @@ shrink_regexp_cache (void)
       }
 }
 
+/* Mark the Lisp objects in the cache.
+   This is called from garbage collection.  */
+
+void
+mark_regexp_cache (void)
+{
+  for (struct regexp_cache *cp = searchbuf_head; cp; cp = cp->next)
+    {
+      mark_object (cp->regexp);
+      mark_object (cp->f_whitespace_regexp);
+      mark_object (cp->syntax_table);
+    }
+}
+
+/* Remove CP from the hash table, if it is there.  */
+
+static void
+searchbuf_unhash (struct regexp_cache *cp)
+{
+  if (NILP (cp->regexp))
+    return;
+  struct regexp_cache **p
+    = &searchbuf_table[cp->hash & (searchbuf_table_size - 1)];
+  while (*p != cp)
+    p = &(*p)->hash_next;
+  *p = cp->hash_next;
+}
+
+/* Add CP, whose regexp is non-nil, to the hash table.  */
+
+static void
+searchbuf_hash (struct regexp_cache *cp)
+{
+  struct regexp_cache **p
+    = &searchbuf_table[cp->hash & (searchbuf_table_size - 1)];
+  cp->hash_next = *p;
+  *p = cp;
+}
+
+/* Remove CP from the list of entries.  */
+
+static void
+searchbuf_unlink (struct regexp_cache *cp)
+{
+  if (cp->prev)
+    cp->prev->next = cp->next;
+  else
+    searchbuf_head = cp->next;
+  if (cp->next)
+    cp->next->prev = cp->prev;
+  else
+    searchbuf_tail = cp->prev;
+}
+
+/* Put CP at the front of the list of entries.  */
+
+static void
+searchbuf_push (struct regexp_cache *cp)
+{
+  cp->prev = NULL;
+  cp->next = searchbuf_head;
+  if (searchbuf_head)
+    searchbuf_head->prev = cp;
+  else
+    searchbuf_tail = cp;
+  searchbuf_head = cp;
+}
+
+/* Return the hash of an entry for a pattern whose contents hash to
+   PATTERN_HASH, compiled with TRANSLATE and POSIX and valid for
+   SYNTAX_TABLE.  */
+
+static EMACS_UINT
+regexp_cache_hash (EMACS_UINT pattern_hash, Lisp_Object translate,
+		   bool posix, Lisp_Object syntax_table)
+{
+  EMACS_UINT hash = sxhash_combine (pattern_hash, XHASH (translate));
+  return sxhash_combine (sxhash_combine (hash, XHASH (syntax_table)), posix);
+}
+
+/* Return the number of entries the cache should hold.  */
+
+static ptrdiff_t
+regexp_cache_limit (void)
+{
+  return clip_to_bounds (1, regexp_cache_size, PTRDIFF_MAX / 4);
+}
+
+/* Make the hash table big enough for a cache of LIMIT entries.  */
+
+static void
+searchbuf_resize_table (ptrdiff_t limit)
+{
+  ptrdiff_t size = 16;
+  while (size < 2 * limit)
+    size *= 2;
+  if (size == searchbuf_table_size)
+    return;
+  xfree (searchbuf_table);
+  searchbuf_table = xzalloc (size * sizeof *searchbuf_table);
+  searchbuf_table_size = size;
+  for (struct regexp_cache *cp = searchbuf_head; cp; cp = cp->next)
+    if (!NILP (cp->regexp))
+      searchbuf_hash (cp);
+}
+
+/* Discard the least recently used entries that are not in use, until
+   there are at most LIMIT left.  */
+
+static void
+searchbuf_trim (ptrdiff_t limit)
+{
+  struct regexp_cache *cp = searchbuf_tail;
+  while (searchbuf_count > limit && cp)
+    {
+      struct regexp_cache *prev = cp->prev;
+      if (!cp->busy)
+	{
+	  searchbuf_unhash (cp);
+	  searchbuf_unlink (cp);
+	  xfree (cp->buf.buffer);
+	  xfree (cp);
+	  searchbuf_count--;
+	}
+      cp = prev;
+    }
+}
+
 /* Clear the regexp cache w.r.t. a particular syntax table,
    because it was changed.
    There is no danger of memory leak here because re_compile_pattern
@@ -159,14 +297,15 @@ shrink_regexp_cache (void)
 void
 clear_regexp_cache (void)
 {
-  int i;
-
-  for (i = 0; i < REGEXP_CACHE_SIZE; ++i)
+  for (struct regexp_cache *cp = searchbuf_head; cp; cp = cp->next)
     /* It's tempting to compare with the syntax-table we've actually changed,
        but it's not sufficient because char-table inheritance means that
        modifying one syntax-table can change others at the same time.  */
-    if (!searchbufs[i].busy && !BASE_EQ (searchbufs[i].syntax_table, Qt))
-      searchbufs[i].regexp = Qnil;
+    if (!cp->busy && !BASE_EQ (cp->syntax_table, Qt))
+      {
+	searchbuf_unhash (cp);
+	cp->regexp = Qnil;
+      }
 }
 
 static void
@@ -199,54 +338,71 @@ freeze_pattern (struct regexp_cache *searchbuf)
 compile_pattern (Lisp_Object pattern, struct re_registers *regp,
 		 Lisp_Object translate, bool posix, bool multibyte)
 {
-  struct regexp_cache *cp, **cpp, **lru_nonbusy;
+  struct regexp_cache *cp;
+  ptrdiff_t limit = regexp_cache_limit ();
+  EMACS_UINT pattern_hash = hash_string (SSDATA (pattern), SBYTES (pattern));
 
-  for (cpp = &searchbuf_head, lru_nonbusy = NULL; ; cpp = &cp->next)
-    {
-      cp = *cpp;
-      if (!cp->busy)
-        lru_nonbusy = cpp;
-      /* Entries are initialized to nil, and may be set to nil by
-	 compile_pattern_1 if the pattern isn't valid.  Don't apply
-	 string accessors in those cases.  However, compile_pattern_1
-	 is only applied to the cache entry we pick here to reuse.  So
-	 nil should never appear before a non-nil entry.  */
-      if (NILP (cp->regexp))
-	goto compile_it;
-      if (SCHARS (cp->regexp) == SCHARS (pattern)
-          && !cp->busy
-	  && STRING_MULTIBYTE (cp->regexp) == STRING_MULTIBYTE (pattern)
-	  && !NILP (Fstring_equal (cp->regexp, pattern))
-	  && BASE_EQ (cp->buf.translate, translate)
-	  && cp->posix == posix
-	  && (BASE_EQ (cp->syntax_table, Qt)
-	      || BASE_EQ (cp->syntax_table,
-			  BVAR (current_buffer, syntax_table)))
-	  && !NILP (Fequal (cp->f_whitespace_regexp, Vsearch_spaces_regexp))
-	  && cp->buf.charset_unibyte == charset_unibyte)
-	break;
+  if (searchbuf_table_size < 2 * limit)
+    searchbuf_resize_table (limit);
 
-      /* If we're at the end of the cache, compile into the last
-	 (least recently used) non-busy cell in the cache.  */
-      if (cp->next == 0)
-	{
-          if (!lru_nonbusy)
-            error ("Too much matching reentrancy");
-          cpp = lru_nonbusy;
-          cp = *cpp;
-	compile_it:
-          eassert (!cp->busy);
-	  compile_pattern_1 (cp, pattern, translate, posix);
-	  break;
-	}
+  /* Look for an entry valid for any syntax table, then for one valid
+     for the current one.  */
+  for (int i = 0; i < 2; i++)
+    {
+      Lisp_Object syntax_table
+	= i == 0 ? Qt : BVAR (current_buffer, syntax_table);
+      EMACS_UINT hash = regexp_cache_hash (pattern_hash, translate, posix,
+					   syntax_table);
+      for (cp = searchbuf_table[hash & (searchbuf_table_size - 1)];
+	   cp; cp = cp->hash_next)
+	if (cp->hash == hash
+	    && !cp->busy
+	    && SBYTES (cp->regexp) == SBYTES (pattern)
+	    && STRING_MULTIBYTE (cp->regexp) == STRING_MULTIBYTE (pattern)
+	    && !memcmp (SDATA (cp->regexp), SDATA (pattern), SBYTES (pattern))
+	    && BASE_EQ (cp->buf.translate, translate)
+	    && cp->posix == posix
+	    && BASE_EQ (cp->syntax_table, syntax_table)
+	    && !NILP (Fequal (cp->f_whitespace_regexp, Vsearch_spaces_regexp))
+	    && cp->buf.charset_unibyte == charset_unibyte)
+	  {
+	    regexp_cache_hits++;
+	    goto found;
+	  }
     }
 
-  /* When we get here, cp (aka *cpp) contains the compiled pattern,
-     either because we found it in the cache or because we just compiled it.
+  regexp_cache_misses++;
+  EMACS_PROBE1 (regexp_cache_miss, SSDATA (pattern));
+
+  /* Compile into the least recently used entry that is not in use,
+     or into a new one if the cache is not full yet.  */
+  searchbuf_trim (limit);
+  if (searchbuf_count < limit)
+    cp = NULL;
+  else
+    for (cp = searchbuf_tail; cp && cp->busy; cp = cp->prev)
+      continue;
+  if (cp)
+    searchbuf_unhash (cp);
+  else
+    {
+      cp = xzalloc (sizeof *cp);
+      cp->buf.fastmap = cp->fastmap;
+      cp->regexp = cp->f_whitespace_regexp = cp->syntax_table = Qnil;
+      searchbuf_push (cp);
+      searchbuf_count++;
+    }
+  compile_pattern_1 (cp, pattern, translate, posix);
+  cp->hash = regexp_cache_hash (pattern_hash, translate, posix,
+				cp->syntax_table);
+  searchbuf_hash (cp);
+
+ found:
+  /* When we get here, cp contains the compiled pattern, either
+     because we found it in the cache or because we just compiled it.
      Move it to the front of the queue to mark it as most recently used.  */
-  *cpp = cp->next;
-  cp->next = searchbuf_head;
-  searchbuf_head = cp;
+  searchbuf_unlink (cp);
+  searchbuf_push (cp);
 
   /* Advise the searching functions about the space we have allocated
      for register data.  */
@@ -592,6 +748,365 @@ fast_looking_at (Lisp_Object regexp, ptrdiff_t pos, ptrdiff_t pos_byte,
 }
 
 
+/* Counting newlines.  */
+
+/* Return the number of newlines in the N bytes at P.  */
+
+static ptrdiff_t
+count_newline_bytes (unsigned char const *p, ptrdiff_t n)
+{
+  ptrdiff_t count = 0;
+
+  /* Count in 16 byte-sized counters at a time, which compilers turn
+     into a few vector instructions per 16 bytes.  The counters are
+     added up before they can overflow.  */
+  enum { LANES = 16, ROUNDS = UCHAR_MAX };
+  while (n >= LANES * ROUNDS)
+    {
+      unsigned char lane[LANES] = { 0 };
+      for (int r = 0; r < ROUNDS; r++, p += LANES)
+	for (int i = 0; i < LANES; i++)
+	  lane[i] += p[i] == '\n';
+      for (int i = 0; i < LANES; i++)
+	count += lane[i];
+      n -= LANES * ROUNDS;
+    }
+  for (ptrdiff_t i = 0; i < n; i++)
+    count += p[i] == '\n';
+  return count;
+}
+
+/* Return the number of newlines in the text of buffer B between byte
+   positions FROM_BYTE and TO_BYTE.  */
+
+static ptrdiff_t
+buf_count_newlines (struct buffer *b, ptrdiff_t from_byte, ptrdiff_t to_byte)
+{
+  ptrdiff_t count = 0;
+
+  if (from_byte < BUF_GPT_BYTE (b) && BUF_GPT_BYTE (b) < to_byte)
+    {
+      count = count_newline_bytes (BUF_BYTE_ADDRESS (b, from_byte),
+				   BUF_GPT_BYTE (b) - from_byte);
+      from_byte = BUF_GPT_BYTE (b);
+    }
+  if (from_byte < to_byte)
+    count += count_newline_bytes (BUF_BYTE_ADDRESS (b, from_byte),
+				  to_byte - from_byte);
+  return count;
+}
+
+/* The line index: remembering how many lines precede places in the
+   text.
+
+   Counting the lines before a position in a large buffer means
+   scanning everything before it.  So such buffers get a sparse index
+   of checkpoints, LINE_INDEX_INTERVAL bytes apart, each of which
+   records the number of newlines before it.  The checkpoints are
+   recorded while counting, from the start of the buffer on, and kept
+   up to date as the text changes: insertions move the checkpoints
+   after them, and other changes discard the checkpoints after them
+   unless they are small enough to count the newlines they remove.  */
+
+enum { LINE_INDEX_INTERVAL = 64 * 1024 };
+
+/* Buffers smaller than this many bytes don't use an index.  */
+enum { LINE_INDEX_THRESHOLD = 4 * LINE_INDEX_INTERVAL };
+
+struct line_checkpoint
+{
+  ptrdiff_t bytepos;
+  /* The number of newlines before BYTEPOS.  */
+  ptrdiff_t lines;
+};
+
+struct line_index
+{
+  /* The value of Z_BYTE that the checkpoints are valid for.  If it
+     doesn't match the buffer, the text was changed in a way this
+     index didn't hear about, and the checkpoints are discarded.  */
+  ptrdiff_t z_byte;
+
+  /* The checkpoints, in increasing order of position.  */
+  struct line_checkpoint *checkpoints;
+  ptrdiff_t count, size;
+
+  /* If CHANGE_START is nonnegative, the bytes from there to
+     CHANGE_END, which contained CHANGE_LINES newlines, are about to
+     be deleted or replaced.  */
+  ptrdiff_t change_start, change_end, change_lines;
+};
+
+/* Return the number of checkpoints in IX that are at or before
+   BYTEPOS.  */
+
+static ptrdiff_t
+line_index_search (struct line_index *ix, ptrdiff_t bytepos)
+{
+  ptrdiff_t lo = 0, hi = ix->count;
+
+  while (lo < hi)
+    {
+      ptrdiff_t mid = lo + (hi - lo) / 2;
+      if (ix->checkpoints[mid].bytepos <= bytepos)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  return lo;
+}
+
+/* Discard the checkpoints of IX that are after BYTEPOS.  */
+
+static void
+line_index_truncate (struct line_index *ix, ptrdiff_t bytepos)
+{
+  ix->count = line_index_search (ix, bytepos);
+}
+
+/* Return the line index of the current buffer, creating it if needed,
+   or NULL if the buffer is too small to need one.  */
+
+static struct line_index *
+line_index (void)
+{
+  struct line_index *ix = current_buffer->text->line_index;
+
+  if (!ix)
+    {
+      if (Z_BYTE < LINE_INDEX_THRESHOLD)
+	return NULL;
+      ix = current_buffer->text->line_index = xzalloc (sizeof *ix);
+      ix->change_start = -1;
+      ix->z_byte = Z_BYTE;
+    }
+  if (ix->z_byte != Z_BYTE)
+    {
+      ix->count = 0;
+      ix->z_byte = Z_BYTE;
+    }
+
+  /* A change that was announced but never done by insdel.c happened
+     in place, so it may have changed any newline in its region.  */
+  if (ix->change_start >= 0)
+    {
+      line_index_truncate (ix, ix->change_start);
+      ix->change_start = -1;
+    }
+  return ix;
+}
+
+/* Return the number of newlines before BYTEPOS in the current buffer,
+   whose line index is IX.  Record new checkpoints if they are needed
+   to count them.  */
+
+static ptrdiff_t
+line_index_lines (struct line_index *ix, ptrdiff_t bytepos)
+{
+  ptrdiff_t i = line_index_search (ix, bytepos);
+  struct line_checkpoint prev = { BEG_BYTE, 0 };
+
+  if (i > 0)
+    prev = ix->checkpoints[i - 1];
+  if (i < ix->count)
+    {
+      /* Count from the nearer of the checkpoints around BYTEPOS.  */
+      struct line_checkpoint next = ix->checkpoints[i];
+      if (bytepos - prev.bytepos <= next.bytepos - bytepos)
+	return prev.lines + buf_count_newlines (current_buffer,
+						prev.bytepos, bytepos);
+      else
+	return next.lines - buf_count_newlines (current_buffer,
+						bytepos, next.bytepos);
+    }
+
+  /* BYTEPOS is after the last checkpoint: extend the index up to it.
+     Put the new checkpoints at character boundaries, so that
+     'line_index_skip' can return them.  */
+  while (bytepos - prev.bytepos >= LINE_INDEX_INTERVAL)
+    {
+      ptrdiff_t next = prev.bytepos + LINE_INDEX_INTERVAL;
+      if (!NILP (BVAR (current_buffer, enable_multibyte_characters)))
+	while (!CHAR_HEAD_P (FETCH_BYTE (next)))
+	  next++;
+      if (next > bytepos)
+	break;
+      prev.lines += buf_count_newlines (current_buffer, prev.bytepos, next);
+      prev.bytepos = next;
+      if (ix->count == ix->size)
+	ix->checkpoints = xpalloc (ix->checkpoints, &ix->size, 1, -1,
+				   sizeof *ix->checkpoints);
+      ix->checkpoints[ix->count++] = prev;
+    }
+  return prev.lines + buf_count_newlines (current_buffer,
+					  prev.bytepos, bytepos);
+}
+
+/* Return the number of newlines in the current buffer between byte
+   positions START_BYTE and END_BYTE.  */
+
+ptrdiff_t
+count_newlines (ptrdiff_t start_byte, ptrdiff_t end_byte)
+{
+  struct line_index *ix = line_index ();
+
+  /* Use the index only if that is cheaper than counting directly,
+     i.e., if the index already covers START_BYTE or the text between
+     the end of what it covers and START_BYTE is smaller than the text
+     to count.  */
+  if (ix)
+    {
+      ptrdiff_t covered = (ix->count
+			   ? ix->checkpoints[ix->count - 1].bytepos
+			   : BEG_BYTE);
+      if (end_byte - start_byte > start_byte - covered)
+	{
+	  ptrdiff_t end_lines = line_index_lines (ix, end_byte);
+	  return end_lines - line_index_lines (ix, start_byte);
+	}
+    }
+  return buf_count_newlines (current_buffer, start_byte, end_byte);
+}
+
+/* Return a byte position between START_BYTE and END_BYTE in the
+   current buffer that is less than COUNT lines after START_BYTE, as
+   far as the line index can tell without scanning much, and set
+   *SKIPPED to the number of newlines between the two.  */
+
+static ptrdiff_t
+line_index_skip (ptrdiff_t start_byte, ptrdiff_t end_byte, ptrdiff_t count,
+		 ptrdiff_t *skipped)
+{
+  struct line_index *ix = line_index ();
+
+  *skipped = 0;
+  if (count < LINE_INDEX_INTERVAL / 32 || !ix
+      || end_byte - start_byte < 2 * LINE_INDEX_INTERVAL)
+    return start_byte;
+
+  /* Extend the index towards END_BYTE until it covers the COUNTth
+     newline, unless it would first have to cover much text before
+     START_BYTE.  Counting newlines is faster than finding them one
+     by one.  */
+  ptrdiff_t covered = (ix->count
+		       ? ix->checkpoints[ix->count - 1].bytepos : BEG_BYTE);
+  if (covered < start_byte - LINE_INDEX_INTERVAL)
+    return start_byte;
+  ptrdiff_t start_lines = line_index_lines (ix, start_byte);
+  ptrdiff_t target = start_lines + count;
+  while (covered <= end_byte - 2 * LINE_INDEX_INTERVAL
+	 && (ix->count == 0 || ix->checkpoints[ix->count - 1].lines < target))
+    {
+      line_index_lines (ix, min (end_byte,
+				 covered + 16 * LINE_INDEX_INTERVAL));
+      covered = ix->checkpoints[ix->count - 1].bytepos;
+    }
+
+  /* Find the last checkpoint before END_BYTE with fewer than TARGET
+     newlines before it; the COUNTth newline after START_BYTE is
+     after that checkpoint.  */
+  ptrdiff_t lo = 0, hi = line_index_search (ix, end_byte - 1);
+  while (lo < hi)
+    {
+      ptrdiff_t mid = lo + (hi - lo) / 2;
+      if (ix->checkpoints[mid].lines < target)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  if (lo == 0 || ix->checkpoints[lo - 1].bytepos <= start_byte)
+    return start_byte;
+  *skipped = ix->checkpoints[lo - 1].lines - start_lines;
+  return ix->checkpoints[lo - 1].bytepos;
+}
+
+/* Prepare the line index of buffer B for a change of the text between
+   byte positions FROM_BYTE and TO_BYTE.  */
+
+void
+invalidate_line_index (struct buffer *b, ptrdiff_t from_byte,
+		       ptrdiff_t to_byte)
+{
+  struct line_index *ix = b->text->line_index;
+
+  if (!ix || from_byte == to_byte)
+    return;
+  if (ix->change_start >= 0)
+    line_index_truncate (ix, ix->change_start);
+  ix->change_start = -1;
+
+  /* Count the newlines that a deletion or replacement would remove,
+     unless that is more work than counting the text after it again.  */
+  ptrdiff_t i = line_index_search (ix, from_byte);
+  if (i < ix->count && to_byte - from_byte <= LINE_INDEX_INTERVAL)
+    {
+      ix->change_start = from_byte;
+      ix->change_end = to_byte;
+      ix->change_lines = buf_count_newlines (b, from_byte, to_byte);
+    }
+  else
+    ix->count = i;
+}
+
+/* Update the line index of buffer B for the replacement of OLD_BYTES
+   bytes at FROM_BYTE by NEW_BYTES bytes, which are already in the
+   buffer.  */
+
+void
+adjust_line_index (struct buffer *b, ptrdiff_t from_byte,
+		   ptrdiff_t old_bytes, ptrdiff_t new_bytes)
+{
+  struct line_index *ix = b->text->line_index;
+
+  if (!ix)
+    return;
+
+  /* The newlines removed by a deletion or replacement were counted
+     by invalidate_line_index, if it announced this change.  */
+  bool announced = (old_bytes > 0 && ix->change_start == from_byte
+		    && ix->change_end == from_byte + old_bytes);
+  if (ix->change_start >= 0 && !announced)
+    line_index_truncate (ix, ix->change_start);
+  ix->change_start = -1;
+
+  ptrdiff_t diff_lines = 0;
+  if (old_bytes == 0 || announced)
+    diff_lines = (buf_count_newlines (b, from_byte, from_byte + new_bytes)
+		  - (announced ? ix->change_lines : 0));
+  else
+    line_index_truncate (ix, from_byte);
+
+  /* Discard the checkpoints inside the old text and move the ones
+     after it.  */
+  ptrdiff_t lo = line_index_search (ix, from_byte);
+  ptrdiff_t hi = line_index_search (ix, from_byte + old_bytes - 1);
+  hi = max (lo, hi);
+  memmove (ix->checkpoints + lo, ix->checkpoints + hi,
+	   (ix->count - hi) * sizeof *ix->checkpoints);
+  ix->count -= hi - lo;
+  for (ptrdiff_t i = lo; i < ix->count; i++)
+    {
+      ix->checkpoints[i].bytepos += new_bytes - old_bytes;
+      ix->checkpoints[i].lines += diff_lines;
+    }
+  ix->z_byte += new_bytes - old_bytes;
+}
+
+/* Free the line index of buffer B.  */
+
+void
+free_line_index (struct buffer *b)
+{
+  struct line_index *ix = b->text->line_index;
+
+  if (ix)
+    {
+      xfree (ix->checkpoints);
+      xfree (ix);
+      b->text->line_index = NULL;
+    }
+}
+
 /* The newline cache: remembering which sections of text have no newlines.  */
 
 /* If the user has requested the long scans caching, make sure it's on.
@@ -698,6 +1213,22 @@ find_newline (ptrdiff_t start, ptrdiff_t start_byte, ptrdiff_t end,
   if (counted)
     *counted = count;
 
+  /* Let the line index skip most of a long stretch of lines.  */
+  if (count > 0)
+    {
+      ptrdiff_t skipped;
+      if (start_byte == -1)
+	start_byte = CHAR_TO_BYTE (start);
+      ptrdiff_t skip_byte = line_index_skip (start_byte, end_byte, count,
+					     &skipped);
+      if (skip_byte != start_byte)
+	{
+	  start = BYTE_TO_CHAR (skip_byte);
+	  start_byte = skip_byte;
+	  count -= skipped;
+	}
+    }
+
   if (count > 0)
     while (start != end)
       {
@@ -1153,7 +1684,8 @@ while (0)
 
 /* Only used in search_buffer, to record the end position of the match
    when searching regexps and SEARCH_REGS should not be changed
-   (i.e. Vinhibit_changing_match_data is non-nil).  */
+   (i.e. Vinhibit_changing_match_data is non-nil), and in
+   re-search-matches.  */
 static struct re_registers search_regs_1;
 
 static EMACS_INT
@@ -2356,6 +2888,123 @@ DEFUN ("posix-search-forward", Fposix_search_forward, Sposix_search_forward, 1,
 {
   return search_command (regexp, bound, noerror, count, 1, true, true);
 }
+
+DEFUN ("re-search-matches", Fre_search_matches, Sre_search_matches, 1, 4, 0,
+       doc: /* Return the positions of the matches for REGEXP between START and END.
+START and END are buffer positions, in either order; nil means point
+and the end of the accessible portion of the buffer, respectively.
+
+Find successive, non-overlapping matches the way repeated calls to
+`re-search-forward' with END as the bound would: no match extends past
+END, and the search for each match starts where the previous one
+ended, or one character after it if it was empty, until it reaches END.
+
+The value is a vector [BEG1 END1 BEG2 END2 ...] of the start and end
+positions of the matches, in buffer order.  Optional fourth argument
+LIMIT, if non-nil, is the maximum number of matches to find.
+
+This function does not move point or change the match data.  Search
+case-sensitivity is determined by the value of the variable
+`case-fold-search', which see.  */)
+  (Lisp_Object regexp, Lisp_Object start, Lisp_Object end, Lisp_Object limit)
+{
+  CHECK_STRING (regexp);
+  EMACS_INT nmax = -1;
+  if (!NILP (limit))
+    {
+      CHECK_FIXNAT (limit);
+      nmax = XFIXNAT (limit);
+    }
+  ptrdiff_t pos = NILP (start) ? PT : fix_position (start);
+  ptrdiff_t lim = NILP (end) ? ZV : fix_position (end);
+  if (pos > lim)
+    {
+      ptrdiff_t tem = pos;
+      pos = lim;
+      lim = tem;
+    }
+  if (! (BEGV <= pos && lim <= ZV))
+    args_out_of_range (start, end);
+
+  /* This is so set_image_of_range_1 in regex-emacs.c can find the EQV
+     table.  */
+  set_char_table_extras (BVAR (current_buffer, case_canon_table), 2,
+			 BVAR (current_buffer, case_eqv_table));
+
+  bool multibyte = !NILP (BVAR (current_buffer, enable_multibyte_characters));
+  struct regexp_cache *cache_entry
+    = compile_pattern (regexp, &search_regs_1,
+		       (!NILP (Vcase_fold_search)
+			? BVAR (current_buffer, case_canon_table)
+			: Qnil),
+		       false, multibyte);
+  struct re_pattern_buffer *bufp = &cache_entry->buf;
+
+  maybe_quit ();
+
+  unsigned char *p1 = BEGV_ADDR;
+  ptrdiff_t s1 = GPT_BYTE - BEGV_BYTE;
+  unsigned char *p2 = GAP_END_ADDR;
+  ptrdiff_t s2 = ZV_BYTE - GPT_BYTE;
+  if (s1 < 0)
+    {
+      p2 = p1;
+      s2 = ZV_BYTE - BEGV_BYTE;
+      s1 = 0;
+    }
+  if (s2 < 0)
+    {
+      s1 = ZV_BYTE - BEGV_BYTE;
+      s2 = 0;
+    }
+
+  specpdl_ref count = SPECPDL_INDEX ();
+  freeze_buffer_relocation ();
+  freeze_pattern (cache_entry);
+
+  ptrdiff_t pos_byte = CHAR_TO_BYTE (pos);
+  ptrdiff_t lim_byte = CHAR_TO_BYTE (lim);
+  Lisp_Object matches = make_nil_vector (16);
+  ptrdiff_t n = 0;
+  while (pos < lim && (nmax < 0 || n < 2 * nmax))
+    {
+      re_match_object = Qnil;
+      ptrdiff_t val = re_search_2 (bufp, (char *) p1, s1, (char *) p2, s2,
+				   pos_byte - BEGV_BYTE, lim_byte - pos_byte,
+				   &search_regs_1, lim_byte - BEGV_BYTE);
+      if (val == -2)
+	{
+	  unbind_to (count, Qnil);
+	  matcher_overflow ();
+	}
+      if (val < 0)
+	break;
+
+      ptrdiff_t beg_byte = search_regs_1.start[0] + BEGV_BYTE;
+      pos_byte = search_regs_1.end[0] + BEGV_BYTE;
+      pos = BYTE_TO_CHAR (pos_byte);
+      if (ASIZE (matches) - n < 2)
+	matches = larger_vector (matches, 2, -1);
+      ASET (matches, n++, make_fixnum (BYTE_TO_CHAR (beg_byte)));
+      ASET (matches, n++, make_fixnum (pos));
+
+      /* Ensure forward progress on empty matches.  */
+      if (beg_byte == pos_byte)
+	{
+	  if (pos >= lim)
+	    break;
+	  pos_byte += multibyte ? next_char_len (pos_byte) : 1;
+	  pos++;
+	}
+      maybe_quit ();
+    }
+  unbind_to (count, Qnil);
+
+  Lisp_Object result = make_uninit_vector (n);
+  memcpy (XVECTOR (result)->contents, XVECTOR (matches)->contents,
+	  n * word_size);
+  return result;
+}
 
 DEFUN ("replace-match", Freplace_match, Sreplace_match, 1, 5, 0,
        doc: /* Replace text matched by last search with NEWTEXT.
@@ -2760,6 +3409,14 @@ DEFUN ("replace-match", Freplace_match, Sreplace_match, 1, 5, 0,
 
   newpoint = sub_start + SCHARS (newtext);
 
+  /* If the case of the new text is to be converted, report the
+     replacement and the conversion to the modification hooks as one
+     change.  */
+  bool convert_case = case_action == all_caps || case_action == cap_initial;
+  specpdl_ref count UNINIT;
+  if (convert_case)
+    count = begin_combined_change (sub_start, sub_end);
+
   /* Replace the old text with the new in the cleanest possible way.  */
   replace_range (sub_start, sub_end, newtext, true, false, true);
 
@@ -2771,6 +3428,10 @@ DEFUN ("replace-match", Freplace_match, Sreplace_match, 1, 5, 0,
     Fupcase_initials_region (make_fixnum (search_regs.start[sub]),
 			     make_fixnum (newpoint), Qnil);
 
+  if (convert_case)
+    finish_combined_change (count, sub_start, sub_end - sub_start,
+			    newpoint - sub_start);
+
   /* Put point back where it was in the text, if possible.  */
   TEMP_SET_PT (clip_to_bounds (BEGV, opoint + (opoint <= 0 ? ZV : 0), ZV));
   /* Now move point "officially" to the end of the inserted replacement.  */
@@ -3430,18 +4091,9 @@ DEFUN ("re--describe-compiled", Fre__describe_compiled, Sre__describe_compiled,
 }
 
 
-static void syms_of_search_for_pdumper (void);
-
 void
 syms_of_search (void)
 {
-  for (int i = 0; i < REGEXP_CACHE_SIZE; ++i)
-    {
-      staticpro (&searchbufs[i].regexp);
-      staticpro (&searchbufs[i].f_whitespace_regexp);
-      staticpro (&searchbufs[i].syntax_table);
-    }
-
   /* Error condition used for failing searches.  */
   DEFSYM (Qsearch_failed, "search-failed");
 
@@ -3467,6 +4119,14 @@ syms_of_search (void)
   Fput (Qinvalid_regexp, Qerror_message,
 	build_string ("Invalid regexp"));
 
+  /* Error condition signaled when matching takes more steps than
+     'regexp-match-step-limit' allows.  */
+  DEFSYM (Qregexp_budget_exceeded, "regexp-budget-exceeded");
+  Fput (Qregexp_budget_exceeded, Qerror_conditions,
+	list (Qregexp_budget_exceeded, Qerror));
+  Fput (Qregexp_budget_exceeded, Qerror_message,
+	build_string ("Regexp matching exceeded its step limit"));
+
   re_match_object = Qnil;
   staticpro (&re_match_object);
 
@@ -3480,6 +4140,39 @@ syms_of_search (void)
 numbering of existing capture groups in unexpected ways.  */);
   Vsearch_spaces_regexp = Qnil;
 
+  DEFVAR_LISP ("regexp-match-step-limit", Vregexp_match_step_limit,
+      doc: /* Maximum number of steps a single regexp match or search may take.
+If a regexp matching or searching function takes more steps than this,
+it signals a `regexp-budget-exceeded' error instead of going on.  A
+step is roughly one backtrack of the matcher, so this bounds the time
+that a regexp prone to catastrophic backtracking can take.  The count
+starts afresh for every search or match; a search that finds several
+matches, such as `re-search-forward' with a COUNT argument, counts
+the steps for each one separately.
+
+A value of nil means no limit.  Typically, this is let-bound around
+code that has to finish quickly, such as fontification.  */);
+  Vregexp_match_step_limit = Qnil;
+
+  DEFVAR_INT ("regexp-cache-size", regexp_cache_size,
+      doc: /* Number of compiled regexps to keep for reuse by searches.
+Searching and matching functions compile their regexp argument, unless
+they find it in a cache of recently compiled regexps.  When the cache
+is full, they discard the least recently used entry.  Increase this if
+more than this many regexps are in use at the same time, as shown by
+`regexp-cache-misses' growing much faster than `regexp-cache-hits'.  */);
+  regexp_cache_size = 64;
+
+  DEFVAR_INT ("regexp-cache-hits", regexp_cache_hits,
+      doc: /* Number of times a search found its regexp in the cache.
+See `regexp-cache-size'.  */);
+  regexp_cache_hits = 0;
+
+  DEFVAR_INT ("regexp-cache-misses", regexp_cache_misses,
+      doc: /* Number of times a search had to compile its regexp.
+See `regexp-cache-size'.  */);
+  regexp_cache_misses = 0;
+
   DEFSYM (Qinhibit_changing_match_data, "inhibit-changing-match-data");
   DEFVAR_LISP ("inhibit-changing-match-data", Vinhibit_changing_match_data,
       doc: /* Internal use only.
@@ -3498,6 +4191,7 @@ syms_of_search (void)
   defsubr (&Sre_search_forward);
   defsubr (&Sre_search_backward);
   defsubr (&Sposix_search_forward);
+  defsubr (&Sre_search_matches);
   defsubr (&Sposix_search_backward);
   defsubr (&Sreplace_match);
   defsubr (&Smatch_beginning);
@@ -3508,23 +4202,4 @@ syms_of_search (void)
   defsubr (&Sregexp_quote);
   defsubr (&Snewline_cache_check);
   defsubr (&Sre__describe_compiled);
-
-  pdumper_do_now_and_after_load (syms_of_search_for_pdumper);
-}
-
-static void
-syms_of_search_for_pdumper (void)
-{
-  for (int i = 0; i < REGEXP_CACHE_SIZE; ++i)
-    {
-      searchbufs[i].buf.allocated = 100;
-      searchbufs[i].buf.buffer = xmalloc (100);
-      searchbufs[i].buf.fastmap = searchbufs[i].fastmap;
-      searchbufs[i].regexp = Qnil;
-      searchbufs[i].f_whitespace_regexp = Qnil;
-      searchbufs[i].busy = false;
-      searchbufs[i].syntax_table = Qnil;
-      searchbufs[i].next = (i == REGEXP_CACHE_SIZE-1 ? 0 : &searchbufs[i+1]);
-    }
-  searchbuf_head = &searchbufs[0];
 }
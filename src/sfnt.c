@@ -42,6 +42,12 @@ Copyright (C) 2023-2025 Free Software Foundation, Inc.
 #include <sys/mman.h>
 #endif
 
+#ifdef __aarch64__
+#include <arm_neon.h>
+#elif defined __SSE2__
+#include <emmintrin.h>
+#endif
+
 #if defined __GNUC__ && !defined __clang__
 #pragma GCC diagnostic ignored "-Wstringop-overflow"
 #endif
@@ -4472,6 +4478,36 @@ sfnt_saturate_short (unsigned short x)
   return x;
 }
 
+/* Add the coverage W to each of the N pixels starting at START,
+   saturating at 255.  This is where most of the time spent filling
+   large glyphs goes, so process 16 pixels at a time where vector
+   instructions are available.  */
+
+static void
+sfnt_fill_span_center (unsigned char *start, int n, unsigned char w)
+{
+#ifdef __aarch64__
+  uint8x16_t coverage;
+
+  coverage = vdupq_n_u8 (w);
+
+  for (; n >= 16; n -= 16, start += 16)
+    vst1q_u8 (start, vqaddq_u8 (vld1q_u8 (start), coverage));
+#elif defined __SSE2__
+  __m128i coverage;
+
+  coverage = _mm_set1_epi8 ((char) w);
+
+  for (; n >= 16; n -= 16, start += 16)
+    _mm_storeu_si128 ((__m128i *) start,
+		      _mm_adds_epu8 (_mm_loadu_si128 ((__m128i *) start),
+				     coverage));
+#endif /* __aarch64__ || __SSE2__ */
+
+  for (; n > 0; n--, start++)
+    *start = sfnt_saturate_short (*start + w);
+}
+
 /* Fill a single span of pixels between X0 and X1 at Y, a raster
    coordinate, onto RASTER.  */
 
@@ -4483,7 +4519,7 @@ sfnt_fill_span (struct sfnt_raster *raster, sfnt_fixed y,
   const unsigned char *coverage;
   sfnt_fixed left, right, end;
   unsigned short w, a;
-  int row;
+  int row, n;
 #ifndef NDEBUG
   unsigned char *row_end;
 #endif /* NDEBUG */
@@ -4568,14 +4604,17 @@ sfnt_fill_span (struct sfnt_raster *raster, sfnt_fixed y,
   w = coverage[SFNT_POLY_SAMPLE];
 
   /* Fill pixels between left and right.  */
-  while (left + SFNT_POLY_MASK < right)
+  n = (right - left) / SFNT_POLY_SAMPLE;
+
+  if (n > 0)
     {
-      /* Assert that start does not exceed the end of the row.  */
-      assert (start <= row_end);
+      /* Assert that the pixels filled do not exceed the end of the
+	 row.  */
+      assert (start + n - 1 <= row_end);
 
-      a = *start + w;
-      *start++ = sfnt_saturate_short (a);
-      left += SFNT_POLY_SAMPLE;
+      sfnt_fill_span_center (start, n, w);
+      start += n;
+      left += n * SFNT_POLY_SAMPLE;
     }
 
   /* Fill rightmost pixel with any partial coverage.  */
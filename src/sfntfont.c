@@ -2070,6 +2070,7 @@ sfntfont_match (struct frame *f, Lisp_Object font_spec)
   {
     SFNT_OUTLINE_CACHE_SIZE = 256,
     SFNT_RASTER_CACHE_SIZE  = 128,
+    SFNT_CACHE_INDEX_SIZE   = 256,
   };
 
 /* Caching subsystem.  Generating outlines from glyphs is expensive,
@@ -2077,7 +2078,14 @@ sfntfont_match (struct frame *f, Lisp_Object font_spec)
    glyph outlines and rasters.
 
    Computing metrics also requires some expensive processing if the
-   glyph has instructions or distortions.  */
+   glyph has instructions or distortions.
+
+   Each cache is a ring ordered by recent use, so that the least
+   recently used glyph is evicted first.  Searching the ring linearly
+   for every glyph drawn is costly in itself, so each cache also has
+   an index of SFNT_CACHE_INDEX_SIZE entries, mapping a glyph code
+   modulo that size to the entry last found or created for it.  The
+   ring is only searched when the index holds another glyph.  */
 
 struct sfnt_outline_cache
 {
@@ -2214,12 +2222,13 @@ sfntfont_dereference_outline (struct sfnt_glyph_outline *outline)
    variation and instructing.
 
    Return the outline with an incremented reference count and enter
-   the generated outline into CACHE upon success, possibly discarding
-   any older outlines, or NULL on failure.  */
+   the generated outline into CACHE and its CACHE_INDEX upon success,
+   possibly discarding any older outlines, or NULL on failure.  */
 
 static struct sfnt_glyph_outline *
 sfntfont_get_glyph_outline (sfnt_glyph glyph_code,
 			    struct sfnt_outline_cache *cache,
+			    struct sfnt_outline_cache **cache_index,
 			    sfnt_fixed scale, int *cache_size,
 			    struct sfnt_blend *blend,
 			    int index,
@@ -2244,31 +2253,35 @@ sfntfont_get_glyph_outline (sfnt_glyph glyph_code,
   struct sfnt_metrics_distortion distortion;
   sfnt_fixed advance;
 
-  start = cache->next;
   distortion.advance = 0;
 
   /* See if the outline is already cached.  */
-  for (; start != cache; start = start->next)
-    {
+  start = cache_index[glyph_code % SFNT_CACHE_INDEX_SIZE];
+
+  if (!start || start->glyph != glyph_code)
+    for (start = cache->next; start != cache; start = start->next)
       if (start->glyph == glyph_code)
-	{
-	  /* Move start to the start of the ring.  Then increase
-	     start->outline->refcount and return it.  */
+	break;
 
-	  start->last->next = start->next;
-	  start->next->last = start->last;
+  if (start && start != cache)
+    {
+      /* Move start to the start of the ring.  Then increase
+	 start->outline->refcount and return it.  */
 
-	  start->next = cache->next;
-	  start->last = cache;
-	  start->next->last = start;
-	  start->last->next = start;
-	  start->outline->refcount++;
+      start->last->next = start->next;
+      start->next->last = start->last;
 
-	  if (metrics)
-	    *metrics = start->metrics;
+      start->next = cache->next;
+      start->last = cache;
+      start->next->last = start;
+      start->last->next = start;
+      start->outline->refcount++;
+      cache_index[glyph_code % SFNT_CACHE_INDEX_SIZE] = start;
 
-	  return start->outline;
-	}
+      if (metrics)
+	*metrics = start->metrics;
+
+      return start->outline;
     }
 
   /* Not already cached.  Get the glyph.  */
@@ -2406,6 +2419,7 @@ sfntfont_get_glyph_outline (sfnt_glyph glyph_code,
   start->last = cache;
   start->next->last = start;
   start->last->next = start;
+  cache_index[glyph_code % SFNT_CACHE_INDEX_SIZE] = start;
 
   /* Update the cache size.  */
   (*cache_size)++;
@@ -2420,6 +2434,8 @@ sfntfont_get_glyph_outline (sfnt_glyph glyph_code,
       /* Free the least recently used entry in the cache.  */
       start->last->next = start->next;
       start->next->last = start->last;
+      if (cache_index[start->glyph % SFNT_CACHE_INDEX_SIZE] == start)
+	cache_index[start->glyph % SFNT_CACHE_INDEX_SIZE] = NULL;
       sfntfont_dereference_outline (start->outline);
       xfree (start);
 
@@ -2473,13 +2489,14 @@ sfntfont_dereference_raster (struct sfnt_raster *raster)
   xfree (raster);
 }
 
-/* Get the raster corresponding to the specified GLYPH_CODE in CACHE.
-   Use the outline named OUTLINE.  Keep *CACHE_SIZE updated with the
-   number of elements in the cache.  */
+/* Get the raster corresponding to the specified GLYPH_CODE in CACHE,
+   whose index is CACHE_INDEX.  Use the outline named OUTLINE.  Keep
+   *CACHE_SIZE updated with the number of elements in the cache.  */
 
 static struct sfnt_raster *
 sfntfont_get_glyph_raster (sfnt_glyph glyph_code,
 			   struct sfnt_raster_cache *cache,
+			   struct sfnt_raster_cache **cache_index,
 			   struct sfnt_glyph_outline *outline,
 			   int *cache_size)
 {
@@ -2487,26 +2504,29 @@ sfntfont_get_glyph_raster (sfnt_glyph glyph_code,
   struct sfnt_raster *raster;
 
   /* See if the raster is already cached.  */
-  start = cache->next;
+  start = cache_index[glyph_code % SFNT_CACHE_INDEX_SIZE];
 
-  for (; start != cache; start = start->next)
-    {
+  if (!start || start->glyph != glyph_code)
+    for (start = cache->next; start != cache; start = start->next)
       if (start->glyph == glyph_code)
-	{
-	  /* Move start to the start of the ring.  Them, increase
-	     start->raster->refcount and return it.  */
+	break;
 
-	  start->last->next = start->next;
-	  start->next->last = start->last;
+  if (start && start != cache)
+    {
+      /* Move start to the start of the ring.  Them, increase
+	 start->raster->refcount and return it.  */
 
-	  start->next = cache->next;
-	  start->last = cache;
-	  start->next->last = start;
-	  start->last->next = start;
-	  start->raster->refcount++;
+      start->last->next = start->next;
+      start->next->last = start->last;
 
-	  return start->raster;
-	}
+      start->next = cache->next;
+      start->last = cache;
+      start->next->last = start;
+      start->last->next = start;
+      start->raster->refcount++;
+      cache_index[glyph_code % SFNT_CACHE_INDEX_SIZE] = start;
+
+      return start->raster;
     }
 
   /* Not already cached.  Raster the outline.  */
@@ -2532,6 +2552,7 @@ sfntfont_get_glyph_raster (sfnt_glyph glyph_code,
   start->last = cache;
   start->next->last = start;
   start->last->next = start;
+  cache_index[glyph_code % SFNT_CACHE_INDEX_SIZE] = start;
 
   /* Update the cache size.  */
   (*cache_size)++;
@@ -2546,6 +2567,8 @@ sfntfont_get_glyph_raster (sfnt_glyph glyph_code,
       /* Free the least recently used entry in the cache.  */
       start->last->next = start->next;
       start->next->last = start->last;
+      if (cache_index[start->glyph % SFNT_CACHE_INDEX_SIZE] == start)
+	cache_index[start->glyph % SFNT_CACHE_INDEX_SIZE] = NULL;
       sfntfont_dereference_raster (start->raster);
       xfree (start);
 
@@ -2624,12 +2647,18 @@ sfntfont_free_raster_cache (struct sfnt_raster_cache *cache)
   /* Outline cache.  */
   struct sfnt_outline_cache outline_cache;
 
+  /* Index into the outline cache.  */
+  struct sfnt_outline_cache *outline_index[SFNT_CACHE_INDEX_SIZE];
+
   /* Number of elements in the outline cache.  */
   int outline_cache_size;
 
   /* Raster cache.  */
   struct sfnt_raster_cache raster_cache;
 
+  /* Index into the raster cache.  */
+  struct sfnt_raster_cache *raster_index[SFNT_CACHE_INDEX_SIZE];
+
   /* Number of elements in the raster cache.  */
   int raster_cache_size;
 
@@ -3244,9 +3273,11 @@ sfntfont_open (struct frame *f, Lisp_Object font_entity,
   font_info->outline_cache.next = &font_info->outline_cache;
   font_info->outline_cache.last = &font_info->outline_cache;
   font_info->outline_cache_size = 0;
+  memset (font_info->outline_index, 0, sizeof font_info->outline_index);
   font_info->raster_cache.next = &font_info->raster_cache;
   font_info->raster_cache.last = &font_info->raster_cache;
   font_info->raster_cache_size = 0;
+  memset (font_info->raster_index, 0, sizeof font_info->raster_index);
   font_info->interpreter = NULL;
   font_info->scale = 0;
   font_info->instance = -1;
@@ -3533,6 +3564,7 @@ sfntfont_measure_pcm (struct sfnt_font_info *font, sfnt_glyph glyph,
   /* Now get the glyph outline, which is required to obtain the rsb,
      ascent and descent.  */
   outline = sfntfont_get_glyph_outline (glyph, &font->outline_cache,
+					font->outline_index,
 					font->scale,
 					&font->outline_cache_size,
 					&font->blend,
@@ -3679,7 +3711,9 @@ sfntfont_close (struct font *font)
 #endif
 
   sfntfont_free_outline_cache (&info->outline_cache);
+  memset (info->outline_index, 0, sizeof info->outline_index);
   sfntfont_free_raster_cache (&info->raster_cache);
+  memset (info->raster_index, 0, sizeof info->raster_index);
 }
 
 
@@ -3721,6 +3755,7 @@ sfntfont_draw (struct glyph_string *s, int from, int to,
       /* Look up the outline.  */
       outline = sfntfont_get_glyph_outline (s->char2b[i],
 					    &info->outline_cache,
+					    info->outline_index,
 					    info->scale,
 					    &info->outline_cache_size,
 					    &info->blend,
@@ -3744,6 +3779,7 @@ sfntfont_draw (struct glyph_string *s, int from, int to,
       /* Rasterize the outline.  */
       rasters[i - from] = sfntfont_get_glyph_raster (s->char2b[i],
 						     &info->raster_cache,
+						     info->raster_index,
 						     outline,
 						     &info->raster_cache_size);
       sfntfont_dereference_outline (outline);
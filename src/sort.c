@@ -207,6 +207,58 @@ order_pred_valuelt (merge_state *ms, Lisp_Object a, Lisp_Object b)
   return !NILP (Fvaluelt (a, b));
 }
 
+/* Specialized versions of the above, used when all keys are of the
+   same type and the predicate is known to compare them the same way.
+   They call no Lisp, so they neither signal nor trigger GC.  */
+
+static bool
+order_pred_fixnum (merge_state *ms, Lisp_Object a, Lisp_Object b)
+{
+  return XFIXNUM (a) < XFIXNUM (b);
+}
+
+static bool
+order_pred_float (merge_state *ms, Lisp_Object a, Lisp_Object b)
+{
+  return XFLOAT_DATA (a) < XFLOAT_DATA (b);
+}
+
+static bool
+order_pred_string (merge_state *ms, Lisp_Object a, Lisp_Object b)
+{
+  return string_cmp (a, b) < 0;
+}
+
+/* Use a specialized ordering predicate in MS if all its N keys are
+   fixnums, floats or strings and its predicate orders them as usual.  */
+static void
+specialize_order_pred (merge_state *ms, const Lisp_Object *keys,
+		       ptrdiff_t n)
+{
+  Lisp_Object pred = ms->predicate;
+  bool numeric = (NILP (pred)
+		  || (SUBRP (pred) && XSUBR (pred)->max_args == MANY
+		      && XSUBR (pred)->function.aMANY == Flss));
+  bool stringy = (NILP (pred)
+		  || (SUBRP (pred) && XSUBR (pred)->max_args == 2
+		      && XSUBR (pred)->function.a2 == Fstring_lessp));
+  bool fixnums = numeric, floats = numeric, strings = stringy;
+
+  for (ptrdiff_t i = 0; i < n && (fixnums | floats | strings); i++)
+    {
+      fixnums &= FIXNUMP (keys[i]);
+      floats &= FLOATP (keys[i]);
+      strings &= STRINGP (keys[i]);
+    }
+
+  if (fixnums)
+    ms->pred_fun = order_pred_fixnum;
+  else if (floats)
+    ms->pred_fun = order_pred_float;
+  else if (strings)
+    ms->pred_fun = order_pred_string;
+}
+
 /* Return true iff A < B according to the order predicate.  */
 static inline bool
 inorder (merge_state *ms, Lisp_Object a, Lisp_Object b)
@@ -1129,9 +1181,9 @@ tim_sort (Lisp_Object predicate, Lisp_Object keyfunc,
     for (ptrdiff_t i = 0; i < length; i++)
       keys[i] = calln (keyfunc, seq[i]);
 
-  /* FIXME: This is where we would check the keys for interesting
-     properties for more optimized comparison (such as all being fixnums
-     etc).  */
+  /* Now that the keys are known, see whether they can be compared
+     without calling the predicate.  */
+  specialize_order_pred (&ms, lo.keys, length);
 
   /* March over the array once, left to right, finding natural runs,
      and extending short natural runs to minrun elements.  */
@@ -24,14 +24,29 @@ Copyright (C) 2021-2025 Free Software Foundation, Inc.
 
 #include <config.h>
 
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+
 #include <c-strcase.h>
+#include <flexmember.h>
+#include <ignore-value.h>
+
 #include "lisp.h"
 #include "coding.h"
+#include "process.h"
+#include "systhread.h"
 
 #ifdef HAVE_SQLITE3
 
 #include <sqlite3.h>
 
+/* Whether queries can be run by other threads, see
+   sqlite_start_async_query.  */
+# if defined HAVE_PTHREAD && defined subprocesses && !defined WINDOWSNT
+#  define SQLITE_ASYNC 1
+# endif
+
 /* Support for loading SQLite extensions requires the ability to
    enable and disable loading of extensions (by default this is
    disabled, and we want to keep it that way).  The required macro is
@@ -54,6 +69,7 @@ DEF_DLL_FN (SQLITE_API int, sqlite3_close, (sqlite3*));
 DEF_DLL_FN (SQLITE_API int, sqlite3_open_v2,
 	    (const char*, sqlite3**, int, const char*));
 DEF_DLL_FN (SQLITE_API int, sqlite3_reset, (sqlite3_stmt*));
+DEF_DLL_FN (SQLITE_API int, sqlite3_clear_bindings, (sqlite3_stmt*));
 DEF_DLL_FN (SQLITE_API int, sqlite3_bind_text,
 	    (sqlite3_stmt*, int, const char*, int, void(*)(void*)));
 DEF_DLL_FN (SQLITE_API int, sqlite3_bind_blob,
@@ -71,6 +87,7 @@ DEF_DLL_FN (SQLITE_API const char*, sqlite3_errstr, (int));
 DEF_DLL_FN (SQLITE_API const char*, sqlite3_libversion, (void));
 DEF_DLL_FN (SQLITE_API int, sqlite3_step, (sqlite3_stmt*));
 DEF_DLL_FN (SQLITE_API int, sqlite3_changes, (sqlite3*));
+DEF_DLL_FN (SQLITE_API int, sqlite3_get_autocommit, (sqlite3*));
 DEF_DLL_FN (SQLITE_API int, sqlite3_column_count, (sqlite3_stmt*));
 DEF_DLL_FN (SQLITE_API int, sqlite3_column_type, (sqlite3_stmt*, int));
 DEF_DLL_FN (SQLITE_API sqlite3_int64, sqlite3_column_int64,
@@ -102,6 +119,7 @@ DEF_DLL_FN (SQLITE_API int, sqlite3_db_config, (sqlite3*, int, ...));
 # undef sqlite3_close
 # undef sqlite3_open_v2
 # undef sqlite3_reset
+# undef sqlite3_clear_bindings
 # undef sqlite3_bind_text
 # undef sqlite3_bind_blob
 # undef sqlite3_bind_int64
@@ -116,6 +134,7 @@ DEF_DLL_FN (SQLITE_API int, sqlite3_db_config, (sqlite3*, int, ...));
 # undef sqlite3_libversion
 # undef sqlite3_step
 # undef sqlite3_changes
+# undef sqlite3_get_autocommit
 # undef sqlite3_column_count
 # undef sqlite3_column_type
 # undef sqlite3_column_int64
@@ -131,6 +150,7 @@ DEF_DLL_FN (SQLITE_API int, sqlite3_db_config, (sqlite3*, int, ...));
 # define sqlite3_close fn_sqlite3_close
 # define sqlite3_open_v2 fn_sqlite3_open_v2
 # define sqlite3_reset fn_sqlite3_reset
+# define sqlite3_clear_bindings fn_sqlite3_clear_bindings
 # define sqlite3_bind_text fn_sqlite3_bind_text
 # define sqlite3_bind_blob fn_sqlite3_bind_blob
 # define sqlite3_bind_int64 fn_sqlite3_bind_int64
@@ -145,6 +165,7 @@ DEF_DLL_FN (SQLITE_API int, sqlite3_db_config, (sqlite3*, int, ...));
 # define sqlite3_libversion fn_sqlite3_libversion
 # define sqlite3_step fn_sqlite3_step
 # define sqlite3_changes fn_sqlite3_changes
+# define sqlite3_get_autocommit fn_sqlite3_get_autocommit
 # define sqlite3_column_count fn_sqlite3_column_count
 # define sqlite3_column_type fn_sqlite3_column_type
 # define sqlite3_column_int64 fn_sqlite3_column_int64
@@ -163,6 +184,7 @@ load_dll_functions (HMODULE library)
   LOAD_DLL_FN (library, sqlite3_close);
   LOAD_DLL_FN (library, sqlite3_open_v2);
   LOAD_DLL_FN (library, sqlite3_reset);
+  LOAD_DLL_FN (library, sqlite3_clear_bindings);
   LOAD_DLL_FN (library, sqlite3_bind_text);
   LOAD_DLL_FN (library, sqlite3_bind_blob);
   LOAD_DLL_FN (library, sqlite3_bind_int64);
@@ -177,6 +199,7 @@ load_dll_functions (HMODULE library)
   LOAD_DLL_FN (library, sqlite3_libversion);
   LOAD_DLL_FN (library, sqlite3_step);
   LOAD_DLL_FN (library, sqlite3_changes);
+  LOAD_DLL_FN (library, sqlite3_get_autocommit);
   LOAD_DLL_FN (library, sqlite3_column_count);
   LOAD_DLL_FN (library, sqlite3_column_type);
   LOAD_DLL_FN (library, sqlite3_column_int64);
@@ -224,6 +247,151 @@ init_sqlite_functions (void)
 #endif	/* !WINDOWSNT */
 }
 
+/* The number of prepared statements that are kept for each database,
+   so that executing the same SQL again needn't compile it again.  */
+#define SQLITE_STATEMENT_CACHE_SIZE 16
+
+/* A statement that was prepared from the LEN bytes of SQL text at
+   SQL.  */
+struct sqlite_cached_statement
+{
+  char *sql;
+  ptrdiff_t len;
+  sqlite3_stmt *stmt;
+  /* The value of the cache's clock when the statement was last used,
+     to find the least recently used statement.  */
+  EMACS_UINT last_use;
+  /* Whether the statement is being executed.  It is not used for
+     other calls until it is done.  */
+  bool in_use;
+};
+
+struct sqlite_statement_cache
+{
+  EMACS_UINT clock;
+  /* Entries whose SQL is NULL are unused.  */
+  struct sqlite_cached_statement entries[SQLITE_STATEMENT_CACHE_SIZE];
+};
+
+/* Finalize the statements prepared for DB and free its cache.  */
+static void
+sqlite_free_statements (struct Lisp_Sqlite *db)
+{
+  struct sqlite_statement_cache *cache = db->statements;
+  if (!cache)
+    return;
+  for (int i = 0; i < SQLITE_STATEMENT_CACHE_SIZE; i++)
+    if (cache->entries[i].sql)
+      {
+	sqlite3_finalize (cache->entries[i].stmt);
+	xfree (cache->entries[i].sql);
+      }
+  xfree (cache);
+  db->statements = NULL;
+}
+
+/* Make a statement that was taken from the cache available again.  */
+static void
+sqlite_release_statement (void *arg)
+{
+  struct sqlite_cached_statement *entry = arg;
+  sqlite3_reset (entry->stmt);
+  /* Values are bound without copying them, so they mustn't stay
+     bound once the Lisp strings they came from may be gone.  */
+  sqlite3_clear_bindings (entry->stmt);
+  entry->in_use = false;
+}
+
+static void
+sqlite_finalize_statement (void *stmt)
+{
+  sqlite3_finalize (stmt);
+}
+
+/* Prepare the statement in the encoded string SQL for DB, and store
+   it in *STMT.  Return the status code of the preparation.
+
+   If CACHED, reuse the statement that was prepared for the same SQL,
+   unless it is being executed.  If the preparation succeeds, push an
+   unwind entry that finalizes the statement, or returns it to the
+   cache; the caller must unbind it once it is done with the
+   statement.  */
+static int
+sqlite_prepare (struct Lisp_Sqlite *db, Lisp_Object sql, bool cached,
+		sqlite3_stmt **stmt)
+{
+  struct sqlite_statement_cache *cache = db->statements;
+  struct sqlite_cached_statement *entry = NULL;
+
+  if (cached)
+    {
+      if (!cache)
+	cache = db->statements = xzalloc (sizeof *cache);
+      for (int i = 0; i < SQLITE_STATEMENT_CACHE_SIZE; i++)
+	{
+	  struct sqlite_cached_statement *e = &cache->entries[i];
+	  if (e->in_use)
+	    continue;
+	  if (e->sql && e->len == SBYTES (sql)
+	      && !memcmp (e->sql, SSDATA (sql), e->len))
+	    {
+	      e->in_use = true;
+	      e->last_use = ++cache->clock;
+	      *stmt = e->stmt;
+	      record_unwind_protect_ptr (sqlite_release_statement, e);
+	      return SQLITE_OK;
+	    }
+	  if (!entry || !e->sql
+	      || (entry->sql && e->last_use < entry->last_use))
+	    entry = e;
+	}
+    }
+
+  *stmt = NULL;
+  int ret = sqlite3_prepare_v2 (db->db, SSDATA (sql), SBYTES (sql),
+				stmt, NULL);
+  if (ret != SQLITE_OK)
+    {
+      if (*stmt)
+	sqlite3_finalize (*stmt);
+      *stmt = NULL;
+      return ret;
+    }
+
+  if (!entry || !*stmt)
+    {
+      /* If every entry is in use, or SQL has no statement, don't
+	 cache it.  */
+      record_unwind_protect_ptr (sqlite_finalize_statement, *stmt);
+      return ret;
+    }
+
+  if (entry->sql)
+    {
+      sqlite3_finalize (entry->stmt);
+      xfree (entry->sql);
+    }
+  entry->sql = xmalloc (SBYTES (sql));
+  memcpy (entry->sql, SSDATA (sql), SBYTES (sql));
+  entry->len = SBYTES (sql);
+  entry->stmt = *stmt;
+  entry->in_use = true;
+  entry->last_use = ++cache->clock;
+  record_unwind_protect_ptr (sqlite_release_statement, entry);
+  return ret;
+}
+
+/* Return whether one of DB's statements is being executed.  */
+static bool
+sqlite_statements_in_use (struct Lisp_Sqlite *db)
+{
+  struct sqlite_statement_cache *cache = db->statements;
+  if (cache)
+    for (int i = 0; i < SQLITE_STATEMENT_CACHE_SIZE; i++)
+      if (cache->entries[i].in_use)
+	return true;
+  return false;
+}
 
 static void
 sqlite_free (void *arg)
@@ -232,7 +400,10 @@ sqlite_free (void *arg)
   if (ptr->is_statement)
     sqlite3_finalize (ptr->stmt);
   else if (ptr->db)
-    sqlite3_close (ptr->db);
+    {
+      sqlite_free_statements (ptr);
+      sqlite3_close (ptr->db);
+    }
   xfree (ptr->name);
   xfree (ptr);
 }
@@ -256,6 +427,8 @@ make_sqlite (bool is_statement, void *db, void *stmt, char *name)
   ptr->db = db;
   ptr->name = name;
   ptr->stmt = stmt;
+  ptr->statements = NULL;
+  ptr->worker = NULL;
   ptr->eof = false;
   return make_lisp_ptr (ptr, Lisp_Vectorlike);
 }
@@ -277,6 +450,10 @@ check_sqlite (Lisp_Object db, bool is_statement)
 
 static int db_count = 0;
 
+#ifdef SQLITE_ASYNC
+static void sqlite_stop_worker (Lisp_Object);
+#endif
+
 DEFUN ("sqlite-open", Fsqlite_open, Ssqlite_open, 0, 1, 0,
        doc: /* Open FILE as an sqlite database.
 If FILE is nil, an in-memory database will be opened instead.  */)
@@ -321,16 +498,26 @@ DEFUN ("sqlite-close", Fsqlite_close, Ssqlite_close, 1, 1, 0,
   (Lisp_Object db)
 {
   check_sqlite (db, false);
+  if (sqlite_statements_in_use (XSQLITE (db)))
+    xsignal1 (Qsqlite_error, build_string ("Database is in use"));
+#ifdef SQLITE_ASYNC
+  sqlite_stop_worker (db);
+#endif
+  /* The database can't be closed while it has statements.  */
+  sqlite_free_statements (XSQLITE (db));
   sqlite3_close (XSQLITE (db)->db);
   XSQLITE (db)->db = NULL;
   return Qt;
 }
 
 /* Bind values in a statement like
-   "insert into foo values (?, ?, ?)".  */
+   "insert into foo values (?, ?, ?)".  If COPY, SQLite makes copies of
+   the strings, so that they may be gone before the statement is
+   executed.  */
 static const char *
-bind_values (sqlite3 *db, sqlite3_stmt *stmt, Lisp_Object values)
+bind_values (sqlite3 *db, sqlite3_stmt *stmt, Lisp_Object values, bool copy)
 {
+  sqlite3_destructor_type destructor = copy ? SQLITE_TRANSIENT : NULL;
   sqlite3_reset (stmt);
   int len;
   if (VECTORP (values))
@@ -376,12 +563,12 @@ bind_values (sqlite3 *db, sqlite3_stmt *stmt, Lisp_Object values)
 		xsignal1 (Qsqlite_error, build_string ("BLOB values must be unibyte"));
 	    ret = sqlite3_bind_blob (stmt, i + 1,
 				       SSDATA (value), SBYTES (value),
-				       NULL);
+				       destructor);
 	    }
 	    else
 	      ret = sqlite3_bind_text (stmt, i + 1,
 				       SSDATA (encoded), SBYTES (encoded),
-				       NULL);
+				       destructor);
 	}
       else if (FIXNUMP (value))
 	ret = sqlite3_bind_int64 (stmt, i + 1, XFIXNUM (value));
@@ -405,6 +592,25 @@ bind_values (sqlite3 *db, sqlite3_stmt *stmt, Lisp_Object values)
   return NULL;
 }
 
+/* Return the text column value at TEXT, which is LEN bytes long, as
+   a Lisp string.  */
+static Lisp_Object
+text_to_value (const char *text, ptrdiff_t len)
+{
+  /* Decoding is slow, but ASCII text without carriage returns (which
+     could make the decoder convert end-of-line sequences) would come
+     out unchanged.  */
+  ptrdiff_t i;
+  for (i = 0; i < len; i++)
+    if (!ASCII_CHAR_P ((unsigned char) text[i]) || text[i] == '\r')
+      break;
+  if (i == len)
+    return make_multibyte_string (text, len, len);
+
+  return code_convert_string_norecord (make_unibyte_string (text, len),
+				       Qutf_8, false);
+}
+
 static Lisp_Object
 row_to_value (sqlite3_stmt *stmt)
 {
@@ -435,11 +641,8 @@ row_to_value (sqlite3_stmt *stmt)
 	  break;
 
 	case SQLITE_TEXT:
-	  v =
-	    code_convert_string_norecord
-	    (make_unibyte_string ((const char *)sqlite3_column_text (stmt, i),
-				  sqlite3_column_bytes (stmt, i)),
-	     Qutf_8, false);
+	  v = text_to_value ((const char *) sqlite3_column_text (stmt, i),
+			     sqlite3_column_bytes (stmt, i));
 	  break;
 	}
 
@@ -494,19 +697,14 @@ DEFUN ("sqlite-execute", Fsqlite_execute, Ssqlite_execute, 2, 3, 0,
   Lisp_Object errmsg = Qnil,
     encoded = encode_string (query);
   sqlite3_stmt *stmt = NULL;
+  specpdl_ref count = SPECPDL_INDEX ();
 
   /* We only execute the first statement -- if there's several
      (separated by a semicolon), the subsequent statements won't be
      done.  */
-  int ret = sqlite3_prepare_v2 (sdb, SSDATA (encoded), -1, &stmt, NULL);
+  int ret = sqlite_prepare (XSQLITE (db), encoded, true, &stmt);
   if (ret != SQLITE_OK)
     {
-      if (stmt != NULL)
-	{
-	  sqlite3_finalize (stmt);
-	  sqlite3_reset (stmt);
-	}
-
       errmsg = sqlite_prepare_errdata (ret, sdb);
       goto exit;
     }
@@ -514,7 +712,7 @@ DEFUN ("sqlite-execute", Fsqlite_execute, Ssqlite_execute, 2, 3, 0,
   /* Bind ? values.  */
   if (!NILP (values))
     {
-      const char *err = bind_values (sdb, stmt, values);
+      const char *err = bind_values (sdb, stmt, values, false);
       if (err != NULL)
 	{
 	  errmsg = build_string (err);
@@ -531,25 +729,124 @@ DEFUN ("sqlite-execute", Fsqlite_execute, Ssqlite_execute, 2, 3, 0,
 	data = Fcons (row_to_value (stmt), data);
       while (sqlite3_step (stmt) == SQLITE_ROW);
 
-      sqlite3_finalize (stmt);
-      return Fnreverse (data);
+      return unbind_to (count, Fnreverse (data));
     }
   else if (ret == SQLITE_OK || ret == SQLITE_DONE)
-    {
-      Lisp_Object rows = make_fixnum (sqlite3_changes (sdb));
-      sqlite3_finalize (stmt);
-      return rows;
-    }
+    return unbind_to (count, make_fixnum (sqlite3_changes (sdb)));
   else
     errmsg = build_string (sqlite3_errmsg (sdb));
 
  exit:
-  sqlite3_finalize (stmt);
   xsignal1 (ret == SQLITE_LOCKED || ret == SQLITE_BUSY?
 	    Qsqlite_locked_error: Qsqlite_error,
 	    errmsg);
 }
 
+static void
+sqlite_rollback_unwind (void *sdb)
+{
+  sqlite3_exec (sdb, "rollback", NULL, NULL, NULL);
+}
+
+/* Execute STMT with the values in ROW bound, for sqlite-execute-many.
+   Return the number of affected rows.  */
+static int
+execute_row (sqlite3 *sdb, sqlite3_stmt *stmt, Lisp_Object row)
+{
+  if (!(NILP (row) || CONSP (row) || VECTORP (row)))
+    xsignal1 (Qsqlite_error, build_string ("Rows must be lists or vectors"));
+
+  /* Don't leave the values of the previous row bound if this one has
+     fewer.  */
+  sqlite3_clear_bindings (stmt);
+  const char *err = bind_values (sdb, stmt, row, false);
+  if (err != NULL)
+    xsignal1 (Qsqlite_error, build_string (err));
+
+  int ret;
+  do
+    ret = sqlite3_step (stmt);
+  while (ret == SQLITE_ROW);
+  if (ret != SQLITE_OK && ret != SQLITE_DONE)
+    xsignal1 (ret == SQLITE_LOCKED || ret == SQLITE_BUSY?
+	      Qsqlite_locked_error: Qsqlite_error,
+	      build_string (sqlite3_errmsg (sdb)));
+  return sqlite3_changes (sdb);
+}
+
+DEFUN ("sqlite-execute-many", Fsqlite_execute_many, Ssqlite_execute_many,
+       3, 3, 0,
+       doc: /* Execute a non-select SQL statement once for each of ROWS.
+ROWS should be a vector or a list whose elements are vectors or lists
+of values to bind when executing QUERY, like the VALUES argument of
+`sqlite-execute'.  Rows returned by QUERY are ignored.
+
+Unless a transaction is already in progress in DB, QUERY is executed
+for all of ROWS in a transaction of its own, which is rolled back if
+an error is signaled.
+
+Value is the total number of affected rows.  */)
+  (Lisp_Object db, Lisp_Object query, Lisp_Object rows)
+{
+  check_sqlite (db, false);
+  CHECK_STRING (query);
+  if (!(NILP (rows) || CONSP (rows) || VECTORP (rows)))
+    xsignal1 (Qsqlite_error, build_string ("ROWS must be a list or a vector"));
+
+  sqlite3 *sdb = XSQLITE (db)->db;
+  Lisp_Object encoded = encode_string (query);
+  specpdl_ref count = SPECPDL_INDEX ();
+
+  /* Start the transaction before preparing the statement, so that the
+     statement is reset before the transaction is rolled back.  */
+  bool own_transaction = sqlite3_get_autocommit (sdb);
+  int ret;
+  if (own_transaction)
+    {
+      ret = sqlite3_exec (sdb, "begin", NULL, NULL, NULL);
+      if (ret != SQLITE_OK)
+	xsignal1 (ret == SQLITE_LOCKED || ret == SQLITE_BUSY?
+		  Qsqlite_locked_error: Qsqlite_error,
+		  build_string (sqlite3_errmsg (sdb)));
+      record_unwind_protect_ptr (sqlite_rollback_unwind, sdb);
+    }
+
+  specpdl_ref stmt_count = SPECPDL_INDEX ();
+  sqlite3_stmt *stmt = NULL;
+  ret = sqlite_prepare (XSQLITE (db), encoded, true, &stmt);
+  if (ret != SQLITE_OK)
+    xsignal1 (Qsqlite_error, sqlite_prepare_errdata (ret, sdb));
+
+  intmax_t changes = 0;
+  if (VECTORP (rows))
+    for (ptrdiff_t i = 0; i < ASIZE (rows); i++)
+      {
+	changes += execute_row (sdb, stmt, AREF (rows, i));
+	maybe_quit ();
+      }
+  else
+    {
+      Lisp_Object tail = rows;
+      FOR_EACH_TAIL (tail)
+	changes += execute_row (sdb, stmt, XCAR (tail));
+      CHECK_LIST_END (tail, rows);
+    }
+
+  /* Let the statement go before committing.  */
+  unbind_to (stmt_count, Qnil);
+  if (own_transaction)
+    {
+      ret = sqlite3_exec (sdb, "commit", NULL, NULL, NULL);
+      if (ret != SQLITE_OK)
+	xsignal1 (ret == SQLITE_LOCKED || ret == SQLITE_BUSY?
+		  Qsqlite_locked_error: Qsqlite_error,
+		  build_string (sqlite3_errmsg (sdb)));
+      clear_unwind_protect (count);
+    }
+
+  return unbind_to (count, make_int (changes));
+}
+
 static Lisp_Object
 column_names (sqlite3_stmt *stmt)
 {
@@ -587,14 +884,14 @@ DEFUN ("sqlite-select", Fsqlite_select, Ssqlite_select, 2, 4, 0,
   sqlite3 *sdb = XSQLITE (db)->db;
   Lisp_Object retval = Qnil, errmsg = Qnil,
     encoded = encode_string (query);
+  bool set = EQ (return_type, Qset);
+  specpdl_ref count = SPECPDL_INDEX ();
 
+  /* A set owns its statement, so it can't come from the cache.  */
   sqlite3_stmt *stmt = NULL;
-  int ret = sqlite3_prepare_v2 (sdb, SSDATA (encoded), SBYTES (encoded),
-				&stmt, NULL);
+  int ret = sqlite_prepare (XSQLITE (db), encoded, !set, &stmt);
   if (ret != SQLITE_OK)
     {
-      if (stmt)
-	sqlite3_finalize (stmt);
       errmsg = sqlite_prepare_errdata (ret, sdb);
       goto exit;
     }
@@ -602,19 +899,19 @@ DEFUN ("sqlite-select", Fsqlite_select, Ssqlite_select, 2, 4, 0,
   /* Query with parameters.  */
   if (!NILP (values))
     {
-      const char *err = bind_values (sdb, stmt, values);
+      const char *err = bind_values (sdb, stmt, values, false);
       if (err != NULL)
 	{
-	  sqlite3_finalize (stmt);
 	  errmsg = build_string (err);
 	  goto exit;
 	}
     }
 
   /* Return a handle to get the data.  */
-  if (EQ (return_type, Qset))
+  if (set)
     {
       retval = make_sqlite (true, sdb, stmt, XSQLITE (db)->name);
+      clear_unwind_protect (count);
       goto exit;
     }
 
@@ -627,13 +924,638 @@ DEFUN ("sqlite-select", Fsqlite_select, Ssqlite_select, 2, 4, 0,
     retval = Fcons (column_names (stmt), Fnreverse (data));
   else
     retval = Fnreverse (data);
-  sqlite3_finalize (stmt);
 
  exit:
   if (! NILP (errmsg))
     xsignal1 (Qsqlite_error, errmsg);
 
-  return retval;
+  return unbind_to (count, retval);
+}
+
+#ifdef SQLITE_ASYNC
+
+/* Asynchronous queries.  Each database that is queried
+   asynchronously gets a thread of its own, which executes the queries
+   in turn, and copies the rows they select into plain C data in
+   batches.  Whenever a batch is ready, the thread writes to a pipe,
+   which wakes up wait_reading_process_output in the main thread; that
+   makes Lisp values of the rows and calls the query's callback.  The
+   database is opened with SQLITE_OPEN_FULLMUTEX, so the main thread
+   can use it meanwhile.  */
+
+/* The number of rows in a batch, and the number of batches a thread
+   makes before it waits for the main thread to take them.  */
+#define SQLITE_ASYNC_BATCH_ROWS 256
+#define SQLITE_ASYNC_MAX_BATCHES 4
+
+/* The value of a column, as copied by the thread.  */
+struct sqlite_async_value
+{
+  int type;
+  union
+  {
+    sqlite3_int64 i;
+    double d;
+    struct
+    {
+      char *data;
+      int len;
+    } s;
+  } u;
+};
+
+struct sqlite_async_batch
+{
+  int ncols, nrows;
+  struct sqlite_async_batch *next;
+  /* NROWS times NCOLS values.  */
+  struct sqlite_async_value values[FLEXIBLE_ARRAY_MEMBER];
+};
+
+struct sqlite_async_query
+{
+  sqlite3_stmt *stmt;
+  /* The remaining members are protected by the mutex of the thread.
+     The thread has taken the query if STARTED, and won't touch it
+     again once DONE.  */
+  bool started, done;
+  struct sqlite_async_batch *batches, **last_batch;
+  int nbatches;
+  /* The final status code of the query, the error message if it
+     failed, and the number of rows it changed.  */
+  int status;
+  char *errmsg;
+  int changes;
+  struct sqlite_async_query *next;
+};
+
+struct sqlite_worker
+{
+  sqlite3 *db;
+  sys_mutex_t mutex;
+  /* Signaled when there is a new query, when the main thread has
+     taken a query's batches, and when the thread should quit or has
+     quit.  */
+  sys_cond_t cond;
+  /* The queries, oldest first.  */
+  struct sqlite_async_query *queries;
+  bool quit, exited;
+};
+
+/* The queries whose callbacks are still to be called, as a list of
+   vectors [DB CALLBACK QUERY SELECT ROWS], where QUERY points to the
+   struct sqlite_async_query, SELECT says whether the query comes from
+   sqlite-select-async, and ROWS are the rows of a query from
+   sqlite-execute-async collected so far, in reverse order.  */
+static Lisp_Object sqlite_async_queries;
+
+/* The pipe that the threads write to when they have something for
+   the main thread.  */
+static int sqlite_async_pipe[2] = { -1, -1 };
+
+static void
+sqlite_async_notify (void)
+{
+  /* If this fails, the pipe is full and the main thread will be woken
+     up anyway.  */
+  char dummy = 0;
+  ignore_value (write (sqlite_async_pipe[1], &dummy, 1));
+}
+
+static void
+sqlite_free_batches (struct sqlite_async_batch *batch)
+{
+  while (batch)
+    {
+      struct sqlite_async_batch *next = batch->next;
+      for (int i = 0; i < batch->nrows * batch->ncols; i++)
+	if (batch->values[i].type == SQLITE_TEXT
+	    || batch->values[i].type == SQLITE_BLOB)
+	  free (batch->values[i].u.s.data);
+      free (batch);
+      batch = next;
+    }
+}
+
+/* Copy the current row of STMT into BATCH.  Return false if memory is
+   exhausted.  */
+static bool
+sqlite_copy_row (struct sqlite_async_batch *batch, sqlite3_stmt *stmt)
+{
+  struct sqlite_async_value *v = &batch->values[batch->nrows * batch->ncols];
+  for (int i = 0; i < batch->ncols; i++, v++)
+    {
+      v->type = sqlite3_column_type (stmt, i);
+      switch (v->type)
+	{
+	case SQLITE_INTEGER:
+	  v->u.i = sqlite3_column_int64 (stmt, i);
+	  break;
+
+	case SQLITE_FLOAT:
+	  v->u.d = sqlite3_column_double (stmt, i);
+	  break;
+
+	case SQLITE_TEXT:
+	case SQLITE_BLOB:
+	  {
+	    const void *data = (v->type == SQLITE_TEXT
+				? (const void *) sqlite3_column_text (stmt, i)
+				: sqlite3_column_blob (stmt, i));
+	    int len = sqlite3_column_bytes (stmt, i);
+	    v->u.s.data = malloc (len ? len : 1);
+	    if (!v->u.s.data)
+	      {
+		/* Let sqlite_free_batches skip the columns that were
+		   not copied.  */
+		for (; i < batch->ncols; i++, v++)
+		  v->type = SQLITE_NULL;
+		batch->nrows++;
+		return false;
+	      }
+	    memcpy (v->u.s.data, data, len);
+	    v->u.s.len = len;
+	  }
+	  break;
+
+	default:
+	  v->type = SQLITE_NULL;
+	  break;
+	}
+    }
+  batch->nrows++;
+  return true;
+}
+
+/* Give BATCH of query Q to the main thread, once it has taken enough
+   of the earlier batches.  Return false if the thread should quit
+   instead.  */
+static bool
+sqlite_deliver_batch (struct sqlite_worker *w, struct sqlite_async_query *q,
+		      struct sqlite_async_batch *batch)
+{
+  sys_mutex_lock (&w->mutex);
+  while (q->nbatches >= SQLITE_ASYNC_MAX_BATCHES && !w->quit)
+    sys_cond_wait (&w->cond, &w->mutex);
+  bool quit = w->quit;
+  if (!quit)
+    {
+      *q->last_batch = batch;
+      q->last_batch = &batch->next;
+      q->nbatches++;
+    }
+  sys_mutex_unlock (&w->mutex);
+  if (quit)
+    sqlite_free_batches (batch);
+  else
+    sqlite_async_notify ();
+  return !quit;
+}
+
+static void
+sqlite_run_query (struct sqlite_worker *w, struct sqlite_async_query *q)
+{
+  int ncols = sqlite3_column_count (q->stmt);
+  struct sqlite_async_batch *batch = NULL;
+  int ret;
+  while ((ret = sqlite3_step (q->stmt)) == SQLITE_ROW)
+    {
+      if (!batch)
+	{
+	  batch = malloc (FLEXSIZEOF (struct sqlite_async_batch, values,
+				      (SQLITE_ASYNC_BATCH_ROWS * ncols
+				       * sizeof *batch->values)));
+	  if (!batch)
+	    {
+	      ret = SQLITE_NOMEM;
+	      break;
+	    }
+	  batch->ncols = ncols;
+	  batch->nrows = 0;
+	  batch->next = NULL;
+	}
+      if (!sqlite_copy_row (batch, q->stmt))
+	{
+	  ret = SQLITE_NOMEM;
+	  break;
+	}
+      if (batch->nrows == SQLITE_ASYNC_BATCH_ROWS)
+	{
+	  struct sqlite_async_batch *full = batch;
+	  batch = NULL;
+	  if (!sqlite_deliver_batch (w, q, full))
+	    {
+	      ret = SQLITE_INTERRUPT;
+	      break;
+	    }
+	}
+    }
+
+  /* This races with the main thread using the database, so the
+     message or count might belong to another statement; it is the
+     best we can do.  */
+  char *errmsg = NULL;
+  if (ret != SQLITE_DONE && ret != SQLITE_OK)
+    {
+      const char *msg = (ret == SQLITE_NOMEM ? "out of memory"
+			 : sqlite3_errmsg (w->db));
+      errmsg = malloc (strlen (msg) + 1);
+      if (errmsg)
+	strcpy (errmsg, msg);
+    }
+  int changes = sqlite3_changes (w->db);
+  sqlite3_reset (q->stmt);
+
+  sys_mutex_lock (&w->mutex);
+  if (batch && batch->nrows)
+    {
+      *q->last_batch = batch;
+      q->last_batch = &batch->next;
+      q->nbatches++;
+      batch = NULL;
+    }
+  q->status = ret;
+  q->errmsg = errmsg;
+  q->changes = changes;
+  q->done = true;
+  sys_mutex_unlock (&w->mutex);
+  free (batch);
+  sqlite_async_notify ();
+}
+
+static void *
+sqlite_worker_thread (void *arg)
+{
+  struct sqlite_worker *w = arg;
+
+  /* Leave signal handling to the main thread.  */
+  sigset_t blocked;
+  sigfillset (&blocked);
+  pthread_sigmask (SIG_BLOCK, &blocked, NULL);
+  sys_thread_set_name ("sqlite worker");
+
+  sys_mutex_lock (&w->mutex);
+  while (!w->quit)
+    {
+      struct sqlite_async_query *q = w->queries;
+      while (q && q->started)
+	q = q->next;
+      if (!q)
+	{
+	  sys_cond_wait (&w->cond, &w->mutex);
+	  continue;
+	}
+      q->started = true;
+      sys_mutex_unlock (&w->mutex);
+      sqlite_run_query (w, q);
+      sys_mutex_lock (&w->mutex);
+    }
+  w->exited = true;
+  sys_cond_broadcast (&w->cond);
+  sys_mutex_unlock (&w->mutex);
+  return NULL;
+}
+
+/* Interrupt the query that the thread of database W is running if it
+   should quit.  This is called by SQLite every so often while the
+   database executes a statement.  */
+static int
+sqlite_worker_progress (void *arg)
+{
+  struct sqlite_worker *w = arg;
+  sys_mutex_lock (&w->mutex);
+  bool quit = w->quit;
+  sys_mutex_unlock (&w->mutex);
+  return quit;
+}
+
+static void sqlite_deliver_async_results (int, void *);
+
+/* Return the thread that runs asynchronous queries for DB, starting it
+   if need be.  Signal an error if that isn't possible.  */
+static struct sqlite_worker *
+sqlite_get_worker (struct Lisp_Sqlite *db)
+{
+  if (db->worker)
+    return db->worker;
+
+  if (sqlite_async_pipe[0] < 0)
+    {
+      int fds[2];
+      if (emacs_pipe (fds) < 0)
+	report_file_error ("Creating pipe", Qnil);
+      if (FD_SETSIZE <= fds[0]
+	  || fcntl (fds[0], F_SETFL, O_NONBLOCK) != 0
+	  || fcntl (fds[1], F_SETFL, O_NONBLOCK) != 0)
+	{
+	  emacs_close (fds[0]);
+	  emacs_close (fds[1]);
+	  xsignal1 (Qsqlite_error,
+		    build_string ("Cannot run queries asynchronously"));
+	}
+      sqlite_async_pipe[0] = fds[0];
+      sqlite_async_pipe[1] = fds[1];
+      add_non_keyboard_read_fd (sqlite_async_pipe[0],
+				sqlite_deliver_async_results, NULL);
+    }
+
+  struct sqlite_worker *w = xzalloc (sizeof *w);
+  w->db = db->db;
+  sys_mutex_init (&w->mutex);
+  sys_cond_init (&w->cond);
+  sys_thread_t thr;
+  if (!sys_thread_create (&thr, sqlite_worker_thread, w))
+    {
+      sys_cond_destroy (&w->cond);
+      xfree (w);
+      xsignal1 (Qsqlite_error, build_string ("Cannot start a thread"));
+    }
+  sqlite3_progress_handler (db->db, 1000, sqlite_worker_progress, w);
+  db->worker = w;
+  return w;
+}
+
+static void
+sqlite_free_query (struct sqlite_async_query *q)
+{
+  sqlite3_finalize (q->stmt);
+  sqlite_free_batches (q->batches);
+  free (q->errmsg);
+  xfree (q);
+}
+
+/* Stop the thread that runs asynchronous queries for DB, if any, and
+   forget its queries.  */
+static void
+sqlite_stop_worker (Lisp_Object db)
+{
+  struct sqlite_worker *w = XSQLITE (db)->worker;
+  if (!w)
+    return;
+
+  sys_mutex_lock (&w->mutex);
+  w->quit = true;
+  sys_cond_broadcast (&w->cond);
+  while (!w->exited)
+    sys_cond_wait (&w->cond, &w->mutex);
+  sys_mutex_unlock (&w->mutex);
+  sqlite3_progress_handler (w->db, 0, NULL, NULL);
+
+  while (w->queries)
+    {
+      struct sqlite_async_query *q = w->queries;
+      w->queries = q->next;
+      sqlite_free_query (q);
+    }
+  sys_cond_destroy (&w->cond);
+  xfree (w);
+  XSQLITE (db)->worker = NULL;
+
+  Lisp_Object *tail = &sqlite_async_queries;
+  while (CONSP (*tail))
+    if (EQ (AREF (XCAR (*tail), 0), db))
+      *tail = XCDR (*tail);
+    else
+      tail = xcdr_addr (*tail);
+}
+
+/* Convert the rows of BATCH into Lisp values, and push them onto
+   ROWS.  */
+static Lisp_Object
+sqlite_batch_rows (struct sqlite_async_batch *batch, Lisp_Object rows)
+{
+  struct sqlite_async_value *v = batch->values;
+  for (int r = 0; r < batch->nrows; r++)
+    {
+      Lisp_Object row = Qnil;
+      for (int i = batch->ncols - 1; i >= 0; i--)
+	{
+	  struct sqlite_async_value *c = &v[r * batch->ncols + i];
+	  Lisp_Object value = Qnil;
+	  switch (c->type)
+	    {
+	    case SQLITE_INTEGER:
+	      value = make_int (c->u.i);
+	      break;
+
+	    case SQLITE_FLOAT:
+	      value = make_float (c->u.d);
+	      break;
+
+	    case SQLITE_BLOB:
+	      value = make_unibyte_string (c->u.s.data, c->u.s.len);
+	      break;
+
+	    case SQLITE_TEXT:
+	      value = text_to_value (c->u.s.data, c->u.s.len);
+	      break;
+	    }
+	  row = Fcons (value, row);
+	}
+      rows = Fcons (row, rows);
+    }
+  return rows;
+}
+
+static Lisp_Object
+sqlite_async_callback_error (Lisp_Object error_val, ptrdiff_t nargs,
+			     Lisp_Object *args)
+{
+  if (!CONSP (error_val))
+    error_val = Fcons (Qerror, error_val);
+  cmd_error_internal (error_val, "error in sqlite callback: ");
+  return Qnil;
+}
+
+/* Pass the rows that the threads have selected, and the results of
+   the queries they have finished, to the callbacks.  This is called
+   when a thread writes to the pipe.  */
+static void
+sqlite_deliver_async_results (int fd, void *data)
+{
+  char buf[64];
+  while (emacs_read (fd, buf, sizeof buf) == sizeof buf)
+    continue;
+
+  /* The callbacks can close databases and start other queries, so
+     look for something to do from the start after calling each
+     one.  */
+ again:
+  for (Lisp_Object tail = sqlite_async_queries; CONSP (tail);
+       tail = XCDR (tail))
+    {
+      Lisp_Object entry = XCAR (tail);
+      struct sqlite_worker *w = XSQLITE (AREF (entry, 0))->worker;
+      struct sqlite_async_query *q = xmint_pointer (AREF (entry, 2));
+      bool select = !NILP (AREF (entry, 3));
+
+      sys_mutex_lock (&w->mutex);
+      struct sqlite_async_batch *batches = q->batches;
+      bool done = q->done;
+      q->batches = NULL;
+      q->last_batch = &q->batches;
+      q->nbatches = 0;
+      sys_cond_broadcast (&w->cond);
+      sys_mutex_unlock (&w->mutex);
+
+      if (!batches && !done)
+	continue;
+
+      Lisp_Object rows = select ? Qnil : AREF (entry, 4);
+      for (struct sqlite_async_batch *b = batches; b; b = b->next)
+	rows = sqlite_batch_rows (b, rows);
+      sqlite_free_batches (batches);
+      if (!select)
+	ASET (entry, 4, rows);
+      if (!done && !select)
+	continue;
+
+      Lisp_Object status = Qnil;
+      Lisp_Object value = Fnreverse (rows);
+      if (done)
+	{
+	  if (q->status == SQLITE_DONE || q->status == SQLITE_OK)
+	    {
+	      status = Qt;
+	      if (!select && NILP (value))
+		value = make_fixnum (q->changes);
+	    }
+	  else
+	    {
+	      status = list2 ((q->status == SQLITE_LOCKED
+			       || q->status == SQLITE_BUSY)
+			      ? Qsqlite_locked_error : Qsqlite_error,
+			      (q->errmsg ? build_string (q->errmsg)
+			       : build_string ("Query failed")));
+	      if (!select)
+		value = Qnil;
+	    }
+
+	  /* Forget the query before calling the callback.  */
+	  struct sqlite_async_query **qp = &w->queries;
+	  sys_mutex_lock (&w->mutex);
+	  while (*qp != q)
+	    qp = &(*qp)->next;
+	  *qp = q->next;
+	  sys_mutex_unlock (&w->mutex);
+	  sqlite_free_query (q);
+	  sqlite_async_queries = Fdelq (entry, sqlite_async_queries);
+	}
+
+      Lisp_Object args[] = { AREF (entry, 1), value, status };
+      internal_condition_case_n (Ffuncall, ARRAYELTS (args), args, Qerror,
+				 sqlite_async_callback_error);
+      goto again;
+    }
+}
+
+/* Start executing QUERY with VALUES bound in DB asynchronously, and
+   call CALLBACK with the results.  SELECT says whether this is for
+   sqlite-select-async.  */
+static void
+sqlite_start_async_query (Lisp_Object db, Lisp_Object query,
+			  Lisp_Object values, Lisp_Object callback,
+			  bool select)
+{
+  struct Lisp_Sqlite *ldb = XSQLITE (db);
+  struct sqlite_worker *w = sqlite_get_worker (ldb);
+  Lisp_Object encoded = encode_string (query);
+  specpdl_ref count = SPECPDL_INDEX ();
+
+  sqlite3_stmt *stmt = NULL;
+  int ret = sqlite_prepare (ldb, encoded, false, &stmt);
+  if (ret != SQLITE_OK)
+    xsignal1 (Qsqlite_error, sqlite_prepare_errdata (ret, ldb->db));
+  if (!NILP (values))
+    {
+      const char *err = bind_values (ldb->db, stmt, values, true);
+      if (err != NULL)
+	xsignal1 (Qsqlite_error, build_string (err));
+    }
+
+  struct sqlite_async_query *q = xzalloc (sizeof *q);
+  q->stmt = stmt;
+  q->last_batch = &q->batches;
+  sqlite_async_queries
+    = Fcons (CALLN (Fvector, db, callback, make_mint_ptr (q),
+		    select ? Qt : Qnil, Qnil),
+	     sqlite_async_queries);
+  /* The query owns the statement now.  */
+  clear_unwind_protect (count);
+  unbind_to (count, Qnil);
+
+  sys_mutex_lock (&w->mutex);
+  struct sqlite_async_query **qp = &w->queries;
+  while (*qp)
+    qp = &(*qp)->next;
+  *qp = q;
+  sys_cond_broadcast (&w->cond);
+  sys_mutex_unlock (&w->mutex);
+}
+
+#endif	/* SQLITE_ASYNC */
+
+DEFUN ("sqlite-select-async", Fsqlite_select_async, Ssqlite_select_async,
+       4, 4, 0,
+       doc: /* Select data from DB that matches QUERY, without waiting.
+VALUES is a list or a vector of values to bind, as for `sqlite-select'.
+
+QUERY is executed by a thread of DB's own, while Emacs goes on.  The
+rows that it selects are passed in batches to CALLBACK, which is called
+with two arguments when Emacs waits for input: a list of rows, and a
+status.  The status is nil if more rows are to come, t once all of
+them have been passed, and the error data, a list whose car is
+`sqlite-error' or `sqlite-locked-error', if QUERY failed.  If DB is
+closed before QUERY is done, CALLBACK is not called any more.  Errors
+in compiling QUERY or binding VALUES are signaled right away.
+
+If Emacs can't run QUERY asynchronously, it runs it right away, and
+calls CALLBACK before returning.  Value is nil.  */)
+  (Lisp_Object db, Lisp_Object query, Lisp_Object values,
+   Lisp_Object callback)
+{
+  check_sqlite (db, false);
+  CHECK_STRING (query);
+  if (!(NILP (values) || CONSP (values) || VECTORP (values)))
+    xsignal1 (Qsqlite_error, build_string ("VALUES must be a list or a vector"));
+
+#ifdef SQLITE_ASYNC
+  sqlite_start_async_query (db, query, values, callback, true);
+#else
+  call2 (callback, Fsqlite_select (db, query, values, Qnil), Qt);
+#endif
+  return Qnil;
+}
+
+DEFUN ("sqlite-execute-async", Fsqlite_execute_async, Ssqlite_execute_async,
+       4, 4, 0,
+       doc: /* Execute a non-select SQL statement in DB, without waiting.
+VALUES is a list or a vector of values to bind, as for `sqlite-execute'.
+
+QUERY is executed by a thread of DB's own, while Emacs goes on.  When
+it is done, CALLBACK is called with two arguments: the value that
+`sqlite-execute' would return, and t, or if QUERY failed, nil and the
+error data, a list whose car is `sqlite-error' or
+`sqlite-locked-error'.  If DB is closed before QUERY is done, CALLBACK
+is not called.  Errors in compiling QUERY or binding VALUES are
+signaled right away.
+
+If Emacs can't run QUERY asynchronously, it runs it right away, and
+calls CALLBACK before returning.  Value is nil.  */)
+  (Lisp_Object db, Lisp_Object query, Lisp_Object values,
+   Lisp_Object callback)
+{
+  check_sqlite (db, false);
+  CHECK_STRING (query);
+  if (!(NILP (values) || CONSP (values) || VECTORP (values)))
+    xsignal1 (Qsqlite_error, build_string ("VALUES must be a list or a vector"));
+
+#ifdef SQLITE_ASYNC
+  sqlite_start_async_query (db, query, values, callback, false);
+#else
+  call2 (callback, Fsqlite_execute (db, query, values), Qt);
+#endif
+  return Qnil;
 }
 
 static Lisp_Object
@@ -797,6 +1719,44 @@ DEFUN ("sqlite-next", Fsqlite_next, Ssqlite_next, 1, 1, 0,
   return row_to_value (XSQLITE (set)->stmt);
 }
 
+DEFUN ("sqlite-next-rows", Fsqlite_next_rows, Ssqlite_next_rows, 2, 2, 0,
+       doc: /* Return a vector of the next COUNT rows from SET.
+The vector is shorter if fewer rows are left.  Return nil when the
+statement has finished executing successfully, like `sqlite-next'.  */)
+  (Lisp_Object set, Lisp_Object count)
+{
+  check_sqlite (set, true);
+  CHECK_FIXNAT (count);
+
+  if (XSQLITE (set)->eof)
+    return Qnil;
+
+  sqlite3_stmt *stmt = XSQLITE (set)->stmt;
+  Lisp_Object rows = Qnil;
+  EMACS_INT n = 0;
+  while (n < XFIXNAT (count))
+    {
+      int ret = sqlite3_step (stmt);
+      if (ret == SQLITE_DONE)
+	{
+	  XSQLITE (set)->eof = true;
+	  if (n == 0)
+	    return Qnil;
+	  break;
+	}
+      if (ret != SQLITE_ROW && ret != SQLITE_OK)
+	xsignal1 (Qsqlite_error,
+		  build_string (sqlite3_errmsg (XSQLITE (set)->db)));
+      rows = Fcons (row_to_value (stmt), rows);
+      n++;
+    }
+
+  Lisp_Object vector = make_nil_vector (n);
+  for (EMACS_INT i = n - 1; i >= 0; i--, rows = XCDR (rows))
+    ASET (vector, i, XCAR (rows));
+  return vector;
+}
+
 DEFUN ("sqlite-columns", Fsqlite_columns, Ssqlite_columns, 1, 1, 0,
        doc: /* Return the column names of SET.  */)
   (Lisp_Object set)
@@ -877,6 +1837,9 @@ syms_of_sqlite (void)
   defsubr (&Ssqlite_open);
   defsubr (&Ssqlite_close);
   defsubr (&Ssqlite_execute);
+  defsubr (&Ssqlite_execute_many);
+  defsubr (&Ssqlite_execute_async);
+  defsubr (&Ssqlite_select_async);
   defsubr (&Ssqlite_select);
   defsubr (&Ssqlite_execute_batch);
   defsubr (&Ssqlite_transaction);
@@ -887,12 +1850,17 @@ syms_of_sqlite (void)
   defsubr (&Ssqlite_load_extension);
 #endif
   defsubr (&Ssqlite_next);
+  defsubr (&Ssqlite_next_rows);
   defsubr (&Ssqlite_columns);
   defsubr (&Ssqlite_more_p);
   defsubr (&Ssqlite_finalize);
   defsubr (&Ssqlite_version);
   DEFSYM (Qset, "set");
   DEFSYM (Qfull, "full");
+#ifdef SQLITE_ASYNC
+  staticpro (&sqlite_async_queries);
+  sqlite_async_queries = Qnil;
+#endif
 #endif
   defsubr (&Ssqlitep);
   defsubr (&Ssqlite_available_p);
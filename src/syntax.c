@@ -149,6 +149,9 @@ SYNTAX_COMEND_FIRST (int c)
     EMACS_INT mindepth;	/* Minimum depth seen while scanning.  */
     /* Char number of most recent start-of-expression at current level */
     ptrdiff_t thislevelstart;
+    /* Char number of start of the expression being scanned at current
+       level, if any.  */
+    ptrdiff_t thislevellast;
     /* Char number of start of containing expression */
     ptrdiff_t prevlevelstart;
     ptrdiff_t location;	     /* Char number at which parsing stopped.  */
@@ -177,6 +180,29 @@ SYNTAX_COMEND_FIRST (int c)
 static ptrdiff_t find_start_begv;
 static modiff_count find_start_modiff;
 
+/* These variables are a table of parse states recorded while scanning
+   forward from BEGV of syntax_checkpoint_buffer, at intervals of about
+   SYNTAX_CHECKPOINT_INTERVAL characters.  The Nth element of
+   syntax_checkpoints is the state after parsing from BEGV to its
+   location, with mindepth being the minimum depth since BEGV; its
+   levelstarts list is also kept in slot N of
+   syntax_checkpoint_levelstarts, for the benefit of GC.  The table is
+   valid only for the syntax table, BEGV and variables recorded with
+   it, and is truncated by invalidate_syntax_checkpoints whenever the
+   text or its properties change.  */
+
+enum { SYNTAX_CHECKPOINT_INTERVAL = 2000 };
+
+static struct lisp_parse_state *syntax_checkpoints;
+static ptrdiff_t syntax_checkpoints_used, syntax_checkpoints_size;
+static Lisp_Object syntax_checkpoint_levelstarts;
+static Lisp_Object syntax_checkpoint_buffer;
+static Lisp_Object syntax_checkpoint_table;
+static struct buffer_text *syntax_checkpoint_text;
+static ptrdiff_t syntax_checkpoint_begv;
+static bool syntax_checkpoint_lookup_properties;
+static bool syntax_checkpoint_comment_end_escapable;
+
 
 static Lisp_Object skip_chars (bool, Lisp_Object, Lisp_Object);
 static Lisp_Object skip_syntaxes (bool, Lisp_Object, Lisp_Object);
@@ -195,6 +221,50 @@ bset_syntax_table (struct buffer *b, Lisp_Object val)
   b->syntax_table_ = val;
 }
 
+/* The syntax codes, with flags, of the ASCII characters according to
+   ascii_syntax_table, as of char_table_modiff ascii_syntax_modiff.
+   Loops over mostly ASCII text use them to avoid looking up each
+   character in the syntax table and its parents.  */
+
+static Lisp_Object ascii_syntax_table;
+static EMACS_UINT ascii_syntax_modiff;
+static int ascii_syntax[128];
+
+/* Return the syntax codes of ASCII characters in the syntax table
+   that is in effect at the global syntax position, or NULL if a
+   syntax-table property overrides the syntax table there.  */
+
+static int const *
+ascii_syntax_codes (void)
+{
+  if (gl_state.use_global)
+    return NULL;
+  Lisp_Object table = gl_state.current_syntax_table;
+  if (! (EQ (table, ascii_syntax_table)
+	 && ascii_syntax_modiff == char_table_modiff))
+    {
+      for (int c = 0; c < ARRAYELTS (ascii_syntax); c++)
+	{
+	  Lisp_Object ent = CHAR_TABLE_REF (table, c);
+	  ascii_syntax[c] = CONSP (ent) ? XFIXNUM (XCAR (ent)) : Swhitespace;
+	}
+      ascii_syntax_table = table;
+      ascii_syntax_modiff = char_table_modiff;
+    }
+  return ascii_syntax;
+}
+
+/* Like SYNTAX (C), but faster for ASCII characters.  */
+
+static enum syntaxcode
+syntax_fast (int c)
+{
+  int const *codes;
+  if (ASCII_CHAR_P (c) && (codes = ascii_syntax_codes ()))
+    return codes[c] & 0xff;
+  return SYNTAX (c);
+}
+
 /* Whether the syntax of the character C has the prefix flag set.  */
 bool
 syntax_prefix_flag_p (int c)
@@ -648,6 +718,174 @@ find_defun_start (ptrdiff_t pos, ptrdiff_t pos_byte)
   return find_start_value;
 }
 
+/* Forget all the parse states recorded in syntax_checkpoints.  */
+
+static void
+clear_syntax_checkpoints (void)
+{
+  syntax_checkpoints_used = 0;
+  syntax_checkpoint_buffer = Qnil;
+  syntax_checkpoint_table = Qnil;
+  syntax_checkpoint_text = NULL;
+}
+
+/* Forget the parse states recorded for the text of BUF at or after
+   START, because the text or its properties there are about to
+   change.  */
+
+void
+invalidate_syntax_checkpoints (struct buffer *buf, ptrdiff_t start)
+{
+  if (buf->text == syntax_checkpoint_text)
+    {
+      ptrdiff_t n = syntax_checkpoints_used;
+      while (n > 0 && syntax_checkpoints[n - 1].location >= start)
+	n--;
+      syntax_checkpoints_used = n;
+    }
+}
+
+/* Return true if syntax_checkpoints describes the current buffer, with
+   its current restriction and syntax settings.  */
+
+static bool
+syntax_checkpoints_valid_p (void)
+{
+  return (BUFFERP (syntax_checkpoint_buffer)
+	  && XBUFFER (syntax_checkpoint_buffer) == current_buffer
+	  && current_buffer->text == syntax_checkpoint_text
+	  && BEGV == syntax_checkpoint_begv
+	  && EQ (BVAR (current_buffer, syntax_table), syntax_checkpoint_table)
+	  && (parse_sexp_lookup_properties
+	      == syntax_checkpoint_lookup_properties)
+	  && (comment_end_can_be_escaped
+	      == syntax_checkpoint_comment_end_escapable));
+}
+
+/* Store into *STATE the parse state at BEGV.  */
+
+static void
+syntax_checkpoint_initial_state (struct lisp_parse_state *state)
+{
+  internalize_parse_state (Qnil, state);
+  state->mindepth = 0;
+  state->prevlevelstart = -1;
+  state->location = BEGV;
+  state->location_byte = BEGV_BYTE;
+}
+
+/* Return true if parsing can resume from STATE, produced by
+   scan_sexps_forward, and reach the same results as if the scan that
+   produced STATE had gone on.  That is not so in the middle of a
+   symbol, after an escape character or after the first character of
+   a two-character construct.  */
+
+static bool
+syntax_checkpoint_p (struct lisp_parse_state *state)
+{
+  if (state->quoted || state->prev_syntax != Smax
+      /* scan_sexps_forward doesn't record deeper levels.  */
+      || state->depth >= 99)
+    return false;
+  if (state->instring >= 0 || state->incomment || state->location >= ZV)
+    return true;
+
+  int c = FETCH_CHAR_AS_MULTIBYTE (state->location_byte);
+  SETUP_SYNTAX_TABLE (state->location, 1);
+  switch (SYNTAX (c))
+    {
+    case Sword: case Ssymbol: case Squote: case Sescape: case Scharquote:
+      return false;
+    default:
+      return true;
+    }
+}
+
+/* Store into *STATE the state of parsing from BEGV to the last
+   position not after POS for which a parse state is known, and
+   return that position.  Parse states are recorded in
+   syntax_checkpoints on the way, so the next call near POS is
+   fast.  */
+
+static ptrdiff_t
+syntax_checkpoint_state (ptrdiff_t pos, struct lisp_parse_state *state)
+{
+  if (!syntax_checkpoints_valid_p ())
+    {
+      syntax_checkpoints_used = 0;
+      XSETBUFFER (syntax_checkpoint_buffer, current_buffer);
+      syntax_checkpoint_text = current_buffer->text;
+      syntax_checkpoint_begv = BEGV;
+      syntax_checkpoint_table = BVAR (current_buffer, syntax_table);
+      syntax_checkpoint_lookup_properties = parse_sexp_lookup_properties;
+      syntax_checkpoint_comment_end_escapable = comment_end_can_be_escaped;
+    }
+
+  ptrdiff_t lo = 0, hi = syntax_checkpoints_used;
+  while (lo < hi)
+    {
+      ptrdiff_t mid = lo + (hi - lo) / 2;
+      if (syntax_checkpoints[mid].location <= pos)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  if (lo == 0)
+    syntax_checkpoint_initial_state (state);
+  else
+    *state = syntax_checkpoints[lo - 1];
+
+  /* Extend the table if POS is far beyond its end.  The scan stops
+     after SYNTAX_CHECKPOINT_INTERVAL characters, or a bit later if
+     that is not a place from which parsing can resume.  */
+  while (lo == syntax_checkpoints_used
+	 && pos - state->location >= SYNTAX_CHECKPOINT_INTERVAL)
+    {
+      struct lisp_parse_state next;
+      ptrdiff_t end = state->location + SYNTAX_CHECKPOINT_INTERVAL;
+      ptrdiff_t step = 16;
+
+      while (true)
+	{
+	  next = *state;
+	  scan_sexps_forward (&next, state->location, state->location_byte,
+			      end, TYPE_MINIMUM (EMACS_INT), 0, 0);
+	  if (syntax_checkpoint_p (&next))
+	    break;
+	  if (end == pos)
+	    return state->location;
+	  end = min (pos, end + step);
+	  step *= 2;
+	}
+
+      /* Parsing can run syntax-propertize, which can change anything.  */
+      if (!syntax_checkpoints_valid_p () || syntax_checkpoints_used < lo)
+	{
+	  clear_syntax_checkpoints ();
+	  syntax_checkpoint_initial_state (state);
+	  return state->location;
+	}
+
+      next.mindepth = min (next.mindepth, state->mindepth);
+      if (syntax_checkpoints_used == syntax_checkpoints_size)
+	syntax_checkpoints = xpalloc (syntax_checkpoints,
+				      &syntax_checkpoints_size, 1, -1,
+				      sizeof *syntax_checkpoints);
+      if (ASIZE (syntax_checkpoint_levelstarts) < syntax_checkpoints_size)
+	syntax_checkpoint_levelstarts
+	  = larger_vector (syntax_checkpoint_levelstarts,
+			   (syntax_checkpoints_size
+			    - ASIZE (syntax_checkpoint_levelstarts)),
+			   -1);
+      syntax_checkpoints[lo] = next;
+      ASET (syntax_checkpoint_levelstarts, lo, next.levelstarts);
+      syntax_checkpoints_used = ++lo;
+      *state = next;
+    }
+
+  return state->location;
+}
+
 /* Return the SYNTAX_COMEND_FIRST of the character before POS, POS_BYTE.  */
 
 static bool
@@ -920,6 +1158,12 @@ back_comment (ptrdiff_t from, ptrdiff_t from_byte, ptrdiff_t stop,
       do
 	{
           internalize_parse_state (Qnil, &state);
+	  /* Don't parse all the way from BEGV if we know a later state.  */
+	  if (defun_start == BEGV)
+	    {
+	      defun_start = syntax_checkpoint_state (comment_end, &state);
+	      defun_start_byte = state.location_byte;
+	    }
 	  scan_sexps_forward (&state,
 			      defun_start, defun_start_byte,
 			      comment_end, TYPE_MINIMUM (EMACS_INT),
@@ -1268,6 +1512,7 @@ c (on any of its chars) using this flag:
     check_syntax_table (syntax_table);
 
   newentry = Fstring_to_syntax (newentry);
+  clear_syntax_checkpoints ();
   if (CONSP (c))
     SET_RAW_SYNTAX_ENTRY_RANGE (syntax_table, c, newentry);
   else
@@ -1460,7 +1705,7 @@ scan_words (ptrdiff_t from, EMACS_INT count)
 	    return 0;
 	  UPDATE_SYNTAX_TABLE_FORWARD (from);
 	  ch0 = FETCH_CHAR_AS_MULTIBYTE (from_byte);
-	  code = SYNTAX (ch0);
+	  code = syntax_fast (ch0);
 	  inc_both (&from, &from_byte);
 	  if (words_include_escapes
 	      && (code == Sescape || code == Scharquote))
@@ -1488,7 +1733,7 @@ scan_words (ptrdiff_t from, EMACS_INT count)
 	      if (from == end) break;
 	      UPDATE_SYNTAX_TABLE_FORWARD (from);
 	      ch1 = FETCH_CHAR_AS_MULTIBYTE (from_byte);
-	      code = SYNTAX (ch1);
+	      code = syntax_fast (ch1);
 	      if ((code != Sword
 		   && (! words_include_escapes
 		       || (code != Sescape && code != Scharquote)))
@@ -1510,7 +1755,7 @@ scan_words (ptrdiff_t from, EMACS_INT count)
 	  dec_both (&from, &from_byte);
 	  UPDATE_SYNTAX_TABLE_BACKWARD (from);
 	  ch1 = FETCH_CHAR_AS_MULTIBYTE (from_byte);
-	  code = SYNTAX (ch1);
+	  code = syntax_fast (ch1);
 	  if (words_include_escapes
 	      && (code == Sescape || code == Scharquote))
 	    break;
@@ -1539,7 +1784,7 @@ scan_words (ptrdiff_t from, EMACS_INT count)
 	      dec_both (&from, &from_byte);
 	      UPDATE_SYNTAX_TABLE_BACKWARD (from);
 	      ch0 = FETCH_CHAR_AS_MULTIBYTE (from_byte);
-	      code = SYNTAX (ch0);
+	      code = syntax_fast (ch0);
 	      if ((code != Sword
 		   && (! words_include_escapes
 		       || (code != Sescape && code != Scharquote)))
@@ -2160,6 +2405,7 @@ skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
       {
 	while (true)
 	  {
+	    int const *codes = ascii_syntax_codes ();
 	    p = BYTE_POS_ADDR (pos_byte);
 	    endp = XFIXNUM (lim) == GPT ? GPT_ADDR : CHAR_POS_ADDR (XFIXNUM (lim));
 	    stop = pos < GPT && GPT < XFIXNUM (lim) ? GPT_ADDR : endp;
@@ -2175,6 +2421,24 @@ skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
 		    p = GAP_END_ADDR;
 		    stop = endp;
 		  }
+		if (codes && ASCII_CHAR_P (*p))
+		  {
+		    /* Skip a run of ASCII characters in one go.  */
+		    unsigned char *run = p;
+		    ptrdiff_t limit = (parse_sexp_lookup_properties
+				       ? gl_state.e_property - pos
+				       : PTRDIFF_MAX);
+		    unsigned char *runend = (stop - p < limit
+					     ? stop : p + limit);
+		    while (p < runend && ASCII_CHAR_P (*p)
+			   && fastmap[codes[*p] & 0xff])
+		      p++;
+		    pos += p - run, pos_byte += p - run;
+		    if (p < runend && ASCII_CHAR_P (*p))
+		      goto done;
+		    rarely_quit (pos);
+		    continue;
+		  }
 		if (multibyte)
 		  c = string_char_and_length (p, &nbytes);
 		else
@@ -2215,7 +2479,7 @@ skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
 		while (stop <= p && ! CHAR_HEAD_P (*p));
 
 		c = STRING_CHAR (p);
-		if (! fastmap[SYNTAX (c)])
+		if (! fastmap[syntax_fast (c)])
 		  break;
 		pos--, pos_byte -= prev_p - p;
 		rarely_quit (pos);
@@ -2233,7 +2497,7 @@ skip_syntaxes (bool forwardp, Lisp_Object string, Lisp_Object lim)
 		    stop = endp;
 		  }
 		UPDATE_SYNTAX_TABLE_BACKWARD (pos - 1);
-		if (! fastmap[SYNTAX (p[-1])])
+		if (! fastmap[syntax_fast (p[-1])])
 		  break;
 		p--, pos--, pos_byte--;
 		rarely_quit (pos);
@@ -3219,8 +3483,8 @@ #define INC_FROM				\
       curlevel->last = -1;
       tem = Fcdr (tem);
     }
-  curlevel->prev = -1;
-  curlevel->last = -1;
+  curlevel->prev = state->thislevelstart;
+  curlevel->last = state->thislevellast;
 
   state->quoted = 0;
   mindepth = depth;
@@ -3458,6 +3722,7 @@ #define INC_FROM				\
   state->depth = depth;
   state->mindepth = mindepth;
   state->thislevelstart = curlevel->prev;
+  state->thislevellast = curlevel->last;
   state->prevlevelstart
     = (curlevel == levelstart) ? -1 : (curlevel - 1)->last;
   state->location = from;
@@ -3484,6 +3749,11 @@ internalize_parse_state (Lisp_Object external, struct lisp_parse_state *state)
 {
   Lisp_Object tem;
 
+  /* Parse states in Lisp do not record where the sexps at the
+     innermost level started.  */
+  state->thislevelstart = -1;
+  state->thislevellast = -1;
+
   if (NILP (external))
     {
       state->depth = 0;
@@ -3602,11 +3872,24 @@ DEFUN ("parse-partial-sexp", Fparse_partial_sexp, Sparse_partial_sexp, 2, 6, 0,
 
   validate_region (&from, &to);
   internalize_parse_state (oldstate, &state);
-  scan_sexps_forward (&state, XFIXNUM (from), CHAR_TO_BYTE (XFIXNUM (from)),
+  ptrdiff_t start = XFIXNUM (from), start_byte;
+  EMACS_INT mindepth = TYPE_MAXIMUM (EMACS_INT);
+  /* A plain parse from BEGV can start at a known later state.  */
+  if (start == BEGV && NILP (oldstate) && NILP (targetdepth)
+      && NILP (stopbefore) && NILP (commentstop))
+    {
+      start = syntax_checkpoint_state (XFIXNUM (to), &state);
+      start_byte = state.location_byte;
+      mindepth = state.mindepth;
+    }
+  else
+    start_byte = CHAR_TO_BYTE (start);
+  scan_sexps_forward (&state, start, start_byte,
 		      XFIXNUM (to),
 		      target, !NILP (stopbefore),
 		      (NILP (commentstop)
 		       ? 0 : (EQ (commentstop, Qsyntax_table) ? -1 : 1)));
+  state.mindepth = min (state.mindepth, mindepth);
 
   SET_PT_BOTH (state.location, state.location_byte);
 
@@ -3740,6 +4023,15 @@ syms_of_syntax (void)
   staticpro (&gl_state.current_syntax_table);
   staticpro (&gl_state.old_prop);
 
+  staticpro (&ascii_syntax_table);
+  ascii_syntax_table = Qnil;
+  staticpro (&syntax_checkpoint_levelstarts);
+  syntax_checkpoint_levelstarts = make_nil_vector (0);
+  staticpro (&syntax_checkpoint_buffer);
+  syntax_checkpoint_buffer = Qnil;
+  staticpro (&syntax_checkpoint_table);
+  syntax_checkpoint_table = Qnil;
+
   DEFSYM (Qscan_error, "scan-error");
   Fput (Qscan_error, Qerror_conditions,
 	list (Qscan_error, Qerror));
@@ -92,6 +92,10 @@ #define STDERR_FILENO fileno(GetStdHandle(STD_ERROR_HANDLE))
 #include <sys/systeminfo.h>
 #endif
 
+#ifdef HAVE_SYS_UIO_H
+#include <sys/uio.h>
+#endif
+
 #ifdef MSDOS	/* Demacs 1.1.2 91/10/20 Manabu Higashida, MW Aug 1993 */
 #include "msdos.h"
 #endif
@@ -1311,9 +1315,11 @@ init_sys_modes (struct tty_display_info *tty_out)
     }
 #endif /* F_GETOWN */
 
+  /* By default, make the buffer large enough for most frame updates
+     to be written with a single system call; see flush_terminal.  */
   const size_t buffer_size = (tty_out->output_buffer_size
 			      ? tty_out->output_buffer_size
-			      : BUFSIZ);
+			      : max (BUFSIZ, 64 * 1024));
   setvbuf (tty_out->output, NULL, _IOFBF, buffer_size);
 
   if (tty_out->terminal->set_terminal_modes_hook)
@@ -2846,6 +2852,52 @@ emacs_write_quit (int fd, void const *buf, ptrdiff_t nbyte)
   return emacs_full_write (fd, buf, nbyte, 1);
 }
 
+#ifdef HAVE_WRITEV
+/* Like emacs_write_sig, but write the IOVCNT buffers described by IOV
+   one after the other, with as few system calls as possible.  IOV may
+   be modified.  Return the total number of bytes written; if this is
+   less than the total size of the buffers, set errno to a value other
+   than EINTR.  */
+ptrdiff_t
+emacs_writev_sig (int fd, struct iovec *iov, int iovcnt)
+{
+  ptrdiff_t bytes_written = 0;
+
+  while (iovcnt > 0)
+    {
+      /* Don't ask for more than MAX_RW_COUNT bytes at once.  */
+      int n = 0;
+      ptrdiff_t nbyte = 0;
+      while (n < iovcnt && iov[n].iov_len <= MAX_RW_COUNT - nbyte)
+	nbyte += iov[n++].iov_len;
+
+      ssize_t written = (n == 0
+			 ? write (fd, iov->iov_base, MAX_RW_COUNT)
+			 : writev (fd, iov, n));
+
+      if (written < 0)
+	{
+	  if (errno != EINTR)
+	    break;
+	  if (pending_signals)
+	    process_pending_signals ();
+	  continue;
+	}
+
+      bytes_written += written;
+      for (; iovcnt > 0 && iov->iov_len <= written; iov++, iovcnt--)
+	written -= iov->iov_len;
+      if (written > 0)
+	{
+	  iov->iov_base = (char *) iov->iov_base + written;
+	  iov->iov_len -= written;
+	}
+    }
+
+  return bytes_written;
+}
+#endif
+
 /* Write a diagnostic to standard error that contains MESSAGE and a
    string derived from errno.  Preserve errno.  Do not buffer stderr.
    Do not process quits or pending signals if interrupted.  */
@@ -233,6 +233,7 @@ tty_reset_terminal_modes (struct terminal *terminal)
 
   if (tty->output)
     {
+      tty_finish_update (tty);
       tty_send_additional_strings (terminal, Qtty_mode_reset_strings);
       tty_turn_off_highlight (tty);
       tty_turn_off_insert (tty);
@@ -247,7 +248,29 @@ tty_reset_terminal_modes (struct terminal *terminal)
     }
 }
 
-/* Flag the end of a display update on a termcap terminal. */
+/* Flag the beginning of a display update on a termcap terminal.  If
+the terminal has told us that it supports synchronized output, ask it
+to hold off displaying what we send until tty_finish_update, so that
+it never shows a partially updated frame.  */
+
+static void
+tty_update_begin (struct frame *f)
+{
+  struct tty_display_info *tty = FRAME_TTY (f);
+
+  if (tty->output
+      && !tty->synchronized_update
+      && !NILP (CDR_SAFE (assq_no_quit (Qtty_synchronized_output,
+					FRAME_TERMINAL (f)->param_alist))))
+    {
+      OUTPUT1 (tty, "\033[?2026h");
+      tty->synchronized_update = true;
+    }
+}
+
+/* Flag the end of a display update on a termcap terminal.  The output
+   is flushed by flush_terminal, after the cursor was positioned, so
+   that an update normally goes out in a single write.  */
 
 static void
 tty_update_end (struct frame *f)
@@ -258,7 +281,20 @@ tty_update_end (struct frame *f)
     tty_show_cursor (tty);
   tty_turn_off_insert (tty);
   tty_background_highlight (tty);
-  fflush (tty->output);
+}
+
+/* Let the terminal of TTY display the output of the last update, if
+   tty_update_begin asked it to wait.  */
+
+void
+tty_finish_update (struct tty_display_info *tty)
+{
+  if (tty->synchronized_update)
+    {
+      if (tty->output)
+	OUTPUT1 (tty, "\033[?2026l");
+      tty->synchronized_update = false;
+    }
 }
 
 /* The implementation of set_terminal_window for termcap frames. */
@@ -753,6 +789,22 @@ encode_terminal_code (struct glyph *src, int src_len,
 
 #ifndef HAVE_ANDROID
 
+/* Return true if turn_on_face and turn_off_face send the same escape
+   sequences for faces A and B.  */
+
+static bool
+tty_faces_look_alike_p (struct face *a, struct face *b)
+{
+  return (a->foreground == b->foreground
+	  && a->background == b->background
+	  && a->underline_color == b->underline_color
+	  && a->underline == b->underline
+	  && a->tty_bold_p == b->tty_bold_p
+	  && a->tty_italic_p == b->tty_italic_p
+	  && a->tty_reverse_p == b->tty_reverse_p
+	  && a->tty_strike_through_p == b->tty_strike_through_p);
+}
+
 /* An implementation of write_glyphs for termcap frames. */
 
 static void
@@ -784,13 +836,22 @@ tty_write_glyphs_1 (struct frame *f, struct glyph *string, int len)
       int face_id = string->face_id;
       struct frame *face_id_frame = string->frame;
 
+      struct face *face = FACE_FROM_ID (face_id_frame, face_id);
+
+      /* Faces that differ only in attributes a terminal cannot show,
+	 such as the font, produce the same escape sequences; write
+	 their glyphs as one run so that we don't turn the same
+	 appearance off and on again between them.  */
       for (n = 1; n < stringlen; ++n)
-	if (string[n].face_id != face_id || string[n].frame != face_id_frame)
+	if (string[n].frame != face_id_frame
+	    || (string[n].face_id != face_id
+		&& !tty_faces_look_alike_p (face,
+					    FACE_FROM_ID (face_id_frame,
+							  string[n].face_id))))
 	  break;
 
       /* Turn appearance modes of the face of the run on.  */
       tty_highlight_if_desired (tty);
-      struct face *face = FACE_FROM_ID (face_id_frame, face_id);
       turn_on_face (f, face);
 
       if (n == stringlen)
@@ -2539,8 +2600,9 @@ DEFUN ("tty--set-output-buffer-size", Ftty__set_output_buffer_size,
        Stty__set_output_buffer_size, 1, 2, 0, doc:
        /* Set the output buffer size for a TTY.
 
-SIZE zero means use the system's default value.  If SIZE is
-non-zero, this also avoids flushing the output stream.
+SIZE zero means use the default value, which is large enough for most
+frame updates to be written in one go.  If SIZE is non-zero, this also
+avoids flushing the output stream.
 
 TTY may be a terminal object, a frame, or nil (meaning the selected
 frame's terminal).
@@ -4251,6 +4313,7 @@ set_tty_hooks (struct terminal *terminal)
   terminal->ring_bell_hook = &tty_ring_bell;
   terminal->reset_terminal_modes_hook = &tty_reset_terminal_modes;
   terminal->set_terminal_modes_hook = &tty_set_terminal_modes;
+  terminal->update_begin_hook = &tty_update_begin;
   terminal->update_end_hook = &tty_update_end;
 #ifdef MSDOS
   terminal->menu_show_hook = &x_menu_show;
@@ -5191,6 +5254,7 @@ syms_of_term (void)
 #endif
 
   DEFSYM (Qtty_mode_set_strings, "tty-mode-set-strings");
+  DEFSYM (Qtty_synchronized_output, "tty-synchronized-output");
   DEFSYM (Qtty_mode_reset_strings, "tty-mode-reset-strings");
 
 #ifndef MSDOS
@@ -53,8 +53,9 @@ #define EMACS_TERMCHAR_H
   FILE *output;                 /* The stream to be used for terminal output.
                                    NULL if the terminal is suspended. */
 
-  /* Size of output buffer.  A value of zero means use the default of
-     BUFIZE.  If non-zero, also minimize writes to the tty by avoiding
+  /* Size of output buffer.  A value of zero means use the default,
+     which is large enough for most frame updates to be written in one
+     go.  If non-zero, also minimize writes to the tty by avoiding
      calls to flush.  */
   size_t output_buffer_size;
 
@@ -213,6 +214,11 @@ #define EMACS_TERMCHAR_H
   /* True means we are displaying a TTY menu on this tty.  */
   bool_bf showing_menu : 1;
 
+  /* True means the display update in progress was started with the
+     sequence that begins synchronized output (DEC private mode 2026),
+     and the sequence that ends it is still to be sent.  */
+  bool_bf synchronized_update : 1;
+
   /* True means spaces in the text must actually be output;
      can't just skip over some columns to leave them blank.  */
   bool_bf must_write_spaces : 1;
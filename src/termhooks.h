@@ -253,6 +253,12 @@ #define EMACS_TERMHOOKS_H
   , THREAD_EVENT
 #endif
 
+#ifdef HAVE_MODULES
+  /* A callback posted by a thread of a dynamic module.  .arg is a
+     list of a user pointer to the callback.  */
+  , MODULE_EVENT
+#endif
+
   , CONFIG_CHANGED_EVENT
 
 #ifdef HAVE_NTGUI
@@ -405,6 +411,10 @@ #define EMACS_TERMHOOKS_H
      "Virtual core pointer" for all events other than keystroke
      events, and "Virtual core keyboard" for those.  */
   Lisp_Object device;
+
+  /* When the event was put into the keyboard buffer, if
+     `track-input-latency' was non-nil then.  */
+  struct timespec arrival;
 };
 
 #define EVENT_INIT(event) (memset (&(event), 0, sizeof (struct input_event)), \
@@ -979,6 +989,7 @@ #define cursorY(t)  curY(t)
 
 void tty_hide_cursor (struct tty_display_info *tty);
 void tty_show_cursor (struct tty_display_info *tty);
+void tty_finish_update (struct tty_display_info *tty);
 
 INLINE_HEADER_END
 
@@ -180,6 +180,7 @@ write_glyphs (struct frame *f, struct glyph *string, int len)
 {
   if (FRAME_TERMINAL (f)->write_glyphs_hook)
     (*FRAME_TERMINAL (f)->write_glyphs_hook) (f, string, len);
+  redisplay_glyphs_written += len;
 }
 
 /* Insert LEN glyphs from START at the nominal cursor position.
@@ -194,6 +195,7 @@ insert_glyphs (struct frame *f, struct glyph *start, int len)
 
   if (FRAME_TERMINAL (f)->insert_glyphs_hook)
     (*FRAME_TERMINAL (f)->insert_glyphs_hook) (f, start, len);
+  redisplay_glyphs_written += len;
 }
 
 /* Delete N glyphs at the nominal cursor position. */
@@ -1327,6 +1327,172 @@ DEFUN ("put-text-property", Fput_text_property,
   return Qnil;
 }
 
+/* Set the properties of PLIST in the LEN characters of OBJECT that
+   start at position S, which is in interval I.  Set *MODIFIED if this
+   changes any interval.  Return the interval that contains the last
+   of these characters.  */
+
+static INTERVAL
+add_properties_to_run (INTERVAL i, ptrdiff_t s, ptrdiff_t len,
+		       Lisp_Object plist, Lisp_Object object, bool *modified)
+{
+  for (;;)
+    {
+      eassert (i->position <= s && s < i->position + LENGTH (i));
+
+      if (!interval_has_all_properties (plist, i))
+	{
+	  INTERVAL unchanged;
+
+	  if (i->position < s)
+	    {
+	      unchanged = i;
+	      i = split_interval_right (unchanged, s - unchanged->position);
+	      copy_properties (unchanged, i);
+	    }
+	  if (LENGTH (i) > len)
+	    {
+	      unchanged = i;
+	      i = split_interval_left (unchanged, len);
+	      copy_properties (unchanged, i);
+	    }
+	  add_properties (plist, i, object, TEXT_PROPERTY_REPLACE, true);
+	  *modified = true;
+	}
+
+      ptrdiff_t got = i->position + LENGTH (i) - s;
+      if (got >= len)
+	return i;
+      s += got;
+      len -= got;
+      i = next_interval (i);
+    }
+}
+
+/* Callers note, this can GC when OBJECT is a buffer (or nil).  */
+
+DEFUN ("put-text-properties-bulk", Fput_text_properties_bulk,
+       Sput_text_properties_bulk, 1, 2, 0,
+       doc: /* Set one property in each of several runs of text.
+RUNS is a vector of lists (START END PROPERTY VALUE), sorted by START.
+For each element, set PROPERTY to VALUE in the text from START to END,
+like `put-text-property' does; where runs overlap, later elements of
+RUNS take precedence.  If the optional second argument OBJECT is a
+buffer (or nil, which means the current buffer), START and END are
+buffer positions (integers or markers).  If OBJECT is a string, START
+and END are 0-based indices into it.
+
+This is faster than calling `put-text-property' for each run: the
+modification hooks run once for the text from the first START to the
+last END, the runs are applied in one pass over the text, and
+adjacent stretches of text that end up with the same properties share
+their record of them afterward.
+
+Return t if any property value actually changed, nil otherwise.  */)
+  (Lisp_Object runs, Lisp_Object object)
+{
+  if (NILP (object))
+    XSETBUFFER (object, current_buffer);
+
+  /* Run the modification hooks in the right buffer, as
+     add_text_properties_1 does.  */
+  if (BUFFERP (object) && XBUFFER (object) != current_buffer)
+    {
+      specpdl_ref count = SPECPDL_INDEX ();
+      record_unwind_current_buffer ();
+      set_buffer_internal (XBUFFER (object));
+      return unbind_to (count, Fput_text_properties_bulk (runs, object));
+    }
+
+  CHECK_STRING_OR_BUFFER (object);
+  CHECK_VECTOR (runs);
+  ptrdiff_t nruns = ASIZE (runs);
+
+  /* Check the runs, and find the text from FIRST to TO that they
+     cover.  */
+  ptrdiff_t first = 0, prev = 0, to = 0;
+  for (ptrdiff_t k = 0; k < nruns; k++)
+    {
+      Lisp_Object run = AREF (runs, k);
+      if (! (CONSP (run) && list_length (run) == 4))
+	wrong_type_argument (Qlistp, run);
+      Lisp_Object rstart = XCAR (run), rend = XCAR (XCDR (run));
+      CHECK_FIXNUM_COERCE_MARKER (rstart);
+      CHECK_FIXNUM_COERCE_MARKER (rend);
+      ptrdiff_t s = min (XFIXNUM (rstart), XFIXNUM (rend));
+      ptrdiff_t e = max (XFIXNUM (rstart), XFIXNUM (rend));
+      if (BUFFERP (object)
+	  ? ! (BUF_BEGV (XBUFFER (object)) <= s
+	       && e <= BUF_ZV (XBUFFER (object)))
+	  : ! (0 <= s && e <= SCHARS (object)))
+	args_out_of_range (rstart, rend);
+      if (k == 0)
+	first = s;
+      else if (s < prev)
+	error ("Runs of text are not sorted by start position");
+      prev = s;
+      to = max (to, e);
+    }
+
+  Lisp_Object start = make_fixnum (first), end = make_fixnum (to);
+  if (nruns == 0 || !validate_interval_range (object, &start, &end, hard))
+    return Qnil;
+
+  if (BUFFERP (object))
+    modify_text_properties (object, start, end);
+
+  /* The modification hooks may have changed the intervals, so find
+     them only now.  */
+  INTERVAL i = validate_interval_range (object, &start, &end, hard);
+  bool modified = false;
+  for (ptrdiff_t k = 0; k < nruns && i; k++)
+    {
+      Lisp_Object run = AREF (runs, k);
+      Lisp_Object rstart = XCAR (run), rend = XCAR (XCDR (run));
+      CHECK_FIXNUM_COERCE_MARKER (rstart);
+      CHECK_FIXNUM_COERCE_MARKER (rend);
+      ptrdiff_t s = min (XFIXNUM (rstart), XFIXNUM (rend));
+      ptrdiff_t e = max (XFIXNUM (rstart), XFIXNUM (rend));
+      if (s == e)
+	continue;
+
+      /* Find the interval of S, going forward from the previous run
+	 unless this run starts before it.  */
+      if (s < i->position)
+	i = find_interval (BUFFERP (object)
+			   ? buffer_intervals (XBUFFER (object))
+			   : string_intervals (object),
+			   s);
+      else
+	while (s >= i->position + LENGTH (i))
+	  i = next_interval (i);
+
+      AUTO_LIST2 (plist, XCAR (XCDR (XCDR (run))),
+		  XCAR (XCDR (XCDR (XCDR (run)))));
+      i = add_properties_to_run (i, s, e - s, plist, object, &modified);
+    }
+
+  if (modified)
+    {
+      /* Merge the intervals with equal properties, so that setting
+	 many runs does not leave the text split into many more
+	 intervals than it needs.  */
+      i = find_interval (BUFFERP (object)
+			 ? buffer_intervals (XBUFFER (object))
+			 : string_intervals (object),
+			 first);
+      if (previous_interval (i))
+	i = previous_interval (i);
+      for (INTERVAL next; (next = next_interval (i)) && next->position <= to; )
+	i = intervals_equal (i, next) ? merge_interval_left (next) : next;
+    }
+
+  if (BUFFERP (object))
+    signal_after_change (first, to - first, to - first);
+
+  return modified ? Qt : Qnil;
+}
+
 DEFUN ("set-text-properties", Fset_text_properties,
        Sset_text_properties, 3, 4, 0,
        doc: /* Completely replace properties of text from START to END.
@@ -2468,6 +2634,7 @@ syms_of_textprop (void)
   defsubr (&Sprevious_single_property_change);
   defsubr (&Sadd_text_properties);
   defsubr (&Sput_text_property);
+  defsubr (&Sput_text_properties_bulk);
   defsubr (&Sset_text_properties);
   defsubr (&Sadd_face_text_property);
   defsubr (&Sremove_text_properties);
@@ -595,6 +595,206 @@ finalize_one_condvar (struct Lisp_CondVar *condvar)
   sys_cond_destroy (&condvar->cond);
 }
 
+
+
+/* All threads waiting for a channel wait on this condition variable,
+   whose associated mutex is the global lock.  Each change to a
+   channel broadcasts to it, and the threads that wake up then check
+   whether the channel each waits for is now ready.  */
+static sys_cond_t channel_cond;
+
+static void
+channel_wait_callback (void *arg)
+{
+  Lisp_Object *object = arg;
+  struct thread_state *self = current_thread;
+
+  self->event_object = *object;
+  /* If signaled before we started waiting, skip the wait.  */
+  if (NILP (self->error_symbol))
+    {
+      self->wait_condvar = &channel_cond;
+      /* This call could switch to another thread.  */
+      sys_cond_wait (&channel_cond, &global_lock);
+      self->wait_condvar = NULL;
+    }
+  self->event_object = Qnil;
+  post_acquire_global_lock (self);
+}
+
+/* Wait until some channel changes.  OBJECT is the channel, or list of
+   channels, that the current thread is waiting for; `thread--blocker'
+   returns it while we wait.  */
+static void
+channel_wait (Lisp_Object object)
+{
+  /* No other thread could ever change the channel, so don't hang this
+     thread forever.  */
+  if (!other_threads_p ())
+    error ("Waiting for a channel with no other threads would never return");
+  flush_stack_call_func (channel_wait_callback, &object);
+}
+
+static void
+channel_notify (void)
+{
+  sys_cond_broadcast (&channel_cond);
+}
+
+/* Remove the oldest value queued in CH and return it.  */
+static Lisp_Object
+channel_pop (struct Lisp_Channel *ch)
+{
+  Lisp_Object value = AREF (ch->values, ch->head);
+  ASET (ch->values, ch->head, Qnil);
+  ch->head = (ch->head + 1) % ASIZE (ch->values);
+  ch->count--;
+  channel_notify ();
+  return value;
+}
+
+DEFUN ("make-channel", Fmake_channel, Smake_channel, 0, 2, 0,
+       doc: /* Make a channel, and return it.
+A channel is a queue of values that threads send to it with
+`channel-send' and that other threads receive from it with
+`channel-receive', in the order they were sent.
+
+CAPACITY, if non-nil, is the number of values that the channel can
+hold before `channel-send' waits for some to be received; the default
+is 1.  NAME, if given, is the name of the channel.  The name is
+informational only.  */)
+  (Lisp_Object capacity, Lisp_Object name)
+{
+  EMACS_INT size = 1;
+  if (!NILP (capacity))
+    {
+      CHECK_FIXNUM (capacity);
+      size = XFIXNUM (capacity);
+      if (size <= 0)
+	xsignal1 (Qargs_out_of_range, capacity);
+    }
+  if (!NILP (name))
+    CHECK_STRING (name);
+
+  Lisp_Object values = make_nil_vector (size);
+  struct Lisp_Channel *ch
+    = ALLOCATE_ZEROED_PSEUDOVECTOR (struct Lisp_Channel, values,
+				    PVEC_CHANNEL);
+  ch->name = name;
+  ch->values = values;
+
+  Lisp_Object result;
+  XSETCHANNEL (result, ch);
+  return result;
+}
+
+DEFUN ("channelp", Fchannelp, Schannelp, 1, 1, 0,
+       doc: /* Return t if OBJECT is a channel.  */)
+  (Lisp_Object object)
+{
+  return CHANNELP (object) ? Qt : Qnil;
+}
+
+DEFUN ("channel-name", Fchannel_name, Schannel_name, 1, 1, 0,
+       doc: /* Return the name of CHANNEL.
+If no name was given when CHANNEL was created, return nil.  */)
+  (Lisp_Object channel)
+{
+  CHECK_CHANNEL (channel);
+  return XCHANNEL (channel)->name;
+}
+
+DEFUN ("channel-send", Fchannel_send, Schannel_send, 2, 2, 0,
+       doc: /* Send VALUE to CHANNEL.
+If CHANNEL already holds as many values as its capacity, wait until
+another thread receives one of them, or until this thread is signaled
+with `thread-signal'.
+
+Signal `channel-closed' if CHANNEL is closed.  */)
+  (Lisp_Object channel, Lisp_Object value)
+{
+  CHECK_CHANNEL (channel);
+  struct Lisp_Channel *ch = XCHANNEL (channel);
+
+  while (!ch->closed && ch->count == ASIZE (ch->values))
+    channel_wait (channel);
+  if (ch->closed)
+    xsignal1 (Qchannel_closed, channel);
+
+  ASET (ch->values, (ch->head + ch->count) % ASIZE (ch->values), value);
+  ch->count++;
+  channel_notify ();
+  return Qnil;
+}
+
+DEFUN ("channel-receive", Fchannel_receive, Schannel_receive, 1, 1, 0,
+       doc: /* Remove the oldest value sent to CHANNEL, and return it.
+If CHANNEL holds no values, wait until another thread sends one, or
+until this thread is signaled with `thread-signal'.
+
+Signal `channel-closed' if CHANNEL is closed and holds no values.  */)
+  (Lisp_Object channel)
+{
+  CHECK_CHANNEL (channel);
+  struct Lisp_Channel *ch = XCHANNEL (channel);
+
+  while (!ch->closed && ch->count == 0)
+    channel_wait (channel);
+  if (ch->count == 0)
+    xsignal1 (Qchannel_closed, channel);
+
+  return channel_pop (ch);
+}
+
+DEFUN ("channel-select", Fchannel_select, Schannel_select, 1, 1, 0,
+       doc: /* Receive a value from the first of CHANNELS that holds one.
+CHANNELS is a list of channels.  Return (CHANNEL . VALUE), where VALUE
+is the value that was removed from CHANNEL, as by `channel-receive'.
+If several channels hold values, use the one that comes first in
+CHANNELS.  If none holds values, wait until another thread sends a
+value to one of them, or until this thread is signaled with
+`thread-signal'.
+
+Closed channels that hold no values are ignored.  Signal
+`channel-closed' if all of CHANNELS are closed and hold no values.  */)
+  (Lisp_Object channels)
+{
+  Lisp_Object tail = channels;
+  FOR_EACH_TAIL (tail)
+    CHECK_CHANNEL (XCAR (tail));
+  CHECK_LIST_END (tail, channels);
+
+  for (;;)
+    {
+      bool open = false;
+      for (tail = channels; CONSP (tail); tail = XCDR (tail))
+	{
+	  struct Lisp_Channel *ch = XCHANNEL (XCAR (tail));
+	  if (ch->count > 0)
+	    return Fcons (XCAR (tail), channel_pop (ch));
+	  if (!ch->closed)
+	    open = true;
+	}
+      if (!open)
+	xsignal1 (Qchannel_closed, channels);
+      channel_wait (channels);
+    }
+}
+
+DEFUN ("channel-close", Fchannel_close, Schannel_close, 1, 1, 0,
+       doc: /* Close CHANNEL.
+After this, `channel-send' signals an error for CHANNEL, while
+`channel-receive' still returns the values that CHANNEL holds, and
+signals an error once it holds no more.  Threads waiting for CHANNEL
+are woken up.  */)
+  (Lisp_Object channel)
+{
+  CHECK_CHANNEL (channel);
+  XCHANNEL (channel)->closed = true;
+  channel_notify ();
+  return Qnil;
+}
+
 
 
 struct select_args
@@ -660,6 +860,49 @@ thread_select (select_func *func, int max_fds, fd_set *rfds,
   return sa.result;
 }
 
+struct unlocked_call_args
+{
+  void (*func) (void *);
+  void *arg;
+};
+
+static void
+really_call_unlocked (void *arg)
+{
+  struct unlocked_call_args *ua = arg;
+  struct thread_state *self = current_thread;
+  sigset_t oldset;
+
+  block_interrupt_signal (&oldset);
+  self->not_holding_lock = 1;
+  release_global_lock ();
+  restore_signal_mask (&oldset);
+
+  ua->func (ua->arg);
+
+  block_interrupt_signal (&oldset);
+  /* See really_call_select.  */
+  if (self->not_holding_lock)
+    {
+      acquire_global_lock (self);
+      self->not_holding_lock = 0;
+    }
+  restore_signal_mask (&oldset);
+}
+
+/* Call FUNC with ARG without holding the global lock, so that other
+   Lisp threads can run meanwhile, on other processors if there are
+   any.  FUNC must not use any Lisp object or other data shared by the
+   threads, not even to read it, since other threads can change it and
+   garbage collection can move it; it should work on plain C data that
+   its caller has made a copy of.  */
+void
+thread_call_unlocked (void (*func) (void *), void *arg)
+{
+  struct unlocked_call_args ua = { func, arg };
+  flush_stack_call_func (really_call_unlocked, &ua);
+}
+
 
 
 static void
@@ -1166,6 +1409,7 @@ in_current_thread (void)
 init_threads (void)
 {
   sys_cond_init (&main_thread.s.thread_condvar);
+  sys_cond_init (&channel_cond);
   sys_mutex_init (&global_lock);
   sys_mutex_lock (&global_lock);
   current_thread = &main_thread.s;
@@ -1202,6 +1446,12 @@ syms_of_threads (void)
       defsubr (&Scondition_notify);
       defsubr (&Scondition_mutex);
       defsubr (&Scondition_name);
+      defsubr (&Smake_channel);
+      defsubr (&Schannel_name);
+      defsubr (&Schannel_send);
+      defsubr (&Schannel_receive);
+      defsubr (&Schannel_select);
+      defsubr (&Schannel_close);
       defsubr (&Sthread_last_error);
 
       staticpro (&last_thread_error);
@@ -1213,6 +1463,16 @@ syms_of_threads (void)
   DEFSYM (Qthreadp, "threadp");
   DEFSYM (Qmutexp, "mutexp");
   DEFSYM (Qcondition_variable_p, "condition-variable-p");
+  DEFSYM (Qchannelp, "channelp");
+  /* Like 'threadp' and 'mutexp', this is defined even without thread
+     support, for 'cl-typep'.  */
+  defsubr (&Schannelp);
+
+  DEFSYM (Qchannel_closed, "channel-closed");
+  Fput (Qchannel_closed, Qerror_conditions,
+	list (Qchannel_closed, Qerror));
+  Fput (Qchannel_closed, Qerror_message,
+	build_string ("Channel is closed"));
 
   DEFVAR_LISP ("main-thread", Vmain_thread,
     doc: /* The main thread of Emacs.  */);
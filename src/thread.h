@@ -181,6 +181,10 @@ #define waiting_for_user_input_p (current_thread->m_waiting_for_user_input_p)
   bool m_waiting_for_input;
 #define waiting_for_input (current_thread->m_waiting_for_input)
 
+  /* What this thread is waiting for, an enum profiler_wait_reason.  */
+  int m_profiler_wait;
+#define profiler_wait (current_thread->m_profiler_wait)
+
   /* For longjmp to where kbd input is being done.  This is per-thread
      so that if more than one thread calls read_char, they don't
      clobber each other's getcjmp, which will cause
@@ -316,6 +320,47 @@ XCONDVAR (Lisp_Object a)
   return XUNTAG (a, Lisp_Vectorlike, struct Lisp_CondVar);
 }
 
+/* A bounded queue of Lisp values, used to pass values between
+   threads.  */
+struct Lisp_Channel
+{
+  union vectorlike_header header;
+
+  /* The name of the channel, or nil.  */
+  Lisp_Object name;
+
+  /* The queued values.  This vector is used as a ring buffer whose
+     size is the capacity of the channel.  */
+  Lisp_Object values;
+
+  /* The index in VALUES of the oldest queued value, and the number of
+     queued values.  */
+  ptrdiff_t head;
+  ptrdiff_t count;
+
+  /* True if the channel was closed by `channel-close'.  */
+  bool closed;
+} GCALIGNED_STRUCT;
+
+INLINE bool
+CHANNELP (Lisp_Object a)
+{
+  return PSEUDOVECTORP (a, PVEC_CHANNEL);
+}
+
+INLINE void
+CHECK_CHANNEL (Lisp_Object x)
+{
+  CHECK_TYPE (CHANNELP (x), Qchannelp, x);
+}
+
+INLINE struct Lisp_Channel *
+XCHANNEL (Lisp_Object a)
+{
+  eassert (CHANNELP (a));
+  return XUNTAG (a, Lisp_Vectorlike, struct Lisp_Channel);
+}
+
 extern struct thread_state *current_thread;
 extern struct thread_state *all_threads;
 
@@ -337,6 +382,15 @@ XCONDVAR (Lisp_Object a)
 		    sigset_t *sigmask);
 
 bool thread_check_current_buffer (struct buffer *);
+extern void thread_call_unlocked (void (*) (void *), void *);
+
+/* Return true if there are Lisp threads other than the current one,
+   which could run while it doesn't hold the global lock.  */
+INLINE bool
+other_threads_p (void)
+{
+  return all_threads->next_thread != NULL;
+}
 
 INLINE_HEADER_END
 
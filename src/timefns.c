@@ -482,7 +482,7 @@ mpz_time (mpz_t const z, time_t *t)
 /* Return a valid timespec (S, N) if S is in time_t range,
    an invalid timespec otherwise.  */
 static struct timespec
-s_ns_to_timespec (intmax_t s, long int ns)
+s_ns_to_timespec (intwide_t s, long int ns)
 {
   time_t sec;
   long int nsec = ckd_add (&sec, s, 0) ? -1 : ns;
@@ -640,6 +640,23 @@ decode_float_time (double t, enum cform cform)
 static Lisp_Object
 ticks_hz_list4 (Lisp_Object ticks, Lisp_Object hz)
 {
+  /* For speed, use intwide_t arithmetic if it will do.  */
+  intwide_t iticks, ihz, ips;
+  if (FASTER_TIMEFNS
+      && integer_to_intwide (ticks, &iticks)
+      && integer_to_intwide (hz, &ihz)
+      && !ckd_mul (&ips, iticks, TRILLION))
+    {
+      ips = ips / ihz - (ips % ihz < 0);
+      intwide_t s = ips / TRILLION - (ips % TRILLION < 0);
+      int_fast64_t fullps = ips - s * TRILLION;
+      intwide_t hi = s / (1 << LO_TIME_BITS) - (s % (1 << LO_TIME_BITS) < 0);
+      return list4 (make_intwide (hi),
+		    make_fixnum (s - hi * (1 << LO_TIME_BITS)),
+		    make_fixnum (fullps / 1000000),
+		    make_fixnum (fullps % 1000000));
+    }
+
   /* mpz[0] = floor ((ticks * trillion) / hz).  */
   mpz_t const *zticks = bignum_integer (&mpz[0], ticks);
 #if FASTER_TIMEFNS && TRILLION <= ULONG_MAX
@@ -697,12 +714,12 @@ timespec_mpz (struct timespec t)
 static Lisp_Object
 timespec_ticks (struct timespec t)
 {
-  /* For speed, use intmax_t arithmetic if it will do.  */
-  intmax_t accum;
+  /* For speed, use intwide_t arithmetic if it will do.  */
+  intwide_t accum;
   if (FASTER_TIMEFNS
       && !ckd_mul (&accum, t.tv_sec, TIMESPEC_HZ)
       && !ckd_add (&accum, accum, t.tv_nsec))
-    return make_int (accum);
+    return make_intwide (accum);
 
   /* Fall back on bignum arithmetic.  */
   timespec_mpz (t);
@@ -738,7 +755,7 @@ ticks_hz_hz_ticks (struct ticks_hz t, Lisp_Object hz)
       /* Prefer non-bignum arithmetic to speed up common cases.  */
       if (FASTER_TIMEFNS && FIXNUMP (t.hz))
 	{
-	  /* Reduce T.hz and HZ by their GCD, to avoid some intmax_t
+	  /* Reduce T.hz and HZ by their GCD, to avoid some intwide_t
 	     overflows that would occur in T.ticks * HZ.  */
 	  EMACS_INT ithz = XFIXNUM (t.hz), ihz = XFIXNUM (hz);
 	  EMACS_INT d = emacs_gcd (ithz, ihz);
@@ -747,9 +764,9 @@ ticks_hz_hz_ticks (struct ticks_hz t, Lisp_Object hz)
 
 	  if (FIXNUMP (t.ticks))
 	    {
-	      intmax_t ticks;
+	      intwide_t ticks;
 	      if (!ckd_mul (&ticks, XFIXNUM (t.ticks), ihz))
-		return make_int (ticks / ithz - (ticks % ithz < 0));
+		return make_intwide (ticks / ithz - (ticks % ithz < 0));
 	    }
 
 	  t.hz = make_fixnum (ithz);
@@ -847,8 +864,8 @@ decode_time_components (Lisp_Object high, Lisp_Object low,
 
   if (FASTER_TIMEFNS && FIXNUMP (high) && FIXNUMP (low))
     {
-      /* Use intmax_t arithmetic if the tick count fits.  */
-      intmax_t iticks;
+      /* Use intwide_t arithmetic if the tick count fits.  */
+      intwide_t iticks;
       bool v = false;
       v |= ckd_mul (&iticks, XFIXNUM (high), 1 << LO_TIME_BITS);
       v |= ckd_add (&iticks, iticks, XFIXNUM (low) + s_from_us_ps);
@@ -875,7 +892,7 @@ decode_time_components (Lisp_Object high, Lisp_Object low,
 
 	  if (!v)
 	    return (struct err_time) {
-	      .time = decode_ticks_hz (make_int (iticks), hz, cform)
+	      .time = decode_ticks_hz (make_intwide (iticks), hz, cform)
 	    };
 	}
     }
@@ -1079,7 +1096,17 @@ lispint_arith (Lisp_Object a, Lisp_Object b, bool subtract)
 	return make_int (subtract
 			 ? XFIXNUM (a) - XFIXNUM (b)
 			 : XFIXNUM (a) + XFIXNUM (b));
+    }
 
+  /* For speed, use intwide_t arithmetic if it will do.  */
+  intwide_t ia, ib, r;
+  if (FASTER_TIMEFNS
+      && integer_to_intwide (a, &ia) && integer_to_intwide (b, &ib)
+      && !(subtract ? ckd_sub (&r, ia, ib) : ckd_add (&r, ia, ib)))
+    return make_intwide (r);
+
+  if (FASTER_TIMEFNS && FIXNUMP (b))
+    {
       /* For speed, use mpz_add_ui/mpz_sub_ui if it will do.  */
       if (eabs (XFIXNUM (b)) <= ULONG_MAX)
 	{
@@ -20,9 +20,19 @@ Copyright (C) 2021-2025 Free Software Foundation, Inc.
 along with GNU Emacs.  If not, see <https://www.gnu.org/licenses/>.  */
 
 #include <config.h>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+
+#include <ignore-value.h>
+#include <nproc.h>
+
 #include "lisp.h"
 #include "buffer.h"
 #include "coding.h"
+#include "process.h"
+#include "probes.h"
 
 #include "treesit.h"
 
@@ -472,10 +482,53 @@ load_tree_sitter_if_necessary (bool required)
 #endif
 }
 
+/* Tree-sitter also allocates memory in the thread that parses in the
+   background (see treesit_start_background_parse).  That thread must
+   not use xmalloc and friends, which can signal an error and record
+   the allocation for the profiler, so it uses the C library directly
+   and gives up if memory is exhausted, like tree-sitter's own
+   allocator.  */
+
+static void *
+treesit_malloc_wrapper (size_t size)
+{
+  if (in_current_thread ())
+    return xmalloc (size);
+  void *p = malloc (size);
+  if (!p)
+    emacs_abort ();
+  return p;
+}
+
 static void *
 treesit_calloc_wrapper (size_t n, size_t size)
 {
-  return xzalloc (n * size);
+  if (in_current_thread ())
+    return xzalloc (n * size);
+  void *p = calloc (n, size);
+  if (!p)
+    emacs_abort ();
+  return p;
+}
+
+static void *
+treesit_realloc_wrapper (void *block, size_t size)
+{
+  if (in_current_thread ())
+    return xrealloc (block, size);
+  void *p = realloc (block, size);
+  if (!p)
+    emacs_abort ();
+  return p;
+}
+
+static void
+treesit_free_wrapper (void *block)
+{
+  if (in_current_thread ())
+    xfree (block);
+  else
+    free (block);
 }
 
 static void
@@ -484,7 +537,8 @@ treesit_initialize (void)
   if (!treesit_initialized)
     {
       load_tree_sitter_if_necessary (true);
-      ts_set_allocator (xmalloc, treesit_calloc_wrapper, xrealloc, xfree);
+      ts_set_allocator (treesit_malloc_wrapper, treesit_calloc_wrapper,
+			treesit_realloc_wrapper, treesit_free_wrapper);
       treesit_initialized = true;
     }
 }
@@ -866,19 +920,55 @@ DEFUN ("treesit-grammar-location", Ftreesit_grammar_location,
 
 /*** Parsing functions  */
 
-static void
-treesit_check_parser (Lisp_Object obj)
+/* A reparse that runs in another thread, when the buffer is at least
+   'treesit-background-parse-threshold' bytes long.  The thread parses
+   a copy of the visible part of the buffer with a parser and tree of
+   its own, so the parser object keeps its tree, which queries use,
+   until treesit_finish_background_parse installs the new one.  The
+   edits made to the buffer in the meantime are recorded, so that they
+   can be applied to the new tree too.  */
+
+#if defined HAVE_PTHREAD && defined subprocesses && !defined WINDOWSNT
+# define TREESIT_BACKGROUND_PARSE 1
+#endif
+
+#ifdef TREESIT_BACKGROUND_PARSE
+struct treesit_background_parse
 {
-  CHECK_TS_PARSER (obj);
-  if (XTS_PARSER (obj)->deleted)
-    xsignal1 (Qtreesit_parser_deleted, obj);
-}
+  /* The parser object that the new tree is for.  */
+  struct Lisp_TS_Parser *parser;
+  /* The tree-sitter parser, old tree and text that the thread uses.  */
+  TSParser *ts_parser;
+  TSTree *old_tree;
+  unsigned char *text;
+  uint32_t text_bytes;
+  /* The new tree, or NULL if the parse failed.  */
+  TSTree *new_tree;
+  /* Whether the thread has taken this job, and whether it is done.
+     Like the list of jobs, these are protected by
+     TREESIT_JOB_MUTEX.  */
+  bool started, done;
+  /* The edits made to the buffer since the text was copied.  Only the
+     main thread uses these.  */
+  TSInputEdit *edits;
+  ptrdiff_t nedits, edits_size;
+  struct treesit_background_parse *next;
+};
+
+/* All the background parses that have not been finished, the mutex
+   that protects them, and the condition variable that is signaled
+   when one is added or done.  */
+static struct treesit_background_parse *treesit_jobs;
+static sys_mutex_t treesit_job_mutex;
+static sys_cond_t treesit_job_cond;
+
+/* The pipe that the thread writes a byte to when it is done with a
+   job, to wake up wait_reading_process_output.  */
+static int treesit_job_pipe[2] = { -1, -1 };
+#endif
 
-/* An auxiliary function that saves a few lines of code.  Assumes TREE
-   is not NULL.  START_BYTE, OLD_END_BYTE, NEW_END_BYTE must not be
-   larger than UINT32_MAX.  */
 static inline void
-treesit_tree_edit_1 (TSTree *tree, ptrdiff_t start_byte,
+treesit_tree_edit_1 (struct Lisp_TS_Parser *parser, ptrdiff_t start_byte,
 		     ptrdiff_t old_end_byte, ptrdiff_t new_end_byte)
 {
   eassert (start_byte >= 0);
@@ -892,9 +982,97 @@ treesit_tree_edit_1 (TSTree *tree, ptrdiff_t start_byte,
 		      (uint32_t) old_end_byte,
 		      (uint32_t) new_end_byte,
 		      dummy_point, dummy_point, dummy_point};
-  ts_tree_edit (tree, &edit);
+  ts_tree_edit (parser->tree, &edit);
+  parser->query_cache = Qnil;
+
+#ifdef TREESIT_BACKGROUND_PARSE
+  struct treesit_background_parse *job = parser->background_parse;
+  if (job)
+    {
+      if (job->nedits == job->edits_size)
+	job->edits = xpalloc (job->edits, &job->edits_size, 1, -1,
+			      sizeof *job->edits);
+      job->edits[job->nedits++] = edit;
+    }
+#endif
+}
+
+/* Edits that are at most this many bytes apart are given to
+   tree-sitter as a single edit that spans them both.  Editing the tree
+   is much cheaper than reparsing, so we only merge edits that are so
+   close that the text between them would likely be reparsed anyway.  */
+#define TREESIT_EDIT_MERGE_DISTANCE 1024
+
+/* Give the edit that PARSER has been holding back to tree-sitter.  */
+static void
+treesit_flush_pending_edit (struct Lisp_TS_Parser *parser)
+{
+  if (parser->has_pending_edit)
+    {
+      parser->has_pending_edit = false;
+      treesit_tree_edit_1 (parser, parser->pending_edit.start_byte,
+			   parser->pending_edit.old_end_byte,
+			   parser->pending_edit.new_end_byte);
+    }
+}
+
+/* Like treesit_tree_edit_1, but if the edit is close to the previous
+   one, merge the two and edit the tree once, before the next
+   reparse.  Commands such as replace-regexp otherwise edit the tree of
+   each parser once for every replacement.  */
+static void
+treesit_tree_edit (struct Lisp_TS_Parser *parser, ptrdiff_t start_byte,
+		   ptrdiff_t old_end_byte, ptrdiff_t new_end_byte)
+{
+  TSInputEdit *pending = &parser->pending_edit;
+  parser->query_cache = Qnil;
+  if (parser->has_pending_edit
+      && start_byte <= pending->new_end_byte + TREESIT_EDIT_MERGE_DISTANCE
+      && pending->start_byte <= old_end_byte + TREESIT_EDIT_MERGE_DISTANCE)
+    {
+      /* The new edit is in the coordinates of the text after the
+	 pending edit.  Its old end is mapped back to the text before
+	 the pending edit if it is after the text that edit inserted,
+	 and the end of that text moves with the new edit if the new
+	 edit is before it.  */
+      ptrdiff_t delta = pending->new_end_byte - pending->old_end_byte;
+      ptrdiff_t merged_old_end = max (pending->old_end_byte,
+				      old_end_byte - delta);
+      ptrdiff_t merged_new_end = max (new_end_byte,
+				      (pending->new_end_byte
+				       + new_end_byte - old_end_byte));
+      eassert (merged_old_end <= UINT32_MAX);
+      eassert (merged_new_end <= UINT32_MAX);
+      pending->start_byte = min (pending->start_byte, start_byte);
+      pending->old_end_byte = merged_old_end;
+      pending->new_end_byte = merged_new_end;
+      return;
+    }
+
+  treesit_flush_pending_edit (parser);
+  eassert (start_byte <= UINT32_MAX);
+  eassert (old_end_byte <= UINT32_MAX);
+  eassert (new_end_byte <= UINT32_MAX);
+  TSPoint dummy_point = {0, 0};
+  TSInputEdit edit = {(uint32_t) start_byte,
+		      (uint32_t) old_end_byte,
+		      (uint32_t) new_end_byte,
+		      dummy_point, dummy_point, dummy_point};
+  *pending = edit;
+  parser->has_pending_edit = true;
+}
+
+static void
+treesit_check_parser (Lisp_Object obj)
+{
+  CHECK_TS_PARSER (obj);
+  if (XTS_PARSER (obj)->deleted)
+    xsignal1 (Qtreesit_parser_deleted, obj);
 }
 
+/* An auxiliary function that saves a few lines of code.  Assumes TREE
+   is not NULL.  START_BYTE, OLD_END_BYTE, NEW_END_BYTE must not be
+   larger than UINT32_MAX.  */
 /* Update each parser's tree after the user made an edit.  This
    function does not parse the buffer and only updates the tree, so it
    should be very fast.  */
@@ -949,8 +1127,8 @@ treesit_record_change (ptrdiff_t start_byte, ptrdiff_t old_end_byte,
 	  eassert (start_offset <= old_end_offset);
 	  eassert (start_offset <= new_end_offset);
 
-	  treesit_tree_edit_1 (tree, start_offset, old_end_offset,
-			       new_end_offset);
+	  treesit_tree_edit (XTS_PARSER (lisp_parser), start_offset,
+			     old_end_offset, new_end_offset);
 	  XTS_PARSER (lisp_parser)->need_reparse = true;
 
 	  /* VISIBLE_BEG/END records tree-sitter's range of view in
@@ -1044,6 +1222,10 @@ treesit_sync_visible_region (Lisp_Object parser)
       return;
     }
 
+  /* The edits below are relative to the tree after the edits made
+     to the buffer.  */
+  treesit_flush_pending_edit (XTS_PARSER (parser));
+
   ptrdiff_t visible_beg = XTS_PARSER (parser)->visible_beg;
   ptrdiff_t visible_end = XTS_PARSER (parser)->visible_end;
   eassert (0 <= visible_beg);
@@ -1070,7 +1252,8 @@ treesit_sync_visible_region (Lisp_Object parser)
   if (visible_beg > BUF_BEGV_BYTE (buffer))
     {
       /* Tree-sitter sees: insert at the beginning.  */
-      treesit_tree_edit_1 (tree, 0, 0, visible_beg - BUF_BEGV_BYTE (buffer));
+      treesit_tree_edit_1 (XTS_PARSER (parser), 0, 0,
+			   visible_beg - BUF_BEGV_BYTE (buffer));
       visible_beg = BUF_BEGV_BYTE (buffer);
       eassert (visible_beg <= visible_end);
     }
@@ -1078,7 +1261,7 @@ treesit_sync_visible_region (Lisp_Object parser)
   if (visible_end < BUF_ZV_BYTE (buffer))
     {
       /* Tree-sitter sees: insert at the end.  */
-      treesit_tree_edit_1 (tree, visible_end - visible_beg,
+      treesit_tree_edit_1 (XTS_PARSER (parser), visible_end - visible_beg,
 			   visible_end - visible_beg,
 			   BUF_ZV_BYTE (buffer) - visible_beg);
       visible_end = BUF_ZV_BYTE (buffer);
@@ -1087,7 +1270,8 @@ treesit_sync_visible_region (Lisp_Object parser)
   else if (visible_end > BUF_ZV_BYTE (buffer))
     {
       /* Tree-sitter sees: delete at the end.  */
-      treesit_tree_edit_1 (tree, BUF_ZV_BYTE (buffer) - visible_beg,
+      treesit_tree_edit_1 (XTS_PARSER (parser),
+			   BUF_ZV_BYTE (buffer) - visible_beg,
 			   visible_end - visible_beg,
 			   BUF_ZV_BYTE (buffer) - visible_beg);
       visible_end = BUF_ZV_BYTE (buffer);
@@ -1097,7 +1281,8 @@ treesit_sync_visible_region (Lisp_Object parser)
   if (visible_beg < BUF_BEGV_BYTE (buffer))
     {
       /* Tree-sitter sees: delete at the beginning.  */
-      treesit_tree_edit_1 (tree, 0, BUF_BEGV_BYTE (buffer) - visible_beg, 0);
+      treesit_tree_edit_1 (XTS_PARSER (parser), 0,
+			   BUF_BEGV_BYTE (buffer) - visible_beg, 0);
       visible_beg = BUF_BEGV_BYTE (buffer);
       eassert (visible_beg <= visible_end);
     }
@@ -1241,8 +1426,264 @@ treesit_call_after_change_functions (TSTree *old_tree, TSTree *new_tree,
   unbind_to (count, Qnil);
 }
 
+#ifdef TREESIT_BACKGROUND_PARSE
+
+/* The read function for the text of a background parse.  */
+static const char *
+treesit_read_snapshot (void *payload, uint32_t byte_index,
+		       TSPoint position, uint32_t *bytes_read)
+{
+  struct treesit_background_parse *job = payload;
+  if (byte_index >= job->text_bytes)
+    {
+      *bytes_read = 0;
+      return "";
+    }
+  *bytes_read = job->text_bytes - byte_index;
+  return (const char *) job->text + byte_index;
+}
+
+static void *
+treesit_parse_thread (void *arg)
+{
+  /* Leave signal handling to the main thread.  */
+  sigset_t blocked;
+  sigfillset (&blocked);
+  pthread_sigmask (SIG_BLOCK, &blocked, NULL);
+  sys_thread_set_name ("tree-sitter parser");
+
+  sys_mutex_lock (&treesit_job_mutex);
+  for (;;)
+    {
+      struct treesit_background_parse *job = treesit_jobs;
+      while (job && job->started)
+	job = job->next;
+      if (!job)
+	{
+	  sys_cond_wait (&treesit_job_cond, &treesit_job_mutex);
+	  continue;
+	}
+      job->started = true;
+      sys_mutex_unlock (&treesit_job_mutex);
+
+      TSInput input = { job, treesit_read_snapshot, TSInputEncodingUTF8 };
+      TSTree *new_tree = ts_parser_parse (job->ts_parser, job->old_tree,
+					  input);
+
+      sys_mutex_lock (&treesit_job_mutex);
+      job->new_tree = new_tree;
+      job->done = true;
+      sys_cond_broadcast (&treesit_job_cond);
+      /* If this fails, the pipe is full and the main thread will be
+	 woken up anyway.  */
+      char dummy = 0;
+      ignore_value (write (treesit_job_pipe[1], &dummy, 1));
+    }
+  return NULL;
+}
+
+static void treesit_finish_done_parses (int, void *);
+
+/* Start the thread that parses in the background, if not yet done.
+   Return false if that isn't possible.  */
+static bool
+treesit_init_background_parse (void)
+{
+  static bool initialized, failed;
+  if (initialized)
+    return true;
+  if (failed)
+    return false;
+
+  int fds[2];
+  if (emacs_pipe (fds) < 0)
+    {
+      failed = true;
+      return false;
+    }
+  if (FD_SETSIZE <= fds[0]
+      || fcntl (fds[0], F_SETFL, O_NONBLOCK) != 0
+      || fcntl (fds[1], F_SETFL, O_NONBLOCK) != 0)
+    {
+      emacs_close (fds[0]);
+      emacs_close (fds[1]);
+      failed = true;
+      return false;
+    }
+  treesit_job_pipe[0] = fds[0];
+  treesit_job_pipe[1] = fds[1];
+  sys_mutex_init (&treesit_job_mutex);
+  sys_cond_init (&treesit_job_cond);
+
+  sys_thread_t thr;
+  if (!sys_thread_create (&thr, treesit_parse_thread, NULL))
+    {
+      failed = true;
+      return false;
+    }
+  add_non_keyboard_read_fd (treesit_job_pipe[0], treesit_finish_done_parses,
+			    NULL);
+  initialized = true;
+  return true;
+}
+
+/* If PARSER's buffer is large enough according to
+   'treesit-background-parse-threshold', start reparsing it in the
+   background and return true.  Otherwise return false.  PARSER must
+   have a tree and no background parse, and its visible region must
+   be in sync with the buffer.  */
+static bool
+treesit_start_background_parse (Lisp_Object parser)
+{
+  struct Lisp_TS_Parser *p = XTS_PARSER (parser);
+  ptrdiff_t bytes = p->visible_end - p->visible_beg;
+  if (!FIXNATP (Vtreesit_background_parse_threshold)
+      || bytes < XFIXNAT (Vtreesit_background_parse_threshold)
+      || !treesit_init_background_parse ())
+    return false;
+
+  struct treesit_background_parse *job = xzalloc (sizeof *job);
+  job->parser = p;
+  job->ts_parser = ts_parser_new ();
+  ts_parser_set_language (job->ts_parser, ts_parser_language (p->parser));
+  uint32_t nranges;
+  const TSRange *ranges = ts_parser_included_ranges (p->parser, &nranges);
+  ts_parser_set_included_ranges (job->ts_parser, ranges, nranges);
+  job->old_tree = ts_tree_copy (p->tree);
+
+  /* Copy the visible part of the buffer, around the gap.  */
+  struct buffer *buffer = XBUFFER (p->buffer);
+  job->text = xmalloc (bytes);
+  job->text_bytes = bytes;
+  ptrdiff_t gpt = clip_to_bounds (p->visible_beg, BUF_GPT_BYTE (buffer),
+				  p->visible_end);
+  memcpy (job->text, BUF_BYTE_ADDRESS (buffer, p->visible_beg),
+	  gpt - p->visible_beg);
+  memcpy (job->text + (gpt - p->visible_beg), BUF_BYTE_ADDRESS (buffer, gpt),
+	  p->visible_end - gpt);
+
+  p->background_parse = job;
+  p->need_reparse = false;
+
+  sys_mutex_lock (&treesit_job_mutex);
+  job->next = treesit_jobs;
+  treesit_jobs = job;
+  sys_cond_broadcast (&treesit_job_cond);
+  sys_mutex_unlock (&treesit_job_mutex);
+  return true;
+}
+
+/* Forget about JOB, which must be done, and free it.  Return the new
+   tree it made, which the caller must free.  */
+static TSTree *
+treesit_free_background_parse (struct treesit_background_parse *job)
+{
+  sys_mutex_lock (&treesit_job_mutex);
+  eassert (job->done);
+  struct treesit_background_parse **prev = &treesit_jobs;
+  while (*prev != job)
+    prev = &(*prev)->next;
+  *prev = job->next;
+  sys_mutex_unlock (&treesit_job_mutex);
+
+  TSTree *new_tree = job->new_tree;
+  job->parser->background_parse = NULL;
+  ts_tree_delete (job->old_tree);
+  ts_parser_delete (job->ts_parser);
+  xfree (job->text);
+  xfree (job->edits);
+  xfree (job);
+  return new_tree;
+}
+
+/* Wait until the background parse of PARSER, if any, is done and
+   throw it away.  */
+static void
+treesit_cancel_background_parse (struct Lisp_TS_Parser *parser)
+{
+  struct treesit_background_parse *job = parser->background_parse;
+  if (!job)
+    return;
+  sys_mutex_lock (&treesit_job_mutex);
+  while (!job->done)
+    sys_cond_wait (&treesit_job_cond, &treesit_job_mutex);
+  sys_mutex_unlock (&treesit_job_mutex);
+  TSTree *new_tree = treesit_free_background_parse (job);
+  if (new_tree)
+    ts_tree_delete (new_tree);
+}
+
+/* If the background parse of PARSER is done, give PARSER the new tree
+   and call its after-change functions.  Return true if the parse is
+   done, or if there was none.  */
+static bool
+treesit_finish_background_parse (Lisp_Object parser)
+{
+  struct Lisp_TS_Parser *p = XTS_PARSER (parser);
+  struct treesit_background_parse *job = p->background_parse;
+  if (!job)
+    return true;
+  sys_mutex_lock (&treesit_job_mutex);
+  bool done = job->done;
+  sys_mutex_unlock (&treesit_job_mutex);
+  if (!done)
+    return false;
+
+  /* Apply the edits made since the text was copied.  Those have set
+     need_reparse again, so the new tree will be brought up to date
+     by the next reparse.  */
+  for (ptrdiff_t i = 0; job->new_tree && i < job->nedits; i++)
+    ts_tree_edit (job->new_tree, &job->edits[i]);
+  TSTree *new_tree = treesit_free_background_parse (job);
+  if (!new_tree)
+    {
+      /* See the comment for the synchronous case in
+	 treesit_ensure_parsed.  */
+      p->need_reparse = true;
+      return true;
+    }
+
+  TSTree *tree = p->tree;
+  p->tree = new_tree;
+  p->query_cache = Qnil;
+  p->timestamp++;
+  if (!p->deleted)
+    treesit_call_after_change_functions (tree, new_tree, parser);
+  ts_tree_delete (tree);
+  return true;
+}
+
+/* Install the trees of the background parses that are done.  This is
+   called when the thread writes to the pipe.  */
+static void
+treesit_finish_done_parses (int fd, void *data)
+{
+  char buf[64];
+  while (emacs_read (fd, buf, sizeof buf) == sizeof buf)
+    continue;
+
+ again:
+  sys_mutex_lock (&treesit_job_mutex);
+  struct treesit_background_parse *job = treesit_jobs;
+  while (job && !(job->done && !job->parser->within_reparse))
+    job = job->next;
+  sys_mutex_unlock (&treesit_job_mutex);
+  if (job)
+    {
+      Lisp_Object parser = make_lisp_ptr (job->parser, Lisp_Vectorlike);
+      XTS_PARSER (parser)->within_reparse = true;
+      treesit_finish_background_parse (parser);
+      XTS_PARSER (parser)->within_reparse = false;
+      goto again;
+    }
+}
+
+#endif	/* TREESIT_BACKGROUND_PARSE */
+
 /* Parse the buffer.  We don't parse until we have to.  When we have
-   to, we call this function to parse and update the tree.  */
+   to, we call this function to parse and update the tree.  If the
+   buffer is being reparsed in the background, use the tree that it
+   had before until that is done.  */
 static void
 treesit_ensure_parsed (Lisp_Object parser)
 {
@@ -1257,17 +1698,36 @@ treesit_ensure_parsed (Lisp_Object parser)
      because it might set the flag to true.  */
   treesit_sync_visible_region (parser);
 
+#ifdef TREESIT_BACKGROUND_PARSE
+  if (!treesit_finish_background_parse (parser))
+    {
+      XTS_PARSER (parser)->within_reparse = false;
+      return;
+    }
+#endif
+
   if (!XTS_PARSER (parser)->need_reparse)
     {
       XTS_PARSER (parser)->within_reparse = false;
       return;
     }
 
+#ifdef TREESIT_BACKGROUND_PARSE
+  if (XTS_PARSER (parser)->tree
+      && treesit_start_background_parse (parser))
+    {
+      XTS_PARSER (parser)->within_reparse = false;
+      return;
+    }
+#endif
+
   TSParser *treesit_parser = XTS_PARSER (parser)->parser;
   TSTree *tree = XTS_PARSER (parser)->tree;
   TSInput input = XTS_PARSER (parser)->input;
 
+  EMACS_PROBE1 (treesit_reparse_start, SSDATA (BVAR (buffer, name)));
   TSTree *new_tree = ts_parser_parse (treesit_parser, tree, input);
+  EMACS_PROBE1 (treesit_reparse_done, SSDATA (BVAR (buffer, name)));
   /* This should be very rare (impossible, really): it only happens
      when 1) language is not set (impossible in Emacs because the user
      has to supply a language to create a parser), 2) parse canceled
@@ -1283,6 +1743,7 @@ treesit_ensure_parsed (Lisp_Object parser)
     }
 
   XTS_PARSER (parser)->tree = new_tree;
+  XTS_PARSER (parser)->query_cache = Qnil;
   XTS_PARSER (parser)->need_reparse = false;
   XTS_PARSER (parser)->timestamp++;
 
@@ -1368,6 +1829,7 @@ make_treesit_parser (Lisp_Object buffer, TSParser *parser,
   lisp_parser->tag = tag;
   lisp_parser->last_set_ranges = Qnil;
   lisp_parser->embed_level = Qnil;
+  lisp_parser->query_cache = Qnil;
   lisp_parser->buffer = buffer;
   lisp_parser->parser = parser;
   lisp_parser->tree = tree;
@@ -1380,6 +1842,8 @@ make_treesit_parser (Lisp_Object buffer, TSParser *parser,
   lisp_parser->deleted = false;
   lisp_parser->need_to_gc_buffer = false;
   lisp_parser->within_reparse = false;
+  lisp_parser->background_parse = NULL;
+  lisp_parser->has_pending_edit = false;
   eassert (lisp_parser->visible_beg <= lisp_parser->visible_end);
   return make_lisp_ptr (lisp_parser, Lisp_Vectorlike);
 }
@@ -1412,6 +1876,7 @@ make_treesit_query (Lisp_Object query, Lisp_Object language)
   lisp_query->source = query;
   lisp_query->query = NULL;
   lisp_query->cursor = NULL;
+  lisp_query->uses_pred = false;
   return make_lisp_ptr (lisp_query, Lisp_Vectorlike);
 }
 
@@ -1421,6 +1886,9 @@ treesit_delete_parser (struct Lisp_TS_Parser *lisp_parser)
 {
   if (lisp_parser->need_to_gc_buffer)
     Fkill_buffer (lisp_parser->buffer);
+#ifdef TREESIT_BACKGROUND_PARSE
+  treesit_cancel_background_parse (lisp_parser);
+#endif
   ts_tree_delete (lisp_parser->tree);
   ts_parser_delete (lisp_parser->parser);
 }
@@ -1488,6 +1956,37 @@ treesit_ensure_query_cursor (Lisp_Object query)
    NULL if error occurs, in which case ERROR_OFFSET and ERROR_TYPE are
    bound.  If error occurs, return NULL, and assign SIGNAL_SYMBOL and
    SIGNAL_DATA accordingly.  */
+/* Return whether any pattern of TREESIT_QUERY uses the `pred'
+   predicate, whose result can depend on anything.  */
+static bool
+treesit_query_uses_pred_p (TSQuery *treesit_query)
+{
+  uint32_t patterns_count = ts_query_pattern_count (treesit_query);
+  for (uint32_t i = 0; i < patterns_count; i++)
+    {
+      uint32_t len;
+      const TSQueryPredicateStep *steps
+	= ts_query_predicates_for_pattern (treesit_query, i, &len);
+      /* The first step of each predicate is its name.  */
+      bool first = true;
+      for (uint32_t idx = 0; idx < len; idx++)
+	{
+	  if (first && steps[idx].type == TSQueryPredicateStepTypeString)
+	    {
+	      uint32_t str_len;
+	      const char *str
+		= ts_query_string_value_for_id (treesit_query,
+						steps[idx].value_id,
+						&str_len);
+	      if (str_len == 4 && memcmp (str, "pred", 4) == 0)
+		return true;
+	    }
+	  first = steps[idx].type == TSQueryPredicateStepTypeDone;
+	}
+    }
+  return false;
+}
+
 static TSQuery *
 treesit_ensure_query_compiled (Lisp_Object query, Lisp_Object *signal_symbol,
 			       Lisp_Object *signal_data)
@@ -1535,6 +2034,9 @@ treesit_ensure_query_compiled (Lisp_Object query, Lisp_Object *signal_symbol,
 							source);
     }
   XTS_COMPILED_QUERY (query)->query = treesit_query;
+  if (treesit_query)
+    XTS_COMPILED_QUERY (query)->uses_pred
+      = treesit_query_uses_pred_p (treesit_query);
   return treesit_query;
 }
 
@@ -2942,6 +3444,29 @@ treesit_predicate_capture_name_to_text (Lisp_Object name,
   return true;
 }
 
+/* Return whether the text spanned by NODE is STRING, in the sense of
+   'string-equal', without making a string of the text.  */
+static bool
+treesit_node_text_equal (Lisp_Object node, Lisp_Object string)
+{
+  struct Lisp_TS_Parser *parser = XTS_PARSER (XTS_NODE (node)->parser);
+  struct buffer *buf = XBUFFER (parser->buffer);
+  TSNode treesit_node = XTS_NODE (node)->node;
+  ptrdiff_t start = parser->visible_beg + ts_node_start_byte (treesit_node);
+  ptrdiff_t end = parser->visible_beg + ts_node_end_byte (treesit_node);
+  if (end - start != SBYTES (string))
+    return false;
+
+  /* Compare the text before the gap and the text after it.  */
+  ptrdiff_t gpt = clip_to_bounds (start, BUF_GPT_BYTE (buf), end);
+  if (memcmp (BUF_BYTE_ADDRESS (buf, start), SDATA (string), gpt - start)
+      || memcmp (BUF_BYTE_ADDRESS (buf, gpt), SDATA (string) + (gpt - start),
+		 end - gpt))
+    return false;
+  return (buf_bytepos_to_charpos (buf, end)
+	  - buf_bytepos_to_charpos (buf, start)) == SCHARS (string);
+}
+
 /* Handles predicate (#equal A B).  Return true if A equals B; return
    false otherwise.  A and B can be either string, or a capture name.
    The capture name evaluates to the text its captured node spans in
@@ -2960,22 +3485,33 @@ treesit_predicate_equal (Lisp_Object args, struct capture_range captures,
     }
   Lisp_Object arg1 = XCAR (args);
   Lisp_Object arg2 = XCAR (XCDR (args));
-  Lisp_Object text1 = arg1;
-  Lisp_Object text2 = arg2;
-  if (SYMBOLP (arg1))
+  if (!SYMBOLP (arg1) && !SYMBOLP (arg2))
+    return !NILP (Fstring_equal (arg1, arg2));
+
+  /* Compare the text of a captured node with the other argument
+     directly in the buffer.  Only if both arguments are captures does
+     one of them need to be made into a string.  */
+  if (!SYMBOLP (arg1))
     {
-      if (!treesit_predicate_capture_name_to_text (arg1, captures, &text1,
-						   signal_data))
-	return false;
+      Lisp_Object tem = arg1;
+      arg1 = arg2;
+      arg2 = tem;
     }
+  Lisp_Object node;
+  if (!treesit_predicate_capture_name_to_node (arg1, captures, &node,
+					       signal_data))
+    return false;
+  Lisp_Object text = arg2;
   if (SYMBOLP (arg2))
     {
-      if (!treesit_predicate_capture_name_to_text (arg2, captures, &text2,
+      if (!treesit_predicate_capture_name_to_text (arg2, captures, &text,
 						   signal_data))
 	return false;
     }
+  else
+    CHECK_STRING (text);
 
-  return !NILP (Fstring_equal (text1, text2));
+  return treesit_node_text_equal (node, text);
 }
 
 /* Handles predicate (#match "regexp" @node).  Return true if "regexp"
@@ -3242,6 +3778,200 @@ treesit_initialize_query (Lisp_Object query, const TSLanguage *lang,
     }
 }
 
+/* The number of results that a parser's query_cache holds.  */
+enum { TREESIT_QUERY_CACHE_SIZE = 64 };
+
+/* If PARSER's query cache has the result of querying NODE with QUERY
+   between BEG and END, with NODE_ONLY and GROUPED, set *RESULT to it
+   and return true.  */
+static bool
+treesit_query_cache_lookup (Lisp_Object parser, Lisp_Object query,
+			    TSNode node, Lisp_Object beg, Lisp_Object end,
+			    Lisp_Object node_only, Lisp_Object grouped,
+			    Lisp_Object *result)
+{
+  for (Lisp_Object tail = XTS_PARSER (parser)->query_cache;
+       CONSP (tail); tail = XCDR (tail))
+    {
+      Lisp_Object entry = XCAR (tail);
+      if (EQ (AREF (entry, 0), query)
+	  && EQ (AREF (entry, 2), beg)
+	  && EQ (AREF (entry, 3), end)
+	  && NILP (AREF (entry, 4)) == NILP (node_only)
+	  && NILP (AREF (entry, 5)) == NILP (grouped)
+	  && ts_node_eq (XTS_NODE (AREF (entry, 1))->node, node))
+	{
+	  *result = AREF (entry, 6);
+	  return true;
+	}
+    }
+  return false;
+}
+
+/* Return a copy of CAPTURES, a result of 'treesit-query-capture', that
+   shares only the nodes with it.  GROUPED says whether CAPTURES is a
+   list of match groups.  */
+static Lisp_Object
+treesit_copy_captures (Lisp_Object captures, bool grouped)
+{
+  Lisp_Object result = Qnil;
+  for (Lisp_Object tail = captures; CONSP (tail); tail = XCDR (tail))
+    {
+      Lisp_Object elt = XCAR (tail);
+      if (grouped)
+	elt = treesit_copy_captures (elt, false);
+      else if (CONSP (elt))
+	elt = Fcons (XCAR (elt), XCDR (elt));
+      result = Fcons (elt, result);
+    }
+  return Fnreverse (result);
+}
+
+/* Record RESULT in PARSER's query cache.  */
+static void
+treesit_query_cache_store (Lisp_Object parser, Lisp_Object query,
+			   Lisp_Object node, Lisp_Object beg, Lisp_Object end,
+			   Lisp_Object node_only, Lisp_Object grouped,
+			   Lisp_Object result)
+{
+  Lisp_Object entry = CALLN (Fvector, query, node, beg, end, node_only,
+			     grouped,
+			     treesit_copy_captures (result, !NILP (grouped)));
+  Lisp_Object cache = Fcons (entry, XTS_PARSER (parser)->query_cache);
+  XTS_PARSER (parser)->query_cache = cache;
+  for (int i = 1; i < TREESIT_QUERY_CACHE_SIZE && CONSP (cache); i++)
+    cache = XCDR (cache);
+  if (CONSP (cache))
+    XSETCDR (cache, Qnil);
+}
+
+/* A source of query matches: a query cursor that runs a query, or the
+   matches that a query thread recorded.  */
+struct treesit_match_source
+{
+  /* If non-NULL, get the matches from this cursor.  */
+  TSQueryCursor *cursor;
+  /* Otherwise, from this job, starting with the match and capture at
+     these indices.  */
+  struct treesit_query_job *job;
+  ptrdiff_t next_match, next_capture;
+};
+
+static bool treesit_next_match (struct treesit_match_source *,
+				TSQueryMatch *);
+
+/* Return the captures of the matches of TREESIT_QUERY, a query for the
+   language of LISP_PARSER, that SOURCE yields, as 'treesit-query-capture'
+   does with NODE_ONLY and GROUPED.  If a predicate signals an error,
+   set *PREDICATE_SIGNAL_DATA to its data and return what was collected
+   until then.  */
+static Lisp_Object
+treesit_collect_captures (Lisp_Object lisp_parser, TSQuery *treesit_query,
+			  struct treesit_match_source *source,
+			  Lisp_Object node_only, Lisp_Object grouped,
+			  Lisp_Object *predicate_signal_data)
+{
+  TSQueryMatch match;
+
+  /* Go over each match, collect captures and predicates.  Include the
+     captures in the RESULT list unconditionally as we get them, then
+     test for predicates.  If predicates pass, then all good, if
+     predicates don't pass, revert the result back to the result
+     before this loop (PREV_RESULT).  (Predicates control the entire
+     match.)  This way we don't need to create a list of captures in
+     every for loop and nconc it to RESULT every time.  That is indeed
+     the initial implementation in which Yoav found nconc being the
+     bottleneck (98.4% of the running time spent on nconc).  */
+  uint32_t patterns_count = ts_query_pattern_count (treesit_query);
+  Lisp_Object result = Qnil;
+  Lisp_Object prev_result = result;
+  Lisp_Object predicates_table = make_vector (patterns_count, Qt);
+
+  struct buffer *old_buf = current_buffer;
+  set_buffer_internal (XBUFFER (XTS_PARSER (lisp_parser)->buffer));
+
+  while (treesit_next_match (source, &match))
+    {
+      /* Depends on the value of GROUPED, we have two modes of
+         operation.
+
+         If GROUPED is nil (mode 1), we return a list of captures; in
+         this case, we append the captures first, and revert back if the
+         captures don't match.
+
+         If GROUPED is non-nil (mode 2), we return a list of match
+         groups; in this case, we collect captures into a list first,
+         and append to the results after verifying that the group
+         matches.  */
+
+      /* Mode 1: Record the checkpoint that we may roll back to.  */
+      prev_result = result;
+      /* Mode 2: Create a list storing captures of this match group.  */
+      Lisp_Object match_group = Qnil;
+      /* 1. Get captured nodes.  */
+      const TSQueryCapture *captures = match.captures;
+      for (int idx = 0; idx < match.capture_count; idx++)
+	{
+	  uint32_t capture_name_len;
+	  TSQueryCapture capture = captures[idx];
+	  Lisp_Object captured_node = make_treesit_node (lisp_parser,
+							 capture.node);
+
+	  Lisp_Object cap;
+	  if (NILP (node_only))
+	    {
+	      const char *capture_name
+		= ts_query_capture_name_for_id (treesit_query, capture.index,
+						&capture_name_len);
+	      cap = Fcons (intern_c_string_1 (capture_name, capture_name_len),
+			   captured_node);
+	    }
+	  else
+	    cap = captured_node;
+
+	  if (NILP (grouped))
+	    result = Fcons (cap, result); /* Mode 1. */
+	  else
+	    match_group = Fcons (cap, match_group); /* Mode 2. */
+	}
+      /* 2. Get predicates and check whether this match can be
+         included in the result list.  */
+      Lisp_Object predicates = AREF (predicates_table, match.pattern_index);
+      if (BASE_EQ (predicates, Qt))
+	{
+	  predicates = treesit_predicates_for_pattern (treesit_query,
+						       match.pattern_index);
+	  ASET (predicates_table, match.pattern_index, predicates);
+	}
+
+      /* captures_lisp = Fnreverse (captures_lisp); */
+      /* Mode 1.  */
+      struct capture_range captures_range = { result, prev_result };
+      /* Mode 2.  */
+      if (!NILP (grouped))
+	{
+	  captures_range.start = match_group;
+	  captures_range.end = Qnil;
+	}
+      bool match
+	= treesit_eval_predicates (captures_range, predicates,
+				   predicate_signal_data);
+
+      if (!NILP (*predicate_signal_data))
+	break;
+
+      /* Mode 1: Predicates didn't pass, roll back.  */
+      if (!match && NILP (grouped))
+	result = prev_result;
+      /* Mode 2: Predicates pass, add this match group.  */
+      if (match && !NILP (grouped))
+	result = Fcons (Fnreverse (match_group), result);
+    }
+
+  set_buffer_internal (old_buf);
+  return Fnreverse (result);
+}
+
 DEFUN ("treesit-query-capture",
        Ftreesit_query_capture,
        Streesit_query_capture, 2, 6, 0,
@@ -3308,6 +4038,17 @@ DEFUN ("treesit-query-capture",
   if (!NILP (end))
     treesit_check_position (end, buf);
 
+  /* Querying a range with a compiled query is what font-lock does for
+     each chunk it fontifies, so if that was done before and the tree
+     hasn't changed since, reuse the result.  */
+  bool use_cache = (TS_COMPILED_QUERY_P (query)
+		    && !NILP (beg) && !NILP (end));
+  Lisp_Object cached;
+  if (use_cache
+      && treesit_query_cache_lookup (lisp_parser, query, treesit_node,
+				     beg, end, node_only, grouped, &cached))
+    return treesit_copy_captures (cached, !NILP (grouped));
+
   /* Initialize query objects.  At the end of this block, we should
      have a working TSQuery and a TSQueryCursor.  */
   TSQuery *treesit_query;
@@ -3341,117 +4082,412 @@ DEFUN ("treesit-query-capture",
 
   /* Execute query.  */
   ts_query_cursor_exec (cursor, treesit_query, treesit_node);
-  TSQueryMatch match;
-
-  /* Go over each match, collect captures and predicates.  Include the
-     captures in the RESULT list unconditionally as we get them, then
-     test for predicates.  If predicates pass, then all good, if
-     predicates don't pass, revert the result back to the result
-     before this loop (PREV_RESULT).  (Predicates control the entire
-     match.)  This way we don't need to create a list of captures in
-     every for loop and nconc it to RESULT every time.  That is indeed
-     the initial implementation in which Yoav found nconc being the
-     bottleneck (98.4% of the running time spent on nconc).  */
-  uint32_t patterns_count = ts_query_pattern_count (treesit_query);
-  Lisp_Object result = Qnil;
-  Lisp_Object prev_result = result;
-  Lisp_Object predicates_table = make_vector (patterns_count, Qt);
+  struct treesit_match_source source = { cursor, NULL, 0, 0 };
   Lisp_Object predicate_signal_data = Qnil;
+  Lisp_Object result
+    = treesit_collect_captures (lisp_parser, treesit_query, &source,
+				node_only, grouped, &predicate_signal_data);
 
-  struct buffer *old_buf = current_buffer;
-  set_buffer_internal (buf);
+  use_cache = (use_cache && NILP (predicate_signal_data)
+	       && !XTS_COMPILED_QUERY (query)->uses_pred);
 
-  while (ts_query_cursor_next_match (cursor, &match))
+  /* Final clean up.  */
+  if (needs_to_free_query_and_cursor)
     {
-      /* Depends on the value of GROUPED, we have two modes of
-         operation.
+      ts_query_delete (treesit_query);
+      ts_query_cursor_delete (cursor);
+    }
 
-         If GROUPED is nil (mode 1), we return a list of captures; in
-         this case, we append the captures first, and revert back if the
-         captures don't match.
+  /* Some capture predicate signaled an error.  */
+  if (!NILP (predicate_signal_data))
+    xsignal (Qtreesit_query_error, predicate_signal_data);
 
-         If GROUPED is non-nil (mode 2), we return a list of match
-         groups; in this case, we collect captures into a list first,
-         and append to the results after verifying that the group
-         matches.  */
+  if (use_cache)
+    treesit_query_cache_store (lisp_parser, query, lisp_node, beg, end,
+			       node_only, grouped, result);
+  return result;
+}
 
-      /* Mode 1: Record the checkpoint that we may roll back to.  */
-      prev_result = result;
-      /* Mode 2: Create a list storing captures of this match group.  */
-      Lisp_Object match_group = Qnil;
-      /* 1. Get captured nodes.  */
-      const TSQueryCapture *captures = match.captures;
-      for (int idx = 0; idx < match.capture_count; idx++)
-	{
-	  uint32_t capture_name_len;
-	  TSQueryCapture capture = captures[idx];
-	  Lisp_Object captured_node = make_treesit_node (lisp_parser,
-							 capture.node);
+/* Queries that other threads run.  These threads only find the
+   matches, which doesn't involve Lisp; the captures and predicates of
+   the matches are then handled in the Lisp thread, by
+   treesit_collect_captures.  Tree-sitter queries and trees aren't
+   changed by running a query, so several threads can run queries on
+   the same tree at once.  */
 
-	  Lisp_Object cap;
-	  if (NILP (node_only))
-	    {
-	      const char *capture_name
-		= ts_query_capture_name_for_id (treesit_query, capture.index,
-						&capture_name_len);
-	      cap = Fcons (intern_c_string_1 (capture_name, capture_name_len),
-			   captured_node);
-	    }
-	  else
-	    cap = captured_node;
+/* A match that a query thread found: the index of its pattern, and
+   the number of its captures.  */
+struct treesit_recorded_match
+{
+  uint16_t pattern_index;
+  uint16_t capture_count;
+};
 
-	  if (NILP (grouped))
-	    result = Fcons (cap, result); /* Mode 1. */
-	  else
-	    match_group = Fcons (cap, match_group); /* Mode 2. */
+/* A query for a thread to run, and the matches it found.  */
+struct treesit_query_job
+{
+  /* The query, the node to run it on, and the byte range to confine
+     it to, if RANGE_P.  */
+  const TSQuery *query;
+  TSNode node;
+  bool range_p;
+  uint32_t beg_byte, end_byte;
+  /* The index of the job in the argument of
+     'treesit-query-capture-batch'.  */
+  ptrdiff_t index;
+  /* The matches found, and the captures of all of them, in order.
+     FAILED means that memory ran out before all were recorded.  */
+  struct treesit_recorded_match *matches;
+  ptrdiff_t nmatches, matches_size;
+  TSQueryCapture *captures;
+  ptrdiff_t ncaptures, captures_size;
+  bool failed;
+};
+
+/* The maximum number of threads that run queries.  */
+enum { MAX_QUERY_THREADS = 16 };
+
+/* The jobs being run, the index of the next one that no thread has
+   taken yet, and the number of jobs done.  These are protected by
+   QUERY_MUTEX, and QUERY_COND is signaled when there are new jobs and
+   when the last one is done.  */
+static struct treesit_query_job *query_jobs;
+static ptrdiff_t query_job_count, query_job_next, query_jobs_done;
+static sys_mutex_t query_mutex;
+static sys_cond_t query_cond;
+
+/* The number of threads started to run queries.  */
+static int query_threads;
+
+static bool
+treesit_next_match (struct treesit_match_source *source, TSQueryMatch *match)
+{
+  if (source->cursor)
+    return ts_query_cursor_next_match (source->cursor, match);
+
+  struct treesit_query_job *job = source->job;
+  if (source->next_match == job->nmatches)
+    return false;
+  struct treesit_recorded_match *recorded
+    = &job->matches[source->next_match++];
+  match->id = 0;
+  match->pattern_index = recorded->pattern_index;
+  match->capture_count = recorded->capture_count;
+  match->captures = job->captures + source->next_capture;
+  source->next_capture += recorded->capture_count;
+  return true;
+}
+
+/* Make the array *VEC, which has room for *SIZE elements of ELTSIZE
+   bytes, large enough for NEEDED elements.  Return false if there
+   isn't enough memory.  This is called in query threads, so it can't
+   use xpalloc.  */
+static bool
+treesit_grow_job_vector (void **vec, ptrdiff_t *size, ptrdiff_t needed,
+			 ptrdiff_t eltsize)
+{
+  if (needed <= *size)
+    return true;
+  ptrdiff_t new_size = max (needed, max (16, *size * 2));
+  void *new_vec = realloc (*vec, new_size * eltsize);
+  if (!new_vec)
+    return false;
+  *vec = new_vec;
+  *size = new_size;
+  return true;
+}
+
+/* Find the matches of JOB.  */
+static void
+treesit_run_query_job (struct treesit_query_job *job)
+{
+  TSQueryCursor *cursor = ts_query_cursor_new ();
+  if (job->range_p)
+    ts_query_cursor_set_byte_range (cursor, job->beg_byte, job->end_byte);
+  ts_query_cursor_exec (cursor, job->query, job->node);
+
+  TSQueryMatch match;
+  while (ts_query_cursor_next_match (cursor, &match))
+    {
+      void *matches = job->matches, *captures = job->captures;
+      bool ok = (treesit_grow_job_vector (&matches, &job->matches_size,
+					  job->nmatches + 1,
+					  sizeof *job->matches)
+		 && (job->matches = matches,
+		     treesit_grow_job_vector (&captures, &job->captures_size,
+					      (job->ncaptures
+					       + match.capture_count),
+					      sizeof *job->captures)));
+      job->captures = captures;
+      if (!ok)
+	{
+	  job->failed = true;
+	  break;
 	}
-      /* 2. Get predicates and check whether this match can be
-         included in the result list.  */
-      Lisp_Object predicates = AREF (predicates_table, match.pattern_index);
-      if (BASE_EQ (predicates, Qt))
+      struct treesit_recorded_match *recorded
+	= &job->matches[job->nmatches++];
+      recorded->pattern_index = match.pattern_index;
+      recorded->capture_count = match.capture_count;
+      memcpy (job->captures + job->ncaptures, match.captures,
+	      match.capture_count * sizeof *match.captures);
+      job->ncaptures += match.capture_count;
+    }
+  ts_query_cursor_delete (cursor);
+}
+
+/* Run the jobs that no other thread has taken.  QUERY_MUTEX must be
+   locked on entry, and is locked on return.  */
+static void
+treesit_run_remaining_query_jobs (void)
+{
+  while (query_job_next < query_job_count)
+    {
+      struct treesit_query_job *job = &query_jobs[query_job_next++];
+      sys_mutex_unlock (&query_mutex);
+      treesit_run_query_job (job);
+      sys_mutex_lock (&query_mutex);
+      if (++query_jobs_done == query_job_count)
+	sys_cond_broadcast (&query_cond);
+    }
+}
+
+static void *
+treesit_query_thread (void *arg)
+{
+#ifdef HAVE_PTHREAD
+  /* Leave signal handling to the main thread.  */
+  sigset_t blocked;
+  sigfillset (&blocked);
+  pthread_sigmask (SIG_BLOCK, &blocked, NULL);
+#endif
+  sys_thread_set_name ("tree-sitter query");
+
+  sys_mutex_lock (&query_mutex);
+  for (;;)
+    {
+      while (query_job_next >= query_job_count)
+	sys_cond_wait (&query_cond, &query_mutex);
+      treesit_run_remaining_query_jobs ();
+    }
+  return NULL;
+}
+
+/* Start query threads until there are NTHREADS of them, if possible,
+   and return how many there are.  */
+static int
+treesit_start_query_threads (int nthreads)
+{
+  static bool initialized, failed;
+  if (!initialized)
+    {
+      sys_mutex_init (&query_mutex);
+      sys_cond_init (&query_cond);
+      initialized = true;
+    }
+  while (query_threads < nthreads && !failed)
+    {
+      sys_thread_t thr;
+      if (sys_thread_create (&thr, treesit_query_thread, NULL))
+	query_threads++;
+      else
+	failed = true;
+    }
+  return query_threads;
+}
+
+/* Run the NJOBS jobs in JOBS with the query threads, and return when
+   all are done.  The Lisp thread only waits, since tree-sitter would
+   allocate memory with xmalloc in it, which can signal an error.
+   There must be at least one query thread.  */
+static void
+treesit_run_query_jobs (struct treesit_query_job *jobs, ptrdiff_t njobs)
+{
+  sys_mutex_lock (&query_mutex);
+  query_jobs = jobs;
+  query_job_count = njobs;
+  query_job_next = query_jobs_done = 0;
+  sys_cond_broadcast (&query_cond);
+  while (query_jobs_done < njobs)
+    sys_cond_wait (&query_cond, &query_mutex);
+  query_jobs = NULL;
+  query_job_count = query_job_next = 0;
+  sys_mutex_unlock (&query_mutex);
+}
+
+/* Free the jobs in ARG, an array of struct treesit_query_job whose
+   last element has a negative index.  */
+static void
+treesit_free_query_jobs (void *arg)
+{
+  struct treesit_query_job *jobs = arg;
+  for (struct treesit_query_job *job = jobs; job->index >= 0; job++)
+    {
+      free (job->matches);
+      free (job->captures);
+    }
+  xfree (jobs);
+}
+
+DEFUN ("treesit-query-capture-batch",
+       Ftreesit_query_capture_batch,
+       Streesit_query_capture_batch, 1, 1, 0,
+       doc: /* Run several queries, on several threads if possible.
+JOBS is a list of elements of the form (NODE QUERY BEG END).  Return a
+list of the results of the jobs, in the same order, where the result of
+each job is what
+
+  (treesit-query-capture NODE QUERY BEG END)
+
+would return.
+
+When there are several jobs and several processors, the matches of
+the jobs whose QUERY is a compiled query are found by several threads
+at once.  The predicates of the matches are always checked in the
+current thread, one job after another, so predicates that call Lisp
+functions work as usual.  */)
+  (Lisp_Object jobs)
+{
+  ptrdiff_t njobs = list_length (jobs);
+  Lisp_Object results = make_nil_vector (njobs);
+  /* The resolved node of each job run by the query threads, or nil
+     for the other jobs.  */
+  Lisp_Object nodes = make_nil_vector (njobs);
+  Lisp_Object jobv = Fvconcat (1, &jobs);
+  int nthreads = min (num_processors (NPROC_CURRENT_OVERRIDABLE),
+		      min (MAX_QUERY_THREADS, njobs));
+  bool parallel = nthreads > 1;
+  ptrdiff_t nparallel = 0;
+
+  /* Check the jobs that the query threads can run, and look them up
+     in the query cache.  The other jobs are run at the end, by
+     'treesit-query-capture'.  */
+  for (ptrdiff_t i = 0; i < njobs; i++)
+    {
+      Lisp_Object job = AREF (jobv, i);
+      Lisp_Object node = Fcar (job), query = Fcar (Fcdr (job));
+      Lisp_Object beg = Fnth (make_fixnum (2), job);
+      Lisp_Object end = Fnth (make_fixnum (3), job);
+      Lisp_Object lisp_node = Qnil, cached;
+
+      if (parallel && TS_COMPILED_QUERY_P (query))
 	{
-	  predicates = treesit_predicates_for_pattern (treesit_query,
-						       match.pattern_index);
-	  ASET (predicates_table, match.pattern_index, predicates);
+	  treesit_initialize ();
+	  lisp_node = treesit_resolve_node (node);
+	  treesit_check_node (lisp_node);
+	  Lisp_Object lisp_parser = XTS_NODE (lisp_node)->parser;
+	  struct buffer *buf = XBUFFER (XTS_PARSER (lisp_parser)->buffer);
+	  if (!NILP (beg))
+	    treesit_check_position (beg, buf);
+	  if (!NILP (end))
+	    treesit_check_position (end, buf);
+	  Lisp_Object signal_symbol, signal_data;
+	  if (!treesit_ensure_query_compiled (query, &signal_symbol,
+					      &signal_data))
+	    xsignal (signal_symbol, signal_data);
+	  if (!NILP (beg) && !NILP (end)
+	      && treesit_query_cache_lookup (lisp_parser, query,
+					     XTS_NODE (lisp_node)->node,
+					     beg, end, Qnil, Qnil, &cached))
+	    {
+	      ASET (results, i, treesit_copy_captures (cached, false));
+	      ASET (jobv, i, Qnil);
+	      continue;
+	    }
+	  ASET (nodes, i, lisp_node);
+	  nparallel++;
 	}
+    }
 
-      /* captures_lisp = Fnreverse (captures_lisp); */
-      /* Mode 1.  */
-      struct capture_range captures_range = { result, prev_result };
-      /* Mode 2.  */
-      if (!NILP (grouped))
+  /* Make the jobs for the query threads, now that no more Lisp code
+     runs until they are done.  The extra job marks the end.  */
+  struct treesit_query_job *ts_jobs = NULL;
+  specpdl_ref count = SPECPDL_INDEX ();
+  if (nparallel > 0)
+    {
+      ts_jobs = xzalloc ((nparallel + 1) * sizeof *ts_jobs);
+      ts_jobs[nparallel].index = -1;
+      record_unwind_protect_ptr (treesit_free_query_jobs, ts_jobs);
+      ptrdiff_t k = 0;
+      for (ptrdiff_t i = 0; i < njobs; i++)
 	{
-	  captures_range.start = match_group;
-	  captures_range.end = Qnil;
+	  Lisp_Object lisp_node = AREF (nodes, i);
+	  if (NILP (lisp_node))
+	    continue;
+	  Lisp_Object job = AREF (jobv, i);
+	  Lisp_Object query = Fcar (Fcdr (job));
+	  Lisp_Object beg = Fnth (make_fixnum (2), job);
+	  Lisp_Object end = Fnth (make_fixnum (3), job);
+	  struct Lisp_TS_Parser *parser
+	    = XTS_PARSER (XTS_NODE (lisp_node)->parser);
+	  struct treesit_query_job *ts_job = &ts_jobs[k++];
+	  ts_job->query = XTS_COMPILED_QUERY (query)->query;
+	  ts_job->node = XTS_NODE (lisp_node)->node;
+	  ts_job->index = i;
+	  if (!NILP (beg) && !NILP (end))
+	    {
+	      struct buffer *buf = XBUFFER (parser->buffer);
+	      ptrdiff_t beg_byte = buf_charpos_to_bytepos (buf, XFIXNUM (beg));
+	      ptrdiff_t end_byte = buf_charpos_to_bytepos (buf, XFIXNUM (end));
+	      eassert (beg_byte - parser->visible_beg <= UINT32_MAX);
+	      eassert (end_byte - parser->visible_beg <= UINT32_MAX);
+	      ts_job->range_p = true;
+	      ts_job->beg_byte = beg_byte - parser->visible_beg;
+	      ts_job->end_byte = end_byte - parser->visible_beg;
+	    }
 	}
-      bool match
-	= treesit_eval_predicates (captures_range, predicates,
-				   &predicate_signal_data);
+      if (treesit_start_query_threads (nthreads) > 0)
+	treesit_run_query_jobs (ts_jobs, nparallel);
+      else
+	for (k = 0; k < nparallel; k++)
+	  ts_jobs[k].failed = true;
+    }
 
+  /* Make the results of the jobs run by the query threads, and of the
+     others.  */
+  for (ptrdiff_t k = 0; k < nparallel; k++)
+    {
+      struct treesit_query_job *ts_job = &ts_jobs[k];
+      ptrdiff_t i = ts_job->index;
+      Lisp_Object lisp_node = AREF (nodes, i);
+      ASET (nodes, i, Qnil);
+      /* Predicates of earlier jobs could have changed the buffer,
+	 which makes the matches found invalid.  */
+      if (ts_job->failed || !treesit_node_uptodate_p (lisp_node))
+	continue;
+      Lisp_Object job = AREF (jobv, i);
+      Lisp_Object query = Fcar (Fcdr (job));
+      Lisp_Object beg = Fnth (make_fixnum (2), job);
+      Lisp_Object end = Fnth (make_fixnum (3), job);
+      Lisp_Object lisp_parser = XTS_NODE (lisp_node)->parser;
+      struct treesit_match_source source = { NULL, ts_job, 0, 0 };
+      Lisp_Object predicate_signal_data = Qnil;
+      TSQuery *treesit_query = XTS_COMPILED_QUERY (query)->query;
+      Lisp_Object result
+	= treesit_collect_captures (lisp_parser, treesit_query, &source,
+				    Qnil, Qnil, &predicate_signal_data);
       if (!NILP (predicate_signal_data))
-	break;
-
-      /* Mode 1: Predicates didn't pass, roll back.  */
-      if (!match && NILP (grouped))
-	result = prev_result;
-      /* Mode 2: Predicates pass, add this match group.  */
-      if (match && !NILP (grouped))
-	result = Fcons (Fnreverse (match_group), result);
+	xsignal (Qtreesit_query_error, predicate_signal_data);
+      if (!NILP (beg) && !NILP (end)
+	  && !XTS_COMPILED_QUERY (query)->uses_pred)
+	treesit_query_cache_store (lisp_parser, query, lisp_node, beg, end,
+				   Qnil, Qnil, result);
+      ASET (results, i, result);
+      /* Mark the job as done.  */
+      ASET (jobv, i, Qnil);
     }
+  unbind_to (count, Qnil);
 
-  /* Final clean up.  */
-  if (needs_to_free_query_and_cursor)
+  for (ptrdiff_t i = 0; i < njobs; i++)
     {
-      ts_query_delete (treesit_query);
-      ts_query_cursor_delete (cursor);
+      Lisp_Object job = AREF (jobv, i);
+      if (!NILP (job))
+	ASET (results, i,
+	      Ftreesit_query_capture (Fcar (job), Fcar (Fcdr (job)),
+				      Fnth (make_fixnum (2), job),
+				      Fnth (make_fixnum (3), job),
+				      Qnil, Qnil));
     }
-  set_buffer_internal (old_buf);
-
-  /* Some capture predicate signaled an error.  */
-  if (!NILP (predicate_signal_data))
-    xsignal (Qtreesit_query_error, predicate_signal_data);
-
-  return Fnreverse (result);
+  return CALLN (Fappend, results, Qnil);
 }
 
 
@@ -3789,6 +4825,54 @@ treesit_traverse_validate_predicate (Lisp_Object pred,
   return false;
 }
 
+/* While a sparse tree is built, the same few node types are matched
+   against the same regexps over and over, so the results are
+   remembered here.  A node type is identified by the address of its
+   name, which tree-sitter keeps in the language definition.  This is
+   NULL when nothing is remembered.  */
+
+enum { TREESIT_TYPE_MEMO_SIZE = 128 };
+
+struct treesit_type_memo
+{
+  struct
+  {
+    Lisp_Object regexp;
+    const char *type;
+    bool match;
+  } entries[TREESIT_TYPE_MEMO_SIZE];
+};
+
+static struct treesit_type_memo *treesit_type_memo;
+
+static void
+treesit_restore_type_memo (void *memo)
+{
+  treesit_type_memo = memo;
+}
+
+/* Return true if the type of NODE matches REGEXP.  */
+static bool
+treesit_node_type_match (Lisp_Object regexp, TSNode node)
+{
+  const char *type = ts_node_type (node);
+  struct treesit_type_memo *memo = treesit_type_memo;
+  if (!memo)
+    return fast_c_string_match (regexp, type, strlen (type)) >= 0;
+
+  uintptr_t hash = (uintptr_t) type ^ (uintptr_t) XLI (regexp);
+  hash ^= hash >> 16;
+  int i = (hash >> 3) % TREESIT_TYPE_MEMO_SIZE;
+  if (memo->entries[i].type != type || !EQ (memo->entries[i].regexp, regexp))
+    {
+      memo->entries[i].regexp = regexp;
+      memo->entries[i].type = type;
+      memo->entries[i].match
+	= fast_c_string_match (regexp, type, strlen (type)) >= 0;
+    }
+  return memo->entries[i].match;
+}
+
 /* Return true if the node at CURSOR matches PRED.  PRED can be a lot
    of things:
 
@@ -3811,10 +4895,7 @@ treesit_traverse_match_predicate (TSTreeCursor *cursor, Lisp_Object pred,
     return false;
 
   if (STRINGP (pred))
-    {
-      const char *type = ts_node_type (node);
-      return fast_c_string_match (pred, type, strlen (type)) >= 0;
-    }
+    return treesit_node_type_match (pred, node);
   else if (FUNCTIONP (pred)
 	   && !(SYMBOLP (pred) && !NILP (Fget (pred, Qtreesit_thing_symbol))))
     {
@@ -3863,9 +4944,7 @@ treesit_traverse_match_predicate (TSTreeCursor *cursor, Lisp_Object pred,
 	}
       else if (STRINGP (car) && FUNCTIONP (cdr))
 	{
-	  /* A bit of code duplication here, but should be fine.  */
-	  const char *type = ts_node_type (node);
-	  if (!(fast_c_string_match (car, type, strlen (type)) >= 0))
+	  if (!treesit_node_type_match (car, node))
 	    return false;
 
 	  Lisp_Object lisp_node = make_treesit_node (parser, node);
@@ -4248,6 +5327,15 @@ DEFUN ("treesit-induce-sparse-tree",
   specpdl_ref count = SPECPDL_INDEX ();
   record_unwind_protect_ptr (treesit_traverse_cleanup_cursor, &cursor);
 
+  struct treesit_type_memo memo;
+  for (int i = 0; i < TREESIT_TYPE_MEMO_SIZE; i++)
+    {
+      memo.entries[i].regexp = Qnil;
+      memo.entries[i].type = NULL;
+    }
+  record_unwind_protect_ptr (treesit_restore_type_memo, treesit_type_memo);
+  treesit_type_memo = &memo;
+
   treesit_build_sparse_tree (&cursor, parent, predicate, process_fn,
 			     the_limit, parser);
 
@@ -4508,6 +5596,22 @@ syms_of_treesit (void)
 then in the system default locations for dynamic libraries, in that order.  */);
   Vtreesit_extra_load_path = Qnil;
 
+  DEFVAR_LISP ("treesit-background-parse-threshold",
+	       Vtreesit_background_parse_threshold,
+	       doc: /* Size from which buffers are reparsed in the background.
+If this is a natural number, a parser whose buffer has at least that
+many bytes in its accessible portion reparses it in another thread
+after a change.  Until that is done, functions that use the parser
+get nodes and query results from the tree made by the previous parse,
+updated for the positions of the changes; when it is done, the new
+tree is used from then on, and the after-change functions of the
+parser are called with the ranges that changed.  The first parse of a
+buffer always happens synchronously.
+
+If it is nil, the default, parsers always reparse synchronously.  On
+systems without threads, this variable has no effect.  */);
+  Vtreesit_background_parse_threshold = Qnil;
+
   DEFVAR_LISP ("treesit-thing-settings",
 	       Vtreesit_thing_settings,
 	       doc:
@@ -4643,6 +5747,7 @@ or (not PRED), meaning not satisfying the inner PRED qualifies the node.
   defsubr (&Streesit_query_expand);
   defsubr (&Streesit_query_compile);
   defsubr (&Streesit_query_capture);
+  defsubr (&Streesit_query_capture_batch);
 
   defsubr (&Streesit_search_subtree);
   defsubr (&Streesit_search_forward);
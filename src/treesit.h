@@ -72,6 +72,12 @@ #define EMACS_TREESIT_H
      friends) haven't touched this parser yet, and this parser isn't
      part of the embed parser tree.  */
   Lisp_Object embed_level;
+  /* Recent results of 'treesit-query-capture' with a compiled query
+     and a range, most recent first, so that querying the same range
+     again needn't run the query.  Each element is a vector [QUERY
+     NODE BEG END NODE-ONLY GROUPED RESULT].  This is reset to nil
+     whenever the tree is edited or replaced.  */
+  Lisp_Object query_cache;
   /* The buffer associated with this parser.  */
   Lisp_Object buffer;
   /* The pointer to the tree-sitter parser.  Never NULL.  */
@@ -113,6 +119,14 @@ #define EMACS_TREESIT_H
      prevent infinite recursion due to calling after change
      functions.  */
   bool within_reparse;
+  /* The reparse running in the background for this parser, or NULL.
+     See treesit_start_background_parse in treesit.c.  */
+  struct treesit_background_parse *background_parse;
+  /* The edit that treesit_record_change would have given to
+     ts_tree_edit but hasn't yet, so that the edits that follow it
+     nearby can be merged into it.  Valid only if has_pending_edit.  */
+  TSInputEdit pending_edit;
+  bool has_pending_edit;
 };
 
 /* A wrapper around a tree-sitter node.  */
@@ -160,6 +174,9 @@ #define EMACS_TREESIT_H
      to be NULL-able because it makes dumping and loading queries
      easy.  */
   TSQueryCursor *cursor;
+  /* Whether the query uses the `pred' predicate, so that its results
+     can't be cached.  This is set when the query is compiled.  */
+  bool uses_pred;
 };
 
 INLINE bool
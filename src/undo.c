@@ -117,50 +117,34 @@ record_insert (ptrdiff_t beg, ptrdiff_t length)
 		  Fcons (Fcons (lbeg, lend), BVAR (current_buffer, undo_list)));
 }
 
-/* Record the fact that markers in the region of FROM, TO are about to
-   be adjusted.  This is done only when a marker points within text
-   being deleted, because that's the only case where an automatic
-   marker adjustment won't be inverted automatically by undoing the
-   buffer modification.  */
+/* Record that marker M, which points into text whose deletion was
+   just recorded by record_delete, is about to be moved by ADJUSTMENT.
+   This is done only when a marker points within text being deleted,
+   because that's the only case where an automatic marker adjustment
+   won't be inverted automatically by undoing the buffer modification.
 
-static void
-record_marker_adjustments (ptrdiff_t from, ptrdiff_t to)
-{
-  prepare_record ();
+   adjust_markers_for_delete calls this as it relocates the markers,
+   so that a deletion walks the buffer's markers only once.  The
+   adjustment goes right after the deletion record, where
+   primitive-undo looks for it.  */
 
-  for (struct Lisp_Marker *m = BUF_MARKERS (current_buffer); m; m = m->next)
-    {
-      ptrdiff_t charpos = m->charpos;
-      eassert (charpos <= Z);
-
-      if (from <= charpos && charpos <= to)
-        {
-          /* insertion_type nil markers will end up at the beginning of
-             the re-inserted text after undoing a deletion, and must be
-             adjusted to move them to the correct place.
-
-             insertion_type t markers will automatically move forward
-             upon re-inserting the deleted text, so we have to arrange
-             for them to move backward to the correct position.  */
-	  ptrdiff_t adjustment = (m->insertion_type ? to : from) - charpos;
-
-          if (adjustment)
-            {
-	      Lisp_Object marker = make_lisp_ptr (m, Lisp_Vectorlike);
-              bset_undo_list
-                (current_buffer,
-                 Fcons (Fcons (marker, make_fixnum (adjustment)),
-                        BVAR (current_buffer, undo_list)));
-            }
-        }
-    }
+void
+record_marker_adjustment (struct Lisp_Marker *m, ptrdiff_t adjustment)
+{
+  Lisp_Object deletion = BVAR (current_buffer, undo_list);
+  eassert (CONSP (deletion) && CONSP (XCAR (deletion))
+	   && STRINGP (XCAR (XCAR (deletion))));
+  Lisp_Object marker = make_lisp_ptr (m, Lisp_Vectorlike);
+  XSETCDR (deletion, Fcons (Fcons (marker, make_fixnum (adjustment)),
+			    XCDR (deletion)));
 }
 
 /* Record that a deletion is about to take place, of the characters in
-   STRING, at location BEG.  Optionally record adjustments for markers
-   in the region STRING occupies in the current buffer.  */
+   STRING, at location BEG.  Adjustments for markers in the region
+   STRING occupies in the current buffer are recorded afterwards, by
+   record_marker_adjustment.  */
 void
-record_delete (ptrdiff_t beg, Lisp_Object string, bool record_markers)
+record_delete (ptrdiff_t beg, Lisp_Object string)
 {
   Lisp_Object sbeg;
 
@@ -180,12 +164,6 @@ record_delete (ptrdiff_t beg, Lisp_Object string, bool record_markers)
       XSETFASTINT (sbeg, beg);
     }
 
-  /* primitive-undo assumes marker adjustments are recorded
-     immediately before the deletion is recorded.  See bug 16818
-     discussion.  */
-  if (record_markers)
-    record_marker_adjustments (beg, beg + SCHARS (string));
-
   bset_undo_list
     (current_buffer,
      Fcons (Fcons (string, sbeg), BVAR (current_buffer, undo_list)));
@@ -198,7 +176,7 @@ record_delete (ptrdiff_t beg, Lisp_Object string, bool record_markers)
 void
 record_change (ptrdiff_t beg, ptrdiff_t length)
 {
-  record_delete (beg, make_buffer_string (beg, beg + length, true), false);
+  record_delete (beg, make_buffer_string (beg, beg + length, true));
   record_insert (beg, length);
 }
 
@@ -281,6 +259,404 @@ DEFUN ("undo-boundary", Fundo_boundary, Sundo_boundary, 0, 0, 0,
   return Qnil;
 }
 
+/* Compressed undo history.
+
+   When `undo-compressed-limit' is non-nil, truncate_undo_list does not
+   discard the undo records past `undo-limit', but encodes them in the
+   compact binary form below, compressed with zlib if possible, and
+   replaces them with an element (undo-compressed . DATA), where DATA
+   is a unibyte string.  `primitive-undo' decodes DATA back into undo
+   records with `undo--decompress-history' when it gets there.
+
+   DATA starts with an undo_method byte and the size of the encoded
+   records, followed by the records, compressed or not.  Each object
+   is encoded as an undo_tag byte followed by its contents; integers
+   are encoded in 7-bit groups, least significant first, with the high
+   bit set in all groups but the last.  */
+
+enum undo_method { UNDO_RAW, UNDO_ZLIB };
+
+enum undo_tag
+  {
+    UNDO_NIL,
+    UNDO_T,
+    UNDO_FIXNUM,		/* Followed by the value.  */
+    UNDO_NEGATIVE_FIXNUM,	/* Followed by the opposite value.  */
+    UNDO_FLOAT,			/* Followed by the bytes of the double.  */
+    UNDO_CONS,			/* Followed by the car and cdr.  */
+    UNDO_SYMBOL,		/* Followed by the name, as a string.  */
+    UNDO_UNIBYTE_STRING,	/* Followed by the size and the bytes.  */
+    UNDO_MULTIBYTE_STRING,	/* Followed by the length, size, bytes.  */
+    UNDO_PROPERTIZED_STRING	/* Followed by the string and the list
+				   returned by `object-intervals'.  */
+  };
+
+/* Limit on the nesting of conses in car positions, which
+   are encoded and decoded recursively.  */
+enum { UNDO_MAX_DEPTH = 64 };
+
+struct undo_encoder
+{
+  unsigned char *data;
+  ptrdiff_t size, used;
+};
+
+static void
+undo_put (struct undo_encoder *e, const void *p, ptrdiff_t n)
+{
+  if (e->size - e->used < n)
+    e->data = xpalloc (e->data, &e->size, n - (e->size - e->used), -1, 1);
+  memcpy (e->data + e->used, p, n);
+  e->used += n;
+}
+
+static void
+undo_put_byte (struct undo_encoder *e, int byte)
+{
+  unsigned char c = byte;
+  undo_put (e, &c, 1);
+}
+
+static void
+undo_put_uint (struct undo_encoder *e, uintmax_t n)
+{
+  for (; 0x80 <= n; n >>= 7)
+    undo_put_byte (e, (n & 0x7f) | 0x80);
+  undo_put_byte (e, n);
+}
+
+/* Encode the text of string STRING, without its properties.  */
+
+static void
+undo_encode_string (struct undo_encoder *e, Lisp_Object string)
+{
+  if (STRING_MULTIBYTE (string))
+    {
+      undo_put_byte (e, UNDO_MULTIBYTE_STRING);
+      undo_put_uint (e, SCHARS (string));
+    }
+  else
+    undo_put_byte (e, UNDO_UNIBYTE_STRING);
+  undo_put_uint (e, SBYTES (string));
+  undo_put (e, SDATA (string), SBYTES (string));
+}
+
+/* Encode OBJ, nested DEPTH conses deep.  Return false if it contains
+   an object that cannot be encoded, such as a marker or an uninterned
+   symbol; the encoder then holds a partial encoding.  */
+
+static bool
+undo_encode (struct undo_encoder *e, Lisp_Object obj, int depth)
+{
+  if (UNDO_MAX_DEPTH < depth)
+    return false;
+
+  for (; CONSP (obj); obj = XCDR (obj))
+    {
+      undo_put_byte (e, UNDO_CONS);
+      if (!undo_encode (e, XCAR (obj), depth + 1))
+	return false;
+    }
+
+  if (NILP (obj))
+    undo_put_byte (e, UNDO_NIL);
+  else if (EQ (obj, Qt))
+    undo_put_byte (e, UNDO_T);
+  else if (FIXNUMP (obj))
+    {
+      EMACS_INT n = XFIXNUM (obj);
+      undo_put_byte (e, n < 0 ? UNDO_NEGATIVE_FIXNUM : UNDO_FIXNUM);
+      undo_put_uint (e, n < 0 ? - (uintmax_t) n : n);
+    }
+  else if (FLOATP (obj))
+    {
+      double d = XFLOAT_DATA (obj);
+      undo_put_byte (e, UNDO_FLOAT);
+      undo_put (e, &d, sizeof d);
+    }
+  else if (SYMBOLP (obj))
+    {
+      if (!SYMBOL_INTERNED_IN_INITIAL_OBARRAY_P (obj))
+	return false;
+      undo_put_byte (e, UNDO_SYMBOL);
+      undo_encode_string (e, SYMBOL_NAME (obj));
+    }
+  else if (STRINGP (obj))
+    {
+      if (string_intervals (obj))
+	{
+	  undo_put_byte (e, UNDO_PROPERTIZED_STRING);
+	  undo_encode_string (e, obj);
+	  return undo_encode (e, Fobject_intervals (obj), depth + 1);
+	}
+      undo_encode_string (e, obj);
+    }
+  else
+    return false;
+  return true;
+}
+
+struct undo_decoder
+{
+  unsigned char const *p, *end;
+};
+
+static AVOID
+undo_corrupt (void)
+{
+  error ("Corrupt compressed undo history");
+}
+
+static int
+undo_get_byte (struct undo_decoder *d)
+{
+  if (d->p == d->end)
+    undo_corrupt ();
+  return *d->p++;
+}
+
+static uintmax_t
+undo_get_uint (struct undo_decoder *d)
+{
+  uintmax_t n = 0;
+  for (int shift = 0; ; shift += 7)
+    {
+      int byte = undo_get_byte (d);
+      if (UINTMAX_WIDTH <= shift)
+	undo_corrupt ();
+      n |= (uintmax_t) (byte & 0x7f) << shift;
+      if (byte < 0x80)
+	return n;
+    }
+}
+
+static Lisp_Object
+undo_decode_string (struct undo_decoder *d, int tag)
+{
+  uintmax_t nchars = tag == UNDO_MULTIBYTE_STRING ? undo_get_uint (d) : 0;
+  uintmax_t nbytes = undo_get_uint (d);
+  if (d->end - d->p < nbytes
+      || (tag == UNDO_MULTIBYTE_STRING
+	  ? nbytes < nchars || (nchars == 0) != (nbytes == 0)
+	  : tag != UNDO_UNIBYTE_STRING))
+    undo_corrupt ();
+  Lisp_Object string
+    = (tag == UNDO_MULTIBYTE_STRING
+       ? make_multibyte_string ((char const *) d->p, nchars, nbytes)
+       : make_unibyte_string ((char const *) d->p, nbytes));
+  d->p += nbytes;
+  return string;
+}
+
+static Lisp_Object
+undo_decode (struct undo_decoder *d, int depth)
+{
+  if (UNDO_MAX_DEPTH < depth)
+    undo_corrupt ();
+
+  Lisp_Object head = Qnil, tail = Qnil;
+  int tag;
+  while ((tag = undo_get_byte (d)) == UNDO_CONS)
+    {
+      Lisp_Object cell = Fcons (undo_decode (d, depth + 1), Qnil);
+      if (NILP (tail))
+	head = cell;
+      else
+	XSETCDR (tail, cell);
+      tail = cell;
+    }
+
+  Lisp_Object obj;
+  switch (tag)
+    {
+    case UNDO_NIL:
+      obj = Qnil;
+      break;
+    case UNDO_T:
+      obj = Qt;
+      break;
+    case UNDO_FIXNUM:
+    case UNDO_NEGATIVE_FIXNUM:
+      {
+	uintmax_t n = undo_get_uint (d);
+	if (MOST_POSITIVE_FIXNUM < n)
+	  undo_corrupt ();
+	obj = make_fixnum (tag == UNDO_FIXNUM ? n : - (EMACS_INT) n);
+      }
+      break;
+    case UNDO_FLOAT:
+      {
+	double f;
+	if (d->end - d->p < sizeof f)
+	  undo_corrupt ();
+	memcpy (&f, d->p, sizeof f);
+	d->p += sizeof f;
+	obj = make_float (f);
+      }
+      break;
+    case UNDO_SYMBOL:
+      obj = Fintern (undo_decode_string (d, undo_get_byte (d)), Qnil);
+      break;
+    case UNDO_UNIBYTE_STRING:
+    case UNDO_MULTIBYTE_STRING:
+      obj = undo_decode_string (d, tag);
+      break;
+    case UNDO_PROPERTIZED_STRING:
+      {
+	obj = undo_decode_string (d, undo_get_byte (d));
+	Lisp_Object intervals = undo_decode (d, depth + 1);
+	for (; CONSP (intervals); intervals = XCDR (intervals))
+	  {
+	    Lisp_Object i = XCAR (intervals);
+	    if (!CONSP (i) || !CONSP (XCDR (i)) || !CONSP (XCDR (XCDR (i))))
+	      undo_corrupt ();
+	    Fset_text_properties (XCAR (i), XCAR (XCDR (i)),
+				  XCAR (XCDR (XCDR (i))), obj);
+	  }
+      }
+      break;
+    default:
+      undo_corrupt ();
+    }
+
+  if (NILP (tail))
+    return obj;
+  XSETCDR (tail, obj);
+  return head;
+}
+
+/* Return the DATA of an (undo-compressed . DATA) element holding the
+   records encoded in E.  */
+
+static Lisp_Object
+make_undo_history (struct undo_encoder *e)
+{
+  struct undo_encoder header = { NULL, 0, 0 };
+  Lisp_Object payload = Qnil;
+#ifdef HAVE_ZLIB
+  payload = zlib_compress_bytes (e->data, e->used);
+#endif
+  undo_put_byte (&header, NILP (payload) ? UNDO_RAW : UNDO_ZLIB);
+  undo_put_uint (&header, e->used);
+
+  ptrdiff_t nbytes = NILP (payload) ? e->used : SBYTES (payload);
+  Lisp_Object data = make_uninit_string (header.used + nbytes);
+  memcpy (SDATA (data), header.data, header.used);
+  memcpy (SDATA (data) + header.used,
+	  NILP (payload) ? e->data : SDATA (payload), nbytes);
+  xfree (header.data);
+  return data;
+}
+
+/* Replace the records of B's undo list past LAST_BOUNDARY, or all of
+   them if LAST_BOUNDARY is nil, by an (undo-compressed . DATA)
+   element, then discard the oldest such elements past
+   `undo-compressed-limit'.  */
+
+static void
+compress_undo_list_tail (struct buffer *b, Lisp_Object last_boundary)
+{
+  Lisp_Object tail = (NILP (last_boundary)
+		      ? BVAR (b, undo_list) : XCDR (last_boundary));
+  Lisp_Object older = Qnil;
+  struct undo_encoder e = { NULL, 0, 0 };
+
+  for (; CONSP (tail); tail = XCDR (tail))
+    {
+      Lisp_Object elt = XCAR (tail);
+      if (CONSP (elt) && EQ (XCAR (elt), Qundo_compressed))
+	{
+	  older = tail;
+	  break;
+	}
+      /* Marker adjustments are only an optimization of undo, and
+	 markers cannot be encoded; drop them.  */
+      if (CONSP (elt) && MARKERP (XCAR (elt)))
+	continue;
+      ptrdiff_t used = e.used;
+      if (!undo_encode (&e, elt, 0))
+	{
+	  /* Undo cannot skip a record, so drop this one and all the
+	     older ones.  */
+	  e.used = used;
+	  break;
+	}
+    }
+
+  Lisp_Object rest = older;
+  if (e.used)
+    rest = Fcons (Fcons (Qundo_compressed, make_undo_history (&e)), older);
+  xfree (e.data);
+
+  intmax_t limit;
+  if (!INTEGERP (Vundo_compressed_limit))
+    limit = INTMAX_MAX;
+  else if (!integer_to_intmax (Vundo_compressed_limit, &limit))
+    limit = NILP (Fnatnump (Vundo_compressed_limit)) ? 0 : INTMAX_MAX;
+  intmax_t size = 0;
+  Lisp_Object prev = last_boundary;
+  for (tail = rest; CONSP (tail); prev = tail, tail = XCDR (tail))
+    {
+      size += SBYTES (XCDR (XCAR (tail)));
+      if (limit < size)
+	break;
+    }
+  if (CONSP (tail))
+    {
+      if (EQ (tail, rest))
+	rest = Qnil;
+      else
+	XSETCDR (prev, Qnil);
+    }
+
+  if (NILP (last_boundary))
+    bset_undo_list (b, rest);
+  else
+    XSETCDR (last_boundary, rest);
+}
+
+DEFUN ("undo--decompress-history", Fundo__decompress_history,
+       Sundo__decompress_history, 1, 1, 0,
+       doc: /* Return the undo records held in compressed form by DATA.
+DATA comes from an element (undo-compressed . DATA) of an undo list;
+see `undo-compressed-limit'.  */)
+  (Lisp_Object data)
+{
+  CHECK_STRING (data);
+  struct undo_decoder d = { SDATA (data), SDATA (data) + SBYTES (data) };
+  int method = undo_get_byte (&d);
+  uintmax_t size = undo_get_uint (&d);
+  if (PTRDIFF_MAX < size
+      || (method == UNDO_RAW ? d.end - d.p != size : method != UNDO_ZLIB))
+    undo_corrupt ();
+
+  /* Decode from a copy, as decoding can relocate the string data.  */
+  USE_SAFE_ALLOCA;
+  unsigned char *buf = SAFE_ALLOCA (size);
+  if (method == UNDO_RAW)
+    memcpy (buf, d.p, size);
+  else
+#ifdef HAVE_ZLIB
+    if (!zlib_uncompress_bytes (d.p, d.end - d.p, buf, size))
+#endif
+      undo_corrupt ();
+
+  d.p = buf;
+  d.end = buf + size;
+  Lisp_Object head = Qnil, tail = Qnil;
+  while (d.p < d.end)
+    {
+      Lisp_Object cell = Fcons (undo_decode (&d, 0), Qnil);
+      if (NILP (tail))
+	head = cell;
+      else
+	XSETCDR (tail, cell);
+      tail = cell;
+    }
+  SAFE_FREE ();
+  return head;
+}
+
 /* At garbage collection time, make an undo list shorter at the end,
    returning the truncated list.  How this is done depends on the
    variables undo-limit, undo-strong-limit and undo-outer-limit.
@@ -408,6 +784,9 @@ truncate_undo_list (struct buffer *b)
   /* If we scanned the whole list, it is short enough; don't change it.  */
   if (NILP (next))
     ;
+  /* Keep what we would discard in compressed form, if so requested.  */
+  else if (!NILP (Vundo_compressed_limit))
+    compress_undo_list_tail (b, last_boundary);
   /* Truncate at the boundary where we decided to truncate.  */
   else if (!NILP (last_boundary))
     XSETCDR (last_boundary, Qnil);
@@ -429,10 +808,14 @@ syms_of_undo (void)
   /* Marker for function call undo list elements.  */
   DEFSYM (Qapply, "apply");
 
+  /* Marker for compressed undo history.  */
+  DEFSYM (Qundo_compressed, "undo-compressed");
+
   pending_boundary = Qnil;
   staticpro (&pending_boundary);
 
   defsubr (&Sundo_boundary);
+  defsubr (&Sundo__decompress_history);
 
   DEFVAR_INT ("undo-limit", undo_limit,
 	      doc: /* Keep no more undo information once it exceeds this size.
@@ -484,6 +867,21 @@ syms_of_undo (void)
 so it must make sure not to do a lot of consing.  */);
   Vundo_outer_limit_function = Qnil;
 
+  DEFVAR_LISP ("undo-compressed-limit", Vundo_compressed_limit,
+	       doc: /* If non-nil, keep old undo information in compressed form.
+When garbage collection would discard undo information because of
+`undo-limit' or `undo-strong-limit', it is instead encoded in a
+compact form, compressed if possible, and kept at the end of the undo
+list as an element (undo-compressed . DATA), which `primitive-undo'
+decodes when it reaches it.  The value is the number of bytes of such
+compressed undo information to keep per buffer; the oldest information
+past it is discarded.  A value of t means no limit.
+
+Marker adjustments are not kept in compressed form.  Undo information
+that cannot be compressed, such as a text property whose value is a
+buffer, ends the compressed history.  */);
+  Vundo_compressed_limit = Qnil;
+
   DEFVAR_BOOL ("undo-inhibit-record-point", undo_inhibit_record_point,
 	       doc: /* Non-nil means do not record `point' in `buffer-undo-list'.  */);
   undo_inhibit_record_point = false;
@@ -1666,12 +1666,13 @@ msg_wait_for_objects (DWORD nCount, HANDLE *lpHandles,
 
    The management of both subprocesses and network/serial streams
    circles around the child_procs[] array, which can record up to the
-   grand total of MAX_CHILDREN (= 32) of these.  (The reasons for the
-   32 limitation will become clear below.)  Each member of
+   grand total of MAX_CHILDREN (= 1024) of these.  (The reasons for
+   the 1024 limitation will become clear below.)  Each member of
    child_procs[] is a child_process structure, defined on w32.h.
 
    A related data structure is the fd_info[] array, which holds twice
-   as many members, 64, and records the information about file
+   as many members, MAXDESC (= 2048), and records the information
+   about file
    descriptors used for communicating with subprocesses and
    network/serial devices.  Each member of the array is the filedesc
    structure, which records the Windows handle for communications,
@@ -1740,11 +1741,16 @@ msg_wait_for_objects (DWORD nCount, HANDLE *lpHandles,
    when the user presses C-g.
 
    Having collected the handles to watch, sys_select calls
-   WaitForMultipleObjects to wait for any one of them to become
-   signaled.  Since WaitForMultipleObjects can only watch up to 64
-   handles, Emacs on Windows is limited to maximum 32 child_process
-   objects (since a subprocess consumes 2 handles to be watched, see
-   above).
+   wait_for_objects (or msg_wait_for_objects) to wait for any one of
+   them to become signaled.  WaitForMultipleObjects can only watch up
+   to 64 handles, so when there are more handles to watch,
+   wait_for_objects distributes them among a pool of worker threads,
+   each of which waits for up to 63 of them; see the overview of
+   waiting for more than 64 objects above.  This lets sys_select watch up to MAXDESC
+   handles, and since a subprocess consumes 2 handles to be watched
+   (see above), Emacs on Windows is limited to MAX_CHILDREN
+   child_process objects.  Note that each child_process still has its
+   own reader thread, but with only 64KB of stack reserved for it.
 
    When any of the handles become signaled, sys_select does whatever
    is appropriate for the corresponding child_process object:
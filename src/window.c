@@ -199,6 +199,12 @@ wset_temslot (struct window *w, Lisp_Object val)
   w->temslot = val;
 }
 
+static void
+wset_saved_state (struct window *w, Lisp_Object val)
+{
+  w->saved_state = val;
+}
+
 static void
 wset_vertical_scroll_bar_type (struct window *w, Lisp_Object val)
 {
@@ -4563,7 +4569,7 @@ temp_output_buffer_show (register Lisp_Object buf)
 static struct window *
 allocate_window (void)
 {
-  return ALLOCATE_ZEROED_PSEUDOVECTOR (struct window, mode_line_help_echo,
+  return ALLOCATE_ZEROED_PSEUDOVECTOR (struct window, mode_line_cache,
 				       PVEC_WINDOW);
 }
 
@@ -7949,6 +7955,128 @@ get_phys_cursor_glyph (struct window *w)
 }
 
 
+/* Return true if the marker SAVED would be a copy of a marker at
+   CHARPOS in buffer B, or of a marker that points nowhere if B is
+   NULL, with insertion type INSERTION_TYPE.  */
+
+static bool
+saved_marker_matches_p (Lisp_Object saved, struct buffer *b,
+			ptrdiff_t charpos, bool insertion_type)
+{
+  struct Lisp_Marker *m = XMARKER (saved);
+
+  return (m->buffer == b
+	  && (!b || m->charpos == charpos)
+	  && m->insertion_type == insertion_type);
+}
+
+/* Return true if the saved window parameters SAVED are those that
+   save_window_save would record for window W now.  */
+
+static bool
+saved_window_parameters_match_p (struct window *w, Lisp_Object saved)
+{
+  Lisp_Object tem, pers, par, old;
+  ptrdiff_t n = 0;
+
+  for (tem = Vwindow_persistent_parameters; CONSP (tem); tem = XCDR (tem))
+    {
+      pers = XCAR (tem);
+      if (CONSP (pers) && !NILP (XCDR (pers)))
+	{
+	  par = Fassq (XCAR (pers), w->window_parameters);
+	  old = Fassq (XCAR (pers), saved);
+	  if (NILP (old) || !EQ (XCDR (old), NILP (par) ? Qnil : XCDR (par)))
+	    return false;
+	  n++;
+	}
+    }
+
+  return n == list_length (saved);
+}
+
+/* Return true if W->saved_state, the state that WINDOW had when it was
+   last saved, still describes WINDOW.  Then a new window configuration
+   can share it with the earlier ones.  The markers of a saved window
+   are never moved once they have been made, so two copies of a marker
+   at the same position with the same insertion type stay equal.  The
+   temslots of WINDOW's parent and previous sibling must have been
+   assigned already.  */
+
+static bool
+saved_window_current_p (Lisp_Object window, struct window *w)
+{
+  if (!VECTORP (w->saved_state))
+    return false;
+
+  struct saved_window *p = (struct saved_window *) XVECTOR (w->saved_state);
+
+  if (!(EQ (p->window, window)
+	&& EQ (p->buffer, WINDOW_LEAF_P (w) ? w->contents : Qnil)
+	&& EQ (p->pixel_left, make_fixnum (w->pixel_left))
+	&& EQ (p->pixel_top, make_fixnum (w->pixel_top))
+	&& EQ (p->pixel_width, make_fixnum (w->pixel_width))
+	&& EQ (p->pixel_height, make_fixnum (w->pixel_height))
+	&& EQ (p->left_col, make_fixnum (w->left_col))
+	&& EQ (p->top_line, make_fixnum (w->top_line))
+	&& EQ (p->total_cols, make_fixnum (w->total_cols))
+	&& EQ (p->total_lines, make_fixnum (w->total_lines))
+	&& EQ (p->normal_cols, w->normal_cols)
+	&& EQ (p->normal_lines, w->normal_lines)
+	&& EQ (p->hscroll, make_fixnum (w->hscroll))
+	&& NILP (p->suspend_auto_hscroll) == !w->suspend_auto_hscroll
+	&& EQ (p->min_hscroll, make_fixnum (w->min_hscroll))
+	&& EQ (p->hscroll_whole, make_fixnum (w->hscroll_whole))
+	&& EQ (p->vscroll, make_fixnum (-w->vscroll))
+	&& EQ (p->display_table, w->display_table)
+	&& EQ (p->left_margin_cols, make_fixnum (w->left_margin_cols))
+	&& EQ (p->right_margin_cols, make_fixnum (w->right_margin_cols))
+	&& EQ (p->left_fringe_width, make_fixnum (w->left_fringe_width))
+	&& EQ (p->right_fringe_width, make_fixnum (w->right_fringe_width))
+	&& NILP (p->fringes_outside_margins) == !w->fringes_outside_margins
+	&& NILP (p->fringes_persistent) == !w->fringes_persistent
+	&& EQ (p->scroll_bar_width, make_fixnum (w->scroll_bar_width))
+	&& EQ (p->scroll_bar_height, make_fixnum (w->scroll_bar_height))
+	&& NILP (p->scroll_bars_persistent) == !w->scroll_bars_persistent
+	&& EQ (p->vertical_scroll_bar_type, w->vertical_scroll_bar_type)
+	&& EQ (p->horizontal_scroll_bar_type, w->horizontal_scroll_bar_type)
+	&& EQ (p->dedicated, w->dedicated)
+	&& EQ (p->combination_limit, w->combination_limit)
+	&& EQ (p->parent,
+	       NILP (w->parent) ? Qnil : XWINDOW (w->parent)->temslot)
+	&& EQ (p->prev, NILP (w->prev) ? Qnil : XWINDOW (w->prev)->temslot)
+	&& saved_window_parameters_match_p (w, p->window_parameters)))
+    return false;
+
+  if (BUFFERP (w->contents))
+    {
+      struct buffer *b = XBUFFER (w->contents);
+      bool window_point_insertion_type
+	= !NILP (buffer_local_value (Qwindow_point_insertion_type,
+				     w->contents));
+      struct Lisp_Marker *start = XMARKER (w->start);
+      struct Lisp_Marker *pointm = XMARKER (w->pointm);
+      struct Lisp_Marker *old_pointm = XMARKER (w->old_pointm);
+
+      if (EQ (window, selected_window)
+	  ? !saved_marker_matches_p (p->pointm, b, BUF_PT (b),
+				     window_point_insertion_type)
+	  : !saved_marker_matches_p (p->pointm, pointm->buffer,
+				     pointm->charpos,
+				     window_point_insertion_type))
+	return false;
+
+      return (saved_marker_matches_p (p->old_pointm, old_pointm->buffer,
+				      old_pointm->charpos,
+				      window_point_insertion_type)
+	      && saved_marker_matches_p (p->start, start->buffer,
+					 start->charpos, false)
+	      && NILP (p->start_at_line_beg) == !w->start_at_line_beg);
+    }
+
+  return true;
+}
+
 static ptrdiff_t
 save_window_save (Lisp_Object window, struct Lisp_Vector *vector, ptrdiff_t i)
 {
@@ -7958,10 +8086,22 @@ save_window_save (Lisp_Object window, struct Lisp_Vector *vector, ptrdiff_t i)
 
   for (; !NILP (window); window = w->next)
     {
-      p = SAVED_WINDOW_N (vector, i);
       w = XWINDOW (window);
+      wset_temslot (w, make_fixnum (i));
 
-      wset_temslot (w, make_fixnum (i)); i++;
+      if (saved_window_current_p (window, w))
+	{
+	  /* Share the state saved earlier.  */
+	  vector->contents[i++] = w->saved_state;
+	  if (WINDOWP (w->contents))
+	    i = save_window_save (w->contents, vector, i);
+	  continue;
+	}
+
+      vector->contents[i] = make_nil_vector (VECSIZE (struct saved_window));
+      wset_saved_state (w, vector->contents[i]);
+      p = SAVED_WINDOW_N (vector, i);
+      i++;
       p->window = window;
       p->buffer = (WINDOW_LEAF_P (w) ? w->contents : Qnil);
       p->pixel_left = make_fixnum (w->pixel_left);
@@ -7995,49 +8135,25 @@ save_window_save (Lisp_Object window, struct Lisp_Vector *vector, ptrdiff_t i)
       p->combination_limit = w->combination_limit;
       p->window_parameters = Qnil;
 
-      if (!NILP (Vwindow_persistent_parameters))
+      for (tem = Vwindow_persistent_parameters; CONSP (tem);
+	   tem = XCDR (tem))
 	{
-	  /* Run cycle detection on Vwindow_persistent_parameters.  */
-	  Lisp_Object tortoise, hare;
-
-	  hare = tortoise = Vwindow_persistent_parameters;
-	  while (CONSP (hare))
-	    {
-	      hare = XCDR (hare);
-	      if (!CONSP (hare))
-		break;
-
-	      hare = XCDR (hare);
-	      tortoise = XCDR (tortoise);
-
-	      if (BASE_EQ (hare, tortoise))
-		/* Reset Vwindow_persistent_parameters to Qnil.  */
-		{
-		  Vwindow_persistent_parameters = Qnil;
-		  break;
-		}
-	    }
-
-	  for (tem = Vwindow_persistent_parameters; CONSP (tem);
-	       tem = XCDR (tem))
+	  pers = XCAR (tem);
+	  /* Save values for persistent window parameters. */
+	  if (CONSP (pers) && !NILP (XCDR (pers)))
 	    {
-	      pers = XCAR (tem);
-	      /* Save values for persistent window parameters. */
-	      if (CONSP (pers) && !NILP (XCDR (pers)))
-		{
-		  par = Fassq (XCAR (pers), w->window_parameters);
-		  if (NILP (par))
-		    /* If the window has no value for the parameter,
-		       make one.  */
-		    p->window_parameters = Fcons (Fcons (XCAR (pers), Qnil),
-						  p->window_parameters);
-		  else
-		    /* If the window has a value for the parameter,
-		       save it.  */
-		    p->window_parameters = Fcons (Fcons (XCAR (par),
-							 XCDR (par)),
-						  p->window_parameters);
-		}
+	      par = Fassq (XCAR (pers), w->window_parameters);
+	      if (NILP (par))
+		/* If the window has no value for the parameter,
+		   make one.  */
+		p->window_parameters = Fcons (Fcons (XCAR (pers), Qnil),
+					      p->window_parameters);
+	      else
+		/* If the window has a value for the parameter,
+		   save it.  */
+		p->window_parameters = Fcons (Fcons (XCAR (par),
+						     XCDR (par)),
+					      p->window_parameters);
 	    }
 	}
 
@@ -8119,8 +8235,34 @@ redirection (see `redirect-frame-focus').  The variable
   data->focus_frame = FRAME_FOCUS_FRAME (f);
   Lisp_Object tem = make_nil_vector (n_windows);
   data->saved_windows = tem;
-  for (ptrdiff_t i = 0; i < n_windows; i++)
-    ASET (tem, i, make_nil_vector (VECSIZE (struct saved_window)));
+
+  if (!NILP (Vwindow_persistent_parameters))
+    {
+      /* Run cycle detection on Vwindow_persistent_parameters.  */
+      Lisp_Object tortoise, hare;
+
+      hare = tortoise = Vwindow_persistent_parameters;
+      while (CONSP (hare))
+	{
+	  hare = XCDR (hare);
+	  if (!CONSP (hare))
+	    break;
+
+	  hare = XCDR (hare);
+	  tortoise = XCDR (tortoise);
+
+	  if (BASE_EQ (hare, tortoise))
+	    /* Reset Vwindow_persistent_parameters to Qnil.  */
+	    {
+	      Vwindow_persistent_parameters = Qnil;
+	      break;
+	    }
+	}
+    }
+
+  /* save_window_save shares the saved state of windows that have not
+     changed since they were last saved, so that repeatedly saving an
+     unchanged configuration allocates little.  */
   save_window_save (FRAME_ROOT_WINDOW (f), XVECTOR (tem), 0);
   XSETWINDOW_CONFIGURATION (tem, data);
   return tem;
@@ -174,6 +174,11 @@ #define WINDOW_H_INCLUDED
        bookkeeping.  */
     Lisp_Object temslot;
 
+    /* The saved_window vector that recorded this window in the most
+       recent window configuration, or nil.  Later configurations
+       share it as long as it still describes the window.  */
+    Lisp_Object saved_state;
+
     /* This window's vertical scroll bar.  This field is only for use by
        the window-system-dependent code which implements the scroll
        bars; it can store anything it likes here.  If this window is
@@ -217,8 +222,13 @@ #define WINDOW_H_INCLUDED
     /* The help echo text for this window.  Qnil if there's none.  */
     Lisp_Object mode_line_help_echo;
 
-    /* No Lisp data may follow this point; mode_line_help_echo must be
-       the last Lisp member.  */
+    /* What the last display of this window's mode line, tab line and
+       header line depended on; see display_mode_line.  A vector of
+       three elements, or nil.  */
+    Lisp_Object mode_line_cache;
+
+    /* No Lisp data may follow this point; mode_line_cache must be the
+       last Lisp member.  */
 
     /* Glyph matrices.  */
     struct glyph_matrix *current_matrix;
@@ -519,6 +529,12 @@ wset_mode_line_help_echo (struct window *w, Lisp_Object val)
   w->mode_line_help_echo = val;
 }
 
+INLINE void
+wset_mode_line_cache (struct window *w, Lisp_Object val)
+{
+  w->mode_line_cache = val;
+}
+
 INLINE void
 wset_new_pixel (struct window *w, Lisp_Object val)
 {
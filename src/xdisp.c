@@ -497,6 +497,7 @@ Copyright (C) 1985-2025 Free Software Foundation, Inc.
 #include "fontset.h"
 #include "blockinput.h"
 #include "xwidget.h"
+#include "probes.h"
 #ifdef HAVE_WINDOW_SYSTEM
 #include TERM_HEADER
 #endif /* HAVE_WINDOW_SYSTEM */
@@ -4270,6 +4271,13 @@ compute_stop_pos (struct it *it)
       pos = next_overlay_change (charpos);
       if (pos < it->stop_charpos)
 	it->stop_charpos = pos;
+      /* Likewise for the ranges of face-range-sets.  */
+      if (CONSP (Vface_range_sets))
+	{
+	  pos = next_face_range_change (it->w, charpos);
+	  if (pos < it->stop_charpos)
+	    it->stop_charpos = pos;
+	}
       /* If we are breaking compositions at point, stop at point.  */
       if (!NILP (BVAR (current_buffer, enable_multibyte_characters))
 	  && !NILP (Vauto_composition_mode)
@@ -6939,6 +6947,102 @@ compare_overlay_entries (const void *e1, const void *e2)
 }
 
 
+/* Cache of sorted overlay strings.
+
+   load_overlay_strings is called at every position where an overlay
+   starts or ends, and again for each further chunk of
+   OVERLAY_STRING_CHUNK_SIZE strings at such a position; the move_it_*
+   functions make redisplay pass over the same positions many times.
+   With many overlay strings at a position, looking up their
+   properties and sorting them each time is expensive, so we remember
+   the sorted strings for the last few positions that had more than
+   one of them.
+
+   Each element of overlay_string_cache is either nil or a vector
+   [BUFFER WINDOW INVISIBILITY-SPEC STRING1 OVERLAY1 STRING2 OVERLAY2
+   ...], and the element of overlay_string_cache_keys with the same
+   index records the position and buffer modification counts it was
+   computed for.  Changing the
+   text, or an overlay or its properties, invalidates the entries of
+   a buffer.  Since the invisibility of overlays also depends on
+   `buffer-invisibility-spec', and the properties of overlays on the
+   plists of their `category' symbols, the cache is also emptied at
+   the start of every redisplay cycle.  */
+
+#define OVERLAY_STRING_CACHE_SIZE 8
+
+static Lisp_Object overlay_string_cache;
+
+static struct overlay_string_cache_key
+{
+  ptrdiff_t charpos;
+  modiff_count modiff, overlay_modiff;
+} overlay_string_cache_keys[OVERLAY_STRING_CACHE_SIZE];
+
+/* The element of overlay_string_cache to replace next.  */
+static int overlay_string_cache_next;
+
+/* Empty the cache of sorted overlay strings.  */
+
+static void
+clear_overlay_string_cache (void)
+{
+  for (int i = 0; i < OVERLAY_STRING_CACHE_SIZE; i++)
+    ASET (overlay_string_cache, i, Qnil);
+}
+
+/* Return the cached overlay strings at CHARPOS for IT, or nil if they
+   aren't in the cache.  */
+
+static Lisp_Object
+lookup_overlay_string_cache (struct it *it, ptrdiff_t charpos)
+{
+  for (int i = 0; i < OVERLAY_STRING_CACHE_SIZE; i++)
+    {
+      Lisp_Object entry = AREF (overlay_string_cache, i);
+      struct overlay_string_cache_key *key = &overlay_string_cache_keys[i];
+
+      if (!NILP (entry)
+	  && key->charpos == charpos
+	  && XBUFFER (AREF (entry, 0)) == current_buffer
+	  && XWINDOW (AREF (entry, 1)) == it->w
+	  && key->modiff == MODIFF
+	  && key->overlay_modiff == OVERLAY_MODIFF
+	  && EQ (AREF (entry, 2), BVAR (current_buffer, invisibility_spec)))
+	return entry;
+    }
+  return Qnil;
+}
+
+/* Record the N sorted overlay strings in ENTRIES as those at CHARPOS
+   for IT.  */
+
+static void
+record_overlay_string_cache (struct it *it, ptrdiff_t charpos,
+			     struct overlay_entry *entries, ptrdiff_t n)
+{
+  int i = overlay_string_cache_next;
+  Lisp_Object entry = make_nil_vector (3 + 2 * n);
+  Lisp_Object buffer, window;
+
+  XSETBUFFER (buffer, current_buffer);
+  XSETWINDOW (window, it->w);
+  ASET (entry, 0, buffer);
+  ASET (entry, 1, window);
+  ASET (entry, 2, BVAR (current_buffer, invisibility_spec));
+  for (ptrdiff_t j = 0; j < n; j++)
+    {
+      ASET (entry, 3 + 2 * j, entries[j].string);
+      ASET (entry, 4 + 2 * j, entries[j].overlay);
+    }
+
+  ASET (overlay_string_cache, i, entry);
+  overlay_string_cache_keys[i].charpos = charpos;
+  overlay_string_cache_keys[i].modiff = MODIFF;
+  overlay_string_cache_keys[i].overlay_modiff = OVERLAY_MODIFF;
+  overlay_string_cache_next = (i + 1) % OVERLAY_STRING_CACHE_SIZE;
+}
+
 /* Load the vector IT->overlay_strings with overlay strings from IT's
    current buffer position, or from CHARPOS if that is > 0.  Set
    IT->n_overlays to the total number of overlay strings found.
@@ -6977,6 +7081,22 @@ load_overlay_strings (struct it *it, ptrdiff_t charpos)
   if (charpos <= 0)
     charpos = IT_CHARPOS (*it);
 
+  Lisp_Object cached = lookup_overlay_string_cache (it, charpos);
+  if (!NILP (cached))
+    {
+      n = (ASIZE (cached) - 3) / 2;
+      it->n_overlay_strings = n;
+      it->overlay_strings_charpos = charpos;
+      ptrdiff_t j = it->current.overlay_string_index;
+      for (ptrdiff_t i = 0; i < OVERLAY_STRING_CHUNK_SIZE && j < n; i++, j++)
+	{
+	  it->overlay_strings[i] = AREF (cached, 3 + 2 * j);
+	  it->string_overlays[i] = AREF (cached, 4 + 2 * j);
+	}
+      CHECK_IT (it);
+      return;
+    }
+
   /* Append the overlay string STRING of overlay OVERLAY to vector
      `entries' which has size `size' and currently contains `n'
      elements.  AFTER_P means STRING is an after-string of
@@ -7044,9 +7164,12 @@ #define RECORD_OVERLAY_STRING(OVERLAY, STRING, AFTER_P)			\
 
 #undef RECORD_OVERLAY_STRING
 
-  /* Sort entries.  */
+  /* Sort entries, and remember the result.  */
   if (n > 1)
-    qsort (entries, n, sizeof *entries, compare_overlay_entries);
+    {
+      qsort (entries, n, sizeof *entries, compare_overlay_entries);
+      record_overlay_string_cache (it, charpos, entries, n);
+    }
 
   /* Record number of overlay strings, and where we computed it.  */
   it->n_overlay_strings = n;
@@ -9243,7 +9366,15 @@ get_visually_first_element (struct it *it)
     }
   else
     {
+      ptrdiff_t orig_charpos = it->bidi_it.charpos;
       ptrdiff_t orig_bytepos = it->bidi_it.bytepos;
+      /* In long lines, resume from and record checkpoints of the bidi
+	 iterator; see "Checkpoints of the bidi iterator" in bidi.c.  */
+      bool checkpoints_p
+	= (!string_p
+	   && current_buffer->long_line_optimizations_p
+	   && !NILP (BVAR (current_buffer, cache_long_scans)));
+      ptrdiff_t line_start, next_checkpoint = PTRDIFF_MAX;
 
       /* We need to prime the bidi iterator starting at the line's or
 	 string's beginning, before we will be able to produce the
@@ -9256,15 +9387,24 @@ get_visually_first_element (struct it *it)
 						      IT_BYTEPOS (*it), -1,
 						      &it->bidi_it.bytepos),
 				it->medium_narrowing_begv);
+      line_start = it->bidi_it.charpos;
       bidi_paragraph_init (it->paragraph_embedding, &it->bidi_it, true);
-      do
-	{
-	  /* Now return to buffer/string position where we were asked
-	     to get the next display element, and produce that.  */
-	  bidi_move_to_visually_next (&it->bidi_it);
-	}
-      while (it->bidi_it.bytepos != orig_bytepos
-	     && it->bidi_it.charpos < eob);
+      if (checkpoints_p)
+	next_checkpoint = bidi_resume_from_checkpoint (&it->bidi_it,
+						       line_start,
+						       orig_charpos);
+      if (it->bidi_it.first_elt || it->bidi_it.bytepos != orig_bytepos)
+	do
+	  {
+	    /* Now return to buffer/string position where we were asked
+	       to get the next display element, and produce that.  */
+	    bidi_move_to_visually_next (&it->bidi_it);
+	    if (it->bidi_it.charpos >= next_checkpoint)
+	      next_checkpoint = bidi_record_checkpoint (&it->bidi_it,
+							line_start);
+	  }
+	while (it->bidi_it.bytepos != orig_bytepos
+	       && it->bidi_it.charpos < eob);
     }
 
   /*  Adjust IT's position information to where we ended up.  */
@@ -10732,6 +10872,346 @@ move_it_in_display_line (struct it *it,
 }
 
 
+/***********************************************************************
+			   Line height cache
+ ***********************************************************************/
+
+/* The line height cache of a buffer remembers, for logical lines that
+   move_it_to has laid out from their beginning to the beginning of the
+   next line, how many screen lines they took, how tall they were, and
+   where the next line starts.  When move_it_to later arrives at the
+   beginning of such a line, it can skip the whole line without laying
+   it out again, if the line lies entirely before the place where it
+   should stop.  This makes pixel-wise scrolling, pos-visible-in-window-p
+   and window-text-pixel-size much cheaper in large buffers.
+
+   The layout of a line depends on the window and on many settings, so
+   the cache records these settings, and is flushed when a call to
+   move_it_to finds them changed.  Buffer modifications invalidate only
+   the entries for lines in the region recorded by BEG_UNCHANGED and
+   END_UNCHANGED, the same region that try_window_id examines, with the
+   entries after that region shifted to their new positions.  */
+
+/* Number of entries in a line height cache.  The cache is direct
+   mapped: the entry of a line is determined by its start position.  */
+
+#define LINE_HEIGHT_CACHE_SIZE 1021
+
+struct line_height_cache_entry
+{
+  /* Start of the line, and start of the next line.  START is zero if
+     this entry is unused.  */
+  ptrdiff_t start, end, end_byte;
+
+  /* The total pixel height and the number of screen lines of the
+     line, the height of its last screen line, and the largest
+     current_x reached on its screen lines.  */
+  int height, nlines, last_height, max_x;
+};
+
+/* Settings on which the layout of buffer text depends.  */
+
+struct line_height_cache_context
+{
+  Lisp_Object window;
+  Lisp_Object invisibility_spec, face_remapping_alist;
+  Lisp_Object line_prefix, wrap_prefix;
+  struct Lisp_Char_Table *dp;
+  ptrdiff_t begv, zv_from_end, selective;
+  EMACS_INT face_generation;
+  int first_visible_x, last_visible_x, extra_line_spacing;
+  int base_face_id, tab_width;
+  enum line_wrap_method line_wrap;
+  bool ctl_arrow_p, multibyte_p;
+};
+
+struct line_height_cache
+{
+  struct line_height_cache_context context;
+
+  /* The state of the buffer text when the entries were last known to
+     be valid.  */
+  modiff_count modiff, overlay_modiff;
+  ptrdiff_t z, z_byte;
+
+  struct line_height_cache_entry entries[LINE_HEIGHT_CACHE_SIZE];
+};
+
+/* Incremented whenever realized faces are freed, which can change the
+   fonts, and thus the height of every line.  */
+
+static EMACS_INT line_height_cache_face_generation;
+
+void
+invalidate_line_height_caches (void)
+{
+  line_height_cache_face_generation++;
+}
+
+void
+free_line_height_cache (struct buffer *b)
+{
+  xfree (b->line_height_cache);
+  b->line_height_cache = NULL;
+}
+
+void
+mark_line_height_cache (struct line_height_cache *cache)
+{
+  mark_object (cache->context.window);
+  mark_object (cache->context.invisibility_spec);
+  mark_object (cache->context.face_remapping_alist);
+  mark_object (cache->context.line_prefix);
+  mark_object (cache->context.wrap_prefix);
+}
+
+static void
+line_height_cache_context (struct it *it,
+			   struct line_height_cache_context *context)
+{
+  /* Clear the padding as well, so that contexts can be compared with
+     memcmp.  */
+  memset (context, 0, sizeof *context);
+  XSETWINDOW (context->window, it->w);
+  context->invisibility_spec = BVAR (current_buffer, invisibility_spec);
+  context->face_remapping_alist = Vface_remapping_alist;
+  context->line_prefix = find_symbol_value (Qline_prefix);
+  context->wrap_prefix = find_symbol_value (Qwrap_prefix);
+  context->dp = it->dp;
+  context->begv = BEGV;
+  context->zv_from_end = Z - ZV;
+  context->selective = it->selective;
+  context->face_generation = line_height_cache_face_generation;
+  context->first_visible_x = it->first_visible_x;
+  context->last_visible_x = it->last_visible_x;
+  context->extra_line_spacing = it->extra_line_spacing;
+  context->base_face_id = it->base_face_id;
+  context->tab_width = it->tab_width;
+  context->line_wrap = it->line_wrap;
+  context->ctl_arrow_p = it->ctl_arrow_p;
+  context->multibyte_p = it->multibyte_p;
+}
+
+/* Drop the entries of CACHE for lines that the buffer modifications
+   since CACHE was last validated could have changed, and move the
+   entries after the modified region to their new positions.  Flush
+   CACHE entirely if the modified region is unknown.  */
+
+static void
+line_height_cache_adjust (struct line_height_cache *cache, struct buffer *b)
+{
+  /* BEG_UNCHANGED and END_UNCHANGED describe the changes made since
+     the last redisplay of B, so they can only be used if CACHE was up
+     to date after that redisplay.  When the paragraph direction of the
+     text is determined from the text itself, a change can affect the
+     layout of the whole paragraph, so don't try to be clever then.  */
+  if (cache->modiff < BUF_UNCHANGED_MODIFIED (b)
+      || cache->overlay_modiff < BUF_OVERLAY_UNCHANGED_MODIFIED (b)
+      || (!NILP (BVAR (b, bidi_display_reordering))
+	  && NILP (BVAR (b, bidi_paragraph_direction))))
+    memset (cache->entries, 0, sizeof cache->entries);
+  else
+    {
+      ptrdiff_t prefix_end = BUF_BEG (b) + BUF_BEG_UNCHANGED (b);
+      ptrdiff_t suffix_start = cache->z - BUF_END_UNCHANGED (b);
+      ptrdiff_t delta = BUF_Z (b) - cache->z;
+      ptrdiff_t delta_byte = BUF_Z_BYTE (b) - cache->z_byte;
+      struct line_height_cache_entry *suffix;
+      int nsuffix = 0;
+      USE_SAFE_ALLOCA;
+
+      SAFE_NALLOCA (suffix, 1, LINE_HEIGHT_CACHE_SIZE);
+      for (int i = 0; i < LINE_HEIGHT_CACHE_SIZE; i++)
+	{
+	  struct line_height_cache_entry *e = &cache->entries[i];
+
+	  if (e->start == 0 || e->end <= prefix_end)
+	    continue;
+
+	  /* The newline before the line must be unchanged as well.  */
+	  bool unchanged = e->start - 1 >= suffix_start;
+	  if (unchanged && delta == 0 && delta_byte == 0)
+	    continue;
+	  if (unchanged)
+	    {
+	      suffix[nsuffix] = *e;
+	      suffix[nsuffix].start += delta;
+	      suffix[nsuffix].end += delta;
+	      suffix[nsuffix].end_byte += delta_byte;
+	      nsuffix++;
+	    }
+	  e->start = 0;
+	}
+      for (int i = 0; i < nsuffix; i++)
+	cache->entries[suffix[i].start % LINE_HEIGHT_CACHE_SIZE] = suffix[i];
+      SAFE_FREE ();
+    }
+  cache->modiff = BUF_MODIFF (b);
+  cache->overlay_modiff = BUF_OVERLAY_MODIFF (b);
+  cache->z = BUF_Z (b);
+  cache->z_byte = BUF_Z_BYTE (b);
+}
+
+/* Return the line height cache that move_it_to can use for IT, or
+   NULL if none.  Allocate the cache of the current buffer if needed,
+   and bring it up to date.  */
+
+static struct line_height_cache *
+line_height_cache_for_it (struct it *it)
+{
+  if (!cache_line_heights
+      || face_change || it->f->face_change
+      || !NILP (Vdisplay_line_numbers)
+      || current_buffer->long_line_optimizations_p
+      || !BUFFERP (it->w->contents)
+      || XBUFFER (it->w->contents) != current_buffer
+      || it->glyph_row)
+    return NULL;
+
+  struct buffer *b = current_buffer;
+  struct line_height_cache *cache = b->line_height_cache;
+  struct line_height_cache_context context;
+
+  line_height_cache_context (it, &context);
+  if (!cache)
+    {
+      cache = b->line_height_cache = xzalloc (sizeof *cache);
+      cache->context = context;
+      cache->modiff = BUF_MODIFF (b);
+      cache->overlay_modiff = BUF_OVERLAY_MODIFF (b);
+      cache->z = BUF_Z (b);
+      cache->z_byte = BUF_Z_BYTE (b);
+    }
+  else if (memcmp (&context, &cache->context, sizeof context) != 0)
+    {
+      memset (cache->entries, 0, sizeof cache->entries);
+      cache->context = context;
+      cache->modiff = BUF_MODIFF (b);
+      cache->overlay_modiff = BUF_OVERLAY_MODIFF (b);
+      cache->z = BUF_Z (b);
+      cache->z_byte = BUF_Z_BYTE (b);
+    }
+  else if (cache->modiff != BUF_MODIFF (b)
+	   || cache->overlay_modiff != BUF_OVERLAY_MODIFF (b))
+    line_height_cache_adjust (cache, b);
+  return cache;
+}
+
+/* Return true if CACHE is still valid, i.e. the buffer was not
+   modified since move_it_to started using it; fontification
+   functions called by the display code could have modified it.  */
+
+static bool
+line_height_cache_valid_p (struct line_height_cache *cache)
+{
+  return (cache->modiff == MODIFF
+	  && cache->overlay_modiff == OVERLAY_MODIFF);
+}
+
+/* Return true if IT is at the beginning of a logical line, i.e. right
+   after a newline or at BEGV, on the first screen line of that line,
+   and without any pending work at that position.  */
+
+static bool
+line_height_cache_line_start_p (struct it *it)
+{
+  return (it->method == GET_FROM_BUFFER
+	  && it->sp == 0
+	  && it->current_x == 0
+	  && it->hpos == 0
+	  && it->continuation_lines_width == 0
+	  && !it->dpvec
+	  && it->cmp_it.id < 0
+	  && it->area == TEXT_AREA
+	  && IT_CHARPOS (*it) < it->stop_charpos
+	  && (!it->bidi_p || it->bidi_it.scan_dir != -1)
+	  && (IT_CHARPOS (*it) == BEGV
+	      || (IT_CHARPOS (*it) > BEGV && IT_CHARPOS (*it) <= ZV
+		  && FETCH_BYTE (IT_BYTEPOS (*it) - 1) == '\n')));
+}
+
+/* Return the entry of CACHE for the line that starts at CHARPOS, or
+   NULL if there is none.  */
+
+static struct line_height_cache_entry *
+line_height_cache_lookup (struct line_height_cache *cache, ptrdiff_t charpos)
+{
+  struct line_height_cache_entry *e
+    = &cache->entries[charpos % LINE_HEIGHT_CACHE_SIZE];
+
+  return (e->start == charpos && e->end <= ZV) ? e : NULL;
+}
+
+/* Record in CACHE that the logical line starting at START, which IT
+   has just laid out, took NLINES screen lines and HEIGHT pixels, and
+   that MAX_X was the largest current_x on its screen lines.  IT is at
+   the beginning of the next line.  */
+
+static void
+line_height_cache_put (struct line_height_cache *cache, ptrdiff_t start,
+		       struct it *it, int height, int nlines, int max_x)
+{
+  struct line_height_cache_entry *e
+    = &cache->entries[start % LINE_HEIGHT_CACHE_SIZE];
+
+  e->start = start;
+  e->end = IT_CHARPOS (*it);
+  e->end_byte = IT_BYTEPOS (*it);
+  e->height = height;
+  e->nlines = nlines;
+  e->last_height = last_height;
+  e->max_x = max_x;
+}
+
+/* Move IT, which is at the beginning of a logical line, over the
+   lines recorded in CACHE, as long as they end before the place
+   specified by TO_CHARPOS, TO_Y, TO_VPOS and OP where move_it_to
+   should stop.  Update *MAX_X with the largest current_x of the lines
+   skipped.  */
+
+static void
+line_height_cache_skip (struct it *it, struct line_height_cache *cache,
+			ptrdiff_t to_charpos, int to_y, int to_vpos, int op,
+			int *max_x)
+{
+  struct line_height_cache_entry *e;
+
+  while (line_height_cache_line_start_p (it)
+	 && (e = line_height_cache_lookup (cache, IT_CHARPOS (*it))))
+    {
+      if (op & MOVE_TO_POS)
+	{
+	  if (to_charpos < e->end)
+	    break;
+	}
+      else if (!(op & (MOVE_TO_VPOS | MOVE_TO_Y)))
+	break;
+      if (op & MOVE_TO_VPOS)
+	{
+	  if (it->vpos + e->nlines > to_vpos)
+	    break;
+	}
+      else if ((op & MOVE_TO_Y) && it->current_y + e->height > to_y)
+	break;
+
+      /* Put IT where laying out the line would have left it.  */
+      struct text_pos pos;
+      SET_TEXT_POS (pos, e->end, e->end_byte);
+      it->current_y += e->height;
+      it->vpos += e->nlines;
+      last_height = e->last_height;
+      *max_x = max (*max_x, e->max_x);
+      if (!IT_OVERFLOW_NEWLINE_INTO_FRINGE (it))
+	it->override_ascent = -1;
+      reseat (it, pos, true);
+      it->current_x = it->hpos = 0;
+      it->wrap_prefix_width = 0;
+      it->continuation_lines_width = 0;
+      it->line_number_produced_p = false;
+      it->max_ascent = it->max_descent = 0;
+    }
+}
+
 /* Move IT forward until it satisfies one or more of the criteria in
    TO_CHARPOS, TO_X, TO_Y, and TO_VPOS.
 
@@ -10753,9 +11233,40 @@ move_it_to (struct it *it, ptrdiff_t to_charpos, int to_x, int to_y, int to_vpos
   int line_height, line_start_x = 0, reached = 0;
   int max_current_x = 0;
   void *backup_data = NULL;
+  struct line_height_cache *lh_cache = line_height_cache_for_it (it);
+  /* Where the logical line being laid out started, if it should be
+     recorded in LH_CACHE, and the largest current_x before it.  */
+  ptrdiff_t lh_start = 0;
+  int lh_y UNINIT, lh_vpos UNINIT, lh_max_x = 0;
 
   for (;;)
     {
+      if (lh_cache && !line_height_cache_valid_p (lh_cache))
+	{
+	  lh_cache = NULL;
+	  lh_start = 0;
+	}
+      else if (lh_cache && line_height_cache_line_start_p (it))
+	{
+	  if (lh_start > 0 && it->vpos > lh_vpos)
+	    line_height_cache_put (lh_cache, lh_start, it,
+				   it->current_y - lh_y, it->vpos - lh_vpos,
+				   max_current_x);
+	  max_current_x = max (max_current_x, lh_max_x);
+	  line_height_cache_skip (it, lh_cache, to_charpos, to_y, to_vpos,
+				  op, &max_current_x);
+	  lh_start = 0;
+	  lh_max_x = 0;
+	  if (line_height_cache_line_start_p (it))
+	    {
+	      lh_start = IT_CHARPOS (*it);
+	      lh_y = it->current_y;
+	      lh_vpos = it->vpos;
+	      lh_max_x = max_current_x;
+	      max_current_x = 0;
+	    }
+	}
+
       if (op & MOVE_TO_VPOS)
 	{
 	  /* If no TO_CHARPOS and no TO_X specified, stop at the
@@ -11078,7 +11589,7 @@ move_it_to (struct it *it, ptrdiff_t to_charpos, int to_x, int to_y, int to_vpos
 
   move_trace ("move_it_to: reached %d\n", reached);
 
-  return max_current_x;
+  return max (max_current_x, lh_max_x);
 }
 
 
@@ -12456,6 +12967,12 @@ message3_nolog (Lisp_Object m)
       else
 	clear_message (true, true);
 
+      /* Like other redisplay, showing the message can wait until a
+	 keyboard macro has finished; redisplay_internal then displays
+	 the last message.  */
+      if (!NILP (Vexecuting_kbd_macro))
+	return;
+
       do_pending_window_change (false);
       echo_area_display (true);
       do_pending_window_change (false);
@@ -16724,6 +17241,138 @@ debug_method_add (struct window *w, char const *fmt, ...)
 #endif /* GLYPH_DEBUG */
 
 
+/***********************************************************************
+			    Redisplay Tracing
+ ***********************************************************************/
+
+/* Ring of the last redisplay-trace-size window redisplays, or nil.
+   Each used slot holds a vector [CYCLE WINDOW METHOD ROWS NSECS] that
+   is reused when the ring wraps around, so that recording a window
+   doesn't cons once the ring is full.  */
+
+static Lisp_Object redisplay_trace_ring;
+
+/* Index of the slot of redisplay_trace_ring to fill next.  */
+
+static ptrdiff_t redisplay_trace_next;
+
+/* Number of traced redisplay cycles, and the time the current one
+   started.  */
+
+static EMACS_INT redisplay_trace_cycle;
+static struct timespec redisplay_trace_cycle_start;
+
+/* Symbol naming the method that produced the desired matrix of the
+   window being redisplayed, or nil if none did.  */
+
+static Lisp_Object redisplay_trace_method;
+
+/* Largest number of entries redisplay_trace_ring can hold.  */
+
+enum { REDISPLAY_TRACE_MAX_SIZE = 1 << 16 };
+
+/* Record that window W was redisplayed by METHOD, redrawing ROWS rows,
+   in the time since START.  */
+
+static void
+redisplay_trace_record (struct window *w, Lisp_Object method, int rows,
+			struct timespec start)
+{
+  ptrdiff_t size = min (redisplay_trace_size, REDISPLAY_TRACE_MAX_SIZE);
+  struct timespec elapsed = timespec_sub (current_timespec (), start);
+  Lisp_Object entry;
+
+  if (!VECTORP (redisplay_trace_ring)
+      || ASIZE (redisplay_trace_ring) != size)
+    {
+      redisplay_trace_ring = make_nil_vector (size);
+      redisplay_trace_next = 0;
+    }
+  entry = AREF (redisplay_trace_ring, redisplay_trace_next);
+  if (NILP (entry))
+    {
+      entry = make_nil_vector (5);
+      ASET (redisplay_trace_ring, redisplay_trace_next, entry);
+    }
+  ASET (entry, 0, make_int (redisplay_trace_cycle));
+  ASET (entry, 1, make_lisp_ptr (w, Lisp_Vectorlike));
+  ASET (entry, 2, method);
+  ASET (entry, 3, make_fixnum (rows));
+  ASET (entry, 4, make_int (elapsed.tv_sec * (intmax_t) 1000000000
+			    + elapsed.tv_nsec));
+  redisplay_trace_next = (redisplay_trace_next + 1) % size;
+}
+
+/* Return the number of rows of W's desired matrix that will be drawn
+   when W is updated.  */
+
+static int
+redisplay_trace_rows (struct window *w)
+{
+  struct glyph_matrix *matrix = w->desired_matrix;
+  int i, rows = 0;
+
+  for (i = 0; i < matrix->nrows; i++)
+    if (MATRIX_ROW (matrix, i)->enabled_p)
+      rows++;
+  return rows;
+}
+
+DEFUN ("redisplay-trace", Fredisplay_trace, Sredisplay_trace, 0, 1, 0,
+       doc: /* Return the recent history of window redisplay.
+The value is a list with an element for each of the last
+`redisplay-trace-size' windows redisplayed, oldest first.  Each
+element has the form (CYCLE WINDOW METHOD ROWS TIME), where CYCLE
+counts the redisplay cycles since tracing started, WINDOW is the
+window redisplayed, ROWS is the number of its glyph rows that were
+redrawn, and TIME is the number of seconds it took, as a float.
+
+METHOD says how redisplay produced the window's contents:
+
+ `try-cursor-movement'  only the cursor moved;
+ `current-line'         only the line showing point was redrawn;
+ `try-window-id'        the unchanged rows were kept, scrolling them if
+                        necessary, and only the changed text was drawn;
+ `try-window-reusing-current-matrix'
+                        rows of the last display were reused, and new
+                        ones were drawn only where the window start
+                        moved;
+ `try-window'           the whole window was drawn from scratch.
+
+Windows that didn't need to be redisplayed are not recorded.
+If CLEAR is non-nil, discard the history after returning it.  */)
+  (Lisp_Object clear)
+{
+  Lisp_Object result = Qnil;
+
+  if (VECTORP (redisplay_trace_ring))
+    {
+      ptrdiff_t size = ASIZE (redisplay_trace_ring);
+
+      for (ptrdiff_t i = 0; i < size; i++)
+	{
+	  Lisp_Object entry
+	    = AREF (redisplay_trace_ring, (redisplay_trace_next + i) % size);
+
+	  if (!NILP (entry))
+	    {
+	      double secs = XFLOATINT (AREF (entry, 4)) / 1e9;
+	      result = Fcons (list5 (AREF (entry, 0), AREF (entry, 1),
+				     AREF (entry, 2), AREF (entry, 3),
+				     make_float (secs)),
+			      result);
+	    }
+	}
+    }
+  if (!NILP (clear))
+    {
+      redisplay_trace_ring = Qnil;
+      redisplay_trace_next = 0;
+    }
+  return Fnreverse (result);
+}
+
+
 /* Value is true if all changes in window W, which displays
    current_buffer, are in the text between START and END.  START is a
    buffer position, END is given as a distance from Z.  Used in
@@ -17136,11 +17785,31 @@ redisplay_internal (void)
     return;
 #endif
 
+  /* Discard old compositions now, if the composition cache grew too
+     large since the previous redisplay.  */
+  composition_gstring_cache_maybe_evict ();
+
+#ifdef HAVE_WINDOW_SYSTEM
+  /* Give this cycle its full budget for decoding images.  */
+  image_start_redisplay_cycle ();
+#endif
+
+  /* Overlay strings may depend on things that the cache of sorted
+     overlay strings doesn't check; see there.  */
+  clear_overlay_string_cache ();
+
+  if (redisplay_trace_size > 0)
+    {
+      redisplay_trace_cycle++;
+      redisplay_trace_cycle_start = current_timespec ();
+    }
+
   /* Record a function that clears redisplaying_p
      when we leave this function.  */
   specpdl_ref count = SPECPDL_INDEX ();
   record_unwind_protect_void (unwind_redisplay);
   redisplaying_p = true;
+  EMACS_PROBE (redisplay_start);
   block_buffer_flips ();
   specbind (Qinhibit_free_realized_faces, Qnil);
 
@@ -17477,6 +18146,9 @@ #define AINC(a,i)							\
 	      *w->desired_matrix->method = 0;
 	      debug_method_add (w, "optimization 1");
 #endif
+	      if (redisplay_trace_size > 0)
+		redisplay_trace_record (w, Qcurrent_line, 1,
+					redisplay_trace_cycle_start);
 #ifdef HAVE_WINDOW_SYSTEM
 	      update_window_fringes (w, false);
 #endif
@@ -17559,6 +18231,9 @@ #define AINC(a,i)							\
 		  *w->desired_matrix->method = 0;
 		  debug_method_add (w, "optimization 3");
 #endif
+		  if (redisplay_trace_size > 0)
+		    redisplay_trace_record (w, Qtry_cursor_movement, 0,
+					    redisplay_trace_cycle_start);
 		  goto update;
 		}
 	      else
@@ -17928,7 +18603,8 @@ #define AINC(a,i)							\
     }
 
 #ifdef HAVE_WINDOW_SYSTEM
-  if (clear_image_cache_count > CLEAR_IMAGE_CACHE_COUNT)
+  if (clear_image_cache_count > CLEAR_IMAGE_CACHE_COUNT
+      || image_caches_over_budget_p ())
     {
       clear_image_caches (Qnil);
       clear_image_cache_count = 0;
@@ -17948,6 +18624,10 @@ #define AINC(a,i)							\
     update_redisplay_ticks (0, NULL);
 
   unbind_to (count, Qnil);
+
+  /* The display now shows the effects of the last command, since
+     unbinding showed any back buffers.  */
+  note_input_latency_display ();
   RESUME_POLLING;
 }
 
@@ -18000,6 +18680,7 @@ redisplay_preserve_echo_area (int from_where)
 static void
 unwind_redisplay (void)
 {
+  EMACS_PROBE (redisplay_done);
   redisplaying_p = false;
   unblock_buffer_flips ();
 }
@@ -18253,11 +18934,32 @@ redisplay_window_error (Lisp_Object error_data)
   return Qnil;
 }
 
+/* Call redisplay_window for WINDOW and JUST_THIS_ONE_P, and record in
+   the redisplay trace how it went, if tracing is enabled.  */
+
+static void
+redisplay_window_and_trace (Lisp_Object window, bool just_this_one_p)
+{
+  if (redisplay_trace_size <= 0)
+    redisplay_window (window, just_this_one_p);
+  else
+    {
+      struct timespec start = current_timespec ();
+
+      redisplay_trace_method = Qnil;
+      redisplay_window (window, just_this_one_p);
+      if (!NILP (redisplay_trace_method) && WINDOW_LIVE_P (window))
+	redisplay_trace_record (XWINDOW (window), redisplay_trace_method,
+				redisplay_trace_rows (XWINDOW (window)),
+				start);
+    }
+}
+
 static Lisp_Object
 redisplay_window_0 (Lisp_Object window)
 {
   if (displayed_buffer->display_error_modiff < BUF_MODIFF (displayed_buffer))
-    redisplay_window (window, false);
+    redisplay_window_and_trace (window, false);
   return Qnil;
 }
 
@@ -18265,7 +18967,7 @@ redisplay_window_0 (Lisp_Object window)
 redisplay_window_1 (Lisp_Object window)
 {
   if (displayed_buffer->display_error_modiff < BUF_MODIFF (displayed_buffer))
-    redisplay_window (window, true);
+    redisplay_window_and_trace (window, true);
   return Qnil;
 }
 
@@ -20660,6 +21362,7 @@ redisplay_window (Lisp_Object window, bool just_this_one_p)
 	{
 	case CURSOR_MOVEMENT_SUCCESS:
 	  used_current_matrix_p = true;
+	  redisplay_trace_method = Qtry_cursor_movement;
 	  goto done;
 
 	case CURSOR_MOVEMENT_MUST_SCROLL:
@@ -20697,7 +21400,10 @@ redisplay_window (Lisp_Object window, bool just_this_one_p)
       if (f->fonts_changed)
 	goto need_larger_matrices;
       if (tem > 0)
-	goto done;
+	{
+	  redisplay_trace_method = Qtry_window_id;
+	  goto done;
+	}
 
       /* Otherwise try_window_id has returned -1 which means that we
 	 don't want the alternative below this comment to execute.  */
@@ -21480,6 +22186,7 @@ try_window (Lisp_Object window, struct text_pos pos, int flags)
 
   /* But that is not valid info until redisplay finishes.  */
   w->window_end_valid = false;
+  redisplay_trace_method = Qtry_window;
   return 1;
 }
 
@@ -21747,6 +22454,7 @@ try_window_reusing_current_matrix (struct window *w)
 #ifdef GLYPH_DEBUG
       debug_method_add (w, "try_window_reusing_current_matrix 1");
 #endif
+      redisplay_trace_method = Qtry_window_reusing_current_matrix;
       return true;
     }
   else if (CHARPOS (new_start) > CHARPOS (start))
@@ -21936,6 +22644,7 @@ try_window_reusing_current_matrix (struct window *w)
 #ifdef GLYPH_DEBUG
       debug_method_add (w, "try_window_reusing_current_matrix 2");
 #endif
+      redisplay_trace_method = Qtry_window_reusing_current_matrix;
       return true;
     }
 
@@ -27684,6 +28393,338 @@ display_mode_lines (struct window *w)
 }
 
 
+/* Mode line cache.
+
+   Displaying a mode, tab or header line walks the whole format and
+   produces glyphs for every element of it, which is wasted work when
+   the line comes out the same as the last time.  So while
+   display_mode_element walks a format for display, it records the
+   inputs of the walk in the order it consumes them: the value of each
+   symbol it looks at, the result of each :eval form, and the text of
+   each %-construct.  The next time the window's line is displayed,
+   mode_line_cache_valid_p goes through these probes again; if every
+   input still has the value it had, the walk would produce the glyphs
+   that are already in the current matrix, and display_mode_line copies
+   them from there instead.
+
+   The :eval forms and %-constructs are still evaluated, since that is
+   the only way to tell whether their results changed, and since their
+   side effects (e.g. the line number cache of %l) are relied upon.
+   When a probe doesn't match, the :eval results computed so far are
+   passed through mode_line_cache_replay to the walk that follows, so
+   that no form is evaluated twice.  */
+
+/* Indices into a window's mode line cache entry.  */
+enum mode_line_cache_index
+  {
+    MODE_LINE_CACHE_FORMAT,
+    MODE_LINE_CACHE_FACE_ID,
+    MODE_LINE_CACHE_WIDTH,
+    MODE_LINE_CACHE_DISPLAY_TABLE,
+    MODE_LINE_CACHE_FACE_REMAPPING,
+    MODE_LINE_CACHE_PROBES,
+    MODE_LINE_CACHE_HASH,
+    MODE_LINE_CACHE_USED,
+    MODE_LINE_CACHE_HEIGHT,
+    MODE_LINE_CACHE_ENTRY_SIZE
+  };
+
+/* The probes recorded by display_mode_element, most recent first, or
+   Qt if no probes are being recorded.  */
+
+static Lisp_Object mode_line_cache_probes;
+
+/* Results of :eval forms evaluated by mode_line_cache_valid_p, for the
+   display_mode_element walk that follows to use instead of evaluating
+   the forms again.  */
+
+static Lisp_Object mode_line_cache_replay;
+
+/* True if display_mode_element should record the inputs it uses.  */
+
+static bool
+mode_line_cache_recording_p (void)
+{
+  return (mode_line_target == MODE_LINE_DISPLAY
+	  && !EQ (mode_line_cache_probes, Qt));
+}
+
+static void
+restore_mode_line_cache (Lisp_Object saved)
+{
+  mode_line_cache_probes = XCAR (saved);
+  mode_line_cache_replay = XCDR (saved);
+}
+
+/* Return a copy of the mode line construct OBJ which shares no conses
+   or strings with it, down to a depth of 100 (beyond which
+   display_mode_element doesn't go), so that a destructive change of
+   OBJ will be noticed by mode_line_cache_equal.  */
+
+static Lisp_Object
+mode_line_cache_copy (Lisp_Object obj, int depth)
+{
+  if (STRINGP (obj))
+    return Fcopy_sequence (obj);
+  if (!CONSP (obj) || depth > 100)
+    return obj;
+
+  Lisp_Object copy = Qnil, last = Qnil, tail = obj;
+  FOR_EACH_TAIL_SAFE (tail)
+    {
+      Lisp_Object cell = list1 (mode_line_cache_copy (XCAR (tail),
+						      depth + 1));
+      if (NILP (last))
+	copy = cell;
+      else
+	XSETCDR (last, cell);
+      last = cell;
+    }
+  XSETCDR (last, mode_line_cache_copy (tail, depth + 1));
+  return copy;
+}
+
+/* Return true if OBJ is still what mode_line_cache_copy returned as
+   COPY.  Strings must be equal including their properties.  */
+
+static bool
+mode_line_cache_equal (Lisp_Object obj, Lisp_Object copy, int depth)
+{
+  if (STRINGP (obj))
+    return (STRINGP (copy)
+	    && !NILP (Fequal_including_properties (obj, copy)));
+  if (!CONSP (obj) || depth > 100)
+    return !NILP (Feql (obj, copy));
+
+  Lisp_Object tail = obj;
+  FOR_EACH_TAIL_SAFE (tail)
+    {
+      if (!CONSP (copy)
+	  || !mode_line_cache_equal (XCAR (tail), XCAR (copy), depth + 1))
+	return false;
+      copy = XCDR (copy);
+    }
+  return mode_line_cache_equal (tail, copy, depth + 1);
+}
+
+/* Record that the mode line being displayed depends on SYMBOL, its
+   value and its `risky-local-variable' property.  */
+
+static void
+mode_line_cache_record_symbol (Lisp_Object symbol)
+{
+  Lisp_Object value = (NILP (Fboundp (symbol)) ? Qunbound
+		       : mode_line_cache_copy (Fsymbol_value (symbol), 0));
+
+  mode_line_cache_probes
+    = Fcons (Fcons (symbol,
+		    Fcons (value, Fget (symbol, Qrisky_local_variable))),
+	     mode_line_cache_probes);
+}
+
+/* Record that the mode line being displayed depends on the result
+   VALUE of the :eval element ELT.  */
+
+static void
+mode_line_cache_record_eval (Lisp_Object elt, Lisp_Object value)
+{
+  mode_line_cache_probes
+    = Fcons (Fcons (elt, mode_line_cache_copy (value, 0)),
+	     mode_line_cache_probes);
+}
+
+/* Record that the mode line being displayed depends on the %-construct
+   C with field width FIELD, which produced SPEC and STRING.  */
+
+static void
+mode_line_cache_record_spec (int c, int field, const char *spec,
+			     Lisp_Object string)
+{
+  mode_line_cache_probes
+    = Fcons (list4 (make_fixnum (c), make_fixnum (field),
+		    make_unibyte_string (spec, strlen (spec)),
+		    mode_line_cache_copy (string, 0)),
+	     mode_line_cache_probes);
+}
+
+/* Return true if each of PROBES recorded for the mode line of IT->w
+   still holds.  Stop at the first one that doesn't, and leave the
+   results of the :eval forms evaluated so far in
+   mode_line_cache_replay.  */
+
+static bool
+mode_line_cache_valid_p (struct it *it, Lisp_Object probes)
+{
+  Lisp_Object replay = Qnil;
+  bool valid = true;
+
+  for (; valid && CONSP (probes); probes = XCDR (probes))
+    {
+      Lisp_Object probe = XCAR (probes);
+      Lisp_Object key = XCAR (probe), data = XCDR (probe);
+
+      if (SYMBOLP (key))
+	{
+	  Lisp_Object value = XCAR (data);
+
+	  if (NILP (Fboundp (key)))
+	    valid = BASE_EQ (value, Qunbound);
+	  else
+	    valid = (!BASE_EQ (value, Qunbound)
+		     && mode_line_cache_equal (Fsymbol_value (key),
+					       value, 0));
+	  valid = valid && EQ (Fget (key, Qrisky_local_variable),
+			       XCDR (data));
+	}
+      else if (FIXNUMP (key))
+	{
+	  Lisp_Object string;
+	  const char *spec = decode_mode_spec (it->w, XFIXNUM (key),
+					       XFIXNUM (XCAR (data)),
+					       &string);
+	  Lisp_Object old_spec = XCAR (XCDR (data));
+	  ptrdiff_t nbytes = strlen (spec);
+
+	  valid = (nbytes == SBYTES (old_spec)
+		   && !memcmp (spec, SDATA (old_spec), nbytes)
+		   && mode_line_cache_equal (string,
+					     XCAR (XCDR (XCDR (data))), 0));
+	}
+      else
+	{
+	  Lisp_Object spec = dsafe_eval (XCAR (XCDR (key)));
+
+	  /* See display_mode_element.  */
+	  if (!FRAME_LIVE_P (it->f))
+	    signal_error (":eval deleted the frame being displayed", key);
+	  replay = Fcons (spec, replay);
+	  valid = mode_line_cache_equal (spec, data, 0);
+	}
+    }
+
+  mode_line_cache_replay = valid ? Qnil : Fnreverse (replay);
+  return valid;
+}
+
+/* Return the display table used by W, or nil if there's none.  */
+
+static Lisp_Object
+mode_line_cache_display_table (struct window *w)
+{
+  struct Lisp_Char_Table *dp = window_display_table (w);
+  Lisp_Object table = Qnil;
+
+  if (dp)
+    XSETCHAR_TABLE (table, dp);
+  return table;
+}
+
+/* Return the row of W's current matrix that displays the line whose
+   cache entry is in SLOT, or NULL if there's none.  */
+
+static struct glyph_row *
+mode_line_cache_current_row (struct window *w, int slot)
+{
+  struct glyph_matrix *matrix = w->current_matrix;
+  struct glyph_row *row;
+
+  if (!matrix || matrix->nrows == 0)
+    return NULL;
+  else if (slot == 0)
+    row = MATRIX_MODE_LINE_ROW (matrix);
+  else if (slot == 1)
+    row = matrix->tab_line_p ? MATRIX_TAB_LINE_ROW (matrix) : NULL;
+  else
+    row = matrix->header_line_p ? MATRIX_HEADER_LINE_ROW (matrix) : NULL;
+
+  return (row && row->enabled_p && row->mode_line_p
+	  && row->tab_line_p == (slot == 1)
+	  ? row : NULL);
+}
+
+/* If the line to be displayed with FORMAT in IT->glyph_row would come
+   out the same as the last time the line of IT->w whose entry is in
+   SLOT was displayed, copy that line from the current matrix into
+   IT->glyph_row and return true.  Otherwise, return false.  */
+
+static bool
+mode_line_cache_lookup (struct it *it, int slot, enum face_id face_id,
+			Lisp_Object format)
+{
+  struct window *w = it->w;
+  Lisp_Object entry = (VECTORP (w->mode_line_cache)
+		       ? AREF (w->mode_line_cache, slot) : Qnil);
+  struct glyph_row *row = mode_line_cache_current_row (w, slot);
+
+  if (!VECTORP (entry)
+      || !row
+      || !EQ (AREF (entry, MODE_LINE_CACHE_FACE_ID), make_fixnum (face_id))
+      || !EQ (AREF (entry, MODE_LINE_CACHE_WIDTH),
+	      make_fixnum (it->last_visible_x))
+      || !EQ (AREF (entry, MODE_LINE_CACHE_DISPLAY_TABLE),
+	      mode_line_cache_display_table (w))
+      || !EQ (AREF (entry, MODE_LINE_CACHE_FACE_REMAPPING),
+	      Vface_remapping_alist)
+      || !EQ (AREF (entry, MODE_LINE_CACHE_HASH),
+	      make_fixnum (row->hash & INTMASK))
+      || !EQ (AREF (entry, MODE_LINE_CACHE_USED),
+	      make_fixnum (row->used[TEXT_AREA]))
+      || !EQ (AREF (entry, MODE_LINE_CACHE_HEIGHT),
+	      make_fixnum (row->height))
+      || row->used[LEFT_MARGIN_AREA] || row->used[RIGHT_MARGIN_AREA]
+      || (row->used[TEXT_AREA]
+	  > it->glyph_row->glyphs[LAST_AREA] - it->glyph_row->glyphs[TEXT_AREA])
+      || !mode_line_cache_equal (format,
+				 AREF (entry, MODE_LINE_CACHE_FORMAT), 0)
+      || !mode_line_cache_valid_p (it, AREF (entry,
+					     MODE_LINE_CACHE_PROBES)))
+    return false;
+
+  copy_glyph_row (it->glyph_row, row);
+  return true;
+}
+
+/* Remember PROBES, the inputs of the line just displayed in
+   IT->glyph_row with FORMAT, in the cache entry SLOT of IT->w.  */
+
+static void
+mode_line_cache_store (struct it *it, int slot, enum face_id face_id,
+		       Lisp_Object format, Lisp_Object probes)
+{
+  struct window *w = it->w;
+  struct glyph_row *row = it->glyph_row;
+
+  if (!VECTORP (w->mode_line_cache))
+    wset_mode_line_cache (w, make_nil_vector (3));
+
+  Lisp_Object entry = AREF (w->mode_line_cache, slot);
+  if (!VECTORP (entry))
+    {
+      entry = make_nil_vector (MODE_LINE_CACHE_ENTRY_SIZE);
+      ASET (w->mode_line_cache, slot, entry);
+    }
+
+  ASET (entry, MODE_LINE_CACHE_FORMAT, mode_line_cache_copy (format, 0));
+  ASET (entry, MODE_LINE_CACHE_FACE_ID, make_fixnum (face_id));
+  ASET (entry, MODE_LINE_CACHE_WIDTH, make_fixnum (it->last_visible_x));
+  ASET (entry, MODE_LINE_CACHE_DISPLAY_TABLE,
+	mode_line_cache_display_table (w));
+  ASET (entry, MODE_LINE_CACHE_FACE_REMAPPING, Vface_remapping_alist);
+  ASET (entry, MODE_LINE_CACHE_PROBES, Fnreverse (probes));
+  ASET (entry, MODE_LINE_CACHE_HASH, make_fixnum (row->hash & INTMASK));
+  ASET (entry, MODE_LINE_CACHE_USED, make_fixnum (row->used[TEXT_AREA]));
+  ASET (entry, MODE_LINE_CACHE_HEIGHT, make_fixnum (row->height));
+}
+
+/* Forget the cache entry SLOT of window W.  */
+
+static void
+mode_line_cache_forget (struct window *w, int slot)
+{
+  if (VECTORP (w->mode_line_cache))
+    ASET (w->mode_line_cache, slot, Qnil);
+}
+
 /* Display mode or header/tab line of window W.  FACE_ID specifies which
    line to display; it is either MODE_LINE_ACTIVE_FACE_ID,
    HEADER_LINE_ACTIVE_FACE_ID, HEADER_LINE_INACTIVE_FACE_ID, or
@@ -27697,6 +28738,12 @@ display_mode_line (struct window *w, enum face_id face_id, Lisp_Object format)
   struct it it;
   struct face *face;
   specpdl_ref count = SPECPDL_INDEX ();
+  /* The entry of W's mode line cache for this line.  */
+  int slot = (face_id == TAB_LINE_FACE_ID ? 1
+	      : (face_id == HEADER_LINE_ACTIVE_FACE_ID
+		 || face_id == HEADER_LINE_INACTIVE_FACE_ID) ? 2
+	      : 0);
+  Lisp_Object probes = Qt;
 
   init_iterator (&it, w, -1, -1, NULL, face_id);
   /* Don't extend on a previously drawn mode-line.
@@ -27735,7 +28782,22 @@ display_mode_line (struct window *w, enum face_id face_id, Lisp_Object format)
       || face_id == TAB_LINE_FACE_ID)
     {
       mode_line_target = MODE_LINE_DISPLAY;
+      if (cache_mode_lines)
+	{
+	  record_unwind_protect (restore_mode_line_cache,
+				 Fcons (mode_line_cache_probes,
+					mode_line_cache_replay));
+	  mode_line_cache_probes = Qt;
+	  if (mode_line_cache_lookup (&it, slot, face_id, format))
+	    {
+	      pop_kboard ();
+	      unbind_to (count, Qnil);
+	      return it.glyph_row->height;
+	    }
+	  mode_line_cache_probes = Qnil;
+	}
       display_mode_element (&it, 0, 0, 0, format, Qnil, false);
+      probes = mode_line_cache_probes;
     }
   else
     {
@@ -27831,6 +28893,11 @@ display_mode_line (struct window *w, enum face_id face_id, Lisp_Object format)
 				      - (it.current_x - it.last_visible_x)));
     }
 
+  if (!EQ (probes, Qt) && FRAME_LIVE_P (it.f))
+    mode_line_cache_store (&it, slot, face_id, format, probes);
+  else
+    mode_line_cache_forget (w, slot);
+
   return it.glyph_row->height;
 }
 
@@ -28112,9 +29179,13 @@ display_mode_element (struct it *it, int depth, int field_width, int precision,
 		prec = precision - n;
 
 		if (c == 'M')
-		  n += display_mode_element (it, depth, field, prec,
-					     Vglobal_mode_string, props,
-					     risky);
+		  {
+		    if (mode_line_cache_recording_p ())
+		      mode_line_cache_record_symbol (Qglobal_mode_string);
+		    n += display_mode_element (it, depth, field, prec,
+					       Vglobal_mode_string, props,
+					       risky);
+		  }
 		else if (c != 0)
 		  {
 		    bool multibyte;
@@ -28128,6 +29199,8 @@ display_mode_element (struct it *it, int depth, int field_width, int precision,
 			       : bytepos);
 		    spec = decode_mode_spec (it->w, c, field, &string);
 		    eassert (NILP (string) || STRINGP (string));
+		    if (mode_line_cache_recording_p ())
+		      mode_line_cache_record_spec (c, field, spec, string);
 		    multibyte = !NILP (string) && STRING_MULTIBYTE (string);
 		    /* Non-ASCII characters in SPEC should cause mode-line
 		       element be displayed as a multibyte string.  */
@@ -28205,6 +29278,9 @@ display_mode_element (struct it *it, int depth, int field_width, int precision,
 	if (NILP (Fget (elt, Qrisky_local_variable)))
 	  risky = true;
 
+	if (mode_line_cache_recording_p ())
+	  mode_line_cache_record_symbol (elt);
+
 	tem = Fboundp (elt);
 	if (!NILP (tem))
 	  {
@@ -28249,7 +29325,15 @@ display_mode_element (struct it *it, int depth, int field_width, int precision,
 	    if (CONSP (XCDR (elt)))
 	      {
 		Lisp_Object spec;
-		spec = dsafe_eval (XCAR (XCDR (elt)));
+		if (mode_line_cache_recording_p ()
+		    && CONSP (mode_line_cache_replay))
+		  {
+		    /* mode_line_cache_valid_p evaluated this already.  */
+		    spec = XCAR (mode_line_cache_replay);
+		    mode_line_cache_replay = XCDR (mode_line_cache_replay);
+		  }
+		else
+		  spec = dsafe_eval (XCAR (XCDR (elt)));
 		/* The :eval form could delete the frame stored in the
 		   iterator, which will cause a crash if we try to
 		   access faces and other fields (e.g., FRAME_KBOARD)
@@ -28258,6 +29342,8 @@ display_mode_element (struct it *it, int depth, int field_width, int precision,
 		   dangerous, but we cannot continue with an invalid frame.  */
 		if (!FRAME_LIVE_P (it->f))
 		  signal_error (":eval deleted the frame being displayed", elt);
+		if (mode_line_cache_recording_p ())
+		  mode_line_cache_record_eval (elt, spec);
 		n += display_mode_element (it, depth, field_width - n,
 					   precision - n, spec, props,
 					   risky);
@@ -28278,6 +29364,8 @@ display_mode_element (struct it *it, int depth, int field_width, int precision,
 	  }
 	else if (SYMBOLP (car))
 	  {
+	    if (mode_line_cache_recording_p ())
+	      mode_line_cache_record_symbol (car);
 	    tem = Fboundp (car);
 	    elt = XCDR (elt);
 	    if (!CONSP (elt))
@@ -29330,6 +30418,18 @@ display_count_lines (ptrdiff_t start_byte,
     = (!NILP (BVAR (current_buffer, selective_display))
        && !FIXNUMP (BVAR (current_buffer, selective_display)));
 
+  /* If there can't be COUNT lines before LIMIT_BYTE, as when callers
+     pass a character position for COUNT, just count them, which is
+     faster and can use the line index of large buffers.  */
+  if (!selective_display && count > 0 && start_byte < limit_byte
+      && count > (limit_byte - start_byte) / MAX_MULTIBYTE_LENGTH
+      && (count > limit_byte - start_byte
+	  || count > BYTE_TO_CHAR (limit_byte) - BYTE_TO_CHAR (start_byte)))
+    {
+      *byte_pos_ptr = limit_byte;
+      return count_newlines (start_byte, limit_byte);
+    }
+
   if (count > 0)
     {
       while (start_byte < limit_byte)
@@ -33743,6 +34843,7 @@ gui_write_glyphs (struct window *w, struct glyph_row *updated_row,
   /* Advance the output cursor.  */
   w->output_cursor.hpos += len;
   w->output_cursor.x = x;
+  redisplay_glyphs_written += len;
 }
 
 
@@ -33794,6 +34895,7 @@ gui_insert_glyphs (struct window *w, struct glyph_row *updated_row,
   /* Advance the output cursor.  */
   w->output_cursor.hpos += len;
   w->output_cursor.x += shift_by_width;
+  redisplay_glyphs_written += len;
   unblock_input ();
 }
 
@@ -37615,6 +38717,7 @@ syms_of_xdisp (void)
 #endif
   defsubr (&Sline_pixel_height);
   defsubr (&Sformat_mode_line);
+  defsubr (&Sredisplay_trace);
   defsubr (&Sinvisible_p);
   defsubr (&Scurrent_bidi_paragraph_direction);
   defsubr (&Swindow_text_pixel_size);
@@ -37782,6 +38885,15 @@ syms_of_xdisp (void)
   staticpro (&previous_help_echo_string);
   help_echo_pos = -1;
 
+  redisplay_trace_ring = Qnil;
+  staticpro (&redisplay_trace_ring);
+  redisplay_trace_method = Qnil;
+  DEFSYM (Qtry_cursor_movement, "try-cursor-movement");
+  DEFSYM (Qtry_window_id, "try-window-id");
+  DEFSYM (Qtry_window_reusing_current_matrix,
+	  "try-window-reusing-current-matrix");
+  DEFSYM (Qtry_window, "try-window");
+
   DEFSYM (Qright_to_left, "right-to-left");
   DEFSYM (Qleft_to_right, "left-to-right");
   defsubr (&Sbidi_resolved_levels);
@@ -37855,6 +38967,7 @@ syms_of_xdisp (void)
 This is used for internal purposes.  */);
   Vinhibit_redisplay = Qnil;
 
+  DEFSYM (Qglobal_mode_string, "global-mode-string");
   DEFVAR_LISP ("global-mode-string", Vglobal_mode_string,
     doc: /* String (or mode line construct) included (normally) in `mode-line-misc-info'.  */);
   Vglobal_mode_string = Qnil;
@@ -38606,6 +39719,43 @@ syms_of_xdisp (void)
 redisplay tests in batch mode.   */);
   redisplay_skip_initial_frame = true;
 
+  DEFVAR_BOOL ("cache-line-heights", cache_line_heights,
+    doc: /* Non-nil means remember the layout of lines for moving over them.
+When this is non-nil, the display engine records, for each logical line
+of a buffer that it lays out while computing screen positions, how many
+screen lines and pixels the line takes.  Functions such as
+`pos-visible-in-window-p', `window-text-pixel-size' and `vertical-motion',
+and pixel-wise scrolling, then move over such lines without laying them
+out again.  The records are discarded when the text or the display
+settings they depend on change.  */);
+  cache_line_heights = true;
+
+  DEFVAR_BOOL ("cache-mode-lines", cache_mode_lines,
+    doc: /* Non-nil means don't redraw mode lines that would come out the same.
+When this is non-nil, the display engine remembers for each window which
+variable values, `:eval' results and %-constructs its mode line, tab
+line and header line were produced from.  When one of these lines is
+to be displayed again, the `:eval' forms and %-constructs are still
+evaluated, but if none of the inputs changed, the line is reused
+instead of being produced from its format again.  */);
+  cache_mode_lines = true;
+  mode_line_cache_probes = Qt;
+  staticpro (&mode_line_cache_probes);
+  mode_line_cache_replay = Qnil;
+  staticpro (&mode_line_cache_replay);
+
+  overlay_string_cache = make_nil_vector (OVERLAY_STRING_CACHE_SIZE);
+  staticpro (&overlay_string_cache);
+
+  DEFVAR_INT ("redisplay-trace-size", redisplay_trace_size,
+    doc: /* Number of window redisplays to remember for `redisplay-trace'.
+When this is positive, redisplay records, for each window it
+redisplays, which method it used, how many rows it redrew and how long
+it took, keeping the last `redisplay-trace-size' records.  Zero, the
+default, disables the tracing.  Values above 65536 are treated as
+65536.  Changing the value discards the records made so far.  */);
+  redisplay_trace_size = 0;
+
   DEFVAR_BOOL ("redisplay-skip-fontification-on-input",
                redisplay_skip_fontification_on_input,
     doc: /* Skip `fontification_functions` when there is input pending.
@@ -2473,6 +2473,12 @@ merge_named_face (struct window *w,
     return false;
 }
 
+/* True if evaluate_face_filter was called since this was last reset.
+   Faces merged with filters depend on the window, so they are not
+   cached.  */
+
+static bool face_filter_evaluated;
+
 /* Determine whether the face filter FILTER evaluated in window W
    matches.  W can be NULL if the window context is unknown.
 
@@ -2490,6 +2496,8 @@ evaluate_face_filter (Lisp_Object filter, struct window *w,
 {
   Lisp_Object orig_filter = filter;
 
+  face_filter_evaluated = true;
+
   /* Inner braces keep compiler happy about the goto skipping variable
      initialization.  */
   {
@@ -4811,6 +4819,38 @@ clear_face_gcs (struct face_cache *c)
 
 #endif /* HAVE_WINDOW_SYSTEM */
 
+/* Cache of the results of merging the faces of text properties and
+   overlays in face_at_buffer_position, or nil.  A vector of
+   FACE_MERGE_CACHE_SIZE slots, indexed by a hash of what was merged,
+   each nil or a vector [FRAME FLAGS BASE-FACE-ID REMAPPING PROP
+   OVERLAY-PROPS FACE-ID], where OVERLAY-PROPS is a vector.  PROP,
+   the elements of OVERLAY-PROPS and REMAPPING are copies of what was
+   merged, so that destructive changes don't go unnoticed.  The cache
+   must be cleared when realized faces are freed, since face IDs are
+   reused.  */
+
+static Lisp_Object face_merge_cache;
+
+enum { FACE_MERGE_CACHE_SIZE = 1024 };
+
+enum face_merge_cache_index
+  {
+    FACE_MERGE_FRAME,
+    FACE_MERGE_FLAGS,
+    FACE_MERGE_BASE_FACE_ID,
+    FACE_MERGE_REMAPPING,
+    FACE_MERGE_PROP,
+    FACE_MERGE_OVERLAY_PROPS,
+    FACE_MERGE_FACE_ID,
+    FACE_MERGE_ENTRY_SIZE
+  };
+
+static void
+clear_face_merge_cache (void)
+{
+  face_merge_cache = Qnil;
+}
+
 /* Free all realized faces in face cache C, including basic faces.
    C may be null.  If faces are freed, make sure the frame's current
    matrix is marked invalid, so that a display caused by an expose
@@ -4829,6 +4869,9 @@ free_realized_faces (struct face_cache *c)
 	 current matrix still references freed faces.  */
       block_input ();
 
+      /* Lines laid out with these faces may now have other heights.  */
+      invalidate_line_height_caches ();
+
       for (i = 0; i < c->used; ++i)
 	{
 	  free_realized_face (f, c->faces_by_id[i]);
@@ -4837,6 +4880,7 @@ free_realized_faces (struct face_cache *c)
 
       /* Forget the escape-glyph and glyphless-char faces.  */
       forget_escape_and_glyphless_faces ();
+      clear_face_merge_cache ();
       c->used = 0;
       size = FACE_CACHE_BUCKETS_SIZE * sizeof *c->buckets;
       memset (c->buckets, 0, size);
@@ -4983,6 +5027,7 @@ uncache_face (struct face_cache *c, struct face *face)
   c->faces_by_id[face->id] = NULL;
   if (face->id == c->used)
     --c->used;
+  clear_face_merge_cache ();
 }
 
 
@@ -6799,10 +6844,182 @@ compute_char_face (struct frame *f, int ch, Lisp_Object prop)
   return face_id;
 }
 
+/* Return a copy of the face property PROP that shares no conses
+   with it, or nil if PROP is nested too deeply to be worth caching
+   in face_merge_cache.  */
+
+static Lisp_Object
+face_merge_cache_copy (Lisp_Object prop, int depth)
+{
+  if (!CONSP (prop))
+    return prop;
+  if (depth > 10)
+    return Qnil;
+
+  Lisp_Object copy = Qnil, tail;
+  for (tail = prop; CONSP (tail); tail = XCDR (tail))
+    {
+      Lisp_Object elt = face_merge_cache_copy (XCAR (tail), depth + 1);
+      if (CONSP (XCAR (tail)) && NILP (elt))
+	return Qnil;
+      copy = Fcons (elt, copy);
+    }
+  return Fnreverse (copy);
+}
+
+/* Return the hash code under which face_merge_cache records the
+   result of merging PROP and the NOPROPS face properties in OPROPS
+   into the face BASE_FACE_ID as described by FLAGS.  */
+
+static EMACS_UINT
+face_merge_cache_hash (int flags, int base_face_id, Lisp_Object prop,
+		       Lisp_Object *oprops, ptrdiff_t noprops)
+{
+  EMACS_UINT hash = sxhash_combine (base_face_id, flags);
+
+  hash = sxhash_combine (hash, sxhash (prop));
+  for (ptrdiff_t i = 0; i < noprops; i++)
+    hash = sxhash_combine (hash, sxhash (oprops[i]));
+  return hash;
+}
+
+/* Return the ID of the face on frame F that face_merge_cache records
+   for the arguments, or -1 if there is none.  HASH is their hash
+   code.  */
+
+static int
+face_merge_cache_lookup (struct frame *f, EMACS_UINT hash, int flags,
+			 int base_face_id, Lisp_Object prop,
+			 Lisp_Object *oprops, ptrdiff_t noprops)
+{
+  if (NILP (face_merge_cache))
+    return -1;
+
+  Lisp_Object entry = AREF (face_merge_cache, hash % FACE_MERGE_CACHE_SIZE);
+  if (NILP (entry)
+      || XFRAME (AREF (entry, FACE_MERGE_FRAME)) != f
+      || XFIXNUM (AREF (entry, FACE_MERGE_FLAGS)) != flags
+      || XFIXNUM (AREF (entry, FACE_MERGE_BASE_FACE_ID)) != base_face_id
+      || ASIZE (AREF (entry, FACE_MERGE_OVERLAY_PROPS)) != noprops
+      || NILP (Fequal (AREF (entry, FACE_MERGE_PROP), prop))
+      || NILP (Fequal (AREF (entry, FACE_MERGE_REMAPPING),
+		       Vface_remapping_alist)))
+    return -1;
+
+  Lisp_Object stored = AREF (entry, FACE_MERGE_OVERLAY_PROPS);
+  for (ptrdiff_t i = 0; i < noprops; i++)
+    if (NILP (Fequal (AREF (stored, i), oprops[i])))
+      return -1;
+
+  int face_id = XFIXNUM (AREF (entry, FACE_MERGE_FACE_ID));
+  return FACE_FROM_ID_OR_NULL (f, face_id) ? face_id : -1;
+}
+
+/* Record in face_merge_cache that merging the arguments produced the
+   face FACE_ID on frame F.  */
+
+static void
+face_merge_cache_store (struct frame *f, EMACS_UINT hash, int flags,
+			int base_face_id, Lisp_Object prop,
+			Lisp_Object *oprops, ptrdiff_t noprops, int face_id)
+{
+  Lisp_Object remapping = face_merge_cache_copy (Vface_remapping_alist, 0);
+  Lisp_Object prop_copy = face_merge_cache_copy (prop, 0);
+
+  if (NILP (remapping) != NILP (Vface_remapping_alist)
+      || NILP (prop_copy) != NILP (prop))
+    return;
+
+  Lisp_Object stored = make_nil_vector (noprops);
+  for (ptrdiff_t i = 0; i < noprops; i++)
+    {
+      Lisp_Object copy = face_merge_cache_copy (oprops[i], 0);
+      if (NILP (copy))
+	return;
+      ASET (stored, i, copy);
+    }
+
+  Lisp_Object entry = make_nil_vector (FACE_MERGE_ENTRY_SIZE);
+  Lisp_Object frame;
+  XSETFRAME (frame, f);
+  ASET (entry, FACE_MERGE_FRAME, frame);
+  ASET (entry, FACE_MERGE_FLAGS, make_fixnum (flags));
+  ASET (entry, FACE_MERGE_BASE_FACE_ID, make_fixnum (base_face_id));
+  ASET (entry, FACE_MERGE_REMAPPING, remapping);
+  ASET (entry, FACE_MERGE_PROP, prop_copy);
+  ASET (entry, FACE_MERGE_OVERLAY_PROPS, stored);
+  ASET (entry, FACE_MERGE_FACE_ID, make_fixnum (face_id));
+
+  if (NILP (face_merge_cache))
+    face_merge_cache = make_nil_vector (FACE_MERGE_CACHE_SIZE);
+  ASET (face_merge_cache, hash % FACE_MERGE_CACHE_SIZE, entry);
+}
+
+/* Return true if ELT, an element of face-range-sets, is to be
+   displayed in window W, and store its vector of ranges in *RANGES.  */
+
+static bool
+face_range_set_applies_p (Lisp_Object elt, struct window *w,
+			  Lisp_Object *ranges)
+{
+  if (!CONSP (elt) || !CONSP (XCDR (elt)) || !VECTORP (XCAR (XCDR (elt))))
+    return false;
+  *ranges = XCAR (XCDR (elt));
+  Lisp_Object tail = XCDR (XCDR (elt));
+  Lisp_Object window = CONSP (tail) ? XCAR (tail) : Qnil;
+  return NILP (window) || (WINDOWP (window) && XWINDOW (window) == w);
+}
+
+/* Return true if POS is inside one of RANGES, a sorted vector of
+   range boundaries.  If a boundary follows POS, lower *NEXT to it if
+   it is smaller.  Use binary search, so that sets with many ranges
+   cost no more than a few lookups.  */
+
+static bool
+face_range_lookup (Lisp_Object ranges, ptrdiff_t pos, ptrdiff_t *next)
+{
+  /* Find the first boundary after POS.  An odd element at the end has
+     no partner, and is ignored.  */
+  ptrdiff_t size = ASIZE (ranges) & ~1, lo = 0, hi = size;
+  while (lo < hi)
+    {
+      ptrdiff_t mid = lo + (hi - lo) / 2;
+      Lisp_Object bound = AREF (ranges, mid);
+      if (!FIXNUMP (bound))
+	return false;
+      if (XFIXNUM (bound) <= pos)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  if (lo == size || !FIXNUMP (AREF (ranges, lo)))
+    return false;
+  if (XFIXNUM (AREF (ranges, lo)) < *next)
+    *next = XFIXNUM (AREF (ranges, lo));
+  /* POS is inside a range if the next boundary is one's end.  */
+  return lo % 2 == 1;
+}
+
+/* Return the first position after POS at which the ranges of
+   face-range-sets displayed in window W start or end, or ZV if there
+   is none.  */
+
+ptrdiff_t
+next_face_range_change (struct window *w, ptrdiff_t pos)
+{
+  ptrdiff_t next = ZV;
+  Lisp_Object tail = Vface_range_sets, ranges;
+  FOR_EACH_TAIL_SAFE (tail)
+    if (face_range_set_applies_p (XCAR (tail), w, &ranges))
+      face_range_lookup (ranges, pos, &next);
+  return next;
+}
+
 /* Return the face ID associated with buffer position POS for
    displaying ASCII characters.  Return in *ENDPTR the position at
-   which a different face is needed, as far as text properties and
-   overlays are concerned.  W is a window displaying current_buffer.
+   which a different face is needed, as far as text properties,
+   overlays and face-range-sets are concerned.  W is a window
+   displaying current_buffer.
 
    ATTR_FILTER is passed merge_face_ref.
 
@@ -6863,6 +7080,25 @@ face_at_buffer_position (struct window *w, ptrdiff_t pos,
       endpos = next_overlay;
   }
 
+  /* Look at the ranges of face-range-sets.  Their faces merge like
+     overlay faces of lower priority than any overlay.  */
+  Lisp_Object *set_faces = NULL;
+  ptrdiff_t nset_faces = 0;
+  if (!mouse && CONSP (Vface_range_sets))
+    {
+      ptrdiff_t nsets = 0;
+      Lisp_Object tail = Vface_range_sets, ranges;
+      FOR_EACH_TAIL_SAFE (tail)
+	nsets++;
+      SAFE_ALLOCA_LISP (set_faces, nsets);
+      tail = Vface_range_sets;
+      FOR_EACH_TAIL_SAFE (tail)
+	if (face_range_set_applies_p (XCAR (tail), w, &ranges)
+	    && face_range_lookup (ranges, pos, &endpos)
+	    && nset_faces < nsets)
+	  set_faces[nset_faces++] = XCAR (XCAR (tail));
+    }
+
   *endptr = endpos;
 
   {
@@ -6890,37 +7126,39 @@ face_at_buffer_position (struct window *w, ptrdiff_t pos,
 
   /* Optimize common cases where we can use the default face.  */
   if (noverlays == 0
+      && nset_faces == 0
       && NILP (prop))
     {
       SAFE_FREE ();
       return default_face->id;
     }
 
-  /* Begin with attributes from the default face.  */
-  memcpy (attrs, default_face->lface, sizeof(attrs));
-
-  /* Merge in attributes specified via text properties.  */
-  if (!NILP (prop))
-    merge_face_ref (w, f, prop, attrs, true, NULL, attr_filter);
-
-  /* Now merge the overlay data.  */
+  /* Collect the face properties of the overlays, in increasing
+     order of priority, after those of face-range-sets.  */
   noverlays = sort_overlays (overlay_vec, noverlays, w);
+  Lisp_Object *oprops;
+  ptrdiff_t noprops = 0;
+  SAFE_ALLOCA_LISP (oprops, max (nset_faces + noverlays, 1));
+  for (i = 0; i < nset_faces; i++)
+    oprops[noprops++] = set_faces[i];
   /* For mouse-face, we need only the single highest-priority face
      from the overlays, if any.  */
   if (mouse)
     {
-      for (prop = Qnil, i = noverlays - 1; i >= 0 && NILP (prop); --i)
+      Lisp_Object oprop;
+
+      for (oprop = Qnil, i = noverlays - 1; i >= 0 && NILP (oprop); --i)
 	{
 	  ptrdiff_t oendpos;
 
-	  prop = Foverlay_get (overlay_vec[i], propname);
-	  if (!NILP (prop))
+	  oprop = Foverlay_get (overlay_vec[i], propname);
+	  if (!NILP (oprop))
 	    {
 	      /* Overlays always take priority over text properties,
 		 so discard the mouse-face text property, if any, and
 		 use the overlay property instead.  */
-	      memcpy (attrs, default_face->lface, sizeof attrs);
-	      merge_face_ref (w, f, prop, attrs, true, NULL, attr_filter);
+	      prop = Qnil;
+	      oprops[noprops++] = oprop;
 	    }
 
 	  oendpos = OVERLAY_END (overlay_vec[i]);
@@ -6933,11 +7171,10 @@ face_at_buffer_position (struct window *w, ptrdiff_t pos,
       for (i = 0; i < noverlays; i++)
 	{
 	  ptrdiff_t oendpos;
+	  Lisp_Object oprop = Foverlay_get (overlay_vec[i], propname);
 
-	  prop = Foverlay_get (overlay_vec[i], propname);
-
-	  if (!NILP (prop))
-	    merge_face_ref (w, f, prop, attrs, true, NULL, attr_filter);
+	  if (!NILP (oprop))
+	    oprops[noprops++] = oprop;
 
           oendpos = OVERLAY_END (overlay_vec[i]);
           if (oendpos < endpos)
@@ -6947,11 +7184,38 @@ face_at_buffer_position (struct window *w, ptrdiff_t pos,
 
   *endptr = endpos;
 
-  SAFE_FREE ();
+  /* Merging the same faces over and over is expensive, so see if we
+     did it before.  */
+  int flags = mouse | attr_filter << 1;
+  EMACS_UINT hash = face_merge_cache_hash (flags, default_face->id,
+					   prop, oprops, noprops);
+  int face_id = face_merge_cache_lookup (f, hash, flags, default_face->id,
+					 prop, oprops, noprops);
+  if (face_id >= 0)
+    {
+      SAFE_FREE ();
+      return face_id;
+    }
+
+  /* Begin with attributes from the default face.  */
+  memcpy (attrs, default_face->lface, sizeof(attrs));
+
+  /* Merge in attributes specified via text properties, and then
+     those of the overlays.  */
+  face_filter_evaluated = false;
+  if (!NILP (prop))
+    merge_face_ref (w, f, prop, attrs, true, NULL, attr_filter);
+  for (i = 0; i < noprops; i++)
+    merge_face_ref (w, f, oprops[i], attrs, true, NULL, attr_filter);
 
   /* Look up a realized face with the given face attributes,
      or realize a new one for ASCII characters.  */
-  return lookup_face (f, attrs);
+  face_id = lookup_face (f, attrs);
+  if (!face_filter_evaluated)
+    face_merge_cache_store (f, hash, flags, default_face->id,
+			    prop, oprops, noprops, face_id);
+  SAFE_FREE ();
+  return face_id;
 }
 
 /* Return the face ID at buffer position POS for displaying ASCII
@@ -7489,6 +7753,8 @@ syms_of_xfaces (void)
   DEFSYM (Qtty_defined_color_alist, "tty-defined-color-alist");
 
   Vface_alternative_font_family_alist = Qnil;
+  face_merge_cache = Qnil;
+  staticpro (&face_merge_cache);
   staticpro (&Vface_alternative_font_family_alist);
   Vface_alternative_font_registry_alist = Qnil;
   staticpro (&Vface_alternative_font_registry_alist);
@@ -7647,6 +7913,28 @@ syms_of_xfaces (void)
   Vface_remapping_alist = Qnil;
   DEFSYM (Qface_remapping_alist,"face-remapping-alist");
 
+  DEFVAR_LISP ("face-range-sets", Vface_range_sets,
+	       doc: /* List of sets of buffer text ranges to display in a face.
+Each element has the form (FACE RANGES) or (FACE RANGES WINDOW).
+RANGES is a vector [BEG1 END1 BEG2 END2 ...] of buffer positions in
+increasing order, delimiting ranges of text that redisplay shows in
+FACE, which can be anything allowed as the value of a `face' text
+property.  FACE is merged as if it came from an overlay with a lower
+priority than any actual overlay.  If WINDOW is non-nil, the set is
+shown only in that window.
+
+This is a compact way of highlighting many ranges with the same face,
+such as all the matches of a search; the value of `re-search-matches'
+can be used as RANGES.  Unlike overlays, the positions in RANGES do
+not move when text is inserted or deleted, so the ranges must be
+updated after buffer changes.  Setting this variable causes the
+buffer to be redisplayed, but modifying RANGES in place does not.
+
+This variable automatically becomes buffer-local when set.  */);
+  Vface_range_sets = Qnil;
+  DEFSYM (Qface_range_sets, "face-range-sets");
+  Fmake_variable_buffer_local (Qface_range_sets);
+
   DEFVAR_LISP ("face-font-rescale-alist", Vface_font_rescale_alist,
 	       doc: /* Alist of fonts vs the rescaling factors.
 Each element is a cons (FONT-PATTERN . RESCALE-RATIO), where
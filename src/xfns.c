@@ -3933,9 +3933,16 @@ xic_string_conversion_callback (XIC ic, XPointer client_data,
 x_mark_frame_dirty (struct frame *f)
 {
 #ifdef HAVE_XDBE
-  if (FRAME_X_DOUBLE_BUFFERED_P (f)
-      && !FRAME_X_NEED_BUFFER_FLIP (f))
-    FRAME_X_NEED_BUFFER_FLIP (f) = true;
+  if (FRAME_X_DOUBLE_BUFFERED_P (f))
+    {
+      if (!FRAME_X_NEED_BUFFER_FLIP (f))
+	FRAME_X_NEED_BUFFER_FLIP (f) = true;
+
+      /* We don't know what is being drawn, unless the caller told
+	 us, so the whole back buffer must be shown.  */
+      if (!f->output_data.x->damage_tracking)
+	f->output_data.x->damage_all = true;
+    }
 #endif
 }
 
@@ -3974,6 +3981,9 @@ set_up_x_back_buffer (struct frame *f)
           if (x_had_errors_p (FRAME_X_DISPLAY (f)))
             FRAME_X_RAW_DRAWABLE (f) = FRAME_X_WINDOW (f);
           x_uncatch_errors_after_check ();
+
+	  /* The new back buffer must be shown in full once.  */
+	  f->output_data.x->damage_all = true;
         }
     }
   unblock_input ();
@@ -34,11 +34,19 @@
 # include "w32common.h"
 # include "w32.h"
 
-DEF_DLL_FN (htmlDocPtr, htmlReadMemory,
-	     (const char *, int, const char *, const char *, int));
-DEF_DLL_FN (xmlDocPtr, xmlReadMemory,
-	     (const char *, int, const char *, const char *, int));
+DEF_DLL_FN (htmlParserCtxtPtr, htmlNewParserCtxt, (void));
+DEF_DLL_FN (htmlDocPtr, htmlCtxtReadMemory,
+	     (htmlParserCtxtPtr, const char *, int, const char *,
+	      const char *, int));
+DEF_DLL_FN (void, htmlFreeParserCtxt, (htmlParserCtxtPtr));
+DEF_DLL_FN (xmlParserCtxtPtr, xmlNewParserCtxt, (void));
+DEF_DLL_FN (xmlDocPtr, xmlCtxtReadMemory,
+	     (xmlParserCtxtPtr, const char *, int, const char *,
+	      const char *, int));
+DEF_DLL_FN (void, xmlFreeParserCtxt, (xmlParserCtxtPtr));
 DEF_DLL_FN (xmlNodePtr, xmlDocGetRootElement, (xmlDocPtr));
+DEF_DLL_FN (void, xmlFreeNodeList, (xmlNodePtr));
+DEF_DLL_FN (void, xmlFreePropList, (xmlAttrPtr));
 DEF_DLL_FN (void, xmlFreeDoc, (xmlDocPtr));
 DEF_DLL_FN (void, xmlCleanupParser, (void));
 DEF_DLL_FN (void, xmlCheckVersion, (int));
@@ -51,26 +59,44 @@ libxml2_loaded_p (void)
   return CONSP (found) && EQ (XCDR (found), Qt);
 }
 
-# undef htmlReadMemory
+# undef htmlCtxtReadMemory
+# undef htmlFreeParserCtxt
+# undef htmlNewParserCtxt
 # undef xmlCheckVersion
 # undef xmlCleanupParser
+# undef xmlCtxtReadMemory
 # undef xmlDocGetRootElement
 # undef xmlFreeDoc
-# undef xmlReadMemory
-
-# define htmlReadMemory fn_htmlReadMemory
+# undef xmlFreeNodeList
+# undef xmlFreeParserCtxt
+# undef xmlFreePropList
+# undef xmlNewParserCtxt
+
+# define htmlCtxtReadMemory fn_htmlCtxtReadMemory
+# define htmlFreeParserCtxt fn_htmlFreeParserCtxt
+# define htmlNewParserCtxt fn_htmlNewParserCtxt
 # define xmlCheckVersion fn_xmlCheckVersion
 # define xmlCleanupParser fn_xmlCleanupParser
+# define xmlCtxtReadMemory fn_xmlCtxtReadMemory
 # define xmlDocGetRootElement fn_xmlDocGetRootElement
 # define xmlFreeDoc fn_xmlFreeDoc
-# define xmlReadMemory fn_xmlReadMemory
+# define xmlFreeNodeList fn_xmlFreeNodeList
+# define xmlFreeParserCtxt fn_xmlFreeParserCtxt
+# define xmlFreePropList fn_xmlFreePropList
+# define xmlNewParserCtxt fn_xmlNewParserCtxt
 
 static bool
 load_dll_functions (HMODULE library)
 {
-  LOAD_DLL_FN (library, htmlReadMemory);
-  LOAD_DLL_FN (library, xmlReadMemory);
+  LOAD_DLL_FN (library, htmlNewParserCtxt);
+  LOAD_DLL_FN (library, htmlCtxtReadMemory);
+  LOAD_DLL_FN (library, htmlFreeParserCtxt);
+  LOAD_DLL_FN (library, xmlNewParserCtxt);
+  LOAD_DLL_FN (library, xmlCtxtReadMemory);
+  LOAD_DLL_FN (library, xmlFreeParserCtxt);
   LOAD_DLL_FN (library, xmlDocGetRootElement);
+  LOAD_DLL_FN (library, xmlFreeNodeList);
+  LOAD_DLL_FN (library, xmlFreePropList);
   LOAD_DLL_FN (library, xmlFreeDoc);
   LOAD_DLL_FN (library, xmlCleanupParser);
   LOAD_DLL_FN (library, xmlCheckVersion);
@@ -119,17 +145,58 @@ init_libxml2_functions (void)
 #endif	/* !WINDOWSNT */
 }
 
+/* The state of a parse.  This lives on the C stack, so that the
+   converted elements in DONE are visible to the garbage collector.  */
+
+struct xml_parse_state
+{
+  /* The converted elements that have not been added to their parent's
+     Lisp form yet, most recently ended first.  */
+  Lisp_Object done;
+
+  /* The handlers that libxml2 would have called when an element
+     ends, which build its tree.  */
+  endElementSAXFunc end_element;
+  endElementNsSAX2Func end_element_ns;
+};
+
+/* The parse in progress.  Parsing does not run Lisp code, so there
+   is at most one.  */
+static struct xml_parse_state *parse_state;
+
+static Lisp_Object make_dom (xmlNode *node, Lisp_Object *done);
+
+/* Return the Lisp form of NODE.  If NODE was already converted when
+   it ended, its form is the first of *DONE, which is popped.  */
+
+static Lisp_Object
+node_value (xmlNode *node, Lisp_Object *done)
+{
+  if (node->type == XML_ELEMENT_NODE && node->_private == parse_state)
+    {
+      Lisp_Object value = XCAR (*done);
+      *done = XCDR (*done);
+      return value;
+    }
+  return make_dom (node, done);
+}
+
 static Lisp_Object
-make_dom (xmlNode *node)
+make_dom (xmlNode *node, Lisp_Object *done)
 {
   if (node->type == XML_ELEMENT_NODE)
     {
-      Lisp_Object result = list1 (intern ((char *) node->name));
+      Lisp_Object result = Qnil;
       xmlNode *child;
       xmlAttr *property;
       Lisp_Object plist = Qnil;
 
-      /* First add the attributes. */
+      /* First add the children of the node, last first, since its
+	 converted children were pushed onto *DONE in order.  */
+      for (child = node->last; child != NULL; child = child->prev)
+	result = Fcons (node_value (child, done), result);
+
+      /* Then add the attributes. */
       property = node->properties;
       while (property != NULL)
 	{
@@ -143,17 +210,9 @@ make_dom (xmlNode *node)
 	    }
 	  property = property->next;
 	}
-      result = Fcons (Fnreverse (plist), result);
-
-      /* Then add the children of the node. */
-      child = node->children;
-      while (child != NULL)
-	{
-	  result = Fcons (make_dom (child), result);
-	  child = child->next;
-	}
 
-      return Fnreverse (result);
+      return Fcons (intern ((char *) node->name),
+		    Fcons (Fnreverse (plist), result));
     }
   else if (node->type == XML_TEXT_NODE || node->type == XML_CDATA_SECTION_NODE)
     {
@@ -174,12 +233,57 @@ make_dom (xmlNode *node)
     return Qnil;
 }
 
+/* Convert the element that has just ended to Lisp, and free its
+   contents, so that the libxml2 tree and the Lisp tree of a large
+   document are never both in memory.  The element itself stays in
+   the tree as an empty placeholder, because the parser looks at the
+   previous siblings of text to decide whether it is ignorable
+   whitespace.  */
+
+static void
+finish_element (xmlNode *node)
+{
+  if (node == NULL || node->type != XML_ELEMENT_NODE)
+    return;
+  Lisp_Object value = make_dom (node, &parse_state->done);
+  parse_state->done = Fcons (value, parse_state->done);
+  node->_private = parse_state;
+  xmlFreeNodeList (node->children);
+  node->children = node->last = NULL;
+  xmlFreePropList (node->properties);
+  node->properties = NULL;
+}
+
+static void
+end_element (void *ctx, const xmlChar *name)
+{
+  xmlParserCtxtPtr ctxt = ctx;
+  xmlNode *node = ctxt->node;
+
+  parse_state->end_element (ctx, name);
+  if (node != ctxt->node)
+    finish_element (node);
+}
+
+static void
+end_element_ns (void *ctx, const xmlChar *localname, const xmlChar *prefix,
+		const xmlChar *uri)
+{
+  xmlParserCtxtPtr ctxt = ctx;
+  xmlNode *node = ctxt->node;
+
+  parse_state->end_element_ns (ctx, localname, prefix, uri);
+  if (node != ctxt->node)
+    finish_element (node);
+}
+
 static Lisp_Object
 parse_region (Lisp_Object start, Lisp_Object end, Lisp_Object base_url,
 	      Lisp_Object discard_comments, bool htmlp)
 {
   xmlDoc *doc;
   Lisp_Object result = Qnil;
+  struct xml_parse_state state = { Qnil };
   const char *burl = "";
   ptrdiff_t istart, iend, istart_byte, iend_byte;
   unsigned char *buftext;
@@ -214,17 +318,39 @@ parse_region (Lisp_Object start, Lisp_Object end, Lisp_Object base_url,
      functions below read its text.  */
   r_alloc_inhibit_buffer_relocation (1);
 #endif
+  /* Let libxml2 build its tree as usual, but convert each element
+     to Lisp as soon as it ends; see finish_element.  */
   if (htmlp)
-    doc = htmlReadMemory ((char *)buftext,
-			  iend_byte - istart_byte, burl, "utf-8",
-			  HTML_PARSE_RECOVER|HTML_PARSE_NONET|
-			  HTML_PARSE_NOWARNING|HTML_PARSE_NOERROR|
-			  HTML_PARSE_NOBLANKS);
+    {
+      htmlParserCtxtPtr ctxt = htmlNewParserCtxt ();
+      if (ctxt == NULL)
+	memory_full (SIZE_MAX);
+      state.end_element = ctxt->sax->endElement;
+      ctxt->sax->endElement = end_element;
+      parse_state = &state;
+      doc = htmlCtxtReadMemory (ctxt, (char *)buftext,
+				iend_byte - istart_byte, burl, "utf-8",
+				HTML_PARSE_RECOVER|HTML_PARSE_NONET|
+				HTML_PARSE_NOWARNING|HTML_PARSE_NOERROR|
+				HTML_PARSE_NOBLANKS);
+      htmlFreeParserCtxt (ctxt);
+    }
   else
-    doc = xmlReadMemory ((char *)buftext,
-			 iend_byte - istart_byte, burl, "utf-8",
-			 XML_PARSE_NONET|XML_PARSE_NOWARNING|
-			 XML_PARSE_NOBLANKS |XML_PARSE_NOERROR);
+    {
+      xmlParserCtxtPtr ctxt = xmlNewParserCtxt ();
+      if (ctxt == NULL)
+	memory_full (SIZE_MAX);
+      state.end_element = ctxt->sax->endElement;
+      ctxt->sax->endElement = end_element;
+      state.end_element_ns = ctxt->sax->endElementNs;
+      ctxt->sax->endElementNs = end_element_ns;
+      parse_state = &state;
+      doc = xmlCtxtReadMemory (ctxt, (char *)buftext,
+			       iend_byte - istart_byte, burl, "utf-8",
+			       XML_PARSE_NONET|XML_PARSE_NOWARNING|
+			       XML_PARSE_NOBLANKS |XML_PARSE_NOERROR);
+      xmlFreeParserCtxt (ctxt);
+    }
 
 #ifdef REL_ALLOC
   r_alloc_inhibit_buffer_relocation (0);
@@ -236,33 +362,38 @@ parse_region (Lisp_Object start, Lisp_Object end, Lisp_Object base_url,
 
   if (doc != NULL)
     {
-      Lisp_Object r = Qnil;
-      if (NILP(discard_comments))
-        {
-          /* If the document has toplevel comments, then this should
-             get us the nodes and the comments. */
-          xmlNode *n = doc->children;
-
-          while (n) {
-            if (!NILP (r))
-              result = Fcons (r, result);
-            r = make_dom (n);
-            n = n->next;
-          }
-        }
-
-      if (NILP (result)) {
+      Lisp_Object r = Qnil, root = Qnil;
+      xmlNode *root_node = xmlDocGetRootElement (doc);
+      /* The converted toplevel elements, in document order.  */
+      Lisp_Object done = Fnreverse (state.done);
+      xmlNode *n = doc->children;
+
+      while (n) {
+	Lisp_Object value = node_value (n, &done);
+	if (n == root_node)
+	  root = value;
+	/* If the document has toplevel comments, then this should
+	   get us the nodes and the comments. */
+	if (NILP (discard_comments))
+	  {
+	    if (!NILP (r))
+	      result = Fcons (r, result);
+	    r = value;
+	  }
+	n = n->next;
+      }
+
+      if (NILP (result))
 	/* The document doesn't have toplevel comments or we discarded
-	   them.  Get the tree the proper way. */
-	xmlNode *node = xmlDocGetRootElement (doc);
-	if (node != NULL)
-	  result = make_dom (node);
-      } else
+	   them.  Use just the tree.  */
+	result = root;
+      else
 	result = Fcons (Qtop, Fcons (Qnil, Fnreverse (Fcons (r, result))));
 
       xmlFreeDoc (doc);
     }
 
+  parse_state = NULL;
   return result;
 }
 
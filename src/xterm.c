@@ -7421,6 +7421,61 @@ x_sync_handle_frame_drawn (struct x_display_info *dpyinfo,
 }
 #endif
 
+/* Add the rectangle at X, Y of size WIDTH by HEIGHT to the parts of
+   the back buffer of F that must be shown by the next call to
+   show_back_buffer.  */
+
+static void
+x_damage_rectangle (struct frame *f, int x, int y, int width, int height)
+{
+#ifdef HAVE_XDBE
+  struct x_output *output = FRAME_X_OUTPUT (f);
+
+  if (!FRAME_X_DOUBLE_BUFFERED_P (f) || width <= 0 || height <= 0)
+    return;
+
+  if (output->damage_width > 0)
+    {
+      int x1 = max (x + width, output->damage_x + output->damage_width);
+      int y1 = max (y + height, output->damage_y + output->damage_height);
+
+      x = min (x, output->damage_x);
+      y = min (y, output->damage_y);
+      width = x1 - x;
+      height = y1 - y;
+    }
+
+  output->damage_x = x;
+  output->damage_y = y;
+  output->damage_width = width;
+  output->damage_height = height;
+#endif
+}
+
+/* Begin drawing into the rectangle at X, Y of size WIDTH by HEIGHT on
+   F.  Until the matching call to x_damage_end, drawing on F doesn't
+   make show_back_buffer show all of the back buffer.  */
+
+static void
+x_damage_begin (struct frame *f, int x, int y, int width, int height)
+{
+  x_damage_rectangle (f, x, y, width, height);
+#ifdef HAVE_XDBE
+  FRAME_X_OUTPUT (f)->damage_tracking++;
+#endif
+}
+
+/* End drawing started by x_damage_begin.  */
+
+static void
+x_damage_end (struct frame *f)
+{
+#ifdef HAVE_XDBE
+  eassert (FRAME_X_OUTPUT (f)->damage_tracking > 0);
+  FRAME_X_OUTPUT (f)->damage_tracking--;
+#endif
+}
+
 /* Start an update of frame F.  This function is installed as a hook
    for update_begin, i.e. it is called when update_begin is called.
    This function is called prior to calls to gui_update_window_begin for
@@ -7462,12 +7517,14 @@ x_draw_vertical_window_border (struct window *w, int x, int y0, int y1)
     XSetForeground (FRAME_X_DISPLAY (f), f->output_data.x->normal_gc,
 		    face->foreground);
 
+  x_damage_begin (f, x, y0, 1, y1 - y0 + 1);
 #ifdef USE_CAIRO
   x_fill_rectangle (f, f->output_data.x->normal_gc, x, y0, 1, y1 - y0, false);
 #else
   XDrawLine (FRAME_X_DISPLAY (f), FRAME_X_DRAWABLE (f),
 	     f->output_data.x->normal_gc, x, y0, x, y1);
 #endif
+  x_damage_end (f);
 }
 
 /* Draw a window divider from (x0,y0) to (x1,y1)  */
@@ -7490,6 +7547,7 @@ x_draw_window_divider (struct window *w, int x0, int x1, int y0, int y1)
 			      : FRAME_FOREGROUND_PIXEL (f));
   Display *display = FRAME_X_DISPLAY (f);
 
+  x_damage_begin (f, x0, y0, x1 - x0, y1 - y0);
   if ((y1 - y0 > x1 - x0) && (x1 - x0 >= 3))
     /* A vertical divider, at least three pixels wide: Draw first and
        last pixels differently.  */
@@ -7526,23 +7584,29 @@ x_draw_window_divider (struct window *w, int x0, int x1, int y0, int y1)
       x_fill_rectangle (f, f->output_data.x->normal_gc,
 			x0, y0, x1 - x0, y1 - y0, false);
     }
+  x_damage_end (f);
 }
 
 #ifdef HAVE_XDBE
 
 /* Show the frame back buffer.  If frame is double-buffered,
    atomically publish to the user's screen graphics updates made since
-   the last call to show_back_buffer.  */
+   the last call to show_back_buffer.  If all of them were made in a
+   known part of the frame that is small enough, copy just that part
+   to the window, which is much cheaper than swapping the buffers for
+   small updates such as when the cursor moved.  */
 
 static void
 show_back_buffer (struct frame *f)
 {
   XdbeSwapInfo swap_info;
+  struct x_output *output = FRAME_X_OUTPUT (f);
 #ifdef USE_CAIRO
   cairo_t *cr;
 #endif
 
-  if (FRAME_X_DOUBLE_BUFFERED_P (f))
+  if (FRAME_X_DOUBLE_BUFFERED_P (f)
+      && (output->damage_all || output->damage_width > 0))
     {
 #if defined HAVE_XSYNC && !defined USE_GTK && defined HAVE_CLOCK_GETTIME
       /* Wait for drawing of the previous frame to complete before
@@ -7558,10 +7622,23 @@ show_back_buffer (struct frame *f)
       if (cr)
 	cairo_surface_flush (cairo_get_target (cr));
 #endif
-      memset (&swap_info, 0, sizeof (swap_info));
-      swap_info.swap_window = FRAME_X_WINDOW (f);
-      swap_info.swap_action = XdbeCopied;
-      XdbeSwapBuffers (FRAME_X_DISPLAY (f), &swap_info, 1);
+      if (!output->damage_all
+	  && ((intmax_t) output->damage_width * output->damage_height * 2
+	      < (intmax_t) FRAME_PIXEL_WIDTH (f) * FRAME_PIXEL_HEIGHT (f)))
+	/* The back buffer was created with XdbeCopied, so it is
+	   identical to the window outside of the damaged area.  */
+	XCopyArea (FRAME_X_DISPLAY (f), FRAME_X_RAW_DRAWABLE (f),
+		   FRAME_X_WINDOW (f), output->normal_gc,
+		   output->damage_x, output->damage_y,
+		   output->damage_width, output->damage_height,
+		   output->damage_x, output->damage_y);
+      else
+	{
+	  memset (&swap_info, 0, sizeof (swap_info));
+	  swap_info.swap_window = FRAME_X_WINDOW (f);
+	  swap_info.swap_action = XdbeCopied;
+	  XdbeSwapBuffers (FRAME_X_DISPLAY (f), &swap_info, 1);
+	}
 
 #if defined HAVE_XSYNC && !defined USE_GTK && defined HAVE_CLOCK_GETTIME
       /* Finish the frame here.  */
@@ -7570,6 +7647,8 @@ show_back_buffer (struct frame *f)
     }
 
   FRAME_X_NEED_BUFFER_FLIP (f) = false;
+  output->damage_all = false;
+  output->damage_width = 0;
 }
 
 #endif
@@ -7867,9 +7946,13 @@ x_draw_fringe_bitmap (struct window *w, struct glyph_row *row,
 
   /* Must clip because of partially visible lines.  */
   x_clip_to_row (w, row, ANY_AREA, gc, &clip_rect);
+  x_damage_begin (f, clip_rect.x, clip_rect.y,
+		  clip_rect.width, clip_rect.height);
 
   if (p->bx >= 0 && !p->overlay_p)
     {
+      x_damage_rectangle (f, p->bx, p->by, p->nx, p->ny);
+
       /* In case the same realized face is used for fringes and
 	 for something displayed in the text (e.g. face `region' on
 	 mono-displays, the fill style may have been changed to
@@ -8053,6 +8136,7 @@ x_draw_fringe_bitmap (struct window *w, struct glyph_row *row,
   undo_clip:
 #endif  /* not USE_CAIRO */
 
+  x_damage_end (f);
   x_reset_clip_rectangles (f, gc);
 }
 
@@ -10933,6 +11017,43 @@ x_fill_underline (struct frame *f, struct glyph_string *s,
     }
 }
 
+/* Begin drawing glyph string S.  Everything drawn for S, including
+   the overhangs of its neighbors and boxes, is clipped to the row of
+   S in its area of the window, so record that as damaged.  */
+
+static void
+x_damage_glyph_string_begin (struct glyph_string *s)
+{
+  struct window *w = s->w;
+  int x, y, width, height;
+
+  if (s->row->full_width_p)
+    {
+      x = WINDOW_LEFT_EDGE_X (w);
+      width = WINDOW_PIXEL_WIDTH (w);
+    }
+  else
+    {
+      x = window_box_left (w, s->area);
+      width = window_box_width (w, s->area);
+    }
+
+  if (s->for_overlaps)
+    {
+      /* Strings drawn for overlapping rows are only clipped to the
+	 window.  */
+      y = WINDOW_TO_FRAME_PIXEL_Y (w, 0);
+      height = WINDOW_PIXEL_HEIGHT (w);
+    }
+  else
+    {
+      y = WINDOW_TO_FRAME_PIXEL_Y (w, max (0, s->row->y));
+      height = max (s->row->height, s->height);
+    }
+
+  x_damage_begin (s->f, x, y, width, height);
+}
+
 /* Draw glyph string S.  */
 
 static void
@@ -10940,6 +11061,8 @@ x_draw_glyph_string (struct glyph_string *s)
 {
   bool relief_drawn_p = false;
 
+  x_damage_glyph_string_begin (s);
+
   /* If S draws into the background of its successors, draw the
      background of the successors first so that S can draw into it.
      This makes S->next use XDrawString instead of XDrawImageString.  */
@@ -11300,6 +11423,8 @@ x_draw_glyph_string (struct glyph_string *s)
       && s->first_glyph->type != IMAGE_GLYPH
       && !s->row->stipple_p)
     s->row->stipple_p = s->stippled_p;
+
+  x_damage_end (s->f);
 }
 
 /* Shift display to make room for inserted glyphs.   */
@@ -11831,6 +11956,8 @@ x_scroll_run (struct window *w, struct run *run)
     }
 #endif
 
+  x_damage_begin (f, x, to_y, width, height);
+
 #ifdef USE_CAIRO_XCB_SURFACE
   /* Some of the following code depends on `normal_gc' being
      up-to-date on the X server, but doesn't call a routine that will
@@ -11900,6 +12027,7 @@ x_scroll_run (struct window *w, struct run *run)
 	       width, height,
 	       x, to_y);
 
+  x_damage_end (f);
   unblock_input ();
 }
 
@@ -19951,7 +20079,13 @@ handle_one_xevent (struct x_display_info *dpyinfo,
 
 #ifdef HAVE_XDBE
           if (!FRAME_GARBAGED_P (f))
-            show_back_buffer (f);
+	    {
+	      /* The window lost its contents in the exposed area.  */
+	      x_damage_rectangle (f, event->xexpose.x, event->xexpose.y,
+				  event->xexpose.width,
+				  event->xexpose.height);
+	      show_back_buffer (f);
+	    }
 #endif
         }
       else
@@ -19989,6 +20123,10 @@ handle_one_xevent (struct x_display_info *dpyinfo,
 	  x_clear_under_internal_border (f);
 #endif
 #ifdef HAVE_XDBE
+	  x_damage_rectangle (f, event->xgraphicsexpose.x,
+			      event->xgraphicsexpose.y,
+			      event->xgraphicsexpose.width,
+			      event->xgraphicsexpose.height);
 	  show_back_buffer (f);
 #endif
         }
@@ -21001,6 +21139,28 @@ handle_one_xevent (struct x_display_info *dpyinfo,
       {
 	XMotionEvent xmotion = event->xmotion;
 
+	/* A fast mouse or touchpad can generate motion events faster
+	   than we can respond to them.  As with ConfigureNotify
+	   below, if this MotionNotify is immediately followed by
+	   another one for the same window and with the same button
+	   and modifier state, only the latter matters for mouse
+	   highlighting, help echo and mouse movement events, so
+	   don't process this one.  Drag-and-drop reports each
+	   position to the drop target, so leave it alone.  */
+	if (!x_dnd_in_progress
+	    && !xmotion.send_event
+	    && XPending (dpyinfo->display))
+	  {
+	    XPeekEvent (dpyinfo->display, &next_event);
+	    if (next_event.type == MotionNotify
+		&& !next_event.xmotion.send_event
+		&& next_event.xmotion.window == xmotion.window
+		&& next_event.xmotion.subwindow == xmotion.subwindow
+		&& next_event.xmotion.state == xmotion.state
+		&& next_event.xmotion.same_screen == xmotion.same_screen)
+	      goto OTHER;
+	  }
+
         previous_help_echo_string = help_echo_string;
         help_echo_string = Qnil;
 
@@ -25867,6 +26027,7 @@ x_draw_hollow_cursor (struct window *w, struct glyph_row *row)
   /* Compute frame-relative coordinates for phys cursor.  */
   get_phys_cursor_geometry (w, row, cursor_glyph, &x, &y, &h);
   wd = w->phys_cursor_width - 1;
+  x_damage_begin (f, x, y, max (wd, cursor_glyph->pixel_width) + 1, h);
 
   /* The foreground of cursor_gc is typically the same as the normal
      background color, which can cause the cursor box to be invisible.  */
@@ -25893,6 +26054,7 @@ x_draw_hollow_cursor (struct window *w, struct glyph_row *row)
   x_clip_to_row (w, row, TEXT_AREA, gc, NULL);
   x_draw_rectangle (f, gc, x, y, wd, h - 1);
   x_reset_clip_rectangles (f, gc);
+  x_damage_end (f);
 }
 
 
@@ -25931,6 +26093,11 @@ x_draw_bar_cursor (struct window *w, struct glyph_row *row, int width, enum text
     }
   else
     {
+      x_damage_begin (f, WINDOW_TEXT_TO_FRAME_PIXEL_X (w, w->phys_cursor.x),
+		      WINDOW_TO_FRAME_PIXEL_Y (w, w->phys_cursor.y),
+		      max (cursor_glyph->pixel_width, w->phys_cursor_width),
+		      row->height);
+
       Display *dpy = FRAME_X_DISPLAY (f);
       Drawable drawable = FRAME_X_DRAWABLE (f);
       GC gc = FRAME_DISPLAY_INFO (f)->scratch_cursor_gc;
@@ -26004,6 +26171,7 @@ x_draw_bar_cursor (struct window *w, struct glyph_row *row, int width, enum text
 	}
 
       x_reset_clip_rectangles (f, gc);
+      x_damage_end (f);
     }
 }
 
@@ -26025,7 +26193,9 @@ x_define_frame_cursor (struct frame *f, Emacs_Cursor cursor)
 static void
 x_clear_frame_area (struct frame *f, int x, int y, int width, int height)
 {
+  x_damage_begin (f, x, y, width, height);
   x_clear_area (f, x, y, width, height);
+  x_damage_end (f);
 }
 
 
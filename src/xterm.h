@@ -1237,6 +1237,19 @@ #define X_INVALID_WINDOW 0xffffffff
      complete and can be safely flushed while handling async
      input.  */
   bool_bf complete : 1;
+
+  /* Flag that indicates whether something was drawn into the back
+     buffer without recording where, so that all of it must be
+     published when it is next shown.  */
+  bool_bf damage_all : 1;
+
+  /* The bounding box of the areas of the back buffer drawn since it
+     was last shown.  DAMAGE_WIDTH is zero if nothing was recorded.  */
+  int damage_x, damage_y, damage_width, damage_height;
+
+  /* Greater than zero while drawing whose extent was already added
+     to the bounding box above.  */
+  int damage_tracking;
 #endif
 
 #ifdef HAVE_X_I18N
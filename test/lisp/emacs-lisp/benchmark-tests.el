@@ -60,4 +60,23 @@ benchmark-tests
     ;; Silence compiler.
     m))
 
+(ert-deftest benchmark-redisplay-test ()
+  (let ((file (make-temp-file "benchmark" nil ".txt"))
+        result)
+    (unwind-protect
+        (progn
+          (with-temp-file file
+            (dotimes (i 1000)
+              (insert (format "Line %d\n" i))))
+          (setq result (benchmark-redisplay file 10))
+          (should (= (plist-get result :frames) 10))
+          (should (<= (plist-get result :min)
+                      (plist-get result :median)
+                      (plist-get result :p90)
+                      (plist-get result :max)))
+          (should (<= (plist-get result :max) (plist-get result :total))))
+      (when-let* ((buffer (find-buffer-visiting file)))
+        (kill-buffer buffer))
+      (delete-file file))))
+
 ;;; benchmark-tests.el ends here.
@@ -2246,6 +2246,56 @@ bytecomp--eq-symbols-with-pos-enabled
             (should (equal (funcall eq-fn sym-with-pos1 sym-with-pos1) t))
             (should (equal (funcall eq-fn sym-with-pos1 sym-with-pos2) t))))))))
 
+(defvar bytecomp-tests--fuse-var '(1 2 3))
+
+(ert-deftest bytecomp-tests-fused-instructions ()
+  "Check that superinstructions are emitted, run and decompiled."
+  (let* ((source (lambda (x f)
+                   (let* ((a (car bytecomp-tests--fuse-var))
+                          (y (and x (funcall f x))))
+                     (if y (+ a y) a))))
+         (fused (let ((byte-compile-fuse-instructions t))
+                  (byte-compile source)))
+         (plain (let ((byte-compile-fuse-instructions nil))
+                  (byte-compile source)))
+         (ops (lambda (fun)
+                (mapcar #'car (seq-remove #'numberp
+                                          (byte-decompile-bytecode
+                                           (aref fun 1) (aref fun 2)))))))
+    (dolist (op byte-fused-ops)
+      (should (seq-contains-p (aref fused 1) (symbol-value op)))
+      (should-not (seq-contains-p (aref plain 1) (symbol-value op))))
+    (dolist (args '((3 1+) (nil 1+) (3 ignore)))
+      (should (equal (apply fused args) (apply plain args))))
+    ;; The decompiled fused code is the same as the plain code.
+    (should (equal (funcall ops fused) (funcall ops plain)))
+    (let ((bytecomp-tests--fuse-var 'not-a-list))
+      (should-error (funcall fused 3 #'1+) :type 'wrong-type-argument))))
+
+(ert-deftest bytecomp-tests-byte-code-profile ()
+  "Check that the byte-code profiler counts instructions and calls."
+  (let ((f (byte-compile
+            (lambda (n)
+              (let ((s 0))
+                (dotimes (i n)
+                  (setq s (+ s (abs i))))
+                s))))
+        (goto (seq-position byte-code-vector 'byte-goto)))
+    (unwind-protect
+        (progn
+          (should (byte-code-profile-start))
+          (should (byte-code-profile-running-p))
+          (should (= (funcall (byte-compile (lambda () (funcall f 100))))
+                     4950)))
+      (byte-code-profile-stop))
+    (should-not (byte-code-profile-running-p))
+    (should-not (byte-code-profile-stop))
+    (should (>= (gethash goto (byte-code-profile-opcodes) 0) 100))
+    (should (= (gethash 'abs (byte-code-profile-calls)) 100))
+    ;; Nothing is counted while stopped.
+    (funcall f 100)
+    (should (= (gethash 'abs (byte-code-profile-calls)) 100))))
+
 ;; Local Variables:
 ;; no-byte-compile: t
 ;; End:
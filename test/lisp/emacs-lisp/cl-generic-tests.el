@@ -332,5 +332,22 @@ cl-generic-tests--print-quoted
     ;; But we don't want (eql '4) to turn into (eql (quote 4)) either.
     (should (re-search-forward "(eql '4)" nil t))))
 
+(ert-deftest cl-generic-tests-fixed-arity-dispatch ()
+  (cl-defgeneric cl-generic-tests--arity (x y))
+  (cl-defmethod cl-generic-tests--arity ((x integer) y) (list 'int x y))
+  (cl-defmethod cl-generic-tests--arity ((x symbol) y)
+    (cons 'sym (cl-call-next-method x y)))
+  (cl-defmethod cl-generic-tests--arity (x y) (list 'any x y))
+  (should (equal (cl-generic-tests--arity 1 2) '(int 1 2)))
+  (should (equal (cl-generic-tests--arity 'a 2) '(sym any a 2)))
+  (should-error (cl-generic-tests--arity 1 2 3)
+                :type 'wrong-number-of-arguments)
+  ;; Methods with different numbers of arguments still work.
+  (cl-defmethod cl-generic-tests--arity ((x string) y &optional z)
+    (list 'str x y z))
+  (should (equal (cl-generic-tests--arity "a" 2) '(str "a" 2 nil)))
+  (should (equal (cl-generic-tests--arity "a" 2 3) '(str "a" 2 3)))
+  (should (equal (cl-generic-tests--arity 1 2) '(int 1 2))))
+
 (provide 'cl-generic-tests)
 ;;; cl-generic-tests.el ends here
@@ -24,6 +24,7 @@
 (require 'ert)
 (require 'ert-x)
 (require 'comp)
+(require 'comp-run)
 
 (defvar comp-native-version-dir)
 (defvar native-comp-eln-load-path)
@@ -81,4 +82,49 @@ test-native-compile-prune-cache/dont-delete-in-parent-of-cache
       (dolist (f (list f1 f2 f3 f4))
 	(should (file-regular-p f))))))
 
+;; The job queue and limits do not need the native compiler itself.
+
+(ert-deftest test-native-comp-queue-file ()
+  (let ((comp-files-queue nil))
+    (comp--queue-file "a.el" nil)
+    (comp--queue-file "b.el" 'late)
+    (comp--queue-file "c.el" nil)
+    (comp--queue-file "d.el" t)
+    (should (equal comp-files-queue
+                   '(("b.el" . late) ("d.el" . t)
+                     ("a.el") ("c.el"))))))
+
+(ert-deftest test-native-comp-make-jobs-limit ()
+  (let ((process-environment (copy-sequence process-environment)))
+    (setenv "MAKEFLAGS" nil)
+    (should-not (comp--make-jobs-limit))
+    (setenv "MAKEFLAGS" "s -j6 --jobserver-auth=fifo:/tmp/GMfifo1")
+    (should (= (comp--make-jobs-limit) 6))
+    (setenv "MAKEFLAGS" " --jobs=3")
+    (should (= (comp--make-jobs-limit) 3))
+    (setenv "MAKEFLAGS" "k -j --jobserver-auth=3,4")
+    (should-not (comp--make-jobs-limit))
+    (let ((native-comp-async-jobs-number 2))
+      (should (= (comp--effective-async-max-jobs) 2)))))
+
+(ert-deftest test-native-comp-profile-hot-functions ()
+  (let ((log (make-hash-table :test #'equal))
+        (native-comp-profile-threshold 0.2))
+    (puthash [foo bar foo nil] 70 log)
+    (puthash [baz "lambda" nil nil] 25 log)
+    (puthash [qux nil nil nil] 5 log)
+    (let ((hot (comp--profile-hot-functions
+                (vector 'profiler-profile "3" 'cpu log nil nil))))
+      (should (= (hash-table-count hot) 3))
+      (dolist (f '(foo bar baz))
+        (should (gethash f hot))))
+    (let ((calls (make-hash-table :test #'eq)))
+      (puthash 'foo 10 calls)
+      (puthash 'bar 1 calls)
+      (let ((hot (comp--profile-hot-functions calls)))
+        (should (gethash 'foo hot))
+        (should-not (gethash 'bar hot))))
+    (let ((native-comp-profile nil))
+      (should-not (comp--profile-hot-functions)))))
+
 ;;; comp-tests.el ends here
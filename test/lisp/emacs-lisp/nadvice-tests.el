@@ -239,4 +239,22 @@ advice-test-bug61179
     (advice-add sym :before ad)
     (should (equal (call-interactively sym) '(42 main)))))
 
+(ert-deftest advice-test-fixed-nargs ()
+  (let ((sym (make-symbol "adtest"))
+        (around (lambda (orig x y) (list 'around (funcall orig x y)))))
+    (defalias sym (lambda (x y) (list x y)))
+    (advice-add sym :around around)
+    (advice-add sym :before #'ignore)
+    (should (equal (funcall sym 1 2) '(around (1 2))))
+    (should (equal (func-arity (symbol-function sym)) '(2 . 2)))
+    (should-error (funcall sym 1) :type 'wrong-number-of-arguments)
+    ;; Redefining the function with other arguments keeps the advice
+    ;; working.
+    (defalias sym (lambda (x &optional y) (list x y)))
+    (should (equal (funcall sym 1 2) '(around (1 2))))
+    (advice-remove sym around)
+    (should (equal (funcall sym 1) '(1 nil)))
+    (advice-remove sym #'ignore)
+    (should (equal (funcall sym 1) '(1 nil)))))
+
 ;;; nadvice-tests.el ends here
@@ -65,4 +65,24 @@ timer-next-integral-multiple-of-time-3
   (let ((nt (timer-next-integral-multiple-of-time '(32770 . 65539) 0.5)))
     (should (time-equal-p 1 nt))))
 
+;; Timers must be kept sorted, each one before those with the same time.
+(ert-deftest timer-tests-activate-order ()
+  (let ((timer-list nil)
+        (timers nil)
+        (now (current-time)))
+    (random "timer-tests")
+    (dotimes (i 200)
+      (let ((timer (timer-create)))
+        (timer-set-time timer (time-add now (random 50)))
+        (timer-set-function timer #'ignore (list i))
+        (timer-activate timer)
+        (push timer timers)))
+    (should (= (length timer-list) 200))
+    (should (equal timer-list
+                   (sort timers
+                         :key #'timer--time :lessp #'time-less-p)))
+    (should-error (timer-activate (car timers)))
+    (cancel-timer (nth 10 timers))
+    (should (= (length timer-list) 199))))
+
 ;;; timer-tests.el ends here
@@ -250,6 +250,34 @@ files-tests-bug-18141
       (save-buffer)
       (should (eq buffer-file-coding-system 'iso-2022-7bit-unix)))))
 
+(ert-deftest files-tests-insert-file-contents-async ()
+  "Test inserting a file in chunks with `insert-file-contents-async'."
+  (ert-with-temp-file tempfile
+    :coding 'utf-8-unix
+    :text (mapconcat (lambda (i) (format "line %d \u00e9\u00e8\n" i))
+                     (number-sequence 1 100))
+    (let ((expected (with-temp-buffer
+                      (insert-file-contents tempfile)
+                      (buffer-string))))
+      (dolist (coding '(nil utf-16))
+        (when coding
+          (let ((coding-system-for-write coding))
+            (write-region expected nil tempfile)))
+        (with-temp-buffer
+          (let* ((coding-system-for-read coding)
+                 (done nil))
+            (insert "<>")
+            (goto-char 2)
+            (insert-file-contents-async tempfile
+                                        (lambda (n) (setq done n)) 50)
+            (with-timeout (10 (ert-fail "Insertion timed out"))
+              (while (not done)
+                (accept-process-output nil 0.01)))
+            (should (= done (length expected)))
+            (should (= (point) 2))
+            (should (equal (buffer-string)
+                           (concat "<" expected ">")))))))))
+
 (ert-deftest files-tests-make-temp-file-empty-prefix ()
   "Test make-temp-file with an empty prefix."
   (let ((tempfile (make-temp-file ""))
@@ -1449,6 +1477,47 @@ files-tests-copy-directory
       (copy-directory source3 (file-name-directory dest3) t)
       (delete-directory dir 'recursive))))
 
+;; The C implementation used for local directories must return the
+;; same files, in the same order, as the Lisp one.
+(ert-deftest files-tests-directory-files-recursively ()
+  (ert-with-temp-directory dir
+    (let ((dir (directory-file-name dir)))
+      (dolist (subdir '("a/b" "a-b" "c" ".git/objects"))
+        (make-directory (expand-file-name subdir dir) t))
+      (dolist (file '("a.txt" "a/x.el" "a/b/y.el" "a-b/z" "c/w"
+                      ".git/config" ".git/objects/o.el"))
+        (write-region "" nil (expand-file-name file dir)))
+      (when (ignore-errors
+              (make-symbolic-link "../a" (expand-file-name "c/lnk" dir))
+              t)
+        (should (equal (directory-files-recursively dir "\\`x" nil nil t)
+                       (list (expand-file-name "a/x.el" dir)
+                             (expand-file-name "c/lnk/x.el" dir)))))
+      (dolist (args '(("") ("\\.el\\'") ("" t) ("a" t) ("\\.el\\'" nil nil t)))
+        (should (equal (apply #'directory-files-recursively dir args)
+                       (apply #'files--directory-files-recursively dir
+                              (append args
+                                      (make-list (- 4 (length args))
+                                                 nil))))))
+      (should (equal (directory-files-recursively dir "")
+                     (mapcar (lambda (file) (expand-file-name file dir))
+                             '(".git/objects/o.el" ".git/config"
+                               "a-b/z" "a/b/y.el" "a/x.el" "c/w"
+                               "a.txt"))))
+      ;; Pruning with a list of regexps, and with a function.
+      (should (equal (directory-files-recursively dir "\\.el\\'" nil
+                                                  '("\\`\\.git\\'" "\\`b\\'"))
+                     (list (expand-file-name "a/x.el" dir))))
+      (should (equal (directory-files-recursively
+                      dir "\\.el\\'" nil
+                      (lambda (subdir)
+                        (not (member (file-name-nondirectory subdir)
+                                     '(".git" "b")))))
+                     (list (expand-file-name "a/x.el" dir))))
+      (should-error (directory-files-recursively
+                     (expand-file-name "nonexistent" dir) "")
+                    :type 'file-missing))))
+
 (ert-deftest files-tests-abbreviate-file-name-homedir ()
   ;; Check homedir abbreviation.
   (let* ((homedir temporary-file-directory)
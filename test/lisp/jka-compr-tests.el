@@ -0,0 +1,66 @@
+;;; jka-compr-tests.el --- Tests for jka-compr.el  -*- lexical-binding: t; -*-
+
+;; Copyright (C) 2025 Free Software Foundation, Inc.
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <https://www.gnu.org/licenses/>.
+
+;;; Code:
+
+(require 'ert)
+(require 'ert-x)
+(require 'jka-compr)
+
+(defun jka-compr-tests--insert (file &rest args)
+  "Return what `insert-file-contents' with ARGS inserts from FILE.
+Start with a buffer holding \"old\\n\", with point at its end."
+  (with-temp-buffer
+    (insert "old\n")
+    (apply #'insert-file-contents file args)
+    (list (buffer-string) (point))))
+
+(ert-deftest jka-compr-tests-insert-gzip ()
+  "Check that both ways of uncompressing gzip files agree."
+  (skip-unless (and (fboundp 'zlib-available-p)
+                    (zlib-available-p)
+                    (executable-find "gzip")))
+  (ert-with-temp-file file
+    :suffix ".gz"
+    (let ((jka-compr-compression-info-list
+           jka-compr-compression-info-list)
+          (auto-compression-mode t)
+          (text "First line\nSecond line\nThird line\n"))
+      (auto-compression-mode 1)
+      (let ((jka-compr-verbose nil))
+        (with-temp-buffer
+          (insert text)
+          (write-region nil nil file nil 'silent)))
+      (dolist (args '(() (nil nil nil t) (nil 6 15) (nil 11) (nil nil 4)))
+        (let ((internal (let ((jka-compr-prefer-uncompress-function t))
+                          (apply #'jka-compr-tests--insert file args)))
+              (external (let ((jka-compr-prefer-uncompress-function nil))
+                          (apply #'jka-compr-tests--insert file args))))
+          (should (equal internal external))))
+      (let ((jka-compr-prefer-uncompress-function t))
+        (should (equal (jka-compr-tests--insert file)
+                       (list (concat "old\n" text) 5)))
+        (delete-file file)
+        (should-error (jka-compr-tests--insert file) :type 'file-missing)
+        ;; When visiting, the buffer visits FILE anyway.
+        (with-temp-buffer
+          (should-error (insert-file-contents file t) :type 'file-missing)
+          (should (equal buffer-file-name file)))))))
+
+;;; jka-compr-tests.el ends here
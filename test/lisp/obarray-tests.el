@@ -89,5 +89,23 @@ obarray-clear
       (mapatoms (lambda (_) (setq n (1+ n))) o)
       (should (equal n 0)))))
 
+(ert-deftest obarray-grow ()
+  "Symbols should still be found after the obarray has grown."
+  (let ((o (obarray-make 1))
+        (syms nil))
+    (dotimes (i 2000)
+      (push (intern (format "sym-%d" i) o) syms))
+    ;; A multibyte name with the same bytes as a unibyte name is a
+    ;; different symbol.
+    (let ((uni (intern "\303\251" o))
+          (multi (intern "\u00e9" o)))
+      (should-not (eq uni multi)))
+    (unintern "sym-7" o)
+    (dotimes (i 2000)
+      (let ((name (format "sym-%d" i)))
+        (if (= i 7)
+            (should-not (intern-soft name o))
+          (should (eq (intern-soft name o) (nth (- 1999 i) syms))))))))
+
 (provide 'obarray-tests)
 ;;; obarray-tests.el ends here
@@ -228,4 +228,37 @@ server-tests/server-force-stop/keeps-frames
     (mapc (lambda (frame) (delete-frame frame t))
           (cl-set-difference (frame-list) starting-frames))))
 
+(ert-deftest server-tests/emacsclient/batch ()
+  "Test that \"emacsclient --batch\" runs in a copy of a fork server."
+  (skip-unless (and (featurep 'make-network-process '(:family local))
+                    (not (memq system-type '(windows-nt ms-dos)))))
+  (let* ((dir (file-name-as-directory
+               (file-truename (make-temp-file "server-tests" t))))
+         (socket (expand-file-name "batch" dir))
+         (server (start-process
+                  "batch-server" nil
+                  (expand-file-name invocation-name invocation-directory)
+                  "-Q" "--batch" "-l" "server"
+                  "--eval" (format "(server-batch-start %S)" socket))))
+    (unwind-protect
+        (progn
+          (server-tests/wait-until (file-exists-p socket))
+          (with-temp-buffer
+            (let ((default-directory dir)
+                  (process-environment
+                   (cons "SERVER_TESTS=yes" process-environment)))
+              (should (= (call-process
+                          server-tests/emacsclient nil t nil
+                          "-s" socket "--batch" "--eval"
+                          "(progn (princ (list default-directory
+                                               (getenv \"SERVER_TESTS\")
+                                               command-line-args-left))
+                                  (kill-emacs 3))"
+                          "foo")
+                         3))
+              (should (equal (buffer-string)
+                             (format "(%s yes (foo))" dir))))))
+      (delete-process server)
+      (delete-directory dir t))))
+
 ;;; server-tests.el ends here
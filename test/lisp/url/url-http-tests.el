@@ -0,0 +1,105 @@
+;;; url-http-tests.el --- Test suite for url-http. -*- lexical-binding: t -*-
+
+;; Copyright (C) 2025 Free Software Foundation, Inc.
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <https://www.gnu.org/licenses/>.
+
+;;; Commentary:
+
+;;; Code:
+
+(require 'url-http)
+(require 'ert)
+
+(defvar url-http-tests--connections nil
+  "Connections accepted by the test server.")
+
+(defun url-http-tests--filter (proc string)
+  "Answer each complete request that PROC receives in STRING."
+  (let ((pending (concat (process-get proc 'pending) string)))
+    (while (string-match "\r\n\r\n" pending)
+      (setq pending (substring pending (match-end 0)))
+      (process-send-string
+       proc
+       "HTTP/1.1 200 OK\r\nContent-Length: 2\r\nContent-Type: text/plain\r\n\r\nok"))
+    (process-put proc 'pending pending)))
+
+(defmacro url-http-tests--with-server (port &rest body)
+  "Run BODY with PORT bound to the port of a local HTTP server."
+  (declare (indent 1))
+  (let ((server (make-symbol "server")))
+    `(let* ((url-http-tests--connections nil)
+            (,server (make-network-process
+                      :name "url-http-tests" :server t :host 'local
+                      :service t :family 'ipv4 :coding 'binary
+                      :filter #'url-http-tests--filter
+                      :log (lambda (_server client _message)
+                             (push client url-http-tests--connections))))
+            (,port (process-contact ,server :service))
+            (url-http-open-connections (make-hash-table :test 'equal))
+            (url-http--busy-connections (make-hash-table :test 'equal))
+            (url-http--pending-requests (make-hash-table :test 'equal))
+            (url-proxy-services nil))
+       (unwind-protect
+           (progn ,@body)
+         (maphash (lambda (_key conns) (mapc #'delete-process conns))
+                  url-http-open-connections)
+         (mapc #'delete-process url-http-tests--connections)
+         (delete-process ,server)))))
+
+(defun url-http-tests--retrieve (port count)
+  "Retrieve COUNT documents from the test server at PORT concurrently.
+Return the number of successful retrievals."
+  (let ((done 0)
+        (ok 0))
+    (dotimes (i count)
+      (url-retrieve (format "http://127.0.0.1:%d/%d" port i)
+                    (lambda (status)
+                      (setq done (1+ done))
+                      (goto-char (point-max))
+                      (when (and (not (plist-get status :error))
+                                 (looking-back "\n\nok" nil))
+                        (setq ok (1+ ok)))
+                      (kill-buffer))
+                    nil t t))
+    (with-timeout (10 (ert-fail "Timed out"))
+      (while (< done count)
+        (accept-process-output nil 0.05)))
+    ok))
+
+(ert-deftest url-http-max-connections-per-host ()
+  "Test that retrievals wait for a free connection."
+  (skip-unless (featurep 'make-network-process '(:server t)))
+  (url-http-tests--with-server port
+    (let ((url-http-max-connections-per-host 2))
+      (should (= (url-http-tests--retrieve port 6) 6))
+      (should (<= (length url-http-tests--connections) 2)))))
+
+(ert-deftest url-http-idle-connection-timeout ()
+  "Test that expired idle connections are not reused."
+  (skip-unless (featurep 'make-network-process '(:server t)))
+  (url-http-tests--with-server port
+    (let ((url-http-idle-connection-timeout 60))
+      (should (= (url-http-tests--retrieve port 1) 1))
+      (should (= (url-http-tests--retrieve port 1) 1))
+      (should (= (length url-http-tests--connections) 1)))
+    (let ((url-http-idle-connection-timeout 0))
+      (should (= (url-http-tests--retrieve port 1) 1))
+      (should (= (length url-http-tests--connections) 2)))))
+
+(provide 'url-http-tests)
+
+;;; url-http-tests.el ends here
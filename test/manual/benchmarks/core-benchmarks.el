@@ -0,0 +1,354 @@
+;;; core-benchmarks.el --- Benchmarks of core hot paths  -*- lexical-binding:t -*-
+
+;; Copyright (C) 2025 Free Software Foundation, Inc.
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <https://www.gnu.org/licenses/>.
+
+;;; Commentary:
+
+;; A small, repeatable suite of benchmarks for the hot paths of the
+;; C core and of a few central Lisp facilities, built on
+;; `benchmark-call'.  Each benchmark works on a corpus that is
+;; generated from a fixed seed, so results of different builds are
+;; comparable.
+;;
+;; Run all the benchmarks with
+;;
+;;   make -C test/manual/benchmarks bench
+;;
+;; or directly with
+;;
+;;   emacs -Q --batch -l core-benchmarks.el -f core-bench-run-batch \
+;;     [OUTPUT-FILE [SELECTOR]]
+;;
+;; Each result is appended to OUTPUT-FILE as one JSON object per line,
+;; which records the benchmark name, the Emacs version and repository
+;; revision, and the elapsed time, number of garbage collections and
+;; time spent in them.  Without OUTPUT-FILE, the lines are printed to
+;; standard output.  SELECTOR is a regexp which limits the run to
+;; benchmarks whose names match.
+;;
+;; Benchmarks that cannot run in the current session, such as the
+;; tree-sitter benchmark without the C grammar, are reported as
+;; skipped.  In batch mode, the redisplay benchmark redisplays the
+;; initial frame, whose glyphs are only produced in memory.
+;;
+;; Use `core-bench-define' to add a benchmark.
+
+;;; Code:
+
+(require 'benchmark)
+(require 'cl-lib)
+
+(declare-function treesit-available-p "treesit.c")
+(declare-function treesit-language-available-p "treesit.c")
+(declare-function treesit-parser-create "treesit.c")
+(declare-function treesit-parser-root-node "treesit.c")
+(declare-function treesit-query-compile "treesit.c")
+(declare-function treesit-query-capture "treesit.c")
+
+(defvar core-bench-repetitions 5
+  "Number of times that each benchmark is repeated.")
+
+(defvar core-bench--benchmarks nil
+  "List of (NAME DOC FUNCTION) of the defined benchmarks, in reverse order.")
+
+(defvar core-bench--result nil
+  "The measurement of the benchmark that is running.")
+
+(defmacro core-bench-define (name doc &rest body)
+  "Define a benchmark called NAME, a symbol, with documentation DOC.
+BODY prepares the corpus of the benchmark, and measures the code
+of interest with `core-bench-measure'.  BODY can call
+`core-bench-skip' to report why the benchmark cannot run."
+  (declare (indent 1) (doc-string 2))
+  `(setf (alist-get ',name core-bench--benchmarks)
+         (list ,doc (lambda () ,@body))))
+
+(defmacro core-bench-measure (&rest body)
+  "Measure the time it takes to evaluate BODY.
+BODY is evaluated `core-bench-repetitions' times."
+  (declare (indent 0))
+  `(progn
+     (garbage-collect)
+     (setq core-bench--result
+           (benchmark-call (lambda () ,@body) core-bench-repetitions))))
+
+(defun core-bench-skip (reason)
+  "Skip the running benchmark, because of REASON."
+  (throw 'core-bench-skip reason))
+
+(defun core-bench--corpus (lines)
+  "Return a pseudo-random Emacs Lisp text of at least LINES lines.
+The text is the same for each call with the same LINES."
+  (random "core-bench")
+  (let ((words ["foo" "bar-baz" "quux" "frobnicate" "widget" "buffer"
+                "point" "window" "mark" "region" "symbol" "list"])
+        (pieces nil)
+        (n 0))
+    (while (< n lines)
+      (let ((name (format "core-bench-%s-%d"
+                          (aref words (random (length words))) n)))
+        (push (format "(defun %s (arg &optional flag)
+  \"Return the %s of ARG, or \\='%s if FLAG.\"
+  ;; Compute the %s.
+  (let ((x (* arg %d)))
+    (if flag '%s (concat \"%s\" (number-to-string x)))))\n\n"
+                      name (aref words (random (length words)))
+                      (aref words (random (length words)))
+                      (aref words (random (length words)))
+                      (random 1000)
+                      (aref words (random (length words)))
+                      (aref words (random (length words))))
+              pieces)
+        (setq n (+ n 7))))
+    (apply #'concat (nreverse pieces))))
+
+(defun core-bench--c-corpus (lines)
+  "Return a pseudo-random C text of at least LINES lines."
+  (random "core-bench")
+  (let ((pieces nil)
+        (n 0))
+    (while (< n lines)
+      (push (format "static int
+f%d (int a, const char *s)
+{
+  int x = a * %d;
+  if (s[0] == '%c')
+    return g%d (x, s + 1);
+  return x;
+}\n\n"
+                    n (random 1000) (+ ?a (random 26)) (random 100))
+            pieces)
+      (setq n (+ n 10)))
+    (apply #'concat (nreverse pieces))))
+
+(defun core-bench--json-object (depth)
+  "Return a pseudo-random JSON object of nesting DEPTH."
+  (let ((table (make-hash-table :test #'equal)))
+    (dotimes (i 8)
+      (puthash (format "key%d" i)
+               (if (and (> depth 0) (< i 3))
+                   (core-bench--json-object (1- depth))
+                 (pcase (random 4)
+                   (0 (random 100000))
+                   (1 (/ (random 100000) 7.0))
+                   (2 (format "stréing %d" (random 1000)))
+                   (_ (vector 1 2 "three" :false :null))))
+               table))
+    table))
+
+(defun core-bench--json-array (length depth)
+  "Return a vector of LENGTH JSON objects of nesting DEPTH."
+  (random "core-bench")
+  (let ((array (make-vector length nil)))
+    (dotimes (i length)
+      (aset array i (core-bench--json-object depth)))
+    array))
+
+(core-bench-define redisplay-scroll
+  "Redisplay while scrolling through a large buffer."
+  ;; In batch mode, redisplay the initial frame in memory.
+  (let ((buffer (generate-new-buffer " *core-bench*"))
+        (redisplay-skip-initial-frame
+         (and (not noninteractive) redisplay-skip-initial-frame)))
+    (unwind-protect
+        (save-window-excursion
+          (switch-to-buffer buffer)
+          (insert (core-bench--corpus 20000))
+          (emacs-lisp-mode)
+          (core-bench-measure
+            (goto-char (point-min))
+            (redisplay t)
+            (dotimes (_ 100)
+              (scroll-up)
+              (redisplay t))))
+      (kill-buffer buffer))))
+
+(core-bench-define font-lock-regexp
+  "Fontify a large Emacs Lisp buffer with regexp-based font-lock."
+  (with-temp-buffer
+    (insert (core-bench--corpus 20000))
+    (emacs-lisp-mode)
+    (core-bench-measure
+      (font-lock-flush)
+      (font-lock-ensure))))
+
+(core-bench-define json-parse-string
+  "Parse a large JSON text."
+  (let ((json (json-serialize (core-bench--json-array 20 5))))
+    (core-bench-measure
+      (json-parse-string json))))
+
+(core-bench-define json-serialize
+  "Serialize a large nested Lisp object as JSON."
+  (let ((object (core-bench--json-array 20 5)))
+    (core-bench-measure
+      (json-serialize object))))
+
+(core-bench-define float-print-read
+  "Print many floats and read them back."
+  (random "core-bench")
+  (let ((floats (mapcar (lambda (i) (/ (random 1000000) (+ i 7.0)))
+                        (number-sequence 1 100000))))
+    (core-bench-measure
+      (car (read-from-string (prin1-to-string floats))))))
+
+(core-bench-define gc-cons-heavy
+  "Garbage collection under a load that allocates many conses."
+  (let ((gc-cons-threshold 800000)
+        (gc-cons-percentage 0.1)
+        (live nil))
+    (core-bench-measure
+      (dotimes (i 200)
+        ;; Keep some of the allocated data alive, so that the
+        ;; collector has to mark as well as sweep.
+        (let ((l (make-list 5000 i)))
+          (when (zerop (% i 10))
+            (push l live))
+          (ignore (mapcar #'1+ l))))
+      (setq live nil))))
+
+(core-bench-define condition-case
+  "Enter and leave many `condition-case' and `catch' forms."
+  (let ((function
+         (byte-compile
+          (lambda (n)
+            (let ((sum 0))
+              (dotimes (i n)
+                (condition-case nil
+                    (setq sum (+ sum (catch 'core-bench
+                                       (if (zerop (% i 100))
+                                           (throw 'core-bench i)
+                                         i))))
+                  (error nil)))
+              sum)))))
+    (core-bench-measure
+      (funcall function 1000000))))
+
+(core-bench-define insert-file-contents-decode
+  "Insert and decode a large UTF-8 file."
+  (let ((file (make-temp-file "core-bench")))
+    (unwind-protect
+        (progn
+          (let ((coding-system-for-write 'utf-8-unix))
+            (with-temp-file file
+              (dotimes (_ 20)
+                (insert (core-bench--corpus 10000)
+                        "ÄÖÜ äöü αβγ 漢字 ☃\n"))))
+          (with-temp-buffer
+            (core-bench-measure
+              (erase-buffer)
+              ;; Let Emacs detect the encoding, as it does when
+              ;; visiting a file.
+              (insert-file-contents file))))
+      (delete-file file))))
+
+(core-bench-define treesit-query-capture
+  "Capture the identifiers in a large C buffer with tree-sitter."
+  (unless (and (fboundp 'treesit-available-p)
+               (treesit-available-p)
+               (treesit-language-available-p 'c))
+    (core-bench-skip "requires tree-sitter and the C grammar"))
+  (with-temp-buffer
+    (insert (core-bench--c-corpus 20000))
+    (let ((root (treesit-parser-root-node (treesit-parser-create 'c)))
+          (query (treesit-query-compile
+                  'c '((identifier) @id (number_literal) @num))))
+      (core-bench-measure
+        (treesit-query-capture root query)))))
+
+(core-bench-define process-output
+  "Read a large amount of output from a subprocess."
+  (unless (executable-find "cat")
+    (core-bench-skip "requires cat"))
+  (let ((file (make-temp-file "core-bench")))
+    (unwind-protect
+        (progn
+          (with-temp-file file
+            (dotimes (_ 10)
+              (insert (core-bench--corpus 10000))))
+          (core-bench-measure
+            (let* ((total 0)
+                   (proc (make-process
+                          :name "core-bench" :command (list "cat" file)
+                          :connection-type 'pipe :coding 'binary
+                          :noquery t
+                          :filter (lambda (_proc string)
+                                    (setq total (+ total (length string)))))))
+              (while (accept-process-output proc))
+              total)))
+      (delete-file file))))
+
+(defun core-bench--revision ()
+  "Return the repository revision of this Emacs, or nil if unknown."
+  (or (and (boundp 'emacs-repository-version) emacs-repository-version)
+      (ignore-errors
+        (emacs-repository-get-version
+         (expand-file-name ".." source-directory)))))
+
+(defun core-bench-run (&optional selector)
+  "Run the benchmarks whose name matches the regexp SELECTOR.
+Run all the benchmarks if SELECTOR is nil.  Return a list of
+results, one alist for each benchmark."
+  (let ((revision (core-bench--revision))
+        (results nil))
+    (pcase-dolist (`(,name ,_doc ,function) (reverse core-bench--benchmarks))
+      (when (or (null selector) (string-match-p selector (symbol-name name)))
+        (let* ((core-bench--result nil)
+               (skip (catch 'core-bench-skip
+                       (funcall function)
+                       nil))
+               (result
+                `((name . ,(symbol-name name))
+                  (emacs-version . ,emacs-version)
+                  (revision . ,(or revision :null))
+                  (system . ,(symbol-name system-type))
+                  (repetitions . ,core-bench-repetitions)
+                  ,@(if skip
+                        `((skipped . ,skip))
+                      (pcase-let ((`(,elapsed ,gcs ,gc-elapsed)
+                                   core-bench--result))
+                        `((elapsed . ,elapsed)
+                          (gcs . ,gcs)
+                          (gc-elapsed . ,gc-elapsed)))))))
+          (message "%-30s %s" name
+                   (if skip
+                       (format "skipped: %s" skip)
+                     (apply #'format "%.3fs (%d GCs, %.3fs in GC)"
+                            core-bench--result)))
+          (push result results))))
+    (nreverse results)))
+
+(defun core-bench-run-batch ()
+  "Run the benchmarks in batch mode and write the results as JSON lines.
+The first remaining command-line argument, if any, names the file
+to which the results are appended; the second one, if any, is the
+selector for `core-bench-run'."
+  (let* ((output (pop command-line-args-left))
+         (selector (pop command-line-args-left))
+         (lines (mapconcat (lambda (result)
+                             (concat (json-serialize result) "\n"))
+                           (core-bench-run
+                            (and selector (not (string-empty-p selector))
+                                 selector)))))
+    (if (and output (not (string-empty-p output)))
+        (write-region lines nil output t 'silent)
+      (princ lines))))
+
+(provide 'core-benchmarks)
+
+;;; core-benchmarks.el ends here
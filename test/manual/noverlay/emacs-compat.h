@@ -32,6 +32,12 @@ xmalloc (size_t size)
   return malloc (size);
 }
 
+void *
+xnmalloc (ptrdiff_t nitems, ptrdiff_t item_size)
+{
+  return malloc (nitems * item_size);
+}
+
 void
 xfree (void *ptr)
 {
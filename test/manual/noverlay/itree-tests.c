@@ -740,6 +740,62 @@ START_TEST (test_remove_10)
 }
 END_TEST
 
+
+/* +===================================================================================+
+ * | Bulk insert and remove
+ * +===================================================================================+ */
+
+START_TEST (test_insert_nodes_1)
+{
+  enum { N = 100 };
+  struct itree_node nodes[2 * N] = {0};
+  struct itree_node *ptrs[N];
+  srand (42);
+  itree_init (&tree);
+
+  /* Build an empty tree, then merge as many nodes into it.  */
+  for (int i = 0; i < 2 * N; ++i)
+    {
+      nodes[i].begin = rand () % 1000;
+      nodes[i].end = nodes[i].begin + rand () % 10;
+    }
+  for (int i = 0; i < N; ++i)
+    ptrs[i] = &nodes[i];
+  itree_insert_nodes (&tree, ptrs, N);
+  ck_assert_int_eq (tree.size, N);
+  itree_insert_gap (&tree, 500, 10, false);
+  for (int i = 0; i < N; ++i)
+    ptrs[i] = &nodes[N + i];
+  itree_insert_nodes (&tree, ptrs, N);
+  ck_assert_int_eq (tree.size, 2 * N);
+  check_tree (&tree, true);
+  for (int i = 0; i < 2 * N; ++i)
+    ck_assert (itree_contains (&tree, &nodes[i]));
+}
+END_TEST
+
+START_TEST (test_remove_nodes_1)
+{
+  enum { N = 100 };
+  struct itree_node nodes[N] = {0};
+  struct itree_node *ptrs[N];
+  itree_init (&tree);
+
+  for (int i = 0; i < N; ++i)
+    itree_insert (&tree, &nodes[i], i, i + 5);
+  itree_insert_gap (&tree, 50, 10, false);
+  for (int i = 0; i < N / 2; ++i)
+    ptrs[i] = &nodes[2 * i];
+  itree_remove_nodes (&tree, ptrs, N / 2);
+  ck_assert_int_eq (tree.size, N / 2);
+  check_tree (&tree, true);
+  for (int i = 0; i < N; ++i)
+    ck_assert (itree_contains (&tree, &nodes[i]) == (i % 2 == 1));
+  ck_assert_int_eq (itree_node_begin (&tree, &nodes[99]), 109);
+  ck_assert (nodes[0].parent == NULL);
+}
+END_TEST
+
 
 /* +===================================================================================+
  * | Generator
@@ -1227,6 +1283,11 @@ basic_suite ()
   tcase_add_test (tc, test_remove_10);
   suite_add_tcase (s, tc);
 
+  tc = tcase_create ("bulk");
+  tcase_add_test (tc, test_insert_nodes_1);
+  tcase_add_test (tc, test_remove_nodes_1);
+  suite_add_tcase (s, tc);
+
   tc = tcase_create ("generator");
   tcase_add_test (tc, test_generator_1);
   tcase_add_test (tc, test_generator_2);
@@ -460,6 +460,39 @@ perf-delete-overlay-scatter
       (benchmark-run 1
         (mapc #'delete-overlay ovls)))))
 
+(perf-define-variable-test perf-make-overlays (n)
+  (with-temp-buffer
+    (perf-insert-text n)
+    (let ((ranges (cl-loop for i from 1 to n
+                           collect (cons i (1+ i)))))
+      (benchmark-run 1
+        (make-overlays ranges)))))
+
+(perf-define-variable-test perf-make-overlays-scatter (n)
+  (with-temp-buffer
+    (perf-insert-text n)
+    (let ((ranges (cl-loop for i from 1 to n
+                           for beg = (1+ (random (point-max)))
+                           collect (cons beg (+ beg (random 70))))))
+      (benchmark-run 1
+        (make-overlays ranges)))))
+
+(perf-define-variable-test perf-delete-overlays (n)
+  (with-temp-buffer
+    (perf-insert-text n)
+    (let ((ovls (cl-loop for i from 1 to n
+                         collect (make-overlay i (1+ i)))))
+      (benchmark-run 1
+        (delete-overlays ovls)))))
+
+(perf-define-variable-test perf-delete-overlays-scatter (n)
+  (with-temp-buffer
+    (perf-insert-text n)
+    (let ((ovls (progn (perf-insert-overlays-scattered n)
+                       (overlays-in (point-min) (point-max)))))
+      (benchmark-run 1
+        (delete-overlays ovls)))))
+
 (perf-define-variable-test perf-overlays-at (n)
   (with-temp-buffer
     (perf-insert-text n)
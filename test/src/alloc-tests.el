@@ -59,4 +59,100 @@ aset-nbytes-change
       (aset s 0 c)
       (should (equal s (make-string 1 c))))))
 
+(ert-deftest alloc-tests-parallel-sweep ()
+  (let ((gc-parallel-sweep t)
+        (live (make-list 10000 1.5)))
+    (dotimes (_ 3)
+      (make-list 50000 nil)
+      (mapcar (lambda (f) (* f 2.0)) live)
+      (garbage-collect))
+    (should (= (length live) 10000))
+    (should (cl-every (lambda (f) (eql f 1.5)) live))))
+
+(ert-deftest alloc-tests-post-gc-statistics ()
+  (garbage-collect)
+  (make-list 10000 nil)
+  (garbage-collect)
+  (let ((phases (alist-get 'phases post-gc-statistics))
+        (freed (alist-get 'freed post-gc-statistics)))
+    (should (floatp (alist-get 'elapsed post-gc-statistics)))
+    (dolist (phase '(mark weak-tables sweep-strings compact-strings
+                     sweep-conses sweep-floats sweep-intervals
+                     sweep-symbols sweep-buffers sweep-vectors))
+      (should (floatp (alist-get phase phases))))
+    (should (>= (alist-get 'conses freed) 10000))))
+
+(ert-deftest alloc-tests-gc-trim-fraction ()
+  (let ((gc-trim-fraction nil))
+    (garbage-collect)
+    (should (eql (alist-get 'released post-gc-statistics) 0)))
+  (let ((gc-trim-fraction 0.1)
+        (live (make-list 1000000 nil)))
+    (garbage-collect)
+    (setq live nil)
+    (garbage-collect)
+    (should (natnump (alist-get 'released post-gc-statistics)))))
+
+(ert-deftest alloc-tests-weak-tables ()
+  (let* ((keys (mapcar #'list (number-sequence 1 100)))
+         (kept (seq-take keys 50))
+         (a (make-hash-table :test 'eq :weakness 'key))
+         (b (make-hash-table :test 'eq :weakness 'value)))
+    ;; An entry of A is kept if its key is kept; an entry of B is kept
+    ;; if its value is, which may be a key of A kept only through B.
+    (dolist (key keys)
+      (puthash key (list key) a))
+    (let ((via-b (list 'via-b)))
+      (puthash via-b 'value a)
+      (puthash 'x via-b b)
+      (setq keys nil)
+      (garbage-collect)
+      (should (eq (gethash via-b a) 'value)))
+    (dolist (key kept)
+      (should (equal (gethash key a) (list key))))
+    (should (>= (hash-table-count a) 51))
+    (let ((stats (assq 'weak-tables post-gc-statistics)))
+      (should stats)
+      (should (cl-some (lambda (s)
+                         (and (eq (nth 0 s) 'key)
+                              (= (nth 1 s) 101)
+                              (>= (nth 2 s) 101)
+                              (= (nth 3 s) (- 101 (hash-table-count a)))))
+                       (cdr stats))))))
+
+;; Allocate N conses from a function of its own, so that they have
+;; their own call site in the heap profiler.
+(defvar alloc-tests--kept nil)
+(defun alloc-tests--retain (n)
+  (setq alloc-tests--kept (make-list n 'x))
+  nil)
+
+(defun alloc-tests--live-bytes (snapshot)
+  (let ((total 0))
+    (maphash (lambda (key bytes)
+               (when (and (eq (aref key 0) 'cons)
+                          (memq 'alloc-tests--retain (append key nil)))
+                 (setq total (+ total bytes))))
+             snapshot)
+    total))
+
+(ert-deftest alloc-tests-heap-profiler ()
+  (should-not (profiler-heap-running-p))
+  (should (profiler-heap-start 1024))
+  (unwind-protect
+      (progn
+        (should (profiler-heap-running-p))
+        (should-error (profiler-heap-start))
+        (alloc-tests--retain 10000)
+        ;; The estimate is within one sampling interval of the truth.
+        (should (<= (abs (- (alloc-tests--live-bytes (profiler-heap-snapshot))
+                            (* 10000 (nth 1 (assq 'conses
+                                                  (garbage-collect))))))
+                    1024))
+        (setq alloc-tests--kept nil)
+        (should (< (alloc-tests--live-bytes (profiler-heap-snapshot))
+                   1024)))
+    (should (profiler-heap-stop)))
+  (should-not (profiler-heap-stop)))
+
 ;;; alloc-tests.el ends here
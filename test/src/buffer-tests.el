@@ -259,6 +259,27 @@ test-generate-new-buffer-name-bug27966
                             (progn (get-buffer-create "nil")
                                    (generate-new-buffer-name "nil")))))
 
+(ert-deftest test-get-buffer-after-rename-and-kill ()
+  "Check that `get-buffer' follows renamed and killed buffers."
+  (let* ((name (generate-new-buffer-name "buffer-tests"))
+         (new-name (generate-new-buffer-name "buffer-tests-renamed"))
+         (buf (get-buffer-create name)))
+    (unwind-protect
+        (progn
+          (should (eq (get-buffer name) buf))
+          (should (eq (get-buffer (propertize name 'face 'bold)) buf))
+          (with-current-buffer buf
+            (rename-buffer new-name))
+          (should-not (get-buffer name))
+          (should (eq (get-buffer new-name) buf))
+          (let ((ind (make-indirect-buffer buf name)))
+            (should (eq (get-buffer name) ind))
+            (kill-buffer buf)
+            (should-not (buffer-live-p ind))
+            (should-not (get-buffer name))
+            (should-not (get-buffer new-name))))
+      (kill-buffer buf))))
+
 (ert-deftest test-buffer-base-buffer-indirect ()
   (with-temp-buffer
     (let* ((ind-buf-name (generate-new-buffer-name "indbuf"))
@@ -1157,6 +1178,69 @@ test-delete-all-overlay-1
     (should-not (delete-all-overlays (current-buffer)))
     (should-not (delete-all-overlays))))
 
+(ert-deftest test-make-overlays ()
+  (with-temp-buffer
+    (insert (make-string 1000 ?\s))
+    (let* ((ranges (cl-loop for i from 1 to 500
+                            collect (cons (+ 2 (random 999))
+                                          (+ 2 (random 999)))))
+           (ovs (make-overlays ranges nil nil t)))
+      (should (= (length ovs) 500))
+      (cl-loop for ov across ovs
+               for (beg . end) in ranges
+               do (should (eq (overlay-buffer ov) (current-buffer)))
+               (should (= (overlay-start ov) (min beg end)))
+               (should (= (overlay-end ov) (max beg end))))
+      (should (= (length (overlays-in (point-min) (point-max))) 500))
+      ;; Add more overlays to the tree, which is no longer empty.
+      (make-overlays (vector (cons 10 20) (cons 5 2000)))
+      (should (= (length (overlays-in (point-min) (point-max))) 502))
+      (should (= (length (overlays-at 15))
+                 (+ 2 (cl-count-if (lambda (ov)
+                                     (< (1- (overlay-start ov)) 15
+                                        (overlay-end ov)))
+                                   ovs))))
+      ;; The overlays follow the text.
+      (goto-char (point-min))
+      (insert "abc")
+      (cl-loop for ov across ovs
+               for (beg . end) in ranges
+               do (should (= (overlay-start ov) (+ 3 (min beg end))))
+               (should (= (overlay-end ov) (+ 3 (max beg end))))))
+    (should-error (make-overlays '((1 . 2) 3)))
+    (should-error (make-overlays (list (cons 1 (point-marker)))
+                                 (get-buffer-create " *temp*")))))
+
+(ert-deftest test-delete-overlays ()
+  (let ((other (generate-new-buffer " *temp*")))
+    (unwind-protect
+        (with-temp-buffer
+          (insert (make-string 100 ?\s))
+          (with-current-buffer other
+            (insert (make-string 100 ?\s)))
+          (let* ((ovs (cl-loop for i from 1 to 100
+                               collect (make-overlay i (+ i 5))))
+                 (others (cl-loop for i from 1 to 10
+                                  collect (make-overlay i (1+ i) other)))
+                 (doomed (append (cl-remove-if #'cl-oddp ovs
+                                               :key #'overlay-start)
+                                 (list (car ovs) (car ovs))
+                                 others)))
+            (delete-overlay (car ovs))
+            (should-not (delete-overlays doomed))
+            (dolist (ov doomed)
+              (should-not (overlay-buffer ov)))
+            (should (equal (sort (mapcar #'overlay-start
+                                         (overlays-in (point-min)
+                                                      (point-max))))
+                           (number-sequence 3 99 2)))
+            (with-current-buffer other
+              (should-not (overlays-in (point-min) (point-max))))
+            (should-not (delete-overlays
+                         (vconcat (overlays-in (point-min) (point-max)))))
+            (should-not (overlays-in (point-min) (point-max)))))
+      (kill-buffer other))))
+
 
 ;; +==========================================================================+
 ;; | get-pos-property
@@ -25,6 +25,7 @@
 ;;; Code:
 
 (require 'ert)
+(require 'ert-x)
 (eval-when-compile (require 'cl-lib))
 
 (ert-deftest initial-environment-preserved ()
@@ -76,4 +77,25 @@ call-process-region-entire-buffer-with-delete
        (eq (call-process-region nil nil emacs :delete nil nil "--version") 0))
       (should (eq (buffer-size) 0)))))
 
+(ert-deftest call-process-decode-ascii ()
+  "Check decoding ASCII output, which can be inserted verbatim."
+  (skip-unless (executable-find "cat"))
+  (ert-with-temp-file file
+    (dolist (test '((undecided-unix "abc\ndef\n" "abc\ndef\n" undecided-unix)
+                    (undecided-unix "abc\r\ndef\n" "abc\r\ndef\n"
+                                    undecided-unix)
+                    (undecided-dos "abc\r\ndef\r\n" "abc\ndef\n"
+                                   undecided-dos)
+                    (undecided-unix "\e$B$\"\e(B\n" "あ\n"
+                                    iso-2022-7bit-unix)
+                    (utf-8-unix "abc\ndef\n" "abc\ndef\n" utf-8-unix)))
+      (pcase-let ((`(,coding ,input ,output ,used) test))
+        (let ((coding-system-for-write 'no-conversion))
+          (write-region input nil file nil 'silent))
+        (with-temp-buffer
+          (let ((coding-system-for-read coding))
+            (call-process "cat" file t))
+          (should (equal (buffer-string) output))
+          (should (eq last-coding-system-used used)))))))
+
 ;;; callproc-tests.el ends here
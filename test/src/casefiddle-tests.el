@@ -294,6 +294,64 @@ casefiddle-turkish
     ;;(should (string-equal (capitalize "indIá") "İndıa"))
     ))
 
+;; ASCII text is cased in runs; check that the runs agree with
+;; casing character by character.
+(ert-deftest casefiddle-tests-ascii-runs ()
+  (let ((text (concat "Hello, World! " (make-string 100 ?x) "-ΌΣΟΣ abcΣ ÀB "
+                      "ΣΑΣ ÉCOLE Straße")))
+    (should (equal (upcase text)
+                   (concat "HELLO, WORLD! " (make-string 100 ?X) "-ΌΣΟΣ ABCΣ ÀB "
+                           "ΣΑΣ ÉCOLE STRASSE")))
+    (should (equal (downcase text)
+                   (concat "hello, world! " (make-string 100 ?x) "-όσος abcς àb "
+                           "σας école straße")))
+    (let ((unibyte (concat "Unibyte \377 " (make-string 100 ?x))))
+      (should (equal (upcase unibyte) (concat "UNIBYTE \377 "
+                                              (make-string 100 ?X))))
+      (with-temp-buffer
+        (set-buffer-multibyte nil)
+        (insert unibyte)
+        (upcase-region (point-min) (point-max))
+        (should (equal (buffer-string) (upcase unibyte)))))
+    (with-temp-buffer
+      (insert text)
+      ;; Put the gap within an ASCII run.
+      (goto-char 30)
+      (insert "X")
+      (delete-char -1)
+      (let (changes)
+        (add-hook 'after-change-functions
+                  (lambda (beg end _len) (push (cons beg end) changes))
+                  nil t)
+        (downcase-region (point-min) (point-max))
+        (should (equal (buffer-string) (downcase text)))
+        (setq changes nil)
+        (upcase-region 4 80)
+        (should (equal changes '((4 . 80))))
+        (setq changes nil)
+        (downcase-region 1 70)
+        (should (equal changes '((4 . 70))))
+        (setq changes nil)
+        (downcase-region 1 90)
+        (should (equal changes '((70 . 80))))
+        (setq changes nil)
+        (downcase-region 1 90)
+        (should-not changes))))
+  ;; Case tables that treat ASCII specially are respected.
+  (let ((table (copy-case-table (standard-case-table))))
+    (with-temp-buffer
+      (set-case-table table)
+      (should (equal (downcase (string-to-multibyte "Info")) "info"))
+      ;; Also when they are changed in place.
+      (set-case-syntax-pair ?I ?ı table)
+      (should (equal (downcase (string-to-multibyte "Info")) "ınfo"))
+      (should (equal (downcase (string-to-multibyte (make-string 100 ?I)))
+                     (make-string 100 ?ı)))
+      (insert (make-string 100 ?I))
+      (downcase-region (point-min) (point-max))
+      (should (equal (buffer-string) (make-string 100 ?ı))))
+    (should (equal (downcase (make-string 100 ?I)) (make-string 100 ?i)))))
+
 (defun casefiddle-tests--check-syms (init with-words with-symbols)
   (let ((case-symbols-as-words nil))
     (should (string-equal (upcase-initials init) with-words)))
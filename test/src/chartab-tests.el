@@ -69,5 +69,34 @@ chartab-test-char-table-extra-slot
     (set-char-table-extra-slot tbl 1 'bar)
     (should (eq (char-table-extra-slot tbl 1) 'bar))))
 
+;; Char-tables that are read often get a flat copy of their values;
+;; the copy must follow changes to the table and its parents.
+(ert-deftest chartab-test-flat-copy ()
+  (let* ((parent (make-char-table 'test 'p))
+         (tbl (make-char-table 'test))
+         (read-all (lambda ()
+                     (dotimes (i 5000)
+                       (aref tbl (+ #x100 (% (* i 7) #xfe00)))))))
+    (set-char-table-parent tbl parent)
+    (set-char-table-range tbl '(#x400 . #x4ff) 'cyrillic)
+    (funcall read-all)
+    (should (eq (aref tbl #x410) 'cyrillic))
+    (should (eq (aref tbl #x3b1) 'p))
+    (aset parent #x3b1 'alpha)
+    (should (eq (aref tbl #x3b1) 'alpha))
+    (funcall read-all)
+    (set-char-table-range parent '(#x3000 . #x30ff) 'cjk)
+    (should (eq (aref tbl #x3042) 'cjk))
+    (funcall read-all)
+    (aset tbl #x410 'a)
+    (should (eq (aref tbl #x410) 'a))
+    (funcall read-all)
+    (set-char-table-parent tbl nil)
+    (should-not (aref tbl #x3b1))
+    (funcall read-all)
+    (fillarray tbl 'all)
+    (should (eq (aref tbl #x410) 'all))
+    (should (eq (aref tbl #x10000) 'all))))
+
 (provide 'chartab-tests)
 ;;; chartab-tests.el ends here
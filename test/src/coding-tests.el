@@ -23,6 +23,7 @@
 ;;; Code:
 
 (require 'ert)
+(require 'ert-x)
 
 ;; Directory to hold test data files.
 (defvar coding-tests-workdir
@@ -430,5 +431,59 @@ coding-check-coding-systems-region
                  '((iso-latin-1 3) (us-ascii 1 3))))
   (should-error (check-coding-systems-region "å" nil '(bad-coding-system))))
 
+;; Long runs of ASCII are decoded and checked many bytes at a time;
+;; make sure what surrounds them is still handled byte by byte.
+(ert-deftest coding-utf-8-ascii-runs ()
+  (let ((run (make-string 100 ?a)))
+    (dolist (prefix (list "" "x" (make-string 31 ?x) (make-string 33 ?x)))
+      (let ((s (encode-coding-string (concat prefix run "é" run "\n") 'utf-8)))
+        (should (equal (decode-coding-string s 'utf-8)
+                       (concat prefix run "é" run "\n")))
+        (should (equal (decode-coding-string s 'undecided)
+                       (concat prefix run "é" run "\n")))
+        (should (eq (coding-system-eol-type last-coding-system-used) 0)))
+      ;; A CR LF before other LFs in the same block of bytes.
+      (let ((s (concat prefix "\r\n" run)))
+        (decode-coding-string s 'utf-8)
+        (should (eq (coding-system-eol-type last-coding-system-used) 1))
+        (should (equal (decode-coding-string s 'utf-8-dos)
+                       (concat prefix "\n" run))))
+      ;; Invalid and truncated sequences after a run.
+      (let ((s (concat (string-to-unibyte (concat prefix run)) "\377\303")))
+        (should (equal (decode-coding-string s 'utf-8-unix)
+                       (concat prefix run (string #x3fffff #x3fffc3))))
+        (should (equal (string-as-multibyte s)
+                       (concat prefix run (string #x3fffff #x3fffc3))))
+        (ert-with-temp-file file
+          (let ((coding-system-for-write 'no-conversion))
+            (write-region s nil file))
+          (with-temp-buffer
+            (let ((coding-system-for-read 'utf-8-unix))
+              (insert-file-contents file))
+            (should (equal (buffer-string)
+                           (concat prefix run
+                                   (string #x3fffff #x3fffc3))))))))))
+
+;; Text that is checked in several chunks must decode as if it were
+;; checked in one, whatever lies at the boundaries of the chunks.
+(ert-deftest coding-parallel-decoding ()
+  (let* ((line (concat (make-string 1000 ?a) "\r\n"))
+         (text (apply #'concat (make-list 3000 line))))
+    (dotimes (i 8)
+      (aset text (+ (* i (/ (length text) 8)) (% i 3)) ?é))
+    (ert-with-temp-file file
+      (let ((coding-system-for-write 'utf-8-unix))
+        (write-region text nil file))
+      (dolist (coding '(utf-8 utf-8-unix utf-8-dos undecided))
+        (let (results)
+          (dolist (threshold '(nil 1000000))
+            (with-temp-buffer
+              (let ((coding-system-for-read coding)
+                    (coding-parallel-decoding-threshold threshold))
+                (insert-file-contents file))
+              (push (list (buffer-string) buffer-file-coding-system)
+                    results)))
+          (should (equal (car results) (cadr results))))))))
+
 (provide 'coding-tests)
 ;;; coding-tests.el ends here
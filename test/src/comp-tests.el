@@ -1603,4 +1603,28 @@ comp-tests-type-branch-optim
           t)
     (native-compile #'comp-tests-type-branch-optim-1-f)))
 
+(defvar native-comp-shared-eln-directory)
+
+(comp-deftest el-to-eln-shared-filename ()
+  "Test that shared .eln names depend only on the source base name and contents."
+  (let ((file1 (expand-file-name "a/foo.el" dir))
+        (file2 (expand-file-name "b/foo.el" dir))
+        (native-comp-shared-eln-directory (expand-file-name "shared/" dir)))
+    (dolist (file (list file1 file2))
+      (make-directory (file-name-directory file))
+      (with-temp-file file
+        (insert "(defun foo ())\n")))
+    (should (equal (comp-el-to-eln-shared-filename file1)
+                   (comp-el-to-eln-shared-filename file2)))
+    (should (string-prefix-p (expand-file-name
+                              comp-native-version-dir
+                              native-comp-shared-eln-directory)
+                             (comp-el-to-eln-shared-filename file1)))
+    (with-temp-file file2
+      (insert "(defun foo () 1)\n"))
+    (should-not (equal (comp-el-to-eln-shared-filename file1)
+                       (comp-el-to-eln-shared-filename file2)))
+    (let ((native-comp-shared-eln-directory nil))
+      (should-not (comp-el-to-eln-shared-filename file1)))))
+
 ;;; comp-tests.el ends here
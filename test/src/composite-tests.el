@@ -0,0 +1,68 @@
+;;; composite-tests.el --- tests for src/composite.c  -*- lexical-binding: t -*-
+
+;; Copyright (C) 2025 Free Software Foundation, Inc.
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <https://www.gnu.org/licenses/>.
+
+;;; Code:
+
+(require 'ert)
+
+(ert-deftest composite-tests-cache-statistics ()
+  "Check that `composition-cache-statistics' accounts for compositions."
+  (let ((stats (composition-cache-statistics)))
+    (dolist (key '(entries bytes hits misses evictions))
+      (should (natnump (alist-get key stats)))))
+  (with-temp-buffer
+    (switch-to-buffer (current-buffer))
+    ;; Hangul jamo sequences are composed on text terminals as well.
+    (dotimes (i 20)
+      (insert (string (+ #x1100 i) (+ #x1161 i) ?\s)))
+    (let ((before (composition-cache-statistics)))
+      (window-text-pixel-size nil (point-min) (point-max))
+      (let ((after (composition-cache-statistics)))
+        (should (> (alist-get 'entries after) (alist-get 'entries before)))
+        (should (> (alist-get 'bytes after) (alist-get 'bytes before)))
+        (should (> (alist-get 'misses after) (alist-get 'misses before)))
+        ;; Laying out the same text again finds it in the cache.
+        (window-text-pixel-size nil (point-min) (point-max))
+        (should (> (alist-get 'hits (composition-cache-statistics))
+                   (alist-get 'hits after)))))))
+
+(ert-deftest composite-tests-composition-cache ()
+  "Check that text known to have no compositions is rechecked as needed."
+  (with-temp-buffer
+    (switch-to-buffer (current-buffer))
+    (dotimes (_ 20)
+      (insert (make-string 200 ?a) "\n"))
+    ;; Laying out the text tells the composition cache that it has no
+    ;; characters with composition rules.
+    (window-text-pixel-size nil (point-min) (point-max))
+    (should-not (find-composition 1000 nil nil t))
+    ;; Buffer changes invalidate the cache.
+    (goto-char 1000)
+    (insert #x1100 #x1161)
+    (should (equal (take 2 (find-composition 1000 nil nil t)) '(1000 1002)))
+    ;; So do changes to `composition-function-table'.
+    (setq-local composition-function-table
+                (copy-sequence composition-function-table))
+    (window-text-pixel-size nil (point-min) (point-max))
+    (should-not (find-composition 2000 nil nil t))
+    (set-char-table-range composition-function-table ?a
+                          (list (vector "aa" 0 #'font-shape-gstring)))
+    (should (equal (take 2 (find-composition 2000 nil nil t)) '(2000 2002)))))
+
+;;; composite-tests.el ends here
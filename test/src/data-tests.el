@@ -396,6 +396,55 @@ data-tests--let-buffer-local-no-unwind-other-buffers
             (should (equal (default-value var) def)))
           )))))
 
+(ert-deftest data-tests--set-buffer-forwarded-local ()
+  "Test that switching buffers loads forwarded buffer-local values."
+  (let ((bufs (list (generate-new-buffer "a") (generate-new-buffer "b")
+                    (generate-new-buffer "c"))))
+    (unwind-protect
+        (progn
+          (with-current-buffer (nth 0 bufs)
+            (setq-local indent-tabs-mode nil))
+          (with-current-buffer (nth 1 bufs)
+            (setq-local indent-tabs-mode t))
+          (let ((indent-tabs-mode t))
+            (dolist (order '((0 1 2) (2 1 0) (1 0 2) (0 2 1) (2 0 1)))
+              (dolist (i order)
+                (set-buffer (nth i bufs))
+                (should (eq indent-tabs-mode (/= i 0)))
+                ;; Check that C code sees the same value.
+                (erase-buffer)
+                (indent-to tab-width)
+                (should (equal (buffer-string)
+                               (if (= i 0)
+                                   (make-string tab-width ?\s)
+                                 "\t")))))))
+      (mapc #'kill-buffer bufs))))
+
+(defvar-local data-tests--local-var 'default)
+(defalias 'data-tests--alias #'data-tests--bump)
+
+(ert-deftest data-tests--compiled-buffer-local ()
+  "Test compiled references to buffer-local variables and via aliases."
+  (defalias 'data-tests--bump
+    (byte-compile
+     (lambda () (setq data-tests--local-var (list data-tests--local-var)))))
+  (should (byte-code-function-p (symbol-function 'data-tests--bump)))
+  (let ((other (generate-new-buffer "other")))
+    (unwind-protect
+        (with-temp-buffer
+          (should-not (local-variable-p 'data-tests--local-var))
+          (should (equal (data-tests--alias) '(default)))
+          (should (local-variable-p 'data-tests--local-var))
+          (should (equal (data-tests--alias) '((default))))
+          (with-current-buffer other
+            (should (equal (data-tests--alias) '(default))))
+          (should (equal data-tests--local-var '((default))))
+          (should (eq (default-value 'data-tests--local-var) 'default))
+          (let ((data-tests--local-var 'let))
+            (should (equal (data-tests--alias) '(let))))
+          (should (equal data-tests--local-var '((default)))))
+      (kill-buffer other))))
+
 (ert-deftest binding-test-makunbound ()
   "Tests of makunbound, from the manual."
   (with-current-buffer binding-test-buffer-B
@@ -649,6 +698,27 @@ data-tests-bignum
     (should (/= b0 0.0e+NaN))
     (should (/= b-1 0.0e+NaN))))
 
+;; Arithmetic on bignums that fit in two words avoids GMP, so check
+;; it against the same computations offset into GMP territory.
+(ert-deftest data-tests-small-bignum ()
+  (let ((big (ash 1 200))
+        (values (list 0 1 -1 7 most-positive-fixnum most-negative-fixnum
+                      (ash 1 62) (1- (ash 1 63)) (- (ash 1 63)) (ash 1 64)
+                      12345678901234567890123 -98765432109876543210
+                      (1- (ash 1 126)) (- (ash 1 126)) (1- (ash 1 127))
+                      (- (ash 1 127)) (ash 1 127) (ash 1 128))))
+    (dolist (a values)
+      (should (= (+ a 0.5) (+ (float a) 0.5)))
+      (dolist (b values)
+        (should (= (+ a b) (- (+ a big b) big)))
+        (should (= (- a b) (- (+ a big) b big)))
+        (should (= (* a b) (/ (* a big b) big)))
+        (unless (zerop b)
+          (should (= (/ a b) (/ (* a big) (* b big)))))
+        (should (= (logxor (logxor a b) b) a))
+        (should (= (logior a b) (+ (logxor a b) (logand a b))))
+        (should (= (+ a b 1 2) (+ (+ a b) 3)))))))
+
 (ert-deftest data-tests-+ ()
   (should-not (fixnump (+ most-positive-fixnum most-positive-fixnum)))
   (should (> (+ most-positive-fixnum most-positive-fixnum) most-positive-fixnum))
@@ -42,6 +42,31 @@ zlib--decompress
              (buffer-string))
            "foo\n")))
 
+;; Concatenated gzip files decompress to the concatenation of their
+;; contents, but other data after the end is ignored.
+(ert-deftest zlib--decompress-members ()
+  (skip-unless (and (fboundp 'zlib-available-p)
+                    (zlib-available-p)))
+  (let ((gz (with-temp-buffer
+              (set-buffer-multibyte nil)
+              (insert-file-contents-literally
+               (expand-file-name "foo.gz" zlib-tests-data-directory))
+              (buffer-string))))
+    (dolist (test `((,(concat gz gz gz) "foo\nfoo\nfoo\n")
+                    (,(concat gz "garbage") "foo\n")
+                    (,(concat gz "\x1f") "foo\n")))
+      (with-temp-buffer
+        (set-buffer-multibyte nil)
+        (insert (car test))
+        (should (eq (zlib-decompress-region (point-min) (point-max)) t))
+        (should (equal (buffer-string) (cadr test)))))
+    ;; A truncated second member is an error.
+    (with-temp-buffer
+      (set-buffer-multibyte nil)
+      (insert gz (substring gz 0 -4))
+      (should-not (zlib-decompress-region (point-min) (point-max)))
+      (should (equal (buffer-string) (concat gz (substring gz 0 -4)))))))
+
 (provide 'decompress-tests)
 
 ;;; decompress-tests.el ends here
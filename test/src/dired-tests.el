@@ -0,0 +1,98 @@
+;;; dired-tests.el --- unit tests for src/dired.c  -*- lexical-binding: t; -*-
+
+;; Copyright 2025 Free Software Foundation, Inc.
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <https://www.gnu.org/licenses/>.
+
+;;; Code:
+
+(require 'ert)
+(require 'ert-x)
+
+(defun dired-tests--make-tree (dir files)
+  "Create the FILES, with their contents, under DIR.
+FILES is a list of (NAME . CONTENTS)."
+  (pcase-dolist (`(,name . ,contents) files)
+    (let ((file (expand-file-name name dir)))
+      (make-directory (file-name-directory file) t)
+      (write-region (or contents "") nil file nil 'silent))))
+
+(ert-deftest dired-tests-directory-files-tree ()
+  (ert-with-temp-directory dir
+    (dired-tests--make-tree
+     dir '(("a.c") ("a.o") ("README") ("sub/b.c") ("sub/b.o")
+           ("sub/deep/c.c") ("build/out.c") ("doc/build/x.texi")))
+    (should (equal (directory-files-tree dir)
+                   ["README" "a.c" "a.o" "build/out.c" "doc/build/x.texi"
+                    "sub/b.c" "sub/b.o" "sub/deep/c.c"]))
+    ;; Unanchored patterns match at any depth, anchored ones only
+    ;; relative to DIR.
+    (should (equal (directory-files-tree dir '("*.o" "/build/"))
+                   ["README" "a.c" "doc/build/x.texi" "sub/b.c"
+                    "sub/deep/c.c"]))
+    (should (equal (directory-files-tree dir '("build"))
+                   ["README" "a.c" "a.o" "sub/b.c" "sub/b.o"
+                    "sub/deep/c.c"]))
+    (should (equal (directory-files-tree dir '("sub/**/*.c" "*.o" "!b.o"))
+                   ["README" "a.c" "build/out.c" "doc/build/x.texi"
+                    "sub/b.o"]))
+    (should (equal (directory-files-tree dir '("[ab].?" "doc/"))
+                   ["README" "build/out.c" "sub/deep/c.c"]))
+    (should-error (directory-files-tree (expand-file-name "missing" dir))
+                  :type 'file-missing)))
+
+(ert-deftest dired-tests-directory-files-tree-gitignore ()
+  (ert-with-temp-directory dir
+    (dired-tests--make-tree
+     dir '((".gitignore" . "# Comment\n*.o\n/build/\n")
+           (".git/info/exclude" . "*.tmp\n")
+           (".git/config") ("a.c") ("a.o") ("a.tmp") ("build/out.c")
+           ("sub/.gitignore" . "!keep.o\nlocal.c\n")
+           ("sub/keep.o") ("sub/drop.o") ("sub/local.c") ("sub/b.c")))
+    (should (equal (directory-files-tree dir nil t)
+                   [".gitignore" "a.c" "sub/.gitignore" "sub/b.c"
+                    "sub/keep.o"]))
+    ;; The .gitignore files take precedence over IGNORES.
+    (should (equal (directory-files-tree dir '("*.c" "!a.o") t)
+                   [".gitignore" "sub/.gitignore" "sub/keep.o"]))))
+
+(ert-deftest dired-tests-directory-files-tree-cache ()
+  (ert-with-temp-directory dir
+    (dired-tests--make-tree dir '((".gitignore" . "*.o\n") ("a.c")
+                                  ("sub/b.c")))
+    (should (equal (directory-files-tree dir nil t t)
+                   [".gitignore" "a.c" "sub/b.c"]))
+    ;; The result is a fresh copy.
+    (aset (directory-files-tree dir nil t t) 0 "x")
+    (should (equal (directory-files-tree dir nil t t)
+                   [".gitignore" "a.c" "sub/b.c"]))
+    ;; The cache notices new files, and changes to ignore files.  Set
+    ;; modification times explicitly, in case the file system's
+    ;; timestamps are coarse.
+    (let ((time 1000000000))
+      (dolist (change (list (lambda ()
+                              (write-region "" nil (expand-file-name
+                                                    "sub/c.o" dir))
+                              (expand-file-name "sub" dir))
+                            (lambda ()
+                              (write-region "" nil (expand-file-name
+                                                    ".gitignore" dir))
+                              (expand-file-name ".gitignore" dir))))
+        (set-file-times (funcall change) (setq time (1+ time)))))
+    (should (equal (directory-files-tree dir nil t t)
+                   [".gitignore" "a.c" "sub/b.c" "sub/c.o"]))))
+
+;;; dired-tests.el ends here
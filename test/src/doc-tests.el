@@ -20,6 +20,7 @@
 ;;; Code:
 
 (require 'ert)
+(require 'ert-x)
 
 (ert-deftest doc-tests-documentation/c-primitive ()
   (should (stringp (documentation 'defalias))))
@@ -37,6 +38,27 @@ doc-tests-documentation/autoloaded-defun
   (should (autoloadp (symbol-function 'tetris)))
   (should (stringp (documentation 'tetris)))) ; See Bug#52969.
 
+(ert-deftest doc-tests-documentation/byte-compiled ()
+  "Test doc strings of byte-compiled files before and after reloading."
+  (ert-with-temp-file file
+    :suffix ".el"
+    (let ((elc (concat file "c")))
+      (unwind-protect
+          (dolist (doc '("First version." "Second version."))
+            (with-temp-file file
+              (insert ";;; -*- lexical-binding: t -*-\n"
+                      (format "(defun doc-tests--fun () %S nil)\n" doc)))
+            (let ((byte-compile-dynamic-docstrings t))
+              (byte-compile-file file))
+            (load elc nil t)
+            (should (consp (aref (symbol-function 'doc-tests--fun) 4)))
+            (should (equal (documentation 'doc-tests--fun t) doc))
+            ;; Interleave a doc string from the DOC file.
+            (should (stringp (documentation 'car t)))
+            (should (equal (documentation 'doc-tests--fun t) doc)))
+        (fmakunbound 'doc-tests--fun)
+        (delete-file elc)))))
+
 (ert-deftest doc-tests-quoting-style ()
   (should (memq (text-quoting-style) '(grave straight curve))))
 
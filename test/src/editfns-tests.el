@@ -278,6 +278,40 @@ format-with-field
                  '(error "Invalid format operation %$")))
   (should (equal (format "%1$c %1$s" ?±) "± 177")))
 
+(ert-deftest format-simple ()
+  (let ((s "abc"))
+    (should (eq (format "%s" s) s))
+    (should (eq (format s) s)))
+  (should (equal (format "%s:%d %s%%" "abc" -12 'foo) "abc:-12 foo%"))
+  (should (equal (format "%d" most-negative-fixnum)
+                 (number-to-string most-negative-fixnum)))
+  (should (multibyte-string-p (format "%s" (string-to-multibyte "a"))))
+  (should-not (multibyte-string-p (format "x%sy" "a")))
+  (should (multibyte-string-p
+           (format "x%s" (intern (string-to-multibyte "a")))))
+  (should (equal (format "\300%s" "é") (string #x3fffc0 ?é)))
+  (should (equal (format "%s" (string-to-unibyte "\300")) "\300"))
+  (should (equal (format "%s\300" (string-to-multibyte "a"))
+                 (string ?a #x3fffc0)))
+  (should (equal (should-error (format "%s:%d" "a"))
+                 '(error "Not enough arguments for format string"))))
+
+(ert-deftest insert-format ()
+  (with-temp-buffer
+    (let ((marker (point-marker)))
+      (insert-format "%s:%d\n" "é" 42)
+      (insert-format "%S %5s|" '(a "b") "c")
+      (insert-format "%s" (propertize "d" 'face 'bold))
+      (insert-format "")
+      (should (equal (buffer-string) "é:42\n(a \"b\")     c|d"))
+      (should (eq (get-text-property 20 'face) 'bold))
+      (should (= (point) (point-max)))
+      (should (= marker (point-min)))))
+  (with-temp-buffer
+    (set-buffer-multibyte nil)
+    (insert-format "%s:%s:%d" (string-to-multibyte "ab") "é" 1)
+    (should (equal (buffer-string) "ab:\351:1"))))
+
 (ert-deftest replace-buffer-contents-1 ()
   (with-temp-buffer
     (insert #("source " 2 4 (prop 7)))
@@ -322,6 +356,29 @@ replace-buffer-contents-bug31837
   (should (equal (buffer-substring-no-properties (point-min) (point-max))
                  (concat (string (char-from-name "SMILE")) "1234"))))
 
+(ert-deftest replace-buffer-contents-many-lines ()
+  "Test replacing a buffer that differs from the source in many lines."
+  (let ((source (generate-new-buffer " *source*")))
+    (unwind-protect
+        (with-temp-buffer
+          (dotimes (i 5000)
+            (insert (format "  x%d = f (%d, \"é\");\n" i i))
+            (with-current-buffer source
+              (insert (if (zerop (% i 2))
+                          (format "    x%d = f(%d, \"é\");\n" i i)
+                        (format "  x%d = f (%d, \"é\");\n" i i)))))
+          (let ((marker (save-excursion
+                          (goto-char (point-max))
+                          (forward-line -1)
+                          (copy-marker (search-forward "=")))))
+            (should (replace-buffer-contents source 10))
+            (should (equal (buffer-string)
+                           (with-current-buffer source (buffer-string))))
+            (goto-char marker)
+            (should (equal (buffer-substring (pos-bol) marker)
+                           "  x4999 ="))))
+      (kill-buffer source))))
+
 (defun editfns--replace-region (from to string)
   (save-excursion
     (save-restriction
@@ -586,6 +643,33 @@ editfns-tests--before/after-change-functions
                             'utf-8 nil (current-buffer))
       (should (null (sanity-check-change-functions-errors))))))
 
+(ert-deftest editfns-tests-combined-change ()
+  "Test that multi-part changes run the change hooks once."
+  (with-temp-buffer
+    (let ((calls nil))
+      (add-hook 'before-change-functions
+                (lambda (beg end) (push (list 'before beg end) calls))
+                nil t)
+      (add-hook 'after-change-functions
+                (lambda (beg end len) (push (list 'after beg end len) calls))
+                nil t)
+      (insert "abcabc")
+      (setq calls nil)
+      (let ((tt (make-char-table 'translation-table)))
+        (aset tt ?a ?x)
+        (aset tt ?c [?y ?z])
+        (should (= (translate-region-internal 1 7 tt) 6)))
+      (should (equal (buffer-string) "xbyzxbyz"))
+      (should (equal (nreverse calls) '((before 1 7) (after 1 9 6))))
+      (upcase-region 1 3)
+      (setq calls nil)
+      (goto-char (point-min))
+      (let ((case-fold-search t))
+        (re-search-forward "XB")
+        (replace-match "foo"))
+      (should (equal (buffer-string) "FOOyzxbyz"))
+      (should (equal (nreverse calls) '((before 1 3) (after 1 4 2)))))))
+
 (ert-deftest editfns-tests-styled-print ()
   "Test bug#75754."
    (let* ((print-unreadable-function
@@ -696,6 +696,78 @@ Fmod_test_async_pipe (emacs_env *env, ptrdiff_t nargs, emacs_value *args,
   return env->intern (env, "nil");
 }
 
+/* The post_callback function of the environment, saved for use by
+   post_from_thread.  */
+static bool (*post_callback) (emacs_env *,
+                              void (*) (emacs_env *, void *), void *);
+
+/* Call mod-test-posted with the integer DATA points to.  */
+static void
+call_posted (emacs_env *env, void *data)
+{
+  int *n = data;
+  emacs_value arg = env->make_integer (env, *n);
+  free (n);
+  env->funcall (env, env->intern (env, "mod-test-posted"), 1, &arg);
+}
+
+#ifdef WINDOWSNT
+static void ALIGN_STACK
+#else
+static void *
+#endif
+post_from_thread (void *arg)
+{
+  /* Post the numbers 0 to *ARG - 1, with no environment active.  */
+  int count = *(int *) arg;
+  free (arg);
+  sleep_for_half_second ();
+  for (int i = 0; i < count; i++)
+    {
+      int *n = malloc (sizeof *n);
+      if (n == NULL)
+        break;
+      *n = i;
+      if (!post_callback (NULL, call_posted, n))
+        {
+          perror ("post_callback");
+          free (n);
+        }
+    }
+#ifndef WINDOWSNT
+  return NULL;
+#endif
+}
+
+static emacs_value
+Fmod_test_post_from_thread (emacs_env *env, ptrdiff_t nargs,
+                            emacs_value *args, void *data)
+{
+  assert (nargs == 1);
+  int *count = malloc (sizeof *count);
+  if (count == NULL)
+    {
+      memory_full (env);
+      return NULL;
+    }
+  *count = env->extract_integer (env, args[0]);
+  post_callback = env->post_callback;
+#ifdef WINDOWSNT
+  uintptr_t thd = _beginthread (post_from_thread, 0, count);
+  int error = (thd == (uintptr_t)-1L) ? errno : 0;
+#else  /* !WINDOWSNT */
+  pthread_t thread;
+  int error = pthread_create (&thread, NULL, post_from_thread, count);
+#endif
+  if (error != 0)
+    {
+      signal_system_error (env, error, "thread create");
+      free (count);
+      return NULL;
+    }
+  return env->intern (env, "nil");
+}
+
 static emacs_value
 Fmod_test_identity (emacs_env *env, ptrdiff_t nargs, emacs_value *args,
                     void *data)
@@ -740,6 +812,121 @@ Fmod_test_make_string (emacs_env *env, ptrdiff_t nargs,
   return ret;
 }
 
+/* Return a list of the two parts of the text of buffer ARGS[0]
+   between positions ARGS[1] and ARGS[2], as unibyte strings.  */
+static emacs_value
+Fmod_test_buffer_text (emacs_env *env, ptrdiff_t nargs,
+                       emacs_value *args, void *data)
+{
+  assert (nargs == 3);
+  intmax_t start = env->extract_integer (env, args[1]);
+  intmax_t end = env->extract_integer (env, args[2]);
+  const char *text1, *text2;
+  ptrdiff_t size1, size2;
+  if (!env->buffer_text (env, args[0], start, end,
+                         &text1, &size1, &text2, &size2))
+    return args[0];
+  /* Copy the text before calling another environment function.  */
+  char *buffer = malloc (size1 + size2 + 1);
+  if (buffer == NULL)
+    {
+      memory_full (env);
+      return args[0];
+    }
+  memcpy (buffer, text1, size1);
+  memcpy (buffer + size1, text2, size2);
+  emacs_value parts[]
+    = { env->make_unibyte_string (env, buffer, size1),
+        env->make_unibyte_string (env, buffer + size1, size2) };
+  free (buffer);
+  return env->funcall (env, env->intern (env, "list"), 2, parts);
+}
+
+/* Insert the strings ARGS in the current buffer with one call of
+   insert_text.  */
+static emacs_value
+Fmod_test_insert_text (emacs_env *env, ptrdiff_t nargs,
+                       emacs_value *args, void *data)
+{
+  char **texts = calloc (nargs + 1, sizeof *texts);
+  ptrdiff_t *sizes = calloc (nargs + 1, sizeof *sizes);
+  emacs_value result = env->intern (env, "nil");
+  if (texts == NULL || sizes == NULL)
+    {
+      memory_full (env);
+      goto done;
+    }
+  for (ptrdiff_t i = 0; i < nargs; i++)
+    {
+      ptrdiff_t size = 0;
+      if (!env->copy_string_contents (env, args[i], NULL, &size))
+        goto done;
+      texts[i] = malloc (size);
+      if (texts[i] == NULL)
+        {
+          memory_full (env);
+          goto done;
+        }
+      if (!env->copy_string_contents (env, args[i], texts[i], &size))
+        goto done;
+      /* Don't count the terminating null byte.  */
+      sizes[i] = size - 1;
+    }
+  if (env->insert_text (env, nargs, (const char *const *) texts, sizes))
+    result = env->intern (env, "t");
+ done:
+  if (texts != NULL)
+    for (ptrdiff_t i = 0; i < nargs; i++)
+      free (texts[i]);
+  free (texts);
+  free (sizes);
+  return result;
+}
+
+/* Return a list of a vector of the integers 0 to ARGS[0] - 1, a
+   vector of their halves, and a list of their decimal
+   representations, each made with a single bulk constructor.  */
+static emacs_value
+Fmod_test_make_bulk (emacs_env *env, ptrdiff_t nargs,
+                     emacs_value *args, void *data)
+{
+  assert (nargs == 1);
+  intmax_t count = env->extract_integer (env, args[0]);
+  if (env->non_local_exit_check (env) != emacs_funcall_exit_return)
+    return args[0];
+  if (count < 0)
+    return env->make_integer_vector (env, count, NULL);
+  intmax_t *integers = calloc (count + 1, sizeof *integers);
+  double *floats = calloc (count + 1, sizeof *floats);
+  ptrdiff_t *sizes = calloc (count + 1, sizeof *sizes);
+  char *text = malloc (count * 24 + 1);
+  emacs_value result = args[0];
+  if (integers == NULL || floats == NULL || sizes == NULL || text == NULL)
+    {
+      memory_full (env);
+      goto done;
+    }
+  char *p = text;
+  for (intmax_t i = 0; i < count; i++)
+    {
+      integers[i] = i;
+      floats[i] = i / 2.0;
+      sizes[i] = sprintf (p, "%jd", i);
+      p += sizes[i];
+    }
+  emacs_value parts[]
+    = { env->make_integer_vector (env, count, integers),
+        env->make_float_vector (env, count, floats),
+        env->make_string_list (env, text, count, sizes) };
+  result = env->funcall (env, env->intern (env, "list"), 3, parts);
+ done:
+  free (integers);
+  free (floats);
+  free (sizes);
+  free (text);
+  return result;
+}
+
 /* Lisp utilities for easier readability (simple wrappers).  */
 
 /* Provide FEATURE to Emacs.  */
@@ -841,6 +1028,12 @@ #define DEFUN(lsym, csym, amin, amax, doc, data) \
   DEFUN ("mod-test-funcall", Fmod_test_funcall, 1, emacs_variadic_function,
          NULL, NULL);
   DEFUN ("mod-test-make-string", Fmod_test_make_string, 2, 2, NULL, NULL);
+  DEFUN ("mod-test-buffer-text", Fmod_test_buffer_text, 3, 3, NULL, NULL);
+  DEFUN ("mod-test-insert-text", Fmod_test_insert_text, 0,
+         emacs_variadic_function, NULL, NULL);
+  DEFUN ("mod-test-make-bulk", Fmod_test_make_bulk, 1, 1, NULL, NULL);
+  DEFUN ("mod-test-post-from-thread", Fmod_test_post_from_thread, 1, 1,
+         NULL, NULL);
 
 #undef DEFUN
 
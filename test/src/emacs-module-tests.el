@@ -471,6 +471,26 @@ module/async-pipe
             (should (equal (buffer-string) "data from thread")))
         (delete-process process)))))
 
+(defvar mod-test--posted nil
+  "Numbers passed to `mod-test-posted', most recent first.")
+
+(defun mod-test-posted (n)
+  (push n mod-test--posted))
+
+(ert-deftest module/post-callback ()
+  "Check that a thread can post callbacks to the event loop."
+  (skip-when (eq system-type 'windows-nt))
+  (setq mod-test--posted nil)
+  (mod-test-post-from-thread 3)
+  (with-timeout (10 (ert-fail "Timed out waiting for posted callbacks"))
+    (while (< (length mod-test--posted) 3)
+      (read-event nil nil 0.1)))
+  (should (equal mod-test--posted '(2 1 0)))
+  ;; Forged events are rejected.
+  (should-error (module-handle-event '(module-event "data")))
+  (should-error (module-handle-event
+                 (list 'module-event (mod-test-userptr-make 42)))))
+
 (ert-deftest module/interactive/return-t ()
   (should (functionp (symbol-function #'mod-test-return-t)))
   (should (module-function-p (symbol-function #'mod-test-return-t)))
@@ -578,4 +598,49 @@ mod-test-make-string/nonempty
         (should (string-equal first second))
         (should-not (eq first second))))))
 
+(ert-deftest mod-test-buffer-text ()
+  (with-temp-buffer
+    (insert "abc\u00e9def")
+    (goto-char 3)
+    ;; Move the gap to position 3.
+    (insert "x")
+    (delete-char -1)
+    (should (equal (mod-test-buffer-text (current-buffer) 1 8)
+                   (list "ab" (encode-coding-string "c\u00e9def" 'utf-8))))
+    (should (equal (mod-test-buffer-text (current-buffer) 4 6)
+                   (list "" (encode-coding-string "\u00e9d" 'utf-8))))
+    (should (equal (mod-test-buffer-text (current-buffer) 2 2) '("" "")))
+    (narrow-to-region 2 4)
+    (should-error (mod-test-buffer-text (current-buffer) 1 3)
+                  :type 'args-out-of-range)
+    (should-error (mod-test-buffer-text "abc" 1 1)
+                  :type 'wrong-type-argument)))
+
+(ert-deftest mod-test-insert-text ()
+  (with-temp-buffer
+    (let ((changes 0))
+      (add-hook 'after-change-functions (lambda (&rest _) (cl-incf changes))
+                nil t)
+      (insert "<>")
+      (goto-char 2)
+      (setq changes 0)
+      (should (eq (mod-test-insert-text "a" "\u00e9" "" "z") t))
+      (should (equal (buffer-string) "<a\u00e9z>"))
+      (should (= (point) 5))
+      (should (= changes 1))
+      (should (eq (mod-test-insert-text) t))
+      (should (= changes 1)))))
+
+(ert-deftest mod-test-make-bulk ()
+  (should (equal (mod-test-make-bulk 0) '([] [] nil)))
+  (should (equal (mod-test-make-bulk 4)
+                 '([0 1 2 3] [0.0 0.5 1.0 1.5] ("0" "1" "2" "3"))))
+  (let ((result (mod-test-make-bulk 100000)))
+    (should (= (length (nth 0 result)) 100000))
+    (should (= (aref (nth 0 result) 99999) 99999))
+    (should (= (aref (nth 1 result) 99999) 49999.5))
+    (should (equal (car (last (nth 2 result))) "99999"))
+    (should (multibyte-string-p (car (nth 2 result)))))
+  (should-error (mod-test-make-bulk -1)))
+
 ;;; emacs-module-tests.el ends here
@@ -252,4 +252,36 @@ emacs-tests--seccomp-debug
                     "--until" (format-time-string "%F %T" end-time)
                     "--no-pager"))))
 
+(ert-deftest emacs-tests/startup-profile ()
+  (let ((emacs
+         (expand-file-name invocation-name invocation-directory))
+        (process-environment nil))
+    (skip-unless (file-executable-p emacs))
+    (ert-with-temp-file profile
+      :prefix "startup-profile-" :suffix ".json"
+      (should (eql (call-process emacs nil nil nil
+                                 "--quick" "--batch"
+                                 (concat "--startup-profile=" profile)
+                                 "--eval=(require 'cl-lib)")
+                   0))
+      (let* ((trace (with-temp-buffer
+                      (insert-file-contents profile)
+                      (json-parse-buffer :object-type 'alist)))
+             (events (alist-get 'traceEvents trace)))
+        (should (cl-plusp (length events)))
+        (should (cl-some (lambda (event)
+                           (equal (alist-get 'name event) "top-level"))
+                         events))
+        (should (cl-some (lambda (event)
+                           (and (equal (alist-get 'cat event) "load")
+                                (string-match-p
+                                 (rx "cl-lib" (? ".el") (? "c") eos)
+                                 (alist-get 'name event))))
+                         events))
+        (should (cl-every (lambda (event)
+                            (and (equal (alist-get 'ph event) "X")
+                                 (>= (alist-get 'ts event) 0)
+                                 (>= (alist-get 'dur event) 0)))
+                          events))))))
+
 ;;; emacs-tests.el ends here
@@ -383,4 +383,71 @@ eval-bad-specbind
                 :type 'wrong-type-argument)
   (should-error (eval '(funcall '(lambda ((a b) 3.15) 84) 5 4))))
 
+(defvar-local eval-tests--local 'default)
+
+(ert-deftest eval-tests--specbind-fast-paths ()
+  "Check `let' of built-in and buffer-local variables across buffers."
+  (specpdl-statistics t)
+  (let ((inhibit-read-only 'bound))
+    (should (eq inhibit-read-only 'bound)))
+  (should-not inhibit-read-only)
+  (let ((stats (specpdl-statistics)))
+    (should (>= (alist-get 'forwarded stats) 1))
+    (should (>= (alist-get 'unbind stats) 1))
+    (should (> (alist-get 'size stats) 0)))
+  (let ((a (generate-new-buffer " a"))
+        (b (generate-new-buffer " b")))
+    (unwind-protect
+        (progn
+          (with-current-buffer a
+            (setq fill-column 33)
+            (setq eval-tests--local 'a)
+            (setq-local case-fold-search 'a))
+          (with-current-buffer a
+            (let ((fill-column 44)
+                  (eval-tests--local 'let)
+                  (case-fold-search 'let))
+              (set-buffer b)
+              (should (eq eval-tests--local 'default))
+              (should (eq case-fold-search (default-value 'case-fold-search)))
+              (should (= fill-column (default-value 'fill-column))))
+            (should (eq (current-buffer) b)))
+          (with-current-buffer a
+            (should (= fill-column 33))
+            (should (eq eval-tests--local 'a))
+            (should (eq case-fold-search 'a)))
+          (should (eq (with-current-buffer b eval-tests--local) 'default))
+          ;; The binding is not restored once the local value is gone.
+          (with-current-buffer a
+            (let ((fill-column 55))
+              (kill-local-variable 'fill-column))
+            (should (= fill-column (default-value 'fill-column)))))
+      (kill-buffer a)
+      (kill-buffer b))))
+
+(ert-deftest eval-tests-nested-handlers ()
+  ;; Handlers of several bytecode frames, and several handlers of one
+  ;; frame, can be thrown to in any order.
+  (let* ((inner (lambda (x)
+                  (condition-case nil
+                      (catch 'inner
+                        (pcase x
+                          (1 (throw 'inner 'inner))
+                          (2 (throw 'outer 'outer))
+                          (3 (/ 1 0))
+                          (4 (signal 'wrong-type-argument nil))
+                          (_ x)))
+                    (arith-error 'inner-error))))
+         (outer (lambda ()
+                  (let ((results nil))
+                    (dotimes (i 6)
+                      (push (condition-case nil
+                                (catch 'outer
+                                  (funcall inner i))
+                              (wrong-type-argument 'outer-error))
+                            results))
+                    (nreverse results)))))
+    (should (equal (funcall outer)
+                   '(0 inner outer inner-error outer-error 5)))))
+
 ;;; eval-tests.el ends here
@@ -217,4 +217,43 @@ fileio-tests-invalid-UNC
   (should-not (file-exists-p "//"))
   (should (file-attributes "//")))
 
+;; Check that the file attribute cache answers repeated questions and
+;; notices changes made by Emacs, but not those made by others.
+(ert-deftest fileio-tests-file-attribute-cache ()
+  (ert-with-temp-file file
+    (let ((file-attribute-cache-ttl 60))
+      (clear-file-attribute-cache)
+      (should (file-exists-p file))
+      (let ((hits file-attribute-cache-hits))
+        (should (file-exists-p file))
+        (should (file-readable-p file))
+        (should (= file-attribute-cache-hits (1+ hits))))
+      (let ((attributes (file-attributes file))
+            (hits file-attribute-cache-hits))
+        (setcar attributes 'modified)
+        (should-not (car (file-attributes file)))
+        (should (equal (cdr (file-attributes file)) (cdr attributes)))
+        (should (= file-attribute-cache-hits (+ hits 2))))
+      ;; Changes made by Emacs flush the cache.
+      (write-region "abc" nil file nil 'silent)
+      (should (= (file-attribute-size (file-attributes file)) 3))
+      (delete-file file)
+      (should-not (file-exists-p file))
+      (should-not (file-attributes file))
+      ;; Changes made behind Emacs's back are not seen until the cache
+      ;; is cleared.
+      (when (executable-find "touch")
+        (call-process "touch" nil nil nil file)
+        (should-not (file-exists-p file))
+        (clear-file-attribute-cache)
+        (should (file-exists-p file)))
+      ;; Disabling the cache makes Emacs ask the file system again.
+      (let ((file-attribute-cache-ttl nil)
+            (hits file-attribute-cache-hits))
+        (delete-file file)
+        (write-region "" nil file nil 'silent)
+        (should (file-exists-p file))
+        (should (file-exists-p file))
+        (should (= file-attribute-cache-hits hits))))))
+
 ;;; fileio-tests.el ends here
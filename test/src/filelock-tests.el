@@ -220,4 +220,23 @@ filelock-tests-detect-external-change
        (when cl (filelock-tests--should-be-locked))))))
 
 (provide 'filelock-tests)
+(ert-deftest filelock-tests-unwritable-lock-directory ()
+  "Check that Emacs does not retry locking in an unusable directory."
+  (skip-when (eq system-type 'ms-dos)) ; no filelock support
+  (filelock-tests--fixture
+   (let* ((lock-dir (expand-file-name "locks/" temp-dir))
+          (lock-file-name-transforms `((".*" ,lock-dir t))))
+     ;; The lock directory does not exist, so locking fails silently.
+     (insert "modified")
+     (should-not (file-locked-p buffer-file-truename))
+     (should-not (unlock-buffer))
+     (set-buffer-modified-p nil)
+     ;; Emacs does not try again right away, even though locking
+     ;; would now work.
+     (make-directory lock-dir)
+     (insert "modified again")
+     (should-not (directory-files lock-dir nil
+                                  directory-files-no-dot-files-regexp))
+     (set-buffer-modified-p nil))))
+
 ;;; filelock-tests.el ends here
@@ -23,6 +23,7 @@
 
 (require 'cl-lib)
 (require 'ert)
+(require 'ert-x)
 
 (ert-deftest fns-tests-identity ()
   (let ((num 12345)) (should (eq (identity num) num)))
@@ -60,6 +61,40 @@ fns-tests-safe-length
 (ert-deftest fns-tests-string-bytes ()
   (should (= (string-bytes "abc") 3)))
 
+(ert-deftest fns-tests-string-char-byte-positions ()
+  ;; Index into several long multibyte strings in turn, so that the
+  ;; character/byte position cache has to juggle them.
+  (let* ((chars (lambda (n step base)
+                  (mapcar (lambda (i)
+                            (if (zerop (% i step)) (+ base (% i 200)) ?a))
+                          (number-sequence 0 (1- n)))))
+         (lists (list (funcall chars 5000 3 #x4e00)
+                      (funcall chars 3000 7 #x1f600)
+                      (funcall chars 2000 2 #xe9)
+                      (funcall chars 100 5 #x3b1)
+                      (funcall chars 1500 11 #x3040)))
+         (strings (mapcar (lambda (l) (apply #'string l)) lists)))
+    (dotimes (i 1500)
+      (let ((j (- 1499 i)))
+        (cl-loop for l in lists
+                 for s in strings
+                 for k = (% (* j 7) (length s))
+                 do (should (eq (aref s k) (nth k l)))
+                    (should (equal (substring s k (1+ k))
+                                   (string (nth k l)))))))
+    ;; Changing the byte length of a character must not leave stale
+    ;; positions behind.
+    (let ((s (car strings)))
+      (aset s 10 ?z)
+      (should (eq (aref s 4998) (nth 4998 (car lists))))
+      (should (= (string-search "z" s) 10)))
+    (let ((s (make-string 2000 ?é)))
+      (should (eq (aref s 1500) ?é))
+      (clear-string s)
+      (aset s 0 ?é)
+      (should (eq (aref s 1999) 0))
+      (should (= (length s) 4000)))))
+
 ;; Test that equality predicates work correctly on NaNs when combined
 ;; with hash tables based on those predicates.  This was not the case
 ;; for eql in Emacs 26.
@@ -439,6 +474,39 @@ fns-tests-sort-gc
                            (string< a b)))))
     (should (equal (length s) (length a)))))
 
+(ert-deftest fns-tests-sort-specialized ()
+  ;; Sorting keys that are all fixnums, floats or strings with `value<',
+  ;; `<' or `string<' does not call the predicate, but must give the
+  ;; same stable result as calling it.
+  (let ((fixnums (mapcar (lambda (_) (- (random 100) 50))
+                         (make-list 500 nil)))
+        (strings (mapcar (lambda (_)
+                           (concat (number-to-string (random 50))
+                                   (if (zerop (random 2)) "\u00e9" "e")))
+                         (make-list 500 nil))))
+    (dolist (case `((,fixnums value< <)
+                    (,fixnums < <)
+                    (,(mapcar #'float fixnums) value< <)
+                    (,(mapcar #'float fixnums) < <)
+                    (,strings value< string<)
+                    (,strings string< string<)
+                    (,(cons 1.0 fixnums) value< <)))
+      (let* ((keys (nth 0 case))
+             (pred (nth 1 case))
+             (lessp (nth 2 case))
+             (items (seq-map-indexed #'cons keys))
+             (expected (sort items :key #'car
+                             :lessp (lambda (a b) (funcall lessp a b)))))
+        (should (equal (sort items :key #'car :lessp pred) expected))
+        (should (equal (sort items :key #'car :lessp pred :reverse t)
+                       (sort items :key #'car
+                             :lessp (lambda (a b) (funcall lessp a b))
+                             :reverse t)))
+        (should (equal (sort (mapcar #'car items) :lessp pred)
+                       (mapcar #'car expected))))))
+  ;; Mixed keys still go through the predicate.
+  (should-error (sort (list 1 "a" 2) :lessp #'<)))
+
 (defvar w32-collate-ignore-punctuation)
 
 (ert-deftest fns-tests-collate-sort ()
@@ -697,6 +765,42 @@ fns-tests-base64-decode-string
   (should (eq :got-error (condition-case () (base64-decode-string "Zm9vYmFy=") (error :got-error))))
   (should (eq :got-error (condition-case () (base64-decode-string "Zg=Zg=") (error :got-error)))))
 
+(ert-deftest fns-tests-base64-region-round-trip ()
+  (let ((data (apply #'unibyte-string
+                     (mapcar (lambda (i) (% (* i 7) 256)) (number-sequence 0 599)))))
+    (dolist (multibyte '(nil t))
+      (dolist (len '(0 1 2 3 4 5 57 58 59 60 600))
+        (with-temp-buffer
+          (set-buffer-multibyte multibyte)
+          (insert "before\n" (substring data 0 len) "\nafter")
+          (let ((beg (copy-marker 8))
+                (end (copy-marker (+ 8 len) t)))
+            ;; Put the gap away from the region.
+            (goto-char (point-max))
+            (insert "!")
+            (goto-char (point-min))
+            (base64-encode-region beg end)
+            (should (equal (buffer-substring beg end)
+                           (base64-encode-string (substring data 0 len))))
+            (should (equal (buffer-substring (point-min) beg) "before\n"))
+            (should (= (point) (point-min)))
+            (base64-decode-region beg end)
+            (should (equal (buffer-substring (point-min) (point-max))
+                           (concat "before\n"
+                                   (if multibyte
+                                       (string-to-multibyte
+                                        (substring data 0 len))
+                                     (substring data 0 len))
+                                   "\nafter!")))))))
+    ;; Invalid data leaves the buffer alone.
+    (with-temp-buffer
+      (insert "Zm9vYmFy Zg=Zg=")
+      (should-error (base64-decode-region (point-min) (point-max)))
+      (should (equal (buffer-string) "Zm9vYmFy Zg=Zg="))
+      (should-error (base64-encode-region
+                     (progn (insert "é") (point-min)) (point-max)))
+      (should (equal (buffer-string) "Zm9vYmFy Zg=Zg=é")))))
+
 (ert-deftest fns-tests-hash-buffer ()
   (should (equal (sha1 "foo") "0beec7b5ea3f0fdbc95d0dd47f3c5bc275da8a33"))
   (should (equal (with-temp-buffer
@@ -1073,6 +1177,61 @@ test-string-distance
   (should (equal 1 (string-distance "" "x")))
   (should (equal 1 (string-distance "" "x" t))))
 
+(defun fns-tests--levenshtein (s1 s2)
+  "Return the Levenshtein distance between sequences S1 and S2."
+  (let ((row (number-sequence 0 (length s1))))
+    (seq-do (lambda (c2)
+              (let ((new (list (1+ (car row))))
+                    (prev row))
+                (seq-do (lambda (c1)
+                          (push (min (1+ (car new)) (1+ (cadr prev))
+                                     (+ (car prev) (if (eq c1 c2) 0 1)))
+                                new)
+                          (setq prev (cdr prev)))
+                        s1)
+                (setq row (nreverse new))))
+            s2)
+    (car (last row))))
+
+(defun fns-tests--string-bytes (string)
+  "Return the bytes of the internal representation of STRING.
+Return nil if they cannot be found because STRING contains raw bytes."
+  (let ((bytes (encode-coding-string string 'utf-8-emacs)))
+    (and (= (length bytes) (string-bytes string)) bytes)))
+
+(ert-deftest test-string-distance-long ()
+  "Test `string-distance' and `string-distance-many' around 64 characters."
+  (let ((alphabet ["a" "b" "c" "é" "我" "\377"])
+        (strings nil))
+    (random "test-string-distance-long")
+    (dolist (len '(0 1 5 63 64 65 80))
+      (dotimes (_ 2)
+        (let ((s (mapconcat (lambda (_) (aref alphabet (random 4)))
+                            (make-list len nil))))
+          (push s strings)
+          (push (mapconcat (lambda (_) (aref alphabet (random 6)))
+                           (make-list len nil))
+                strings))))
+    (dolist (s1 strings)
+      (let ((many (string-distance-many s1 strings))
+            (many-bytes (string-distance-many s1 (vconcat strings) t)))
+        (should (= (length many) (length strings)))
+        (seq-do-indexed
+         (lambda (s2 i)
+           (let ((d (fns-tests--levenshtein s1 s2)))
+             (should (= (string-distance s1 s2) d))
+             (should (= (aref many i) d)))
+           (let ((b1 (fns-tests--string-bytes s1))
+                 (b2 (fns-tests--string-bytes s2)))
+             (when (and b1 b2)
+               (let ((d (fns-tests--levenshtein b1 b2)))
+                 (should (= (string-distance s1 s2 t) d))
+                 (should (= (aref many-bytes i) d))))))
+         strings))))
+  (should (equal (string-distance-many "ab" '("ab" "ba" "")) [0 2 2]))
+  (should (equal (string-distance-many "ab" []) []))
+  (should-error (string-distance-many "ab" '("a" b))))
+
 (ert-deftest test-bignum-eql ()
   "Test that `eql' works for bignums."
   (let ((x (+ most-positive-fixnum 1))
@@ -1204,6 +1363,31 @@ test-copy-hash-table
     (should-not (eq h1 h2))
     (should (equal (gethash 'foo h2) '(bar baz)))))
 
+(ert-deftest test-hash-table-grow-and-remove ()
+  (dolist (test '(eq eql equal))
+    (let ((h (make-hash-table :test test)))
+      (dotimes (i 1000)
+        (puthash (if (eq test 'equal) (format "k%d" i) i) i h))
+      ;; Remove every other entry, then reuse the freed slots.
+      (dotimes (i 500)
+        (remhash (if (eq test 'equal) (format "k%d" (* 2 i)) (* 2 i)) h))
+      (should (= (hash-table-count h) 500))
+      (dotimes (i 250)
+        (puthash (if (eq test 'equal) (format "n%d" i) (- -1 i)) i h))
+      (let ((h2 (copy-hash-table h)))
+        (dolist (table (list h h2))
+          (should (= (hash-table-count table) 750))
+          (dotimes (i 1000)
+            (should (eql (gethash (if (eq test 'equal) (format "k%d" i) i)
+                                  table)
+                         (and (cl-oddp i) i))))
+          (dotimes (i 250)
+            (should (eql (gethash (if (eq test 'equal)
+                                      (format "n%d" i)
+                                    (- -1 i))
+                                  table)
+                         i))))))))
+
 (ert-deftest test-hash-function-that-mutates-hash-table ()
   (define-hash-table-test 'badeq 'eq 'bad-hash)
   (let ((h (make-hash-table :test 'badeq :size 1 :rehash-size 1)))
@@ -1264,6 +1448,49 @@ test-secure-hash
   (should (string-match "\\`[0-9a-f]\\{128\\}\\'"
                         (secure-hash 'sha512 'iv-auto 100))))
 
+(ert-deftest test-secure-hash-streaming ()
+  (dolist (algorithm (secure-hash-algorithms))
+    (let ((ctx (secure-hash-make algorithm)))
+      (should (equal (secure-hash-final ctx) (secure-hash algorithm "")))
+      (secure-hash-update ctx "foo")
+      ;; Taking the hash does not change the context.
+      (should (equal (secure-hash-final ctx) (secure-hash algorithm "foo")))
+      (secure-hash-update ctx "xbarx" 1 4)
+      (should (equal (secure-hash-final ctx)
+                     (secure-hash algorithm "foobar")))
+      (should (equal (secure-hash-final ctx t)
+                     (secure-hash algorithm "foobar" nil nil t)))))
+  ;; Buffer text on both sides of the gap.
+  (with-temp-buffer
+    (set-buffer-multibyte nil)
+    (dotimes (i 5000)
+      (insert (format "line %d\n" i)))
+    (goto-char 30000)
+    (insert "x")
+    (narrow-to-region 10 (point-max))
+    (let ((expected (secure-hash 'sha256 (current-buffer))))
+      (should (equal (secure-hash-final
+                      (secure-hash-update (secure-hash-make 'sha256)
+                                          (current-buffer)))
+                     expected))
+      (let ((ctx (secure-hash-make 'sha256)))
+        (secure-hash-update ctx (current-buffer) nil 20000)
+        (secure-hash-update ctx (current-buffer) 20000)
+        (should (equal (secure-hash-final ctx) expected)))
+      (ert-with-temp-file file
+        (let ((coding-system-for-write 'no-conversion))
+          (write-region (point-min) (point-max) file nil 'silent))
+        (should (equal (secure-hash-final
+                        (secure-hash-update-file (secure-hash-make 'sha256)
+                                                 file))
+                       expected)))))
+  (should-error (secure-hash-make 'foo))
+  (should-error (secure-hash-update (record 'foo) "a")
+                :type 'wrong-type-argument)
+  (should-error (secure-hash-update-file (secure-hash-make 'md5)
+                                         "/nonexistent/file")
+                :type 'file-missing))
+
 (ert-deftest test-vector-delete ()
   (let ((v1 (make-vector 1000 1)))
     (should (equal (delete t (vector nil t)) [nil]))
@@ -58,4 +58,34 @@ indent-tests-move-to-column-invis-between-tabs
       (buffer-substring-no-properties 1 14))
     "\txxx    \tLine")))
 
+(ert-deftest indent-tests-column-cache ()
+  "Test columns computed from a remembered position in the same line."
+  (with-temp-buffer
+    (insert "a\tbc\C-ad\t\te\n\tx")
+    (let ((tab-width 8)
+          (ctl-arrow t)
+          (columns '(0 1 8 9 10 12 13 16 24 25)))
+      (dotimes (i (length columns))
+        (goto-char (+ 1 i))
+        (should (= (current-column) (nth i columns))))
+      (should (> (car (column-cache-statistics)) 0))
+      (setq tab-width 4)
+      (goto-char 9)
+      (should (= (current-column) 16))
+      (setq ctl-arrow nil)
+      (goto-char 10)
+      (should (= (current-column) 17))
+      (goto-char 1)
+      (should (= (move-to-column 10) 10))
+      (should (= (point) 6))
+      (should (= (move-to-column 14) 16))
+      (should (= (point) 9))
+      (goto-char 6)
+      (insert "xxxx")
+      (goto-char 11)
+      (should (= (current-column) 15))
+      (forward-line 1)
+      (end-of-line)
+      (should (= (current-column) 5)))))
+
 ;;; indent-tests.el ends here
@@ -67,6 +67,33 @@ inotify-file-watch-simple
           (inotify-rm-watch wd)
           (should-not (inotify-valid-p wd)))))))
 
+(ert-deftest inotify-file-watch-coalesce ()
+  "Test that repeated change events for a file are coalesced."
+  (skip-unless (featurep 'inotify))
+  (skip-unless (executable-find "sh"))
+  (ert-with-temp-directory temp-dir
+    (let* ((events nil)
+           (wd (inotify-add-watch
+                temp-dir '(create delete modify)
+                (lambda (event)
+                  (push (list (nth 1 event) (nth 2 event)) events)))))
+      (unwind-protect
+          (progn
+            ;; Everything happens before Emacs reads the events, so
+            ;; it reads them all at once.
+            (call-process "sh" nil nil nil "-c"
+                          (concat "cd " (shell-quote-argument temp-dir)
+                                  " && for i in 1 2 3 4 5; do"
+                                  " echo $i >> a; echo $i >> b; done"
+                                  " && rm a && echo x > a && echo y >> a"))
+            (while (read-event nil nil 0.5))
+            (should (equal (nreverse events)
+                           '(((create) "a") ((modify) "a")
+                             ((create) "b") ((modify) "b")
+                             ((delete) "a")
+                             ((create) "a") ((modify) "a")))))
+        (inotify-rm-watch wd)))))
+
 (ert-deftest inotify-file-watch-stop-delivery ()
   "Test whether IN_IGNORE events are delivered."
   (skip-unless (featurep 'inotify))
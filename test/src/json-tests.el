@@ -205,6 +205,31 @@ json-parse-string/object-unicode-keys
     (should (equal (json-parse-string input :object-type 'plist)
                    '(:é 1 :☃ 2 :𐌐 3)))))
 
+;; Objects with the same keys share them.
+(ert-deftest json-parse-string/shared-keys ()
+  (let* ((keys (mapcar (lambda (i) (format "k%d" i)) (number-sequence 1 300)))
+         (object (concat "{" (mapconcat (lambda (k) (format "\"%s\":\"%s\"" k k))
+                                        keys ",")
+                         "}"))
+         (input (concat "[" object "," object "]")))
+    (let ((actual (json-parse-string input)))
+      (should (equal (sort (hash-table-keys (aref actual 0))) (sort keys)))
+      (should (equal (map-pairs (aref actual 0)) (map-pairs (aref actual 1))))
+      (should-not (eq (gethash "k1" (aref actual 0))
+                      (gethash "k1" (aref actual 1)))))
+    (let ((actual (json-parse-string "[{\"a\":1},{\"a\":2}]")))
+      (should (eq (car (hash-table-keys (aref actual 0)))
+                  (car (hash-table-keys (aref actual 1))))))
+    (should (equal (json-parse-string input :object-type 'alist
+                                      :array-type 'list)
+                   (let ((alist (mapcar (lambda (k) (cons (intern k) k)) keys)))
+                     (list alist alist))))
+    (should (equal (json-parse-string input :object-type 'plist
+                                      :array-type 'list)
+                   (let ((plist (mapcan (lambda (k) (list (intern (concat ":" k)) k))
+                                        keys)))
+                     (list plist plist))))))
+
 (ert-deftest json-parse-string/array ()
   (let ((input "[\"a\", 1, [\"b\", 2]]"))
     (should (equal (json-parse-string input)
@@ -398,5 +423,89 @@ json-serialize/wrong-hash-key-type
     (puthash 1 2 table)
     (should-error (json-serialize table) :type 'wrong-type-argument)))
 
+(ert-deftest json-send ()
+  (skip-unless (executable-find "cat"))
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (dolist (framing '(nil jsonrpc ndjson))
+      (let* ((output nil)
+             (object '(:a "é" :b [1 :false]))
+             (proc (make-process
+                    :name "test" :connection-type 'pipe :coding 'binary
+                    :command '("cat")
+                    :filter (lambda (_proc string) (push string output)))))
+        (json-send proc object :false-object :false :framing framing)
+        (process-send-eof proc)
+        (while (process-live-p proc)
+          (accept-process-output proc 0.1))
+        (while (accept-process-output proc 0.1))
+        (let ((json (json-serialize object)))
+          (should (equal (apply #'concat (nreverse output))
+                         (pcase framing
+                           ('jsonrpc (format "Content-Length: %d\r\n\r\n%s"
+                                             (length json) json))
+                           ('ndjson (concat json "\n"))
+                           (_ json)))))))
+    (should-error (json-send nil 1 :framing 'lines))))
+
+;; Long runs of plain characters are copied in blocks, so put the
+;; special ones at every offset in a block.
+(ert-deftest json-serialize/long-strings ()
+  (dolist (special '("\"" "\\" "\n" "\x01" "\x7f" "é" "😀"))
+    (dotimes (i 40)
+      (let* ((s (concat (make-string i ?a) special (make-string 20 ?b)))
+             (json (json-serialize (vector s))))
+        (should (equal (json-parse-string json) (vector s)))
+        (should (equal (json-serialize (vector (concat s "\t")))
+                       (concat (substring json 0 -2) "\\t\"]")))))))
+
+;; Every way of splitting the text must give the same values.
+(ert-deftest json-parser-feed ()
+  (let ((text "{\"a\": [1, \"]}\\\"\"]}\n\"\\u00e9\" 12 true [] -1.5e3 null ")
+        (values (list '((a . [1 "]}\""])) "é" 12 t [] -1500.0 :null)))
+    (dotimes (i (length text))
+      (let ((parser (json-make-parser :object-type 'alist)))
+        (should (json-parser-p parser))
+        (should (equal (append (json-parser-feed parser (substring text 0 i))
+                               (json-parser-feed parser (substring text i)))
+                       values))))
+    ;; A UTF-8 sequence split between two pieces.
+    (let ((parser (json-make-parser))
+          (bytes (encode-coding-string "\"é\"" 'utf-8)))
+      (should (equal (json-parser-feed parser (substring bytes 0 2)) nil))
+      (should (equal (json-parser-feed parser (substring bytes 2)) '("é"))))
+    ;; A number is complete only once something follows it.
+    (let ((parser (json-make-parser)))
+      (should (equal (json-parser-feed parser "12") nil))
+      (should (equal (json-parser-feed parser "3") nil))
+      (should (equal (json-parser-feed parser "\n") '(123))))))
+
+(ert-deftest json-parser-feed/framing ()
+  (let* ((body "{\"id\":1,\"é\":\"x\"}")
+         (message (format "Content-Length: %d\r\nX: y\r\n\r\n%s"
+                          (string-bytes body) body))
+         (text (concat message message)))
+    (dotimes (i (length text))
+      (let ((parser (json-make-parser :framing 'content-length
+                                      :object-type 'plist)))
+        (should (equal (append (json-parser-feed parser (substring text 0 i))
+                               (json-parser-feed parser (substring text i)))
+                       '((:id 1 :é "x") (:id 1 :é "x"))))))
+    (let ((parser (json-make-parser :framing 'content-length)))
+      (should-error (json-parser-feed parser "X: y\r\n\r\n")
+                    :type 'json-parse-error)
+      (should (equal (json-parser-feed parser "content-length: 1\r\n\r\n1")
+                     '(1)))))
+  (should-error (json-make-parser :framing 'lines) :type 'error))
+
+(ert-deftest json-parser-feed/error ()
+  (let ((parser (json-make-parser)))
+    (should-error (json-parser-feed parser "1 [2, x] 3 ")
+                  :type 'json-parse-error)
+    ;; The value before the invalid one is returned after it.
+    (should (equal (json-parser-feed parser "") '(1 3)))
+    (should-error (json-parser-feed parser "tru ") :type 'json-parse-error)
+    (should (equal (json-parser-feed parser "[] ") '([]))))
+  (should-error (json-parser-feed 1 "") :type 'wrong-type-argument))
+
 (provide 'json-tests)
 ;;; json-tests.el ends here
@@ -52,6 +52,12 @@ keyboard-lossage-size
     (should-error (lossage-size (1- min-value)))
     (should (= lossage-orig (lossage-size lossage-orig)))))
 
+(ert-deftest keyboard-tests--input-latency-statistics ()
+  "Check that `input-latency-statistics' can discard its statistics."
+  (let ((track-input-latency nil))
+    (should (listp (input-latency-statistics t)))
+    (should (null (input-latency-statistics)))))
+
 ;; FIXME: This test doesn't currently work :-(
 ;; (ert-deftest keyboard-tests--echo-keystrokes-bug15332 ()
 ;;   (let ((msgs '())
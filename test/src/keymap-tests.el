@@ -116,6 +116,65 @@ keymap-lookup-key/list-of-keymaps
     (should (eq (lookup-key (list map1 map2) [?b]) 'bar))
     (should-not (lookup-key (list map1 map2) [?c]))))
 
+(ert-deftest keymap-lookup-key/after-changes ()
+  ;; Looking keys up again must see changes made since.
+  (let ((map (make-sparse-keymap))
+        (parent (make-sparse-keymap))
+        (other (make-sparse-keymap)))
+    (define-key parent [?a] 'foo)
+    (should-not (lookup-key map [?a]))
+    (set-keymap-parent map parent)
+    (should (eq (lookup-key map [?a]) 'foo))
+    (define-key parent [?a] 'bar)
+    (should (eq (lookup-key map [?a]) 'bar))
+    (define-key map [?a] 'baz)
+    (should (eq (lookup-key map [?a]) 'baz))
+    (define-key other [?a] 'qux)
+    (set-keymap-parent parent other)
+    (define-key parent [?a] nil t)
+    (define-key map [?a] nil t)
+    (should (eq (lookup-key map [?a]) 'qux))
+    (set-keymap-parent map nil)
+    (should-not (lookup-key map [?a]))))
+
+(ert-deftest keymap-lookup-key/menu-item-filter ()
+  ;; A binding computed by a filter is not remembered.
+  (let* ((map (make-sparse-keymap))
+         (cmd 'foo))
+    (define-key map [?a] `(menu-item "x" ignore :filter ,(lambda (_) cmd)))
+    (should (eq (lookup-key map [?a]) 'foo))
+    (setq cmd 'bar)
+    (should (eq (lookup-key map [?a]) 'bar))))
+
+(ert-deftest keymap-lookup-key/composed-after-changes ()
+  ;; Lookups in the keymaps of a list or composed keymap must see
+  ;; changes too, as must the distinction between nil and no binding.
+  (let ((map1 (make-sparse-keymap))
+        (map2 (make-sparse-keymap))
+        (filter-cmd 'foo))
+    (define-key map2 [?a] 'foo)
+    (define-key map2 [?b] `(menu-item "x" ignore
+                                      :filter ,(lambda (_) filter-cmd)))
+    (dotimes (_ 2)
+      (should (eq (lookup-key (list map1 map2) [?a]) 'foo))
+      (should (eq (lookup-key (make-composed-keymap map1 map2) [?a]) 'foo)))
+    (define-key map1 [?a] 'bar)
+    (should (eq (lookup-key (list map1 map2) [?a]) 'bar))
+    (should (eq (lookup-key (make-composed-keymap map1 map2) [?a]) 'bar))
+    (define-key map1 [?a] nil)
+    (should-not (lookup-key (make-composed-keymap map1 map2) [?a]))
+    (define-key map1 [?a] nil t)
+    (should (eq (lookup-key (make-composed-keymap map1 map2) [?a]) 'foo))
+    (should (eq (lookup-key (list map1 map2) [?b]) 'foo))
+    (setq filter-cmd 'bar)
+    (should (eq (lookup-key (list map1 map2) [?b]) 'bar))
+    ;; Meta characters go through the keymap of ESC.
+    (define-key map2 [?\M-c] 'baz)
+    (should (eq (lookup-key (make-composed-keymap map1 map2) [?\M-c]) 'baz))
+    (define-key map1 [?\M-c] 'qux)
+    (should (eq (lookup-key (make-composed-keymap map1 map2) [?\M-c])
+                'qux))))
+
 (ert-deftest keymap-lookup-key/too-long ()
   (let ((map (make-keymap)))
     (define-key map (kbd "C-c f") 'foo)
@@ -278,6 +337,30 @@ keymap-where-is-internal/remap
     (should (equal (where-is-internal 'foo map t) [?y]))
     (should (equal (where-is-internal 'bar map t) [?y]))))
 
+(ert-deftest keymap-where-is-internal/several-keymaps ()
+  ;; Alternate between keymaps and search modes, and change them.
+  (let ((map1 (make-sparse-keymap))
+        (map2 (make-sparse-keymap)))
+    (define-key map1 "x" 'keymap-tests--command-1)
+    (define-key map1 [menu-bar foo cmd] 'keymap-tests--command-1)
+    (define-key map2 "y" 'keymap-tests--command-1)
+    (dotimes (_ 2)
+      (should (equal (where-is-internal 'keymap-tests--command-1 map1 t)
+                     [?x]))
+      (should (equal (where-is-internal 'keymap-tests--command-1 map1)
+                     '([?x] [menu-bar foo cmd])))
+      (should (equal (where-is-internal 'keymap-tests--command-1 map2)
+                     '([?y])))
+      (should-not (where-is-internal 'keymap-tests--command-2 map2)))
+    (define-key map2 "z" 'keymap-tests--command-2)
+    (should (equal (where-is-internal 'keymap-tests--command-2 map2)
+                   '([?z])))
+    (set-keymap-parent map2 map1)
+    (should (equal (where-is-internal 'keymap-tests--command-1 map2 t)
+                   [?y]))
+    (should (equal (where-is-internal 'keymap-tests--command-1 map2)
+                   '([?y] [?x] [menu-bar foo cmd])))))
+
 (defvar-keymap keymap-tests-minor-mode-map
   "x" 'keymap-tests--command-2)
 
@@ -290,6 +290,28 @@ lread-float
   (should (equal (read "-0.e-5") -0.0))
   )
 
+(ert-deftest lread-float-round-trip ()
+  "Test printing floats in the fewest digits and reading them back."
+  (dolist (case '(("0.1" . 0.1) ("1e+20" . 1e20) ("1e+21" . 1e21)
+                  ("123456.0" . 123456.0) ("1e-05" . 1e-5)
+                  ("0.0001" . 1e-4) ("0.3333333333333333" . 0.3333333333333333)
+                  ("1.7976931348623157e+308" . 1.7976931348623157e308)
+                  ("2.2250738585072014e-308" . 2.2250738585072014e-308)
+                  ("5e-324" . 5e-324) ("9007199254740992.0" . 9007199254740992.0)
+                  ("1e+23" . 1e23) ("1.2345678901234568e-300" . 1.2345678901234568e-300)))
+    (should (equal (prin1-to-string (cdr case)) (car case)))
+    (should (equal (read (car case)) (cdr case))))
+  ;; Numbers with many digits, or halfway between two floats.
+  (should (equal (read "9007199254740993.0") 9007199254740992.0))
+  (should (equal (read "9007199254740995.0") 9007199254740996.0))
+  (should (equal (read "0.10000000000000000000000000001") 0.1))
+  (should (equal (read "1e400") 1.0e+INF))
+  (should (equal (read "1e-400") 0.0))
+  (dotimes (_ 1000)
+    (let ((x (/ (random most-positive-fixnum) (float (1+ (random 1000000))))))
+      (should (equal (read (prin1-to-string x)) x))
+      (should (equal (read (prin1-to-string (* x 1e-200))) (* x 1e-200))))))
+
 (defun lread-test-read-and-print (str)
   (let* ((read-circle t)
          (print-circle t)
@@ -387,4 +409,135 @@ lread-skip-to-eof
     (goto-char (point-min))
     (should-error (read (current-buffer)) :type 'end-of-file)))
 
+(ert-deftest lread-load-path-cache ()
+  "Check that `load-path-cache' notices files added to a directory."
+  (ert-with-temp-directory dir
+    (let ((load-path (list dir "/nonexistent/lread-tests"))
+          (load-path-cache t)
+          (old-time '(1000000000 0)))
+      (write-region "" nil (expand-file-name "lread-tests-a.el" dir))
+      ;; Make the directory look old enough for its listing to be kept.
+      (set-file-times dir old-time)
+      (should (equal (locate-library "lread-tests-a")
+                     (expand-file-name "lread-tests-a.el" dir)))
+      (should-not (locate-library "lread-tests-b"))
+      (write-region "" nil (expand-file-name "lread-tests-b.el" dir))
+      (set-file-times dir (time-add old-time 10))
+      (should (equal (locate-library "lread-tests-b")
+                     (expand-file-name "lread-tests-b.el" dir)))
+      (should (equal (locate-file "lread-tests-b.el" load-path)
+                     (expand-file-name "lread-tests-b.el" dir))))))
+
+;; Objects whose `#%' binary form should read back as `equal'.
+(defconst lread-tests--binary-objects
+  (list 0 -1 most-positive-fixnum most-negative-fixnum
+        (1+ most-positive-fixnum) (- (expt 3 80)) 1.5 -0.0 1.0e+INF
+        "" "abc" "h\u00e9llo" (string-to-unibyte "\377a")
+        'foo nil '(a b . c) '(1 (2 (3))) [1 "2" (x)] []
+        (record 'foo 1 2) (make-bool-vector 13 t) (make-bool-vector 0 nil)
+        (byte-compile (lambda (x) (* x 2)))))
+
+(ert-deftest lread-binary-round-trip ()
+  (dolist (obj lread-tests--binary-objects)
+    (let ((binary (print--binary obj)))
+      (should (string-prefix-p "#%" binary))
+      (should (equal (read binary) obj))
+      (with-temp-buffer
+        (insert binary " rest")
+        (goto-char (point-min))
+        (should (equal (read (current-buffer)) obj))
+        (should (looking-at-p " rest")))))
+  (should (= (funcall (read (print--binary
+                             (byte-compile (lambda (x) (* x 2)))))
+                      21)
+             42)))
+
+(ert-deftest lread-binary-sharing ()
+  (let* ((cell (list 1 2))
+         (sym (make-symbol "lread-tests"))
+         (obj (read (print--binary (list cell cell sym sym (vector sym))))))
+    (should (equal (nth 0 obj) cell))
+    (should (eq (nth 0 obj) (nth 1 obj)))
+    (should (eq (nth 2 obj) (nth 3 obj)))
+    (should (eq (nth 2 obj) (aref (nth 4 obj) 0)))
+    (should-not (eq (nth 2 obj) sym))
+    (should-not (intern-soft (nth 2 obj)))))
+
+(ert-deftest lread-binary-unsupported ()
+  (let ((circular (list 1)))
+    (setcdr circular circular)
+    (should-not (print--binary circular)))
+  (should-not (print--binary (propertize "a" 'face 'bold)))
+  (should-not (print--binary (current-buffer)))
+  (should-error (read "#%4 AAAA") :type 'invalid-read-syntax)
+  (should-error (read "#%8 AQAAAQ") :type 'invalid-read-syntax)
+  (let ((binary (print--binary '(a b))))
+    (should-error (read (substring binary 0 -1))
+                  :type 'invalid-read-syntax)))
+
+(ert-deftest lread-serialize-round-trip ()
+  (dolist (obj lread-tests--binary-objects)
+    (let ((data (serialize obj)))
+      (should-not (multibyte-string-p data))
+      (should (equal (deserialize data) obj))
+      (should (equal (deserialize (string-to-multibyte data)) obj))))
+  (let* ((cell (list 1 2))
+         (obj (deserialize (serialize (list cell cell)))))
+    (should (equal (car obj) cell))
+    (should (eq (car obj) (cadr obj)))))
+
+(ert-deftest lread-serialize-hash-table ()
+  (let ((table (make-hash-table :test 'equal :weakness 'key))
+        (cell (list 'x)))
+    (puthash "a" cell table)
+    (puthash '(b) cell table)
+    (let* ((obj (deserialize (serialize (list table table))))
+           (copy (car obj)))
+      (should (eq copy (cadr obj)))
+      (should (hash-table-p copy))
+      (should (eq (hash-table-test copy) 'equal))
+      (should (eq (hash-table-weakness copy) 'key))
+      (should (= (hash-table-count copy) 2))
+      (should (equal (gethash "a" copy) '(x)))
+      (should (eq (gethash "a" copy) (gethash '(b) copy))))
+    ;; Compiled files can contain hash tables now too.
+    (should (hash-table-p (read (print--binary table))))))
+
+(ert-deftest lread-serialize-errors ()
+  (let ((circular (list 1)))
+    (setcdr circular circular)
+    (should-error (serialize circular)))
+  (should-error (serialize (propertize "a" 'face 'bold)))
+  (should-error (serialize (current-buffer)))
+  (should-error (deserialize ""))
+  (should-error (deserialize "\u00e9"))
+  (let ((data (serialize '(a "b" [c]))))
+    (should-error (deserialize (substring data 0 -1)))
+    (should-error (deserialize (concat data "x")))))
+
+(ert-deftest lread-binary-forms-load ()
+  "Check that files compiled with `byte-compile-binary-forms' load."
+  (ert-with-temp-file file
+    :suffix ".el"
+    (with-temp-file file
+      (insert ";;; -*- lexical-binding: t -*-\n"
+              "(defvar lread-tests--binary-var (list 1 \"x\" 'y))\n"
+              "(defun lread-tests--binary-fun (x)\n"
+              "  \"My doc string.\"\n"
+              "  (cons x lread-tests--binary-var))\n"))
+    (let ((byte-compile-binary-forms t))
+      (byte-compile-file file))
+    (let ((elc (concat file "c")))
+      (unwind-protect
+          (progn
+            (with-temp-buffer
+              (insert-file-contents elc)
+              (should (search-forward "#%" nil t)))
+            (load elc nil t)
+            (should (equal (lread-tests--binary-fun 0) '(0 1 "x" y)))
+            (should (string-prefix-p
+                     "My doc string."
+                     (documentation 'lread-tests--binary-fun))))
+        (delete-file elc)))))
+
 ;;; lread-tests.el ends here
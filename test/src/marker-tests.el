@@ -57,4 +57,60 @@ marker-goto-char-from-other-buffer
     (set-marker marker-2 marker-1)
     (should (goto-char marker-2))))
 
+(ert-deftest marker-position-index ()
+  "Position conversions in a large multibyte buffer."
+  (with-temp-buffer
+    (let ((model (apply #'concat (make-list 20000 "a\u00e9\u4e2d\U0001F600\n")))
+          (check
+           (lambda (model)
+             (dolist (pos (list 2 5001 33333 50000 66666 80001
+                                (- (point-max) 7)))
+               (let ((byte (1+ (string-bytes (substring model 0 (1- pos))))))
+                 (should (= (position-bytes pos) byte))
+                 (should (= (byte-to-position byte) pos)))))))
+      (insert model)
+      (goto-char (point-min))
+      (funcall check model)
+      (should (> (nth 2 (position-index-statistics)) 0))
+      ;; The checkpoints after a change must be relocated.
+      (goto-char 40000)
+      (insert "\u00fc\u00fc")
+      (setq model (concat (substring model 0 39999) "\u00fc\u00fc"
+                          (substring model 39999)))
+      (goto-char (point-min))
+      (funcall check model)
+      (delete-region 20000 30000)
+      (setq model (concat (substring model 0 19999) (substring model 29999)))
+      (goto-char (point-min))
+      (funcall check model))))
+
+(ert-deftest marker-tests-unchain ()
+  "Test removing markers from a buffer's marker chain."
+  (with-temp-buffer
+    (insert "abcdefghij")
+    (let* ((base (current-buffer))
+           (indirect (make-indirect-buffer base " *marker-tests*"))
+           (markers (mapcar (lambda (pos)
+                              (copy-marker
+                               (set-marker (make-marker) pos
+                                           (if (= (% pos 2) 1) indirect base))))
+                            (number-sequence 1 10))))
+      ;; Unchain markers from the front, the back and the middle of
+      ;; the chain, and by moving them to another buffer.
+      (set-marker (nth 0 markers) nil)
+      (set-marker (nth 9 markers) nil)
+      (set-marker (nth 4 markers) nil)
+      (with-temp-buffer
+        (insert "xyz")
+        (set-marker (nth 2 markers) 2 (current-buffer))
+        (should (eq (marker-buffer (nth 2 markers)) (current-buffer))))
+      (kill-buffer indirect)
+      (dolist (i '(0 2 4 6 8 9))
+        (should-not (marker-buffer (nth i markers))))
+      (dolist (i '(1 3 5 7))
+        (should (eq (marker-buffer (nth i markers)) base)))
+      (delete-region 1 5)
+      (should (equal (mapcar #'marker-position markers)
+                     '(nil 1 nil 1 nil 2 nil 4 nil nil))))))
+
 ;;; marker-tests.el ends here
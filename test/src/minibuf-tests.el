@@ -431,5 +431,79 @@ test-inhibit-interaction
                   (error nil))
                 'inhibit))))
 
+(ert-deftest completion-flex-matches-scores ()
+  (require 'minibuffer)
+  (let* ((strings '("fabrobazo" "fbarbazoo" "barfoobaz" "foo" "bar" "FoO"))
+         (matches (completion-flex-matches "foo" strings)))
+    (should (equal (mapcar #'car matches)
+                   '("foo" "barfoobaz" "fbarbazoo" "fabrobazo")))
+    (should (equal (nth 2 (assoc "fbarbazoo" matches)) '(0 7 8)))
+    ;; The scores are those the `flex' completion style gives.
+    (dolist (match matches)
+      (should (= (nth 1 match)
+                 (completion--flex-score
+                  (car match) "\\`\\(.*?\\)f\\(.*?\\)o\\(.*?\\)o\\(.*\\)"))))
+    (should (equal (mapcar #'car (completion-flex-matches "foo" strings nil 2))
+                   '("foo" "barfoobaz")))
+    (let ((completion-ignore-case t))
+      (should (equal (mapcar #'car (completion-flex-matches "foo" strings))
+                     '("foo" "FoO" "barfoobaz" "fbarbazoo" "fabrobazo"))))))
+
+(ert-deftest completion-flex-matches-collections ()
+  (let ((strings '("abc" "axbxc" "cba" "abd")))
+    (dolist (collection
+             (list strings
+                   (minibuf-tests--strings-to-symbol-list strings)
+                   (minibuf-tests--strings-to-string-alist strings)
+                   (minibuf-tests--strings-to-obarray strings)
+                   (minibuf-tests--strings-to-string-hashtable strings)
+                   (minibuf-tests--strings-to-symbol-hashtable strings)
+                   (lambda (_string _pred _action) strings)))
+      (should (equal (sort (mapcar #'car (completion-flex-matches
+                                          "abc" collection)))
+                     '("abc" "axbxc"))))
+    (should (equal (mapcar #'car (completion-flex-matches
+                                  "ab" strings
+                                  (lambda (s) (not (equal s "abc")))))
+                   '("abd" "axbxc")))
+    (let ((completion-regexp-list '("d")))
+      (should (equal (mapcar #'car (completion-flex-matches "ab" strings))
+                     '("abd"))))))
+
+(ert-deftest completion-session-reuses-matches ()
+  (let* ((strings (list "foo" "foobar" "Foobaz" "bar"))
+         (session (make-completion-session))
+         (calls 0)
+         (pred (lambda (s) (incf calls) (not (equal s "foobar")))))
+    (should (equal (completion-session-all-completions session "f" strings pred)
+                   '("foo")))
+    (should (= calls 2))
+    ;; Extending the input only looks at the previous matches.
+    (should (equal (completion-session-all-completions session "fo" strings pred)
+                   '("foo")))
+    (should (= calls 2))
+    (should (eq (completion-session-try-completion session "foo" strings pred)
+                t))
+    (should (= calls 2))
+    ;; Anything else rescans the collection.
+    (let ((completion-ignore-case t))
+      (should (equal (completion-session-all-completions
+                      session "foo" strings pred)
+                     '("foo" "Foobaz"))))
+    (should (= calls 5))
+    (should (equal (completion-session-all-completions session "b" strings pred)
+                   '("bar")))
+    (should (= calls 6))
+    (should (equal (completion-session-try-completion session "" strings)
+                   ""))
+    (should (equal (completion-session-all-completions session "ba" strings)
+                   '("bar")))
+    ;; The result can be modified without affecting the session.
+    (let ((matches (completion-session-all-completions session "" strings)))
+      (setcar matches "x"))
+    (should (equal (completion-session-all-completions session "f" strings)
+                   '("foo" "foobar")))
+    (should-error (completion-session-all-completions [1] "f" strings))))
+
 
 ;;; minibuf-tests.el ends here
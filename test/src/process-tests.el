@@ -403,6 +403,121 @@ make-process/stop
                                                   invocation-directory))
                  :stop t))))
 
+(ert-deftest process-tests/read-process-output-adaptive-max ()
+  "Check that the read chunk size adapts to bulk output."
+  (skip-unless (executable-find "head"))
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (let* ((read-process-output-max 4096)
+           (read-process-output-adaptive-max 65536)
+           (total 0)
+           (largest 0)
+           (proc (make-process
+                  :name "test" :connection-type 'pipe :coding 'binary
+                  :command '("head" "-c" "4000000" "/dev/zero")
+                  :filter (lambda (_proc string)
+                            (setq total (+ total (length string))
+                                  largest (max largest (length string)))))))
+      (should (= (process-read-output-max proc) 4096))
+      (while (process-live-p proc)
+        (accept-process-output proc 1))
+      (while (accept-process-output proc 0.1))
+      (should (= total 4000000))
+      (should (> largest 4096))
+      (should (<= largest 65536))
+      (should (<= 4096 (process-read-output-max proc) 65536)))))
+
+(ert-deftest process-tests/insert-output-verbatim ()
+  "Check inserting output that decoding would not change."
+  (skip-unless (executable-find "printf"))
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (dolist (test '((utf-8-unix "a\\nb\\n" "a\nb\n")
+                    (utf-8-dos "a\\r\\nb\\n" "a\nb\n")
+                    (utf-8-unix "\\303\\251\\n" "\u00e9\n")))
+      (with-temp-buffer
+        (let ((proc (make-process :name "test" :buffer (current-buffer)
+                                  :connection-type 'pipe
+                                  :coding (car test)
+                                  :command (list "printf" (nth 1 test))
+                                  :sentinel #'ignore)))
+          (while (process-live-p proc)
+            (accept-process-output proc 1))
+          (while (accept-process-output proc 0.1))
+          (should (equal (buffer-string) (nth 2 test))))))))
+
+(ert-deftest process-tests/filter-batch ()
+  "Check that batched output reaches the filter before the sentinel."
+  (skip-unless (executable-find "sh"))
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (let* ((events nil)
+           (proc (make-process
+                  :name "test" :connection-type 'pipe :coding 'utf-8-unix
+                  :command '("sh" "-c" "echo a; sleep 0.1; echo b")
+                  :filter-batch-ms 10000
+                  :filter (lambda (_proc string) (push string events))
+                  :sentinel (lambda (_proc _event) (push 'exit events)))))
+      (should (equal (process-filter-batch proc) '(10000)))
+      (while (not (memq 'exit events))
+        (accept-process-output proc 0.1))
+      (should (equal events '(exit "a\nb\n")))
+      (set-process-filter-batch proc nil)
+      (should-not (process-filter-batch proc)))))
+
+(ert-deftest process-tests/framing ()
+  "Check that the filter is passed the JSON values in the output."
+  (skip-unless (executable-find "cat"))
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (let* ((values nil)
+           (proc (make-process
+                  :name "test" :connection-type 'pipe :coding 'binary
+                  :command '("cat")
+                  :framing 'jsonrpc
+                  :filter (lambda (_proc value) (push value values)))))
+      (should (json-parser-p (process-framing proc)))
+      (dolist (body '("{\"id\":1}" "\"\\u00e9\"" "2"))
+        (process-send-string
+         proc (format "Content-Length: %d\r\n\r\n%s" (length body) body)))
+      (process-send-eof proc)
+      (while (process-live-p proc)
+        (accept-process-output proc 0.1))
+      (while (accept-process-output proc 0.1))
+      (should (equal (length values) 3))
+      (should (equal (gethash "id" (nth 2 values)) 1))
+      (should (equal (cdr values) (list "é" (nth 2 values))))
+      (should (equal (car values) 2))
+      (set-process-framing proc nil)
+      (should-not (process-framing proc))
+      (should-error (set-process-framing proc 'lines)))))
+
+(ert-deftest process-tests/send-string-queued ()
+  "Check that output queued while the pipe is full keeps its order."
+  (skip-unless (executable-find "cat"))
+  (with-timeout (60 (ert-fail "Test timed out"))
+    (let* ((big (make-string 1000000 ?x))
+           (extra (mapconcat (lambda (i) (format "<%d>" i))
+                             (number-sequence 0 9)))
+           (sent-extra nil)
+           (received nil)
+           (proc (make-process
+                  :name "test" :connection-type 'pipe :coding 'binary
+                  :command '("cat")
+                  :filter (lambda (proc string)
+                            (push string received)
+                            ;; This runs while `big' is still being
+                            ;; sent, so these strings are queued.
+                            (unless sent-extra
+                              (setq sent-extra t)
+                              (dotimes (i 10)
+                                (process-send-string
+                                 proc (format "<%d>" i))))))))
+      (process-send-string proc big)
+      (process-send-eof proc)
+      (while (process-live-p proc)
+        (accept-process-output proc 1))
+      (while (accept-process-output proc 0.1))
+      (should sent-extra)
+      (should (equal (apply #'concat (nreverse received))
+                     (concat big extra))))))
+
 ;; The following tests require working DNS
 
 ;; This will need updating when IANA assign more IPv6 global ranges.
@@ -519,6 +634,27 @@ non-existent-lookup-failure
 
 ;; End of tests requiring DNS
 
+(ert-deftest process-tests/network-lookup-cache ()
+  "Check connecting by name with and without remembered addresses."
+  (skip-unless (featurep 'make-network-process '(:server t)))
+  (let* ((network-lookup-cache-ttl 60)
+         (server (make-network-process :name "server" :server t
+                                       :host 'local :service t
+                                       :family 'ipv4))
+         (port (process-contact server :service)))
+    (unwind-protect
+        (dolist (nowait '(nil nil t t nil))
+          (let ((client (make-network-process
+                         :name "client" :host "localhost" :service port
+                         :family 'ipv4 :nowait nowait)))
+            (unwind-protect
+                (with-timeout (10 (ert-fail "Test timed out"))
+                  (while (eq (process-status client) 'connect)
+                    (accept-process-output nil 0.01))
+                  (should (eq (process-status client) 'open)))
+              (delete-process client))))
+      (delete-process server))))
+
 (ert-deftest process-tests-check-bug-74907 ()
   "Check that the result of `network-interface-list' is well-formed.
 (Bug#74907)"
@@ -911,6 +911,87 @@ regexp-tests-backtrack-optimization
     (should (string-match ".*\\>" "hello "))
     ))
 
+(ert-deftest regexp-tests-nested-repetition ()
+  ;; Nested repetitions are matched without backtracking, which would
+  ;; otherwise take time exponential in the length of the text.
+  ;; relint suppression: Repetition of expression matching an empty string
+  (let ((s (concat (make-string 40 ?a) "c")))
+    (should-not (string-match "\\(a*\\)*b" s))
+    (should-not (string-match "\\(a\\|aa\\)+b" s))
+    (should (equal (string-match "\\(a\\|aa\\)+c" s) 0)))
+  ;; The match and its groups are the ones backtracking would find.
+  ;; relint suppression: Repetition of expression matching an empty string
+  (should (equal (string-match "\\(x?\\)*y" "y") 0))
+  (should (equal (match-data) '(0 1 0 0)))
+  (should (equal (string-match "\\(a\\|\\(b\\)\\)*c" "zbac") 1))
+  (should (equal (match-data) '(1 4 2 3 1 2)))
+  ;; relint suppression: Repetition of expression matching an empty string
+  (should (equal (string-match "\\(.*\\)+" "ab\n") 0))
+  (should (equal (match-data) '(0 2 2 2)))
+  (should (equal (string-match "\\(\\(?:ab\\|a\\)*?\\)b" "xaab") 1))
+  (should (equal (match-data) '(1 4 1 3)))
+  (with-temp-buffer
+    (insert "xx" (make-string 30 ?a) "y\naab")
+    (goto-char (point-min))
+    (should (equal (re-search-forward "^\\(a\\|aa\\)*b" nil t) 38))
+    (should (equal (match-beginning 0) 35))
+    (should (equal (match-beginning 1) 36))))
+
+;; Searches skip text that lacks a string every match must contain.
+(ert-deftest regexp-tests-required-literal ()
+  (with-temp-buffer
+    (insert "(setq x 1)\n  (defun foo ()\n(progn)\n  (DEFUN bar ())\n")
+    ;; Move the gap into the middle of the first "defun".
+    (goto-char 6)
+    (insert "z")
+    (delete-char -1)
+    (let ((case-fold-search nil))
+      (goto-char (point-min))
+      (should (equal (re-search-forward "^\\s-*(defun \\(\\w+\\)" nil t)
+                     24))
+      (should (equal (match-string 1) "foo"))
+      (should-not (re-search-forward "^\\s-*(defun " nil t))
+      (should (equal (re-search-backward "^\\s-*(def" nil t) 12))
+      (should-not (re-search-backward "(defun " nil t))
+      (goto-char (point-max))
+      (should-not (re-search-backward "[a-z]+ nothing" nil t))
+      (should (equal (re-search-backward "\\(?:un\\|UN\\) [a-z]+" nil t)
+                     42)))
+    (let ((case-fold-search t))
+      (goto-char (point-min))
+      (should (equal (re-search-forward "^\\s-*(defun \\(\\w+\\)" nil t)
+                     24))
+      (should (equal (re-search-forward "^\\s-*(defun \\(\\w+\\)" nil t)
+                     48))
+      (should (equal (match-string 1) "bar"))
+      (should (equal (re-search-backward "^ *(DeFuN" nil t) 36))
+      (should (equal (re-search-backward "^ *(DeFuN" nil t) 12))
+      (should-not (re-search-backward "^ *(DeFuN" nil t))))
+  ;; A string that only some matches contain is not required.
+  (should (equal (string-match "\\(?:abc\\|xy\\)z" "xxyz") 1))
+  (should (equal (string-match "\\(abc\\)?xy" "abxy") 2))
+  (should (equal (string-match "é\\(?:ab\\)\\{0,2\\}é" "aéé") 1)))
+
+(ert-deftest regexp-tests-step-limit ()
+  ;; Back references keep this from being matched in lock step, so it
+  ;; backtracks exponentially.
+  (let ((re "\\(a*\\)*\\1b")
+        (s (make-string 30 ?a)))
+    (let ((regexp-match-step-limit 1000))
+      (should (equal (should-error (string-match re s)
+                                   :type 'regexp-budget-exceeded)
+                     '(regexp-budget-exceeded 1000)))
+      (with-temp-buffer
+        (insert s)
+        (goto-char (point-min))
+        (should-error (re-search-forward re nil t)
+                      :type 'regexp-budget-exceeded)
+        (should-error (looking-at re) :type 'regexp-budget-exceeded)))
+    ;; Matches that take fewer steps are not affected.
+    (let ((regexp-match-step-limit 1000))
+      (should (equal (string-match re "aab") 0))
+      (should (equal (string-match "\\(a*\\)*b" s) nil)))))
+
 (ert-deftest regexp-tests-zero-width-assertion-repetition ()
   ;; Check compatibility behavior with repetition operators after
   ;; certain zero-width assertions (bug#64128).
@@ -0,0 +1,126 @@
+;;; region-cache-tests.el --- tests for region-cache.c -*- lexical-binding: t -*-
+
+;; Copyright (C) 2025 Free Software Foundation, Inc.
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <https://www.gnu.org/licenses/>.
+
+;;; Code:
+
+(require 'ert)
+
+(ert-deftest region-cache-tests-know-and-query ()
+  (with-temp-buffer
+    (insert (make-string 100 ?a))
+    (let ((cache (make-region-cache)))
+      (should (region-cache-p cache))
+      (should-not (region-cache-p (current-buffer)))
+      (should (eq (region-cache-buffer cache) (current-buffer)))
+      (should (eq (cl-type-of cache) 'region-cache))
+      (should (string-prefix-p "#<region-cache " (format "%S" cache)))
+      (should-not (region-cache-query cache 10))
+      (region-cache-know cache 40 20)
+      (should (= (region-cache-query cache 20) 40))
+      (should (= (region-cache-query cache 30) 40))
+      (should-not (region-cache-query cache 40))
+      (should-not (region-cache-query cache 20 t))
+      (should (= (region-cache-query cache 40 t) 20))
+      (region-cache-know cache 40 60)
+      (should (= (region-cache-query cache 25) 60))
+      (region-cache-forget cache 45 50)
+      (should (= (region-cache-query cache 25) 45))
+      (should (= (region-cache-query cache 50) 60))
+      ;; Narrowing does not affect positions.
+      (narrow-to-region 30 35)
+      (should (= (region-cache-query cache 25) 45))
+      (widen)
+      (should-error (region-cache-query cache 0) :type 'args-out-of-range)
+      (should-error (region-cache-know cache 1 200) :type 'args-out-of-range)
+      (region-cache-forget cache)
+      (should-not (region-cache-query cache 25)))))
+
+(ert-deftest region-cache-tests-edits ()
+  (with-temp-buffer
+    (insert (make-string 100 ?a))
+    (let ((cache (make-region-cache)))
+      (region-cache-know cache 1 101)
+      ;; An insertion makes the inserted text unknown and shifts what
+      ;; follows it.
+      (goto-char 51)
+      (insert "bbbbb")
+      (should (region-cache-query cache 1))
+      (should (<= (region-cache-query cache 1) 51))
+      (should-not (region-cache-query cache 52))
+      (should (= (region-cache-query cache 60) 106))
+      (region-cache-know cache 1 106)
+      ;; A deletion leaves the text around it known.
+      (delete-region 10 20)
+      (should (= (region-cache-query cache 1) 96))
+      ;; Changes through an indirect buffer count too.
+      (region-cache-know cache 1 96)
+      (let ((base (current-buffer))
+            (indirect (make-indirect-buffer (current-buffer)
+                                            " *region-cache-tests*")))
+        (unwind-protect
+            (progn
+              (with-current-buffer indirect
+                (goto-char 80)
+                (insert "c"))
+              (with-current-buffer base
+                (should (= (region-cache-query cache 85) 97))
+                (should-not (region-cache-query cache 80))))
+          (kill-buffer indirect))))))
+
+(ert-deftest region-cache-tests-killed-buffer ()
+  (let* ((buffer (generate-new-buffer " *region-cache-tests*"))
+         (cache (make-region-cache buffer)))
+    (with-current-buffer buffer
+      (insert "abc"))
+    (region-cache-know cache 1 3)
+    (should (= (region-cache-query cache 1) 3))
+    (kill-buffer buffer)
+    (should (string-match-p "killed" (format "%S" cache)))
+    (should-error (region-cache-query cache 1))
+    (should-error (make-region-cache buffer))))
+
+(ert-deftest region-cache-tests-swap-text ()
+  (let ((a (generate-new-buffer " *region-cache-tests-a*"))
+        (b (generate-new-buffer " *region-cache-tests-b*")))
+    (unwind-protect
+        (let ((cache (make-region-cache a)))
+          (with-current-buffer a (insert "aaaa"))
+          (with-current-buffer b (insert "bbbbbbbb"))
+          (region-cache-know cache 1 5)
+          (with-current-buffer a (buffer-swap-text b))
+          (should-not (region-cache-query cache 1)))
+      (kill-buffer a)
+      (kill-buffer b))))
+
+(ert-deftest region-cache-tests-garbage-collection ()
+  (with-temp-buffer
+    (insert "abc")
+    (let ((cache (make-region-cache)))
+      (dotimes (_ 100)
+        (region-cache-know (make-region-cache) 1 3))
+      (garbage-collect)
+      (region-cache-know cache 1 4)
+      (goto-char 2)
+      (insert "x")
+      (should (= (region-cache-query cache 1) 2))
+      (should (= (region-cache-query cache 3) 5)))))
+
+(provide 'region-cache-tests)
+
+;;; region-cache-tests.el ends here
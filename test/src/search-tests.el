@@ -79,4 +79,115 @@ search-test--replace-match-update-data
         ;;(should (equal (match-end 2) beg4))
         ))))
 
+(ert-deftest search-test--regexp-cache ()
+  (let ((regexp-cache-size 4)
+        (regexps (mapcar (lambda (i) (format "x%d\\'" i)) (number-sequence 1 8))))
+    ;; Regexps that fit in the cache are compiled once.
+    (dolist (re (take 4 regexps))
+      (string-match re "x1"))
+    (let ((hits regexp-cache-hits)
+          (misses regexp-cache-misses))
+      (dotimes (_ 3)
+        (dolist (re (take 4 regexps))
+          (string-match re "x1")))
+      (should (= regexp-cache-hits (+ hits 12)))
+      (should (= regexp-cache-misses misses)))
+    ;; More regexps than that evict the least recently used ones, so
+    ;; only the first four are found the first time round.
+    (let ((misses regexp-cache-misses))
+      (dotimes (_ 2)
+        (dolist (re regexps)
+          (should (eq (string-match re "x3") (and (equal re "x3\\'") 0)))))
+      (should (= regexp-cache-misses (+ misses 12))))
+    ;; Patterns that use the syntax table are compiled again after it
+    ;; changes.
+    (with-temp-buffer
+      (insert "a_b")
+      (let ((table (make-syntax-table)))
+        (set-syntax-table table)
+        (goto-char (point-min))
+        (should-not (re-search-forward "[[:word:]]\\{3\\}" nil t))
+        (modify-syntax-entry ?_ "w" table)
+        (goto-char (point-min))
+        (should (re-search-forward "[[:word:]]\\{3\\}" nil t))))))
+
+;; Large buffers count lines with the help of an index, which must
+;; follow the changes to the text.
+(ert-deftest search-test--line-index ()
+  (with-temp-buffer
+    (dotimes (i 20000)
+      (insert (make-string (% (* i 7) 31) (if (zerop (% i 5)) ?é ?a)) "\n"))
+    (let ((check
+           (lambda ()
+             (dolist (pos (list (point-min) (/ (point-max) 3)
+                                (/ (point-max) 2) (1- (point-max))
+                                (point-max)))
+               (should (= (line-number-at-pos pos)
+                          (1+ (cl-count ?\n (buffer-substring
+                                            (point-min) pos))))))
+             (goto-char (point-min))
+             (let ((left (forward-line 15000)))
+               (should (= (cl-count ?\n (buffer-substring (point-min) (point)))
+                          (- 15000 left)))
+               (should (bolp))))))
+      (funcall check)
+      (goto-char (/ (point-max) 4))
+      (insert "\n\nnew lines\n")
+      (funcall check)
+      (delete-region (/ (point-max) 5) (+ (/ (point-max) 5) 1000))
+      (funcall check)
+      (subst-char-in-region (/ (point-max) 6) (+ (/ (point-max) 6) 500)
+                            ?a ?\n)
+      (funcall check)
+      (save-restriction
+        (narrow-to-region (/ (point-max) 7) (point-max))
+        (funcall check))
+      (set-buffer-multibyte nil)
+      (funcall check))))
+
+(ert-deftest search-test--re-search-matches ()
+  (with-temp-buffer
+    (insert "foo bar Foo\nbaz föo foo\n")
+    (let ((case-fold-search nil))
+      (should (equal (re-search-matches "foo" (point-min)) [1 4 21 24]))
+      (should (equal (re-search-matches "foo" (point-min) nil 1) [1 4]))
+      (should (equal (re-search-matches "foo" (point-min) 23) [1 4]))
+      (should (equal (re-search-matches "foo" 23 (point-min)) [1 4]))
+      (should (equal (re-search-matches "xyz" (point-min)) [])))
+    (let ((case-fold-search t))
+      (should (equal (re-search-matches "f.o" (point-min))
+                     [1 4 9 12 17 20 21 24])))
+    ;; Same results as a `re-search-forward' loop, including for
+    ;; empty matches, and the match data stays put.
+    (dolist (re '("^" "$" "o*" "\\b" "[^o]*" "\\(?:o\\|\\'\\)"))
+      (dolist (start (list (point-min) 3 12 (point-max)))
+        (let ((expected nil))
+          (save-excursion
+            (goto-char start)
+            (while (and (< (point) (point-max))
+                        (re-search-forward re nil t))
+              (push (match-beginning 0) expected)
+              (push (match-end 0) expected)
+              (when (and (= (match-beginning 0) (match-end 0))
+                         (not (eobp)))
+                (forward-char 1))))
+          (string-match "x" "x")
+          (goto-char 5)
+          (should (equal (re-search-matches re start)
+                         (vconcat (nreverse expected))))
+          (should (equal (match-data) '(0 1)))
+          (should (= (point) 5)))))
+    (should (equal (length (re-search-matches "" (point-min)))
+                   (* 2 (1- (point-max)))))
+    (save-restriction
+      (narrow-to-region 5 15)
+      (should (equal (re-search-matches "[a-z]+") [5 8 9 12 13 15]))
+      (should-error (re-search-matches "foo" 1)))
+    (with-temp-buffer
+      (dotimes (_ 5000)
+        (insert "line with foo in it\n"))
+      (let ((matches (re-search-matches "foo" (point-min))))
+        (should (= (length matches) 10000))
+        (should (equal (aref matches 9998) (- (point-max) 10)))))))
+
 ;;; search-tests.el ends here
@@ -32,12 +32,18 @@
 (declare-function sqlite-available-p "sqlite.c")
 (declare-function sqlite-finalize "sqlite.c")
 (declare-function sqlite-next "sqlite.c")
+(declare-function sqlite-next-rows "sqlite.c")
 (declare-function sqlite-more-p "sqlite.c")
 (declare-function sqlite-select "sqlite.c")
 (declare-function sqlite-open "sqlite.c")
 (declare-function sqlite-load-extension "sqlite.c")
 (declare-function sqlite-version "sqlite.c")
 (declare-function sqlite-execute-batch "sqlite.c")
+(declare-function sqlite-execute-many "sqlite.c")
+(declare-function sqlite-transaction "sqlite.c")
+(declare-function sqlite-rollback "sqlite.c")
+(declare-function sqlite-select-async "sqlite.c")
+(declare-function sqlite-execute-async "sqlite.c")
 
 (ert-deftest sqlite-select ()
   (skip-unless (sqlite-available-p))
@@ -112,6 +118,29 @@ sqlite-chars
      (equal (sqlite-select db "select * from test2" nil 'full)
             '(("col1" "col2") ("fóo" 3) ("fóo" 3) ("fo" 4))))))
 
+(ert-deftest sqlite-next-rows ()
+  (skip-unless (sqlite-available-p))
+  (let ((db (sqlite-open))
+        set)
+    (sqlite-execute db "create table test2b (col1 text, col2 integer)")
+    (sqlite-execute-many db "insert into test2b values (?, ?)"
+                         [["fóo" 1] ["foo" 2] ["fo\r\no" 3] ["" 4] [nil 5]])
+    (setq set (sqlite-select db "select * from test2b order by col2" nil 'set))
+    (should (equal (sqlite-next-rows set 0) []))
+    (should (equal (sqlite-next-rows set 2) [("fóo" 1) ("foo" 2)]))
+    ;; Text is decoded as by `sqlite-select'.
+    (should (equal (sqlite-next-rows set 2)
+                   (vconcat (sqlite-select
+                             db "select * from test2b where col2 in (3, 4)
+                                 order by col2"))))
+    (should (equal (sqlite-next-rows set 2) [(nil 5)]))
+    (should-not (sqlite-next-rows set 2))
+    (should-not (sqlite-more-p set))
+    (sqlite-finalize set)
+    ;; Text columns always come out as multibyte strings.
+    (should (multibyte-string-p
+             (caar (sqlite-select db "select col1 from test2b where col2 = 2"))))))
+
 (ert-deftest sqlite-numbers ()
   (skip-unless (sqlite-available-p))
   (let (db)
@@ -143,6 +172,106 @@ sqlite-param
       (sqlite-select db "select * from test4 where col2 = ?" [1])
       '(("foo" 1))))))
 
+(ert-deftest sqlite-param-reuse ()
+  (skip-unless (sqlite-available-p))
+  (let ((db (sqlite-open)))
+    (sqlite-execute db "create table test4b (col1 text, col2 number)")
+    (dotimes (i 3)
+      (sqlite-execute db "insert into test4b values (?, ?)"
+                      (list (format "foo%d" i) i)))
+    ;; The values bound by an earlier call are not reused.
+    (should (= (sqlite-execute db "insert into test4b values (?, ?)"
+                               '("bar"))
+               1))
+    (should (= (sqlite-execute db "insert into test4b values (?, ?)") 1))
+    (should
+     (equal (sqlite-select db "select * from test4b order by col2, col1")
+            '((nil nil) ("bar" nil) ("foo0" 0) ("foo1" 1) ("foo2" 2))))
+    ;; A set that is not finished doesn't get in the way.
+    (let ((set (sqlite-select db "select * from test4b where col2 > ?"
+                              '(0) 'set)))
+      (should
+       (equal (sqlite-select db "select * from test4b where col2 > ?" '(1))
+              '(("foo2" 2))))
+      (should (equal (sqlite-next set) '("foo1" 1)))
+      (sqlite-finalize set))
+    (should (sqlite-close db))))
+
+(ert-deftest sqlite-execute-many ()
+  (skip-unless (sqlite-available-p))
+  (let ((db (sqlite-open)))
+    (sqlite-execute db "create table test4c (col1 text, col2 number)")
+    (should (= (sqlite-execute-many db "insert into test4c values (?, ?)"
+                                    [["foo" 1] ("bar" 2) ["baz"]])
+               3))
+    (should (= (sqlite-execute-many db "insert into test4c values (?, ?)"
+                                    nil)
+               0))
+    (should
+     (equal (sqlite-select db "select * from test4c order by col1")
+            '(("bar" 2) ("baz" nil) ("foo" 1))))
+    (should (= (sqlite-execute-many db "update test4c set col2 = ? where col1 = ?"
+                                    '((3 "foo") (4 "bar") (5 "none")))
+               2))
+    ;; An error rolls back all the rows.
+    (should-error (sqlite-execute-many db "insert into test4c values (?, ?)"
+                                       [["zot" 6] ["zot" 7 8]]))
+    (should-not (sqlite-select db "select * from test4c where col1 = 'zot'"))
+    ;; But not an enclosing transaction.
+    (sqlite-transaction db)
+    (should (= (sqlite-execute-many db "insert into test4c values (?, ?)"
+                                    [["zot" 6]])
+               1))
+    (sqlite-rollback db)
+    (should-not (sqlite-select db "select * from test4c where col1 = 'zot'"))
+    (should-error (sqlite-execute-many db "insert into test4c values (?, ?)"
+                                       [foo]))
+    (should-error (sqlite-execute-many db "insert into nowhere values (?)"
+                                       [[1]]))))
+
+(ert-deftest sqlite-async ()
+  (skip-unless (sqlite-available-p))
+  (let ((db (sqlite-open))
+        (rows nil)
+        (status nil))
+    (sqlite-execute db "create table test4d (col1 text, col2 number)")
+    (sqlite-execute-many db "insert into test4d values (?, ?)"
+                         (mapcar (lambda (i) (list (format "foo%d" i) i))
+                                 (number-sequence 1 1000)))
+    (sqlite-select-async db "select * from test4d where col2 > ? order by col2"
+                         '(10)
+                         (lambda (batch s)
+                           (setq rows (append rows batch))
+                           (setq status s)))
+    (with-timeout (10 (ert-fail "Query didn't finish"))
+      (while (not status)
+        (accept-process-output nil 0.01)))
+    (should (eq status t))
+    (should (= (length rows) 990))
+    (should (equal (car rows) '("foo11" 11)))
+    (should (equal (car (last rows)) '("foo1000" 1000)))
+    (setq status nil)
+    (sqlite-execute-async db "delete from test4d where col2 > ?" [500]
+                          (lambda (value s) (setq status (list value s))))
+    (with-timeout (10 (ert-fail "Query didn't finish"))
+      (while (not status)
+        (accept-process-output nil 0.01)))
+    (should (equal status '(500 t)))
+    ;; Errors in compiling the query are signaled right away.
+    (should-error (sqlite-execute-async db "insert into nowhere values (?)"
+                                        nil #'ignore))
+    (setq status nil)
+    (sqlite-execute db "create table test4e (col1 integer primary key)")
+    (sqlite-execute db "insert into test4e values (1)")
+    (sqlite-execute-async db "insert into test4e values (?)" '(1)
+                          (lambda (value s) (setq status (list value s))))
+    (with-timeout (10 (ert-fail "Query didn't finish"))
+      (while (not status)
+        (accept-process-output nil 0.01)))
+    (should-not (car status))
+    (should (eq (car (cadr status)) 'sqlite-error))
+    (should (sqlite-close db))))
+
 (ert-deftest sqlite-binary ()
   (skip-unless (sqlite-available-p))
   (let (db)
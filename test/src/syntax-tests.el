@@ -520,4 +520,77 @@ syntax-char-syntax
         (should (equal (eval '(char-syntax 128) t) ?_))
         (should (equal (funcall cs 128) ?_))))))
 
+;; The parse states recorded while parsing from the beginning of the
+;; buffer must not change any results.
+(ert-deftest syntax-tests-parse-partial-sexp-checkpoints ()
+  (with-temp-buffer
+    (emacs-lisp-mode)
+    (dotimes (i 300)
+      (insert (format "(defun f%d (x) \"Doc \\\" (%d.\"\n  ;; a \"comment\n  '(x ?\\( . [%d]))\n"
+                      i i i)))
+    (let ((check
+           (lambda ()
+             (let ((pos (point-min)))
+               (while (< pos (point-max))
+                 ;; A TARGETDEPTH that is never reached disables the
+                 ;; recorded states.
+                 (should (equal (parse-partial-sexp (point-min) pos)
+                                (parse-partial-sexp (point-min) pos -1000)))
+                 (setq pos (+ pos 997)))))))
+      (funcall check)
+      (goto-char 4000)
+      (insert "\"")
+      (funcall check)
+      (goto-char 9000)
+      (insert "((")
+      (goto-char 20)
+      (delete-char 3)
+      (funcall check)
+      (narrow-to-region 1000 (- (point-max) 1000))
+      (funcall check))))
+
+(ert-deftest syntax-tests-back-comment-checkpoints ()
+  (with-temp-buffer
+    (let ((st (make-syntax-table))
+          (comment-use-syntax-ppss nil)
+          (open-paren-in-column-0-is-defun-start nil)
+          (ends nil))
+      (modify-syntax-entry ?/ ". 14" st)
+      (modify-syntax-entry ?* ". 23" st)
+      (set-syntax-table st)
+      (dotimes (i 500)
+        (insert (format "x = \"/*%d\"; /* it's \" */" i))
+        (push (point) ends)
+        (insert "\n"))
+      (dolist (end ends)
+        (goto-char end)
+        (should (forward-comment -1))
+        (should (looking-at "/\\* it's"))))))
+
+;; The syntax of ASCII characters is cached per syntax table; the
+;; cache must notice changes to the table and its parents.
+(ert-deftest syntax-tests-skip-syntax-table-changes ()
+  (with-temp-buffer
+    (let* ((parent (make-syntax-table))
+           (st (make-syntax-table parent)))
+      (set-syntax-table st)
+      (insert "foo-bar baz")
+      (goto-char (point-min))
+      (should (= (skip-syntax-forward "w") 3))
+      (modify-syntax-entry ?- "w" parent)
+      (goto-char (point-min))
+      (should (= (skip-syntax-forward "w") 7))
+      (aset st ?- '(1))
+      (goto-char (point-min))
+      (should (= (skip-syntax-forward "w") 3))
+      (set-char-table-parent st (make-syntax-table))
+      (aset st ?- nil)
+      (goto-char (point-min))
+      (should (= (skip-syntax-forward "w") 3))
+      (should (= (skip-syntax-forward "_") 1))
+      (goto-char (point-max))
+      (should (= (skip-syntax-backward "w") -3))
+      (should (forward-word -1))
+      (should (= (point) 5)))))
+
 ;;; syntax-tests.el ends here
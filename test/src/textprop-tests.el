@@ -119,5 +119,77 @@ textprop-interval-immutability
       ;; `inhibit-read-only''s influence towards the end of the buffer.
       (should-error (delete-and-extract-region 26 37)))))
 
+;; Lookups of text properties start from the interval found last, so
+;; check that it is forgotten when the text or its properties change.
+(ert-deftest textprop-tests-sequential-lookups ()
+  (with-temp-buffer
+    (dotimes (i 100)
+      (insert (propertize "ab" 'n i)))
+    (dotimes (i 200)
+      (should (eq (get-text-property (1+ i) 'n) (/ i 2))))
+    (should (eq (next-single-property-change 1 'n) 3))
+    (should (eq (next-single-property-change 3 'n) 5))
+    (goto-char 4)
+    (insert "x")
+    (should-not (get-text-property 4 'n))
+    (should (eq (get-text-property 5 'n) 1))
+    (should (eq (get-text-property 6 'n) 2))
+    (should (eq (next-single-property-change 3 'n) 4))
+    (should (eq (next-single-property-change 5 'n) 6))
+    (put-text-property 6 8 'n 1)
+    (should (eq (next-single-property-change 5 'n) 8))
+    (should (eq (get-text-property 7 'n) 1))
+    (remove-text-properties 1 (point-max) '(n nil))
+    (should-not (get-text-property 7 'n))
+    (should-not (next-single-property-change 1 'n))))
+
+(ert-deftest textprop-tests-insert-at-interval-boundary ()
+  ;; Inserting text must not leave stale positions in the interval
+  ;; last looked up.
+  (with-temp-buffer
+    (insert "aaa" (propertize "bbb" 'face 'bold) "ccc")
+    (should (eq (get-text-property 5 'face) 'bold))
+    (goto-char 4)
+    (insert "xx")
+    (should-not (get-text-property 5 'face))
+    (should (eq (get-text-property 6 'face) 'bold))
+    (should (eq (get-text-property 8 'face) 'bold))
+    (should-not (get-text-property 9 'face))
+    (should (equal-including-properties
+             (buffer-string)
+             #("aaaxxbbbccc" 5 8 (face bold))))))
+
+;; Compare `put-text-properties-bulk' with `put-text-property'.
+(ert-deftest textprop-tests-put-text-properties-bulk ()
+  (let ((runs [(2 5 face bold) (3 9 face italic) (4 6 n 1)
+               (12 12 n 2) (12 15 face bold)]))
+    (with-temp-buffer
+      (insert (propertize "0123456789abcdefghij" 'x 1))
+      (let ((expected (copy-sequence (buffer-string))))
+        (seq-doseq (run runs)
+          (put-text-property (1- (nth 0 run)) (1- (nth 1 run))
+                             (nth 2 run) (nth 3 run) expected))
+        (should (eq (put-text-properties-bulk runs) t))
+        (should (equal-including-properties (buffer-string) expected))
+        (should-not (put-text-properties-bulk [(3 5 face italic)]))
+        ;; Text with equal properties ends up in one interval.
+        (remove-text-properties 1 21 '(n nil))
+        (put-text-properties-bulk [(1 11 face bold) (11 21 face bold)])
+        (should (= (length (object-intervals (current-buffer))) 1))
+        (should-not (put-text-properties-bulk []))))
+    (let ((string (make-string 10 ?a)))
+      (put-text-properties-bulk [(0 4 face bold) (2 6 n 1)] string)
+      (should (equal-including-properties
+               string
+               #("aaaaaaaaaa" 0 2 (face bold) 2 4 (n 1 face bold)
+                 4 6 (n 1)))))
+    (with-temp-buffer
+      (insert "abc")
+      (should-error (put-text-properties-bulk [(2 3 n 1) (1 2 n 1)]))
+      (should-error (put-text-properties-bulk [(1 5 n 1)])
+                    :type 'args-out-of-range)
+      (should-error (put-text-properties-bulk [(1 2 n)])
+                    :type 'wrong-type-argument))))
+
 (provide 'textprop-tests)
 ;;; textprop-tests.el ends here
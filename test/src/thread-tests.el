@@ -23,11 +23,18 @@
 
 ;; Declare the functions in case Emacs has been configured --without-threads.
 (declare-function all-threads "thread.c" ())
+(declare-function channel-close "thread.c" (channel))
+(declare-function channel-name "thread.c" (channel))
+(declare-function channel-receive "thread.c" (channel))
+(declare-function channel-select "thread.c" (channels))
+(declare-function channel-send "thread.c" (channel value))
+(declare-function channelp "thread.c" (object))
 (declare-function condition-mutex "thread.c" (cond))
 (declare-function condition-name "thread.c" (cond))
 (declare-function condition-notify "thread.c" (cond &optional all))
 (declare-function condition-wait "thread.c" (cond))
 (declare-function current-thread "thread.c" ())
+(declare-function make-channel "thread.c" (&optional capacity name))
 (declare-function make-condition-variable "thread.c" (mutex &optional name))
 (declare-function make-mutex "thread.c" (&optional name))
 (declare-function make-thread "thread.c" (function &optional name))
@@ -418,4 +425,108 @@ threads-test-bug48990
         (should (eq threads-test--var 'local2)))
       (should (eq threads-test--var 'global)))))
 
+(ert-deftest threads-secure-hash ()
+  "Hash large strings in several threads at once."
+  (skip-unless (fboundp 'make-thread))
+  (let* ((strings (mapcar (lambda (c) (make-string (* 1024 1024) c))
+                          '(?a ?b ?c)))
+         (expected (mapcar (lambda (s) (secure-hash 'sha256 s)) strings))
+         (threads (mapcar (lambda (s)
+                            (make-thread
+                             (lambda ()
+                               (list (secure-hash 'sha256 s)
+                                     (md5 s nil nil 'utf-8)))))
+                          strings)))
+    (should (equal (mapcar #'thread-join threads)
+                   (mapcar (lambda (s)
+                             (list (secure-hash 'sha256 s)
+                                   (md5 s nil nil 'utf-8)))
+                           strings)))
+    (should (equal (mapcar (lambda (s) (secure-hash 'sha256 s)) strings)
+                   expected))))
+
+(ert-deftest threads-channel ()
+  "Pass values between threads through a channel."
+  (skip-unless (fboundp 'make-thread))
+  (let* ((channel (make-channel 2 "chan"))
+         (sender (make-thread (lambda ()
+                                (dotimes (i 10)
+                                  (channel-send channel i))
+                                (channel-close channel))))
+         (received nil))
+    (should (channelp channel))
+    (should (equal (channel-name channel) "chan"))
+    (should (string-match-p "\\`#<channel chan>\\'" (prin1-to-string channel)))
+    (should (eq (type-of channel) 'channel))
+    (condition-case nil
+        (while t
+          (push (channel-receive channel) received))
+      (channel-closed nil))
+    (thread-join sender)
+    (should (equal (nreverse received) (number-sequence 0 9)))
+    (should-error (channel-send channel 'x) :type 'channel-closed)
+    (should-error (make-channel 0) :type 'args-out-of-range)))
+
+(ert-deftest threads-channel-buffered ()
+  "Values sent before a channel is closed can still be received."
+  (skip-unless (fboundp 'make-thread))
+  (let ((channel (make-channel 3)))
+    (channel-send channel 'a)
+    (channel-send channel 'b)
+    (channel-close channel)
+    (should (eq (channel-receive channel) 'a))
+    (should (eq (channel-receive channel) 'b))
+    (should-error (channel-receive channel) :type 'channel-closed)
+    ;; Waiting with no other thread to wake us up is an error.
+    (should-error (channel-receive (make-channel)))))
+
+(ert-deftest threads-channel-select ()
+  "Receive from whichever channel has a value."
+  (skip-unless (fboundp 'make-thread))
+  (let* ((a (make-channel))
+         (b (make-channel))
+         (thread (make-thread (lambda ()
+                                (channel-send b 1)
+                                (channel-send a 2)
+                                (channel-close a)
+                                (channel-close b)))))
+    ;; Both channels hold a value when this thread wakes up, so the
+    ;; first one in the list is used.
+    (should (equal (channel-select (list a b)) (cons a 2)))
+    (should (equal (channel-select (list a b)) (cons b 1)))
+    (should-error (channel-select (list a b)) :type 'channel-closed)
+    (thread-join thread)
+    (should-error (channel-select (list a 'foo)) :type 'wrong-type-argument)))
+
+(ert-deftest threads-channel-signal ()
+  "A thread waiting for a channel can be signaled."
+  (skip-unless (fboundp 'make-thread))
+  (let* ((channel (make-channel))
+         (thread (make-thread (lambda ()
+                                (condition-case err
+                                    (channel-receive channel)
+                                  (error err))))))
+    (while (not (eq (thread--blocker thread) channel))
+      (thread-yield))
+    (thread-signal thread 'error '("stop"))
+    (while (thread-live-p thread)
+      (thread-yield))
+    (should (equal (thread-join thread) '(error "stop")))))
+
+(ert-deftest threads-thread-pool ()
+  "Run functions in a thread pool."
+  (skip-unless (fboundp 'make-thread))
+  (let ((pool (make-thread-pool 3 "pool")))
+    (should (thread-pool-p pool))
+    (should (= (length (thread-pool-threads pool)) 3))
+    (should (equal (thread-pool-map pool (lambda (x) (sleep-for 0.01) (* x x))
+                                    (number-sequence 1 10))
+                   (mapcar (lambda (x) (* x x)) (number-sequence 1 10))))
+    (let ((result (thread-pool-submit pool #'error "Oops %d" 1)))
+      (should (equal (should-error (thread-pool-result result))
+                     '(error "Oops 1"))))
+    (thread-pool-shutdown pool t)
+    (should-not (seq-some #'thread-live-p (thread-pool-threads pool)))
+    (should-error (thread-pool-submit pool #'ignore) :type 'channel-closed)))
+
 ;;; thread-tests.el ends here
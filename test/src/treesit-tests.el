@@ -25,6 +25,7 @@
 (declare-function treesit-language-available-p "treesit.c")
 
 (declare-function treesit-parser-root-node "treesit.c")
+(declare-function treesit-parser-add-notifier "treesit.c")
 (declare-function treesit-parser-set-included-ranges "treesit.c")
 (declare-function treesit-parser-included-ranges "treesit.c")
 
@@ -58,6 +59,8 @@
 (declare-function treesit-search-forward "treesit.c")
 (declare-function treesit-search-subtree "treesit.c")
 
+(defvar treesit-background-parse-threshold)
+
 ;;; Basic API
 
 (ert-deftest treesit-basic-parsing ()
@@ -87,6 +90,66 @@ treesit-basic-parsing
          (treesit-parser-root-node parser))
         "(document (array (number) (object (pair key: (string (string_content)) value: (string (string_content)))) (number) (number)))")))))
 
+;; The parser keeps the previous tree until the background reparse is
+;; done, and then calls its notifiers.
+(defvar treesit-tests--notified nil)
+(defun treesit-tests--notifier (ranges _parser)
+  (push ranges treesit-tests--notified))
+
+(ert-deftest treesit-background-parsing ()
+  "Test reparsing in the background."
+  (skip-unless (treesit-language-available-p 'json))
+  (with-temp-buffer
+    (let ((treesit-background-parse-threshold 1)
+          (treesit-tests--notified nil)
+          (parser (treesit-parser-create 'json)))
+      (insert "[1,2,3]")
+      (should
+       (equal (treesit-node-string
+               (treesit-parser-root-node parser))
+              "(document (array (number) (number) (number)))"))
+      (treesit-parser-add-notifier parser #'treesit-tests--notifier)
+      (setq treesit-tests--notified nil)
+      (goto-char (point-max))
+      (insert "[4]")
+      (treesit-parser-root-node parser)
+      (with-timeout (10 (ert-fail "Background parse didn't finish"))
+        (while (not treesit-tests--notified)
+          (accept-process-output nil 0.01)
+          (treesit-parser-root-node parser)))
+      (should
+       (equal (treesit-node-string
+               (treesit-parser-root-node parser))
+              "(document (array (number) (number) (number)) (array (number)))")))))
+
+;; Edits close to each other are merged before being given to
+;; tree-sitter, check that the tree still comes out right.
+(ert-deftest treesit-merged-edits ()
+  "Test reparsing after many nearby and distant edits."
+  (skip-unless (treesit-language-available-p 'json))
+  (with-temp-buffer
+    (let ((parser (treesit-parser-create 'json)))
+      (insert "[" (mapconcat #'number-to-string (number-sequence 1 500) ",")
+              "]")
+      (treesit-parser-root-node parser)
+      (goto-char (point-min))
+      (while (re-search-forward "[0-9]+" nil t)
+        (replace-match "\"x\"" t t))
+      (goto-char (point-min))
+      (insert (make-string 3000 ?\s))
+      (goto-char (point-max))
+      (insert ",null")
+      (should
+       (equal (treesit-node-string (treesit-parser-root-node parser))
+              (format "(document (array %s (null)))"
+                      (string-join
+                       (make-list 500 "(string (string_content))") " "))))
+      (erase-buffer)
+      (insert "{}")
+      (should
+       (equal (treesit-node-string (treesit-parser-root-node parser))
+              "(document (object))")))))
+
 (ert-deftest treesit-node-api ()
   "Tests for node API."
   (skip-unless (treesit-language-available-p 'json))
@@ -500,6 +563,76 @@ treesit-query-api
                (treesit-pattern-expand "a\nb\rc\td\0e\"f\1g\\h\fi")
                "\"a\\nb\\rc\\td\\0e\\\"f\1g\\\\h\fi\"")))))
 
+(ert-deftest treesit-query-api-equal ()
+  "Test the `equal' predicate on captured text."
+  (skip-unless (treesit-language-available-p 'json))
+  (with-temp-buffer
+    (insert "[\"é\", \"é\", \"e\", 12]")
+    (let ((parser (treesit-parser-create 'json)))
+      (goto-char (point-min))
+      ;; Put the gap inside the text of a node.
+      (search-forward "é")
+      (insert "x")
+      (delete-char -1)
+      (should (equal (mapcar (lambda (capture)
+                               (treesit-node-start (cdr capture)))
+                             (treesit-query-capture
+                              (treesit-parser-root-node parser)
+                              '(((string_content) @s (:equal "é" @s)))))
+                     '(3 8))))))
+
+(ert-deftest treesit-query-api-range-cache ()
+  "Test querying the same range repeatedly with a compiled query."
+  (skip-unless (treesit-language-available-p 'json))
+  (with-temp-buffer
+    (insert "[1,2,{\"name\": \"Bob\"},3]")
+    (let* ((parser (treesit-parser-create 'json))
+           (query (treesit-query-compile 'json '((number) @number)))
+           (capture (lambda ()
+                      (mapcar (lambda (entry)
+                                (cons (car entry)
+                                      (treesit-node-text (cdr entry))))
+                              (treesit-query-capture
+                               (treesit-parser-root-node parser) query 1 5))))
+           (first (funcall capture)))
+      (should (equal first '((number . "1") (number . "2"))))
+      ;; Changing the result doesn't change the next one.
+      (setcar (car (treesit-query-capture
+                    (treesit-parser-root-node parser) query 1 5))
+              'changed)
+      (should (equal (funcall capture) first))
+      ;; Nor does changing the buffer leave a stale result.
+      (goto-char 2)
+      (insert "7,")
+      (should (equal (funcall capture) '((number . "7") (number . "1"))))
+      (delete-region 2 4)
+      (should (equal (funcall capture) first)))))
+
+(ert-deftest treesit-query-capture-batch ()
+  "Test `treesit-query-capture-batch'."
+  (skip-unless (treesit-language-available-p 'json))
+  (with-temp-buffer
+    (insert "[1,2,{\"name\": \"Bob\"},3]")
+    (let* ((parser (treesit-parser-create 'json))
+           (root (treesit-parser-root-node parser))
+           (compiled (treesit-query-compile
+                      'json '((number) @number
+                              ((string) @s (:match "B" @s)))))
+           (jobs `((,root ,compiled 1 5)
+                   (,root ,compiled nil nil)
+                   (,parser "(pair key: (_) @keyword)" nil nil)
+                   (,root ,compiled 1 5)))
+           (results (treesit-query-capture-batch jobs)))
+      (should (= (length results) 4))
+      (should (equal results
+                     (mapcar (lambda (job)
+                               (apply #'treesit-query-capture job))
+                             jobs)))
+      (should (equal (mapcar (lambda (capture)
+                               (treesit-node-text (cdr capture)))
+                             (nth 1 results))
+                     '("1" "2" "\"Bob\"" "3"))))))
+
 ;;; Narrow
 
 (ert-deftest treesit-narrow ()
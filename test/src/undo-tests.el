@@ -357,6 +357,35 @@ undo-test-marker-adjustment-nominal
       (undo-boundary)
       (should (= 2 (marker-position m))))))
 
+;; `adjust_markers_for_delete' records the adjustments as it relocates
+;; the markers; they must follow the deletion record.
+(ert-deftest undo-test-marker-adjustment-record ()
+  "Test the marker adjustments recorded for a deletion."
+  (with-temp-buffer
+    (buffer-enable-undo)
+    (insert "abcdefghij")
+    (undo-boundary)
+    (let ((before (copy-marker 2))
+          (inside (copy-marker 5))
+          (inside-t (copy-marker 5 t))
+          (at-end (copy-marker 7))
+          (after (copy-marker 9)))
+      (delete-region 3 7)
+      (let ((list buffer-undo-list))
+        (should (equal (car list) '("cdef" . 3)))
+        (let ((adjustments (seq-take-while
+                            (lambda (elt) (markerp (car-safe elt)))
+                            (cdr list))))
+          (should (= (length adjustments) 3))
+          (should (eq (cdr (assq inside adjustments)) -2))
+          (should (eq (cdr (assq inside-t adjustments)) 2))
+          (should (eq (cdr (assq at-end adjustments)) -4))))
+      (primitive-undo 1 buffer-undo-list)
+      (should (equal (buffer-string) "abcdefghij"))
+      (should (equal (mapcar #'marker-position
+                             (list before inside inside-t at-end after))
+                     '(2 5 5 7 9))))))
+
 (ert-deftest undo-test-region-t-marker ()
   "Test undo in region containing marker with t insertion-type."
   (with-temp-buffer
@@ -539,5 +568,56 @@ undo-test-skip-invalidated-markers
     (undo-boundary)
     (undo)))
 
+;; Make a random change to the current buffer.
+(defun undo-test--random-change (i)
+  (if (and (> (buffer-size) 10) (zerop (random 3)))
+      (let ((beg (1+ (random (1- (buffer-size))))))
+        (delete-region beg (min (point-max) (+ beg 1 (random 30)))))
+    (goto-char (1+ (random (1+ (buffer-size)))))
+    (insert (propertize (format "chunk%d-\u00e9-%s " i (make-string (random 20) ?x))
+                        'face (if (zerop (% i 2)) 'bold '(italic (:height 1.5)))))))
+
+(ert-deftest undo-test-compressed-history ()
+  "Test undoing through compressed undo history."
+  (with-temp-buffer
+    (buffer-enable-undo)
+    (setq-local undo-limit 2000
+                undo-strong-limit 3000
+                undo-compressed-limit t)
+    (let ((states nil))
+      (dotimes (i 200)
+        (push (buffer-string) states)
+        (undo-test--random-change i)
+        (undo-boundary))
+      (garbage-collect)
+      (should (assq 'undo-compressed buffer-undo-list))
+      (let ((list buffer-undo-list))
+        (when (null (car list))
+          (pop list))
+        (dolist (state states)
+          (setq list (primitive-undo 1 list))
+          (should (equal-including-properties (buffer-string) state)))))))
+
+(ert-deftest undo-test-compressed-history-limit ()
+  "Test that `undo-compressed-limit' bounds the compressed history."
+  (with-temp-buffer
+    (buffer-enable-undo)
+    (setq-local undo-limit 200
+                undo-strong-limit 300
+                undo-compressed-limit 2000)
+    (dotimes (i 500)
+      (undo-test--random-change i)
+      (undo-boundary)
+      (when (zerop (% i 10))
+        (garbage-collect)))
+    (garbage-collect)
+    (let ((sizes (mapcar (lambda (elt) (length (cdr elt)))
+                         (seq-filter (lambda (elt)
+                                       (eq (car-safe elt) 'undo-compressed))
+                                     buffer-undo-list))))
+      (should sizes)
+      (should (<= (apply #'+ sizes) 2000)))
+    (should-error (undo--decompress-history "\0\5abc"))))
+
 (provide 'undo-tests)
 ;;; undo-tests.el ends here
@@ -0,0 +1,77 @@
+;;; window-tests.el --- tests for window.c functions -*- lexical-binding: t -*-
+
+;; Copyright (C) 2025 Free Software Foundation, Inc.
+
+;; This file is part of GNU Emacs.
+
+;; GNU Emacs is free software: you can redistribute it and/or modify
+;; it under the terms of the GNU General Public License as published by
+;; the Free Software Foundation, either version 3 of the License, or
+;; (at your option) any later version.
+
+;; GNU Emacs is distributed in the hope that it will be useful,
+;; but WITHOUT ANY WARRANTY; without even the implied warranty of
+;; MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+;; GNU General Public License for more details.
+
+;; You should have received a copy of the GNU General Public License
+;; along with GNU Emacs.  If not, see <https://www.gnu.org/licenses/>.
+
+;;; Code:
+
+(require 'ert)
+
+(ert-deftest window-tests-configuration-shared-state ()
+  "Test restoring configurations that share the state of unchanged windows."
+  (let ((buffer (generate-new-buffer " *window-tests*")))
+    (unwind-protect
+        (save-window-excursion
+          (delete-other-windows)
+          (let* ((w1 (selected-window))
+                 (w2 (split-window))
+                 config1 config2 config3)
+            (set-window-buffer w1 buffer)
+            (set-window-buffer w2 buffer)
+            (with-current-buffer buffer
+              (dotimes (i 100)
+                (insert (format "line %d\n" i))))
+            (set-window-start w2 11)
+            (set-window-point w2 21)
+            (setq config1 (current-window-configuration))
+            ;; Nothing changed.
+            (setq config2 (current-window-configuration))
+            (should (compare-window-configurations config1 config2))
+            ;; Only W2 changed.
+            (set-window-start w2 31)
+            (set-window-point w2 41)
+            (setq config3 (current-window-configuration))
+            ;; The saved positions of both configurations follow
+            ;; editing.
+            (with-current-buffer buffer
+              (goto-char (point-min))
+              (insert "12345"))
+            (set-window-configuration config1)
+            (should (= (window-start w2) 16))
+            (should (= (window-point w2) 26))
+            (set-window-configuration config3)
+            (should (= (window-start w2) 36))
+            (should (= (window-point w2) 46))
+            (set-window-configuration config2)
+            (should (= (window-start w2) 16))
+            (should (= (window-point w2) 26))
+            ;; A changed window parameter is saved anew.
+            (let ((window-persistent-parameters
+                   (cons '(window-tests . t) window-persistent-parameters)))
+              (set-window-parameter w2 'window-tests 1)
+              (setq config1 (current-window-configuration))
+              (set-window-parameter w2 'window-tests 2)
+              (setq config2 (current-window-configuration))
+              (set-window-configuration config1)
+              (should (eq (window-parameter w2 'window-tests) 1))
+              (set-window-configuration config2)
+              (should (eq (window-parameter w2 'window-tests) 2)))))
+      (kill-buffer buffer))))
+
+(provide 'window-tests)
+
+;;; window-tests.el ends here
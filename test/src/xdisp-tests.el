@@ -179,4 +179,140 @@ test-messages-buffer-name
         (buffer-string)))
     "foo\n")))
 
+(ert-deftest xdisp-tests--cache-line-heights ()
+  "Check that caching line heights doesn't change the results of motion."
+  (with-temp-buffer
+    (dotimes (i 500)
+      (insert (make-string (% (* i 37) 230) ?x) "\n"))
+    (set-window-buffer nil (current-buffer))
+    (let (results)
+      (dolist (cache-line-heights '(t nil))
+        (let (r)
+          (dotimes (_ 2)
+            (goto-char (point-min))
+            (push (vertical-motion 300) r)
+            (push (point) r)
+            (push (vertical-motion -100) r)
+            (push (point) r)
+            (goto-char 3000)
+            (insert "foo\nbar"))
+          (goto-char 3000)
+          (delete-char 7)
+          (goto-char 3000)
+          (delete-char 7)
+          (push r results)))
+      (should (equal (car results) (cadr results))))))
+
+(ert-deftest xdisp-tests--redisplay-trace ()
+  "Check that `redisplay-trace' records the windows redisplayed."
+  (let ((redisplay-trace-size 10)
+        (redisplay-skip-initial-frame nil))
+    (redisplay-trace t)
+    (with-temp-buffer
+      (insert "foo\nbar\n")
+      (set-window-buffer nil (current-buffer))
+      (redisplay t)
+      (let ((trace (redisplay-trace t)))
+        (should (<= 1 (length trace) 10))
+        (dolist (entry trace)
+          (should (windowp (nth 1 entry)))
+          (should (memq (nth 2 entry)
+                        '( try-cursor-movement current-line try-window-id
+                           try-window-reusing-current-matrix try-window)))
+          (should (natnump (nth 3 entry)))
+          (should (floatp (nth 4 entry)))))
+      (should-not (redisplay-trace)))))
+
+(defvar xdisp-tests--evals)
+(defvar xdisp-tests--label)
+
+(ert-deftest xdisp-tests--cache-mode-lines ()
+  "Check that cached mode lines still evaluate their `:eval' forms once."
+  (let ((redisplay-skip-initial-frame nil)
+        counts)
+    (dolist (cache-mode-lines '(t nil))
+      (with-temp-buffer
+        (setq-local xdisp-tests--evals 0
+                    xdisp-tests--label "foo"
+                    mode-line-format
+                    '("%b " xdisp-tests--label " "
+                      (:eval (number-to-string
+                              (/ (setq xdisp-tests--evals
+                                       (1+ xdisp-tests--evals))
+                                 2)))))
+        (set-window-buffer nil (current-buffer))
+        (dotimes (i 6)
+          (when (= i 3)
+            (setq xdisp-tests--label "bar"))
+          (force-mode-line-update)
+          (redisplay t))
+        (push xdisp-tests--evals counts)))
+    (should (> (car counts) 0))
+    (should (equal (car counts) (cadr counts)))))
+
+(ert-deftest xdisp-tests--cached-paragraph-direction ()
+  "Check that edits change the cached direction of a paragraph."
+  (with-temp-buffer
+    (insert (make-string 2000 ?.) "\u05e9\u05dc\u05d5\u05dd\n")
+    (goto-char 1000)
+    (should (eq (current-bidi-paragraph-direction) 'right-to-left))
+    (goto-char 1500)
+    (should (eq (current-bidi-paragraph-direction) 'right-to-left))
+    (goto-char 2001)
+    (insert "abc")
+    (goto-char 1500)
+    (should (eq (current-bidi-paragraph-direction) 'left-to-right))
+    (delete-region 2001 2004)
+    (should (eq (current-bidi-paragraph-direction) 'right-to-left))
+    (narrow-to-region 1200 1600)
+    (should (eq (current-bidi-paragraph-direction) 'left-to-right))))
+
+(ert-deftest xdisp-tests--long-line-checkpoints ()
+  "Check that bidi checkpoints in long lines don't change the layout."
+  (let ((redisplay-skip-initial-frame nil)
+        (long-line-threshold 1000)
+        results)
+    (dolist (cache '(t nil))
+      (with-temp-buffer
+        (setq cache-long-scans cache)
+        (dotimes (i 3000)
+          (insert (if (zerop (% i 7)) "\u05d0\u05d1 (x) " "foo, ")))
+        (set-window-buffer nil (current-buffer))
+        (let (r)
+          (dolist (pos '(20000 9000 14000 5000 14500))
+            (goto-char pos)
+            (set-window-start nil (- pos 500))
+            (redisplay t)
+            (push (window-end nil t) r)
+            (push (vertical-motion 3) r)
+            (push (point) r)
+            (push (vertical-motion -5) r)
+            (push (point) r))
+          (push r results))))
+    (should (car results))
+    (should (equal (car results) (cadr results)))))
+
+(ert-deftest xdisp-tests--many-overlay-strings ()
+  "Check that changes to overlays show in cached overlay strings."
+  (with-temp-buffer
+    (insert "xxx")
+    (switch-to-buffer (current-buffer))
+    (let ((char-width (frame-char-width))
+          overlays)
+      (dotimes (i 20)
+        (let ((ov (make-overlay 2 2)))
+          (overlay-put ov 'priority i)
+          (overlay-put ov 'before-string "a")
+          (push ov overlays)))
+      (should (equal (/ (car (window-text-pixel-size nil t t)) char-width)
+                     23))
+      (should (equal (/ (car (window-text-pixel-size nil t t)) char-width)
+                     23))
+      (overlay-put (car overlays) 'before-string "bbbb")
+      (should (equal (/ (car (window-text-pixel-size nil t t)) char-width)
+                     26))
+      (delete-overlay (cadr overlays))
+      (should (equal (/ (car (window-text-pixel-size nil t t)) char-width)
+                     25)))))
+
 ;;; xdisp-tests.el ends here
@@ -52,6 +52,27 @@ xfaces-internal-color-values-from-color-spec
   (should (equal (color-values-from-color-spec "rgbi:0/0x0/0") nil))
   (should (equal (color-values-from-color-spec "rgbi:0/+0x1/0") nil)))
 
+(ert-deftest xfaces-face-range-sets ()
+  (with-temp-buffer
+    (insert "foo bar foo\nbaz foo\n")
+    (switch-to-buffer (current-buffer))
+    (let ((size (window-text-pixel-size nil t t)))
+      (setq face-range-sets
+            `((bold ,(re-search-matches "foo" (point-min)))
+              ((:underline t) [2 6 9 30])
+              (italic [5 7] ,(selected-window))
+              (italic [1 3] ,(next-window))))
+      (should (local-variable-p 'face-range-sets))
+      (should (memq (symbol-function 'set-buffer-redisplay)
+                    (get-variable-watchers 'face-range-sets)))
+      (should (equal (window-text-pixel-size nil t t) size))
+      ;; Malformed sets and ranges are ignored by redisplay.
+      (setq face-range-sets
+            '(nil bold (bold) (bold . [1 2]) (bold [a 3 5 b 9])
+                  (bold [3 1]) (bold [1 4 7])))
+      (should (equal (window-text-pixel-size nil t t) size))))
+  (should-not (default-value 'face-range-sets)))
+
 (provide 'xfaces-tests)
 
 ;;; xfaces-tests.el ends here
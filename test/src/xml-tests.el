@@ -27,6 +27,7 @@
 
 (require 'ert)
 
+(declare-function libxml-parse-html-region "xml.c")
 (declare-function libxml-parse-xml-region "xml.c")
 
 (defvar libxml-tests--data-comments-preserved
@@ -54,4 +55,28 @@ libxml-tests
       (should (equal (cdr test)
                      (libxml-parse-xml-region (point-min) (point-max)))))))
 
+(ert-deftest libxml-tests-nested ()
+  "Test that nested elements, text and whitespace are all kept."
+  (skip-unless (fboundp 'libxml-parse-html-region))
+  (with-temp-buffer
+    (insert "<ul> <li>one <b>b</b> <i>c</i> </li>\n <!-- c --> "
+            "<li>two<li>three</ul>")
+    (should (equal (libxml-parse-html-region)
+                   '(html nil
+                          (body nil
+                                (ul nil
+                                    (li nil "one " (b nil "b") " "
+                                        (i nil "c") " ")
+                                    "\n " (comment nil " c ") " "
+                                    (li nil "two") (li nil "three")))))))
+  (with-temp-buffer
+    (insert "<?xml version=\"1.0\"?><r xmlns:a=\"u\"><a:x a:y=\"1\"> "
+            "<![CDATA[c1]]>t<![CDATA[c3]]> </a:x>\n  <e/>  <f> </f>"
+            "<!-- c --></r><!-- after -->")
+    (should (equal (libxml-parse-xml-region)
+                   '(top nil
+                         (r nil (x ((y . "1")) "c1" "t" "c3") (e nil)
+                            (f nil " ") (comment nil " c "))
+                         (comment nil " after "))))))
+
 ;;; xml-tests.el ends here